@@ -0,0 +1,32 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_COMMON_PLATFORM_API_QUICHE_BENCHMARK_H_
+#define QUICHE_COMMON_PLATFORM_API_QUICHE_BENCHMARK_H_
+
+#include "quiche_platform_impl/quiche_benchmark_impl.h"
+
+namespace quiche {
+
+// State handed to each benchmark routine.  This mirrors the subset of
+// benchmark::State that quiche benchmarks rely on, so that platforms can
+// back it directly with google-benchmark.
+using QuicheBenchmarkState = QuicheBenchmarkStateImpl;
+
+// Runs every registered benchmark and writes one JSON document describing
+// the results to stdout.  Returns the exit code of the benchmark binary.
+inline int QuicheRunBenchmarks(int argc, char** argv) {
+  return QuicheRunBenchmarksImpl(argc, argv);
+}
+
+}  // namespace quiche
+
+// Registers |func|, of signature void(quiche::QuicheBenchmarkState&), to be
+// run by QuicheRunBenchmarks().
+#define QUICHE_BENCHMARK(func) QUICHE_BENCHMARK_IMPL(func)
+
+// Defines the main() of a benchmark binary.
+#define QUICHE_BENCHMARK_MAIN() QUICHE_BENCHMARK_MAIN_IMPL()
+
+#endif  // QUICHE_COMMON_PLATFORM_API_QUICHE_BENCHMARK_H_
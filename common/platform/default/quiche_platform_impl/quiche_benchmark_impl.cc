@@ -0,0 +1,118 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quiche_platform_impl/quiche_benchmark_impl.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace quiche {
+namespace {
+
+// Minimum wall time each benchmark runs for.
+constexpr int64_t kMinRunTimeNs = INT64_C(500) * 1000 * 1000;
+
+// How many iterations pass between clock reads.  Power of two.
+constexpr int64_t kClockCheckInterval = 1024;
+
+int64_t NowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+struct RegisteredBenchmark {
+  const char* name;
+  QuicheBenchmarkFunction func;
+};
+
+std::vector<RegisteredBenchmark>* Registry() {
+  static std::vector<RegisteredBenchmark>* registry =
+      new std::vector<RegisteredBenchmark>();
+  return registry;
+}
+
+}  // namespace
+
+bool QuicheBenchmarkStateImpl::KeepRunning() {
+  if (iterations_ == 0) {
+    start_ns_ = NowNs();
+    ++iterations_;
+    return true;
+  }
+  if (iterations_ % kClockCheckInterval != 0) {
+    ++iterations_;
+    return true;
+  }
+  const int64_t elapsed = NowNs() - start_ns_;
+  if (elapsed < kMinRunTimeNs) {
+    ++iterations_;
+    return true;
+  }
+  elapsed_ns_ = elapsed;
+  return false;
+}
+
+void QuicheBenchmarkStateImpl::SetCounter(const char* name, int64_t value) {
+  for (auto& counter : counters_) {
+    if (strcmp(counter.first, name) == 0) {
+      counter.second = value;
+      return;
+    }
+  }
+  counters_.emplace_back(name, value);
+}
+
+int QuicheRegisterBenchmarkImpl(const char* name,
+                                QuicheBenchmarkFunction func) {
+  Registry()->push_back({name, func});
+  return static_cast<int>(Registry()->size()) - 1;
+}
+
+int QuicheRunBenchmarksImpl(int argc, char** argv) {
+  const char* filter = argc > 1 ? argv[1] : nullptr;
+  printf("{\"benchmarks\": [\n");
+  bool first = true;
+  for (const RegisteredBenchmark& benchmark : *Registry()) {
+    if (filter != nullptr && strstr(benchmark.name, filter) == nullptr) {
+      continue;
+    }
+    QuicheBenchmarkStateImpl state;
+    benchmark.func(state);
+    if (!first) {
+      printf(",\n");
+    }
+    first = false;
+    const double ns_per_iteration =
+        state.iterations() > 0
+            ? static_cast<double>(state.elapsed_ns()) / state.iterations()
+            : 0.0;
+    printf("  {\"name\": \"%s\", \"iterations\": %lld, "
+           "\"ns_per_iteration\": %.2f",
+           benchmark.name, static_cast<long long>(state.iterations()),
+           ns_per_iteration);
+    if (state.bytes_processed() > 0 && state.elapsed_ns() > 0) {
+      printf(", \"bytes_per_second\": %.0f",
+             static_cast<double>(state.bytes_processed()) * 1e9 /
+                 static_cast<double>(state.elapsed_ns()));
+    }
+    if (!state.counters().empty()) {
+      printf(", \"counters\": {");
+      bool first_counter = true;
+      for (const auto& counter : state.counters()) {
+        printf("%s\"%s\": %lld", first_counter ? "" : ", ", counter.first,
+               static_cast<long long>(counter.second));
+        first_counter = false;
+      }
+      printf("}");
+    }
+    printf("}");
+  }
+  printf("\n]}\n");
+  return 0;
+}
+
+}  // namespace quiche
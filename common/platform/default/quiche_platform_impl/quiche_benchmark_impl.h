@@ -0,0 +1,73 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_COMMON_PLATFORM_DEFAULT_QUICHE_PLATFORM_IMPL_QUICHE_BENCHMARK_IMPL_H_
+#define QUICHE_COMMON_PLATFORM_DEFAULT_QUICHE_PLATFORM_IMPL_QUICHE_BENCHMARK_IMPL_H_
+
+// A dependency-free benchmark runner.  Platforms with google-benchmark
+// available can replace this implementation with aliases into it; the API
+// surface used by quiche benchmarks is kept to a compatible subset.
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace quiche {
+
+class QuicheBenchmarkStateImpl {
+ public:
+  // Returns true while the benchmark body should keep iterating.  Wall time
+  // is measured from the first call; the loop runs until a minimum run time
+  // has elapsed, checking the clock only once every power-of-two number of
+  // iterations so the check itself stays off the measured path.
+  bool KeepRunning();
+
+  // Declares the total number of bytes processed by all iterations, for
+  // throughput reporting.  Typically called after the loop as
+  // SetBytesProcessed(state.iterations() * bytes_per_iteration).
+  void SetBytesProcessed(int64_t bytes) { bytes_processed_ = bytes; }
+
+  // Attaches a named counter to the benchmark's result line.  Counters carry
+  // statistics the benchmark body gathers itself (e.g. allocation counts);
+  // the runner reports them verbatim.  |name| must outlive the state, so pass
+  // a string literal.  Setting an existing name overwrites its value.
+  void SetCounter(const char* name, int64_t value);
+
+  int64_t iterations() const { return iterations_; }
+  int64_t elapsed_ns() const { return elapsed_ns_; }
+  int64_t bytes_processed() const { return bytes_processed_; }
+  const std::vector<std::pair<const char*, int64_t>>& counters() const {
+    return counters_;
+  }
+
+ private:
+  int64_t iterations_ = 0;
+  int64_t elapsed_ns_ = 0;
+  int64_t bytes_processed_ = 0;
+  int64_t start_ns_ = 0;
+  std::vector<std::pair<const char*, int64_t>> counters_;
+};
+
+using QuicheBenchmarkFunction = void (*)(QuicheBenchmarkStateImpl&);
+
+// Adds a benchmark to the global registry.  Returns its index, so that the
+// registration macro has a constant to initialize.
+int QuicheRegisterBenchmarkImpl(const char* name, QuicheBenchmarkFunction func);
+
+// Runs all registered benchmarks, or only those whose name contains
+// argv[1] when given, and prints one JSON document to stdout.
+int QuicheRunBenchmarksImpl(int argc, char** argv);
+
+}  // namespace quiche
+
+#define QUICHE_BENCHMARK_IMPL(func)                     \
+  static const int quiche_benchmark_registered_##func = \
+      ::quiche::QuicheRegisterBenchmarkImpl(#func, func)
+
+#define QUICHE_BENCHMARK_MAIN_IMPL()                      \
+  int main(int argc, char** argv) {                       \
+    return ::quiche::QuicheRunBenchmarksImpl(argc, argv); \
+  }
+
+#endif  // QUICHE_COMMON_PLATFORM_DEFAULT_QUICHE_PLATFORM_IMPL_QUICHE_BENCHMARK_IMPL_H_
@@ -5,17 +5,16 @@
 #ifndef QUICHE_COMMON_PLATFORM_DEFAULT_QUICHE_PLATFORM_IMPL_QUICHE_CONTAINERS_IMPL_H_
 #define QUICHE_COMMON_PLATFORM_DEFAULT_QUICHE_PLATFORM_IMPL_QUICHE_CONTAINERS_IMPL_H_
 
-#pragma clang diagnostic push
-#pragma clang diagnostic ignored "-Weverything"
-
-#include "absl/container/btree_set.h"
-
-#pragma clang diagnostic pop
+#include "common/quiche_small_ordered_set.h"
 
 namespace quiche {
 
+// Two-tier sorted-vector layout: sets of up to 8 elements live inline with
+// no heap allocation, which covers the interval set of virtually every ack
+// frame, and large sets spill into page-sized nodes so ack tracking of huge
+// reordered transfers avoids whole-set shifts.
 template <typename Key, typename Compare>
-using QuicheSmallOrderedSetImpl = absl::btree_set<Key, Compare>;
+using QuicheSmallOrderedSetImpl = QuicheSmallOrderedSet<Key, Compare>;
 
 }  // namespace quiche
 
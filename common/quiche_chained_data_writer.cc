@@ -0,0 +1,147 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "common/quiche_chained_data_writer.h"
+
+#include <algorithm>
+
+#include "common/platform/api/quiche_logging.h"
+
+namespace quiche {
+
+QuicheChainedDataWriter::QuicheChainedDataWriter(size_t block_size)
+    : QuicheChainedDataWriter(block_size, quiche::NETWORK_BYTE_ORDER) {}
+
+QuicheChainedDataWriter::QuicheChainedDataWriter(size_t block_size,
+                                                 quiche::Endianness endianness)
+    : block_size_(block_size), endianness_(endianness) {
+  QUICHE_DCHECK_GT(block_size, 0u);
+}
+
+QuicheChainedDataWriter::~QuicheChainedDataWriter() = default;
+
+size_t QuicheChainedDataWriter::total_length() const {
+  return sealed_length_ +
+         (current_writer_.has_value() ? current_writer_->length() : 0);
+}
+
+bool QuicheChainedDataWriter::WriteUInt8(uint8_t value) {
+  return EnsureRoom(sizeof(value)) && current_writer_->WriteUInt8(value);
+}
+
+bool QuicheChainedDataWriter::WriteUInt16(uint16_t value) {
+  return EnsureRoom(sizeof(value)) && current_writer_->WriteUInt16(value);
+}
+
+bool QuicheChainedDataWriter::WriteUInt32(uint32_t value) {
+  return EnsureRoom(sizeof(value)) && current_writer_->WriteUInt32(value);
+}
+
+bool QuicheChainedDataWriter::WriteUInt64(uint64_t value) {
+  return EnsureRoom(sizeof(value)) && current_writer_->WriteUInt64(value);
+}
+
+bool QuicheChainedDataWriter::WriteBytesToUInt64(size_t num_bytes,
+                                                 uint64_t value) {
+  return EnsureRoom(num_bytes) &&
+         current_writer_->WriteBytesToUInt64(num_bytes, value);
+}
+
+bool QuicheChainedDataWriter::WriteStringPiece(absl::string_view val) {
+  return WriteBytes(val.data(), val.size());
+}
+
+bool QuicheChainedDataWriter::WriteStringPiece16(absl::string_view val) {
+  if (val.size() > std::numeric_limits<uint16_t>::max()) {
+    return false;
+  }
+  return EnsureRoom(sizeof(uint16_t) + val.size()) &&
+         current_writer_->WriteStringPiece16(val);
+}
+
+bool QuicheChainedDataWriter::WriteBytes(const void* data, size_t data_len) {
+  if (data_len == 0) {
+    return true;
+  }
+  return EnsureRoom(data_len) && current_writer_->WriteBytes(data, data_len);
+}
+
+bool QuicheChainedDataWriter::WriteRepeatedByte(uint8_t byte, size_t count) {
+  if (count == 0) {
+    return true;
+  }
+  return EnsureRoom(count) && current_writer_->WriteRepeatedByte(byte, count);
+}
+
+bool QuicheChainedDataWriter::WriteTag(uint32_t tag) {
+  return EnsureRoom(sizeof(tag)) && current_writer_->WriteTag(tag);
+}
+
+bool QuicheChainedDataWriter::WriteBorrowedBytes(absl::string_view data) {
+  if (data.empty()) {
+    return true;
+  }
+  SealCurrentSegment();
+  segments_.push_back(data);
+  sealed_length_ += data.size();
+  return true;
+}
+
+char* QuicheChainedDataWriter::ReserveBytes(size_t length) {
+  if (length == 0 || !EnsureRoom(length)) {
+    return nullptr;
+  }
+  char* reserved = current_writer_->data() + current_writer_->length();
+  if (!current_writer_->Seek(length)) {
+    return nullptr;
+  }
+  return reserved;
+}
+
+const std::vector<absl::string_view>& QuicheChainedDataWriter::segments() {
+  SealCurrentSegment();
+  return segments_;
+}
+
+std::string QuicheChainedDataWriter::AsString() {
+  std::string result;
+  result.reserve(total_length());
+  for (absl::string_view segment : segments()) {
+    result.append(segment.data(), segment.size());
+  }
+  return result;
+}
+
+void QuicheChainedDataWriter::SealCurrentSegment() {
+  if (!current_writer_.has_value()) {
+    return;
+  }
+  const size_t written = current_writer_->length();
+  const size_t remaining = current_writer_->remaining();
+  if (written > 0) {
+    segments_.push_back(absl::string_view(current_base_, written));
+    sealed_length_ += written;
+  }
+  current_writer_.reset();
+  if (remaining > 0) {
+    // Subsequent small writes continue in the unused tail of the block, as a
+    // new segment.
+    current_base_ += written;
+    current_writer_.emplace(remaining, current_base_, endianness_);
+  }
+}
+
+bool QuicheChainedDataWriter::EnsureRoom(size_t length) {
+  if (current_writer_.has_value() && current_writer_->remaining() >= length) {
+    return true;
+  }
+  SealCurrentSegment();
+  const size_t block_size = std::max(block_size_, length);
+  blocks_.push_back(std::make_unique<char[]>(block_size));
+  current_base_ = blocks_.back().get();
+  current_writer_.emplace(block_size, current_base_, endianness_);
+  return true;
+}
+
+}  // namespace quiche
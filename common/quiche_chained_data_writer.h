@@ -0,0 +1,110 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_COMMON_QUICHE_CHAINED_DATA_WRITER_H_
+#define QUICHE_COMMON_QUICHE_CHAINED_DATA_WRITER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+#include "common/platform/api/quiche_export.h"
+#include "common/quiche_data_writer.h"
+#include "common/quiche_endian.h"
+
+namespace quiche {
+
+// A writer with the QuicheDataWriter appending API that serializes into a
+// chain of segments instead of one contiguous buffer. Small writes land in
+// scratch blocks owned by the writer; large payloads that already live in
+// caller-owned memory are appended by reference with WriteBorrowedBytes(),
+// without copying a byte. The resulting chain can be handed to scattered I/O
+// (e.g. converted to iovecs for a batch writer) via segments().
+//
+// Typical use is emitting frame headers around payloads: write the header
+// with the Write* methods, append the payload as a borrowed slice, and repeat.
+// Borrowed slices must outlive the writer's last use of segments().
+class QUICHE_EXPORT_PRIVATE QuicheChainedDataWriter {
+ public:
+  // Creates a writer whose scratch blocks hold |block_size| bytes, using
+  // NETWORK_BYTE_ORDER endianness.
+  explicit QuicheChainedDataWriter(size_t block_size);
+  QuicheChainedDataWriter(size_t block_size, quiche::Endianness endianness);
+  QuicheChainedDataWriter(const QuicheChainedDataWriter&) = delete;
+  QuicheChainedDataWriter& operator=(const QuicheChainedDataWriter&) = delete;
+
+  ~QuicheChainedDataWriter();
+
+  // Total number of bytes written so far, across all segments.
+  size_t total_length() const;
+
+  // Methods for appending to the chain. These mirror QuicheDataWriter and
+  // only fail if scratch allocation sizes overflow, so in practice they
+  // always succeed; the bool returns keep the two APIs interchangeable.
+  bool WriteUInt8(uint8_t value);
+  bool WriteUInt16(uint16_t value);
+  bool WriteUInt32(uint32_t value);
+  bool WriteUInt64(uint64_t value);
+  bool WriteBytesToUInt64(size_t num_bytes, uint64_t value);
+  bool WriteStringPiece(absl::string_view val);
+  bool WriteStringPiece16(absl::string_view val);
+  bool WriteBytes(const void* data, size_t data_len);
+  bool WriteRepeatedByte(uint8_t byte, size_t count);
+  bool WriteTag(uint32_t tag);
+
+  // Appends |data| to the chain by reference. The caller keeps ownership and
+  // must keep the bytes alive and unchanged for as long as the chain is used;
+  // no copy is made.
+  bool WriteBorrowedBytes(absl::string_view data);
+
+  // Reserves |length| contiguous scratch bytes at the end of the chain and
+  // returns a pointer to them, advancing the writer past the reservation.
+  // Lets callers emit encodings this class does not mirror (e.g. variable
+  // length integers) by wrapping the span in their own data writer.
+  char* ReserveBytes(size_t length);
+
+  // Seals any segment under construction and returns the chain, in order.
+  // Scratch segments point into memory owned by this writer; borrowed
+  // segments are returned exactly as appended. The result is invalidated by
+  // any subsequent write.
+  const std::vector<absl::string_view>& segments();
+
+  // Copies the chain into one contiguous string. Mainly useful for tests and
+  // for callers that need a contiguous fallback.
+  std::string AsString();
+
+ private:
+  // Seals the segment currently being written, if any, and positions the
+  // writer over whatever scratch remains in the current block.
+  void SealCurrentSegment();
+
+  // Ensures the current scratch writer has at least |length| bytes of room,
+  // opening a new block if needed.
+  bool EnsureRoom(size_t length);
+
+  const size_t block_size_;
+  const quiche::Endianness endianness_;
+
+  // Scratch blocks backing the owned segments.
+  std::vector<std::unique_ptr<char[]>> blocks_;
+
+  // Sealed segments, in write order.
+  std::vector<absl::string_view> segments_;
+
+  // Bytes covered by |segments_|.
+  size_t sealed_length_ = 0;
+
+  // Start of the segment currently being written, and a writer over the
+  // scratch space from there to the end of the current block.
+  char* current_base_ = nullptr;
+  absl::optional<QuicheDataWriter> current_writer_;
+};
+
+}  // namespace quiche
+
+#endif  // QUICHE_COMMON_QUICHE_CHAINED_DATA_WRITER_H_
@@ -0,0 +1,106 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "common/quiche_chained_data_writer.h"
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "common/platform/api/quiche_test.h"
+#include "common/quiche_endian.h"
+
+namespace quiche {
+namespace test {
+namespace {
+
+class QuicheChainedDataWriterTest : public QuicheTest {};
+
+TEST_F(QuicheChainedDataWriterTest, SmallWritesShareOneSegment) {
+  QuicheChainedDataWriter writer(/*block_size=*/64);
+  EXPECT_TRUE(writer.WriteUInt8(0x01));
+  EXPECT_TRUE(writer.WriteUInt16(0x0203));
+  EXPECT_TRUE(writer.WriteUInt32(0x04050607));
+  EXPECT_EQ(7u, writer.total_length());
+
+  const std::vector<absl::string_view>& segments = writer.segments();
+  ASSERT_EQ(1u, segments.size());
+  EXPECT_EQ(absl::string_view("\x01\x02\x03\x04\x05\x06\x07", 7), segments[0]);
+}
+
+TEST_F(QuicheChainedDataWriterTest, BorrowedBytesAreNotCopied) {
+  const std::string payload(1024, 'p');
+  QuicheChainedDataWriter writer(/*block_size=*/16);
+  EXPECT_TRUE(writer.WriteUInt16(0x1234));
+  EXPECT_TRUE(writer.WriteBorrowedBytes(payload));
+  EXPECT_TRUE(writer.WriteUInt8(0x56));
+  EXPECT_EQ(2u + payload.size() + 1u, writer.total_length());
+
+  const std::vector<absl::string_view>& segments = writer.segments();
+  ASSERT_EQ(3u, segments.size());
+  // The middle segment aliases the caller's buffer.
+  EXPECT_EQ(payload.data(), segments[1].data());
+  EXPECT_EQ(payload.size(), segments[1].size());
+  // The surrounding header segments are scratch owned by the writer.
+  EXPECT_EQ(absl::string_view("\x12\x34", 2), segments[0]);
+  EXPECT_EQ(absl::string_view("\x56", 1), segments[2]);
+}
+
+TEST_F(QuicheChainedDataWriterTest, HeaderAfterBorrowReusesBlockTail) {
+  const std::string payload = "payload";
+  QuicheChainedDataWriter writer(/*block_size=*/64);
+  EXPECT_TRUE(writer.WriteUInt8(0x01));
+  EXPECT_TRUE(writer.WriteBorrowedBytes(payload));
+  EXPECT_TRUE(writer.WriteUInt8(0x02));
+
+  const std::vector<absl::string_view>& segments = writer.segments();
+  ASSERT_EQ(3u, segments.size());
+  // Both one-byte headers fit in the same scratch block, back to back.
+  EXPECT_EQ(segments[0].data() + segments[0].size(), segments[2].data());
+}
+
+TEST_F(QuicheChainedDataWriterTest, WritesLargerThanBlockSize) {
+  const std::string big(100, 'b');
+  QuicheChainedDataWriter writer(/*block_size=*/16);
+  EXPECT_TRUE(writer.WriteStringPiece(big));
+  EXPECT_EQ(big, writer.AsString());
+  EXPECT_EQ(1u, writer.segments().size());
+}
+
+TEST_F(QuicheChainedDataWriterTest, ReserveBytes) {
+  QuicheChainedDataWriter writer(/*block_size=*/32);
+  EXPECT_TRUE(writer.WriteUInt8(0xaa));
+  char* reserved = writer.ReserveBytes(2);
+  ASSERT_NE(nullptr, reserved);
+  EXPECT_TRUE(writer.WriteUInt8(0xdd));
+  // Reserved bytes can be filled in after later writes.
+  reserved[0] = '\xbb';
+  reserved[1] = '\xcc';
+  EXPECT_EQ(std::string("\xaa\xbb\xcc\xdd", 4), writer.AsString());
+}
+
+TEST_F(QuicheChainedDataWriterTest, HostByteOrder) {
+  QuicheChainedDataWriter writer(/*block_size=*/8, quiche::HOST_BYTE_ORDER);
+  EXPECT_TRUE(writer.WriteUInt16(0x1122));
+  uint16_t in_memory = 0x1122;
+  std::string actual = writer.AsString();
+  ASSERT_EQ(sizeof(in_memory), actual.size());
+  EXPECT_EQ(0, memcmp(&in_memory, actual.data(), sizeof(in_memory)));
+}
+
+TEST_F(QuicheChainedDataWriterTest, EmptyAndRepeatedWrites) {
+  QuicheChainedDataWriter writer(/*block_size=*/8);
+  EXPECT_TRUE(writer.WriteBorrowedBytes(absl::string_view()));
+  EXPECT_TRUE(writer.WriteBytes(nullptr, 0));
+  EXPECT_EQ(0u, writer.total_length());
+  EXPECT_TRUE(writer.segments().empty());
+
+  EXPECT_TRUE(writer.WriteRepeatedByte(0x00, 3));
+  EXPECT_EQ(std::string(3, '\0'), writer.AsString());
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quiche
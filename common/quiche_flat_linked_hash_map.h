@@ -0,0 +1,483 @@
+// Copyright (c) 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// A flat, insertion-ordered map with the same API surface as
+// QuicheLinkedHashMap.  Entries live in one contiguous slab with intrusive
+// insertion-order links, and lookups go through an open-addressing slot table
+// of 4-byte indices, so a map entry costs two small arrays instead of a list
+// node plus a node_hash_map node, and full-map iteration walks memory
+// linearly.
+//
+// Erasing leaves a tombstone in the slab; tombstones are compacted away the
+// next time the slot table is rebuilt on insertion.  Compaction renumbers
+// entries, so unlike QuicheLinkedHashMap, iterators are invalidated by
+// insertions (but not by erasing other elements).  Each iterator carries the
+// map's generation count at the time it was obtained, and dereferencing or
+// advancing a stale iterator fails a QUICHE_DCHECK in debug builds.
+//
+// A second divergence from QuicheLinkedHashMap: because compaction relocates
+// entries, Key and Value must be move-constructible.
+//
+// This class provides no thread safety guarantees.
+
+#ifndef QUICHE_COMMON_QUICHE_FLAT_LINKED_HASH_MAP_H_
+#define QUICHE_COMMON_QUICHE_FLAT_LINKED_HASH_MAP_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "absl/hash/hash.h"
+#include "absl/types/optional.h"
+#include "common/platform/api/quiche_export.h"
+#include "common/platform/api/quiche_logging.h"
+
+namespace quiche {
+
+// QUICHE_NO_EXPORT comments suppress erroneous presubmit failures.
+template <class Key,                      // QUICHE_NO_EXPORT
+          class Value,                    // QUICHE_NO_EXPORT
+          class Hash = absl::Hash<Key>,   // QUICHE_NO_EXPORT
+          class Eq = std::equal_to<Key>>  // QUICHE_NO_EXPORT
+class QuicheFlatLinkedHashMap {           // QUICHE_NO_EXPORT
+ public:
+  typedef Key key_type;
+  typedef std::pair<Key, Value> value_type;
+  typedef size_t size_type;
+
+ private:
+  // Marks an absent entry index: the end() iterator, a link off either end of
+  // the insertion order, and a lookup miss.
+  static constexpr uint32_t kInvalidIndex =
+      std::numeric_limits<uint32_t>::max();
+  // Slot table sentinels.  Entry indices above kDeletedSlot are never used.
+  static constexpr uint32_t kEmptySlot = std::numeric_limits<uint32_t>::max();
+  static constexpr uint32_t kDeletedSlot = kEmptySlot - 1;
+  static constexpr size_t kInitialSlots = 16;
+
+  struct Entry {
+    // Disengaged for tombstones.
+    absl::optional<value_type> kv;
+    // Insertion-order links; indices into entries_.
+    uint32_t prev = kInvalidIndex;
+    uint32_t next = kInvalidIndex;
+  };
+
+  template <bool kConst>
+  class IteratorImpl {
+   public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = QuicheFlatLinkedHashMap::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<kConst, const value_type*, value_type*>;
+    using reference = std::conditional_t<kConst, const value_type&,
+                                         value_type&>;
+
+    IteratorImpl() = default;
+
+    // Conversion from iterator to const_iterator.
+    template <bool kOtherConst,
+              typename = std::enable_if_t<kConst && !kOtherConst>>
+    IteratorImpl(const IteratorImpl<kOtherConst>& other)  // NOLINT
+        : map_(other.map_),
+          index_(other.index_),
+          generation_(other.generation_) {}
+
+    reference operator*() const {
+      QUICHE_DCHECK(IsCurrent());
+      QUICHE_DCHECK_NE(index_, kInvalidIndex);
+      return *map_->entries_[index_].kv;
+    }
+    pointer operator->() const { return &operator*(); }
+
+    IteratorImpl& operator++() {
+      QUICHE_DCHECK(IsCurrent());
+      QUICHE_DCHECK_NE(index_, kInvalidIndex);
+      index_ = map_->entries_[index_].next;
+      return *this;
+    }
+    IteratorImpl operator++(int) {
+      IteratorImpl it = *this;
+      ++*this;
+      return it;
+    }
+    IteratorImpl& operator--() {
+      QUICHE_DCHECK(IsCurrent());
+      index_ = index_ == kInvalidIndex ? map_->tail_
+                                       : map_->entries_[index_].prev;
+      QUICHE_DCHECK_NE(index_, kInvalidIndex);
+      return *this;
+    }
+    IteratorImpl operator--(int) {
+      IteratorImpl it = *this;
+      --*this;
+      return it;
+    }
+
+    friend bool operator==(const IteratorImpl& a, const IteratorImpl& b) {
+      return a.map_ == b.map_ && a.index_ == b.index_;
+    }
+    friend bool operator!=(const IteratorImpl& a, const IteratorImpl& b) {
+      return !(a == b);
+    }
+
+   private:
+    friend class QuicheFlatLinkedHashMap;
+    template <bool>
+    friend class IteratorImpl;
+
+    using MapPointer = std::conditional_t<kConst,
+                                          const QuicheFlatLinkedHashMap*,
+                                          QuicheFlatLinkedHashMap*>;
+
+    IteratorImpl(MapPointer map, uint32_t index)
+        : map_(map), index_(index), generation_(map->generation_) {}
+
+    // False once the map has compacted its slab since this iterator was
+    // obtained; entry indices are renumbered by compaction.
+    bool IsCurrent() const {
+      return map_ != nullptr && generation_ == map_->generation_;
+    }
+
+    MapPointer map_ = nullptr;
+    uint32_t index_ = kInvalidIndex;
+    uint64_t generation_ = 0;
+  };
+
+ public:
+  typedef IteratorImpl<false> iterator;
+  typedef IteratorImpl<true> const_iterator;
+  typedef std::reverse_iterator<iterator> reverse_iterator;
+  typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+  QuicheFlatLinkedHashMap() = default;
+  explicit QuicheFlatLinkedHashMap(size_type bucket_count) {
+    Rebuild(NormalizeSlotCount(bucket_count));
+  }
+
+  QuicheFlatLinkedHashMap(const QuicheFlatLinkedHashMap& other) = delete;
+  QuicheFlatLinkedHashMap& operator=(const QuicheFlatLinkedHashMap& other) =
+      delete;
+  // Moved-from maps are left empty.
+  QuicheFlatLinkedHashMap(QuicheFlatLinkedHashMap&& other)
+      : entries_(std::move(other.entries_)),
+        slots_(std::move(other.slots_)),
+        head_(other.head_),
+        tail_(other.tail_),
+        size_(other.size_),
+        num_tombstones_(other.num_tombstones_) {
+    other.clear();
+  }
+  QuicheFlatLinkedHashMap& operator=(QuicheFlatLinkedHashMap&& other) {
+    entries_ = std::move(other.entries_);
+    slots_ = std::move(other.slots_);
+    head_ = other.head_;
+    tail_ = other.tail_;
+    size_ = other.size_;
+    num_tombstones_ = other.num_tombstones_;
+    ++generation_;
+    other.clear();
+    return *this;
+  }
+
+  // Returns an iterator to the first (insertion-ordered) element.  Like a
+  // map, this can be dereferenced to a pair<Key, Value>.
+  iterator begin() { return iterator(this, head_); }
+  const_iterator begin() const { return const_iterator(this, head_); }
+
+  // Returns an iterator beyond the last element.
+  iterator end() { return iterator(this, kInvalidIndex); }
+  const_iterator end() const { return const_iterator(this, kInvalidIndex); }
+
+  reverse_iterator rbegin() { return reverse_iterator(end()); }
+  const_reverse_iterator rbegin() const {
+    return const_reverse_iterator(end());
+  }
+
+  reverse_iterator rend() { return reverse_iterator(begin()); }
+  const_reverse_iterator rend() const {
+    return const_reverse_iterator(begin());
+  }
+
+  // Returns the earliest-inserted element.
+  const value_type& front() const { return *entries_[head_].kv; }
+  value_type& front() { return *entries_[head_].kv; }
+
+  // Returns the most-recently-inserted element.
+  const value_type& back() const { return *entries_[tail_].kv; }
+  value_type& back() { return *entries_[tail_].kv; }
+
+  // Clears the map of all values.
+  void clear() {
+    entries_.clear();
+    slots_.clear();
+    head_ = tail_ = kInvalidIndex;
+    size_ = 0;
+    num_tombstones_ = 0;
+    ++generation_;
+  }
+
+  // Returns true iff the map is empty.
+  bool empty() const { return size_ == 0; }
+
+  // Removes the first element from the insertion order.
+  void pop_front() { erase(begin()); }
+
+  // Erases values with the provided key.  Returns the number of elements
+  // erased.  In this implementation, this will be 0 or 1.
+  size_type erase(const Key& key) {
+    iterator it = find(key);
+    if (it == end()) {
+      return 0;
+    }
+    erase(it);
+    return 1;
+  }
+
+  // Erases the item that 'position' points to.  Returns an iterator that
+  // points to the item that comes immediately after the deleted item in the
+  // insertion order, or end().  If the provided iterator is invalid, a
+  // QUICHE_CHECK() error will occur.
+  iterator erase(iterator position) {
+    QUICHE_CHECK(position.map_ == this && position.IsCurrent() &&
+                 position.index_ != kInvalidIndex &&
+                 entries_[position.index_].kv.has_value())
+        << "The iterator is invalid.";
+    Entry& entry = entries_[position.index_];
+    const uint32_t next = entry.next;
+    EraseSlotFor(entry.kv->first, position.index_);
+    if (entry.prev != kInvalidIndex) {
+      entries_[entry.prev].next = entry.next;
+    } else {
+      head_ = entry.next;
+    }
+    if (entry.next != kInvalidIndex) {
+      entries_[entry.next].prev = entry.prev;
+    } else {
+      tail_ = entry.prev;
+    }
+    // The tombstone keeps its slab index until the next compaction, so other
+    // outstanding iterators stay valid; the value is destroyed now.
+    entry.kv.reset();
+    ++num_tombstones_;
+    --size_;
+    return iterator(this, next);
+  }
+
+  // Erases all the items in the range [first, last).  Returns an iterator
+  // that points to the item that comes immediately after the last deleted
+  // item, or end().
+  iterator erase(iterator first, iterator last) {
+    while (first != last && first != end()) {
+      first = erase(first);
+    }
+    return first;
+  }
+
+  // Finds the element with the given key.  Returns an iterator to the value
+  // found, or to end() if the value was not found.  Like a map, this iterator
+  // points to a pair<Key, Value>.
+  iterator find(const Key& key) {
+    return iterator(this, FindEntryIndex(key));
+  }
+
+  const_iterator find(const Key& key) const {
+    return const_iterator(this, FindEntryIndex(key));
+  }
+
+  bool contains(const Key& key) const { return find(key) != end(); }
+
+  // Returns the value mapped to key, inserting a default-constructed value if
+  // the key was absent.
+  Value& operator[](const key_type& key) {
+    return (*((this->insert(std::make_pair(key, Value()))).first)).second;
+  }
+
+  // Inserts an element into the map.
+  std::pair<iterator, bool> insert(const std::pair<Key, Value>& pair) {
+    return InsertInternal(pair);
+  }
+
+  // Inserts an element into the map.
+  std::pair<iterator, bool> insert(std::pair<Key, Value>&& pair) {
+    return InsertInternal(std::move(pair));
+  }
+
+  size_type size() const { return size_; }
+
+  template <typename... Args>
+  std::pair<iterator, bool> emplace(Args&&... args) {
+    value_type node(std::forward<Args>(args)...);
+    return InsertInternal(std::move(node));
+  }
+
+  void swap(QuicheFlatLinkedHashMap& other) {
+    entries_.swap(other.entries_);
+    slots_.swap(other.slots_);
+    std::swap(head_, other.head_);
+    std::swap(tail_, other.tail_);
+    std::swap(size_, other.size_);
+    std::swap(num_tombstones_, other.num_tombstones_);
+    ++generation_;
+    ++other.generation_;
+  }
+
+ private:
+  template <typename U>
+  std::pair<iterator, bool> InsertInternal(U&& pair) {
+    const uint32_t existing = FindEntryIndex(pair.first);
+    if (existing != kInvalidIndex) {
+      return {iterator(this, existing), false};
+    }
+    EnsureSpaceForInsert();
+    const uint32_t index = static_cast<uint32_t>(entries_.size());
+    entries_.emplace_back();
+    Entry& entry = entries_.back();
+    entry.kv.emplace(std::forward<U>(pair));
+    entry.prev = tail_;
+    if (tail_ != kInvalidIndex) {
+      entries_[tail_].next = index;
+    } else {
+      head_ = index;
+    }
+    tail_ = index;
+    StoreSlot(entry.kv->first, index);
+    ++size_;
+    return {iterator(this, index), true};
+  }
+
+  // Returns the slab index of the entry with |key|, or kInvalidIndex.
+  uint32_t FindEntryIndex(const Key& key) const {
+    if (slots_.empty()) {
+      return kInvalidIndex;
+    }
+    const size_t mask = slots_.size() - 1;
+    size_t slot = Hash()(key) & mask;
+    // Triangular probing visits every slot of a power-of-two table.
+    for (size_t step = 1; step <= slots_.size(); ++step) {
+      const uint32_t stored = slots_[slot];
+      if (stored == kEmptySlot) {
+        return kInvalidIndex;
+      }
+      if (stored != kDeletedSlot && Eq()(entries_[stored].kv->first, key)) {
+        return stored;
+      }
+      slot = (slot + step) & mask;
+    }
+    return kInvalidIndex;
+  }
+
+  // Writes |index| into the first free slot of |key|'s probe sequence.  The
+  // caller guarantees the key is absent and the table has a free slot.
+  void StoreSlot(const Key& key, uint32_t index) {
+    const size_t mask = slots_.size() - 1;
+    size_t slot = Hash()(key) & mask;
+    for (size_t step = 1;; ++step) {
+      if (slots_[slot] == kEmptySlot || slots_[slot] == kDeletedSlot) {
+        slots_[slot] = index;
+        return;
+      }
+      slot = (slot + step) & mask;
+    }
+  }
+
+  // Replaces the slot holding |index| with a tombstone, so later probes for
+  // other keys keep walking past it.
+  void EraseSlotFor(const Key& key, uint32_t index) {
+    const size_t mask = slots_.size() - 1;
+    size_t slot = Hash()(key) & mask;
+    for (size_t step = 1;; ++step) {
+      if (slots_[slot] == index) {
+        slots_[slot] = kDeletedSlot;
+        return;
+      }
+      QUICHE_DCHECK_NE(slots_[slot], kEmptySlot);
+      slot = (slot + step) & mask;
+    }
+  }
+
+  // Keeps the slot table under 3/4 occupancy (live entries plus tombstones).
+  // When the threshold is hit, rebuilds: at double the slot count if live
+  // entries alone fill half the table, otherwise at the same size purely to
+  // shed tombstones and compact the slab.
+  void EnsureSpaceForInsert() {
+    if (slots_.empty()) {
+      Rebuild(kInitialSlots);
+      return;
+    }
+    if ((size_ + num_tombstones_ + 1) * 4 <= slots_.size() * 3) {
+      return;
+    }
+    const size_t new_slot_count =
+        (size_ + 1) * 2 >= slots_.size() ? slots_.size() * 2 : slots_.size();
+    Rebuild(new_slot_count);
+  }
+
+  // Rebuilds the slot table with |new_slot_count| slots and compacts the
+  // entry slab to insertion order, dropping tombstones.  Invalidates
+  // outstanding iterators by bumping the generation count.
+  void Rebuild(size_t new_slot_count) {
+    std::vector<Entry> old_entries = std::move(entries_);
+    const uint32_t old_head = head_;
+    entries_.clear();
+    entries_.reserve(size_ + 1);
+    slots_.assign(new_slot_count, kEmptySlot);
+    head_ = tail_ = kInvalidIndex;
+    num_tombstones_ = 0;
+    ++generation_;
+    for (uint32_t old_index = old_head; old_index != kInvalidIndex;
+         old_index = old_entries[old_index].next) {
+      Entry& old_entry = old_entries[old_index];
+      const uint32_t index = static_cast<uint32_t>(entries_.size());
+      entries_.emplace_back();
+      Entry& entry = entries_.back();
+      entry.kv.emplace(std::move(*old_entry.kv));
+      entry.prev = tail_;
+      if (tail_ != kInvalidIndex) {
+        entries_[tail_].next = index;
+      } else {
+        head_ = index;
+      }
+      tail_ = index;
+      StoreSlot(entry.kv->first, index);
+    }
+  }
+
+  // Rounds a requested bucket count up to a power of two of at least
+  // kInitialSlots, as the probe sequence requires.
+  static size_t NormalizeSlotCount(size_type bucket_count) {
+    size_t slot_count = kInitialSlots;
+    while (slot_count < bucket_count) {
+      slot_count *= 2;
+    }
+    return slot_count;
+  }
+
+  // The entry slab.  Live entries and tombstones, in no particular order;
+  // compaction restores insertion order.
+  std::vector<Entry> entries_;
+
+  // Open-addressing table of indices into entries_.
+  std::vector<uint32_t> slots_;
+
+  // Insertion-order list endpoints; indices into entries_.
+  uint32_t head_ = kInvalidIndex;
+  uint32_t tail_ = kInvalidIndex;
+
+  size_t size_ = 0;
+  size_t num_tombstones_ = 0;
+
+  // Incremented whenever entry indices are renumbered; iterators snapshot
+  // this to detect staleness.
+  uint64_t generation_ = 0;
+};
+
+}  // namespace quiche
+
+#endif  // QUICHE_COMMON_QUICHE_FLAT_LINKED_HASH_MAP_H_
@@ -0,0 +1,274 @@
+// Copyright (c) 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Tests QuicheFlatLinkedHashMap.
+
+#include "common/quiche_flat_linked_hash_map.h"
+
+#include <memory>
+#include <utility>
+
+#include "common/platform/api/quiche_test.h"
+
+using testing::ElementsAre;
+using testing::Pair;
+using testing::Pointee;
+using testing::UnorderedElementsAre;
+
+namespace quiche {
+namespace test {
+
+// Tests that move constructor works.
+TEST(FlatLinkedHashMapTest, Move) {
+  // Use unique_ptr as an example of a non-copyable type.
+  QuicheFlatLinkedHashMap<int, std::unique_ptr<int>> m;
+  m[2] = std::make_unique<int>(12);
+  m[3] = std::make_unique<int>(13);
+  QuicheFlatLinkedHashMap<int, std::unique_ptr<int>> n = std::move(m);
+  EXPECT_THAT(n,
+              UnorderedElementsAre(Pair(2, Pointee(12)), Pair(3, Pointee(13))));
+  EXPECT_TRUE(m.empty());  // NOLINT(bugprone-use-after-move)
+}
+
+TEST(FlatLinkedHashMapTest, CanEmplaceMoveOnly) {
+  QuicheFlatLinkedHashMap<int, std::unique_ptr<int>> m;
+  struct Data {
+    int k, v;
+  };
+  const Data data[] = {{1, 123}, {3, 345}, {2, 234}, {4, 456}};
+  for (const auto& kv : data) {
+    m.emplace(std::piecewise_construct, std::make_tuple(kv.k),
+              std::make_tuple(new int{kv.v}));
+  }
+  EXPECT_TRUE(m.contains(2));
+  auto found = m.find(2);
+  ASSERT_TRUE(found != m.end());
+  EXPECT_EQ(234, *found->second);
+}
+
+TEST(FlatLinkedHashMapTest, Iteration) {
+  QuicheFlatLinkedHashMap<int, int> m;
+  m.insert(std::make_pair(2, 12));
+  m.insert(std::make_pair(1, 11));
+  m.insert(std::make_pair(3, 13));
+
+  // Iteration is in insertion order, not key order.
+  EXPECT_THAT(m, ElementsAre(Pair(2, 12), Pair(1, 11), Pair(3, 13)));
+}
+
+TEST(FlatLinkedHashMapTest, ReverseIteration) {
+  QuicheFlatLinkedHashMap<int, int> m;
+  m.insert(std::make_pair(2, 12));
+  m.insert(std::make_pair(1, 11));
+  m.insert(std::make_pair(3, 13));
+
+  auto it = m.rbegin();
+  EXPECT_EQ(3, it->first);
+  ++it;
+  EXPECT_EQ(1, it->first);
+  ++it;
+  EXPECT_EQ(2, it->first);
+  ++it;
+  EXPECT_TRUE(it == m.rend());
+}
+
+TEST(FlatLinkedHashMapTest, Clear) {
+  QuicheFlatLinkedHashMap<int, int> m;
+  m.insert(std::make_pair(2, 12));
+  m.insert(std::make_pair(1, 11));
+  m.clear();
+  EXPECT_TRUE(m.empty());
+  EXPECT_EQ(0u, m.size());
+  EXPECT_TRUE(m.begin() == m.end());
+  m.insert(std::make_pair(3, 13));
+  EXPECT_THAT(m, ElementsAre(Pair(3, 13)));
+}
+
+TEST(FlatLinkedHashMapTest, Size) {
+  QuicheFlatLinkedHashMap<int, int> m;
+  EXPECT_EQ(0u, m.size());
+  m.insert(std::make_pair(2, 12));
+  EXPECT_EQ(1u, m.size());
+  m.insert(std::make_pair(2, 12));  // Duplicate key; not inserted.
+  EXPECT_EQ(1u, m.size());
+  m.insert(std::make_pair(1, 11));
+  EXPECT_EQ(2u, m.size());
+  m.erase(2);
+  EXPECT_EQ(1u, m.size());
+}
+
+TEST(FlatLinkedHashMapTest, Erase) {
+  QuicheFlatLinkedHashMap<int, int> m;
+  m.insert(std::make_pair(2, 12));
+  m.insert(std::make_pair(1, 11));
+  m.insert(std::make_pair(3, 13));
+
+  EXPECT_EQ(0u, m.erase(4));  // Not in the map.
+  EXPECT_EQ(1u, m.erase(1));
+  EXPECT_THAT(m, ElementsAre(Pair(2, 12), Pair(3, 13)));
+  EXPECT_FALSE(m.contains(1));
+
+  // Erase through an iterator; the returned iterator points at the next
+  // element in insertion order.
+  auto it = m.find(2);
+  ASSERT_TRUE(it != m.end());
+  it = m.erase(it);
+  ASSERT_TRUE(it != m.end());
+  EXPECT_EQ(3, it->first);
+  EXPECT_THAT(m, ElementsAre(Pair(3, 13)));
+}
+
+TEST(FlatLinkedHashMapTest, EraseWhileIterating) {
+  QuicheFlatLinkedHashMap<int, int> m;
+  for (int i = 0; i < 8; ++i) {
+    m.insert(std::make_pair(i, 10 + i));
+  }
+  // Erase the even keys in one pass.
+  for (auto it = m.begin(); it != m.end();) {
+    if (it->first % 2 == 0) {
+      it = m.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  EXPECT_THAT(
+      m, ElementsAre(Pair(1, 11), Pair(3, 13), Pair(5, 15), Pair(7, 17)));
+}
+
+TEST(FlatLinkedHashMapTest, EraseRange) {
+  QuicheFlatLinkedHashMap<int, int> m;
+  for (int i = 0; i < 5; ++i) {
+    m.insert(std::make_pair(i, 10 + i));
+  }
+  auto first = m.find(1);
+  auto last = m.find(4);
+  auto it = m.erase(first, last);
+  EXPECT_EQ(4, it->first);
+  EXPECT_THAT(m, ElementsAre(Pair(0, 10), Pair(4, 14)));
+}
+
+TEST(FlatLinkedHashMapTest, Insertion) {
+  QuicheFlatLinkedHashMap<int, int> m;
+  std::pair<QuicheFlatLinkedHashMap<int, int>::iterator, bool> result =
+      m.insert(std::make_pair(2, 12));
+  EXPECT_TRUE(result.second);
+  EXPECT_EQ(2, result.first->first);
+
+  result = m.insert(std::make_pair(2, 999));
+  EXPECT_FALSE(result.second);
+  EXPECT_EQ(12, result.first->second);  // The original value is kept.
+}
+
+TEST(FlatLinkedHashMapTest, FrontBackPopFront) {
+  QuicheFlatLinkedHashMap<int, int> m;
+  m.insert(std::make_pair(2, 12));
+  m.insert(std::make_pair(1, 11));
+  m.insert(std::make_pair(3, 13));
+  EXPECT_EQ(2, m.front().first);
+  EXPECT_EQ(3, m.back().first);
+  m.pop_front();
+  EXPECT_EQ(1, m.front().first);
+  m.pop_front();
+  m.pop_front();
+  EXPECT_TRUE(m.empty());
+}
+
+TEST(FlatLinkedHashMapTest, Find) {
+  QuicheFlatLinkedHashMap<int, int> m;
+  EXPECT_TRUE(m.end() == m.find(1));
+  m.insert(std::make_pair(2, 12));
+  EXPECT_TRUE(m.end() == m.find(1));
+  auto it = m.find(2);
+  ASSERT_TRUE(it != m.end());
+  EXPECT_EQ(12, it->second);
+
+  const QuicheFlatLinkedHashMap<int, int>& const_m = m;
+  auto const_it = const_m.find(2);
+  ASSERT_TRUE(const_it != const_m.end());
+  EXPECT_EQ(12, const_it->second);
+}
+
+TEST(FlatLinkedHashMapTest, Contains) {
+  QuicheFlatLinkedHashMap<int, int> m;
+  EXPECT_FALSE(m.contains(1));
+  m.insert(std::make_pair(1, 11));
+  EXPECT_TRUE(m.contains(1));
+  m.erase(1);
+  EXPECT_FALSE(m.contains(1));
+}
+
+TEST(FlatLinkedHashMapTest, Swap) {
+  QuicheFlatLinkedHashMap<int, int> m1;
+  QuicheFlatLinkedHashMap<int, int> m2;
+  m1.insert(std::make_pair(1, 1));
+  m1.insert(std::make_pair(2, 2));
+  m2.insert(std::make_pair(3, 3));
+  m1.swap(m2);
+  EXPECT_THAT(m1, ElementsAre(Pair(3, 3)));
+  EXPECT_THAT(m2, ElementsAre(Pair(1, 1), Pair(2, 2)));
+}
+
+// Churns the map well past its initial capacity so that slot-table growth
+// and tombstone compaction both trigger, and checks that lookup results and
+// insertion order survive.
+TEST(FlatLinkedHashMapTest, GrowthAndCompaction) {
+  QuicheFlatLinkedHashMap<int, int> m;
+  for (int i = 0; i < 1000; ++i) {
+    m.insert(std::make_pair(i, 10 * i));
+  }
+  // Erase the first three quarters, leaving tombstones.
+  for (int i = 0; i < 750; ++i) {
+    EXPECT_EQ(1u, m.erase(i));
+  }
+  EXPECT_EQ(250u, m.size());
+  // More insertions force compaction along the way.
+  for (int i = 1000; i < 1500; ++i) {
+    m.insert(std::make_pair(i, 10 * i));
+  }
+  EXPECT_EQ(750u, m.size());
+  for (int i = 750; i < 1500; ++i) {
+    auto it = m.find(i);
+    ASSERT_TRUE(it != m.end()) << "key " << i;
+    EXPECT_EQ(10 * i, it->second);
+  }
+  // Insertion order is preserved across compaction.
+  int expected = 750;
+  for (const auto& kv : m) {
+    EXPECT_EQ(expected, kv.first);
+    ++expected;
+  }
+  EXPECT_EQ(1500, expected);
+}
+
+// Keys that all collide exercise the full probe sequence, including probing
+// across tombstones left by erased colliding keys.
+TEST(FlatLinkedHashMapTest, CollidingKeys) {
+  struct BadHash {
+    size_t operator()(int /*key*/) const { return 42; }
+  };
+  QuicheFlatLinkedHashMap<int, int, BadHash> m;
+  for (int i = 0; i < 10; ++i) {
+    m.insert(std::make_pair(i, 10 + i));
+  }
+  EXPECT_EQ(1u, m.erase(3));
+  EXPECT_EQ(1u, m.erase(7));
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_EQ(i != 3 && i != 7, m.contains(i)) << "key " << i;
+  }
+  m.insert(std::make_pair(3, 103));
+  EXPECT_EQ(103, m.find(3)->second);
+}
+
+TEST(FlatLinkedHashMapTest, CustomHashAndEquality) {
+  struct CustomIntHash {
+    size_t operator()(int x) const { return x; }
+  };
+  QuicheFlatLinkedHashMap<int, int, CustomIntHash> m;
+  m.insert(std::make_pair(1, 1));
+  EXPECT_TRUE(m.contains(1));
+  EXPECT_EQ(1, m[1]);
+}
+
+}  // namespace test
+}  // namespace quiche
@@ -0,0 +1,404 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_COMMON_QUICHE_SMALL_ORDERED_SET_H_
+#define QUICHE_COMMON_QUICHE_SMALL_ORDERED_SET_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "absl/container/inlined_vector.h"
+#include "common/platform/api/quiche_export.h"
+
+namespace quiche {
+
+// An ordered set with a two-tier layout. Small sets are a single sorted
+// absl::InlinedVector: elements up to |InlineCapacity| live inline with no
+// heap allocation at all, which covers the interval set of virtually every
+// ack frame. Once a set outgrows kSpillThreshold elements — as the acked-byte
+// tracking of a multi-gigabyte transfer with reordered acks does — it spills
+// into a sorted vector of page-sized sorted vectors, so a mid-set insertion
+// or erasure shifts at most one page of elements instead of the whole set,
+// and lookups remain two binary searches over contiguous memory. Once
+// spilled, a set stays paged until clear().
+//
+// Supports the subset of the std::set/absl::btree_set API that
+// QuicIntervalSet relies on, including transparent lower_bound/upper_bound
+// lookups. As in std::set, iterator is const_iterator. Iterators are
+// invalidated by mutations; use the iterators returned by insert() and
+// erase().
+template <typename Key, typename Compare = std::less<Key>,
+          size_t InlineCapacity = 8>
+class QUICHE_NO_EXPORT QuicheSmallOrderedSet {
+ private:
+  // Elements per page of the paged tier. With 16-byte elements a full page
+  // is 2 kB of contiguous memory.
+  static constexpr size_t kPageCapacity = 128;
+  // Flat-vector size beyond which the set converts to the paged layout.
+  static constexpr size_t kSpillThreshold = kPageCapacity;
+
+  using SmallRep = absl::InlinedVector<Key, InlineCapacity>;
+  using Page = std::vector<Key>;
+
+ public:
+  using key_type = Key;
+  using value_type = Key;
+  using key_compare = Compare;
+  using size_type = size_t;
+
+  class const_iterator {
+   public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = Key;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const Key*;
+    using reference = const Key&;
+
+    const_iterator() = default;
+
+    reference operator*() const { return *set_->SlotPtr(page_, slot_); }
+    pointer operator->() const { return set_->SlotPtr(page_, slot_); }
+
+    const_iterator& operator++() {
+      if (++slot_ >= set_->PageSize(page_)) {
+        ++page_;
+        slot_ = 0;
+      }
+      return *this;
+    }
+    const_iterator operator++(int) {
+      const_iterator result = *this;
+      ++*this;
+      return result;
+    }
+    const_iterator& operator--() {
+      if (slot_ == 0) {
+        --page_;
+        slot_ = set_->PageSize(page_) - 1;
+      } else {
+        --slot_;
+      }
+      return *this;
+    }
+    const_iterator operator--(int) {
+      const_iterator result = *this;
+      --*this;
+      return result;
+    }
+
+    friend bool operator==(const const_iterator& a, const const_iterator& b) {
+      return a.page_ == b.page_ && a.slot_ == b.slot_;
+    }
+    friend bool operator!=(const const_iterator& a, const const_iterator& b) {
+      return !(a == b);
+    }
+
+   private:
+    friend class QuicheSmallOrderedSet;
+
+    const_iterator(const QuicheSmallOrderedSet* set, size_t page, size_t slot)
+        : set_(set), page_(page), slot_(slot) {}
+
+    const QuicheSmallOrderedSet* set_ = nullptr;
+    size_t page_ = 0;
+    size_t slot_ = 0;
+  };
+
+  using iterator = const_iterator;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+  using reverse_iterator = const_reverse_iterator;
+
+  QuicheSmallOrderedSet() = default;
+  explicit QuicheSmallOrderedSet(const Compare& comp) : comp_(comp) {}
+
+  const_iterator begin() const { return MakeIterator(0, 0); }
+  const_iterator end() const { return const_iterator(this, PageCount(), 0); }
+  const_reverse_iterator rbegin() const {
+    return const_reverse_iterator(end());
+  }
+  const_reverse_iterator rend() const {
+    return const_reverse_iterator(begin());
+  }
+
+  bool empty() const { return size() == 0; }
+  size_type size() const { return paged_ ? paged_size_ : small_.size(); }
+
+  void clear() {
+    small_.clear();
+    pages_.clear();
+    paged_ = false;
+    paged_size_ = 0;
+  }
+
+  void swap(QuicheSmallOrderedSet& other) {
+    small_.swap(other.small_);
+    pages_.swap(other.pages_);
+    std::swap(paged_, other.paged_);
+    std::swap(paged_size_, other.paged_size_);
+    std::swap(comp_, other.comp_);
+  }
+
+  std::pair<iterator, bool> insert(const value_type& value) {
+    if (!paged_) {
+      typename SmallRep::iterator it =
+          std::lower_bound(small_.begin(), small_.end(), value, comp_);
+      if (it != small_.end() && !comp_(value, *it)) {
+        return {const_iterator(this, 0, it - small_.begin()), false};
+      }
+      if (small_.size() < kSpillThreshold) {
+        const size_t slot = it - small_.begin();
+        small_.insert(it, value);
+        return {const_iterator(this, 0, slot), true};
+      }
+      SpillToPages();
+    }
+    return PagedInsert(value);
+  }
+
+  iterator erase(const_iterator pos) {
+    if (!paged_) {
+      small_.erase(small_.begin() + pos.slot_);
+      return MakeIterator(0, pos.slot_);
+    }
+    Page& page = pages_[pos.page_];
+    page.erase(page.begin() + pos.slot_);
+    --paged_size_;
+    if (page.empty()) {
+      pages_.erase(pages_.begin() + pos.page_);
+      return MakeIterator(pos.page_, 0);
+    }
+    return MakeIterator(pos.page_, pos.slot_);
+  }
+
+  iterator erase(const_iterator first, const_iterator last) {
+    if (first == last) {
+      return MakeIterator(first.page_, first.slot_);
+    }
+    if (!paged_) {
+      const size_t first_slot = first.slot_;
+      const size_t last_slot = (last.page_ == 0) ? last.slot_ : small_.size();
+      small_.erase(small_.begin() + first_slot, small_.begin() + last_slot);
+      return MakeIterator(0, first_slot);
+    }
+    const size_t first_page = first.page_;
+    const size_t first_slot = first.slot_;
+    const size_t last_page = last.page_;
+    const size_t last_slot = last.slot_;
+    if (first_page == last_page) {
+      Page& page = pages_[first_page];
+      page.erase(page.begin() + first_slot, page.begin() + last_slot);
+      paged_size_ -= last_slot - first_slot;
+      if (page.empty()) {
+        pages_.erase(pages_.begin() + first_page);
+      }
+      return MakeIterator(first_page, first_slot);
+    }
+    // Trim the head of the last page first so earlier page indices stay
+    // valid, then drop the wholly covered pages, then trim the tail of the
+    // first page.
+    if (last_page < pages_.size() && last_slot > 0) {
+      Page& page = pages_[last_page];
+      page.erase(page.begin(), page.begin() + last_slot);
+      paged_size_ -= last_slot;
+    }
+    const size_t whole_begin = (first_slot > 0) ? first_page + 1 : first_page;
+    for (size_t i = whole_begin; i < last_page; ++i) {
+      paged_size_ -= pages_[i].size();
+    }
+    pages_.erase(pages_.begin() + whole_begin, pages_.begin() + last_page);
+    if (first_slot > 0) {
+      Page& page = pages_[first_page];
+      paged_size_ -= page.size() - first_slot;
+      page.erase(page.begin() + first_slot, page.end());
+      return MakeIterator(first_page + 1, 0);
+    }
+    return MakeIterator(first_page, 0);
+  }
+
+  // Transparent lookups: |key| may be any type the comparator accepts.
+  template <typename K>
+  const_iterator lower_bound(const K& key) const {
+    if (!paged_) {
+      return MakeIterator(
+          0, std::lower_bound(small_.begin(), small_.end(), key, comp_) -
+                 small_.begin());
+    }
+    const size_t page = PageLowerBound(key);
+    if (page == pages_.size()) {
+      return end();
+    }
+    return const_iterator(
+        this, page,
+        std::lower_bound(pages_[page].begin(), pages_[page].end(), key,
+                         comp_) -
+            pages_[page].begin());
+  }
+
+  template <typename K>
+  const_iterator upper_bound(const K& key) const {
+    if (!paged_) {
+      return MakeIterator(
+          0, std::upper_bound(small_.begin(), small_.end(), key, comp_) -
+                 small_.begin());
+    }
+    const size_t page = PageUpperBound(key);
+    if (page == pages_.size()) {
+      return end();
+    }
+    return const_iterator(
+        this, page,
+        std::upper_bound(pages_[page].begin(), pages_[page].end(), key,
+                         comp_) -
+            pages_[page].begin());
+  }
+
+  template <typename K>
+  const_iterator find(const K& key) const {
+    const_iterator it = lower_bound(key);
+    if (it != end() && !comp_(key, *it)) {
+      return it;
+    }
+    return end();
+  }
+
+  friend bool operator==(const QuicheSmallOrderedSet& a,
+                         const QuicheSmallOrderedSet& b) {
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin());
+  }
+  friend bool operator!=(const QuicheSmallOrderedSet& a,
+                         const QuicheSmallOrderedSet& b) {
+    return !(a == b);
+  }
+
+ private:
+  size_t PageCount() const { return paged_ ? pages_.size() : 1; }
+
+  size_t PageSize(size_t page) const {
+    return paged_ ? pages_[page].size() : small_.size();
+  }
+
+  const Key* SlotPtr(size_t page, size_t slot) const {
+    return paged_ ? &pages_[page][slot] : &small_[slot];
+  }
+
+  // Builds an iterator for |slot| of |page|, stepping past page boundaries
+  // so that one-past-the-last-slot positions normalize to the next page (or
+  // to end()).
+  const_iterator MakeIterator(size_t page, size_t slot) const {
+    while (page < PageCount() && slot >= PageSize(page)) {
+      ++page;
+      slot = 0;
+    }
+    return const_iterator(this, page, slot);
+  }
+
+  // Converts the flat vector into half-full pages, leaving room on each for
+  // further insertions before any page has to split.
+  void SpillToPages() {
+    const size_t half = kPageCapacity / 2;
+    for (size_t i = 0; i < small_.size(); i += half) {
+      const size_t end = std::min(i + half, small_.size());
+      pages_.emplace_back(small_.begin() + i, small_.begin() + end);
+    }
+    paged_size_ = small_.size();
+    small_.clear();
+    paged_ = true;
+  }
+
+  // Index of the first page whose last element is not less than |key|, i.e.
+  // the page an element equal to |key| would live in.
+  template <typename K>
+  size_t PageLowerBound(const K& key) const {
+    size_t lo = 0;
+    size_t hi = pages_.size();
+    while (lo < hi) {
+      const size_t mid = lo + (hi - lo) / 2;
+      if (comp_(pages_[mid].back(), key)) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    return lo;
+  }
+
+  // Index of the first page whose last element is greater than |key|.
+  template <typename K>
+  size_t PageUpperBound(const K& key) const {
+    size_t lo = 0;
+    size_t hi = pages_.size();
+    while (lo < hi) {
+      const size_t mid = lo + (hi - lo) / 2;
+      if (comp_(key, pages_[mid].back())) {
+        hi = mid;
+      } else {
+        lo = mid + 1;
+      }
+    }
+    return lo;
+  }
+
+  // Moves the upper half of page |i| into a new page at |i| + 1.
+  void SplitPage(size_t i) {
+    Page& page = pages_[i];
+    const size_t half = page.size() / 2;
+    Page tail(std::make_move_iterator(page.begin() + half),
+              std::make_move_iterator(page.end()));
+    page.erase(page.begin() + half, page.end());
+    pages_.insert(pages_.begin() + i + 1, std::move(tail));
+  }
+
+  std::pair<iterator, bool> PagedInsert(const value_type& value) {
+    if (pages_.empty()) {
+      // erase can drain the paged representation entirely while leaving
+      // |paged_| set. Start a fresh page directly: the page binary searches
+      // assume every page is non-empty.
+      pages_.emplace_back();
+      pages_[0].push_back(value);
+      ++paged_size_;
+      return {const_iterator(this, 0, 0), true};
+    }
+    size_t page = PageLowerBound(value);
+    if (page == pages_.size()) {
+      // Larger than every element; goes at the end of the last page.
+      page = pages_.size() - 1;
+    }
+    Page* p = &pages_[page];
+    typename Page::iterator it =
+        std::lower_bound(p->begin(), p->end(), value, comp_);
+    if (it != p->end() && !comp_(value, *it)) {
+      return {const_iterator(this, page, it - p->begin()), false};
+    }
+    size_t slot = it - p->begin();
+    if (p->size() >= kPageCapacity) {
+      SplitPage(page);
+      const size_t half = pages_[page].size();
+      if (slot > half) {
+        ++page;
+        slot -= half;
+      }
+      p = &pages_[page];
+    }
+    p->insert(p->begin() + slot, value);
+    ++paged_size_;
+    return {const_iterator(this, page, slot), true};
+  }
+
+  // Flat representation, used until the set outgrows kSpillThreshold.
+  SmallRep small_;
+  // Paged representation: a sorted vector of non-empty page-sized sorted
+  // vectors. Unused (and empty) until |paged_| is true.
+  std::vector<Page> pages_;
+  bool paged_ = false;
+  size_t paged_size_ = 0;
+  Compare comp_;
+};
+
+}  // namespace quiche
+
+#endif  // QUICHE_COMMON_QUICHE_SMALL_ORDERED_SET_H_
@@ -0,0 +1,172 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "common/quiche_small_ordered_set.h"
+
+#include <iterator>
+#include <string>
+
+#include "common/platform/api/quiche_test.h"
+
+using testing::ElementsAre;
+
+namespace quiche {
+namespace test {
+namespace {
+
+TEST(QuicheSmallOrderedSetTest, InsertKeepsSortedOrderAndRejectsDuplicates) {
+  QuicheSmallOrderedSet<int> set;
+  EXPECT_TRUE(set.empty());
+
+  EXPECT_TRUE(set.insert(3).second);
+  EXPECT_TRUE(set.insert(1).second);
+  EXPECT_TRUE(set.insert(2).second);
+  EXPECT_FALSE(set.insert(2).second);
+
+  EXPECT_EQ(3u, set.size());
+  EXPECT_THAT(set, ElementsAre(1, 2, 3));
+}
+
+TEST(QuicheSmallOrderedSetTest, EraseReturnsNextIterator) {
+  QuicheSmallOrderedSet<int> set;
+  for (int i = 1; i <= 5; ++i) {
+    set.insert(i);
+  }
+
+  auto it = set.erase(set.find(3));
+  EXPECT_EQ(4, *it);
+  it = set.erase(set.begin(), set.find(4));
+  EXPECT_EQ(4, *it);
+  EXPECT_THAT(set, ElementsAre(4, 5));
+}
+
+TEST(QuicheSmallOrderedSetTest, BoundsAndFind) {
+  QuicheSmallOrderedSet<int> set;
+  set.insert(10);
+  set.insert(20);
+  set.insert(30);
+
+  EXPECT_EQ(20, *set.lower_bound(20));
+  EXPECT_EQ(30, *set.upper_bound(20));
+  EXPECT_EQ(20, *set.lower_bound(15));
+  EXPECT_EQ(set.end(), set.upper_bound(30));
+  EXPECT_EQ(20, *set.find(20));
+  EXPECT_EQ(set.end(), set.find(25));
+}
+
+struct TransparentLess {
+  using is_transparent = void;
+  bool operator()(const std::string& a, const std::string& b) const {
+    return a < b;
+  }
+  bool operator()(const std::string& a, char b) const { return a[0] < b; }
+  bool operator()(char a, const std::string& b) const { return a < b[0]; }
+};
+
+TEST(QuicheSmallOrderedSetTest, TransparentLookup) {
+  QuicheSmallOrderedSet<std::string, TransparentLess> set;
+  set.insert("apple");
+  set.insert("cherry");
+
+  EXPECT_EQ("cherry", *set.lower_bound('b'));
+  EXPECT_EQ("cherry", *set.upper_bound('b'));
+  EXPECT_EQ("apple", *set.upper_bound('\0'));
+}
+
+TEST(QuicheSmallOrderedSetTest, ReverseIterationAndEquality) {
+  QuicheSmallOrderedSet<int> a;
+  QuicheSmallOrderedSet<int> b;
+  for (int i : {5, 1, 3}) {
+    a.insert(i);
+    b.insert(i);
+  }
+  EXPECT_EQ(5, *a.rbegin());
+  EXPECT_EQ(1, *std::prev(a.rend()));
+  EXPECT_EQ(a, b);
+  b.erase(b.begin());
+  EXPECT_NE(a, b);
+
+  a.clear();
+  EXPECT_TRUE(a.empty());
+}
+
+TEST(QuicheSmallOrderedSetTest, SpillsToPagedLayoutAndStaysSorted) {
+  QuicheSmallOrderedSet<int> set;
+  // Insert enough elements, in an order with many mid-set insertions, to
+  // push the set well past the spill threshold and through page splits.
+  for (int i = 0; i < 1000; i += 2) {
+    ASSERT_TRUE(set.insert(i).second);
+  }
+  for (int i = 999; i > 0; i -= 2) {
+    ASSERT_TRUE(set.insert(i).second);
+  }
+  EXPECT_EQ(1000u, set.size());
+  EXPECT_FALSE(set.insert(500).second);
+
+  int expected = 0;
+  for (int value : set) {
+    EXPECT_EQ(expected++, value);
+  }
+  EXPECT_EQ(1000, expected);
+  EXPECT_EQ(999, *set.rbegin());
+}
+
+TEST(QuicheSmallOrderedSetTest, PagedBoundsAndFind) {
+  QuicheSmallOrderedSet<int> set;
+  for (int i = 0; i < 500; ++i) {
+    set.insert(10 * i);
+  }
+  EXPECT_EQ(1230, *set.lower_bound(1223));
+  EXPECT_EQ(1230, *set.lower_bound(1230));
+  EXPECT_EQ(1240, *set.upper_bound(1230));
+  EXPECT_EQ(4990, *set.find(4990));
+  EXPECT_EQ(set.end(), set.find(4991));
+  EXPECT_EQ(set.end(), set.lower_bound(5000));
+}
+
+TEST(QuicheSmallOrderedSetTest, PagedEraseSingleAndRange) {
+  QuicheSmallOrderedSet<int> set;
+  for (int i = 0; i < 600; ++i) {
+    set.insert(i);
+  }
+
+  auto it = set.erase(set.find(100));
+  EXPECT_EQ(101, *it);
+  EXPECT_EQ(599u, set.size());
+
+  // Erase a range spanning several pages.
+  it = set.erase(set.find(50), set.find(550));
+  EXPECT_EQ(550, *it);
+  EXPECT_EQ(100u, set.size());
+  EXPECT_EQ(set.end(), set.find(300));
+
+  // Erase through the end.
+  it = set.erase(set.find(550), set.end());
+  EXPECT_EQ(set.end(), it);
+  EXPECT_EQ(50u, set.size());
+  EXPECT_EQ(49, *set.rbegin());
+}
+
+TEST(QuicheSmallOrderedSetTest, ReinsertAfterPagedSetIsDrained) {
+  QuicheSmallOrderedSet<int> set;
+  for (int i = 0; i < 600; ++i) {
+    set.insert(i);
+  }
+
+  // Drain the spilled set completely; the paged layout stays active.
+  set.erase(set.begin(), set.end());
+  EXPECT_TRUE(set.empty());
+
+  // Insertion must repopulate the drained paged layout.
+  EXPECT_TRUE(set.insert(42).second);
+  EXPECT_TRUE(set.insert(7).second);
+  EXPECT_TRUE(set.insert(99).second);
+  EXPECT_FALSE(set.insert(42).second);
+  EXPECT_THAT(set, ElementsAre(7, 42, 99));
+  EXPECT_EQ(42, *set.find(42));
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quiche
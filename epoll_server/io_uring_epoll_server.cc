@@ -0,0 +1,362 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "epoll_server/io_uring_epoll_server.h"
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <linux/time_types.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define EPOLL_SERVER_HAVE_IO_URING 1
+#endif
+#endif
+#endif
+
+namespace epoll_server {
+
+namespace {
+
+const int kErrorBufferSize = 256;
+
+#ifdef EPOLL_SERVER_HAVE_IO_URING
+
+// user_data tags for completions which do not correspond to a registered fd.
+const uint64_t kTimeoutUserData = ~static_cast<uint64_t>(0);
+const uint64_t kPollRemoveUserData = ~static_cast<uint64_t>(1);
+
+int IoUringSetup(unsigned entries, struct io_uring_params* params) {
+  return syscall(__NR_io_uring_setup, entries, params);
+}
+
+int IoUringEnter(int ring_fd, unsigned to_submit, unsigned min_complete,
+                 unsigned flags) {
+  return syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags,
+                 nullptr, 0);
+}
+
+#endif  // EPOLL_SERVER_HAVE_IO_URING
+
+}  // namespace
+
+IoUringEpollServer::IoUringEpollServer()
+    : ring_fd_(-1),
+      sq_entries_(0),
+      sq_ring_ptr_(nullptr),
+      sq_ring_size_(0),
+      cq_ring_ptr_(nullptr),
+      cq_ring_size_(0),
+      sqes_(nullptr),
+      sqes_size_(0),
+      sq_head_(nullptr),
+      sq_tail_(nullptr),
+      sq_ring_mask_(nullptr),
+      sq_array_(nullptr),
+      cq_head_(nullptr),
+      cq_tail_(nullptr),
+      cq_ring_mask_(nullptr),
+      cqes_(nullptr),
+      unsubmitted_sqes_(0) {
+#ifdef EPOLL_SERVER_HAVE_IO_URING
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  int ring_fd = IoUringSetup(kRingEntries, &params);
+  if (ring_fd < 0) {
+    int saved_errno = errno;
+    char buf[kErrorBufferSize];
+    EPOLL_LOG(WARNING) << "Error " << saved_errno << " in io_uring_setup(), "
+                       << "falling back to epoll: "
+                       << strerror_r(saved_errno, buf, sizeof(buf));
+    return;
+  }
+
+  sq_entries_ = params.sq_entries;
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cq_ring_size_ =
+      params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+
+  bool single_mmap = false;
+#ifdef IORING_FEAT_SINGLE_MMAP
+  single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+#endif
+  if (single_mmap) {
+    sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+  }
+
+  sq_ring_ptr_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+  if (sq_ring_ptr_ == MAP_FAILED) {
+    sq_ring_ptr_ = nullptr;
+    close(ring_fd);
+    EPOLL_LOG(WARNING) << "mmap of io_uring SQ ring failed, "
+                       << "falling back to epoll";
+    return;
+  }
+
+  if (single_mmap) {
+    cq_ring_ptr_ = sq_ring_ptr_;
+  } else {
+    cq_ring_ptr_ = mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+    if (cq_ring_ptr_ == MAP_FAILED) {
+      cq_ring_ptr_ = nullptr;
+      munmap(sq_ring_ptr_, sq_ring_size_);
+      sq_ring_ptr_ = nullptr;
+      close(ring_fd);
+      EPOLL_LOG(WARNING) << "mmap of io_uring CQ ring failed, "
+                         << "falling back to epoll";
+      return;
+    }
+  }
+
+  sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+  void* sqes = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+  if (sqes == MAP_FAILED) {
+    if (cq_ring_ptr_ != sq_ring_ptr_) {
+      munmap(cq_ring_ptr_, cq_ring_size_);
+    }
+    cq_ring_ptr_ = nullptr;
+    munmap(sq_ring_ptr_, sq_ring_size_);
+    sq_ring_ptr_ = nullptr;
+    close(ring_fd);
+    EPOLL_LOG(WARNING) << "mmap of io_uring SQE array failed, "
+                       << "falling back to epoll";
+    return;
+  }
+  sqes_ = reinterpret_cast<struct io_uring_sqe*>(sqes);
+
+  char* sq_ring = reinterpret_cast<char*>(sq_ring_ptr_);
+  sq_head_ = reinterpret_cast<unsigned*>(sq_ring + params.sq_off.head);
+  sq_tail_ = reinterpret_cast<unsigned*>(sq_ring + params.sq_off.tail);
+  sq_ring_mask_ =
+      reinterpret_cast<unsigned*>(sq_ring + params.sq_off.ring_mask);
+  sq_array_ = reinterpret_cast<unsigned*>(sq_ring + params.sq_off.array);
+
+  char* cq_ring = reinterpret_cast<char*>(cq_ring_ptr_);
+  cq_head_ = reinterpret_cast<unsigned*>(cq_ring + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<unsigned*>(cq_ring + params.cq_off.tail);
+  cq_ring_mask_ =
+      reinterpret_cast<unsigned*>(cq_ring + params.cq_off.ring_mask);
+  cqes_ =
+      reinterpret_cast<struct io_uring_cqe*>(cq_ring + params.cq_off.cqes);
+
+  ring_fd_ = ring_fd;
+
+  // The base class constructor registered its wake pipe before the ring
+  // existed -- virtual dispatch does not reach a derived class during base
+  // construction -- so arm polls for anything already in the callback map.
+  for (const auto& cb_and_mask : cb_map_) {
+    const int mask = cb_and_mask.event_mask | EPOLLERR | EPOLLHUP;
+    poll_masks_[cb_and_mask.fd] = mask;
+    QueuePollAdd(cb_and_mask.fd, mask);
+  }
+#endif  // EPOLL_SERVER_HAVE_IO_URING
+}
+
+IoUringEpollServer::~IoUringEpollServer() { CloseRing(); }
+
+void IoUringEpollServer::DelFD(int fd) const {
+  SimpleEpollServer::DelFD(fd);
+  if (!io_uring_enabled()) {
+    return;
+  }
+  poll_masks_.erase(fd);
+  QueuePollRemove(fd);
+}
+
+void IoUringEpollServer::AddFD(int fd, int event_mask) const {
+  SimpleEpollServer::AddFD(fd, event_mask);
+  if (!io_uring_enabled()) {
+    return;
+  }
+  const int mask = event_mask | EPOLLERR | EPOLLHUP;
+  poll_masks_[fd] = mask;
+  QueuePollAdd(fd, mask);
+}
+
+void IoUringEpollServer::ModFD(int fd, int event_mask) const {
+  SimpleEpollServer::ModFD(fd, event_mask);
+  if (!io_uring_enabled()) {
+    return;
+  }
+  const int mask = event_mask | EPOLLERR | EPOLLHUP;
+  poll_masks_[fd] = mask;
+  // Any armed one-shot poll still carries the old interest set; replace it.
+  QueuePollRemove(fd);
+  QueuePollAdd(fd, mask);
+}
+
+#ifdef EPOLL_SERVER_HAVE_IO_URING
+
+int IoUringEpollServer::epoll_wait_impl(int epfd, struct epoll_event* events,
+                                        int max_events, int timeout_in_ms) {
+  if (!io_uring_enabled()) {
+    return SimpleEpollServer::epoll_wait_impl(epfd, events, max_events,
+                                              timeout_in_ms);
+  }
+
+  // A bounded wait is expressed as a timeout operation riding the same
+  // submission.  Its completion (and any stale one from a previous cycle
+  // whose events arrived first) is skipped during the reap below.  The
+  // kernel copies the timespec while processing the submission, so the
+  // stack lifetime is sufficient.
+  struct __kernel_timespec timeout_spec;
+  if (timeout_in_ms > 0) {
+    timeout_spec.tv_sec = timeout_in_ms / 1000;
+    timeout_spec.tv_nsec = (timeout_in_ms % 1000) * 1000000LL;
+    struct io_uring_sqe* sqe = GetSqe();
+    sqe->opcode = IORING_OP_TIMEOUT;
+    sqe->fd = -1;
+    sqe->addr = reinterpret_cast<uint64_t>(&timeout_spec);
+    sqe->len = 1;
+    sqe->user_data = kTimeoutUserData;
+  }
+
+  const unsigned to_submit = unsubmitted_sqes_;
+  unsubmitted_sqes_ = 0;
+  const unsigned min_complete = timeout_in_ms == 0 ? 0 : 1;
+  if (Enter(to_submit, min_complete, IORING_ENTER_GETEVENTS) < 0 &&
+      errno != EINTR) {
+    int saved_errno = errno;
+    char buf[kErrorBufferSize];
+    EPOLL_LOG(FATAL) << "Error " << saved_errno << " in io_uring_enter(): "
+                     << strerror_r(saved_errno, buf, sizeof(buf));
+  }
+
+  int nevents = 0;
+  unsigned head = *cq_head_;
+  const unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+  while (head != tail && nevents < max_events) {
+    const struct io_uring_cqe* cqe = &cqes_[head & *cq_ring_mask_];
+    ++head;
+    if (cqe->user_data == kTimeoutUserData ||
+        cqe->user_data == kPollRemoveUserData) {
+      continue;
+    }
+    const int fd = static_cast<int>(cqe->user_data);
+    std::unordered_map<int, int>::const_iterator it = poll_masks_.find(fd);
+    if (it == poll_masks_.end()) {
+      // Unregistered after the poll fired but before the completion was
+      // reaped.
+      continue;
+    }
+    // POLL* and EPOLL* event bits coincide for IN/OUT/ERR/HUP/PRI.  Filter
+    // by the current interest set: the completion may come from a poll armed
+    // before a ModFD() narrowed the mask, and epoll would not report such
+    // events.
+    const uint32_t revents =
+        (cqe->res < 0 ? EPOLLERR : static_cast<uint32_t>(cqe->res)) &
+        static_cast<uint32_t>(it->second);
+    // The one-shot poll is now spent either way; queue a re-arm.  It is
+    // submitted with the next cycle's io_uring_enter() rather than costing a
+    // syscall here.
+    QueuePollAdd(fd, it->second);
+    if (revents == 0) {
+      continue;
+    }
+    events[nevents].events = revents;
+    events[nevents].data.fd = fd;
+    ++nevents;
+  }
+  __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+  return nevents;
+}
+
+struct io_uring_sqe* IoUringEpollServer::GetSqe() const {
+  unsigned head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+  unsigned tail = *sq_tail_;
+  if (tail - head >= sq_entries_) {
+    // Submission queue is full; flush what is queued to free entries.
+    if (Enter(unsubmitted_sqes_, 0, 0) < 0) {
+      EPOLL_LOG(FATAL) << "io_uring_enter failed flushing a full "
+                       << "submission queue";
+    }
+    unsubmitted_sqes_ = 0;
+    head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+    CHECK_LT(tail - head, sq_entries_);
+  }
+  const unsigned index = tail & *sq_ring_mask_;
+  struct io_uring_sqe* sqe = &sqes_[index];
+  memset(sqe, 0, sizeof(*sqe));
+  sq_array_[index] = index;
+  __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+  ++unsubmitted_sqes_;
+  return sqe;
+}
+
+void IoUringEpollServer::QueuePollAdd(int fd, int event_mask) const {
+  struct io_uring_sqe* sqe = GetSqe();
+  sqe->opcode = IORING_OP_POLL_ADD;
+  sqe->fd = fd;
+  sqe->poll_events = static_cast<uint16_t>(event_mask);
+  sqe->user_data = static_cast<uint64_t>(static_cast<uint32_t>(fd));
+}
+
+void IoUringEpollServer::QueuePollRemove(int fd) const {
+  struct io_uring_sqe* sqe = GetSqe();
+  sqe->opcode = IORING_OP_POLL_REMOVE;
+  sqe->fd = -1;
+  sqe->addr = static_cast<uint64_t>(static_cast<uint32_t>(fd));
+  sqe->user_data = kPollRemoveUserData;
+}
+
+int IoUringEpollServer::Enter(unsigned to_submit, unsigned min_complete,
+                              unsigned flags) const {
+  return IoUringEnter(ring_fd_, to_submit, min_complete, flags);
+}
+
+void IoUringEpollServer::CloseRing() {
+  if (ring_fd_ < 0) {
+    return;
+  }
+  if (sqes_ != nullptr) {
+    munmap(sqes_, sqes_size_);
+    sqes_ = nullptr;
+  }
+  if (cq_ring_ptr_ != nullptr && cq_ring_ptr_ != sq_ring_ptr_) {
+    munmap(cq_ring_ptr_, cq_ring_size_);
+  }
+  cq_ring_ptr_ = nullptr;
+  if (sq_ring_ptr_ != nullptr) {
+    munmap(sq_ring_ptr_, sq_ring_size_);
+    sq_ring_ptr_ = nullptr;
+  }
+  close(ring_fd_);
+  ring_fd_ = -1;
+}
+
+#else  // !EPOLL_SERVER_HAVE_IO_URING
+
+int IoUringEpollServer::epoll_wait_impl(int epfd, struct epoll_event* events,
+                                        int max_events, int timeout_in_ms) {
+  return SimpleEpollServer::epoll_wait_impl(epfd, events, max_events,
+                                            timeout_in_ms);
+}
+
+struct io_uring_sqe* IoUringEpollServer::GetSqe() const { return nullptr; }
+
+void IoUringEpollServer::QueuePollAdd(int /*fd*/, int /*event_mask*/) const {}
+
+void IoUringEpollServer::QueuePollRemove(int /*fd*/) const {}
+
+int IoUringEpollServer::Enter(unsigned /*to_submit*/, unsigned /*min_complete*/,
+                              unsigned /*flags*/) const {
+  errno = ENOSYS;
+  return -1;
+}
+
+void IoUringEpollServer::CloseRing() {}
+
+#endif  // EPOLL_SERVER_HAVE_IO_URING
+
+}  // namespace epoll_server
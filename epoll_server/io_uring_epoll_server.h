@@ -0,0 +1,116 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_EPOLL_SERVER_IO_URING_EPOLL_SERVER_H_
+#define QUICHE_EPOLL_SERVER_IO_URING_EPOLL_SERVER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <unordered_map>
+
+#include "epoll_server/platform/api/epoll_export.h"
+#include "epoll_server/simple_epoll_server.h"
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace epoll_server {
+
+// An event loop backed by io_uring instead of epoll_wait().
+//
+// Poll interests are armed as one-shot IORING_OP_POLL_ADD submissions and
+// re-armed after each completion is reaped, which makes the delivered events
+// look level-triggered to the rest of the server, just like epoll_wait()
+// does.  All submissions accumulated since the previous wait -- re-arms,
+// registrations, modifications and removals -- are handed to the kernel in
+// the single io_uring_enter() call that also collects completions, so a wait
+// cycle costs one syscall no matter how many fds changed state.  The plain
+// epoll mechanism pays epoll_wait() plus one epoll_ctl() per changed fd.
+//
+// The epoll set of the base class is kept registered in parallel.  This costs
+// an epoll_ctl() on the (rare) registration-change path but keeps the
+// teardown code in ~SimpleEpollServer() valid, since virtual dispatch cannot
+// reach this class once its destructor has run.  Nobody waits on the epoll
+// fd while io_uring is active, so the duplicated readiness is never seen.
+//
+// If io_uring_setup() fails -- kernel older than 5.1, seccomp policy, locked
+// memory limits -- the instance silently degrades to the epoll behavior of
+// the base class; io_uring_enabled() reports which mode is active.
+class EPOLL_EXPORT_PRIVATE IoUringEpollServer : public SimpleEpollServer {
+ public:
+  IoUringEpollServer();
+  IoUringEpollServer(const IoUringEpollServer&) = delete;
+  IoUringEpollServer& operator=(const IoUringEpollServer&) = delete;
+  ~IoUringEpollServer() override;
+
+  // Returns true if the ring was set up and events are being driven through
+  // io_uring, false if this instance fell back to plain epoll.
+  bool io_uring_enabled() const { return ring_fd_ >= 0; }
+
+ protected:
+  void DelFD(int fd) const override;
+  void AddFD(int fd, int event_mask) const override;
+  void ModFD(int fd, int event_mask) const override;
+  int epoll_wait_impl(int epfd, struct epoll_event* events, int max_events,
+                      int timeout_in_ms) override;
+
+ private:
+  // Entries requested for the submission queue.  Must be a power of two.
+  // Large enough that a full wait cycle's worth of re-arms fits without an
+  // extra flush; GetSqe() copes if it does not.
+  static const unsigned kRingEntries = 256;
+
+  // Returns the next free submission queue entry, zeroed.  Flushes pending
+  // submissions to the kernel first if the queue is full.
+  struct io_uring_sqe* GetSqe() const;
+
+  // Queues a one-shot poll for |fd| with epoll-style |event_mask|.
+  void QueuePollAdd(int fd, int event_mask) const;
+
+  // Queues cancellation of any poll currently armed for |fd|.
+  void QueuePollRemove(int fd) const;
+
+  // io_uring_enter(2) wrapper.  Returns the syscall result; errno is set on
+  // failure.
+  int Enter(unsigned to_submit, unsigned min_complete, unsigned flags) const;
+
+  // Unmaps the rings and closes the ring fd.  Safe to call when disabled.
+  void CloseRing();
+
+  int ring_fd_;
+  unsigned sq_entries_;
+
+  // Mapped ring memory.  sq_ring_ptr_ and cq_ring_ptr_ alias each other when
+  // the kernel reports IORING_FEAT_SINGLE_MMAP.
+  void* sq_ring_ptr_;
+  size_t sq_ring_size_;
+  void* cq_ring_ptr_;
+  size_t cq_ring_size_;
+  struct io_uring_sqe* sqes_;
+  size_t sqes_size_;
+
+  // Pointers into the mapped rings.
+  unsigned* sq_head_;
+  unsigned* sq_tail_;
+  unsigned* sq_ring_mask_;
+  unsigned* sq_array_;
+  unsigned* cq_head_;
+  unsigned* cq_tail_;
+  unsigned* cq_ring_mask_;
+  struct io_uring_cqe* cqes_;
+
+  // SQEs queued locally since the last io_uring_enter().  Mutable because
+  // AddFD()/ModFD()/DelFD() are const in the base class.
+  mutable unsigned unsubmitted_sqes_;
+
+  // Event mask currently wanted for each registered fd, consulted when
+  // deciding whether (and with what interest) to re-arm a completed one-shot
+  // poll.
+  mutable std::unordered_map<int, int> poll_masks_;
+};
+
+}  // namespace epoll_server
+
+#endif  // QUICHE_EPOLL_SERVER_IO_URING_EPOLL_SERVER_H_
@@ -0,0 +1,125 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "epoll_server/io_uring_epoll_server.h"
+
+#include <unistd.h>
+
+#include <string>
+
+#include "epoll_server/platform/api/epoll_test.h"
+
+namespace epoll_server {
+
+namespace test {
+
+namespace {
+
+// Counts events delivered to an fd and remembers the last event mask.
+class EventCountingCB : public EpollCallbackInterface {
+ public:
+  EventCountingCB() : num_events_(0), last_event_mask_(0) {}
+
+  void OnRegistration(SimpleEpollServer* /*eps*/, int /*fd*/,
+                      int /*event_mask*/) override {}
+  void OnModification(int /*fd*/, int /*event_mask*/) override {}
+  void OnEvent(int /*fd*/, EpollEvent* event) override {
+    ++num_events_;
+    last_event_mask_ = event->in_events;
+  }
+  void OnUnregistration(int /*fd*/, bool /*replaced*/) override {}
+  void OnShutdown(SimpleEpollServer* eps, int fd) override {
+    eps->UnregisterFD(fd);
+  }
+  std::string Name() const override { return "EventCountingCB"; }
+
+  int num_events() const { return num_events_; }
+  int last_event_mask() const { return last_event_mask_; }
+
+ private:
+  int num_events_;
+  int last_event_mask_;
+};
+
+// All tests exercise the public SimpleEpollServer contract, so they pass in
+// both modes: driven through io_uring where the kernel supports it, and
+// through the epoll fallback everywhere else.
+
+TEST(IoUringEpollServerTest, ReadEventDelivered) {
+  IoUringEpollServer server;
+  EPOLL_LOG(INFO) << "io_uring "
+                  << (server.io_uring_enabled() ? "enabled" : "disabled");
+  EventCountingCB cb;
+  int pipe_fds[2];
+  ASSERT_EQ(0, pipe(pipe_fds));
+  server.RegisterFD(pipe_fds[0], &cb, EPOLLIN);
+
+  // Nothing to read yet; a zero-timeout wait delivers no event.
+  server.set_timeout_in_us(0);
+  server.WaitForEventsAndExecuteCallbacks();
+  EXPECT_EQ(0, cb.num_events());
+
+  char data = 'x';
+  ASSERT_EQ(1, write(pipe_fds[1], &data, 1));
+  server.set_timeout_in_us(-1);
+  server.WaitForEventsAndExecuteCallbacks();
+  EXPECT_EQ(1, cb.num_events());
+  EXPECT_TRUE(cb.last_event_mask() & EPOLLIN);
+
+  server.UnregisterFD(pipe_fds[0]);
+  close(pipe_fds[0]);
+  close(pipe_fds[1]);
+}
+
+TEST(IoUringEpollServerTest, EventsFollowModification) {
+  IoUringEpollServer server;
+  EventCountingCB cb;
+  int pipe_fds[2];
+  ASSERT_EQ(0, pipe(pipe_fds));
+  // The write side of a fresh pipe is immediately writable.
+  server.RegisterFD(pipe_fds[1], &cb, EPOLLOUT);
+  server.set_timeout_in_us(0);
+  server.WaitForEventsAndExecuteCallbacks();
+  EXPECT_EQ(1, cb.num_events());
+  EXPECT_TRUE(cb.last_event_mask() & EPOLLOUT);
+
+  // Dropping the write interest stops further events even though the fd
+  // stays writable.
+  server.ModifyCallback(pipe_fds[1], 0);
+  server.WaitForEventsAndExecuteCallbacks();
+  EXPECT_EQ(1, cb.num_events());
+
+  // Restoring it resumes delivery.
+  server.ModifyCallback(pipe_fds[1], EPOLLOUT);
+  server.WaitForEventsAndExecuteCallbacks();
+  EXPECT_EQ(2, cb.num_events());
+
+  server.UnregisterFD(pipe_fds[1]);
+  close(pipe_fds[0]);
+  close(pipe_fds[1]);
+}
+
+TEST(IoUringEpollServerTest, NoEventAfterUnregistration) {
+  IoUringEpollServer server;
+  EventCountingCB cb;
+  int pipe_fds[2];
+  ASSERT_EQ(0, pipe(pipe_fds));
+  server.RegisterFD(pipe_fds[0], &cb, EPOLLIN);
+  char data = 'x';
+  ASSERT_EQ(1, write(pipe_fds[1], &data, 1));
+  server.UnregisterFD(pipe_fds[0]);
+
+  server.set_timeout_in_us(0);
+  server.WaitForEventsAndExecuteCallbacks();
+  EXPECT_EQ(0, cb.num_events());
+
+  close(pipe_fds[0]);
+  close(pipe_fds[1]);
+}
+
+}  // namespace
+
+}  // namespace test
+
+}  // namespace epoll_server
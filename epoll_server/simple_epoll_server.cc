@@ -4,10 +4,11 @@
 
 #include "epoll_server/simple_epoll_server.h"
 
-#include <errno.h>   // for errno
-#include <stdlib.h>  // for abort
-#include <string.h>  // for strerror_r
-#include <unistd.h>  // For read, pipe, close and write.
+#include <errno.h>       // for errno
+#include <stdlib.h>      // for abort
+#include <string.h>      // for strerror_r
+#include <sys/socket.h>  // for setsockopt
+#include <unistd.h>      // For read, pipe, close and write.
 
 #include <algorithm>
 #include <utility>
@@ -100,15 +101,23 @@ class ReadPipeCallback : public EpollCallbackInterface {
 
 SimpleEpollServer::SimpleEpollServer()
     : epoll_fd_(epoll_create(1024)),
+      intrusive_dispatch_(false),
       timeout_in_us_(0),
       recorded_now_in_us_(0),
       ready_list_size_(0),
       wake_cb_(new ReadPipeCallback),
       read_fd_(-1),
       write_fd_(-1),
+      cross_thread_tasks_(nullptr),
       in_wait_for_events_and_execute_callbacks_(false),
       in_shutdown_(false),
-      last_delay_in_usec_(0) {
+      last_delay_in_usec_(0),
+      busy_poll_spin_budget_in_us_(0),
+      last_event_seen_time_in_us_(0),
+      iteration_cpu_budget_in_us_(0),
+      iteration_deadline_in_us_(0),
+      budget_exceeded_in_iteration_(false),
+      event_batch_size_(events_size_) {
   // ensure that the epoll_fd_ is valid.
   CHECK_NE(epoll_fd_, -1);
   LIST_INIT(&ready_list_);
@@ -175,6 +184,7 @@ SimpleEpollServer::~SimpleEpollServer() {
   LIST_INIT(&tmp_list_);
 
   CleanupTimeToAlarmCBMap();
+  CleanupCrossThreadTasks();
 
   close(read_fd_);
   close(write_fd_);
@@ -206,6 +216,24 @@ inline void SimpleEpollServer::RemoveFromReadyList(
   }
 }
 
+void SimpleEpollServer::EnableIntrusiveEventDispatch() {
+  if (intrusive_dispatch_) {
+    return;
+  }
+  intrusive_dispatch_ = true;
+  // Re-stamp every live registration (this includes the wake pipe registered
+  // in the constructor) so the kernel hands back the node pointer instead of
+  // the fd. Node pointers are stable: hash_set nodes do not move until
+  // erased, and UnregisterFD always removes the fd from the epoll set before
+  // erasing its node.
+  for (auto& cb_and_mask : cb_map_) {
+    if (cb_and_mask.cb != NULL) {
+      ControlFDWithNode(EPOLL_CTL_MOD,
+                        const_cast<CBAndEventMask*>(&cb_and_mask));
+    }
+  }
+}
+
 void SimpleEpollServer::RegisterFD(int fd, CB* cb, int event_mask) {
   CHECK(cb);
   EPOLL_VLOG(3) << "RegisterFD fd=" << fd << " event_mask=" << event_mask;
@@ -216,21 +244,35 @@ void SimpleEpollServer::RegisterFD(int fd, CB* cb, int event_mask) {
 
     // unregister any callback that may already be registered for this FD.
     CB* other_cb = fd_i->cb;
+    fd_i->event_mask = event_mask;
     if (other_cb) {
       // Must remove from the ready list before erasing.
       RemoveFromReadyList(*fd_i);
       other_cb->OnUnregistration(fd, true);
-      ModFD(fd, event_mask);
+      if (intrusive_dispatch_) {
+        ControlFDWithNode(EPOLL_CTL_MOD, const_cast<CBAndEventMask*>(&*fd_i));
+      } else {
+        ModFD(fd, event_mask);
+      }
     } else {
       // already unregistered, so just recycle the node.
-      AddFD(fd, event_mask);
+      if (intrusive_dispatch_) {
+        ControlFDWithNode(EPOLL_CTL_ADD, const_cast<CBAndEventMask*>(&*fd_i));
+      } else {
+        AddFD(fd, event_mask);
+      }
     }
     fd_i->cb = cb;
-    fd_i->event_mask = event_mask;
     fd_i->events_to_fake = 0;
   } else {
-    AddFD(fd, event_mask);
-    cb_map_.insert(CBAndEventMask(cb, event_mask, fd));
+    auto insert_result = cb_map_.insert(CBAndEventMask(cb, event_mask, fd));
+    if (intrusive_dispatch_) {
+      // The node must exist before the kernel learns its address.
+      ControlFDWithNode(EPOLL_CTL_ADD,
+                        const_cast<CBAndEventMask*>(&*insert_result.first));
+    } else {
+      AddFD(fd, event_mask);
+    }
   }
 
   // set the FD to be non-blocking.
@@ -262,6 +304,25 @@ void SimpleEpollServer::SetNonblocking(int fd) {
   }
 }
 
+// static
+bool SimpleEpollServer::SetSocketBusyPollUsec(int fd, int usecs) {
+#ifdef SO_BUSY_POLL
+  if (setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, &usecs, sizeof(usecs)) != 0) {
+    int saved_errno = errno;
+    char buf[kErrorBufferSize];
+    EPOLL_LOG(WARNING) << "Error " << saved_errno << " doing setsockopt(" << fd
+                       << ", SOL_SOCKET, SO_BUSY_POLL, " << usecs
+                       << "): " << strerror_r(saved_errno, buf, sizeof(buf));
+    return false;
+  }
+  return true;
+#else
+  (void)fd;
+  (void)usecs;
+  return false;
+#endif
+}
+
 int SimpleEpollServer::epoll_wait_impl(int epfd, struct epoll_event* events,
                                        int max_events, int timeout_in_ms) {
   return epoll_wait(epfd, events, max_events, timeout_in_ms);
@@ -342,6 +403,22 @@ void SimpleEpollServer::HandleEvent(int fd, int event_mask) {
   AddToReadyList(cb_and_mask);
 }
 
+void SimpleEpollServer::HandleEventForNode(CBAndEventMask* cb_and_mask,
+                                           int event_mask) {
+#ifdef EPOLL_SERVER_EVENT_TRACING
+  event_recorder_.RecordEpollEvent(cb_and_mask->fd, event_mask);
+#endif
+  if (cb_and_mask->cb == NULL) {
+    // The fd was unregistered while processing an earlier event in this
+    // batch. The node is kept alive (cb set to NULL) until the callback
+    // chain unwinds, so dereferencing it here is safe; just ignore the
+    // event like HandleEvent does.
+    return;
+  }
+  cb_and_mask->events_asserted = event_mask;
+  AddToReadyList(cb_and_mask);
+}
+
 void SimpleEpollServer::WaitForEventsAndExecuteCallbacks() {
   if (in_wait_for_events_and_execute_callbacks_) {
     EPOLL_LOG(DFATAL) << "Attempting to call WaitForEventsAndExecuteCallbacks"
@@ -353,6 +430,12 @@ void SimpleEpollServer::WaitForEventsAndExecuteCallbacks() {
   }
   AutoReset<bool> recursion_guard(&in_wait_for_events_and_execute_callbacks_,
                                   true);
+
+  // Run closures posted from other threads before doing any event or alarm
+  // work: a posted task commonly registers an alarm or arms a write, and
+  // draining first ensures those take effect in this very iteration.
+  ExecuteCrossThreadTasks();
+
   if (alarm_map_.empty()) {
     // no alarms, this is business as usual.
     WaitForEventsAndCallHandleEvents(timeout_in_us_, events_, events_size_);
@@ -391,6 +474,11 @@ void SimpleEpollServer::WaitForEventsAndExecuteCallbacks() {
   // wait for events.
 
   WaitForEventsAndCallHandleEvents(wait_time_in_us, events_, events_size_);
+  if (budget_exceeded_in_iteration_ && ready_list_size_ > 0) {
+    // The alarm pass below runs with events still deferred on the ready
+    // list, i.e. ahead of where it would have run without the budget.
+    ++cpu_budget_stats_.alarm_interleaves;
+  }
   CallAndReregisterAlarmEvents();
   recorded_now_in_us_ = 0;
 }
@@ -485,6 +573,57 @@ void SimpleEpollServer::Wake() {
   DCHECK_EQ(rv, 1);
 }
 
+void SimpleEpollServer::PostCrossThreadTask(std::function<void()> task) {
+  CrossThreadTask* node = new CrossThreadTask(std::move(task));
+  // Standard lock-free stack push: keep trying to swing the head from the
+  // value we last observed to our new node. Release ordering publishes the
+  // node's contents to the epoll thread's acquiring exchange in
+  // ExecuteCrossThreadTasks.
+  node->next = cross_thread_tasks_.load(std::memory_order_relaxed);
+  while (!cross_thread_tasks_.compare_exchange_weak(
+      node->next, node, std::memory_order_release, std::memory_order_relaxed)) {
+  }
+  // The pipe write is idempotent-enough: spurious wakeups just cost an empty
+  // drain, and ReadPipeCallback empties the pipe in one go regardless of how
+  // many producers wrote to it.
+  Wake();
+}
+
+void SimpleEpollServer::ExecuteCrossThreadTasks() {
+  CrossThreadTask* head =
+      cross_thread_tasks_.exchange(nullptr, std::memory_order_acquire);
+  if (head == nullptr) {
+    return;
+  }
+  // The detached list is in reverse posting order (it is a stack); reverse
+  // it so tasks run in the order they were posted.
+  CrossThreadTask* fifo = nullptr;
+  while (head != nullptr) {
+    CrossThreadTask* next = head->next;
+    head->next = fifo;
+    fifo = head;
+    head = next;
+  }
+  while (fifo != nullptr) {
+    std::unique_ptr<CrossThreadTask> task(fifo);
+    fifo = task->next;
+    task->task();
+  }
+}
+
+void SimpleEpollServer::CleanupCrossThreadTasks() {
+  // Tasks posted but never drained are freed without being run: by the time
+  // the destructor runs, invoking arbitrary closures against a half-torn-down
+  // epoll server would be unsafe.
+  CrossThreadTask* head =
+      cross_thread_tasks_.exchange(nullptr, std::memory_order_acquire);
+  while (head != nullptr) {
+    CrossThreadTask* next = head->next;
+    delete head;
+    head = next;
+  }
+}
+
 int64_t SimpleEpollServer::NowInUsec() const { return WallTimeNowInUsec(); }
 
 int64_t SimpleEpollServer::ApproximateNowInUsec() const {
@@ -593,6 +732,26 @@ void SimpleEpollServer::ModFD(int fd, int event_mask) const {
 
 ////////////////////////////////////////
 
+void SimpleEpollServer::ControlFDWithNode(int op,
+                                          CBAndEventMask* cb_and_mask) const {
+  struct epoll_event ee;
+  memset(&ee, 0, sizeof(ee));
+  ee.events = cb_and_mask->event_mask | EPOLLERR | EPOLLHUP;
+  ee.data.ptr = cb_and_mask;
+#ifdef EPOLL_SERVER_EVENT_TRACING
+  event_recorder_.RecordFDMaskEvent(cb_and_mask->fd, ee.events,
+                                    "ControlFDWithNode");
+#endif
+  if (epoll_ctl(epoll_fd_, op, cb_and_mask->fd, &ee)) {
+    int saved_errno = errno;
+    char buf[kErrorBufferSize];
+    EPOLL_LOG(FATAL) << "Epoll set control error for fd " << cb_and_mask->fd
+                     << ": " << strerror_r(saved_errno, buf, sizeof(buf));
+  }
+}
+
+////////////////////////////////////////
+
 void SimpleEpollServer::ModifyFD(int fd, int remove_event, int add_event) {
   auto fd_i = cb_map_.find(CBAndEventMask(NULL, 0, fd));
   if (cb_map_.end() == fd_i) {
@@ -609,7 +768,11 @@ void SimpleEpollServer::ModifyFD(int fd, int remove_event, int add_event) {
 
     EPOLL_VLOG(3) << " event_mask after: " << EventMaskToString(event_mask);
 
-    ModFD(fd, event_mask);
+    if (intrusive_dispatch_) {
+      ControlFDWithNode(EPOLL_CTL_MOD, const_cast<CBAndEventMask*>(&*fd_i));
+    } else {
+      ModFD(fd, event_mask);
+    }
 
     fd_i->cb->OnModification(fd, event_mask);
   }
@@ -617,9 +780,24 @@ void SimpleEpollServer::ModifyFD(int fd, int remove_event, int add_event) {
 
 void SimpleEpollServer::WaitForEventsAndCallHandleEvents(
     int64_t timeout_in_us, struct epoll_event events[], int events_size) {
+  if (iteration_cpu_budget_in_us_ > 0 && event_batch_size_ < events_size) {
+    // A smaller batch keeps the dispatch round small enough to fit within
+    // the CPU budget; the kernel retains whatever doesn't fit.
+    events_size = event_batch_size_;
+  }
+  bool spinning = false;
   if (timeout_in_us == 0 || ready_list_.lh_first != NULL) {
     // If ready list is not empty, then don't sleep at all.
     timeout_in_us = 0;
+  } else if (busy_poll_spin_budget_in_us_ > 0 &&
+             NowInUsec() - last_event_seen_time_in_us_ <=
+                 busy_poll_spin_budget_in_us_) {
+    // An event was seen within the spin budget: poll without sleeping so
+    // that the next packet is picked up with microsecond latency. The
+    // caller's event loop re-enters immediately, making this a spin.
+    timeout_in_us = 0;
+    spinning = true;
+    ++busy_poll_stats_.spin_loops;
   } else if (timeout_in_us < 0) {
     EPOLL_LOG(INFO) << "Negative epoll timeout: " << timeout_in_us
                     << "us; epoll will wait forever for events.";
@@ -652,6 +830,14 @@ void SimpleEpollServer::WaitForEventsAndCallHandleEvents(
   // time it takes to process all the events generated by epoll_wait.
   recorded_now_in_us_ = NowInUsec();
 
+  // The deadline is measured from after epoll_wait returns so that time
+  // spent blocked in the kernel does not count against the budget.
+  iteration_deadline_in_us_ = iteration_cpu_budget_in_us_ > 0
+                                  ? recorded_now_in_us_ +
+                                        iteration_cpu_budget_in_us_
+                                  : 0;
+  budget_exceeded_in_iteration_ = false;
+
   if (timeout_in_us > 0) {
     int64_t delta = NowInUsec() - expected_wakeup_us;
     last_delay_in_usec_ = delta > 0 ? delta : 0;
@@ -662,10 +848,27 @@ void SimpleEpollServer::WaitForEventsAndCallHandleEvents(
   }
 
   if (nfds > 0) {
-    for (int i = 0; i < nfds; ++i) {
-      int event_mask = events[i].events;
-      int fd = events[i].data.fd;
-      HandleEvent(fd, event_mask);
+    last_event_seen_time_in_us_ = recorded_now_in_us_;
+    if (busy_poll_spin_budget_in_us_ > 0) {
+      if (spinning) {
+        ++busy_poll_stats_.spin_wakeups;
+      } else {
+        ++busy_poll_stats_.blocking_wakeups;
+      }
+    }
+    if (intrusive_dispatch_) {
+      // The kernel handed back the registration node directly; no hash
+      // lookup is needed per event.
+      for (int i = 0; i < nfds; ++i) {
+        HandleEventForNode(static_cast<CBAndEventMask*>(events[i].data.ptr),
+                           events[i].events);
+      }
+    } else {
+      for (int i = 0; i < nfds; ++i) {
+        int event_mask = events[i].events;
+        int fd = events[i].data.fd;
+        HandleEvent(fd, event_mask);
+      }
     }
   } else if (nfds < 0) {
     // Catch interrupted syscall and just ignore it and move on.
@@ -681,6 +884,28 @@ void SimpleEpollServer::WaitForEventsAndCallHandleEvents(
   if (ready_list_.lh_first) {
     CallReadyListCallbacks();
   }
+
+  if (iteration_cpu_budget_in_us_ > 0) {
+    // Adapt the batch size: halve it after an over-budget iteration, and
+    // grow it back once a round of real events fits within the budget.
+    if (budget_exceeded_in_iteration_) {
+      event_batch_size_ /= 2;
+      if (event_batch_size_ < kMinEventBatchSize) {
+        event_batch_size_ = kMinEventBatchSize;
+      }
+    } else if (nfds > 0 && event_batch_size_ < events_size_) {
+      event_batch_size_ *= 2;
+      if (event_batch_size_ > events_size_) {
+        event_batch_size_ = events_size_;
+      }
+    }
+  }
+
+  if (spinning) {
+    // |expected_wakeup_us| was computed with a zero timeout, so it holds the
+    // entry time of this spin iteration.
+    busy_poll_stats_.total_spin_time_in_us += NowInUsec() - expected_wakeup_us;
+  }
 }
 
 void SimpleEpollServer::CallReadyListCallbacks() {
@@ -692,10 +917,41 @@ void SimpleEpollServer::CallReadyListCallbacks() {
   if (tmp_list_.lh_first) {
     tmp_list_.lh_first->entry.le_prev = &tmp_list_.lh_first;
     EpollEvent event(0);
+    int callbacks_run = 0;
     while (tmp_list_.lh_first != NULL) {
       DCHECK_GT(ready_list_size_, 0);
+      if (iteration_deadline_in_us_ > 0 && callbacks_run > 0 &&
+          NowInUsec() >= iteration_deadline_in_us_) {
+        // The CPU budget is exhausted: push the rest of the batch back to
+        // the ready list (their asserted/faked events are still intact) and
+        // yield to alarm processing.  The non-empty ready list forces a
+        // zero timeout on the next epoll_wait, so deferred callbacks run
+        // again without sleeping.
+        budget_exceeded_in_iteration_ = true;
+        ++cpu_budget_stats_.budget_exceeded_iterations;
+        while (tmp_list_.lh_first != NULL) {
+          CBAndEventMask* deferred = tmp_list_.lh_first;
+          tmp_list_.lh_first = deferred->entry.le_next;
+          if (tmp_list_.lh_first != NULL) {
+            tmp_list_.lh_first->entry.le_prev = &tmp_list_.lh_first;
+          }
+          deferred->entry.le_prev = NULL;
+          --ready_list_size_;
+          AddToReadyList(deferred);
+          ++cpu_budget_stats_.events_deferred;
+        }
+        break;
+      }
       CBAndEventMask* cb_and_mask = tmp_list_.lh_first;
-      RemoveFromReadyList(*cb_and_mask);
+      // Pop the head directly rather than going through the generic
+      // RemoveFromReadyList(): the head has no predecessor node, so there is
+      // no need to consult le_prev or re-link a previous entry.
+      tmp_list_.lh_first = cb_and_mask->entry.le_next;
+      if (tmp_list_.lh_first != NULL) {
+        tmp_list_.lh_first->entry.le_prev = &tmp_list_.lh_first;
+      }
+      cb_and_mask->entry.le_prev = NULL;
+      --ready_list_size_;
 
       event.out_ready_mask = 0;
       event.in_events =
@@ -711,6 +967,7 @@ void SimpleEpollServer::CallReadyListCallbacks() {
         AutoReset<bool> in_use_guard(&(cb_and_mask->in_use), true);
         cb_and_mask->cb->OnEvent(cb_and_mask->fd, &event);
       }
+      ++callbacks_run;
 
       // Since OnEvent may have called UnregisterFD, we must check here that
       // the callback is still valid. If it isn't, then UnregisterFD *was*
@@ -722,6 +979,13 @@ void SimpleEpollServer::CallReadyListCallbacks() {
         AddToReadyList(cb_and_mask);
       }
     }
+    if (iteration_deadline_in_us_ > 0 && !budget_exceeded_in_iteration_ &&
+        NowInUsec() >= iteration_deadline_in_us_) {
+      // The batch drained, but ran over budget doing so; note it so that the
+      // next epoll_wait uses a smaller batch.
+      budget_exceeded_in_iteration_ = true;
+      ++cpu_budget_stats_.budget_exceeded_iterations;
+    }
   }
   DCHECK(tmp_list_.lh_first == NULL);
 }
@@ -747,6 +1011,12 @@ void SimpleEpollServer::CallAndReregisterAlarmEvents() {
       ++i;
       continue;
     }
+    if (iteration_cpu_budget_in_us_ > 0) {
+      const int64_t lateness_in_us = now_in_us - i->first;
+      if (lateness_in_us > cpu_budget_stats_.max_alarm_lateness_in_us) {
+        cpu_budget_stats_.max_alarm_lateness_in_us = lateness_in_us;
+      }
+    }
     all_alarms_.erase(cb);
     const int64_t new_timeout_time_in_us = cb->OnAlarm();
 
@@ -10,6 +10,8 @@
 #include <stdint.h>
 #include <sys/queue.h>
 
+#include <atomic>
+#include <functional>
 #include <map>
 #include <memory>
 #include <string>
@@ -147,6 +149,26 @@ class EPOLL_EXPORT_PRIVATE SimpleEpollServer {
 
   ////////////////////////////////////////
 
+  // Summary:
+  //   Enables intrusive event dispatch. Each epoll registration then stores
+  //   a pointer to the fd's registration node in epoll_event.data.ptr, so a
+  //   ready event is dispatched directly to the node instead of going
+  //   through the per-event hash lookup in cb_map_. With hundreds of
+  //   thousands of registered fds that lookup cache-misses on nearly every
+  //   event, so bypassing it measurably lowers dispatch cost on busy
+  //   servers. The map is still maintained for control-plane operations
+  //   (UnregisterFD, ModifyCallback, the ready list setters), which are off
+  //   the hot path.
+  //
+  //   Registrations made before the call (including the internal wake pipe)
+  //   are re-stamped with their node pointer, so this may be called at any
+  //   time. Subclasses which override AddFD/ModFD to drive a different
+  //   polling backend must not enable this mode, since those overrides
+  //   cannot stamp the node pointer into the kernel registration.
+  void EnableIntrusiveEventDispatch();
+
+  ////////////////////////////////////////
+
   // Summary
   //   Register a callback to be called whenever an event contained
   //   in the set of events included in event_mask occurs on the
@@ -423,6 +445,22 @@ class EPOLL_EXPORT_PRIVATE SimpleEpollServer {
   //   Force the epoll server to wake up (by writing to an internal pipe).
   virtual void Wake();
 
+  // Summary:
+  //   Schedules 'task' to run on the thread which calls
+  //   WaitForEventsAndExecuteCallbacks, and wakes that thread if it is
+  //   blocked in epoll_wait. Unlike every other method of this class, this
+  //   one may safely be called from any thread. Producers contend only on a
+  //   single atomic exchange (no mutex), so posting from worker threads is
+  //   cheap even when many of them complete work simultaneously.
+  //
+  //   Tasks are executed in the order they were posted, at the top of the
+  //   next WaitForEventsAndExecuteCallbacks call, before any fd events or
+  //   alarms are processed. Tasks still queued when the epoll server is
+  //   destroyed are discarded without being run.
+  // Args:
+  //   task - the closure to run on the epoll thread.
+  virtual void PostCrossThreadTask(std::function<void()> task);
+
   // Summary:
   //   Wrapper around WallTimer's NowInUsec.  We do this so that we can test
   //   SimpleEpollServer without using the system clock (and can avoid the
@@ -501,6 +539,91 @@ class EPOLL_EXPORT_PRIVATE SimpleEpollServer {
 
   int64_t LastDelayInUsec() const { return last_delay_in_usec_; }
 
+  // Summary:
+  //   Statistics maintained while a busy-poll spin budget is set, for tuning
+  //   the spin budget against CPU burn.  Times are wall time microseconds.
+  struct BusyPollStats {
+    // Nonblocking polls issued because an event was seen recently.
+    int64_t spin_loops = 0;
+    // Of those, polls which found at least one event.
+    int64_t spin_wakeups = 0;
+    // Events found by a blocking epoll_wait after the spin budget expired.
+    int64_t blocking_wakeups = 0;
+    // Wall time spent in spin iterations, including callback execution.
+    int64_t total_spin_time_in_us = 0;
+  };
+
+  // Summary:
+  //   Enables adaptive busy-polling.  While any event has been seen within
+  //   the last spin_budget_in_us microseconds, WaitForEventsAndExecute-
+  //   Callbacks() polls epoll without sleeping instead of blocking, so that
+  //   a caller driving it in a loop picks up new packets with microsecond
+  //   rather than millisecond wakeup latency.  Once the budget expires with
+  //   no events seen, the server falls back to the blocking wait configured
+  //   with set_timeout_in_us().  A budget of 0 (the default) disables
+  //   spinning.
+  void set_busy_poll_spin_budget_in_us(int64_t spin_budget_in_us) {
+    busy_poll_spin_budget_in_us_ = spin_budget_in_us;
+  }
+
+  int64_t busy_poll_spin_budget_in_us() const {
+    return busy_poll_spin_budget_in_us_;
+  }
+
+  const BusyPollStats& busy_poll_stats() const { return busy_poll_stats_; }
+
+  void ResetBusyPollStats() { busy_poll_stats_ = BusyPollStats(); }
+
+  // Summary:
+  //   Requests kernel-side busy polling of usecs microseconds on fd via
+  //   SO_BUSY_POLL, complementing the userspace spin.  Returns false if the
+  //   option is not supported or cannot be set.
+  static bool SetSocketBusyPollUsec(int fd, int usecs);
+
+  // Summary:
+  //   Statistics maintained while a per-iteration CPU budget is set, for
+  //   tuning the budget against dispatch throughput.  Times are wall time
+  //   microseconds.
+  struct CpuBudgetStats {
+    // Iterations which exhausted the CPU budget before draining the ready
+    // list.
+    int64_t budget_exceeded_iterations = 0;
+    // Ready callbacks pushed back to the next iteration because the budget
+    // was exhausted.
+    int64_t events_deferred = 0;
+    // Alarm-processing passes which ran while events were still deferred,
+    // i.e. passes which would otherwise have waited for the full burst.
+    int64_t alarm_interleaves = 0;
+    // Largest observed gap between an alarm's deadline and the time at
+    // which it actually fired.
+    int64_t max_alarm_lateness_in_us = 0;
+  };
+
+  // Summary:
+  //   Bounds the CPU spent dispatching fd events in one iteration of
+  //   WaitForEventsAndExecuteCallbacks().  Once a dispatch round has run
+  //   for cpu_budget_in_us microseconds, the remaining ready callbacks are
+  //   deferred to the next iteration so that alarm processing is not
+  //   starved by a burst on a few hot fds.  The epoll_wait() batch size
+  //   adapts alongside: it halves after an over-budget iteration (down to
+  //   kMinEventBatchSize) and doubles again once iterations fit the budget.
+  //   At least one callback always runs per iteration, so progress is
+  //   guaranteed even with a tiny budget.  A budget of 0 (the default)
+  //   disables the governor.
+  void set_iteration_cpu_budget_in_us(int64_t cpu_budget_in_us) {
+    iteration_cpu_budget_in_us_ = cpu_budget_in_us;
+  }
+
+  int64_t iteration_cpu_budget_in_us() const {
+    return iteration_cpu_budget_in_us_;
+  }
+
+  const CpuBudgetStats& cpu_budget_stats() const { return cpu_budget_stats_; }
+
+  void ResetCpuBudgetStats() { cpu_budget_stats_ = CpuBudgetStats(); }
+
+  int event_batch_size_for_test() const { return event_batch_size_; }
+
  protected:
   virtual void SetNonblocking(int fd);
 
@@ -636,6 +759,28 @@ class EPOLL_EXPORT_PRIVATE SimpleEpollServer {
 
   ////////////////////////////////////////
 
+  // Summary:
+  //   Adds or modifies (per 'op', an EPOLL_CTL_* constant) the kernel
+  //   registration for cb_and_mask's fd, with epoll_event.data.ptr pointing
+  //   at the node itself. Only used in intrusive dispatch mode.
+  // Args:
+  //   op - EPOLL_CTL_ADD or EPOLL_CTL_MOD
+  //   cb_and_mask - the registration node whose fd and event mask are used
+  void ControlFDWithNode(int op, CBAndEventMask* cb_and_mask) const;
+
+  ////////////////////////////////////////
+
+  // Summary:
+  //   The intrusive dispatch counterpart of HandleEvent(): records the
+  //   asserted events on the node the kernel handed back and puts it on the
+  //   ready list, without any map lookup.
+  // Args:
+  //   cb_and_mask - the registration node from epoll_event.data.ptr
+  //   event_mask - a bitmask representing the events which have occurred
+  void HandleEventForNode(CBAndEventMask* cb_and_mask, int event_mask);
+
+  ////////////////////////////////////////
+
   // Summary:
   //   Waits for events, and calls HandleEvents() for each
   //   fd, event pair discovered to possibly have an event.
@@ -670,6 +815,11 @@ class EPOLL_EXPORT_PRIVATE SimpleEpollServer {
   // The mapping of file-descriptor to CBAndEventMasks
   FDToCBMap cb_map_;
 
+  // If true, kernel registrations carry a pointer to their CBAndEventMask
+  // and ready events bypass the cb_map_ lookup. See
+  // EnableIntrusiveEventDispatch().
+  bool intrusive_dispatch_;
+
   // Custom hash function to be used by hash_set.
   struct AlarmCBHash {
     size_t operator()(AlarmCB* const& p) const {
@@ -715,6 +865,9 @@ class EPOLL_EXPORT_PRIVATE SimpleEpollServer {
   // TODO(alyssar): make this into something that scales up.
   static const int events_size_ = 256;
   struct epoll_event events_[256];
+  // Floor for the adaptive epoll_wait batch size used while an iteration
+  // CPU budget is set.
+  static const int kMinEventBatchSize = 8;
 
 #ifdef EPOLL_SERVER_EVENT_TRACING
   struct EventRecorder {
@@ -944,6 +1097,24 @@ class EPOLL_EXPORT_PRIVATE SimpleEpollServer {
   void CleanupFDToCBMap();
   void CleanupTimeToAlarmCBMap();
 
+  // Node in the lock-free multi-producer single-consumer stack used by
+  // PostCrossThreadTask. Producers push nodes with an atomic exchange on
+  // cross_thread_tasks_; the epoll thread detaches the entire stack at once
+  // and reverses it to recover posting order.
+  struct CrossThreadTask {
+    explicit CrossThreadTask(std::function<void()> t) : task(std::move(t)) {}
+
+    std::function<void()> task;
+    CrossThreadTask* next = nullptr;
+  };
+
+  // Runs (in FIFO order) every task posted via PostCrossThreadTask since the
+  // last drain. Called only from the epoll thread.
+  void ExecuteCrossThreadTasks();
+
+  // Frees queued tasks without running them. Used in the destructor.
+  void CleanupCrossThreadTasks();
+
   // The callback registered to the fds below.  As the purpose of their
   // registration is to wake the epoll server it just clears the pipe and
   // returns.
@@ -954,6 +1125,11 @@ class EPOLL_EXPORT_PRIVATE SimpleEpollServer {
   int read_fd_;
   int write_fd_;
 
+  // Top of the stack of tasks posted by PostCrossThreadTask but not yet run.
+  // This is the only member of the class which may be touched from threads
+  // other than the epoll thread.
+  std::atomic<CrossThreadTask*> cross_thread_tasks_;
+
   // This boolean is checked to see if it is false at the top of the
   // WaitForEventsAndExecuteCallbacks function. If not, then it either returns
   // without doing work, and logs to ERROR, or aborts the program (in
@@ -964,6 +1140,33 @@ class EPOLL_EXPORT_PRIVATE SimpleEpollServer {
   // Returns true when the SimpleEpollServer() is being destroyed.
   bool in_shutdown_;
   int64_t last_delay_in_usec_;
+
+  // Spin budget for adaptive busy-polling; 0 disables spinning.
+  int64_t busy_poll_spin_budget_in_us_;
+
+  // Wall time at which epoll_wait last reported an event, used to decide
+  // whether the spin budget has expired.
+  int64_t last_event_seen_time_in_us_;
+
+  BusyPollStats busy_poll_stats_;
+
+  // CPU budget for one event-dispatch iteration; 0 disables the governor.
+  int64_t iteration_cpu_budget_in_us_;
+
+  // Absolute time at which the current dispatch iteration must yield, or 0
+  // when no budget is set.
+  int64_t iteration_deadline_in_us_;
+
+  // True while the current iteration has blown its deadline and deferred
+  // the rest of its callbacks back to the ready list.
+  bool budget_exceeded_in_iteration_;
+
+  // Number of events requested from epoll_wait per iteration while a budget
+  // is set; halves on over-budget iterations and doubles when a round of
+  // events fits within the budget.
+  int event_batch_size_;
+
+  CpuBudgetStats cpu_budget_stats_;
 };
 
 class EpollAlarmCallbackInterface {
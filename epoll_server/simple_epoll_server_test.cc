@@ -18,6 +18,7 @@
 #include <cstddef>
 #include <cstdlib>
 #include <cstring>
+#include <functional>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -513,6 +514,43 @@ TEST_F(EpollFunctionTest, TestNumFDsRegistered) {
   EXPECT_EQ(0, ep()->NumFDsRegistered());
 }
 
+TEST_F(EpollFunctionTest, TestIntrusiveEventDispatch) {
+  // Events must reach the callback without the cb_map_ lookup when intrusive
+  // dispatch is enabled before registration.
+  ep()->EnableIntrusiveEventDispatch();
+  ep()->RegisterFD(fd(), cb(), EPOLLIN);
+
+  // Make the read end of the pipe ready.
+  write(fd2(), "x", 1);
+  ep()->WaitForEventsAndExecuteCallbacks();
+
+  Recorder tmp;
+  tmp.Record(cb(), CREATION, 0, 0);
+  tmp.Record(cb(), REGISTRATION, fd(), EPOLLIN);
+  tmp.Record(cb(), EVENT, fd(), EPOLLIN);
+  EXPECT_TRUE(recorder()->IsEqual(&tmp));
+
+  ep()->UnregisterFD(fd());
+}
+
+TEST_F(EpollFunctionTest, TestIntrusiveEventDispatchEnabledAfterRegister) {
+  // Registrations made before the mode is enabled are re-stamped with their
+  // node pointer, so events registered earlier must still be dispatched.
+  ep()->RegisterFD(fd(), cb(), EPOLLIN);
+  ep()->EnableIntrusiveEventDispatch();
+
+  write(fd2(), "x", 1);
+  ep()->WaitForEventsAndExecuteCallbacks();
+
+  Recorder tmp;
+  tmp.Record(cb(), CREATION, 0, 0);
+  tmp.Record(cb(), REGISTRATION, fd(), EPOLLIN);
+  tmp.Record(cb(), EVENT, fd(), EPOLLIN);
+  EXPECT_TRUE(recorder()->IsEqual(&tmp));
+
+  ep()->UnregisterFD(fd());
+}
+
 // Check all of the individual signals and 1-2 combinations.
 TEST_F(EpollFunctionTest, TestEventMaskToString) {
   std::string test;
@@ -1424,6 +1462,191 @@ TEST(SimpleEpollServerTest, TestWrite) {
   close(write_fd);
 }
 
+TEST(SimpleEpollServerTest, BusyPollStats) {
+  SimpleEpollServer ep;
+  ep.set_timeout_in_us(1);
+  char data[kPageSize] = {0};
+
+  int pipe_fds[2];
+  if (pipe(pipe_fds) < 0) {
+    EPOLL_PLOG(FATAL) << "pipe() failed";
+  }
+  int read_fd = pipe_fds[0];
+  int write_fd = pipe_fds[1];
+
+  RecordingCB recording_cb;
+  ep.RegisterFD(read_fd, &recording_cb, EPOLLIN);
+
+  // Without a spin budget, no busy-poll stats accumulate.
+  EXPECT_EQ(1, write(write_fd, data, 1));
+  ep.WaitForEventsAndExecuteCallbacks();
+  EXPECT_EQ(0, ep.busy_poll_stats().spin_loops);
+  EXPECT_EQ(0, ep.busy_poll_stats().spin_wakeups);
+  EXPECT_EQ(0, ep.busy_poll_stats().blocking_wakeups);
+
+  // An event was just seen, so with a generous budget the next event is
+  // picked up by a nonblocking spin iteration.
+  ep.set_busy_poll_spin_budget_in_us(10 * 1000 * 1000);
+  EXPECT_EQ(1, write(write_fd, data, 1));
+  ep.WaitForEventsAndExecuteCallbacks();
+  EXPECT_GE(ep.busy_poll_stats().spin_loops, 1);
+  EXPECT_EQ(1, ep.busy_poll_stats().spin_wakeups);
+  EXPECT_EQ(0, ep.busy_poll_stats().blocking_wakeups);
+
+  // After sitting idle for longer than a one-microsecond budget, the next
+  // wakeup comes from the blocking path again.
+  ep.set_busy_poll_spin_budget_in_us(1);
+  usleep(1000);
+  EXPECT_EQ(1, write(write_fd, data, 1));
+  ep.WaitForEventsAndExecuteCallbacks();
+  EXPECT_EQ(1, ep.busy_poll_stats().spin_wakeups);
+  EXPECT_EQ(1, ep.busy_poll_stats().blocking_wakeups);
+
+  ep.ResetBusyPollStats();
+  EXPECT_EQ(0, ep.busy_poll_stats().spin_loops);
+  EXPECT_EQ(0, ep.busy_poll_stats().blocking_wakeups);
+
+  ep.UnregisterFD(read_fd);
+  close(read_fd);
+  close(write_fd);
+}
+
+// Drains the pipe like RecordingCB, then burns wall time so that a small
+// iteration CPU budget is exceeded after a single callback.
+class SleepingCB : public EpollCallbackInterface {
+ public:
+  SleepingCB() : events_seen_(0), sleep_in_us_(500) {}
+
+  void OnRegistration(SimpleEpollServer* /*eps*/, int /*fd*/,
+                      int /*event_mask*/) override {}
+  void OnModification(int /*fd*/, int /*event_mask*/) override {}
+  void OnEvent(int fd, EpollEvent* event) override {
+    ++events_seen_;
+    if (event->in_events & EPOLLIN) {
+      char buf[kPageSize];
+      int data_read;
+      do {
+        data_read = read(fd, buf, sizeof(buf));
+      } while (data_read > 0);
+    }
+    if (sleep_in_us_ > 0) {
+      usleep(sleep_in_us_);
+    }
+  }
+  void OnUnregistration(int /*fd*/, bool /*replaced*/) override {}
+  void OnShutdown(SimpleEpollServer* eps, int fd) override {
+    eps->UnregisterFD(fd);
+  }
+  std::string Name() const override { return "SleepingCB"; }
+
+  int events_seen() const { return events_seen_; }
+  void set_sleep_in_us(int sleep_in_us) { sleep_in_us_ = sleep_in_us; }
+
+ private:
+  int events_seen_;
+  int sleep_in_us_;
+};
+
+TEST(SimpleEpollServerTest, CpuBudgetDefersEventsAndInterleavesAlarms) {
+  SimpleEpollServer ep;
+  ep.set_timeout_in_us(1);
+  char data = 'x';
+
+  int pipe_one[2];
+  if (pipe(pipe_one) < 0) {
+    EPOLL_PLOG(FATAL) << "pipe() failed";
+  }
+  int pipe_two[2];
+  if (pipe(pipe_two) < 0) {
+    EPOLL_PLOG(FATAL) << "pipe() failed";
+  }
+
+  SleepingCB cb_one;
+  SleepingCB cb_two;
+  ep.RegisterFD(pipe_one[0], &cb_one, EPOLLIN);
+  ep.RegisterFD(pipe_two[0], &cb_two, EPOLLIN);
+
+  TestAlarm alarm;
+  ep.RegisterAlarm(WallTimeNowInUsec(), &alarm);
+
+  // With both pipes hot and a one-microsecond budget, a single slow callback
+  // exhausts the budget and the second event is deferred.
+  ep.set_iteration_cpu_budget_in_us(1);
+  EXPECT_EQ(1, write(pipe_one[1], &data, 1));
+  EXPECT_EQ(1, write(pipe_two[1], &data, 1));
+  // Let the alarm go measurably past due before the iteration runs.
+  usleep(1000);
+  ep.WaitForEventsAndExecuteCallbacks();
+  EXPECT_EQ(1, cb_one.events_seen() + cb_two.events_seen());
+  EXPECT_EQ(1u, ep.ReadyListSize());
+  EXPECT_EQ(1, ep.cpu_budget_stats().budget_exceeded_iterations);
+  EXPECT_EQ(1, ep.cpu_budget_stats().events_deferred);
+
+  // The alarm still fired in the same iteration, ahead of the deferred
+  // event, and its lateness was recorded.
+  EXPECT_TRUE(alarm.was_called());
+  EXPECT_EQ(1, ep.cpu_budget_stats().alarm_interleaves);
+  EXPECT_GT(ep.cpu_budget_stats().max_alarm_lateness_in_us, 0);
+
+  // The deferred callback runs on the next iteration without a new write.
+  ep.WaitForEventsAndExecuteCallbacks();
+  EXPECT_EQ(2, cb_one.events_seen() + cb_two.events_seen());
+  EXPECT_EQ(0u, ep.ReadyListSize());
+
+  ep.ResetCpuBudgetStats();
+  EXPECT_EQ(0, ep.cpu_budget_stats().budget_exceeded_iterations);
+  EXPECT_EQ(0, ep.cpu_budget_stats().events_deferred);
+
+  ep.UnregisterFD(pipe_one[0]);
+  ep.UnregisterFD(pipe_two[0]);
+  close(pipe_one[0]);
+  close(pipe_one[1]);
+  close(pipe_two[0]);
+  close(pipe_two[1]);
+}
+
+TEST(SimpleEpollServerTest, CpuBudgetAdaptsEventBatchSize) {
+  SimpleEpollServer ep;
+  ep.set_timeout_in_us(1);
+  char data = 'x';
+
+  int pipe_fds[2];
+  if (pipe(pipe_fds) < 0) {
+    EPOLL_PLOG(FATAL) << "pipe() failed";
+  }
+  int read_fd = pipe_fds[0];
+  int write_fd = pipe_fds[1];
+
+  SleepingCB slow_cb;
+  ep.RegisterFD(read_fd, &slow_cb, EPOLLIN);
+
+  EXPECT_EQ(256, ep.event_batch_size_for_test());
+
+  // Over-budget iterations halve the batch size.
+  ep.set_iteration_cpu_budget_in_us(1);
+  EXPECT_EQ(1, write(write_fd, &data, 1));
+  ep.WaitForEventsAndExecuteCallbacks();
+  EXPECT_EQ(128, ep.event_batch_size_for_test());
+  EXPECT_EQ(1, write(write_fd, &data, 1));
+  ep.WaitForEventsAndExecuteCallbacks();
+  EXPECT_EQ(64, ep.event_batch_size_for_test());
+
+  // Iterations that fit within the budget double it back toward the
+  // events_ array capacity.
+  slow_cb.set_sleep_in_us(0);
+  ep.set_iteration_cpu_budget_in_us(10 * 1000 * 1000);
+  EXPECT_EQ(1, write(write_fd, &data, 1));
+  ep.WaitForEventsAndExecuteCallbacks();
+  EXPECT_EQ(128, ep.event_batch_size_for_test());
+  EXPECT_EQ(1, write(write_fd, &data, 1));
+  ep.WaitForEventsAndExecuteCallbacks();
+  EXPECT_EQ(256, ep.event_batch_size_for_test());
+
+  ep.UnregisterFD(read_fd);
+  close(read_fd);
+  close(write_fd);
+}
+
 TEST(SimpleEpollServerTest, TestReadWrite) {
   SimpleEpollServer ep;
   ep.set_timeout_in_us(1);
@@ -2062,6 +2285,66 @@ TEST(EpollServerTest, TestWake) {
   eps_thread.Join();
 }
 
+TEST(EpollServerTest, TestCrossThreadTasksRunInPostingOrder) {
+  SimpleEpollServer eps;
+  std::vector<int> order;
+  for (int i = 0; i < 3; ++i) {
+    eps.PostCrossThreadTask([&order, i]() { order.push_back(i); });
+  }
+  // The tasks were pushed onto a LIFO stack; the drain at the top of
+  // WaitForEventsAndExecuteCallbacks must restore FIFO order.
+  eps.WaitForEventsAndExecuteCallbacks();
+  ASSERT_EQ(3u, order.size());
+  EXPECT_EQ(0, order[0]);
+  EXPECT_EQ(1, order[1]);
+  EXPECT_EQ(2, order[2]);
+}
+
+// Runs WaitForEventsAndExecuteCallbacks until a posted task calls Quit().
+class EPSTaskLoopThread : public EpollThread {
+ public:
+  explicit EPSTaskLoopThread(SimpleEpollServer* eps)
+      : EpollThread("EPSTaskLoop"), eps_(eps) {}
+
+  void Run() override {
+    while (!quit_) {
+      eps_->WaitForEventsAndExecuteCallbacks();
+    }
+  }
+
+  // Only safe to call from the epoll thread (i.e. from a posted task).
+  void Quit() { quit_ = true; }
+
+ private:
+  SimpleEpollServer* eps_;
+  bool quit_ = false;
+};
+
+TEST(EpollServerTest, TestPostCrossThreadTaskWakesBlockedServer) {
+  SimpleEpollServer eps;
+  eps.set_timeout_in_us(-1);
+  EPSTaskLoopThread eps_thread(&eps);
+  eps_thread.Start();
+
+  // The epoll thread is (or soon will be) blocked in epoll_wait with an
+  // infinite timeout. The post must wake it; the task runs on the epoll
+  // thread and tells the loop to exit, which is what allows Join() to
+  // return.
+  eps.PostCrossThreadTask([&eps_thread]() { eps_thread.Quit(); });
+  eps_thread.Join();
+}
+
+TEST(EpollServerTest, TestCrossThreadTasksDiscardedAtShutdown) {
+  bool ran = false;
+  {
+    SimpleEpollServer eps;
+    eps.PostCrossThreadTask([&ran]() { ran = true; });
+    // eps is destroyed without another WaitForEventsAndExecuteCallbacks
+    // call; the queued task must be freed without being run.
+  }
+  EXPECT_FALSE(ran);
+}
+
 class UnRegisterWhileProcessingCB: public EpollCallbackInterface {
  public:
   explicit UnRegisterWhileProcessingCB(int fd) : eps_(nullptr), fd_(fd) {}
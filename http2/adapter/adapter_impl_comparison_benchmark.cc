@@ -0,0 +1,319 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Benchmarks OgHttp2Adapter against NgHttp2Adapter on identical high-volume
+// scenarios, complementing the behavioral checks in
+// adapter_impl_comparison_test.cc with performance data.  Each scenario feeds
+// one pre-serialized client connection to a server-side adapter over an
+// in-memory pipe; the reported counters cover CPU (ns_per_iteration),
+// allocations, and bytes crossing the adapter boundary.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "http2/adapter/http2_adapter.h"
+#include "http2/adapter/http2_protocol.h"
+#include "http2/adapter/http2_visitor_interface.h"
+#include "http2/adapter/nghttp2_adapter.h"
+#include "http2/adapter/oghttp2_adapter.h"
+#include "http2/adapter/test_frame_sequence.h"
+#include "common/platform/api/quiche_benchmark.h"
+
+namespace {
+
+// Number of heap allocations made by this binary. Maintained by the
+// replacement allocation functions below.
+int64_t g_num_allocations = 0;
+
+}  // namespace
+
+// Replacing the global allocation functions is safe here because this
+// translation unit only links into the benchmark binary.
+void* operator new(size_t size) {
+  ++g_num_allocations;
+  void* ptr = malloc(size);
+  if (ptr == nullptr) {
+    abort();
+  }
+  return ptr;
+}
+
+void* operator new[](size_t size) {
+  ++g_num_allocations;
+  void* ptr = malloc(size);
+  if (ptr == nullptr) {
+    abort();
+  }
+  return ptr;
+}
+
+void operator delete(void* ptr) noexcept { free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { free(ptr); }
+void operator delete[](void* ptr) noexcept { free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { free(ptr); }
+
+namespace http2 {
+namespace adapter {
+namespace test {
+namespace {
+
+// Accepts every event and only counts the bytes crossing the adapter
+// boundary: frames the adapter wants written, plus header and data payloads
+// delivered to the application.
+class BenchmarkVisitor : public Http2VisitorInterface {
+ public:
+  int64_t OnReadyToSend(absl::string_view serialized) override {
+    bytes_copied_ += serialized.size();
+    return serialized.size();
+  }
+  void OnConnectionError(ConnectionError /*error*/) override { ++errors_; }
+  void OnSettingsStart() override {}
+  void OnSetting(Http2Setting /*setting*/) override {}
+  void OnSettingsEnd() override {}
+  void OnSettingsAck() override {}
+  bool OnBeginHeadersForStream(Http2StreamId /*stream_id*/) override {
+    return true;
+  }
+  OnHeaderResult OnHeaderForStream(Http2StreamId /*stream_id*/,
+                                   absl::string_view key,
+                                   absl::string_view value) override {
+    bytes_copied_ += key.size() + value.size();
+    return HEADER_OK;
+  }
+  bool OnEndHeadersForStream(Http2StreamId /*stream_id*/) override {
+    return true;
+  }
+  bool OnBeginDataForStream(Http2StreamId /*stream_id*/,
+                            size_t /*payload_length*/) override {
+    return true;
+  }
+  bool OnDataForStream(Http2StreamId /*stream_id*/,
+                       absl::string_view data) override {
+    bytes_copied_ += data.size();
+    return true;
+  }
+  void OnEndStream(Http2StreamId /*stream_id*/) override {}
+  void OnRstStream(Http2StreamId /*stream_id*/,
+                   Http2ErrorCode /*error_code*/) override {}
+  void OnCloseStream(Http2StreamId /*stream_id*/,
+                     Http2ErrorCode /*error_code*/) override {}
+  void OnPriorityForStream(Http2StreamId /*stream_id*/,
+                           Http2StreamId /*parent_stream_id*/, int /*weight*/,
+                           bool /*exclusive*/) override {}
+  void OnPing(Http2PingId /*ping_id*/, bool /*is_ack*/) override {}
+  void OnPushPromiseForStream(Http2StreamId /*stream_id*/,
+                              Http2StreamId /*promised_stream_id*/) override {}
+  bool OnGoAway(Http2StreamId /*last_accepted_stream_id*/,
+                Http2ErrorCode /*error_code*/,
+                absl::string_view /*opaque_data*/) override {
+    return true;
+  }
+  void OnWindowUpdate(Http2StreamId /*stream_id*/,
+                      int /*window_increment*/) override {}
+  int OnBeforeFrameSent(uint8_t /*frame_type*/, Http2StreamId /*stream_id*/,
+                        size_t /*length*/, uint8_t /*flags*/) override {
+    return 0;
+  }
+  int OnFrameSent(uint8_t /*frame_type*/, Http2StreamId /*stream_id*/,
+                  size_t /*length*/, uint8_t /*flags*/,
+                  uint32_t /*error_code*/) override {
+    return 0;
+  }
+  bool OnInvalidFrame(Http2StreamId /*stream_id*/,
+                      InvalidFrameError /*error*/) override {
+    return true;
+  }
+  void OnBeginMetadataForStream(Http2StreamId /*stream_id*/,
+                                size_t /*payload_length*/) override {}
+  bool OnMetadataForStream(Http2StreamId /*stream_id*/,
+                           absl::string_view /*metadata*/) override {
+    return true;
+  }
+  bool OnMetadataEndForStream(Http2StreamId /*stream_id*/) override {
+    return true;
+  }
+  void OnErrorDebug(absl::string_view /*message*/) override {}
+
+  int64_t bytes_copied() const { return bytes_copied_; }
+  int64_t errors() const { return errors_; }
+
+ private:
+  int64_t bytes_copied_ = 0;
+  int64_t errors_ = 0;
+};
+
+enum class AdapterImpl { kOgHttp2, kNgHttp2 };
+
+std::unique_ptr<Http2Adapter> CreateServerAdapter(
+    AdapterImpl impl, Http2VisitorInterface& visitor) {
+  if (impl == AdapterImpl::kNgHttp2) {
+    return NgHttp2Adapter::CreateServerAdapter(visitor);
+  }
+  OgHttp2Adapter::Options options{.perspective = Perspective::kServer};
+  return OgHttp2Adapter::Create(visitor, options);
+}
+
+// Each iteration stands up a fresh server adapter, feeds it |wire| (one
+// serialized client connection), and drains the frames the adapter wants to
+// send in response.  Creating the adapter inside the loop keeps every
+// iteration identical without fighting connection-level flow control, and
+// charges both implementations the same per-connection setup cost.
+void RunServerScenario(quiche::QuicheBenchmarkState& state, AdapterImpl impl,
+                       const std::string& wire) {
+  BenchmarkVisitor visitor;
+  const int64_t allocations_before = g_num_allocations;
+  while (state.KeepRunning()) {
+    std::unique_ptr<Http2Adapter> adapter = CreateServerAdapter(impl, visitor);
+    adapter->ProcessBytes(wire);
+    adapter->Send();
+  }
+  state.SetBytesProcessed(state.iterations() *
+                          static_cast<int64_t>(wire.size()));
+  state.SetCounter("allocations_per_iteration",
+                   (g_num_allocations - allocations_before) /
+                       state.iterations());
+  state.SetCounter("bytes_copied_per_iteration",
+                   visitor.bytes_copied() / state.iterations());
+  // Nonzero if any iteration hit a connection error; the comparison is only
+  // meaningful when both adapters process the whole scenario cleanly.
+  state.SetCounter("connection_errors", visitor.errors());
+}
+
+// One POST stream uploading 64000 bytes in 16000-byte DATA frames, staying
+// within the default 65535-byte stream and connection flow control windows.
+std::string BulkDataScenario() {
+  TestFrameSequence seq;
+  seq.ClientPreface().Headers(1,
+                              {{":method", "POST"},
+                               {":scheme", "https"},
+                               {":authority", "www.example.com"},
+                               {":path", "/upload"}},
+                              /*fin=*/false);
+  const std::string chunk(16000, 'd');
+  seq.Data(1, chunk).Data(1, chunk).Data(1, chunk).Data(1, chunk,
+                                                        /*fin=*/true);
+  return seq.Serialize();
+}
+
+// Twenty-five GET streams, each carrying a realistic set of request headers,
+// exercising HPACK decoding and per-header callbacks.
+std::string HeaderHeavyScenario() {
+  std::vector<std::string> paths;
+  for (int i = 0; i < 25; ++i) {
+    paths.push_back(absl::StrCat("/resource/", i, "?session=", 1000 + i));
+  }
+  TestFrameSequence seq;
+  seq.ClientPreface();
+  for (int i = 0; i < 25; ++i) {
+    seq.Headers(
+        2 * i + 1,
+        {{":method", "GET"},
+         {":scheme", "https"},
+         {":authority", "www.example.com"},
+         {":path", paths[i]},
+         {"user-agent",
+          "Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36 "
+          "(KHTML, like Gecko) Chrome/92.0.4515.131 Safari/537.36"},
+         {"accept",
+          "text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8"},
+         {"accept-encoding", "gzip, deflate, br"},
+         {"accept-language", "en-US,en;q=0.9"},
+         {"cache-control", "max-age=0"},
+         {"cookie", "sessionid=38afes7a8; csrftoken=8h2f3ff9a8s7df89"},
+         {"referer", "https://www.example.com/search?q=http2+adapters"}},
+        /*fin=*/true);
+  }
+  return seq.Serialize();
+}
+
+// One hundred concurrent streams: all headers first, then one small DATA
+// frame per stream round-robin, stressing per-stream bookkeeping.
+std::string MultiplexingScenario() {
+  TestFrameSequence seq;
+  seq.ClientPreface();
+  const std::string body(256, 'm');
+  for (int i = 0; i < 100; ++i) {
+    seq.Headers(2 * i + 1,
+                {{":method", "POST"},
+                 {":scheme", "https"},
+                 {":authority", "www.example.com"},
+                 {":path", "/multiplexed"}},
+                /*fin=*/false);
+  }
+  for (int i = 0; i < 100; ++i) {
+    seq.Data(2 * i + 1, body, /*fin=*/true);
+  }
+  return seq.Serialize();
+}
+
+// A storm of small WINDOW_UPDATE frames alternating between the connection
+// and a single open stream.
+std::string WindowUpdateStormScenario() {
+  TestFrameSequence seq;
+  seq.ClientPreface().Headers(1,
+                              {{":method", "POST"},
+                               {":scheme", "https"},
+                               {":authority", "www.example.com"},
+                               {":path", "/storm"}},
+                              /*fin=*/false);
+  for (int i = 0; i < 1000; ++i) {
+    seq.WindowUpdate(0, 100).WindowUpdate(1, 100);
+  }
+  return seq.Serialize();
+}
+
+void BM_OgHttp2ServerBulkData(quiche::QuicheBenchmarkState& state) {
+  RunServerScenario(state, AdapterImpl::kOgHttp2, BulkDataScenario());
+}
+QUICHE_BENCHMARK(BM_OgHttp2ServerBulkData);
+
+void BM_NgHttp2ServerBulkData(quiche::QuicheBenchmarkState& state) {
+  RunServerScenario(state, AdapterImpl::kNgHttp2, BulkDataScenario());
+}
+QUICHE_BENCHMARK(BM_NgHttp2ServerBulkData);
+
+void BM_OgHttp2ServerHeaderHeavy(quiche::QuicheBenchmarkState& state) {
+  RunServerScenario(state, AdapterImpl::kOgHttp2, HeaderHeavyScenario());
+}
+QUICHE_BENCHMARK(BM_OgHttp2ServerHeaderHeavy);
+
+void BM_NgHttp2ServerHeaderHeavy(quiche::QuicheBenchmarkState& state) {
+  RunServerScenario(state, AdapterImpl::kNgHttp2, HeaderHeavyScenario());
+}
+QUICHE_BENCHMARK(BM_NgHttp2ServerHeaderHeavy);
+
+void BM_OgHttp2ServerMultiplexing(quiche::QuicheBenchmarkState& state) {
+  RunServerScenario(state, AdapterImpl::kOgHttp2, MultiplexingScenario());
+}
+QUICHE_BENCHMARK(BM_OgHttp2ServerMultiplexing);
+
+void BM_NgHttp2ServerMultiplexing(quiche::QuicheBenchmarkState& state) {
+  RunServerScenario(state, AdapterImpl::kNgHttp2, MultiplexingScenario());
+}
+QUICHE_BENCHMARK(BM_NgHttp2ServerMultiplexing);
+
+void BM_OgHttp2ServerWindowUpdateStorm(quiche::QuicheBenchmarkState& state) {
+  RunServerScenario(state, AdapterImpl::kOgHttp2, WindowUpdateStormScenario());
+}
+QUICHE_BENCHMARK(BM_OgHttp2ServerWindowUpdateStorm);
+
+void BM_NgHttp2ServerWindowUpdateStorm(quiche::QuicheBenchmarkState& state) {
+  RunServerScenario(state, AdapterImpl::kNgHttp2, WindowUpdateStormScenario());
+}
+QUICHE_BENCHMARK(BM_NgHttp2ServerWindowUpdateStorm);
+
+}  // namespace
+}  // namespace test
+}  // namespace adapter
+}  // namespace http2
+
+QUICHE_BENCHMARK_MAIN();
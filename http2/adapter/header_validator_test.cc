@@ -76,6 +76,31 @@ TEST(HeaderValidatorTest, ValueHasInvalidChar) {
   }
 }
 
+TEST(HeaderValidatorTest, LongHeaderFieldsValidated) {
+  HeaderValidator v;
+  // Names and values longer than 16 bytes take the vectorized scan; an
+  // invalid byte must be caught at every position, including positions that
+  // fall in the scalar tail.
+  const std::string long_name(70, 'x');
+  const std::string long_value(70, 'y');
+  EXPECT_EQ(HeaderValidator::HEADER_OK,
+            v.ValidateSingleHeader(long_name, long_value));
+  for (size_t i = 0; i < long_name.size(); ++i) {
+    std::string bad_name = long_name;
+    bad_name[i] = 'A';  // Uppercase is not allowed in header names.
+    EXPECT_EQ(HeaderValidator::HEADER_FIELD_INVALID,
+              v.ValidateSingleHeader(bad_name, long_value));
+  }
+  for (size_t i = 0; i < long_value.size(); ++i) {
+    for (const char c : {'\x00', '\x1F', '\x7F', '\x80', '\xFF'}) {
+      std::string bad_value = long_value;
+      bad_value[i] = c;
+      EXPECT_EQ(HeaderValidator::HEADER_FIELD_INVALID,
+                v.ValidateSingleHeader(long_name, bad_value));
+    }
+  }
+}
+
 TEST(HeaderValidatorTest, StatusHasInvalidChar) {
   HeaderValidator v;
 
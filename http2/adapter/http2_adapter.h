@@ -37,6 +37,28 @@ class QUICHE_EXPORT_PRIVATE Http2Adapter {
   // |visitor_| as appropriate.
   virtual int64_t ProcessBytes(absl::string_view bytes) = 0;
 
+  // Processes a sequence of borrowed input segments as if they were one
+  // contiguous buffer, so callers holding scattered TCP segments (e.g. from
+  // readv or a ring of receive buffers) do not need to copy them into a
+  // contiguous staging buffer first. The frame decoder is resumable at any
+  // byte boundary, so frames may straddle segments. Returns the total number
+  // of bytes processed; processing stops early if a segment is not fully
+  // consumed. If a segment fails outright, its error result is returned.
+  int64_t ProcessScatteredBytes(absl::Span<const absl::string_view> segments) {
+    int64_t total_processed = 0;
+    for (absl::string_view segment : segments) {
+      const int64_t result = ProcessBytes(segment);
+      if (result < 0) {
+        return result;
+      }
+      total_processed += result;
+      if (static_cast<size_t>(result) < segment.size()) {
+        break;
+      }
+    }
+    return total_processed;
+  }
+
   // Submits the |settings| to be written to the peer, e.g., as part of the
   // HTTP/2 connection preface.
   virtual void SubmitSettings(absl::Span<const Http2Setting> settings) = 0;
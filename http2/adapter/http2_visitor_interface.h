@@ -5,6 +5,7 @@
 #include <vector>
 
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "http2/adapter/http2_protocol.h"
 #include "common/platform/api/quiche_export.h"
 
@@ -60,6 +61,28 @@ class QUICHE_EXPORT_PRIVATE Http2VisitorInterface {
   // bytes were actually sent. May return kSendBlocked or kSendError.
   virtual int64_t OnReadyToSend(absl::string_view serialized) = 0;
 
+  // Called when there are multiple serialized frames to send as one write.
+  // |serialized_frames| contains one entry per frame, in wire order. Should
+  // return the total number of bytes actually sent, which may fall partway
+  // through a frame. May return kSendBlocked or kSendError. The default
+  // implementation forwards each entry to OnReadyToSend(); visitors only need
+  // to override this to perform vectored I/O (e.g. writev).
+  virtual int64_t OnReadyToSendVectored(
+      absl::Span<const absl::string_view> serialized_frames) {
+    int64_t total_sent = 0;
+    for (const absl::string_view frame : serialized_frames) {
+      const int64_t result = OnReadyToSend(frame);
+      if (result < 0) {
+        return total_sent > 0 ? total_sent : result;
+      }
+      total_sent += result;
+      if (static_cast<size_t>(result) < frame.size()) {
+        break;
+      }
+    }
+    return total_sent;
+  }
+
   // Called when a connection-level error has occurred.
   enum class ConnectionError {
     // The peer sent an invalid connection preface.
@@ -1,6 +1,7 @@
 #include "http2/adapter/oghttp2_adapter.h"
 
 #include <string>
+#include <vector>
 
 #include "absl/strings/str_join.h"
 #include "http2/adapter/http2_protocol.h"
@@ -62,6 +63,25 @@ TEST_F(OgHttp2AdapterTest, ProcessBytes) {
       TestFrameSequence().ClientPreface().Ping(17).Serialize());
 }
 
+TEST_F(OgHttp2AdapterTest, ProcessScatteredBytes) {
+  testing::InSequence seq;
+  EXPECT_CALL(http2_visitor_, OnFrameHeader(0, 0, 4, 0));
+  EXPECT_CALL(http2_visitor_, OnSettingsStart());
+  EXPECT_CALL(http2_visitor_, OnSettingsEnd());
+  EXPECT_CALL(http2_visitor_, OnFrameHeader(0, 8, 6, 0));
+  EXPECT_CALL(http2_visitor_, OnPing(17, false));
+  const std::string frames =
+      TestFrameSequence().ClientPreface().Ping(17).Serialize();
+  // Split the input into segments small enough that both frame headers and
+  // the PING payload straddle segment boundaries.
+  std::vector<absl::string_view> segments;
+  for (size_t i = 0; i < frames.size(); i += 7) {
+    segments.push_back(absl::string_view(frames).substr(i, 7));
+  }
+  const int64_t result = adapter_->ProcessScatteredBytes(segments);
+  EXPECT_EQ(frames.size(), static_cast<size_t>(result));
+}
+
 TEST_F(OgHttp2AdapterTest, InitialSettings) {
   DataSavingVisitor client_visitor;
   OgHttp2Adapter::Options client_options{.perspective = Perspective::kClient,
@@ -3,6 +3,7 @@
 #include <cstdint>
 #include <tuple>
 #include <utility>
+#include <vector>
 
 #include "absl/memory/memory.h"
 #include "absl/strings/escaping.h"
@@ -37,6 +38,9 @@ const uint32_t kMaximumHpackTableCapacity = 65536u;
 // Corresponds to NGHTTP2_ERR_CALLBACK_FAILURE.
 const int kSendError = -902;
 
+// The maximum number of queued frames serialized into a single vectored send.
+const size_t kMaxSendBatchSize = 16;
+
 // TODO(birenroy): Consider incorporating spdy::FlagsSerializionVisitor here.
 class FrameAttributeCollector : public spdy::SpdyFrameVisitor {
  public:
@@ -614,42 +618,66 @@ OgHttp2Session::SendResult OgHttp2Session::SendQueuedFrames() {
   if (result != SendResult::SEND_OK) {
     return result;
   }
-  // Serialize and send frames in the queue.
+  // Serialize and send frames in the queue, batching them so the visitor can
+  // use vectored I/O.
   while (!frames_.empty()) {
-    const auto& frame_ptr = frames_.front();
-    FrameAttributeCollector c;
-    frame_ptr->Visit(&c);
-    // Frames can't accurately report their own length; the actual serialized
-    // length must be used instead.
-    spdy::SpdySerializedFrame frame = framer_.SerializeFrame(*frame_ptr);
-    const size_t frame_payload_length = frame.size() - spdy::kFrameHeaderSize;
-    frame_ptr->Visit(&send_logger_);
-    visitor_.OnBeforeFrameSent(c.frame_type(), c.stream_id(),
-                               frame_payload_length, c.flags());
-    const int64_t result = visitor_.OnReadyToSend(absl::string_view(frame));
+    std::vector<spdy::SpdySerializedFrame> serialized_frames;
+    std::vector<absl::string_view> chunks;
+    std::vector<FrameAttributeCollector> attributes;
+    for (const auto& frame_ptr : frames_) {
+      if (serialized_frames.size() >= kMaxSendBatchSize) {
+        break;
+      }
+      FrameAttributeCollector c;
+      frame_ptr->Visit(&c);
+      // Frames can't accurately report their own length; the actual serialized
+      // length must be used instead.
+      spdy::SpdySerializedFrame frame = framer_.SerializeFrame(*frame_ptr);
+      frame_ptr->Visit(&send_logger_);
+      visitor_.OnBeforeFrameSent(c.frame_type(), c.stream_id(),
+                                 frame.size() - spdy::kFrameHeaderSize,
+                                 c.flags());
+      serialized_frames.push_back(std::move(frame));
+      chunks.push_back(absl::string_view(serialized_frames.back()));
+      attributes.push_back(c);
+      if (static_cast<FrameType>(c.frame_type()) == FrameType::SETTINGS) {
+        // Acking a SETTINGS frame can resize the header encoder table, so
+        // frames queued behind a SETTINGS frame must not be serialized until
+        // it has been sent.
+        break;
+      }
+    }
+    const int64_t result = visitor_.OnReadyToSendVectored(chunks);
     if (result < 0) {
       LatchErrorAndNotify(Http2ErrorCode::INTERNAL_ERROR,
                           ConnectionError::kSendError);
       return SendResult::SEND_ERROR;
-    } else if (result == 0) {
-      // Write blocked.
-      return SendResult::SEND_BLOCKED;
-    } else {
+    }
+    size_t remaining = static_cast<size_t>(result);
+    for (size_t i = 0; i < serialized_frames.size(); ++i) {
+      const spdy::SpdySerializedFrame& frame = serialized_frames[i];
+      const FrameAttributeCollector& c = attributes[i];
+      if (remaining == 0) {
+        // Write blocked before reaching this frame; it stays in the queue.
+        return SendResult::SEND_BLOCKED;
+      }
       frames_.pop_front();
 
-      const bool ok =
-          AfterFrameSent(c.frame_type(), c.stream_id(), frame_payload_length,
-                         c.flags(), c.error_code());
+      const bool ok = AfterFrameSent(c.frame_type(), c.stream_id(),
+                                     frame.size() - spdy::kFrameHeaderSize,
+                                     c.flags(), c.error_code());
       if (!ok) {
         LatchErrorAndNotify(Http2ErrorCode::INTERNAL_ERROR,
                             ConnectionError::kSendError);
         return SendResult::SEND_ERROR;
       }
-      if (static_cast<size_t>(result) < frame.size()) {
+      if (remaining < frame.size()) {
         // The frame was partially written, so the rest must be buffered.
-        buffered_data_.append(frame.data() + result, frame.size() - result);
+        buffered_data_.append(frame.data() + remaining,
+                              frame.size() - remaining);
         return SendResult::SEND_BLOCKED;
       }
+      remaining -= frame.size();
     }
   }
   return SendResult::SEND_OK;
@@ -25,6 +25,24 @@ enum FrameType {
   WINDOW_UPDATE,
 };
 
+// Records the number of frames passed to each vectored send, in addition to
+// saving the serialized bytes like the base class.
+class VectorRecordingVisitor : public DataSavingVisitor {
+ public:
+  int64_t OnReadyToSendVectored(
+      absl::Span<const absl::string_view> serialized_frames) override {
+    frames_per_send_.push_back(serialized_frames.size());
+    return DataSavingVisitor::OnReadyToSendVectored(serialized_frames);
+  }
+
+  const std::vector<size_t>& frames_per_send() const {
+    return frames_per_send_;
+  }
+
+ private:
+  std::vector<size_t> frames_per_send_;
+};
+
 }  // namespace
 
 TEST(OgHttp2SessionTest, ClientConstruction) {
@@ -208,6 +226,36 @@ TEST(OgHttp2SessionTest, ClientEnqueuesSettingsOnce) {
   EXPECT_THAT(serialized, EqualsFrames({SpdyFrameType::SETTINGS}));
 }
 
+// Verifies that queued frames are serialized into a single vectored send, with
+// SETTINGS flushed separately since acking it can change serializer state.
+TEST(OgHttp2SessionTest, ClientSendsQueuedFramesInVectoredBatches) {
+  VectorRecordingVisitor visitor;
+  OgHttp2Session session(
+      visitor, OgHttp2Session::Options{.perspective = Perspective::kClient});
+  session.EnqueueFrame(absl::make_unique<spdy::SpdyPingIR>(42));
+  session.EnqueueFrame(absl::make_unique<spdy::SpdyPingIR>(47));
+  session.EnqueueFrame(absl::make_unique<spdy::SpdyWindowUpdateIR>(0, 1000));
+
+  EXPECT_CALL(visitor, OnBeforeFrameSent(SETTINGS, 0, _, 0x0));
+  EXPECT_CALL(visitor, OnFrameSent(SETTINGS, 0, _, 0x0, 0));
+  EXPECT_CALL(visitor, OnBeforeFrameSent(PING, 0, 8, 0x0)).Times(2);
+  EXPECT_CALL(visitor, OnFrameSent(PING, 0, 8, 0x0, 0)).Times(2);
+  EXPECT_CALL(visitor, OnBeforeFrameSent(WINDOW_UPDATE, 0, 4, 0x0));
+  EXPECT_CALL(visitor, OnFrameSent(WINDOW_UPDATE, 0, 4, 0x0, 0));
+
+  int result = session.Send();
+  EXPECT_EQ(0, result);
+  // The SETTINGS frame goes out alone; the remaining frames share one send.
+  EXPECT_THAT(visitor.frames_per_send(), testing::ElementsAre(1, 3));
+  absl::string_view serialized = visitor.data();
+  EXPECT_THAT(serialized,
+              testing::StartsWith(spdy::kHttp2ConnectionHeaderPrefix));
+  serialized.remove_prefix(strlen(spdy::kHttp2ConnectionHeaderPrefix));
+  EXPECT_THAT(serialized,
+              EqualsFrames({SpdyFrameType::SETTINGS, SpdyFrameType::PING,
+                            SpdyFrameType::PING, SpdyFrameType::WINDOW_UPDATE}));
+}
+
 TEST(OgHttp2SessionTest, ClientSubmitRequest) {
   DataSavingVisitor visitor;
   OgHttp2Session session(
@@ -110,10 +110,14 @@ void HpackDecoderState::OnNameIndexAndLiteralValue(
   allow_dynamic_table_size_update_ = false;
   const HpackStringPair* entry = decoder_tables_.Lookup(name_index);
   if (entry != nullptr) {
-    std::string value(ExtractString(value_buffer));
-    listener_->OnHeader(entry->name, value);
     if (entry_type == HpackEntryType::kIndexedLiteralHeader) {
+      std::string value(ExtractString(value_buffer));
+      listener_->OnHeader(entry->name, value);
       decoder_tables_.Insert(entry->name, std::move(value));
+    } else {
+      // The value is emitted as a view into |value_buffer|, which is reused
+      // for the next header; no copy is made.
+      listener_->OnHeader(entry->name, value_buffer->str());
     }
   } else {
     ReportError(HpackDecodingError::kInvalidNameIndex, "");
@@ -134,11 +138,15 @@ void HpackDecoderState::OnLiteralNameAndValue(
     return;
   }
   allow_dynamic_table_size_update_ = false;
-  std::string name(ExtractString(name_buffer));
-  std::string value(ExtractString(value_buffer));
-  listener_->OnHeader(name, value);
   if (entry_type == HpackEntryType::kIndexedLiteralHeader) {
+    std::string name(ExtractString(name_buffer));
+    std::string value(ExtractString(value_buffer));
+    listener_->OnHeader(name, value);
     decoder_tables_.Insert(std::move(name), std::move(value));
+  } else {
+    // The name and value are emitted as views into the decode buffers, which
+    // are reused for the next header; no copies are made.
+    listener_->OnHeader(name_buffer->str(), value_buffer->str());
   }
 }
 
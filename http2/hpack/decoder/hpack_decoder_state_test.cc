@@ -38,7 +38,7 @@ class MockHpackDecoderListener : public HpackDecoderListener {
   MOCK_METHOD(void, OnHeaderListStart, (), (override));
   MOCK_METHOD(void,
               OnHeader,
-              (const std::string& name, const std::string& value),
+              (absl::string_view name, absl::string_view value),
               (override));
   MOCK_METHOD(void, OnHeaderListEnd, (), (override));
   MOCK_METHOD(void,
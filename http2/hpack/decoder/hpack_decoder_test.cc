@@ -11,6 +11,7 @@
 #include <utility>
 #include <vector>
 
+#include "absl/strings/string_view.h"
 #include "http2/decoder/decode_buffer.h"
 #include "http2/hpack/decoder/hpack_decoder_listener.h"
 #include "http2/hpack/decoder/hpack_decoder_state.h"
@@ -65,7 +66,7 @@ class MockHpackDecoderListener : public HpackDecoderListener {
   MOCK_METHOD(void, OnHeaderListStart, (), (override));
   MOCK_METHOD(void,
               OnHeader,
-              (const std::string& name, const std::string& value),
+              (absl::string_view name, absl::string_view value),
               (override));
   MOCK_METHOD(void, OnHeaderListEnd, (), (override));
   MOCK_METHOD(void,
@@ -96,7 +97,7 @@ class HpackDecoderTest : public QuicheTestWithParam<bool>,
   // Called for each header name-value pair that is decoded, in the order they
   // appear in the HPACK block. Multiple values for a given key will be emitted
   // as multiple calls to OnHeader.
-  void OnHeader(const std::string& name, const std::string& value) override {
+  void OnHeader(absl::string_view name, absl::string_view value) override {
     ASSERT_TRUE(saw_start_);
     ASSERT_FALSE(saw_end_);
     header_entries_.emplace_back(name, value);
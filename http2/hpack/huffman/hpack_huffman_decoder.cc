@@ -212,137 +212,44 @@ constexpr unsigned char kCanonicalToSymbol[] = {
 };
 // clang-format on
 
-constexpr size_t kShortCodeTableSize = 124;
-struct ShortCodeInfo {
-  uint8_t symbol;
-  uint8_t length;
-} kShortCodeTable[kShortCodeTableSize] = {
-    {0x30, 5},  // Match: 0b0000000, Symbol: 0
-    {0x30, 5},  // Match: 0b0000001, Symbol: 0
-    {0x30, 5},  // Match: 0b0000010, Symbol: 0
-    {0x30, 5},  // Match: 0b0000011, Symbol: 0
-    {0x31, 5},  // Match: 0b0000100, Symbol: 1
-    {0x31, 5},  // Match: 0b0000101, Symbol: 1
-    {0x31, 5},  // Match: 0b0000110, Symbol: 1
-    {0x31, 5},  // Match: 0b0000111, Symbol: 1
-    {0x32, 5},  // Match: 0b0001000, Symbol: 2
-    {0x32, 5},  // Match: 0b0001001, Symbol: 2
-    {0x32, 5},  // Match: 0b0001010, Symbol: 2
-    {0x32, 5},  // Match: 0b0001011, Symbol: 2
-    {0x61, 5},  // Match: 0b0001100, Symbol: a
-    {0x61, 5},  // Match: 0b0001101, Symbol: a
-    {0x61, 5},  // Match: 0b0001110, Symbol: a
-    {0x61, 5},  // Match: 0b0001111, Symbol: a
-    {0x63, 5},  // Match: 0b0010000, Symbol: c
-    {0x63, 5},  // Match: 0b0010001, Symbol: c
-    {0x63, 5},  // Match: 0b0010010, Symbol: c
-    {0x63, 5},  // Match: 0b0010011, Symbol: c
-    {0x65, 5},  // Match: 0b0010100, Symbol: e
-    {0x65, 5},  // Match: 0b0010101, Symbol: e
-    {0x65, 5},  // Match: 0b0010110, Symbol: e
-    {0x65, 5},  // Match: 0b0010111, Symbol: e
-    {0x69, 5},  // Match: 0b0011000, Symbol: i
-    {0x69, 5},  // Match: 0b0011001, Symbol: i
-    {0x69, 5},  // Match: 0b0011010, Symbol: i
-    {0x69, 5},  // Match: 0b0011011, Symbol: i
-    {0x6f, 5},  // Match: 0b0011100, Symbol: o
-    {0x6f, 5},  // Match: 0b0011101, Symbol: o
-    {0x6f, 5},  // Match: 0b0011110, Symbol: o
-    {0x6f, 5},  // Match: 0b0011111, Symbol: o
-    {0x73, 5},  // Match: 0b0100000, Symbol: s
-    {0x73, 5},  // Match: 0b0100001, Symbol: s
-    {0x73, 5},  // Match: 0b0100010, Symbol: s
-    {0x73, 5},  // Match: 0b0100011, Symbol: s
-    {0x74, 5},  // Match: 0b0100100, Symbol: t
-    {0x74, 5},  // Match: 0b0100101, Symbol: t
-    {0x74, 5},  // Match: 0b0100110, Symbol: t
-    {0x74, 5},  // Match: 0b0100111, Symbol: t
-    {0x20, 6},  // Match: 0b0101000, Symbol: (space)
-    {0x20, 6},  // Match: 0b0101001, Symbol: (space)
-    {0x25, 6},  // Match: 0b0101010, Symbol: %
-    {0x25, 6},  // Match: 0b0101011, Symbol: %
-    {0x2d, 6},  // Match: 0b0101100, Symbol: -
-    {0x2d, 6},  // Match: 0b0101101, Symbol: -
-    {0x2e, 6},  // Match: 0b0101110, Symbol: .
-    {0x2e, 6},  // Match: 0b0101111, Symbol: .
-    {0x2f, 6},  // Match: 0b0110000, Symbol: /
-    {0x2f, 6},  // Match: 0b0110001, Symbol: /
-    {0x33, 6},  // Match: 0b0110010, Symbol: 3
-    {0x33, 6},  // Match: 0b0110011, Symbol: 3
-    {0x34, 6},  // Match: 0b0110100, Symbol: 4
-    {0x34, 6},  // Match: 0b0110101, Symbol: 4
-    {0x35, 6},  // Match: 0b0110110, Symbol: 5
-    {0x35, 6},  // Match: 0b0110111, Symbol: 5
-    {0x36, 6},  // Match: 0b0111000, Symbol: 6
-    {0x36, 6},  // Match: 0b0111001, Symbol: 6
-    {0x37, 6},  // Match: 0b0111010, Symbol: 7
-    {0x37, 6},  // Match: 0b0111011, Symbol: 7
-    {0x38, 6},  // Match: 0b0111100, Symbol: 8
-    {0x38, 6},  // Match: 0b0111101, Symbol: 8
-    {0x39, 6},  // Match: 0b0111110, Symbol: 9
-    {0x39, 6},  // Match: 0b0111111, Symbol: 9
-    {0x3d, 6},  // Match: 0b1000000, Symbol: =
-    {0x3d, 6},  // Match: 0b1000001, Symbol: =
-    {0x41, 6},  // Match: 0b1000010, Symbol: A
-    {0x41, 6},  // Match: 0b1000011, Symbol: A
-    {0x5f, 6},  // Match: 0b1000100, Symbol: _
-    {0x5f, 6},  // Match: 0b1000101, Symbol: _
-    {0x62, 6},  // Match: 0b1000110, Symbol: b
-    {0x62, 6},  // Match: 0b1000111, Symbol: b
-    {0x64, 6},  // Match: 0b1001000, Symbol: d
-    {0x64, 6},  // Match: 0b1001001, Symbol: d
-    {0x66, 6},  // Match: 0b1001010, Symbol: f
-    {0x66, 6},  // Match: 0b1001011, Symbol: f
-    {0x67, 6},  // Match: 0b1001100, Symbol: g
-    {0x67, 6},  // Match: 0b1001101, Symbol: g
-    {0x68, 6},  // Match: 0b1001110, Symbol: h
-    {0x68, 6},  // Match: 0b1001111, Symbol: h
-    {0x6c, 6},  // Match: 0b1010000, Symbol: l
-    {0x6c, 6},  // Match: 0b1010001, Symbol: l
-    {0x6d, 6},  // Match: 0b1010010, Symbol: m
-    {0x6d, 6},  // Match: 0b1010011, Symbol: m
-    {0x6e, 6},  // Match: 0b1010100, Symbol: n
-    {0x6e, 6},  // Match: 0b1010101, Symbol: n
-    {0x70, 6},  // Match: 0b1010110, Symbol: p
-    {0x70, 6},  // Match: 0b1010111, Symbol: p
-    {0x72, 6},  // Match: 0b1011000, Symbol: r
-    {0x72, 6},  // Match: 0b1011001, Symbol: r
-    {0x75, 6},  // Match: 0b1011010, Symbol: u
-    {0x75, 6},  // Match: 0b1011011, Symbol: u
-    {0x3a, 7},  // Match: 0b1011100, Symbol: :
-    {0x42, 7},  // Match: 0b1011101, Symbol: B
-    {0x43, 7},  // Match: 0b1011110, Symbol: C
-    {0x44, 7},  // Match: 0b1011111, Symbol: D
-    {0x45, 7},  // Match: 0b1100000, Symbol: E
-    {0x46, 7},  // Match: 0b1100001, Symbol: F
-    {0x47, 7},  // Match: 0b1100010, Symbol: G
-    {0x48, 7},  // Match: 0b1100011, Symbol: H
-    {0x49, 7},  // Match: 0b1100100, Symbol: I
-    {0x4a, 7},  // Match: 0b1100101, Symbol: J
-    {0x4b, 7},  // Match: 0b1100110, Symbol: K
-    {0x4c, 7},  // Match: 0b1100111, Symbol: L
-    {0x4d, 7},  // Match: 0b1101000, Symbol: M
-    {0x4e, 7},  // Match: 0b1101001, Symbol: N
-    {0x4f, 7},  // Match: 0b1101010, Symbol: O
-    {0x50, 7},  // Match: 0b1101011, Symbol: P
-    {0x51, 7},  // Match: 0b1101100, Symbol: Q
-    {0x52, 7},  // Match: 0b1101101, Symbol: R
-    {0x53, 7},  // Match: 0b1101110, Symbol: S
-    {0x54, 7},  // Match: 0b1101111, Symbol: T
-    {0x55, 7},  // Match: 0b1110000, Symbol: U
-    {0x56, 7},  // Match: 0b1110001, Symbol: V
-    {0x57, 7},  // Match: 0b1110010, Symbol: W
-    {0x59, 7},  // Match: 0b1110011, Symbol: Y
-    {0x6a, 7},  // Match: 0b1110100, Symbol: j
-    {0x6b, 7},  // Match: 0b1110101, Symbol: k
-    {0x71, 7},  // Match: 0b1110110, Symbol: q
-    {0x76, 7},  // Match: 0b1110111, Symbol: v
-    {0x77, 7},  // Match: 0b1111000, Symbol: w
-    {0x78, 7},  // Match: 0b1111001, Symbol: x
-    {0x79, 7},  // Match: 0b1111010, Symbol: y
-    {0x7a, 7},  // Match: 0b1111011, Symbol: z
+// An 8-bit lookup table covering every code of length 5 to 8 bits, i.e. one
+// entry for each possible value of the high order byte of the accumulator.
+// The overwhelming majority of symbols in typical header fields are encoded
+// with these short codes, so most symbols are decoded with a single table
+// lookup instead of walking the canonical code groups bit by bit. Entries
+// with length == 0 mark bytes that begin a code longer than 8 bits, which
+// are decoded via PrefixToInfo() as before. EOS (30 bits) can never hit this
+// table. The table is derived from PrefixToInfo() and kCanonicalToSymbol at
+// first use.
+struct ByteCodeTable {
+  struct Entry {
+    uint8_t symbol;
+    uint8_t length;  // 0 if the code is longer than 8 bits.
+  };
+
+  ByteCodeTable() {
+    for (uint32_t byte = 0; byte < 256; ++byte) {
+      const HuffmanCode prefix = byte << (kHuffmanCodeBitCount - 8);
+      const PrefixInfo prefix_info = PrefixToInfo(prefix);
+      if (prefix_info.code_length <= 8) {
+        const uint32_t canonical = prefix_info.DecodeToCanonical(prefix);
+        QUICHE_DCHECK_LT(canonical, 256u);
+        entries[byte] = {kCanonicalToSymbol[canonical],
+                         static_cast<uint8_t>(prefix_info.code_length)};
+      } else {
+        entries[byte] = {0, 0};
+      }
+    }
+  }
+
+  Entry entries[256];
 };
 
+const ByteCodeTable& GetByteCodeTable() {
+  static const ByteCodeTable* table = new ByteCodeTable();
+  return *table;
+}
+
 }  // namespace
 
 HuffmanBitBuffer::HuffmanBitBuffer() {
@@ -420,19 +327,19 @@ bool HpackHuffmanDecoder::Decode(absl::string_view input, std::string* output) {
 
   while (true) {
     HTTP2_DVLOG(3) << "Enter Decode Loop, bit_buffer_: " << bit_buffer_;
-    if (bit_buffer_.count() >= 7) {
-      // Get high 7 bits of the bit buffer, see if that contains a complete
-      // code of 5, 6 or 7 bits.
-      uint8_t short_code =
-          bit_buffer_.value() >> (kHuffmanAccumulatorBitCount - 7);
-      QUICHE_DCHECK_LT(short_code, 128);
-      if (short_code < kShortCodeTableSize) {
-        ShortCodeInfo info = kShortCodeTable[short_code];
-        bit_buffer_.ConsumeBits(info.length);
-        output->push_back(static_cast<char>(info.symbol));
+    if (bit_buffer_.count() >= 8) {
+      // Get the high byte of the bit buffer; if it starts with a complete
+      // code of 5 to 8 bits, decode the symbol with a single table lookup.
+      const uint8_t high_byte =
+          bit_buffer_.value() >> (kHuffmanAccumulatorBitCount - 8);
+      const ByteCodeTable::Entry entry =
+          GetByteCodeTable().entries[high_byte];
+      if (entry.length != 0) {
+        bit_buffer_.ConsumeBits(entry.length);
+        output->push_back(static_cast<char>(entry.symbol));
         continue;
       }
-      // The code is more than 7 bits long. Use PrefixToInfo, etc. to decode
+      // The code is more than 8 bits long. Use PrefixToInfo, etc. to decode
       // longer codes.
     } else {
       // We may have (mostly) drained bit_buffer_. If we can top it up, try
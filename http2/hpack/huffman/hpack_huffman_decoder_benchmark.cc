@@ -0,0 +1,63 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "common/platform/api/quiche_benchmark.h"
+#include "http2/hpack/huffman/hpack_huffman_decoder.h"
+#include "http2/hpack/huffman/hpack_huffman_encoder.h"
+
+namespace http2 {
+namespace {
+
+// Field values typical of real request and response headers; Huffman
+// decoding throughput depends heavily on the symbol mix.
+const char* const kHeaderCorpus[] = {
+    "Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36 (KHTML, "
+    "like Gecko) Chrome/92.0.4515.131 Safari/537.36",
+    "text/html,application/xhtml+xml,application/xml;q=0.9,image/avif,"
+    "image/webp,*/*;q=0.8",
+    "gzip, deflate, br",
+    "https://www.example.com/search?q=quic+transport&hl=en&start=20",
+    "sessionid=38afes7a8; csrftoken=8h2f3ff9a8s7df89; _ga=GA1.2.12345",
+    "max-age=31536000; includeSubDomains",
+    "Apache/2.4.39 (Unix) OpenSSL/1.1.1c",
+    "Mon, 23 Aug 2021 17:43:12 GMT",
+};
+
+void BM_HuffmanDecodeHeaderCorpus(quiche::QuicheBenchmarkState& state) {
+  std::vector<std::string> encoded_corpus;
+  int64_t encoded_bytes = 0;
+  for (const char* value : kHeaderCorpus) {
+    std::string huffman;
+    HuffmanEncode(value, HuffmanSize(value), &huffman);
+    encoded_bytes += huffman.size();
+    encoded_corpus.push_back(std::move(huffman));
+  }
+
+  HpackHuffmanDecoder decoder;
+  std::string decoded;
+  bool ok = true;
+  while (state.KeepRunning()) {
+    for (const std::string& huffman : encoded_corpus) {
+      decoded.clear();
+      decoder.Reset();
+      ok &= decoder.Decode(huffman, &decoded) && decoder.InputProperlyTerminated();
+    }
+  }
+  if (!ok) {
+    // Decoding our own encoder's output must not fail.
+    return;
+  }
+  state.SetBytesProcessed(state.iterations() * encoded_bytes);
+}
+QUICHE_BENCHMARK(BM_HuffmanDecodeHeaderCorpus);
+
+}  // namespace
+}  // namespace http2
+
+QUICHE_BENCHMARK_MAIN();
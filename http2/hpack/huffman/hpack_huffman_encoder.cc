@@ -4,11 +4,78 @@
 
 #include "http2/hpack/huffman/hpack_huffman_encoder.h"
 
+#include <vector>
+
 #include "http2/hpack/huffman/huffman_spec_tables.h"
 #include "http2/platform/api/http2_logging.h"
 
 namespace http2 {
 
+namespace {
+
+// Symbols whose Huffman code is at most 8 bits long cover the characters
+// that dominate header data (lowercase letters, digits, and common
+// punctuation). Two such codes concatenated fit in 16 bits, so pairs of
+// short-code symbols can be encoded with a single table probe instead of
+// two, halving per-symbol table and shift work on typical input.
+constexpr size_t kMaxFusedCodeLength = 8;
+constexpr uint8_t kInvalidShortIndex = 0xff;
+
+struct FusedPairTables {
+  // Maps a byte to its dense index among short-code symbols, or
+  // kInvalidShortIndex if its code is longer than kMaxFusedCodeLength bits.
+  uint8_t short_index[256];
+  size_t num_short_symbols;
+  // The tables below are indexed by
+  // first_short_index * num_short_symbols + second_short_index.
+  // Summed code length of the pair, in bits.
+  std::vector<uint8_t> pair_lengths;
+  // Concatenated codes of the pair, right justified.
+  std::vector<uint16_t> pair_codes;
+  // Concatenated codes of the pair, left justified in 32 bits, matching the
+  // layout of HuffmanSpecTables::kLeftCodes.
+  std::vector<uint32_t> pair_left_codes;
+};
+
+const FusedPairTables& GetFusedPairTables() {
+  static const FusedPairTables* const tables = []() {
+    auto* t = new FusedPairTables();
+    t->num_short_symbols = 0;
+    std::vector<uint8_t> short_symbols;
+    for (int c = 0; c < 256; ++c) {
+      if (HuffmanSpecTables::kCodeLengths[c] <= kMaxFusedCodeLength) {
+        t->short_index[c] = static_cast<uint8_t>(t->num_short_symbols++);
+        short_symbols.push_back(static_cast<uint8_t>(c));
+      } else {
+        t->short_index[c] = kInvalidShortIndex;
+      }
+    }
+    const size_t n = t->num_short_symbols;
+    t->pair_lengths.resize(n * n);
+    t->pair_codes.resize(n * n);
+    t->pair_left_codes.resize(n * n);
+    for (size_t i = 0; i < n; ++i) {
+      const uint8_t a = short_symbols[i];
+      const uint32_t a_length = HuffmanSpecTables::kCodeLengths[a];
+      for (size_t j = 0; j < n; ++j) {
+        const uint8_t b = short_symbols[j];
+        const uint32_t b_length = HuffmanSpecTables::kCodeLengths[b];
+        const uint32_t length = a_length + b_length;
+        const uint32_t code = (HuffmanSpecTables::kRightCodes[a] << b_length) |
+                              HuffmanSpecTables::kRightCodes[b];
+        const size_t index = i * n + j;
+        t->pair_lengths[index] = static_cast<uint8_t>(length);
+        t->pair_codes[index] = static_cast<uint16_t>(code);
+        t->pair_left_codes[index] = code << (32 - length);
+      }
+    }
+    return t;
+  }();
+  return *tables;
+}
+
+}  // namespace
+
 size_t HuffmanSize(absl::string_view plain) {
   size_t bits = 0;
   for (const uint8_t c : plain) {
@@ -21,15 +88,35 @@ void HuffmanEncode(absl::string_view plain,
                    size_t encoded_size,
                    std::string* huffman) {
   QUICHE_DCHECK(huffman != nullptr);
+  const FusedPairTables& fused = GetFusedPairTables();
   huffman->reserve(huffman->size() + encoded_size);
   uint64_t bit_buffer = 0;  // High-bit is next bit to output. Not clear if that
                             // is more performant than having the low-bit be the
                             // last to be output.
   size_t bits_unused = 64;  // Number of bits available for the next code.
-  for (uint8_t c : plain) {
-    size_t code_length = HuffmanSpecTables::kCodeLengths[c];
+  const uint8_t* const data = reinterpret_cast<const uint8_t*>(plain.data());
+  const size_t size = plain.size();
+  size_t i = 0;
+  while (i < size) {
+    const uint8_t c = data[i];
+    uint64_t code;
+    size_t code_length;
+    const uint8_t first_index = fused.short_index[c];
+    uint8_t second_index;
+    if (i + 1 < size && first_index != kInvalidShortIndex &&
+        (second_index = fused.short_index[data[i + 1]]) != kInvalidShortIndex) {
+      // Both codes are short: emit the concatenated pair with one probe.
+      const size_t index = first_index * fused.num_short_symbols + second_index;
+      code = fused.pair_codes[index];
+      code_length = fused.pair_lengths[index];
+      i += 2;
+    } else {
+      code = HuffmanSpecTables::kRightCodes[c];
+      code_length = HuffmanSpecTables::kCodeLengths[c];
+      ++i;
+    }
     if (bits_unused < code_length) {
-      // There isn't enough room in bit_buffer for the code of c.
+      // There isn't enough room in bit_buffer for the code.
       // Flush until bits_unused > 56 (i.e. 64 - 8).
       do {
         char h = static_cast<char>(bit_buffer >> 56);
@@ -41,7 +128,6 @@ void HuffmanEncode(absl::string_view plain,
         huffman->push_back(h);
       } while (bits_unused <= 56);
     }
-    uint64_t code = HuffmanSpecTables::kRightCodes[c];
     size_t shift_by = bits_unused - code_length;
     bit_buffer |= (code << shift_by);
     bits_unused -= code_length;
@@ -68,6 +154,7 @@ void HuffmanEncode(absl::string_view plain,
 void HuffmanEncodeFast(absl::string_view input,
                        size_t encoded_size,
                        std::string* output) {
+  const FusedPairTables& fused = GetFusedPairTables();
   const size_t original_size = output->size();
   const size_t final_size = original_size + encoded_size;
   // Reserve an extra four bytes to avoid accessing unallocated memory (even
@@ -76,18 +163,39 @@ void HuffmanEncodeFast(absl::string_view input,
 
   // Pointer to first appended byte.
   char* const first = &*output->begin() + original_size;
+  const uint8_t* const data = reinterpret_cast<const uint8_t*>(input.data());
+  const size_t size = input.size();
   size_t bit_counter = 0;
-  for (uint8_t c : input) {
+  size_t i = 0;
+  while (i < size) {
+    const uint8_t c = data[i];
+    uint64_t left_code;
+    size_t code_length;
+    const uint8_t first_index = fused.short_index[c];
+    uint8_t second_index;
+    if (i + 1 < size && first_index != kInvalidShortIndex &&
+        (second_index = fused.short_index[data[i + 1]]) != kInvalidShortIndex) {
+      // Both codes are short: write the concatenated pair with one probe.
+      // The pair is at most 16 bits long, so it fits in the same five-byte
+      // window as a single long code below.
+      const size_t index = first_index * fused.num_short_symbols + second_index;
+      left_code = fused.pair_left_codes[index];
+      code_length = fused.pair_lengths[index];
+      i += 2;
+    } else {
+      left_code = HuffmanSpecTables::kLeftCodes[c];
+      code_length = HuffmanSpecTables::kCodeLengths[c];
+      ++i;
+    }
     // Align the Huffman code to byte boundaries as it needs to be written.
     // The longest Huffman code is 30 bits long, and it can be shifted by up to
     // 7 bits, requiring 37 bits in total.  The most significant 25 bits and
     // least significant 2 bits of |code| are always zero.
-    uint64_t code = static_cast<uint64_t>(HuffmanSpecTables::kLeftCodes[c])
-                    << (8 - (bit_counter % 8));
+    uint64_t code = left_code << (8 - (bit_counter % 8));
     // The byte where the first bit of |code| needs to be written.
     char* const current = first + (bit_counter / 8);
 
-    bit_counter += HuffmanSpecTables::kCodeLengths[c];
+    bit_counter += code_length;
 
     *current |= code >> 32;
 
@@ -115,6 +115,33 @@ TEST_P(HuffmanEncoderTest, EncodedSizeAgreesWithEncodeString) {
   }
 }
 
+// Exercise the fused pair fast path (both adjacent symbols have short
+// codes) together with its fallbacks: odd-length runs of short-code
+// symbols, long-code symbols, and alternations between the two.
+TEST_P(HuffmanEncoderTest, ShortAndLongCodeMixtures) {
+  std::string test_table[] = {
+      "a",                                    // Single short-code symbol.
+      "ab",                                   // One fused pair.
+      "abc",                                  // Pair plus trailing symbol.
+      "0123456789abcdefghijklmnopqrstuvwxyz", // Many fused pairs.
+      std::string(1, '\x01'),                 // Single long-code symbol.
+      std::string("\x01\x01", 2),             // Long codes never fuse.
+      std::string("a\x01" "b\x01" "c", 5),    // Alternating short and long.
+      std::string("ab\x01" "cd", 5),          // Pair broken by a long code.
+  };
+  for (size_t i = 0; i != ABSL_ARRAYSIZE(test_table); ++i) {
+    const std::string& plain_string = test_table[i];
+    size_t encoded_size = HuffmanSize(plain_string);
+    std::string slow_encoded;
+    HuffmanEncode(plain_string, encoded_size, &slow_encoded);
+    std::string fast_encoded;
+    HuffmanEncodeFast(plain_string, encoded_size, &fast_encoded);
+    EXPECT_EQ(encoded_size, slow_encoded.size());
+    EXPECT_EQ(slow_encoded, fast_encoded)
+        << "Encoder mismatch for " << absl::CEscape(plain_string);
+  }
+}
+
 // Test that encoding appends to output without overwriting it.
 TEST_P(HuffmanEncoderTest, AppendToOutput) {
   size_t encoded_size = HuffmanSize("foo");
@@ -4,6 +4,7 @@
 
 #include "quic/core/batch_writer/quic_gso_batch_writer.h"
 
+#include <cerrno>
 #include <time.h>
 #include <ctime>
 
@@ -77,7 +78,7 @@ QuicGsoBatchWriter::CanBatchResult QuicGsoBatchWriter::CanBatch(
   const bool can_burst = !SupportsReleaseTime() || !options ||
                          options->release_time_delay.IsZero() ||
                          options->allow_burst;
-  size_t max_segments = MaxSegments(first.buf_len);
+  size_t max_segments = CurrentMaxSegments(first.buf_len);
   bool can_batch =
       buffered_writes().size() < max_segments &&                    // [0]
       last.self_address == self_address &&                          // [1]
@@ -129,8 +130,46 @@ QuicGsoBatchWriter::ReleaseTime QuicGsoBatchWriter::GetReleaseTime(
     return result;
   }
 
-  // Send according to the release time delay.
-  return {ideal_release_time, QuicTime::Delta::Zero()};
+  // Send according to the release time delay, quantized so that packets
+  // whose ideal release times fall into the same window share a release time
+  // and can stay in one GSO batch.
+  const uint64_t actual_release_time =
+      options->release_time_delay.IsZero()
+          ? ideal_release_time
+          : QuantizeReleaseTime(ideal_release_time);
+  const int64_t offset_ns = actual_release_time - ideal_release_time;
+  return {actual_release_time,
+          QuicTime::Delta::FromMicroseconds(offset_ns / 1000)};
+}
+
+uint64_t QuicGsoBatchWriter::QuantizeReleaseTime(uint64_t release_time) const {
+  if (release_time_quantization_ns_ == 0) {
+    return release_time;
+  }
+  // Round up: a packet is never released earlier than the pacer intended, and
+  // the added delay is bounded by one quantum.
+  const uint64_t quantum = release_time_quantization_ns_;
+  return (release_time + quantum - 1) / quantum * quantum;
+}
+
+void QuicGsoBatchWriter::RecordReleaseTimeDrift(uint64_t release_time,
+                                                uint64_t now_ns) {
+  ++release_time_stats_.txtime_flushes;
+  if (now_ns > release_time) {
+    ++release_time_stats_.late_handoffs;
+    release_time_stats_.max_handoff_drift_ns = std::max(
+        release_time_stats_.max_handoff_drift_ns, now_ns - release_time);
+  }
+}
+
+void QuicGsoBatchWriter::OnTxTimeRejected() {
+  supports_release_time_ = false;
+  release_time_stats_.reverted_to_userspace_pacing = true;
+  QUIC_LOG_FIRST_N(WARNING, 5)
+      << "Kernel rejected SO_TXTIME at send time, possibly because no ETF/FQ "
+         "qdisc is installed on the egress device or the qdisc's clockid does "
+         "not match ours; reverting to userspace pacing. fd: "
+      << fd();
 }
 
 uint64_t QuicGsoBatchWriter::NowInNanosForReleaseTime() const {
@@ -143,6 +182,74 @@ uint64_t QuicGsoBatchWriter::NowInNanosForReleaseTime() const {
   return ts.tv_sec * (1000ULL * 1000 * 1000) + ts.tv_nsec;
 }
 
+void QuicGsoBatchWriter::AdjustBurstAfterFlush(size_t num_segments,
+                                               const WriteResult& result,
+                                               uint64_t flush_latency_ns) {
+  // Per-segment latency has to inflate by this much over the EWMA before the
+  // burst size is reduced.
+  constexpr uint64_t kLatencyBackoffNumerator = 2;
+  // Number of consecutive well-behaved full bursts before probing a larger
+  // burst size.
+  constexpr size_t kFullBurstsBeforeIncrease = 16;
+
+  ++stats_.flushes;
+  if (result.status != WRITE_STATUS_OK) {
+    // EMSGSIZE and ENOBUFS indicate the NIC or qdisc can't absorb bursts of
+    // the current size; back off multiplicatively.
+    if (result.status == WRITE_STATUS_MSG_TOO_BIG ||
+        (result.status == WRITE_STATUS_ERROR &&
+         result.error_code == ENOBUFS)) {
+      adaptive_max_segments_ =
+          std::max(kMinAdaptiveSegments, adaptive_max_segments_ / 2);
+      ++stats_.burst_backoffs;
+      good_full_bursts_ = 0;
+      QUIC_DVLOG(1) << "GSO burst backoff on send error, new limit: "
+                    << adaptive_max_segments_;
+    }
+    return;
+  }
+
+  stats_.segments_sent += num_segments;
+  if (num_segments == 0 || flush_latency_ns == 0) {
+    return;
+  }
+  const uint64_t segment_latency_ns = flush_latency_ns / num_segments;
+  if (ewma_segment_latency_ns_ == 0) {
+    ewma_segment_latency_ns_ = segment_latency_ns;
+    return;
+  }
+  const bool latency_inflated =
+      segment_latency_ns >
+      kLatencyBackoffNumerator * ewma_segment_latency_ns_;
+  // EWMA with gain 1/8.
+  ewma_segment_latency_ns_ +=
+      (static_cast<int64_t>(segment_latency_ns) -
+       static_cast<int64_t>(ewma_segment_latency_ns_)) /
+      8;
+
+  if (latency_inflated && num_segments >= adaptive_max_segments_ &&
+      adaptive_max_segments_ > kMinAdaptiveSegments) {
+    adaptive_max_segments_ =
+        std::max(kMinAdaptiveSegments, adaptive_max_segments_ / 2);
+    ++stats_.burst_backoffs;
+    good_full_bursts_ = 0;
+    QUIC_DVLOG(1) << "GSO burst backoff on latency inflation, new limit: "
+                  << adaptive_max_segments_;
+    return;
+  }
+
+  if (!latency_inflated && num_segments >= adaptive_max_segments_ &&
+      adaptive_max_segments_ < kMaxAdaptiveSegments) {
+    if (++good_full_bursts_ >= kFullBurstsBeforeIncrease) {
+      ++adaptive_max_segments_;
+      ++stats_.burst_increases;
+      good_full_bursts_ = 0;
+      QUIC_DVLOG(1) << "GSO burst increase, new limit: "
+                    << adaptive_max_segments_;
+    }
+  }
+}
+
 // static
 void QuicGsoBatchWriter::BuildCmsg(QuicMsgHdr* hdr,
                                    const QuicIpAddress& self_address,
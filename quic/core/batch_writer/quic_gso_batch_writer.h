@@ -5,7 +5,11 @@
 #ifndef QUICHE_QUIC_PLATFORM_IMPL_BATCH_WRITER_QUIC_GSO_BATCH_WRITER_H_
 #define QUICHE_QUIC_PLATFORM_IMPL_BATCH_WRITER_QUIC_GSO_BATCH_WRITER_H_
 
+#include <algorithm>
+#include <cerrno>
+
 #include "quic/core/batch_writer/quic_batch_writer_base.h"
+#include "quic/platform/api/quic_logging.h"
 
 namespace quic {
 
@@ -30,6 +34,57 @@ class QUIC_EXPORT_PRIVATE QuicGsoBatchWriter : public QuicUdpBatchWriter {
 
   FlushImplResult FlushImpl() override;
 
+  // Counters describing how well GSO bursts are being absorbed by this
+  // socket. One GSO socket is typically shared by many connections, so these
+  // are exposed per writer rather than per QuicConnectionStats.
+  struct QUIC_EXPORT_PRIVATE AdaptiveBurstStats {
+    // Number of flushes, i.e. sendmsg calls.
+    QuicPacketCount flushes = 0;
+    // Total segments handed to the kernel by successful flushes.
+    QuicPacketCount segments_sent = 0;
+    // Number of times the burst size limit was raised.
+    QuicPacketCount burst_increases = 0;
+    // Number of times the burst size limit was lowered due to send errors or
+    // flush latency inflation.
+    QuicPacketCount burst_backoffs = 0;
+  };
+
+  const AdaptiveBurstStats& adaptive_burst_stats() const { return stats_; }
+
+  // Counters describing how well kernel pacing(SO_TXTIME with an ETF or FQ
+  // qdisc) is keeping up with the release times requested by the pacer.
+  struct QUIC_EXPORT_PRIVATE ReleaseTimeStats {
+    // Flushes that carried a SO_TXTIME timestamp.
+    QuicPacketCount txtime_flushes = 0;
+    // Flushes whose requested release time was already in the past by the
+    // time the burst was handed to the kernel. The qdisc cannot honor such
+    // deadlines, so these measure userspace scheduling drift.
+    QuicPacketCount late_handoffs = 0;
+    // Largest observed lateness of a handoff, in nanos.
+    uint64_t max_handoff_drift_ns = 0;
+    // True if release time was disabled at runtime because the kernel
+    // rejected a txtime at send time, e.g. there is no ETF/FQ qdisc on the
+    // egress device, or the qdisc's clockid does not match ours. Packets are
+    // then paced purely by the userspace send alarm.
+    bool reverted_to_userspace_pacing = false;
+  };
+
+  const ReleaseTimeStats& release_time_stats() const {
+    return release_time_stats_;
+  }
+
+  // Quantum for release time quantization, zero(the default) to disable.
+  // When enabled, release times of paced packets are rounded up to the next
+  // multiple of the quantum, so packets whose ideal release times fall into
+  // the same window share a release time and can stay in one GSO batch
+  // instead of flushing on every per-packet pacing step. A packet is never
+  // released earlier than the pacer intended; the added delay is bounded by
+  // one quantum. Packets with no release time delay are not quantized.
+  void set_release_time_quantization(QuicTime::Delta quantum) {
+    QUICHE_DCHECK_LE(QuicTime::Delta::Zero(), quantum);
+    release_time_quantization_ns_ = quantum.ToMicroseconds() * 1000;
+  }
+
  protected:
   // Test only constructor to forcefully enable release time.
   struct QUIC_EXPORT_PRIVATE ReleaseTimeForceEnabler {};
@@ -52,6 +107,26 @@ class QUIC_EXPORT_PRIVATE QuicGsoBatchWriter : public QuicUdpBatchWriter {
     return gso_size <= 2 ? 16 : 45;
   }
 
+  // Lower bound for the adaptive burst size limit; below this GSO stops
+  // paying for itself.
+  static constexpr size_t kMinAdaptiveSegments = 4;
+  // Upper bound for the adaptive burst size limit, UDP_MAX_SEGMENTS.
+  static constexpr size_t kMaxAdaptiveSegments = 64;
+
+  // The effective segment limit for this socket: the static MaxSegments()
+  // heuristic capped by the runtime-adapted per-socket limit.
+  size_t CurrentMaxSegments(size_t gso_size) const {
+    return std::min(MaxSegments(gso_size), adaptive_max_segments_);
+  }
+
+  // Called after every flush with the burst size, the write result and the
+  // observed sendmsg latency. Backs the limit off multiplicatively on
+  // EMSGSIZE/ENOBUFS or per-segment latency inflation, and raises it
+  // additively after a streak of well-behaved full bursts.
+  void AdjustBurstAfterFlush(size_t num_segments,
+                             const WriteResult& result,
+                             uint64_t flush_latency_ns);
+
   static const int kCmsgSpace =
       kCmsgSpaceForIp + kCmsgSpaceForSegmentSize + kCmsgSpaceForTxTime;
   static void BuildCmsg(QuicMsgHdr* hdr,
@@ -75,9 +150,30 @@ class QUIC_EXPORT_PRIVATE QuicGsoBatchWriter : public QuicUdpBatchWriter {
                    sizeof(cbuf));
 
     uint16_t gso_size = buffered_writes().size() > 1 ? first.buf_len : 0;
-    cmsg_builder(&hdr, first.self_address, gso_size, first.release_time);
+    const uint64_t release_time =
+        supports_release_time_ ? first.release_time : 0;
+    cmsg_builder(&hdr, first.self_address, gso_size, release_time);
 
+    const uint64_t flush_start_ns = NowInNanosForReleaseTime();
+    if (release_time != 0) {
+      RecordReleaseTimeDrift(release_time, flush_start_ns);
+    }
     write_result = QuicLinuxSocketUtils::WritePacket(fd(), hdr);
+    if (release_time != 0 && write_result.status == WRITE_STATUS_ERROR &&
+        write_result.error_code == EINVAL) {
+      // The kernel accepted SO_TXTIME at socket setup but rejected this
+      // txtime at send time. Revert to userspace pacing and retry the flush
+      // without a release time.
+      OnTxTimeRejected();
+      char retry_cbuf[CmsgSpace];
+      QuicMsgHdr retry_hdr(first.buffer, total_bytes, first.peer_address,
+                           retry_cbuf, sizeof(retry_cbuf));
+      cmsg_builder(&retry_hdr, first.self_address, gso_size,
+                   /*release_time=*/0);
+      write_result = QuicLinuxSocketUtils::WritePacket(fd(), retry_hdr);
+    }
+    AdjustBurstAfterFlush(buffered_writes().size(), write_result,
+                          NowInNanosForReleaseTime() - flush_start_ns);
     QUIC_DVLOG(1) << "Write GSO packet result: " << write_result
                   << ", fd: " << fd()
                   << ", self_address: " << first.self_address.ToString()
@@ -108,8 +204,35 @@ class QUIC_EXPORT_PRIVATE QuicGsoBatchWriter : public QuicUdpBatchWriter {
  private:
   static std::unique_ptr<QuicBatchWriterBuffer> CreateBatchWriterBuffer();
 
+  // Rounds |release_time| up to the next multiple of the configured quantum.
+  // Returns |release_time| unchanged if quantization is disabled.
+  uint64_t QuantizeReleaseTime(uint64_t release_time) const;
+
+  // Updates |release_time_stats_| for a flush carrying |release_time|, handed
+  // to the kernel at |now_ns|.
+  void RecordReleaseTimeDrift(uint64_t release_time, uint64_t now_ns);
+
+  // Called when the kernel rejects a txtime at send time. Disables release
+  // time for this writer; packets are paced by the userspace send alarm from
+  // here on.
+  void OnTxTimeRejected();
+
   const clockid_t clockid_for_release_time_;
-  const bool supports_release_time_;
+  // Initialized by probing SO_TXTIME support on the socket; may flip to false
+  // at runtime if the kernel rejects a txtime at send time.
+  bool supports_release_time_;
+
+  // Quantum for release time quantization in nanos; zero means disabled.
+  uint64_t release_time_quantization_ns_ = 0;
+
+  // Runtime-adapted burst size limit for this socket.
+  size_t adaptive_max_segments_ = kMaxAdaptiveSegments;
+  // EWMA of per-segment sendmsg latency in nanos; 0 until the first sample.
+  uint64_t ewma_segment_latency_ns_ = 0;
+  // Number of consecutive full-size bursts without latency inflation.
+  size_t good_full_bursts_ = 0;
+  AdaptiveBurstStats stats_;
+  ReleaseTimeStats release_time_stats_;
 };
 
 }  // namespace quic
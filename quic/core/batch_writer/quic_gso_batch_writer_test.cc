@@ -35,11 +35,15 @@ uint64_t MillisToNanos(uint64_t milliseconds) {
 
 class QUIC_EXPORT_PRIVATE TestQuicGsoBatchWriter : public QuicGsoBatchWriter {
  public:
+  using QuicGsoBatchWriter::AdjustBurstAfterFlush;
   using QuicGsoBatchWriter::batch_buffer;
   using QuicGsoBatchWriter::buffered_writes;
   using QuicGsoBatchWriter::CanBatch;
   using QuicGsoBatchWriter::CanBatchResult;
+  using QuicGsoBatchWriter::CurrentMaxSegments;
   using QuicGsoBatchWriter::GetReleaseTime;
+  using QuicGsoBatchWriter::kMaxAdaptiveSegments;
+  using QuicGsoBatchWriter::kMinAdaptiveSegments;
   using QuicGsoBatchWriter::MaxSegments;
   using QuicGsoBatchWriter::QuicGsoBatchWriter;
   using QuicGsoBatchWriter::ReleaseTime;
@@ -467,6 +471,176 @@ TEST_F(QuicGsoBatchWriterTest, ReleaseTime) {
   EXPECT_EQ(result.send_time_offset, QuicTime::Delta::Zero());
 }
 
+TEST_F(QuicGsoBatchWriterTest, ReleaseTimeQuantization) {
+  const WriteResult write_buffered(WRITE_STATUS_OK, 0);
+
+  auto writer = TestQuicGsoBatchWriter::NewInstanceWithReleaseTimeSupport();
+  writer->set_release_time_quantization(QuicTime::Delta::FromMicroseconds(300));
+
+  TestPerPacketOptions options;
+  // Packets without a pacing delay are not quantized.
+  EXPECT_TRUE(options.release_time_delay.IsZero());
+  EXPECT_EQ(MillisToNanos(1),
+            writer->GetReleaseTime(&options).actual_release_time);
+
+  // The 1st packet is paced; its release time rounds up to the next 300us
+  // boundary, at 1.2ms.
+  options.release_time_delay = QuicTime::Delta::FromMicroseconds(50);
+  WriteResult result = WritePacketWithOptions(writer.get(), &options);
+  ASSERT_EQ(write_buffered, result);
+  EXPECT_EQ(1200000u, writer->buffered_writes().back().release_time);
+  EXPECT_EQ(QuicTime::Delta::FromMicroseconds(150), result.send_time_offset);
+
+  // The 2nd packet's ideal release time falls into the same window, so it
+  // shares the release time of the 1st packet and is batched with it.
+  options.release_time_delay = QuicTime::Delta::FromMicroseconds(150);
+  result = WritePacketWithOptions(writer.get(), &options);
+  ASSERT_EQ(write_buffered, result);
+  ASSERT_EQ(2u, writer->buffered_writes().size());
+  EXPECT_EQ(1200000u, writer->buffered_writes().back().release_time);
+  EXPECT_EQ(QuicTime::Delta::FromMicroseconds(50), result.send_time_offset);
+
+  // The 3rd packet lands in the next window, which flushes the batch.
+  EXPECT_CALL(mock_syscalls_, Sendmsg(_, _, _))
+      .WillOnce(Invoke([](int /*sockfd*/, const msghdr* msg, int /*flags*/) {
+        EXPECT_EQ(2700u, PacketLength(msg));
+        errno = 0;
+        return 0;
+      }));
+  options.release_time_delay = QuicTime::Delta::FromMicroseconds(350);
+  result = WritePacketWithOptions(writer.get(), &options);
+  ASSERT_EQ(WriteResult(WRITE_STATUS_OK, 2700), result);
+  ASSERT_EQ(1u, writer->buffered_writes().size());
+  EXPECT_EQ(1500000u, writer->buffered_writes().back().release_time);
+}
+
+TEST_F(QuicGsoBatchWriterTest, AdaptiveBurstBacksOffOnSendErrors) {
+  TestQuicGsoBatchWriter writer(/*fd=*/-1);
+  const size_t initial_limit = writer.CurrentMaxSegments(1350);
+
+  // ENOBUFS halves the burst size limit.
+  writer.AdjustBurstAfterFlush(initial_limit,
+                               WriteResult(WRITE_STATUS_ERROR, ENOBUFS),
+                               /*flush_latency_ns=*/10000);
+  EXPECT_EQ(initial_limit / 2, writer.CurrentMaxSegments(1350));
+
+  // So does EMSGSIZE, down to the floor.
+  for (int i = 0; i < 10; ++i) {
+    writer.AdjustBurstAfterFlush(
+        writer.CurrentMaxSegments(1350),
+        WriteResult(WRITE_STATUS_MSG_TOO_BIG, EMSGSIZE),
+        /*flush_latency_ns=*/10000);
+  }
+  EXPECT_EQ(TestQuicGsoBatchWriter::kMinAdaptiveSegments,
+            writer.CurrentMaxSegments(1350));
+  EXPECT_EQ(0u, writer.adaptive_burst_stats().segments_sent);
+  EXPECT_GT(writer.adaptive_burst_stats().burst_backoffs, 0u);
+
+  // Unrelated errors (e.g. EWOULDBLOCK) do not shrink the burst.
+  const size_t limit = writer.CurrentMaxSegments(1350);
+  writer.AdjustBurstAfterFlush(limit,
+                               WriteResult(WRITE_STATUS_BLOCKED, EWOULDBLOCK),
+                               /*flush_latency_ns=*/10000);
+  EXPECT_EQ(limit, writer.CurrentMaxSegments(1350));
+}
+
+TEST_F(QuicGsoBatchWriterTest, AdaptiveBurstRecoversAfterGoodFullBursts) {
+  TestQuicGsoBatchWriter writer(/*fd=*/-1);
+  writer.AdjustBurstAfterFlush(writer.CurrentMaxSegments(1350),
+                               WriteResult(WRITE_STATUS_ERROR, ENOBUFS),
+                               /*flush_latency_ns=*/10000);
+  const size_t backed_off_limit = writer.CurrentMaxSegments(1350);
+  ASSERT_LT(backed_off_limit, MaxSegments(1350));
+
+  // A long streak of full bursts with steady per-segment latency raises the
+  // limit again.
+  for (int i = 0; i < 100; ++i) {
+    writer.AdjustBurstAfterFlush(writer.CurrentMaxSegments(1350),
+                                 WriteResult(WRITE_STATUS_OK, 0),
+                                 /*flush_latency_ns=*/writer.CurrentMaxSegments(
+                                     1350) * 1000);
+  }
+  EXPECT_GT(writer.CurrentMaxSegments(1350), backed_off_limit);
+  EXPECT_GT(writer.adaptive_burst_stats().burst_increases, 0u);
+  EXPECT_GT(writer.adaptive_burst_stats().segments_sent, 0u);
+}
+
+bool HasTxTimeCmsg(const msghdr* msg) {
+  msghdr* mutable_msg = const_cast<msghdr*>(msg);
+  for (cmsghdr* cmsg = CMSG_FIRSTHDR(mutable_msg); cmsg != nullptr;
+       cmsg = CMSG_NXTHDR(mutable_msg, cmsg)) {
+    if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SO_TXTIME) {
+      return true;
+    }
+  }
+  return false;
+}
+
+TEST_F(QuicGsoBatchWriterTest, ReleaseTimeDriftStats) {
+  auto writer = TestQuicGsoBatchWriter::NewInstanceWithReleaseTimeSupport();
+
+  // Buffer one packet with a 2ms pacing delay, i.e. a release time of 3ms.
+  TestPerPacketOptions options;
+  options.release_time_delay = QuicTime::Delta::FromMilliseconds(2);
+  ASSERT_EQ(WriteResult(WRITE_STATUS_OK, 0),
+            WritePacketWithOptions(writer.get(), &options));
+  EXPECT_EQ(MillisToNanos(3), writer->buffered_writes().back().release_time);
+
+  // By the time the burst is flushed, the release time is 2ms in the past.
+  writer->ForceReleaseTimeMs(5);
+  EXPECT_CALL(mock_syscalls_, Sendmsg(_, _, _))
+      .WillOnce(Invoke([](int /*sockfd*/, const msghdr* msg, int /*flags*/) {
+        EXPECT_TRUE(HasTxTimeCmsg(msg));
+        errno = 0;
+        return 1350;
+      }));
+  ASSERT_EQ(WriteResult(WRITE_STATUS_OK, 1350), writer->Flush());
+
+  EXPECT_EQ(1u, writer->release_time_stats().txtime_flushes);
+  EXPECT_EQ(1u, writer->release_time_stats().late_handoffs);
+  EXPECT_EQ(MillisToNanos(2),
+            writer->release_time_stats().max_handoff_drift_ns);
+  EXPECT_FALSE(writer->release_time_stats().reverted_to_userspace_pacing);
+  EXPECT_TRUE(writer->SupportsReleaseTime());
+}
+
+TEST_F(QuicGsoBatchWriterTest, TxTimeRejectionRevertsToUserspacePacing) {
+  auto writer = TestQuicGsoBatchWriter::NewInstanceWithReleaseTimeSupport();
+
+  // Buffer two packets sharing a release time of 3ms.
+  TestPerPacketOptions options;
+  options.release_time_delay = QuicTime::Delta::FromMilliseconds(2);
+  ASSERT_EQ(WriteResult(WRITE_STATUS_OK, 0),
+            WritePacketWithOptions(writer.get(), &options));
+  options.allow_burst = true;
+  ASSERT_EQ(WriteResult(WRITE_STATUS_OK, 0),
+            WritePacketWithOptions(writer.get(), &options));
+  ASSERT_EQ(2u, writer->buffered_writes().size());
+
+  // The kernel rejects the txtime with EINVAL, e.g. because no ETF/FQ qdisc
+  // is installed. The flush is retried without a release time and the writer
+  // reverts to userspace pacing.
+  EXPECT_CALL(mock_syscalls_, Sendmsg(_, _, _))
+      .WillOnce(Invoke([](int /*sockfd*/, const msghdr* msg, int /*flags*/) {
+        EXPECT_EQ(2700u, PacketLength(msg));
+        EXPECT_TRUE(HasTxTimeCmsg(msg));
+        errno = EINVAL;
+        return -1;
+      }))
+      .WillOnce(Invoke([](int /*sockfd*/, const msghdr* msg, int /*flags*/) {
+        EXPECT_EQ(2700u, PacketLength(msg));
+        EXPECT_FALSE(HasTxTimeCmsg(msg));
+        errno = 0;
+        return 2700;
+      }));
+  ASSERT_EQ(WriteResult(WRITE_STATUS_OK, 2700), writer->Flush());
+  EXPECT_TRUE(writer->buffered_writes().empty());
+
+  EXPECT_FALSE(writer->SupportsReleaseTime());
+  EXPECT_TRUE(writer->release_time_stats().reverted_to_userspace_pacing);
+  EXPECT_EQ(1u, writer->release_time_stats().txtime_flushes);
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace quic
@@ -0,0 +1,83 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/congestion_control/bandwidth_estimate_store.h"
+
+#include <memory>
+#include <string>
+
+namespace quic {
+
+namespace {
+
+// Key lengths in bytes: a /24 prefix for IPv4 and a /48 prefix for IPv6. The
+// lengths differ, so keys of different families cannot collide.
+constexpr size_t kIPv4PrefixBytes = 3;
+constexpr size_t kIPv6PrefixBytes = 6;
+
+}  // namespace
+
+constexpr QuicTime::Delta BandwidthEstimateStore::kBandwidthEstimateLifetime;
+
+BandwidthEstimateStore::BandwidthEstimateStore(size_t capacity)
+    : estimates_(capacity) {}
+
+// static
+std::string BandwidthEstimateStore::PrefixKey(
+    const QuicSocketAddress& peer_address) {
+  if (!peer_address.IsInitialized()) {
+    return std::string();
+  }
+  // Normalize so that an IPv4-mapped IPv6 address shares its key with the
+  // equivalent pure IPv4 address.
+  const QuicIpAddress host = peer_address.host().Normalized();
+  const std::string packed = host.ToPackedString();
+  const size_t prefix_bytes =
+      host.IsIPv4() ? kIPv4PrefixBytes : kIPv6PrefixBytes;
+  if (packed.length() < prefix_bytes) {
+    return std::string();
+  }
+  return packed.substr(0, prefix_bytes);
+}
+
+void BandwidthEstimateStore::RecordEstimate(
+    const QuicSocketAddress& peer_address,
+    QuicBandwidth bandwidth,
+    QuicTime::Delta rtt,
+    QuicTime now) {
+  if (bandwidth.IsZero()) {
+    return;
+  }
+  const std::string key = PrefixKey(peer_address);
+  if (key.empty()) {
+    return;
+  }
+  auto estimate = std::make_unique<Estimate>();
+  estimate->bandwidth = bandwidth;
+  estimate->rtt = rtt;
+  estimate->recorded_time = now;
+  estimates_.Insert(key, std::move(estimate));
+}
+
+absl::optional<SendAlgorithmInterface::NetworkParams>
+BandwidthEstimateStore::GetNetworkParams(const QuicSocketAddress& peer_address,
+                                         QuicTime now) {
+  const std::string key = PrefixKey(peer_address);
+  if (key.empty()) {
+    return absl::nullopt;
+  }
+  auto it = estimates_.Lookup(key);
+  if (it == estimates_.end()) {
+    return absl::nullopt;
+  }
+  const Estimate& estimate = *it->second;
+  if (estimate.recorded_time + kBandwidthEstimateLifetime < now) {
+    estimates_.Erase(it);
+    return absl::nullopt;
+  }
+  return SendAlgorithmInterface::NetworkParams(
+      estimate.bandwidth, estimate.rtt, /*allow_cwnd_to_decrease=*/false);
+}
+
+}  // namespace quic
@@ -0,0 +1,75 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_CONGESTION_CONTROL_BANDWIDTH_ESTIMATE_STORE_H_
+#define QUICHE_QUIC_CORE_CONGESTION_CONTROL_BANDWIDTH_ESTIMATE_STORE_H_
+
+#include <string>
+
+#include "absl/types/optional.h"
+#include "quic/core/congestion_control/send_algorithm_interface.h"
+#include "quic/core/quic_bandwidth.h"
+#include "quic/core/quic_lru_cache.h"
+#include "quic/core/quic_time.h"
+#include "quic/platform/api/quic_export.h"
+#include "quic/platform/api/quic_socket_address.h"
+
+namespace quic {
+
+// BandwidthEstimateStore remembers recent sustained bandwidth estimates keyed
+// by peer network prefix (/24 for IPv4, /48 for IPv6), so that a new
+// connection to a nearby peer can seed its send algorithm via
+// AdjustNetworkParameters() instead of discovering the path from scratch. A
+// server typically records into the store when a connection with a valid
+// QuicSustainedBandwidthRecorder estimate closes, and queries it when a new
+// connection completes its handshake.
+//
+// Entries expire kBandwidthEstimateLifetime after they were recorded and the
+// least recently used entries are evicted beyond the capacity given at
+// construction. Like the QuicLRUCache underneath, a store must be used from
+// one thread at a time; a server typically owns one per dispatcher thread.
+class QUIC_EXPORT_PRIVATE BandwidthEstimateStore {
+ public:
+  static constexpr QuicTime::Delta kBandwidthEstimateLifetime =
+      QuicTime::Delta::FromSeconds(60 * 10);
+
+  explicit BandwidthEstimateStore(size_t capacity);
+  BandwidthEstimateStore(const BandwidthEstimateStore&) = delete;
+  BandwidthEstimateStore& operator=(const BandwidthEstimateStore&) = delete;
+
+  // Stores |bandwidth| and |rtt| for the network prefix of |peer_address|,
+  // replacing any earlier estimate for the same prefix. A typical caller
+  // passes QuicSustainedBandwidthRecorder::BandwidthEstimate() and
+  // RttStats::smoothed_rtt(). No-op if |bandwidth| is zero or |peer_address|
+  // is uninitialized.
+  void RecordEstimate(const QuicSocketAddress& peer_address,
+                      QuicBandwidth bandwidth,
+                      QuicTime::Delta rtt,
+                      QuicTime now);
+
+  // Returns network params seeded from the most recent unexpired estimate for
+  // the network prefix of |peer_address|, or nullopt if there is none.
+  absl::optional<SendAlgorithmInterface::NetworkParams> GetNetworkParams(
+      const QuicSocketAddress& peer_address,
+      QuicTime now);
+
+  size_t Size() const { return estimates_.Size(); }
+
+ private:
+  struct QUIC_EXPORT_PRIVATE Estimate {
+    QuicBandwidth bandwidth = QuicBandwidth::Zero();
+    QuicTime::Delta rtt = QuicTime::Delta::Zero();
+    QuicTime recorded_time = QuicTime::Zero();
+  };
+
+  // Returns the cache key for |peer_address|, or an empty string if the
+  // address cannot be keyed.
+  static std::string PrefixKey(const QuicSocketAddress& peer_address);
+
+  QuicLRUCache<std::string, Estimate> estimates_;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_CONGESTION_CONTROL_BANDWIDTH_ESTIMATE_STORE_H_
@@ -0,0 +1,110 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/congestion_control/bandwidth_estimate_store.h"
+
+#include <string>
+
+#include "quic/platform/api/quic_test.h"
+#include "quic/test_tools/mock_clock.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+class BandwidthEstimateStoreTest : public QuicTest {
+ protected:
+  BandwidthEstimateStoreTest() : store_(/*capacity=*/2) {
+    clock_.AdvanceTime(QuicTime::Delta::FromSeconds(1));
+  }
+
+  QuicSocketAddress Address(const std::string& ip) {
+    QuicIpAddress host;
+    QUICHE_CHECK(host.FromString(ip));
+    return QuicSocketAddress(host, /*port=*/443);
+  }
+
+  MockClock clock_;
+  BandwidthEstimateStore store_;
+};
+
+TEST_F(BandwidthEstimateStoreTest, RecordAndGetSamePrefix) {
+  const QuicBandwidth bandwidth =
+      QuicBandwidth::FromKBitsPerSecond(/*k_bits_per_second=*/5000);
+  const QuicTime::Delta rtt = QuicTime::Delta::FromMilliseconds(30);
+  store_.RecordEstimate(Address("10.1.2.3"), bandwidth, rtt, clock_.Now());
+
+  // A different host in the same /24 gets the estimate.
+  auto params = store_.GetNetworkParams(Address("10.1.2.200"), clock_.Now());
+  ASSERT_TRUE(params.has_value());
+  EXPECT_EQ(bandwidth, params->bandwidth);
+  EXPECT_EQ(rtt, params->rtt);
+  EXPECT_FALSE(params->allow_cwnd_to_decrease);
+
+  // A host in a different /24 does not.
+  EXPECT_FALSE(
+      store_.GetNetworkParams(Address("10.1.3.3"), clock_.Now()).has_value());
+}
+
+TEST_F(BandwidthEstimateStoreTest, ZeroBandwidthAndUninitializedAddress) {
+  store_.RecordEstimate(Address("10.1.2.3"), QuicBandwidth::Zero(),
+                        QuicTime::Delta::FromMilliseconds(30), clock_.Now());
+  store_.RecordEstimate(QuicSocketAddress(),
+                        QuicBandwidth::FromKBitsPerSecond(5000),
+                        QuicTime::Delta::FromMilliseconds(30), clock_.Now());
+  EXPECT_EQ(0u, store_.Size());
+  EXPECT_FALSE(
+      store_.GetNetworkParams(QuicSocketAddress(), clock_.Now()).has_value());
+}
+
+TEST_F(BandwidthEstimateStoreTest, EstimateExpires) {
+  store_.RecordEstimate(Address("10.1.2.3"),
+                        QuicBandwidth::FromKBitsPerSecond(5000),
+                        QuicTime::Delta::FromMilliseconds(30), clock_.Now());
+  clock_.AdvanceTime(BandwidthEstimateStore::kBandwidthEstimateLifetime +
+                     QuicTime::Delta::FromSeconds(1));
+  EXPECT_FALSE(
+      store_.GetNetworkParams(Address("10.1.2.3"), clock_.Now()).has_value());
+  // The expired entry was dropped.
+  EXPECT_EQ(0u, store_.Size());
+}
+
+TEST_F(BandwidthEstimateStoreTest, LeastRecentlyUsedEviction) {
+  const QuicTime::Delta rtt = QuicTime::Delta::FromMilliseconds(30);
+  store_.RecordEstimate(Address("10.1.1.1"),
+                        QuicBandwidth::FromKBitsPerSecond(1000), rtt,
+                        clock_.Now());
+  store_.RecordEstimate(Address("10.1.2.1"),
+                        QuicBandwidth::FromKBitsPerSecond(2000), rtt,
+                        clock_.Now());
+  // Touch the first prefix, then insert a third one; the second prefix is now
+  // the least recently used and gets evicted.
+  EXPECT_TRUE(
+      store_.GetNetworkParams(Address("10.1.1.2"), clock_.Now()).has_value());
+  store_.RecordEstimate(Address("10.1.3.1"),
+                        QuicBandwidth::FromKBitsPerSecond(3000), rtt,
+                        clock_.Now());
+  EXPECT_EQ(2u, store_.Size());
+  EXPECT_TRUE(
+      store_.GetNetworkParams(Address("10.1.1.1"), clock_.Now()).has_value());
+  EXPECT_FALSE(
+      store_.GetNetworkParams(Address("10.1.2.1"), clock_.Now()).has_value());
+}
+
+TEST_F(BandwidthEstimateStoreTest, MappedIPv4SharesKeyWithIPv4) {
+  store_.RecordEstimate(Address("10.1.2.3"),
+                        QuicBandwidth::FromKBitsPerSecond(5000),
+                        QuicTime::Delta::FromMilliseconds(30), clock_.Now());
+  EXPECT_TRUE(store_.GetNetworkParams(Address("::ffff:10.1.2.200"),
+                                      clock_.Now())
+                  .has_value());
+  // IPv6 addresses are keyed by /48 and do not collide with IPv4 keys.
+  EXPECT_FALSE(
+      store_.GetNetworkParams(Address("2001:db8::1"), clock_.Now())
+          .has_value());
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
@@ -147,6 +147,7 @@ BandwidthSampler::BandwidthSampler(
       max_ack_height_tracker_(max_height_tracker_window_length),
       total_bytes_acked_after_last_ack_event_(0),
       overestimate_avoidance_(false),
+      one_way_delay_sampling_(false),
       limit_max_ack_height_tracker_by_send_rate_(false) {}
 
 BandwidthSampler::BandwidthSampler(const BandwidthSampler& other)
@@ -171,6 +172,7 @@ BandwidthSampler::BandwidthSampler(const BandwidthSampler& other)
       total_bytes_acked_after_last_ack_event_(
           other.total_bytes_acked_after_last_ack_event_),
       overestimate_avoidance_(other.overestimate_avoidance_),
+      one_way_delay_sampling_(other.one_way_delay_sampling_),
       limit_max_ack_height_tracker_by_send_rate_(
           other.limit_max_ack_height_tracker_by_send_rate_) {}
 
@@ -185,6 +187,10 @@ void BandwidthSampler::EnableOverestimateAvoidance() {
   max_ack_height_tracker_.SetAckAggregationBandwidthThreshold(2.0);
 }
 
+void BandwidthSampler::EnableOneWayDelaySampling() {
+  one_way_delay_sampling_ = true;
+}
+
 BandwidthSampler::~BandwidthSampler() {}
 
 void BandwidthSampler::OnPacketSent(
@@ -303,8 +309,16 @@ BandwidthSampler::OnCongestionEvent(QuicTime ack_time,
   SendTimeState last_acked_packet_send_state;
   QuicBandwidth max_send_rate = QuicBandwidth::Zero();
   for (const auto& packet : acked_packets) {
+    // In one-way delay mode, the ack rate curve is advanced by the
+    // peer-reported receive timestamp, when the peer supplied one for this
+    // packet. The local |ack_time| is still used for the RTT sample.
+    QuicTime delivered_time = ack_time;
+    if (one_way_delay_sampling_ &&
+        packet.receive_timestamp != QuicTime::Zero()) {
+      delivered_time = packet.receive_timestamp;
+    }
     BandwidthSample sample =
-        OnPacketAcknowledged(ack_time, packet.packet_number);
+        OnPacketAcknowledged(ack_time, delivered_time, packet.packet_number);
     if (!sample.state_at_send.is_valid) {
       continue;
     }
@@ -382,6 +396,7 @@ QuicByteCount BandwidthSampler::OnAckEventEnd(
 
 BandwidthSample BandwidthSampler::OnPacketAcknowledged(
     QuicTime ack_time,
+    QuicTime delivered_time,
     QuicPacketNumber packet_number) {
   last_acked_packet_ = packet_number;
   ConnectionStateOnSentPacket* sent_packet_pointer =
@@ -390,22 +405,23 @@ BandwidthSample BandwidthSampler::OnPacketAcknowledged(
     // See the TODO below.
     return BandwidthSample();
   }
-  BandwidthSample sample =
-      OnPacketAcknowledgedInner(ack_time, packet_number, *sent_packet_pointer);
+  BandwidthSample sample = OnPacketAcknowledgedInner(
+      ack_time, delivered_time, packet_number, *sent_packet_pointer);
   return sample;
 }
 
 BandwidthSample BandwidthSampler::OnPacketAcknowledgedInner(
     QuicTime ack_time,
+    QuicTime delivered_time,
     QuicPacketNumber packet_number,
     const ConnectionStateOnSentPacket& sent_packet) {
   total_bytes_acked_ += sent_packet.size;
   total_bytes_sent_at_last_acked_packet_ =
       sent_packet.send_time_state.total_bytes_sent;
   last_acked_packet_sent_time_ = sent_packet.sent_time;
-  last_acked_packet_ack_time_ = ack_time;
+  last_acked_packet_ack_time_ = delivered_time;
   if (overestimate_avoidance_) {
-    recent_ack_points_.Update(ack_time, total_bytes_acked_);
+    recent_ack_points_.Update(delivered_time, total_bytes_acked_);
   }
 
   if (is_app_limited_) {
@@ -448,10 +464,12 @@ BandwidthSample BandwidthSampler::OnPacketAcknowledgedInner(
     a0.total_bytes_acked = sent_packet.send_time_state.total_bytes_acked;
   }
 
-  // During the slope calculation, ensure that ack time of the current packet is
-  // always larger than the time of the previous packet, otherwise division by
-  // zero or integer underflow can occur.
-  if (ack_time <= a0.ack_time) {
+  // During the slope calculation, ensure that ack time of the current packet
+  // is always larger than the time of the previous packet, otherwise division
+  // by zero or integer underflow can occur. In one-way delay mode this also
+  // discards samples straddling a switch between the local and the peer clock
+  // domain, e.g. the first sample after quiescense.
+  if (delivered_time <= a0.ack_time) {
     // TODO(wub): Compare this code count before and after fixing clock jitter
     // issue.
     if (a0.ack_time == sent_packet.sent_time) {
@@ -464,7 +482,7 @@ BandwidthSample BandwidthSampler::OnPacketAcknowledgedInner(
         << "Time of the previously acked packet:"
         << a0.ack_time.ToDebuggingValue()
         << " is larger than the ack time of the current packet:"
-        << ack_time.ToDebuggingValue()
+        << delivered_time.ToDebuggingValue()
         << ". acked packet number:" << packet_number
         << ", total_bytes_acked_:" << total_bytes_acked_
         << ", overestimate_avoidance_:" << overestimate_avoidance_
@@ -472,7 +490,7 @@ BandwidthSample BandwidthSampler::OnPacketAcknowledgedInner(
     return BandwidthSample();
   }
   QuicBandwidth ack_rate = QuicBandwidth::FromBytesAndTimeDelta(
-      total_bytes_acked_ - a0.total_bytes_acked, ack_time - a0.ack_time);
+      total_bytes_acked_ - a0.total_bytes_acked, delivered_time - a0.ack_time);
 
   BandwidthSample sample;
   sample.bandwidth = std::min(send_rate, ack_rate);
@@ -488,7 +506,7 @@ BandwidthSample BandwidthSampler::OnPacketAcknowledgedInner(
         << "ack_rate: " << ack_rate << ", send_rate: " << send_rate
         << ". acked packet number:" << packet_number
         << ", overestimate_avoidance_:" << overestimate_avoidance_ << "a1:{"
-        << total_bytes_acked_ << "@" << ack_time << "}, a0:{"
+        << total_bytes_acked_ << "@" << delivered_time << "}, a0:{"
         << a0.total_bytes_acked << "@" << a0.ack_time
         << "}, sent_packet:" << sent_packet;
   }
@@ -457,6 +457,17 @@ class QUIC_EXPORT_PRIVATE BandwidthSampler : public BandwidthSamplerInterface {
     return overestimate_avoidance_;
   }
 
+  // In one-way delay mode, the ack rate is computed from the peer-reported
+  // receive timestamps(when present in the ACK frame) instead of the local
+  // arrival times of the ACKs. Receive timestamps are taken on the peer when
+  // the data packets arrive, so the resulting delivery rate is immune to ack
+  // delay, ack decimation and local event loop scheduling jitter. The peer
+  // clock does not need to be synchronized with the local clock: only
+  // differences between receive timestamps are used. RTT samples are still
+  // computed from local time.
+  void EnableOneWayDelaySampling();
+  bool IsOneWayDelaySamplingEnabled() const { return one_way_delay_sampling_; }
+
  private:
   friend class test::BandwidthSamplerPeer;
 
@@ -528,7 +539,12 @@ class QUIC_EXPORT_PRIVATE BandwidthSampler : public BandwidthSamplerInterface {
     }
   };
 
+  // |ack_time| is the local time at which the acknowledgement was processed,
+  // used for RTT samples. |delivered_time| is the time used for the ack rate
+  // curve; it equals |ack_time| unless one-way delay sampling substituted the
+  // peer-reported receive timestamp.
   BandwidthSample OnPacketAcknowledged(QuicTime ack_time,
+                                       QuicTime delivered_time,
                                        QuicPacketNumber packet_number);
 
   SendTimeState OnPacketLost(QuicPacketNumber packet_number,
@@ -609,6 +625,7 @@ class QUIC_EXPORT_PRIVATE BandwidthSampler : public BandwidthSamplerInterface {
   // retrieving and removing |sent_packet|.
   BandwidthSample OnPacketAcknowledgedInner(
       QuicTime ack_time,
+      QuicTime delivered_time,
       QuicPacketNumber packet_number,
       const ConnectionStateOnSentPacket& sent_packet);
 
@@ -618,6 +635,9 @@ class QUIC_EXPORT_PRIVATE BandwidthSampler : public BandwidthSamplerInterface {
   // True if connection option 'BSAO' is set.
   bool overestimate_avoidance_;
 
+  // True if connection option 'BSOW' is set.
+  bool one_way_delay_sampling_;
+
   // True if connection option 'BBRB' is set.
   bool limit_max_ack_height_tracker_by_send_rate_;
 };
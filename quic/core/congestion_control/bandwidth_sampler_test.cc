@@ -216,6 +216,38 @@ TEST_P(BandwidthSamplerTest, SendAndWait) {
   EXPECT_EQ(0u, bytes_in_flight_);
 }
 
+// One-way delay sampling computes the ack rate from the peer-reported receive
+// timestamps instead of the local times at which the acks were processed, so
+// jitter in ack processing does not affect the bandwidth samples. Only
+// differences between receive timestamps are used, so the peer clock does not
+// need to agree with the local one.
+TEST_P(BandwidthSamplerTest, OneWayDelaySamplingIgnoresAckProcessingJitter) {
+  sampler_.EnableOneWayDelaySampling();
+  QuicTime::Delta time_between_packets = QuicTime::Delta::FromMilliseconds(10);
+  QuicBandwidth expected_bandwidth =
+      QuicBandwidth::FromBytesPerSecond(kRegularPacketSize * 100);
+
+  Send40PacketsAndAckFirst20(time_between_packets);
+
+  // Ack packets 21 to 40 with receive timestamps exactly
+  // |time_between_packets| apart, while the local ack processing time lags
+  // behind by up to half of that - mimicking an event loop which falls behind
+  // under load. Without receive timestamps, every other sample would come out
+  // below |expected_bandwidth|.
+  for (int i = 21; i <= 40; i++) {
+    AckedPacket acked_packet = MakeAckedPacket(i);
+    bytes_in_flight_ -= acked_packet.bytes_acked;
+    QuicTime::Delta processing_jitter =
+        QuicTime::Delta::FromMilliseconds(i % 2 == 0 ? 5 : 0);
+    BandwidthSampler::CongestionEventSample sample = sampler_.OnCongestionEvent(
+        clock_.Now() + processing_jitter, {acked_packet}, {}, max_bandwidth_,
+        est_bandwidth_upper_bound_, round_trip_count_);
+    max_bandwidth_ = std::max(max_bandwidth_, sample.sample_max_bandwidth);
+    EXPECT_EQ(expected_bandwidth, sample.sample_max_bandwidth);
+    clock_.AdvanceTime(time_between_packets);
+  }
+}
+
 TEST_P(BandwidthSamplerTest, SendTimeState) {
   QuicTime::Delta time_between_packets = QuicTime::Delta::FromMilliseconds(10);
 
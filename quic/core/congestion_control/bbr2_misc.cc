@@ -153,6 +153,8 @@ void Bbr2NetworkModel::OnCongestionEventStart(
     loss_events_in_round_++;
   }
 
+  ApplyEcnResponse(acked_packets, *congestion_event);
+
   if (congestion_event->bytes_acked > 0 &&
       congestion_event->last_packet_send_state.is_valid &&
       total_bytes_acked() >
@@ -195,6 +197,48 @@ void Bbr2NetworkModel::OnCongestionEventStart(
   }
 }
 
+void Bbr2NetworkModel::ApplyEcnResponse(
+    const AckedPacketVector& acked_packets,
+    const Bbr2CongestionEvent& congestion_event) {
+  if (!ecn_response_enabled_ || acked_packets.empty()) {
+    return;
+  }
+
+  // DCTCP gain: alpha moves 1/16th of the way towards the observed mark
+  // fraction on every congestion event with acked packets.
+  constexpr float kEcnAlphaGain = 1.0 / 16.0;
+
+  // The peer reports cumulative CE counts per ACK, so the marks pending here
+  // can not exceed the packets acknowledged by this event.
+  const QuicPacketCount newly_marked = std::min<QuicPacketCount>(
+      pending_ecn_ce_marks_, acked_packets.size());
+  pending_ecn_ce_marks_ -= newly_marked;
+
+  const float mark_fraction =
+      static_cast<float>(newly_marked) / acked_packets.size();
+  ecn_alpha_ = (1.0 - kEcnAlphaGain) * ecn_alpha_ +
+               kEcnAlphaGain * mark_fraction;
+
+  if (newly_marked == 0) {
+    return;
+  }
+
+  // Scale the upper inflight bound down by alpha/2, mirroring DCTCP's cwnd
+  // response. When inflight_hi is not yet set, start from the current cwnd.
+  const QuicByteCount base_inflight_hi = (inflight_hi_ == inflight_hi_default())
+                                             ? congestion_event.prior_cwnd
+                                             : inflight_hi_;
+  const QuicByteCount target_inflight_hi = std::max<QuicByteCount>(
+      base_inflight_hi * (1.0 - ecn_alpha_ / 2.0), 4 * kDefaultTCPMSS);
+  if (target_inflight_hi < inflight_hi_) {
+    QUIC_DVLOG(3) << "Reducing inflight_hi due to " << newly_marked
+                  << " CE marked packets, ecn_alpha:" << ecn_alpha_
+                  << ", inflight_hi:" << inflight_hi_ << " -> "
+                  << target_inflight_hi;
+    inflight_hi_ = target_inflight_hi;
+  }
+}
+
 void Bbr2NetworkModel::AdaptLowerBounds(
     const Bbr2CongestionEvent& congestion_event) {
   if (Params().bw_lo_mode_ == Bbr2Params::DEFAULT) {
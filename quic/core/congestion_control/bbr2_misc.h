@@ -414,10 +414,26 @@ class QUIC_EXPORT_PRIVATE Bbr2NetworkModel {
     bandwidth_sampler_.EnableOverestimateAvoidance();
   }
 
+  void EnableOneWayDelaySampling() {
+    bandwidth_sampler_.EnableOneWayDelaySampling();
+  }
+
   bool IsBandwidthOverestimateAvoidanceEnabled() const {
     return bandwidth_sampler_.IsOverestimateAvoidanceEnabled();
   }
 
+  void EnableEcnResponse() { ecn_response_enabled_ = true; }
+
+  bool IsEcnResponseEnabled() const { return ecn_response_enabled_; }
+
+  // Records |newly_ce_marked_packets| CE marks reported by the peer. The marks
+  // are applied to the model by the next OnCongestionEventStart().
+  void OnEcnCeMarks(QuicPacketCount newly_ce_marked_packets) {
+    pending_ecn_ce_marks_ += newly_ce_marked_packets;
+  }
+
+  float ecn_alpha() const { return ecn_alpha_; }
+
   void OnPacketNeutered(QuicPacketNumber packet_number) {
     bandwidth_sampler_.OnPacketNeutered(packet_number);
   }
@@ -541,6 +557,14 @@ class QUIC_EXPORT_PRIVATE Bbr2NetworkModel {
   // Called when a new round trip starts.
   void OnNewRound();
 
+  // DCTCP-style response to the CE marks accumulated by OnEcnCeMarks():
+  // updates |ecn_alpha_| from the fraction of marked packets in
+  // |acked_packets| and, when marks are present, reduces |inflight_hi_|
+  // proportionally to |ecn_alpha_|. No-op unless EnableEcnResponse() has been
+  // called.
+  void ApplyEcnResponse(const AckedPacketVector& acked_packets,
+                        const Bbr2CongestionEvent& congestion_event);
+
   const Bbr2Params& Params() const { return *params_; }
   const Bbr2Params* const params_;
   RoundTripCounter round_trip_counter_;
@@ -553,6 +577,14 @@ class QUIC_EXPORT_PRIVATE Bbr2NetworkModel {
   Bbr2MaxBandwidthFilter max_bandwidth_filter_;
   MinRttFilter min_rtt_filter_;
 
+  // Whether ApplyEcnResponse() reacts to peer-reported CE marks.
+  bool ecn_response_enabled_ = false;
+  // CE marks reported by the peer that have not yet been applied to the model.
+  QuicPacketCount pending_ecn_ce_marks_ = 0;
+  // DCTCP-style moving average of the fraction of acked packets that were CE
+  // marked. Only updated when the ECN response is enabled.
+  float ecn_alpha_ = 0.0;
+
   // Bytes lost in the current round. Updated once per congestion event.
   QuicByteCount bytes_lost_in_round_ = 0;
   // Number of loss marking events in the current round.
@@ -92,6 +92,12 @@ Bbr2Sender::Bbr2Sender(QuicTime now,
                 << ", PacingRate:" << pacing_rate_ << ", Cwnd:" << cwnd_
                 << ", CwndLimits:" << cwnd_limits() << "  @ " << now;
   QUICHE_DCHECK_EQ(mode_, Bbr2Mode::STARTUP);
+  const int32_t sampling_interval_ms =
+      GetQuicFlag(FLAGS_quic_bbr2_state_sampling_interval_ms);
+  if (sampling_interval_ms > 0) {
+    state_sampler_ = std::make_unique<Bbr2StateSampler>(
+        now, QuicTime::Delta::FromMilliseconds(sampling_interval_ms));
+  }
 }
 
 void Bbr2Sender::SetFromConfig(const QuicConfig& config,
@@ -156,6 +162,12 @@ void Bbr2Sender::ApplyConnectionOptions(
   if (ContainsQuicTag(connection_options, kBSAO)) {
     model_.EnableOverestimateAvoidance();
   }
+  if (ContainsQuicTag(connection_options, kBSOW)) {
+    model_.EnableOneWayDelaySampling();
+  }
+  if (ContainsQuicTag(connection_options, kB2EC)) {
+    model_.EnableEcnResponse();
+  }
   if (ContainsQuicTag(connection_options, kBBQ6)) {
     params_.decrease_startup_pacing_at_end_of_round = true;
   }
@@ -259,6 +271,9 @@ void Bbr2Sender::AdjustNetworkParameters(const NetworkParams& params) {
     if (!params.allow_cwnd_to_decrease) {
       cwnd_ = std::max(cwnd_, prior_cwnd);
     }
+    if (cwnd_ > prior_cwnd) {
+      prior_cwnd_when_network_parameters_adjusted_ = prior_cwnd;
+    }
 
     pacing_rate_ = std::max(pacing_rate_, QuicBandwidth::FromBytesAndTimeDelta(
                                               cwnd_, model_.MinRtt()));
@@ -273,6 +288,10 @@ void Bbr2Sender::SetInitialCongestionWindowInPackets(
   }
 }
 
+void Bbr2Sender::OnEcnFeedback(QuicPacketCount newly_ce_marked_packets) {
+  model_.OnEcnCeMarks(newly_ce_marked_packets);
+}
+
 void Bbr2Sender::OnCongestionEvent(bool /*rtt_updated*/,
                                    QuicByteCount prior_in_flight,
                                    QuicTime event_time,
@@ -324,6 +343,31 @@ void Bbr2Sender::OnCongestionEvent(bool /*rtt_updated*/,
     }
   }
 
+  if (prior_cwnd_when_network_parameters_adjusted_ != 0) {
+    if (model_.full_bandwidth_reached()) {
+      // The bootstrapped estimate has been validated against the actual path.
+      prior_cwnd_when_network_parameters_adjusted_ = 0;
+    } else if (!lost_packets.empty()) {
+      // Loss before the bootstrapped bandwidth was validated: the previous
+      // connection's estimate no longer matches the path. Fall back to the
+      // cwnd the sender had before the jump-start, or the measured BDP if
+      // that is larger.
+      const QuicByteCount safe_cwnd =
+          std::max(prior_cwnd_when_network_parameters_adjusted_,
+                   model_.BDP(model_.BandwidthEstimate()));
+      if (cwnd_ > safe_cwnd) {
+        QUIC_DVLOG(2) << this << " Rolling back bootstrapped cwnd " << cwnd_
+                      << " to " << safe_cwnd << " after loss in STARTUP.  @ "
+                      << event_time;
+        cwnd_ = cwnd_limits().ApplyLimits(safe_cwnd);
+        pacing_rate_ = std::max(
+            model_.BandwidthEstimate(),
+            QuicBandwidth::FromBytesAndTimeDelta(cwnd_, model_.MinRtt()));
+      }
+      prior_cwnd_when_network_parameters_adjusted_ = 0;
+    }
+  }
+
   UpdatePacingRate(congestion_event.bytes_acked);
   QUIC_BUG_IF(quic_bug_10443_2, pacing_rate_.IsZero())
       << "Pacing rate must not be zero!";
@@ -341,6 +385,11 @@ void Bbr2Sender::OnCongestionEvent(bool /*rtt_updated*/,
     OnEnterQuiescence(event_time);
   }
 
+  if (state_sampler_ != nullptr) {
+    state_sampler_->MaybeSample(event_time, mode_, model_, cwnd_, pacing_rate_,
+                                congestion_event.bytes_in_flight);
+  }
+
   QUIC_DVLOG(3)
       << this
       << " END CongestionEvent(acked:" << quiche::PrintElements(acked_packets)
@@ -490,6 +539,9 @@ QuicByteCount Bbr2Sender::GetTargetBytesInflight() const {
 
 void Bbr2Sender::PopulateConnectionStats(QuicConnectionStats* stats) const {
   stats->num_ack_aggregation_epochs = model_.num_ack_aggregation_epochs();
+  if (state_sampler_ != nullptr) {
+    stats->bbr2_state_samples = state_sampler_->SerializeToString();
+  }
 }
 
 void Bbr2Sender::OnEnterQuiescence(QuicTime now) {
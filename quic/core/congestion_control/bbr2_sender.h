@@ -6,11 +6,13 @@
 #define QUICHE_QUIC_CORE_CONGESTION_CONTROL_BBR2_SENDER_H_
 
 #include <cstdint>
+#include <memory>
 
 #include "quic/core/congestion_control/bandwidth_sampler.h"
 #include "quic/core/congestion_control/bbr2_drain.h"
 #include "quic/core/congestion_control/bbr2_misc.h"
 #include "quic/core/congestion_control/bbr2_probe_bw.h"
+#include "quic/core/congestion_control/bbr2_state_sampler.h"
 #include "quic/core/congestion_control/bbr2_probe_rtt.h"
 #include "quic/core/congestion_control/bbr2_startup.h"
 #include "quic/core/congestion_control/bbr_sender.h"
@@ -63,6 +65,8 @@ class QUIC_EXPORT_PRIVATE Bbr2Sender final : public SendAlgorithmInterface {
                          const AckedPacketVector& acked_packets,
                          const LostPacketVector& lost_packets) override;
 
+  void OnEcnFeedback(QuicPacketCount newly_ce_marked_packets) override;
+
   void OnPacketSent(QuicTime sent_time,
                     QuicByteCount bytes_in_flight,
                     QuicPacketNumber packet_number,
@@ -138,6 +142,11 @@ class QUIC_EXPORT_PRIVATE Bbr2Sender final : public SendAlgorithmInterface {
 
   DebugState ExportDebugState() const;
 
+  // Non-null iff --quic_bbr2_state_sampling_interval_ms is positive.
+  const Bbr2StateSampler* state_sampler() const {
+    return state_sampler_.get();
+  }
+
  private:
   void UpdatePacingRate(QuicByteCount bytes_acked);
   void UpdateCongestionWindow(QuicByteCount bytes_acked);
@@ -183,6 +192,13 @@ class QUIC_EXPORT_PRIVATE Bbr2Sender final : public SendAlgorithmInterface {
   QuicByteCount max_cwnd_when_network_parameters_adjusted_ =
       kMaxInitialCongestionWindow * kDefaultTCPMSS;
 
+  // Cwnd in use before AdjustNetworkParameters bootstrapped the cwnd in
+  // STARTUP. If packets are lost before the bootstrapped estimate is
+  // validated by reaching full bandwidth, the cwnd falls back to the measured
+  // BDP, but no lower than this value. Zero when the cwnd has not been
+  // bootstrapped, or once the bootstrap has been validated or rolled back.
+  QuicByteCount prior_cwnd_when_network_parameters_adjusted_ = 0;
+
   Bbr2NetworkModel model_;
 
   const QuicByteCount initial_cwnd_;
@@ -193,6 +209,10 @@ class QUIC_EXPORT_PRIVATE Bbr2Sender final : public SendAlgorithmInterface {
 
   QuicTime last_quiescence_start_ = QuicTime::Zero();
 
+  // Periodically snapshots the network model for offline analysis. Null
+  // unless --quic_bbr2_state_sampling_interval_ms is positive.
+  std::unique_ptr<Bbr2StateSampler> state_sampler_;
+
   Bbr2StartupMode startup_;
   Bbr2DrainMode drain_;
   Bbr2ProbeBwMode probe_bw_;
@@ -1850,6 +1850,39 @@ TEST_F(Bbr2DefaultTopologyTest,
   EXPECT_GT(1024 * params.BottleneckBandwidth(), sender_->PacingRate(0));
 }
 
+TEST_F(Bbr2DefaultTopologyTest, BootstrappedCwndRolledBackOnStartupLoss) {
+  DefaultTopologyParams params;
+  // A shallow queue, so the overshoot from the bootstrapped cwnd causes
+  // losses quickly.
+  params.switch_queue_capacity_in_bdp = 0.5;
+  CreateNetwork(params);
+
+  sender_endpoint_.AddBytesToTransfer(10 * 1024 * 1024);
+  // Wait until an ACK comes back.
+  const QuicTime::Delta timeout = QuicTime::Delta::FromSeconds(5);
+  bool simulator_result = simulator_.RunUntilOrTimeout(
+      [this]() { return !sender_->ExportDebugState().min_rtt.IsZero(); },
+      timeout);
+  ASSERT_TRUE(simulator_result);
+
+  // Bootstrap cwnd by a overly large bandwidth sample.
+  sender_connection()->AdjustNetworkParameters(
+      SendAlgorithmInterface::NetworkParams(1024 * params.BottleneckBandwidth(),
+                                            QuicTime::Delta::Zero(), false));
+  ASSERT_EQ(200 * kDefaultTCPMSS,
+            sender_->ExportDebugState().congestion_window);
+
+  // The overshoot overflows the bottleneck queue. Once losses are detected
+  // before the bootstrapped estimate is validated, the cwnd falls back to
+  // what the path actually supports.
+  simulator_result = simulator_.RunUntilOrTimeout(
+      [this]() { return sender_connection()->GetStats().packets_lost > 0; },
+      timeout);
+  ASSERT_TRUE(simulator_result);
+  EXPECT_LT(sender_->ExportDebugState().congestion_window,
+            200 * kDefaultTCPMSS);
+}
+
 // All Bbr2MultiSenderTests uses the following network topology:
 //
 //   Sender 0  (A Bbr2Sender)
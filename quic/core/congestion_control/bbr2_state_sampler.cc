@@ -0,0 +1,87 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/congestion_control/bbr2_state_sampler.h"
+
+#include "quic/core/quic_data_writer.h"
+#include "quic/platform/api/quic_bug_tracker.h"
+
+namespace quic {
+
+namespace {
+
+// Upper bound on the number of buffered samples per connection. At the
+// default record size this caps the memory cost at roughly 24KB.
+const size_t kMaxBbr2StateSamples = 256;
+
+}  // namespace
+
+Bbr2StateSampler::Bbr2StateSampler(QuicTime now,
+                                   QuicTime::Delta sampling_interval)
+    : creation_time_(now), sampling_interval_(sampling_interval) {}
+
+void Bbr2StateSampler::MaybeSample(QuicTime now,
+                                   Bbr2Mode mode,
+                                   const Bbr2NetworkModel& model,
+                                   QuicByteCount congestion_window,
+                                   QuicBandwidth pacing_rate,
+                                   QuicByteCount bytes_in_flight) {
+  if (last_sample_time_.IsInitialized() &&
+      now - last_sample_time_ < sampling_interval_) {
+    return;
+  }
+  last_sample_time_ = now;
+
+  if (samples_.size() >= kMaxBbr2StateSamples) {
+    samples_.pop_front();
+  }
+
+  Bbr2StateSample sample;
+  sample.timestamp_us = (now - creation_time_).ToMicroseconds();
+  sample.mode = static_cast<uint8_t>(mode);
+  sample.bandwidth_est_bps = model.BandwidthEstimate().ToBitsPerSecond();
+  sample.bandwidth_lo_bps = model.bandwidth_lo().ToBitsPerSecond();
+  sample.bandwidth_hi_bps = model.MaxBandwidth().ToBitsPerSecond();
+  sample.inflight_lo = model.inflight_lo();
+  sample.inflight_hi = model.inflight_hi();
+  sample.congestion_window = congestion_window;
+  sample.pacing_rate_bps = pacing_rate.ToBitsPerSecond();
+  sample.bytes_in_flight = bytes_in_flight;
+  sample.min_rtt_us = model.MinRtt().ToMicroseconds();
+  sample.round_trip_count = model.RoundTripCount();
+  sample.pacing_gain_x100 = static_cast<uint16_t>(model.pacing_gain() * 100);
+  sample.cwnd_gain_x100 = static_cast<uint16_t>(model.cwnd_gain() * 100);
+  samples_.push_back(sample);
+}
+
+std::string Bbr2StateSampler::SerializeToString() const {
+  std::string serialized;
+  serialized.resize(samples_.size() * kBbr2StateSampleSize);
+  QuicDataWriter writer(serialized.size(), &serialized[0]);
+  for (const Bbr2StateSample& sample : samples_) {
+    bool success = writer.WriteUInt64(sample.timestamp_us) &&
+                   writer.WriteUInt8(sample.mode) &&
+                   writer.WriteUInt64(sample.bandwidth_est_bps) &&
+                   writer.WriteUInt64(sample.bandwidth_lo_bps) &&
+                   writer.WriteUInt64(sample.bandwidth_hi_bps) &&
+                   writer.WriteUInt64(sample.inflight_lo) &&
+                   writer.WriteUInt64(sample.inflight_hi) &&
+                   writer.WriteUInt64(sample.congestion_window) &&
+                   writer.WriteUInt64(sample.pacing_rate_bps) &&
+                   writer.WriteUInt64(sample.bytes_in_flight) &&
+                   writer.WriteUInt64(sample.min_rtt_us) &&
+                   writer.WriteUInt64(sample.round_trip_count) &&
+                   writer.WriteUInt16(sample.pacing_gain_x100) &&
+                   writer.WriteUInt16(sample.cwnd_gain_x100);
+    if (!success) {
+      QUIC_BUG(quic_bug_bbr2_state_sampler_serialize)
+          << "Failed to serialize Bbr2 state sample.";
+      return std::string();
+    }
+  }
+  QUICHE_DCHECK_EQ(writer.length(), serialized.size());
+  return serialized;
+}
+
+}  // namespace quic
@@ -0,0 +1,82 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_CONGESTION_CONTROL_BBR2_STATE_SAMPLER_H_
+#define QUICHE_QUIC_CORE_CONGESTION_CONTROL_BBR2_STATE_SAMPLER_H_
+
+#include <cstdint>
+#include <string>
+
+#include "quic/core/congestion_control/bbr2_misc.h"
+#include "quic/core/quic_bandwidth.h"
+#include "quic/core/quic_time.h"
+#include "quic/core/quic_types.h"
+#include "quic/platform/api/quic_export.h"
+#include "common/quiche_circular_deque.h"
+
+namespace quic {
+
+// A point-in-time snapshot of the state of a Bbr2Sender's network model.
+// Samples are kept as plain values and serialized on demand, so recording
+// one is a handful of loads and stores.
+struct QUIC_EXPORT_PRIVATE Bbr2StateSample {
+  // Time the sample was taken, in microseconds since the sampler was
+  // created.
+  uint64_t timestamp_us = 0;
+  // The sender's Bbr2Mode at the time of the sample.
+  uint8_t mode = 0;
+  uint64_t bandwidth_est_bps = 0;
+  uint64_t bandwidth_lo_bps = 0;
+  uint64_t bandwidth_hi_bps = 0;
+  uint64_t inflight_lo = 0;
+  uint64_t inflight_hi = 0;
+  uint64_t congestion_window = 0;
+  uint64_t pacing_rate_bps = 0;
+  uint64_t bytes_in_flight = 0;
+  uint64_t min_rtt_us = 0;
+  uint64_t round_trip_count = 0;
+  // Gains in hundredths, e.g. a pacing gain of 1.25 is stored as 125.
+  uint16_t pacing_gain_x100 = 0;
+  uint16_t cwnd_gain_x100 = 0;
+};
+
+// Size in bytes of one serialized Bbr2StateSample.
+const size_t kBbr2StateSampleSize = 8 + 1 + 10 * 8 + 2 * 2;
+
+// Records periodic fixed-width snapshots of a Bbr2Sender's network model
+// into a bounded ring buffer, so that congestion control behavior can be
+// correlated with model state after the fact. Sampling is driven by the
+// sender's congestion events rather than a timer, so the actual spacing
+// between samples is at least, not exactly, the configured interval.
+class QUIC_EXPORT_PRIVATE Bbr2StateSampler {
+ public:
+  Bbr2StateSampler(QuicTime now, QuicTime::Delta sampling_interval);
+
+  // Records a sample if at least |sampling_interval_| has passed since the
+  // last recorded sample. The oldest sample is evicted once the ring buffer
+  // is full.
+  void MaybeSample(QuicTime now,
+                   Bbr2Mode mode,
+                   const Bbr2NetworkModel& model,
+                   QuicByteCount congestion_window,
+                   QuicBandwidth pacing_rate,
+                   QuicByteCount bytes_in_flight);
+
+  // Serializes the buffered samples, oldest first, as consecutive
+  // fixed-width records of kBbr2StateSampleSize bytes each, with all fields
+  // in network byte order.
+  std::string SerializeToString() const;
+
+  size_t num_samples() const { return samples_.size(); }
+
+ private:
+  const QuicTime creation_time_;
+  const QuicTime::Delta sampling_interval_;
+  QuicTime last_sample_time_ = QuicTime::Zero();
+  quiche::QuicheCircularDeque<Bbr2StateSample> samples_;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_CONGESTION_CONTROL_BBR2_STATE_SAMPLER_H_
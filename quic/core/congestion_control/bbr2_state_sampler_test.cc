@@ -0,0 +1,88 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/congestion_control/bbr2_state_sampler.h"
+
+#include <memory>
+
+#include "quic/core/congestion_control/bbr2_misc.h"
+#include "quic/core/quic_constants.h"
+#include "quic/platform/api/quic_test.h"
+#include "quic/test_tools/mock_clock.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+class Bbr2StateSamplerTest : public QuicTest {
+ protected:
+  Bbr2StateSamplerTest()
+      : params_(kDefaultMinimumCongestionWindow,
+                kMaxInitialCongestionWindow * kDefaultTCPMSS),
+        model_(&params_,
+               QuicTime::Delta::FromMilliseconds(100),
+               clock_.Now(),
+               /*cwnd_gain=*/1.0,
+               /*pacing_gain=*/2.885,
+               /*old_sampler=*/nullptr) {}
+
+  void Sample() {
+    sampler_->MaybeSample(clock_.Now(), Bbr2Mode::STARTUP, model_,
+                          /*congestion_window=*/32 * kDefaultTCPMSS,
+                          QuicBandwidth::FromKBitsPerSecond(1000),
+                          /*bytes_in_flight=*/10 * kDefaultTCPMSS);
+  }
+
+  static constexpr QuicByteCount kDefaultMinimumCongestionWindow =
+      4 * kMaxSegmentSize;
+
+  MockClock clock_;
+  Bbr2Params params_;
+  Bbr2NetworkModel model_;
+  std::unique_ptr<Bbr2StateSampler> sampler_;
+};
+
+TEST_F(Bbr2StateSamplerTest, RespectsSamplingInterval) {
+  sampler_ = std::make_unique<Bbr2StateSampler>(
+      clock_.Now(), QuicTime::Delta::FromMilliseconds(10));
+  Sample();
+  EXPECT_EQ(1u, sampler_->num_samples());
+
+  // A sample within the interval is dropped.
+  clock_.AdvanceTime(QuicTime::Delta::FromMilliseconds(5));
+  Sample();
+  EXPECT_EQ(1u, sampler_->num_samples());
+
+  clock_.AdvanceTime(QuicTime::Delta::FromMilliseconds(5));
+  Sample();
+  EXPECT_EQ(2u, sampler_->num_samples());
+}
+
+TEST_F(Bbr2StateSamplerTest, RingBufferIsBounded) {
+  sampler_ = std::make_unique<Bbr2StateSampler>(
+      clock_.Now(), QuicTime::Delta::FromMilliseconds(10));
+  for (int i = 0; i < 1000; ++i) {
+    clock_.AdvanceTime(QuicTime::Delta::FromMilliseconds(10));
+    Sample();
+  }
+  EXPECT_LT(sampler_->num_samples(), 1000u);
+  EXPECT_GT(sampler_->num_samples(), 0u);
+}
+
+TEST_F(Bbr2StateSamplerTest, SerializedSizeIsFixedWidth) {
+  sampler_ = std::make_unique<Bbr2StateSampler>(
+      clock_.Now(), QuicTime::Delta::FromMilliseconds(10));
+  EXPECT_EQ(0u, sampler_->SerializeToString().size());
+
+  for (int i = 0; i < 3; ++i) {
+    Sample();
+    clock_.AdvanceTime(QuicTime::Delta::FromMilliseconds(10));
+  }
+  EXPECT_EQ(3u, sampler_->num_samples());
+  EXPECT_EQ(3 * kBbr2StateSampleSize, sampler_->SerializeToString().size());
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
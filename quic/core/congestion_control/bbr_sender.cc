@@ -278,6 +278,9 @@ void BbrSender::ApplyConnectionOptions(
   if (ContainsQuicTag(connection_options, kBSAO)) {
     sampler_.EnableOverestimateAvoidance();
   }
+  if (ContainsQuicTag(connection_options, kBSOW)) {
+    sampler_.EnableOneWayDelaySampling();
+  }
   if (ContainsQuicTag(connection_options, kBBRA)) {
     sampler_.SetStartNewAggregationEpochAfterFullRound(true);
   }
@@ -154,16 +154,17 @@ void GeneralLossAlgorithm::SpuriousLossDetected(
     QuicTime ack_receive_time,
     QuicPacketNumber packet_number,
     QuicPacketNumber previous_largest_acked) {
-  if (use_adaptive_time_threshold_ && reordering_shift_ > 0) {
+  if (use_adaptive_time_threshold_ &&
+      reordering_shift_ > min_reordering_shift_) {
     // Increase reordering fraction such that the packet would not have been
-    // declared lost.
+    // declared lost, but no further than min_reordering_shift_ allows.
     QuicTime::Delta time_needed =
         ack_receive_time -
         unacked_packets.GetTransmissionInfo(packet_number).sent_time;
     QuicTime::Delta max_rtt =
         std::max(rtt_stats.previous_srtt(), rtt_stats.latest_rtt());
     while (max_rtt + (max_rtt >> reordering_shift_) < time_needed &&
-           reordering_shift_ > 0) {
+           reordering_shift_ > min_reordering_shift_) {
       --reordering_shift_;
     }
   }
@@ -174,6 +175,10 @@ void GeneralLossAlgorithm::SpuriousLossDetected(
     // been declared lost.
     reordering_threshold_ = std::max(
         reordering_threshold_, previous_largest_acked - packet_number + 1);
+    if (max_adaptive_reordering_threshold_ > 0) {
+      reordering_threshold_ =
+          std::min(reordering_threshold_, max_adaptive_reordering_threshold_);
+    }
   }
 }
 
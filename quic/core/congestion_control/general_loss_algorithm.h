@@ -104,6 +104,28 @@ class QUIC_EXPORT_PRIVATE GeneralLossAlgorithm : public LossDetectionInterface {
 
   void enable_adaptive_time_threshold() { use_adaptive_time_threshold_ = true; }
 
+  void set_use_adaptive_time_threshold(bool value) {
+    use_adaptive_time_threshold_ = value;
+  }
+
+  QuicPacketCount max_adaptive_reordering_threshold() const {
+    return max_adaptive_reordering_threshold_;
+  }
+
+  // Caps how far adaptive tuning may raise reordering_threshold_. Zero (the
+  // default) leaves the threshold unbounded.
+  void set_max_adaptive_reordering_threshold(QuicPacketCount max_threshold) {
+    max_adaptive_reordering_threshold_ = max_threshold;
+  }
+
+  int min_reordering_shift() const { return min_reordering_shift_; }
+
+  // Floors how far adaptive tuning may lower reordering_shift_, i.e. how
+  // large a fraction of RTT the time threshold may grow to.
+  void set_min_reordering_shift(int min_reordering_shift) {
+    min_reordering_shift_ = min_reordering_shift;
+  }
+
   bool use_packet_threshold_for_runt_packets() const {
     return use_packet_threshold_for_runt_packets_;
   }
@@ -125,6 +147,10 @@ class QUIC_EXPORT_PRIVATE GeneralLossAlgorithm : public LossDetectionInterface {
   bool use_adaptive_reordering_threshold_ = true;
   // If true, uses adaptive time threshold for time based loss detection.
   bool use_adaptive_time_threshold_ = false;
+  // Upper bound for adaptively tuned reordering_threshold_. 0 means no bound.
+  QuicPacketCount max_adaptive_reordering_threshold_ = 0;
+  // Lower bound for adaptively tuned reordering_shift_.
+  int min_reordering_shift_ = 0;
   // If true, uses packet threshold when largest acked is a runt packet.
   bool use_packet_threshold_for_runt_packets_ = true;
   // The least in flight packet. Loss detection should start from this. Please
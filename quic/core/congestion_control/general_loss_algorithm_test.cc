@@ -396,6 +396,45 @@ TEST_F(GeneralLossAlgorithmTest, IncreaseReorderingThresholdUponSpuriousLoss) {
   packets_acked.clear();
 }
 
+TEST_F(GeneralLossAlgorithmTest, AdaptiveReorderingThresholdClampedToMax) {
+  loss_algorithm_.set_use_adaptive_reordering_threshold(true);
+  loss_algorithm_.set_max_adaptive_reordering_threshold(5);
+  for (size_t i = 1; i <= 10; ++i) {
+    SendDataPacket(i);
+  }
+  // Acking 10 causes 1 to 7 to be detected lost.
+  AckedPacketVector packets_acked;
+  unacked_packets_.RemoveFromInFlight(QuicPacketNumber(10));
+  packets_acked.push_back(AckedPacket(
+      QuicPacketNumber(10), kMaxOutgoingPacketSize, QuicTime::Zero()));
+  VerifyLosses(10, packets_acked, {1, 2, 3, 4, 5, 6, 7});
+  packets_acked.clear();
+
+  // Acking 1 such that it was detected lost spuriously. Unclamped, this
+  // would raise the reordering threshold to 10; the cap keeps it at 5.
+  unacked_packets_.RemoveFromInFlight(QuicPacketNumber(1));
+  loss_algorithm_.SpuriousLossDetected(unacked_packets_, rtt_stats_,
+                                       clock_.Now(), QuicPacketNumber(1),
+                                       QuicPacketNumber(10));
+  EXPECT_EQ(5u, loss_algorithm_.reordering_threshold());
+}
+
+TEST_F(GeneralLossAlgorithmTest, SpuriousLossRespectsMinReorderingShift) {
+  loss_algorithm_.enable_adaptive_time_threshold();
+  loss_algorithm_.set_reordering_shift(kDefaultLossDelayShift);
+  loss_algorithm_.set_min_reordering_shift(kDefaultLossDelayShift);
+  SendDataPacket(1);
+  SendDataPacket(2);
+
+  // A spurious loss detected two RTTs after the packet was sent would
+  // normally lower the reordering shift to 0; the floor keeps it unchanged.
+  clock_.AdvanceTime(2 * rtt_stats_.smoothed_rtt());
+  loss_algorithm_.SpuriousLossDetected(unacked_packets_, rtt_stats_,
+                                       clock_.Now(), QuicPacketNumber(1),
+                                       QuicPacketNumber(2));
+  EXPECT_EQ(kDefaultLossDelayShift, loss_algorithm_.reordering_shift());
+}
+
 TEST_F(GeneralLossAlgorithmTest, DefaultIetfLossDetection) {
   loss_algorithm_.set_reordering_shift(kDefaultIetfLossDelayShift);
   for (size_t i = 1; i <= 6; ++i) {
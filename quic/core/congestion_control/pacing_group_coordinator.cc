@@ -0,0 +1,92 @@
+// Copyright (c) 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/congestion_control/pacing_group_coordinator.h"
+
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "quic/platform/api/quic_bug_tracker.h"
+#include "quic/platform/api/quic_logging.h"
+
+namespace quic {
+
+PacingGroupCoordinator::Membership::Membership(
+    PacingGroupCoordinator* coordinator,
+    std::string aggregate_key)
+    : coordinator_(coordinator), aggregate_key_(std::move(aggregate_key)) {
+  Group& group = coordinator_->groups_[aggregate_key_];
+  ++group.num_members;
+  group_ = &group;
+}
+
+PacingGroupCoordinator::Membership::~Membership() {
+  coordinator_->Leave(*this);
+}
+
+void PacingGroupCoordinator::Membership::OnBandwidthEstimate(
+    QuicBandwidth estimate) {
+  coordinator_->UpdateEstimate(*this, estimate);
+}
+
+QuicBandwidth PacingGroupCoordinator::Membership::rate_limit() const {
+  const Group& group = *group_;
+  if (group.num_reporting < 2 || group.aggregate_estimate.IsZero()) {
+    return QuicBandwidth::Infinite();
+  }
+  return QuicBandwidth::FromBitsPerSecond(
+      group.aggregate_estimate.ToBitsPerSecond() /
+      static_cast<int64_t>(group.num_reporting));
+}
+
+PacingGroupCoordinator::PacingGroupCoordinator() = default;
+
+PacingGroupCoordinator::~PacingGroupCoordinator() {
+  QUIC_BUG_IF(quic_pacing_group_outstanding_members, !groups_.empty())
+      << "PacingGroupCoordinator destroyed with " << groups_.size()
+      << " groups still populated";
+}
+
+std::unique_ptr<PacingGroupCoordinator::Membership>
+PacingGroupCoordinator::Join(std::string aggregate_key) {
+  return absl::WrapUnique(new Membership(this, std::move(aggregate_key)));
+}
+
+size_t PacingGroupCoordinator::GroupSize(
+    const std::string& aggregate_key) const {
+  auto it = groups_.find(aggregate_key);
+  return it == groups_.end() ? 0 : it->second.num_members;
+}
+
+QuicBandwidth PacingGroupCoordinator::AggregateBandwidthEstimate(
+    const std::string& aggregate_key) const {
+  auto it = groups_.find(aggregate_key);
+  return it == groups_.end() ? QuicBandwidth::Zero()
+                             : it->second.aggregate_estimate;
+}
+
+void PacingGroupCoordinator::Leave(Membership& membership) {
+  Group& group = *membership.group_;
+  UpdateEstimate(membership, QuicBandwidth::Zero());
+  --group.num_members;
+  if (group.num_members == 0) {
+    groups_.erase(membership.aggregate_key_);
+  }
+}
+
+void PacingGroupCoordinator::UpdateEstimate(Membership& membership,
+                                            QuicBandwidth estimate) {
+  Group& group = *membership.group_;
+  if (!membership.estimate_.IsZero()) {
+    group.aggregate_estimate = group.aggregate_estimate - membership.estimate_;
+    --group.num_reporting;
+  }
+  if (!estimate.IsZero()) {
+    group.aggregate_estimate = group.aggregate_estimate + estimate;
+    ++group.num_reporting;
+  }
+  membership.estimate_ = estimate;
+}
+
+}  // namespace quic
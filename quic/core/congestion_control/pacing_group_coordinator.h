@@ -0,0 +1,107 @@
+// Copyright (c) 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_CONGESTION_CONTROL_PACING_GROUP_COORDINATOR_H_
+#define QUICHE_QUIC_CORE_CONGESTION_CONTROL_PACING_GROUP_COORDINATOR_H_
+
+#include <memory>
+#include <string>
+
+#include "absl/container/node_hash_map.h"
+#include "quic/core/quic_bandwidth.h"
+#include "quic/platform/api/quic_export.h"
+
+namespace quic {
+
+// Coordinates pacing across connections believed to share a bottleneck, such
+// as hundreds of connections toward one eyeball network. Connections are
+// grouped by a caller-supplied aggregate key (e.g. client /24 or egress
+// interface); each group maintains an aggregate bandwidth estimate built from
+// the members' own congestion controller estimates, and apportions an equal
+// share of that aggregate to each reporting member. PacingSender consults the
+// share as an upper bound on its pacing rate, so coupled members stop
+// overshooting the shared bottleneck by each probing for the full capacity.
+//
+// The sum of the members' delivery-rate estimates approximates the bottleneck
+// capacity once the members collectively saturate it, which makes the equal
+// split self-correcting: a member pushed below its fair share contributes a
+// lower estimate, but the shares of the others shrink with the aggregate
+// rather than growing at its expense.
+//
+// The coordinator must outlive every Membership it hands out. It is not
+// thread safe; all members must be served from the same thread, as is the
+// case for connections sharing a dispatcher.
+class QUIC_EXPORT_PRIVATE PacingGroupCoordinator {
+ private:
+  // Shared state of one aggregate group.
+  struct QUIC_EXPORT_PRIVATE Group {
+    size_t num_members = 0;
+    // Members whose last reported estimate is nonzero.
+    size_t num_reporting = 0;
+    // Sum of the reporting members' latest estimates.
+    QuicBandwidth aggregate_estimate = QuicBandwidth::Zero();
+  };
+
+ public:
+  // One connection's membership in an aggregate group. Obtained from Join();
+  // leaves the group on destruction.
+  class QUIC_EXPORT_PRIVATE Membership {
+   public:
+    Membership(const Membership&) = delete;
+    Membership& operator=(const Membership&) = delete;
+    ~Membership();
+
+    // Updates the group's aggregate model with this member's latest bandwidth
+    // estimate, replacing the member's previous contribution.
+    void OnBandwidthEstimate(QuicBandwidth estimate);
+
+    // This member's share of the aggregate: the aggregate bandwidth estimate
+    // divided equally among the members that have reported an estimate.
+    // Infinite while fewer than two members are reporting, so coupling never
+    // throttles a connection that has the bottleneck to itself.
+    QuicBandwidth rate_limit() const;
+
+   private:
+    friend class PacingGroupCoordinator;
+
+    Membership(PacingGroupCoordinator* coordinator, std::string aggregate_key);
+
+    PacingGroupCoordinator* coordinator_;
+    const std::string aggregate_key_;
+    // Points into coordinator_->groups_; node_hash_map keeps it stable.
+    Group* group_;
+    // This member's last reported estimate, so updates can replace it in the
+    // group's running sum.
+    QuicBandwidth estimate_ = QuicBandwidth::Zero();
+  };
+
+  PacingGroupCoordinator();
+  PacingGroupCoordinator(const PacingGroupCoordinator&) = delete;
+  PacingGroupCoordinator& operator=(const PacingGroupCoordinator&) = delete;
+  ~PacingGroupCoordinator();
+
+  // Joins the group identified by |aggregate_key|, creating it if needed.
+  // The returned membership must not outlive the coordinator.
+  std::unique_ptr<Membership> Join(std::string aggregate_key);
+
+  size_t num_groups() const { return groups_.size(); }
+
+  // The number of members in |aggregate_key|'s group; 0 if there is none.
+  size_t GroupSize(const std::string& aggregate_key) const;
+
+  // The group's current aggregate bandwidth estimate: the sum of the latest
+  // estimates of its reporting members. Zero if no member has reported.
+  QuicBandwidth AggregateBandwidthEstimate(
+      const std::string& aggregate_key) const;
+
+ private:
+  void Leave(Membership& membership);
+  void UpdateEstimate(Membership& membership, QuicBandwidth estimate);
+
+  absl::node_hash_map<std::string, Group> groups_;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_CONGESTION_CONTROL_PACING_GROUP_COORDINATOR_H_
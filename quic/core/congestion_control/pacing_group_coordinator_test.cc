@@ -0,0 +1,130 @@
+// Copyright (c) 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/congestion_control/pacing_group_coordinator.h"
+
+#include <memory>
+
+#include "quic/platform/api/quic_test.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+const char kKey[] = "203.0.113.0/24";
+const char kOtherKey[] = "198.51.100.0/24";
+
+class PacingGroupCoordinatorTest : public QuicTest {
+ protected:
+  PacingGroupCoordinator coordinator_;
+};
+
+TEST_F(PacingGroupCoordinatorTest, JoinAndLeave) {
+  EXPECT_EQ(0u, coordinator_.num_groups());
+  EXPECT_EQ(0u, coordinator_.GroupSize(kKey));
+
+  std::unique_ptr<PacingGroupCoordinator::Membership> first =
+      coordinator_.Join(kKey);
+  std::unique_ptr<PacingGroupCoordinator::Membership> second =
+      coordinator_.Join(kKey);
+  std::unique_ptr<PacingGroupCoordinator::Membership> other =
+      coordinator_.Join(kOtherKey);
+  EXPECT_EQ(2u, coordinator_.num_groups());
+  EXPECT_EQ(2u, coordinator_.GroupSize(kKey));
+  EXPECT_EQ(1u, coordinator_.GroupSize(kOtherKey));
+
+  first = nullptr;
+  EXPECT_EQ(1u, coordinator_.GroupSize(kKey));
+  second = nullptr;
+  // The group is discarded once its last member leaves.
+  EXPECT_EQ(0u, coordinator_.GroupSize(kKey));
+  EXPECT_EQ(1u, coordinator_.num_groups());
+  other = nullptr;
+  EXPECT_EQ(0u, coordinator_.num_groups());
+}
+
+TEST_F(PacingGroupCoordinatorTest, SoloMemberIsNeverLimited) {
+  std::unique_ptr<PacingGroupCoordinator::Membership> member =
+      coordinator_.Join(kKey);
+  EXPECT_TRUE(member->rate_limit().IsInfinite());
+  member->OnBandwidthEstimate(QuicBandwidth::FromKBitsPerSecond(5000));
+  // A single reporting member still gets no limit.
+  EXPECT_TRUE(member->rate_limit().IsInfinite());
+}
+
+TEST_F(PacingGroupCoordinatorTest, EqualShareOfAggregate) {
+  std::unique_ptr<PacingGroupCoordinator::Membership> first =
+      coordinator_.Join(kKey);
+  std::unique_ptr<PacingGroupCoordinator::Membership> second =
+      coordinator_.Join(kKey);
+  // Nobody has reported yet.
+  EXPECT_TRUE(first->rate_limit().IsInfinite());
+
+  first->OnBandwidthEstimate(QuicBandwidth::FromKBitsPerSecond(6000));
+  // Only one of the two members is reporting, so no limit applies yet.
+  EXPECT_TRUE(first->rate_limit().IsInfinite());
+
+  second->OnBandwidthEstimate(QuicBandwidth::FromKBitsPerSecond(2000));
+  EXPECT_EQ(QuicBandwidth::FromKBitsPerSecond(8000),
+            coordinator_.AggregateBandwidthEstimate(kKey));
+  EXPECT_EQ(QuicBandwidth::FromKBitsPerSecond(4000), first->rate_limit());
+  EXPECT_EQ(QuicBandwidth::FromKBitsPerSecond(4000), second->rate_limit());
+}
+
+TEST_F(PacingGroupCoordinatorTest, NewEstimateReplacesPrevious) {
+  std::unique_ptr<PacingGroupCoordinator::Membership> first =
+      coordinator_.Join(kKey);
+  std::unique_ptr<PacingGroupCoordinator::Membership> second =
+      coordinator_.Join(kKey);
+  first->OnBandwidthEstimate(QuicBandwidth::FromKBitsPerSecond(6000));
+  second->OnBandwidthEstimate(QuicBandwidth::FromKBitsPerSecond(2000));
+
+  first->OnBandwidthEstimate(QuicBandwidth::FromKBitsPerSecond(4000));
+  EXPECT_EQ(QuicBandwidth::FromKBitsPerSecond(6000),
+            coordinator_.AggregateBandwidthEstimate(kKey));
+  EXPECT_EQ(QuicBandwidth::FromKBitsPerSecond(3000), first->rate_limit());
+}
+
+TEST_F(PacingGroupCoordinatorTest, LeavingMemberEstimateRemoved) {
+  std::unique_ptr<PacingGroupCoordinator::Membership> first =
+      coordinator_.Join(kKey);
+  std::unique_ptr<PacingGroupCoordinator::Membership> second =
+      coordinator_.Join(kKey);
+  std::unique_ptr<PacingGroupCoordinator::Membership> third =
+      coordinator_.Join(kKey);
+  first->OnBandwidthEstimate(QuicBandwidth::FromKBitsPerSecond(3000));
+  second->OnBandwidthEstimate(QuicBandwidth::FromKBitsPerSecond(3000));
+  third->OnBandwidthEstimate(QuicBandwidth::FromKBitsPerSecond(3000));
+  EXPECT_EQ(QuicBandwidth::FromKBitsPerSecond(3000), first->rate_limit());
+
+  third = nullptr;
+  EXPECT_EQ(QuicBandwidth::FromKBitsPerSecond(6000),
+            coordinator_.AggregateBandwidthEstimate(kKey));
+  EXPECT_EQ(QuicBandwidth::FromKBitsPerSecond(3000), first->rate_limit());
+
+  second = nullptr;
+  // Back down to a single member; no limit applies.
+  EXPECT_TRUE(first->rate_limit().IsInfinite());
+}
+
+TEST_F(PacingGroupCoordinatorTest, GroupsAreIndependent) {
+  std::unique_ptr<PacingGroupCoordinator::Membership> first =
+      coordinator_.Join(kKey);
+  std::unique_ptr<PacingGroupCoordinator::Membership> second =
+      coordinator_.Join(kKey);
+  std::unique_ptr<PacingGroupCoordinator::Membership> other =
+      coordinator_.Join(kOtherKey);
+  first->OnBandwidthEstimate(QuicBandwidth::FromKBitsPerSecond(1000));
+  second->OnBandwidthEstimate(QuicBandwidth::FromKBitsPerSecond(1000));
+  other->OnBandwidthEstimate(QuicBandwidth::FromKBitsPerSecond(9000));
+
+  EXPECT_EQ(QuicBandwidth::FromKBitsPerSecond(2000),
+            coordinator_.AggregateBandwidthEstimate(kKey));
+  EXPECT_EQ(QuicBandwidth::FromKBitsPerSecond(1000), first->rate_limit());
+  EXPECT_TRUE(other->rate_limit().IsInfinite());
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
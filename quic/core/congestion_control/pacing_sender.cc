@@ -26,6 +26,8 @@ PacingSender::PacingSender()
       initial_burst_size_(kInitialUnpacedBurst),
       lumpy_tokens_(0),
       alarm_granularity_(kAlarmGranularity),
+      deadline_hint_(QuicTime::Zero()),
+      coupled_membership_(nullptr),
       pacing_limited_(false) {
   if (GetQuicReloadableFlag(quic_donot_reset_ideal_next_packet_send_time)) {
     QUIC_RELOADABLE_FLAG_COUNT(quic_donot_reset_ideal_next_packet_send_time);
@@ -51,6 +53,10 @@ void PacingSender::OnCongestionEvent(bool rtt_updated,
   }
   sender_->OnCongestionEvent(rtt_updated, bytes_in_flight, event_time,
                              acked_packets, lost_packets);
+  if (coupled_membership_ != nullptr) {
+    // Feed the freshly updated estimate into the group's aggregate model.
+    coupled_membership_->OnBandwidthEstimate(sender_->BandwidthEstimate());
+  }
 }
 
 void PacingSender::OnPacketSent(
@@ -154,6 +160,15 @@ QuicTime::Delta PacingSender::TimeUntilSend(
 
   // If the next send time is within the alarm granularity, send immediately.
   if (ideal_next_packet_send_time_ > now + alarm_granularity_) {
+    if (deadline_hint_.IsInitialized() && now <= deadline_hint_ &&
+        ideal_next_packet_send_time_ > deadline_hint_) {
+      // Honoring the pacing delay would miss the delivery deadline.  Send
+      // immediately; the send consumes pacing budget as usual, so later
+      // packets are delayed longer and the aggregate rate is preserved.
+      QUIC_DVLOG(1) << "Skipping pacing delay for imminent deadline: "
+                    << deadline_hint_;
+      return QuicTime::Delta::Zero();
+    }
     QUIC_DVLOG(1) << "Delaying packet: "
                   << (ideal_next_packet_send_time_ - now).ToMicroseconds();
     return ideal_next_packet_send_time_ - now;
@@ -166,12 +181,16 @@ QuicTime::Delta PacingSender::TimeUntilSend(
 
 QuicBandwidth PacingSender::PacingRate(QuicByteCount bytes_in_flight) const {
   QUICHE_DCHECK(sender_ != nullptr);
+  QuicBandwidth rate = sender_->PacingRate(bytes_in_flight);
   if (!max_pacing_rate_.IsZero()) {
-    return QuicBandwidth::FromBitsPerSecond(
-        std::min(max_pacing_rate_.ToBitsPerSecond(),
-                 sender_->PacingRate(bytes_in_flight).ToBitsPerSecond()));
+    rate = std::min(max_pacing_rate_, rate);
+  }
+  if (coupled_membership_ != nullptr) {
+    // Cap at this connection's share of the group's shared bottleneck. The
+    // limit is infinite while fewer than two group members are reporting.
+    rate = std::min(rate, coupled_membership_->rate_limit());
   }
-  return sender_->PacingRate(bytes_in_flight);
+  return rate;
 }
 
 }  // namespace quic
@@ -15,6 +15,7 @@
 #include <map>
 #include <memory>
 
+#include "quic/core/congestion_control/pacing_group_coordinator.h"
 #include "quic/core/congestion_control/send_algorithm_interface.h"
 #include "quic/core/quic_bandwidth.h"
 #include "quic/core/quic_config.h"
@@ -48,6 +49,24 @@ class QUIC_EXPORT_PRIVATE PacingSender {
     alarm_granularity_ = alarm_granularity;
   }
 
+  // Sets the earliest delivery deadline among data waiting to be sent.  If
+  // honoring the pacing delay would push the next send past |deadline|,
+  // TimeUntilSend() returns zero instead of the delay.  The send still
+  // consumes pacing budget, so later packets are delayed longer and the
+  // aggregate rate stays at the pacing rate.  The hint expires once
+  // |deadline| has passed; pass QuicTime::Zero() to clear it.
+  void set_deadline_hint(QuicTime deadline) { deadline_hint_ = deadline; }
+
+  // Couples this sender to the pacing group |membership| belongs to. While
+  // set, the membership's rate limit caps PacingRate(), and the underlying
+  // sender's bandwidth estimate feeds the group's aggregate model on every
+  // congestion event. Does not take ownership; pass nullptr to decouple. The
+  // membership must outlive this sender or the next call with nullptr.
+  void set_coupled_membership(
+      PacingGroupCoordinator::Membership* membership) {
+    coupled_membership_ = membership;
+  }
+
   QuicBandwidth max_pacing_rate() const { return max_pacing_rate_; }
 
   void OnCongestionEvent(bool rtt_updated,
@@ -104,6 +123,14 @@ class QUIC_EXPORT_PRIVATE PacingSender {
   // quic_offload_pacing_to_usps2 flag.
   QuicTime::Delta alarm_granularity_;
 
+  // Earliest delivery deadline among data waiting to be sent, or
+  // QuicTime::Zero() if there is none.
+  QuicTime deadline_hint_;
+
+  // If not null, the pacing group membership whose rate limit caps
+  // PacingRate(). Not owned.
+  PacingGroupCoordinator::Membership* coupled_membership_;
+
   // Indicates whether pacing throttles the sending. If true, make up for lost
   // time.
   bool pacing_limited_;
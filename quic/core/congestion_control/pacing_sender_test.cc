@@ -217,6 +217,39 @@ TEST_F(PacingSenderTest, VariousSending) {
   CheckPacketIsSentImmediately();
 }
 
+TEST_F(PacingSenderTest, DeadlineHintSkipsDelay) {
+  // Configure pacing rate of 1 packet per 1 ms, no initial burst.
+  InitPacingRate(
+      0, QuicBandwidth::FromBytesAndTimeDelta(
+             kMaxOutgoingPacketSize, QuicTime::Delta::FromMilliseconds(1)));
+  UpdateRtt();
+
+  CheckPacketIsSentImmediately();
+  CheckPacketIsSentImmediately();
+  CheckPacketIsDelayed(QuicTime::Delta::FromMilliseconds(2));
+
+  // A deadline earlier than the ideal send time lets the packet through
+  // without waiting.
+  pacing_sender_->set_deadline_hint(clock_.Now() +
+                                    QuicTime::Delta::FromMilliseconds(1));
+  CheckPacketIsSentImmediately();
+
+  // Clearing the hint restores the delay, which is now larger because the
+  // early send still consumed pacing budget.
+  pacing_sender_->set_deadline_hint(QuicTime::Zero());
+  CheckPacketIsDelayed(QuicTime::Delta::FromMilliseconds(3));
+
+  // A hint whose deadline has already passed has no effect.
+  pacing_sender_->set_deadline_hint(clock_.Now() -
+                                    QuicTime::Delta::FromMilliseconds(1));
+  CheckPacketIsDelayed(QuicTime::Delta::FromMilliseconds(3));
+
+  // Neither does a deadline the paced send would meet anyway.
+  pacing_sender_->set_deadline_hint(clock_.Now() +
+                                    QuicTime::Delta::FromMilliseconds(10));
+  CheckPacketIsDelayed(QuicTime::Delta::FromMilliseconds(3));
+}
+
 TEST_F(PacingSenderTest, InitialBurst) {
   // Configure pacing rate of 1 packet per 1 ms.
   InitPacingRate(
@@ -19,6 +19,9 @@ const float kOneMinusAlpha = (1 - kAlpha);
 const float kBeta = 0.25f;
 const float kOneMinusBeta = (1 - kBeta);
 
+// Window over which the maximum queueing delay sample is retained.
+const QuicTime::Delta kQueueingDelayWindow = QuicTime::Delta::FromSeconds(10);
+
 }  // namespace
 
 RttStats::RttStats()
@@ -29,7 +32,10 @@ RttStats::RttStats()
       mean_deviation_(QuicTime::Delta::Zero()),
       calculate_standard_deviation_(false),
       initial_rtt_(QuicTime::Delta::FromMilliseconds(kInitialRttMs)),
-      last_update_time_(QuicTime::Zero()) {}
+      last_update_time_(QuicTime::Zero()),
+      max_queueing_delay_filter_(kQueueingDelayWindow,
+                                 QuicTime::Delta::Zero(),
+                                 QuicTime::Zero()) {}
 
 void RttStats::ExpireSmoothedMetrics() {
   mean_deviation_ = std::max(
@@ -77,6 +83,11 @@ void RttStats::UpdateRtt(QuicTime::Delta send_delta,
     QUIC_CODE_COUNT(quic_ack_delay_greater_than_rtt_sample);
   }
   latest_rtt_ = rtt_sample;
+  // The part of the latest RTT in excess of min_rtt approximates time spent
+  // in the bottleneck queue. The sample can be negative when the ack_delay
+  // correction pushes rtt_sample below min_rtt; treat that as no queueing.
+  max_queueing_delay_filter_.Update(
+      std::max(QuicTime::Delta::Zero(), latest_rtt_ - min_rtt_), now);
   if (calculate_standard_deviation_) {
     standard_deviation_calculator_.OnNewRttSample(rtt_sample, smoothed_rtt_);
   }
@@ -101,6 +112,7 @@ void RttStats::OnConnectionMigration() {
   smoothed_rtt_ = QuicTime::Delta::Zero();
   mean_deviation_ = QuicTime::Delta::Zero();
   initial_rtt_ = QuicTime::Delta::FromMilliseconds(kInitialRttMs);
+  max_queueing_delay_filter_.Reset(QuicTime::Delta::Zero(), QuicTime::Zero());
 }
 
 QuicTime::Delta RttStats::GetStandardOrMeanDeviation() const {
@@ -139,6 +151,7 @@ void RttStats::CloneFrom(const RttStats& stats) {
   calculate_standard_deviation_ = stats.calculate_standard_deviation_;
   initial_rtt_ = stats.initial_rtt_;
   last_update_time_ = stats.last_update_time_;
+  max_queueing_delay_filter_ = stats.max_queueing_delay_filter_;
 }
 
 }  // namespace quic
@@ -10,6 +10,7 @@
 #include <algorithm>
 #include <cstdint>
 
+#include "quic/core/congestion_control/windowed_filter.h"
 #include "quic/core/quic_packets.h"
 #include "quic/core/quic_time.h"
 #include "quic/platform/api/quic_bug_tracker.h"
@@ -95,6 +96,14 @@ class QUIC_EXPORT_PRIVATE RttStats {
 
   QuicTime::Delta mean_deviation() const { return mean_deviation_; }
 
+  // Returns the largest (latest_rtt - min_rtt) observed over the recent
+  // sample window, an estimate of queueing delay at the bottleneck.
+  // Persistently large values alongside a stable min_rtt indicate a bloated
+  // queue. May return Zero if no valid updates have occurred.
+  QuicTime::Delta max_queueing_delay() const {
+    return max_queueing_delay_filter_.GetBest();
+  }
+
   // Returns standard deviation if there is a valid one. Otherwise, returns
   // mean_deviation_.
   QuicTime::Delta GetStandardOrMeanDeviation() const;
@@ -124,6 +133,12 @@ class QUIC_EXPORT_PRIVATE RttStats {
   bool calculate_standard_deviation_;
   QuicTime::Delta initial_rtt_;
   QuicTime last_update_time_;
+  // Windowed maximum of (latest_rtt - min_rtt), a queueing delay estimate.
+  WindowedFilter<QuicTime::Delta,
+                 MaxFilter<QuicTime::Delta>,
+                 QuicTime,
+                 QuicTime::Delta>
+      max_queueing_delay_filter_;
 };
 
 }  // namespace quic
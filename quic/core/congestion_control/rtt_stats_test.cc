@@ -27,6 +27,35 @@ TEST_F(RttStatsTest, DefaultsBeforeUpdate) {
   EXPECT_LT(QuicTime::Delta::Zero(), rtt_stats_.initial_rtt());
   EXPECT_EQ(QuicTime::Delta::Zero(), rtt_stats_.min_rtt());
   EXPECT_EQ(QuicTime::Delta::Zero(), rtt_stats_.smoothed_rtt());
+  EXPECT_EQ(QuicTime::Delta::Zero(), rtt_stats_.max_queueing_delay());
+}
+
+TEST_F(RttStatsTest, MaxQueueingDelay) {
+  QuicTime now = QuicTime::Zero();
+  rtt_stats_.UpdateRtt(QuicTime::Delta::FromMilliseconds(100),
+                       QuicTime::Delta::Zero(), now);
+  // The first sample sets min_rtt, so no queueing delay is observed yet.
+  EXPECT_EQ(QuicTime::Delta::Zero(), rtt_stats_.max_queueing_delay());
+
+  now = now + QuicTime::Delta::FromMilliseconds(100);
+  rtt_stats_.UpdateRtt(QuicTime::Delta::FromMilliseconds(250),
+                       QuicTime::Delta::Zero(), now);
+  EXPECT_EQ(QuicTime::Delta::FromMilliseconds(150),
+            rtt_stats_.max_queueing_delay());
+
+  // A smaller sample does not lower the windowed maximum.
+  now = now + QuicTime::Delta::FromMilliseconds(100);
+  rtt_stats_.UpdateRtt(QuicTime::Delta::FromMilliseconds(120),
+                       QuicTime::Delta::Zero(), now);
+  EXPECT_EQ(QuicTime::Delta::FromMilliseconds(150),
+            rtt_stats_.max_queueing_delay());
+
+  // The maximum expires once its sample falls out of the window.
+  now = now + QuicTime::Delta::FromSeconds(20);
+  rtt_stats_.UpdateRtt(QuicTime::Delta::FromMilliseconds(110),
+                       QuicTime::Delta::Zero(), now);
+  EXPECT_EQ(QuicTime::Delta::FromMilliseconds(10),
+            rtt_stats_.max_queueing_delay());
 }
 
 TEST_F(RttStatsTest, SmoothedRtt) {
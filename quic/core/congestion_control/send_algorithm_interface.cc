@@ -4,7 +4,10 @@
 
 #include "quic/core/congestion_control/send_algorithm_interface.h"
 
+#include <utility>
+
 #include "absl/base/attributes.h"
+#include "absl/container/flat_hash_map.h"
 #include "quic/core/congestion_control/bbr2_sender.h"
 #include "quic/core/congestion_control/bbr_sender.h"
 #include "quic/core/congestion_control/tcp_cubic_sender_bytes.h"
@@ -12,11 +15,52 @@
 #include "quic/platform/api/quic_bug_tracker.h"
 #include "quic/platform/api/quic_flag_utils.h"
 #include "quic/platform/api/quic_flags.h"
+#include "quic/platform/api/quic_mutex.h"
 
 namespace quic {
 
 class RttStats;
 
+namespace {
+
+// Process-wide registry of factories overriding the builtin algorithms,
+// indexed by congestion control type. Registration is expected to happen at
+// startup, but a mutex guards concurrent access anyway; Create() only runs at
+// connection setup, so the lock is off the packet processing path.
+using SendAlgorithmFactoryMap =
+    absl::flat_hash_map<int, SendAlgorithmInterface::Factory>;
+
+QuicMutex* FactoryMapMutex() {
+  static QuicMutex* mutex = new QuicMutex();
+  return mutex;
+}
+
+SendAlgorithmFactoryMap* FactoryMap() {
+  static SendAlgorithmFactoryMap* map = new SendAlgorithmFactoryMap();
+  return map;
+}
+
+SendAlgorithmInterface::Factory GetRegisteredFactory(
+    CongestionControlType congestion_control_type) {
+  QuicReaderMutexLock lock(FactoryMapMutex());
+  auto it = FactoryMap()->find(congestion_control_type);
+  return it != FactoryMap()->end() ? it->second
+                                   : SendAlgorithmInterface::Factory();
+}
+
+}  // namespace
+
+// static
+void SendAlgorithmInterface::RegisterFactory(CongestionControlType type,
+                                             Factory factory) {
+  QuicWriterMutexLock lock(FactoryMapMutex());
+  if (factory == nullptr) {
+    FactoryMap()->erase(type);
+    return;
+  }
+  (*FactoryMap())[type] = std::move(factory);
+}
+
 // Factory for send side congestion control algorithm.
 SendAlgorithmInterface* SendAlgorithmInterface::Create(
     const QuicClock* clock,
@@ -29,6 +73,12 @@ SendAlgorithmInterface* SendAlgorithmInterface::Create(
     SendAlgorithmInterface* old_send_algorithm) {
   QuicPacketCount max_congestion_window =
       GetQuicFlag(FLAGS_quic_max_congestion_window);
+  Factory factory = GetRegisteredFactory(congestion_control_type);
+  if (factory != nullptr) {
+    return factory(clock, rtt_stats, unacked_packets, random, stats,
+                   initial_congestion_window, max_congestion_window,
+                   old_send_algorithm);
+  }
   switch (congestion_control_type) {
     case kGoogCC:  // GoogCC is not supported by quic/core, fall back to BBR.
     case kBBR:
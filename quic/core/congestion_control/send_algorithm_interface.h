@@ -8,6 +8,7 @@
 #define QUICHE_QUIC_CORE_CONGESTION_CONTROL_SEND_ALGORITHM_INTERFACE_H_
 
 #include <algorithm>
+#include <functional>
 #include <map>
 #include <string>
 
@@ -66,6 +67,24 @@ class QUIC_EXPORT_PRIVATE SendAlgorithmInterface {
       QuicPacketCount initial_congestion_window,
       SendAlgorithmInterface* old_send_algorithm);
 
+  // Creates a send algorithm with the same arguments Create() receives, minus
+  // the congestion control type, which the factory is registered under.
+  using Factory = std::function<SendAlgorithmInterface*(
+      const QuicClock* clock, const RttStats* rtt_stats,
+      const QuicUnackedPacketMap* unacked_packets, QuicRandom* random,
+      QuicConnectionStats* stats, QuicPacketCount initial_congestion_window,
+      QuicPacketCount max_congestion_window,
+      SendAlgorithmInterface* old_send_algorithm)>;
+
+  // Registers |factory| to be used by Create() instead of the builtin
+  // implementation whenever |type| is requested, process-wide. This allows
+  // embedders to experiment with out-of-tree send algorithms while keeping
+  // the existing per-connection selection mechanisms (connection options,
+  // server config, defaults). Registering a null |factory| restores the
+  // builtin algorithm for |type|. Expected to be called at startup; it is
+  // nevertheless safe to call concurrently with Create().
+  static void RegisterFactory(CongestionControlType type, Factory factory);
+
   virtual ~SendAlgorithmInterface() {}
 
   virtual void SetFromConfig(const QuicConfig& config,
@@ -89,6 +108,12 @@ class QUIC_EXPORT_PRIVATE SendAlgorithmInterface {
                                  const AckedPacketVector& acked_packets,
                                  const LostPacketVector& lost_packets) = 0;
 
+  // Called when an ACK_ECN frame reports |newly_ce_marked_packets| packets
+  // marked Congestion Experienced by the network since the last report.
+  // Called before the OnCongestionEvent() triggered by the same ACK. The
+  // default implementation ignores ECN feedback.
+  virtual void OnEcnFeedback(QuicPacketCount /*newly_ce_marked_packets*/) {}
+
   // Inform that we sent |bytes| to the wire, and if the packet is
   // retransmittable.  |bytes_in_flight| is the number of bytes in flight before
   // the packet was sent.
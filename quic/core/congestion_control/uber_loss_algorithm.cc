@@ -11,6 +11,50 @@
 
 namespace quic {
 
+// static
+LossDetectionProfile LossDetectionProfile::Datacenter() {
+  LossDetectionProfile profile;
+  profile.id = kLDPD;
+  // Reordering windows inside a datacenter span a handful of packets at
+  // most; declare loss quickly and keep adaptive growth on a short leash.
+  profile.reordering_shift = kDefaultIetfLossDelayShift;
+  profile.min_reordering_shift = kDefaultIetfLossDelayShift;
+  profile.reordering_threshold = kDefaultPacketReorderingThreshold;
+  profile.use_adaptive_reordering_threshold = true;
+  profile.max_adaptive_reordering_threshold = 10;
+  profile.use_adaptive_time_threshold = false;
+  return profile;
+}
+
+// static
+LossDetectionProfile LossDetectionProfile::Cable() {
+  LossDetectionProfile profile;
+  profile.id = kLDPC;
+  profile.reordering_shift = kDefaultLossDelayShift;
+  profile.min_reordering_shift = 1;
+  profile.reordering_threshold = kDefaultPacketReorderingThreshold;
+  profile.use_adaptive_reordering_threshold = true;
+  profile.max_adaptive_reordering_threshold = 20;
+  profile.use_adaptive_time_threshold = true;
+  return profile;
+}
+
+// static
+LossDetectionProfile LossDetectionProfile::Satellite() {
+  LossDetectionProfile profile;
+  profile.id = kLDPS;
+  // Allow half an RTT of reordering leeway up front: with RTTs in the
+  // hundreds of milliseconds, every spurious retransmit wastes goodput for a
+  // long time.
+  profile.reordering_shift = 1;
+  profile.min_reordering_shift = 0;
+  profile.reordering_threshold = 10;
+  profile.use_adaptive_reordering_threshold = true;
+  profile.max_adaptive_reordering_threshold = 100;
+  profile.use_adaptive_time_threshold = true;
+  return profile;
+}
+
 UberLossAlgorithm::UberLossAlgorithm() {
   for (int8_t i = INITIAL_DATA; i < NUM_PACKET_NUMBER_SPACES; ++i) {
     general_loss_algorithms_[i].Initialize(static_cast<PacketNumberSpace>(i),
@@ -159,6 +203,21 @@ void UberLossAlgorithm::OnReorderingDetected() {
   }
 }
 
+void UberLossAlgorithm::ApplyProfile(const LossDetectionProfile& profile) {
+  for (int8_t i = INITIAL_DATA; i < NUM_PACKET_NUMBER_SPACES; ++i) {
+    GeneralLossAlgorithm& algorithm = general_loss_algorithms_[i];
+    algorithm.set_reordering_shift(profile.reordering_shift);
+    algorithm.set_reordering_threshold(profile.reordering_threshold);
+    algorithm.set_use_adaptive_reordering_threshold(
+        profile.use_adaptive_reordering_threshold);
+    algorithm.set_use_adaptive_time_threshold(
+        profile.use_adaptive_time_threshold);
+    algorithm.set_max_adaptive_reordering_threshold(
+        profile.max_adaptive_reordering_threshold);
+    algorithm.set_min_reordering_shift(profile.min_reordering_shift);
+  }
+}
+
 void UberLossAlgorithm::SetReorderingShift(int reordering_shift) {
   for (int8_t i = INITIAL_DATA; i < NUM_PACKET_NUMBER_SPACES; ++i) {
     general_loss_algorithms_[i].set_reordering_shift(reordering_shift);
@@ -24,6 +24,36 @@ struct QUIC_EXPORT_PRIVATE LossDetectionParameters {
   absl::optional<QuicPacketCount> reordering_threshold;
 };
 
+// A named bundle of loss detection parameters tuned for one class of network
+// paths. Profiles are applied per connection, either when the client requests
+// one by connection option at handshake (kLDPD/kLDPC/kLDPS) or by server
+// policy via QuicSentPacketManager::ApplyLossDetectionProfile. The profile ID
+// is recorded in QuicConnectionStats, so spurious retransmit rates can be
+// aggregated per profile and the presets converged empirically.
+struct QUIC_EXPORT_PRIVATE LossDetectionProfile {
+  // Recorded in QuicConnectionStats::loss_detection_profile_id. Zero means no
+  // profile was applied.
+  uint32_t id = 0;
+  // See GeneralLossAlgorithm for the meaning of these fields.
+  int reordering_shift = kDefaultLossDelayShift;
+  QuicPacketCount reordering_threshold = kDefaultPacketReorderingThreshold;
+  bool use_adaptive_reordering_threshold = true;
+  bool use_adaptive_time_threshold = false;
+  // Bounds for adaptive tuning, see GeneralLossAlgorithm. A zero
+  // max_adaptive_reordering_threshold leaves the threshold unbounded.
+  QuicPacketCount max_adaptive_reordering_threshold = 0;
+  int min_reordering_shift = 0;
+
+  // Low-RTT paths with next to no reordering: declare loss aggressively and
+  // keep adaptive tuning on a short leash.
+  static LossDetectionProfile Datacenter();
+  // Last-mile paths with moderate reordering, e.g. cable or DSL.
+  static LossDetectionProfile Cable();
+  // Long-RTT paths with heavy reordering: tolerate large reordering windows
+  // before declaring loss, since every spurious retransmit is costly.
+  static LossDetectionProfile Satellite();
+};
+
 class QUIC_EXPORT_PRIVATE LossDetectionTunerInterface {
  public:
   virtual ~LossDetectionTunerInterface() {}
@@ -77,6 +107,9 @@ class QUIC_EXPORT_PRIVATE UberLossAlgorithm : public LossDetectionInterface {
   void OnConnectionClosed() override;
   void OnReorderingDetected() override;
 
+  // Applies every parameter of |profile| to all packet number spaces.
+  void ApplyProfile(const LossDetectionProfile& profile);
+
   // Sets reordering_shift for all packet number spaces.
   void SetReorderingShift(int reordering_shift);
 
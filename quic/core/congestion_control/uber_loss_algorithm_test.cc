@@ -356,6 +356,16 @@ TEST_F(UberLossAlgorithmTest, LossDetectionTuning_StartFailed) {
             loss_algorithm_.GetPacketReorderingThreshold());
 }
 
+TEST_F(UberLossAlgorithmTest, ApplyLossDetectionProfile) {
+  const LossDetectionProfile profile = LossDetectionProfile::Satellite();
+  loss_algorithm_.ApplyProfile(profile);
+
+  EXPECT_EQ(profile.reordering_shift,
+            loss_algorithm_.GetPacketReorderingShift());
+  EXPECT_EQ(profile.reordering_threshold,
+            loss_algorithm_.GetPacketReorderingThreshold());
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace quic
@@ -211,4 +211,8 @@ absl::string_view AeadBaseDecrypter::GetNoncePrefix() const {
                            nonce_size_ - sizeof(QuicPacketNumber));
 }
 
+absl::string_view AeadBaseDecrypter::GetIV() const {
+  return absl::string_view(reinterpret_cast<const char*>(iv_), nonce_size_);
+}
+
 }  // namespace quic
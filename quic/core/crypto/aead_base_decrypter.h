@@ -34,17 +34,22 @@ class QUIC_EXPORT_PRIVATE AeadBaseDecrypter : public QuicDecrypter {
   bool SetIV(absl::string_view iv) override;
   bool SetPreliminaryKey(absl::string_view key) override;
   bool SetDiversificationNonce(const DiversificationNonce& nonce) override;
+  // DecryptPacket is final so that calls made through an AeadBaseDecrypter
+  // pointer compile to direct calls; see
+  // QuicDecrypter::AsAeadBaseDecrypter().
   bool DecryptPacket(uint64_t packet_number,
                      absl::string_view associated_data,
                      absl::string_view ciphertext,
                      char* output,
                      size_t* output_length,
-                     size_t max_output_length) override;
+                     size_t max_output_length) final;
+  AeadBaseDecrypter* AsAeadBaseDecrypter() final { return this; }
   size_t GetKeySize() const override;
   size_t GetNoncePrefixSize() const override;
   size_t GetIVSize() const override;
   absl::string_view GetKey() const override;
   absl::string_view GetNoncePrefix() const override;
+  absl::string_view GetIV() const override;
 
  protected:
   // Make these constants available to the subclasses so that the subclasses
@@ -185,4 +185,8 @@ absl::string_view AeadBaseEncrypter::GetNoncePrefix() const {
                            GetNoncePrefixSize());
 }
 
+absl::string_view AeadBaseEncrypter::GetIV() const {
+  return absl::string_view(reinterpret_cast<const char*>(iv_), nonce_size_);
+}
+
 }  // namespace quic
@@ -32,19 +32,24 @@ class QUIC_EXPORT_PRIVATE AeadBaseEncrypter : public QuicEncrypter {
   bool SetKey(absl::string_view key) override;
   bool SetNoncePrefix(absl::string_view nonce_prefix) override;
   bool SetIV(absl::string_view iv) override;
+  // EncryptPacket and the size accessors it uses are final so that calls
+  // made through an AeadBaseEncrypter pointer compile to direct calls; see
+  // QuicEncrypter::AsAeadBaseEncrypter().
   bool EncryptPacket(uint64_t packet_number,
                      absl::string_view associated_data,
                      absl::string_view plaintext,
                      char* output,
                      size_t* output_length,
-                     size_t max_output_length) override;
+                     size_t max_output_length) final;
   size_t GetKeySize() const override;
   size_t GetNoncePrefixSize() const override;
   size_t GetIVSize() const override;
-  size_t GetMaxPlaintextSize(size_t ciphertext_size) const override;
-  size_t GetCiphertextSize(size_t plaintext_size) const override;
+  size_t GetMaxPlaintextSize(size_t ciphertext_size) const final;
+  size_t GetCiphertextSize(size_t plaintext_size) const final;
+  AeadBaseEncrypter* AsAeadBaseEncrypter() final { return this; }
   absl::string_view GetKey() const override;
   absl::string_view GetNoncePrefix() const override;
+  absl::string_view GetIV() const override;
 
   // Necessary so unit tests can explicitly specify a nonce, instead of an IV
   // (or nonce prefix) and packet number.
@@ -0,0 +1,103 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "common/platform/api/quiche_benchmark.h"
+#include "quic/core/crypto/aes_128_gcm_decrypter.h"
+#include "quic/core/crypto/aes_128_gcm_encrypter.h"
+#include "quic/core/quic_packets.h"
+
+namespace quic {
+namespace {
+
+const char kKey[] = "0123456789abcdef";       // 16 bytes.
+const char kIV[] = "0123456789ab";            // 12 bytes.
+const char kAssociatedData[] = "associated data";
+
+// Encrypts packets of |plaintext_size| bytes for the duration of the
+// benchmark and reports throughput over the plaintext.
+void EncryptPackets(quiche::QuicheBenchmarkState& state,
+                    size_t plaintext_size) {
+  Aes128GcmEncrypter encrypter;
+  encrypter.SetKey(absl::string_view(kKey, 16));
+  encrypter.SetIV(absl::string_view(kIV, 12));
+
+  const std::string plaintext(plaintext_size, 'q');
+  char ciphertext[kMaxOutgoingPacketSize];
+  uint64_t packet_number = 1;
+  size_t ciphertext_length = 0;
+  while (state.KeepRunning()) {
+    encrypter.EncryptPacket(packet_number++, kAssociatedData, plaintext,
+                            ciphertext, &ciphertext_length,
+                            sizeof(ciphertext));
+  }
+  state.SetBytesProcessed(state.iterations() * plaintext_size);
+}
+
+// Decrypts packets of |plaintext_size| bytes of payload.
+void DecryptPackets(quiche::QuicheBenchmarkState& state,
+                    size_t plaintext_size) {
+  Aes128GcmEncrypter encrypter;
+  encrypter.SetKey(absl::string_view(kKey, 16));
+  encrypter.SetIV(absl::string_view(kIV, 12));
+  Aes128GcmDecrypter decrypter;
+  decrypter.SetKey(absl::string_view(kKey, 16));
+  decrypter.SetIV(absl::string_view(kIV, 12));
+
+  const uint64_t packet_number = 1;
+  const std::string plaintext(plaintext_size, 'q');
+  char ciphertext[kMaxOutgoingPacketSize];
+  size_t ciphertext_length = 0;
+  encrypter.EncryptPacket(packet_number, kAssociatedData, plaintext,
+                          ciphertext, &ciphertext_length, sizeof(ciphertext));
+
+  char decrypted[kMaxOutgoingPacketSize];
+  size_t decrypted_length = 0;
+  while (state.KeepRunning()) {
+    decrypter.DecryptPacket(
+        packet_number, kAssociatedData,
+        absl::string_view(ciphertext, ciphertext_length), decrypted,
+        &decrypted_length, sizeof(decrypted));
+  }
+  state.SetBytesProcessed(state.iterations() * plaintext_size);
+}
+
+void BM_Aes128GcmEncrypt64(quiche::QuicheBenchmarkState& state) {
+  EncryptPackets(state, 64);
+}
+QUICHE_BENCHMARK(BM_Aes128GcmEncrypt64);
+
+void BM_Aes128GcmEncrypt600(quiche::QuicheBenchmarkState& state) {
+  EncryptPackets(state, 600);
+}
+QUICHE_BENCHMARK(BM_Aes128GcmEncrypt600);
+
+void BM_Aes128GcmEncrypt1350(quiche::QuicheBenchmarkState& state) {
+  EncryptPackets(state, 1350);
+}
+QUICHE_BENCHMARK(BM_Aes128GcmEncrypt1350);
+
+void BM_Aes128GcmDecrypt64(quiche::QuicheBenchmarkState& state) {
+  DecryptPackets(state, 64);
+}
+QUICHE_BENCHMARK(BM_Aes128GcmDecrypt64);
+
+void BM_Aes128GcmDecrypt600(quiche::QuicheBenchmarkState& state) {
+  DecryptPackets(state, 600);
+}
+QUICHE_BENCHMARK(BM_Aes128GcmDecrypt600);
+
+void BM_Aes128GcmDecrypt1350(quiche::QuicheBenchmarkState& state) {
+  DecryptPackets(state, 1350);
+}
+QUICHE_BENCHMARK(BM_Aes128GcmDecrypt1350);
+
+}  // namespace
+}  // namespace quic
+
+QUICHE_BENCHMARK_MAIN();
@@ -6,9 +6,11 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "absl/base/macros.h"
 #include "absl/strings/escaping.h"
+#include "absl/strings/string_view.h"
 #include "quic/core/quic_utils.h"
 #include "quic/platform/api/quic_test.h"
 #include "quic/test_tools/quic_test_utils.h"
@@ -287,5 +289,28 @@ TEST_F(Aes128GcmDecrypterTest, GenerateHeaderProtectionMask) {
       expected_mask.size());
 }
 
+TEST_F(Aes128GcmDecrypterTest, GenerateHeaderProtectionMasks) {
+  Aes128GcmDecrypter decrypter;
+  std::string key = absl::HexStringToBytes("d9132370cb18476ab833649cf080d970");
+  ASSERT_TRUE(decrypter.SetHeaderProtectionKey(key));
+  std::string sample1 =
+      absl::HexStringToBytes("d1d7998068517adb769b48b924a32c47");
+  std::string sample2 =
+      absl::HexStringToBytes("2cf2e0b9a2afd90a46e1259929a1d0dc");
+  // Too short to be sampled; must yield an empty mask, not shift the batch.
+  std::string short_sample = absl::HexStringToBytes("d1d7");
+  const absl::string_view samples[] = {sample1, short_sample, sample2};
+
+  std::vector<std::string> masks =
+      decrypter.GenerateHeaderProtectionMasks(samples);
+  ASSERT_EQ(3u, masks.size());
+  EXPECT_TRUE(masks[1].empty());
+  // Each batched mask must match the single-sample method.
+  QuicDataReader sample1_reader(sample1.data(), sample1.size());
+  EXPECT_EQ(decrypter.GenerateHeaderProtectionMask(&sample1_reader), masks[0]);
+  QuicDataReader sample2_reader(sample2.data(), sample2.size());
+  EXPECT_EQ(decrypter.GenerateHeaderProtectionMask(&sample2_reader), masks[2]);
+}
+
 }  // namespace test
 }  // namespace quic
@@ -4,6 +4,10 @@
 
 #include "quic/core/crypto/aes_base_decrypter.h"
 
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "absl/strings/string_view.h"
 #include "third_party/boringssl/src/include/openssl/aes.h"
 #include "quic/platform/api/quic_bug_tracker.h"
@@ -36,6 +40,24 @@ std::string AesBaseDecrypter::GenerateHeaderProtectionMask(
   return out;
 }
 
+std::vector<std::string> AesBaseDecrypter::GenerateHeaderProtectionMasks(
+    absl::Span<const absl::string_view> samples) {
+  std::vector<std::string> masks;
+  masks.reserve(samples.size());
+  for (const absl::string_view sample : samples) {
+    if (sample.size() < AES_BLOCK_SIZE) {
+      masks.emplace_back();
+      continue;
+    }
+    std::string out(AES_BLOCK_SIZE, 0);
+    AES_encrypt(reinterpret_cast<const uint8_t*>(sample.data()),
+                reinterpret_cast<uint8_t*>(const_cast<char*>(out.data())),
+                &pne_key_);
+    masks.push_back(std::move(out));
+  }
+  return masks;
+}
+
 QuicPacketCount AesBaseDecrypter::GetIntegrityLimit() const {
   // For AEAD_AES_128_GCM ... endpoints that do not attempt to remove
   // protection from packets larger than 2^11 bytes can attempt to remove
@@ -6,8 +6,11 @@
 #define QUICHE_QUIC_CORE_CRYPTO_AES_BASE_DECRYPTER_H_
 
 #include <cstddef>
+#include <string>
+#include <vector>
 
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "third_party/boringssl/src/include/openssl/aes.h"
 #include "quic/core/crypto/aead_base_decrypter.h"
 #include "quic/platform/api/quic_export.h"
@@ -21,6 +24,10 @@ class QUIC_EXPORT_PRIVATE AesBaseDecrypter : public AeadBaseDecrypter {
   bool SetHeaderProtectionKey(absl::string_view key) override;
   std::string GenerateHeaderProtectionMask(
       QuicDataReader* sample_reader) override;
+  // Encrypts all of the single-block samples back to back against the same
+  // expanded key, so a batch of packets pays the per-call setup once.
+  std::vector<std::string> GenerateHeaderProtectionMasks(
+      absl::Span<const absl::string_view> samples) override;
   QuicPacketCount GetIntegrityLimit() const override;
 
  private:
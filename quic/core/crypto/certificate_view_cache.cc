@@ -0,0 +1,65 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/crypto/certificate_view_cache.h"
+
+#include <memory>
+#include <utility>
+
+#include "quic/core/quic_utils.h"
+#include "quic/platform/api/quic_flag_utils.h"
+#include "quic/platform/api/quic_flags.h"
+
+namespace quic {
+
+// static
+const size_t CertificateViewCache::kDefaultCertificateViewCacheSize = 128;
+
+CertificateViewCache::CertificateViewCache(size_t capacity)
+    : certificate_cache_(capacity) {}
+
+CertificateViewCache::~CertificateViewCache() = default;
+
+std::shared_ptr<const CachedCertificateView> CertificateViewCache::GetOrParse(
+    absl::string_view certificate) {
+  const uint64_t key = QuicUtils::FNV1a_64_Hash(certificate);
+  auto iter = certificate_cache_.Lookup(key);
+  if (iter != certificate_cache_.end() &&
+      (*iter->second)->der() == certificate) {
+    QUIC_CODE_COUNT(quic_certificate_view_cache_hit);
+    return *iter->second;
+  }
+
+  QUIC_CODE_COUNT(quic_certificate_view_cache_miss);
+  // The entry owns its copy of the DER bytes; parse the copy so the view
+  // points into memory with the same lifetime as the view itself.
+  auto entry = std::shared_ptr<CachedCertificateView>(
+      new CachedCertificateView(certificate));
+  entry->view_ = CertificateView::ParseSingleCertificate(entry->der_);
+  if (entry->view_ == nullptr) {
+    return nullptr;
+  }
+  std::shared_ptr<const CachedCertificateView> shared_entry = std::move(entry);
+  certificate_cache_.Insert(
+      key, std::make_unique<std::shared_ptr<const CachedCertificateView>>(
+               shared_entry));
+  return shared_entry;
+}
+
+std::vector<std::shared_ptr<const CachedCertificateView>>
+CertificateViewCache::GetOrParseChain(const std::vector<std::string>& chain) {
+  std::vector<std::shared_ptr<const CachedCertificateView>> views;
+  views.reserve(chain.size());
+  for (const std::string& certificate : chain) {
+    std::shared_ptr<const CachedCertificateView> view =
+        GetOrParse(certificate);
+    if (view == nullptr) {
+      return {};
+    }
+    views.push_back(std::move(view));
+  }
+  return views;
+}
+
+}  // namespace quic
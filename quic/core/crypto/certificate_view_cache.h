@@ -0,0 +1,83 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_CRYPTO_CERTIFICATE_VIEW_CACHE_H_
+#define QUICHE_QUIC_CORE_CRYPTO_CERTIFICATE_VIEW_CACHE_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "quic/core/crypto/certificate_view.h"
+#include "quic/core/quic_lru_cache.h"
+#include "quic/platform/api/quic_export.h"
+
+namespace quic {
+
+// An immutable parsed certificate together with the DER bytes it points into.
+// CertificateView does not own the underlying certificate, so a cached entry
+// has to carry its own copy of the DER encoding; the view is valid for the
+// lifetime of this object. Handed out as std::shared_ptr<const ...> so
+// callers can hold on to a parse result across cache evictions.
+class QUIC_EXPORT_PRIVATE CachedCertificateView {
+ public:
+  CachedCertificateView(const CachedCertificateView&) = delete;
+  CachedCertificateView& operator=(const CachedCertificateView&) = delete;
+
+  const CertificateView& view() const { return *view_; }
+  absl::string_view der() const { return der_; }
+
+ private:
+  friend class CertificateViewCache;
+
+  explicit CachedCertificateView(absl::string_view der) : der_(der) {}
+
+  const std::string der_;
+  std::unique_ptr<CertificateView> view_;
+};
+
+// CertificateViewCache avoids re-parsing X.509 certificates that are seen
+// repeatedly, e.g. when a client opens many connections to servers sharing a
+// certificate chain. Entries are keyed by a hash of the DER bytes and
+// evicted in LRU order; lookups verify the full DER encoding, so a hash
+// collision causes a re-parse rather than a wrong certificate.
+//
+// Like QuicCompressedCertsCache, the cache itself must not be shared between
+// threads. The returned views are immutable and remain valid for as long as
+// the caller holds the shared pointer, even after eviction.
+class QUIC_EXPORT_PRIVATE CertificateViewCache {
+ public:
+  // Default capacity; certificate chains rarely contain more than a handful
+  // of distinct certificates per origin.
+  static const size_t kDefaultCertificateViewCacheSize;
+
+  explicit CertificateViewCache(size_t capacity);
+  CertificateViewCache(const CertificateViewCache&) = delete;
+  CertificateViewCache& operator=(const CertificateViewCache&) = delete;
+  ~CertificateViewCache();
+
+  // Returns a shared parsed form of the DER-encoded |certificate|, parsing
+  // and caching it on a miss. Returns nullptr if the certificate does not
+  // parse; parse failures are not cached.
+  std::shared_ptr<const CachedCertificateView> GetOrParse(
+      absl::string_view certificate);
+
+  // Parses every certificate of a chain, leaf first. Returns an empty vector
+  // if any certificate in the chain fails to parse.
+  std::vector<std::shared_ptr<const CachedCertificateView>> GetOrParseChain(
+      const std::vector<std::string>& chain);
+
+  size_t Size() const { return certificate_cache_.Size(); }
+  size_t MaxSize() const { return certificate_cache_.MaxSize(); }
+
+ private:
+  // Key is a hash of the DER bytes; the value re-checks the full encoding.
+  QuicLRUCache<uint64_t, std::shared_ptr<const CachedCertificateView>>
+      certificate_cache_;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_CRYPTO_CERTIFICATE_VIEW_CACHE_H_
@@ -0,0 +1,86 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/crypto/certificate_view_cache.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "quic/platform/api/quic_test.h"
+#include "quic/test_tools/test_certificates.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+TEST(CertificateViewCacheTest, ParseAndCache) {
+  CertificateViewCache cache(
+      CertificateViewCache::kDefaultCertificateViewCacheSize);
+  std::shared_ptr<const CachedCertificateView> first =
+      cache.GetOrParse(kTestCertificate);
+  ASSERT_TRUE(first != nullptr);
+  EXPECT_EQ(first->der(), kTestCertificate);
+  EXPECT_FALSE(first->view().subject_alt_name_domains().empty());
+  EXPECT_EQ(1u, cache.Size());
+
+  // The second lookup returns the same shared entry without re-parsing.
+  std::shared_ptr<const CachedCertificateView> second =
+      cache.GetOrParse(kTestCertificate);
+  EXPECT_EQ(first.get(), second.get());
+  EXPECT_EQ(1u, cache.Size());
+}
+
+TEST(CertificateViewCacheTest, ParseFailureIsNotCached) {
+  CertificateViewCache cache(
+      CertificateViewCache::kDefaultCertificateViewCacheSize);
+  EXPECT_EQ(nullptr, cache.GetOrParse("clearly not a certificate"));
+  EXPECT_EQ(0u, cache.Size());
+}
+
+TEST(CertificateViewCacheTest, EvictedEntryRemainsValid) {
+  CertificateViewCache cache(/*capacity=*/1);
+  std::shared_ptr<const CachedCertificateView> first =
+      cache.GetOrParse(kTestCertificate);
+  ASSERT_TRUE(first != nullptr);
+
+  // Inserting a second certificate evicts the first, but the shared view
+  // held by the caller is unaffected.
+  std::shared_ptr<const CachedCertificateView> second =
+      cache.GetOrParse(kWildcardCertificate);
+  ASSERT_TRUE(second != nullptr);
+  EXPECT_EQ(1u, cache.Size());
+  EXPECT_EQ(first->der(), kTestCertificate);
+  EXPECT_FALSE(first->view().subject_alt_name_domains().empty());
+
+  // The first certificate is re-parsed into a new entry on the next lookup.
+  std::shared_ptr<const CachedCertificateView> reparsed =
+      cache.GetOrParse(kTestCertificate);
+  ASSERT_TRUE(reparsed != nullptr);
+  EXPECT_NE(first.get(), reparsed.get());
+}
+
+TEST(CertificateViewCacheTest, ParseChain) {
+  CertificateViewCache cache(
+      CertificateViewCache::kDefaultCertificateViewCacheSize);
+  const std::vector<std::string> chain = {std::string(kTestCertificate),
+                                          std::string(kWildcardCertificate)};
+  auto views = cache.GetOrParseChain(chain);
+  ASSERT_EQ(2u, views.size());
+  EXPECT_EQ(views[0]->der(), kTestCertificate);
+  EXPECT_EQ(views[1]->der(), kWildcardCertificate);
+  EXPECT_EQ(2u, cache.Size());
+
+  // A chain with a malformed certificate fails as a whole; the valid
+  // certificates stay cached.
+  const std::vector<std::string> bad_chain = {std::string(kTestCertificate),
+                                              "malformed"};
+  EXPECT_TRUE(cache.GetOrParseChain(bad_chain).empty());
+  EXPECT_EQ(2u, cache.Size());
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
@@ -6,6 +6,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "absl/strings/escaping.h"
 #include "absl/strings/string_view.h"
@@ -184,5 +185,23 @@ TEST_F(ChaCha20Poly1305TlsDecrypterTest, GenerateHeaderProtectionMask) {
       expected_mask.size());
 }
 
+TEST_F(ChaCha20Poly1305TlsDecrypterTest, GenerateHeaderProtectionMasks) {
+  // ChaCha has no batched override, so this exercises the base class loop.
+  ChaCha20Poly1305TlsDecrypter decrypter;
+  std::string key = absl::HexStringToBytes(
+      "6a067f432787bd6034dd3f08f07fc9703a27e58c70e2d88d948b7f6489923cc7");
+  ASSERT_TRUE(decrypter.SetHeaderProtectionKey(key));
+  std::string sample =
+      absl::HexStringToBytes("1210d91cceb45c716b023f492c29e612");
+  std::string short_sample = absl::HexStringToBytes("1210");
+  const absl::string_view samples[] = {sample, short_sample};
+
+  std::vector<std::string> masks =
+      decrypter.GenerateHeaderProtectionMasks(samples);
+  ASSERT_EQ(2u, masks.size());
+  EXPECT_EQ(absl::HexStringToBytes("1cc2cd98dc"), masks[0]);
+  EXPECT_TRUE(masks[1].empty());
+}
+
 }  // namespace test
 }  // namespace quic
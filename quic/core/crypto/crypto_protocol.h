@@ -156,8 +156,16 @@ const QuicTag kB2RC = TAG('B', '2', 'R', 'C');   // Disable Reno-coexistence for
 const QuicTag kBSAO = TAG('B', 'S', 'A', 'O');   // Avoid Overestimation in
                                                  // Bandwidth Sampler with ack
                                                  // aggregation
+const QuicTag kBSOW = TAG('B', 'S', 'O', 'W');   // Compute delivery rate from
+                                                 // peer-reported receive
+                                                 // timestamps in Bandwidth
+                                                 // Sampler
 const QuicTag kB2DL = TAG('B', '2', 'D', 'L');   // Increase inflight_hi based
                                                  // on delievered, not inflight.
+const QuicTag kB2EC = TAG('B', '2', 'E', 'C');   // React to peer-reported
+                                                 // ECN-CE marks with a
+                                                 // DCTCP-style inflight_hi
+                                                 // reduction in BBR2.
 const QuicTag kB201 = TAG('B', '2', '0', '1');   // In PROBE_UP, check if cwnd
                                                  // limited before aggregation
                                                  // epoch, instead of ack event.
@@ -234,6 +242,12 @@ const QuicTag kILD4 = TAG('I', 'L', 'D', '4');   // IETF style loss detection
                                                  // threshold
 const QuicTag kRUNT = TAG('R', 'U', 'N', 'T');   // No packet threshold loss
                                                  // detection for "runt" packet.
+const QuicTag kLDPD = TAG('L', 'D', 'P', 'D');   // Datacenter loss detection
+                                                 // profile
+const QuicTag kLDPC = TAG('L', 'D', 'P', 'C');   // Cable loss detection
+                                                 // profile
+const QuicTag kLDPS = TAG('L', 'D', 'P', 'S');   // Satellite loss detection
+                                                 // profile
 const QuicTag kNSTP = TAG('N', 'S', 'T', 'P');   // No stop waiting frames.
 const QuicTag kNRTT = TAG('N', 'R', 'T', 'T');   // Ignore initial RTT
 
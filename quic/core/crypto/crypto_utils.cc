@@ -30,11 +30,13 @@
 #include "quic/core/quic_connection_id.h"
 #include "quic/core/quic_constants.h"
 #include "quic/core/quic_data_writer.h"
+#include "quic/core/quic_lru_cache.h"
 #include "quic/core/quic_time.h"
 #include "quic/core/quic_utils.h"
 #include "quic/core/quic_versions.h"
 #include "quic/platform/api/quic_bug_tracker.h"
 #include "quic/platform/api/quic_logging.h"
+#include "quic/platform/api/quic_mutex.h"
 #include "common/quiche_endian.h"
 
 namespace quic {
@@ -154,8 +156,9 @@ const uint8_t kReservedForNegotiationSalt[] = {
 
 const uint8_t* InitialSaltForVersion(const ParsedQuicVersion& version,
                                      size_t* out_len) {
-  static_assert(SupportedVersions().size() == 5u,
-                "Supported versions out of sync with initial encryption salts");
+  static_assert(
+      SupportedVersions().size() == (GQuicVersionsCompiledIn() ? 5u : 2u),
+      "Supported versions out of sync with initial encryption salts");
   if (version == ParsedQuicVersion::RFCv1()) {
     *out_len = ABSL_ARRAYSIZE(kRFCv1InitialSalt);
     return kRFCv1InitialSalt;
@@ -204,8 +207,9 @@ const uint8_t kReservedForNegotiationRetryIntegrityNonce[] = {
 bool RetryIntegrityKeysForVersion(const ParsedQuicVersion& version,
                                   absl::string_view* key,
                                   absl::string_view* nonce) {
-  static_assert(SupportedVersions().size() == 5u,
-                "Supported versions out of sync with retry integrity keys");
+  static_assert(
+      SupportedVersions().size() == (GQuicVersionsCompiledIn() ? 5u : 2u),
+      "Supported versions out of sync with retry integrity keys");
   if (!version.UsesTls()) {
     QUIC_BUG(quic_bug_10699_2)
         << "Attempted to get retry integrity keys for invalid version "
@@ -242,6 +246,128 @@ bool RetryIntegrityKeysForVersion(const ParsedQuicVersion& version,
   return false;
 }
 
+// Key, IV and header protection key for one direction of initial packet
+// protection.
+struct InitialObfuscatorKeys {
+  std::string key;
+  std::string iv;
+  std::string header_protection_key;
+};
+
+// Derives the packet protection key material for one direction of initial
+// packet protection. |label| is "client in" or "server in"; the expansion
+// labels mirror SetKeyAndIV and GenerateHeaderProtectionKey.
+InitialObfuscatorKeys DeriveInitialObfuscatorKeys(
+    const EVP_MD* hash,
+    const std::vector<uint8_t>& handshake_secret,
+    const std::string& label,
+    const QuicCrypter& crypter) {
+  std::vector<uint8_t> secret =
+      HkdfExpandLabel(hash, handshake_secret, label, EVP_MD_size(hash));
+  std::vector<uint8_t> key =
+      HkdfExpandLabel(hash, secret, "quic key", crypter.GetKeySize());
+  std::vector<uint8_t> iv =
+      HkdfExpandLabel(hash, secret, "quic iv", crypter.GetIVSize());
+  std::vector<uint8_t> header_protection_key =
+      HkdfExpandLabel(hash, secret, "quic hp", crypter.GetKeySize());
+  InitialObfuscatorKeys keys;
+  keys.key.assign(reinterpret_cast<const char*>(key.data()), key.size());
+  keys.iv.assign(reinterpret_cast<const char*>(iv.data()), iv.size());
+  keys.header_protection_key.assign(
+      reinterpret_cast<const char*>(header_protection_key.data()),
+      header_protection_key.size());
+  return keys;
+}
+
+void ApplyInitialObfuscatorKeys(const InitialObfuscatorKeys& keys,
+                                QuicCrypter* crypter) {
+  crypter->SetKey(keys.key);
+  crypter->SetIV(keys.iv);
+  crypter->SetHeaderProtectionKey(keys.header_protection_key);
+}
+
+// Fully derived initial key material for a (version, connection ID) pair. The
+// original inputs are retained to rule out returning material for a colliding
+// hash. The material is perspective-independent: both directions are stored
+// and the caller picks which one encrypts and which one decrypts.
+struct InitialObfuscatorCacheEntry {
+  QuicConnectionId connection_id;
+  ParsedQuicVersion version;
+  InitialObfuscatorKeys client_keys;
+  InitialObfuscatorKeys server_keys;
+};
+
+// A server runs the initial obfuscation HKDF tree at least twice per incoming
+// connection with identical inputs: once when the dispatcher's
+// TlsChloExtractor sets up a framer to inspect the client hello, and again
+// when the session's connection installs its initial crypters. Entries stay
+// hot for only a moment, so a small capacity suffices.
+const size_t kInitialObfuscatorCacheCapacity = 128;
+
+// Process-wide memoization of derived initial key material, shared by all
+// connections. The material is a pure function of the version and the
+// client-chosen connection ID, both of which are sent in the clear, so
+// caching it leaks nothing. Guarded by a mutex because connections may be
+// dispatched on multiple threads; material is copied out under the lock so
+// that eviction cannot free an entry a caller still uses.
+class InitialObfuscatorCache {
+ public:
+  static InitialObfuscatorCache* GetInstance() {
+    static InitialObfuscatorCache* cache = new InitialObfuscatorCache();
+    return cache;
+  }
+
+  bool Lookup(ParsedQuicVersion version,
+              QuicConnectionId connection_id,
+              InitialObfuscatorKeys* client_keys,
+              InitialObfuscatorKeys* server_keys) {
+    QuicWriterMutexLock lock(&mu_);
+    auto it = cache_.Lookup(ComputeKey(version, connection_id));
+    if (it != cache_.end() && it->second->version == version &&
+        it->second->connection_id == connection_id) {
+      *client_keys = it->second->client_keys;
+      *server_keys = it->second->server_keys;
+      return true;
+    }
+    return false;
+  }
+
+  void Insert(ParsedQuicVersion version,
+              QuicConnectionId connection_id,
+              const InitialObfuscatorKeys& client_keys,
+              const InitialObfuscatorKeys& server_keys) {
+    auto entry = std::make_unique<InitialObfuscatorCacheEntry>(
+        InitialObfuscatorCacheEntry{connection_id, version, client_keys,
+                                    server_keys});
+    QuicWriterMutexLock lock(&mu_);
+    cache_.Insert(ComputeKey(version, connection_id), std::move(entry));
+  }
+
+  size_t Size() {
+    QuicWriterMutexLock lock(&mu_);
+    return cache_.Size();
+  }
+
+  void Clear() {
+    QuicWriterMutexLock lock(&mu_);
+    cache_.Clear();
+  }
+
+ private:
+  InitialObfuscatorCache() : cache_(kInitialObfuscatorCacheCapacity) {}
+
+  static uint64_t ComputeKey(ParsedQuicVersion version,
+                             QuicConnectionId connection_id) {
+    return QuicUtils::FNV1a_64_Hash(absl::string_view(
+               connection_id.data(), connection_id.length())) ^
+           CreateQuicVersionLabel(version);
+  }
+
+  QuicMutex mu_;
+  QuicLRUCache<uint64_t, InitialObfuscatorCacheEntry> cache_
+      QUIC_GUARDED_BY(mu_);
+};
+
 }  // namespace
 
 // static
@@ -263,40 +389,46 @@ void CryptoUtils::CreateInitialObfuscators(Perspective perspective,
                                     connection_id, version.transport_version))
       << "CreateTlsInitialCrypters: attempted to use connection ID "
       << connection_id << " which is invalid with version " << version;
-  const EVP_MD* hash = EVP_sha256();
-
-  size_t salt_len;
-  const uint8_t* salt = InitialSaltForVersion(version, &salt_len);
-  std::vector<uint8_t> handshake_secret;
-  handshake_secret.resize(EVP_MAX_MD_SIZE);
-  size_t handshake_secret_len;
-  const bool hkdf_extract_success =
-      HKDF_extract(handshake_secret.data(), &handshake_secret_len, hash,
-                   reinterpret_cast<const uint8_t*>(connection_id.data()),
-                   connection_id.length(), salt, salt_len);
-  QUIC_BUG_IF(quic_bug_12871_2, !hkdf_extract_success)
-      << "HKDF_extract failed when creating initial crypters";
-  handshake_secret.resize(handshake_secret_len);
-
-  const std::string client_label = "client in";
-  const std::string server_label = "server in";
-  std::string encryption_label, decryption_label;
-  if (perspective == Perspective::IS_CLIENT) {
-    encryption_label = client_label;
-    decryption_label = server_label;
-  } else {
-    encryption_label = server_label;
-    decryption_label = client_label;
-  }
-  std::vector<uint8_t> encryption_secret = HkdfExpandLabel(
-      hash, handshake_secret, encryption_label, EVP_MD_size(hash));
   crypters->encrypter = std::make_unique<Aes128GcmEncrypter>();
-  InitializeCrypterSecrets(hash, encryption_secret, crypters->encrypter.get());
-
-  std::vector<uint8_t> decryption_secret = HkdfExpandLabel(
-      hash, handshake_secret, decryption_label, EVP_MD_size(hash));
   crypters->decrypter = std::make_unique<Aes128GcmDecrypter>();
-  InitializeCrypterSecrets(hash, decryption_secret, crypters->decrypter.get());
+
+  InitialObfuscatorKeys client_keys;
+  InitialObfuscatorKeys server_keys;
+  InitialObfuscatorCache* cache = InitialObfuscatorCache::GetInstance();
+  if (!cache->Lookup(version, connection_id, &client_keys, &server_keys)) {
+    const EVP_MD* hash = EVP_sha256();
+
+    size_t salt_len;
+    const uint8_t* salt = InitialSaltForVersion(version, &salt_len);
+    std::vector<uint8_t> handshake_secret;
+    handshake_secret.resize(EVP_MAX_MD_SIZE);
+    size_t handshake_secret_len;
+    const bool hkdf_extract_success =
+        HKDF_extract(handshake_secret.data(), &handshake_secret_len, hash,
+                     reinterpret_cast<const uint8_t*>(connection_id.data()),
+                     connection_id.length(), salt, salt_len);
+    QUIC_BUG_IF(quic_bug_12871_2, !hkdf_extract_success)
+        << "HKDF_extract failed when creating initial crypters";
+    handshake_secret.resize(handshake_secret_len);
+
+    // Both directions are always derived, so memoizing them costs no extra
+    // HKDF work on a miss.
+    client_keys = DeriveInitialObfuscatorKeys(hash, handshake_secret,
+                                              "client in", *crypters->encrypter);
+    server_keys = DeriveInitialObfuscatorKeys(hash, handshake_secret,
+                                              "server in", *crypters->encrypter);
+    if (hkdf_extract_success && !client_keys.key.empty() &&
+        !server_keys.key.empty()) {
+      cache->Insert(version, connection_id, client_keys, server_keys);
+    }
+  }
+
+  const InitialObfuscatorKeys& encryption_keys =
+      perspective == Perspective::IS_CLIENT ? client_keys : server_keys;
+  const InitialObfuscatorKeys& decryption_keys =
+      perspective == Perspective::IS_CLIENT ? server_keys : client_keys;
+  ApplyInitialObfuscatorKeys(encryption_keys, crypters->encrypter.get());
+  ApplyInitialObfuscatorKeys(decryption_keys, crypters->decrypter.get());
 }
 
 // static
@@ -763,4 +895,16 @@ bool CryptoUtils::GetSSLCapabilities(const SSL* ssl,
   return true;
 }
 
+namespace test {
+
+size_t InitialObfuscatorCacheSizeForTesting() {
+  return InitialObfuscatorCache::GetInstance()->Size();
+}
+
+void ClearInitialObfuscatorCacheForTesting() {
+  InitialObfuscatorCache::GetInstance()->Clear();
+}
+
+}  // namespace test
+
 }  // namespace quic
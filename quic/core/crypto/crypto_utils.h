@@ -113,6 +113,12 @@ class QUIC_EXPORT_PRIVATE CryptoUtils {
   // as setting the key and IV on those crypters. For older versions of QUIC
   // that do not use the new IETF style ENCRYPTION_INITIAL obfuscators, this
   // function puts a NullEncrypter and NullDecrypter in |*crypters|.
+  //
+  // The derived key material is a pure function of |version| and
+  // |connection_id| and is memoized in a small process-wide cache, so
+  // repeated calls with the same inputs -- e.g. the dispatcher inspecting a
+  // client hello and the resulting connection installing its initial crypters
+  // -- skip the HKDF derivation.
   static void CreateInitialObfuscators(Perspective perspective,
                                        ParsedQuicVersion version,
                                        QuicConnectionId connection_id,
@@ -255,6 +261,17 @@ class QUIC_EXPORT_PRIVATE CryptoUtils {
                                  size_t* capabilities_len);
 };
 
+namespace test {
+
+// Returns the number of initial key derivations currently memoized by
+// CreateInitialObfuscators.
+size_t InitialObfuscatorCacheSizeForTesting();
+
+// Empties the process-wide initial obfuscator cache.
+void ClearInitialObfuscatorCacheForTesting();
+
+}  // namespace test
+
 }  // namespace quic
 
 #endif  // QUICHE_QUIC_CORE_CRYPTO_CRYPTO_UTILS_H_
@@ -165,6 +165,70 @@ TEST_F(CryptoUtilsTest, ValidateServerVersionsWithDowngrade) {
   EXPECT_FALSE(error_details.empty());
 }
 
+TEST_F(CryptoUtilsTest, CreateInitialObfuscatorsMemoized) {
+  const ParsedQuicVersion version = ParsedQuicVersion::RFCv1();
+  const QuicConnectionId connection_id = TestConnectionId(0x1337);
+  const std::string plaintext = "client hello";
+  const std::string associated_data = "associated data";
+
+  ClearInitialObfuscatorCacheForTesting();
+  EXPECT_EQ(0u, InitialObfuscatorCacheSizeForTesting());
+
+  // The first derivation populates the cache.
+  CrypterPair first;
+  CryptoUtils::CreateInitialObfuscators(Perspective::IS_SERVER, version,
+                                        connection_id, &first);
+  EXPECT_EQ(1u, InitialObfuscatorCacheSizeForTesting());
+
+  // A repeated derivation hits the cache and must yield the same key
+  // material: both encrypters produce identical ciphertext.
+  CrypterPair second;
+  CryptoUtils::CreateInitialObfuscators(Perspective::IS_SERVER, version,
+                                        connection_id, &second);
+  EXPECT_EQ(1u, InitialObfuscatorCacheSizeForTesting());
+
+  char first_ciphertext[100], second_ciphertext[100];
+  size_t first_len, second_len;
+  ASSERT_TRUE(first.encrypter->EncryptPacket(
+      /*packet_number=*/1, associated_data, plaintext, first_ciphertext,
+      &first_len, ABSL_ARRAYSIZE(first_ciphertext)));
+  ASSERT_TRUE(second.encrypter->EncryptPacket(
+      /*packet_number=*/1, associated_data, plaintext, second_ciphertext,
+      &second_len, ABSL_ARRAYSIZE(second_ciphertext)));
+  ASSERT_EQ(first_len, second_len);
+  EXPECT_EQ(absl::string_view(first_ciphertext, first_len),
+            absl::string_view(second_ciphertext, second_len));
+
+  // The cache is perspective-independent: a client using the same connection
+  // ID hits the same entry, and its decrypter undoes the server's encrypter.
+  CrypterPair client;
+  CryptoUtils::CreateInitialObfuscators(Perspective::IS_CLIENT, version,
+                                        connection_id, &client);
+  EXPECT_EQ(1u, InitialObfuscatorCacheSizeForTesting());
+
+  char decrypted[100];
+  size_t decrypted_len;
+  ASSERT_TRUE(client.decrypter->DecryptPacket(
+      /*packet_number=*/1, associated_data,
+      absl::string_view(first_ciphertext, first_len), decrypted,
+      &decrypted_len, ABSL_ARRAYSIZE(decrypted)));
+  EXPECT_EQ(plaintext, absl::string_view(decrypted, decrypted_len));
+
+  // A different connection ID derives different material.
+  CrypterPair other;
+  CryptoUtils::CreateInitialObfuscators(Perspective::IS_SERVER, version,
+                                        TestConnectionId(0x1338), &other);
+  EXPECT_EQ(2u, InitialObfuscatorCacheSizeForTesting());
+
+  char other_ciphertext[100];
+  size_t other_len;
+  ASSERT_TRUE(other.encrypter->EncryptPacket(
+      /*packet_number=*/1, associated_data, plaintext, other_ciphertext,
+      &other_len, ABSL_ARRAYSIZE(other_ciphertext)));
+  EXPECT_NE(absl::string_view(first_ciphertext, first_len),
+            absl::string_view(other_ciphertext, other_len));
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace quic
@@ -99,6 +99,10 @@ absl::string_view NullDecrypter::GetNoncePrefix() const {
   return absl::string_view();
 }
 
+absl::string_view NullDecrypter::GetIV() const {
+  return absl::string_view();
+}
+
 uint32_t NullDecrypter::cipher_id() const {
   return 0;
 }
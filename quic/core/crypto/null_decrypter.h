@@ -48,6 +48,7 @@ class QUIC_EXPORT_PRIVATE NullDecrypter : public QuicDecrypter {
   size_t GetIVSize() const override;
   absl::string_view GetKey() const override;
   absl::string_view GetNoncePrefix() const override;
+  absl::string_view GetIV() const override;
 
   uint32_t cipher_id() const override;
   QuicPacketCount GetIntegrityLimit() const override;
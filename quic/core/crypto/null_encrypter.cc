@@ -96,6 +96,10 @@ absl::string_view NullEncrypter::GetNoncePrefix() const {
   return absl::string_view();
 }
 
+absl::string_view NullEncrypter::GetIV() const {
+  return absl::string_view();
+}
+
 size_t NullEncrypter::GetHashLength() const {
   return kHashSizeShort;
 }
@@ -44,6 +44,7 @@ class QUIC_EXPORT_PRIVATE NullEncrypter : public QuicEncrypter {
   QuicPacketCount GetConfidentialityLimit() const override;
   absl::string_view GetKey() const override;
   absl::string_view GetNoncePrefix() const override;
+  absl::string_view GetIV() const override;
 
  private:
   size_t GetHashLength() const;
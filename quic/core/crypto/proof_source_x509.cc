@@ -11,12 +11,16 @@
 #include "third_party/boringssl/src/include/openssl/ssl.h"
 #include "quic/core/crypto/certificate_view.h"
 #include "quic/core/crypto/crypto_protocol.h"
+#include "quic/core/crypto/tls_cert_compression.h"
 #include "quic/core/quic_data_writer.h"
 #include "quic/platform/api/quic_bug_tracker.h"
 #include "common/quiche_endian.h"
 
 namespace quic {
 
+ProofSourceX509::ProofSourceX509()
+    : certificate_set_(std::make_shared<CertificateSet>()) {}
+
 std::unique_ptr<ProofSourceX509> ProofSourceX509::Create(
     QuicReferenceCountedPointer<Chain> default_chain,
     CertificatePrivateKey default_key) {
@@ -24,7 +28,6 @@ std::unique_ptr<ProofSourceX509> ProofSourceX509::Create(
   if (!result->AddCertificateChain(default_chain, std::move(default_key))) {
     return nullptr;
   }
-  result->default_certificate_ = &result->certificates_.front();
   return result;
 }
 
@@ -53,7 +56,9 @@ void ProofSourceX509::GetProof(
     return;
   }
 
-  Certificate* certificate = GetCertificate(hostname, &proof.cert_matched_sni);
+  std::shared_ptr<const CertificateSet> certificate_set = GetCertificateSet();
+  Certificate* certificate =
+      GetCertificate(*certificate_set, hostname, &proof.cert_matched_sni);
   proof.signature =
       certificate->key.Sign(absl::string_view(payload.get(), payload_size),
                             SSL_SIGN_RSA_PSS_RSAE_SHA256);
@@ -65,7 +70,8 @@ QuicReferenceCountedPointer<ProofSource::Chain> ProofSourceX509::GetCertChain(
     const QuicSocketAddress& /*server_address*/,
     const QuicSocketAddress& /*client_address*/, const std::string& hostname,
     bool* cert_matched_sni) {
-  return GetCertificate(hostname, cert_matched_sni)->chain;
+  std::shared_ptr<const CertificateSet> certificate_set = GetCertificateSet();
+  return GetCertificate(*certificate_set, hostname, cert_matched_sni)->chain;
 }
 
 void ProofSourceX509::ComputeTlsSignature(
@@ -76,8 +82,10 @@ void ProofSourceX509::ComputeTlsSignature(
     absl::string_view in,
     std::unique_ptr<ProofSource::SignatureCallback> callback) {
   bool cert_matched_sni;
-  std::string signature = GetCertificate(hostname, &cert_matched_sni)
-                              ->key.Sign(in, signature_algorithm);
+  std::shared_ptr<const CertificateSet> certificate_set = GetCertificateSet();
+  std::string signature =
+      GetCertificate(*certificate_set, hostname, &cert_matched_sni)
+          ->key.Sign(in, signature_algorithm);
   callback->Run(/*ok=*/!signature.empty(), signature, nullptr);
 }
 
@@ -113,36 +121,109 @@ bool ProofSourceX509::AddCertificateChain(
     return false;
   }
 
-  certificates_.push_front(Certificate{
+  // Copy-on-write: build a new snapshot which shares the existing
+  // certificate objects, then publish it atomically so that concurrent
+  // lookups never observe a partially updated map.
+  std::shared_ptr<const CertificateSet> current = GetCertificateSet();
+  auto new_set = std::make_shared<CertificateSet>();
+  new_set->version = current->version + 1;
+  new_set->certificates = current->certificates;
+  new_set->default_certificate = current->default_certificate;
+  new_set->certificate_map = current->certificate_map;
+
+  new_set->certificates.push_front(std::make_shared<Certificate>(Certificate{
       chain,
       std::move(key),
-  });
-  Certificate* certificate = &certificates_.front();
+  }));
+  Certificate* certificate = new_set->certificates.front().get();
+  if (new_set->default_certificate == nullptr) {
+    // The first certificate added is used when no SubjectAltName matches.
+    new_set->default_certificate = certificate;
+  }
 
   for (absl::string_view host : leaf->subject_alt_name_domains()) {
-    certificate_map_[std::string(host)] = certificate;
+    new_set->certificate_map[std::string(host)] = certificate;
   }
+  WarmCompressedCertCacheForChain(*chain);
+  std::atomic_store(&certificate_set_,
+                    std::shared_ptr<CertificateSet>(std::move(new_set)));
   return true;
 }
 
+void ProofSourceX509::SwapCertificates(
+    std::unique_ptr<ProofSourceX509> new_source) {
+  if (new_source == nullptr) {
+    QUIC_BUG(quic_bug_proof_source_swap_null)
+        << "SwapCertificates called with a null proof source.";
+    return;
+  }
+  // |new_source| is exclusively owned here, so its snapshot has not been
+  // published yet and can still be renumbered.
+  std::shared_ptr<CertificateSet> new_set =
+      std::atomic_load(&new_source->certificate_set_);
+  new_set->version = GetCertificateSet()->version + 1;
+  std::atomic_store(&certificate_set_, std::move(new_set));
+}
+
+uint64_t ProofSourceX509::certificate_set_version() const {
+  return GetCertificateSet()->version;
+}
+
+std::shared_ptr<const ProofSourceX509::CertificateSet>
+ProofSourceX509::GetCertificateSet() const {
+  return std::atomic_load(&certificate_set_);
+}
+
+// static
+void ProofSourceX509::WarmCompressedCertCacheForChain(const Chain& chain) {
+  // Reconstruct the TLS 1.3 Certificate message a server sends for this chain
+  // (empty certificate_request_context and empty per-certificate extensions)
+  // and pre-compress it, so the first handshake does not run zlib either.
+  size_t list_length = 0;
+  for (const std::string& cert : chain.certs) {
+    list_length += 3 /* cert_data length */ + cert.size() +
+                   2 /* extensions length */;
+  }
+  const size_t message_length = 1 /* request context length */ +
+                                3 /* certificate_list length */ + list_length;
+  auto message = std::make_unique<char[]>(message_length);
+  QuicDataWriter writer(message_length, message.get());
+  bool success = writer.WriteUInt8(0) &&
+                 writer.WriteBytesToUInt64(3, list_length);
+  for (const std::string& cert : chain.certs) {
+    success = success && writer.WriteBytesToUInt64(3, cert.size()) &&
+              writer.WriteStringPiece(cert) && writer.WriteUInt16(0);
+  }
+  if (!success) {
+    QUIC_BUG(quic_bug_proof_source_cert_message) << "Failed to serialize "
+                                                    "Certificate message for "
+                                                    "compression warm-up.";
+    return;
+  }
+  WarmCompressedCertCache(absl::string_view(message.get(), message_length));
+}
+
+// static
 ProofSourceX509::Certificate* ProofSourceX509::GetCertificate(
-    const std::string& hostname, bool* cert_matched_sni) const {
-  auto it = certificate_map_.find(hostname);
-  if (it != certificate_map_.end()) {
+    const CertificateSet& certificate_set,
+    const std::string& hostname,
+    bool* cert_matched_sni) {
+  auto it = certificate_set.certificate_map.find(hostname);
+  if (it != certificate_set.certificate_map.end()) {
     *cert_matched_sni = true;
     return it->second;
   }
   auto dot_pos = hostname.find('.');
   if (dot_pos != std::string::npos) {
     std::string wildcard = absl::StrCat("*", hostname.substr(dot_pos));
-    it = certificate_map_.find(wildcard);
-    if (it != certificate_map_.end()) {
+    it = certificate_set.certificate_map.find(wildcard);
+    if (it != certificate_set.certificate_map.end()) {
       *cert_matched_sni = true;
       return it->second;
     }
   }
   *cert_matched_sni = false;
-  return default_certificate_;
+  return certificate_set.default_certificate;
 }
 
 }  // namespace quic
@@ -5,6 +5,7 @@
 #ifndef QUICHE_QUIC_CORE_CRYPTO_PROOF_SOURCE_X509_H_
 #define QUICHE_QUIC_CORE_CRYPTO_PROOF_SOURCE_X509_H_
 
+#include <cstdint>
 #include <forward_list>
 #include <memory>
 
@@ -50,27 +51,63 @@ class QUIC_EXPORT_PRIVATE ProofSourceX509 : public ProofSource {
 
   // Adds a certificate chain to the verifier.  Returns false if the chain is
   // not valid.  Newer certificates will override older certificates with the
-  // same SubjectAltName value.
+  // same SubjectAltName value.  Publishes a new certificate set, so it is
+  // safe to call concurrently with lookups.
   ABSL_MUST_USE_RESULT bool AddCertificateChain(
       QuicReferenceCountedPointer<Chain> chain,
       CertificatePrivateKey key);
 
+  // Atomically replaces all of the certificate chains served by this proof
+  // source with those of |new_source|, which is typically built on another
+  // thread via Create() and AddCertificateChain().  Lookups that started
+  // before the swap keep using the old certificate set; the old chains are
+  // freed once the last lookup and the last in-flight handshake referencing
+  // them complete.  This allows certificates to be rotated without
+  // restarting the process or locking the handshake path.
+  void SwapCertificates(std::unique_ptr<ProofSourceX509> new_source);
+
+  // Version of the currently published certificate set.  Starts at one and
+  // increases with every AddCertificateChain() or SwapCertificates() call.
+  uint64_t certificate_set_version() const;
+
  private:
-  ProofSourceX509() = default;
+  ProofSourceX509();
 
   struct QUIC_EXPORT_PRIVATE Certificate {
     QuicReferenceCountedPointer<Chain> chain;
     CertificatePrivateKey key;
   };
 
+  // An immutable snapshot of the certificates served by this proof source.
+  // A snapshot is never modified after it has been published; updates build
+  // a new snapshot and publish it with an atomic shared_ptr store, so
+  // lookups are lock-free.
+  struct QUIC_EXPORT_PRIVATE CertificateSet {
+    uint64_t version = 0;
+    // Certificate objects are shared between consecutive snapshots.  The
+    // map values and the default pointer refer to objects owned by
+    // |certificates|.
+    std::forward_list<std::shared_ptr<Certificate>> certificates;
+    Certificate* default_certificate = nullptr;
+    absl::node_hash_map<std::string, Certificate*> certificate_map;
+  };
+
+  // Returns the currently published snapshot.  The caller must hold on to
+  // the returned pointer for as long as it uses certificates from the set.
+  std::shared_ptr<const CertificateSet> GetCertificateSet() const;
+
   // Looks up certficiate for hostname, returns the default if no certificate is
   // found.
-  Certificate* GetCertificate(const std::string& hostname,
-                              bool* cert_matched_sni) const;
+  static Certificate* GetCertificate(const CertificateSet& certificate_set,
+                                     const std::string& hostname,
+                                     bool* cert_matched_sni);
+
+  // Pre-compresses the TLS Certificate message for |chain| into the
+  // process-wide compressed-cert cache.
+  static void WarmCompressedCertCacheForChain(const Chain& chain);
 
-  std::forward_list<Certificate> certificates_;
-  Certificate* default_certificate_;
-  absl::node_hash_map<std::string, Certificate*> certificate_map_;
+  // Accessed only via std::atomic_load/std::atomic_store.
+  std::shared_ptr<CertificateSet> certificate_set_;
 };
 
 }  // namespace quic
@@ -114,6 +114,47 @@ TEST_F(ProofSourceX509Test, CertificateSelection) {
   EXPECT_FALSE(cert_matched_sni);
 }
 
+TEST_F(ProofSourceX509Test, CertificateSetVersion) {
+  std::unique_ptr<ProofSourceX509> proof_source =
+      ProofSourceX509::Create(test_chain_, std::move(*test_key_));
+  ASSERT_TRUE(proof_source != nullptr);
+  EXPECT_EQ(1u, proof_source->certificate_set_version());
+  ASSERT_TRUE(proof_source->AddCertificateChain(wildcard_chain_,
+                                                std::move(*wildcard_key_)));
+  EXPECT_EQ(2u, proof_source->certificate_set_version());
+}
+
+TEST_F(ProofSourceX509Test, SwapCertificates) {
+  std::unique_ptr<ProofSourceX509> proof_source =
+      ProofSourceX509::Create(test_chain_, std::move(*test_key_));
+  ASSERT_TRUE(proof_source != nullptr);
+
+  bool cert_matched_sni;
+  QuicReferenceCountedPointer<ProofSource::Chain> old_chain =
+      proof_source->GetCertChain(QuicSocketAddress(), QuicSocketAddress(),
+                                 "unknown.test", &cert_matched_sni);
+  EXPECT_EQ(old_chain->certs[0], kTestCertificate);
+
+  // Build a replacement proof source, as a certificate rotation would on
+  // another thread, and swap it in.
+  std::unique_ptr<ProofSourceX509> new_source =
+      ProofSourceX509::Create(wildcard_chain_, std::move(*wildcard_key_));
+  ASSERT_TRUE(new_source != nullptr);
+  proof_source->SwapCertificates(std::move(new_source));
+  EXPECT_EQ(2u, proof_source->certificate_set_version());
+
+  // Lookups now serve the new default chain.
+  EXPECT_EQ(proof_source
+                ->GetCertChain(QuicSocketAddress(), QuicSocketAddress(),
+                               "unknown.test", &cert_matched_sni)
+                ->certs[0],
+            kWildcardCertificate);
+
+  // The chain handed out before the swap stays valid until its last
+  // reference goes away, as an in-flight handshake's would.
+  EXPECT_EQ(old_chain->certs[0], kTestCertificate);
+}
+
 TEST_F(ProofSourceX509Test, TlsSignature) {
   class Callback : public ProofSource::SignatureCallback {
    public:
@@ -4,13 +4,21 @@
 
 #include "quic/core/crypto/quic_client_session_cache.h"
 
+#include "third_party/boringssl/src/include/openssl/mem.h"
+#include "quic/core/crypto/transport_parameters.h"
 #include "quic/core/quic_clock.h"
+#include "quic/core/quic_data_reader.h"
+#include "quic/core/quic_data_writer.h"
 
 namespace quic {
 
 namespace {
 
 const size_t kDefaultMaxEntries = 1024;
+
+// Header of the blob produced by QuicClientSessionCache::Serialize().
+const uint32_t kSerializedCacheMagic = 0x51435343;  // "QCSC"
+const uint16_t kSerializedCacheVersion = 1;
 // Returns false if the SSL |session| doesn't exist or it is expired at |now|.
 bool IsValid(SSL_SESSION* session, uint64_t now) {
   if (!session) return false;
@@ -30,6 +38,65 @@ bool DoApplicationStatesMatch(const ApplicationState* state,
   return false;
 }
 
+void AppendUint(std::string* output, uint64_t value, size_t num_bytes) {
+  char buffer[sizeof(uint64_t)];
+  QuicDataWriter writer(sizeof(buffer), buffer);
+  writer.WriteBytesToUInt64(num_bytes, value);
+  output->append(buffer, num_bytes);
+}
+
+void AppendLengthPrefixed(std::string* output,
+                          absl::string_view data,
+                          size_t length_bytes) {
+  AppendUint(output, data.size(), length_bytes);
+  output->append(data.data(), data.size());
+}
+
+// Serializes an SSL_SESSION, or returns an empty string on failure.
+std::string SerializeSession(const SSL_SESSION* session) {
+  uint8_t* data = nullptr;
+  size_t len = 0;
+  if (!SSL_SESSION_to_bytes(session, &data, &len)) {
+    return std::string();
+  }
+  std::string result(reinterpret_cast<char*>(data), len);
+  OPENSSL_free(data);
+  return result;
+}
+
+// Transport parameters are stored as one perspective byte followed by the
+// TLS extension encoding, always using the RFCv1 codec.
+std::string SerializeParams(const TransportParameters& params) {
+  std::vector<uint8_t> encoded;
+  if (!SerializeTransportParameters(ParsedQuicVersion::RFCv1(), params,
+                                    &encoded)) {
+    return std::string();
+  }
+  std::string result;
+  result.push_back(static_cast<char>(params.perspective));
+  result.append(reinterpret_cast<const char*>(encoded.data()), encoded.size());
+  return result;
+}
+
+std::unique_ptr<TransportParameters> ParseSerializedParams(
+    absl::string_view data) {
+  if (data.empty()) {
+    return nullptr;
+  }
+  const Perspective perspective = static_cast<Perspective>(data[0]);
+  auto params = std::make_unique<TransportParameters>();
+  std::string error_details;
+  if (!ParseTransportParameters(
+          ParsedQuicVersion::RFCv1(), perspective,
+          reinterpret_cast<const uint8_t*>(data.data()) + 1, data.size() - 1,
+          params.get(), &error_details)) {
+    QUIC_DLOG(WARNING) << "Failed to parse cached transport parameters: "
+                       << error_details;
+    return nullptr;
+  }
+  return params;
+}
+
 }  // namespace
 
 QuicClientSessionCache::QuicClientSessionCache()
@@ -52,6 +119,16 @@ void QuicClientSessionCache::Insert(const QuicServerId& server_id,
     return;
   }
 
+  if (!iter->second->pending_sessions.empty() ||
+      !iter->second->pending_params.empty()) {
+    // A persisted entry that was never looked up; replace it with the live
+    // state from this connection.
+    cache_.Erase(iter);
+    CreateAndInsertEntry(server_id, std::move(session), params,
+                         application_state);
+    return;
+  }
+
   QUICHE_DCHECK(iter->second->params);
   // The states are both the same, so only need to insert sessions.
   if (params == *iter->second->params &&
@@ -68,10 +145,11 @@ void QuicClientSessionCache::Insert(const QuicServerId& server_id,
 }
 
 std::unique_ptr<QuicResumptionState> QuicClientSessionCache::Lookup(
-    const QuicServerId& server_id, QuicWallTime now, const SSL_CTX* /*ctx*/) {
+    const QuicServerId& server_id, QuicWallTime now, const SSL_CTX* ctx) {
   auto iter = cache_.Lookup(server_id);
   if (iter == cache_.end()) return nullptr;
 
+  MaybeDecodePending(iter->second.get(), ctx);
   if (!IsValid(iter->second->PeekSession(), now.ToUNIXSeconds())) {
     QUIC_DLOG(INFO) << "TLS Session expired for host:" << server_id.host();
     cache_.Erase(iter);
@@ -123,7 +201,14 @@ void QuicClientSessionCache::OnNewTokenReceived(const QuicServerId& server_id,
 void QuicClientSessionCache::RemoveExpiredEntries(QuicWallTime now) {
   auto iter = cache_.begin();
   while (iter != cache_.end()) {
-    if (!IsValid(iter->second->PeekSession(), now.ToUNIXSeconds())) {
+    // Entries restored by Deserialize() are checked against the expiry
+    // recorded at serialization time, since their sessions have not been
+    // decoded yet.
+    const bool valid =
+        iter->second->pending_sessions.empty()
+            ? IsValid(iter->second->PeekSession(), now.ToUNIXSeconds())
+            : now.ToUNIXSeconds() < iter->second->pending_expiry;
+    if (!valid) {
       iter = cache_.Erase(iter);
     } else {
       ++iter;
@@ -133,6 +218,172 @@ void QuicClientSessionCache::RemoveExpiredEntries(QuicWallTime now) {
 
 void QuicClientSessionCache::Clear() { cache_.Clear(); }
 
+bool QuicClientSessionCache::Serialize(std::string* output) {
+  std::string records;
+  uint32_t num_records = 0;
+  for (auto& item : cache_) {
+    Entry& entry = *item.second;
+
+    // Pass pending (never decoded) state through unchanged; otherwise encode
+    // the live sessions.
+    std::vector<std::string> sessions = entry.pending_sessions;
+    uint64_t expiry = entry.pending_expiry;
+    if (sessions.empty()) {
+      for (const auto& session : entry.sessions) {
+        if (session == nullptr) continue;
+        std::string serialized = SerializeSession(session.get());
+        if (!serialized.empty()) {
+          sessions.push_back(std::move(serialized));
+        }
+      }
+      if (entry.PeekSession() != nullptr) {
+        expiry = SSL_SESSION_get_time(entry.PeekSession()) +
+                 SSL_SESSION_get_timeout(entry.PeekSession());
+      }
+    }
+    if (sessions.empty()) {
+      // Nothing to resume with; skip the entry.
+      continue;
+    }
+
+    std::string params_bytes = entry.pending_params;
+    if (params_bytes.empty() && entry.params != nullptr) {
+      params_bytes = SerializeParams(*entry.params);
+    }
+
+    std::string record;
+    AppendLengthPrefixed(&record, item.first.host(), 2);
+    AppendUint(&record, item.first.port(), 2);
+    AppendUint(&record, item.first.privacy_mode_enabled() ? 1 : 0, 1);
+    AppendUint(&record, expiry, 8);
+    AppendLengthPrefixed(&record, entry.token, 2);
+    AppendLengthPrefixed(&record, params_bytes, 2);
+    AppendUint(&record, entry.application_state != nullptr ? 1 : 0, 1);
+    if (entry.application_state != nullptr) {
+      AppendLengthPrefixed(
+          &record,
+          absl::string_view(
+              reinterpret_cast<const char*>(entry.application_state->data()),
+              entry.application_state->size()),
+          4);
+    }
+    AppendUint(&record, sessions.size(), 1);
+    for (const std::string& session : sessions) {
+      AppendLengthPrefixed(&record, session, 4);
+    }
+
+    AppendLengthPrefixed(&records, record, 4);
+    ++num_records;
+  }
+
+  if (num_records == 0) {
+    return false;
+  }
+  AppendUint(output, kSerializedCacheMagic, 4);
+  AppendUint(output, kSerializedCacheVersion, 2);
+  AppendUint(output, num_records, 4);
+  output->append(records);
+  return true;
+}
+
+bool QuicClientSessionCache::Deserialize(absl::string_view data) {
+  QuicDataReader reader(data.data(), data.size());
+  uint32_t magic;
+  uint16_t version;
+  uint32_t num_records;
+  if (!reader.ReadUInt32(&magic) || magic != kSerializedCacheMagic ||
+      !reader.ReadUInt16(&version) || version != kSerializedCacheVersion ||
+      !reader.ReadUInt32(&num_records)) {
+    return false;
+  }
+
+  for (uint32_t i = 0; i < num_records; ++i) {
+    uint32_t record_length;
+    absl::string_view record;
+    if (!reader.ReadUInt32(&record_length) ||
+        !reader.ReadStringPiece(&record, record_length)) {
+      return false;
+    }
+    QuicDataReader record_reader(record.data(), record.size());
+
+    absl::string_view host;
+    uint16_t port;
+    uint8_t privacy_mode_enabled;
+    uint64_t expiry;
+    absl::string_view token;
+    absl::string_view params_bytes;
+    uint8_t has_application_state;
+    if (!record_reader.ReadStringPiece16(&host) ||
+        !record_reader.ReadUInt16(&port) ||
+        !record_reader.ReadUInt8(&privacy_mode_enabled) ||
+        !record_reader.ReadUInt64(&expiry) ||
+        !record_reader.ReadStringPiece16(&token) ||
+        !record_reader.ReadStringPiece16(&params_bytes) ||
+        !record_reader.ReadUInt8(&has_application_state)) {
+      return false;
+    }
+
+    auto entry = std::make_unique<Entry>();
+    entry->token = std::string(token);
+    entry->pending_params = std::string(params_bytes);
+    entry->pending_expiry = expiry;
+    if (has_application_state != 0) {
+      uint32_t state_length;
+      absl::string_view state;
+      if (!record_reader.ReadUInt32(&state_length) ||
+          !record_reader.ReadStringPiece(&state, state_length)) {
+        return false;
+      }
+      entry->application_state = std::make_unique<ApplicationState>(
+          state.begin(), state.end());
+    }
+    uint8_t num_sessions;
+    if (!record_reader.ReadUInt8(&num_sessions)) {
+      return false;
+    }
+    for (uint8_t j = 0; j < num_sessions; ++j) {
+      uint32_t session_length;
+      absl::string_view session;
+      if (!record_reader.ReadUInt32(&session_length) ||
+          !record_reader.ReadStringPiece(&session, session_length)) {
+        return false;
+      }
+      entry->pending_sessions.push_back(std::string(session));
+    }
+
+    cache_.Insert(QuicServerId(std::string(host), port,
+                               privacy_mode_enabled != 0),
+                  std::move(entry));
+  }
+  return true;
+}
+
+// static
+void QuicClientSessionCache::MaybeDecodePending(Entry* entry,
+                                                const SSL_CTX* ctx) {
+  if (entry->pending_sessions.empty() && entry->pending_params.empty()) {
+    return;
+  }
+  // Sessions were serialized newest first; push oldest first so that
+  // PushSession() keeps the original order.
+  for (auto it = entry->pending_sessions.rbegin();
+       it != entry->pending_sessions.rend(); ++it) {
+    bssl::UniquePtr<SSL_SESSION> session(SSL_SESSION_from_bytes(
+        reinterpret_cast<const uint8_t*>(it->data()), it->size(), ctx));
+    if (session == nullptr) {
+      QUIC_DLOG(WARNING) << "Failed to decode a cached TLS session.";
+      continue;
+    }
+    entry->PushSession(std::move(session));
+  }
+  if (entry->params == nullptr) {
+    entry->params = ParseSerializedParams(entry->pending_params);
+  }
+  entry->pending_sessions.clear();
+  entry->pending_params.clear();
+  entry->pending_expiry = 0;
+}
+
 void QuicClientSessionCache::CreateAndInsertEntry(
     const QuicServerId& server_id, bssl::UniquePtr<SSL_SESSION> session,
     const TransportParameters& params,
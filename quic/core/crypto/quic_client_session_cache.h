@@ -6,7 +6,10 @@
 #define QUICHE_QUIC_CORE_CRYPTO_QUIC_CLIENT_SESSION_CACHE_H_
 
 #include <memory>
+#include <string>
+#include <vector>
 
+#include "absl/strings/string_view.h"
 #include "quic/core/crypto/quic_crypto_client_config.h"
 #include "quic/core/quic_lru_cache.h"
 #include "quic/core/quic_server_id.h"
@@ -43,6 +46,22 @@ class QUIC_EXPORT_PRIVATE QuicClientSessionCache : public SessionCache {
 
   void Clear() override;
 
+  // Serializes all resumable entries (tickets, transport parameters,
+  // application state, and NEW_TOKEN tokens) into a compact length-prefixed
+  // binary blob, appended to |*output|.  The layout is position-independent,
+  // so callers may persist the blob to a file and later mmap() it and hand
+  // the mapped bytes to Deserialize().  Returns false if nothing was
+  // serialized.
+  bool Serialize(std::string* output);
+
+  // Rebuilds cache entries from a blob produced by Serialize().  Entries are
+  // indexed eagerly, but each entry's TLS sessions and transport parameters
+  // are only decoded on the first Lookup() for that server, so a process
+  // restoring a large persisted cache pays decode cost only for origins it
+  // actually revisits.  Returns false if |data| is malformed; entries parsed
+  // before the error are kept.
+  bool Deserialize(absl::string_view data);
+
   size_t size() const { return cache_.Size(); }
 
  private:
@@ -66,6 +85,14 @@ class QUIC_EXPORT_PRIVATE QuicClientSessionCache : public SessionCache {
     std::unique_ptr<TransportParameters> params;
     std::unique_ptr<ApplicationState> application_state;
     std::string token;  // An opaque string received in NEW_TOKEN frame.
+
+    // Serialized state captured by Deserialize(), decoded on first Lookup()
+    // by MaybeDecodePending().  |pending_expiry| is the absolute UNIX
+    // deadline of the newest serialized session, used for expiry checks
+    // before the sessions are decoded.
+    std::vector<std::string> pending_sessions;
+    std::string pending_params;
+    uint64_t pending_expiry = 0;
   };
 
   // Creates a new entry and insert into |cache_|.
@@ -74,6 +101,9 @@ class QUIC_EXPORT_PRIVATE QuicClientSessionCache : public SessionCache {
                             const TransportParameters& params,
                             const ApplicationState* application_state);
 
+  // Decodes any state a Deserialize() call left pending on |entry|.
+  static void MaybeDecodePending(Entry* entry, const SSL_CTX* ctx);
+
   QuicLRUCache<QuicServerId, Entry, QuicServerIdHash> cache_;
 };
 
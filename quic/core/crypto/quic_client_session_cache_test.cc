@@ -435,6 +435,67 @@ TEST_F(QuicClientSessionCacheTest, RemoveExpiredEntriesAndClear) {
   EXPECT_EQ(0u, cache.size());
 }
 
+// Tests that a serialized cache can be restored in a new process and used for
+// resumption, with entries decoded lazily on Lookup.
+TEST_F(QuicClientSessionCacheTest, SerializeAndDeserialize) {
+  QuicClientSessionCache cache;
+
+  auto params = std::make_unique<TransportParameters>();
+  params->perspective = Perspective::IS_SERVER;
+  params->max_idle_timeout_ms.set_value(kFakeIdleTimeoutMilliseconds);
+  params->initial_max_data.set_value(kFakeInitialMaxData);
+
+  auto session = MakeTestSession();
+  QuicServerId id("a.com", 443);
+  cache.Insert(id, std::move(session), *params, nullptr);
+
+  std::string serialized;
+  ASSERT_TRUE(cache.Serialize(&serialized));
+
+  QuicClientSessionCache restored;
+  ASSERT_TRUE(restored.Deserialize(serialized));
+  EXPECT_EQ(1u, restored.size());
+
+  auto resumption_state =
+      restored.Lookup(id, clock_.WallNow(), ssl_ctx_.get());
+  ASSERT_NE(nullptr, resumption_state);
+  ASSERT_NE(nullptr, resumption_state->tls_session);
+  ASSERT_NE(nullptr, resumption_state->transport_params);
+  EXPECT_EQ(kFakeIdleTimeoutMilliseconds,
+            resumption_state->transport_params->max_idle_timeout_ms.value());
+  EXPECT_EQ(kFakeInitialMaxData,
+            resumption_state->transport_params->initial_max_data.value());
+}
+
+// Tests that restored entries expire correctly even before they have been
+// decoded.
+TEST_F(QuicClientSessionCacheTest, DeserializedEntryExpires) {
+  QuicClientSessionCache cache;
+
+  auto params = MakeFakeTransportParams();
+  auto session = MakeTestSession();
+  QuicServerId id("a.com", 443);
+  cache.Insert(id, std::move(session), *params, nullptr);
+
+  std::string serialized;
+  ASSERT_TRUE(cache.Serialize(&serialized));
+
+  QuicClientSessionCache restored;
+  ASSERT_TRUE(restored.Deserialize(serialized));
+  EXPECT_EQ(1u, restored.size());
+
+  clock_.AdvanceTime(kTimeout * 2);
+  restored.RemoveExpiredEntries(clock_.WallNow());
+  EXPECT_EQ(0u, restored.size());
+}
+
+// Tests that malformed input is rejected.
+TEST_F(QuicClientSessionCacheTest, DeserializeGarbage) {
+  QuicClientSessionCache cache;
+  EXPECT_FALSE(cache.Deserialize("not a serialized session cache"));
+  EXPECT_EQ(0u, cache.size());
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace quic
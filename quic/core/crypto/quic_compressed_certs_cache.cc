@@ -65,7 +65,10 @@ const std::string* QuicCompressedCertsCache::CachedCerts::compressed_cert()
 }
 
 QuicCompressedCertsCache::QuicCompressedCertsCache(int64_t max_num_certs)
-    : certs_cache_(max_num_certs) {}
+    // A single stripe preserves the documented global LRU eviction order;
+    // deployments sharing one cache across dispatcher shards can move to a
+    // striped configuration without changing this class's semantics per key.
+    : certs_cache_(max_num_certs, /*num_stripes=*/1) {}
 
 QuicCompressedCertsCache::~QuicCompressedCertsCache() {
   // Underlying cache must be cleared before destruction.
@@ -81,13 +84,11 @@ const std::string* QuicCompressedCertsCache::GetCompressedCert(
 
   uint64_t key = ComputeUncompressedCertsHash(uncompressed_certs);
 
-  CachedCerts* cached_value = nullptr;
-  auto iter = certs_cache_.Lookup(key);
-  if (iter != certs_cache_.end()) {
-    cached_value = iter->second.get();
-  }
+  std::shared_ptr<const CachedCerts> cached_value = certs_cache_.Lookup(key);
   if (cached_value != nullptr &&
       cached_value->MatchesUncompressedCerts(uncompressed_certs)) {
+    // Pin the entry so the returned pointer survives a concurrent eviction.
+    last_lookup_ = cached_value;
     return cached_value->compressed_cert();
   }
   return nullptr;
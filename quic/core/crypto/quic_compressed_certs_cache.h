@@ -5,11 +5,12 @@
 #ifndef QUICHE_QUIC_CORE_CRYPTO_QUIC_COMPRESSED_CERTS_CACHE_H_
 #define QUICHE_QUIC_CORE_CRYPTO_QUIC_COMPRESSED_CERTS_CACHE_H_
 
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "quic/core/crypto/proof_source.h"
-#include "quic/core/quic_lru_cache.h"
+#include "quic/core/quic_striped_lru_cache.h"
 #include "quic/platform/api/quic_export.h"
 
 namespace quic {
@@ -99,8 +100,13 @@ class QUIC_EXPORT_PRIVATE QuicCompressedCertsCache {
 
   // Key is a unit64_t hash for UncompressedCerts. Stored associated value is
   // CachedCerts which has both original uncompressed certs data and the
-  // compressed representation of the certs.
-  QuicLRUCache<uint64_t, CachedCerts> certs_cache_;
+  // compressed representation of the certs. The underlying cache is safe to
+  // share across threads; this wrapper's raw-pointer accessors are not.
+  QuicStripedLRUCache<uint64_t, CachedCerts> certs_cache_;
+  // Pins the most recently looked-up entry so the pointer returned by
+  // GetCompressedCert() stays valid even if a concurrent user of the
+  // underlying cache evicts the entry.
+  std::shared_ptr<const CachedCerts> last_lookup_;
 };
 
 }  // namespace quic
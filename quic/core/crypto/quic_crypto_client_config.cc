@@ -799,6 +799,15 @@ ProofVerifier* QuicCryptoClientConfig::proof_verifier() const {
   return proof_verifier_.get();
 }
 
+ProofVerifier* QuicCryptoClientConfig::policy_verifier() const {
+  return policy_verifier_.get();
+}
+
+void QuicCryptoClientConfig::set_policy_verifier(
+    std::unique_ptr<ProofVerifier> policy_verifier) {
+  policy_verifier_ = std::move(policy_verifier);
+}
+
 SessionCache* QuicCryptoClientConfig::session_cache() const {
   return session_cache_.get();
 }
@@ -347,6 +347,19 @@ class QUIC_EXPORT_PRIVATE QuicCryptoClientConfig : public QuicCryptoConfig {
       std::string* error_details);
 
   ProofVerifier* proof_verifier() const;
+
+  // Opt-in staged certificate verification for TLS handshakes. When a policy
+  // verifier is set, |proof_verifier()| is expected to perform only the
+  // cryptographic chain validation, which stays on the handshake critical
+  // path, while |policy_verifier()| performs the remaining policy checks
+  // (e.g. CT log inclusion, revocation). The policy checks run concurrently
+  // with the rest of the handshake; if they fail after the handshake has
+  // proceeded, the connection is closed with QUIC_PROOF_INVALID. Callers
+  // must ensure the two verifiers together enforce the same policy as a
+  // single full verifier.
+  ProofVerifier* policy_verifier() const;
+  void set_policy_verifier(std::unique_ptr<ProofVerifier> policy_verifier);
+
   SessionCache* session_cache() const;
   ClientProofSource* proof_source() const;
   void set_proof_source(std::unique_ptr<ClientProofSource> proof_source);
@@ -442,6 +455,8 @@ class QUIC_EXPORT_PRIVATE QuicCryptoClientConfig : public QuicCryptoConfig {
   std::vector<std::string> canonical_suffixes_;
 
   std::unique_ptr<ProofVerifier> proof_verifier_;
+  // Optional verifier for deferred policy checks; see set_policy_verifier().
+  std::unique_ptr<ProofVerifier> policy_verifier_;
   std::unique_ptr<SessionCache> session_cache_;
   std::unique_ptr<ClientProofSource> proof_source_;
 
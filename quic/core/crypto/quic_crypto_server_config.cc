@@ -241,6 +241,9 @@ QuicCryptoServerConfig::QuicCryptoServerConfig(
       configs_lock_(),
       primary_config_(nullptr),
       next_config_promotion_time_(QuicWallTime::Zero()),
+      deferred_default_config_generation_(false),
+      deferred_config_rand_(nullptr),
+      deferred_config_clock_(nullptr),
       proof_source_(std::move(proof_source)),
       key_exchange_source_(std::move(key_exchange_source)),
       ssl_ctx_(TlsServerConnection::CreateSslCtx(proof_source_.get())),
@@ -412,6 +415,7 @@ std::unique_ptr<CryptoHandshakeMessage> QuicCryptoServerConfig::AddConfig(
     }
 
     configs_[config->id] = config;
+    deferred_default_config_generation_ = false;
     SelectNewPrimaryConfig(now);
     QUICHE_DCHECK(primary_config_.get());
     QUICHE_DCHECK_EQ(configs_.find(primary_config_->id)->second.get(),
@@ -428,6 +432,22 @@ QuicCryptoServerConfig::AddDefaultConfig(QuicRandom* rand,
   return AddConfig(GenerateConfig(rand, clock, options), clock->WallNow());
 }
 
+void QuicCryptoServerConfig::DeferDefaultConfigGeneration(
+    QuicRandom* rand,
+    const QuicClock* clock,
+    const ConfigOptions& options) {
+  QuicWriterMutexLock locked(&configs_lock_);
+  if (!configs_.empty()) {
+    QUIC_LOG(WARNING) << "Not deferring default config generation because "
+                         "configs have already been added";
+    return;
+  }
+  deferred_default_config_generation_ = true;
+  deferred_config_rand_ = rand;
+  deferred_config_clock_ = clock;
+  deferred_config_options_ = options;
+}
+
 bool QuicCryptoServerConfig::SetConfigs(
     const std::vector<QuicServerConfigProtobuf>& protobufs,
     const QuicServerConfigProtobuf* fallback_protobuf,
@@ -502,6 +522,7 @@ bool QuicCryptoServerConfig::SetConfigs(
 
   configs_ = std::move(new_configs);
   fallback_config_ = fallback_config;
+  deferred_default_config_generation_ = false;
   SelectNewPrimaryConfig(now);
   QUICHE_DCHECK(primary_config_.get());
   QUICHE_DCHECK_EQ(configs_.find(primary_config_->id)->second.get(),
@@ -1094,6 +1115,14 @@ bool QuicCryptoServerConfig::GetCurrentConfigs(
     Configs* configs) const {
   QuicReaderMutexLock locked(&configs_lock_);
 
+  if (deferred_default_config_generation_) {
+    configs_lock_.ReaderUnlock();
+    configs_lock_.WriterLock();
+    MaybeAddDeferredDefaultConfig(now);
+    configs_lock_.WriterUnlock();
+    configs_lock_.ReaderLock();
+  }
+
   if (!primary_config_) {
     return false;
   }
@@ -1120,6 +1149,33 @@ bool QuicCryptoServerConfig::GetCurrentConfigs(
   return true;
 }
 
+void QuicCryptoServerConfig::MaybeAddDeferredDefaultConfig(
+    QuicWallTime now) const {
+  if (!deferred_default_config_generation_) {
+    // Another thread generated the config between the reader unlock and the
+    // writer lock, or a config was added by other means.
+    return;
+  }
+  deferred_default_config_generation_ = false;
+
+  QuicReferenceCountedPointer<Config> config = ParseConfigProtobuf(
+      GenerateConfig(deferred_config_rand_, deferred_config_clock_,
+                     deferred_config_options_),
+      /* is_fallback = */ false);
+  if (!config || configs_.find(config->id) != configs_.end()) {
+    QUIC_LOG(WARNING) << "Failed to generate deferred default config";
+    return;
+  }
+
+  QUIC_LOG(INFO) << "Adding deferred default config with scid: "
+                 << absl::BytesToHexString(config->id);
+  configs_[config->id] = config;
+  SelectNewPrimaryConfig(now);
+  QUICHE_DCHECK(primary_config_.get());
+  QUICHE_DCHECK_EQ(configs_.find(primary_config_->id)->second.get(),
+                   primary_config_.get());
+}
+
 // ConfigPrimaryTimeLessThan is a comparator that implements "less than" for
 // Config's based on their primary_time.
 // static
@@ -246,6 +246,17 @@ class QUIC_EXPORT_PRIVATE QuicCryptoServerConfig {
       const QuicClock* clock,
       const ConfigOptions& options);
 
+  // DeferDefaultConfigGeneration records the arguments that AddDefaultConfig
+  // would use, but does not generate a config. The config is generated and
+  // added the first time a handshake needs it, which moves the expensive key
+  // generation in GenerateConfig off the server startup path. Does nothing if
+  // a config has already been added. The deferred generation is abandoned if
+  // another config is added before the first handshake. |rand| and |clock|
+  // must outlive this object.
+  void DeferDefaultConfigGeneration(QuicRandom* rand,
+                                    const QuicClock* clock,
+                                    const ConfigOptions& options);
+
   // SetConfigs takes a vector of config protobufs and the current time.
   // Configs are assumed to be uniquely identified by their server config ID.
   // Previously unknown configs are added and possibly made the primary config
@@ -566,6 +577,12 @@ class QUIC_EXPORT_PRIVATE QuicCryptoServerConfig {
   void SelectNewPrimaryConfig(QuicWallTime now) const
       QUIC_EXCLUSIVE_LOCKS_REQUIRED(configs_lock_);
 
+  // If DeferDefaultConfigGeneration was called and is still pending, generates
+  // the default config and adds it to |configs_|, making it primary.
+  // Otherwise, does nothing.
+  void MaybeAddDeferredDefaultConfig(QuicWallTime now) const
+      QUIC_EXCLUSIVE_LOCKS_REQUIRED(configs_lock_);
+
   // EvaluateClientHello checks |client_hello_state->client_hello| for gross
   // errors and determines whether it is fresh (i.e. not a replay). The results
   // are written to |client_hello_state->info|.
@@ -867,7 +884,7 @@ class QUIC_EXPORT_PRIVATE QuicCryptoServerConfig {
 
   // configs_ contains all active server configs. It's expected that there are
   // about half-a-dozen configs active at any one time.
-  ConfigMap configs_ QUIC_GUARDED_BY(configs_lock_);
+  mutable ConfigMap configs_ QUIC_GUARDED_BY(configs_lock_);
 
   // primary_config_ points to a Config (which is also in |configs_|) which is
   // the primary config - i.e. the one that we'll give out to new clients.
@@ -887,6 +904,16 @@ class QUIC_EXPORT_PRIVATE QuicCryptoServerConfig {
   mutable QuicWallTime next_config_promotion_time_
       QUIC_GUARDED_BY(configs_lock_);
 
+  // True while a call to DeferDefaultConfigGeneration is pending, i.e. the
+  // default config has not yet been generated and no other config has been
+  // added. The remaining deferred_config_* members hold the arguments that
+  // MaybeAddDeferredDefaultConfig will pass to GenerateConfig.
+  mutable bool deferred_default_config_generation_
+      QUIC_GUARDED_BY(configs_lock_);
+  QuicRandom* deferred_config_rand_ QUIC_GUARDED_BY(configs_lock_);
+  const QuicClock* deferred_config_clock_ QUIC_GUARDED_BY(configs_lock_);
+  ConfigOptions deferred_config_options_ QUIC_GUARDED_BY(configs_lock_);
+
   // Callback to invoke when the primary config changes.
   std::unique_ptr<PrimaryConfigChangedCallback> primary_config_changed_cb_
       QUIC_GUARDED_BY(configs_lock_);
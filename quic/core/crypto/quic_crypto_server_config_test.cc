@@ -60,6 +60,26 @@ TEST_F(QuicCryptoServerConfigTest, ServerConfig) {
   EXPECT_LE(1u, aead.size());
 }
 
+TEST_F(QuicCryptoServerConfigTest, DeferredDefaultConfigGeneration) {
+  QuicRandom* rand = QuicRandom::GetInstance();
+  QuicCryptoServerConfig server(QuicCryptoServerConfig::TESTING, rand,
+                                crypto_test_utils::ProofSourceForTesting(),
+                                KeyExchangeSource::Default());
+  MockClock clock;
+  QuicCryptoServerConfigPeer peer(&server);
+
+  server.DeferDefaultConfigGeneration(rand, &clock,
+                                      QuicCryptoServerConfig::ConfigOptions());
+  // No config is generated until one is needed.
+  peer.CheckConfigs(std::vector<std::pair<std::string, bool>>());
+
+  // The first handshake that looks up the current configs generates the
+  // default config and makes it primary.
+  EXPECT_TRUE(peer.GetCurrentConfigs(clock.WallNow()));
+  EXPECT_NE(nullptr, peer.GetPrimaryConfig());
+  EXPECT_EQ(1u, server.GetConfigIds().size());
+}
+
 TEST_F(QuicCryptoServerConfigTest, CompressCerts) {
   QuicCompressedCertsCache compressed_certs_cache(
       QuicCompressedCertsCache::kQuicCompressedCertsCacheSize);
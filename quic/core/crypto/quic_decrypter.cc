@@ -6,8 +6,10 @@
 
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "third_party/boringssl/src/include/openssl/tls1.h"
 #include "quic/core/crypto/aes_128_gcm_12_decrypter.h"
 #include "quic/core/crypto/aes_128_gcm_decrypter.h"
@@ -61,7 +63,17 @@ std::unique_ptr<QuicDecrypter> QuicDecrypter::CreateFromCipherSuite(
   }
 }
 
-// static
+std::vector<std::string> QuicDecrypter::GenerateHeaderProtectionMasks(
+    absl::Span<const absl::string_view> samples) {
+  std::vector<std::string> masks;
+  masks.reserve(samples.size());
+  for (const absl::string_view sample : samples) {
+    QuicDataReader sample_reader(sample.data(), sample.size());
+    masks.push_back(GenerateHeaderProtectionMask(&sample_reader));
+  }
+  return masks;
+}
+
 void QuicDecrypter::DiversifyPreliminaryKey(absl::string_view preliminary_key,
                                             absl::string_view nonce_prefix,
                                             const DiversificationNonce& nonce,
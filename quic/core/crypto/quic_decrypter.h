@@ -9,8 +9,10 @@
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "quic/core/crypto/quic_crypter.h"
 #include "quic/core/quic_data_reader.h"
 #include "quic/core/quic_packets.h"
@@ -18,6 +20,8 @@
 
 namespace quic {
 
+class AeadBaseDecrypter;
+
 class QUIC_EXPORT_PRIVATE QuicDecrypter : public QuicCrypter {
  public:
   virtual ~QuicDecrypter() {}
@@ -62,6 +66,13 @@ class QUIC_EXPORT_PRIVATE QuicDecrypter : public QuicCrypter {
                              size_t* output_length,
                              size_t max_output_length) = 0;
 
+  // Returns this decrypter as an AeadBaseDecrypter, or nullptr if it is not
+  // one. Since a connection's cipher is fixed once negotiated, the framer
+  // uses this to bind the concrete AEAD implementation and call its
+  // per-packet entry point directly, leaving the virtual interface for
+  // setup; see QuicFramer::DecryptPayload.
+  virtual AeadBaseDecrypter* AsAeadBaseDecrypter() { return nullptr; }
+
   // Reads a sample of ciphertext from |sample_reader| and uses the header
   // protection key to generate a mask to use for header protection. If
   // successful, this function returns this mask, which is at least 5 bytes
@@ -69,6 +80,17 @@ class QUIC_EXPORT_PRIVATE QuicDecrypter : public QuicCrypter {
   virtual std::string GenerateHeaderProtectionMask(
       QuicDataReader* sample_reader) = 0;
 
+  // Computes header protection masks for all of |samples| in one call, where
+  // each sample is the raw ciphertext sample of one packet. The returned
+  // vector has one entry per sample; entries corresponding to samples that
+  // were too short are empty strings. The default implementation loops over
+  // GenerateHeaderProtectionMask. Ciphers whose mask derivation is a single
+  // cheap block operation override this to process the whole batch in one
+  // pass, which avoids re-entering the cipher per packet when many packets
+  // are read from the socket at once.
+  virtual std::vector<std::string> GenerateHeaderProtectionMasks(
+      absl::Span<const absl::string_view> samples);
+
   // The ID of the cipher. Return 0x03000000 ORed with the 'cryptographic suite
   // selector'.
   virtual uint32_t cipher_id() const = 0;
@@ -81,6 +103,11 @@ class QUIC_EXPORT_PRIVATE QuicDecrypter : public QuicCrypter {
   virtual absl::string_view GetKey() const = 0;
   virtual absl::string_view GetNoncePrefix() const = 0;
 
+  // Exports the full IETF nonce construction IV, for transferring established
+  // keys to another process. Returns an empty view for crypters that do not
+  // use an IV.
+  virtual absl::string_view GetIV() const = 0;
+
   static void DiversifyPreliminaryKey(absl::string_view preliminary_key,
                                       absl::string_view nonce_prefix,
                                       const DiversificationNonce& nonce,
@@ -58,4 +58,16 @@ std::unique_ptr<QuicEncrypter> QuicEncrypter::CreateFromCipherSuite(
   }
 }
 
+bool QuicEncrypter::EncryptPacketBatch(
+    absl::Span<QuicPacketEncryptionTask> tasks) {
+  for (QuicPacketEncryptionTask& task : tasks) {
+    if (!EncryptPacket(task.packet_number, task.associated_data,
+                       task.plaintext, task.output, task.output_length,
+                       task.max_output_length)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 }  // namespace quic
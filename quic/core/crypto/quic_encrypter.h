@@ -9,12 +9,26 @@
 #include <memory>
 
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "quic/core/crypto/quic_crypter.h"
 #include "quic/core/quic_packets.h"
 #include "quic/platform/api/quic_export.h"
 
 namespace quic {
 
+class AeadBaseEncrypter;
+
+// One packet of a batch encryption request; see
+// QuicEncrypter::EncryptPacketBatch.
+struct QUIC_EXPORT_PRIVATE QuicPacketEncryptionTask {
+  uint64_t packet_number;
+  absl::string_view associated_data;
+  absl::string_view plaintext;
+  char* output;
+  size_t* output_length;
+  size_t max_output_length;
+};
+
 class QUIC_EXPORT_PRIVATE QuicEncrypter : public QuicCrypter {
  public:
   virtual ~QuicEncrypter() {}
@@ -42,6 +56,22 @@ class QUIC_EXPORT_PRIVATE QuicEncrypter : public QuicCrypter {
                              size_t* output_length,
                              size_t max_output_length) = 0;
 
+  // Returns this encrypter as an AeadBaseEncrypter, or nullptr if it is not
+  // one. Since a connection's cipher is fixed once negotiated, the framer
+  // uses this to bind the concrete AEAD implementation and call its
+  // per-packet entry point directly, leaving the virtual interface for
+  // setup; see QuicFramer::EncryptPayload.
+  virtual AeadBaseEncrypter* AsAeadBaseEncrypter() { return nullptr; }
+
+  // Encrypts several packets in one call, with the same semantics as calling
+  // EncryptPacket for each task in order. The default implementation does
+  // exactly that; encrypters backed by multi-buffer AEAD implementations can
+  // override it to interleave the per-packet block operations and keep the
+  // vector units full across packet boundaries. Returns false if any task
+  // fails, in which case that task's |output_length| is unspecified and no
+  // later task has been processed.
+  virtual bool EncryptPacketBatch(absl::Span<QuicPacketEncryptionTask> tasks);
+
   // Takes a |sample| of ciphertext and uses the header protection key to
   // generate a mask to use for header protection, and returns that mask. On
   // success, the mask will be at least 5 bytes long; on failure the string will
@@ -64,6 +94,11 @@ class QUIC_EXPORT_PRIVATE QuicEncrypter : public QuicCrypter {
   // For use by unit tests only.
   virtual absl::string_view GetKey() const = 0;
   virtual absl::string_view GetNoncePrefix() const = 0;
+
+  // Exports the full IETF nonce construction IV, for transferring established
+  // keys to another process. Returns an empty view for crypters that do not
+  // use an IV.
+  virtual absl::string_view GetIV() const = 0;
 };
 
 }  // namespace quic
@@ -0,0 +1,193 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/crypto/quic_retry_token_helper.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "third_party/boringssl/src/include/openssl/mem.h"
+#include "third_party/boringssl/src/include/openssl/siphash.h"
+#include "quic/core/crypto/quic_siphash_batch.h"
+#include "quic/platform/api/quic_logging.h"
+#include "common/quiche_endian.h"
+
+namespace quic {
+
+namespace {
+
+const size_t kExpiryOffset = 0;
+const size_t kConnectionIdLengthOffset = 8;
+const size_t kConnectionIdOffset = 9;
+const size_t kAuthenticatorOffset =
+    QuicRetryTokenHelper::kTokenLength - sizeof(uint64_t);
+const size_t kMaxEncodedConnectionIdLength =
+    kAuthenticatorOffset - kConnectionIdOffset;
+// Largest authenticator input: the token prefix plus a port and an IPv6
+// address.
+const size_t kAuthenticatorInputCapacity =
+    kAuthenticatorOffset + sizeof(uint16_t) + sizeof(in6_addr);
+
+}  // namespace
+
+QuicRetryTokenHelper::QuicRetryTokenHelper(QuicRandom* random) {
+  random->RandBytes(key_, sizeof(key_));
+}
+
+bool QuicRetryTokenHelper::GenerateToken(
+    const QuicSocketAddress& peer_address,
+    QuicConnectionId original_destination_connection_id,
+    QuicWallTime now,
+    QuicTime::Delta validity,
+    char* out) const {
+  if (original_destination_connection_id.length() >
+      kMaxEncodedConnectionIdLength) {
+    return false;
+  }
+
+  const uint64_t expiry = quiche::QuicheEndian::HostToNet64(
+      now.ToUNIXSeconds() + validity.ToSeconds());
+  memcpy(out + kExpiryOffset, &expiry, sizeof(expiry));
+  out[kConnectionIdLengthOffset] =
+      static_cast<char>(original_destination_connection_id.length());
+  memset(out + kConnectionIdOffset, 0, kMaxEncodedConnectionIdLength);
+  memcpy(out + kConnectionIdOffset,
+         original_destination_connection_id.data(),
+         original_destination_connection_id.length());
+
+  const uint64_t authenticator = ComputeAuthenticator(
+      absl::string_view(out, kAuthenticatorOffset), peer_address);
+  memcpy(out + kAuthenticatorOffset, &authenticator, sizeof(authenticator));
+  return true;
+}
+
+bool QuicRetryTokenHelper::ValidateToken(
+    absl::string_view token,
+    const QuicSocketAddress& peer_address,
+    QuicWallTime now,
+    QuicConnectionId* original_destination_connection_id) const {
+  if (token.length() != kTokenLength) {
+    return false;
+  }
+
+  // Check the authenticator before trusting any other field.
+  const uint64_t authenticator = ComputeAuthenticator(
+      token.substr(0, kAuthenticatorOffset), peer_address);
+  if (CRYPTO_memcmp(&authenticator, token.data() + kAuthenticatorOffset,
+                    sizeof(authenticator)) != 0) {
+    return false;
+  }
+
+  return CheckAuthenticatedToken(token, now,
+                                 original_destination_connection_id);
+}
+
+void QuicRetryTokenHelper::ValidateTokenBatch(
+    const std::vector<TokenCandidate>& candidates,
+    QuicWallTime now,
+    std::vector<TokenValidation>* results) const {
+  results->clear();
+  results->resize(candidates.size());
+  uint8_t inputs[kQuicSipHashBatchLanes][kAuthenticatorInputCapacity];
+  absl::string_view input_views[kQuicSipHashBatchLanes];
+  size_t lane_to_candidate[kQuicSipHashBatchLanes];
+  uint64_t digests[kQuicSipHashBatchLanes];
+  for (size_t begin = 0; begin < candidates.size();
+       begin += kQuicSipHashBatchLanes) {
+    // Fill the lanes, dropping malformed candidates on the floor: a token
+    // of the wrong length can never validate, so it is not worth a hash.
+    size_t num_lanes = 0;
+    const size_t end =
+        std::min(begin + kQuicSipHashBatchLanes, candidates.size());
+    for (size_t i = begin; i < end; ++i) {
+      const TokenCandidate& candidate = candidates[i];
+      if (candidate.token.length() != kTokenLength) {
+        continue;
+      }
+      const size_t input_length = BuildAuthenticatorInput(
+          candidate.token.substr(0, kAuthenticatorOffset),
+          candidate.peer_address, inputs[num_lanes]);
+      input_views[num_lanes] = absl::string_view(
+          reinterpret_cast<const char*>(inputs[num_lanes]), input_length);
+      lane_to_candidate[num_lanes] = i;
+      ++num_lanes;
+    }
+    QuicSipHash24Batch(key_, input_views, num_lanes, digests);
+    for (size_t lane = 0; lane < num_lanes; ++lane) {
+      const size_t i = lane_to_candidate[lane];
+      if (CRYPTO_memcmp(&digests[lane],
+                        candidates[i].token.data() + kAuthenticatorOffset,
+                        sizeof(digests[lane])) != 0) {
+        continue;
+      }
+      (*results)[i].valid = CheckAuthenticatedToken(
+          candidates[i].token, now,
+          &(*results)[i].original_destination_connection_id);
+    }
+  }
+}
+
+// static
+bool QuicRetryTokenHelper::CheckAuthenticatedToken(
+    absl::string_view token,
+    QuicWallTime now,
+    QuicConnectionId* original_destination_connection_id) {
+  uint64_t expiry;
+  memcpy(&expiry, token.data() + kExpiryOffset, sizeof(expiry));
+  if (QuicWallTime::FromUNIXSeconds(quiche::QuicheEndian::NetToHost64(expiry))
+          .IsBefore(now)) {
+    return false;
+  }
+
+  const uint8_t connection_id_length =
+      static_cast<uint8_t>(token[kConnectionIdLengthOffset]);
+  if (connection_id_length > kMaxEncodedConnectionIdLength) {
+    return false;
+  }
+  *original_destination_connection_id =
+      QuicConnectionId(token.data() + kConnectionIdOffset,
+                       connection_id_length);
+  return true;
+}
+
+uint64_t QuicRetryTokenHelper::ComputeAuthenticator(
+    absl::string_view token_prefix,
+    const QuicSocketAddress& peer_address) const {
+  uint8_t input[kAuthenticatorInputCapacity];
+  const size_t input_length =
+      BuildAuthenticatorInput(token_prefix, peer_address, input);
+  return SIPHASH_24(key_, input, input_length);
+}
+
+// static
+size_t QuicRetryTokenHelper::BuildAuthenticatorInput(
+    absl::string_view token_prefix,
+    const QuicSocketAddress& peer_address,
+    uint8_t* input) {
+  // Normalize so that a token issued to an IPv4-mapped IPv6 address
+  // validates against the equivalent IPv4 address on a dual-stack socket.
+  const QuicSocketAddress normalized = peer_address.Normalized();
+
+  memcpy(input, token_prefix.data(), token_prefix.length());
+  size_t input_length = token_prefix.length();
+
+  const uint16_t port = normalized.port();
+  memcpy(input + input_length, &port, sizeof(port));
+  input_length += sizeof(port);
+
+  const QuicIpAddress host = normalized.host();
+  if (host.IsIPv4()) {
+    const in_addr address = host.GetIPv4();
+    memcpy(input + input_length, &address, sizeof(address));
+    input_length += sizeof(address);
+  } else if (host.IsIPv6()) {
+    const in6_addr address = host.GetIPv6();
+    memcpy(input + input_length, &address, sizeof(address));
+    input_length += sizeof(address);
+  }
+
+  return input_length;
+}
+
+}  // namespace quic
@@ -0,0 +1,113 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_CRYPTO_QUIC_RETRY_TOKEN_HELPER_H_
+#define QUICHE_QUIC_CORE_CRYPTO_QUIC_RETRY_TOKEN_HELPER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "quic/core/crypto/quic_random.h"
+#include "quic/core/quic_connection_id.h"
+#include "quic/core/quic_time.h"
+#include "quic/platform/api/quic_export.h"
+#include "quic/platform/api/quic_socket_address.h"
+
+namespace quic {
+
+// Generates and validates stateless address validation tokens for RETRY
+// packets.  Tokens are authenticated with a per-process SipHash-2-4 key and
+// carry the original destination connection ID and an expiry time, so a
+// server can confirm a client address and recover the original connection ID
+// without keeping any per-connection state.  Both operations work entirely
+// on caller-provided and stack buffers and perform no heap allocation, which
+// makes them safe to run for every Initial packet during an address spoofing
+// flood.
+class QUIC_EXPORT_PRIVATE QuicRetryTokenHelper {
+ public:
+  // Token wire layout (kTokenLength bytes):
+  //   8 bytes  expiry, seconds since the UNIX epoch, big endian
+  //   1 byte   length of the original destination connection ID
+  //  20 bytes  original destination connection ID, zero padded
+  //   8 bytes  SipHash-2-4 of the preceding fields and the client address
+  static constexpr size_t kTokenLength = 8 + 1 + 20 + 8;
+
+  // Draws a fresh key from |random|.  Tokens do not survive process
+  // restarts; a client presenting a stale token simply fails validation and
+  // pays another round trip.
+  explicit QuicRetryTokenHelper(QuicRandom* random);
+  QuicRetryTokenHelper(const QuicRetryTokenHelper&) = delete;
+  QuicRetryTokenHelper& operator=(const QuicRetryTokenHelper&) = delete;
+
+  // Writes a token for |peer_address| into |out|, which must have room for
+  // kTokenLength bytes.  The token expires |validity| after |now|.  Returns
+  // false if |original_destination_connection_id| is too long to encode.
+  bool GenerateToken(const QuicSocketAddress& peer_address,
+                     QuicConnectionId original_destination_connection_id,
+                     QuicWallTime now,
+                     QuicTime::Delta validity,
+                     char* out) const;
+
+  // Returns true if |token| was issued by this helper for |peer_address| and
+  // has not expired, and sets |*original_destination_connection_id| to the
+  // connection ID the token was issued for.  The authenticator comparison is
+  // constant time.
+  bool ValidateToken(
+      absl::string_view token,
+      const QuicSocketAddress& peer_address,
+      QuicWallTime now,
+      QuicConnectionId* original_destination_connection_id) const;
+
+  // One token to be checked by ValidateTokenBatch(), paired with the
+  // address the packet carrying it arrived from.
+  struct QUIC_EXPORT_PRIVATE TokenCandidate {
+    absl::string_view token;
+    QuicSocketAddress peer_address;
+  };
+
+  // Outcome of validating one candidate.
+  struct QUIC_EXPORT_PRIVATE TokenValidation {
+    bool valid = false;
+    QuicConnectionId original_destination_connection_id;
+  };
+
+  // Validates a batch of candidate tokens, e.g. gathered from one
+  // recvmmsg() burst. Equivalent to calling ValidateToken() on each
+  // candidate, but the authenticators are computed with the multi-lane
+  // SipHash kernel so independent hashes pipeline against each other,
+  // which matters when a reflection attack makes the server reject
+  // millions of forged tokens per second. |results| is resized to match
+  // |candidates|, index for index.
+  void ValidateTokenBatch(const std::vector<TokenCandidate>& candidates,
+                          QuicWallTime now,
+                          std::vector<TokenValidation>* results) const;
+
+ private:
+  // Computes the SipHash-2-4 authenticator over |token_prefix| (the token
+  // minus its final 8 bytes) and the normalized peer address.
+  uint64_t ComputeAuthenticator(absl::string_view token_prefix,
+                                const QuicSocketAddress& peer_address) const;
+
+  // Assembles the authenticator input (|token_prefix| followed by the
+  // normalized peer address) into |input|, which must have room for
+  // kAuthenticatorInputCapacity bytes, and returns the bytes written.
+  static size_t BuildAuthenticatorInput(absl::string_view token_prefix,
+                                        const QuicSocketAddress& peer_address,
+                                        uint8_t* input);
+
+  // Checks the expiry and connection ID fields of a token whose
+  // authenticator has already been verified.
+  static bool CheckAuthenticatedToken(
+      absl::string_view token,
+      QuicWallTime now,
+      QuicConnectionId* original_destination_connection_id);
+
+  uint64_t key_[2];
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_CRYPTO_QUIC_RETRY_TOKEN_HELPER_H_
@@ -0,0 +1,188 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/crypto/quic_retry_token_helper.h"
+
+#include <string>
+#include <vector>
+
+#include "quic/core/crypto/quic_siphash_batch.h"
+#include "quic/platform/api/quic_ip_address.h"
+#include "quic/platform/api/quic_test.h"
+#include "quic/test_tools/quic_test_utils.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+class QuicRetryTokenHelperTest : public QuicTest {
+ protected:
+  QuicRetryTokenHelperTest()
+      : helper_(QuicRandom::GetInstance()),
+        peer_address_(QuicIpAddress::Loopback4(), 443),
+        now_(QuicWallTime::FromUNIXSeconds(1000000)),
+        validity_(QuicTime::Delta::FromSeconds(30)) {}
+
+  std::string GenerateToken(const QuicSocketAddress& peer_address,
+                            QuicConnectionId connection_id) {
+    char token[QuicRetryTokenHelper::kTokenLength];
+    EXPECT_TRUE(helper_.GenerateToken(peer_address, connection_id, now_,
+                                      validity_, token));
+    return std::string(token, sizeof(token));
+  }
+
+  QuicRetryTokenHelper helper_;
+  QuicSocketAddress peer_address_;
+  QuicWallTime now_;
+  QuicTime::Delta validity_;
+};
+
+TEST_F(QuicRetryTokenHelperTest, RoundTrip) {
+  const QuicConnectionId connection_id = TestConnectionId(0x1337);
+  std::string token = GenerateToken(peer_address_, connection_id);
+  EXPECT_EQ(QuicRetryTokenHelper::kTokenLength, token.length());
+
+  QuicConnectionId original_destination_connection_id;
+  EXPECT_TRUE(helper_.ValidateToken(token, peer_address_, now_,
+                                    &original_destination_connection_id));
+  EXPECT_EQ(connection_id, original_destination_connection_id);
+}
+
+TEST_F(QuicRetryTokenHelperTest, RejectsWrongAddress) {
+  std::string token = GenerateToken(peer_address_, TestConnectionId(1));
+
+  QuicConnectionId connection_id;
+  QuicSocketAddress different_port(peer_address_.host(), 444);
+  EXPECT_FALSE(
+      helper_.ValidateToken(token, different_port, now_, &connection_id));
+
+  QuicSocketAddress different_host(QuicIpAddress::Loopback6(),
+                                   peer_address_.port());
+  EXPECT_FALSE(
+      helper_.ValidateToken(token, different_host, now_, &connection_id));
+}
+
+TEST_F(QuicRetryTokenHelperTest, RejectsExpiredToken) {
+  std::string token = GenerateToken(peer_address_, TestConnectionId(1));
+
+  QuicConnectionId connection_id;
+  EXPECT_TRUE(helper_.ValidateToken(
+      token, peer_address_,
+      QuicWallTime::FromUNIXSeconds(now_.ToUNIXSeconds() + 29),
+      &connection_id));
+  EXPECT_FALSE(helper_.ValidateToken(
+      token, peer_address_,
+      QuicWallTime::FromUNIXSeconds(now_.ToUNIXSeconds() + 31),
+      &connection_id));
+}
+
+TEST_F(QuicRetryTokenHelperTest, RejectsCorruptToken) {
+  std::string token = GenerateToken(peer_address_, TestConnectionId(1));
+
+  QuicConnectionId connection_id;
+  for (size_t i = 0; i < token.length(); ++i) {
+    std::string corrupt_token = token;
+    corrupt_token[i] ^= 0x01;
+    EXPECT_FALSE(helper_.ValidateToken(corrupt_token, peer_address_, now_,
+                                       &connection_id))
+        << "Token with byte " << i << " corrupted unexpectedly validated";
+  }
+
+  EXPECT_FALSE(helper_.ValidateToken(token.substr(0, token.length() - 1),
+                                     peer_address_, now_, &connection_id));
+  EXPECT_FALSE(
+      helper_.ValidateToken(token + 'x', peer_address_, now_, &connection_id));
+  EXPECT_FALSE(helper_.ValidateToken("", peer_address_, now_, &connection_id));
+}
+
+TEST_F(QuicRetryTokenHelperTest, RejectsTokenFromOtherKey) {
+  std::string token = GenerateToken(peer_address_, TestConnectionId(1));
+
+  QuicRetryTokenHelper other_helper(QuicRandom::GetInstance());
+  QuicConnectionId connection_id;
+  EXPECT_FALSE(
+      other_helper.ValidateToken(token, peer_address_, now_, &connection_id));
+}
+
+TEST_F(QuicRetryTokenHelperTest, BatchValidationMatchesSingleValidation) {
+  QuicSocketAddress other_address(QuicIpAddress::Loopback6(), 4433);
+  std::string valid = GenerateToken(peer_address_, TestConnectionId(1));
+  std::string valid_v6 = GenerateToken(other_address, TestConnectionId(2));
+  std::string corrupt = valid;
+  corrupt[0] ^= 0x01;
+  std::string truncated = valid.substr(0, valid.length() - 1);
+
+  std::vector<QuicRetryTokenHelper::TokenCandidate> candidates = {
+      {valid, peer_address_},
+      {valid_v6, other_address},
+      {corrupt, peer_address_},
+      {truncated, peer_address_},
+      {valid_v6, peer_address_},  // Right token, wrong address.
+  };
+  std::vector<QuicRetryTokenHelper::TokenValidation> results;
+  helper_.ValidateTokenBatch(candidates, now_, &results);
+
+  ASSERT_EQ(candidates.size(), results.size());
+  for (size_t i = 0; i < candidates.size(); ++i) {
+    QuicConnectionId connection_id;
+    EXPECT_EQ(helper_.ValidateToken(candidates[i].token,
+                                    candidates[i].peer_address, now_,
+                                    &connection_id),
+              results[i].valid)
+        << "candidate " << i;
+  }
+  EXPECT_TRUE(results[0].valid);
+  EXPECT_EQ(TestConnectionId(1), results[0].original_destination_connection_id);
+  EXPECT_TRUE(results[1].valid);
+  EXPECT_EQ(TestConnectionId(2), results[1].original_destination_connection_id);
+  EXPECT_FALSE(results[2].valid);
+  EXPECT_FALSE(results[3].valid);
+  EXPECT_FALSE(results[4].valid);
+}
+
+TEST_F(QuicRetryTokenHelperTest, BatchValidationLargerThanOneLaneGroup) {
+  std::vector<std::string> tokens;
+  std::vector<QuicRetryTokenHelper::TokenCandidate> candidates;
+  const size_t num_candidates = 3 * kQuicSipHashBatchLanes + 1;
+  for (size_t i = 0; i < num_candidates; ++i) {
+    tokens.push_back(GenerateToken(peer_address_, TestConnectionId(i)));
+    if (i % 2 == 1) {
+      tokens.back()[i % QuicRetryTokenHelper::kTokenLength] ^= 0x01;
+    }
+  }
+  for (const std::string& token : tokens) {
+    candidates.push_back({token, peer_address_});
+  }
+
+  std::vector<QuicRetryTokenHelper::TokenValidation> results;
+  helper_.ValidateTokenBatch(candidates, now_, &results);
+
+  ASSERT_EQ(num_candidates, results.size());
+  for (size_t i = 0; i < num_candidates; ++i) {
+    EXPECT_EQ(i % 2 == 0, results[i].valid) << "candidate " << i;
+    if (results[i].valid) {
+      EXPECT_EQ(TestConnectionId(i),
+                results[i].original_destination_connection_id);
+    }
+  }
+}
+
+TEST_F(QuicRetryTokenHelperTest, BatchValidationEmptyBatch) {
+  std::vector<QuicRetryTokenHelper::TokenValidation> results(3);
+  helper_.ValidateTokenBatch({}, now_, &results);
+  EXPECT_TRUE(results.empty());
+}
+
+TEST_F(QuicRetryTokenHelperTest, EmptyConnectionId) {
+  std::string token = GenerateToken(peer_address_, EmptyQuicConnectionId());
+
+  QuicConnectionId connection_id = TestConnectionId(1);
+  EXPECT_TRUE(
+      helper_.ValidateToken(token, peer_address_, now_, &connection_id));
+  EXPECT_TRUE(connection_id.IsEmpty());
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
@@ -0,0 +1,134 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/crypto/quic_siphash_batch.h"
+
+#include "quic/platform/api/quic_logging.h"
+
+namespace quic {
+
+namespace {
+
+inline uint64_t RotateLeft(uint64_t value, int bits) {
+  return (value << bits) | (value >> (64 - bits));
+}
+
+inline void SipRound(uint64_t& v0, uint64_t& v1, uint64_t& v2, uint64_t& v3) {
+  v0 += v1;
+  v1 = RotateLeft(v1, 13);
+  v1 ^= v0;
+  v0 = RotateLeft(v0, 32);
+  v2 += v3;
+  v3 = RotateLeft(v3, 16);
+  v3 ^= v2;
+  v0 += v3;
+  v3 = RotateLeft(v3, 21);
+  v3 ^= v0;
+  v2 += v1;
+  v1 = RotateLeft(v1, 17);
+  v1 ^= v2;
+  v2 = RotateLeft(v2, 32);
+}
+
+// Loads |count| (at most 8) bytes as a little-endian word, as SipHash
+// specifies; on little-endian hosts the full-word case compiles to a
+// single load.
+inline uint64_t LoadLittleEndian(const uint8_t* data, size_t count) {
+  uint64_t word = 0;
+  for (size_t i = 0; i < count; ++i) {
+    word |= static_cast<uint64_t>(data[i]) << (8 * i);
+  }
+  return word;
+}
+
+}  // namespace
+
+void QuicSipHash24Batch(const uint64_t key[2],
+                        const absl::string_view* inputs,
+                        size_t num_inputs,
+                        uint64_t* digests) {
+  QUICHE_DCHECK_LE(num_inputs, kQuicSipHashBatchLanes);
+
+  uint64_t v0[kQuicSipHashBatchLanes];
+  uint64_t v1[kQuicSipHashBatchLanes];
+  uint64_t v2[kQuicSipHashBatchLanes];
+  uint64_t v3[kQuicSipHashBatchLanes];
+  size_t num_blocks[kQuicSipHashBatchLanes];
+  size_t max_blocks = 0;
+  for (size_t lane = 0; lane < num_inputs; ++lane) {
+    v0[lane] = key[0] ^ UINT64_C(0x736f6d6570736575);
+    v1[lane] = key[1] ^ UINT64_C(0x646f72616e646f6d);
+    v2[lane] = key[0] ^ UINT64_C(0x6c7967656e657261);
+    v3[lane] = key[1] ^ UINT64_C(0x7465646279746573);
+    num_blocks[lane] = inputs[lane].length() / sizeof(uint64_t);
+    if (num_blocks[lane] > max_blocks) {
+      max_blocks = num_blocks[lane];
+    }
+  }
+
+  // Whole 8-byte blocks. Lanes whose message has run out of whole blocks
+  // simply sit the round out; candidate tokens are close to equal length,
+  // so in practice every lane stays busy until the end.
+  uint64_t message[kQuicSipHashBatchLanes];
+  for (size_t block = 0; block < max_blocks; ++block) {
+    for (size_t lane = 0; lane < num_inputs; ++lane) {
+      if (block >= num_blocks[lane]) {
+        continue;
+      }
+      message[lane] = LoadLittleEndian(
+          reinterpret_cast<const uint8_t*>(inputs[lane].data()) +
+              block * sizeof(uint64_t),
+          sizeof(uint64_t));
+      v3[lane] ^= message[lane];
+    }
+    for (int round = 0; round < 2; ++round) {
+      for (size_t lane = 0; lane < num_inputs; ++lane) {
+        if (block >= num_blocks[lane]) {
+          continue;
+        }
+        SipRound(v0[lane], v1[lane], v2[lane], v3[lane]);
+      }
+    }
+    for (size_t lane = 0; lane < num_inputs; ++lane) {
+      if (block >= num_blocks[lane]) {
+        continue;
+      }
+      v0[lane] ^= message[lane];
+    }
+  }
+
+  // Final block: the trailing bytes with the low byte of the length in the
+  // most significant position. Every lane has exactly one, so no lane
+  // skips apply from here on.
+  for (size_t lane = 0; lane < num_inputs; ++lane) {
+    const size_t length = inputs[lane].length();
+    message[lane] = LoadLittleEndian(
+        reinterpret_cast<const uint8_t*>(inputs[lane].data()) +
+            num_blocks[lane] * sizeof(uint64_t),
+        length % sizeof(uint64_t));
+    message[lane] |= static_cast<uint64_t>(length & 0xff) << 56;
+    v3[lane] ^= message[lane];
+  }
+  for (int round = 0; round < 2; ++round) {
+    for (size_t lane = 0; lane < num_inputs; ++lane) {
+      SipRound(v0[lane], v1[lane], v2[lane], v3[lane]);
+    }
+  }
+  for (size_t lane = 0; lane < num_inputs; ++lane) {
+    v0[lane] ^= message[lane];
+    v2[lane] ^= 0xff;
+  }
+
+  // Finalization.
+  for (int round = 0; round < 4; ++round) {
+    for (size_t lane = 0; lane < num_inputs; ++lane) {
+      SipRound(v0[lane], v1[lane], v2[lane], v3[lane]);
+    }
+  }
+  for (size_t lane = 0; lane < num_inputs; ++lane) {
+    digests[lane] = v0[lane] ^ v1[lane] ^ v2[lane] ^ v3[lane];
+  }
+}
+
+}  // namespace quic
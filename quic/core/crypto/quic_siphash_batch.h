@@ -0,0 +1,36 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_CRYPTO_QUIC_SIPHASH_BATCH_H_
+#define QUICHE_QUIC_CORE_CRYPTO_QUIC_SIPHASH_BATCH_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "absl/strings/string_view.h"
+#include "quic/platform/api/quic_export.h"
+
+namespace quic {
+
+// Number of messages hashed concurrently by QuicSipHash24Batch.
+constexpr size_t kQuicSipHashBatchLanes = 8;
+
+// Computes SipHash-2-4 of up to kQuicSipHashBatchLanes messages under a
+// single key, writing one digest per message to |digests|. Produces the
+// same digests as SIPHASH_24() from BoringSSL.
+//
+// The lane states advance in lock step: each compression round runs across
+// every lane before the next round starts, so independent lanes pipeline
+// against each other instead of serializing on one message's add-rotate-xor
+// dependency chain. This is what makes validating a batch of candidate
+// tokens (e.g. gathered from one recvmmsg() burst during an address
+// spoofing flood) substantially cheaper than hashing them one at a time.
+QUIC_EXPORT_PRIVATE void QuicSipHash24Batch(const uint64_t key[2],
+                                            const absl::string_view* inputs,
+                                            size_t num_inputs,
+                                            uint64_t* digests);
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_CRYPTO_QUIC_SIPHASH_BATCH_H_
@@ -0,0 +1,76 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/crypto/quic_siphash_batch.h"
+
+#include <string>
+#include <vector>
+
+#include "third_party/boringssl/src/include/openssl/siphash.h"
+#include "quic/core/crypto/quic_random.h"
+#include "quic/platform/api/quic_test.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+class QuicSipHashBatchTest : public QuicTest {
+ protected:
+  QuicSipHashBatchTest() {
+    QuicRandom::GetInstance()->RandBytes(key_, sizeof(key_));
+  }
+
+  uint64_t ReferenceHash(absl::string_view input) {
+    return SIPHASH_24(key_,
+                      reinterpret_cast<const uint8_t*>(input.data()),
+                      input.length());
+  }
+
+  uint64_t key_[2];
+};
+
+TEST_F(QuicSipHashBatchTest, MatchesBoringSslAcrossLengths) {
+  // Cover every final-block length and multiple whole blocks, including
+  // the empty message.
+  std::string message;
+  for (size_t length = 0; length <= 64; ++length) {
+    absl::string_view input(message);
+    uint64_t digest;
+    QuicSipHash24Batch(key_, &input, 1, &digest);
+    EXPECT_EQ(ReferenceHash(message), digest) << "length " << length;
+    message.push_back(static_cast<char>(length * 31));
+  }
+}
+
+TEST_F(QuicSipHashBatchTest, MatchesBoringSslAcrossLaneCounts) {
+  std::vector<std::string> messages;
+  std::vector<absl::string_view> inputs;
+  for (size_t num_lanes = 1; num_lanes <= kQuicSipHashBatchLanes;
+       ++num_lanes) {
+    messages.clear();
+    inputs.clear();
+    for (size_t lane = 0; lane < num_lanes; ++lane) {
+      // Different lengths per lane so some lanes run out of whole blocks
+      // before others.
+      messages.push_back(std::string(3 * lane + 1, static_cast<char>(lane)));
+      inputs.push_back(messages.back());
+    }
+    uint64_t digests[kQuicSipHashBatchLanes];
+    QuicSipHash24Batch(key_, inputs.data(), num_lanes, digests);
+    for (size_t lane = 0; lane < num_lanes; ++lane) {
+      EXPECT_EQ(ReferenceHash(messages[lane]), digests[lane])
+          << "lanes " << num_lanes << " lane " << lane;
+    }
+  }
+}
+
+TEST_F(QuicSipHashBatchTest, ZeroLanesWritesNothing) {
+  uint64_t digest = 0x1234;
+  QuicSipHash24Batch(key_, nullptr, 0, &digest);
+  EXPECT_EQ(0x1234u, digest);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
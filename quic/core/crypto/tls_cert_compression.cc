@@ -0,0 +1,437 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/crypto/tls_cert_compression.h"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/strings/string_view.h"
+#include "third_party/boringssl/src/include/openssl/bytestring.h"
+#include "third_party/boringssl/src/include/openssl/pool.h"
+#include "third_party/zlib/zlib.h"
+#include "quic/core/quic_lru_cache.h"
+#include "quic/core/quic_utils.h"
+#include "quic/platform/api/quic_logging.h"
+#include "quic/platform/api/quic_mutex.h"
+
+namespace quic {
+namespace {
+
+// A server typically serves a small number of distinct chains, one per
+// configured certificate.
+const size_t kCompressedCertCacheCapacity = 32;
+
+struct CompressedCertEntry {
+  // The uncompressed Certificate message, kept to rule out serving a blob for
+  // a colliding hash.
+  std::string uncompressed;
+  std::string compressed;
+  uint16_t algorithm_id;
+};
+
+// The built-in RFC 8879 zlib backend.
+class ZlibCertCompressionBackend : public CertCompressionBackend {
+ public:
+  static ZlibCertCompressionBackend* GetInstance() {
+    static ZlibCertCompressionBackend* backend =
+        new ZlibCertCompressionBackend();
+    return backend;
+  }
+
+  uint16_t algorithm_id() const override {
+    return kZlibCertCompressionAlgorithm;
+  }
+
+  bool Compress(absl::string_view in, std::string* out) override {
+    uLongf compressed_size = compressBound(in.size());
+    out->resize(compressed_size);
+    const int rv =
+        compress2(reinterpret_cast<Bytef*>(&(*out)[0]), &compressed_size,
+                  reinterpret_cast<const Bytef*>(in.data()), in.size(),
+                  Z_DEFAULT_COMPRESSION);
+    if (rv != Z_OK) {
+      QUIC_LOG(WARNING) << "zlib certificate compression failed: " << rv;
+      return false;
+    }
+    out->resize(compressed_size);
+    return true;
+  }
+
+  bool Decompress(absl::string_view in, uint8_t* out,
+                  size_t uncompressed_len) override {
+    uLongf actual_len = uncompressed_len;
+    const int rv =
+        uncompress(out, &actual_len, reinterpret_cast<const Bytef*>(in.data()),
+                   in.size());
+    if (rv != Z_OK || actual_len != uncompressed_len) {
+      QUIC_DLOG(WARNING) << "zlib certificate decompression failed: " << rv;
+      return false;
+    }
+    return true;
+  }
+};
+
+// zlib with a preset dictionary, registered under a private-use codepoint
+// because the RFC 8879 zlib algorithm has no dictionary. The dictionary is
+// trained offline and must be identical on both endpoints.
+class DictionaryZlibCertCompressionBackend : public CertCompressionBackend {
+ public:
+  explicit DictionaryZlibCertCompressionBackend(std::string dictionary)
+      : dictionary_(std::move(dictionary)) {}
+
+  uint16_t algorithm_id() const override {
+    return kDictionaryZlibCertCompressionAlgorithm;
+  }
+
+  bool Compress(absl::string_view in, std::string* out) override {
+    z_stream z;
+    memset(&z, 0, sizeof(z));
+    if (deflateInit(&z, Z_DEFAULT_COMPRESSION) != Z_OK) {
+      return false;
+    }
+    if (deflateSetDictionary(
+            &z, reinterpret_cast<const Bytef*>(dictionary_.data()),
+            dictionary_.size()) != Z_OK) {
+      deflateEnd(&z);
+      return false;
+    }
+    out->resize(deflateBound(&z, in.size()));
+    z.next_in = const_cast<Bytef*>(reinterpret_cast<const Bytef*>(in.data()));
+    z.avail_in = in.size();
+    z.next_out = reinterpret_cast<Bytef*>(&(*out)[0]);
+    z.avail_out = out->size();
+    const int rv = deflate(&z, Z_FINISH);
+    const size_t compressed_size = out->size() - z.avail_out;
+    deflateEnd(&z);
+    if (rv != Z_STREAM_END) {
+      QUIC_LOG(WARNING) << "dictionary zlib certificate compression failed: "
+                        << rv;
+      return false;
+    }
+    out->resize(compressed_size);
+    return true;
+  }
+
+  bool Decompress(absl::string_view in, uint8_t* out,
+                  size_t uncompressed_len) override {
+    z_stream z;
+    memset(&z, 0, sizeof(z));
+    if (inflateInit(&z) != Z_OK) {
+      return false;
+    }
+    z.next_in = const_cast<Bytef*>(reinterpret_cast<const Bytef*>(in.data()));
+    z.avail_in = in.size();
+    z.next_out = out;
+    z.avail_out = uncompressed_len;
+    int rv = inflate(&z, Z_FINISH);
+    if (rv == Z_NEED_DICT) {
+      if (inflateSetDictionary(
+              &z, reinterpret_cast<const Bytef*>(dictionary_.data()),
+              dictionary_.size()) != Z_OK) {
+        inflateEnd(&z);
+        return false;
+      }
+      rv = inflate(&z, Z_FINISH);
+    }
+    const bool ok = rv == Z_STREAM_END && z.avail_out == 0 && z.avail_in == 0;
+    inflateEnd(&z);
+    if (!ok) {
+      QUIC_DLOG(WARNING) << "dictionary zlib certificate decompression "
+                            "failed: "
+                         << rv;
+    }
+    return ok;
+  }
+
+ private:
+  const std::string dictionary_;
+};
+
+// Registered backends live in fixed slots so that each can be bound to its
+// own pair of BoringSSL callbacks; BoringSSL does not pass registration
+// context to them. Slots are write-once: backends are never unregistered
+// because SSL contexts keep the callback pointers for their lifetime.
+const size_t kMaxCertCompressionBackends = 4;
+
+class CertCompressionBackendRegistry {
+ public:
+  static CertCompressionBackendRegistry* GetInstance() {
+    static CertCompressionBackendRegistry* registry =
+        new CertCompressionBackendRegistry();
+    return registry;
+  }
+
+  bool Register(std::unique_ptr<CertCompressionBackend> backend) {
+    if (backend == nullptr ||
+        backend->algorithm_id() == kZlibCertCompressionAlgorithm) {
+      return false;
+    }
+    QuicWriterMutexLock lock(&mu_);
+    if (num_backends_ == kMaxCertCompressionBackends) {
+      QUIC_LOG(WARNING) << "Certificate compression backend table is full";
+      return false;
+    }
+    for (size_t i = 0; i < num_backends_; ++i) {
+      if (slots_[i]->algorithm_id() == backend->algorithm_id()) {
+        return false;
+      }
+    }
+    slots_[num_backends_++] = std::move(backend);
+    return true;
+  }
+
+  // Returns the backend in |slot|, or nullptr. The returned pointer is
+  // stable: slots are write-once.
+  CertCompressionBackend* GetSlot(size_t slot) {
+    QuicReaderMutexLock lock(&mu_);
+    return slot < num_backends_ ? slots_[slot].get() : nullptr;
+  }
+
+  CertCompressionBackend* Find(uint16_t algorithm_id) {
+    QuicReaderMutexLock lock(&mu_);
+    for (size_t i = 0; i < num_backends_; ++i) {
+      if (slots_[i]->algorithm_id() == algorithm_id) {
+        return slots_[i].get();
+      }
+    }
+    return nullptr;
+  }
+
+  size_t num_backends() {
+    QuicReaderMutexLock lock(&mu_);
+    return num_backends_;
+  }
+
+ private:
+  CertCompressionBackendRegistry() = default;
+
+  QuicMutex mu_;
+  std::unique_ptr<CertCompressionBackend>
+      slots_[kMaxCertCompressionBackends] QUIC_GUARDED_BY(mu_);
+  size_t num_backends_ QUIC_GUARDED_BY(mu_) = 0;
+};
+
+// Process-wide memoization of compressed Certificate messages, shared by all
+// SSL contexts. Guarded by a mutex because handshakes may run on multiple
+// threads; values are copied out under the lock.
+class CompressedCertCache {
+ public:
+  static CompressedCertCache* GetInstance() {
+    static CompressedCertCache* cache = new CompressedCertCache();
+    return cache;
+  }
+
+  // Returns the form of |msg| compressed with |backend|, compressing and
+  // memoizing it on a miss. Returns an empty string if compression fails.
+  std::string GetOrCompress(absl::string_view msg,
+                            CertCompressionBackend* backend) {
+    const uint16_t algorithm_id = backend->algorithm_id();
+    const uint64_t key = QuicUtils::FNV1a_64_Hash(msg) ^ algorithm_id;
+    {
+      QuicWriterMutexLock lock(&mu_);
+      auto it = cache_.Lookup(key);
+      if (it != cache_.end() && it->second->algorithm_id == algorithm_id &&
+          it->second->uncompressed == msg) {
+        return it->second->compressed;
+      }
+    }
+
+    std::string compressed;
+    if (!backend->Compress(msg, &compressed)) {
+      return std::string();
+    }
+
+    auto entry = std::make_unique<CompressedCertEntry>();
+    entry->uncompressed = std::string(msg);
+    entry->compressed = compressed;
+    entry->algorithm_id = algorithm_id;
+    QuicWriterMutexLock lock(&mu_);
+    cache_.Insert(key, std::move(entry));
+    return compressed;
+  }
+
+  size_t Size() {
+    QuicWriterMutexLock lock(&mu_);
+    return cache_.Size();
+  }
+
+  void Clear() {
+    QuicWriterMutexLock lock(&mu_);
+    cache_.Clear();
+  }
+
+ private:
+  CompressedCertCache() : cache_(kCompressedCertCacheCapacity) {}
+
+  QuicMutex mu_;
+  QuicLRUCache<uint64_t, CompressedCertEntry> cache_ QUIC_GUARDED_BY(mu_);
+};
+
+int CompressWithBackend(CertCompressionBackend* backend,
+                        CBB* out,
+                        const uint8_t* in,
+                        size_t in_len) {
+  if (backend == nullptr) {
+    return 0;
+  }
+  const std::string compressed =
+      CompressedCertCache::GetInstance()->GetOrCompress(
+          absl::string_view(reinterpret_cast<const char*>(in), in_len),
+          backend);
+  if (compressed.empty()) {
+    return 0;
+  }
+  return CBB_add_bytes(out,
+                       reinterpret_cast<const uint8_t*>(compressed.data()),
+                       compressed.size());
+}
+
+int DecompressWithBackend(CertCompressionBackend* backend,
+                          CRYPTO_BUFFER** out,
+                          size_t uncompressed_len,
+                          const uint8_t* in,
+                          size_t in_len) {
+  if (backend == nullptr) {
+    return 0;
+  }
+  uint8_t* data;
+  bssl::UniquePtr<CRYPTO_BUFFER> buffer(
+      CRYPTO_BUFFER_alloc(&data, uncompressed_len));
+  if (buffer == nullptr) {
+    return 0;
+  }
+  if (!backend->Decompress(
+          absl::string_view(reinterpret_cast<const char*>(in), in_len), data,
+          uncompressed_len)) {
+    return 0;
+  }
+  *out = buffer.release();
+  return 1;
+}
+
+int CompressCertCallback(SSL* /*ssl*/,
+                         CBB* out,
+                         const uint8_t* in,
+                         size_t in_len) {
+  return CompressWithBackend(ZlibCertCompressionBackend::GetInstance(), out,
+                             in, in_len);
+}
+
+int DecompressCertCallback(SSL* /*ssl*/,
+                           CRYPTO_BUFFER** out,
+                           size_t uncompressed_len,
+                           const uint8_t* in,
+                           size_t in_len) {
+  return DecompressWithBackend(ZlibCertCompressionBackend::GetInstance(), out,
+                               uncompressed_len, in, in_len);
+}
+
+// BoringSSL passes no registration context to the callbacks, so each slot of
+// the registry is bound to its own template instantiation.
+template <size_t Slot>
+int CompressCertCallbackForSlot(SSL* /*ssl*/,
+                                CBB* out,
+                                const uint8_t* in,
+                                size_t in_len) {
+  return CompressWithBackend(
+      CertCompressionBackendRegistry::GetInstance()->GetSlot(Slot), out, in,
+      in_len);
+}
+
+template <size_t Slot>
+int DecompressCertCallbackForSlot(SSL* /*ssl*/,
+                                  CRYPTO_BUFFER** out,
+                                  size_t uncompressed_len,
+                                  const uint8_t* in,
+                                  size_t in_len) {
+  return DecompressWithBackend(
+      CertCompressionBackendRegistry::GetInstance()->GetSlot(Slot), out,
+      uncompressed_len, in, in_len);
+}
+
+using SlotCompressCallback = int (*)(SSL*, CBB*, const uint8_t*, size_t);
+using SlotDecompressCallback =
+    int (*)(SSL*, CRYPTO_BUFFER**, size_t, const uint8_t*, size_t);
+
+const SlotCompressCallback kSlotCompressCallbacks[] = {
+    &CompressCertCallbackForSlot<0>, &CompressCertCallbackForSlot<1>,
+    &CompressCertCallbackForSlot<2>, &CompressCertCallbackForSlot<3>};
+const SlotDecompressCallback kSlotDecompressCallbacks[] = {
+    &DecompressCertCallbackForSlot<0>, &DecompressCertCallbackForSlot<1>,
+    &DecompressCertCallbackForSlot<2>, &DecompressCertCallbackForSlot<3>};
+
+static_assert(sizeof(kSlotCompressCallbacks) / sizeof(SlotCompressCallback) ==
+                  kMaxCertCompressionBackends,
+              "one pair of callbacks per backend slot");
+
+}  // namespace
+
+bool RegisterCertCompressionBackend(
+    std::unique_ptr<CertCompressionBackend> backend) {
+  return CertCompressionBackendRegistry::GetInstance()->Register(
+      std::move(backend));
+}
+
+bool SetCertCompressionDictionary(absl::string_view dictionary) {
+  return RegisterCertCompressionBackend(
+      std::make_unique<DictionaryZlibCertCompressionBackend>(
+          std::string(dictionary)));
+}
+
+bool ConfigureCertificateCompression(SSL_CTX* ssl_ctx) {
+  // BoringSSL prefers algorithms in registration order, so registered
+  // backends are added ahead of the built-in zlib fallback.
+  CertCompressionBackendRegistry* registry =
+      CertCompressionBackendRegistry::GetInstance();
+  const size_t num_backends = registry->num_backends();
+  for (size_t slot = 0; slot < num_backends; ++slot) {
+    if (SSL_CTX_add_cert_compression_alg(
+            ssl_ctx, registry->GetSlot(slot)->algorithm_id(),
+            kSlotCompressCallbacks[slot],
+            kSlotDecompressCallbacks[slot]) != 1) {
+      return false;
+    }
+  }
+  return SSL_CTX_add_cert_compression_alg(
+             ssl_ctx, kZlibCertCompressionAlgorithm, &CompressCertCallback,
+             &DecompressCertCallback) == 1;
+}
+
+void WarmCompressedCertCache(absl::string_view cert_message) {
+  CompressedCertCache* cache = CompressedCertCache::GetInstance();
+  cache->GetOrCompress(cert_message,
+                       ZlibCertCompressionBackend::GetInstance());
+  CertCompressionBackendRegistry* registry =
+      CertCompressionBackendRegistry::GetInstance();
+  const size_t num_backends = registry->num_backends();
+  for (size_t slot = 0; slot < num_backends; ++slot) {
+    cache->GetOrCompress(cert_message, registry->GetSlot(slot));
+  }
+}
+
+namespace test {
+
+CertCompressionBackend* FindCertCompressionBackendForTesting(
+    uint16_t algorithm_id) {
+  if (algorithm_id == kZlibCertCompressionAlgorithm) {
+    return ZlibCertCompressionBackend::GetInstance();
+  }
+  return CertCompressionBackendRegistry::GetInstance()->Find(algorithm_id);
+}
+
+size_t CompressedCertCacheSizeForTesting() {
+  return CompressedCertCache::GetInstance()->Size();
+}
+
+void ClearCompressedCertCacheForTesting() {
+  CompressedCertCache::GetInstance()->Clear();
+}
+
+}  // namespace test
+
+}  // namespace quic
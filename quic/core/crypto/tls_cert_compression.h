@@ -0,0 +1,100 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_CRYPTO_TLS_CERT_COMPRESSION_H_
+#define QUICHE_QUIC_CORE_CRYPTO_TLS_CERT_COMPRESSION_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "third_party/boringssl/src/include/openssl/ssl.h"
+#include "quic/platform/api/quic_export.h"
+
+namespace quic {
+
+// RFC 8879 CertificateCompressionAlgorithm codepoint for zlib.
+const uint16_t kZlibCertCompressionAlgorithm = 1;
+// Private-use codepoint for zlib with a preset dictionary, see
+// SetCertCompressionDictionary. Values in [16384, 65535] are reserved for
+// private use by RFC 8879.
+const uint16_t kDictionaryZlibCertCompressionAlgorithm = 16385;
+
+// Interface for a pluggable certificate compression backend. Implementations
+// must be thread-safe: Compress and Decompress may run concurrently on
+// multiple handshake threads.
+class QUIC_EXPORT_PRIVATE CertCompressionBackend {
+ public:
+  virtual ~CertCompressionBackend() {}
+
+  // The CertificateCompressionAlgorithm codepoint this backend implements,
+  // e.g. brotli(2) or zstd(3) from RFC 8879, or a private-use value for
+  // variants both endpoints are known to share.
+  virtual uint16_t algorithm_id() const = 0;
+
+  // Compresses |in| into |out|, replacing its contents. Returns false on
+  // failure.
+  virtual bool Compress(absl::string_view in, std::string* out) = 0;
+
+  // Decompresses |in| into |out|, which has room for exactly
+  // |uncompressed_len| bytes. Returns false on failure, including when |in|
+  // does not decompress to exactly |uncompressed_len| bytes.
+  virtual bool Decompress(absl::string_view in, uint8_t* out,
+                          size_t uncompressed_len) = 0;
+};
+
+// Registers |backend| for use by all SSL contexts subsequently passed to
+// ConfigureCertificateCompression; this is how e.g. a zstd backend is plugged
+// in where the dependency is available. zlib is built in and does not need to
+// be registered. Registered backends are preferred over zlib when the peer
+// supports them. A small fixed number of backends is supported; returns false
+// if the table is full or the algorithm ID is already taken. Backends are
+// never unregistered.
+QUIC_EXPORT_PRIVATE bool RegisterCertCompressionBackend(
+    std::unique_ptr<CertCompressionBackend> backend);
+
+// Enables zlib-with-preset-dictionary compression under
+// |kDictionaryZlibCertCompressionAlgorithm|, using |dictionary| as the preset
+// dictionary. The dictionary is typically trained offline from a sample of
+// the fleet's certificate chains and distributed to both endpoints; peers
+// that do not advertise the private-use codepoint are unaffected and keep
+// using plain zlib. May only be called once; returns false if a dictionary
+// was already loaded or the backend table is full.
+QUIC_EXPORT_PRIVATE bool SetCertCompressionDictionary(
+    absl::string_view dictionary);
+
+// Registers certificate compression callbacks on |ssl_ctx|: every backend
+// registered via RegisterCertCompressionBackend, in preference order, then
+// the built-in RFC 8879 zlib algorithm. Outgoing Certificate messages are
+// compressed at most once per distinct message: the compressed blob is
+// memoized in a process-wide cache keyed by message hash and compression
+// algorithm, so steady-state handshakes serve a cached copy instead of
+// running the compressor. Returns false if BoringSSL rejects a registration.
+QUIC_EXPORT_PRIVATE bool ConfigureCertificateCompression(SSL_CTX* ssl_ctx);
+
+// Compresses |cert_message| and seeds the cache with the result, so that even
+// the first handshake using the corresponding chain avoids zlib on the hot
+// path. Intended to be called at proof source initialization time by callers
+// that can reconstruct the Certificate message bytes.
+QUIC_EXPORT_PRIVATE void WarmCompressedCertCache(
+    absl::string_view cert_message);
+
+namespace test {
+
+// Returns the registered backend for |algorithm_id|, or nullptr.
+CertCompressionBackend* FindCertCompressionBackendForTesting(
+    uint16_t algorithm_id);
+
+// Returns the number of entries currently memoized.
+size_t CompressedCertCacheSizeForTesting();
+
+// Empties the process-wide cache.
+void ClearCompressedCertCacheForTesting();
+
+}  // namespace test
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_CRYPTO_TLS_CERT_COMPRESSION_H_
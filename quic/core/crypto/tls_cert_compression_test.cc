@@ -0,0 +1,125 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/crypto/tls_cert_compression.h"
+
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "third_party/boringssl/src/include/openssl/ssl.h"
+#include "quic/platform/api/quic_test.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+class TlsCertCompressionTest : public QuicTest {
+ protected:
+  TlsCertCompressionTest() { ClearCompressedCertCacheForTesting(); }
+};
+
+TEST_F(TlsCertCompressionTest, WarmCacheMemoizesPerMessage) {
+  EXPECT_EQ(0u, CompressedCertCacheSizeForTesting());
+
+  WarmCompressedCertCache("certificate message one");
+  EXPECT_EQ(1u, CompressedCertCacheSizeForTesting());
+
+  // Re-warming the same message does not add an entry.
+  WarmCompressedCertCache("certificate message one");
+  EXPECT_EQ(1u, CompressedCertCacheSizeForTesting());
+
+  WarmCompressedCertCache("certificate message two");
+  EXPECT_EQ(2u, CompressedCertCacheSizeForTesting());
+}
+
+TEST_F(TlsCertCompressionTest, RegistersZlibAlgorithm) {
+  bssl::UniquePtr<SSL_CTX> ssl_ctx(SSL_CTX_new(TLS_method()));
+  ASSERT_NE(nullptr, ssl_ctx);
+  EXPECT_TRUE(ConfigureCertificateCompression(ssl_ctx.get()));
+}
+
+// A trivial backend used to exercise the registry; echoes its input.
+class FakeCertCompressionBackend : public CertCompressionBackend {
+ public:
+  explicit FakeCertCompressionBackend(uint16_t algorithm_id)
+      : algorithm_id_(algorithm_id) {}
+
+  uint16_t algorithm_id() const override { return algorithm_id_; }
+
+  bool Compress(absl::string_view in, std::string* out) override {
+    *out = std::string(in);
+    return true;
+  }
+
+  bool Decompress(absl::string_view in, uint8_t* out,
+                  size_t uncompressed_len) override {
+    if (in.size() != uncompressed_len) {
+      return false;
+    }
+    memcpy(out, in.data(), in.size());
+    return true;
+  }
+
+ private:
+  const uint16_t algorithm_id_;
+};
+
+TEST_F(TlsCertCompressionTest, BackendRegistryRejectsDuplicates) {
+  ASSERT_TRUE(RegisterCertCompressionBackend(
+      std::make_unique<FakeCertCompressionBackend>(16400)));
+  // Each algorithm ID may only be registered once.
+  EXPECT_FALSE(RegisterCertCompressionBackend(
+      std::make_unique<FakeCertCompressionBackend>(16400)));
+  // The built-in zlib codepoint cannot be overridden.
+  EXPECT_FALSE(RegisterCertCompressionBackend(
+      std::make_unique<FakeCertCompressionBackend>(
+          kZlibCertCompressionAlgorithm)));
+
+  EXPECT_NE(nullptr, FindCertCompressionBackendForTesting(16400));
+  EXPECT_EQ(nullptr, FindCertCompressionBackendForTesting(16401));
+}
+
+TEST_F(TlsCertCompressionTest, DictionaryZlibRoundTrip) {
+  const std::string dictionary(
+      "-----BEGIN CERTIFICATE----- common issuer, subject and extension "
+      "bytes sampled from the fleet's certificate chains, produced by the "
+      "offline dictionary trainer");
+  ASSERT_TRUE(SetCertCompressionDictionary(dictionary));
+  // Only one dictionary may be loaded per process.
+  EXPECT_FALSE(SetCertCompressionDictionary("another dictionary"));
+
+  CertCompressionBackend* backend = FindCertCompressionBackendForTesting(
+      kDictionaryZlibCertCompressionAlgorithm);
+  ASSERT_NE(nullptr, backend);
+  EXPECT_EQ(kDictionaryZlibCertCompressionAlgorithm, backend->algorithm_id());
+
+  // A message sharing most of its content with the dictionary round-trips
+  // and compresses smaller than with plain zlib.
+  const std::string msg = dictionary + " leaf-specific serial 0123456789";
+  std::string compressed;
+  ASSERT_TRUE(backend->Compress(msg, &compressed));
+
+  CertCompressionBackend* zlib =
+      FindCertCompressionBackendForTesting(kZlibCertCompressionAlgorithm);
+  ASSERT_NE(nullptr, zlib);
+  std::string zlib_compressed;
+  ASSERT_TRUE(zlib->Compress(msg, &zlib_compressed));
+  EXPECT_LT(compressed.size(), zlib_compressed.size());
+
+  std::string decompressed(msg.size(), '\0');
+  ASSERT_TRUE(backend->Decompress(
+      compressed, reinterpret_cast<uint8_t*>(&decompressed[0]), msg.size()));
+  EXPECT_EQ(msg, decompressed);
+
+  // Registered backends are added to new contexts alongside zlib.
+  bssl::UniquePtr<SSL_CTX> ssl_ctx(SSL_CTX_new(TLS_method()));
+  ASSERT_NE(nullptr, ssl_ctx);
+  EXPECT_TRUE(ConfigureCertificateCompression(ssl_ctx.get()));
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
@@ -4,6 +4,8 @@
 
 #include "quic/core/crypto/tls_client_connection.h"
 
+#include "quic/core/crypto/tls_cert_compression.h"
+
 namespace quic {
 
 TlsClientConnection::TlsClientConnection(SSL_CTX* ssl_ctx,
@@ -31,6 +33,9 @@ bssl::UniquePtr<SSL_CTX> TlsClientConnection::CreateSslCtx(
   // TODO(wub): Always enable early data on the SSL_CTX, but allow it to be
   // overridden on the SSL object, via QuicSSLConfig.
   SSL_CTX_set_early_data_enabled(ssl_ctx.get(), enable_early_data);
+
+  // Advertise support for compressed Certificate messages from servers.
+  ConfigureCertificateCompression(ssl_ctx.get());
   return ssl_ctx;
 }
 
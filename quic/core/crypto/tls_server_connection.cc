@@ -7,6 +7,7 @@
 #include "absl/strings/string_view.h"
 #include "third_party/boringssl/src/include/openssl/ssl.h"
 #include "quic/core/crypto/proof_source.h"
+#include "quic/core/crypto/tls_cert_compression.h"
 #include "quic/core/quic_types.h"
 #include "quic/platform/api/quic_flag_utils.h"
 #include "quic/platform/api/quic_flags.h"
@@ -52,6 +53,10 @@ bssl::UniquePtr<SSL_CTX> TlsServerConnection::CreateSslCtx(
   SSL_CTX_set_select_certificate_cb(
       ssl_ctx.get(), &TlsServerConnection::EarlySelectCertCallback);
   SSL_CTX_set_options(ssl_ctx.get(), SSL_OP_CIPHER_SERVER_PREFERENCE);
+
+  // Serve compressed Certificate messages from the process-wide cache so the
+  // same chain is not recompressed on every handshake.
+  ConfigureCertificateCompression(ssl_ctx.get());
   return ssl_ctx;
 }
 
@@ -18,11 +18,13 @@
 #include "quic/core/quic_connection_id.h"
 #include "quic/core/quic_data_reader.h"
 #include "quic/core/quic_data_writer.h"
+#include "quic/core/quic_lru_cache.h"
 #include "quic/core/quic_types.h"
 #include "quic/core/quic_utils.h"
 #include "quic/core/quic_versions.h"
 #include "quic/platform/api/quic_bug_tracker.h"
 #include "quic/platform/api/quic_flag_utils.h"
+#include "quic/platform/api/quic_mutex.h"
 
 namespace quic {
 
@@ -1621,6 +1623,122 @@ bool ParseTransportParameters(ParsedQuicVersion version,
 
 namespace {
 
+// A small set of distinct client implementations produces nearly all of the
+// transport parameter blobs a server sees, so a modest cache covers the vast
+// majority of handshakes.
+const size_t kTransportParameterCacheCapacity = 128;
+
+struct ParsedTransportParametersEntry {
+  // The raw serialized parameters, kept to rule out returning a parse result
+  // for a colliding hash.
+  std::string serialized;
+  ParsedQuicVersion version;
+  Perspective perspective;
+  std::shared_ptr<const TransportParameters> parsed;
+};
+
+// Process-wide memoization of successfully parsed transport parameters,
+// shared by all connections. Guarded by a mutex because handshakes may run on
+// multiple threads; the shared_ptr is copied out under the lock so that
+// eviction cannot free an entry a caller still uses.
+class TransportParameterCache {
+ public:
+  static TransportParameterCache* GetInstance() {
+    static TransportParameterCache* cache = new TransportParameterCache();
+    return cache;
+  }
+
+  std::shared_ptr<const TransportParameters> Lookup(
+      ParsedQuicVersion version, Perspective perspective,
+      absl::string_view serialized) {
+    QuicWriterMutexLock lock(&mu_);
+    auto it = cache_.Lookup(ComputeKey(version, perspective, serialized));
+    if (it != cache_.end() && it->second->version == version &&
+        it->second->perspective == perspective &&
+        it->second->serialized == serialized) {
+      return it->second->parsed;
+    }
+    return nullptr;
+  }
+
+  void Insert(ParsedQuicVersion version, Perspective perspective,
+              absl::string_view serialized,
+              std::shared_ptr<const TransportParameters> parsed) {
+    auto entry = std::make_unique<ParsedTransportParametersEntry>(
+        ParsedTransportParametersEntry{std::string(serialized), version,
+                                       perspective, std::move(parsed)});
+    QuicWriterMutexLock lock(&mu_);
+    cache_.Insert(ComputeKey(version, perspective, serialized),
+                  std::move(entry));
+  }
+
+  size_t Size() {
+    QuicWriterMutexLock lock(&mu_);
+    return cache_.Size();
+  }
+
+  void Clear() {
+    QuicWriterMutexLock lock(&mu_);
+    cache_.Clear();
+  }
+
+ private:
+  TransportParameterCache() : cache_(kTransportParameterCacheCapacity) {}
+
+  static uint64_t ComputeKey(ParsedQuicVersion version,
+                             Perspective perspective,
+                             absl::string_view serialized) {
+    return QuicUtils::FNV1a_64_Hash(serialized) ^
+           CreateQuicVersionLabel(version) ^
+           (static_cast<uint64_t>(perspective) << 32);
+  }
+
+  QuicMutex mu_;
+  QuicLRUCache<uint64_t, ParsedTransportParametersEntry> cache_
+      QUIC_GUARDED_BY(mu_);
+};
+
+}  // namespace
+
+std::shared_ptr<const TransportParameters> ParseTransportParametersMemoized(
+    ParsedQuicVersion version,
+    Perspective perspective,
+    const uint8_t* in,
+    size_t in_len,
+    std::string* error_details) {
+  const absl::string_view serialized(reinterpret_cast<const char*>(in),
+                                     in_len);
+  TransportParameterCache* cache = TransportParameterCache::GetInstance();
+  std::shared_ptr<const TransportParameters> cached =
+      cache->Lookup(version, perspective, serialized);
+  if (cached != nullptr) {
+    return cached;
+  }
+
+  auto parsed = std::make_shared<TransportParameters>();
+  if (!ParseTransportParameters(version, perspective, in, in_len, parsed.get(),
+                                error_details)) {
+    return nullptr;
+  }
+  std::shared_ptr<const TransportParameters> result = std::move(parsed);
+  cache->Insert(version, perspective, serialized, result);
+  return result;
+}
+
+namespace test {
+
+size_t TransportParameterCacheSizeForTesting() {
+  return TransportParameterCache::GetInstance()->Size();
+}
+
+void ClearTransportParameterCacheForTesting() {
+  TransportParameterCache::GetInstance()->Clear();
+}
+
+}  // namespace test
+
+namespace {
+
 bool DigestUpdateIntegerParam(
     EVP_MD_CTX* hash_ctx,
     const TransportParameters::IntegerParameter& param) {
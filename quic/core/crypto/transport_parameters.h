@@ -303,6 +303,20 @@ QUIC_EXPORT_PRIVATE bool ParseTransportParameters(ParsedQuicVersion version,
                                                   TransportParameters* out,
                                                   std::string* error_details);
 
+// Memoizing variant of ParseTransportParameters for endpoints which see the
+// same serialized blobs over and over, e.g. a server whose client population
+// consists of a small number of distinct implementations. On success, returns
+// a shared immutable parsed object; repeated calls with the same bytes,
+// version and perspective return the same object from a process-wide cache,
+// skipping the parse and sharing the parsed representation between
+// connections. On failure, returns nullptr and writes a human-readable error
+// message to |error_details|; failures are never cached. Callers that need to
+// modify the result must first copy it into their own TransportParameters.
+QUIC_EXPORT_PRIVATE std::shared_ptr<const TransportParameters>
+ParseTransportParametersMemoized(ParsedQuicVersion version,
+                                 Perspective perspective, const uint8_t* in,
+                                 size_t in_len, std::string* error_details);
+
 // Serializes |in| and |application_data| in a deterministic format so that
 // multiple calls to SerializeTransportParametersForTicket with the same inputs
 // will generate the same output, and if the inputs differ, then the output will
@@ -316,6 +330,17 @@ QUIC_EXPORT_PRIVATE bool SerializeTransportParametersForTicket(
     const std::vector<uint8_t>& application_data,
     std::vector<uint8_t>* out);
 
+namespace test {
+
+// Returns the number of parse results currently memoized by
+// ParseTransportParametersMemoized.
+size_t TransportParameterCacheSizeForTesting();
+
+// Empties the process-wide parse cache.
+void ClearTransportParameterCacheForTesting();
+
+}  // namespace test
+
 }  // namespace quic
 
 #endif  // QUICHE_QUIC_CORE_CRYPTO_TRANSPORT_PARAMETERS_H_
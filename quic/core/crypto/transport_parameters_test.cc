@@ -5,6 +5,7 @@
 #include "quic/core/crypto/transport_parameters.h"
 
 #include <cstring>
+#include <memory>
 #include <utility>
 
 #include "absl/base/macros.h"
@@ -755,6 +756,59 @@ TEST_P(TransportParametersTest, ParseClientParametersRepeated) {
   EXPECT_EQ(error_details, "Received a second max_idle_timeout");
 }
 
+TEST_P(TransportParametersTest, MemoizedParseSharesResult) {
+  // clang-format off
+  const uint8_t kClientParams[] = {
+      // max_idle_timeout
+      0x01,  // parameter id
+      0x02,  // length
+      0x6e, 0xec,  // value
+  };
+  // clang-format on
+  ClearTransportParameterCacheForTesting();
+  std::string error_details;
+  std::shared_ptr<const TransportParameters> first =
+      ParseTransportParametersMemoized(version_, Perspective::IS_CLIENT,
+                                       kClientParams,
+                                       ABSL_ARRAYSIZE(kClientParams),
+                                       &error_details);
+  ASSERT_NE(first, nullptr) << error_details;
+  EXPECT_EQ(kFakeIdleTimeoutMilliseconds, first->max_idle_timeout_ms.value());
+  EXPECT_EQ(1u, TransportParameterCacheSizeForTesting());
+
+  // The same bytes parse to the same shared object.
+  std::shared_ptr<const TransportParameters> second =
+      ParseTransportParametersMemoized(version_, Perspective::IS_CLIENT,
+                                       kClientParams,
+                                       ABSL_ARRAYSIZE(kClientParams),
+                                       &error_details);
+  EXPECT_EQ(first.get(), second.get());
+  EXPECT_EQ(1u, TransportParameterCacheSizeForTesting());
+
+  // The perspective is part of the cache key.
+  std::shared_ptr<const TransportParameters> server =
+      ParseTransportParametersMemoized(version_, Perspective::IS_SERVER,
+                                       kClientParams,
+                                       ABSL_ARRAYSIZE(kClientParams),
+                                       &error_details);
+  ASSERT_NE(server, nullptr) << error_details;
+  EXPECT_NE(first.get(), server.get());
+  EXPECT_EQ(Perspective::IS_SERVER, server->perspective);
+  EXPECT_EQ(2u, TransportParameterCacheSizeForTesting());
+}
+
+TEST_P(TransportParametersTest, MemoizedParseDoesNotCacheFailures) {
+  // A lone parameter ID with its length and value truncated off.
+  const uint8_t kMalformedParams[] = {0x01};
+  ClearTransportParameterCacheForTesting();
+  std::string error_details;
+  EXPECT_EQ(nullptr, ParseTransportParametersMemoized(
+                         version_, Perspective::IS_CLIENT, kMalformedParams,
+                         ABSL_ARRAYSIZE(kMalformedParams), &error_details));
+  EXPECT_FALSE(error_details.empty());
+  EXPECT_EQ(0u, TransportParameterCacheSizeForTesting());
+}
+
 TEST_P(TransportParametersTest, ParseServerParams) {
   // clang-format off
   const uint8_t kServerParams[] = {
@@ -595,19 +595,47 @@ bool CapsuleParser::IngestCapsuleFragment(absl::string_view capsule_fragment) {
   if (parsing_error_occurred_) {
     return false;
   }
-  absl::StrAppend(&buffered_data_, capsule_fragment);
-  while (true) {
-    const size_t buffered_data_read = AttemptParseCapsule();
+  if (!buffered_data_.empty()) {
+    // A capsule is split across fragments: complete it in the buffer, then
+    // fall through to parse the rest of |capsule_fragment| in place.
+    const size_t previously_buffered = buffered_data_.size();
+    absl::StrAppend(&buffered_data_, capsule_fragment);
+    const size_t buffered_data_read = AttemptParseCapsule(buffered_data_);
     if (parsing_error_occurred_) {
       QUICHE_DCHECK_EQ(buffered_data_read, 0u);
       buffered_data_.clear();
       return false;
     }
     if (buffered_data_read == 0) {
+      // Still incomplete; everything is buffered.
+      return CheckBufferedCapsuleSize();
+    }
+    // The buffered capsule is done. Drop its bytes but keep the allocation
+    // for the next split capsule, and resume on the unbuffered remainder.
+    QUICHE_DCHECK_GT(buffered_data_read, previously_buffered);
+    capsule_fragment.remove_prefix(buffered_data_read - previously_buffered);
+    buffered_data_.clear();
+  }
+  // Common case: parse complete capsules directly out of |capsule_fragment|,
+  // handing the visitor views into the caller's buffer.
+  while (!capsule_fragment.empty()) {
+    const size_t capsule_fragment_read = AttemptParseCapsule(capsule_fragment);
+    if (parsing_error_occurred_) {
+      QUICHE_DCHECK_EQ(capsule_fragment_read, 0u);
+      buffered_data_.clear();
+      return false;
+    }
+    if (capsule_fragment_read == 0) {
+      // Trailing partial capsule; buffer it until the next fragment.
+      buffered_data_.assign(capsule_fragment.data(), capsule_fragment.size());
       break;
     }
-    buffered_data_.erase(0, buffered_data_read);
+    capsule_fragment.remove_prefix(capsule_fragment_read);
   }
+  return CheckBufferedCapsuleSize();
+}
+
+bool CapsuleParser::CheckBufferedCapsuleSize() {
   static constexpr size_t kMaxCapsuleBufferSize = 1024 * 1024;
   if (buffered_data_.size() > kMaxCapsuleBufferSize) {
     buffered_data_.clear();
@@ -617,12 +645,12 @@ bool CapsuleParser::IngestCapsuleFragment(absl::string_view capsule_fragment) {
   return true;
 }
 
-size_t CapsuleParser::AttemptParseCapsule() {
+size_t CapsuleParser::AttemptParseCapsule(absl::string_view data) {
   QUICHE_DCHECK(!parsing_error_occurred_);
-  if (buffered_data_.empty()) {
+  if (data.empty()) {
     return 0;
   }
-  QuicDataReader capsule_fragment_reader(buffered_data_);
+  QuicDataReader capsule_fragment_reader(data);
   uint64_t capsule_type64;
   if (!capsule_fragment_reader.ReadVarInt62(&capsule_type64)) {
     QUIC_DVLOG(2) << "Partial read: not enough data to read capsule type";
@@ -258,7 +258,10 @@ class QUIC_EXPORT_PRIVATE CapsuleParser {
 
   // Ingests a capsule fragment (any fragment of bytes from the capsule data
   // stream) and parses and complete capsules it encounters. Returns false if a
-  // parsing error occurred.
+  // parsing error occurred. Capsules that lie entirely within
+  // |capsule_fragment| are delivered to the visitor as views into that buffer
+  // without copying; only a capsule split across fragments is buffered
+  // internally until the rest of it arrives.
   bool IngestCapsuleFragment(absl::string_view capsule_fragment);
 
   void ErrorIfThereIsRemainingBufferedData();
@@ -266,10 +269,14 @@ class QUIC_EXPORT_PRIVATE CapsuleParser {
   friend class test::CapsuleParserPeer;
 
  private:
-  // Attempts to parse a single capsule from |buffered_data_|. If a full capsule
-  // is not available, returns 0. If a parsing error occurs, returns 0.
-  // Otherwise, returns the number of bytes in the parsed capsule.
-  size_t AttemptParseCapsule();
+  // Attempts to parse a single capsule from the start of |data|. If a full
+  // capsule is not available, returns 0. If a parsing error occurs, returns 0.
+  // Otherwise, returns the number of bytes in the parsed capsule. The views
+  // handed to the visitor point into |data|.
+  size_t AttemptParseCapsule(absl::string_view data);
+  // Fails parsing if |buffered_data_| has grown beyond the maximum number of
+  // bytes this parser is willing to buffer. Returns false on failure.
+  bool CheckBufferedCapsuleSize();
   void ReportParseFailure(const std::string& error_message);
 
   // Whether HTTP Datagram Context IDs are present.
@@ -279,6 +286,9 @@ class QUIC_EXPORT_PRIVATE CapsuleParser {
   // Visitor which will receive callbacks, unowned.
   Visitor* visitor_;
 
+  // Holds the leading bytes of a capsule split across fragments. Cleared
+  // without releasing its allocation once the capsule completes, so the same
+  // buffer is reused for later split capsules.
   std::string buffered_data_;
 };
 
@@ -257,6 +257,26 @@ TEST_F(CapsuleTest, TwoCapsules) {
   ValidateParserIsEmpty();
 }
 
+TEST_F(CapsuleTest, CompleteCapsuleIsParsedWithoutCopying) {
+  std::string capsule_fragment = absl::HexStringToBytes(
+      "80ff37a5"          // DATAGRAM_WITHOUT_CONTEXT capsule type
+      "08"                // capsule length
+      "a1a2a3a4a5a6a7a8"  // HTTP Datagram payload
+  );
+  EXPECT_CALL(visitor_, OnCapsule(_))
+      .WillOnce([&capsule_fragment](const Capsule& capsule) {
+        // The payload must be a view into the ingested fragment, not a copy.
+        absl::string_view payload =
+            capsule.datagram_without_context_capsule().http_datagram_payload;
+        EXPECT_GE(payload.data(), capsule_fragment.data());
+        EXPECT_LE(payload.data() + payload.size(),
+                  capsule_fragment.data() + capsule_fragment.size());
+        return true;
+      });
+  ASSERT_TRUE(capsule_parser_.IngestCapsuleFragment(capsule_fragment));
+  EXPECT_TRUE(CapsuleParserPeer::buffered_data(&capsule_parser_)->empty());
+}
+
 TEST_F(CapsuleTest, TwoCapsulesPartialReads) {
   std::string capsule_fragment1 = absl::HexStringToBytes(
       "80ff37a5"  // first capsule DATAGRAM_WITHOUT_CONTEXT capsule type
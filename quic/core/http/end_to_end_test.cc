@@ -1930,6 +1930,43 @@ TEST_P(EndToEndTest, LargePostZeroRTTFailure) {
   VerifyCleanConnection(false);
 }
 
+TEST_P(EndToEndTest, EarlyRequestPipelineZeroRtt) {
+  // Send a request and then disconnect. This prepares the client to attempt
+  // a 0-RTT handshake for the next request.
+  ASSERT_TRUE(Initialize());
+
+  SendSynchronousFooRequestAndCheckResponse();
+  EXPECT_FALSE(client_->client()->EarlyDataAccepted());
+
+  client_->Disconnect();
+
+  // Reconnect, and hand a request to the early request pipeline before the
+  // handshake is confirmed so that it is sent as 0-RTT data.
+  client_->client()->set_store_response(true);
+  client_->Connect();
+
+  SpdyHeaderBlock headers;
+  headers[":method"] = "GET";
+  headers[":path"] = "/foo";
+  headers[":scheme"] = "https";
+  headers[":authority"] = server_hostname_;
+  client_->client()->SendEarlyRequest(headers, "", /*fin=*/true,
+                                      /*idempotent=*/true);
+
+  EXPECT_TRUE(client_->client()->WaitForHandshakeConfirmed());
+  while (client_->client()->WaitForEvents()) {
+  }
+
+  EXPECT_TRUE(client_->client()->EarlyDataAccepted());
+  EXPECT_EQ(kFooResponseBody, client_->client()->latest_response_body());
+  const QuicSpdyClientBase::EarlyRequestStats& stats =
+      client_->client()->early_request_stats();
+  EXPECT_EQ(1u, stats.num_early_requests_sent);
+  // The 0-RTT data was accepted, so the buffered copy was never replayed.
+  EXPECT_EQ(0u, stats.num_early_requests_replayed);
+  EXPECT_EQ(0u, stats.num_early_requests_dropped);
+}
+
 // Regression test for b/168020146.
 TEST_P(EndToEndTest, MultipleZeroRtt) {
   ASSERT_TRUE(Initialize());
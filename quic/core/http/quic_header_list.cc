@@ -7,6 +7,7 @@
 #include <limits>
 #include <string>
 
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "quic/core/qpack/qpack_header_table.h"
 #include "quic/core/quic_packets.h"
@@ -43,7 +44,12 @@ void QuicHeaderList::OnHeader(absl::string_view name, absl::string_view value) {
     current_header_list_size_ += name.size();
     current_header_list_size_ += value.size();
     current_header_list_size_ += kQpackEntrySizeOverhead;
-    header_list_.emplace_back(std::string(name), std::string(value));
+    Entry entry;
+    entry.name_offset = arena_.size();
+    entry.name_length = name.size();
+    entry.value_length = value.size();
+    absl::StrAppend(&arena_, name, value);
+    entries_.push_back(entry);
   }
 }
 
@@ -57,7 +63,9 @@ void QuicHeaderList::OnHeaderBlockEnd(size_t uncompressed_header_bytes,
 }
 
 void QuicHeaderList::Clear() {
-  header_list_.clear();
+  arena_.clear();
+  arena_.shrink_to_fit();
+  entries_.clear();
   current_header_list_size_ = 0;
   uncompressed_header_bytes_ = 0;
   compressed_header_bytes_ = 0;
@@ -66,7 +74,7 @@ void QuicHeaderList::Clear() {
 std::string QuicHeaderList::DebugString() const {
   std::string s = "{ ";
   for (const auto& p : *this) {
-    s.append(p.first + "=" + p.second + ", ");
+    absl::StrAppend(&s, p.first, "=", p.second, ", ");
   }
   s.append("}");
   return s;
@@ -6,27 +6,80 @@
 #define QUICHE_QUIC_CORE_HTTP_QUIC_HEADER_LIST_H_
 
 #include <algorithm>
+#include <cstdint>
 #include <functional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/strings/string_view.h"
 #include "quic/platform/api/quic_bug_tracker.h"
 #include "quic/platform/api/quic_export.h"
-#include "common/quiche_circular_deque.h"
 #include "spdy/core/spdy_header_block.h"
 #include "spdy/core/spdy_headers_handler_interface.h"
 
 namespace quic {
 
-// A simple class that accumulates header pairs
+// A simple class that accumulates header pairs.
+//
+// All names and values are packed into one contiguous arena, with a compact
+// offset/length entry per header, so accumulating a request costs one
+// amortized allocation instead of two small heap strings per header.
+// Iteration yields string_view pairs into the arena; they are invalidated by
+// mutating or destroying the list.
 class QUIC_EXPORT_PRIVATE QuicHeaderList
     : public spdy::SpdyHeadersHandlerInterface {
  public:
-  using ListType =
-      quiche::QuicheCircularDeque<std::pair<std::string, std::string>>;
-  using value_type = ListType::value_type;
-  using const_iterator = ListType::const_iterator;
+  using value_type = std::pair<absl::string_view, absl::string_view>;
+
+  // Iterates over the entry table, materializing string_view pairs that point
+  // into the arena. Dereferencing returns the pair by value since no
+  // pair<string_view, string_view> is stored.
+  class QUIC_EXPORT_PRIVATE const_iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = QuicHeaderList::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const value_type*;
+    using reference = value_type;
+
+    const_iterator(const QuicHeaderList* list, size_t index)
+        : list_(list), index_(index) {}
+
+    reference operator*() const { return list_->entry(index_); }
+
+    // Keeps the materialized pair alive for the duration of an it-> access.
+    class QUIC_EXPORT_PRIVATE pointer_proxy {
+     public:
+      explicit pointer_proxy(value_type pair) : pair_(pair) {}
+      const value_type* operator->() const { return &pair_; }
+
+     private:
+      value_type pair_;
+    };
+    pointer_proxy operator->() const { return pointer_proxy(**this); }
+
+    const_iterator& operator++() {
+      ++index_;
+      return *this;
+    }
+    const_iterator operator++(int) {
+      const_iterator it = *this;
+      ++index_;
+      return it;
+    }
+
+    bool operator==(const const_iterator& other) const {
+      return list_ == other.list_ && index_ == other.index_;
+    }
+    bool operator!=(const const_iterator& other) const {
+      return !(*this == other);
+    }
+
+   private:
+    const QuicHeaderList* list_;
+    size_t index_;
+  };
 
   QuicHeaderList();
   QuicHeaderList(QuicHeaderList&& other);
@@ -43,10 +96,10 @@ class QUIC_EXPORT_PRIVATE QuicHeaderList
 
   void Clear();
 
-  const_iterator begin() const { return header_list_.begin(); }
-  const_iterator end() const { return header_list_.end(); }
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator end() const { return const_iterator(this, entries_.size()); }
 
-  bool empty() const { return header_list_.empty(); }
+  bool empty() const { return entries_.empty(); }
   size_t uncompressed_header_bytes() const {
     return uncompressed_header_bytes_;
   }
@@ -60,7 +113,28 @@ class QUIC_EXPORT_PRIVATE QuicHeaderList
   std::string DebugString() const;
 
  private:
-  quiche::QuicheCircularDeque<std::pair<std::string, std::string>> header_list_;
+  // An offset-based entry into |arena_|. The value immediately follows the
+  // name, so only one offset is stored.
+  struct QUIC_EXPORT_PRIVATE Entry {
+    uint32_t name_offset;
+    uint32_t name_length;
+    uint32_t value_length;
+  };
+
+  // Materializes the |index|th header pair as views into |arena_|.
+  value_type entry(size_t index) const {
+    const Entry& entry = entries_[index];
+    const absl::string_view arena(arena_);
+    return value_type(arena.substr(entry.name_offset, entry.name_length),
+                      arena.substr(entry.name_offset + entry.name_length,
+                                   entry.value_length));
+  }
+
+  // Name and value bytes of all headers, in order, back to back.
+  std::string arena_;
+
+  // One entry per header, in the order headers were added.
+  std::vector<Entry> entries_;
 
   // The limit on the size of the header list (defined by spec as name + value +
   // overhead for each header field). Headers over this limit will not be
@@ -77,8 +151,8 @@ class QUIC_EXPORT_PRIVATE QuicHeaderList
 };
 
 inline bool operator==(const QuicHeaderList& l1, const QuicHeaderList& l2) {
-  auto pred = [](const std::pair<std::string, std::string>& p1,
-                 const std::pair<std::string, std::string>& p2) {
+  auto pred = [](const QuicHeaderList::value_type& p1,
+                 const QuicHeaderList::value_type& p2) {
     return p1.first == p2.first && p1.second == p2.second;
   };
   return std::equal(l1.begin(), l1.end(), l2.begin(), pred);
@@ -67,6 +67,24 @@ TEST_F(QuicHeaderListTest, NotTooLarge) {
   EXPECT_FALSE(headers.empty());
 }
 
+// This test verifies that iteration yields views into the arena that survive
+// arena reallocation caused by later insertions.
+TEST_F(QuicHeaderListTest, ViewsStableAcrossGrowth) {
+  QuicHeaderList headers;
+  headers.OnHeader("foo", "bar");
+  // Force the arena to reallocate.
+  std::string long_value(1 << 16, 'x');
+  headers.OnHeader("long", long_value);
+
+  auto it = headers.begin();
+  EXPECT_EQ("foo", it->first);
+  EXPECT_EQ("bar", it->second);
+  ++it;
+  EXPECT_EQ("long", it->first);
+  EXPECT_EQ(long_value, it->second);
+  EXPECT_EQ(headers.end(), ++it);
+}
+
 // This test verifies that QuicHeaderList is copyable and assignable.
 TEST_F(QuicHeaderListTest, IsCopyableAndAssignable) {
   QuicHeaderList headers;
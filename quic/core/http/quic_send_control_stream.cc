@@ -18,6 +18,54 @@
 
 namespace quic {
 
+namespace {
+
+// Applies the greasing rules of
+// https://tools.ietf.org/html/draft-ietf-quic-http-25#section-7.2.4.1:
+// setting identifiers of 0x1f * N + 0x21 are reserved and greasing should
+// be attempted.
+void AddGreaseSetting(SettingsFrame* settings) {
+  if (!GetQuicFlag(FLAGS_quic_enable_http3_grease_randomness)) {
+    settings->values[0x40] = 20;
+    return;
+  }
+  uint32_t result;
+  QuicRandom::GetInstance()->RandBytes(&result, sizeof(result));
+  uint64_t setting_id = 0x1fULL * static_cast<uint64_t>(result) + 0x21ULL;
+  QuicRandom::GetInstance()->RandBytes(&result, sizeof(result));
+  settings->values[setting_id] = result;
+}
+
+}  // namespace
+
+// static
+std::shared_ptr<const QuicControlStreamPreamble>
+QuicControlStreamPreamble::Create(const SettingsFrame& settings) {
+  auto preamble = std::make_shared<QuicControlStreamPreamble>();
+  preamble->settings = settings;
+  AddGreaseSetting(&preamble->settings);
+
+  char type[sizeof(kControlStream)];
+  QuicDataWriter writer(ABSL_ARRAYSIZE(type), type);
+  writer.WriteVarInt62(kControlStream);
+
+  std::unique_ptr<char[]> settings_bytes;
+  QuicByteCount settings_length =
+      HttpEncoder::SerializeSettingsFrame(preamble->settings, &settings_bytes);
+  // https://tools.ietf.org/html/draft-ietf-quic-http-25#section-7.2.9
+  // specifies that a reserved frame type has no semantic meaning and should
+  // be discarded. A greasing frame is added here.
+  std::unique_ptr<char[]> grease_bytes;
+  QuicByteCount grease_length =
+      HttpEncoder::SerializeGreasingFrame(&grease_bytes);
+
+  preamble->bytes.reserve(writer.length() + settings_length + grease_length);
+  preamble->bytes.append(writer.data(), writer.length());
+  preamble->bytes.append(settings_bytes.get(), settings_length);
+  preamble->bytes.append(grease_bytes.get(), grease_length);
+  return preamble;
+}
+
 QuicSendControlStream::QuicSendControlStream(QuicStreamId id,
                                              QuicSpdySession* spdy_session,
                                              const SettingsFrame& settings)
@@ -44,6 +92,21 @@ void QuicSendControlStream::MaybeSendSettingsFrame() {
   }
 
   QuicConnection::ScopedPacketFlusher flusher(session()->connection());
+
+  if (preamble_ != nullptr) {
+    // The stream type, SETTINGS and greasing frame were serialized once for
+    // every connection sharing this configuration; write them in one shot.
+    QUIC_DVLOG(1) << "Control stream " << id()
+                  << " is writing pre-serialized settings frame "
+                  << preamble_->settings;
+    if (spdy_session_->debug_visitor()) {
+      spdy_session_->debug_visitor()->OnSettingsFrameSent(preamble_->settings);
+    }
+    WriteOrBufferData(preamble_->bytes, /*fin = */ false, nullptr);
+    settings_sent_ = true;
+    return;
+  }
+
   // Send the stream type on so the peer knows about this stream.
   char data[sizeof(kControlStream)];
   QuicDataWriter writer(ABSL_ARRAYSIZE(data), data);
@@ -52,18 +115,7 @@ void QuicSendControlStream::MaybeSendSettingsFrame() {
                     nullptr);
 
   SettingsFrame settings = settings_;
-  // https://tools.ietf.org/html/draft-ietf-quic-http-25#section-7.2.4.1
-  // specifies that setting identifiers of 0x1f * N + 0x21 are reserved and
-  // greasing should be attempted.
-  if (!GetQuicFlag(FLAGS_quic_enable_http3_grease_randomness)) {
-    settings.values[0x40] = 20;
-  } else {
-    uint32_t result;
-    QuicRandom::GetInstance()->RandBytes(&result, sizeof(result));
-    uint64_t setting_id = 0x1fULL * static_cast<uint64_t>(result) + 0x21ULL;
-    QuicRandom::GetInstance()->RandBytes(&result, sizeof(result));
-    settings.values[setting_id] = result;
-  }
+  AddGreaseSetting(&settings);
 
   std::unique_ptr<char[]> buffer;
   QuicByteCount frame_length =
@@ -5,6 +5,10 @@
 #ifndef QUICHE_QUIC_CORE_HTTP_QUIC_SEND_CONTROL_STREAM_H_
 #define QUICHE_QUIC_CORE_HTTP_QUIC_SEND_CONTROL_STREAM_H_
 
+#include <memory>
+#include <string>
+#include <utility>
+
 #include "quic/core/http/http_encoder.h"
 #include "quic/core/quic_stream.h"
 #include "quic/core/quic_types.h"
@@ -15,6 +19,26 @@ namespace quic {
 
 class QuicSpdySession;
 
+// The serialized opening bytes of a send control stream: the stream type
+// varint, the SETTINGS frame and the greasing frame. These bytes are
+// identical for every connection using the same settings, so a server can
+// build the preamble once per config change and share the immutable buffer
+// across all sessions it accepts, instead of running HttpEncoder and
+// allocating for each connection.
+struct QUIC_EXPORT_PRIVATE QuicControlStreamPreamble {
+  // Builds the preamble for |settings|. The greasing setting and frame are
+  // drawn when the preamble is built, so connections sharing a preamble
+  // send identical grease; rebuild the preamble to re-randomize.
+  static std::shared_ptr<const QuicControlStreamPreamble> Create(
+      const SettingsFrame& settings);
+
+  // The settings as serialized, including the greasing entry; passed to
+  // debug visitors when the preamble is sent.
+  SettingsFrame settings;
+  // Stream type varint + SETTINGS frame + greasing frame.
+  std::string bytes;
+};
+
 // 6.2.1 Control Stream.
 // The send control stream is self initiated and is write only.
 class QUIC_EXPORT_PRIVATE QuicSendControlStream : public QuicStream {
@@ -37,6 +61,15 @@ class QUIC_EXPORT_PRIVATE QuicSendControlStream : public QuicStream {
   // first frame sent on this stream.
   void MaybeSendSettingsFrame();
 
+  // Makes MaybeSendSettingsFrame() write |preamble| instead of serializing
+  // the settings itself. Must be called before the settings are sent; the
+  // preamble must have been built from the settings this stream was
+  // constructed with.
+  void SetPreamble(std::shared_ptr<const QuicControlStreamPreamble> preamble) {
+    QUICHE_DCHECK(!settings_sent_);
+    preamble_ = std::move(preamble);
+  }
+
   // Send a PRIORITY_UPDATE frame on this stream, and a SETTINGS frame
   // beforehand if one has not been already sent.
   void WritePriorityUpdate(const PriorityUpdateFrame& priority_update);
@@ -56,6 +89,9 @@ class QUIC_EXPORT_PRIVATE QuicSendControlStream : public QuicStream {
   // SETTINGS values to send.
   const SettingsFrame settings_;
 
+  // If set, the pre-serialized bytes sent by MaybeSendSettingsFrame().
+  std::shared_ptr<const QuicControlStreamPreamble> preamble_;
+
   QuicSpdySession* const spdy_session_;
 };
 
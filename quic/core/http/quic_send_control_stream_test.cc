@@ -246,6 +246,43 @@ TEST_P(QuicSendControlStreamTest, WriteSettingsOnlyOnce) {
   send_control_stream_->MaybeSendSettingsFrame();
 }
 
+TEST_P(QuicSendControlStreamTest, WritePreSerializedPreamble) {
+  SetQuicFlag(FLAGS_quic_enable_http3_grease_randomness, false);
+  Initialize();
+
+  // With grease randomness disabled the preamble is deterministic, so a
+  // shared preamble carries exactly the bytes the per-connection path
+  // would serialize.
+  std::shared_ptr<const QuicControlStreamPreamble> preamble =
+      QuicControlStreamPreamble::Create(session_.settings());
+  send_control_stream_->SetPreamble(preamble);
+
+  auto buffer = std::make_unique<char[]>(preamble->bytes.size());
+  QuicDataWriter writer(preamble->bytes.size(), buffer.get());
+  auto save_write_data =
+      [&writer, this](QuicStreamId /*id*/, size_t write_length,
+                      QuicStreamOffset offset, StreamSendingState /*state*/,
+                      TransmissionType /*type*/,
+                      absl::optional<EncryptionLevel> /*level*/) {
+        send_control_stream_->WriteStreamData(offset, write_length, &writer);
+        return QuicConsumedData(/* bytes_consumed = */ write_length,
+                                /* fin_consumed = */ false);
+      };
+
+  // The whole preamble goes out in a single write.
+  EXPECT_CALL(session_, WritevData(send_control_stream_->id(),
+                                   preamble->bytes.size(), _, _, _, _))
+      .WillOnce(Invoke(save_write_data));
+  send_control_stream_->MaybeSendSettingsFrame();
+  quiche::test::CompareCharArraysWithHexError(
+      "preamble", writer.data(), writer.length(), preamble->bytes.data(),
+      preamble->bytes.length());
+
+  // No data should be written the second time MaybeSendSettingsFrame() is
+  // called.
+  send_control_stream_->MaybeSendSettingsFrame();
+}
+
 // Send stream type and SETTINGS frame if WritePriorityUpdate() is called first.
 TEST_P(QuicSendControlStreamTest, WritePriorityBeforeSettings) {
   Initialize();
@@ -19,6 +19,15 @@
 
 namespace quic {
 
+namespace {
+
+// Estimates recorded on a connection that lost more than this fraction of its
+// packets (in packets per million sent) are not used for bandwidth resumption:
+// a jump-start computed under heavy loss is likely to overshoot the path.
+const int32_t kMaxResumptionLossRatePerMillion = 20000;  // 2%
+
+}  // namespace
+
 QuicServerSessionBase::QuicServerSessionBase(
     const QuicConfig& config,
     const ParsedQuicVersionVector& supported_versions,
@@ -100,7 +109,12 @@ void QuicServerSessionBase::OnConfigNegotiated() {
       const uint64_t seconds_since_estimate =
           connection()->clock()->WallNow().ToUNIXSeconds() -
           cached_network_params->timestamp();
-      if (seconds_since_estimate <= kNumSecondsPerHour) {
+      // Do not jump-start from an estimate that was recorded while the
+      // previous connection was experiencing substantial loss.
+      if (cached_network_params->loss_rate_per_million() >
+          kMaxResumptionLossRatePerMillion) {
+        QUIC_CODE_COUNT(quic_bandwidth_resumption_skipped_lossy_path);
+      } else if (seconds_since_estimate <= kNumSecondsPerHour) {
         connection()->ResumeConnectionState(*cached_network_params,
                                             max_bandwidth_resumption);
       }
@@ -357,7 +371,7 @@ QuicSSLConfig QuicServerSessionBase::GetSSLConfig() const {
 }
 
 absl::optional<CachedNetworkParameters>
-QuicServerSessionBase::GenerateCachedNetworkParameters() const {
+QuicServerSessionBase::GenerateCachedNetworkParameters() {
   QUICHE_DCHECK(add_cached_network_parameters_to_address_token());
   const QuicSentPacketManager& sent_packet_manager =
       connection()->sent_packet_manager();
@@ -397,6 +411,15 @@ QuicServerSessionBase::GenerateCachedNetworkParameters() const {
         bandwidth_recorder->EstimateRecordedDuringSlowStart()
             ? CachedNetworkParameters::SLOW_START
             : CachedNetworkParameters::CONGESTION_AVOIDANCE);
+
+    // Record the connection's loss rate alongside the estimate, so that the
+    // resumption logic on a future connection can refuse to jump-start from an
+    // estimate taken on an unhealthy path.
+    const QuicConnectionStats& stats = connection()->GetStats();
+    if (stats.packets_sent > 0) {
+      cached_network_params.set_loss_rate_per_million(static_cast<int32_t>(
+          stats.packets_lost * 1000000 / stats.packets_sent));
+    }
   }
 
   if (!serving_region_.empty()) {
@@ -77,7 +77,7 @@ class QUIC_EXPORT_PRIVATE QuicServerSessionBase : public QuicSpdySession {
   const QuicCryptoServerStreamBase* GetCryptoStream() const override;
 
   absl::optional<CachedNetworkParameters> GenerateCachedNetworkParameters()
-      const override;
+      override;
 
   // If an outgoing stream can be created, return true.
   // Return false when connection is closed or forward secure encryption hasn't
@@ -713,6 +713,18 @@ TEST_P(QuicServerSessionBaseTest, BandwidthResumptionExperiment) {
   crypto_stream->SetPreviousCachedNetworkParams(cached_network_params);
   EXPECT_CALL(*connection_, ResumeConnectionState(_, _)).Times(1);
   session_->OnConfigNegotiated();
+
+  // An estimate recorded on a connection with a high loss rate is not used.
+  cached_network_params.set_loss_rate_per_million(50 * 1000);  // 5%
+  crypto_stream->SetPreviousCachedNetworkParams(cached_network_params);
+  EXPECT_CALL(*connection_, ResumeConnectionState(_, _)).Times(0);
+  session_->OnConfigNegotiated();
+
+  // A modest loss rate does not prevent resumption.
+  cached_network_params.set_loss_rate_per_million(10 * 1000);  // 1%
+  crypto_stream->SetPreviousCachedNetworkParams(cached_network_params);
+  EXPECT_CALL(*connection_, ResumeConnectionState(_, _)).Times(1);
+  session_->OnConfigNegotiated();
 }
 
 TEST_P(QuicServerSessionBaseTest, BandwidthMaxEnablesResumption) {
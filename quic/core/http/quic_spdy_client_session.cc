@@ -4,6 +4,7 @@
 
 #include "quic/core/http/quic_spdy_client_session.h"
 
+#include <algorithm>
 #include <string>
 #include <utility>
 
@@ -12,6 +13,7 @@
 #include "quic/core/http/quic_server_initiated_spdy_stream.h"
 #include "quic/core/http/quic_spdy_client_stream.h"
 #include "quic/core/http/spdy_utils.h"
+#include "quic/core/http/web_transport_http3.h"
 #include "quic/core/quic_server_id.h"
 #include "quic/core/quic_utils.h"
 #include "quic/platform/api/quic_bug_tracker.h"
@@ -117,6 +119,68 @@ void QuicSpdyClientSession::AddKnownServerAddress(
   known_server_addresses_.push_back(address);
 }
 
+size_t QuicSpdyClientSession::PrewarmWebTransportSessions(
+    const std::string& authority, const std::string& path, size_t count,
+    size_t num_unidirectional_streams) {
+  if (!SupportsWebTransport()) {
+    QUIC_DLOG(INFO) << "Not pre-warming WebTransport sessions; support has "
+                       "not been negotiated.";
+    return 0;
+  }
+  size_t num_established = 0;
+  for (size_t i = 0; i < count; ++i) {
+    QuicSpdyClientStream* stream = CreateOutgoingBidirectionalStream();
+    if (stream == nullptr) {
+      break;
+    }
+    spdy::SpdyHeaderBlock headers;
+    headers[":scheme"] = "https";
+    headers[":authority"] = authority;
+    headers[":path"] = path;
+    headers[":method"] = "CONNECT";
+    headers[":protocol"] = "webtransport";
+    stream->WriteHeaders(std::move(headers), /*fin=*/false, nullptr);
+    WebTransportHttp3* web_transport = stream->web_transport();
+    if (web_transport == nullptr) {
+      QUIC_DLOG(ERROR) << "Pre-warmed CONNECT stream " << stream->id()
+                       << " did not produce a WebTransport session.";
+      stream->Reset(QUIC_STREAM_CANCELLED);
+      break;
+    }
+    web_transport->PreOpenOutgoingUnidirectionalStreams(
+        num_unidirectional_streams);
+    prewarmed_web_transport_sessions_.push_back(web_transport->id());
+    ++num_established;
+  }
+  return num_established;
+}
+
+WebTransportHttp3* QuicSpdyClientSession::TakePrewarmedWebTransportSession() {
+  // Drop pooled sessions that have been closed or rejected in the meantime.
+  auto is_gone = [this](WebTransportSessionId id) {
+    return GetWebTransportSession(id) == nullptr;
+  };
+  prewarmed_web_transport_sessions_.erase(
+      std::remove_if(prewarmed_web_transport_sessions_.begin(),
+                     prewarmed_web_transport_sessions_.end(), is_gone),
+      prewarmed_web_transport_sessions_.end());
+  if (prewarmed_web_transport_sessions_.empty()) {
+    return nullptr;
+  }
+  // Prefer a session whose CONNECT response has already arrived.
+  auto chosen = prewarmed_web_transport_sessions_.begin();
+  for (auto it = prewarmed_web_transport_sessions_.begin();
+       it != prewarmed_web_transport_sessions_.end(); ++it) {
+    if (GetWebTransportSession(*it)->ready()) {
+      chosen = it;
+      break;
+    }
+  }
+  WebTransportHttp3* session = GetWebTransportSession(*chosen);
+  prewarmed_web_transport_sessions_.erase(chosen);
+  return session;
+}
+
 void QuicSpdyClientSession::CryptoConnect() {
   QUICHE_DCHECK(flow_controller());
   crypto_stream_->CryptoConnect();
@@ -81,6 +81,29 @@ class QUIC_EXPORT_PRIVATE QuicSpdyClientSession
 
   using QuicSession::CanOpenNextOutgoingBidirectionalStream;
 
+  // Pre-establishes up to |count| WebTransport sessions to |authority| and
+  // |path| by sending the extended CONNECT requests now, so that an
+  // application can later obtain a session without paying the setup round
+  // trip at use time. Each pre-warmed session also pre-opens
+  // |num_unidirectional_streams| outgoing unidirectional streams. Returns
+  // the number of sessions actually pre-established, which is zero until the
+  // server's SETTINGS have negotiated WebTransport support. The connection's
+  // regular keep-alive PINGs prevent pooled sessions from idling out.
+  size_t PrewarmWebTransportSessions(const std::string& authority,
+                                     const std::string& path, size_t count,
+                                     size_t num_unidirectional_streams);
+
+  // Removes a pre-warmed WebTransport session from the pool and returns it,
+  // preferring sessions whose CONNECT response has already arrived. Returns
+  // nullptr if the pool is empty.
+  WebTransportHttp3* TakePrewarmedWebTransportSession();
+
+  // The number of pooled sessions, including any that have been closed or
+  // rejected since they were pre-warmed.
+  size_t num_prewarmed_web_transport_sessions() const {
+    return prewarmed_web_transport_sessions_.size();
+  }
+
   void set_respect_goaway(bool respect_goaway) {
     respect_goaway_ = respect_goaway;
   }
@@ -117,6 +140,10 @@ class QUIC_EXPORT_PRIVATE QuicSpdyClientSession
   // Server addresses that are known to the client.
   std::vector<QuicSocketAddress> known_server_addresses_;
 
+  // Pre-warmed WebTransport sessions that have not yet been handed to the
+  // application, identified by their CONNECT stream IDs.
+  std::vector<WebTransportSessionId> prewarmed_web_transport_sessions_;
+
   // If this is set to false, the client will ignore server GOAWAYs and allow
   // the creation of streams regardless of the high chance they will fail.
   bool respect_goaway_;
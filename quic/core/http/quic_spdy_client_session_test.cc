@@ -951,6 +951,17 @@ TEST_P(QuicSpdyClientSessionTest, TooManyPushPromises) {
   }
 }
 
+// WebTransport sessions cannot be pre-warmed before the server's SETTINGS
+// have negotiated WebTransport support, and an empty pool hands out nothing.
+TEST_P(QuicSpdyClientSessionTest, PrewarmWebTransportSessionsRequiresSupport) {
+  CompleteCryptoHandshake();
+  EXPECT_EQ(0u, session_->PrewarmWebTransportSessions(
+                    "www.example.org", "/echo", /*count=*/2,
+                    /*num_unidirectional_streams=*/1));
+  EXPECT_EQ(0u, session_->num_prewarmed_web_transport_sessions());
+  EXPECT_EQ(nullptr, session_->TakePrewarmedWebTransportSession());
+}
+
 // Test that upon receiving HTTP/3 SETTINGS, the settings are serialized and
 // stored into client session cache.
 TEST_P(QuicSpdyClientSessionTest, OnSettingsFrame) {
@@ -195,6 +195,23 @@ size_t QuicSpdyClientStream::SendRequest(SpdyHeaderBlock headers,
   return bytes_sent;
 }
 
+size_t QuicSpdyClientStream::SendRequestFromPrepared(
+    uint64_t prepared_headers_id, const spdy::Http2HeaderBlock& delta_headers,
+    absl::string_view body, bool fin) {
+  QuicConnection::ScopedPacketFlusher flusher(session_->connection());
+  bool send_fin_with_headers = fin && body.empty();
+  size_t bytes_sent = body.size();
+  header_bytes_written_ = WritePreparedHeaders(
+      prepared_headers_id, delta_headers, send_fin_with_headers);
+  bytes_sent += header_bytes_written_;
+
+  if (!body.empty()) {
+    WriteOrBufferBody(body, fin);
+  }
+
+  return bytes_sent;
+}
+
 bool QuicSpdyClientStream::AreHeadersValid(
     const QuicHeaderList& header_list) const {
   if (!GetQuicReloadableFlag(quic_verify_request_headers_2)) {
@@ -205,7 +222,7 @@ bool QuicSpdyClientStream::AreHeadersValid(
   }
   // Verify the presence of :status header.
   bool saw_status = false;
-  for (const std::pair<std::string, std::string>& pair : header_list) {
+  for (const auto& pair : header_list) {
     if (pair.first == ":status") {
       saw_status = true;
     } else if (absl::StrContains(pair.first, ":")) {
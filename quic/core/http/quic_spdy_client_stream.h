@@ -54,6 +54,15 @@ class QUIC_EXPORT_PRIVATE QuicSpdyClientStream : public QuicSpdyStream {
                      absl::string_view body,
                      bool fin);
 
+  // Like SendRequest(), but the request headers are the template registered
+  // with the session under |prepared_headers_id|
+  // (QuicSpdySession::RegisterPreparedHeaders()) plus |delta_headers|, so
+  // only the varying fields are encoded per request. Only usable with
+  // HTTP/3.
+  size_t SendRequestFromPrepared(uint64_t prepared_headers_id,
+                                 const spdy::Http2HeaderBlock& delta_headers,
+                                 absl::string_view body, bool fin);
+
   // Returns the response data.
   const std::string& data() { return data_; }
 
@@ -67,7 +67,7 @@ bool QuicSpdyServerStreamBase::AreHeadersValid(
   bool is_extended_connect = false;
   // Check if it is missing any required headers and if there is any disallowed
   // ones.
-  for (const std::pair<std::string, std::string>& pair : header_list) {
+  for (const auto& pair : header_list) {
     if (pair.first == ":method") {
       saw_method = true;
       if (pair.second == "CONNECT") {
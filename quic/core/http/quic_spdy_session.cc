@@ -61,6 +61,20 @@ namespace {
 #define ENDPOINT \
   (perspective() == Perspective::IS_SERVER ? "Server: " : "Client: ")
 
+// Sessions hinted to live shorter than this do not build a QPACK encoder
+// dynamic table: the insertions would not be amortized over enough header
+// blocks to pay for the encoder stream bytes.
+constexpr QuicTime::Delta kMinSessionDurationForQpackDynamicTable =
+    QuicTime::Delta::FromSeconds(1);
+
+// Loss rates at or above these thresholds shrink the QPACK encoder dynamic
+// table capacity to a half resp. a quarter of its configured value.  Only
+// applied once this many packets have been sent, so that a single lost
+// handshake packet does not dominate the estimate.
+constexpr float kQpackModerateLossRate = 0.05f;
+constexpr float kQpackSevereLossRate = 0.10f;
+constexpr QuicPacketCount kQpackMinPacketsForLossEstimate = 20;
+
 // Class to forward ACCEPT_CH frame to QuicSpdySession,
 // and ignore every other frame.
 class AlpsFrameDecoder : public HttpDecoder::Visitor {
@@ -573,8 +587,8 @@ void QuicSpdySession::OnStreamHeaderList(QuicStreamId stream_id, bool fin,
     // byte offset necessary for flow control and open stream accounting.
     size_t final_byte_offset = 0;
     for (const auto& header : header_list) {
-      const std::string& header_key = header.first;
-      const std::string& header_value = header.second;
+      const absl::string_view header_key = header.first;
+      const absl::string_view header_value = header.second;
       if (header_key == kFinalOffsetHeaderKey) {
         if (!absl::SimpleAtoi(header_value, &final_byte_offset)) {
           connection()->CloseConnection(
@@ -831,12 +845,53 @@ QpackEncoder* QuicSpdySession::qpack_encoder() {
   return qpack_encoder_.get();
 }
 
+uint64_t QuicSpdySession::RegisterPreparedHeaders(
+    const spdy::Http2HeaderBlock& headers) {
+  QUICHE_DCHECK(VersionUsesHttp3(transport_version()));
+  const uint64_t prepared_headers_id = next_prepared_headers_id_++;
+  prepared_header_fields_[prepared_headers_id] =
+      qpack_encoder_->EncodeStaticHeaderFields(headers);
+  return prepared_headers_id;
+}
+
+const std::string* QuicSpdySession::GetPreparedHeaderFields(
+    uint64_t prepared_headers_id) const {
+  auto it = prepared_header_fields_.find(prepared_headers_id);
+  if (it == prepared_header_fields_.end()) {
+    return nullptr;
+  }
+  return &it->second;
+}
+
 QpackDecoder* QuicSpdySession::qpack_decoder() {
   QUICHE_DCHECK(VersionUsesHttp3(transport_version()));
 
   return qpack_decoder_.get();
 }
 
+QuicByteCount QuicSpdySession::GetMemoryFootprint() const {
+  QuicByteCount total = QuicSession::GetMemoryFootprint();
+  if (qpack_encoder_ != nullptr) {
+    total += qpack_encoder_->dynamic_table_size();
+  }
+  if (qpack_decoder_ != nullptr) {
+    total += qpack_decoder_->dynamic_table_size();
+  }
+  return total;
+}
+
+void QuicSpdySession::OnMemoryPressure(MemoryPressureLevel level) {
+  QuicSession::OnMemoryPressure(level);
+  if (level == MemoryPressureLevel::kCritical) {
+    // The connection is closing.
+    return;
+  }
+  if (qpack_encoder_ != nullptr && qpack_encoder_->MaybeDropDynamicTable()) {
+    QUIC_DVLOG(1) << ENDPOINT
+                  << "Dropped QPACK dynamic table due to memory pressure";
+  }
+}
+
 void QuicSpdySession::OnStreamCreated(QuicSpdyStream* stream) {
   auto it = buffered_stream_priorities_.find(stream->id());
   if (it == buffered_stream_priorities_.end()) {
@@ -1050,6 +1105,39 @@ bool QuicSpdySession::VerifySettingIsZeroOrOne(uint64_t id, uint64_t value) {
   return false;
 }
 
+uint64_t QuicSpdySession::AdjustedQpackDynamicTableCapacity(
+    uint64_t maximum_table_capacity) {
+  uint64_t capacity =
+      std::min(maximum_table_capacity, qpack_maximum_dynamic_table_capacity_);
+  if (capacity == 0) {
+    return 0;
+  }
+  if (expected_session_duration_.has_value() &&
+      *expected_session_duration_ < kMinSessionDurationForQpackDynamicTable) {
+    QUIC_DVLOG(1) << ENDPOINT
+                  << "Disabling QPACK dynamic table for session expected to "
+                     "live only "
+                  << *expected_session_duration_;
+    return 0;
+  }
+  const QuicConnectionStats& stats = connection()->GetStats();
+  if (stats.packets_sent >= kQpackMinPacketsForLossEstimate) {
+    const float loss_rate =
+        static_cast<float>(stats.packets_lost) / stats.packets_sent;
+    if (loss_rate >= kQpackSevereLossRate) {
+      capacity /= 4;
+    } else if (loss_rate >= kQpackModerateLossRate) {
+      capacity /= 2;
+    }
+    if (capacity < std::min(maximum_table_capacity,
+                            qpack_maximum_dynamic_table_capacity_)) {
+      QUIC_DVLOG(1) << ENDPOINT << "Reducing QPACK dynamic table capacity to "
+                    << capacity << " due to observed loss rate " << loss_rate;
+    }
+  }
+  return capacity;
+}
+
 bool QuicSpdySession::OnSetting(uint64_t id, uint64_t value) {
   any_settings_received_ = true;
 
@@ -1077,9 +1165,15 @@ bool QuicSpdySession::OnSetting(uint64_t id, uint64_t value) {
           return false;
         }
         // However, limit the dynamic table capacity to
-        // |qpack_maximum_dynamic_table_capacity_|.
-        qpack_encoder_->SetDynamicTableCapacity(
-            std::min(value, qpack_maximum_dynamic_table_capacity_));
+        // |qpack_maximum_dynamic_table_capacity_|, further reduced for
+        // sessions expected to be short-lived and for lossy paths.
+        const uint64_t dynamic_table_capacity =
+            AdjustedQpackDynamicTableCapacity(value);
+        qpack_encoder_->SetDynamicTableCapacity(dynamic_table_capacity);
+        if (dynamic_table_capacity > 0 &&
+            qpack_encoder_template_table_ != nullptr) {
+          qpack_encoder_->WarmUpFromTemplate(*qpack_encoder_template_table_);
+        }
         break;
       }
       case SETTINGS_MAX_FIELD_SECTION_SIZE:
@@ -1466,6 +1560,9 @@ void QuicSpdySession::MaybeInitializeHttp3UnidirectionalStreams() {
   if (!send_control_stream_ && CanOpenNextOutgoingUnidirectionalStream()) {
     auto send_control = std::make_unique<QuicSendControlStream>(
         GetNextOutgoingUnidirectionalStreamId(), this, settings_);
+    if (control_stream_preamble_ != nullptr) {
+      send_control->SetPreamble(control_stream_preamble_);
+    }
     send_control_stream_ = send_control.get();
     ActivateStream(std::move(send_control));
     if (debug_visitor_) {
@@ -1654,7 +1751,8 @@ void QuicSpdySession::LogHeaderCompressionRatioHistogram(
 MessageStatus QuicSpdySession::SendHttp3Datagram(
     QuicDatagramStreamId stream_id,
     absl::optional<QuicDatagramContextId> context_id,
-    absl::string_view payload) {
+    absl::string_view payload,
+    QuicDatagramQueue::Priority priority) {
   if (!SupportsH3Datagram()) {
     QUIC_BUG(send http datagram too early)
         << "Refusing to send HTTP Datagram before SETTINGS received";
@@ -1692,7 +1790,7 @@ MessageStatus QuicSpdySession::SendHttp3Datagram(
   }
 
   QuicMemSlice slice(std::move(buffer));
-  return datagram_queue()->SendOrQueueDatagram(std::move(slice));
+  return datagram_queue()->SendOrQueueDatagram(std::move(slice), priority);
 }
 
 void QuicSpdySession::SetMaxDatagramTimeInQueueForStreamId(
@@ -25,6 +25,7 @@
 #include "quic/core/qpack/qpack_decoder_stream_sender.h"
 #include "quic/core/qpack/qpack_encoder.h"
 #include "quic/core/qpack/qpack_encoder_stream_sender.h"
+#include "quic/core/qpack/qpack_encoder_template_table.h"
 #include "quic/core/qpack/qpack_receive_stream.h"
 #include "quic/core/qpack/qpack_send_stream.h"
 #include "quic/core/quic_session.h"
@@ -240,6 +241,14 @@ class QUIC_EXPORT_PRIVATE QuicSpdySession
   QpackDecoder* qpack_decoder();
   QuicHeadersStream* headers_stream() { return headers_stream_; }
 
+  // Adds QPACK dynamic table state to the session estimate.
+  QuicByteCount GetMemoryFootprint() const override;
+
+  // In addition to the degradation done by QuicSession, drops the local
+  // QPACK encoder's dynamic table when no entry is referenced by an
+  // unacknowledged header block.
+  void OnMemoryPressure(MemoryPressureLevel level) override;
+
   const QuicHeadersStream* headers_stream() const { return headers_stream_; }
 
   // Called when the control stream receives HTTP/3 SETTINGS.
@@ -276,6 +285,40 @@ class QUIC_EXPORT_PRIVATE QuicSpdySession
         qpack_maximum_dynamic_table_capacity;
   }
 
+  // Hints how long this session is expected to stay alive, e.g. based on
+  // historical data for the client or origin.  Sessions expected to be
+  // short-lived do not build a QPACK encoder dynamic table at all: the
+  // encoder stream bytes spent on insertions would never be amortized over
+  // later header blocks.  Must be called before SETTINGS are received to
+  // take effect.
+  void set_expected_session_duration(QuicTime::Delta expected_duration) {
+    expected_session_duration_ = expected_duration;
+  }
+
+  // Sets the shared template table used to warm the QPACK encoder dynamic
+  // table when SETTINGS_QPACK_MAX_TABLE_CAPACITY is received, see
+  // QpackEncoder::WarmUpFromTemplate().  |qpack_encoder_template_table| is
+  // typically a process-level object shared by many sessions; it must be
+  // trained before this call and must outlive this session.
+  // Must not be called after SETTINGS are received.
+  void set_qpack_encoder_template_table(
+      const QpackEncoderTemplateTable* qpack_encoder_template_table) {
+    qpack_encoder_template_table_ = qpack_encoder_template_table;
+  }
+
+  // Registers |headers| as a prepared header template and returns a handle
+  // for it. The template is QPACK-encoded once, with static-table-only
+  // references so the bytes stay valid regardless of dynamic table state;
+  // streams can then send it repeatedly via
+  // QuicSpdyStream::WritePreparedHeaders(), paying per request only for the
+  // few fields that vary. Only usable with HTTP/3.
+  uint64_t RegisterPreparedHeaders(const spdy::Http2HeaderBlock& headers);
+
+  // Returns the encoded field lines registered under |prepared_headers_id|,
+  // or nullptr if the handle is unknown.
+  const std::string* GetPreparedHeaderFields(
+      uint64_t prepared_headers_id) const;
+
   // Must not be called after Initialize().
   // TODO(bnc): Move to constructor argument.
   void set_qpack_maximum_blocked_streams(
@@ -397,7 +440,8 @@ class QUIC_EXPORT_PRIVATE QuicSpdySession
   MessageStatus SendHttp3Datagram(
       QuicDatagramStreamId stream_id,
       absl::optional<QuicDatagramContextId> context_id,
-      absl::string_view payload);
+      absl::string_view payload,
+      QuicDatagramQueue::Priority priority = QuicDatagramQueue::Priority::kHigh);
   // This must not be used except by QuicSpdyStream::SetMaxDatagramTimeInQueue.
   void SetMaxDatagramTimeInQueueForStreamId(QuicStreamId stream_id,
                                             QuicTime::Delta max_time_in_queue);
@@ -529,6 +573,16 @@ class QUIC_EXPORT_PRIVATE QuicSpdySession
 
   const SettingsFrame& settings() const { return settings_; }
 
+  // Makes the send control stream write |preamble| instead of serializing
+  // SETTINGS per connection. Must be called before the control stream is
+  // created, and |preamble| must have been built from this session's
+  // settings. Intended for servers that accept many connections with
+  // identical settings and share one immutable preamble between them.
+  void set_control_stream_preamble(
+      std::shared_ptr<const QuicControlStreamPreamble> preamble) {
+    control_stream_preamble_ = std::move(preamble);
+  }
+
   // Initializes HTTP/3 unidirectional streams if not yet initialzed.
   virtual void MaybeInitializeHttp3UnidirectionalStreams();
 
@@ -587,6 +641,15 @@ class QUIC_EXPORT_PRIVATE QuicSpdySession
 
   bool VerifySettingIsZeroOrOne(uint64_t id, uint64_t value);
 
+  // Returns the QPACK encoder dynamic table capacity to use given the
+  // peer-advertised |maximum_table_capacity|.  Starts from the smaller of
+  // |maximum_table_capacity| and |qpack_maximum_dynamic_table_capacity_|,
+  // then returns zero for sessions hinted to be short-lived via
+  // set_expected_session_duration() and shrinks the capacity on paths that
+  // have already exhibited loss, where dynamic table references are more
+  // likely to block streams behind a lost encoder stream packet.
+  uint64_t AdjustedQpackDynamicTableCapacity(uint64_t maximum_table_capacity);
+
   std::unique_ptr<QpackEncoder> qpack_encoder_;
   std::unique_ptr<QpackDecoder> qpack_decoder_;
 
@@ -606,6 +669,10 @@ class QUIC_EXPORT_PRIVATE QuicSpdySession
 
   SettingsFrame settings_;
 
+  // If set, handed to the send control stream on creation so it writes
+  // these shared pre-serialized bytes instead of serializing settings_.
+  std::shared_ptr<const QuicControlStreamPreamble> control_stream_preamble_;
+
   // Maximum dynamic table capacity as defined at
   // https://quicwg.org/base-drafts/draft-ietf-quic-qpack.html#maximum-dynamic-table-capacity
   // for the decoding context.  Value will be sent via
@@ -615,6 +682,19 @@ class QUIC_EXPORT_PRIVATE QuicSpdySession
   // if a larger SETTINGS_QPACK_MAX_TABLE_CAPACITY value is received.
   uint64_t qpack_maximum_dynamic_table_capacity_;
 
+  // If not null, used to warm the encoder dynamic table when
+  // SETTINGS_QPACK_MAX_TABLE_CAPACITY is received.  Not owned.
+  const QpackEncoderTemplateTable* qpack_encoder_template_table_ = nullptr;
+
+  // If set, how long this session is expected to stay alive, see
+  // set_expected_session_duration().
+  absl::optional<QuicTime::Delta> expected_session_duration_;
+
+  // Encoded field lines of header templates registered via
+  // RegisterPreparedHeaders(), keyed by handle.
+  absl::flat_hash_map<uint64_t, std::string> prepared_header_fields_;
+  uint64_t next_prepared_headers_id_ = 1;
+
   // Maximum number of blocked streams as defined at
   // https://quicwg.org/base-drafts/draft-ietf-quic-qpack.html#blocked-streams
   // for the decoding context.  Value will be sent via
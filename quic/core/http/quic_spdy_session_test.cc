@@ -2139,8 +2139,9 @@ TEST_P(QuicSpdySessionTestServer, OnStreamFrameLost) {
   session_.MarkConnectionLevelWriteBlocked(stream2->id());
   session_.MarkConnectionLevelWriteBlocked(stream4->id());
 
-  // Lost data is retransmitted before new data, and retransmissions for crypto
-  // stream go first.
+  // Crypto retransmissions still go first, but lost data on streams 2 and 4
+  // is serviced through the write blocked list in stream order rather than
+  // ahead of new data.
   // Do not check congestion window when crypto stream has lost data.
   EXPECT_CALL(*send_algorithm, CanSend(_)).Times(0);
   if (!QuicVersionUsesCryptoFrames(transport_version())) {
@@ -2149,9 +2150,10 @@ TEST_P(QuicSpdySessionTestServer, OnStreamFrameLost) {
         .WillOnce(Return(false));
   }
   // Check congestion window for non crypto streams.
+  // Stream 2 gets the first write slot and retransmits its lost data.
   EXPECT_CALL(*send_algorithm, CanSend(_)).WillOnce(Return(true));
-  EXPECT_CALL(*stream4, OnCanWrite());
-  EXPECT_CALL(*stream4, HasPendingRetransmission()).WillOnce(Return(false));
+  EXPECT_CALL(*stream2, OnCanWrite());
+  EXPECT_CALL(*stream2, HasPendingRetransmission()).WillOnce(Return(false));
   // Connection is blocked.
   EXPECT_CALL(*send_algorithm, CanSend(_)).WillRepeatedly(Return(false));
 
@@ -2159,15 +2161,10 @@ TEST_P(QuicSpdySessionTestServer, OnStreamFrameLost) {
   EXPECT_TRUE(session_.WillingAndAbleToWrite());
 
   // Unblock connection.
-  // Stream 2 retransmits lost data.
-  EXPECT_CALL(*send_algorithm, CanSend(_)).WillOnce(Return(true));
-  EXPECT_CALL(*stream2, OnCanWrite());
-  EXPECT_CALL(*stream2, HasPendingRetransmission()).WillOnce(Return(false));
-  EXPECT_CALL(*send_algorithm, CanSend(_)).WillOnce(Return(true));
-  // Stream 2 sends new data.
-  EXPECT_CALL(*stream2, OnCanWrite());
+  // Stream 4 retransmits lost data from its write slot.
   EXPECT_CALL(*send_algorithm, CanSend(_)).WillOnce(Return(true));
   EXPECT_CALL(*stream4, OnCanWrite());
+  EXPECT_CALL(*stream4, HasPendingRetransmission()).WillOnce(Return(false));
   EXPECT_CALL(*send_algorithm, OnApplicationLimited(_));
 
   session_.OnCanWrite();
@@ -2210,15 +2207,15 @@ TEST_P(QuicSpdySessionTestServer, DonotRetransmitDataOfClosedStreams) {
   EXPECT_CALL(*connection_, OnStreamReset(stream4->id(), _));
   stream4->Reset(QUIC_STREAM_CANCELLED);
 
-  // Verify stream 4 is removed from streams with lost data list.
-  EXPECT_CALL(*stream6, OnCanWrite());
-  EXPECT_CALL(*stream6, HasPendingRetransmission()).WillOnce(Return(false));
-  EXPECT_CALL(*stream2, OnCanWrite());
-  EXPECT_CALL(*stream2, HasPendingRetransmission()).WillOnce(Return(false));
+  // Verify stream 4 is removed from streams with lost data list. The control
+  // frames buffered by the reset go out first, then streams 2 and 6
+  // retransmit lost data from their regular write slots.
   EXPECT_CALL(*connection_, SendControlFrame(_))
       .WillRepeatedly(Invoke(&ClearControlFrame));
   EXPECT_CALL(*stream2, OnCanWrite());
+  EXPECT_CALL(*stream2, HasPendingRetransmission()).WillOnce(Return(false));
   EXPECT_CALL(*stream6, OnCanWrite());
+  EXPECT_CALL(*stream6, HasPendingRetransmission()).WillOnce(Return(false));
   session_.OnCanWrite();
 }
 
@@ -2958,6 +2955,47 @@ TEST_P(QuicSpdySessionTestServer, OnSetting) {
   EXPECT_EQ(59u, hpack_encoder->CurrentHeaderTableSizeSetting());
 }
 
+TEST_P(QuicSpdySessionTestServer, QpackDynamicTableDisabledForShortSession) {
+  if (!VersionUsesHttp3(transport_version())) {
+    return;
+  }
+  CompleteHandshake();
+  EXPECT_CALL(*writer_, WritePacket(_, _, _, _, _))
+      .WillRepeatedly(Return(WriteResult(WRITE_STATUS_OK, 0)));
+
+  // A session expected to be too short-lived to amortize dynamic table
+  // insertions does not build a dynamic table at all.
+  session_.set_expected_session_duration(
+      QuicTime::Delta::FromMilliseconds(100));
+  session_.OnSetting(SETTINGS_QPACK_MAX_TABLE_CAPACITY, 1024);
+
+  QpackEncoderHeaderTable* header_table =
+      QpackEncoderPeer::header_table(session_.qpack_encoder());
+  EXPECT_EQ(1024u, header_table->maximum_dynamic_table_capacity());
+  EXPECT_EQ(0u, header_table->dynamic_table_capacity());
+}
+
+TEST_P(QuicSpdySessionTestServer, QpackDynamicTableShrunkOnLossyPath) {
+  if (!VersionUsesHttp3(transport_version())) {
+    return;
+  }
+  CompleteHandshake();
+  EXPECT_CALL(*writer_, WritePacket(_, _, _, _, _))
+      .WillRepeatedly(Return(WriteResult(WRITE_STATUS_OK, 0)));
+
+  // 12% observed loss shrinks the dynamic table to a quarter of the
+  // configured capacity.
+  QuicConnectionStats& stats = connection_->mutable_stats();
+  stats.packets_sent = 100;
+  stats.packets_lost = 12;
+  session_.OnSetting(SETTINGS_QPACK_MAX_TABLE_CAPACITY, 1024);
+
+  QpackEncoderHeaderTable* header_table =
+      QpackEncoderPeer::header_table(session_.qpack_encoder());
+  EXPECT_EQ(1024u, header_table->maximum_dynamic_table_capacity());
+  EXPECT_EQ(256u, header_table->dynamic_table_capacity());
+}
+
 TEST_P(QuicSpdySessionTestServer, FineGrainedHpackErrorCodes) {
   if (VersionUsesHttp3(transport_version())) {
     // HPACK is not used in HTTP/3.
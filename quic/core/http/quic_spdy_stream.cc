@@ -7,6 +7,7 @@
 #include <limits>
 #include <memory>
 #include <string>
+#include <vector>
 #include <utility>
 
 #include "absl/base/macros.h"
@@ -324,6 +325,10 @@ void QuicSpdyStream::WriteOrBufferBody(absl::string_view data, bool fin) {
   }
   if (!VersionUsesHttp3(transport_version()) || data.length() == 0) {
     WriteOrBufferData(data, fin, nullptr);
+    if (fin && xor_repair_encoder_ != nullptr) {
+      // Protect any trailing partial repair block.
+      MaybeSendRepairSymbols(data, fin);
+    }
     return;
   }
   QuicConnection::ScopedPacketFlusher flusher(spdy_session_->connection());
@@ -341,6 +346,10 @@ void QuicSpdyStream::WriteOrBufferBody(absl::string_view data, bool fin) {
                   << " is writing DATA frame payload of length "
                   << data.length() << " with fin " << fin;
   WriteOrBufferData(data, fin, nullptr);
+
+  if (xor_repair_encoder_ != nullptr) {
+    MaybeSendRepairSymbols(data, fin);
+  }
 }
 
 size_t QuicSpdyStream::WriteTrailers(
@@ -532,7 +541,7 @@ void QuicSpdyStream::OnStreamHeaderList(bool fin, size_t frame_len,
     std::string uaid;
     for (const auto& kv : header_list) {
       if (quiche::QuicheTextUtils::ToLower(kv.first) == kUserAgentHeaderName) {
-        uaid = kv.second;
+        uaid = std::string(kv.second);
         break;
       }
     }
@@ -1221,6 +1230,53 @@ size_t QuicSpdyStream::WriteHeadersImpl(
   return encoded_headers.size();
 }
 
+size_t QuicSpdyStream::WritePreparedHeaders(
+    uint64_t prepared_headers_id, const spdy::Http2HeaderBlock& delta_headers,
+    bool fin) {
+  QUICHE_DCHECK(VersionUsesHttp3(transport_version()));
+  const std::string* prepared_fields =
+      spdy_session_->GetPreparedHeaderFields(prepared_headers_id);
+  if (prepared_fields == nullptr) {
+    QUIC_BUG(quic_bug_prepared_headers_unknown_id)
+        << "WritePreparedHeaders called with unknown prepared headers id "
+        << prepared_headers_id;
+    return 0;
+  }
+
+  // Splice the header block together: a prefix declaring no dynamic table
+  // references, the cached template field lines, then the varying fields
+  // encoded on the spot. All parts are static-table-only, so the result is
+  // valid regardless of dynamic table state and no encoder stream bytes are
+  // needed.
+  std::string encoded_headers = QpackEncoder::SerializeStaticHeaderBlockPrefix();
+  encoded_headers.append(*prepared_fields);
+  encoded_headers.append(
+      spdy_session_->qpack_encoder()->EncodeStaticHeaderFields(delta_headers));
+
+  // Write HEADERS frame.
+  std::unique_ptr<char[]> headers_frame_header;
+  const size_t headers_frame_header_length =
+      HttpEncoder::SerializeHeadersFrameHeader(encoded_headers.size(),
+                                               &headers_frame_header);
+  unacked_frame_headers_offsets_.Add(
+      send_buffer().stream_offset(),
+      send_buffer().stream_offset() + headers_frame_header_length);
+
+  QUIC_DLOG(INFO) << ENDPOINT << "Stream " << id()
+                  << " is writing HEADERS frame header of length "
+                  << headers_frame_header_length;
+  WriteOrBufferData(absl::string_view(headers_frame_header.get(),
+                                      headers_frame_header_length),
+                    /* fin = */ false, /* ack_listener = */ nullptr);
+
+  QUIC_DLOG(INFO) << ENDPOINT << "Stream " << id()
+                  << " is writing prepared HEADERS frame payload of length "
+                  << encoded_headers.length() << " with fin " << fin;
+  WriteOrBufferData(encoded_headers, fin, nullptr);
+
+  return encoded_headers.size();
+}
+
 bool QuicSpdyStream::CanWriteNewBodyData(QuicByteCount write_size) const {
   QUICHE_DCHECK_NE(0u, write_size);
   if (!VersionUsesHttp3(transport_version())) {
@@ -1245,19 +1301,19 @@ void QuicSpdyStream::MaybeProcessReceivedWebTransportHeaders() {
   absl::optional<QuicDatagramStreamId> flow_id;
   bool version_indicated = false;
   for (const auto& header : header_list_) {
-    const std::string& header_name = header.first;
-    const std::string& header_value = header.second;
+    const absl::string_view header_name = header.first;
+    const absl::string_view header_value = header.second;
     if (header_name == ":method") {
       if (!method.empty() || header_value.empty()) {
         return;
       }
-      method = header_value;
+      method = std::string(header_value);
     }
     if (header_name == ":protocol") {
       if (!protocol.empty() || header_value.empty()) {
         return;
       }
-      protocol = header_value;
+      protocol = std::string(header_value);
     }
     if (header_name == "datagram-flow-id") {
       if (spdy_session_->http_datagram_support() !=
@@ -1557,12 +1613,50 @@ void QuicSpdyStream::WriteGreaseCapsule() {
   WriteCapsule(capsule, /*fin=*/false);
 }
 
+void QuicSpdyStream::MarkLossSensitive() {
+  if (!VersionUsesHttp3(transport_version()) ||
+      xor_repair_encoder_ != nullptr) {
+    return;
+  }
+  xor_repair_encoder_ = std::make_unique<QuicXorRepairEncoder>();
+}
+
+void QuicSpdyStream::MaybeSendRepairSymbols(absl::string_view data, bool fin) {
+  if (!spdy_session_->SupportsH3Datagram()) {
+    // The peer never negotiated HTTP/3 datagram support (or its SETTINGS
+    // have not arrived yet); repair symbols cannot be delivered. The stream
+    // simply runs without repair protection.
+    return;
+  }
+  // The loss detected by the loss algorithm is surfaced through connection
+  // stats; adapt the repair rate before absorbing new payload.
+  const QuicConnectionStats& stats =
+      spdy_session_->connection()->GetStats();
+  if (stats.packets_sent > 0) {
+    xor_repair_encoder_->OnLossRateUpdated(static_cast<float>(stats.packets_lost) /
+                                           stats.packets_sent);
+  }
+  std::vector<std::string> repair_payloads;
+  xor_repair_encoder_->AbsorbSourceData(data, &repair_payloads);
+  if (fin) {
+    xor_repair_encoder_->Flush(&repair_payloads);
+  }
+  for (const std::string& payload : repair_payloads) {
+    // Repair symbols are pure redundancy; let them be dropped first if the
+    // datagram queue backs up.
+    SendHttp3Datagram(absl::nullopt, payload,
+                      QuicDatagramQueue::Priority::kLow);
+  }
+}
+
 MessageStatus QuicSpdyStream::SendHttp3Datagram(
     absl::optional<QuicDatagramContextId> context_id,
-    absl::string_view payload) {
+    absl::string_view payload,
+    QuicDatagramQueue::Priority priority) {
   QuicDatagramStreamId stream_id =
       datagram_flow_id_.has_value() ? datagram_flow_id_.value() : id();
-  return spdy_session_->SendHttp3Datagram(stream_id, context_id, payload);
+  return spdy_session_->SendHttp3Datagram(stream_id, context_id, payload,
+                                          priority);
 }
 
 void QuicSpdyStream::RegisterHttp3DatagramRegistrationVisitor(
@@ -1891,8 +1985,8 @@ constexpr bool isInvalidHeaderNameCharacter(unsigned char c) {
 
 bool QuicSpdyStream::AreHeadersValid(const QuicHeaderList& header_list) const {
   QUICHE_DCHECK(GetQuicReloadableFlag(quic_verify_request_headers_2));
-  for (const std::pair<std::string, std::string>& pair : header_list) {
-    const std::string& name = pair.first;
+  for (const auto& pair : header_list) {
+    const absl::string_view name = pair.first;
     if (std::any_of(name.begin(), name.end(), isInvalidHeaderNameCharacter)) {
       QUIC_DLOG(ERROR) << "Invalid request header " << name;
       return false;
@@ -26,10 +26,12 @@
 #include "quic/core/http/quic_spdy_stream_body_manager.h"
 #include "quic/core/http/web_transport_stream_adapter.h"
 #include "quic/core/qpack/qpack_decoded_headers_accumulator.h"
+#include "quic/core/quic_datagram_queue.h"
 #include "quic/core/quic_error_codes.h"
 #include "quic/core/quic_packets.h"
 #include "quic/core/quic_stream.h"
 #include "quic/core/quic_stream_sequencer.h"
+#include "quic/core/quic_xor_repair_engine.h"
 #include "quic/core/quic_types.h"
 #include "quic/core/web_transport_interface.h"
 #include "quic/platform/api/quic_export.h"
@@ -126,6 +128,17 @@ class QUIC_EXPORT_PRIVATE QuicSpdyStream
       spdy::SpdyHeaderBlock header_block, bool fin,
       QuicReferenceCountedPointer<QuicAckListenerInterface> ack_listener);
 
+  // Writes a HEADERS frame whose field lines are the template registered
+  // with the session under |prepared_headers_id|
+  // (QuicSpdySession::RegisterPreparedHeaders()) followed by
+  // |delta_headers|, encoded on the spot with static-table-only references.
+  // This skips re-encoding the unchanging bulk of a repeated request.
+  // Only usable with HTTP/3. Returns the number of bytes sent, or 0 if the
+  // handle is unknown.
+  size_t WritePreparedHeaders(uint64_t prepared_headers_id,
+                              const spdy::Http2HeaderBlock& delta_headers,
+                              bool fin);
+
   // Sends |data| to the peer, or buffers if it can't be sent immediately.
   void WriteOrBufferBody(absl::string_view data, bool fin);
 
@@ -250,11 +263,21 @@ class QUIC_EXPORT_PRIVATE QuicSpdyStream
   bool OnCapsule(const Capsule& capsule) override;
   void OnCapsuleParseFailure(const std::string& error_message) override;
 
+  // Marks this stream as loss sensitive: outgoing body bytes are covered by
+  // XOR-coded repair symbols sent as HTTP/3 datagrams on this stream, which
+  // lets the peer recover a single lost packet per repair block without
+  // waiting a round trip for a retransmission. The repair rate adapts to the
+  // loss rate observed by loss detection. Only has an effect for HTTP/3.
+  void MarkLossSensitive();
+  bool is_loss_sensitive() const { return xor_repair_encoder_ != nullptr; }
+
   // Sends an HTTP/3 datagram. The stream and context IDs are not part of
-  // |payload|.
+  // |payload|.  |priority| selects the drop-priority lane the datagram is
+  // queued into if it cannot be sent immediately.
   MessageStatus SendHttp3Datagram(
       absl::optional<QuicDatagramContextId> context_id,
-      absl::string_view payload);
+      absl::string_view payload,
+      QuicDatagramQueue::Priority priority = QuicDatagramQueue::Priority::kHigh);
 
   class QUIC_EXPORT_PRIVATE Http3DatagramVisitor {
    public:
@@ -431,8 +454,16 @@ class QUIC_EXPORT_PRIVATE QuicSpdyStream
   // Whether datagram contexts should be used on this stream.
   bool ShouldUseDatagramContexts() const;
 
+  // Feeds |data| to the XOR repair encoder and sends any completed repair
+  // symbols as low drop-priority HTTP/3 datagrams. Flushes a partial repair
+  // block when |fin| is true.
+  void MaybeSendRepairSymbols(absl::string_view data, bool fin);
+
   QuicSpdySession* spdy_session_;
 
+  // Non-null if MarkLossSensitive() has been called.
+  std::unique_ptr<QuicXorRepairEncoder> xor_repair_encoder_;
+
   bool on_body_available_called_because_sequencer_is_closed_;
 
   Visitor* visitor_;
@@ -4,6 +4,8 @@
 
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "absl/base/macros.h"
 #include "absl/strings/string_view.h"
@@ -22,7 +24,7 @@ const bool kExpectFinalByteOffset = true;
 const bool kDoNotExpectFinalByteOffset = false;
 
 static std::unique_ptr<QuicHeaderList> FromList(
-    const QuicHeaderList::ListType& src) {
+    const std::vector<std::pair<std::string, std::string>>& src) {
   std::unique_ptr<QuicHeaderList> headers(new QuicHeaderList);
   headers->OnHeaderBlockStart();
   for (const auto& p : src) {
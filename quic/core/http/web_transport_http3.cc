@@ -271,6 +271,20 @@ WebTransportStream* WebTransportHttp3::OpenOutgoingBidirectionalStream() {
 }
 
 WebTransportStream* WebTransportHttp3::OpenOutgoingUnidirectionalStream() {
+  while (!preopened_unidirectional_streams_.empty()) {
+    const QuicStreamId stream_id = preopened_unidirectional_streams_.front();
+    preopened_unidirectional_streams_.pop_front();
+    if (!streams_.contains(stream_id)) {
+      // The pre-opened stream was closed while pooled.
+      continue;
+    }
+    QuicStream* stream = session_->GetActiveStream(stream_id);
+    if (stream == nullptr) {
+      continue;
+    }
+    return static_cast<WebTransportHttp3UnidirectionalStream*>(stream)
+        ->interface();
+  }
   WebTransportHttp3UnidirectionalStream* stream =
       session_->CreateOutgoingUnidirectionalWebTransportStream(this);
   if (stream == nullptr) {
@@ -280,11 +294,30 @@ WebTransportStream* WebTransportHttp3::OpenOutgoingUnidirectionalStream() {
   return stream->interface();
 }
 
+void WebTransportHttp3::PreOpenOutgoingUnidirectionalStreams(size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    WebTransportHttp3UnidirectionalStream* stream =
+        session_->CreateOutgoingUnidirectionalWebTransportStream(this);
+    if (stream == nullptr) {
+      // Out of stream flow control credit; pre-open the rest on demand.
+      return;
+    }
+    preopened_unidirectional_streams_.push_back(stream->id());
+  }
+}
+
 MessageStatus WebTransportHttp3::SendOrQueueDatagram(QuicMemSlice datagram) {
   return connect_stream_->SendHttp3Datagram(
       context_id_, absl::string_view(datagram.data(), datagram.length()));
 }
 
+MessageStatus WebTransportHttp3::SendOrQueueDatagram(
+    QuicMemSlice datagram, QuicDatagramQueue::Priority priority) {
+  return connect_stream_->SendHttp3Datagram(
+      context_id_, absl::string_view(datagram.data(), datagram.length()),
+      priority);
+}
+
 QuicByteCount WebTransportHttp3::GetMaxDatagramSize() const {
   return connect_stream_->GetMaxDatagramSize(context_id_);
 }
@@ -294,6 +327,18 @@ void WebTransportHttp3::SetDatagramMaxTimeInQueue(
   connect_stream_->SetMaxDatagramTimeInQueue(max_time_in_queue);
 }
 
+void WebTransportHttp3::SetDatagramMaxTimeInQueue(
+    QuicDatagramQueue::Priority priority, QuicTime::Delta max_time_in_queue) {
+  // TODO(b/184598230): scope this to the session once the queue is
+  // per-session rather than per-connection.
+  session_->datagram_queue()->SetMaxTimeInQueue(priority, max_time_in_queue);
+}
+
+uint64_t WebTransportHttp3::GetDatagramsExpired(
+    QuicDatagramQueue::Priority priority) const {
+  return session_->datagram_queue()->expired_datagram_count(priority);
+}
+
 void WebTransportHttp3::OnHttp3Datagram(
     QuicStreamId stream_id, absl::optional<QuicDatagramContextId> context_id,
     absl::string_view payload) {
@@ -12,6 +12,7 @@
 #include "absl/types/optional.h"
 #include "quic/core/http/quic_spdy_session.h"
 #include "quic/core/http/web_transport_stream_adapter.h"
+#include "quic/core/quic_datagram_queue.h"
 #include "quic/core/quic_error_codes.h"
 #include "quic/core/quic_stream.h"
 #include "quic/core/quic_types.h"
@@ -84,10 +85,28 @@ class QUIC_EXPORT_PRIVATE WebTransportHttp3
   WebTransportStream* OpenOutgoingBidirectionalStream() override;
   WebTransportStream* OpenOutgoingUnidirectionalStream() override;
 
+  // Opens up to |count| outgoing unidirectional streams ahead of time; later
+  // calls to OpenOutgoingUnidirectionalStream() hand out the pre-opened
+  // streams before creating new ones. Pre-opening at session setup moves
+  // stream creation and the preamble write off the application's first-send
+  // path.
+  void PreOpenOutgoingUnidirectionalStreams(size_t count);
+
   MessageStatus SendOrQueueDatagram(QuicMemSlice datagram) override;
   QuicByteCount GetMaxDatagramSize() const override;
   void SetDatagramMaxTimeInQueue(QuicTime::Delta max_time_in_queue) override;
 
+  // Extensions beyond the WebTransportSession interface: queues the datagram
+  // into the given drop-priority lane, configures a lane's maximum queueing
+  // time, and reports the number of datagrams a lane has dropped due to
+  // expiry.  This lets an application shed its least important datagrams
+  // under congestion while more important ones survive.
+  MessageStatus SendOrQueueDatagram(QuicMemSlice datagram,
+                                    QuicDatagramQueue::Priority priority);
+  void SetDatagramMaxTimeInQueue(QuicDatagramQueue::Priority priority,
+                                 QuicTime::Delta max_time_in_queue);
+  uint64_t GetDatagramsExpired(QuicDatagramQueue::Priority priority) const;
+
   // From QuicSpdyStream::Http3DatagramVisitor.
   void OnHttp3Datagram(QuicStreamId stream_id,
                        absl::optional<QuicDatagramContextId> context_id,
@@ -129,6 +148,8 @@ class QUIC_EXPORT_PRIVATE WebTransportHttp3
   absl::flat_hash_set<QuicStreamId> streams_;
   quiche::QuicheCircularDeque<QuicStreamId> incoming_bidirectional_streams_;
   quiche::QuicheCircularDeque<QuicStreamId> incoming_unidirectional_streams_;
+  // Outgoing unidirectional streams opened ahead of application demand.
+  quiche::QuicheCircularDeque<QuicStreamId> preopened_unidirectional_streams_;
 
   bool close_sent_ = false;
   bool close_received_ = false;
@@ -31,6 +31,16 @@ void QpackDecodedHeadersAccumulator::OnHeaderDecoded(absl::string_view name,
                                                      absl::string_view value) {
   QUICHE_DCHECK(!error_detected_);
 
+  if (in_pseudo_header_prefix_) {
+    if (!name.empty() && name[0] == ':') {
+      if (early_header_visitor_ != nullptr) {
+        early_header_visitor_->OnPseudoHeaderDecoded(name, value);
+      }
+    } else {
+      in_pseudo_header_prefix_ = false;
+    }
+  }
+
   uncompressed_header_bytes_without_overhead_ += name.size() + value.size();
 
   if (header_list_size_limit_exceeded_) {
@@ -50,6 +50,22 @@ class QUIC_EXPORT_PRIVATE QpackDecodedHeadersAccumulator
                                        absl::string_view error_message) = 0;
   };
 
+  // Optional visitor that observes pseudo-headers as soon as each one
+  // decodes, before the remainder of the header block is processed. This
+  // lets e.g. a router pick a backend from :authority and :path and start
+  // connection establishment concurrently with decoding the remaining
+  // headers. Callbacks stop at the first non-pseudo header field. The
+  // string views are only valid for the duration of the call; the final
+  // OnHeadersDecoded() or OnHeaderDecodingError() still follows as usual
+  // and remains authoritative.
+  class QUIC_EXPORT_PRIVATE EarlyHeaderVisitor {
+   public:
+    virtual ~EarlyHeaderVisitor() = default;
+
+    virtual void OnPseudoHeaderDecoded(absl::string_view name,
+                                       absl::string_view value) = 0;
+  };
+
   QpackDecodedHeadersAccumulator(QuicStreamId id,
                                  QpackDecoder* qpack_decoder,
                                  Visitor* visitor,
@@ -74,9 +90,20 @@ class QUIC_EXPORT_PRIVATE QpackDecodedHeadersAccumulator
   // Must not be called more that once.
   void EndHeaderBlock();
 
+  // Sets the visitor notified of pseudo-headers as they decode. May be
+  // nullptr to stop notifications. Must be called before Decode().
+  void set_early_header_visitor(EarlyHeaderVisitor* early_header_visitor) {
+    early_header_visitor_ = early_header_visitor;
+  }
+
  private:
   std::unique_ptr<QpackProgressiveDecoder> decoder_;
   Visitor* visitor_;
+  // May be nullptr. Notified of pseudo-headers until the first non-pseudo
+  // header field decodes.
+  EarlyHeaderVisitor* early_header_visitor_ = nullptr;
+  // True while decoded header fields are still in the pseudo-header prefix.
+  bool in_pseudo_header_prefix_ = true;
   // Maximum header list size including overhead.
   size_t max_header_list_size_;
   // Uncompressed header list size including overhead, for enforcing the limit.
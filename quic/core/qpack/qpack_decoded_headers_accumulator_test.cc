@@ -5,6 +5,9 @@
 #include "quic/core/qpack/qpack_decoded_headers_accumulator.h"
 
 #include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "absl/strings/escaping.h"
 #include "absl/strings/string_view.h"
@@ -51,6 +54,27 @@ class MockVisitor : public QpackDecodedHeadersAccumulator::Visitor {
               (override));
 };
 
+// Records pseudo-headers surfaced during decoding.
+class RecordingEarlyHeaderVisitor
+    : public QpackDecodedHeadersAccumulator::EarlyHeaderVisitor {
+ public:
+  ~RecordingEarlyHeaderVisitor() override = default;
+
+  void OnPseudoHeaderDecoded(absl::string_view name,
+                             absl::string_view value) override {
+    pseudo_headers_.push_back(
+        std::make_pair(std::string(name), std::string(value)));
+  }
+
+  const std::vector<std::pair<std::string, std::string>>& pseudo_headers()
+      const {
+    return pseudo_headers_;
+  }
+
+ private:
+  std::vector<std::pair<std::string, std::string>> pseudo_headers_;
+};
+
 }  // anonymous namespace
 
 class QpackDecodedHeadersAccumulatorTest : public QuicTest {
@@ -139,6 +163,38 @@ TEST_F(QpackDecodedHeadersAccumulatorTest, Success) {
   EXPECT_EQ(encoded_data.size(), header_list.compressed_header_bytes());
 }
 
+// Pseudo-headers are surfaced to the early header visitor as soon as they
+// decode, before EndHeaderBlock(), and forwarding stops at the first
+// non-pseudo header field.
+TEST_F(QpackDecodedHeadersAccumulatorTest, EarlyHeaderVisitor) {
+  RecordingEarlyHeaderVisitor early_header_visitor;
+  accumulator_.set_early_header_visitor(&early_header_visitor);
+
+  accumulator_.Decode(absl::HexStringToBytes(
+      "0000"                // header block prefix
+      "d1"                  // static table entry 17: ":method: GET"
+      "253a70617468012f"    // ":path: /"
+      "23666f6f03626172"    // "foo: bar"
+      "253a6c6174650178"));  // ":late: x", after the pseudo-header prefix
+
+  // Pseudo-headers preceding the first non-pseudo field are available before
+  // the header block completes.
+  EXPECT_THAT(early_header_visitor.pseudo_headers(),
+              ElementsAre(Pair(":method", "GET"), Pair(":path", "/")));
+
+  QuicHeaderList header_list;
+  EXPECT_CALL(visitor_, OnHeadersDecoded(_, false))
+      .WillOnce(SaveArg<0>(&header_list));
+  accumulator_.EndHeaderBlock();
+
+  // The complete header list is unaffected by the early visitor.
+  EXPECT_THAT(header_list,
+              ElementsAre(Pair(":method", "GET"), Pair(":path", "/"),
+                          Pair("foo", "bar"), Pair(":late", "x")));
+  EXPECT_THAT(early_header_visitor.pseudo_headers(),
+              ElementsAre(Pair(":method", "GET"), Pair(":path", "/")));
+}
+
 // Test that Decode() calls are not ignored after header list limit is exceeded,
 // otherwise decoding could fail with "incomplete header block" error.
 TEST_F(QpackDecodedHeadersAccumulatorTest, ExceedLimitThenSplitInstruction) {
@@ -7,8 +7,8 @@
 
 #include <cstdint>
 #include <memory>
-#include <set>
 
+#include "absl/container/flat_hash_set.h"
 #include "absl/strings/string_view.h"
 #include "quic/core/qpack/qpack_decoder_stream_sender.h"
 #include "quic/core/qpack/qpack_encoder_stream_receiver.h"
@@ -103,6 +103,11 @@ class QUIC_EXPORT_PRIVATE QpackDecoder
   }
 
   // True if any dynamic table entries have been referenced from a header block.
+  // Size of the dynamic table in bytes, including the per-entry overhead.
+  uint64_t dynamic_table_size() const {
+    return header_table_.dynamic_table_size();
+  }
+
   bool dynamic_table_entry_referenced() const {
     return header_table_.dynamic_table_entry_referenced();
   }
@@ -112,7 +117,12 @@ class QUIC_EXPORT_PRIVATE QpackDecoder
   QpackEncoderStreamReceiver encoder_stream_receiver_;
   QpackDecoderStreamSender decoder_stream_sender_;
   QpackDecoderHeaderTable header_table_;
-  std::set<QuicStreamId> blocked_streams_;
+  // Streams currently blocked on dynamic table insertions.  Only used to
+  // enforce |maximum_blocked_streams_|; wakeups on Insert Count advancement
+  // are driven by the required-insert-count ordered observer index in
+  // QpackDecoderHeaderTable, which only touches streams whose requirement is
+  // satisfied.
+  absl::flat_hash_set<QuicStreamId> blocked_streams_;
   const uint64_t maximum_blocked_streams_;
 
   // Known Received Count is the number of insertions the encoder has received
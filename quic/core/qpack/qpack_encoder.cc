@@ -5,10 +5,12 @@
 #include "quic/core/qpack/qpack_encoder.h"
 
 #include <algorithm>
+#include <limits>
 #include <utility>
 
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "quic/core/qpack/qpack_encoder_template_table.h"
 #include "quic/core/qpack/qpack_index_conversions.h"
 #include "quic/core/qpack/qpack_instruction_encoder.h"
 #include "quic/core/qpack/qpack_required_insert_count.h"
@@ -37,7 +39,8 @@ QpackEncoder::QpackEncoder(
     : decoder_stream_error_delegate_(decoder_stream_error_delegate),
       decoder_stream_receiver_(this),
       maximum_blocked_streams_(0),
-      header_list_count_(0) {
+      header_list_count_(0),
+      speculative_insertions_enabled_(false) {
   QUICHE_DCHECK(decoder_stream_error_delegate_);
 }
 
@@ -147,6 +150,18 @@ QpackEncoder::Representations QpackEncoder::FirstPassEncode(
           // Entry is draining, needs to be duplicated.
           if (!blocking_allowed) {
             blocked_stream_limit_exhausted = true;
+            if (speculative_insertions_enabled_ &&
+                QpackEntry::Size(name, value) <=
+                    header_table_.MaxInsertSizeWithoutEvictingGivenEntry(
+                        std::min(smallest_blocking_index, index))) {
+              // Duplicate the entry anyway, without referencing the copy from
+              // this header block.  Subsequent header blocks can reference it
+              // without blocking as soon as it is acknowledged.
+              encoder_stream_sender_.SendDuplicate(
+                  QpackAbsoluteIndexToEncoderStreamRelativeIndex(
+                      index, header_table_.inserted_entry_count()));
+              header_table_.InsertEntry(name, value);
+            }
           } else if (QpackEntry::Size(name, value) >
                      header_table_.MaxInsertSizeWithoutEvictingGivenEntry(
                          std::min(smallest_blocking_index, index))) {
@@ -193,6 +208,17 @@ QpackEncoder::Representations QpackEncoder::FirstPassEncode(
             break;
           }
 
+          if (!blocking_allowed && speculative_insertions_enabled_ &&
+              QpackEntry::Size(name, value) <=
+                  header_table_.MaxInsertSizeWithoutEvictingGivenEntry(
+                      smallest_blocking_index)) {
+            // Speculatively insert the entry for the benefit of subsequent
+            // header blocks.
+            encoder_stream_sender_.SendInsertWithNameReference(is_static, index,
+                                                               value);
+            header_table_.InsertEntry(name, value);
+          }
+
           // Emit literal field with name reference.
           representations.push_back(EncodeLiteralHeaderFieldWithNameReference(
               is_static, index, value, referred_indices));
@@ -202,6 +228,19 @@ QpackEncoder::Representations QpackEncoder::FirstPassEncode(
 
         if (!blocking_allowed) {
           blocked_stream_limit_exhausted = true;
+          if (speculative_insertions_enabled_ &&
+              QpackEntry::Size(name, value) <=
+                  header_table_.MaxInsertSizeWithoutEvictingGivenEntry(
+                      std::min(smallest_blocking_index, index))) {
+            // Speculatively insert the entry for the benefit of subsequent
+            // header blocks.
+            encoder_stream_sender_.SendInsertWithNameReference(
+                is_static,
+                QpackAbsoluteIndexToEncoderStreamRelativeIndex(
+                    index, header_table_.inserted_entry_count()),
+                value);
+            header_table_.InsertEntry(name, value);
+          }
         } else if (QpackEntry::Size(name, value) >
                    header_table_.MaxInsertSizeWithoutEvictingGivenEntry(
                        std::min(smallest_blocking_index, index))) {
@@ -246,6 +285,15 @@ QpackEncoder::Representations QpackEncoder::FirstPassEncode(
         // If allowed, insert entry and refer to it.
         if (!blocking_allowed) {
           blocked_stream_limit_exhausted = true;
+          if (speculative_insertions_enabled_ &&
+              QpackEntry::Size(name, value) <=
+                  header_table_.MaxInsertSizeWithoutEvictingGivenEntry(
+                      smallest_blocking_index)) {
+            // Speculatively insert the entry for the benefit of subsequent
+            // header blocks.
+            encoder_stream_sender_.SendInsertWithoutNameReference(name, value);
+            header_table_.InsertEntry(name, value);
+          }
         } else if (QpackEntry::Size(name, value) >
                    header_table_.MaxInsertSizeWithoutEvictingGivenEntry(
                        smallest_blocking_index)) {
@@ -261,10 +309,9 @@ QpackEncoder::Representations QpackEncoder::FirstPassEncode(
           break;
         }
 
-        // Encode entry as string literals.
-        // TODO(b/112770235): Consider also adding to dynamic table to improve
-        // compression ratio for subsequent header blocks with peers that do not
-        // allow any blocked streams.
+        // Encode entry as string literals.  If speculative insertions are
+        // enabled, the entry may have been added to the dynamic table above to
+        // improve the compression ratio of subsequent header blocks.
         representations.push_back(EncodeLiteralHeaderField(name, value));
 
         break;
@@ -362,20 +409,81 @@ std::string QpackEncoder::EncodeHeaderList(
   QpackBlockingManager::IndexSet referred_indices;
 
   // First pass: encode into |representations|.
-  Representations representations =
-      FirstPassEncode(stream_id, header_list, &referred_indices,
-                      encoder_stream_sent_byte_count);
+  QuicByteCount encoder_stream_bytes = 0;
+  Representations representations = FirstPassEncode(
+      stream_id, header_list, &referred_indices, &encoder_stream_bytes);
+  if (encoder_stream_sent_byte_count != nullptr) {
+    *encoder_stream_sent_byte_count = encoder_stream_bytes;
+  }
 
   const uint64_t required_insert_count =
       referred_indices.empty()
           ? 0
           : QpackBlockingManager::RequiredInsertCount(referred_indices);
+  if (required_insert_count > blocking_manager_.known_received_count()) {
+    // The header block references entries the decoder has not acknowledged
+    // yet, so it may block the stream it is sent on.
+    ++stats_.potentially_blocked_header_lists;
+  }
   if (!referred_indices.empty()) {
     blocking_manager_.OnHeaderBlockSent(stream_id, std::move(referred_indices));
   }
 
   // Second pass.
-  return SecondPassEncode(std::move(representations), required_insert_count);
+  std::string encoded_headers =
+      SecondPassEncode(std::move(representations), required_insert_count);
+
+  for (const auto& header : header_list) {
+    stats_.uncompressed_header_bytes +=
+        header.first.size() + header.second.size();
+  }
+  stats_.compressed_header_bytes += encoded_headers.size();
+  stats_.encoder_stream_sent_bytes += encoder_stream_bytes;
+
+  return encoded_headers;
+}
+
+std::string QpackEncoder::EncodeStaticHeaderFields(
+    const spdy::Http2HeaderBlock& header_list) const {
+  QpackInstructionEncoder instruction_encoder;
+  std::string encoded_headers;
+
+  for (const auto& header : ValueSplittingHeaderList(&header_list)) {
+    absl::string_view name = header.first;
+    absl::string_view value = header.second;
+
+    uint64_t index;
+    switch (header_table_.FindStaticHeaderField(name, value, &index)) {
+      case QpackEncoderHeaderTable::MatchType::kNameAndValue:
+        instruction_encoder.Encode(
+            EncodeIndexedHeaderField(/*is_static=*/true, index,
+                                     /*referred_indices=*/nullptr),
+            &encoded_headers);
+        break;
+      case QpackEncoderHeaderTable::MatchType::kName:
+        instruction_encoder.Encode(
+            EncodeLiteralHeaderFieldWithNameReference(
+                /*is_static=*/true, index, value,
+                /*referred_indices=*/nullptr),
+            &encoded_headers);
+        break;
+      case QpackEncoderHeaderTable::MatchType::kNoMatch:
+        instruction_encoder.Encode(EncodeLiteralHeaderField(name, value),
+                                   &encoded_headers);
+        break;
+    }
+  }
+
+  return encoded_headers;
+}
+
+// static
+std::string QpackEncoder::SerializeStaticHeaderBlockPrefix() {
+  QpackInstructionEncoder instruction_encoder;
+  std::string prefix;
+  instruction_encoder.Encode(
+      Representation::Prefix(/*required_insert_count=*/0), &prefix);
+  return prefix;
 }
 
 bool QpackEncoder::SetMaximumDynamicTableCapacity(
@@ -393,6 +501,48 @@ void QpackEncoder::SetDynamicTableCapacity(uint64_t dynamic_table_capacity) {
   QUICHE_DCHECK(success);
 }
 
+bool QpackEncoder::WarmUpFromTemplate(
+    const QpackEncoderTemplateTable& template_table) {
+  if (header_table_.inserted_entry_count() > 0) {
+    // The table already diverged from the template; the pre-encoded
+    // instructions assume an empty table.
+    return false;
+  }
+  if (template_table.total_entry_size() >
+      header_table_.dynamic_table_capacity()) {
+    return false;
+  }
+
+  encoder_stream_sender_.SendPreEncodedInstructions(
+      template_table.serialized_insertions());
+  // Do not flush encoder stream.  Like the Set Dynamic Table Capacity
+  // instruction, this write can safely be delayed until more instructions are
+  // written.
+
+  for (const auto& entry : template_table.entries()) {
+    header_table_.InsertEntry(entry.first, entry.second);
+  }
+
+  return true;
+}
+
+bool QpackEncoder::MaybeDropDynamicTable() {
+  if (header_table_.dynamic_table_size() == 0) {
+    return false;
+  }
+  if (blocking_manager_.smallest_blocking_index() !=
+      std::numeric_limits<uint64_t>::max()) {
+    // Some entry is referenced by an unacknowledged header block and must not
+    // be evicted.
+    return false;
+  }
+  SetDynamicTableCapacity(0);
+  // Flush so that the peer can release its mirror of the table promptly;
+  // further header blocks may be a long time coming.
+  encoder_stream_sender_.Flush();
+  return true;
+}
+
 bool QpackEncoder::SetMaximumBlockedStreams(uint64_t maximum_blocked_streams) {
   if (maximum_blocked_streams < maximum_blocked_streams_) {
     return false;
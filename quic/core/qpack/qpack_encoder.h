@@ -24,6 +24,8 @@
 
 namespace quic {
 
+class QpackEncoderTemplateTable;
+
 namespace test {
 
 class QpackEncoderPeer;
@@ -45,6 +47,21 @@ class QUIC_EXPORT_PRIVATE QpackEncoder
                                       absl::string_view error_message) = 0;
   };
 
+  // Counters describing how well header compression is paying off on this
+  // connection, and what it costs in terms of potentially blocked streams.
+  struct QUIC_EXPORT_PRIVATE Stats {
+    // Sum of the name and value sizes of all encoded header fields.
+    uint64_t uncompressed_header_bytes = 0;
+    // Total size of the encoded header blocks.
+    uint64_t compressed_header_bytes = 0;
+    // Bytes sent on the encoder stream to insert dynamic table entries.
+    uint64_t encoder_stream_sent_bytes = 0;
+    // Number of header blocks that referenced dynamic table entries not yet
+    // acknowledged by the decoder, and therefore risked blocking the stream
+    // they were sent on.
+    uint64_t potentially_blocked_header_lists = 0;
+  };
+
   QpackEncoder(DecoderStreamErrorDelegate* decoder_stream_error_delegate);
   ~QpackEncoder() override;
 
@@ -55,6 +72,21 @@ class QUIC_EXPORT_PRIVATE QpackEncoder
                                const spdy::Http2HeaderBlock& header_list,
                                QuicByteCount* encoder_stream_sent_byte_count);
 
+  // Encodes |header_list| using only static table references and string
+  // literals, consulting neither the dynamic table nor the encoder stream.
+  // The returned bytes carry no header block prefix and are independent of
+  // connection state, so they can be encoded once and spliced into any
+  // header block whose prefix declares no dynamic table references.  Used
+  // by QuicSpdySession::RegisterPreparedHeaders() to cache the encoding of
+  // repeated request templates.
+  std::string EncodeStaticHeaderFields(
+      const spdy::Http2HeaderBlock& header_list) const;
+
+  // Serializes the header block prefix of a block without dynamic table
+  // references, suitable for prepending to EncodeStaticHeaderFields()
+  // output.
+  static std::string SerializeStaticHeaderBlockPrefix();
+
   // Set maximum dynamic table capacity to |maximum_dynamic_table_capacity|,
   // measured in bytes.  Called when SETTINGS_QPACK_MAX_TABLE_CAPACITY is
   // received.  Encoder needs to know this value so that it can calculate
@@ -69,12 +101,40 @@ class QUIC_EXPORT_PRIVATE QpackEncoder
   // Also sends Set Dynamic Table Capacity instruction on encoder stream.
   void SetDynamicTableCapacity(uint64_t dynamic_table_capacity);
 
+  // Populates the dynamic table with the entries of |template_table| by
+  // replaying its pre-encoded insert instructions on the encoder stream.
+  // Must be called after SetDynamicTableCapacity() and before any entry has
+  // been inserted, typically when SETTINGS_QPACK_MAX_TABLE_CAPACITY is
+  // received.  Returns false without modifying any state if entries have
+  // already been inserted or if the template does not fit in the dynamic
+  // table capacity in its entirety (a subset could not reuse the shared
+  // serialized instructions).  The per-connection table diverges from the
+  // template independently afterwards.
+  bool WarmUpFromTemplate(const QpackEncoderTemplateTable& template_table);
+
+  // Sets the dynamic table capacity to zero and evicts all entries, unless
+  // an entry is still referenced by an unacknowledged header block, in which
+  // case the table is left untouched.  Returns true if the table was dropped.
+  // Called under memory pressure; trades compression ratio for memory on
+  // both endpoints.
+  bool MaybeDropDynamicTable();
+
   // Set maximum number of blocked streams.
   // Called when SETTINGS_QPACK_BLOCKED_STREAMS is received.
   // Returns true if |maximum_blocked_streams| doesn't decrease current value.
   // The setting is not changed when returning false.
   bool SetMaximumBlockedStreams(uint64_t maximum_blocked_streams);
 
+  // When enabled, header fields that cannot reference the dynamic table
+  // without risking a blocked stream are still inserted into the table
+  // speculatively, while the current header block falls back to literal
+  // representations.  Subsequent header blocks can then reference the
+  // entries without blocking as soon as they are acknowledged.  This trades
+  // encoder stream bytes for compression ratio on connections where blocked
+  // streams are expensive, for example on lossy paths or when the peer
+  // advertises a low (or zero) SETTINGS_QPACK_BLOCKED_STREAMS value.
+  void EnableSpeculativeInsertions() { speculative_insertions_enabled_ = true; }
+
   // QpackDecoderStreamReceiver::Delegate implementation
   void OnInsertCountIncrement(uint64_t increment) override;
   void OnHeaderAcknowledgement(QuicStreamId stream_id) override;
@@ -102,6 +162,13 @@ class QUIC_EXPORT_PRIVATE QpackEncoder
     return header_table_.maximum_dynamic_table_capacity();
   }
 
+  // Size of the dynamic table in bytes, including the per-entry overhead.
+  uint64_t dynamic_table_size() const {
+    return header_table_.dynamic_table_size();
+  }
+
+  const Stats& stats() const { return stats_; }
+
  private:
   friend class test::QpackEncoderPeer;
 
@@ -157,6 +224,8 @@ class QUIC_EXPORT_PRIVATE QpackEncoder
   uint64_t maximum_blocked_streams_;
   QpackBlockingManager blocking_manager_;
   int header_list_count_;
+  bool speculative_insertions_enabled_;
+  Stats stats_;
 };
 
 }  // namespace quic
@@ -0,0 +1,50 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/qpack/qpack_encoder_dynamic_index.h"
+
+#include <utility>
+
+#include "quic/platform/api/quic_logging.h"
+
+namespace quic {
+
+void QpackEncoderDynamicIndex::Rehash(uint64_t first_valid_index) {
+  size_t live_slot_count = 0;
+  for (const Slot& slot : slots_) {
+    if (slot.index_plus_one != 0 &&
+        slot.index_plus_one - 1 >= first_valid_index) {
+      ++live_slot_count;
+    }
+  }
+
+  size_t new_capacity =
+      slots_.empty() ? kMinimumCapacity : slots_.size();
+  // Grow only if dropping tombstones alone does not get the table below
+  // half full; eviction-heavy workloads rebuild in place.
+  while (live_slot_count * 2 >= new_capacity) {
+    new_capacity *= 2;
+  }
+
+  std::vector<Slot> old_slots = std::move(slots_);
+  slots_.assign(new_capacity, Slot{0, 0});
+  occupied_slot_count_ = 0;
+
+  const size_t mask = new_capacity - 1;
+  for (const Slot& slot : old_slots) {
+    if (slot.index_plus_one == 0 ||
+        slot.index_plus_one - 1 < first_valid_index) {
+      continue;
+    }
+    size_t probe = slot.hash & mask;
+    while (slots_[probe].index_plus_one != 0) {
+      probe = (probe + 1) & mask;
+    }
+    slots_[probe] = slot;
+    ++occupied_slot_count_;
+  }
+  QUICHE_DCHECK_LT(occupied_slot_count_, slots_.size() / 2 + 1);
+}
+
+}  // namespace quic
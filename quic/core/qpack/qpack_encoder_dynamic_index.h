@@ -0,0 +1,131 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_QPACK_QPACK_ENCODER_DYNAMIC_INDEX_H_
+#define QUICHE_QUIC_CORE_QPACK_QPACK_ENCODER_DYNAMIC_INDEX_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "absl/types/optional.h"
+#include "quic/platform/api/quic_export.h"
+
+namespace quic {
+
+// An open-addressing hash index over QPACK dynamic table entries,
+// purpose-built for QpackEncoderHeaderTable. A slot holds only the hash of
+// the key and the absolute index of the entry it refers to; the header
+// strings themselves stay in the dynamic table and are consulted through a
+// caller-supplied matcher, so the index never stores or copies keys.
+//
+// Eviction is free. Entries leave the dynamic table strictly in insertion
+// order, so a slot whose absolute index has fallen below the caller's
+// dropped-entry count is implicitly a tombstone: lookups skip it and
+// insertions reclaim it. Nothing is rehashed when entries are evicted; the
+// table is only rebuilt when insertions fill three quarters of the slots,
+// which amortizes to constant time per insertion.
+class QUIC_EXPORT_PRIVATE QpackEncoderDynamicIndex {
+ public:
+  QpackEncoderDynamicIndex() = default;
+  QpackEncoderDynamicIndex(const QpackEncoderDynamicIndex&) = delete;
+  QpackEncoderDynamicIndex& operator=(const QpackEncoderDynamicIndex&) =
+      delete;
+
+  // Records |index| as the most recent entry for the key hashing to |hash|,
+  // replacing any live slot with the same key. |first_valid_index| is the
+  // smallest absolute index still in the dynamic table. |matcher| is called
+  // with the absolute index held by a probed live slot and must return
+  // whether the entry at that index has the same key as the one being
+  // inserted.
+  template <typename Matcher>
+  void InsertOrReplace(size_t hash,
+                       uint64_t index,
+                       uint64_t first_valid_index,
+                       const Matcher& matcher) {
+    if (occupied_slot_count_ + 1 > slots_.size() - slots_.size() / 4) {
+      Rehash(first_valid_index);
+    }
+    const size_t mask = slots_.size() - 1;
+    size_t probe = hash & mask;
+    size_t reusable_slot = kNoSlot;
+    while (true) {
+      Slot& slot = slots_[probe];
+      if (slot.index_plus_one == 0) {
+        // Empty slot: the key is not in the index. Prefer reclaiming a
+        // tombstone passed on the way to keep probe chains short.
+        if (reusable_slot != kNoSlot) {
+          slots_[reusable_slot] = Slot{hash, index + 1};
+        } else {
+          slot = Slot{hash, index + 1};
+          ++occupied_slot_count_;
+        }
+        return;
+      }
+      if (slot.index_plus_one - 1 < first_valid_index) {
+        // The referenced entry was evicted; this slot is a tombstone.
+        if (reusable_slot == kNoSlot) {
+          reusable_slot = probe;
+        }
+      } else if (slot.hash == hash && matcher(slot.index_plus_one - 1)) {
+        // Same key: track the most recent entry, like the hash map did.
+        slot.index_plus_one = index + 1;
+        return;
+      }
+      probe = (probe + 1) & mask;
+    }
+  }
+
+  // Returns the absolute index of the most recently inserted live entry
+  // whose key hashes to |hash| and satisfies |matcher|, if any.
+  template <typename Matcher>
+  absl::optional<uint64_t> Find(size_t hash,
+                                uint64_t first_valid_index,
+                                const Matcher& matcher) const {
+    if (slots_.empty()) {
+      return absl::nullopt;
+    }
+    const size_t mask = slots_.size() - 1;
+    size_t probe = hash & mask;
+    while (true) {
+      const Slot& slot = slots_[probe];
+      if (slot.index_plus_one == 0) {
+        return absl::nullopt;
+      }
+      if (slot.index_plus_one - 1 >= first_valid_index &&
+          slot.hash == hash && matcher(slot.index_plus_one - 1)) {
+        return slot.index_plus_one - 1;
+      }
+      probe = (probe + 1) & mask;
+    }
+  }
+
+  // The number of occupied slots, including tombstones. Exposed for tests.
+  size_t occupied_slot_count_for_testing() const {
+    return occupied_slot_count_;
+  }
+  size_t capacity_for_testing() const { return slots_.size(); }
+
+ private:
+  struct QUIC_EXPORT_PRIVATE Slot {
+    size_t hash;
+    // Absolute index of the referenced entry plus one; zero means empty.
+    uint64_t index_plus_one;
+  };
+
+  static constexpr size_t kNoSlot = static_cast<size_t>(-1);
+  static constexpr size_t kMinimumCapacity = 64;
+
+  // Rebuilds the table, dropping tombstones and growing if the live slots
+  // alone would fill it past half.
+  void Rehash(uint64_t first_valid_index);
+
+  // Slot count is always zero or a power of two.
+  std::vector<Slot> slots_;
+  size_t occupied_slot_count_ = 0;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_QPACK_QPACK_ENCODER_DYNAMIC_INDEX_H_
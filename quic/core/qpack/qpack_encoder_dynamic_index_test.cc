@@ -0,0 +1,108 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/qpack/qpack_encoder_dynamic_index.h"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "absl/hash/hash.h"
+#include "absl/strings/str_cat.h"
+#include "quic/platform/api/quic_test.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+// Backs the index with a simple vector of keys, mimicking how
+// QpackEncoderHeaderTable resolves absolute indices to entries.
+class QpackEncoderDynamicIndexTest : public QuicTest {
+ protected:
+  uint64_t Insert(const std::string& key) {
+    const uint64_t index = first_valid_index_ + keys_.size();
+    keys_.push_back(key);
+    index_.InsertOrReplace(absl::Hash<std::string>()(key), index,
+                           first_valid_index_, MatcherFor(key));
+    return index;
+  }
+
+  absl::optional<uint64_t> Find(const std::string& key) const {
+    return index_.Find(absl::Hash<std::string>()(key), first_valid_index_,
+                       MatcherFor(key));
+  }
+
+  void EvictOldest() {
+    keys_.erase(keys_.begin());
+    ++first_valid_index_;
+  }
+
+  std::function<bool(uint64_t)> MatcherFor(const std::string& key) const {
+    return [this, key](uint64_t entry_index) {
+      return keys_[entry_index - first_valid_index_] == key;
+    };
+  }
+
+  QpackEncoderDynamicIndex index_;
+  std::vector<std::string> keys_;
+  uint64_t first_valid_index_ = 0;
+};
+
+TEST_F(QpackEncoderDynamicIndexTest, FindAfterInsert) {
+  EXPECT_FALSE(Find("foo").has_value());
+  const uint64_t foo_index = Insert("foo");
+  const uint64_t bar_index = Insert("bar");
+  EXPECT_THAT(Find("foo"), testing::Optional(foo_index));
+  EXPECT_THAT(Find("bar"), testing::Optional(bar_index));
+  EXPECT_FALSE(Find("baz").has_value());
+}
+
+TEST_F(QpackEncoderDynamicIndexTest, DuplicateKeyTracksMostRecent) {
+  Insert("foo");
+  const uint64_t second_index = Insert("foo");
+  EXPECT_THAT(Find("foo"), testing::Optional(second_index));
+}
+
+TEST_F(QpackEncoderDynamicIndexTest, EvictedEntryIsNotFound) {
+  Insert("foo");
+  const uint64_t bar_index = Insert("bar");
+  EvictOldest();
+  EXPECT_FALSE(Find("foo").has_value());
+  EXPECT_THAT(Find("bar"), testing::Optional(bar_index));
+}
+
+TEST_F(QpackEncoderDynamicIndexTest, TombstoneIsReclaimed) {
+  Insert("foo");
+  Insert("bar");
+  EvictOldest();
+  const size_t occupied_before = index_.occupied_slot_count_for_testing();
+  // "foo" was evicted; inserting a fresh key may reuse its stale slot, and
+  // at worst takes an empty one.
+  const uint64_t baz_index = Insert("baz");
+  EXPECT_THAT(Find("baz"), testing::Optional(baz_index));
+  EXPECT_LE(index_.occupied_slot_count_for_testing(), occupied_before + 1);
+}
+
+TEST_F(QpackEncoderDynamicIndexTest, ManyInsertionsWithEviction) {
+  // Roll a small window of live keys through a large number of insertions,
+  // forcing rebuilds and heavy tombstone traffic.
+  const size_t kWindow = 16;
+  for (int i = 0; i < 1000; ++i) {
+    Insert(absl::StrCat("key-", i));
+    if (keys_.size() > kWindow) {
+      EvictOldest();
+    }
+  }
+  for (size_t i = 0; i < keys_.size(); ++i) {
+    EXPECT_THAT(Find(keys_[i]), testing::Optional(first_valid_index_ + i));
+  }
+  EXPECT_FALSE(Find("key-0").has_value());
+  // The table stays sized for the live window, not the insertion count.
+  EXPECT_LE(index_.capacity_for_testing(), 128u);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
@@ -44,6 +44,11 @@ void QpackEncoderStreamSender::SendSetDynamicTableCapacity(uint64_t capacity) {
       QpackInstructionWithValues::SetDynamicTableCapacity(capacity), &buffer_);
 }
 
+void QpackEncoderStreamSender::SendPreEncodedInstructions(
+    absl::string_view instructions) {
+  buffer_.append(instructions.data(), instructions.size());
+}
+
 void QpackEncoderStreamSender::Flush() {
   if (buffer_.empty()) {
     return;
@@ -38,6 +38,11 @@ class QUIC_EXPORT_PRIVATE QpackEncoderStreamSender {
   // 5.2.4. Set Dynamic Table Capacity
   void SendSetDynamicTableCapacity(uint64_t capacity);
 
+  // Buffers |instructions|, which must be valid encoder stream instructions
+  // already serialized by a QpackInstructionEncoder, for example the shared
+  // insertions of a QpackEncoderTemplateTable.
+  void SendPreEncodedInstructions(absl::string_view instructions);
+
   // Returns number of buffered bytes.
   QuicByteCount BufferedByteCount() const { return buffer_.size(); }
 
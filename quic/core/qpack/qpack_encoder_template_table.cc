@@ -0,0 +1,24 @@
+// Copyright (c) 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/qpack/qpack_encoder_template_table.h"
+
+#include "quic/core/qpack/qpack_header_table.h"
+#include "quic/core/qpack/qpack_instructions.h"
+
+namespace quic {
+
+QpackEncoderTemplateTable::QpackEncoderTemplateTable()
+    : total_entry_size_(0) {}
+
+void QpackEncoderTemplateTable::AddEntry(absl::string_view name,
+                                         absl::string_view value) {
+  instruction_encoder_.Encode(
+      QpackInstructionWithValues::InsertWithoutNameReference(name, value),
+      &serialized_insertions_);
+  total_entry_size_ += QpackEntry::Size(name, value);
+  entries_.emplace_back(std::string(name), std::string(value));
+}
+
+}  // namespace quic
@@ -0,0 +1,68 @@
+// Copyright (c) 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_QPACK_QPACK_ENCODER_TEMPLATE_TABLE_H_
+#define QUICHE_QUIC_CORE_QPACK_QPACK_ENCODER_TEMPLATE_TABLE_H_
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "quic/core/qpack/qpack_instruction_encoder.h"
+#include "quic/platform/api/quic_export.h"
+
+namespace quic {
+
+// A process-level, immutable-after-training set of header fields used to warm
+// the QPACK dynamic table of new connections, see
+// QpackEncoder::WarmUpFromTemplate().  Intended for endpoints that open many
+// connections carrying near-identical header sets (e.g. a fanout proxy):
+// the Insert Without Name Reference instructions for the template entries are
+// serialized exactly once here, and each connection replays the shared
+// pre-encoded bytes on its encoder stream instead of re-running the insertion
+// and serialization logic.  The per-connection dynamic tables then diverge
+// from the shared template independently.
+//
+// Train the table at startup by calling AddEntry() with the canonical header
+// fields, most valuable entries last (QPACK evicts from the front).  After
+// training, the table must not be modified; it can then be shared read-only
+// by any number of encoders on any threads.
+class QUIC_EXPORT_PRIVATE QpackEncoderTemplateTable {
+ public:
+  QpackEncoderTemplateTable();
+  QpackEncoderTemplateTable(const QpackEncoderTemplateTable&) = delete;
+  QpackEncoderTemplateTable& operator=(const QpackEncoderTemplateTable&) =
+      delete;
+
+  // Appends (name, value) to the template and serializes the corresponding
+  // Insert Without Name Reference instruction.
+  void AddEntry(absl::string_view name, absl::string_view value);
+
+  const std::vector<std::pair<std::string, std::string>>& entries() const {
+    return entries_;
+  }
+
+  // Pre-encoded Insert Without Name Reference instructions for all entries,
+  // in insertion order.  Valid as long as this object is alive and no more
+  // entries are added.
+  absl::string_view serialized_insertions() const {
+    return serialized_insertions_;
+  }
+
+  // Sum of the sizes of all entries including per-entry overhead, i.e. the
+  // minimum dynamic table capacity required to hold the whole template.
+  uint64_t total_entry_size() const { return total_entry_size_; }
+
+ private:
+  std::vector<std::pair<std::string, std::string>> entries_;
+  std::string serialized_insertions_;
+  uint64_t total_entry_size_;
+  QpackInstructionEncoder instruction_encoder_;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_QPACK_QPACK_ENCODER_TEMPLATE_TABLE_H_
@@ -0,0 +1,52 @@
+// Copyright (c) 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/qpack/qpack_encoder_template_table.h"
+
+#include <string>
+
+#include "absl/strings/escaping.h"
+#include "quic/core/qpack/qpack_header_table.h"
+#include "quic/platform/api/quic_test.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+class QpackEncoderTemplateTableTest : public QuicTest {
+ protected:
+  QpackEncoderTemplateTable table_;
+};
+
+TEST_F(QpackEncoderTemplateTableTest, Empty) {
+  EXPECT_TRUE(table_.entries().empty());
+  EXPECT_TRUE(table_.serialized_insertions().empty());
+  EXPECT_EQ(0u, table_.total_entry_size());
+}
+
+TEST_F(QpackEncoderTemplateTableTest, SerializesInsertInstructions) {
+  table_.AddEntry("foo", "bar");
+  table_.AddEntry("foo", "baz");
+
+  ASSERT_EQ(2u, table_.entries().size());
+  EXPECT_EQ("foo", table_.entries()[0].first);
+  EXPECT_EQ("bar", table_.entries()[0].second);
+  EXPECT_EQ("baz", table_.entries()[1].second);
+
+  EXPECT_EQ(QpackEntry::Size("foo", "bar") + QpackEntry::Size("foo", "baz"),
+            table_.total_entry_size());
+
+  // Two Insert Without Name Reference instructions, in insertion order.
+  EXPECT_EQ(absl::HexStringToBytes("62"        // insert without name reference
+                                   "94e7"      // Huffman-encoded name "foo"
+                                   "03626172"  // value "bar"
+                                   "62"        // insert without name reference
+                                   "94e7"        // Huffman-encoded name "foo"
+                                   "0362617a"),  // value "baz"
+            table_.serialized_insertions());
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
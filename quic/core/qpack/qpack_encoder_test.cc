@@ -7,6 +7,8 @@
 #include <limits>
 #include <string>
 
+#include "quic/core/qpack/qpack_encoder_template_table.h"
+
 #include "absl/strings/escaping.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
@@ -137,6 +139,51 @@ TEST_F(QpackEncoderTest, StaticTable) {
   }
 }
 
+TEST_F(QpackEncoderTest, EncodeStaticHeaderFields) {
+  // Field lines only, no header block prefix.  The strict mock stream sender
+  // delegate verifies that nothing is written on the encoder stream.
+  {
+    spdy::Http2HeaderBlock header_list;
+    header_list[":method"] = "GET";
+    header_list["accept-encoding"] = "gzip, deflate, br";
+    header_list["location"] = "";
+
+    EXPECT_EQ(absl::HexStringToBytes("d1dfcc"),
+              encoder_.EncodeStaticHeaderFields(header_list));
+  }
+  {
+    spdy::Http2HeaderBlock header_list;
+    header_list["foo"] = "bar";
+
+    EXPECT_EQ(absl::HexStringToBytes("2a94e703626172"),
+              encoder_.EncodeStaticHeaderFields(header_list));
+  }
+}
+
+TEST_F(QpackEncoderTest, StaticHeaderFieldsSpliceIntoHeaderBlock) {
+  EXPECT_EQ(absl::HexStringToBytes("0000"),
+            QpackEncoder::SerializeStaticHeaderBlockPrefix());
+
+  // A block spliced together from independently encoded pieces decodes the
+  // same as one encoded in a single pass.
+  spdy::Http2HeaderBlock template_headers;
+  template_headers[":method"] = "GET";
+  template_headers["accept-encoding"] = "gzip, deflate, br";
+  spdy::Http2HeaderBlock delta_headers;
+  delta_headers["foo"] = "bar";
+
+  spdy::Http2HeaderBlock combined_headers;
+  combined_headers[":method"] = "GET";
+  combined_headers["accept-encoding"] = "gzip, deflate, br";
+  combined_headers["foo"] = "bar";
+
+  std::string spliced = QpackEncoder::SerializeStaticHeaderBlockPrefix();
+  spliced.append(encoder_.EncodeStaticHeaderFields(template_headers));
+  spliced.append(encoder_.EncodeStaticHeaderFields(delta_headers));
+
+  EXPECT_EQ(Encode(combined_headers), spliced);
+}
+
 TEST_F(QpackEncoderTest, DecoderStreamError) {
   EXPECT_CALL(decoder_stream_error_delegate_,
               OnDecoderStreamError(QUIC_QPACK_DECODER_STREAM_INTEGER_TOO_LARGE,
@@ -250,6 +297,87 @@ TEST_F(QpackEncoderTest, DynamicTable) {
   EXPECT_EQ(insert_entries.size(), encoder_stream_sent_byte_count_);
 }
 
+TEST_F(QpackEncoderTest, WarmUpFromTemplate) {
+  encoder_.SetMaximumDynamicTableCapacity(4096);
+  encoder_.SetDynamicTableCapacity(4096);
+
+  QpackEncoderTemplateTable template_table;
+  template_table.AddEntry("foo", "bar");
+
+  EXPECT_TRUE(encoder_.WarmUpFromTemplate(template_table));
+
+  // The Set Dynamic Table Capacity instruction and the template's pre-encoded
+  // insert instruction are flushed together with the first header block.
+  std::string set_dynamic_table_capacity = absl::HexStringToBytes("3fe11f");
+  std::string insert_entry = absl::HexStringToBytes(
+      "62"          // insert without name reference
+      "94e7"        // Huffman-encoded name "foo"
+      "03626172");  // value "bar"
+  EXPECT_CALL(
+      encoder_stream_sender_delegate_,
+      WriteStreamData(Eq(absl::StrCat(set_dynamic_table_capacity,
+                                      insert_entry))));
+
+  // The first header block can reference the warmed entry without inserting
+  // anything itself.
+  spdy::Http2HeaderBlock header_list;
+  header_list["foo"] = "bar";
+  EXPECT_EQ(absl::HexStringToBytes(
+                "0200"  // prefix
+                "80"),  // dynamic entry with relative index 0
+            Encode(header_list));
+  EXPECT_EQ(0u, encoder_stream_sent_byte_count_);
+
+  // Once the table is populated, warming up again is rejected: the
+  // pre-encoded instructions assume an empty table.
+  EXPECT_FALSE(encoder_.WarmUpFromTemplate(template_table));
+}
+
+TEST_F(QpackEncoderTest, WarmUpFromTemplateDoesNotFit) {
+  encoder_.SetMaximumDynamicTableCapacity(QpackEntry::Size("foo", "bar"));
+  encoder_.SetDynamicTableCapacity(QpackEntry::Size("foo", "bar"));
+
+  QpackEncoderTemplateTable template_table;
+  template_table.AddEntry("foo", "bar");
+  template_table.AddEntry("baz", "qux");
+
+  // The template only fits partially, so no entries are inserted.
+  EXPECT_FALSE(encoder_.WarmUpFromTemplate(template_table));
+}
+
+TEST_F(QpackEncoderTest, MaybeDropDynamicTable) {
+  // Nothing to drop while the dynamic table is empty.
+  EXPECT_FALSE(encoder_.MaybeDropDynamicTable());
+
+  encoder_.SetMaximumDynamicTableCapacity(4096);
+  encoder_.SetDynamicTableCapacity(4096);
+
+  spdy::Http2HeaderBlock header_list;
+  header_list["foo"] = "bar";
+
+  // Set Dynamic Table Capacity instruction and insert one entry.
+  EXPECT_CALL(encoder_stream_sender_delegate_, WriteStreamData(_));
+  Encode(header_list);
+  EXPECT_LT(0u, encoder_.dynamic_table_size());
+
+  // The header block for stream 1 references the new entry and is not yet
+  // acknowledged, so the entry must not be evicted.
+  EXPECT_FALSE(encoder_.MaybeDropDynamicTable());
+  EXPECT_LT(0u, encoder_.dynamic_table_size());
+
+  encoder_.OnHeaderAcknowledgement(/* stream_id = */ 1);
+
+  // With no outstanding references left, the table is dropped. A Set Dynamic
+  // Table Capacity instruction with capacity zero is sent and flushed.
+  EXPECT_CALL(encoder_stream_sender_delegate_,
+              WriteStreamData(Eq(absl::HexStringToBytes("20"))));
+  EXPECT_TRUE(encoder_.MaybeDropDynamicTable());
+  EXPECT_EQ(0u, encoder_.dynamic_table_size());
+
+  // Dropping again is a no-op.
+  EXPECT_FALSE(encoder_.MaybeDropDynamicTable());
+}
+
 // There is no room in the dynamic table after inserting the first entry.
 TEST_F(QpackEncoderTest, SmallDynamicTable) {
   encoder_.SetMaximumBlockedStreams(1);
@@ -394,6 +522,70 @@ TEST_F(QpackEncoderTest, BlockedStream) {
   EXPECT_EQ(0u, encoder_stream_sent_byte_count_);
 }
 
+TEST_F(QpackEncoderTest, SpeculativeInsertions) {
+  encoder_.EnableSpeculativeInsertions();
+  encoder_.SetMaximumBlockedStreams(1);
+  encoder_.SetMaximumDynamicTableCapacity(4096);
+  encoder_.SetDynamicTableCapacity(4096);
+
+  spdy::Http2HeaderBlock header_list1;
+  header_list1["foo"] = "bar";
+
+  // Set Dynamic Table Capacity instruction.
+  std::string set_dyanamic_table_capacity = absl::HexStringToBytes("3fe11f");
+  // Insert one entry into the dynamic table.
+  std::string insert_entry1 = absl::HexStringToBytes(
+      "62"          // insert without name reference
+      "94e7"        // Huffman-encoded name "foo"
+      "03626172");  // value "bar"
+  EXPECT_CALL(encoder_stream_sender_delegate_,
+              WriteStreamData(Eq(
+                  absl::StrCat(set_dyanamic_table_capacity, insert_entry1))));
+
+  EXPECT_EQ(absl::HexStringToBytes("0200"  // prefix
+                                   "80"),  // dynamic entry 0
+            encoder_.EncodeHeaderList(/* stream_id = */ 1, header_list1,
+                                      &encoder_stream_sent_byte_count_));
+  EXPECT_EQ(insert_entry1.size(), encoder_stream_sent_byte_count_);
+
+  // Stream 1 is blocked.  Stream 2 is not allowed to block, so its header
+  // block falls back to literals, but entries are still inserted into the
+  // dynamic table speculatively.
+  spdy::Http2HeaderBlock header_list2;
+  header_list2["cookie"] = "baz";  // name matches static entry
+  header_list2["bar"] = "baz";     // no match
+
+  // Insert two entries into the dynamic table.
+  std::string insert_entries2 = absl::HexStringToBytes(
+      "c5"          // insert with name reference, static index 5
+      "0362617a"    // value "baz"
+      "43"          // insert without name reference
+      "626172"      // name "bar"
+      "0362617a");  // value "baz"
+  EXPECT_CALL(encoder_stream_sender_delegate_,
+              WriteStreamData(Eq(insert_entries2)));
+
+  EXPECT_EQ(absl::HexStringToBytes("0000"        // prefix
+                                   "55"          // name of static entry 5
+                                   "0362617a"    // with literal value "baz"
+                                   "23626172"    // literal name "bar"
+                                   "0362617a"),  // with literal value "baz"
+            encoder_.EncodeHeaderList(/* stream_id = */ 2, header_list2,
+                                      &encoder_stream_sent_byte_count_));
+  EXPECT_EQ(insert_entries2.size(), encoder_stream_sent_byte_count_);
+
+  // Peer acknowledges receipt of all three dynamic table entries.
+  encoder_.OnInsertCountIncrement(3);
+
+  // The speculatively inserted entries are now acknowledged, so referencing
+  // them does not block, no matter how many streams are already blocked.
+  EXPECT_EQ(absl::HexStringToBytes("0400"    // prefix
+                                   "8180"),  // dynamic entries 1 and 2
+            encoder_.EncodeHeaderList(/* stream_id = */ 3, header_list2,
+                                      &encoder_stream_sent_byte_count_));
+  EXPECT_EQ(0u, encoder_stream_sent_byte_count_);
+}
+
 TEST_F(QpackEncoderTest, Draining) {
   spdy::Http2HeaderBlock header_list1;
   header_list1["one"] = "foo";
@@ -467,6 +659,33 @@ TEST_F(QpackEncoderTest, DynamicTableCapacityLessThanMaximum) {
   EXPECT_EQ(30u, header_table->dynamic_table_capacity());
 }
 
+TEST_F(QpackEncoderTest, Stats) {
+  // Encoding from the static table costs no encoder stream bytes and cannot
+  // block any stream.
+  spdy::Http2HeaderBlock header_list;
+  header_list["foo"] = "bar";
+  std::string output = Encode(header_list);
+
+  const QpackEncoder::Stats& stats = encoder_.stats();
+  EXPECT_EQ(6u, stats.uncompressed_header_bytes);
+  EXPECT_EQ(output.size(), stats.compressed_header_bytes);
+  EXPECT_EQ(0u, stats.encoder_stream_sent_bytes);
+  EXPECT_EQ(0u, stats.potentially_blocked_header_lists);
+
+  // With a dynamic table, insertions cost encoder stream bytes, and
+  // referencing an entry the decoder has not acknowledged yet risks blocking
+  // the stream.
+  encoder_.SetMaximumDynamicTableCapacity(4096);
+  encoder_.SetDynamicTableCapacity(4096);
+  EXPECT_CALL(encoder_stream_sender_delegate_, WriteStreamData(_));
+  std::string output2 = Encode(header_list);
+
+  EXPECT_EQ(12u, stats.uncompressed_header_bytes);
+  EXPECT_EQ(output.size() + output2.size(), stats.compressed_header_bytes);
+  EXPECT_GT(stats.encoder_stream_sent_bytes, 0u);
+  EXPECT_EQ(1u, stats.potentially_blocked_header_lists);
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace quic
@@ -4,48 +4,51 @@
 
 #include "quic/core/qpack/qpack_header_table.h"
 
+#include "absl/hash/hash.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
 #include "quic/core/qpack/qpack_static_table.h"
 #include "quic/platform/api/quic_logging.h"
 
 namespace quic {
+namespace {
+
+size_t HashOfNameAndValue(absl::string_view name, absl::string_view value) {
+  return absl::Hash<QpackLookupEntry>()(QpackLookupEntry{name, value});
+}
+
+size_t HashOfName(absl::string_view name) {
+  return absl::Hash<absl::string_view>()(name);
+}
+
+}  // namespace
 
 QpackEncoderHeaderTable::QpackEncoderHeaderTable()
-    : static_index_(ObtainQpackStaticTable().GetStaticIndex()),
-      static_name_index_(ObtainQpackStaticTable().GetStaticNameIndex()) {}
+    : static_table_(ObtainQpackStaticTable()) {}
 
 uint64_t QpackEncoderHeaderTable::InsertEntry(absl::string_view name,
                                               absl::string_view value) {
   const uint64_t index =
       QpackHeaderTableBase<QpackEncoderDynamicTable>::InsertEntry(name, value);
 
-  // Make name and value point to the new entry.
+  // Make name and value point to the new entry, which owns its own copy.
   name = dynamic_entries().back().name();
   value = dynamic_entries().back().value();
 
-  auto index_result = dynamic_index_.insert(
-      std::make_pair(QpackLookupEntry{name, value}, index));
-  if (!index_result.second) {
-    // An entry with the same name and value already exists.  It needs to be
-    // replaced, because |dynamic_index_| tracks the most recent entry for a
-    // given name and value.
-    QUICHE_DCHECK_GT(index, index_result.first->second);
-    dynamic_index_.erase(index_result.first);
-    auto result = dynamic_index_.insert(
-        std::make_pair(QpackLookupEntry{name, value}, index));
-    QUICHE_CHECK(result.second);
-  }
-
-  auto name_result = dynamic_name_index_.insert({name, index});
-  if (!name_result.second) {
-    // An entry with the same name already exists.  It needs to be replaced,
-    // because |dynamic_name_index_| tracks the most recent entry for a given
-    // name.
-    QUICHE_DCHECK_GT(index, name_result.first->second);
-    dynamic_name_index_.erase(name_result.first);
-    auto result = dynamic_name_index_.insert({name, index});
-    QUICHE_CHECK(result.second);
-  }
+  // The indexes track the most recent entry for a given key; inserting again
+  // with the same key replaces the slot in place.
+  dynamic_index_.InsertOrReplace(
+      HashOfNameAndValue(name, value), index, dropped_entry_count(),
+      [this, name, value](uint64_t entry_index) {
+        const QpackEntry& entry = entry_at_absolute_index(entry_index);
+        return entry.name() == name && entry.value() == value;
+      });
+
+  dynamic_name_index_.InsertOrReplace(
+      HashOfName(name), index, dropped_entry_count(),
+      [this, name](uint64_t entry_index) {
+        return entry_at_absolute_index(entry_index).name() == name;
+      });
 
   return index;
 }
@@ -55,36 +58,44 @@ QpackEncoderHeaderTable::MatchType QpackEncoderHeaderTable::FindHeaderField(
     absl::string_view value,
     bool* is_static,
     uint64_t* index) const {
-  QpackLookupEntry query{name, value};
-
   // Look for exact match in static table.
-  auto index_it = static_index_.find(query);
-  if (index_it != static_index_.end()) {
-    *index = index_it->second;
+  absl::optional<size_t> static_match =
+      static_table_.FindByNameAndValue(name, value);
+  if (static_match.has_value()) {
+    *index = *static_match;
     *is_static = true;
     return MatchType::kNameAndValue;
   }
 
   // Look for exact match in dynamic table.
-  index_it = dynamic_index_.find(query);
-  if (index_it != dynamic_index_.end()) {
-    *index = index_it->second;
+  absl::optional<uint64_t> dynamic_match = dynamic_index_.Find(
+      HashOfNameAndValue(name, value), dropped_entry_count(),
+      [this, name, value](uint64_t entry_index) {
+        const QpackEntry& entry = entry_at_absolute_index(entry_index);
+        return entry.name() == name && entry.value() == value;
+      });
+  if (dynamic_match.has_value()) {
+    *index = *dynamic_match;
     *is_static = false;
     return MatchType::kNameAndValue;
   }
 
   // Look for name match in static table.
-  auto name_index_it = static_name_index_.find(name);
-  if (name_index_it != static_name_index_.end()) {
-    *index = name_index_it->second;
+  static_match = static_table_.FindByName(name);
+  if (static_match.has_value()) {
+    *index = *static_match;
     *is_static = true;
     return MatchType::kName;
   }
 
   // Look for name match in dynamic table.
-  name_index_it = dynamic_name_index_.find(name);
-  if (name_index_it != dynamic_name_index_.end()) {
-    *index = name_index_it->second;
+  dynamic_match = dynamic_name_index_.Find(
+      HashOfName(name), dropped_entry_count(),
+      [this, name](uint64_t entry_index) {
+        return entry_at_absolute_index(entry_index).name() == name;
+      });
+  if (dynamic_match.has_value()) {
+    *index = *dynamic_match;
     *is_static = false;
     return MatchType::kName;
   }
@@ -92,6 +103,26 @@ QpackEncoderHeaderTable::MatchType QpackEncoderHeaderTable::FindHeaderField(
   return MatchType::kNoMatch;
 }
 
+QpackEncoderHeaderTable::MatchType
+QpackEncoderHeaderTable::FindStaticHeaderField(absl::string_view name,
+                                               absl::string_view value,
+                                               uint64_t* index) const {
+  absl::optional<size_t> static_match =
+      static_table_.FindByNameAndValue(name, value);
+  if (static_match.has_value()) {
+    *index = *static_match;
+    return MatchType::kNameAndValue;
+  }
+
+  static_match = static_table_.FindByName(name);
+  if (static_match.has_value()) {
+    *index = *static_match;
+    return MatchType::kName;
+  }
+
+  return MatchType::kNoMatch;
+}
+
 uint64_t QpackEncoderHeaderTable::MaxInsertSizeWithoutEvictingGivenEntry(
     uint64_t index) const {
   QUICHE_DCHECK_LE(dropped_entry_count(), index);
@@ -144,27 +175,6 @@ uint64_t QpackEncoderHeaderTable::draining_index(
   return entry_index;
 }
 
-void QpackEncoderHeaderTable::RemoveEntryFromEnd() {
-  const QpackEntry* const entry = &dynamic_entries().front();
-  const uint64_t index = dropped_entry_count();
-
-  auto index_it = dynamic_index_.find({entry->name(), entry->value()});
-  // Remove |dynamic_index_| entry only if it points to the same
-  // QpackEntry in dynamic_entries().
-  if (index_it != dynamic_index_.end() && index_it->second == index) {
-    dynamic_index_.erase(index_it);
-  }
-
-  auto name_it = dynamic_name_index_.find(entry->name());
-  // Remove |dynamic_name_index_| entry only if it points to the same
-  // QpackEntry in dynamic_entries().
-  if (name_it != dynamic_name_index_.end() && name_it->second == index) {
-    dynamic_name_index_.erase(name_it);
-  }
-
-  QpackHeaderTableBase<QpackEncoderDynamicTable>::RemoveEntryFromEnd();
-}
-
 QpackDecoderHeaderTable::QpackDecoderHeaderTable()
     : static_entries_(ObtainQpackStaticTable().GetStaticEntries()) {}
 
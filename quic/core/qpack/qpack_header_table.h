@@ -6,9 +6,11 @@
 #define QUICHE_QUIC_CORE_QPACK_QPACK_HEADER_TABLE_H_
 
 #include <cstdint>
-#include <deque>
+#include <map>
 
 #include "absl/strings/string_view.h"
+#include "quic/core/qpack/qpack_encoder_dynamic_index.h"
+#include "quic/core/qpack/qpack_static_table.h"
 #include "quic/platform/api/quic_export.h"
 #include "common/quiche_circular_deque.h"
 #include "spdy/core/hpack/hpack_entry.h"
@@ -20,10 +22,10 @@ using QpackEntry = spdy::HpackEntry;
 using QpackLookupEntry = spdy::HpackLookupEntry;
 constexpr size_t kQpackEntrySizeOverhead = spdy::kHpackEntrySizeOverhead;
 
-// Encoder needs pointer stability for |dynamic_index_| and
-// |dynamic_name_index_|.  However, it does not need random access.
-// TODO(b/182349990): Change to a more memory efficient container.
-using QpackEncoderDynamicTable = std::deque<QpackEntry>;
+// The encoder index refers to entries by absolute index instead of by
+// pointer, so the encoder does not need pointer stability and can use the
+// same memory efficient container as the decoder.
+using QpackEncoderDynamicTable = quiche::QuicheCircularDeque<QpackEntry>;
 
 // Decoder needs random access for LookupEntry().
 // However, it does not need pointer stability.
@@ -242,6 +244,12 @@ class QUIC_EXPORT_PRIVATE QpackEncoderHeaderTable
                             bool* is_static,
                             uint64_t* index) const;
 
+  // Like FindHeaderField(), but only consults the static table, so the
+  // result does not depend on dynamic table state.
+  MatchType FindStaticHeaderField(absl::string_view name,
+                                  absl::string_view value,
+                                  uint64_t* index) const;
+
   // Returns the size of the largest entry that could be inserted into the
   // dynamic table without evicting entry |index|.  |index| might be larger than
   // inserted_entry_count(), in which case the capacity of the table is
@@ -256,37 +264,30 @@ class QUIC_EXPORT_PRIVATE QpackEncoderHeaderTable
   // The returned index might not be the index of a valid entry.
   uint64_t draining_index(float draining_fraction) const;
 
- protected:
-  void RemoveEntryFromEnd() override;
-
  private:
-  using NameValueToEntryMap = spdy::HpackHeaderTable::NameValueToEntryMap;
-  using NameToEntryMap = spdy::HpackHeaderTable::NameToEntryMap;
+  // Returns the dynamic table entry at absolute index |index|, which must be
+  // between dropped_entry_count() and inserted_entry_count().
+  const QpackEntry& entry_at_absolute_index(uint64_t index) const {
+    return dynamic_entries()[index - dropped_entry_count()];
+  }
 
   // Static Table
 
-  // |static_index_| and |static_name_index_| are owned by QpackStaticTable
-  // singleton.
-
-  // Tracks the unique static entry for a given header name and value.
-  const NameValueToEntryMap& static_index_;
-
-  // Tracks the first static entry for a given header name.
-  const NameToEntryMap& static_name_index_;
+  // Owned by the QpackStaticTable singleton.  Answers static table lookups by
+  // name and by name and value through its flat indices.
+  const QpackStaticTable& static_table_;
 
   // Dynamic Table
 
-  // An unordered set of QpackEntry pointers with a comparison operator that
-  // only cares about name and value.  This allows fast lookup of the most
-  // recently inserted dynamic entry for a given header name and value pair.
-  // Entries point to entries owned by |QpackHeaderTableBase::dynamic_entries_|.
-  NameValueToEntryMap dynamic_index_;
-
-  // An unordered map of QpackEntry pointers keyed off header name.  This allows
-  // fast lookup of the most recently inserted dynamic entry for a given header
-  // name.  Entries point to entries owned by
-  // |QpackHeaderTableBase::dynamic_entries_|.
-  NameToEntryMap dynamic_name_index_;
+  // Tracks the absolute index of the most recently inserted dynamic entry
+  // for a given header name and value pair.  Slots referencing evicted
+  // entries go stale implicitly, so eviction requires no index maintenance
+  // and RemoveEntryFromEnd() does not need to be overridden.
+  QpackEncoderDynamicIndex dynamic_index_;
+
+  // Tracks the absolute index of the most recently inserted dynamic entry
+  // for a given header name.
+  QpackEncoderDynamicIndex dynamic_name_index_;
 };
 
 class QUIC_EXPORT_PRIVATE QpackDecoderHeaderTable
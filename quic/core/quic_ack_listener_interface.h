@@ -27,6 +27,21 @@ class QUIC_EXPORT_PRIVATE QuicAckListenerInterface
   // |retransmitted_bytes| is the number of data bytes retransmitted.
   virtual void OnPacketRetransmitted(int retransmitted_bytes) = 0;
 
+  // Called when a range of stream data written with this listener attached is
+  // fully acked, with a breakdown of where the time between the application
+  // write and the ack went:
+  //  - |queued|: waiting in the send buffer behind earlier stream data.
+  //  - |paced|: at the head of the send buffer, but not yet written to the
+  //    wire, e.g. because of pacing, congestion control or flow control.
+  //  - |in_flight|: written to the wire until acknowledged; for data that had
+  //    to be retransmitted this spans the first transmission to the ack.
+  // Ranges are reported in stream offset order. The default implementation
+  // ignores the breakdown.
+  virtual void OnDataLatencyBreakdown(QuicByteCount /*acked_bytes*/,
+                                      QuicTime::Delta /*queued*/,
+                                      QuicTime::Delta /*paced*/,
+                                      QuicTime::Delta /*in_flight*/) {}
+
  protected:
   // Delegates are ref counted.
   ~QuicAckListenerInterface() override;
@@ -79,6 +79,23 @@ bool QuicAlarm::IsSet() const {
   return deadline_.IsInitialized();
 }
 
+void QuicAlarm::set_precision(Precision precision) {
+  QUICHE_DCHECK(!IsSet());
+  precision_ = precision;
+}
+
+QuicTime::Delta QuicAlarm::precision_delta() const {
+  switch (precision_) {
+    case Precision::kExact:
+      return QuicTime::Delta::Zero();
+    case Precision::kCoarse10ms:
+      return QuicTime::Delta::FromMilliseconds(10);
+    case Precision::kCoarse1s:
+      return QuicTime::Delta::FromSeconds(1);
+  }
+  return QuicTime::Delta::Zero();
+}
+
 void QuicAlarm::Fire() {
   if (!IsSet()) {
     return;
@@ -5,6 +5,8 @@
 #ifndef QUICHE_QUIC_CORE_QUIC_ALARM_H_
 #define QUICHE_QUIC_CORE_QUIC_ALARM_H_
 
+#include <cstdint>
+
 #include "quic/core/quic_arena_scoped_ptr.h"
 #include "quic/core/quic_connection_context.h"
 #include "quic/core/quic_time.h"
@@ -56,6 +58,17 @@ class QUIC_EXPORT_PRIVATE QuicAlarm {
     QuicConnectionContext* GetConnectionContext() override { return nullptr; }
   };
 
+  // How precisely the alarm must honor its deadline. Coarse alarms may be
+  // batched with other alarms expiring in the same interval and fire up to
+  // one interval after their deadline, which lets implementations keep them
+  // out of the precise timer heap. A coarse alarm never fires before its
+  // deadline. kExact is the default and preserves the historical behavior.
+  enum class Precision : uint8_t {
+    kExact,
+    kCoarse10ms,
+    kCoarse1s,
+  };
+
   explicit QuicAlarm(QuicArenaScopedPtr<Delegate> delegate);
   QuicAlarm(const QuicAlarm&) = delete;
   QuicAlarm& operator=(const QuicAlarm&) = delete;
@@ -89,6 +102,16 @@ class QUIC_EXPORT_PRIVATE QuicAlarm {
 
   QuicTime deadline() const { return deadline_; }
 
+  // Declares how precisely this alarm must honor its deadlines. Must not be
+  // called while the alarm is set; typically called once right after the
+  // alarm is created. Implementations which do not support coarse scheduling
+  // simply ignore the precision and fire exactly.
+  void set_precision(Precision precision);
+  Precision precision() const { return precision_; }
+
+  // Upper bound on how late the alarm may fire, as a delta. Zero for kExact.
+  QuicTime::Delta precision_delta() const;
+
  protected:
   // Subclasses implement this method to perform the platform-specific
   // scheduling of the alarm.  Is called from Set() or Fire(), after the
@@ -118,6 +141,7 @@ class QUIC_EXPORT_PRIVATE QuicAlarm {
 
   QuicArenaScopedPtr<Delegate> delegate_;
   QuicTime deadline_;
+  Precision precision_ = Precision::kExact;
 };
 
 }  // namespace quic
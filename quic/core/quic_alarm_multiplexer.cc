@@ -0,0 +1,168 @@
+// Copyright (c) 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/quic_alarm_multiplexer.h"
+
+#include "quic/core/quic_constants.h"
+#include "quic/platform/api/quic_bug_tracker.h"
+#include "quic/platform/api/quic_logging.h"
+
+namespace quic {
+
+namespace {
+
+class AlarmDelegate : public QuicAlarm::DelegateWithContext {
+ public:
+  explicit AlarmDelegate(QuicAlarmMultiplexer* multiplexer,
+                         QuicConnectionContext* context)
+      : QuicAlarm::DelegateWithContext(context), multiplexer_(multiplexer) {}
+  AlarmDelegate(const AlarmDelegate&) = delete;
+  AlarmDelegate& operator=(const AlarmDelegate&) = delete;
+
+  void OnAlarm() override { multiplexer_->OnAlarm(); }
+
+ private:
+  QuicAlarmMultiplexer* multiplexer_;
+};
+
+}  // namespace
+
+QuicAlarmMultiplexer::QuicAlarmMultiplexer(Delegate* delegate,
+                                           size_t num_slots,
+                                           const QuicClock* clock,
+                                           QuicConnectionArena* arena,
+                                           QuicAlarmFactory* alarm_factory,
+                                           QuicConnectionContext* context)
+    : delegate_(delegate),
+      clock_(clock),
+      deadlines_(num_slots, QuicTime::Zero()),
+      alarm_(alarm_factory->CreateAlarm(arena->New<AlarmDelegate>(this, context),
+                                        arena)) {
+  QUIC_BUG_IF(quic_alarm_multiplexer_too_many_slots, num_slots > kMaxSlots)
+      << "QuicAlarmMultiplexer created with " << num_slots << " slots";
+}
+
+void QuicAlarmMultiplexer::Set(size_t slot, QuicTime deadline) {
+  QUICHE_DCHECK_LT(slot, deadlines_.size());
+  QUICHE_DCHECK(!IsSet(slot));
+  QUICHE_DCHECK(deadline.IsInitialized());
+  if (alarm_->IsPermanentlyCancelled()) {
+    QUIC_BUG(quic_alarm_multiplexer_set_after_permanent_cancel)
+        << "Set called after the multiplexer is permanently cancelled, slot: "
+        << slot;
+    return;
+  }
+  deadlines_[slot] = deadline;
+  UpdateAlarm();
+}
+
+void QuicAlarmMultiplexer::Update(size_t slot, QuicTime new_deadline,
+                                  QuicTime::Delta granularity) {
+  QUICHE_DCHECK_LT(slot, deadlines_.size());
+  if (!new_deadline.IsInitialized()) {
+    Cancel(slot);
+    return;
+  }
+  if (alarm_->IsPermanentlyCancelled()) {
+    QUIC_BUG(quic_alarm_multiplexer_update_after_permanent_cancel)
+        << "Update called after the multiplexer is permanently cancelled, "
+           "slot: "
+        << slot;
+    return;
+  }
+  if (IsSet(slot) &&
+      std::abs((new_deadline - deadlines_[slot]).ToMicroseconds()) <
+          granularity.ToMicroseconds()) {
+    return;
+  }
+  deadlines_[slot] = new_deadline;
+  UpdateAlarm();
+}
+
+void QuicAlarmMultiplexer::Cancel(size_t slot) {
+  QUICHE_DCHECK_LT(slot, deadlines_.size());
+  if (!IsSet(slot)) {
+    return;
+  }
+  deadlines_[slot] = QuicTime::Zero();
+  UpdateAlarm();
+}
+
+void QuicAlarmMultiplexer::CancelAll(bool permanent) {
+  for (QuicTime& deadline : deadlines_) {
+    deadline = QuicTime::Zero();
+  }
+  if (permanent) {
+    alarm_->PermanentCancel();
+  } else {
+    alarm_->Cancel();
+  }
+}
+
+bool QuicAlarmMultiplexer::IsSet(size_t slot) const {
+  QUICHE_DCHECK_LT(slot, deadlines_.size());
+  return deadlines_[slot].IsInitialized();
+}
+
+QuicTime QuicAlarmMultiplexer::GetDeadline(size_t slot) const {
+  QUICHE_DCHECK_LT(slot, deadlines_.size());
+  return deadlines_[slot];
+}
+
+bool QuicAlarmMultiplexer::HasPendingAlarms() const {
+  return GetEarliestDeadline().IsInitialized();
+}
+
+void QuicAlarmMultiplexer::OnAlarm() {
+  // Fire every expired slot before touching the platform alarm again, so a
+  // stalled event loop drains its backlog with one registration instead of a
+  // set/fire round trip per slot. Dispatching can set or cancel other slots,
+  // so re-scan after every callback.
+  const QuicTime now = clock_->ApproximateNow();
+  while (true) {
+    QuicTime earliest = QuicTime::Zero();
+    size_t earliest_slot = 0;
+    for (size_t slot = 0; slot < deadlines_.size(); ++slot) {
+      const QuicTime deadline = deadlines_[slot];
+      if (!deadline.IsInitialized() || deadline > now) {
+        continue;
+      }
+      if (!earliest.IsInitialized() || deadline < earliest) {
+        earliest = deadline;
+        earliest_slot = slot;
+      }
+    }
+    if (!earliest.IsInitialized()) {
+      break;
+    }
+    deadlines_[earliest_slot] = QuicTime::Zero();
+    delegate_->OnMultiplexedAlarm(earliest_slot);
+    if (alarm_->IsPermanentlyCancelled()) {
+      return;
+    }
+  }
+  UpdateAlarm();
+}
+
+QuicTime QuicAlarmMultiplexer::GetEarliestDeadline() const {
+  QuicTime result = QuicTime::Zero();
+  for (const QuicTime deadline : deadlines_) {
+    if (!deadline.IsInitialized()) {
+      continue;
+    }
+    if (!result.IsInitialized() || deadline < result) {
+      result = deadline;
+    }
+  }
+  return result;
+}
+
+void QuicAlarmMultiplexer::UpdateAlarm() {
+  if (alarm_->IsPermanentlyCancelled()) {
+    return;
+  }
+  alarm_->Update(GetEarliestDeadline(), kAlarmGranularity);
+}
+
+}  // namespace quic
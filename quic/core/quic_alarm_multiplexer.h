@@ -0,0 +1,109 @@
+// Copyright (c) 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_QUIC_ALARM_MULTIPLEXER_H_
+#define QUICHE_QUIC_CORE_QUIC_ALARM_MULTIPLEXER_H_
+
+#include "absl/container/inlined_vector.h"
+#include "quic/core/quic_alarm.h"
+#include "quic/core/quic_alarm_factory.h"
+#include "quic/core/quic_clock.h"
+#include "quic/core/quic_one_block_arena.h"
+#include "quic/core/quic_time.h"
+#include "quic/platform/api/quic_export.h"
+
+namespace quic {
+
+namespace test {
+class QuicAlarmMultiplexerPeer;
+}  // namespace test
+
+// QuicAlarmMultiplexer hosts the deadlines of many logical alarms on a single
+// platform alarm. A connection today creates roughly ten alarm objects, each
+// pairing a heap-allocated delegate with a platform alarm instance that is
+// registered with the event loop separately. The multiplexer replaces that
+// hierarchy with one platform alarm and an inline array of per-slot
+// deadlines: setting or cancelling a slot only touches the array, the
+// soonest deadline across all slots is what gets registered with the event
+// loop, and firing dispatches through a single delegate callback so the
+// owner can switch on the slot instead of paying a virtual call per alarm.
+// This follows the same one-alarm-many-deadlines pattern as
+// QuicNetworkBlackholeDetector, generalized to caller-defined slots.
+//
+// Slots are identified by index; owners are expected to define an enum of
+// slot kinds and dispatch on it in Delegate::OnMultiplexedAlarm.
+class QUIC_EXPORT_PRIVATE QuicAlarmMultiplexer {
+ public:
+  // Enough slots for every alarm of one connection, kept inline so the whole
+  // schedule sits on adjacent cache lines.
+  static constexpr size_t kMaxSlots = 16;
+
+  class QUIC_EXPORT_PRIVATE Delegate {
+   public:
+    virtual ~Delegate() {}
+
+    // Called once per expired slot, earliest deadline first. The slot is
+    // cancelled before the call; the delegate may set or cancel any slot,
+    // including |slot| itself, from within the callback.
+    virtual void OnMultiplexedAlarm(size_t slot) = 0;
+  };
+
+  QuicAlarmMultiplexer(Delegate* delegate, size_t num_slots,
+                       const QuicClock* clock, QuicConnectionArena* arena,
+                       QuicAlarmFactory* alarm_factory,
+                       QuicConnectionContext* context);
+
+  // Sets |slot| to fire at |deadline|. Must not be called while the slot is
+  // set; to reschedule a set slot, call Update() or Cancel() first.
+  void Set(size_t slot, QuicTime deadline);
+
+  // Reschedules |slot| to |new_deadline| if it differs from the current
+  // deadline by more than |granularity|, and otherwise does nothing. If
+  // |new_deadline| is not initialized, the slot is cancelled.
+  void Update(size_t slot, QuicTime new_deadline, QuicTime::Delta granularity);
+
+  // Cancels |slot|. May be called repeatedly.
+  void Cancel(size_t slot);
+
+  // Cancels every slot. If |permanent|, the platform alarm is permanently
+  // cancelled and future calls to Set() and Update() become no-ops.
+  void CancelAll(bool permanent);
+
+  // Returns true if |slot| has a pending deadline.
+  bool IsSet(size_t slot) const;
+
+  // Returns the pending deadline of |slot|, or QuicTime::Zero() if the slot
+  // is not set.
+  QuicTime GetDeadline(size_t slot) const;
+
+  // Returns true if any slot has a pending deadline.
+  bool HasPendingAlarms() const;
+
+  size_t num_slots() const { return deadlines_.size(); }
+
+  // Called when the shared platform alarm fires.
+  void OnAlarm();
+
+ private:
+  friend class test::QuicAlarmMultiplexerPeer;
+
+  // Returns the soonest pending deadline across all slots, or
+  // QuicTime::Zero() if no slot is set.
+  QuicTime GetEarliestDeadline() const;
+
+  // Re-registers the platform alarm for the soonest pending deadline.
+  void UpdateAlarm();
+
+  Delegate* delegate_;      // Not owned.
+  const QuicClock* clock_;  // Not owned.
+
+  // One deadline per slot. QuicTime::Zero() means the slot is not set.
+  absl::InlinedVector<QuicTime, kMaxSlots> deadlines_;
+
+  QuicArenaScopedPtr<QuicAlarm> alarm_;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_QUIC_ALARM_MULTIPLEXER_H_
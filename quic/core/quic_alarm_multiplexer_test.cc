@@ -0,0 +1,173 @@
+// Copyright (c) 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/quic_alarm_multiplexer.h"
+
+#include "quic/core/quic_constants.h"
+#include "quic/core/quic_one_block_arena.h"
+#include "quic/platform/api/quic_expect_bug.h"
+#include "quic/platform/api/quic_test.h"
+#include "quic/test_tools/quic_test_utils.h"
+
+namespace quic {
+namespace test {
+
+class QuicAlarmMultiplexerPeer {
+ public:
+  static QuicAlarm* GetAlarm(QuicAlarmMultiplexer* multiplexer) {
+    return multiplexer->alarm_.get();
+  }
+};
+
+namespace {
+
+using testing::InSequence;
+using testing::Invoke;
+
+// The slots one owner might host; only the indices matter to the multiplexer.
+enum : size_t {
+  kAckSlot = 0,
+  kRetransmissionSlot = 1,
+  kPingSlot = 2,
+  kNumSlots = 3,
+};
+
+class MockDelegate : public QuicAlarmMultiplexer::Delegate {
+ public:
+  MOCK_METHOD(void, OnMultiplexedAlarm, (size_t), (override));
+};
+
+class QuicAlarmMultiplexerTest : public QuicTest {
+ public:
+  QuicAlarmMultiplexerTest()
+      : multiplexer_(&delegate_, kNumSlots, &clock_, &arena_, &alarm_factory_,
+                     /*context=*/nullptr),
+        alarm_(static_cast<MockAlarmFactory::TestAlarm*>(
+            QuicAlarmMultiplexerPeer::GetAlarm(&multiplexer_))) {
+    clock_.AdvanceTime(QuicTime::Delta::FromSeconds(1));
+  }
+
+ protected:
+  testing::StrictMock<MockDelegate> delegate_;
+  QuicConnectionArena arena_;
+  MockAlarmFactory alarm_factory_;
+  MockClock clock_;
+
+  QuicAlarmMultiplexer multiplexer_;
+
+  MockAlarmFactory::TestAlarm* alarm_;
+};
+
+TEST_F(QuicAlarmMultiplexerTest, PlatformAlarmTracksEarliestDeadline) {
+  EXPECT_FALSE(multiplexer_.HasPendingAlarms());
+  EXPECT_FALSE(alarm_->IsSet());
+
+  const QuicTime ack_deadline = clock_.Now() + QuicTime::Delta::FromSeconds(5);
+  const QuicTime retransmission_deadline =
+      clock_.Now() + QuicTime::Delta::FromSeconds(10);
+  multiplexer_.Set(kRetransmissionSlot, retransmission_deadline);
+  EXPECT_EQ(retransmission_deadline, alarm_->deadline());
+  multiplexer_.Set(kAckSlot, ack_deadline);
+  EXPECT_EQ(ack_deadline, alarm_->deadline());
+  EXPECT_TRUE(multiplexer_.IsSet(kAckSlot));
+  EXPECT_FALSE(multiplexer_.IsSet(kPingSlot));
+
+  // Cancelling the earliest slot moves the platform alarm out to the next
+  // pending deadline; cancelling the last slot stops it.
+  multiplexer_.Cancel(kAckSlot);
+  EXPECT_EQ(retransmission_deadline, alarm_->deadline());
+  multiplexer_.Cancel(kRetransmissionSlot);
+  EXPECT_FALSE(alarm_->IsSet());
+  EXPECT_FALSE(multiplexer_.HasPendingAlarms());
+}
+
+TEST_F(QuicAlarmMultiplexerTest, FiresExpiredSlotsEarliestFirst) {
+  const QuicTime::Delta ack_delay = QuicTime::Delta::FromSeconds(5);
+  const QuicTime::Delta retransmission_delay = QuicTime::Delta::FromSeconds(7);
+  const QuicTime ping_deadline = clock_.Now() + QuicTime::Delta::FromSeconds(20);
+  multiplexer_.Set(kRetransmissionSlot, clock_.Now() + retransmission_delay);
+  multiplexer_.Set(kAckSlot, clock_.Now() + ack_delay);
+  multiplexer_.Set(kPingSlot, ping_deadline);
+
+  // Both the ack and retransmission deadlines have passed when the alarm
+  // fires; one firing drains both, in deadline order.
+  clock_.AdvanceTime(QuicTime::Delta::FromSeconds(10));
+  InSequence s;
+  EXPECT_CALL(delegate_, OnMultiplexedAlarm(kAckSlot));
+  EXPECT_CALL(delegate_, OnMultiplexedAlarm(kRetransmissionSlot));
+  alarm_->Fire();
+
+  EXPECT_FALSE(multiplexer_.IsSet(kAckSlot));
+  EXPECT_FALSE(multiplexer_.IsSet(kRetransmissionSlot));
+  EXPECT_TRUE(multiplexer_.IsSet(kPingSlot));
+  EXPECT_EQ(ping_deadline, alarm_->deadline());
+}
+
+TEST_F(QuicAlarmMultiplexerTest, UpdateWithinGranularityDoesNothing) {
+  const QuicTime deadline = clock_.Now() + QuicTime::Delta::FromSeconds(5);
+  multiplexer_.Set(kAckSlot, deadline);
+
+  multiplexer_.Update(kAckSlot,
+                      deadline + QuicTime::Delta::FromMicroseconds(100),
+                      kAlarmGranularity);
+  EXPECT_EQ(deadline, multiplexer_.GetDeadline(kAckSlot));
+
+  const QuicTime new_deadline = deadline + QuicTime::Delta::FromSeconds(5);
+  multiplexer_.Update(kAckSlot, new_deadline, kAlarmGranularity);
+  EXPECT_EQ(new_deadline, multiplexer_.GetDeadline(kAckSlot));
+  EXPECT_EQ(new_deadline, alarm_->deadline());
+}
+
+TEST_F(QuicAlarmMultiplexerTest, UpdateWithUninitializedDeadlineCancels) {
+  multiplexer_.Set(kAckSlot, clock_.Now() + QuicTime::Delta::FromSeconds(5));
+  multiplexer_.Update(kAckSlot, QuicTime::Zero(), kAlarmGranularity);
+  EXPECT_FALSE(multiplexer_.IsSet(kAckSlot));
+  EXPECT_FALSE(alarm_->IsSet());
+}
+
+TEST_F(QuicAlarmMultiplexerTest, DelegateMayRearmDuringDispatch) {
+  multiplexer_.Set(kAckSlot, clock_.Now() + QuicTime::Delta::FromSeconds(5));
+  clock_.AdvanceTime(QuicTime::Delta::FromSeconds(5));
+
+  const QuicTime rearm_deadline =
+      clock_.Now() + QuicTime::Delta::FromSeconds(5);
+  EXPECT_CALL(delegate_, OnMultiplexedAlarm(kAckSlot))
+      .WillOnce(Invoke([this, rearm_deadline](size_t /*slot*/) {
+        // The slot is already cancelled when the callback runs, so it can be
+        // set again directly.
+        EXPECT_FALSE(multiplexer_.IsSet(kAckSlot));
+        multiplexer_.Set(kAckSlot, rearm_deadline);
+      }));
+  alarm_->Fire();
+
+  // The re-armed deadline is in the future, so it is not fired in the same
+  // dispatch, only registered with the platform alarm.
+  EXPECT_EQ(rearm_deadline, multiplexer_.GetDeadline(kAckSlot));
+  EXPECT_EQ(rearm_deadline, alarm_->deadline());
+}
+
+TEST_F(QuicAlarmMultiplexerTest, CancelAll) {
+  multiplexer_.Set(kAckSlot, clock_.Now() + QuicTime::Delta::FromSeconds(5));
+  multiplexer_.Set(kPingSlot, clock_.Now() + QuicTime::Delta::FromSeconds(15));
+
+  multiplexer_.CancelAll(/*permanent=*/false);
+  EXPECT_FALSE(multiplexer_.HasPendingAlarms());
+  EXPECT_FALSE(alarm_->IsSet());
+
+  // A non-permanent cancellation can be re-armed.
+  const QuicTime deadline = clock_.Now() + QuicTime::Delta::FromSeconds(5);
+  multiplexer_.Set(kAckSlot, deadline);
+  EXPECT_EQ(deadline, alarm_->deadline());
+
+  multiplexer_.CancelAll(/*permanent=*/true);
+  EXPECT_TRUE(alarm_->IsPermanentlyCancelled());
+  EXPECT_QUIC_BUG(
+      multiplexer_.Set(kAckSlot, clock_.Now() + QuicTime::Delta::FromSeconds(1)),
+      "Set called after the multiplexer is permanently cancelled");
+  EXPECT_FALSE(multiplexer_.HasPendingAlarms());
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
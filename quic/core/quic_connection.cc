@@ -32,9 +32,11 @@
 #include "quic/core/quic_constants.h"
 #include "quic/core/quic_error_codes.h"
 #include "quic/core/quic_legacy_version_encapsulator.h"
+#include "quic/core/quic_mtu_discovery.h"
 #include "quic/core/quic_packet_creator.h"
 #include "quic/core/quic_packet_writer.h"
 #include "quic/core/quic_path_validator.h"
+#include "quic/core/quic_stage_latency_recorder.h"
 #include "quic/core/quic_types.h"
 #include "quic/core/quic_utils.h"
 #include "quic/platform/api/quic_bug_tracker.h"
@@ -63,6 +65,10 @@ const QuicPacketCount kMaxConsecutiveNonRetransmittablePackets = 19;
 // The minimum release time into future in ms.
 const int kMinReleaseTimeIntoFutureMs = 1;
 
+// Maximum number of packet buffers retained in the per-connection pool used
+// while the writer is blocked.
+const size_t kMaxFreePacketBuffers = 32;
+
 // Base class of all alarms owned by a QuicConnection.
 class QuicConnectionAlarmDelegate : public QuicAlarm::Delegate {
  public:
@@ -744,6 +750,10 @@ void QuicConnection::SetMaxPacingRate(QuicBandwidth max_pacing_rate) {
   sent_packet_manager_.SetMaxPacingRate(max_pacing_rate);
 }
 
+void QuicConnection::SetPacingDeadlineHint(QuicTime deadline) {
+  sent_packet_manager_.SetPacingDeadlineHint(deadline);
+}
+
 void QuicConnection::AdjustNetworkParameters(
     const SendAlgorithmInterface::NetworkParams& params) {
   sent_packet_manager_.AdjustNetworkParameters(params);
@@ -1428,6 +1438,26 @@ bool QuicConnection::OnAckRange(QuicPacketNumber start, QuicPacketNumber end) {
   return true;
 }
 
+bool QuicConnection::OnAckFrameEcnCounts(QuicPacketCount ect_0_count,
+                                         QuicPacketCount ect_1_count,
+                                         QuicPacketCount ecn_ce_count) {
+  QUIC_BUG_IF(quic_bug_ecn_counts_disconnected, !connected_)
+      << "Processing ACK frame ECN counts when connection is closed. Last "
+         "frame: "
+      << most_recent_frame_type_;
+  QUIC_DVLOG(1) << ENDPOINT << "OnAckFrameEcnCounts: ect_0: " << ect_0_count
+                << ", ect_1: " << ect_1_count << ", ce: " << ecn_ce_count;
+
+  if (GetLargestReceivedPacketWithAck().IsInitialized() &&
+      last_header_.packet_number <= GetLargestReceivedPacketWithAck()) {
+    QUIC_DLOG(INFO) << ENDPOINT << "Received an old ack frame: ignoring";
+    return true;
+  }
+  sent_packet_manager_.OnAckFrameEcnCounts(ect_0_count, ect_1_count,
+                                           ecn_ce_count);
+  return true;
+}
+
 bool QuicConnection::OnAckTimestamp(QuicPacketNumber packet_number,
                                     QuicTime timestamp) {
   QUIC_BUG_IF(quic_bug_10511_7, !connected_)
@@ -1745,12 +1775,12 @@ bool QuicConnection::OnPathChallengeFrameInternal(
   const bool success = SendPathResponse(
       frame.data_buffer, last_received_packet_info_.source_address,
       current_effective_peer_address);
-  if (GetQuicReloadableFlag(quic_drop_unsent_path_response)) {
+  if (flag_snapshot_.drop_unsent_path_response) {
     QUIC_RELOADABLE_FLAG_COUNT(quic_drop_unsent_path_response);
   }
   if (!success) {
     QUIC_CODE_COUNT(quic_failed_to_send_path_response);
-    if (!GetQuicReloadableFlag(quic_drop_unsent_path_response)) {
+    if (!flag_snapshot_.drop_unsent_path_response) {
       // Queue the payloads to re-try later.
       pending_path_challenge_payloads_.push_back(
           {frame.data_buffer, last_received_packet_info_.source_address});
@@ -2340,6 +2370,11 @@ void QuicConnection::OnKeyUpdate(KeyUpdateReason reason) {
   // old keys would already be discarded.
   discard_previous_one_rtt_keys_alarm_->Cancel();
 
+  // Cached retransmission templates serialized their headers under the old
+  // key phase; re-encrypting them under the new keys would emit packets the
+  // peer cannot decrypt.
+  packet_creator_.ClearRetransmissionTemplates();
+
   visitor_->OnKeyUpdate(reason);
 }
 
@@ -2473,6 +2508,12 @@ size_t QuicConnection::SendCryptoData(EncryptionLevel level,
   if (level == ENCRYPTION_INITIAL) {
     MaybeActivateLegacyVersionEncapsulation();
   }
+  if (packet_creator_.HasPendingRetransmittableFrames()) {
+    // The creator flushes any pending application frames before adding
+    // crypto data, so that the crypto frames lead a packet of their own.
+    // Track how often crypto data preempts a partially-filled packet.
+    ++stats_.crypto_preempted_partial_packets;
+  }
   size_t consumed_length;
   {
     ScopedPacketFlusher flusher(this);
@@ -2592,6 +2633,9 @@ const QuicConnectionStats& QuicConnection::GetStats() {
   QuicTime::Delta srtt = rtt_stats->SmoothedOrInitialRtt();
   stats_.srtt_us = srtt.ToMicroseconds();
 
+  stats_.max_queueing_delay_us =
+      rtt_stats->max_queueing_delay().ToMicroseconds();
+
   stats_.estimated_bandwidth = sent_packet_manager_.BandwidthEstimate();
   sent_packet_manager_.GetSendAlgorithm()->PopulateConnectionStats(&stats_);
   stats_.egress_mtu = long_term_mtu_;
@@ -2734,6 +2778,8 @@ void QuicConnection::ProcessUdpPacket(const QuicSocketAddress& self_address,
   if (!connected_) {
     return;
   }
+  QuicScopedStageLatencySampler latency_sampler(
+      QuicStageLatencyRecorder::kProcessUdpPacket);
   QUIC_DVLOG(2) << ENDPOINT << "Received encrypted " << packet.length()
                 << " bytes:" << std::endl
                 << quiche::QuicheTextUtils::HexDump(
@@ -2795,6 +2841,15 @@ void QuicConnection::ProcessUdpPacket(const QuicSocketAddress& self_address,
                 << last_received_packet_info_.source_address;
 
   ScopedPacketFlusher flusher(this);
+  // Once the handshake completes, a packet that fails to decrypt is dropped
+  // rather than buffered for a later retry, so the framer may decrypt the
+  // receive buffer in place instead of copying the plaintext out of it. All
+  // decrypters are AEADs for versions which know which decrypter to use.
+  framer_.set_allow_in_place_decryption(version().KnowsWhichDecrypterToUse() &&
+                                        IsHandshakeComplete());
+  // Process all ACK frames in this datagram (including coalesced packets) in
+  // a single loss detection and congestion control pass.
+  sent_packet_manager_.EnterAckBatchMode();
   if (!framer_.ProcessPacket(packet)) {
     // If we are unable to decrypt this packet, it might be
     // because the CHLO or SHLO packet was lost.
@@ -2805,6 +2860,9 @@ void QuicConnection::ProcessUdpPacket(const QuicSocketAddress& self_address,
     is_current_packet_connectivity_probing_ = false;
 
     MaybeProcessCoalescedPackets();
+    if (sent_packet_manager_.OnAckBatchComplete() && connected_) {
+      SetRetransmissionAlarm();
+    }
     return;
   }
 
@@ -2830,6 +2888,11 @@ void QuicConnection::ProcessUdpPacket(const QuicSocketAddress& self_address,
     MaybeProcessUndecryptablePackets();
     MaybeSendInResponseToPacket();
   }
+  if (sent_packet_manager_.OnAckBatchComplete() && connected_) {
+    // The retransmission alarm was armed before the deferred loss detection
+    // and congestion control pass ran; recompute it with the updated state.
+    SetRetransmissionAlarm();
+  }
   SetPingAlarm();
   RetirePeerIssuedConnectionIdsNoLongerOnPath();
   current_packet_data_ = nullptr;
@@ -2845,6 +2908,8 @@ void QuicConnection::OnCanWrite() {
   if (!connected_) {
     return;
   }
+  QuicScopedStageLatencySampler latency_sampler(
+      QuicStageLatencyRecorder::kOnCanWrite);
   if (writer_->IsWriteBlocked()) {
     const std::string error_details =
         "Writer is blocked while calling OnCanWrite.";
@@ -3131,6 +3196,11 @@ void QuicConnection::WriteQueuedPackets() {
       break;
     }
     const BufferedPacket& packet = buffered_packets_.front();
+    if (per_packet_options_ != nullptr) {
+      // Restore the QoS marking the packet was assigned when it was
+      // originally written.
+      per_packet_options_->qos_class = packet.qos_class;
+    }
     WriteResult result = writer_->WritePacket(
         packet.encrypted_buffer.data(), packet.encrypted_buffer.length(),
         packet.self_address.host(), packet.peer_address, per_packet_options_);
@@ -3273,7 +3343,7 @@ bool QuicConnection::CanWrite(HasRetransmittableData retransmittable) {
     return false;
   }
 
-  if (GetQuicReloadableFlag(quic_suppress_write_mid_packet_processing) &&
+  if (flag_snapshot_.suppress_write_mid_packet_processing &&
       version().CanSendCoalescedPackets() &&
       framer_.HasEncrypterOfEncryptionLevel(ENCRYPTION_INITIAL) &&
       framer_.is_processing_packet()) {
@@ -3295,8 +3365,8 @@ bool QuicConnection::CanWrite(HasRetransmittableData retransmittable) {
   }
 
   const bool donot_check_amplification_limit_with_pending_timer_credit =
-      GetQuicReloadableFlag(
-          quic_donot_check_amplification_limit_with_pending_timer_credit);
+      flag_snapshot_
+          .donot_check_amplification_limit_with_pending_timer_credit;
 
   if (!donot_check_amplification_limit_with_pending_timer_credit &&
       LimitedByAmplificationFactor()) {
@@ -3459,6 +3529,12 @@ bool QuicConnection::WritePacket(SerializedPacket* packet) {
       (send_path_response_) ? packet->peer_address : peer_address();
   // Self address is always the default self address on this code path.
   bool send_on_current_path = send_to_address == peer_address();
+  // The highest QoS class among the streams whose data this packet carries.
+  // QoS-aware writers translate it into the packet's DSCP marking.
+  const QuicQosClass packet_qos_class = GetQosClassForPacket(*packet);
+  if (per_packet_options_ != nullptr) {
+    per_packet_options_->qos_class = packet_qos_class;
+  }
   switch (fate) {
     case DISCARD:
       ++stats_.packets_discarded;
@@ -3497,7 +3573,10 @@ bool QuicConnection::WritePacket(SerializedPacket* packet) {
     case BUFFER:
       QUIC_DVLOG(1) << ENDPOINT << "Adding packet: " << packet->packet_number
                     << " to buffered packets";
-      buffered_packets_.emplace_back(*packet, self_address(), send_to_address);
+      // Takes over the packet's buffer lease (a pooled buffer handed out by
+      // GetPacketBuffer() while blocked) instead of copying.
+      buffered_packets_.emplace_back(packet, self_address(), send_to_address);
+      buffered_packets_.back().qos_class = packet_qos_class;
       break;
     case SEND_TO_WRITER:
       // Stop using coalescer from now on.
@@ -3556,9 +3635,11 @@ bool QuicConnection::WritePacket(SerializedPacket* packet) {
             << " of length " << encrypted_length;
       }
       if (!buffered_packets_.empty() || HandleWriteBlocked()) {
-        // Buffer the packet.
-        buffered_packets_.emplace_back(*packet, self_address(),
+        // Buffer the packet, taking over the encapsulated packet's buffer
+        // lease instead of copying.
+        buffered_packets_.emplace_back(packet, self_address(),
                                        send_to_address);
+        buffered_packets_.back().qos_class = packet_qos_class;
       } else {  // Send the packet to the writer.
         // writer_->WritePacket transfers buffer ownership back to the writer.
         packet->release_encrypted_buffer = nullptr;
@@ -3589,7 +3670,10 @@ bool QuicConnection::WritePacket(SerializedPacket* packet) {
     if (result.status != WRITE_STATUS_BLOCKED_DATA_BUFFERED) {
       QUIC_DVLOG(1) << ENDPOINT << "Adding packet: " << packet->packet_number
                     << " to buffered packets";
-      buffered_packets_.emplace_back(*packet, self_address(), send_to_address);
+      // The buffer lease was consumed by writer_->WritePacket() above, so
+      // this copies the bytes.
+      buffered_packets_.emplace_back(packet, self_address(), send_to_address);
+      buffered_packets_.back().qos_class = packet_qos_class;
     }
   }
 
@@ -3726,8 +3810,7 @@ bool QuicConnection::WritePacket(SerializedPacket* packet) {
       return true;
     }
   }
-  if (GetQuicReloadableFlag(
-          quic_donot_rearm_pto_on_application_data_during_handshake)) {
+  if (flag_snapshot_.donot_rearm_pto_on_application_data_during_handshake) {
     QUIC_RELOADABLE_FLAG_COUNT(
         quic_donot_rearm_pto_on_application_data_during_handshake);
     if (ShouldSetRetransmissionAlarmOnPacketSent(in_flight,
@@ -3942,6 +4025,11 @@ bool QuicConnection::MaybeRevertToPreviousMtu() {
   mtu_discoverer_.Disable();
   mtu_discovery_alarm_->Cancel();
   previous_validated_mtu_ = 0;
+  // The increased MTU black-holed (or could not be written). Lower the
+  // process-wide estimate so other connections to this prefix do not probe
+  // past the size this connection fell back to.
+  QuicMtuCache::GetInstance()->OnMtuBlackholeDetected(peer_address(),
+                                                      max_packet_length());
   return true;
 }
 
@@ -3979,9 +4067,37 @@ QuicPacketBuffer QuicConnection::GetPacketBuffer() {
     // contain multiple QUIC packets.
     return {nullptr, nullptr};
   }
+  if (!buffered_packets_.empty() || writer_->IsWriteBlocked()) {
+    // This packet is going to be buffered (GetSerializedPacketFate applies
+    // the same predicate), so serialize it straight into a pooled buffer
+    // whose lease transfers into buffered_packets_ without a copy. The
+    // writer's buffer must not be used here: its next-write slot cannot be
+    // held across other writes, which would force BufferedPacket to copy.
+    return AcquirePooledPacketBuffer();
+  }
   return writer_->GetNextWriteLocation(self_address().host(), peer_address());
 }
 
+QuicPacketBuffer QuicConnection::AcquirePooledPacketBuffer() {
+  char* buffer;
+  if (!free_packet_buffers_.empty()) {
+    buffer = free_packet_buffers_.back().release();
+    free_packet_buffers_.pop_back();
+  } else {
+    buffer = new char[kMaxOutgoingPacketSize];
+  }
+  return QuicPacketBuffer(
+      buffer, [this](const char* p) { ReleasePooledPacketBuffer(p); });
+}
+
+void QuicConnection::ReleasePooledPacketBuffer(const char* buffer) {
+  if (free_packet_buffers_.size() < kMaxFreePacketBuffers) {
+    free_packet_buffers_.emplace_back(const_cast<char*>(buffer));
+    return;
+  }
+  delete[] buffer;
+}
+
 void QuicConnection::OnSerializedPacket(SerializedPacket serialized_packet) {
   if (serialized_packet.encrypted_buffer == nullptr) {
     // We failed to serialize the packet, so close the connection.
@@ -4046,6 +4162,8 @@ void QuicConnection::OnPathMtuIncreased(QuicPacketLength packet_size) {
     SetMaxPacketLength(packet_size);
     mtu_discoverer_.OnMaxPacketLengthUpdated(previous_validated_mtu_,
                                              max_packet_length());
+    QuicMtuCache::GetInstance()->OnMtuValidated(peer_address(),
+                                                max_packet_length());
   }
 }
 
@@ -4204,7 +4322,9 @@ void QuicConnection::OnRetransmissionTimeout() {
   // In the PTO and TLP cases, the SentPacketManager gives the connection the
   // opportunity to send new data before retransmitting.
   if (sent_packet_manager_.pto_enabled()) {
-    sent_packet_manager_.MaybeSendProbePackets();
+    if (!MaybeSendProbeFromRetransmissionTemplate()) {
+      sent_packet_manager_.MaybeSendProbePackets();
+    }
   } else if (sent_packet_manager_.MaybeRetransmitTailLossProbe()) {
     // Send the pending retransmission now that it's been queued.
     WriteIfNotBlocked();
@@ -4275,6 +4395,37 @@ void QuicConnection::OnRetransmissionTimeout() {
   }
 }
 
+bool QuicConnection::MaybeSendProbeFromRetransmissionTemplate() {
+  if (!packet_creator_.has_retransmission_templates() ||
+      sent_packet_manager_.pending_timer_transmission_count() == 0) {
+    return false;
+  }
+  const QuicUnackedPacketMap& unacked_packets =
+      sent_packet_manager_.unacked_packets();
+  if (unacked_packets.empty()) {
+    return false;
+  }
+  const QuicPacketNumber largest_sent_packet =
+      unacked_packets.largest_sent_packet();
+  for (QuicPacketNumber packet_number = unacked_packets.GetLeastUnacked();
+       packet_number <= largest_sent_packet; ++packet_number) {
+    const QuicTransmissionInfo& transmission_info =
+        unacked_packets.GetTransmissionInfo(packet_number);
+    if (transmission_info.state != OUTSTANDING ||
+        !unacked_packets.HasRetransmittableFrames(transmission_info)) {
+      continue;
+    }
+    if (!packet_creator_.HasRetransmissionTemplate(packet_number)) {
+      // Probe the oldest outstanding packet or nothing; probing newer data
+      // while older data needs retransmission would reorder recovery.
+      return false;
+    }
+    return packet_creator_.MaybeSerializeFromRetransmissionTemplate(
+        packet_number, PTO_RETRANSMISSION);
+  }
+  return false;
+}
+
 void QuicConnection::SetEncrypter(EncryptionLevel level,
                                   std::unique_ptr<QuicEncrypter> encrypter) {
   packet_creator_.SetEncrypter(level, std::move(encrypter));
@@ -4290,6 +4441,18 @@ void QuicConnection::SetDiversificationNonce(
   packet_creator_.SetDiversificationNonce(nonce);
 }
 
+void QuicConnection::AdvanceToPacketNumber(QuicPacketNumber next_packet_number) {
+  const QuicPacketNumber next_to_send =
+      packet_creator_.NextSendingPacketNumber();
+  if (next_packet_number <= next_to_send) {
+    return;
+  }
+  packet_creator_.SkipNPacketNumbers(
+      next_packet_number - next_to_send,
+      sent_packet_manager_.GetLeastPacketAwaitedByPeer(encryption_level_),
+      sent_packet_manager_.EstimateMaxPacketsInFlight(max_packet_length()));
+}
+
 void QuicConnection::SetDefaultEncryptionLevel(EncryptionLevel level) {
   QUIC_DVLOG(1) << ENDPOINT << "Setting default encryption level from "
                 << encryption_level_ << " to " << level;
@@ -4754,6 +4917,13 @@ void QuicConnection::SetNetworkTimeouts(QuicTime::Delta handshake_timeout,
   idle_network_detector_.SetTimeouts(handshake_timeout, idle_timeout);
 }
 
+void QuicConnection::SetMemoryReclaimTimeout(QuicTime::Delta timeout) {
+  if (!connected_) {
+    return;
+  }
+  idle_network_detector_.SetMemoryReclaimTimeout(timeout);
+}
+
 void QuicConnection::SetPingAlarm() {
   if (!connected_) {
     return;
@@ -4973,22 +5143,55 @@ QuicConnection::BufferedPacket::BufferedPacket(
     const SerializedPacket& packet,
     const QuicSocketAddress& self_address,
     const QuicSocketAddress& peer_address)
-    : encrypted_buffer(CopyBuffer(packet), packet.encrypted_length),
+    : packet_buffer(CopyBuffer(packet), [](const char* p) { delete[] p; }),
+      encrypted_buffer(packet_buffer.buffer, packet.encrypted_length),
       self_address(self_address),
       peer_address(peer_address) {}
 
+QuicConnection::BufferedPacket::BufferedPacket(
+    SerializedPacket* packet,
+    const QuicSocketAddress& self_address,
+    const QuicSocketAddress& peer_address)
+    : packet_buffer(nullptr, nullptr),
+      self_address(self_address),
+      peer_address(peer_address) {
+  if (packet->release_encrypted_buffer != nullptr) {
+    // The packet owns its buffer; transfer the lease instead of copying.
+    packet_buffer.buffer = const_cast<char*>(packet->encrypted_buffer);
+    packet_buffer.release_buffer = std::move(packet->release_encrypted_buffer);
+    packet->release_encrypted_buffer = nullptr;
+  } else {
+    packet_buffer.buffer = CopyBuffer(*packet);
+    packet_buffer.release_buffer = [](const char* p) { delete[] p; };
+  }
+  encrypted_buffer =
+      absl::string_view(packet_buffer.buffer, packet->encrypted_length);
+}
+
 QuicConnection::BufferedPacket::BufferedPacket(
     char* encrypted_buffer,
     QuicPacketLength encrypted_length,
     const QuicSocketAddress& self_address,
     const QuicSocketAddress& peer_address)
-    : encrypted_buffer(CopyBuffer(encrypted_buffer, encrypted_length),
-                       encrypted_length),
+    : packet_buffer(CopyBuffer(encrypted_buffer, encrypted_length),
+                    [](const char* p) { delete[] p; }),
+      encrypted_buffer(packet_buffer.buffer, encrypted_length),
       self_address(self_address),
       peer_address(peer_address) {}
 
-QuicConnection::BufferedPacket::~BufferedPacket() {
-  delete[] encrypted_buffer.data();
+QuicConnection::BufferedPacket::~BufferedPacket() {}
+
+QuicQosClass QuicConnection::GetQosClassForPacket(
+    const SerializedPacket& packet) const {
+  QuicQosClass qos_class = QOS_CLASS_DEFAULT;
+  for (const QuicFrame& frame : packet.retransmittable_frames) {
+    if (frame.type != STREAM_FRAME) {
+      continue;
+    }
+    qos_class = std::max(qos_class, visitor_->GetQosClassForStream(
+                                        frame.stream_frame.stream_id));
+  }
+  return qos_class;
 }
 
 HasRetransmittableData QuicConnection::IsRetransmittable(
@@ -5018,6 +5221,14 @@ bool QuicConnection::IsTerminationPacket(const SerializedPacket& packet,
 }
 
 void QuicConnection::SetMtuDiscoveryTarget(QuicByteCount target) {
+  // Paths already explored by other connections seed the search: probe
+  // towards the MTU previously validated for this destination prefix rather
+  // than the fixed default, and do not probe past a size that black-holed.
+  const QuicByteCount cached_mtu =
+      QuicMtuCache::GetInstance()->GetMtuEstimate(peer_address());
+  if (cached_mtu != 0) {
+    target = cached_mtu;
+  }
   QUIC_DVLOG(2) << ENDPOINT << "SetMtuDiscoveryTarget: " << target;
   mtu_discoverer_.Disable();
   mtu_discoverer_.Enable(max_packet_length(), GetLimitedMaxPacketSize(target));
@@ -5210,6 +5421,15 @@ void QuicConnection::DisableMtuDiscovery() {
 void QuicConnection::DiscoverMtu() {
   QUICHE_DCHECK(!mtu_discovery_alarm_->IsSet());
 
+  if (sent_packet_manager_.GetBytesInFlight() >=
+      sent_packet_manager_.GetCongestionWindowInBytes()) {
+    // The congestion window is fully committed to application data. Defer
+    // the probe rather than taking window from the application; the alarm is
+    // re-armed after the next sent packet and the probe goes out once there
+    // is headroom.
+    return;
+  }
+
   const QuicPacketNumber largest_sent_packet =
       sent_packet_manager_.GetLargestSentPacket();
   if (mtu_discoverer_.ShouldProbeMtu(largest_sent_packet)) {
@@ -6034,10 +6254,26 @@ bool QuicConnection::FlushCoalescedPacket() {
     return true;
   }
 
-  char buffer[kMaxOutgoingPacketSize];
+  char stack_buffer[kMaxOutgoingPacketSize];
+  // When the datagram is going straight to the writer, assemble it directly
+  // into the writer's buffer so that each coalesced ciphertext is copied to
+  // the wire buffer exactly once; a batch writer will then push it in place
+  // without a further copy. Fall back to the stack buffer if the datagram is
+  // about to be buffered instead, or if the writer has no buffer to offer.
+  QuicPacketBuffer writer_buffer;
+  if (buffered_packets_.empty() && !writer_->IsWriteBlocked()) {
+    writer_buffer = writer_->GetNextWriteLocation(
+        coalesced_packet_.self_address().host(),
+        coalesced_packet_.peer_address());
+  }
+  char* buffer =
+      writer_buffer.buffer != nullptr ? writer_buffer.buffer : stack_buffer;
   const size_t length = packet_creator_.SerializeCoalescedPacket(
       coalesced_packet_, buffer, coalesced_packet_.max_packet_length());
   if (length == 0) {
+    if (writer_buffer.release_buffer != nullptr) {
+      writer_buffer.release_buffer(writer_buffer.buffer);
+    }
     return false;
   }
   if (debug_visitor_ != nullptr) {
@@ -6236,6 +6472,11 @@ void QuicConnection::set_min_received_before_ack_decimation(size_t new_value) {
       new_value);
 }
 
+void QuicConnection::set_local_max_ack_delay(
+    QuicTime::Delta local_max_ack_delay) {
+  uber_received_packet_manager_.set_local_max_ack_delay(local_max_ack_delay);
+}
+
 const QuicAckFrame& QuicConnection::ack_frame() const {
   if (SupportsMultiplePacketNumberSpaces()) {
     return uber_received_packet_manager_.GetAckFrame(
@@ -6354,6 +6595,21 @@ void QuicConnection::OnIdleNetworkDetected() {
                   idle_timeout_connection_close_behavior_);
 }
 
+void QuicConnection::OnMemoryReclaimTimeout() {
+  if (!connected_) {
+    return;
+  }
+  // Only reclaim while the connection is quiescent. With packets in flight or
+  // queued data, buffers are about to be reused and freeing them would churn.
+  if (!IsHandshakeComplete() || sent_packet_manager_.HasInFlightPackets() ||
+      HasQueuedData()) {
+    return;
+  }
+  QUIC_DVLOG(1) << ENDPOINT << "Reclaiming idle connection memory";
+  ++stats_.num_idle_memory_reclaims;
+  visitor_->OnIdleMemoryReclaim();
+}
+
 void QuicConnection::OnPeerIssuedConnectionIdRetired() {
   QUICHE_DCHECK(peer_issued_cid_manager_ != nullptr);
   QuicConnectionId* default_path_cid =
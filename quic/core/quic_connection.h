@@ -41,6 +41,7 @@
 #include "quic/core/quic_connection_id_manager.h"
 #include "quic/core/quic_connection_stats.h"
 #include "quic/core/quic_constants.h"
+#include "quic/core/quic_flag_snapshot.h"
 #include "quic/core/quic_framer.h"
 #include "quic/core/quic_idle_network_detector.h"
 #include "quic/core/quic_mtu_discovery.h"
@@ -196,6 +197,13 @@ class QUIC_EXPORT_PRIVATE QuicConnectionVisitorInterface {
   // Called to retrieve streams information for logging purpose.
   virtual std::string GetStreamsInfoForLogging() const = 0;
 
+  // Returns the QoS class of |stream_id|, used to DSCP-mark packets carrying
+  // the stream's data. The default implementation treats all streams as best
+  // effort.
+  virtual QuicQosClass GetQosClassForStream(QuicStreamId /*stream_id*/) const {
+    return QOS_CLASS_DEFAULT;
+  }
+
   // Called when a self address change is observed. Returns true if self address
   // change is allowed.
   virtual bool AllowSelfAddressChange() const = 0;
@@ -243,6 +251,11 @@ class QUIC_EXPORT_PRIVATE QuicConnectionVisitorInterface {
 
   // Whether the server address is known to the connection.
   virtual bool IsKnownServerAddress(const QuicSocketAddress& address) const = 0;
+
+  // Called when the connection has been idle for the configured memory
+  // reclaim period. The visitor should release buffers and caches that can be
+  // rebuilt on demand; the connection stays fully functional.
+  virtual void OnIdleMemoryReclaim() = 0;
 };
 
 // Interface which gets callbacks from the QuicConnection at interesting
@@ -504,6 +517,11 @@ class QUIC_EXPORT_PRIVATE QuicConnection
   // Called by the Session when a max pacing rate for the connection is needed.
   virtual void SetMaxPacingRate(QuicBandwidth max_pacing_rate);
 
+  // Called by the Session with the earliest delivery deadline among streams
+  // with data waiting to be sent, so the pacer can skip its delay when
+  // honoring it would miss the deadline. See PacingSender::set_deadline_hint.
+  virtual void SetPacingDeadlineHint(QuicTime deadline);
+
   // Allows the client to adjust network parameters based on external
   // information.
   void AdjustNetworkParameters(
@@ -661,6 +679,9 @@ class QUIC_EXPORT_PRIVATE QuicConnection
   bool OnAckFrameStart(QuicPacketNumber largest_acked,
                        QuicTime::Delta ack_delay_time) override;
   bool OnAckRange(QuicPacketNumber start, QuicPacketNumber end) override;
+  bool OnAckFrameEcnCounts(QuicPacketCount ect_0_count,
+                           QuicPacketCount ect_1_count,
+                           QuicPacketCount ecn_ce_count) override;
   bool OnAckTimestamp(QuicPacketNumber packet_number,
                       QuicTime timestamp) override;
   bool OnAckFrameEnd(QuicPacketNumber start) override;
@@ -719,6 +740,7 @@ class QUIC_EXPORT_PRIVATE QuicConnection
   // QuicIdleNetworkDetector::Delegate
   void OnHandshakeTimeout() override;
   void OnIdleNetworkDetected() override;
+  void OnMemoryReclaimTimeout() override;
 
   // QuicConnectionIdManagerVisitorInterface
   void OnPeerIssuedConnectionIdRetired() override;
@@ -813,6 +835,14 @@ class QUIC_EXPORT_PRIVATE QuicConnection
   void SetNetworkTimeouts(QuicTime::Delta handshake_timeout,
                           QuicTime::Delta idle_timeout);
 
+  // Sets how long the network must be idle before the connection releases
+  // memory that can be rebuilt on demand, e.g. empty stream receive buffers.
+  // Should be well below the idle network timeout. Infinite (the default)
+  // disables idle memory reclaim. Intended for deployments holding large
+  // numbers of mostly-idle connections, where memory rather than CPU limits
+  // connection density.
+  void SetMemoryReclaimTimeout(QuicTime::Delta timeout);
+
   // Called when the ping alarm fires. Causes a ping frame to be sent only
   // if the retransmission alarm is not running.
   void OnPingTimeout();
@@ -849,6 +879,13 @@ class QUIC_EXPORT_PRIVATE QuicConnection
   // to new packets.
   void SetDefaultEncryptionLevel(EncryptionLevel level);
 
+  // Skips ahead so that the next packet sent uses |next_packet_number|, if
+  // that is larger than the next packet number the connection would use
+  // anyway. Used when resuming a connection handed off from another process,
+  // where reusing a packet number already consumed by the previous process
+  // would reuse an AEAD nonce.
+  void AdvanceToPacketNumber(QuicPacketNumber next_packet_number);
+
   // SetDecrypter sets the primary decrypter, replacing any that already exists.
   // If an alternative decrypter is in place then the function QUICHE_DCHECKs.
   // This is intended for cases where one knows that future packets will be
@@ -986,6 +1023,14 @@ class QUIC_EXPORT_PRIVATE QuicConnection
   // Set transmission type of next sending packets.
   void SetTransmissionType(TransmissionType type);
 
+  // Enables caching of the serialized plaintext of sent 1-RTT stream data
+  // packets, so PTO probes can retransmit them by patching the packet number
+  // and re-running AEAD instead of re-serializing frames. |max_templates|
+  // bounds the per-connection memory spent on templates; 0 disables caching.
+  void EnableRetransmissionTemplates(size_t max_templates) {
+    packet_creator_.EnableRetransmissionTemplates(max_templates);
+  }
+
   // Tries to send |message| and returns the message status.
   // If |flush| is false, this will return a MESSAGE_STATUS_BLOCKED
   // when the connection is deemed unwritable.
@@ -1060,6 +1105,11 @@ class QUIC_EXPORT_PRIVATE QuicConnection
   size_t min_received_before_ack_decimation() const;
   void set_min_received_before_ack_decimation(size_t new_value);
 
+  // Sets the maximum delay before an application data ack is sent. Stretched
+  // beyond the default while the server is overloaded to slow the inbound
+  // rate; restored when the overload clears.
+  void set_local_max_ack_delay(QuicTime::Delta local_max_ack_delay);
+
   // If |defer| is true, configures the connection to defer sending packets in
   // response to an ACK to the SendAlarm. If |defer| is false, packets may be
   // sent immediately after receiving an ACK.
@@ -1086,6 +1136,13 @@ class QUIC_EXPORT_PRIVATE QuicConnection
   // packets have been successfully processed.
   bool MaybeProcessCoalescedPackets();
 
+  // Sends a PTO probe by re-encrypting the cached serialized template of the
+  // oldest outstanding retransmittable packet, if one is available. The
+  // original packet stays outstanding; the probe is a byte-identical copy
+  // under a new packet number. Returns false if no template applies, in which
+  // case the caller should fall back to regular probe retransmission.
+  bool MaybeSendProbeFromRetransmissionTemplate();
+
   enum PacketContent : uint8_t {
     NO_FRAMES_RECEIVED,
     // TODO(fkastenholz): Change name when we get rid of padded ping/
@@ -1347,6 +1404,18 @@ class QUIC_EXPORT_PRIVATE QuicConnection
   // list.
   bool HandleWriteBlocked();
 
+  // Leases a kMaxOutgoingPacketSize buffer from |free_packet_buffers_|,
+  // allocating one when the pool is empty. The lease's release function
+  // returns the buffer to the pool, so it must not outlive this connection.
+  QuicPacketBuffer AcquirePooledPacketBuffer();
+  // Returns |buffer| to |free_packet_buffers_|, or frees it if the pool is
+  // full.
+  void ReleasePooledPacketBuffer(const char* buffer);
+
+  // Returns the highest QoS class among the streams whose data |packet|
+  // carries; QOS_CLASS_DEFAULT for packets without stream data.
+  QuicQosClass GetQosClassForPacket(const SerializedPacket& packet) const;
+
   // Whether connection enforces anti-amplification limit.
   bool EnforceAntiAmplificationLimit() const;
 
@@ -1415,9 +1484,18 @@ class QUIC_EXPORT_PRIVATE QuicConnection
   // socket is blocked. From unacked packet map and send algorithm's
   // perspective, buffered packets are treated as sent.
   struct QUIC_EXPORT_PRIVATE BufferedPacket {
+    // Copies |packet|'s encrypted bytes into a new heap buffer.
     BufferedPacket(const SerializedPacket& packet,
                    const QuicSocketAddress& self_address,
                    const QuicSocketAddress& peer_address);
+    // Transfers the buffer lease out of |packet| when |packet| owns its
+    // encrypted buffer (a pooled or heap buffer), avoiding a copy. Falls
+    // back to copying when the buffer is not owned (e.g. a stack buffer).
+    // Must not be used while |packet| holds a writer-leased buffer, since
+    // the writer's next-write slot cannot be held across other writes.
+    BufferedPacket(SerializedPacket* packet,
+                   const QuicSocketAddress& self_address,
+                   const QuicSocketAddress& peer_address);
     BufferedPacket(char* encrypted_buffer,
                    QuicPacketLength encrypted_length,
                    const QuicSocketAddress& self_address,
@@ -1427,8 +1505,13 @@ class QUIC_EXPORT_PRIVATE QuicConnection
 
     ~BufferedPacket();
 
-    // encrypted_buffer is owned by buffered packet.
+    // Owns the encrypted bytes and releases them on destruction.
+    QuicOwnedPacketBuffer packet_buffer;
+    // Views the bytes owned by |packet_buffer|.
     absl::string_view encrypted_buffer;
+    // QoS class the packet was assigned when it was originally written, so
+    // the marking survives until the buffered packet is flushed.
+    QuicQosClass qos_class = QOS_CLASS_DEFAULT;
     // Self and peer addresses when the packet is serialized.
     const QuicSocketAddress self_address;
     const QuicSocketAddress peer_address;
@@ -2185,10 +2268,17 @@ class QUIC_EXPORT_PRIVATE QuicConnection
   // the source connection ID from that packet.
   absl::optional<QuicConnectionId> retry_source_connection_id_;
 
+  // Recycles kMaxOutgoingPacketSize buffers leased out while the writer is
+  // blocked, so that serializing into a buffered packet does not allocate or
+  // copy per packet. Declared before |buffered_packets_| because buffered
+  // packets return their buffers to this pool on destruction.
+  std::vector<std::unique_ptr<char[]>> free_packet_buffers_;
+
   // Used to store content of packets which cannot be sent because of write
-  // blocked. Packets' encrypted buffers are copied and owned by
-  // buffered_packets_. From unacked_packet_map (and congestion control)'s
-  // perspective, those packets are considered sent.
+  // blocked. Packets' encrypted buffers are owned by buffered_packets_,
+  // either by taking over the serialized packet's buffer lease or by copying.
+  // From unacked_packet_map (and congestion control)'s perspective, those
+  // packets are considered sent.
   std::list<BufferedPacket> buffered_packets_;
 
   // Used to coalesce packets of different encryption level into the same UDP
@@ -2207,6 +2297,10 @@ class QUIC_EXPORT_PRIVATE QuicConnection
   const bool default_enable_5rto_blackhole_detection_ =
       GetQuicReloadableFlag(quic_default_enable_5rto_blackhole_detection2);
 
+  // Reloadable flags read on per-packet paths, resolved once at connection
+  // creation. See QuicFlagSnapshot.
+  const QuicFlagSnapshot flag_snapshot_;
+
   // Whether the Legacy Version Encapsulation feature is enabled.
   bool legacy_version_encapsulation_enabled_ = false;
   // Whether we are in the middle of sending a packet using Legacy Version
@@ -0,0 +1,186 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/quic_connection_handoff_state.h"
+
+#include <memory>
+#include <string>
+
+#include "absl/base/macros.h"
+#include "absl/strings/string_view.h"
+#include "quic/core/congestion_control/rtt_stats.h"
+#include "quic/core/crypto/quic_decrypter.h"
+#include "quic/core/crypto/quic_encrypter.h"
+#include "quic/core/quic_socket_address_coder.h"
+#include "quic/core/quic_types.h"
+#include "quic/platform/api/quic_logging.h"
+
+namespace quic {
+
+namespace {
+
+bool WriteSocketAddress(const QuicSocketAddress& address,
+                        QuicDataWriter* writer) {
+  QuicSocketAddressCoder coder(address);
+  return writer->WriteStringPieceVarInt62(coder.Encode());
+}
+
+bool ReadSocketAddress(QuicDataReader* reader, QuicSocketAddress* address) {
+  absl::string_view encoded;
+  if (!reader->ReadStringPieceVarInt62(&encoded)) {
+    return false;
+  }
+  QuicSocketAddressCoder coder;
+  if (!coder.Decode(encoded.data(), encoded.length())) {
+    return false;
+  }
+  *address = QuicSocketAddress(coder.ip(), coder.port());
+  return true;
+}
+
+bool ReadString(QuicDataReader* reader, std::string* out) {
+  absl::string_view piece;
+  if (!reader->ReadStringPieceVarInt62(&piece)) {
+    return false;
+  }
+  *out = std::string(piece);
+  return true;
+}
+
+}  // namespace
+
+bool QuicConnectionHandoffState::Serialize(QuicDataWriter* writer) const {
+  const uint64_t counters[] = {next_packet_number, smoothed_rtt_us,
+                               min_rtt_us};
+  return writer->WriteUInt32(version_label) &&
+         writer->WriteUInt32(cipher_suite) &&
+         writer->WriteLengthPrefixedConnectionId(server_connection_id) &&
+         writer->WriteLengthPrefixedConnectionId(client_connection_id) &&
+         WriteSocketAddress(self_address, writer) &&
+         WriteSocketAddress(peer_address, writer) &&
+         writer->WriteStringPieceVarInt62(encryption_key) &&
+         writer->WriteStringPieceVarInt62(encryption_iv) &&
+         writer->WriteStringPieceVarInt62(encryption_header_protection_key) &&
+         writer->WriteStringPieceVarInt62(decryption_key) &&
+         writer->WriteStringPieceVarInt62(decryption_iv) &&
+         writer->WriteStringPieceVarInt62(decryption_header_protection_key) &&
+         writer->WriteVarInt62Batch(counters, ABSL_ARRAYSIZE(counters)) ==
+             ABSL_ARRAYSIZE(counters);
+}
+
+bool QuicConnectionHandoffState::Deserialize(QuicDataReader* reader) {
+  uint64_t counters[3];
+  if (!reader->ReadUInt32(&version_label) ||
+      !reader->ReadUInt32(&cipher_suite) ||
+      !reader->ReadLengthPrefixedConnectionId(&server_connection_id) ||
+      !reader->ReadLengthPrefixedConnectionId(&client_connection_id) ||
+      !ReadSocketAddress(reader, &self_address) ||
+      !ReadSocketAddress(reader, &peer_address) ||
+      !ReadString(reader, &encryption_key) ||
+      !ReadString(reader, &encryption_iv) ||
+      !ReadString(reader, &encryption_header_protection_key) ||
+      !ReadString(reader, &decryption_key) ||
+      !ReadString(reader, &decryption_iv) ||
+      !ReadString(reader, &decryption_header_protection_key) ||
+      reader->ReadVarInt62Batch(counters, ABSL_ARRAYSIZE(counters)) !=
+          ABSL_ARRAYSIZE(counters)) {
+    return false;
+  }
+  next_packet_number = counters[0];
+  smoothed_rtt_us = counters[1];
+  min_rtt_us = counters[2];
+  return true;
+}
+
+bool CaptureConnectionHandoffState(const QuicConnection& connection,
+                                   QuicConnectionHandoffState* state) {
+  if (!connection.version().KnowsWhichDecrypterToUse()) {
+    // Handoff is only supported for IETF QUIC, where the 1-RTT crypters can
+    // be located by encryption level.
+    return false;
+  }
+  const QuicFramer& framer = connection.framer();
+  if (!framer.HasEncrypterOfEncryptionLevel(ENCRYPTION_FORWARD_SECURE) ||
+      !framer.HasDecrypterOfEncryptionLevel(ENCRYPTION_FORWARD_SECURE)) {
+    // Without 1-RTT keys a handoff would not save the handshake; let the
+    // receiving process treat the packets as a new connection.
+    return false;
+  }
+  const QuicEncrypter* encrypter =
+      framer.GetEncrypter(ENCRYPTION_FORWARD_SECURE);
+  const QuicDecrypter* decrypter =
+      framer.GetDecrypter(ENCRYPTION_FORWARD_SECURE);
+
+  state->version_label = CreateQuicVersionLabel(connection.version());
+  state->cipher_suite = decrypter->cipher_id();
+  state->server_connection_id = connection.connection_id();
+  state->client_connection_id = connection.client_connection_id();
+  state->self_address = connection.self_address();
+  state->peer_address = connection.peer_address();
+  state->encryption_key = std::string(encrypter->GetKey());
+  state->encryption_iv = std::string(encrypter->GetIV());
+  state->encryption_header_protection_key.clear();
+  state->decryption_key = std::string(decrypter->GetKey());
+  state->decryption_iv = std::string(decrypter->GetIV());
+  state->decryption_header_protection_key.clear();
+
+  const QuicSentPacketManager& manager = connection.sent_packet_manager();
+  const QuicPacketNumber largest_sent = manager.GetLargestSentPacket();
+  state->next_packet_number =
+      largest_sent.IsInitialized()
+          ? largest_sent.ToUint64() + 1
+          : framer.first_sending_packet_number().ToUint64();
+  const RttStats* rtt_stats = manager.GetRttStats();
+  state->smoothed_rtt_us = rtt_stats->smoothed_rtt().ToMicroseconds();
+  state->min_rtt_us = rtt_stats->min_rtt().ToMicroseconds();
+  return true;
+}
+
+bool ApplyConnectionHandoffState(const QuicConnectionHandoffState& state,
+                                 QuicConnection* connection) {
+  if (CreateQuicVersionLabel(connection->version()) != state.version_label) {
+    QUIC_DLOG(ERROR) << "Handoff state version "
+                     << QuicVersionLabelToString(state.version_label)
+                     << " does not match connection version "
+                     << ParsedQuicVersionToString(connection->version());
+    return false;
+  }
+  std::unique_ptr<QuicEncrypter> encrypter =
+      QuicEncrypter::CreateFromCipherSuite(state.cipher_suite);
+  std::unique_ptr<QuicDecrypter> decrypter =
+      QuicDecrypter::CreateFromCipherSuite(state.cipher_suite);
+  if (encrypter == nullptr || decrypter == nullptr) {
+    return false;
+  }
+  if (!encrypter->SetKey(state.encryption_key) ||
+      !encrypter->SetIV(state.encryption_iv) ||
+      !decrypter->SetKey(state.decryption_key) ||
+      !decrypter->SetIV(state.decryption_iv)) {
+    return false;
+  }
+  if (!state.encryption_header_protection_key.empty() &&
+      !encrypter->SetHeaderProtectionKey(
+          state.encryption_header_protection_key)) {
+    return false;
+  }
+  if (!state.decryption_header_protection_key.empty() &&
+      !decrypter->SetHeaderProtectionKey(
+          state.decryption_header_protection_key)) {
+    return false;
+  }
+
+  connection->SetEncrypter(ENCRYPTION_FORWARD_SECURE, std::move(encrypter));
+  connection->InstallDecrypter(ENCRYPTION_FORWARD_SECURE,
+                               std::move(decrypter));
+  connection->SetDefaultEncryptionLevel(ENCRYPTION_FORWARD_SECURE);
+
+  if (state.smoothed_rtt_us > 0) {
+    connection->sent_packet_manager().SetInitialRtt(
+        QuicTime::Delta::FromMicroseconds(state.smoothed_rtt_us));
+  }
+  connection->AdvanceToPacketNumber(QuicPacketNumber(state.next_packet_number));
+  return true;
+}
+
+}  // namespace quic
@@ -0,0 +1,94 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_QUIC_CONNECTION_HANDOFF_STATE_H_
+#define QUICHE_QUIC_CORE_QUIC_CONNECTION_HANDOFF_STATE_H_
+
+#include <cstdint>
+#include <string>
+
+#include "quic/core/quic_connection.h"
+#include "quic/core/quic_connection_id.h"
+#include "quic/core/quic_data_reader.h"
+#include "quic/core/quic_data_writer.h"
+#include "quic/core/quic_versions.h"
+#include "quic/platform/api/quic_export.h"
+#include "quic/platform/api/quic_socket_address.h"
+
+namespace quic {
+
+// A compact snapshot of an established connection, for transferring the
+// connection between dispatcher processes when a migrated client's packets
+// start arriving at a process that has no state for them (e.g. under
+// SO_REUSEPORT, where the kernel routes by 4-tuple). The snapshot carries
+// the 1-RTT packet protection keys, the connection IDs and addresses, and
+// enough send state for the receiving process to continue the connection
+// without redoing the handshake. It deliberately does not carry per-stream
+// or in-flight packet state: anything unacknowledged at handoff time is
+// recovered through normal loss detection on the new process.
+struct QUIC_EXPORT_PRIVATE QuicConnectionHandoffState {
+  // Serializes this state into |writer|. Returns false if the writer runs
+  // out of space.
+  bool Serialize(QuicDataWriter* writer) const;
+
+  // Parses a serialized state from |reader|. Returns false if the input is
+  // malformed, in which case this state is left in an unspecified mess and
+  // must not be applied.
+  bool Deserialize(QuicDataReader* reader);
+
+  // Version the connection settled on, as a wire label so the snapshot does
+  // not depend on both processes running identical binaries.
+  QuicVersionLabel version_label = 0;
+
+  // TLS cipher suite of the 1-RTT keys; used to reconstruct the crypters
+  // via QuicEncrypter/QuicDecrypter::CreateFromCipherSuite.
+  uint32_t cipher_suite = 0;
+
+  QuicConnectionId server_connection_id;
+  QuicConnectionId client_connection_id;
+
+  QuicSocketAddress self_address;
+  QuicSocketAddress peer_address;
+
+  // 1-RTT packet protection key material, as exported by the crypters. The
+  // header protection keys cannot be exported from established crypters
+  // (the AES variants only keep the expanded key schedule), so they are
+  // left empty by CaptureConnectionHandoffState and are only applied when
+  // the embedder fills them in from the handshake secrets.
+  std::string encryption_key;
+  std::string encryption_iv;
+  std::string encryption_header_protection_key;
+  std::string decryption_key;
+  std::string decryption_iv;
+  std::string decryption_header_protection_key;
+
+  // Packet number the receiving process must start sending at; reusing a
+  // number already consumed by the old process would reuse an AEAD nonce.
+  uint64_t next_packet_number = 0;
+
+  // Seed for the new process's RTT estimator, in microseconds.
+  uint64_t smoothed_rtt_us = 0;
+  uint64_t min_rtt_us = 0;
+};
+
+// Fills |state| from |connection|. Returns false if the connection has not
+// established 1-RTT keys yet, in which case handoff would not save the
+// handshake anyway and the packets should be handled as a new connection.
+QUIC_EXPORT_PRIVATE bool CaptureConnectionHandoffState(
+    const QuicConnection& connection,
+    QuicConnectionHandoffState* state);
+
+// Installs |state| on |connection|, which must be freshly constructed with
+// the connection IDs and addresses from the snapshot. Installs the 1-RTT
+// crypters, moves the connection to forward secure, seeds the RTT estimator
+// and advances the packet number past what the old process used. Returns
+// false if the versions do not match or the crypters cannot be
+// reconstructed.
+QUIC_EXPORT_PRIVATE bool ApplyConnectionHandoffState(
+    const QuicConnectionHandoffState& state,
+    QuicConnection* connection);
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_QUIC_CONNECTION_HANDOFF_STATE_H_
@@ -0,0 +1,175 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/quic_connection_handoff_state.h"
+
+#include <memory>
+#include <string>
+
+#include "third_party/boringssl/src/include/openssl/tls1.h"
+#include "quic/core/crypto/aes_128_gcm_decrypter.h"
+#include "quic/core/crypto/aes_128_gcm_encrypter.h"
+#include "quic/core/quic_connection_id.h"
+#include "quic/core/quic_data_reader.h"
+#include "quic/core/quic_data_writer.h"
+#include "quic/platform/api/quic_test.h"
+#include "quic/test_tools/quic_test_utils.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+class QuicConnectionHandoffStateTest : public QuicTest {
+ protected:
+  QuicConnectionHandoffStateTest()
+      : version_(ParsedQuicVersion::RFCv1()),
+        encryption_key_(16, 'e'),
+        encryption_iv_(12, 'E'),
+        decryption_key_(16, 'd'),
+        decryption_iv_(12, 'D'),
+        connection_(&helper_,
+                    &alarm_factory_,
+                    Perspective::IS_SERVER,
+                    ParsedQuicVersionVector{version_}) {}
+
+  void InstallOneRttKeys(MockQuicConnection* connection) {
+    auto encrypter = std::make_unique<Aes128GcmEncrypter>();
+    ASSERT_TRUE(encrypter->SetKey(encryption_key_));
+    ASSERT_TRUE(encrypter->SetIV(encryption_iv_));
+    connection->SetEncrypter(ENCRYPTION_FORWARD_SECURE, std::move(encrypter));
+    auto decrypter = std::make_unique<Aes128GcmDecrypter>();
+    ASSERT_TRUE(decrypter->SetKey(decryption_key_));
+    ASSERT_TRUE(decrypter->SetIV(decryption_iv_));
+    connection->InstallDecrypter(ENCRYPTION_FORWARD_SECURE,
+                                 std::move(decrypter));
+  }
+
+  QuicConnectionHandoffState MakeState() {
+    QuicConnectionHandoffState state;
+    state.version_label = CreateQuicVersionLabel(version_);
+    state.cipher_suite = TLS1_CK_AES_128_GCM_SHA256;
+    state.server_connection_id = TestConnectionId(42);
+    state.client_connection_id = TestConnectionId(24);
+    state.self_address = QuicSocketAddress(QuicIpAddress::Loopback4(), 443);
+    state.peer_address = QuicSocketAddress(QuicIpAddress::Loopback6(), 4433);
+    state.encryption_key = encryption_key_;
+    state.encryption_iv = encryption_iv_;
+    state.decryption_key = decryption_key_;
+    state.decryption_iv = decryption_iv_;
+    state.next_packet_number = 1234;
+    state.smoothed_rtt_us = 30000;
+    state.min_rtt_us = 25000;
+    return state;
+  }
+
+  const ParsedQuicVersion version_;
+  const std::string encryption_key_;
+  const std::string encryption_iv_;
+  const std::string decryption_key_;
+  const std::string decryption_iv_;
+  MockQuicConnectionHelper helper_;
+  MockAlarmFactory alarm_factory_;
+  MockQuicConnection connection_;
+};
+
+TEST_F(QuicConnectionHandoffStateTest, SerializeRoundTrip) {
+  QuicConnectionHandoffState state = MakeState();
+
+  char buffer[512];
+  QuicDataWriter writer(sizeof(buffer), buffer);
+  ASSERT_TRUE(state.Serialize(&writer));
+
+  QuicConnectionHandoffState parsed;
+  QuicDataReader reader(buffer, writer.length());
+  ASSERT_TRUE(parsed.Deserialize(&reader));
+  EXPECT_EQ(0u, reader.BytesRemaining());
+
+  EXPECT_EQ(state.version_label, parsed.version_label);
+  EXPECT_EQ(state.cipher_suite, parsed.cipher_suite);
+  EXPECT_EQ(state.server_connection_id, parsed.server_connection_id);
+  EXPECT_EQ(state.client_connection_id, parsed.client_connection_id);
+  EXPECT_EQ(state.self_address, parsed.self_address);
+  EXPECT_EQ(state.peer_address, parsed.peer_address);
+  EXPECT_EQ(state.encryption_key, parsed.encryption_key);
+  EXPECT_EQ(state.encryption_iv, parsed.encryption_iv);
+  EXPECT_EQ(state.decryption_key, parsed.decryption_key);
+  EXPECT_EQ(state.decryption_iv, parsed.decryption_iv);
+  EXPECT_EQ(state.next_packet_number, parsed.next_packet_number);
+  EXPECT_EQ(state.smoothed_rtt_us, parsed.smoothed_rtt_us);
+  EXPECT_EQ(state.min_rtt_us, parsed.min_rtt_us);
+}
+
+TEST_F(QuicConnectionHandoffStateTest, DeserializeRejectsTruncatedInput) {
+  QuicConnectionHandoffState state = MakeState();
+
+  char buffer[512];
+  QuicDataWriter writer(sizeof(buffer), buffer);
+  ASSERT_TRUE(state.Serialize(&writer));
+
+  for (size_t length = 0; length < writer.length(); ++length) {
+    QuicConnectionHandoffState parsed;
+    QuicDataReader reader(buffer, length);
+    EXPECT_FALSE(parsed.Deserialize(&reader))
+        << " deserialize of " << length << " byte prefix succeeded";
+  }
+}
+
+TEST_F(QuicConnectionHandoffStateTest, CaptureRequiresOneRttKeys) {
+  QuicConnectionHandoffState state;
+  EXPECT_FALSE(CaptureConnectionHandoffState(connection_, &state));
+}
+
+TEST_F(QuicConnectionHandoffStateTest, CaptureApplyRoundTrip) {
+  InstallOneRttKeys(&connection_);
+
+  QuicConnectionHandoffState state;
+  ASSERT_TRUE(CaptureConnectionHandoffState(connection_, &state));
+  EXPECT_EQ(CreateQuicVersionLabel(version_), state.version_label);
+  EXPECT_EQ(static_cast<uint32_t>(TLS1_CK_AES_128_GCM_SHA256),
+            state.cipher_suite);
+  EXPECT_EQ(connection_.connection_id(), state.server_connection_id);
+  EXPECT_EQ(encryption_key_, state.encryption_key);
+  EXPECT_EQ(encryption_iv_, state.encryption_iv);
+  EXPECT_EQ(decryption_key_, state.decryption_key);
+  EXPECT_EQ(decryption_iv_, state.decryption_iv);
+
+  MockQuicConnection target(&helper_, &alarm_factory_, Perspective::IS_SERVER,
+                            ParsedQuicVersionVector{version_});
+  ASSERT_TRUE(ApplyConnectionHandoffState(state, &target));
+  EXPECT_EQ(ENCRYPTION_FORWARD_SECURE, target.encryption_level());
+  const QuicEncrypter* encrypter =
+      target.framer().GetEncrypter(ENCRYPTION_FORWARD_SECURE);
+  ASSERT_NE(nullptr, encrypter);
+  EXPECT_EQ(encryption_key_, encrypter->GetKey());
+  EXPECT_EQ(encryption_iv_, encrypter->GetIV());
+  const QuicDecrypter* decrypter =
+      target.framer().GetDecrypter(ENCRYPTION_FORWARD_SECURE);
+  ASSERT_NE(nullptr, decrypter);
+  EXPECT_EQ(decryption_key_, decrypter->GetKey());
+  EXPECT_EQ(decryption_iv_, decrypter->GetIV());
+}
+
+TEST_F(QuicConnectionHandoffStateTest, ApplyRejectsVersionMismatch) {
+  QuicConnectionHandoffState state = MakeState();
+  state.version_label = CreateQuicVersionLabel(ParsedQuicVersion::Draft29());
+
+  EXPECT_FALSE(ApplyConnectionHandoffState(state, &connection_));
+}
+
+TEST_F(QuicConnectionHandoffStateTest, ApplyAdvancesPacketNumber) {
+  InstallOneRttKeys(&connection_);
+  QuicConnectionHandoffState state;
+  ASSERT_TRUE(CaptureConnectionHandoffState(connection_, &state));
+  state.next_packet_number = 1234;
+
+  MockQuicConnection target(&helper_, &alarm_factory_, Perspective::IS_SERVER,
+                            ParsedQuicVersionVector{version_});
+  ASSERT_TRUE(ApplyConnectionHandoffState(state, &target));
+  EXPECT_EQ(QuicPacketNumber(1234),
+            target.packet_creator().NextSendingPacketNumber());
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
@@ -20,6 +20,12 @@
 #include "quic/platform/api/quic_logging.h"
 #include "common/quiche_endian.h"
 
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#elif defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+
 namespace quic {
 
 namespace {
@@ -54,21 +60,28 @@ QuicConnectionId::QuicConnectionId() : QuicConnectionId(nullptr, 0) {
   static_assert(offsetof(QuicConnectionId, padding_) ==
                     offsetof(QuicConnectionId, length_),
                 "bad offset");
-  static_assert(sizeof(QuicConnectionId) <= 16, "bad size");
+  static_assert(sizeof(data_short_) >=
+                    kQuicMaxConnectionIdWithLengthPrefixLength,
+                "bad inline length");
+  static_assert(sizeof(QuicConnectionId) <= 32, "bad size");
 }
 
 QuicConnectionId::QuicConnectionId(const char* data, uint8_t length) {
   length_ = length;
+  hash_ = 0;
   if (length_ == 0) {
     return;
   }
   if (length_ <= sizeof(data_short_)) {
     memcpy(data_short_, data, length_);
-    return;
+  } else {
+    data_long_ = reinterpret_cast<char*>(malloc(length_));
+    QUICHE_CHECK_NE(nullptr, data_long_);
+    memcpy(data_long_, data, length_);
   }
-  data_long_ = reinterpret_cast<char*>(malloc(length_));
-  QUICHE_CHECK_NE(nullptr, data_long_);
-  memcpy(data_long_, data, length_);
+  // Compute the hash eagerly: connection IDs are hashed on every dispatcher
+  // lookup, and the cached value travels with copies of the ID.
+  hash_ = ComputeHash();
 }
 
 QuicConnectionId::~QuicConnectionId() {
@@ -78,12 +91,24 @@ QuicConnectionId::~QuicConnectionId() {
   }
 }
 
-QuicConnectionId::QuicConnectionId(const QuicConnectionId& other)
-    : QuicConnectionId(other.data(), other.length()) {}
+QuicConnectionId::QuicConnectionId(const QuicConnectionId& other) {
+  length_ = other.length_;
+  if (length_ > 0) {
+    if (length_ <= sizeof(data_short_)) {
+      memcpy(data_short_, other.data_short_, length_);
+    } else {
+      data_long_ = reinterpret_cast<char*>(malloc(length_));
+      QUICHE_CHECK_NE(nullptr, data_long_);
+      memcpy(data_long_, other.data_long_, length_);
+    }
+  }
+  hash_ = other.hash_;
+}
 
 QuicConnectionId& QuicConnectionId::operator=(const QuicConnectionId& other) {
   set_length(other.length());
   memcpy(mutable_data(), other.data(), length_);
+  hash_ = other.hash_;
   return *this;
 }
 
@@ -95,6 +120,7 @@ const char* QuicConnectionId::data() const {
 }
 
 char* QuicConnectionId::mutable_data() {
+  hash_ = 0;
   if (length_ <= sizeof(data_short_)) {
     return data_short_;
   }
@@ -129,6 +155,7 @@ void QuicConnectionId::set_length(uint8_t length) {
     memcpy(data_short_, temporary_data, length);
   }
   length_ = length;
+  hash_ = 0;
 }
 
 bool QuicConnectionId::IsEmpty() const {
@@ -136,6 +163,13 @@ bool QuicConnectionId::IsEmpty() const {
 }
 
 size_t QuicConnectionId::Hash() const {
+  if (hash_ == 0) {
+    hash_ = ComputeHash();
+  }
+  return hash_;
+}
+
+size_t QuicConnectionId::ComputeHash() const {
   static const QuicConnectionIdHasher hasher = QuicConnectionIdHasher();
   return hasher.Hash(data(), length_);
 }
@@ -153,7 +187,16 @@ std::ostream& operator<<(std::ostream& os, const QuicConnectionId& v) {
 }
 
 bool QuicConnectionId::operator==(const QuicConnectionId& v) const {
-  return length_ == v.length_ && memcmp(data(), v.data(), length_) == 0;
+  if (length_ != v.length_) {
+    return false;
+  }
+  // Two equal connection IDs always have equal hashes, so when both sides
+  // have a cached hash, a mismatch proves inequality without touching the
+  // bytes.
+  if (hash_ != 0 && v.hash_ != 0 && hash_ != v.hash_) {
+    return false;
+  }
+  return memcmp(data(), v.data(), length_) == 0;
 }
 
 bool QuicConnectionId::operator!=(const QuicConnectionId& v) const {
@@ -174,6 +217,65 @@ QuicConnectionId EmptyQuicConnectionId() {
   return QuicConnectionId();
 }
 
+namespace {
+
+#if defined(__SSE4_2__) || defined(__ARM_FEATURE_CRC32)
+
+inline uint64_t Crc32Word(uint64_t crc, uint64_t word) {
+#if defined(__SSE4_2__)
+  return _mm_crc32_u64(crc, word);
+#else
+  return __crc32cd(static_cast<uint32_t>(crc), word);
+#endif
+}
+
+#endif
+
+}  // namespace
+
+QuicConnectionIdFastHasher::QuicConnectionIdFastHasher() {
+  QuicRandom::GetInstance()->RandBytes(key_, sizeof(key_));
+}
+
+// static
+bool QuicConnectionIdFastHasher::IsHardwareAccelerated() {
+#if defined(__SSE4_2__) || defined(__ARM_FEATURE_CRC32)
+  return true;
+#else
+  return false;
+#endif
+}
+
+size_t QuicConnectionIdFastHasher::Hash(
+    const QuicConnectionId& connection_id) const {
+#if defined(__SSE4_2__) || defined(__ARM_FEATURE_CRC32)
+  const char* data = connection_id.data();
+  size_t remaining = connection_id.length();
+  // Fold the length into the seed so that IDs that only differ by trailing
+  // zero bytes do not collide.
+  uint64_t crc = key_[0] ^ remaining;
+  while (remaining >= sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, data, sizeof(word));
+    crc = Crc32Word(crc, word);
+    data += sizeof(word);
+    remaining -= sizeof(word);
+  }
+  if (remaining > 0) {
+    uint64_t word = 0;
+    memcpy(&word, data, remaining);
+    crc = Crc32Word(crc, word);
+  }
+  // CRC32 only produces 32 bits of state; mix the second key in with a
+  // multiply to spread the entropy across the full size_t.
+  uint64_t hash = (crc ^ key_[1]) * uint64_t{0xbf58476d1ce4e5b9};
+  hash ^= hash >> 32;
+  return static_cast<size_t>(hash);
+#else
+  return connection_id.Hash();
+#endif
+}
+
 static_assert(kQuicDefaultConnectionIdLength == sizeof(uint64_t),
               "kQuicDefaultConnectionIdLength changed");
 static_assert(kQuicDefaultConnectionIdLength == PACKET_8BYTE_CONNECTION_ID,
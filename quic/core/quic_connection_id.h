@@ -69,7 +69,8 @@ class QUIC_EXPORT_PRIVATE QuicConnectionId {
   const char* data() const;
 
   // Returns a mutable pointer to the connection ID bytes,
-  // in network byte order.
+  // in network byte order. Invalidates the cached hash; callers must be done
+  // mutating the bytes before Hash() is called again.
   char* mutable_data();
 
   // Returns whether the connection ID has length zero.
@@ -81,6 +82,9 @@ class QUIC_EXPORT_PRIVATE QuicConnectionId {
   // that this property is not guaranteed across process lifetimes. This makes
   // Hash() suitable for data structures such as hash tables but not for sending
   // a hash over the network.
+  // The hash is computed once and cached, so repeated lookups (e.g. a
+  // dispatcher hashing the connection ID of every incoming packet) do not
+  // rehash the bytes.
   size_t Hash() const;
 
   // Generates an ASCII string that represents
@@ -98,24 +102,31 @@ class QUIC_EXPORT_PRIVATE QuicConnectionId {
   bool operator<(const QuicConnectionId& v) const;
 
  private:
+  // Computes the hash of the connection ID bytes.
+  size_t ComputeHash() const;
+
   // The connection ID is represented in network byte order.
   union {
     // If the connection ID fits in |data_short_|, it is stored in the
     // first |length_| bytes of |data_short_|.
     // Otherwise it is stored in |data_long_| which is guaranteed to have a size
     // equal to |length_|.
-    // A value of 11 was chosen because our commonly used connection ID length
-    // is 8 and with the length, the class is padded to at least 12 bytes
-    // anyway.
+    // A value of 20 covers every length allowed by the IETF invariants for
+    // supported versions, so the heap-allocated representation is only used
+    // when parsing packets of unknown versions with longer connection IDs.
     struct {
       uint8_t padding_;  // Match length_ field of the other union member.
-      char data_short_[11];
+      char data_short_[20];
     };
     struct {
       uint8_t length_;  // length of the connection ID, in bytes.
       char* data_long_;
     };
   };
+  // Cached output of Hash(). Zero when the hash has not been computed yet; a
+  // computed hash of zero is simply recomputed on the next call. Invalidated
+  // by set_length() and mutable_data().
+  mutable size_t hash_;
 };
 
 // Creates a connection ID of length zero, unless the restart flag
@@ -136,6 +147,29 @@ class QUIC_EXPORT_PRIVATE QuicConnectionIdHash {
   }
 };
 
+// A keyed hash over connection ID bytes built on the hardware CRC32
+// instructions where available. Several times cheaper than
+// QuicConnectionId::Hash() (SipHash), but with weaker collision resistance:
+// an attacker who recovers the key offline can craft colliding connection
+// IDs. Callers must therefore pair it with collision monitoring on the hash
+// table it feeds, and fall back to QuicConnectionId::Hash() when the bucket
+// distribution degrades; see QuicDispatcher's session map. On builds without
+// the instructions, Hash() forwards to QuicConnectionId::Hash().
+class QUIC_EXPORT_PRIVATE QuicConnectionIdFastHasher {
+ public:
+  // Generates a fresh random key.
+  QuicConnectionIdFastHasher();
+
+  // Returns true when this build hashes with the hardware instructions, and
+  // false when Hash() forwards to the SipHash-based QuicConnectionId::Hash().
+  static bool IsHardwareAccelerated();
+
+  size_t Hash(const QuicConnectionId& connection_id) const;
+
+ private:
+  uint64_t key_[2];
+};
+
 }  // namespace quic
 
 #endif  // QUICHE_QUIC_CORE_QUIC_CONNECTION_ID_H_
@@ -102,6 +102,56 @@ TEST_F(QuicConnectionIdTest, Hash) {
   }
 }
 
+TEST_F(QuicConnectionIdTest, HashTracksMutations) {
+  QuicConnectionId connection_id = test::TestConnectionId(1);
+  const size_t hash = connection_id.Hash();
+  EXPECT_EQ(hash, connection_id.Hash());
+
+  // The cached hash travels with copies.
+  QuicConnectionId copied = connection_id;
+  EXPECT_EQ(hash, copied.Hash());
+
+  // Mutating the bytes invalidates the cached hash.
+  copied.mutable_data()[0] = 0x33;
+  QuicConnectionId mutated(copied.data(), copied.length());
+  EXPECT_EQ(mutated.Hash(), copied.Hash());
+  EXPECT_NE(hash, copied.Hash());
+
+  // So does changing the length.
+  copied.set_length(4);
+  QuicConnectionId truncated(mutated.data(), 4);
+  EXPECT_EQ(truncated.Hash(), copied.Hash());
+}
+
+TEST_F(QuicConnectionIdTest, FastHasher) {
+  QuicConnectionIdFastHasher hasher;
+  QuicConnectionId connection_id64_1 = test::TestConnectionId(1);
+  QuicConnectionId connection_id64_1b = test::TestConnectionId(1);
+  QuicConnectionId connection_id64_2 = test::TestConnectionId(42);
+  EXPECT_EQ(hasher.Hash(connection_id64_1), hasher.Hash(connection_id64_1b));
+  EXPECT_NE(hasher.Hash(connection_id64_1), hasher.Hash(connection_id64_2));
+
+  // All-zero connection IDs of different lengths must not collide, and
+  // lengths beyond a single word exercise the multi-word loop.
+  const char connection_id_bytes[20] = {};
+  for (uint8_t i = 0; i < sizeof(connection_id_bytes) - 1; ++i) {
+    QuicConnectionId connection_id_i(connection_id_bytes, i);
+    for (uint8_t j = i + 1; j < sizeof(connection_id_bytes); ++j) {
+      QuicConnectionId connection_id_j(connection_id_bytes, j);
+      EXPECT_NE(hasher.Hash(connection_id_i), hasher.Hash(connection_id_j));
+    }
+  }
+
+  if (!QuicConnectionIdFastHasher::IsHardwareAccelerated()) {
+    // Without hardware support the hasher forwards to SipHash, so two
+    // hashers agree despite having different keys.
+    QuicConnectionIdFastHasher other_hasher;
+    EXPECT_EQ(hasher.Hash(connection_id64_1),
+              other_hasher.Hash(connection_id64_1));
+    EXPECT_EQ(hasher.Hash(connection_id64_1), connection_id64_1.Hash());
+  }
+}
+
 TEST_F(QuicConnectionIdTest, AssignAndCopy) {
   QuicConnectionId connection_id = test::TestConnectionId(1);
   QuicConnectionId connection_id2 = test::TestConnectionId(2);
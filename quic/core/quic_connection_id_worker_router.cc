@@ -0,0 +1,63 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/quic_connection_id_worker_router.h"
+
+#include "quic/core/quic_constants.h"
+#include "quic/core/quic_utils.h"
+#include "quic/platform/api/quic_logging.h"
+
+namespace quic {
+
+QuicConnectionIdWorkerRouter::QuicConnectionIdWorkerRouter(uint8_t worker_index,
+                                                           uint8_t num_workers)
+    : worker_index_(worker_index), num_workers_(num_workers) {
+  QUICHE_DCHECK_GT(num_workers, 0u);
+  QUICHE_DCHECK_LT(worker_index, num_workers);
+}
+
+QuicConnectionId
+QuicConnectionIdWorkerRouter::CreateRoutableReplacementConnectionId(
+    const QuicConnectionId& connection_id,
+    uint8_t expected_connection_id_length) const {
+  if (expected_connection_id_length == 0) {
+    return EmptyQuicConnectionId();
+  }
+  QuicConnectionId replacement = QuicUtils::CreateReplacementConnectionId(
+      connection_id, expected_connection_id_length);
+  replacement.mutable_data()[0] = static_cast<char>(worker_index_);
+  return replacement;
+}
+
+// static
+uint8_t QuicConnectionIdWorkerRouter::GetWorkerIndex(
+    const QuicConnectionId& connection_id, uint8_t num_workers) {
+  QUICHE_DCHECK_GT(num_workers, 0u);
+  if (connection_id.IsEmpty()) {
+    return 0;
+  }
+  return static_cast<uint8_t>(connection_id.data()[0]) % num_workers;
+}
+
+QuicWorkerRoutedSelfIssuedConnectionIdManager::
+    QuicWorkerRoutedSelfIssuedConnectionIdManager(
+        const QuicConnectionIdWorkerRouter* router,
+        size_t active_connection_id_limit,
+        const QuicConnectionId& initial_connection_id, const QuicClock* clock,
+        QuicAlarmFactory* alarm_factory,
+        QuicConnectionIdManagerVisitorInterface* visitor,
+        QuicConnectionContext* context)
+    : QuicSelfIssuedConnectionIdManager(active_connection_id_limit,
+                                        initial_connection_id, clock,
+                                        alarm_factory, visitor, context),
+      router_(router) {}
+
+QuicConnectionId
+QuicWorkerRoutedSelfIssuedConnectionIdManager::GenerateNewConnectionId(
+    const QuicConnectionId& old_connection_id) const {
+  return router_->CreateRoutableReplacementConnectionId(
+      old_connection_id, kQuicDefaultConnectionIdLength);
+}
+
+}  // namespace quic
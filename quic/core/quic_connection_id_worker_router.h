@@ -0,0 +1,74 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_QUIC_CONNECTION_ID_WORKER_ROUTER_H_
+#define QUICHE_QUIC_CORE_QUIC_CONNECTION_ID_WORKER_ROUTER_H_
+
+#include <cstdint>
+
+#include "quic/core/quic_connection_id.h"
+#include "quic/core/quic_connection_id_manager.h"
+#include "quic/platform/api/quic_export.h"
+
+namespace quic {
+
+// Encodes a worker index into the first byte of server-chosen connection IDs
+// so that a kernel SO_REUSEPORT BPF program (see
+// QuicUdpSocketApi::EnableConnectionIdReusePortRouting) can deliver every
+// short header packet to the process that owns the connection, even after
+// the client migrates to a new path and the kernel 4-tuple hash no longer
+// matches. Each of |num_workers| processes constructs a router with its own
+// |worker_index| and installs it on its dispatcher via
+// QuicDispatcher::set_connection_id_worker_router().
+class QUIC_EXPORT_PRIVATE QuicConnectionIdWorkerRouter {
+ public:
+  // |worker_index| must be less than |num_workers|, which must be positive.
+  QuicConnectionIdWorkerRouter(uint8_t worker_index, uint8_t num_workers);
+
+  // Deterministically derives a connection ID of
+  // |expected_connection_id_length| bytes from |connection_id| whose first
+  // byte routes to this worker. Calling this method with two connection IDs
+  // that are equal is guaranteed to produce the same result.
+  QuicConnectionId CreateRoutableReplacementConnectionId(
+      const QuicConnectionId& connection_id,
+      uint8_t expected_connection_id_length) const;
+
+  // Returns the worker a packet carrying |connection_id| is routed to. This
+  // mirrors the computation performed by the kernel BPF program.
+  static uint8_t GetWorkerIndex(const QuicConnectionId& connection_id,
+                                uint8_t num_workers);
+
+  uint8_t worker_index() const { return worker_index_; }
+  uint8_t num_workers() const { return num_workers_; }
+
+ private:
+  const uint8_t worker_index_;
+  const uint8_t num_workers_;
+};
+
+// Self-issued connection ID manager which preserves the worker routing byte
+// in every connection ID issued for path migration, so packets sent to those
+// connection IDs still reach the issuing process.
+class QUIC_EXPORT_PRIVATE QuicWorkerRoutedSelfIssuedConnectionIdManager
+    : public QuicSelfIssuedConnectionIdManager {
+ public:
+  // |router| must outlive this manager.
+  QuicWorkerRoutedSelfIssuedConnectionIdManager(
+      const QuicConnectionIdWorkerRouter* router,
+      size_t active_connection_id_limit,
+      const QuicConnectionId& initial_connection_id, const QuicClock* clock,
+      QuicAlarmFactory* alarm_factory,
+      QuicConnectionIdManagerVisitorInterface* visitor,
+      QuicConnectionContext* context);
+
+  QuicConnectionId GenerateNewConnectionId(
+      const QuicConnectionId& old_connection_id) const override;
+
+ private:
+  const QuicConnectionIdWorkerRouter* router_;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_QUIC_CONNECTION_ID_WORKER_ROUTER_H_
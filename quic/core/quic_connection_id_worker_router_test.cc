@@ -0,0 +1,95 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/quic_connection_id_worker_router.h"
+
+#include "quic/core/quic_connection_id.h"
+#include "quic/core/quic_constants.h"
+#include "quic/platform/api/quic_test.h"
+#include "quic/test_tools/mock_clock.h"
+#include "quic/test_tools/quic_test_utils.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+TEST(QuicConnectionIdWorkerRouterTest, ReplacementRoutesToOwningWorker) {
+  for (uint8_t worker_index = 0; worker_index < 8; ++worker_index) {
+    QuicConnectionIdWorkerRouter router(worker_index, /*num_workers=*/8);
+    QuicConnectionId replacement =
+        router.CreateRoutableReplacementConnectionId(
+            TestConnectionId(0x1122334455667788),
+            kQuicDefaultConnectionIdLength);
+    EXPECT_EQ(kQuicDefaultConnectionIdLength, replacement.length());
+    EXPECT_EQ(worker_index, QuicConnectionIdWorkerRouter::GetWorkerIndex(
+                                replacement, /*num_workers=*/8));
+  }
+}
+
+TEST(QuicConnectionIdWorkerRouterTest, ReplacementIsDeterministic) {
+  QuicConnectionIdWorkerRouter router(/*worker_index=*/3, /*num_workers=*/4);
+  EXPECT_EQ(router.CreateRoutableReplacementConnectionId(
+                TestConnectionId(1), kQuicDefaultConnectionIdLength),
+            router.CreateRoutableReplacementConnectionId(
+                TestConnectionId(1), kQuicDefaultConnectionIdLength));
+  EXPECT_NE(router.CreateRoutableReplacementConnectionId(
+                TestConnectionId(1), kQuicDefaultConnectionIdLength),
+            router.CreateRoutableReplacementConnectionId(
+                TestConnectionId(2), kQuicDefaultConnectionIdLength));
+}
+
+TEST(QuicConnectionIdWorkerRouterTest, ZeroLengthReplacementIsEmpty) {
+  QuicConnectionIdWorkerRouter router(/*worker_index=*/1, /*num_workers=*/2);
+  EXPECT_EQ(EmptyQuicConnectionId(),
+            router.CreateRoutableReplacementConnectionId(
+                TestConnectionId(1), /*expected_connection_id_length=*/0));
+}
+
+TEST(QuicConnectionIdWorkerRouterTest, GetWorkerIndexAppliesModulo) {
+  const char connection_id_bytes[] = {0x0a, 0x01, 0x02, 0x03,
+                                      0x04, 0x05, 0x06, 0x07};
+  QuicConnectionId connection_id(connection_id_bytes,
+                                 sizeof(connection_id_bytes));
+  EXPECT_EQ(2u, QuicConnectionIdWorkerRouter::GetWorkerIndex(
+                    connection_id, /*num_workers=*/4));
+  EXPECT_EQ(0u, QuicConnectionIdWorkerRouter::GetWorkerIndex(
+                    EmptyQuicConnectionId(), /*num_workers=*/4));
+}
+
+class StubConnectionIdManagerVisitor
+    : public QuicConnectionIdManagerVisitorInterface {
+ public:
+  void OnPeerIssuedConnectionIdRetired() override {}
+  bool SendNewConnectionId(const QuicNewConnectionIdFrame& /*frame*/) override {
+    return true;
+  }
+  void OnNewConnectionIdIssued(
+      const QuicConnectionId& /*connection_id*/) override {}
+  void OnSelfIssuedConnectionIdRetired(
+      const QuicConnectionId& /*connection_id*/) override {}
+};
+
+TEST(QuicConnectionIdWorkerRouterTest, SelfIssuedIdsKeepRoutingByte) {
+  QuicConnectionIdWorkerRouter router(/*worker_index=*/5, /*num_workers=*/8);
+  MockClock clock;
+  MockAlarmFactory alarm_factory;
+  StubConnectionIdManagerVisitor visitor;
+  QuicConnectionId initial_connection_id =
+      router.CreateRoutableReplacementConnectionId(
+          TestConnectionId(1), kQuicDefaultConnectionIdLength);
+  QuicWorkerRoutedSelfIssuedConnectionIdManager manager(
+      &router, /*active_connection_id_limit=*/2, initial_connection_id, &clock,
+      &alarm_factory, &visitor, /*context=*/nullptr);
+
+  QuicConnectionId connection_id = initial_connection_id;
+  for (int i = 0; i < 4; ++i) {
+    connection_id = manager.GenerateNewConnectionId(connection_id);
+    EXPECT_EQ(5u, QuicConnectionIdWorkerRouter::GetWorkerIndex(
+                      connection_id, /*num_workers=*/8));
+  }
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
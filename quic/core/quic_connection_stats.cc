@@ -41,6 +41,7 @@ std::ostream& operator<<(std::ostream& os, const QuicConnectionStats& s) {
   os << " packets_reordered: " << s.packets_reordered;
   os << " max_sequence_reordering: " << s.max_sequence_reordering;
   os << " max_time_reordering_us: " << s.max_time_reordering_us;
+  os << " ecn_ce_marks_received: " << s.ecn_ce_marks_received;
   os << " tcp_loss_events: " << s.tcp_loss_events;
   os << " connection_creation_time: "
      << s.connection_creation_time.ToDebuggingValue();
@@ -64,6 +65,9 @@ std::ostream& operator<<(std::ostream& os, const QuicConnectionStats& s) {
   os << " address_validated_via_decrypting_packet: "
      << s.address_validated_via_decrypting_packet;
   os << " address_validated_via_token: " << s.address_validated_via_token;
+  os << " tls_server_resumption_attempted: "
+     << s.tls_server_resumption_attempted;
+  os << " tls_server_session_resumed: " << s.tls_server_session_resumed;
   os << " }";
 
   return os;
@@ -7,6 +7,7 @@
 
 #include <cstdint>
 #include <ostream>
+#include <string>
 
 #include "quic/core/quic_bandwidth.h"
 #include "quic/core/quic_packets.h"
@@ -93,6 +94,10 @@ struct QUIC_EXPORT_PRIVATE QuicConnectionStats {
   QuicPacketCount undecryptable_packets_received_before_handshake_complete = 0;
 
   size_t crypto_retransmit_count = 0;
+  // Number of times a partially-filled packet holding application frames was
+  // flushed early so that crypto data (e.g. a PTO-triggered handshake
+  // retransmission) could lead a packet of its own.
+  size_t crypto_preempted_partial_packets = 0;
   // Count of times the loss detection alarm fired.  At least one packet should
   // be lost when the alarm fires.
   size_t loss_timeout_count = 0;
@@ -102,6 +107,10 @@ struct QUIC_EXPORT_PRIVATE QuicConnectionStats {
 
   int64_t min_rtt_us = 0;  // Minimum RTT in microseconds.
   int64_t srtt_us = 0;     // Smoothed RTT in microseconds.
+  // Windowed maximum of (latest_rtt - min_rtt) in microseconds, an estimate
+  // of queueing delay at the bottleneck. See RttStats::max_queueing_delay().
+  // Populated by QuicConnection::GetStats().
+  int64_t max_queueing_delay_us = 0;
   int64_t cwnd_bootstrapping_rtt_us = 0;  // RTT used in cwnd_bootstrapping.
   // The connection's |long_term_mtu_| used for sending packets, populated by
   // QuicConnection::GetStats().
@@ -113,6 +122,13 @@ struct QUIC_EXPORT_PRIVATE QuicConnectionStats {
   QuicByteCount ingress_mtu = 0;
   QuicBandwidth estimated_bandwidth = QuicBandwidth::Zero();
 
+  // Histogram of bytes in flight sampled as each congestion controlled packet
+  // is sent: bucket i counts packets sent while bytes in flight was in
+  // [2^i, 2^(i+1)), with the last bucket absorbing anything larger. Populated
+  // by QuicSentPacketManager.
+  static constexpr size_t kNumBytesInFlightBuckets = 25;
+  QuicPacketCount bytes_in_flight_histogram[kNumBytesInFlightBuckets] = {};
+
   // Reordering stats for received packets.
   // Number of packets received out of packet number order.
   QuicPacketCount packets_reordered = 0;
@@ -127,6 +143,11 @@ struct QUIC_EXPORT_PRIVATE QuicConnectionStats {
   // but would have been if the reordering_shift increases by one.
   QuicPacketCount sent_packets_num_borderline_time_reorderings = 0;
 
+  // Number of sent packets the peer has reported as ECN-CE marked, summed
+  // across all ACK_ECN frames. Zero unless the path marks and the peer
+  // reports ECN.
+  QuicPacketCount ecn_ce_marks_received = 0;
+
   // The following stats are used only in TcpCubicSender.
   // The number of loss events from TCP's perspective.  Each loss event includes
   // one or more lost packets.
@@ -219,6 +240,17 @@ struct QUIC_EXPORT_PRIVATE QuicConnectionStats {
   size_t num_new_connection_id_sent = 0;
   // Number of RETIRE_CONNECTION_ID frames sent.
   size_t num_retire_connection_id_sent = 0;
+  // Number of times idle connection memory got reclaimed.
+  size_t num_idle_memory_reclaims = 0;
+  // ID of the loss detection profile applied to this connection, see
+  // LossDetectionProfile. Zero when no profile was applied. Together with the
+  // spurious retransmit counters above, this lets profiles be compared
+  // empirically across the fleet.
+  uint32_t loss_detection_profile_id = 0;
+  // Serialized ring buffer of Bbr2 network model snapshots, see
+  // Bbr2StateSampler. Only populated when BBRv2 is in use and
+  // --quic_bbr2_state_sampling_interval_ms is positive.
+  std::string bbr2_state_samples;
 
   struct QUIC_NO_EXPORT TlsServerOperationStats {
     bool success = false;
@@ -234,6 +266,13 @@ struct QUIC_EXPORT_PRIVATE QuicConnectionStats {
   absl::optional<TlsServerOperationStats> tls_server_select_cert_stats;
   absl::optional<TlsServerOperationStats> tls_server_compute_signature_stats;
   absl::optional<TlsServerOperationStats> tls_server_decrypt_ticket_stats;
+
+  // True if the client presented a session ticket in its TLS ClientHello.
+  // Only set on server connections, once the handshake completes.
+  bool tls_server_resumption_attempted = false;
+  // True if the TLS handshake resumed a previous session from such a ticket.
+  // Only set on server connections, once the handshake completes.
+  bool tls_server_session_resumed = false;
 };
 
 }  // namespace quic
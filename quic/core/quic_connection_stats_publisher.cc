@@ -0,0 +1,99 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/quic_connection_stats_publisher.h"
+
+#include <algorithm>
+
+namespace quic {
+
+QuicConnectionStatsSnapshot::QuicConnectionStatsSnapshot(
+    const QuicConnectionStats& stats)
+    : bytes_sent(stats.bytes_sent),
+      packets_sent(stats.packets_sent),
+      stream_bytes_sent(stats.stream_bytes_sent),
+      bytes_retransmitted(stats.bytes_retransmitted),
+      packets_retransmitted(stats.packets_retransmitted),
+      packets_lost(stats.packets_lost),
+      rto_count(stats.rto_count),
+      pto_count(stats.pto_count),
+      ping_frames_sent(stats.ping_frames_sent),
+      bytes_received(stats.bytes_received),
+      packets_received(stats.packets_received),
+      packets_processed(stats.packets_processed),
+      stream_bytes_received(stats.stream_bytes_received),
+      packets_dropped(stats.packets_dropped),
+      packets_reordered(stats.packets_reordered),
+      min_rtt_us(stats.min_rtt_us),
+      srtt_us(stats.srtt_us),
+      estimated_bandwidth_bps(
+          stats.estimated_bandwidth.IsInfinite()
+              ? 0
+              : stats.estimated_bandwidth.ToBitsPerSecond()) {}
+
+void QuicConnectionStatsSnapshot::Aggregate(
+    const QuicConnectionStatsSnapshot& other) {
+  bytes_sent += other.bytes_sent;
+  packets_sent += other.packets_sent;
+  stream_bytes_sent += other.stream_bytes_sent;
+  bytes_retransmitted += other.bytes_retransmitted;
+  packets_retransmitted += other.packets_retransmitted;
+  packets_lost += other.packets_lost;
+  rto_count += other.rto_count;
+  pto_count += other.pto_count;
+  ping_frames_sent += other.ping_frames_sent;
+  bytes_received += other.bytes_received;
+  packets_received += other.packets_received;
+  packets_processed += other.packets_processed;
+  stream_bytes_received += other.stream_bytes_received;
+  packets_dropped += other.packets_dropped;
+  packets_reordered += other.packets_reordered;
+  if (other.min_rtt_us != 0 &&
+      (min_rtt_us == 0 || other.min_rtt_us < min_rtt_us)) {
+    min_rtt_us = other.min_rtt_us;
+  }
+  srtt_us = std::max(srtt_us, other.srtt_us);
+  estimated_bandwidth_bps =
+      std::max(estimated_bandwidth_bps, other.estimated_bandwidth_bps);
+}
+
+void QuicConnectionStatsPublisher::Publish(const QuicConnectionStats& stats) {
+  const uint64_t sequence = sequence_.load(std::memory_order_relaxed);
+  // An odd sequence marks the snapshot as mid-update; readers retry.
+  sequence_.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  snapshot_ = QuicConnectionStatsSnapshot(stats);
+  sequence_.store(sequence + 2, std::memory_order_release);
+}
+
+QuicConnectionStatsSnapshot QuicConnectionStatsPublisher::Snapshot() const {
+  while (true) {
+    const uint64_t sequence_before =
+        sequence_.load(std::memory_order_acquire);
+    if (sequence_before % 2 != 0) {
+      // A publish is in progress.
+      continue;
+    }
+    const QuicConnectionStatsSnapshot result = snapshot_;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (sequence_.load(std::memory_order_relaxed) == sequence_before) {
+      return result;
+    }
+  }
+}
+
+void QuicConnectionStatsAggregator::AddShard(
+    const QuicConnectionStatsPublisher* publisher) {
+  shards_.push_back(publisher);
+}
+
+QuicConnectionStatsSnapshot QuicConnectionStatsAggregator::Sum() const {
+  QuicConnectionStatsSnapshot total;
+  for (const QuicConnectionStatsPublisher* shard : shards_) {
+    total.Aggregate(shard->Snapshot());
+  }
+  return total;
+}
+
+}  // namespace quic
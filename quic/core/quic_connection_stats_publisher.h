@@ -0,0 +1,108 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_QUIC_CONNECTION_STATS_PUBLISHER_H_
+#define QUICHE_QUIC_CORE_QUIC_CONNECTION_STATS_PUBLISHER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "absl/base/optimization.h"
+#include "quic/core/quic_connection_stats.h"
+#include "quic/platform/api/quic_export.h"
+
+namespace quic {
+
+// The trivially-copyable hot counters of QuicConnectionStats, suitable for
+// lock-free snapshotting and fleet aggregation. Cold fields of the full stats
+// struct (strings, optionals, one-shot handshake data) are excluded; export
+// those through the regular owning-thread path instead.
+struct QUIC_EXPORT_PRIVATE QuicConnectionStatsSnapshot {
+  QuicConnectionStatsSnapshot() = default;
+  explicit QuicConnectionStatsSnapshot(const QuicConnectionStats& stats);
+
+  // Accumulates |other| into this snapshot: additive counters are summed,
+  // |min_rtt_us| takes the minimum of the non-zero values, and |srtt_us| and
+  // |estimated_bandwidth| take the maximum, which keeps them meaningful when
+  // summing across connections or shards.
+  void Aggregate(const QuicConnectionStatsSnapshot& other);
+
+  // Send path.
+  QuicByteCount bytes_sent = 0;
+  QuicPacketCount packets_sent = 0;
+  QuicByteCount stream_bytes_sent = 0;
+  QuicByteCount bytes_retransmitted = 0;
+  QuicPacketCount packets_retransmitted = 0;
+  QuicPacketCount packets_lost = 0;
+  size_t rto_count = 0;
+  size_t pto_count = 0;
+  size_t ping_frames_sent = 0;
+
+  // Receive path.
+  QuicByteCount bytes_received = 0;
+  QuicPacketCount packets_received = 0;
+  QuicPacketCount packets_processed = 0;
+  QuicByteCount stream_bytes_received = 0;
+  QuicPacketCount packets_dropped = 0;
+  QuicPacketCount packets_reordered = 0;
+
+  // Path characteristics.
+  int64_t min_rtt_us = 0;
+  int64_t srtt_us = 0;
+  int64_t estimated_bandwidth_bps = 0;
+};
+
+static_assert(std::is_trivially_copyable<QuicConnectionStatsSnapshot>::value,
+              "QuicConnectionStatsSnapshot must be trivially copyable for the "
+              "seqlock snapshot protocol to be sound.");
+
+// Publishes a connection's hot counters so that a monitoring thread can read
+// them without a mutex and without stalling the connection. The connection's
+// owning thread periodically calls Publish(); readers call Snapshot(), which
+// retries until it observes a version that was not concurrently overwritten
+// (a seqlock). Writers never block and a Publish() costs one struct copy plus
+// two relaxed atomic stores, so the scrape interval no longer shows up in
+// tail latency.
+class QUIC_EXPORT_PRIVATE QuicConnectionStatsPublisher {
+ public:
+  QuicConnectionStatsPublisher() = default;
+  QuicConnectionStatsPublisher(const QuicConnectionStatsPublisher&) = delete;
+  QuicConnectionStatsPublisher& operator=(const QuicConnectionStatsPublisher&) =
+      delete;
+
+  // Called by the connection's owning thread only.
+  void Publish(const QuicConnectionStats& stats);
+
+  // Called from any thread. Retries until a consistent snapshot is read.
+  QuicConnectionStatsSnapshot Snapshot() const;
+
+ private:
+  // The sequence counter and the data live on separate cache lines so that
+  // readers polling the sequence do not bounce the line the writer is
+  // copying into.
+  ABSL_CACHELINE_ALIGNED std::atomic<uint64_t> sequence_{0};
+  ABSL_CACHELINE_ALIGNED QuicConnectionStatsSnapshot snapshot_;
+};
+
+// Sums hot-counter snapshots across dispatcher shards without stopping them.
+// Each shard owns a QuicConnectionStatsPublisher that its dispatcher thread
+// publishes into; the monitoring thread calls Sum(), which seqlock-reads each
+// shard in turn. Registered publishers must outlive the aggregator.
+class QUIC_EXPORT_PRIVATE QuicConnectionStatsAggregator {
+ public:
+  void AddShard(const QuicConnectionStatsPublisher* publisher);
+
+  QuicConnectionStatsSnapshot Sum() const;
+
+  size_t num_shards() const { return shards_.size(); }
+
+ private:
+  std::vector<const QuicConnectionStatsPublisher*> shards_;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_QUIC_CONNECTION_STATS_PUBLISHER_H_
@@ -0,0 +1,85 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/quic_connection_stats_publisher.h"
+
+#include "quic/platform/api/quic_test.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+QuicConnectionStats MakeStats(QuicByteCount bytes_sent, int64_t min_rtt_us,
+                              int64_t srtt_us) {
+  QuicConnectionStats stats;
+  stats.bytes_sent = bytes_sent;
+  stats.packets_sent = bytes_sent / 1000;
+  stats.min_rtt_us = min_rtt_us;
+  stats.srtt_us = srtt_us;
+  stats.estimated_bandwidth = QuicBandwidth::FromBitsPerSecond(8 * bytes_sent);
+  return stats;
+}
+
+class QuicConnectionStatsPublisherTest : public QuicTest {};
+
+TEST_F(QuicConnectionStatsPublisherTest, SnapshotReflectsLatestPublish) {
+  QuicConnectionStatsPublisher publisher;
+
+  // Before any publish, the snapshot is all zeros.
+  QuicConnectionStatsSnapshot snapshot = publisher.Snapshot();
+  EXPECT_EQ(0u, snapshot.bytes_sent);
+  EXPECT_EQ(0, snapshot.srtt_us);
+
+  publisher.Publish(MakeStats(/*bytes_sent=*/5000, /*min_rtt_us=*/100,
+                              /*srtt_us=*/150));
+  snapshot = publisher.Snapshot();
+  EXPECT_EQ(5000u, snapshot.bytes_sent);
+  EXPECT_EQ(5u, snapshot.packets_sent);
+  EXPECT_EQ(100, snapshot.min_rtt_us);
+  EXPECT_EQ(150, snapshot.srtt_us);
+  EXPECT_EQ(8 * 5000, snapshot.estimated_bandwidth_bps);
+
+  publisher.Publish(MakeStats(/*bytes_sent=*/9000, /*min_rtt_us=*/90,
+                              /*srtt_us=*/140));
+  snapshot = publisher.Snapshot();
+  EXPECT_EQ(9000u, snapshot.bytes_sent);
+  EXPECT_EQ(90, snapshot.min_rtt_us);
+}
+
+TEST_F(QuicConnectionStatsPublisherTest, InfiniteBandwidthExportedAsZero) {
+  QuicConnectionStatsPublisher publisher;
+  QuicConnectionStats stats;
+  stats.estimated_bandwidth = QuicBandwidth::Infinite();
+  publisher.Publish(stats);
+  EXPECT_EQ(0, publisher.Snapshot().estimated_bandwidth_bps);
+}
+
+TEST_F(QuicConnectionStatsPublisherTest, AggregatorSumsShards) {
+  QuicConnectionStatsPublisher shard1;
+  QuicConnectionStatsPublisher shard2;
+  QuicConnectionStatsPublisher idle_shard;
+  shard1.Publish(MakeStats(/*bytes_sent=*/1000, /*min_rtt_us=*/200,
+                           /*srtt_us=*/250));
+  shard2.Publish(MakeStats(/*bytes_sent=*/2000, /*min_rtt_us=*/100,
+                           /*srtt_us=*/300));
+
+  QuicConnectionStatsAggregator aggregator;
+  aggregator.AddShard(&shard1);
+  aggregator.AddShard(&shard2);
+  aggregator.AddShard(&idle_shard);
+  EXPECT_EQ(3u, aggregator.num_shards());
+
+  QuicConnectionStatsSnapshot total = aggregator.Sum();
+  EXPECT_EQ(3000u, total.bytes_sent);
+  EXPECT_EQ(3u, total.packets_sent);
+  // Counters sum; min RTT ignores the idle shard's zero, smoothed RTT and
+  // bandwidth take the maximum.
+  EXPECT_EQ(100, total.min_rtt_us);
+  EXPECT_EQ(300, total.srtt_us);
+  EXPECT_EQ(8 * 2000, total.estimated_bandwidth_bps);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
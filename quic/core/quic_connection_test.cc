@@ -27,6 +27,7 @@
 #include "quic/core/quic_connection_id.h"
 #include "quic/core/quic_constants.h"
 #include "quic/core/quic_error_codes.h"
+#include "quic/core/quic_mtu_discovery.h"
 #include "quic/core/quic_packet_creator.h"
 #include "quic/core/quic_packets.h"
 #include "quic/core/quic_path_validator.h"
@@ -1403,6 +1404,8 @@ class QuicConnectionTest : public QuicTestWithParam<TestParams> {
   }
 
   void MtuDiscoveryTestInit() {
+    // The process-wide MTU cache would leak probe results between tests.
+    QuicMtuCache::GetInstance()->ClearForTesting();
     set_perspective(Perspective::IS_SERVER);
     QuicPacketCreatorPeer::SetSendVersionInPacket(creator_, false);
     if (version().SupportsAntiAmplificationLimit()) {
@@ -3632,6 +3635,26 @@ TEST_P(QuicConnectionTest, FramePacking) {
             writer_->stream_frames()[1]->stream_id);
 }
 
+TEST_P(QuicConnectionTest, CryptoDataPreemptsPartiallyFilledPacket) {
+  if (!QuicVersionUsesCryptoFrames(connection_.transport_version())) {
+    return;
+  }
+  connection_.SetDefaultEncryptionLevel(ENCRYPTION_FORWARD_SECURE);
+  EXPECT_EQ(0u, connection_.GetStats().crypto_preempted_partial_packets);
+  {
+    EXPECT_CALL(*send_algorithm_, OnPacketSent(_, _, _, _, _)).Times(2);
+    QuicConnection::ScopedPacketFlusher flusher(&connection_);
+    connection_.SendStreamData3();
+    // Crypto data at the same encryption level flushes the partially-filled
+    // packet so that the crypto frames lead a packet of their own, and the
+    // preemption is recorded in the connection stats.
+    connection_.SendCryptoDataWithString("TLS ticket", 0,
+                                         ENCRYPTION_FORWARD_SECURE);
+  }
+  EXPECT_EQ(0u, connection_.NumQueuedPackets());
+  EXPECT_EQ(1u, connection_.GetStats().crypto_preempted_partial_packets);
+}
+
 TEST_P(QuicConnectionTest, FramePackingNonCryptoThenCrypto) {
   // Send two stream frames (one non-crypto, then one crypto) in 2 packets by
   // queueing them.
@@ -5468,6 +5491,78 @@ TEST_P(QuicConnectionTest, MtuDiscoveryEnabled) {
               IsError(QUIC_PACKET_WRITE_ERROR));
 }
 
+TEST_P(QuicConnectionTest, MtuDiscoveryProbeTargetSeededFromMtuCache) {
+  MtuDiscoveryTestInit();
+
+  const QuicPacketCount packets_between_probes_base = 5;
+  set_packets_between_probes_base(packets_between_probes_base);
+
+  // A previous connection to this prefix validated a larger MTU than the
+  // default probe target. This connection should probe towards the cached
+  // value instead.
+  const QuicByteCount cached_mtu = kMtuDiscoveryTargetPacketSizeHigh + 40;
+  QuicMtuCache::GetInstance()->OnMtuValidated(connection_.peer_address(),
+                                              cached_mtu);
+
+  connection_.EnablePathMtuDiscovery(send_algorithm_);
+
+  // Send enough packets so that the next one triggers path MTU discovery.
+  for (QuicPacketCount i = 0; i < packets_between_probes_base - 1; i++) {
+    SendStreamDataToPeer(3, ".", i, NO_FIN, nullptr);
+    ASSERT_FALSE(connection_.GetMtuDiscoveryAlarm()->IsSet());
+  }
+
+  // Trigger the probe.
+  SendStreamDataToPeer(3, "!", packets_between_probes_base - 1, NO_FIN,
+                       nullptr);
+  ASSERT_TRUE(connection_.GetMtuDiscoveryAlarm()->IsSet());
+  // The first probe splits the difference between the current MTU and the
+  // cached target, not the default target.
+  const QuicByteCount expected_probe_size =
+      (connection_.max_packet_length() + cached_mtu + 1) / 2;
+  QuicByteCount probe_size;
+  EXPECT_CALL(*send_algorithm_, OnPacketSent(_, _, _, _, _))
+      .WillOnce(SaveArg<3>(&probe_size));
+  connection_.GetMtuDiscoveryAlarm()->Fire();
+  EXPECT_EQ(expected_probe_size, probe_size);
+
+  QuicMtuCache::GetInstance()->ClearForTesting();
+}
+
+TEST_P(QuicConnectionTest, MtuProbeDeferredWhenCongestionWindowIsFull) {
+  MtuDiscoveryTestInit();
+
+  const QuicPacketCount packets_between_probes_base = 5;
+  set_packets_between_probes_base(packets_between_probes_base);
+
+  connection_.EnablePathMtuDiscovery(send_algorithm_);
+
+  QuicStreamOffset stream_offset = 0;
+  for (QuicPacketCount i = 0; i < packets_between_probes_base - 1; i++) {
+    SendStreamDataToPeer(3, ".", stream_offset++, NO_FIN, nullptr);
+    ASSERT_FALSE(connection_.GetMtuDiscoveryAlarm()->IsSet());
+  }
+
+  // Trigger the probe, but with the congestion window fully committed to
+  // the in-flight application data. The probe yields instead of consuming
+  // window the application needs.
+  SendStreamDataToPeer(3, "!", stream_offset++, NO_FIN, nullptr);
+  ASSERT_TRUE(connection_.GetMtuDiscoveryAlarm()->IsSet());
+  EXPECT_CALL(*send_algorithm_, GetCongestionWindow())
+      .WillRepeatedly(Return(connection_.GetBytesInFlight()));
+  connection_.GetMtuDiscoveryAlarm()->Fire();
+  EXPECT_EQ(0u, connection_.mtu_probe_count());
+
+  // Once the window opens up again, the next sent packet re-arms the alarm
+  // and the probe goes out.
+  EXPECT_CALL(*send_algorithm_, GetCongestionWindow())
+      .WillRepeatedly(Return(10 * kDefaultTCPMSS));
+  SendStreamDataToPeer(3, "!", stream_offset++, NO_FIN, nullptr);
+  ASSERT_TRUE(connection_.GetMtuDiscoveryAlarm()->IsSet());
+  connection_.GetMtuDiscoveryAlarm()->Fire();
+  EXPECT_EQ(1u, connection_.mtu_probe_count());
+}
+
 // After a successful MTU probe, one and only one write error should be ignored
 // if it happened in QuicConnection::FlushPacket.
 TEST_P(QuicConnectionTest,
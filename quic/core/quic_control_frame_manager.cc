@@ -4,6 +4,7 @@
 
 #include "quic/core/quic_control_frame_manager.h"
 
+#include <algorithm>
 #include <string>
 
 #include "absl/strings/str_cat.h"
@@ -77,6 +78,20 @@ void QuicControlFrameManager::WriteOrBufferGoAway(
 void QuicControlFrameManager::WriteOrBufferWindowUpdate(
     QuicStreamId id, QuicStreamOffset byte_offset) {
   QUIC_DVLOG(1) << "Writing WINDOW_UPDATE_FRAME";
+  // If a WINDOW_UPDATE for the same stream is buffered but not yet sent,
+  // raise its offset in place. Updates are absolute, so the newest offset
+  // subsumes the older one, and a burst of consumption across many streams
+  // flushes as one frame per stream instead of a queue of stale updates.
+  for (size_t i = least_unsent_ - least_unacked_; i < control_frames_.size();
+       ++i) {
+    QuicFrame& frame = control_frames_[i];
+    if (frame.type == WINDOW_UPDATE_FRAME &&
+        frame.window_update_frame->stream_id == id) {
+      frame.window_update_frame->max_data =
+          std::max(frame.window_update_frame->max_data, byte_offset);
+      return;
+    }
+  }
   WriteOrBufferQuicFrame(QuicFrame(
       new QuicWindowUpdateFrame(++last_control_frame_id_, id, byte_offset)));
 }
@@ -5,6 +5,7 @@
 #include "quic/core/quic_control_frame_manager.h"
 
 #include <utility>
+#include <vector>
 
 #include "quic/core/crypto/null_encrypter.h"
 #include "quic/core/frames/quic_ack_frequency_frame.h"
@@ -273,7 +274,15 @@ TEST_F(QuicControlFrameManagerTest, NewAndRetireConnectionIdFrames) {
 
 TEST_F(QuicControlFrameManagerTest, DonotRetransmitOldWindowUpdates) {
   Initialize();
-  // Send two more window updates of the same stream.
+  InSequence s;
+  // Flush the buffered control frames first: an unsent window update of the
+  // same stream would otherwise be collapsed into instead of queued behind.
+  EXPECT_CALL(*session_, WriteControlFrame(_, _))
+      .WillRepeatedly(Invoke(&ClearControlFrameWithTransmissionType));
+  manager_->OnCanWrite();
+
+  // Send two more window updates of the same stream, each sent before the
+  // next is written.
   manager_->WriteOrBufferWindowUpdate(kTestStreamId, 200);
   QuicWindowUpdateFrame window_update2(number_of_frames_ + 1, kTestStreamId,
                                        200);
@@ -281,11 +290,6 @@ TEST_F(QuicControlFrameManagerTest, DonotRetransmitOldWindowUpdates) {
   manager_->WriteOrBufferWindowUpdate(kTestStreamId, 300);
   QuicWindowUpdateFrame window_update3(number_of_frames_ + 2, kTestStreamId,
                                        300);
-  InSequence s;
-  // Flush all buffered control frames.
-  EXPECT_CALL(*session_, WriteControlFrame(_, _))
-      .WillRepeatedly(Invoke(&ClearControlFrameWithTransmissionType));
-  manager_->OnCanWrite();
 
   // Mark all 3 window updates as lost.
   manager_->OnControlFrameLost(QuicFrame(&window_update_));
@@ -335,6 +339,43 @@ TEST_F(QuicControlFrameManagerTest, RetransmitWindowUpdateOfDifferentStreams) {
   EXPECT_FALSE(manager_->WillingToWrite());
 }
 
+TEST_F(QuicControlFrameManagerTest, CollapsesBufferedWindowUpdates) {
+  Initialize();
+  // The queue holds number_of_frames_ unsent frames, including a
+  // WINDOW_UPDATE for kTestStreamId with offset 100. A newer update of the
+  // same stream raises that frame in place instead of queueing another.
+  manager_->WriteOrBufferWindowUpdate(kTestStreamId, 200);
+  EXPECT_EQ(number_of_frames_,
+            QuicControlFrameManagerPeer::QueueSize(manager_.get()));
+
+  // An update of a different stream gets its own frame.
+  manager_->WriteOrBufferWindowUpdate(kTestStreamId + 2, 300);
+  EXPECT_EQ(number_of_frames_ + 1,
+            QuicControlFrameManagerPeer::QueueSize(manager_.get()));
+
+  // The collapsed frame carries the newest offset.
+  std::vector<QuicWindowUpdateFrame> sent_window_updates;
+  EXPECT_CALL(*session_, WriteControlFrame(_, _))
+      .WillRepeatedly(Invoke(
+          [&sent_window_updates](QuicFrame frame, TransmissionType type) {
+            if (frame.type == WINDOW_UPDATE_FRAME) {
+              sent_window_updates.push_back(*frame.window_update_frame);
+            }
+            return ClearControlFrameWithTransmissionType(frame, type);
+          }));
+  manager_->OnCanWrite();
+  ASSERT_EQ(2u, sent_window_updates.size());
+  EXPECT_EQ(kTestStreamId, sent_window_updates[0].stream_id);
+  EXPECT_EQ(200u, sent_window_updates[0].max_data);
+  EXPECT_EQ(kTestStreamId + 2, sent_window_updates[1].stream_id);
+  EXPECT_EQ(300u, sent_window_updates[1].max_data);
+
+  // Sent frames are not collapsed into; a fresh update queues a new frame.
+  EXPECT_CALL(*session_, WriteControlFrame(_, _))
+      .WillOnce(Invoke(&ClearControlFrameWithTransmissionType));
+  manager_->WriteOrBufferWindowUpdate(kTestStreamId, 400);
+}
+
 TEST_F(QuicControlFrameManagerTest, TooManyBufferedControlFrames) {
   Initialize();
   EXPECT_CALL(*session_, WriteControlFrame(_, _))
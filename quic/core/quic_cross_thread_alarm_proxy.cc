@@ -0,0 +1,32 @@
+// Copyright (c) 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/quic_cross_thread_alarm_proxy.h"
+
+namespace quic {
+
+QuicCrossThreadAlarmProxy::QuicCrossThreadAlarmProxy(
+    QuicEpollServer* epoll_server, QuicAlarm* alarm)
+    : epoll_server_(epoll_server), alarm_(alarm) {}
+
+void QuicCrossThreadAlarmProxy::Set(QuicTime new_deadline) {
+  QuicAlarm* alarm = alarm_;
+  epoll_server_->PostCrossThreadTask(
+      [alarm, new_deadline]() { alarm->Set(new_deadline); });
+}
+
+void QuicCrossThreadAlarmProxy::Update(QuicTime new_deadline,
+                                       QuicTime::Delta granularity) {
+  QuicAlarm* alarm = alarm_;
+  epoll_server_->PostCrossThreadTask([alarm, new_deadline, granularity]() {
+    alarm->Update(new_deadline, granularity);
+  });
+}
+
+void QuicCrossThreadAlarmProxy::Cancel() {
+  QuicAlarm* alarm = alarm_;
+  epoll_server_->PostCrossThreadTask([alarm]() { alarm->Cancel(); });
+}
+
+}  // namespace quic
@@ -0,0 +1,51 @@
+// Copyright (c) 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_QUIC_CROSS_THREAD_ALARM_PROXY_H_
+#define QUICHE_QUIC_CORE_QUIC_CROSS_THREAD_ALARM_PROXY_H_
+
+#include "quic/core/quic_alarm.h"
+#include "quic/core/quic_time.h"
+#include "quic/platform/api/quic_epoll.h"
+#include "quic/platform/api/quic_export.h"
+
+namespace quic {
+
+// Marshals QuicAlarm mutations onto the alarm's epoll thread so that worker
+// threads (handshake offload, backend pools) can arm or cancel alarms
+// without external locking.
+//
+// QuicAlarm is deliberately unsynchronized: deadline bookkeeping and Fire()
+// all run on the epoll thread. Rather than putting a mutex on every alarm
+// operation -- which taxes the common, single-threaded path -- the proxy
+// posts each mutation to the epoll loop via
+// QuicEpollServer::PostCrossThreadTask. The alarm itself is therefore only
+// ever touched from its own thread, and callers on the epoll thread should
+// keep using the alarm directly.
+//
+// Each method has the same semantics as the identically named QuicAlarm
+// method, applied when the epoll loop next drains its cross-thread task
+// queue. Callers must ensure both the alarm and the epoll server outlive
+// any posted operation; in practice that means destroying alarms on the
+// epoll thread after the workers referencing them have quiesced.
+class QUIC_EXPORT_PRIVATE QuicCrossThreadAlarmProxy {
+ public:
+  QuicCrossThreadAlarmProxy(QuicEpollServer* epoll_server, QuicAlarm* alarm);
+  QuicCrossThreadAlarmProxy(const QuicCrossThreadAlarmProxy&) = delete;
+  QuicCrossThreadAlarmProxy& operator=(const QuicCrossThreadAlarmProxy&) =
+      delete;
+
+  // All three may be called from any thread.
+  void Set(QuicTime new_deadline);
+  void Update(QuicTime new_deadline, QuicTime::Delta granularity);
+  void Cancel();
+
+ private:
+  QuicEpollServer* epoll_server_;  // Not owned.
+  QuicAlarm* alarm_;               // Not owned.
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_QUIC_CROSS_THREAD_ALARM_PROXY_H_
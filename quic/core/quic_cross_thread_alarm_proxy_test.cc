@@ -0,0 +1,105 @@
+// Copyright (c) 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/quic_cross_thread_alarm_proxy.h"
+
+#include <memory>
+#include <thread>
+
+#include "quic/core/quic_epoll_alarm_factory.h"
+#include "quic/platform/api/quic_epoll_test_tools.h"
+#include "quic/platform/api/quic_test.h"
+#include "net/quic/platform/impl/quic_epoll_clock.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+class TestDelegate : public QuicAlarm::DelegateWithoutContext {
+ public:
+  TestDelegate() : fired_(false) {}
+
+  void OnAlarm() override { fired_ = true; }
+
+  bool fired() const { return fired_; }
+
+ private:
+  bool fired_;
+};
+
+class QuicCrossThreadAlarmProxyTest : public QuicTest {
+ protected:
+  QuicCrossThreadAlarmProxyTest()
+      : clock_(&epoll_server_), alarm_factory_(&epoll_server_) {}
+
+  QuicFakeEpollServer epoll_server_;
+  const QuicEpollClock clock_;
+  QuicEpollAlarmFactory alarm_factory_;
+};
+
+TEST_F(QuicCrossThreadAlarmProxyTest, SetFromAnotherThread) {
+  TestDelegate* delegate = new TestDelegate();
+  std::unique_ptr<QuicAlarm> alarm(alarm_factory_.CreateAlarm(delegate));
+  QuicCrossThreadAlarmProxy proxy(&epoll_server_, alarm.get());
+
+  QuicTime::Delta delta = QuicTime::Delta::FromMicroseconds(1);
+  QuicTime deadline = clock_.Now() + delta;
+  std::thread worker([&proxy, deadline]() { proxy.Set(deadline); });
+  worker.join();
+
+  // The posted Set has not been applied yet: the alarm is only mutated once
+  // the epoll loop drains its cross-thread task queue.
+  EXPECT_FALSE(alarm->IsSet());
+
+  epoll_server_.AdvanceByAndWaitForEventsAndExecuteCallbacks(
+      delta.ToMicroseconds());
+  EXPECT_TRUE(delegate->fired());
+}
+
+TEST_F(QuicCrossThreadAlarmProxyTest, CancelFromAnotherThread) {
+  TestDelegate* delegate = new TestDelegate();
+  std::unique_ptr<QuicAlarm> alarm(alarm_factory_.CreateAlarm(delegate));
+  QuicCrossThreadAlarmProxy proxy(&epoll_server_, alarm.get());
+
+  QuicTime::Delta delta = QuicTime::Delta::FromMicroseconds(1);
+  alarm->Set(clock_.Now() + delta);
+
+  std::thread worker([&proxy]() { proxy.Cancel(); });
+  worker.join();
+
+  epoll_server_.AdvanceByAndWaitForEventsAndExecuteCallbacks(
+      delta.ToMicroseconds());
+  EXPECT_FALSE(alarm->IsSet());
+  EXPECT_FALSE(delegate->fired());
+}
+
+TEST_F(QuicCrossThreadAlarmProxyTest, UpdateFromAnotherThread) {
+  TestDelegate* delegate = new TestDelegate();
+  std::unique_ptr<QuicAlarm> alarm(alarm_factory_.CreateAlarm(delegate));
+  QuicCrossThreadAlarmProxy proxy(&epoll_server_, alarm.get());
+
+  QuicTime::Delta delta = QuicTime::Delta::FromMicroseconds(1);
+  QuicTime::Delta new_delta = QuicTime::Delta::FromMicroseconds(3);
+  alarm->Set(clock_.Now() + delta);
+
+  QuicTime new_deadline = clock_.Now() + new_delta;
+  std::thread worker([&proxy, new_deadline]() {
+    proxy.Update(new_deadline, QuicTime::Delta::Zero());
+  });
+  worker.join();
+
+  // The first drain applies the update, so the original deadline passes
+  // without firing.
+  epoll_server_.AdvanceByAndWaitForEventsAndExecuteCallbacks(
+      delta.ToMicroseconds());
+  EXPECT_FALSE(delegate->fired());
+
+  epoll_server_.AdvanceByAndWaitForEventsAndExecuteCallbacks(
+      (new_delta - delta).ToMicroseconds());
+  EXPECT_TRUE(delegate->fired());
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
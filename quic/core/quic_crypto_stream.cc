@@ -70,17 +70,111 @@ QuicByteCount QuicCryptoStream::CryptoMessageFramingOverhead(
       /*offset=*/0);
 }
 
+bool QuicCryptoReassemblyBuffer::OnCryptoData(QuicStreamOffset offset,
+                                              absl::string_view data) {
+  QuicStreamOffset end_offset = offset + data.size();
+  if (end_offset <= num_bytes_consumed_) {
+    // The frame is entirely a retransmission of consumed data.
+    return true;
+  }
+  if (offset < num_bytes_consumed_) {
+    data.remove_prefix(num_bytes_consumed_ - offset);
+    offset = num_bytes_consumed_;
+  }
+  QuicIntervalSet<QuicStreamOffset> newly_received(offset, end_offset);
+  newly_received.Difference(received_);
+  if (newly_received.Empty()) {
+    // Duplicate of pending data; nothing new to buffer.
+    return true;
+  }
+  received_.Add(offset, end_offset);
+  if (received_.Size() > kMaxGaps + 1) {
+    return false;
+  }
+  if (end_offset - num_bytes_consumed_ > buffer_.size()) {
+    // The buffer is sized by the first frame; it only grows again if later
+    // frames extend past that (std::string grows geometrically, so the
+    // number of reallocations per handshake stays logarithmic).
+    buffer_.resize(end_offset - num_bytes_consumed_);
+  }
+  data.copy(&buffer_[offset - num_bytes_consumed_], data.size());
+  for (const auto& interval : newly_received) {
+    num_bytes_buffered_ += interval.Length();
+  }
+  return true;
+}
+
+absl::string_view QuicCryptoReassemblyBuffer::GetReadableRegion() const {
+  if (received_.Empty() || received_.begin()->min() > num_bytes_consumed_) {
+    return absl::string_view();
+  }
+  return absl::string_view(buffer_.data(),
+                           received_.begin()->max() - num_bytes_consumed_);
+}
+
+void QuicCryptoReassemblyBuffer::MarkConsumed(size_t num_bytes) {
+  QUICHE_DCHECK_LE(num_bytes, GetReadableRegion().size());
+  num_bytes_consumed_ += num_bytes;
+  num_bytes_buffered_ -= num_bytes;
+  received_.TrimLessThan(num_bytes_consumed_);
+  // Out-of-order data beyond the first gap is rare and small during a
+  // handshake, so shifting it to the front of the buffer is cheap.
+  buffer_.erase(0, num_bytes);
+}
+
+void QuicCryptoReassemblyBuffer::ReleaseBufferIfEmpty() {
+  if (num_bytes_buffered_ == 0) {
+    std::string().swap(buffer_);
+  }
+}
+
 void QuicCryptoStream::OnCryptoFrame(const QuicCryptoFrame& frame) {
   QUIC_BUG_IF(quic_bug_12573_1,
               !QuicVersionUsesCryptoFrames(session()->transport_version()))
       << "Versions less than 47 shouldn't receive CRYPTO frames";
+  if (frame.data_length == 0) {
+    if (GetQuicReloadableFlag(quic_accept_empty_crypto_frame)) {
+      QUIC_RELOADABLE_FLAG_COUNT(quic_accept_empty_crypto_frame);
+      // Ignore empty crypto frame.
+      return;
+    }
+    OnUnrecoverableError(QUIC_EMPTY_STREAM_FRAME_NO_FIN,
+                         "Empty crypto frame received");
+    return;
+  }
   EncryptionLevel level = session()->connection()->last_decrypted_level();
-  substreams_[level].sequencer.OnCryptoFrame(frame);
-  EncryptionLevel frame_level = level;
-  if (substreams_[level].sequencer.NumBytesBuffered() >
-      BufferSizeLimitForLevel(frame_level)) {
+  QuicCryptoReassemblyBuffer& reassembly_buffer =
+      substreams_[level].reassembly_buffer;
+  if (!reassembly_buffer.OnCryptoData(
+          frame.offset,
+          absl::string_view(frame.data_buffer, frame.data_length))) {
+    OnUnrecoverableError(QUIC_FLOW_CONTROL_RECEIVED_TOO_MUCH_DATA,
+                         "Too many gaps in crypto data");
+    return;
+  }
+  if (reassembly_buffer.NumBytesBuffered() > BufferSizeLimitForLevel(level)) {
     OnUnrecoverableError(QUIC_FLOW_CONTROL_RECEIVED_TOO_MUCH_DATA,
                          "Too much crypto data received");
+    return;
+  }
+  // Hand newly contiguous data straight to the handshake parser; there is no
+  // sequencer in this path.
+  absl::string_view data = reassembly_buffer.GetReadableRegion();
+  if (data.empty()) {
+    return;
+  }
+  if (!crypto_message_parser()->ProcessInput(data, level)) {
+    OnUnrecoverableError(crypto_message_parser()->error(),
+                         crypto_message_parser()->error_detail());
+    return;
+  }
+  reassembly_buffer.MarkConsumed(data.size());
+  if (one_rtt_keys_available() &&
+      crypto_message_parser()->InputBytesRemaining() == 0) {
+    // If the handshake is complete and the current message has been fully
+    // processed then no more handshake messages are likely to arrive soon
+    // so release the reassembly buffer's memory.
+    reassembly_buffer.ReleaseBufferIfEmpty();
   }
 }
 
@@ -102,7 +196,10 @@ void QuicCryptoStream::OnDataAvailable() {
     OnDataAvailableInSequencer(sequencer(), level);
     return;
   }
-  OnDataAvailableInSequencer(&substreams_[level].sequencer, level);
+  // CRYPTO frame data is delivered directly to the handshake parser in
+  // OnCryptoFrame and never reaches a sequencer.
+  QUIC_BUG(quic_crypto_stream_unexpected_data_available)
+      << "OnDataAvailable called on a version using CRYPTO frames";
 }
 
 void QuicCryptoStream::OnDataAvailableInSequencer(
@@ -350,13 +447,13 @@ uint64_t QuicCryptoStream::crypto_bytes_read() const {
   }
   uint64_t bytes_read = 0;
   for (EncryptionLevel level : AllEncryptionLevels()) {
-    bytes_read += substreams_[level].sequencer.NumBytesConsumed();
+    bytes_read += substreams_[level].reassembly_buffer.NumBytesConsumed();
   }
   return bytes_read;
 }
 
 uint64_t QuicCryptoStream::BytesReadOnLevel(EncryptionLevel level) const {
-  return substreams_[level].sequencer.NumBytesConsumed();
+  return substreams_[level].reassembly_buffer.NumBytesConsumed();
 }
 
 bool QuicCryptoStream::WriteCryptoFrame(EncryptionLevel level,
@@ -473,8 +570,7 @@ bool QuicCryptoStream::IsWaitingForAcks() const {
 QuicCryptoStream::CryptoSubstream::CryptoSubstream(
     QuicCryptoStream* crypto_stream,
     EncryptionLevel)
-    : sequencer(crypto_stream),
-      send_buffer(crypto_stream->session()
+    : send_buffer(crypto_stream->session()
                       ->connection()
                       ->helper()
                       ->GetStreamSendBufferAllocator()) {}
@@ -25,6 +25,56 @@ namespace quic {
 class CachedNetworkParameters;
 class QuicSession;
 
+// Reassembles out-of-order CRYPTO frame data for a single encryption level.
+// Unlike the general purpose QuicStreamSequencer, all pending data lives in
+// one contiguous buffer which is sized when the first frame arrives, and only
+// a small fixed number of gaps is tracked. This keeps the cost of reassembling
+// a multi-packet CHLO predictable during handshake floods: no per-block
+// allocations, and contiguous data can be handed to the handshake parser
+// without an intermediate copy.
+class QUIC_EXPORT_PRIVATE QuicCryptoReassemblyBuffer {
+ public:
+  // The maximum number of gaps tracked at once. A legitimate handshake
+  // flight spans at most a few dozen packets, so more gaps than this
+  // indicates a misbehaving (or malicious) peer.
+  static constexpr size_t kMaxGaps = 32;
+
+  // Buffers the payload of a CRYPTO frame received at |offset|. Returns false
+  // if accepting the frame would require tracking more than kMaxGaps gaps, in
+  // which case the frame is discarded.
+  bool OnCryptoData(QuicStreamOffset offset, absl::string_view data);
+
+  // Returns the contiguous data available for consumption. Empty if the data
+  // at the consumption frontier has not been received yet.
+  absl::string_view GetReadableRegion() const;
+
+  // Discards |num_bytes| of data, which must not exceed the size of the
+  // current readable region.
+  void MarkConsumed(size_t num_bytes);
+
+  // Releases the buffer's memory if all received data has been consumed.
+  void ReleaseBufferIfEmpty();
+
+  // Number of bytes consumed via MarkConsumed().
+  QuicByteCount NumBytesConsumed() const { return num_bytes_consumed_; }
+
+  // Number of received bytes which have not been consumed yet.
+  QuicByteCount NumBytesBuffered() const { return num_bytes_buffered_; }
+
+ private:
+  // Received byte ranges which have not been consumed yet. Holds at most
+  // kMaxGaps + 1 intervals.
+  QuicIntervalSet<QuicStreamOffset> received_;
+
+  // Stores stream bytes [num_bytes_consumed_,
+  // num_bytes_consumed_ + buffer_.size()). Bytes not covered by |received_|
+  // are uninitialized.
+  std::string buffer_;
+
+  QuicByteCount num_bytes_consumed_ = 0;
+  QuicByteCount num_bytes_buffered_ = 0;
+};
+
 // Crypto handshake messages in QUIC take place over a reserved stream with the
 // id 1.  Each endpoint (client and server) will allocate an instance of a
 // subclass of QuicCryptoStream to send and receive handshake messages.  (In the
@@ -245,10 +295,6 @@ class QUIC_EXPORT_PRIVATE QuicCryptoStream : public QuicStream {
   virtual void OnDataAvailableInSequencer(QuicStreamSequencer* sequencer,
                                           EncryptionLevel level);
 
-  QuicStreamSequencer* GetStreamSequencerForLevel(EncryptionLevel level) {
-    return &substreams_[level].sequencer;
-  }
-
  private:
   // Data sent and received in CRYPTO frames is sent at multiple encryption
   // levels. Some of the state for the single logical crypto stream is split
@@ -257,7 +303,7 @@ class QUIC_EXPORT_PRIVATE QuicCryptoStream : public QuicStream {
   struct QUIC_EXPORT_PRIVATE CryptoSubstream {
     CryptoSubstream(QuicCryptoStream* crypto_stream, EncryptionLevel);
 
-    QuicStreamSequencer sequencer;
+    QuicCryptoReassemblyBuffer reassembly_buffer;
     QuicStreamSendBuffer send_buffer;
   };
 
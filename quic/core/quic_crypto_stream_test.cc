@@ -673,6 +673,41 @@ TEST_F(QuicCryptoStreamTest, LimitBufferedCryptoData) {
       QuicCryptoFrame(ENCRYPTION_INITIAL, offset, large_frame));
 }
 
+TEST_F(QuicCryptoStreamTest, ProcessOutOfOrderCryptoData) {
+  if (!QuicVersionUsesCryptoFrames(connection_->transport_version())) {
+    return;
+  }
+  absl::string_view message = message_data_->AsStringPiece();
+  size_t split = message.size() / 2;
+  // Deliver the second half first; nothing can be processed yet.
+  stream_->OnCryptoFrame(
+      QuicCryptoFrame(ENCRYPTION_INITIAL, split, message.substr(split)));
+  EXPECT_EQ(0u, stream_->messages()->size());
+  EXPECT_EQ(0u, stream_->BytesReadOnLevel(ENCRYPTION_INITIAL));
+  // The first half fills the gap and the whole message gets processed.
+  stream_->OnCryptoFrame(
+      QuicCryptoFrame(ENCRYPTION_INITIAL, 0, message.substr(0, split)));
+  ASSERT_EQ(1u, stream_->messages()->size());
+  EXPECT_EQ(kSHLO, (*stream_->messages())[0].tag());
+  EXPECT_EQ(message.size(), stream_->BytesReadOnLevel(ENCRYPTION_INITIAL));
+}
+
+TEST_F(QuicCryptoStreamTest, LimitGapsInCryptoData) {
+  if (!QuicVersionUsesCryptoFrames(connection_->transport_version())) {
+    return;
+  }
+  // Disjoint one-byte frames starting at offset 1 each open a new gap.
+  QuicStreamOffset offset = 1;
+  for (size_t i = 0; i < QuicCryptoReassemblyBuffer::kMaxGaps + 1; ++i) {
+    stream_->OnCryptoFrame(QuicCryptoFrame(ENCRYPTION_INITIAL, offset, "a"));
+    offset += 2;
+  }
+  // One more gap exceeds the budget and closes the connection.
+  EXPECT_CALL(*connection_,
+              CloseConnection(QUIC_FLOW_CONTROL_RECEIVED_TOO_MUCH_DATA, _, _));
+  stream_->OnCryptoFrame(QuicCryptoFrame(ENCRYPTION_INITIAL, offset, "a"));
+}
+
 TEST_F(QuicCryptoStreamTest, RetransmitCryptoFramesAndPartialWrite) {
   if (!QuicVersionUsesCryptoFrames(connection_->transport_version())) {
     return;
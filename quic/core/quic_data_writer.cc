@@ -189,6 +189,45 @@ bool QuicDataWriter::WriteVarInt62(uint64_t value) {
   return false;
 }
 
+// Performance notes
+//
+// The fast path computes the encoded length without branching on it: the
+// three comparisons yield 0-3, which is both log2 of the length and the
+// two-bit prefix of the first wire byte.  Shifting the prefixed value to
+// the top of a word and byte swapping leaves the |encoded_length|
+// significant bytes first, so one unaligned 8-byte store emits the whole
+// varint; the store's tail lands in unused capacity, which the
+// remaining() check guarantees exists.  The bounds-checked WriteVarInt62
+// path is only taken within 8 bytes of the end of the buffer.
+size_t QuicDataWriter::WriteVarInt62Batch(const uint64_t* values,
+                                          size_t count) {
+  QUICHE_DCHECK_EQ(endianness(), quiche::NETWORK_BYTE_ORDER);
+
+  for (size_t i = 0; i < count; ++i) {
+    const uint64_t value = values[i];
+    if (remaining() < sizeof(uint64_t)) {
+      if (!WriteVarInt62(value)) {
+        return i;
+      }
+      continue;
+    }
+    if ((value & kVarInt62ErrorMask) != 0) {
+      // Can not encode, high 2 bits not 0.
+      return i;
+    }
+    const unsigned prefix =
+        (value > 0x3f) + (value > 0x3fff) + (value > 0x3fffffff);
+    const size_t encoded_length = size_t{1} << prefix;
+    const uint64_t encoded =
+        value | (static_cast<uint64_t>(prefix) << (8 * encoded_length - 2));
+    const uint64_t store =
+        quiche::QuicheEndian::HostToNet64(encoded << (64 - 8 * encoded_length));
+    memcpy(buffer() + length(), &store, sizeof(store));
+    IncreaseLength(encoded_length);
+  }
+  return count;
+}
+
 bool QuicDataWriter::WriteVarInt62(
     uint64_t value,
     QuicVariableLengthIntegerLength write_length) {
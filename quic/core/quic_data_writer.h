@@ -60,6 +60,13 @@ class QUIC_EXPORT_PRIVATE QuicDataWriter : public quiche::QuicheDataWriter {
   // buffer.
   bool WriteVarInt62(uint64_t value);
 
+  // Writes |count| integers from |values| as minimally-encoded IETF Variable
+  // Length Integers.  Returns the number successfully written, which is less
+  // than |count| only if a value exceeds kVarInt62MaxValue or the buffer ran
+  // out of space.  While at least eight bytes of capacity remain, each
+  // integer is encoded branchlessly with one unaligned eight byte store.
+  size_t WriteVarInt62Batch(const uint64_t* values, size_t count);
+
   // Same as WriteVarInt62(uint64_t), but forces an encoding size to write to.
   // This is not as optimized as WriteVarInt62(uint64_t).
   // Returns false if the value does not fit in the specified write_length or if
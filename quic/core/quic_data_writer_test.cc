@@ -1079,6 +1079,100 @@ TEST_P(QuicDataWriterTest, VarIntFixedLength) {
   EXPECT_FALSE(reader.ReadVarInt62(&test_val));
 }
 
+// Test that batched varint writes and reads round trip across all four
+// encoded lengths, and agree with the one-at-a-time methods in both
+// directions.
+TEST_P(QuicDataWriterTest, VarIntBatchRoundTrip) {
+  const uint64_t values[] = {
+      0,
+      1,
+      0x3e,
+      0x3f,  // Largest 1-byte encoding.
+      0x40,
+      0x3ffe,
+      0x3fff,  // Largest 2-byte encoding.
+      0x4000,
+      0x3ffffffe,
+      0x3fffffff,  // Largest 4-byte encoding.
+      0x40000000,
+      0x3ffffffffffffffe,
+      kVarInt62MaxValue,  // Largest 8-byte encoding.
+  };
+  const size_t kValueCount = ABSL_ARRAYSIZE(values);
+  char batch_buffer[8 * kValueCount];
+  memset(batch_buffer, 0, sizeof(batch_buffer));
+  QuicDataWriter batch_writer(sizeof(batch_buffer), batch_buffer,
+                              quiche::Endianness::NETWORK_BYTE_ORDER);
+  EXPECT_EQ(kValueCount, batch_writer.WriteVarInt62Batch(values, kValueCount));
+
+  // The batched writer must emit the same minimal encodings as the
+  // one-at-a-time writer.
+  char single_buffer[8 * kValueCount];
+  memset(single_buffer, 0, sizeof(single_buffer));
+  QuicDataWriter single_writer(sizeof(single_buffer), single_buffer,
+                               quiche::Endianness::NETWORK_BYTE_ORDER);
+  for (uint64_t value : values) {
+    EXPECT_TRUE(single_writer.WriteVarInt62(value));
+  }
+  EXPECT_EQ(single_writer.length(), batch_writer.length());
+  EXPECT_EQ(0, memcmp(single_buffer, batch_buffer, batch_writer.length()));
+
+  // The batched reader must decode what the one-at-a-time reader decodes.
+  QuicDataReader batch_reader(batch_buffer, batch_writer.length(),
+                              quiche::Endianness::NETWORK_BYTE_ORDER);
+  uint64_t results[kValueCount];
+  EXPECT_EQ(kValueCount, batch_reader.ReadVarInt62Batch(results, kValueCount));
+  for (size_t i = 0; i < kValueCount; i++) {
+    EXPECT_EQ(values[i], results[i]) << " batched decode of index " << i;
+  }
+  EXPECT_EQ(0u, batch_reader.BytesRemaining());
+}
+
+// Test the bounds-checked tail of the batched methods: within 8 bytes of
+// the end of the buffer they fall back to the single-value methods and
+// return a short count once the buffer truly runs out.
+TEST_P(QuicDataWriterTest, VarIntBatchNearBufferEnd) {
+  // Three 2-byte encodings fit exactly; there is never 8 bytes of slack,
+  // so every write takes the fallback path.
+  const uint64_t values[] = {0x3142, 0x3143, 0x3144, 0x3145};
+  char buffer[6];
+  memset(buffer, 0, sizeof(buffer));
+  QuicDataWriter writer(sizeof(buffer), static_cast<char*>(buffer),
+                        quiche::Endianness::NETWORK_BYTE_ORDER);
+  EXPECT_EQ(3u, writer.WriteVarInt62Batch(values, ABSL_ARRAYSIZE(values)));
+  EXPECT_EQ(sizeof(buffer), writer.length());
+
+  // Reading asks for one more value than was encoded; the fourth decode
+  // fails and the reader stops after the third.
+  QuicDataReader reader(buffer, sizeof(buffer),
+                        quiche::Endianness::NETWORK_BYTE_ORDER);
+  uint64_t results[ABSL_ARRAYSIZE(values)];
+  EXPECT_EQ(3u, reader.ReadVarInt62Batch(results, ABSL_ARRAYSIZE(values)));
+  for (size_t i = 0; i < 3; i++) {
+    EXPECT_EQ(values[i], results[i]);
+  }
+  EXPECT_EQ(0u, reader.BytesRemaining());
+}
+
+// Test that a batched write stops at the first value too large for
+// VarInt62 encoding, leaving the previously written values intact.
+TEST_P(QuicDataWriterTest, VarIntBatchBadValue) {
+  const uint64_t values[] = {0x3142, kVarInt62MaxValue + 1, 0x3143};
+  char buffer[8 * ABSL_ARRAYSIZE(values)];
+  memset(buffer, 0, sizeof(buffer));
+  QuicDataWriter writer(sizeof(buffer), static_cast<char*>(buffer),
+                        quiche::Endianness::NETWORK_BYTE_ORDER);
+  EXPECT_EQ(1u, writer.WriteVarInt62Batch(values, ABSL_ARRAYSIZE(values)));
+  EXPECT_EQ(2u, writer.length());
+
+  QuicDataReader reader(buffer, writer.length(),
+                        quiche::Endianness::NETWORK_BYTE_ORDER);
+  uint64_t test_val;
+  EXPECT_TRUE(reader.ReadVarInt62(&test_val));
+  EXPECT_EQ(values[0], test_val);
+  EXPECT_FALSE(reader.ReadVarInt62(&test_val));
+}
+
 // Test encoding/decoding stream-id values.
 void EncodeDecodeStreamId(uint64_t value_in) {
   char buffer[1 * kMultiVarCount];
@@ -26,10 +26,16 @@ QuicDatagramQueue::QuicDatagramQueue(QuicSession* session,
       observer_(std::move(observer)) {}
 
 MessageStatus QuicDatagramQueue::SendOrQueueDatagram(QuicMemSlice datagram) {
-  // If the queue is non-empty, always queue the daragram.  This ensures that
-  // the datagrams are sent in the same order that they were sent by the
-  // application.
-  if (queue_.empty()) {
+  return SendOrQueueDatagram(std::move(datagram), Priority::kHigh);
+}
+
+MessageStatus QuicDatagramQueue::SendOrQueueDatagram(QuicMemSlice datagram,
+                                                     Priority priority) {
+  // If the queue is non-empty, always queue the datagram.  This ensures that
+  // datagrams within a lane are sent in the same order that they were sent by
+  // the application, and that lanes with queued data are served in priority
+  // order.
+  if (empty()) {
     MessageResult result = session_->SendMessage(absl::MakeSpan(&datagram, 1));
     if (result.status != MESSAGE_STATUS_BLOCKED) {
       if (observer_) {
@@ -39,26 +45,29 @@ MessageStatus QuicDatagramQueue::SendOrQueueDatagram(QuicMemSlice datagram) {
     }
   }
 
-  queue_.emplace_back(Datagram{std::move(datagram),
-                               clock_->ApproximateNow() + GetMaxTimeInQueue()});
+  lanes_[static_cast<size_t>(priority)].queue.emplace_back(
+      Datagram{std::move(datagram),
+               clock_->ApproximateNow() + GetMaxTimeInQueue(priority)});
   return MESSAGE_STATUS_BLOCKED;
 }
 
 absl::optional<MessageStatus> QuicDatagramQueue::TrySendingNextDatagram() {
   RemoveExpiredDatagrams();
-  if (queue_.empty()) {
-    return absl::nullopt;
-  }
-
-  MessageResult result =
-      session_->SendMessage(absl::MakeSpan(&queue_.front().datagram, 1));
-  if (result.status != MESSAGE_STATUS_BLOCKED) {
-    queue_.pop_front();
-    if (observer_) {
-      observer_->OnDatagramProcessed(result.status);
+  for (Lane& lane : lanes_) {
+    if (lane.queue.empty()) {
+      continue;
+    }
+    MessageResult result =
+        session_->SendMessage(absl::MakeSpan(&lane.queue.front().datagram, 1));
+    if (result.status != MESSAGE_STATUS_BLOCKED) {
+      lane.queue.pop_front();
+      if (observer_) {
+        observer_->OnDatagramProcessed(result.status);
+      }
     }
+    return result.status;
   }
-  return result.status;
+  return absl::nullopt;
 }
 
 size_t QuicDatagramQueue::SendDatagrams() {
@@ -87,12 +96,47 @@ QuicTime::Delta QuicDatagramQueue::GetMaxTimeInQueue() const {
                   kMinPacingWindows * kAlarmGranularity);
 }
 
+void QuicDatagramQueue::SetMaxTimeInQueue(Priority priority,
+                                          QuicTime::Delta max_time_in_queue) {
+  lanes_[static_cast<size_t>(priority)].max_time_in_queue = max_time_in_queue;
+}
+
+uint64_t QuicDatagramQueue::expired_datagram_count(Priority priority) const {
+  return lanes_[static_cast<size_t>(priority)].expired_datagram_count;
+}
+
+size_t QuicDatagramQueue::queue_size() const {
+  size_t total = 0;
+  for (const Lane& lane : lanes_) {
+    total += lane.queue.size();
+  }
+  return total;
+}
+
+bool QuicDatagramQueue::empty() const {
+  for (const Lane& lane : lanes_) {
+    if (!lane.queue.empty()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+QuicTime::Delta QuicDatagramQueue::GetMaxTimeInQueue(Priority priority) const {
+  const QuicTime::Delta lane_max =
+      lanes_[static_cast<size_t>(priority)].max_time_in_queue;
+  return lane_max.IsZero() ? GetMaxTimeInQueue() : lane_max;
+}
+
 void QuicDatagramQueue::RemoveExpiredDatagrams() {
   QuicTime now = clock_->ApproximateNow();
-  while (!queue_.empty() && queue_.front().expiry <= now) {
-    queue_.pop_front();
-    if (observer_) {
-      observer_->OnDatagramProcessed(absl::nullopt);
+  for (Lane& lane : lanes_) {
+    while (!lane.queue.empty() && lane.queue.front().expiry <= now) {
+      lane.queue.pop_front();
+      ++lane.expired_datagram_count;
+      if (observer_) {
+        observer_->OnDatagramProcessed(absl::nullopt);
+      }
     }
   }
 }
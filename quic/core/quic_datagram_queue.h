@@ -5,6 +5,7 @@
 #ifndef QUICHE_QUIC_CORE_QUIC_DATAGRAM_QUEUE_H_
 #define QUICHE_QUIC_CORE_QUIC_DATAGRAM_QUEUE_H_
 
+#include <cstdint>
 #include <memory>
 
 #include "absl/types/optional.h"
@@ -20,16 +21,31 @@ class QuicSession;
 // Provides a way to buffer QUIC datagrams (messages) in case they cannot
 // be sent due to congestion control.  Datagrams are buffered for a limited
 // amount of time, and deleted after that time passes.
+//
+// Datagrams are queued into one of three drop-priority lanes.  Lanes are
+// served in priority order, datagrams within a lane are sent first-in
+// first-out, and each lane can be given its own maximum queueing time, so
+// that under congestion an application can let its least important
+// datagrams expire while more important ones survive.
 class QUIC_EXPORT_PRIVATE QuicDatagramQueue {
  public:
+  // Drop-priority lanes.  kHigh is sent first and, with a suitably longer
+  // maximum queueing time, dropped last.
+  enum class Priority : uint8_t {
+    kHigh = 0,
+    kMedium = 1,
+    kLow = 2,
+  };
+  static constexpr size_t kNumPriorities = 3;
+
   // An interface used to monitor events on the associated `QuicDatagramQueue`.
   class QUIC_EXPORT_PRIVATE Observer {
    public:
     virtual ~Observer() = default;
 
     // Called when a datagram in the associated queue is sent or discarded.
-    // Identity information for the datagram is not given, because the sending
-    // and discarding order is always first-in-first-out.
+    // Identity information for the datagram is not given, because within a
+    // lane the sending and discarding order is always first-in-first-out.
     // This function is called synchronously in `QuicDatagramQueue` methods.
     // `status` is nullopt when the datagram is dropped due to being in the
     // queue for too long.
@@ -42,10 +58,13 @@ class QUIC_EXPORT_PRIVATE QuicDatagramQueue {
   // |session| is not owned and must outlive this object.
   QuicDatagramQueue(QuicSession* session, std::unique_ptr<Observer> observer);
 
-  // Adds the datagram to the end of the queue.  May send it immediately; if
-  // not, MESSAGE_STATUS_BLOCKED is returned.
+  // Adds the datagram to the end of the high-priority lane.  May send it
+  // immediately; if not, MESSAGE_STATUS_BLOCKED is returned.
   MessageStatus SendOrQueueDatagram(QuicMemSlice datagram);
 
+  // Same as above, but queues the datagram in |priority|'s lane.
+  MessageStatus SendOrQueueDatagram(QuicMemSlice datagram, Priority priority);
+
   // Attempts to send a single datagram from the queue.  Returns the result of
   // SendMessage(), or nullopt if there were no unexpired datagrams to send.
   absl::optional<MessageStatus> TrySendingNextDatagram();
@@ -63,9 +82,17 @@ class QUIC_EXPORT_PRIVATE QuicDatagramQueue {
     max_time_in_queue_ = max_time_in_queue;
   }
 
-  size_t queue_size() { return queue_.size(); }
+  // Overrides the maximum queueing time for a single lane.  A zero delta
+  // reverts the lane to the queue-wide value above.
+  void SetMaxTimeInQueue(Priority priority, QuicTime::Delta max_time_in_queue);
+
+  // Number of datagrams dropped from |priority|'s lane because they stayed
+  // queued for too long.
+  uint64_t expired_datagram_count(Priority priority) const;
 
-  bool empty() { return queue_.empty(); }
+  size_t queue_size() const;
+
+  bool empty() const;
 
  private:
   struct QUIC_EXPORT_PRIVATE Datagram {
@@ -73,14 +100,24 @@ class QUIC_EXPORT_PRIVATE QuicDatagramQueue {
     QuicTime expiry;
   };
 
-  // Removes expired datagrams from the front of the queue.
+  struct QUIC_EXPORT_PRIVATE Lane {
+    quiche::QuicheCircularDeque<Datagram> queue;
+    // Per-lane override of |max_time_in_queue_|; zero when unset.
+    QuicTime::Delta max_time_in_queue = QuicTime::Delta::Zero();
+    uint64_t expired_datagram_count = 0;
+  };
+
+  // Returns the maximum queueing time for |priority|'s lane.
+  QuicTime::Delta GetMaxTimeInQueue(Priority priority) const;
+
+  // Removes expired datagrams from the front of every lane.
   void RemoveExpiredDatagrams();
 
   QuicSession* session_;  // Not owned.
   const QuicClock* clock_;
 
   QuicTime::Delta max_time_in_queue_ = QuicTime::Delta::Zero();
-  quiche::QuicheCircularDeque<Datagram> queue_;
+  Lane lanes_[kNumPriorities];
   std::unique_ptr<Observer> observer_;
 };
 
@@ -200,6 +200,59 @@ TEST_F(QuicDatagramQueueTest, ExpireAll) {
   EXPECT_EQ(0u, queue_.SendDatagrams());
 }
 
+TEST_F(QuicDatagramQueueTest, PriorityLaneOrder) {
+  EXPECT_CALL(*connection_, SendMessage(_, _, _))
+      .WillOnce(Return(MESSAGE_STATUS_BLOCKED));
+  queue_.SendOrQueueDatagram(CreateMemSlice("low"),
+                             QuicDatagramQueue::Priority::kLow);
+  queue_.SendOrQueueDatagram(CreateMemSlice("high"),
+                             QuicDatagramQueue::Priority::kHigh);
+  queue_.SendOrQueueDatagram(CreateMemSlice("medium"),
+                             QuicDatagramQueue::Priority::kMedium);
+  EXPECT_EQ(3u, queue_.queue_size());
+
+  std::vector<std::string> messages;
+  EXPECT_CALL(*connection_, SendMessage(_, _, _))
+      .WillRepeatedly([&messages](QuicMessageId /*id*/,
+                                  absl::Span<QuicMemSlice> message,
+                                  bool /*flush*/) {
+        messages.push_back(std::string(message[0].AsStringView()));
+        return MESSAGE_STATUS_SUCCESS;
+      });
+  EXPECT_EQ(3u, queue_.SendDatagrams());
+  EXPECT_THAT(messages, ElementsAre("high", "medium", "low"));
+}
+
+TEST_F(QuicDatagramQueueTest, PerLaneExpiry) {
+  constexpr QuicTime::Delta expiry = QuicTime::Delta::FromMilliseconds(100);
+  queue_.SetMaxTimeInQueue(expiry);
+  queue_.SetMaxTimeInQueue(QuicDatagramQueue::Priority::kLow, 0.5 * expiry);
+
+  EXPECT_CALL(*connection_, SendMessage(_, _, _))
+      .WillOnce(Return(MESSAGE_STATUS_BLOCKED));
+  queue_.SendOrQueueDatagram(CreateMemSlice("high"),
+                             QuicDatagramQueue::Priority::kHigh);
+  queue_.SendOrQueueDatagram(CreateMemSlice("low"),
+                             QuicDatagramQueue::Priority::kLow);
+
+  // The low lane's shorter maximum age drops only its datagram.
+  helper_.AdvanceTime(0.6 * expiry);
+  std::vector<std::string> messages;
+  EXPECT_CALL(*connection_, SendMessage(_, _, _))
+      .WillRepeatedly([&messages](QuicMessageId /*id*/,
+                                  absl::Span<QuicMemSlice> message,
+                                  bool /*flush*/) {
+        messages.push_back(std::string(message[0].AsStringView()));
+        return MESSAGE_STATUS_SUCCESS;
+      });
+  EXPECT_EQ(1u, queue_.SendDatagrams());
+  EXPECT_THAT(messages, ElementsAre("high"));
+  EXPECT_EQ(0u, queue_.expired_datagram_count(
+                    QuicDatagramQueue::Priority::kHigh));
+  EXPECT_EQ(1u,
+            queue_.expired_datagram_count(QuicDatagramQueue::Priority::kLow));
+}
+
 class QuicDatagramQueueWithObserverTest : public QuicDatagramQueueTestBase {
  public:
   QuicDatagramQueueWithObserverTest()
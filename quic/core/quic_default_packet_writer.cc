@@ -20,11 +20,15 @@ WriteResult QuicDefaultPacketWriter::WritePacket(
     const QuicSocketAddress& peer_address,
     PerPacketOptions* options) {
   QUICHE_DCHECK(!write_blocked_);
-  QUICHE_DCHECK(nullptr == options)
-      << "QuicDefaultPacketWriter does not accept any options.";
   QuicUdpPacketInfo packet_info;
   packet_info.SetPeerAddress(peer_address);
   packet_info.SetSelfIp(self_address);
+  // Of the per-packet options, only the QoS class is supported: it is
+  // translated into a TOS/traffic class marking on this packet. Release time
+  // is not supported (see SupportsReleaseTime()).
+  if (options != nullptr && options->qos_class != QOS_CLASS_DEFAULT) {
+    packet_info.SetTos(QosClassToTos(options->qos_class));
+  }
   WriteResult result =
       QuicUdpSocketApi().WritePacket(fd_, buffer, buf_len, packet_info);
   if (IsWriteBlockedStatus(result.status)) {
@@ -4,6 +4,7 @@
 
 #include "quic/core/quic_dispatcher.h"
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <utility>
@@ -14,7 +15,9 @@
 #include "quic/core/crypto/crypto_protocol.h"
 #include "quic/core/crypto/quic_random.h"
 #include "quic/core/quic_connection_id.h"
+#include "quic/core/quic_connection_id_worker_router.h"
 #include "quic/core/quic_error_codes.h"
+#include "quic/core/quic_load_balancer_codec.h"
 #include "quic/core/quic_session.h"
 #include "quic/core/quic_time_wait_list_manager.h"
 #include "quic/core/quic_types.h"
@@ -39,6 +42,18 @@ namespace {
 // Minimal INITIAL packet length sent by clients is 1200.
 const QuicPacketLength kMinClientInitialPacketLength = 1200;
 
+// While the session map uses the keyed hardware hash, the dispatcher scans a
+// sample of the map for colliding hashes every this many session insertions.
+constexpr size_t kSessionMapCollisionCheckInterval = 256;
+
+// Number of sessions examined by each collision scan.
+constexpr size_t kSessionMapCollisionSampleSize = 256;
+
+// Most repetitions of a single hash value tolerated in a sample. Distinct
+// connection IDs virtually never share a full 64-bit hash by accident, so
+// repeats beyond this mean the hash key has been recovered.
+constexpr size_t kSessionMapMaxIdenticalHashes = 2;
+
 // An alarm that informs the QuicDispatcher to delete old sessions.
 class DeleteSessionsAlarm : public QuicAlarm::DelegateWithoutContext {
  public:
@@ -337,6 +352,12 @@ QuicDispatcher::QuicDispatcher(
       crypto_config_(crypto_config),
       compressed_certs_cache_(
           QuicCompressedCertsCache::kQuicCompressedCertsCacheSize),
+      session_map_uses_fast_hash_(
+          GetQuicFlag(FLAGS_quic_dispatcher_use_fast_cid_hash) &&
+          QuicConnectionIdFastHasher::IsHardwareAccelerated()),
+      reference_counted_session_map_(
+          /*bucket_count=*/0,
+          SessionMapHasher(&fast_cid_hasher_, session_map_uses_fast_hash_)),
       helper_(std::move(helper)),
       session_helper_(std::move(session_helper)),
       alarm_factory_(std::move(alarm_factory)),
@@ -352,7 +373,8 @@ QuicDispatcher::QuicDispatcher(
           expected_server_connection_id_length),
       clear_stateless_reset_addresses_alarm_(alarm_factory_->CreateAlarm(
           new ClearStatelessResetAddressesAlarm(this))),
-      should_update_expected_server_connection_id_length_(false) {
+      should_update_expected_server_connection_id_length_(false),
+      retry_token_helper_(QuicRandom::GetInstance()) {
   QUIC_BUG_IF(quic_bug_12724_1, GetSupportedVersions().empty())
       << "Trying to create dispatcher without any supported versions";
   QUIC_DLOG(INFO) << "Created QuicDispatcher with versions: "
@@ -480,16 +502,43 @@ QuicConnectionId QuicDispatcher::ReplaceShortServerConnectionId(
     uint8_t expected_server_connection_id_length) const {
   QUICHE_DCHECK_LT(server_connection_id.length(),
                    expected_server_connection_id_length);
+  if (load_balancer_codec_ != nullptr) {
+    return load_balancer_codec_->GenerateConnectionIdFromSeed(
+        server_connection_id);
+  }
+  if (connection_id_worker_router_ != nullptr) {
+    return connection_id_worker_router_->CreateRoutableReplacementConnectionId(
+        server_connection_id, expected_server_connection_id_length);
+  }
   return QuicUtils::CreateReplacementConnectionId(
       server_connection_id, expected_server_connection_id_length);
 }
 
+void QuicDispatcher::set_load_balancer_codec(
+    const QuicLoadBalancerCodec* codec) {
+  load_balancer_codec_ = codec;
+  if (codec != nullptr) {
+    // Client-chosen connection IDs of any other length are replaced through
+    // MaybeReplaceServerConnectionId(), so every routable connection ID this
+    // dispatcher hands out carries the codec's server ID.
+    expected_server_connection_id_length_ = codec->connection_id_length();
+  }
+}
+
 QuicConnectionId QuicDispatcher::ReplaceLongServerConnectionId(
     const ParsedQuicVersion& /*version*/,
     const QuicConnectionId& server_connection_id,
     uint8_t expected_server_connection_id_length) const {
   QUICHE_DCHECK_GT(server_connection_id.length(),
                    expected_server_connection_id_length);
+  if (load_balancer_codec_ != nullptr) {
+    return load_balancer_codec_->GenerateConnectionIdFromSeed(
+        server_connection_id);
+  }
+  if (connection_id_worker_router_ != nullptr) {
+    return connection_id_worker_router_->CreateRoutableReplacementConnectionId(
+        server_connection_id, expected_server_connection_id_length);
+  }
   return QuicUtils::CreateReplacementConnectionId(
       server_connection_id, expected_server_connection_id_length);
 }
@@ -708,6 +757,16 @@ void QuicDispatcher::ProcessHeader(ReceivedPacketInfo* packet_info) {
   // Packet's connection ID is unknown.  Apply the validity checks.
   QuicPacketFate fate = ValidityChecks(*packet_info);
 
+  if (fate == kFateProcess && validate_retry_tokens_ &&
+      packet_info->retry_token.has_value() &&
+      !packet_info->retry_token->empty() &&
+      !ValidateRetryToken(*packet_info)) {
+    // Stateless fast path: the token was parsed from the long header
+    // already, so a forged one is rejected here on the stack, before any
+    // packet is buffered or any CHLO bytes are parsed.
+    fate = kFateDrop;
+  }
+
   if (fate == kFateProcess) {
     absl::optional<ParsedClientHello> parsed_chlo =
         TryExtractChloOrBufferEarlyPacket(*packet_info);
@@ -765,6 +824,31 @@ void QuicDispatcher::ProcessHeader(ReceivedPacketInfo* packet_info) {
   }
 }
 
+bool QuicDispatcher::GenerateRetryToken(const ReceivedPacketInfo& packet_info,
+                                        char* out) {
+  // Long enough for a client to complete its retried handshake attempt,
+  // short enough that a leaked token is of little use to an attacker.
+  const QuicTime::Delta kRetryTokenValidity = QuicTime::Delta::FromSeconds(30);
+  return retry_token_helper_.GenerateToken(
+      packet_info.peer_address, packet_info.destination_connection_id,
+      helper_->GetClock()->WallNow(), kRetryTokenValidity, out);
+}
+
+bool QuicDispatcher::ValidateRetryToken(
+    const ReceivedPacketInfo& packet_info) {
+  QuicConnectionId original_destination_connection_id;
+  if (retry_token_helper_.ValidateToken(
+          *packet_info.retry_token, packet_info.peer_address,
+          helper_->GetClock()->WallNow(),
+          &original_destination_connection_id)) {
+    ++num_retry_tokens_validated_;
+    return true;
+  }
+  ++num_retry_tokens_rejected_;
+  QUIC_CODE_COUNT(quic_dropped_invalid_retry_token);
+  return false;
+}
+
 absl::optional<ParsedClientHello>
 QuicDispatcher::TryExtractChloOrBufferEarlyPacket(
     const ReceivedPacketInfo& packet_info) {
@@ -933,6 +1017,18 @@ void QuicDispatcher::StopAcceptingNewConnections() {
   buffered_packets_.DiscardAllPackets();
 }
 
+void QuicDispatcher::OnServerOverloadSignal(bool overloaded) {
+  if (server_overloaded_ == overloaded) {
+    return;
+  }
+  server_overloaded_ = overloaded;
+  QUIC_DLOG(INFO) << "Server overload " << (overloaded ? "started" : "ended")
+                  << ", notifying " << NumSessions() << " sessions";
+  PerformActionOnActiveSessions([overloaded](QuicSession* session) {
+    session->OnServerOverload(overloaded);
+  });
+}
+
 void QuicDispatcher::PerformActionOnActiveSessions(
     std::function<void(QuicSession*)> operation) const {
   absl::flat_hash_set<QuicSession*> visited_session;
@@ -1048,6 +1144,17 @@ void QuicDispatcher::OnConnectionClosed(QuicConnectionId server_connection_id,
       << ", with details: " << error_details;
 
   QuicConnection* connection = it->second->connection();
+  {
+    // Fold the closing connection's traffic into the aggregate totals while
+    // its stats are still available.
+    const QuicConnectionStats& connection_stats = connection->GetStats();
+    ++stats_accumulator_.sessions_closed;
+    stats_accumulator_.bytes_sent += connection_stats.bytes_sent;
+    stats_accumulator_.bytes_received += connection_stats.bytes_received;
+    stats_accumulator_.packets_sent += connection_stats.packets_sent;
+    stats_accumulator_.packets_received += connection_stats.packets_received;
+    stats_accumulator_.packets_lost += connection_stats.packets_lost;
+  }
   if (ShouldDestroySessionAsynchronously()) {
     // Set up alarm to fire immediately to bring destruction of this session
     // out of current call stack.
@@ -1063,6 +1170,7 @@ void QuicDispatcher::OnConnectionClosed(QuicConnectionId server_connection_id,
     reference_counted_session_map_.erase(cid);
   }
   --num_sessions_in_session_map_;
+  PublishStatsSnapshot();
 }
 
 void QuicDispatcher::OnWriteBlocked(
@@ -1236,6 +1344,9 @@ void QuicDispatcher::ProcessBufferedChlos(size_t max_connections_to_create) {
           << server_connection_id;
     } else {
       ++num_sessions_in_session_map_;
+      ++stats_accumulator_.sessions_created;
+      PublishStatsSnapshot();
+      MaybeMonitorSessionMapCollisions();
     }
     DeliverPacketsToSession(packets, insertion_result.first->second.get());
   }
@@ -1345,8 +1456,15 @@ void QuicDispatcher::ProcessChlo(ParsedClientHello parsed_chlo,
         << packet_info->destination_connection_id;
   } else {
     ++num_sessions_in_session_map_;
+    ++stats_accumulator_.sessions_created;
+    PublishStatsSnapshot();
+    MaybeMonitorSessionMapCollisions();
   }
   session_ptr = insertion_result.first->second.get();
+  if (server_overloaded_) {
+    // Sessions created during overload start throttled.
+    session_ptr->OnServerOverload(true);
+  }
   std::list<BufferedPacket> packets =
       buffered_packets_.DeliverPackets(packet_info->destination_connection_id)
           .buffered_packets;
@@ -1418,6 +1536,15 @@ void QuicDispatcher::MaybeResetPacketsWithNoVersion(
       QUIC_CODE_COUNT(quic_drop_too_small_short_header_packets);
       return;
     }
+    if (load_balancer_codec_ != nullptr &&
+        !load_balancer_codec_->MatchesConfig(
+            packet_info.destination_connection_id)) {
+      // This backend only issues codec-generated connection IDs, so the
+      // packet was misrouted by the load balancer; a stateless reset here
+      // would wrongly tear down a connection owned by another backend.
+      QUIC_CODE_COUNT(quic_lb_drop_misrouted_stateless_reset);
+      return;
+    }
   } else {
     const size_t MinValidPacketLength =
         kPacketHeaderTypeSize + expected_server_connection_id_length_ +
@@ -1458,4 +1585,81 @@ size_t QuicDispatcher::NumSessions() const {
   return num_sessions_in_session_map_;
 }
 
+void QuicDispatcher::MaybeMonitorSessionMapCollisions() {
+  if (!session_map_uses_fast_hash_) {
+    return;
+  }
+  if (++session_insertions_since_collision_check_ <
+      kSessionMapCollisionCheckInterval) {
+    return;
+  }
+  session_insertions_since_collision_check_ = 0;
+  // Count how often individual hash values repeat across a sample of the
+  // map. flat_hash_map does not expose probe lengths, so this is the
+  // observable equivalent of anomalous bucket depth.
+  absl::flat_hash_map<size_t, size_t> hash_counts;
+  hash_counts.reserve(kSessionMapCollisionSampleSize);
+  const SessionMapHasher hasher(&fast_cid_hasher_, /*use_fast_hash=*/true);
+  size_t sampled = 0;
+  size_t max_identical_hashes = 0;
+  for (const auto& entry : reference_counted_session_map_) {
+    max_identical_hashes =
+        std::max(max_identical_hashes, ++hash_counts[hasher(entry.first)]);
+    if (++sampled >= kSessionMapCollisionSampleSize) {
+      break;
+    }
+  }
+  if (max_identical_hashes <= kSessionMapMaxIdenticalHashes) {
+    return;
+  }
+  QUIC_LOG(WARNING) << "Found " << max_identical_hashes
+                    << " sessions sharing one connection ID hash; falling "
+                       "back to SipHash for session map hashing.";
+  QUIC_CODE_COUNT(quic_dispatcher_fast_cid_hash_fallback);
+  FallBackToSipHashSessionMap();
+}
+
+void QuicDispatcher::FallBackToSipHashSessionMap() {
+  session_map_uses_fast_hash_ = false;
+  ReferenceCountedSessionMap siphash_map(
+      reference_counted_session_map_.size(),
+      SessionMapHasher(&fast_cid_hasher_, /*use_fast_hash=*/false));
+  for (const auto& entry : reference_counted_session_map_) {
+    siphash_map.insert(entry);
+  }
+  reference_counted_session_map_ = std::move(siphash_map);
+}
+
+void QuicDispatcher::PublishStatsSnapshot() {
+  stats_accumulator_.active_sessions = num_sessions_in_session_map_;
+  stats_accumulator_.retry_tokens_validated = num_retry_tokens_validated_;
+  stats_accumulator_.retry_tokens_rejected = num_retry_tokens_rejected_;
+  ++stats_accumulator_.version;
+
+  const int inactive = 1 - published_stats_buffer_.load(std::memory_order_relaxed);
+  // Odd sequence marks the copy in progress; readers of this buffer retry.
+  stats_buffer_sequences_[inactive].fetch_add(1, std::memory_order_release);
+  stats_buffers_[inactive] = stats_accumulator_;
+  stats_buffer_sequences_[inactive].fetch_add(1, std::memory_order_release);
+  published_stats_buffer_.store(inactive, std::memory_order_release);
+}
+
+QuicDispatcher::StatsSnapshot QuicDispatcher::GetStatsSnapshot() const {
+  while (true) {
+    const int index = published_stats_buffer_.load(std::memory_order_acquire);
+    const uint64_t sequence_before =
+        stats_buffer_sequences_[index].load(std::memory_order_acquire);
+    if (sequence_before % 2 != 0) {
+      // A publish into this buffer is in flight; the other buffer will be
+      // published momentarily.
+      continue;
+    }
+    StatsSnapshot snapshot = stats_buffers_[index];
+    if (stats_buffer_sequences_[index].load(std::memory_order_acquire) ==
+        sequence_before) {
+      return snapshot;
+    }
+  }
+}
+
 }  // namespace quic
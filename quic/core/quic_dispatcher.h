@@ -8,6 +8,7 @@
 #ifndef QUICHE_QUIC_CORE_QUIC_DISPATCHER_H_
 #define QUICHE_QUIC_CORE_QUIC_DISPATCHER_H_
 
+#include <atomic>
 #include <cstddef>
 #include <memory>
 #include <string>
@@ -17,6 +18,7 @@
 #include "absl/strings/string_view.h"
 #include "quic/core/crypto/quic_compressed_certs_cache.h"
 #include "quic/core/crypto/quic_random.h"
+#include "quic/core/crypto/quic_retry_token_helper.h"
 #include "quic/core/quic_blocked_writer_interface.h"
 #include "quic/core/quic_buffered_packet_store.h"
 #include "quic/core/quic_connection.h"
@@ -37,7 +39,9 @@ class QuicDispatcherPeer;
 }  // namespace test
 
 class QuicConfig;
+class QuicConnectionIdWorkerRouter;
 class QuicCryptoServerConfig;
+class QuicLoadBalancerCodec;
 
 class QUIC_NO_EXPORT QuicDispatcher
     : public QuicTimeWaitListManager::Visitor,
@@ -121,13 +125,65 @@ class QUIC_NO_EXPORT QuicDispatcher
   void OnConnectionAddedToTimeWaitList(
       QuicConnectionId server_connection_id) override;
 
+  // Hashes session map keys with the keyed hardware hash while it is
+  // trusted, and with SipHash (QuicConnectionId::Hash) otherwise. The choice
+  // is baked into the functor, so switching requires rebuilding the map; see
+  // FallBackToSipHashSessionMap().
+  class QUIC_NO_EXPORT SessionMapHasher {
+   public:
+    SessionMapHasher() : SessionMapHasher(nullptr, false) {}
+    SessionMapHasher(const QuicConnectionIdFastHasher* fast_hasher,
+                     bool use_fast_hash)
+        : fast_hasher_(fast_hasher), use_fast_hash_(use_fast_hash) {}
+
+    size_t operator()(const QuicConnectionId& connection_id) const {
+      return use_fast_hash_ ? fast_hasher_->Hash(connection_id)
+                            : connection_id.Hash();
+    }
+
+   private:
+    const QuicConnectionIdFastHasher* fast_hasher_;
+    bool use_fast_hash_;
+  };
+
   using ReferenceCountedSessionMap =
       absl::flat_hash_map<QuicConnectionId,
                           std::shared_ptr<QuicSession>,
-                          QuicConnectionIdHash>;
+                          SessionMapHasher>;
 
   size_t NumSessions() const;
 
+  // Aggregate dispatcher-wide statistics. Published through a double buffer
+  // so a monitoring thread can scrape them at O(1) cost regardless of the
+  // number of connections, instead of iterating the session map on the
+  // event loop thread.
+  struct QUIC_NO_EXPORT StatsSnapshot {
+    // Publication counter; also guards against torn reads, see
+    // GetStatsSnapshot().
+    uint64_t version = 0;
+    // Sessions currently in the session map.
+    size_t active_sessions = 0;
+    // Sessions ever created by / closed on this dispatcher.
+    uint64_t sessions_created = 0;
+    uint64_t sessions_closed = 0;
+    // Traffic totals folded in from the connection stats of sessions as
+    // they close; a live session's traffic appears here once it closes.
+    uint64_t bytes_sent = 0;
+    uint64_t bytes_received = 0;
+    uint64_t packets_sent = 0;
+    uint64_t packets_received = 0;
+    uint64_t packets_lost = 0;
+    // Stateless retry token fast path counters.
+    uint64_t retry_tokens_validated = 0;
+    uint64_t retry_tokens_rejected = 0;
+  };
+
+  // Returns the most recently published snapshot. The only method on this
+  // class which may be called from a thread other than the event loop
+  // thread; retries if a publish lands mid-copy, so the result is always
+  // internally consistent.
+  StatsSnapshot GetStatsSnapshot() const;
+
   // Deletes all sessions on the closed session list and clears the list.
   virtual void DeleteSessions();
 
@@ -155,6 +211,15 @@ class QUIC_NO_EXPORT QuicDispatcher
   // duck process or because explicitly configured.
   void StopAcceptingNewConnections();
 
+  // Called by the owner when its event loop enters or leaves overload, e.g.
+  // when the kernel reports dropped packets on the server socket. Forwards
+  // the signal to all active sessions, which throttle their inbound rate
+  // while overloaded, see QuicSession::OnServerOverload(). Sessions created
+  // while overloaded start throttled.
+  void OnServerOverloadSignal(bool overloaded);
+
+  bool server_overloaded() const { return server_overloaded_; }
+
   // Apply an operation for each session.
   void PerformActionOnActiveSessions(
       std::function<void(QuicSession*)> operation) const;
@@ -164,6 +229,30 @@ class QUIC_NO_EXPORT QuicDispatcher
 
   bool accept_new_connections() const { return accept_new_connections_; }
 
+  // If set, |router| is used to derive replacement server connection IDs
+  // whose first byte routes packets back to this process when several
+  // processes share a port via SO_REUSEPORT (see
+  // QuicUdpSocketApi::EnableConnectionIdReusePortRouting). |router| must
+  // outlive this dispatcher.
+  void set_connection_id_worker_router(
+      const QuicConnectionIdWorkerRouter* router) {
+    connection_id_worker_router_ = router;
+  }
+  const QuicConnectionIdWorkerRouter* connection_id_worker_router() const {
+    return connection_id_worker_router_;
+  }
+
+  // If set, |codec| generates every replacement server connection ID, so
+  // that a QUIC-LB compliant load balancer can route packets for existing
+  // connections to this backend. The dispatcher adopts the codec's
+  // connection ID length as its expected length. |codec| must outlive this
+  // dispatcher and takes precedence over the worker router above.
+  void set_load_balancer_codec(const QuicLoadBalancerCodec* codec);
+
+  const QuicLoadBalancerCodec* load_balancer_codec() const {
+    return load_balancer_codec_;
+  }
+
  protected:
   // Creates a QUIC session based on the given information.
   // |alpn| is the selected ALPN from |parsed_chlo.alpns|.
@@ -372,6 +461,29 @@ class QUIC_NO_EXPORT QuicDispatcher
   virtual void MaybeResetPacketsWithNoVersion(
       const quic::ReceivedPacketInfo& packet_info);
 
+  // If true, Initial packets carrying a retry token that does not validate
+  // for the client address are dropped before any packet is buffered or any
+  // CHLO bytes are parsed.  Off by default: a client may legitimately
+  // present an address token issued in a NEW_TOKEN frame by a previous
+  // incarnation of this server, which this dispatcher cannot validate.
+  void SetValidateRetryTokens(bool validate_retry_tokens) {
+    validate_retry_tokens_ = validate_retry_tokens;
+  }
+
+  // Writes a retry token binding |packet_info|'s client address and
+  // destination connection ID into |out|, which must have room for
+  // QuicRetryTokenHelper::kTokenLength bytes.  For use by subclasses that
+  // send RETRY packets.  Allocation free.
+  bool GenerateRetryToken(const ReceivedPacketInfo& packet_info, char* out);
+
+  // Counters for the stateless token fast path, for export by server stats.
+  uint64_t num_retry_tokens_validated() const {
+    return num_retry_tokens_validated_;
+  }
+  uint64_t num_retry_tokens_rejected() const {
+    return num_retry_tokens_rejected_;
+  }
+
  private:
   friend class test::QuicDispatcherPeer;
 
@@ -398,6 +510,25 @@ class QUIC_NO_EXPORT QuicDispatcher
   // Returns true if |version| is a supported protocol version.
   bool IsSupportedVersion(const ParsedQuicVersion version);
 
+  // Validates |packet_info|'s retry token against its client address on the
+  // stack, with no per-connection state, and updates the token counters.
+  bool ValidateRetryToken(const ReceivedPacketInfo& packet_info);
+
+  // Copies the stats accumulator into the inactive stats buffer and flips
+  // the published index. O(1); called on the event loop thread whenever a
+  // session is created or closed.
+  void PublishStatsSnapshot();
+
+  // Called after each session insertion while the fast hash is active.
+  // Periodically samples the session map for connection IDs whose keyed
+  // hashes collide, which only happens when an attacker has recovered the
+  // hash key, and falls back to SipHash if any are found.
+  void MaybeMonitorSessionMapCollisions();
+
+  // Rebuilds the session map with SipHash-based hashing. One-way: the fast
+  // hash is not trusted again for the lifetime of this dispatcher.
+  void FallBackToSipHashSessionMap();
+
   const QuicConfig* config_;
 
   const QuicCryptoServerConfig* crypto_config_;
@@ -408,6 +539,18 @@ class QUIC_NO_EXPORT QuicDispatcher
   // The list of connections waiting to write.
   WriteBlockedList write_blocked_list_;
 
+  // Keyed hardware hash for session map lookups, enabled by
+  // FLAGS_quic_dispatcher_use_fast_cid_hash on builds that support it.
+  // Declared before the session map so the map's hasher can refer to it.
+  QuicConnectionIdFastHasher fast_cid_hasher_;
+
+  // Whether the session map currently hashes with |fast_cid_hasher_|. Unset
+  // permanently by FallBackToSipHashSessionMap().
+  bool session_map_uses_fast_hash_;
+
+  // Number of session insertions since the last collision scan.
+  size_t session_insertions_since_collision_check_ = 0;
+
   ReferenceCountedSessionMap reference_counted_session_map_;
 
   // Entity that manages connection_ids in time wait state.
@@ -454,6 +597,10 @@ class QUIC_NO_EXPORT QuicDispatcher
   // connections), false otherwise.
   bool accept_new_connections_;
 
+  // True while the owner's event loop has reported overload, see
+  // OnServerOverloadSignal().
+  bool server_overloaded_ = false;
+
   // If false, the dispatcher follows the IETF spec and rejects packets with
   // invalid destination connection IDs lengths below 64 bits.
   // If true they are allowed.
@@ -478,8 +625,34 @@ class QUIC_NO_EXPORT QuicDispatcher
   // destination connection ID length of all IETF long headers.
   bool should_update_expected_server_connection_id_length_;
 
+  // If non-null, used to derive replacement server connection IDs that
+  // encode this process's worker index. Not owned.
+  const QuicConnectionIdWorkerRouter* connection_id_worker_router_ = nullptr;
+
+  // If non-null, generates replacement server connection IDs that embed
+  // this backend's QUIC-LB server ID. Not owned.
+  const QuicLoadBalancerCodec* load_balancer_codec_ = nullptr;
+
   const bool use_recent_reset_addresses_ =
       GetQuicRestartFlag(quic_use_recent_reset_addresses);
+
+  // Issues and validates stateless retry tokens, keyed once per process.
+  QuicRetryTokenHelper retry_token_helper_;
+
+  // Whether the stateless token fast path in ProcessHeader is enabled.
+  bool validate_retry_tokens_ = false;
+
+  uint64_t num_retry_tokens_validated_ = 0;
+  uint64_t num_retry_tokens_rejected_ = 0;
+
+  // Running stats totals, written only by the event loop thread.
+  StatsSnapshot stats_accumulator_;
+  // Double buffer the accumulator is published through. Each buffer's
+  // sequence number is odd while a copy into it is in progress, so a reader
+  // that observes an odd or changed sequence retries its copy.
+  StatsSnapshot stats_buffers_[2];
+  std::atomic<uint64_t> stats_buffer_sequences_[2] = {{0}, {0}};
+  std::atomic<int> published_stats_buffer_{0};
 };
 
 }  // namespace quic
@@ -915,6 +915,49 @@ TEST_P(QuicDispatcherTestAllVersions, TimeWaitListManager) {
   ProcessPacket(client_address, connection_id, true, "data");
 }
 
+TEST_P(QuicDispatcherTestAllVersions, StatsSnapshotTracksSessionLifecycle) {
+  CreateTimeWaitListManager();
+
+  QuicDispatcher::StatsSnapshot snapshot = dispatcher_->GetStatsSnapshot();
+  EXPECT_EQ(0u, snapshot.sessions_created);
+  EXPECT_EQ(0u, snapshot.active_sessions);
+
+  QuicSocketAddress client_address(QuicIpAddress::Loopback4(), 1);
+  QuicConnectionId connection_id = TestConnectionId(1);
+  EXPECT_CALL(*dispatcher_, CreateQuicSession(connection_id, _, client_address,
+                                              Eq(ExpectedAlpn()), _, _))
+      .WillOnce(Return(ByMove(CreateSession(
+          dispatcher_.get(), config_, connection_id, client_address,
+          &mock_helper_, &mock_alarm_factory_, &crypto_config_,
+          QuicDispatcherPeer::GetCache(dispatcher_.get()), &session1_))));
+  EXPECT_CALL(*reinterpret_cast<MockQuicConnection*>(session1_->connection()),
+              ProcessUdpPacket(_, _, _))
+      .WillOnce(WithArg<2>(Invoke([this](const QuicEncryptedPacket& packet) {
+        ValidatePacket(TestConnectionId(1), packet);
+      })));
+  EXPECT_CALL(*dispatcher_,
+              ShouldCreateOrBufferPacketForConnection(
+                  ReceivedPacketInfoConnectionIdEquals(TestConnectionId(1))));
+  ProcessFirstFlight(client_address, connection_id);
+
+  const uint64_t version_after_create =
+      dispatcher_->GetStatsSnapshot().version;
+  snapshot = dispatcher_->GetStatsSnapshot();
+  EXPECT_EQ(1u, snapshot.sessions_created);
+  EXPECT_EQ(1u, snapshot.active_sessions);
+  EXPECT_EQ(0u, snapshot.sessions_closed);
+
+  session1_->connection()->CloseConnection(
+      QUIC_PEER_GOING_AWAY, "stats snapshot test",
+      ConnectionCloseBehavior::SILENT_CLOSE);
+
+  snapshot = dispatcher_->GetStatsSnapshot();
+  EXPECT_EQ(1u, snapshot.sessions_created);
+  EXPECT_EQ(1u, snapshot.sessions_closed);
+  EXPECT_EQ(0u, snapshot.active_sessions);
+  EXPECT_GT(snapshot.version, version_after_create);
+}
+
 TEST_P(QuicDispatcherTestAllVersions, NoVersionPacketToTimeWaitListManager) {
   CreateTimeWaitListManager();
 
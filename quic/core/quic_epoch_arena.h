@@ -0,0 +1,116 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// A region allocator for transient, per-epoch objects such as frames created
+// while processing a single UDP packet. Unlike QuicOneBlockArena, objects are
+// not individually owned: everything allocated from the arena lives until the
+// next Reset(), at which point destructors are run (in reverse allocation
+// order) and the memory is reclaimed in bulk. Allocations are served from an
+// inline block of |InlineSize| bytes and spill over to heap blocks when the
+// inline block is exhausted, so the arena never fails.
+
+#ifndef QUICHE_QUIC_CORE_QUIC_EPOCH_ARENA_H_
+#define QUICHE_QUIC_CORE_QUIC_EPOCH_ARENA_H_
+
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "quic/platform/api/quic_logging.h"
+
+namespace quic {
+
+template <uint32_t InlineSize>
+class QUIC_EXPORT_PRIVATE QuicEpochArena {
+  static const uint32_t kMaxAlign = 8;
+
+ public:
+  QuicEpochArena() : offset_(0) {}
+  QuicEpochArena(const QuicEpochArena&) = delete;
+  QuicEpochArena& operator=(const QuicEpochArena&) = delete;
+  ~QuicEpochArena() { Reset(); }
+
+  // Instantiates an object of type |T| with |args| inside the current epoch.
+  // The returned pointer is valid until the next call to Reset().
+  template <typename T, typename... Args>
+  T* New(Args&&... args) {
+    static_assert(alignof(T) <= kMaxAlign,
+                  "Objects in the arena must not be over-aligned.");
+    void* buf = Allocate(AlignedSize<T>());
+    T* object = new (buf) T(std::forward<Args>(args)...);
+    if (!std::is_trivially_destructible<T>::value) {
+      destructors_.push_back(
+          Destructor{buf, [](void* ptr) { static_cast<T*>(ptr)->~T(); }});
+    }
+    return object;
+  }
+
+  // Ends the current epoch: runs pending destructors in reverse allocation
+  // order, releases overflow blocks and makes the whole inline block
+  // available again.
+  void Reset() {
+    for (auto it = destructors_.rbegin(); it != destructors_.rend(); ++it) {
+      it->destroy(it->object);
+    }
+    destructors_.clear();
+    overflow_blocks_.clear();
+    offset_ = 0;
+    bytes_allocated_ = 0;
+  }
+
+  // Total bytes handed out since the last Reset(). Overflow allocations are
+  // counted at their requested (aligned) size.
+  size_t bytes_allocated() const { return bytes_allocated_; }
+
+  // True if any allocation since the last Reset() did not fit in the inline
+  // block.
+  bool overflowed() const { return !overflow_blocks_.empty(); }
+
+ private:
+  struct Destructor {
+    void* object;
+    void (*destroy)(void*);
+  };
+
+  void* Allocate(uint32_t aligned_size) {
+    bytes_allocated_ += aligned_size;
+    if (QUIC_PREDICT_TRUE(aligned_size <= InlineSize &&
+                          offset_ <= InlineSize - aligned_size)) {
+      void* buf = &storage_[offset_];
+      offset_ += aligned_size;
+      return buf;
+    }
+    // Inline space exhausted (or the object is larger than the whole block):
+    // fall back to a heap block owned by the arena for this epoch.
+    overflow_blocks_.push_back(std::make_unique<char[]>(aligned_size));
+    return overflow_blocks_.back().get();
+  }
+
+  // Returns the size of |T| aligned up to |kMaxAlign|.
+  template <typename T>
+  static inline uint32_t AlignedSize() {
+    return ((sizeof(T) + (kMaxAlign - 1)) / kMaxAlign) * kMaxAlign;
+  }
+
+  // Inline storage. As in QuicOneBlockArena, the value '8' must be coded
+  // explicitly into the alignment declaration for MSVC.
+  alignas(8) char storage_[InlineSize];
+  // Current offset into the inline storage.
+  uint32_t offset_;
+  // Heap blocks for allocations which did not fit inline; freed on Reset().
+  std::vector<std::unique_ptr<char[]>> overflow_blocks_;
+  // Destructors for non-trivially-destructible objects in this epoch.
+  std::vector<Destructor> destructors_;
+  size_t bytes_allocated_ = 0;
+};
+
+// Sized for the transient frames created while processing one UDP packet; a
+// full ack frame plus a handful of stream/control frames fit comfortably.
+using QuicTransientFrameArena = QuicEpochArena<4096>;
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_QUIC_EPOCH_ARENA_H_
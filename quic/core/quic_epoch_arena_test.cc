@@ -0,0 +1,90 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/quic_epoch_arena.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "quic/core/frames/quic_ack_frame.h"
+#include "quic/platform/api/quic_test.h"
+
+namespace quic {
+namespace {
+
+static const uint32_t kArenaSize = 1024;
+
+using TestArena = QuicEpochArena<kArenaSize>;
+
+TEST(QuicEpochArenaTest, AllocateSuccess) {
+  TestArena arena;
+  int* value = arena.New<int>(42);
+  EXPECT_EQ(42, *value);
+  EXPECT_FALSE(arena.overflowed());
+}
+
+TEST(QuicEpochArenaTest, PointersStayValidUntilReset) {
+  TestArena arena;
+  std::vector<uint64_t*> values;
+  for (uint64_t i = 0; i < 32; ++i) {
+    values.push_back(arena.New<uint64_t>(i));
+  }
+  for (uint64_t i = 0; i < 32; ++i) {
+    EXPECT_EQ(i, *values[i]);
+  }
+}
+
+TEST(QuicEpochArenaTest, OverflowFallsBackToHeap) {
+  TestArena arena;
+  // Each allocation is 8-byte aligned, so this exceeds the inline block.
+  for (int i = 0; i < 200; ++i) {
+    *arena.New<uint64_t>(7) = i;
+  }
+  EXPECT_TRUE(arena.overflowed());
+  arena.Reset();
+  EXPECT_FALSE(arena.overflowed());
+  EXPECT_EQ(0u, arena.bytes_allocated());
+}
+
+TEST(QuicEpochArenaTest, ResetRunsDestructors) {
+  struct DestructionCounter {
+    explicit DestructionCounter(int* counter) : counter(counter) {}
+    ~DestructionCounter() { ++*counter; }
+    int* counter;
+  };
+
+  int destroyed = 0;
+  TestArena arena;
+  arena.New<DestructionCounter>(&destroyed);
+  arena.New<DestructionCounter>(&destroyed);
+  EXPECT_EQ(0, destroyed);
+  arena.Reset();
+  EXPECT_EQ(2, destroyed);
+  // A second reset must not run destructors again.
+  arena.Reset();
+  EXPECT_EQ(2, destroyed);
+}
+
+TEST(QuicEpochArenaTest, HoldsNonTrivialFrames) {
+  QuicTransientFrameArena arena;
+  QuicAckFrame* frame = arena.New<QuicAckFrame>();
+  frame->packets.AddRange(QuicPacketNumber(1), QuicPacketNumber(10));
+  EXPECT_EQ(9u, frame->packets.NumPacketsSlow());
+  arena.Reset();
+}
+
+TEST(QuicEpochArenaTest, ReusableAcrossEpochs) {
+  TestArena arena;
+  for (int epoch = 0; epoch < 3; ++epoch) {
+    std::string* value = arena.New<std::string>("epoch");
+    EXPECT_EQ("epoch", *value);
+    EXPECT_GT(arena.bytes_allocated(), 0u);
+    arena.Reset();
+    EXPECT_EQ(0u, arena.bytes_allocated());
+  }
+}
+
+}  // namespace
+}  // namespace quic
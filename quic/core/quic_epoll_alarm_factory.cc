@@ -4,36 +4,204 @@
 
 #include "quic/core/quic_epoll_alarm_factory.h"
 
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <new>
 #include <type_traits>
+#include <utility>
 
 #include "quic/core/quic_arena_scoped_ptr.h"
 
 namespace quic {
+
+// QuicCoarseAlarmWheels collapses coarse-precision alarms into one epoll
+// server registration per quantized deadline. Each coarse alarm embeds an
+// Entry and is linked into the bucket covering its deadline; the bucket
+// itself is the only object registered with the epoll server's alarm map.
+// Deadlines are rounded up to the end of their precision interval, so a
+// coarse alarm fires up to one interval late but never early.
+class QuicCoarseAlarmWheels {
+ public:
+  class Bucket;
+
+  // Intrusive hook linking one coarse alarm into its deadline bucket. The
+  // owner overrides OnBucketExpired(), which is invoked once when the
+  // bucket's deadline passes; the entry is unlinked before the call.
+  class Entry {
+   public:
+    virtual ~Entry() = default;
+
+   protected:
+    virtual void OnBucketExpired() = 0;
+
+   private:
+    friend class QuicCoarseAlarmWheels;
+
+    Entry* prev_ = nullptr;
+    Entry* next_ = nullptr;
+    Bucket* bucket_ = nullptr;
+  };
+
+  explicit QuicCoarseAlarmWheels(QuicEpollServer* epoll_server)
+      : epoll_server_(epoll_server) {}
+
+  // Links |entry| into the bucket covering |deadline_us|, creating the
+  // bucket and its epoll server registration if this is the first entry in
+  // the interval. |entry| must not currently be linked.
+  void Add(Entry* entry, int64_t deadline_us, QuicTime::Delta precision);
+
+  // Unlinks |entry| from its bucket. No-op if |entry| is not linked. An
+  // emptied bucket stays registered and is reclaimed when it fires.
+  void Remove(Entry* entry);
+
+ private:
+  void FireBucket(Bucket* bucket);
+
+  QuicEpollServer* epoll_server_;  // Not owned.
+
+  // Active buckets keyed by quantized deadline in microseconds. Buckets of
+  // different precision classes that quantize to the same deadline are
+  // shared.
+  std::map<int64_t, std::unique_ptr<Bucket>> buckets_;
+};
+
+// The per-interval epoll server registration. Holds the intrusive list of
+// entries expiring at |deadline_us_|.
+class QuicCoarseAlarmWheels::Bucket : public QuicEpollAlarmBase {
+ public:
+  using int64_epoll = decltype(QuicEpollAlarmBase().OnAlarm());
+
+  Bucket(QuicCoarseAlarmWheels* wheels, int64_t deadline_us)
+      : wheels_(wheels), deadline_us_(deadline_us) {}
+
+  int64_epoll OnAlarm() override {
+    QuicEpollAlarmBase::OnAlarm();
+    // FireBucket() destroys this bucket; no member access past this point.
+    wheels_->FireBucket(this);
+    return 0;
+  }
+
+  int64_t deadline_us() const { return deadline_us_; }
+
+ private:
+  friend class QuicCoarseAlarmWheels;
+
+  QuicCoarseAlarmWheels* wheels_;  // Not owned.
+  int64_t deadline_us_;
+
+  Entry* head_ = nullptr;
+  Entry* tail_ = nullptr;
+};
+
+void QuicCoarseAlarmWheels::Add(Entry* entry, int64_t deadline_us,
+                                QuicTime::Delta precision) {
+  QUICHE_DCHECK(entry->bucket_ == nullptr);
+  const int64_t precision_us = precision.ToMicroseconds();
+  QUICHE_DCHECK_GT(precision_us, 0);
+  // Round up to the end of the interval so the alarm never fires early.
+  const int64_t bucket_deadline_us =
+      ((deadline_us + precision_us - 1) / precision_us) * precision_us;
+  std::unique_ptr<Bucket>& bucket = buckets_[bucket_deadline_us];
+  if (bucket == nullptr) {
+    bucket = std::make_unique<Bucket>(this, bucket_deadline_us);
+    epoll_server_->RegisterAlarm(bucket_deadline_us, bucket.get());
+  }
+  entry->bucket_ = bucket.get();
+  entry->prev_ = bucket->tail_;
+  entry->next_ = nullptr;
+  if (bucket->tail_ != nullptr) {
+    bucket->tail_->next_ = entry;
+  } else {
+    bucket->head_ = entry;
+  }
+  bucket->tail_ = entry;
+}
+
+void QuicCoarseAlarmWheels::Remove(Entry* entry) {
+  Bucket* bucket = entry->bucket_;
+  if (bucket == nullptr) {
+    return;
+  }
+  if (entry->prev_ != nullptr) {
+    entry->prev_->next_ = entry->next_;
+  } else {
+    bucket->head_ = entry->next_;
+  }
+  if (entry->next_ != nullptr) {
+    entry->next_->prev_ = entry->prev_;
+  } else {
+    bucket->tail_ = entry->prev_;
+  }
+  entry->prev_ = nullptr;
+  entry->next_ = nullptr;
+  entry->bucket_ = nullptr;
+}
+
+void QuicCoarseAlarmWheels::FireBucket(Bucket* bucket) {
+  auto it = buckets_.find(bucket->deadline_us());
+  QUICHE_DCHECK(it != buckets_.end() && it->second.get() == bucket);
+  // Detach the bucket from the map before dispatching so entries re-added
+  // from a callback land in a fresh registration.
+  std::unique_ptr<Bucket> firing_bucket = std::move(it->second);
+  buckets_.erase(it);
+  while (bucket->head_ != nullptr) {
+    Entry* entry = bucket->head_;
+    Remove(entry);
+    entry->OnBucketExpired();
+  }
+}
+
 namespace {
 
 class QuicEpollAlarm : public QuicAlarm {
  public:
   QuicEpollAlarm(QuicEpollServer* epoll_server,
+                 QuicCoarseAlarmWheels* coarse_wheels,
                  QuicArenaScopedPtr<QuicAlarm::Delegate> delegate)
       : QuicAlarm(std::move(delegate)),
         epoll_server_(epoll_server),
-        epoll_alarm_impl_(this) {}
+        coarse_wheels_(coarse_wheels),
+        epoll_alarm_impl_(this),
+        wheel_entry_impl_(this) {}
+
+  // Heap-allocated alarms are recycled through a per-thread pool of
+  // fixed-size blocks, so steady-state alarm churn does not touch malloc.
+  // Arena-allocated alarms (see CreateAlarm() below) use the placement form
+  // and are unaffected.
+  static void* operator new(size_t size);
+  static void operator delete(void* block, size_t size);
+  static void* operator new(size_t /*size*/, void* block) { return block; }
+  static void operator delete(void* /*block*/, void* /*placement*/) {}
 
  protected:
   void SetImpl() override {
     QUICHE_DCHECK(deadline().IsInitialized());
-    epoll_server_->RegisterAlarm(
-        (deadline() - QuicTime::Zero()).ToMicroseconds(), &epoll_alarm_impl_);
+    const int64_t epoll_deadline =
+        (deadline() - QuicTime::Zero()).ToMicroseconds();
+    if (precision() != Precision::kExact) {
+      coarse_wheels_->Add(&wheel_entry_impl_, epoll_deadline,
+                          precision_delta());
+      return;
+    }
+    epoll_server_->RegisterAlarm(epoll_deadline, &epoll_alarm_impl_);
   }
 
   void CancelImpl() override {
     QUICHE_DCHECK(!deadline().IsInitialized());
+    coarse_wheels_->Remove(&wheel_entry_impl_);
     epoll_alarm_impl_.UnregisterIfRegistered();
   }
 
   void UpdateImpl() override {
     QUICHE_DCHECK(deadline().IsInitialized());
     int64_t epoll_deadline = (deadline() - QuicTime::Zero()).ToMicroseconds();
+    if (precision() != Precision::kExact) {
+      coarse_wheels_->Remove(&wheel_entry_impl_);
+      coarse_wheels_->Add(&wheel_entry_impl_, epoll_deadline,
+                          precision_delta());
+      return;
+    }
     if (epoll_alarm_impl_.registered()) {
       epoll_alarm_impl_.ReregisterAlarm(epoll_deadline);
     } else {
@@ -60,19 +228,73 @@ class QuicEpollAlarm : public QuicAlarm {
     QuicEpollAlarm* alarm_;
   };
 
+  class WheelEntryImpl : public QuicCoarseAlarmWheels::Entry {
+   public:
+    explicit WheelEntryImpl(QuicEpollAlarm* alarm) : alarm_(alarm) {}
+
+   protected:
+    void OnBucketExpired() override { alarm_->Fire(); }
+
+   private:
+    QuicEpollAlarm* alarm_;
+  };
+
   QuicEpollServer* epoll_server_;
+  QuicCoarseAlarmWheels* coarse_wheels_;  // Not owned.
   EpollAlarmImpl epoll_alarm_impl_;
+  WheelEntryImpl wheel_entry_impl_;
 };
 
+// Bounded per-thread free list of alarm-sized blocks. Blocks are recycled in
+// LIFO order to keep recently freed (cache-warm) memory in use; once the pool
+// is full, further frees fall through to the global allocator.
+class AlarmBlockPool {
+ public:
+  static constexpr size_t kCapacity = 256;
+
+  static AlarmBlockPool* Get() {
+    static thread_local AlarmBlockPool* pool = new AlarmBlockPool();
+    return pool;
+  }
+
+  void* Allocate(size_t size) {
+    if (size == sizeof(QuicEpollAlarm) && num_free_ > 0) {
+      return free_blocks_[--num_free_];
+    }
+    return ::operator new(size);
+  }
+
+  void Release(void* block, size_t size) {
+    if (size == sizeof(QuicEpollAlarm) && num_free_ < kCapacity) {
+      free_blocks_[num_free_++] = block;
+      return;
+    }
+    ::operator delete(block);
+  }
+
+ private:
+  void* free_blocks_[kCapacity];
+  size_t num_free_ = 0;
+};
+
+void* QuicEpollAlarm::operator new(size_t size) {
+  return AlarmBlockPool::Get()->Allocate(size);
+}
+
+void QuicEpollAlarm::operator delete(void* block, size_t size) {
+  AlarmBlockPool::Get()->Release(block, size);
+}
+
 }  // namespace
 
 QuicEpollAlarmFactory::QuicEpollAlarmFactory(QuicEpollServer* epoll_server)
-    : epoll_server_(epoll_server) {}
+    : epoll_server_(epoll_server),
+      coarse_wheels_(std::make_unique<QuicCoarseAlarmWheels>(epoll_server)) {}
 
 QuicEpollAlarmFactory::~QuicEpollAlarmFactory() = default;
 
 QuicAlarm* QuicEpollAlarmFactory::CreateAlarm(QuicAlarm::Delegate* delegate) {
-  return new QuicEpollAlarm(epoll_server_,
+  return new QuicEpollAlarm(epoll_server_, coarse_wheels_.get(),
                             QuicArenaScopedPtr<QuicAlarm::Delegate>(delegate));
 }
 
@@ -80,10 +302,11 @@ QuicArenaScopedPtr<QuicAlarm> QuicEpollAlarmFactory::CreateAlarm(
     QuicArenaScopedPtr<QuicAlarm::Delegate> delegate,
     QuicConnectionArena* arena) {
   if (arena != nullptr) {
-    return arena->New<QuicEpollAlarm>(epoll_server_, std::move(delegate));
+    return arena->New<QuicEpollAlarm>(epoll_server_, coarse_wheels_.get(),
+                                      std::move(delegate));
   }
-  return QuicArenaScopedPtr<QuicAlarm>(
-      new QuicEpollAlarm(epoll_server_, std::move(delegate)));
+  return QuicArenaScopedPtr<QuicAlarm>(new QuicEpollAlarm(
+      epoll_server_, coarse_wheels_.get(), std::move(delegate)));
 }
 
 }  // namespace quic
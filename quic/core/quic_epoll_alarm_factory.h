@@ -5,6 +5,8 @@
 #ifndef QUICHE_QUIC_CORE_QUIC_EPOLL_ALARM_FACTORY_H_
 #define QUICHE_QUIC_CORE_QUIC_EPOLL_ALARM_FACTORY_H_
 
+#include <memory>
+
 #include "quic/core/quic_alarm.h"
 #include "quic/core/quic_alarm_factory.h"
 #include "quic/core/quic_one_block_arena.h"
@@ -12,6 +14,10 @@
 
 namespace quic {
 
+// Shared timer wheels for alarms with a coarse precision class. Defined in
+// the .cc file.
+class QuicCoarseAlarmWheels;
+
 // Creates alarms that use the supplied EpollServer for timing and firing.
 class QUIC_EXPORT_PRIVATE QuicEpollAlarmFactory : public QuicAlarmFactory {
  public:
@@ -21,6 +27,12 @@ class QUIC_EXPORT_PRIVATE QuicEpollAlarmFactory : public QuicAlarmFactory {
   ~QuicEpollAlarmFactory() override;
 
   // QuicAlarmFactory interface.
+  //
+  // Alarms with a coarse precision class (see QuicAlarm::set_precision) are
+  // not entered into the epoll server's per-deadline alarm map. Instead, all
+  // coarse alarms expiring within the same precision interval share a single
+  // epoll server registration, so a server with millions of idle-timeout
+  // style alarms keeps only one timer heap entry per active interval.
   QuicAlarm* CreateAlarm(QuicAlarm::Delegate* delegate) override;
   QuicArenaScopedPtr<QuicAlarm> CreateAlarm(
       QuicArenaScopedPtr<QuicAlarm::Delegate> delegate,
@@ -28,6 +40,10 @@ class QUIC_EXPORT_PRIVATE QuicEpollAlarmFactory : public QuicAlarmFactory {
 
  private:
   QuicEpollServer* epoll_server_;  // Not owned.
+
+  // Buckets coarse alarms by quantized deadline. Must outlive the alarms
+  // created by this factory, as must |epoll_server_|.
+  std::unique_ptr<QuicCoarseAlarmWheels> coarse_wheels_;
 };
 
 }  // namespace quic
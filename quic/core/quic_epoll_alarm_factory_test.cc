@@ -4,6 +4,8 @@
 
 #include "quic/core/quic_epoll_alarm_factory.h"
 
+#include <memory>
+
 #include "quic/platform/api/quic_epoll_test_tools.h"
 #include "quic/platform/api/quic_test.h"
 #include "net/quic/platform/impl/quic_epoll_clock.h"
@@ -136,6 +138,105 @@ TEST_P(QuicEpollAlarmFactoryTest, CreateAlarmAndUpdate) {
   EXPECT_FALSE(alarm->IsSet());
 }
 
+TEST_P(QuicEpollAlarmFactoryTest, CoarseAlarmFiresAtIntervalBoundary) {
+  QuicArenaScopedPtr<TestDelegate> delegate =
+      QuicArenaScopedPtr<TestDelegate>(new TestDelegate());
+  TestDelegate* unowned_delegate = delegate.get();
+  QuicArenaScopedPtr<QuicAlarm> alarm(
+      alarm_factory_.CreateAlarm(std::move(delegate), GetArenaParam()));
+  alarm->set_precision(QuicAlarm::Precision::kCoarse10ms);
+
+  // The fake epoll server starts at time zero, so intervals are aligned with
+  // the start time. A deadline 3ms into a 10ms interval fires at the end of
+  // the interval, not at the deadline.
+  QuicTime::Delta delta = QuicTime::Delta::FromMilliseconds(3);
+  alarm->Set(clock_.Now() + delta);
+
+  epoll_server_.AdvanceByExactlyAndCallCallbacks(delta.ToMicroseconds());
+  EXPECT_FALSE(unowned_delegate->fired());
+
+  epoll_server_.AdvanceByExactlyAndCallCallbacks(
+      (QuicTime::Delta::FromMilliseconds(10) - delta).ToMicroseconds());
+  EXPECT_TRUE(unowned_delegate->fired());
+}
+
+TEST_P(QuicEpollAlarmFactoryTest, CoarseAlarmsShareOneRegistration) {
+  // Coarse alarms expiring within the same interval share a single epoll
+  // server alarm registration; an exact alarm gets its own.
+  QuicArenaScopedPtr<QuicAlarm> alarm1(alarm_factory_.CreateAlarm(
+      QuicArenaScopedPtr<QuicAlarm::Delegate>(new TestDelegate()),
+      GetArenaParam()));
+  QuicArenaScopedPtr<QuicAlarm> alarm2(alarm_factory_.CreateAlarm(
+      QuicArenaScopedPtr<QuicAlarm::Delegate>(new TestDelegate()),
+      GetArenaParam()));
+  QuicArenaScopedPtr<QuicAlarm> exact_alarm(alarm_factory_.CreateAlarm(
+      QuicArenaScopedPtr<QuicAlarm::Delegate>(new TestDelegate()),
+      GetArenaParam()));
+  alarm1->set_precision(QuicAlarm::Precision::kCoarse1s);
+  alarm2->set_precision(QuicAlarm::Precision::kCoarse1s);
+
+  alarm1->Set(clock_.Now() + QuicTime::Delta::FromMilliseconds(100));
+  alarm2->Set(clock_.Now() + QuicTime::Delta::FromMilliseconds(700));
+  EXPECT_EQ(1u, epoll_server_.NumberOfAlarms());
+
+  exact_alarm->Set(clock_.Now() + QuicTime::Delta::FromMilliseconds(100));
+  EXPECT_EQ(2u, epoll_server_.NumberOfAlarms());
+}
+
+TEST_P(QuicEpollAlarmFactoryTest, CoarseAlarmCancel) {
+  QuicArenaScopedPtr<TestDelegate> delegate =
+      QuicArenaScopedPtr<TestDelegate>(new TestDelegate());
+  TestDelegate* unowned_delegate = delegate.get();
+  QuicArenaScopedPtr<QuicAlarm> alarm(
+      alarm_factory_.CreateAlarm(std::move(delegate), GetArenaParam()));
+  alarm->set_precision(QuicAlarm::Precision::kCoarse10ms);
+
+  alarm->Set(clock_.Now() + QuicTime::Delta::FromMilliseconds(3));
+  alarm->Cancel();
+
+  epoll_server_.AdvanceByExactlyAndCallCallbacks(
+      QuicTime::Delta::FromMilliseconds(20).ToMicroseconds());
+  EXPECT_FALSE(unowned_delegate->fired());
+}
+
+TEST_P(QuicEpollAlarmFactoryTest, CoarseAlarmUpdateMovesToLaterInterval) {
+  QuicArenaScopedPtr<TestDelegate> delegate =
+      QuicArenaScopedPtr<TestDelegate>(new TestDelegate());
+  TestDelegate* unowned_delegate = delegate.get();
+  QuicArenaScopedPtr<QuicAlarm> alarm(
+      alarm_factory_.CreateAlarm(std::move(delegate), GetArenaParam()));
+  alarm->set_precision(QuicAlarm::Precision::kCoarse10ms);
+
+  alarm->Set(clock_.Now() + QuicTime::Delta::FromMilliseconds(3));
+  alarm->Update(clock_.Now() + QuicTime::Delta::FromMilliseconds(23),
+                QuicTime::Delta::FromMicroseconds(1));
+
+  // The original interval passes without a firing.
+  epoll_server_.AdvanceByExactlyAndCallCallbacks(
+      QuicTime::Delta::FromMilliseconds(10).ToMicroseconds());
+  EXPECT_FALSE(unowned_delegate->fired());
+
+  // The interval containing the updated deadline fires.
+  epoll_server_.AdvanceByExactlyAndCallCallbacks(
+      QuicTime::Delta::FromMilliseconds(20).ToMicroseconds());
+  EXPECT_TRUE(unowned_delegate->fired());
+}
+
+TEST_P(QuicEpollAlarmFactoryTest, HeapAlarmAllocationsAreRecycled) {
+  if (GetParam()) {
+    // Arena-allocated alarms do not go through the pool.
+    return;
+  }
+  // A freed heap alarm's block is reused by the next allocation on this
+  // thread (LIFO free list).
+  std::unique_ptr<QuicAlarm> alarm(
+      alarm_factory_.CreateAlarm(new TestDelegate()));
+  QuicAlarm* first_address = alarm.get();
+  alarm.reset();
+  alarm.reset(alarm_factory_.CreateAlarm(new TestDelegate()));
+  EXPECT_EQ(first_address, alarm.get());
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace quic
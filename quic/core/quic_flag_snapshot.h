@@ -0,0 +1,57 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_QUIC_FLAG_SNAPSHOT_H_
+#define QUICHE_QUIC_CORE_QUIC_FLAG_SNAPSHOT_H_
+
+#include "quic/platform/api/quic_export.h"
+#include "quic/platform/api/quic_flags.h"
+
+namespace quic {
+
+// A connection-local snapshot of the reloadable flags consulted on per-packet
+// code paths. Each GetQuicReloadableFlag call is a global load plus branch,
+// which on busy servers shows up in per-packet processing and contends across
+// dispatcher threads. Resolving these flags once at connection creation turns
+// the hot-path checks into reads of connection-local immutables; flipping a
+// flag then only affects connections created afterwards, which matches how
+// reloadable flags are rolled out anyway.
+//
+// Only flags read on per-packet or per-ack paths belong here. Flags consulted
+// at connection setup or on rare control-plane events should keep using
+// GetQuicReloadableFlag directly.
+struct QUIC_EXPORT_PRIVATE QuicFlagSnapshot {
+  QuicFlagSnapshot()
+      : drop_unsent_path_response(
+            GetQuicReloadableFlag(quic_drop_unsent_path_response)),
+        suppress_write_mid_packet_processing(
+            GetQuicReloadableFlag(quic_suppress_write_mid_packet_processing)),
+        donot_check_amplification_limit_with_pending_timer_credit(
+            GetQuicReloadableFlag(
+                quic_donot_check_amplification_limit_with_pending_timer_credit)),
+        donot_rearm_pto_on_application_data_during_handshake(
+            GetQuicReloadableFlag(
+                quic_donot_rearm_pto_on_application_data_during_handshake)),
+        ignore_peer_max_ack_delay_during_handshake(GetQuicReloadableFlag(
+            quic_ignore_peer_max_ack_delay_during_handshake)) {}
+
+  // Latched value of --gfe2_reloadable_flag_quic_drop_unsent_path_response.
+  const bool drop_unsent_path_response;
+  // Latched value of
+  // --gfe2_reloadable_flag_quic_suppress_write_mid_packet_processing.
+  const bool suppress_write_mid_packet_processing;
+  // Latched value of
+  // --gfe2_reloadable_flag_quic_donot_check_amplification_limit_with_pending_timer_credit.
+  const bool donot_check_amplification_limit_with_pending_timer_credit;
+  // Latched value of
+  // --gfe2_reloadable_flag_quic_donot_rearm_pto_on_application_data_during_handshake.
+  const bool donot_rearm_pto_on_application_data_during_handshake;
+  // Latched value of
+  // --gfe2_reloadable_flag_quic_ignore_peer_max_ack_delay_during_handshake.
+  const bool ignore_peer_max_ack_delay_during_handshake;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_QUIC_FLAG_SNAPSHOT_H_
@@ -0,0 +1,30 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/quic_flag_snapshot.h"
+
+#include "quic/platform/api/quic_flags.h"
+#include "quic/platform/api/quic_test.h"
+
+namespace quic {
+namespace test {
+
+class QuicFlagSnapshotTest : public QuicTest {};
+
+TEST_F(QuicFlagSnapshotTest, LatchesValuesAtConstruction) {
+  SetQuicReloadableFlag(quic_drop_unsent_path_response, false);
+  QuicFlagSnapshot snapshot;
+  EXPECT_FALSE(snapshot.drop_unsent_path_response);
+
+  // Flipping the flag must not affect an existing snapshot; only snapshots
+  // captured afterwards observe the new value.
+  SetQuicReloadableFlag(quic_drop_unsent_path_response, true);
+  EXPECT_FALSE(snapshot.drop_unsent_path_response);
+
+  QuicFlagSnapshot later_snapshot;
+  EXPECT_TRUE(later_snapshot.drop_unsent_path_response);
+}
+
+}  // namespace test
+}  // namespace quic
@@ -0,0 +1,132 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/quic_flight_recorder.h"
+
+#include <string>
+
+#include "quic/core/quic_data_writer.h"
+#include "quic/platform/api/quic_bug_tracker.h"
+#include "quic/platform/api/quic_logging.h"
+
+namespace quic {
+
+QuicFlightRecorder::QuicFlightRecorder(const QuicConnection* connection)
+    : connection_(connection),
+      start_time_(connection_->clock()->ApproximateNow()) {}
+
+void QuicFlightRecorder::OnPacketSent(
+    QuicPacketNumber packet_number,
+    QuicPacketLength packet_length,
+    bool /*has_crypto_handshake*/,
+    TransmissionType /*transmission_type*/,
+    EncryptionLevel /*encryption_level*/,
+    const QuicFrames& /*retransmittable_frames*/,
+    const QuicFrames& /*nonretransmittable_frames*/,
+    QuicTime sent_time) {
+  RecordEvent(EventType::kPacketSent, sent_time, packet_number.ToUint64(),
+              packet_length);
+}
+
+void QuicFlightRecorder::OnIncomingAck(
+    QuicPacketNumber /*ack_packet_number*/,
+    EncryptionLevel /*ack_decrypted_level*/,
+    const QuicAckFrame& /*ack_frame*/,
+    QuicTime ack_receive_time,
+    QuicPacketNumber largest_observed,
+    bool rtt_updated,
+    QuicPacketNumber /*least_unacked_sent_packet*/) {
+  RecordEvent(EventType::kPacketAcked, ack_receive_time,
+              largest_observed.IsInitialized() ? largest_observed.ToUint64()
+                                               : 0,
+              connection_->sent_packet_manager()
+                  .GetRttStats()
+                  ->smoothed_rtt()
+                  .ToMicroseconds());
+  MaybeRecordCongestionWindowChange(ack_receive_time);
+  if (rtt_updated) {
+    MaybeDetectRttAnomaly(ack_receive_time);
+  }
+}
+
+void QuicFlightRecorder::OnPacketLoss(QuicPacketNumber lost_packet_number,
+                                      EncryptionLevel /*encryption_level*/,
+                                      TransmissionType /*transmission_type*/,
+                                      QuicTime detection_time) {
+  RecordEvent(EventType::kPacketLost, detection_time,
+              lost_packet_number.ToUint64(), 0);
+  MaybeRecordCongestionWindowChange(detection_time);
+}
+
+std::string QuicFlightRecorder::SerializeToString() const {
+  const size_t num_retained =
+      num_events_recorded_ < kCapacity ? num_events_recorded_ : kCapacity;
+  std::string result(num_retained * kSerializedEventSize, '\0');
+  QuicDataWriter writer(result.size(), &result[0]);
+  for (size_t i = num_events_recorded_ - num_retained;
+       i < num_events_recorded_; ++i) {
+    const Event& event = events_[i % kCapacity];
+    const bool success = writer.WriteUInt64(event.time_us) &&
+                         writer.WriteUInt64(event.packet_number) &&
+                         writer.WriteUInt64(event.value) &&
+                         writer.WriteUInt8(static_cast<uint8_t>(event.type));
+    QUICHE_DCHECK(success);
+  }
+  return result;
+}
+
+void QuicFlightRecorder::RecordEvent(EventType type,
+                                     QuicTime time,
+                                     uint64_t packet_number,
+                                     uint64_t value) {
+  Event& event = events_[num_events_recorded_ % kCapacity];
+  event.time_us = ConvertTimestampToRecordedFormat(time);
+  event.packet_number = packet_number;
+  event.value = value;
+  event.type = type;
+  ++num_events_recorded_;
+}
+
+void QuicFlightRecorder::MaybeRecordCongestionWindowChange(QuicTime time) {
+  const QuicByteCount cwnd =
+      connection_->sent_packet_manager().GetCongestionWindowInBytes();
+  if (cwnd == last_recorded_cwnd_) {
+    return;
+  }
+  last_recorded_cwnd_ = cwnd;
+  RecordEvent(EventType::kCongestionWindowChange, time, 0, cwnd);
+}
+
+void QuicFlightRecorder::MaybeDetectRttAnomaly(QuicTime time) {
+  const QuicTime::Delta smoothed_rtt =
+      connection_->sent_packet_manager().GetRttStats()->smoothed_rtt();
+  if (smoothed_rtt.IsZero()) {
+    return;
+  }
+  if (min_smoothed_rtt_.IsZero() || smoothed_rtt < min_smoothed_rtt_) {
+    min_smoothed_rtt_ = smoothed_rtt;
+    return;
+  }
+  if (anomaly_detected_ || smoothed_rtt < 2 * min_smoothed_rtt_) {
+    return;
+  }
+  anomaly_detected_ = true;
+  RecordEvent(EventType::kRttAnomaly, time, 0, smoothed_rtt.ToMicroseconds());
+  if (anomaly_delegate_ != nullptr) {
+    anomaly_delegate_->OnRttAnomaly(*this);
+  }
+}
+
+uint64_t QuicFlightRecorder::ConvertTimestampToRecordedFormat(
+    QuicTime timestamp) const {
+  if (timestamp < start_time_) {
+    QUIC_BUG(quic_flight_recorder_timestamp_underflow)
+        << "Timestamp before the recorder was created: " << timestamp
+        << " vs " << start_time_;
+    return 0;
+  }
+  return (timestamp - start_time_).ToMicroseconds();
+}
+
+}  // namespace quic
@@ -0,0 +1,132 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_QUIC_FLIGHT_RECORDER_H_
+#define QUICHE_QUIC_CORE_QUIC_FLIGHT_RECORDER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "quic/core/quic_connection.h"
+#include "quic/core/quic_time.h"
+#include "quic/core/quic_types.h"
+
+namespace quic {
+
+// Records a compact history of transport events for a single connection into
+// a preallocated fixed-size ring buffer.  Unlike QuicTraceVisitor, which
+// serializes every event into a quic_trace protobuf and is too expensive to
+// leave enabled in production, the flight recorder performs no allocation on
+// the hot path; older records are silently overwritten.  The buffer is meant
+// to be serialized only when an anomaly is detected (currently: the smoothed
+// RTT reaching twice the lowest smoothed RTT observed on the connection),
+// which makes it suitable for always-on postmortem debugging.
+class QUIC_EXPORT_PRIVATE QuicFlightRecorder
+    : public QuicConnectionDebugVisitor {
+ public:
+  enum class EventType : uint8_t {
+    kPacketSent = 1,
+    kPacketAcked = 2,
+    kPacketLost = 3,
+    kCongestionWindowChange = 4,
+    kRttAnomaly = 5,
+  };
+
+  // A single fixed-size event record.  |value| holds the packet length for
+  // kPacketSent, the congestion window in bytes for kCongestionWindowChange,
+  // and the smoothed RTT in microseconds for kPacketAcked and kRttAnomaly.
+  struct QUIC_EXPORT_PRIVATE Event {
+    uint64_t time_us;
+    uint64_t packet_number;
+    uint64_t value;
+    EventType type;
+  };
+
+  // Notified when the recorder detects an anomaly.  The delegate is expected
+  // to call SerializeToString() and persist the result.
+  class QUIC_EXPORT_PRIVATE AnomalyDelegate {
+   public:
+    virtual ~AnomalyDelegate() {}
+
+    // Called at most once per connection, when the smoothed RTT reaches
+    // twice the lowest smoothed RTT observed so far.
+    virtual void OnRttAnomaly(const QuicFlightRecorder& recorder) = 0;
+  };
+
+  // Number of event records retained before the oldest are overwritten.
+  static constexpr size_t kCapacity = 512;
+  // Size in bytes of one record in the serialized output.
+  static constexpr size_t kSerializedEventSize = 25;
+
+  explicit QuicFlightRecorder(const QuicConnection* connection);
+  QuicFlightRecorder(const QuicFlightRecorder&) = delete;
+  QuicFlightRecorder& operator=(const QuicFlightRecorder&) = delete;
+
+  void set_anomaly_delegate(AnomalyDelegate* delegate) {
+    anomaly_delegate_ = delegate;
+  }
+
+  // QuicConnectionDebugVisitor implementation.
+  void OnPacketSent(QuicPacketNumber packet_number,
+                    QuicPacketLength packet_length,
+                    bool has_crypto_handshake,
+                    TransmissionType transmission_type,
+                    EncryptionLevel encryption_level,
+                    const QuicFrames& retransmittable_frames,
+                    const QuicFrames& nonretransmittable_frames,
+                    QuicTime sent_time) override;
+  void OnIncomingAck(QuicPacketNumber ack_packet_number,
+                     EncryptionLevel ack_decrypted_level,
+                     const QuicAckFrame& ack_frame,
+                     QuicTime ack_receive_time,
+                     QuicPacketNumber largest_observed,
+                     bool rtt_updated,
+                     QuicPacketNumber least_unacked_sent_packet) override;
+  void OnPacketLoss(QuicPacketNumber lost_packet_number,
+                    EncryptionLevel encryption_level,
+                    TransmissionType transmission_type,
+                    QuicTime detection_time) override;
+
+  // Serializes the retained records, oldest first, as fixed-size binary
+  // records of kSerializedEventSize bytes each in network byte order:
+  // time_us (8 bytes), packet_number (8 bytes), value (8 bytes) and type
+  // (1 byte).  This is the only method that allocates.
+  std::string SerializeToString() const;
+
+  // Total number of events recorded, including overwritten ones.
+  size_t num_events_recorded() const { return num_events_recorded_; }
+
+  bool anomaly_detected() const { return anomaly_detected_; }
+
+ private:
+  void RecordEvent(EventType type,
+                   QuicTime time,
+                   uint64_t packet_number,
+                   uint64_t value);
+  // Records a kCongestionWindowChange event if the congestion window differs
+  // from the last recorded value.
+  void MaybeRecordCongestionWindowChange(QuicTime time);
+  // Fires the anomaly trigger once the smoothed RTT doubles relative to the
+  // lowest smoothed RTT observed so far.
+  void MaybeDetectRttAnomaly(QuicTime time);
+  // Converts |timestamp| into the microsecond offset from |start_time_| used
+  // in the recorded events.
+  uint64_t ConvertTimestampToRecordedFormat(QuicTime timestamp) const;
+
+  const QuicConnection* connection_;
+  const QuicTime start_time_;
+
+  Event events_[kCapacity];
+  size_t num_events_recorded_ = 0;
+
+  QuicByteCount last_recorded_cwnd_ = 0;
+  QuicTime::Delta min_smoothed_rtt_ = QuicTime::Delta::Zero();
+  bool anomaly_detected_ = false;
+  AnomalyDelegate* anomaly_delegate_ = nullptr;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_QUIC_FLIGHT_RECORDER_H_
@@ -0,0 +1,164 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/quic_flight_recorder.h"
+
+#include <string>
+
+#include "quic/core/congestion_control/rtt_stats.h"
+#include "quic/core/quic_data_reader.h"
+#include "quic/core/quic_time.h"
+#include "quic/platform/api/quic_test.h"
+#include "quic/test_tools/quic_sent_packet_manager_peer.h"
+#include "quic/test_tools/quic_test_utils.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+class CountingAnomalyDelegate : public QuicFlightRecorder::AnomalyDelegate {
+ public:
+  void OnRttAnomaly(const QuicFlightRecorder& recorder) override {
+    ++anomaly_count_;
+    serialized_on_anomaly_ = recorder.SerializeToString();
+  }
+
+  int anomaly_count() const { return anomaly_count_; }
+  const std::string& serialized_on_anomaly() const {
+    return serialized_on_anomaly_;
+  }
+
+ private:
+  int anomaly_count_ = 0;
+  std::string serialized_on_anomaly_;
+};
+
+class QuicFlightRecorderTest : public QuicTest {
+ protected:
+  QuicFlightRecorderTest()
+      : connection_(&helper_, &alarm_factory_, Perspective::IS_SERVER),
+        recorder_(&connection_) {
+    recorder_.set_anomaly_delegate(&delegate_);
+  }
+
+  QuicTime Now() { return helper_.GetClock()->Now(); }
+
+  void SendPacket(uint64_t packet_number, QuicPacketLength length) {
+    recorder_.OnPacketSent(QuicPacketNumber(packet_number), length,
+                           /*has_crypto_handshake=*/false, NOT_RETRANSMISSION,
+                           ENCRYPTION_FORWARD_SECURE, {}, {}, Now());
+  }
+
+  void AckPacket(uint64_t largest_observed, bool rtt_updated) {
+    QuicAckFrame ack_frame;
+    recorder_.OnIncomingAck(QuicPacketNumber(1), ENCRYPTION_FORWARD_SECURE,
+                            ack_frame, Now(),
+                            QuicPacketNumber(largest_observed), rtt_updated,
+                            QuicPacketNumber(1));
+  }
+
+  // Feeds an RTT sample to the connection's RttStats.
+  void UpdateRtt(QuicTime::Delta rtt_sample) {
+    QuicSentPacketManagerPeer::GetRttStats(&connection_.sent_packet_manager())
+        ->UpdateRtt(rtt_sample, QuicTime::Delta::Zero(), Now());
+  }
+
+  MockQuicConnectionHelper helper_;
+  MockAlarmFactory alarm_factory_;
+  MockQuicConnection connection_;
+  QuicFlightRecorder recorder_;
+  CountingAnomalyDelegate delegate_;
+};
+
+TEST_F(QuicFlightRecorderTest, RecordsSentPackets) {
+  helper_.AdvanceTime(QuicTime::Delta::FromMilliseconds(5));
+  SendPacket(1, 1200);
+
+  ASSERT_EQ(1u, recorder_.num_events_recorded());
+  std::string serialized = recorder_.SerializeToString();
+  ASSERT_EQ(QuicFlightRecorder::kSerializedEventSize, serialized.size());
+
+  QuicDataReader reader(serialized);
+  uint64_t time_us, packet_number, value;
+  uint8_t type;
+  ASSERT_TRUE(reader.ReadUInt64(&time_us));
+  ASSERT_TRUE(reader.ReadUInt64(&packet_number));
+  ASSERT_TRUE(reader.ReadUInt64(&value));
+  ASSERT_TRUE(reader.ReadUInt8(&type));
+  EXPECT_EQ(5000u, time_us);
+  EXPECT_EQ(1u, packet_number);
+  EXPECT_EQ(1200u, value);
+  EXPECT_EQ(static_cast<uint8_t>(QuicFlightRecorder::EventType::kPacketSent),
+            type);
+  EXPECT_TRUE(reader.IsDoneReading());
+}
+
+TEST_F(QuicFlightRecorderTest, AckRecordsCongestionWindowOnce) {
+  // The first ack records both the ack itself and the initial congestion
+  // window; subsequent acks with an unchanged window only record the ack.
+  AckPacket(/*largest_observed=*/1, /*rtt_updated=*/false);
+  EXPECT_EQ(2u, recorder_.num_events_recorded());
+  AckPacket(/*largest_observed=*/2, /*rtt_updated=*/false);
+  EXPECT_EQ(3u, recorder_.num_events_recorded());
+}
+
+TEST_F(QuicFlightRecorderTest, LossRecorded) {
+  AckPacket(/*largest_observed=*/2, /*rtt_updated=*/false);
+  const size_t events_before = recorder_.num_events_recorded();
+  recorder_.OnPacketLoss(QuicPacketNumber(1), ENCRYPTION_FORWARD_SECURE,
+                         LOSS_RETRANSMISSION, Now());
+  EXPECT_EQ(events_before + 1, recorder_.num_events_recorded());
+}
+
+TEST_F(QuicFlightRecorderTest, RingBufferOverwritesOldestRecords) {
+  const size_t num_sent = QuicFlightRecorder::kCapacity + 10;
+  for (uint64_t i = 1; i <= num_sent; ++i) {
+    SendPacket(i, 1200);
+  }
+  EXPECT_EQ(num_sent, recorder_.num_events_recorded());
+
+  std::string serialized = recorder_.SerializeToString();
+  ASSERT_EQ(QuicFlightRecorder::kCapacity *
+                QuicFlightRecorder::kSerializedEventSize,
+            serialized.size());
+
+  // The oldest retained record is for the 11th packet sent.
+  QuicDataReader reader(serialized);
+  uint64_t time_us, packet_number;
+  ASSERT_TRUE(reader.ReadUInt64(&time_us));
+  ASSERT_TRUE(reader.ReadUInt64(&packet_number));
+  EXPECT_EQ(11u, packet_number);
+}
+
+TEST_F(QuicFlightRecorderTest, RttDoublingFiresAnomalyOnce) {
+  UpdateRtt(QuicTime::Delta::FromMilliseconds(100));
+  AckPacket(/*largest_observed=*/1, /*rtt_updated=*/true);
+  EXPECT_FALSE(recorder_.anomaly_detected());
+  EXPECT_EQ(0, delegate_.anomaly_count());
+
+  // A single 1s sample moves the smoothed RTT from 100ms to 212.5ms, past
+  // twice the 100ms baseline.
+  UpdateRtt(QuicTime::Delta::FromSeconds(1));
+  AckPacket(/*largest_observed=*/2, /*rtt_updated=*/true);
+  EXPECT_TRUE(recorder_.anomaly_detected());
+  EXPECT_EQ(1, delegate_.anomaly_count());
+  EXPECT_FALSE(delegate_.serialized_on_anomaly().empty());
+
+  // The trigger fires at most once per connection.
+  UpdateRtt(QuicTime::Delta::FromSeconds(1));
+  AckPacket(/*largest_observed=*/3, /*rtt_updated=*/true);
+  EXPECT_EQ(1, delegate_.anomaly_count());
+}
+
+TEST_F(QuicFlightRecorderTest, AcksWithoutRttUpdateDoNotTrigger) {
+  UpdateRtt(QuicTime::Delta::FromMilliseconds(100));
+  AckPacket(/*largest_observed=*/1, /*rtt_updated=*/true);
+  UpdateRtt(QuicTime::Delta::FromSeconds(1));
+  AckPacket(/*largest_observed=*/2, /*rtt_updated=*/false);
+  EXPECT_FALSE(recorder_.anomaly_detected());
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
@@ -50,6 +50,10 @@ QuicFlowController::QuicFlowController(
       receive_window_size_(receive_window_offset),
       receive_window_size_limit_(receive_window_size_limit),
       auto_tune_receive_window_(should_auto_tune_receive_window),
+      overloaded_(false),
+      consumption_rate_tuning_enabled_(false),
+      consumption_rate_(QuicBandwidth::Zero()),
+      bytes_consumed_at_prev_window_update_(0),
       session_flow_controller_(session_flow_controller),
       last_blocked_send_window_offset_(0),
       prev_window_update_time_(QuicTime::Zero()) {
@@ -137,6 +141,12 @@ void QuicFlowController::MaybeIncreaseMaxWindowSize() {
   prev_window_update_time_ = now;
   if (!prev.IsInitialized()) {
     QUIC_DVLOG(1) << ENDPOINT << "first window update for " << LogLabel();
+    bytes_consumed_at_prev_window_update_ = bytes_consumed_;
+    return;
+  }
+
+  if (consumption_rate_tuning_enabled_) {
+    TuneWindowToConsumptionRate(now, prev);
     return;
   }
 
@@ -188,8 +198,86 @@ void QuicFlowController::IncreaseWindowSize() {
       std::min(receive_window_size_, receive_window_size_limit_);
 }
 
+void QuicFlowController::EnableConsumptionRateTuning() {
+  consumption_rate_tuning_enabled_ = true;
+  bytes_consumed_at_prev_window_update_ = bytes_consumed_;
+}
+
+void QuicFlowController::TuneWindowToConsumptionRate(QuicTime now,
+                                                     QuicTime prev) {
+  const QuicByteCount newly_consumed =
+      bytes_consumed_ - bytes_consumed_at_prev_window_update_;
+  bytes_consumed_at_prev_window_update_ = bytes_consumed_;
+
+  const QuicTime::Delta since_last = now - prev;
+  if (since_last.IsZero()) {
+    return;
+  }
+  consumption_rate_ =
+      QuicBandwidth::FromBytesAndTimeDelta(newly_consumed, since_last);
+
+  const QuicTime::Delta rtt =
+      connection_->sent_packet_manager().GetRttStats()->smoothed_rtt();
+  if (rtt.IsZero() || consumption_rate_.IsZero()) {
+    QUIC_DVLOG(1) << ENDPOINT << "no rate estimate for " << LogLabel();
+    return;
+  }
+
+  // Cover two RTTs of reads, so a consumer that keeps pace is not throttled
+  // while the WINDOW_UPDATE frame is in flight.
+  QuicByteCount target = consumption_rate_.ToBytesPerPeriod(2 * rtt);
+  target = std::min(std::max(target, kDefaultFlowControlSendWindow),
+                    receive_window_size_limit_);
+
+  // Hysteresis: leave the window alone unless the target differs from the
+  // current size by more than a quarter, so small fluctuations in read rate
+  // do not churn the window.
+  const QuicByteCount old_window = receive_window_size_;
+  if (target > old_window + old_window / 4 ||
+      target + old_window / 4 < old_window) {
+    receive_window_size_ = target;
+    QUIC_DVLOG(1) << ENDPOINT << "Consumption rate window "
+                  << (target > old_window ? "increase" : "decrease") << " for "
+                  << LogLabel() << ", rate: " << consumption_rate_
+                  << ", RTT is " << rtt.ToMicroseconds()
+                  << "us. max wndw: " << receive_window_size_;
+    if (target > old_window && session_flow_controller_ != nullptr) {
+      session_flow_controller_->EnsureWindowAtLeast(
+          kSessionFlowControlMultiplier * receive_window_size_);
+    }
+  }
+}
+
+// static
+QuicByteCount QuicFlowController::WindowUpdateThresholdForStreamCount(
+    QuicByteCount receive_window_size, size_t num_active_streams) {
+  // With many concurrent streams, per-stream updates at half-window dominate
+  // the control-frame budget, so let streams consume deeper into their
+  // windows before updating: fewer, larger WINDOW_UPDATE frames.
+  if (num_active_streams > 128) {
+    return receive_window_size / 8;
+  }
+  if (num_active_streams > 32) {
+    return receive_window_size / 4;
+  }
+  return receive_window_size / 2;
+}
+
 QuicByteCount QuicFlowController::WindowUpdateThreshold() {
-  return receive_window_size_ / 2;
+  if (is_connection_flow_controller_) {
+    // The connection-level window gates every stream, so it keeps updating
+    // at half-window regardless of how many streams are active.
+    return EffectiveReceiveWindowSize() / 2;
+  }
+  return WindowUpdateThresholdForStreamCount(EffectiveReceiveWindowSize(),
+                                             session_->GetNumActiveStreams());
+}
+
+QuicByteCount QuicFlowController::EffectiveReceiveWindowSize() const {
+  if (overloaded_) {
+    return receive_window_size_ / 4;
+  }
+  return receive_window_size_;
 }
 
 void QuicFlowController::MaybeSendWindowUpdate() {
@@ -216,14 +304,23 @@ void QuicFlowController::MaybeSendWindowUpdate() {
     return;
   }
 
-  MaybeIncreaseMaxWindowSize();
+  if (!overloaded_) {
+    // While overloaded, the window must not grow.
+    MaybeIncreaseMaxWindowSize();
+  }
+  if (EffectiveReceiveWindowSize() <= available_window) {
+    // Consumption-rate tuning or overload throttling shrank the window below
+    // the credit already advertised to the peer. Do not advance the offset
+    // until the peer has used up the outstanding credit.
+    return;
+  }
   UpdateReceiveWindowOffsetAndSendWindowUpdate(available_window);
 }
 
 void QuicFlowController::UpdateReceiveWindowOffsetAndSendWindowUpdate(
     QuicStreamOffset available_window) {
   // Update our receive window.
-  receive_window_offset_ += (receive_window_size_ - available_window);
+  receive_window_offset_ += (EffectiveReceiveWindowSize() - available_window);
 
   QUIC_DVLOG(1) << ENDPOINT << "Sending WindowUpdate frame for " << LogLabel()
                 << ", consumed bytes: " << bytes_consumed_
@@ -308,6 +405,23 @@ void QuicFlowController::UpdateReceiveWindowSize(QuicStreamOffset size) {
   receive_window_offset_ = size;
 }
 
+void QuicFlowController::MaybeRaiseReceiveWindowSize(QuicByteCount size) {
+  if (size <= receive_window_size_) {
+    return;
+  }
+  QUIC_DVLOG(1) << ENDPOINT << "Raising receive window size for " << LogLabel()
+                << " from " << receive_window_size_ << " to " << size;
+  if (size > receive_window_size_limit_) {
+    receive_window_size_limit_ = size;
+  }
+  receive_window_size_ = size;
+  const QuicByteCount available_window =
+      receive_window_offset_ - bytes_consumed_;
+  if (EffectiveReceiveWindowSize() > available_window) {
+    UpdateReceiveWindowOffsetAndSendWindowUpdate(available_window);
+  }
+}
+
 void QuicFlowController::SendWindowUpdate() {
   QuicStreamId id = id_;
   if (is_connection_flow_controller_) {
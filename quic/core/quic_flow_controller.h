@@ -5,6 +5,7 @@
 #ifndef QUICHE_QUIC_CORE_QUIC_FLOW_CONTROLLER_H_
 #define QUICHE_QUIC_CORE_QUIC_FLOW_CONTROLLER_H_
 
+#include "quic/core/quic_bandwidth.h"
 #include "quic/core/quic_packets.h"
 #include "quic/platform/api/quic_export.h"
 
@@ -109,8 +110,46 @@ class QUIC_EXPORT_PRIVATE QuicFlowController
   // Should only be called before any data is received.
   void UpdateReceiveWindowSize(QuicStreamOffset size);
 
+  // Raises the receive window size to |size| on a live connection and
+  // immediately advertises the extra credit with a WINDOW_UPDATE, raising
+  // the auto-tune limit when needed. Values at or below the current window
+  // size are ignored: credit already advertised cannot be retracted.
+  void MaybeRaiseReceiveWindowSize(QuicByteCount size);
+
   bool auto_tune_receive_window() { return auto_tune_receive_window_; }
 
+  // Stops the receive window from growing further via auto-tuning. Called
+  // under memory pressure; the advertised window itself cannot shrink.
+  void DisableReceiveWindowAutoTuning() { auto_tune_receive_window_ = false; }
+
+  // While |overloaded| is true, WINDOW_UPDATE frames advance the advertised
+  // offset as if the receive window were a quarter of its configured size,
+  // and auto-tune growth pauses. The offset already advertised never
+  // retreats; the peer is simply granted less new credit, throttling the
+  // inbound rate. Driven by server overload signals, see
+  // QuicSession::OnServerOverload().
+  void SetOverloaded(bool overloaded) { overloaded_ = overloaded; }
+
+  bool overloaded() const { return overloaded_; }
+
+  // Switches receive window tuning from doubling on fast growth to tracking
+  // the application's observed read rate: each window update resizes the
+  // window to cover two RTTs of consumption, growing or shrinking with
+  // hysteresis. The advertised offset never retreats; shrinking the window
+  // only slows how far future WINDOW_UPDATE frames advance it.
+  void EnableConsumptionRateTuning();
+
+  // The application's observed read rate. Zero until consumption-rate tuning
+  // is enabled and a full window update interval has been observed.
+  QuicBandwidth consumption_rate() const { return consumption_rate_; }
+
+  // Returns the available-window threshold below which a stream-level
+  // controller sends a WINDOW_UPDATE, given the number of active streams in
+  // the session. The threshold drops as the stream count grows, trading
+  // update frequency for update size to bound control-frame overhead.
+  static QuicByteCount WindowUpdateThresholdForStreamCount(
+      QuicByteCount receive_window_size, size_t num_active_streams);
+
  private:
   friend class test::QuicFlowControllerPeer;
 
@@ -127,6 +166,12 @@ class QUIC_EXPORT_PRIVATE QuicFlowController
   // Double the window size as long as we haven't hit the max window size.
   void IncreaseWindowSize();
 
+  // Updates |consumption_rate_| from the bytes consumed between the previous
+  // window update at |prev| and this one at |now|, and resizes
+  // |receive_window_size_| to cover two RTTs of consumption. Called before a
+  // WINDOW_UPDATE frame is sent when consumption-rate tuning is enabled.
+  void TuneWindowToConsumptionRate(QuicTime now, QuicTime prev);
+
   // Returns "stream $ID" (where $ID is set to |id_|) or "connection" based on
   // |is_connection_flow_controller_|.
   std::string LogLabel();
@@ -196,6 +241,20 @@ class QUIC_EXPORT_PRIVATE QuicFlowController
   // Used to dynamically enable receive window auto-tuning.
   bool auto_tune_receive_window_;
 
+  // True while the server has reported overload, see SetOverloaded().
+  bool overloaded_;
+
+  // If true, the receive window tracks the application's read rate instead of
+  // doubling on fast growth.
+  bool consumption_rate_tuning_enabled_;
+
+  // The application's read rate, measured between successive window updates.
+  QuicBandwidth consumption_rate_;
+
+  // Value of |bytes_consumed_| when the previous window update was sent; used
+  // to measure |consumption_rate_|.
+  QuicByteCount bytes_consumed_at_prev_window_update_;
+
   // The session's flow controller. Null if this is the session flow controller.
   // Not owned.
   QuicFlowControllerInterface* session_flow_controller_;
@@ -203,6 +262,10 @@ class QUIC_EXPORT_PRIVATE QuicFlowController
   // Send window update when receive window size drops below this.
   QuicByteCount WindowUpdateThreshold();
 
+  // The window size used when advancing the advertised offset: the full
+  // |receive_window_size_| normally, a quarter of it while overloaded.
+  QuicByteCount EffectiveReceiveWindowSize() const;
+
   // Keep track of the last time we sent a BLOCKED frame. We should only send
   // another when the number of bytes we have sent has changed.
   QuicStreamOffset last_blocked_send_window_offset_;
@@ -404,5 +404,147 @@ TEST_F(QuicFlowControllerTest, ReceivingBytesNormalNoAutoTune) {
   EXPECT_EQ(new_threshold, threshold);
 }
 
+TEST_F(QuicFlowControllerTest, ConsumptionRateTuning) {
+  Initialize();
+  flow_controller_->EnableConsumptionRateTuning();
+  // The baseline round and the fast round each send a WINDOW_UPDATE; the
+  // slow round shrinks the window instead of advancing the offset.
+  EXPECT_CALL(*session_, WriteControlFrame(_, _))
+      .Times(2)
+      .WillRepeatedly(Invoke(&ClearControlFrameWithTransmissionType));
+
+  // Make sure clock is inititialized.
+  connection_->AdvanceTime(QuicTime::Delta::FromMilliseconds(1));
+
+  QuicSentPacketManager* manager =
+      QuicConnectionPeer::GetSentPacketManager(connection_);
+  RttStats* rtt_stats = const_cast<RttStats*>(manager->GetRttStats());
+  rtt_stats->UpdateRtt(QuicTime::Delta::FromMilliseconds(kRtt),
+                       QuicTime::Delta::Zero(), QuicTime::Zero());
+
+  QuicByteCount threshold =
+      QuicFlowControllerPeer::WindowUpdateThreshold(flow_controller_.get());
+
+  // First WINDOW_UPDATE establishes the measurement baseline; no rate
+  // estimate has formed yet and the window is unchanged.
+  QuicStreamOffset receive_offset = threshold + 1;
+  EXPECT_TRUE(flow_controller_->UpdateHighestReceivedOffset(receive_offset));
+  flow_controller_->AddBytesConsumed(threshold + 1);
+  EXPECT_EQ(kInitialSessionFlowControlWindowForTest,
+            QuicFlowControllerPeer::ReceiveWindowSize(flow_controller_.get()));
+  EXPECT_TRUE(flow_controller_->consumption_rate().IsZero());
+
+  // A slow consumer: half a window read over ten seconds. The window shrinks
+  // to the floor instead of staying at 1.5 MB, and no WINDOW_UPDATE is sent
+  // because the peer already has more credit than the new window.
+  connection_->AdvanceTime(QuicTime::Delta::FromSeconds(10));
+  receive_offset += threshold + 1;
+  EXPECT_TRUE(flow_controller_->UpdateHighestReceivedOffset(receive_offset));
+  flow_controller_->AddBytesConsumed(threshold + 1);
+  EXPECT_EQ(kDefaultFlowControlSendWindow,
+            QuicFlowControllerPeer::ReceiveWindowSize(flow_controller_.get()));
+  EXPECT_FALSE(flow_controller_->consumption_rate().IsZero());
+
+  // A fast consumer: the rest of the advertised credit read within one RTT.
+  // The window grows back to cover two RTTs at the new rate and the session
+  // window is widened to match.
+  EXPECT_CALL(session_flow_controller_, EnsureWindowAtLeast(_));
+  connection_->AdvanceTime(QuicTime::Delta::FromMilliseconds(kRtt));
+  const QuicByteCount remaining = threshold - 4096;
+  receive_offset += remaining;
+  EXPECT_TRUE(flow_controller_->UpdateHighestReceivedOffset(receive_offset));
+  flow_controller_->AddBytesConsumed(remaining);
+  EXPECT_GT(QuicFlowControllerPeer::ReceiveWindowSize(flow_controller_.get()),
+            kDefaultFlowControlSendWindow);
+  EXPECT_FALSE(flow_controller_->FlowControlViolation());
+}
+
+TEST_F(QuicFlowControllerTest, WindowUpdateThresholdScalesWithStreamCount) {
+  const QuicByteCount window = 64 * 1024;
+  // Few streams: update at half-window, the historical behavior.
+  EXPECT_EQ(window / 2,
+            QuicFlowController::WindowUpdateThresholdForStreamCount(window, 1));
+  EXPECT_EQ(window / 2, QuicFlowController::WindowUpdateThresholdForStreamCount(
+                            window, 32));
+  // Many streams: streams consume deeper into their windows before updating,
+  // so each WINDOW_UPDATE advances the offset further.
+  EXPECT_EQ(window / 4, QuicFlowController::WindowUpdateThresholdForStreamCount(
+                            window, 33));
+  EXPECT_EQ(window / 4, QuicFlowController::WindowUpdateThresholdForStreamCount(
+                            window, 128));
+  EXPECT_EQ(window / 8, QuicFlowController::WindowUpdateThresholdForStreamCount(
+                            window, 129));
+}
+
+TEST_F(QuicFlowControllerTest, OverloadShrinksAdvertisedWindow) {
+  Initialize();
+  flow_controller_->SetOverloaded(true);
+  EXPECT_TRUE(flow_controller_->overloaded());
+
+  // Consuming half the window would normally trigger a WINDOW_UPDATE, but
+  // while overloaded the update threshold drops to an eighth of the window.
+  EXPECT_CALL(*session_, WriteControlFrame(_, _)).Times(0);
+  QuicByteCount consumed = receive_window_ / 2 + 1;
+  flow_controller_->UpdateHighestReceivedOffset(consumed);
+  flow_controller_->AddBytesConsumed(consumed);
+  EXPECT_EQ(receive_window_,
+            QuicFlowControllerPeer::ReceiveWindowOffset(flow_controller_.get()));
+
+  // Consuming below an eighth of the window sends an update, but it only
+  // grants a quarter window of new credit.
+  EXPECT_CALL(*session_, WriteControlFrame(_, _)).Times(1);
+  QuicByteCount more = receive_window_ - receive_window_ / 8 + 1 - consumed;
+  consumed += more;
+  flow_controller_->UpdateHighestReceivedOffset(consumed);
+  flow_controller_->AddBytesConsumed(more);
+  EXPECT_EQ(consumed + receive_window_ / 4,
+            QuicFlowControllerPeer::ReceiveWindowOffset(flow_controller_.get()));
+
+  // Once the overload clears, updates grant the full window again.
+  flow_controller_->SetOverloaded(false);
+  EXPECT_CALL(*session_, WriteControlFrame(_, _)).Times(1);
+  more = receive_window_ / 4;
+  consumed += more;
+  flow_controller_->AddBytesConsumed(more);
+  EXPECT_EQ(consumed + receive_window_,
+            QuicFlowControllerPeer::ReceiveWindowOffset(flow_controller_.get()));
+}
+
+TEST_F(QuicFlowControllerTest, MaybeRaiseReceiveWindowSize) {
+  Initialize();
+
+  // Raising the window size on a live connection immediately advertises the
+  // extra credit: the offset advances by the size increase.
+  EXPECT_CALL(*session_, WriteControlFrame(_, _)).Times(1);
+  flow_controller_->MaybeRaiseReceiveWindowSize(2 * receive_window_);
+  EXPECT_EQ(2 * receive_window_, flow_controller_->receive_window_size());
+  EXPECT_EQ(2 * receive_window_,
+            QuicFlowControllerPeer::ReceiveWindowOffset(flow_controller_.get()));
+
+  // Values at or below the current size are ignored; advertised credit
+  // cannot be retracted.
+  EXPECT_CALL(*session_, WriteControlFrame(_, _)).Times(0);
+  flow_controller_->MaybeRaiseReceiveWindowSize(receive_window_);
+  EXPECT_EQ(2 * receive_window_, flow_controller_->receive_window_size());
+
+  // A raise beyond the auto-tune limit raises the limit with it.
+  EXPECT_CALL(*session_, WriteControlFrame(_, _)).Times(1);
+  flow_controller_->MaybeRaiseReceiveWindowSize(2 * kStreamReceiveWindowLimit);
+  EXPECT_EQ(2 * kStreamReceiveWindowLimit,
+            flow_controller_->receive_window_size());
+  EXPECT_EQ(
+      2 * kStreamReceiveWindowLimit,
+      QuicFlowControllerPeer::ReceiveWindowSizeLimit(flow_controller_.get()));
+}
+
+TEST_F(QuicFlowControllerTest, StreamThresholdTracksSessionStreamCount) {
+  Initialize();
+  // The mock session has no active streams, so the stream-level threshold is
+  // the historical half-window.
+  EXPECT_EQ(
+      receive_window_ / 2,
+      QuicFlowControllerPeer::WindowUpdateThreshold(flow_controller_.get()));
+}
+
 }  // namespace test
 }  // namespace quic
@@ -10,6 +10,7 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/base/attributes.h"
 #include "absl/base/macros.h"
@@ -26,6 +27,8 @@
 #include "quic/core/crypto/crypto_utils.h"
 #include "quic/core/crypto/null_decrypter.h"
 #include "quic/core/crypto/null_encrypter.h"
+#include "quic/core/crypto/aead_base_decrypter.h"
+#include "quic/core/crypto/aead_base_encrypter.h"
 #include "quic/core/crypto/quic_decrypter.h"
 #include "quic/core/crypto/quic_encrypter.h"
 #include "quic/core/crypto/quic_random.h"
@@ -37,6 +40,7 @@
 #include "quic/core/quic_error_codes.h"
 #include "quic/core/quic_packets.h"
 #include "quic/core/quic_socket_address_coder.h"
+#include "quic/core/quic_stage_latency_recorder.h"
 #include "quic/core/quic_stream_frame_data_producer.h"
 #include "quic/core/quic_time.h"
 #include "quic/core/quic_types.h"
@@ -405,6 +409,8 @@ QuicFramer::QuicFramer(const ParsedQuicVersionVector& supported_versions,
       last_serialized_server_connection_id_(EmptyQuicConnectionId()),
       last_serialized_client_connection_id_(EmptyQuicConnectionId()),
       version_(ParsedQuicVersion::Unsupported()),
+      version_has_ietf_invariant_header_(false),
+      version_has_header_protection_(false),
       supported_versions_(supported_versions),
       decrypter_level_(ENCRYPTION_INITIAL),
       alternative_decrypter_level_(NUM_ENCRYPTION_LEVELS),
@@ -435,6 +441,7 @@ QuicFramer::QuicFramer(const ParsedQuicVersionVector& supported_versions,
   version_ = supported_versions_[0];
   QUICHE_DCHECK(version_.IsKnown())
       << ParsedQuicVersionVectorToString(supported_versions_);
+  CacheVersionPredicates();
 }
 
 QuicFramer::~QuicFramer() {}
@@ -1479,7 +1486,7 @@ bool QuicFramer::ProcessPacketInternal(const QuicEncryptedPacket& packet) {
 
   bool packet_has_ietf_packet_header = false;
   if (infer_packet_header_type_from_version_) {
-    packet_has_ietf_packet_header = version_.HasIetfInvariantHeader();
+    packet_has_ietf_packet_header = version_has_ietf_invariant_header_;
   } else if (!reader.IsDoneReading()) {
     uint8_t type = reader.PeekByte();
     packet_has_ietf_packet_header = QuicUtils::IsIetfPacketHeader(type);
@@ -1793,7 +1800,7 @@ bool QuicFramer::ProcessIetfDataPacket(QuicDataReader* encrypted_reader,
     }
     uint64_t full_packet_number;
     bool hp_removal_failed = false;
-    if (version_.HasHeaderProtection()) {
+    if (version_has_header_protection_) {
       if (!RemoveHeaderProtection(encrypted_reader, packet, header,
                                   &full_packet_number, &ad_storage)) {
         hp_removal_failed = true;
@@ -1863,7 +1870,7 @@ bool QuicFramer::ProcessIetfDataPacket(QuicDataReader* encrypted_reader,
   }
 
   absl::string_view encrypted = encrypted_reader->ReadRemainingPayload();
-  if (!version_.HasHeaderProtection()) {
+  if (!version_has_header_protection_) {
     associated_data = GetAssociatedDataFromEncryptedPacket(
         version_.transport_version, packet,
         GetIncludedDestinationConnectionIdLength(*header),
@@ -1875,9 +1882,19 @@ bool QuicFramer::ProcessIetfDataPacket(QuicDataReader* encrypted_reader,
 
   size_t decrypted_length = 0;
   EncryptionLevel decrypted_level;
+  char* decryption_output = decrypted_buffer;
+  size_t decryption_output_length = buffer_length;
+  if (allow_in_place_decryption_) {
+    // AEAD decrypters support exactly aliased input and output buffers, so
+    // the plaintext can overwrite the ciphertext and frame parsing can stay
+    // on the buffer the packet was received into. The caller has promised
+    // not to read the payload bytes again if decryption fails.
+    decryption_output = const_cast<char*>(encrypted.data());
+    decryption_output_length = encrypted.length();
+  }
   if (!DecryptPayload(packet.length(), encrypted, associated_data, *header,
-                      decrypted_buffer, buffer_length, &decrypted_length,
-                      &decrypted_level)) {
+                      decryption_output, decryption_output_length,
+                      &decrypted_length, &decrypted_level)) {
     if (IsIetfStatelessResetPacket(*header)) {
       // This is a stateless reset packet.
       QuicIetfStatelessResetPacket packet(
@@ -1903,7 +1920,7 @@ bool QuicFramer::ProcessIetfDataPacket(QuicDataReader* encrypted_reader,
     RecordDroppedPacketReason(DroppedPacketReason::DECRYPTION_FAILURE);
     return RaiseError(QUIC_DECRYPTION_FAILURE);
   }
-  QuicDataReader reader(decrypted_buffer, decrypted_length);
+  QuicDataReader reader(decryption_output, decrypted_length);
 
   // Update the largest packet number after we have decrypted the packet
   // so we are confident is not attacker controlled.
@@ -2672,7 +2689,7 @@ bool QuicFramer::ProcessIetfHeaderTypeByte(QuicDataReader* reader,
     set_detailed_error("Fixed bit is 0 in short header.");
     return false;
   }
-  if (!version_.HasHeaderProtection()) {
+  if (!version_has_header_protection_) {
     header->packet_number_length = GetShortHeaderPacketNumberLength(type);
   }
   QUIC_DVLOG(1) << "packet_number_length = " << header->packet_number_length;
@@ -2774,7 +2791,7 @@ bool QuicFramer::ProcessIetfPacketHeader(QuicDataReader* reader,
     std::string detailed_error;
     QuicErrorCode parse_result = QuicFramer::ParsePublicHeader(
         reader, expected_destination_connection_id_length,
-        version_.HasIetfInvariantHeader(), &header->type_byte, &header->form,
+        version_has_ietf_invariant_header_, &header->type_byte, &header->form,
         &header->version_flag, &has_length_prefix, &version_label,
         &header->version, &header->destination_connection_id,
         &header->source_connection_id, &header->long_packet_type,
@@ -2803,7 +2820,7 @@ bool QuicFramer::ProcessIetfPacketHeader(QuicDataReader* reader,
       return false;
     }
     if (!header->version_flag) {
-      if (!version_.HasHeaderProtection()) {
+      if (!version_has_header_protection_) {
         header->packet_number_length =
             GetShortHeaderPacketNumberLength(header->type_byte);
       }
@@ -2912,7 +2929,7 @@ bool QuicFramer::ProcessFrameData(QuicDataReader* reader,
       set_detailed_error("Unable to read frame type.");
       return RaiseError(QUIC_INVALID_FRAME_DATA);
     }
-    const uint8_t special_mask = version_.HasIetfInvariantHeader()
+    const uint8_t special_mask = version_has_ietf_invariant_header_
                                      ? kQuicFrameTypeSpecialMask
                                      : kQuicFrameTypeBrokenMask;
     if (frame_type & special_mask) {
@@ -3169,6 +3186,11 @@ bool QuicFramer::ProcessIetfFrameData(QuicDataReader* reader,
   }
 
   QUIC_DVLOG(2) << ENDPOINT << "Processing IETF packet with header " << header;
+  // At ENCRYPTION_FORWARD_SECURE every frame type is allowed, so the
+  // per-frame gating check can be skipped entirely on the 1-RTT packets that
+  // dominate an established connection.
+  const bool enforce_frame_type_gating =
+      decrypted_level != ENCRYPTION_FORWARD_SECURE;
   while (!reader->IsDoneReading()) {
     uint64_t frame_type;
     // Will be the number of bytes into which frame_type was encoded.
@@ -3177,7 +3199,8 @@ bool QuicFramer::ProcessIetfFrameData(QuicDataReader* reader,
       set_detailed_error("Unable to read frame type.");
       return RaiseError(QUIC_INVALID_FRAME_DATA);
     }
-    if (!IsIetfFrameTypeExpectedForEncryptionLevel(frame_type,
+    if (enforce_frame_type_gating &&
+        !IsIetfFrameTypeExpectedForEncryptionLevel(frame_type,
                                                    decrypted_level)) {
       set_detailed_error(absl::StrCat(
           "IETF frame type ",
@@ -3192,9 +3215,11 @@ bool QuicFramer::ProcessIetfFrameData(QuicDataReader* reader,
     // Is now the number of bytes into which the frame type was encoded.
     encoded_bytes -= reader->BytesRemaining();
 
-    // Check that the frame type is minimally encoded.
-    if (encoded_bytes !=
-        static_cast<size_t>(QuicDataWriter::GetVarInt62Len(frame_type))) {
+    // Check that the frame type is minimally encoded. A frame type encoded in
+    // a single byte is always minimal.
+    if (encoded_bytes != 1 &&
+        encoded_bytes !=
+            static_cast<size_t>(QuicDataWriter::GetVarInt62Len(frame_type))) {
       // The frame type was not minimally encoded.
       set_detailed_error("Frame type not minimally encoded.");
       return RaiseError(IETF_QUIC_PROTOCOL_VIOLATION);
@@ -3212,6 +3237,22 @@ bool QuicFramer::ProcessIetfFrameData(QuicDataReader* reader,
         // Returning true since there was no parsing error.
         return true;
       }
+    } else if (frame_type == IETF_ACK || frame_type == IETF_ACK_ECN ||
+               frame_type == IETF_ACK_RECEIVE_TIMESTAMPS) {
+      // ACK is dispatched ahead of the switch below because, together with
+      // STREAM, it makes up nearly every frame received on an established
+      // connection.
+      if (frame_type == IETF_ACK_RECEIVE_TIMESTAMPS && !process_timestamps_) {
+        set_detailed_error("Unsupported frame type.");
+        QUIC_DLOG(WARNING) << ENDPOINT
+                           << "IETF_ACK_RECEIVE_TIMESTAMPS not supported";
+        return RaiseError(QUIC_INVALID_FRAME_DATA);
+      }
+      QuicAckFrame frame;
+      if (!ProcessIetfAckFrame(reader, frame_type, &frame)) {
+        return RaiseError(QUIC_INVALID_ACK_DATA);
+      }
+      QUIC_DVLOG(2) << ENDPOINT << "Processing IETF ACK frame " << frame;
     } else {
       switch (frame_type) {
         case IETF_PADDING: {
@@ -3416,23 +3457,6 @@ bool QuicFramer::ProcessIetfFrameData(QuicDataReader* reader,
           }
           break;
         }
-        case IETF_ACK_RECEIVE_TIMESTAMPS:
-          if (!process_timestamps_) {
-            set_detailed_error("Unsupported frame type.");
-            QUIC_DLOG(WARNING)
-                << ENDPOINT << "IETF_ACK_RECEIVE_TIMESTAMPS not supported";
-            return RaiseError(QUIC_INVALID_FRAME_DATA);
-          }
-          ABSL_FALLTHROUGH_INTENDED;
-        case IETF_ACK_ECN:
-        case IETF_ACK: {
-          QuicAckFrame frame;
-          if (!ProcessIetfAckFrame(reader, frame_type, &frame)) {
-            return RaiseError(QUIC_INVALID_ACK_DATA);
-          }
-          QUIC_DVLOG(2) << ENDPOINT << "Processing IETF ACK frame " << frame;
-          break;
-        }
         case IETF_PATH_CHALLENGE: {
           QuicPathChallengeFrame frame;
           if (!ProcessPathChallengeFrame(reader, &frame)) {
@@ -3741,6 +3765,8 @@ bool QuicFramer::ProcessAckFrequencyFrame(QuicDataReader* reader,
 }
 
 bool QuicFramer::ProcessAckFrame(QuicDataReader* reader, uint8_t frame_type) {
+  QuicScopedStageLatencySampler latency_sampler(
+      QuicStageLatencyRecorder::kProcessAckFrame);
   const bool has_ack_blocks =
       ExtractBit(frame_type, kQuicHasMultipleAckBlocksOffset);
   uint8_t num_ack_blocks = 0;
@@ -3956,11 +3982,17 @@ bool QuicFramer::ProcessTimestampsInAckFrame(uint8_t num_received_packets,
 bool QuicFramer::ProcessIetfAckFrame(QuicDataReader* reader,
                                      uint64_t frame_type,
                                      QuicAckFrame* ack_frame) {
-  uint64_t largest_acked;
-  if (!reader->ReadVarInt62(&largest_acked)) {
+  QuicScopedStageLatencySampler latency_sampler(
+      QuicStageLatencyRecorder::kProcessAckFrame);
+  // The largest acked and the ack delay always travel together, so decode
+  // them with one batched call.
+  uint64_t header[2];
+  const size_t header_count = reader->ReadVarInt62Batch(header, 2);
+  if (header_count == 0) {
     set_detailed_error("Unable to read largest acked.");
     return false;
   }
+  const uint64_t largest_acked = header[0];
   if (largest_acked < first_sending_packet_number_.ToUint64()) {
     // Connection always sends packet starting from kFirstSendingPacketNumber >
     // 0, peer has observed an unsent packet.
@@ -3968,11 +4000,11 @@ bool QuicFramer::ProcessIetfAckFrame(QuicDataReader* reader,
     return false;
   }
   ack_frame->largest_acked = static_cast<QuicPacketNumber>(largest_acked);
-  uint64_t ack_delay_time_in_us;
-  if (!reader->ReadVarInt62(&ack_delay_time_in_us)) {
+  if (header_count < 2) {
     set_detailed_error("Unable to read ack delay time.");
     return false;
   }
+  uint64_t ack_delay_time_in_us = header[1];
 
   if (ack_delay_time_in_us >= (kVarInt62MaxValue >> peer_ack_delay_exponent_)) {
     ack_frame->ack_delay_time = QuicTime::Delta::Infinite();
@@ -3990,21 +4022,23 @@ bool QuicFramer::ProcessIetfAckFrame(QuicDataReader* reader,
     return false;
   }
 
-  // Get number of ACK blocks from the packet.
-  uint64_t ack_block_count;
-  if (!reader->ReadVarInt62(&ack_block_count)) {
-    set_detailed_error("Unable to read ack block count.");
-    return false;
-  }
+  // Get the number of ACK blocks and the first block, batched as above.
   // There always is a first ACK block, which is the (number of packets being
   // acked)-1, up to and including the packet at largest_acked. Therefore if the
   // value is 0, then only largest is acked. If it is 1, then largest-1,
   // largest] are acked, etc
-  uint64_t ack_block_value;
-  if (!reader->ReadVarInt62(&ack_block_value)) {
+  uint64_t blocks[2];
+  const size_t blocks_count = reader->ReadVarInt62Batch(blocks, 2);
+  if (blocks_count == 0) {
+    set_detailed_error("Unable to read ack block count.");
+    return false;
+  }
+  if (blocks_count < 2) {
     set_detailed_error("Unable to read first ack block length.");
     return false;
   }
+  uint64_t ack_block_count = blocks[0];
+  uint64_t ack_block_value = blocks[1];
   // Calculate the packets being acked in the first block.
   //  +1 because AddRange implementation requires [low,high)
   uint64_t block_high = largest_acked + 1;
@@ -4033,12 +4067,14 @@ bool QuicFramer::ProcessIetfAckFrame(QuicDataReader* reader,
   }
 
   while (ack_block_count != 0) {
-    uint64_t gap_block_value;
-    // Get the sizes of the gap and ack blocks,
-    if (!reader->ReadVarInt62(&gap_block_value)) {
+    // Get the sizes of the gap and ack blocks with one batched decode; the
+    // underflow checks run in between, exactly as the separate reads did.
+    const size_t pair_count = reader->ReadVarInt62Batch(blocks, 2);
+    if (pair_count == 0) {
       set_detailed_error("Unable to read gap block value.");
       return false;
     }
+    const uint64_t gap_block_value = blocks[0];
     // It's an error if the gap is larger than the space from packet
     // number 0 to the start of the block that's just been acked, PLUS
     // there must be space for at least 1 packet to be acked. For
@@ -4063,10 +4099,11 @@ bool QuicFramer::ProcessIetfAckFrame(QuicDataReader* reader,
     // (per the implementation of OnAckRange/AddAckRange, below).
     block_high = block_low - 1 - gap_block_value;
 
-    if (!reader->ReadVarInt62(&ack_block_value)) {
+    if (pair_count < 2) {
       set_detailed_error("Unable to read ack block value.");
       return false;
     }
+    ack_block_value = blocks[1];
     if (ack_block_value + first_sending_packet_number_.ToUint64() >
         (block_high - 1)) {
       set_detailed_error(
@@ -4116,7 +4153,14 @@ bool QuicFramer::ProcessIetfAckFrame(QuicDataReader* reader,
     ack_frame->ect_1_count = 0;
     ack_frame->ecn_ce_count = 0;
   }
-  // TODO(fayang): Report ECN counts to visitor when they are actually used.
+  if (ack_frame->ecn_counters_populated &&
+      !visitor_->OnAckFrameEcnCounts(ack_frame->ect_0_count,
+                                     ack_frame->ect_1_count,
+                                     ack_frame->ecn_ce_count)) {
+    set_detailed_error(
+        "Error occurs when visitor processes ECN counts of an ACK frame.");
+    return false;
+  }
   if (!visitor_->OnAckFrameEnd(QuicPacketNumber(block_low))) {
     set_detailed_error(
         "Error occurs when visitor finishes processing the ACK frame.");
@@ -4394,6 +4438,7 @@ void QuicFramer::SetDecrypter(EncryptionLevel level,
   decrypter_[decrypter_level_] = nullptr;
   decrypter_[level] = std::move(decrypter);
   decrypter_level_ = level;
+  RefreshAeadCrypterCaches();
 }
 
 void QuicFramer::SetAlternativeDecrypter(
@@ -4410,6 +4455,7 @@ void QuicFramer::SetAlternativeDecrypter(
   decrypter_[level] = std::move(decrypter);
   alternative_decrypter_level_ = level;
   alternative_decrypter_latch_ = latch_once_used;
+  RefreshAeadCrypterCaches();
 }
 
 void QuicFramer::InstallDecrypter(EncryptionLevel level,
@@ -4417,12 +4463,14 @@ void QuicFramer::InstallDecrypter(EncryptionLevel level,
   QUICHE_DCHECK(version_.KnowsWhichDecrypterToUse());
   QUIC_DVLOG(1) << ENDPOINT << "Installing decrypter at level " << level;
   decrypter_[level] = std::move(decrypter);
+  RefreshAeadCrypterCaches();
 }
 
 void QuicFramer::RemoveDecrypter(EncryptionLevel level) {
   QUICHE_DCHECK(version_.KnowsWhichDecrypterToUse());
   QUIC_DVLOG(1) << ENDPOINT << "Removing decrypter at level " << level;
   decrypter_[level] = nullptr;
+  RefreshAeadCrypterCaches();
 }
 
 void QuicFramer::SetKeyUpdateSupportForConnection(bool enabled) {
@@ -4434,6 +4482,7 @@ void QuicFramer::DiscardPreviousOneRttKeys() {
   QUICHE_DCHECK(support_key_update_for_connection_);
   QUIC_DVLOG(1) << ENDPOINT << "Discarding previous set of 1-RTT keys";
   previous_decrypter_ = nullptr;
+  RefreshAeadCrypterCaches();
 }
 
 bool QuicFramer::DoKeyUpdate(KeyUpdateReason reason) {
@@ -4478,6 +4527,16 @@ bool QuicFramer::DoKeyUpdate(KeyUpdateReason reason) {
       break;
   }
   visitor_->OnKeyUpdate(reason);
+  if (speculative_next_key_derivation_) {
+    // Stage the decrypter for the phase after this one, so a future peer
+    // initiated update (or a reordered packet from it) does not pay key
+    // derivation on the packet path. Failure is not an error here; the
+    // derivation will be retried lazily when that phase is first seen.
+    next_decrypter_ = visitor_->AdvanceKeysAndCreateCurrentOneRttDecrypter();
+    QUIC_DLOG_IF(WARNING, !next_decrypter_)
+        << ENDPOINT << "Speculative next key derivation failed";
+  }
+  RefreshAeadCrypterCaches();
   return true;
 }
 
@@ -4490,6 +4549,11 @@ const QuicDecrypter* QuicFramer::GetDecrypter(EncryptionLevel level) const {
   return decrypter_[level].get();
 }
 
+const QuicEncrypter* QuicFramer::GetEncrypter(EncryptionLevel level) const {
+  QUICHE_DCHECK(level < NUM_ENCRYPTION_LEVELS);
+  return encrypter_[level].get();
+}
+
 const QuicDecrypter* QuicFramer::decrypter() const {
   return decrypter_[decrypter_level_].get();
 }
@@ -4507,11 +4571,13 @@ void QuicFramer::SetEncrypter(EncryptionLevel level,
   QUICHE_DCHECK_LT(level, NUM_ENCRYPTION_LEVELS);
   QUIC_DVLOG(1) << ENDPOINT << "Setting encrypter at level " << level;
   encrypter_[level] = std::move(encrypter);
+  RefreshAeadCrypterCaches();
 }
 
 void QuicFramer::RemoveEncrypter(EncryptionLevel level) {
   QUIC_DVLOG(1) << ENDPOINT << "Removing encrypter of " << level;
   encrypter_[level] = nullptr;
+  RefreshAeadCrypterCaches();
 }
 
 void QuicFramer::SetInitialObfuscators(QuicConnectionId connection_id) {
@@ -4520,6 +4586,40 @@ void QuicFramer::SetInitialObfuscators(QuicConnectionId connection_id) {
                                         &crypters);
   encrypter_[ENCRYPTION_INITIAL] = std::move(crypters.encrypter);
   decrypter_[ENCRYPTION_INITIAL] = std::move(crypters.decrypter);
+  RefreshAeadCrypterCaches();
+}
+
+void QuicFramer::RefreshAeadCrypterCaches() {
+  for (int i = 0; i < NUM_ENCRYPTION_LEVELS; ++i) {
+    aead_encrypter_[i] =
+        encrypter_[i] == nullptr ? nullptr : encrypter_[i]->AsAeadBaseEncrypter();
+    aead_decrypter_[i] =
+        decrypter_[i] == nullptr ? nullptr : decrypter_[i]->AsAeadBaseDecrypter();
+  }
+  aead_previous_decrypter_ = previous_decrypter_ == nullptr
+                                 ? nullptr
+                                 : previous_decrypter_->AsAeadBaseDecrypter();
+  aead_next_decrypter_ = next_decrypter_ == nullptr
+                             ? nullptr
+                             : next_decrypter_->AsAeadBaseDecrypter();
+}
+
+bool QuicFramer::EncryptPacketAtLevel(EncryptionLevel level,
+                                      uint64_t packet_number,
+                                      absl::string_view associated_data,
+                                      absl::string_view plaintext,
+                                      char* output,
+                                      size_t* output_length,
+                                      size_t max_output_length) {
+  AeadBaseEncrypter* aead_encrypter = aead_encrypter_[level];
+  if (aead_encrypter != nullptr) {
+    return aead_encrypter->EncryptPacket(packet_number, associated_data,
+                                         plaintext, output, output_length,
+                                         max_output_length);
+  }
+  return encrypter_[level]->EncryptPacket(packet_number, associated_data,
+                                          plaintext, output, output_length,
+                                          max_output_length);
 }
 
 size_t QuicFramer::EncryptInPlace(EncryptionLevel level,
@@ -4538,8 +4638,8 @@ size_t QuicFramer::EncryptInPlace(EncryptionLevel level,
   }
 
   size_t output_length = 0;
-  if (!encrypter_[level]->EncryptPacket(
-          packet_number.ToUint64(),
+  if (!EncryptPacketAtLevel(
+          level, packet_number.ToUint64(),
           absl::string_view(buffer, ad_len),  // Associated data
           absl::string_view(buffer + ad_len,
                             total_len - ad_len),  // Plaintext
@@ -4548,7 +4648,7 @@ size_t QuicFramer::EncryptInPlace(EncryptionLevel level,
     RaiseError(QUIC_ENCRYPTION_FAILURE);
     return 0;
   }
-  if (version_.HasHeaderProtection() &&
+  if (version_has_header_protection_ &&
       !ApplyHeaderProtection(level, buffer, ad_len + output_length, ad_len)) {
     QUIC_DLOG(ERROR) << "Applying header protection failed.";
     RaiseError(QUIC_ENCRYPTION_FAILURE);
@@ -4558,6 +4658,60 @@ size_t QuicFramer::EncryptInPlace(EncryptionLevel level,
   return ad_len + output_length;
 }
 
+bool QuicFramer::EncryptInPlaceBatch(
+    absl::Span<PendingInPlaceEncryption> batch) {
+  size_t start = 0;
+  while (start < batch.size()) {
+    const EncryptionLevel level = batch[start].level;
+    if (encrypter_[level] == nullptr) {
+      QUIC_BUG(quic_framer_batch_encrypt_no_encrypter)
+          << ENDPOINT
+          << "Attempted to batch encrypt without encrypter at level " << level;
+      RaiseError(QUIC_ENCRYPTION_FAILURE);
+      return false;
+    }
+    size_t end = start;
+    while (end < batch.size() && batch[end].level == level) {
+      ++end;
+    }
+
+    std::vector<size_t> output_lengths(end - start, 0);
+    std::vector<QuicPacketEncryptionTask> tasks;
+    tasks.reserve(end - start);
+    for (size_t i = start; i < end; ++i) {
+      PendingInPlaceEncryption& pending = batch[i];
+      QUICHE_DCHECK(pending.packet_number.IsInitialized());
+      pending.encrypted_length = 0;
+      tasks.push_back(
+          {pending.packet_number.ToUint64(),
+           absl::string_view(pending.buffer, pending.ad_len),
+           absl::string_view(pending.buffer + pending.ad_len,
+                             pending.total_len - pending.ad_len),
+           pending.buffer + pending.ad_len, &output_lengths[i - start],
+           pending.buffer_len - pending.ad_len});
+    }
+    if (!encrypter_[level]->EncryptPacketBatch(absl::MakeSpan(tasks))) {
+      RaiseError(QUIC_ENCRYPTION_FAILURE);
+      return false;
+    }
+    for (size_t i = start; i < end; ++i) {
+      PendingInPlaceEncryption& pending = batch[i];
+      const size_t output_length = output_lengths[i - start];
+      if (version_has_header_protection_ &&
+          !ApplyHeaderProtection(level, pending.buffer,
+                                 pending.ad_len + output_length,
+                                 pending.ad_len)) {
+        QUIC_DLOG(ERROR) << "Applying header protection failed.";
+        RaiseError(QUIC_ENCRYPTION_FAILURE);
+        return false;
+      }
+      pending.encrypted_length = pending.ad_len + output_length;
+    }
+    start = end;
+  }
+  return true;
+}
+
 namespace {
 
 const size_t kHPSampleLen = 16;
@@ -4809,14 +4963,14 @@ size_t QuicFramer::EncryptPayload(EncryptionLevel level,
   memmove(buffer, associated_data.data(), ad_len);
   // Encrypt the plaintext into the buffer.
   size_t output_length = 0;
-  if (!encrypter_[level]->EncryptPacket(
-          packet_number.ToUint64(), associated_data,
+  if (!EncryptPacketAtLevel(
+          level, packet_number.ToUint64(), associated_data,
           packet.Plaintext(version_.transport_version), buffer + ad_len,
           &output_length, buffer_len - ad_len)) {
     RaiseError(QUIC_ENCRYPTION_FAILURE);
     return 0;
   }
-  if (version_.HasHeaderProtection() &&
+  if (version_has_header_protection_ &&
       !ApplyHeaderProtection(level, buffer, ad_len + output_length, ad_len)) {
     QUIC_DLOG(ERROR) << "Applying header protection failed.";
     RaiseError(QUIC_ENCRYPTION_FAILURE);
@@ -4871,6 +5025,8 @@ bool QuicFramer::DecryptPayload(size_t udp_packet_length,
                                 size_t buffer_length,
                                 size_t* decrypted_length,
                                 EncryptionLevel* decrypted_level) {
+  QuicScopedStageLatencySampler latency_sampler(
+      QuicStageLatencyRecorder::kDecryptPacket);
   if (!EncryptionLevelIsValid(decrypter_level_)) {
     QUIC_BUG(quic_bug_10850_67)
         << "Attempted to decrypt with bad decrypter_level_";
@@ -4878,10 +5034,12 @@ bool QuicFramer::DecryptPayload(size_t udp_packet_length,
   }
   EncryptionLevel level = decrypter_level_;
   QuicDecrypter* decrypter = decrypter_[level].get();
+  AeadBaseDecrypter* aead_decrypter = aead_decrypter_[level];
   QuicDecrypter* alternative_decrypter = nullptr;
   bool key_phase_parsed = false;
   bool key_phase;
   bool attempt_key_update = false;
+  bool used_previous_decrypter = false;
   if (version().KnowsWhichDecrypterToUse()) {
     if (header.form == GOOGLE_QUIC_PACKET) {
       QUIC_BUG(quic_bug_10850_68)
@@ -4895,6 +5053,7 @@ bool QuicFramer::DecryptPayload(size_t udp_packet_length,
       return false;
     }
     decrypter = decrypter_[level].get();
+    aead_decrypter = aead_decrypter_[level];
     if (decrypter == nullptr) {
       return false;
     }
@@ -4924,18 +5083,22 @@ bool QuicFramer::DecryptPayload(size_t udp_packet_length,
               QUIC_BUG(quic_bug_10850_70) << "Failed to create next_decrypter";
               return false;
             }
+            RefreshAeadCrypterCaches();
           }
           QUIC_DVLOG(1) << ENDPOINT << "packet " << header.packet_number
                         << " attempt_key_update=true";
           attempt_key_update = true;
           potential_peer_key_update_attempt_count_++;
           decrypter = next_decrypter_.get();
+          aead_decrypter = aead_next_decrypter_;
         } else {
           if (previous_decrypter_) {
             QUIC_DVLOG(1) << ENDPOINT
                           << "trying previous_decrypter_ for packet "
                           << header.packet_number;
             decrypter = previous_decrypter_.get();
+            aead_decrypter = aead_previous_decrypter_;
+            used_previous_decrypter = true;
           } else {
             QUIC_DVLOG(1) << ENDPOINT << "dropping packet "
                           << header.packet_number << " with old key phase";
@@ -4960,9 +5123,32 @@ bool QuicFramer::DecryptPayload(size_t udp_packet_length,
     return false;
   }
 
-  bool success = decrypter->DecryptPacket(
-      header.packet_number.ToUint64(), associated_data, encrypted,
-      decrypted_buffer, decrypted_length, buffer_length);
+  // Open through the devirtualized AEAD entry point when the decrypter is
+  // an AEAD one; the virtual interface is only needed for the null decrypter
+  // and for setup.
+  bool success =
+      aead_decrypter != nullptr
+          ? aead_decrypter->DecryptPacket(header.packet_number.ToUint64(),
+                                          associated_data, encrypted,
+                                          decrypted_buffer, decrypted_length,
+                                          buffer_length)
+          : decrypter->DecryptPacket(header.packet_number.ToUint64(),
+                                     associated_data, encrypted,
+                                     decrypted_buffer, decrypted_length,
+                                     buffer_length);
+  if (key_phase_parsed) {
+    // Record which set of keys the phase bit selected, and whether the
+    // prediction paid off.
+    if (!success) {
+      ++key_phase_decryption_stats_.misses;
+    } else if (attempt_key_update) {
+      ++key_phase_decryption_stats_.next_key_hits;
+    } else if (used_previous_decrypter) {
+      ++key_phase_decryption_stats_.previous_key_hits;
+    } else {
+      ++key_phase_decryption_stats_.current_key_hits;
+    }
+  }
   if (success) {
     visitor_->OnDecryptedPacket(udp_packet_length, level);
     if (level == ENCRYPTION_ZERO_RTT &&
@@ -5595,6 +5781,19 @@ void QuicFramer::set_version(const ParsedQuicVersion version) {
   QUICHE_DCHECK(IsSupportedVersion(version))
       << ParsedQuicVersionToString(version);
   version_ = version;
+  CacheVersionPredicates();
+}
+
+void QuicFramer::CacheVersionPredicates() {
+  if (!version_.IsKnown()) {
+    // Callers may assign an unsupported version to trigger version
+    // negotiation; the predicates below would DCHECK on it.
+    version_has_ietf_invariant_header_ = false;
+    version_has_header_protection_ = false;
+    return;
+  }
+  version_has_ietf_invariant_header_ = version_.HasIetfInvariantHeader();
+  version_has_header_protection_ = version_.HasHeaderProtection();
 }
 
 bool QuicFramer::AppendAckFrameAndTypeByte(const QuicAckFrame& frame,
@@ -5811,7 +6010,7 @@ bool QuicFramer::AppendTimestampsToAckFrame(const QuicAckFrame& frame,
 bool QuicFramer::AppendStopWaitingFrame(const QuicPacketHeader& header,
                                         const QuicStopWaitingFrame& frame,
                                         QuicDataWriter* writer) {
-  QUICHE_DCHECK(!version_.HasIetfInvariantHeader());
+  QUICHE_DCHECK(!version_has_ietf_invariant_header_);
   QUICHE_DCHECK(frame.least_unacked.IsInitialized());
   QUICHE_DCHECK_GE(header.packet_number, frame.least_unacked);
   const uint64_t least_unacked_delta =
@@ -5900,20 +6099,38 @@ bool QuicFramer::AppendIetfAckFrameAndTypeByte(const QuicAckFrame& frame,
   ++iter;
   // Append remaining ACK blocks.
   uint64_t appended_ack_blocks = 0;
+  // An ACK block costs at most two 8-byte varints. While at least that much
+  // room is left after reserving the ECN counts, the two writes below cannot
+  // fail, so the per-block capacity arithmetic can be skipped. With frames
+  // carrying hundreds of blocks this fast path covers nearly every
+  // iteration; only the last few blocks before truncation take the exact
+  // (and more expensive) check.
+  constexpr size_t kMaxBytesPerAckBlock = 16;
+  size_t capacity =
+      writer->remaining() < ecn_size ? 0 : writer->remaining() - ecn_size;
   for (; iter != frame.packets.rend(); ++iter) {
     const uint64_t gap = previous_smallest - iter->max() - 1;
     const uint64_t ack_range = iter->Length() - 1;
 
-    if (writer->remaining() < ecn_size ||
-        writer->remaining() - ecn_size <
-            static_cast<size_t>(QuicDataWriter::GetVarInt62Len(gap) +
-                                QuicDataWriter::GetVarInt62Len(ack_range))) {
-      // ACK range does not fit, truncate it.
-      break;
+    if (capacity >= kMaxBytesPerAckBlock) {
+      const size_t length_before = writer->length();
+      const bool success =
+          writer->WriteVarInt62(gap) && writer->WriteVarInt62(ack_range);
+      QUICHE_DCHECK(success);
+      capacity -= writer->length() - length_before;
+    } else {
+      const size_t block_size =
+          static_cast<size_t>(QuicDataWriter::GetVarInt62Len(gap) +
+                              QuicDataWriter::GetVarInt62Len(ack_range));
+      if (capacity < block_size) {
+        // ACK range does not fit, truncate it.
+        break;
+      }
+      const bool success =
+          writer->WriteVarInt62(gap) && writer->WriteVarInt62(ack_range);
+      QUICHE_DCHECK(success);
+      capacity -= block_size;
     }
-    const bool success =
-        writer->WriteVarInt62(gap) && writer->WriteVarInt62(ack_range);
-    QUICHE_DCHECK(success);
     previous_smallest = iter->min();
     ++appended_ack_blocks;
   }
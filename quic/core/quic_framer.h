@@ -11,6 +11,7 @@
 #include <string>
 
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "quic/core/crypto/quic_decrypter.h"
 #include "quic/core/crypto/quic_encrypter.h"
 #include "quic/core/crypto/quic_random.h"
@@ -163,6 +164,16 @@ class QUIC_EXPORT_PRIVATE QuicFramerVisitorInterface {
   virtual bool OnAckTimestamp(QuicPacketNumber packet_number,
                               QuicTime timestamp) = 0;
 
+  // Called when the ECN counts of an IETF ACK_ECN frame have been parsed,
+  // after the last OnAckRange() and before OnAckFrameEnd(). The counts are
+  // cumulative over the lifetime of the connection. The default
+  // implementation ignores ECN feedback.
+  virtual bool OnAckFrameEcnCounts(QuicPacketCount /*ect_0_count*/,
+                                   QuicPacketCount /*ect_1_count*/,
+                                   QuicPacketCount /*ecn_ce_count*/) {
+    return true;
+  }
+
   // Called after the last ack range in an AckFrame has been parsed.
   // |start| is the starting value of the last ack range.
   virtual bool OnAckFrameEnd(QuicPacketNumber start) = 0;
@@ -304,6 +315,7 @@ class QUIC_EXPORT_PRIVATE QuicFramer {
   // unsupported version to trigger version negotiation.
   void set_version_for_tests(const ParsedQuicVersion version) {
     version_ = version;
+    CacheVersionPredicates();
   }
 
   QuicErrorCode error() const { return error_; }
@@ -327,6 +339,22 @@ class QUIC_EXPORT_PRIVATE QuicFramer {
   // ignored.
   bool ProcessPacket(const QuicEncryptedPacket& packet);
 
+  // When true, IETF packets are decrypted in place: the plaintext overwrites
+  // the ciphertext in the packet buffer and frame parsing operates on that
+  // same buffer, instead of copying the plaintext into a separate buffer.
+  // The caller thereby lends the packet buffer to the framer for the duration
+  // of ProcessPacket() and must not read the payload bytes afterwards, since
+  // a failed decryption attempt leaves them garbled. Only safe when every
+  // installed decrypter is an AEAD, which supports exactly aliased input and
+  // output buffers (true for all TLS versions), and when an undecryptable
+  // packet will be dropped rather than buffered for a later retry.
+  void set_allow_in_place_decryption(bool allow) {
+    allow_in_place_decryption_ = allow;
+  }
+  bool allow_in_place_decryption() const {
+    return allow_in_place_decryption_;
+  }
+
   // Whether we are in the middle of a call to this->ProcessPacket.
   bool is_processing_packet() const { return is_processing_packet_; }
 
@@ -560,10 +588,37 @@ class QUIC_EXPORT_PRIVATE QuicFramer {
   // successfully decrypted packet.
   QuicPacketCount PotentialPeerKeyUpdateAttemptCount() const;
 
+  // Counters for key-phase-aware 1-RTT decryption, recording which set of
+  // keys the header's key phase bit selected and whether the AEAD attempt
+  // succeeded. Only updated on connections with key update support.
+  struct QUIC_EXPORT_PRIVATE KeyPhaseDecryptionStats {
+    QuicPacketCount current_key_hits = 0;
+    QuicPacketCount next_key_hits = 0;
+    QuicPacketCount previous_key_hits = 0;
+    QuicPacketCount misses = 0;
+  };
+  const KeyPhaseDecryptionStats& key_phase_decryption_stats() const {
+    return key_phase_decryption_stats_;
+  }
+
+  // If enabled, the decrypter for the next key phase is derived eagerly at
+  // the end of each key update instead of on the first short header packet
+  // whose key phase bit flips, so reordered packets around an update
+  // boundary never pay key derivation on the packet path.
+  void set_speculative_next_key_derivation(bool enabled) {
+    speculative_next_key_derivation_ = enabled;
+  }
+  bool speculative_next_key_derivation() const {
+    return speculative_next_key_derivation_;
+  }
+
   const QuicDecrypter* GetDecrypter(EncryptionLevel level) const;
   const QuicDecrypter* decrypter() const;
   const QuicDecrypter* alternative_decrypter() const;
 
+  // Returns the encrypter of |level|, or nullptr if none is set.
+  const QuicEncrypter* GetEncrypter(EncryptionLevel level) const;
+
   // Changes the encrypter used for level |level| to |encrypter|.
   void SetEncrypter(EncryptionLevel level,
                     std::unique_ptr<QuicEncrypter> encrypter);
@@ -584,6 +639,27 @@ class QUIC_EXPORT_PRIVATE QuicFramer {
                         size_t buffer_len,
                         char* buffer);
 
+  // Describes one serialized plaintext packet awaiting in-place encryption.
+  // The fields mirror the arguments of EncryptInPlace; |encrypted_length| is
+  // filled in by EncryptInPlaceBatch.
+  struct QUIC_EXPORT_PRIVATE PendingInPlaceEncryption {
+    EncryptionLevel level;
+    QuicPacketNumber packet_number;
+    size_t ad_len;
+    size_t total_len;
+    size_t buffer_len;
+    char* buffer;
+    size_t encrypted_length = 0;
+  };
+
+  // Encrypts a batch of serialized packets, equivalent to calling
+  // EncryptInPlace for each entry in order. Runs of entries at the same
+  // encryption level are handed to the encrypter as one batch, so that
+  // multi-buffer AEAD implementations can interleave the per-packet block
+  // operations. Returns false and raises QUIC_ENCRYPTION_FAILURE if any
+  // entry fails to encrypt.
+  bool EncryptInPlaceBatch(absl::Span<PendingInPlaceEncryption> batch);
+
   // Returns the length of the data encrypted into |buffer| if |buffer_len| is
   // long enough, and otherwise 0.
   size_t EncryptPayload(EncryptionLevel level,
@@ -883,6 +959,21 @@ class QUIC_EXPORT_PRIVATE QuicFramer {
                       size_t* decrypted_length,
                       EncryptionLevel* decrypted_level);
 
+  // Encrypts one packet with the encrypter at |level|, through the
+  // devirtualized AEAD entry point when there is one; see aead_encrypter_.
+  bool EncryptPacketAtLevel(EncryptionLevel level,
+                            uint64_t packet_number,
+                            absl::string_view associated_data,
+                            absl::string_view plaintext,
+                            char* output,
+                            size_t* output_length,
+                            size_t max_output_length);
+
+  // Re-derives the devirtualized AEAD views (aead_encrypter_ and friends)
+  // from the installed crypters. Must be called whenever one of them
+  // changes.
+  void RefreshAeadCrypterCaches();
+
   // Returns the full packet number from the truncated
   // wire format version and the last seen packet number.
   uint64_t CalculatePacketNumberFromWire(
@@ -1071,6 +1162,10 @@ class QUIC_EXPORT_PRIVATE QuicFramer {
 
   void set_error(QuicErrorCode error) { error_ = error; }
 
+  // Refreshes the cached version predicates below. Must be called whenever
+  // |version_| is assigned.
+  void CacheVersionPredicates();
+
   void set_detailed_error(const char* error) { detailed_error_ = error; }
   void set_detailed_error(std::string error) { detailed_error_ = error; }
 
@@ -1095,6 +1190,12 @@ class QUIC_EXPORT_PRIVATE QuicFramer {
   QuicConnectionId last_serialized_client_connection_id_;
   // Version of the protocol being used.
   ParsedQuicVersion version_;
+  // Version predicates consulted on the hot parse path, cached by
+  // CacheVersionPredicates() whenever |version_| changes. Field parsing tests
+  // a flag instead of calling out to ParsedQuicVersion, so with a single
+  // negotiated version the version branches become trivially predictable.
+  bool version_has_ietf_invariant_header_;
+  bool version_has_header_protection_;
   // This vector contains QUIC versions which we currently support.
   // This should be ordered such that the highest supported version is the first
   // element, with subsequent elements in descending order (versions can be
@@ -1114,6 +1215,16 @@ class QUIC_EXPORT_PRIVATE QuicFramer {
   bool alternative_decrypter_latch_;
   // Encrypters used to encrypt packets via EncryptPayload().
   std::unique_ptr<QuicEncrypter> encrypter_[NUM_ENCRYPTION_LEVELS];
+  // Devirtualized views of the crypters above, non-null where the installed
+  // crypter is an AEAD one (every negotiated cipher is). The per-packet
+  // seal/open calls go through these so they bind the concrete
+  // implementation directly; the virtual interface is only used for setup
+  // and for non-AEAD crypters such as the null crypters. Refreshed by
+  // RefreshAeadCrypterCaches() whenever an installed crypter changes.
+  AeadBaseEncrypter* aead_encrypter_[NUM_ENCRYPTION_LEVELS] = {};
+  AeadBaseDecrypter* aead_decrypter_[NUM_ENCRYPTION_LEVELS] = {};
+  AeadBaseDecrypter* aead_previous_decrypter_ = nullptr;
+  AeadBaseDecrypter* aead_next_decrypter_ = nullptr;
   // Tracks if the framer is being used by the entity that received the
   // connection or the entity that initiated it.
   Perspective perspective_;
@@ -1153,6 +1264,11 @@ class QUIC_EXPORT_PRIVATE QuicFramer {
   // Decrypter for the next key phase. May be null if next keys haven't been
   // generated yet.
   std::unique_ptr<QuicDecrypter> next_decrypter_;
+  // Whether to stage next_decrypter_ eagerly after each key update. See
+  // set_speculative_next_key_derivation().
+  bool speculative_next_key_derivation_ = false;
+  // Per-phase decryption hit/miss counters.
+  KeyPhaseDecryptionStats key_phase_decryption_stats_;
 
   // If this is a framer of a connection, this is the packet number of first
   // sending packet. If this is a framer of a framer of dispatcher, this is the
@@ -1166,6 +1282,10 @@ class QUIC_EXPORT_PRIVATE QuicFramer {
   // Whether we are in the middle of a call to this->ProcessPacket.
   bool is_processing_packet_ = false;
 
+  // If true, IETF packets are decrypted into the packet buffer itself rather
+  // than into a separate buffer. See set_allow_in_place_decryption().
+  bool allow_in_place_decryption_ = false;
+
   // If true, framer infers packet header type (IETF/GQUIC) from version_.
   // Otherwise, framer infers packet header type from first byte of a received
   // packet.
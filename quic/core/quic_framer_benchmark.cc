@@ -0,0 +1,103 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "common/platform/api/quiche_benchmark.h"
+#include "quic/core/crypto/null_decrypter.h"
+#include "quic/core/quic_framer.h"
+#include "quic/core/quic_packets.h"
+#include "quic/core/quic_utils.h"
+#include "quic/core/quic_versions.h"
+#include "quic/test_tools/quic_test_utils.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+// Parses one encrypted stream-data packet per supported version,
+// round-robin, so every wire format stays covered.
+void BM_FramerProcessStreamPacket(quiche::QuicheBenchmarkState& state) {
+  std::vector<std::unique_ptr<QuicFramer>> framers;
+  std::vector<std::unique_ptr<QuicEncryptedPacket>> packets;
+  NoOpFramerVisitor visitor;
+  int64_t bytes_per_round = 0;
+  for (const ParsedQuicVersion& version : AllSupportedVersions()) {
+    ParsedQuicVersionVector versions = {version};
+    auto framer = std::make_unique<QuicFramer>(versions, QuicTime::Zero(),
+                                               Perspective::IS_SERVER,
+                                               kQuicDefaultConnectionIdLength);
+    if (framer->version().KnowsWhichDecrypterToUse()) {
+      framer->InstallDecrypter(
+          ENCRYPTION_INITIAL,
+          std::make_unique<NullDecrypter>(Perspective::IS_SERVER));
+    } else {
+      framer->SetDecrypter(
+          ENCRYPTION_INITIAL,
+          std::make_unique<NullDecrypter>(Perspective::IS_SERVER));
+    }
+    framer->set_visitor(&visitor);
+    framer->InferPacketHeaderTypeFromVersion();
+    packets.emplace_back(ConstructEncryptedPacket(
+        TestConnectionId(1), EmptyQuicConnectionId(), /*version_flag=*/true,
+        /*reset_flag=*/false, /*packet_number=*/1, std::string(1200, 'q'),
+        CONNECTION_ID_PRESENT, CONNECTION_ID_ABSENT,
+        PACKET_4BYTE_PACKET_NUMBER, &versions));
+    bytes_per_round += packets.back()->length();
+    framers.push_back(std::move(framer));
+  }
+
+  size_t index = 0;
+  while (state.KeepRunning()) {
+    framers[index]->ProcessPacket(*packets[index]);
+    index = (index + 1) % framers.size();
+  }
+  state.SetBytesProcessed(state.iterations() *
+                          (bytes_per_round / framers.size()));
+}
+QUICHE_BENCHMARK(BM_FramerProcessStreamPacket);
+
+// Serializes a full-sized stream-data packet with the default version.
+void BM_FramerBuildStreamPacket(quiche::QuicheBenchmarkState& state) {
+  QuicFramer framer(AllSupportedVersions(), QuicTime::Zero(),
+                    Perspective::IS_CLIENT, kQuicDefaultConnectionIdLength);
+  framer.InferPacketHeaderTypeFromVersion();
+
+  QuicPacketHeader header;
+  header.destination_connection_id = TestConnectionId(1);
+  header.reset_flag = false;
+  header.version_flag = false;
+  header.packet_number = QuicPacketNumber(UINT64_C(0x12345678));
+  if (QuicVersionHasLongHeaderLengths(framer.transport_version())) {
+    header.length_length = VARIABLE_LENGTH_INTEGER_LENGTH_2;
+  }
+
+  const std::string payload(1200, 'q');
+  QuicStreamFrame stream_frame(
+      QuicUtils::GetFirstBidirectionalStreamId(framer.transport_version(),
+                                               Perspective::IS_CLIENT),
+      /*fin=*/false, /*offset=*/0, payload);
+  QuicFrames frames = {QuicFrame(stream_frame)};
+
+  char buffer[kMaxOutgoingPacketSize];
+  size_t length = 0;
+  while (state.KeepRunning()) {
+    length = framer.BuildDataPacket(header, frames, buffer,
+                                    kMaxOutgoingPacketSize,
+                                    ENCRYPTION_FORWARD_SECURE);
+  }
+  state.SetBytesProcessed(state.iterations() * length);
+}
+QUICHE_BENCHMARK(BM_FramerBuildStreamPacket);
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
+
+QUICHE_BENCHMARK_MAIN();
@@ -138,6 +138,7 @@ class TestEncrypter : public QuicEncrypter {
   absl::string_view GetNoncePrefix() const override {
     return absl::string_view();
   }
+  absl::string_view GetIV() const override { return absl::string_view(); }
 
   QuicPacketNumber packet_number_;
   std::string associated_data_;
@@ -186,6 +187,7 @@ class TestDecrypter : public QuicDecrypter {
   absl::string_view GetNoncePrefix() const override {
     return absl::string_view();
   }
+  absl::string_view GetIV() const override { return absl::string_view(); }
   // Use a distinct value starting with 0xFFFFFF, which is never used by TLS.
   uint32_t cipher_id() const override { return 0xFFFFFFF2; }
   QuicPacketCount GetIntegrityLimit() const override {
@@ -2353,6 +2355,101 @@ TEST_P(QuicFramerTest, StreamFrame) {
   CheckFramingBoundaries(fragments, QUIC_INVALID_STREAM_DATA);
 }
 
+TEST_P(QuicFramerTest, StreamFrameWithInPlaceDecryption) {
+  if (!framer_.version().HasIetfInvariantHeader()) {
+    // In-place decryption is only wired up for the IETF packet path.
+    return;
+  }
+  SetDecrypterLevel(ENCRYPTION_FORWARD_SECURE);
+  framer_.set_allow_in_place_decryption(true);
+
+  // clang-format off
+  PacketFragments packet46 = {
+      // type (short header, 4 byte packet number)
+      {"",
+       {0x43}},
+      // connection_id
+      {"",
+       {0xFE, 0xDC, 0xBA, 0x98, 0x76, 0x54, 0x32, 0x10}},
+      // packet number
+      {"",
+       {0x12, 0x34, 0x56, 0x78}},
+      // frame type (stream frame with fin)
+      {"",
+       {0xFF}},
+      // stream id
+      {"Unable to read stream_id.",
+       {0x01, 0x02, 0x03, 0x04}},
+      // offset
+      {"Unable to read offset.",
+       {0x3A, 0x98, 0xFE, 0xDC,
+        0x32, 0x10, 0x76, 0x54}},
+      {"Unable to read frame data.",
+       {
+         // data length
+         0x00, 0x0c,
+         // data
+         'h',  'e',  'l',  'l',
+         'o',  ' ',  'w',  'o',
+         'r',  'l',  'd',  '!'}},
+  };
+
+  PacketFragments packet_ietf = {
+      // type (short header, 4 byte packet number)
+      {"",
+       {0x43}},
+      // connection_id
+      {"",
+       {0xFE, 0xDC, 0xBA, 0x98, 0x76, 0x54, 0x32, 0x10}},
+      // packet number
+      {"",
+       {0x12, 0x34, 0x56, 0x78}},
+      // frame type - IETF_STREAM with FIN, LEN, and OFFSET bits set.
+      {"",
+       { 0x08 | 0x01 | 0x02 | 0x04 }},
+      // stream id
+      {"Unable to read IETF_STREAM frame stream id/count.",
+       {kVarInt62FourBytes + 0x01, 0x02, 0x03, 0x04}},
+      // offset
+      {"Unable to read stream data offset.",
+       {kVarInt62EightBytes + 0x3A, 0x98, 0xFE, 0xDC,
+        0x32, 0x10, 0x76, 0x54}},
+      // data length
+      {"Unable to read stream data length.",
+       {kVarInt62OneByte + 0x0c}},
+      // data
+      {"Unable to read frame data.",
+       { 'h',  'e',  'l',  'l',
+         'o',  ' ',  'w',  'o',
+         'r',  'l',  'd',  '!'}},
+  };
+  // clang-format on
+
+  PacketFragments& fragments =
+      VersionHasIetfQuicFrames(framer_.transport_version()) ? packet_ietf
+                                                            : packet46;
+  std::unique_ptr<QuicEncryptedPacket> encrypted(
+      AssemblePacketFromFragments(fragments));
+  EXPECT_TRUE(framer_.ProcessPacket(*encrypted));
+
+  EXPECT_THAT(framer_.error(), IsQuicNoError());
+  ASSERT_TRUE(visitor_.header_.get());
+
+  ASSERT_EQ(1u, visitor_.stream_frames_.size());
+  EXPECT_EQ(kStreamId, visitor_.stream_frames_[0]->stream_id);
+  EXPECT_TRUE(visitor_.stream_frames_[0]->fin);
+  EXPECT_EQ(kStreamOffset, visitor_.stream_frames_[0]->offset);
+  CheckStreamFrameData("hello world!", visitor_.stream_frames_[0].get());
+
+  // Frame parsing operated directly on the packet buffer: the stream data
+  // points into the packet rather than into a separate decryption buffer.
+  EXPECT_GE(visitor_.stream_frames_[0]->data_buffer, encrypted->data());
+  EXPECT_LE(
+      visitor_.stream_frames_[0]->data_buffer +
+          visitor_.stream_frames_[0]->data_length,
+      encrypted->data() + encrypted->length());
+}
+
 // Test an empty (no data) stream frame.
 TEST_P(QuicFramerTest, EmptyStreamFrame) {
   // Only the IETF QUIC spec explicitly says that empty
@@ -9730,6 +9827,101 @@ TEST_P(QuicFramerTest, EncryptPacket) {
   EXPECT_TRUE(CheckEncryption(packet_number, raw.get()));
 }
 
+TEST_P(QuicFramerTest, EncryptInPlaceBatchMatchesEncryptInPlace) {
+  // clang-format off
+  unsigned char packet[] = {
+    // public flags (8 byte connection_id)
+    0x28,
+    // connection_id
+    0xFE, 0xDC, 0xBA, 0x98, 0x76, 0x54, 0x32, 0x10,
+    // packet number
+    0x12, 0x34, 0x56, 0x78,
+
+    // redundancy
+    'a',  'b',  'c',  'd',
+    'e',  'f',  'g',  'h',
+    'i',  'j',  'k',  'l',
+    'm',  'n',  'o',  'p',
+  };
+
+  unsigned char packet46[] = {
+    // type (short header, 4 byte packet number)
+    0x43,
+    // connection_id
+    0xFE, 0xDC, 0xBA, 0x98, 0x76, 0x54, 0x32, 0x10,
+    // packet number
+    0x12, 0x34, 0x56, 0x78,
+
+    // redundancy
+    'a',  'b',  'c',  'd',
+    'e',  'f',  'g',  'h',
+    'i',  'j',  'k',  'l',
+    'm',  'n',  'o',  'p',
+  };
+
+  unsigned char packet50[] = {
+    // type (short header, 4 byte packet number)
+    0x43,
+    // connection_id
+    0xFE, 0xDC, 0xBA, 0x98, 0x76, 0x54, 0x32, 0x10,
+    // packet number
+    0x12, 0x34, 0x56, 0x78,
+
+    // redundancy
+    'a',  'b',  'c',  'd',
+    'e',  'f',  'g',  'h',
+    'i',  'j',  'k',  'l',
+    'm',  'n',  'o',  'p',
+    'q',  'r',  's',  't',
+  };
+  // clang-format on
+
+  unsigned char* p = packet;
+  size_t p_size = ABSL_ARRAYSIZE(packet);
+  if (framer_.version().HasHeaderProtection()) {
+    p = packet50;
+    p_size = ABSL_ARRAYSIZE(packet50);
+  } else if (framer_.version().HasIetfInvariantHeader()) {
+    p = packet46;
+  }
+
+  std::unique_ptr<QuicPacket> raw(new QuicPacket(
+      AsChars(p), p_size, false, PACKET_8BYTE_CONNECTION_ID,
+      PACKET_0BYTE_CONNECTION_ID, !kIncludeVersion,
+      !kIncludeDiversificationNonce, PACKET_4BYTE_PACKET_NUMBER,
+      VARIABLE_LENGTH_INTEGER_LENGTH_0, 0, VARIABLE_LENGTH_INTEGER_LENGTH_0));
+  const size_t ad_len =
+      raw->AssociatedData(framer_.transport_version()).length();
+
+  char in_place_buffer[kMaxOutgoingPacketSize];
+  memcpy(in_place_buffer, p, p_size);
+  size_t in_place_length =
+      framer_.EncryptInPlace(ENCRYPTION_INITIAL, kPacketNumber, ad_len, p_size,
+                             kMaxOutgoingPacketSize, in_place_buffer);
+  ASSERT_NE(0u, in_place_length);
+
+  char batch_buffer1[kMaxOutgoingPacketSize];
+  char batch_buffer2[kMaxOutgoingPacketSize];
+  memcpy(batch_buffer1, p, p_size);
+  memcpy(batch_buffer2, p, p_size);
+  QuicFramer::PendingInPlaceEncryption batch[] = {
+      {ENCRYPTION_INITIAL, kPacketNumber, ad_len, p_size,
+       kMaxOutgoingPacketSize, batch_buffer1},
+      {ENCRYPTION_INITIAL, kPacketNumber + 1, ad_len, p_size,
+       kMaxOutgoingPacketSize, batch_buffer2},
+  };
+  ASSERT_TRUE(framer_.EncryptInPlaceBatch(absl::MakeSpan(batch)));
+
+  // Both entries were encrypted, and the batch path produces the same bytes
+  // as the single-packet path.
+  EXPECT_EQ(in_place_length, batch[0].encrypted_length);
+  EXPECT_EQ(in_place_length, batch[1].encrypted_length);
+  EXPECT_EQ(absl::string_view(in_place_buffer, in_place_length),
+            absl::string_view(batch_buffer1, batch[0].encrypted_length));
+  // The second entry's packet number is the last one seen by the encrypter.
+  EXPECT_EQ(kPacketNumber + 1, encrypter_->packet_number_);
+}
+
 // Regression test for b/158014497.
 TEST_P(QuicFramerTest, EncryptEmptyPacket) {
   auto packet = std::make_unique<QuicPacket>(
@@ -15074,6 +15266,126 @@ TEST_P(QuicFramerTest, KeyUpdate) {
   EXPECT_EQ(3, visitor_.decrypted_first_packet_in_key_phase_count_);
 }
 
+TEST_P(QuicFramerTest, SpeculativeNextKeyDerivation) {
+  if (!framer_.version().UsesTls()) {
+    // Key update is only used in QUIC+TLS.
+    return;
+  }
+  ASSERT_TRUE(framer_.version().KnowsWhichDecrypterToUse());
+  framer_.InstallDecrypter(ENCRYPTION_FORWARD_SECURE,
+                           std::make_unique<StrictTaggingDecrypter>(/*key=*/0));
+  framer_.SetKeyUpdateSupportForConnection(true);
+  framer_.set_speculative_next_key_derivation(true);
+
+  QuicPacketHeader header;
+  header.destination_connection_id = FramerTestConnectionId();
+  header.reset_flag = false;
+  header.version_flag = false;
+  header.packet_number = kPacketNumber;
+
+  QuicFrames frames = {QuicFrame(QuicPaddingFrame())};
+
+  QuicFramerPeer::SetPerspective(&framer_, Perspective::IS_CLIENT);
+  std::unique_ptr<QuicPacket> data(BuildDataPacket(header, frames));
+  ASSERT_TRUE(data != nullptr);
+  std::unique_ptr<QuicEncryptedPacket> encrypted(
+      EncryptPacketWithTagAndPhase(*data, 0, false));
+  ASSERT_TRUE(encrypted);
+
+  QuicFramerPeer::SetPerspective(&framer_, Perspective::IS_SERVER);
+  EXPECT_TRUE(framer_.ProcessPacket(*encrypted));
+  // Processed valid packet in phase 0 with the current keys: no key update.
+  EXPECT_EQ(0u, visitor_.key_update_count());
+  EXPECT_EQ(0, visitor_.derive_next_key_count_);
+  EXPECT_EQ(1u, framer_.key_phase_decryption_stats().current_key_hits);
+
+  header.packet_number += 1;
+  QuicFramerPeer::SetPerspective(&framer_, Perspective::IS_CLIENT);
+  data = BuildDataPacket(header, frames);
+  ASSERT_TRUE(data != nullptr);
+  encrypted = EncryptPacketWithTagAndPhase(*data, 1, true);
+  ASSERT_TRUE(encrypted);
+  QuicFramerPeer::SetPerspective(&framer_, Perspective::IS_SERVER);
+  EXPECT_TRUE(framer_.ProcessPacket(*encrypted));
+  // Key update occurred, and the decrypter for the phase after this one was
+  // derived eagerly at the end of the update: two derivations, not one.
+  ASSERT_EQ(1u, visitor_.key_update_count());
+  EXPECT_EQ(2, visitor_.derive_next_key_count_);
+  EXPECT_EQ(1u, framer_.key_phase_decryption_stats().next_key_hits);
+
+  // A reordered packet from the previous key phase decrypts with the
+  // retained previous keys.
+  QuicPacketHeader old_header = header;
+  old_header.packet_number = kPacketNumber;
+  QuicFramerPeer::SetPerspective(&framer_, Perspective::IS_CLIENT);
+  data = BuildDataPacket(old_header, frames);
+  ASSERT_TRUE(data != nullptr);
+  encrypted = EncryptPacketWithTagAndPhase(*data, 0, false);
+  ASSERT_TRUE(encrypted);
+  QuicFramerPeer::SetPerspective(&framer_, Perspective::IS_SERVER);
+  EXPECT_TRUE(framer_.ProcessPacket(*encrypted));
+  EXPECT_EQ(1u, visitor_.key_update_count());
+  EXPECT_EQ(1u, framer_.key_phase_decryption_stats().previous_key_hits);
+
+  // The next key update decrypts its first packet with the staged decrypter
+  // (key=2) without deriving keys on the packet path; the only new
+  // derivation is the staging at the end of the update itself.
+  header.packet_number += 1;
+  QuicFramerPeer::SetPerspective(&framer_, Perspective::IS_CLIENT);
+  data = BuildDataPacket(header, frames);
+  ASSERT_TRUE(data != nullptr);
+  encrypted = EncryptPacketWithTagAndPhase(*data, 2, false);
+  ASSERT_TRUE(encrypted);
+  QuicFramerPeer::SetPerspective(&framer_, Perspective::IS_SERVER);
+  EXPECT_TRUE(framer_.ProcessPacket(*encrypted));
+  ASSERT_EQ(2u, visitor_.key_update_count());
+  EXPECT_EQ(3, visitor_.derive_next_key_count_);
+  EXPECT_EQ(2u, framer_.key_phase_decryption_stats().next_key_hits);
+  EXPECT_EQ(0u, framer_.key_phase_decryption_stats().misses);
+}
+
+TEST_P(QuicFramerTest, KeyPhaseDecryptionStatsMiss) {
+  if (!framer_.version().UsesTls()) {
+    // Key update is only used in QUIC+TLS.
+    return;
+  }
+  ASSERT_TRUE(framer_.version().KnowsWhichDecrypterToUse());
+  framer_.InstallDecrypter(ENCRYPTION_FORWARD_SECURE,
+                           std::make_unique<StrictTaggingDecrypter>(/*key=*/0));
+  framer_.SetKeyUpdateSupportForConnection(true);
+
+  QuicPacketHeader header;
+  header.destination_connection_id = FramerTestConnectionId();
+  header.reset_flag = false;
+  header.version_flag = false;
+  header.packet_number = kPacketNumber;
+
+  QuicFrames frames = {QuicFrame(QuicPaddingFrame())};
+
+  QuicFramerPeer::SetPerspective(&framer_, Perspective::IS_CLIENT);
+  std::unique_ptr<QuicPacket> data(BuildDataPacket(header, frames));
+  ASSERT_TRUE(data != nullptr);
+  std::unique_ptr<QuicEncryptedPacket> encrypted(
+      EncryptPacketWithTagAndPhase(*data, 0, false));
+  ASSERT_TRUE(encrypted);
+  QuicFramerPeer::SetPerspective(&framer_, Perspective::IS_SERVER);
+  EXPECT_TRUE(framer_.ProcessPacket(*encrypted));
+  EXPECT_EQ(1u, framer_.key_phase_decryption_stats().current_key_hits);
+  EXPECT_EQ(0u, framer_.key_phase_decryption_stats().misses);
+
+  // A packet encrypted with the wrong key but an unchanged phase bit fails
+  // AEAD with the current keys and is counted as a miss.
+  header.packet_number += 1;
+  QuicFramerPeer::SetPerspective(&framer_, Perspective::IS_CLIENT);
+  data = BuildDataPacket(header, frames);
+  ASSERT_TRUE(data != nullptr);
+  encrypted = EncryptPacketWithTagAndPhase(*data, 1, false);
+  ASSERT_TRUE(encrypted);
+  QuicFramerPeer::SetPerspective(&framer_, Perspective::IS_SERVER);
+  EXPECT_FALSE(framer_.ProcessPacket(*encrypted));
+  EXPECT_EQ(1u, framer_.key_phase_decryption_stats().misses);
+}
+
 TEST_P(QuicFramerTest, KeyUpdateOldPacketAfterUpdate) {
   if (!framer_.version().UsesTls()) {
     // Key update is only used in QUIC+TLS.
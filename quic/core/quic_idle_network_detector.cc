@@ -36,10 +36,37 @@ QuicIdleNetworkDetector::QuicIdleNetworkDetector(
       time_of_last_received_packet_(now),
       time_of_first_packet_sent_after_receiving_(QuicTime::Zero()),
       idle_network_timeout_(QuicTime::Delta::Infinite()),
+      memory_reclaim_timeout_(QuicTime::Delta::Infinite()),
       alarm_(alarm_factory->CreateAlarm(
-          arena->New<AlarmDelegate>(this, context), arena)) {}
+          arena->New<AlarmDelegate>(this, context), arena)) {
+  // Handshake, idle and memory-reclaim deadlines are all multi-second, so
+  // the alarm can be batched with other alarms expiring in the same second
+  // instead of occupying its own slot in the precise timer heap.
+  alarm_->set_precision(QuicAlarm::Precision::kCoarse1s);
+}
 
 void QuicIdleNetworkDetector::OnAlarm() {
+  if (!memory_reclaim_timeout_.IsInfinite() && !memory_reclaim_fired_) {
+    // The alarm fires at the earliest deadline. If the memory reclaim
+    // deadline is no later than the connection-closing deadlines, this firing
+    // is the memory reclaim one: notify the delegate and re-arm for the
+    // remaining deadlines.
+    QuicTime close_deadline = QuicTime::Infinite();
+    if (!handshake_timeout_.IsInfinite()) {
+      close_deadline = start_time_ + handshake_timeout_;
+    }
+    if (!idle_network_timeout_.IsInfinite()) {
+      close_deadline = std::min(close_deadline, GetIdleNetworkDeadline());
+    }
+    if (GetMemoryReclaimDeadline() <= close_deadline) {
+      memory_reclaim_fired_ = true;
+      delegate_->OnMemoryReclaimTimeout();
+      if (!stopped_) {
+        SetAlarm();
+      }
+      return;
+    }
+  }
   if (handshake_timeout_.IsInfinite()) {
     delegate_->OnIdleNetworkDetected();
     return;
@@ -65,10 +92,19 @@ void QuicIdleNetworkDetector::SetTimeouts(
   SetAlarm();
 }
 
+void QuicIdleNetworkDetector::SetMemoryReclaimTimeout(
+    QuicTime::Delta memory_reclaim_timeout) {
+  memory_reclaim_timeout_ = memory_reclaim_timeout;
+  memory_reclaim_fired_ = false;
+
+  SetAlarm();
+}
+
 void QuicIdleNetworkDetector::StopDetection() {
   alarm_->PermanentCancel();
   handshake_timeout_ = QuicTime::Delta::Infinite();
   idle_network_timeout_ = QuicTime::Delta::Infinite();
+  memory_reclaim_timeout_ = QuicTime::Delta::Infinite();
   stopped_ = true;
 }
 
@@ -80,6 +116,7 @@ void QuicIdleNetworkDetector::OnPacketSent(QuicTime now,
   }
   time_of_first_packet_sent_after_receiving_ =
       std::max(time_of_first_packet_sent_after_receiving_, now);
+  memory_reclaim_fired_ = false;
   if (shorter_idle_timeout_on_sent_packet_) {
     MaybeSetAlarmOnSentPacket(pto_delay);
     return;
@@ -90,6 +127,7 @@ void QuicIdleNetworkDetector::OnPacketSent(QuicTime now,
 
 void QuicIdleNetworkDetector::OnPacketReceived(QuicTime now) {
   time_of_last_received_packet_ = std::max(time_of_last_received_packet_, now);
+  memory_reclaim_fired_ = false;
 
   SetAlarm();
 }
@@ -116,6 +154,14 @@ void QuicIdleNetworkDetector::SetAlarm() {
       new_deadline = idle_network_deadline;
     }
   }
+  if (!memory_reclaim_timeout_.IsInfinite() && !memory_reclaim_fired_) {
+    const QuicTime memory_reclaim_deadline = GetMemoryReclaimDeadline();
+    if (new_deadline.IsInitialized()) {
+      new_deadline = std::min(new_deadline, memory_reclaim_deadline);
+    } else {
+      new_deadline = memory_reclaim_deadline;
+    }
+  }
   alarm_->Update(new_deadline, kAlarmGranularity);
 }
 
@@ -142,4 +188,11 @@ QuicTime QuicIdleNetworkDetector::GetIdleNetworkDeadline() const {
   return last_network_activity_time() + idle_network_timeout_;
 }
 
+QuicTime QuicIdleNetworkDetector::GetMemoryReclaimDeadline() const {
+  if (memory_reclaim_timeout_.IsInfinite()) {
+    return QuicTime::Zero();
+  }
+  return last_network_activity_time() + memory_reclaim_timeout_;
+}
+
 }  // namespace quic
@@ -22,7 +22,9 @@ class QuicIdleNetworkDetectorTestPeer;
 // QuicIdleNetworkDetector detects handshake timeout and idle network timeout.
 // Handshake timeout detection is disabled after handshake completes. Idle
 // network deadline is extended by network activity (e.g., sending or receiving
-// packets).
+// packets). It can additionally notify the delegate when the network has been
+// idle for a (typically much shorter) memory reclaim period, so per-connection
+// buffers can be released while the connection stays open.
 class QUIC_EXPORT_PRIVATE QuicIdleNetworkDetector {
  public:
   class QUIC_EXPORT_PRIVATE Delegate {
@@ -34,6 +36,10 @@ class QUIC_EXPORT_PRIVATE QuicIdleNetworkDetector {
 
     // Called when idle network has been detected.
     virtual void OnIdleNetworkDetected() = 0;
+
+    // Called when the network has been idle for the memory reclaim period.
+    // Fired at most once per idle period; network activity re-arms it.
+    virtual void OnMemoryReclaimTimeout() = 0;
   };
 
   QuicIdleNetworkDetector(Delegate* delegate, QuicTime now,
@@ -47,6 +53,10 @@ class QUIC_EXPORT_PRIVATE QuicIdleNetworkDetector {
   void SetTimeouts(QuicTime::Delta handshake_timeout,
                    QuicTime::Delta idle_network_timeout);
 
+  // Called to set memory_reclaim_timeout_. Infinite (the default) disables
+  // memory reclaim notifications.
+  void SetMemoryReclaimTimeout(QuicTime::Delta memory_reclaim_timeout);
+
   // Stop the detection once and for all.
   void StopDetection();
 
@@ -73,6 +83,10 @@ class QUIC_EXPORT_PRIVATE QuicIdleNetworkDetector {
 
   QuicTime::Delta idle_network_timeout() const { return idle_network_timeout_; }
 
+  QuicTime::Delta memory_reclaim_timeout() const {
+    return memory_reclaim_timeout_;
+  }
+
   QuicTime GetIdleNetworkDeadline() const;
 
  private:
@@ -81,6 +95,8 @@ class QUIC_EXPORT_PRIVATE QuicIdleNetworkDetector {
 
   void SetAlarm();
 
+  QuicTime GetMemoryReclaimDeadline() const;
+
   void MaybeSetAlarmOnSentPacket(QuicTime::Delta pto_delay);
 
   Delegate* delegate_;  // Not owned.
@@ -105,6 +121,13 @@ class QUIC_EXPORT_PRIVATE QuicIdleNetworkDetector {
   // Idle network timeout. Infinit means no idle network timeout.
   QuicTime::Delta idle_network_timeout_;
 
+  // Memory reclaim timeout. Infinite means no memory reclaim notifications.
+  QuicTime::Delta memory_reclaim_timeout_;
+
+  // Whether OnMemoryReclaimTimeout has fired for the current idle period.
+  // Reset when the idle network deadline gets extended.
+  bool memory_reclaim_fired_ = false;
+
   QuicArenaScopedPtr<QuicAlarm> alarm_;
 
   bool shorter_idle_timeout_on_sent_packet_ = false;
@@ -25,6 +25,7 @@ class MockDelegate : public QuicIdleNetworkDetector::Delegate {
  public:
   MOCK_METHOD(void, OnHandshakeTimeout, (), (override));
   MOCK_METHOD(void, OnIdleNetworkDetected, (), (override));
+  MOCK_METHOD(void, OnMemoryReclaimTimeout, (), (override));
 };
 
 class QuicIdleNetworkDetectorTest : public QuicTest {
@@ -183,6 +184,58 @@ TEST_F(QuicIdleNetworkDetectorTest, ShorterIdleTimeoutOnSentPacket) {
   EXPECT_EQ(clock_.Now() + QuicTime::Delta::FromSeconds(2), alarm_->deadline());
 }
 
+TEST_F(QuicIdleNetworkDetectorTest, MemoryReclaimTimeoutBeforeIdleTimeout) {
+  detector_->SetTimeouts(
+      /*handshake_timeout=*/QuicTime::Delta::Infinite(),
+      /*idle_network_timeout=*/QuicTime::Delta::FromSeconds(600));
+  detector_->SetMemoryReclaimTimeout(QuicTime::Delta::FromSeconds(60));
+  // The alarm fires at the earlier memory reclaim deadline.
+  EXPECT_EQ(clock_.Now() + QuicTime::Delta::FromSeconds(60),
+            alarm_->deadline());
+
+  const QuicTime start_time = clock_.Now();
+  clock_.AdvanceTime(QuicTime::Delta::FromSeconds(60));
+  EXPECT_CALL(delegate_, OnMemoryReclaimTimeout());
+  alarm_->Fire();
+  // The alarm gets re-armed for the idle network deadline; memory reclaim
+  // does not fire again within the same idle period.
+  EXPECT_EQ(start_time + QuicTime::Delta::FromSeconds(600),
+            alarm_->deadline());
+
+  // Receiving a packet arms a new memory reclaim deadline.
+  clock_.AdvanceTime(QuicTime::Delta::FromSeconds(100));
+  detector_->OnPacketReceived(clock_.Now());
+  EXPECT_EQ(clock_.Now() + QuicTime::Delta::FromSeconds(60),
+            alarm_->deadline());
+
+  const QuicTime receive_time = clock_.Now();
+  clock_.AdvanceTime(QuicTime::Delta::FromSeconds(60));
+  EXPECT_CALL(delegate_, OnMemoryReclaimTimeout());
+  alarm_->Fire();
+  EXPECT_EQ(receive_time + QuicTime::Delta::FromSeconds(600),
+            alarm_->deadline());
+
+  // With no further network activity, the idle timeout fires as usual.
+  clock_.AdvanceTime(QuicTime::Delta::FromSeconds(540));
+  EXPECT_CALL(delegate_, OnIdleNetworkDetected());
+  alarm_->Fire();
+}
+
+TEST_F(QuicIdleNetworkDetectorTest, MemoryReclaimTimeoutLongerThanIdleTimeout) {
+  detector_->SetTimeouts(
+      /*handshake_timeout=*/QuicTime::Delta::FromSeconds(30),
+      /*idle_network_timeout=*/QuicTime::Delta::FromSeconds(20));
+  detector_->SetMemoryReclaimTimeout(QuicTime::Delta::FromSeconds(60));
+  // The connection-closing deadline stays the earliest deadline.
+  EXPECT_EQ(clock_.Now() + QuicTime::Delta::FromSeconds(20),
+            alarm_->deadline());
+
+  // Memory reclaim never fires; the idle timeout wins.
+  clock_.AdvanceTime(QuicTime::Delta::FromSeconds(20));
+  EXPECT_CALL(delegate_, OnIdleNetworkDetected());
+  alarm_->Fire();
+}
+
 TEST_F(QuicIdleNetworkDetectorTest, NoAlarmAfterStopped) {
   detector_->StopDetection();
 
@@ -0,0 +1,65 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <cstdint>
+
+#include "common/platform/api/quiche_benchmark.h"
+#include "quic/core/quic_interval_set.h"
+
+namespace quic {
+namespace {
+
+// Number of packets tracked per simulated ACK workload.
+const uint64_t kNumPackets = 1000;
+
+// Every 32nd packet is initially missing, as under ~3% reordering or loss.
+const uint64_t kGapStride = 32;
+
+// Keeps results observable so the loops are not optimized away.
+volatile uint64_t sink = 0;
+
+// Builds the received-packets interval set of an ACK tracker: almost pure
+// appends, followed by late arrivals that fill the gaps.
+void BM_IntervalSetAckTracking(quiche::QuicheBenchmarkState& state) {
+  while (state.KeepRunning()) {
+    QuicIntervalSet<uint64_t> intervals;
+    for (uint64_t i = 0; i < kNumPackets; ++i) {
+      if (i % kGapStride == kGapStride - 1) {
+        continue;
+      }
+      intervals.AddOptimizedForAppend(i, i + 1);
+    }
+    for (uint64_t i = kGapStride - 1; i < kNumPackets; i += kGapStride) {
+      intervals.Add(i, i + 1);
+    }
+    sink += intervals.Size();
+  }
+}
+QUICHE_BENCHMARK(BM_IntervalSetAckTracking);
+
+// Membership queries against a gappy set, as done for every arriving packet
+// when deciding whether it is a duplicate.
+void BM_IntervalSetContains(quiche::QuicheBenchmarkState& state) {
+  QuicIntervalSet<uint64_t> intervals;
+  for (uint64_t i = 0; i < kNumPackets; ++i) {
+    if (i % kGapStride == kGapStride - 1) {
+      continue;
+    }
+    intervals.AddOptimizedForAppend(i, i + 1);
+  }
+
+  uint64_t hits = 0;
+  uint64_t packet = 0;
+  while (state.KeepRunning()) {
+    hits += intervals.Contains(packet) ? 1 : 0;
+    packet = (packet + 7) % kNumPackets;
+  }
+  sink += hits;
+}
+QUICHE_BENCHMARK(BM_IntervalSetContains);
+
+}  // namespace
+}  // namespace quic
+
+QUICHE_BENCHMARK_MAIN();
@@ -0,0 +1,145 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/quic_keepalive_offload.h"
+
+#include <algorithm>
+
+#include "quic/platform/api/quic_logging.h"
+
+namespace quic {
+
+namespace {
+
+class WheelTickAlarmDelegate : public QuicAlarm::DelegateWithoutContext {
+ public:
+  explicit WheelTickAlarmDelegate(QuicKeepaliveOffload* offload)
+      : offload_(offload) {}
+  WheelTickAlarmDelegate(const WheelTickAlarmDelegate&) = delete;
+  WheelTickAlarmDelegate& operator=(const WheelTickAlarmDelegate&) = delete;
+
+  void OnAlarm() override { offload_->OnWheelTick(); }
+
+ private:
+  // Not owned.
+  QuicKeepaliveOffload* offload_;
+};
+
+}  // namespace
+
+QuicKeepaliveOffload::QuicKeepaliveOffload(const QuicClock* clock,
+                                           QuicAlarmFactory* alarm_factory,
+                                           QuicTime::Delta tick_granularity)
+    : clock_(clock),
+      tick_granularity_(tick_granularity),
+      buckets_(kNumWheelBuckets),
+      last_serviced_tick_(TickForTime(clock->ApproximateNow())),
+      tick_alarm_(alarm_factory->CreateAlarm(new WheelTickAlarmDelegate(this))) {
+  QUICHE_DCHECK(!tick_granularity_.IsZero());
+}
+
+QuicKeepaliveOffload::~QuicKeepaliveOffload() {
+  tick_alarm_->Cancel();
+}
+
+void QuicKeepaliveOffload::RegisterConnection(QuicConnection* connection,
+                                              QuicTime::Delta interval) {
+  QUICHE_DCHECK(!interval.IsZero());
+  UnregisterConnection(connection);
+  const QuicTime deadline = clock_->ApproximateNow() + interval;
+  const size_t bucket_index = TickForTime(deadline) % kNumWheelBuckets;
+  Bucket& bucket = buckets_[bucket_index];
+  bucket.push_front(Entry{connection, interval, deadline});
+  entries_[connection] = std::make_pair(bucket_index, bucket.begin());
+  MaybeSetTickAlarm();
+}
+
+void QuicKeepaliveOffload::UnregisterConnection(QuicConnection* connection) {
+  auto it = entries_.find(connection);
+  if (it == entries_.end()) {
+    return;
+  }
+  buckets_[it->second.first].erase(it->second.second);
+  entries_.erase(it);
+  if (entries_.empty()) {
+    tick_alarm_->Cancel();
+  }
+}
+
+void QuicKeepaliveOffload::OnWheelTick() {
+  const QuicTime now = clock_->ApproximateNow();
+  const int64_t now_tick = TickForTime(now);
+  // If the wheel has been idle for longer than one rotation, one pass over
+  // every bucket reaches all overdue entries.
+  last_serviced_tick_ = std::max(
+      last_serviced_tick_, now_tick - static_cast<int64_t>(kNumWheelBuckets));
+  std::vector<QuicPacketWriter*> writers;
+  while (last_serviced_tick_ < now_tick) {
+    ++last_serviced_tick_;
+    ServiceBucket(&buckets_[last_serviced_tick_ % kNumWheelBuckets], now,
+                  &writers);
+  }
+  for (QuicPacketWriter* writer : writers) {
+    writer->Flush();
+  }
+  MaybeSetTickAlarm();
+}
+
+int64_t QuicKeepaliveOffload::TickForTime(QuicTime time) const {
+  return (time - QuicTime::Zero()).ToMicroseconds() /
+         tick_granularity_.ToMicroseconds();
+}
+
+void QuicKeepaliveOffload::ServiceBucket(
+    Bucket* bucket,
+    QuicTime now,
+    std::vector<QuicPacketWriter*>* writers) {
+  for (auto it = bucket->begin(); it != bucket->end();) {
+    if (it->deadline > now) {
+      // Due on a later rotation of the wheel.
+      ++it;
+      continue;
+    }
+    QuicConnection* connection = it->connection;
+    if (!connection->connected()) {
+      QUIC_DVLOG(1) << "Dropping closed connection "
+                    << connection->connection_id()
+                    << " from the keepalive wheel";
+      entries_.erase(connection);
+      it = bucket->erase(it);
+      continue;
+    }
+    connection->OnPingTimeout();
+    QuicPacketWriter* writer = connection->writer();
+    if (writer != nullptr && writer->IsBatchMode() &&
+        std::find(writers->begin(), writers->end(), writer) ==
+            writers->end()) {
+      writers->push_back(writer);
+    }
+    Entry entry = *it;
+    it = bucket->erase(it);
+    entry.deadline = now + entry.interval;
+    const size_t new_bucket_index = TickForTime(entry.deadline) % kNumWheelBuckets;
+    Bucket& new_bucket = buckets_[new_bucket_index];
+    // push_front keeps the entry out of this loop even when it hashes back
+    // into the bucket currently being serviced.
+    new_bucket.push_front(entry);
+    entries_[entry.connection] =
+        std::make_pair(new_bucket_index, new_bucket.begin());
+  }
+}
+
+void QuicKeepaliveOffload::MaybeSetTickAlarm() {
+  if (entries_.empty()) {
+    tick_alarm_->Cancel();
+    return;
+  }
+  const QuicTime next_tick_time =
+      QuicTime::Zero() +
+      QuicTime::Delta::FromMicroseconds((last_serviced_tick_ + 1) *
+                                        tick_granularity_.ToMicroseconds());
+  tick_alarm_->Update(next_tick_time, QuicTime::Delta::Zero());
+}
+
+}  // namespace quic
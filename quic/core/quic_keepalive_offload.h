@@ -0,0 +1,116 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_QUIC_KEEPALIVE_OFFLOAD_H_
+#define QUICHE_QUIC_CORE_QUIC_KEEPALIVE_OFFLOAD_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "quic/core/quic_alarm.h"
+#include "quic/core/quic_alarm_factory.h"
+#include "quic/core/quic_clock.h"
+#include "quic/core/quic_connection.h"
+#include "quic/core/quic_time.h"
+#include "quic/platform/api/quic_export.h"
+
+namespace quic {
+
+namespace test {
+class QuicKeepaliveOffloadTestPeer;
+}  // namespace test
+
+// Sends keepalive PINGs for a set of mostly-idle connections from a single
+// hashed timer wheel instead of one ping alarm per connection. Each wheel
+// tick services every connection whose keepalive deadline has passed, pinging
+// it through the connection's minimal ping path (no session OnCanWrite walk),
+// and flushes each distinct batch-mode writer once per tick so the pings of a
+// tick share syscalls. This keeps deployments with very large numbers of
+// hibernating connections down to one alarm pop per tick granularity rather
+// than one per connection per keepalive interval.
+//
+// Connections registered here should not also arm their own keepalive ping
+// alarm; server-perspective connections leave it unarmed by default.
+class QUIC_EXPORT_PRIVATE QuicKeepaliveOffload {
+ public:
+  // |clock| and |alarm_factory| are owned by the caller and must outlive this
+  // object. |tick_granularity| bounds how late a keepalive may fire and must
+  // be positive; keepalive intervals are typically several seconds, so a
+  // granularity of a few hundred milliseconds adds negligible slack.
+  QuicKeepaliveOffload(const QuicClock* clock,
+                       QuicAlarmFactory* alarm_factory,
+                       QuicTime::Delta tick_granularity);
+  QuicKeepaliveOffload(const QuicKeepaliveOffload&) = delete;
+  QuicKeepaliveOffload& operator=(const QuicKeepaliveOffload&) = delete;
+
+  ~QuicKeepaliveOffload();
+
+  // Starts sending a PING on |connection| every |interval| until the
+  // connection is unregistered or closes. |connection| is owned by the caller
+  // and must be unregistered before it is destroyed. Re-registering an
+  // already registered connection resets its interval and deadline.
+  void RegisterConnection(QuicConnection* connection,
+                          QuicTime::Delta interval);
+
+  // Stops sending keepalives for |connection|. No-op if not registered.
+  void UnregisterConnection(QuicConnection* connection);
+
+  // Called when the tick alarm fires. Services every wheel bucket whose tick
+  // has passed, then flushes the batch writers the serviced pings went
+  // through.
+  void OnWheelTick();
+
+  size_t num_connections() const { return entries_.size(); }
+
+ private:
+  friend class test::QuicKeepaliveOffloadTestPeer;
+
+  // Keepalive deadlines are hashed into this many buckets by tick index, so
+  // one rotation of the wheel covers kNumWheelBuckets ticks.
+  static const size_t kNumWheelBuckets = 64;
+
+  struct QUIC_NO_EXPORT Entry {
+    QuicConnection* connection;
+    QuicTime::Delta interval;
+    QuicTime deadline;
+  };
+  using Bucket = std::list<Entry>;
+
+  // Returns the index of the tick period containing |time|.
+  int64_t TickForTime(QuicTime time) const;
+
+  // Pings the entries of |bucket| whose deadlines have passed and re-buckets
+  // them one interval out. Entries whose connections have closed are dropped.
+  // Batch-mode writers used by the pings are added to |writers| if not
+  // already present.
+  void ServiceBucket(Bucket* bucket,
+                     QuicTime now,
+                     std::vector<QuicPacketWriter*>* writers);
+
+  // Arms the tick alarm for the next tick, or cancels it if no connections
+  // are registered.
+  void MaybeSetTickAlarm();
+
+  const QuicClock* clock_;  // Not owned.
+  const QuicTime::Delta tick_granularity_;
+
+  std::vector<Bucket> buckets_;
+  // Locates each registered connection's entry for O(1) unregistration.
+  absl::flat_hash_map<QuicConnection*, std::pair<size_t, Bucket::iterator>>
+      entries_;
+
+  // The most recent tick whose bucket has been serviced.
+  int64_t last_serviced_tick_;
+
+  std::unique_ptr<QuicAlarm> tick_alarm_;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_QUIC_KEEPALIVE_OFFLOAD_H_
@@ -0,0 +1,131 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/quic_keepalive_offload.h"
+
+#include <memory>
+
+#include "quic/platform/api/quic_test.h"
+#include "quic/test_tools/quic_test_utils.h"
+
+namespace quic {
+namespace test {
+
+class QuicKeepaliveOffloadTestPeer {
+ public:
+  static QuicAlarm* GetTickAlarm(QuicKeepaliveOffload* offload) {
+    return offload->tick_alarm_.get();
+  }
+};
+
+namespace {
+
+using testing::Return;
+
+const QuicTime::Delta kTickGranularity = QuicTime::Delta::FromMilliseconds(500);
+const QuicTime::Delta kKeepaliveInterval = QuicTime::Delta::FromSeconds(15);
+
+class QuicKeepaliveOffloadTest : public QuicTest {
+ public:
+  QuicKeepaliveOffloadTest()
+      : connection_(&helper_, &alarm_factory_, Perspective::IS_SERVER) {
+    clock_.AdvanceTime(QuicTime::Delta::FromSeconds(1));
+    connection_.set_visitor(&visitor_);
+    offload_ = std::make_unique<QuicKeepaliveOffload>(&clock_, &alarm_factory_,
+                                                      kTickGranularity);
+    tick_alarm_ = static_cast<MockAlarmFactory::TestAlarm*>(
+        QuicKeepaliveOffloadTestPeer::GetTickAlarm(offload_.get()));
+  }
+
+ protected:
+  MockQuicConnectionHelper helper_;
+  MockAlarmFactory alarm_factory_;
+  MockClock clock_;
+  MockQuicConnectionVisitor visitor_;
+  MockQuicConnection connection_;
+
+  std::unique_ptr<QuicKeepaliveOffload> offload_;
+  MockAlarmFactory::TestAlarm* tick_alarm_;
+};
+
+TEST_F(QuicKeepaliveOffloadTest, AlarmTracksRegistration) {
+  EXPECT_FALSE(tick_alarm_->IsSet());
+  EXPECT_EQ(0u, offload_->num_connections());
+
+  offload_->RegisterConnection(&connection_, kKeepaliveInterval);
+  EXPECT_EQ(1u, offload_->num_connections());
+  EXPECT_TRUE(tick_alarm_->IsSet());
+  EXPECT_LE(tick_alarm_->deadline(), clock_.Now() + kTickGranularity);
+
+  offload_->UnregisterConnection(&connection_);
+  EXPECT_EQ(0u, offload_->num_connections());
+  EXPECT_FALSE(tick_alarm_->IsSet());
+
+  // Unregistering twice is a no-op.
+  offload_->UnregisterConnection(&connection_);
+}
+
+TEST_F(QuicKeepaliveOffloadTest, PingsWhenIntervalElapses) {
+  offload_->RegisterConnection(&connection_, kKeepaliveInterval);
+
+  // A tick before the deadline does not touch the connection.
+  EXPECT_CALL(visitor_, ShouldKeepConnectionAlive()).Times(0);
+  clock_.AdvanceTime(kTickGranularity);
+  tick_alarm_->Fire();
+  EXPECT_TRUE(tick_alarm_->IsSet());
+
+  // Once the interval has elapsed the wheel enters the connection's ping
+  // path, which consults the visitor before sending.
+  EXPECT_CALL(visitor_, ShouldKeepConnectionAlive()).WillOnce(Return(false));
+  clock_.AdvanceTime(kKeepaliveInterval);
+  tick_alarm_->Fire();
+
+  // The connection was re-bucketed one interval out and the alarm re-armed.
+  EXPECT_EQ(1u, offload_->num_connections());
+  EXPECT_TRUE(tick_alarm_->IsSet());
+  EXPECT_CALL(visitor_, ShouldKeepConnectionAlive()).WillOnce(Return(false));
+  clock_.AdvanceTime(kKeepaliveInterval);
+  tick_alarm_->Fire();
+}
+
+TEST_F(QuicKeepaliveOffloadTest, ServicesManyConnectionsPerTick) {
+  MockQuicConnection connection2(&helper_, &alarm_factory_,
+                                 Perspective::IS_SERVER);
+  connection2.set_visitor(&visitor_);
+  offload_->RegisterConnection(&connection_, kKeepaliveInterval);
+  offload_->RegisterConnection(&connection2, kKeepaliveInterval);
+  EXPECT_EQ(2u, offload_->num_connections());
+
+  // Both connections come due in the same tick and are serviced by a single
+  // alarm fire.
+  EXPECT_CALL(visitor_, ShouldKeepConnectionAlive())
+      .Times(2)
+      .WillRepeatedly(Return(false));
+  clock_.AdvanceTime(kKeepaliveInterval);
+  tick_alarm_->Fire();
+  EXPECT_EQ(2u, offload_->num_connections());
+
+  offload_->UnregisterConnection(&connection2);
+}
+
+TEST_F(QuicKeepaliveOffloadTest, ReRegisterResetsDeadline) {
+  offload_->RegisterConnection(&connection_, kKeepaliveInterval);
+  clock_.AdvanceTime(kKeepaliveInterval - kTickGranularity);
+
+  // Re-registering pushes the deadline a full interval out again.
+  offload_->RegisterConnection(&connection_, kKeepaliveInterval);
+  EXPECT_EQ(1u, offload_->num_connections());
+
+  EXPECT_CALL(visitor_, ShouldKeepConnectionAlive()).Times(0);
+  clock_.AdvanceTime(kTickGranularity);
+  tick_alarm_->Fire();
+
+  EXPECT_CALL(visitor_, ShouldKeepConnectionAlive()).WillOnce(Return(false));
+  clock_.AdvanceTime(kKeepaliveInterval);
+  tick_alarm_->Fire();
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
@@ -0,0 +1,200 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/quic_load_balancer_codec.h"
+
+#include <cstring>
+
+#include "absl/memory/memory.h"
+#include "absl/numeric/int128.h"
+#include "quic/core/crypto/quic_random.h"
+#include "quic/core/quic_utils.h"
+#include "quic/platform/api/quic_bug_tracker.h"
+#include "quic/platform/api/quic_logging.h"
+
+namespace quic {
+
+namespace {
+
+// The server ID occupies the low bits of the first octet's length field, so
+// it can be at most 15 bytes.
+const size_t kMaxServerIdLength = 15;
+
+// Nonces shorter than this make connection ID collisions across a backend's
+// connections too likely.
+const uint8_t kMinNonceLength = 4;
+
+const size_t kLoadBalancerKeyLength = 16;
+
+bool AreParametersValid(uint8_t config_id, absl::string_view server_id,
+                        uint8_t nonce_length) {
+  if (config_id > QuicLoadBalancerCodec::kMaxConfigId) {
+    QUIC_DLOG(ERROR) << "Invalid QUIC-LB config id " << int{config_id};
+    return false;
+  }
+  if (server_id.empty() || server_id.size() > kMaxServerIdLength) {
+    QUIC_DLOG(ERROR) << "Invalid QUIC-LB server id length "
+                     << server_id.size();
+    return false;
+  }
+  if (nonce_length < kMinNonceLength) {
+    QUIC_DLOG(ERROR) << "QUIC-LB nonce length " << int{nonce_length}
+                     << " is below the minimum of " << int{kMinNonceLength};
+    return false;
+  }
+  if (1 + server_id.size() + nonce_length >
+      kQuicMaxConnectionIdWithLengthPrefixLength) {
+    QUIC_DLOG(ERROR) << "QUIC-LB connection ID length "
+                     << 1 + server_id.size() + nonce_length
+                     << " exceeds the maximum of "
+                     << int{kQuicMaxConnectionIdWithLengthPrefixLength};
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+// static
+std::unique_ptr<QuicLoadBalancerCodec> QuicLoadBalancerCodec::CreatePlaintext(
+    uint8_t config_id, absl::string_view server_id, uint8_t nonce_length) {
+  if (!AreParametersValid(config_id, server_id, nonce_length)) {
+    return nullptr;
+  }
+  return absl::WrapUnique(new QuicLoadBalancerCodec(
+      config_id, server_id, nonce_length, /*encrypted=*/false));
+}
+
+// static
+std::unique_ptr<QuicLoadBalancerCodec> QuicLoadBalancerCodec::CreateEncrypted(
+    uint8_t config_id, absl::string_view server_id, uint8_t nonce_length,
+    absl::string_view key) {
+  if (!AreParametersValid(config_id, server_id, nonce_length)) {
+    return nullptr;
+  }
+  if (server_id.size() + nonce_length != AES_BLOCK_SIZE) {
+    QUIC_DLOG(ERROR) << "Encrypted QUIC-LB configs require a "
+                     << AES_BLOCK_SIZE << " byte server id plus nonce, got "
+                     << server_id.size() + nonce_length;
+    return nullptr;
+  }
+  if (key.size() != kLoadBalancerKeyLength) {
+    QUIC_DLOG(ERROR) << "Invalid QUIC-LB key length " << key.size();
+    return nullptr;
+  }
+  auto codec = absl::WrapUnique(new QuicLoadBalancerCodec(
+      config_id, server_id, nonce_length, /*encrypted=*/true));
+  if (AES_set_encrypt_key(reinterpret_cast<const uint8_t*>(key.data()),
+                          kLoadBalancerKeyLength * 8,
+                          &codec->encrypt_key_) != 0 ||
+      AES_set_decrypt_key(reinterpret_cast<const uint8_t*>(key.data()),
+                          kLoadBalancerKeyLength * 8,
+                          &codec->decrypt_key_) != 0) {
+    QUIC_BUG(quic_lb_aes_key_setup_failed)
+        << "Unexpected failure of AES key setup";
+    return nullptr;
+  }
+  return codec;
+}
+
+QuicLoadBalancerCodec::QuicLoadBalancerCodec(uint8_t config_id,
+                                             absl::string_view server_id,
+                                             uint8_t nonce_length,
+                                             bool encrypted)
+    : config_id_(config_id),
+      server_id_(server_id),
+      nonce_length_(nonce_length),
+      encrypted_(encrypted) {}
+
+uint8_t QuicLoadBalancerCodec::FirstOctet() const {
+  // Top three bits are the config rotator; the low five bits carry the
+  // length of the server ID plus nonce so the balancer can parse the
+  // connection ID without knowing the config.
+  return static_cast<uint8_t>(
+      (config_id_ << 5) |
+      static_cast<uint8_t>(server_id_.size() + nonce_length_));
+}
+
+QuicConnectionId QuicLoadBalancerCodec::EncodeWithNonce(
+    absl::string_view nonce) const {
+  QUICHE_DCHECK_EQ(nonce_length_, nonce.size());
+  char connection_id_data[kQuicMaxConnectionIdWithLengthPrefixLength];
+  connection_id_data[0] = static_cast<char>(FirstOctet());
+  memcpy(connection_id_data + 1, server_id_.data(), server_id_.size());
+  memcpy(connection_id_data + 1 + server_id_.size(), nonce.data(),
+         nonce.size());
+  if (encrypted_) {
+    AES_encrypt(reinterpret_cast<uint8_t*>(connection_id_data + 1),
+                reinterpret_cast<uint8_t*>(connection_id_data + 1),
+                &encrypt_key_);
+  }
+  return QuicConnectionId(connection_id_data, connection_id_length());
+}
+
+QuicConnectionId QuicLoadBalancerCodec::GenerateConnectionId(
+    QuicRandom* random) const {
+  char nonce[kQuicMaxConnectionIdWithLengthPrefixLength];
+  random->RandBytes(nonce, nonce_length_);
+  return EncodeWithNonce(absl::string_view(nonce, nonce_length_));
+}
+
+QuicConnectionId QuicLoadBalancerCodec::GenerateConnectionIdFromSeed(
+    const QuicConnectionId& seed) const {
+  // Derive the nonce the same way CreateReplacementConnectionId() derives
+  // replacement bytes, so equal seeds always yield equal connection IDs.
+  char nonce[sizeof(uint64_t) + sizeof(absl::uint128)];
+  const uint64_t seed_hash64 =
+      QuicUtils::FNV1a_64_Hash(absl::string_view(seed.data(), seed.length()));
+  const absl::uint128 seed_hash128 =
+      QuicUtils::FNV1a_128_Hash(absl::string_view(seed.data(), seed.length()));
+  static_assert(sizeof(nonce) >= kQuicMaxConnectionIdWithLengthPrefixLength - 2,
+                "nonce buffer too small");
+  memcpy(nonce, &seed_hash64, sizeof(seed_hash64));
+  memcpy(nonce + sizeof(seed_hash64), &seed_hash128, sizeof(seed_hash128));
+  return EncodeWithNonce(absl::string_view(nonce, nonce_length_));
+}
+
+bool QuicLoadBalancerCodec::DecodeServerId(
+    const QuicConnectionId& connection_id, std::string* server_id) const {
+  if (!MatchesConfig(connection_id)) {
+    return false;
+  }
+  if (!encrypted_) {
+    *server_id = std::string(connection_id.data() + 1, server_id_.size());
+    return true;
+  }
+  uint8_t plaintext[AES_BLOCK_SIZE];
+  AES_decrypt(reinterpret_cast<const uint8_t*>(connection_id.data() + 1),
+              plaintext, &decrypt_key_);
+  *server_id =
+      std::string(reinterpret_cast<char*>(plaintext), server_id_.size());
+  return true;
+}
+
+bool QuicLoadBalancerCodec::MatchesConfig(
+    const QuicConnectionId& connection_id) const {
+  return connection_id.length() == connection_id_length() &&
+         static_cast<uint8_t>(connection_id.data()[0]) == FirstOctet();
+}
+
+QuicLoadBalancerSelfIssuedConnectionIdManager::
+    QuicLoadBalancerSelfIssuedConnectionIdManager(
+        const QuicLoadBalancerCodec* codec,
+        size_t active_connection_id_limit,
+        const QuicConnectionId& initial_connection_id, const QuicClock* clock,
+        QuicAlarmFactory* alarm_factory,
+        QuicConnectionIdManagerVisitorInterface* visitor,
+        QuicConnectionContext* context)
+    : QuicSelfIssuedConnectionIdManager(active_connection_id_limit,
+                                        initial_connection_id, clock,
+                                        alarm_factory, visitor, context),
+      codec_(codec) {}
+
+QuicConnectionId
+QuicLoadBalancerSelfIssuedConnectionIdManager::GenerateNewConnectionId(
+    const QuicConnectionId& old_connection_id) const {
+  return codec_->GenerateConnectionIdFromSeed(old_connection_id);
+}
+
+}  // namespace quic
@@ -0,0 +1,124 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_QUIC_LOAD_BALANCER_CODEC_H_
+#define QUICHE_QUIC_CORE_QUIC_LOAD_BALANCER_CODEC_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "third_party/boringssl/src/include/openssl/aes.h"
+#include "quic/core/quic_connection_id.h"
+#include "quic/core/quic_connection_id_manager.h"
+#include "quic/platform/api/quic_export.h"
+
+namespace quic {
+
+class QuicRandom;
+
+// Encodes a server ID into every server-generated connection ID following the
+// QUIC-LB draft, so that an L4 load balancer can recover the ID from a short
+// header packet and keep routing an existing connection to the same backend
+// across balancer failovers. The first octet carries the 3-bit config
+// rotator and the length of the remainder; the remainder is the server ID
+// followed by a nonce. In encrypted configs the remainder is scrambled with
+// a single AES-128 pass (the draft's single-pass algorithm for 16-byte
+// payloads) so the server ID is not visible to observers on the path.
+class QUIC_EXPORT_PRIVATE QuicLoadBalancerCodec {
+ public:
+  // Config rotator values 0 through 6 identify deployed configs; 7 marks
+  // connection IDs that are not routable by the balancer.
+  static const uint8_t kMaxConfigId = 6;
+
+  // Returns a codec whose connection IDs carry |server_id| in the clear.
+  // Returns nullptr if the parameters are invalid: |config_id| must be at
+  // most kMaxConfigId, |server_id| must be 1 to 15 bytes, |nonce_length| at
+  // least 4, and the resulting connection ID at most
+  // kQuicMaxConnectionIdWithLengthPrefixLength bytes.
+  static std::unique_ptr<QuicLoadBalancerCodec> CreatePlaintext(
+      uint8_t config_id, absl::string_view server_id, uint8_t nonce_length);
+
+  // As above, but the server ID and nonce are encrypted in place with a
+  // single AES-128 pass. |key| must be 16 bytes and server_id.size() +
+  // nonce_length must equal the 16-byte AES block size; the draft's
+  // four-pass construction for other payload lengths is not implemented.
+  static std::unique_ptr<QuicLoadBalancerCodec> CreateEncrypted(
+      uint8_t config_id, absl::string_view server_id, uint8_t nonce_length,
+      absl::string_view key);
+
+  // Returns a fresh connection ID with a nonce drawn from |random|.
+  QuicConnectionId GenerateConnectionId(QuicRandom* random) const;
+
+  // Deterministically derives a connection ID whose nonce is a hash of
+  // |seed|. Calling this with two equal seeds produces the same result,
+  // which QuicDispatcher::MaybeReplaceServerConnectionId() requires of
+  // replacement connection IDs.
+  QuicConnectionId GenerateConnectionIdFromSeed(
+      const QuicConnectionId& seed) const;
+
+  // Extracts the server ID of |connection_id| into |server_id|, decrypting
+  // the payload for encrypted configs. Returns false if |connection_id|
+  // cannot have been produced by a codec with this configuration.
+  bool DecodeServerId(const QuicConnectionId& connection_id,
+                      std::string* server_id) const;
+
+  // Returns true if |connection_id| has the first octet and length this
+  // config produces. A false return on the stateless-reset path means the
+  // connection ID cannot belong to this backend and the packet was
+  // misrouted by the balancer.
+  bool MatchesConfig(const QuicConnectionId& connection_id) const;
+
+  uint8_t config_id() const { return config_id_; }
+
+  // Total length of every connection ID this codec generates: one octet
+  // plus server ID plus nonce.
+  uint8_t connection_id_length() const {
+    return static_cast<uint8_t>(1 + server_id_.size() + nonce_length_);
+  }
+
+ private:
+  QuicLoadBalancerCodec(uint8_t config_id, absl::string_view server_id,
+                        uint8_t nonce_length, bool encrypted);
+
+  // Builds the connection ID for |nonce|, encrypting the payload if this is
+  // an encrypted config. |nonce| must be nonce_length_ bytes.
+  QuicConnectionId EncodeWithNonce(absl::string_view nonce) const;
+
+  // The fixed first octet of every connection ID this codec generates.
+  uint8_t FirstOctet() const;
+
+  const uint8_t config_id_;
+  const std::string server_id_;
+  const uint8_t nonce_length_;
+  const bool encrypted_;
+  AES_KEY encrypt_key_;
+  AES_KEY decrypt_key_;
+};
+
+// Self-issued connection ID manager which runs every connection ID issued
+// for path migration through the codec, so packets sent to those connection
+// IDs still route to this backend.
+class QUIC_EXPORT_PRIVATE QuicLoadBalancerSelfIssuedConnectionIdManager
+    : public QuicSelfIssuedConnectionIdManager {
+ public:
+  // |codec| must outlive this manager.
+  QuicLoadBalancerSelfIssuedConnectionIdManager(
+      const QuicLoadBalancerCodec* codec, size_t active_connection_id_limit,
+      const QuicConnectionId& initial_connection_id, const QuicClock* clock,
+      QuicAlarmFactory* alarm_factory,
+      QuicConnectionIdManagerVisitorInterface* visitor,
+      QuicConnectionContext* context);
+
+  QuicConnectionId GenerateNewConnectionId(
+      const QuicConnectionId& old_connection_id) const override;
+
+ private:
+  const QuicLoadBalancerCodec* codec_;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_QUIC_LOAD_BALANCER_CODEC_H_
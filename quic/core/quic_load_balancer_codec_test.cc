@@ -0,0 +1,161 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/quic_load_balancer_codec.h"
+
+#include <string>
+
+#include "quic/core/crypto/quic_random.h"
+#include "quic/core/quic_connection_id.h"
+#include "quic/platform/api/quic_test.h"
+#include "quic/test_tools/mock_clock.h"
+#include "quic/test_tools/quic_test_utils.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+const char kServerId[] = "\x01\x02\x03\x04";
+const char kKey[] = "sixteen byte key";
+
+TEST(QuicLoadBalancerCodecTest, CreateRejectsInvalidParameters) {
+  // Config rotator value 7 is reserved for unroutable connection IDs.
+  EXPECT_EQ(nullptr, QuicLoadBalancerCodec::CreatePlaintext(
+                         /*config_id=*/7, kServerId, /*nonce_length=*/8));
+  // The server ID must be 1 to 15 bytes.
+  EXPECT_EQ(nullptr, QuicLoadBalancerCodec::CreatePlaintext(
+                         /*config_id=*/0, "", /*nonce_length=*/8));
+  EXPECT_EQ(nullptr,
+            QuicLoadBalancerCodec::CreatePlaintext(
+                /*config_id=*/0, std::string(16, 'a'), /*nonce_length=*/8));
+  // The nonce must be at least 4 bytes.
+  EXPECT_EQ(nullptr, QuicLoadBalancerCodec::CreatePlaintext(
+                         /*config_id=*/0, kServerId, /*nonce_length=*/3));
+  // The connection ID must fit in 20 bytes.
+  EXPECT_EQ(nullptr,
+            QuicLoadBalancerCodec::CreatePlaintext(
+                /*config_id=*/0, std::string(15, 'a'), /*nonce_length=*/8));
+  // Encrypted configs require a 16-byte server ID plus nonce and a 16-byte
+  // key.
+  EXPECT_EQ(nullptr, QuicLoadBalancerCodec::CreateEncrypted(
+                         /*config_id=*/0, kServerId, /*nonce_length=*/8,
+                         absl::string_view(kKey, 16)));
+  EXPECT_EQ(nullptr, QuicLoadBalancerCodec::CreateEncrypted(
+                         /*config_id=*/0, kServerId, /*nonce_length=*/12,
+                         "short key"));
+  EXPECT_NE(nullptr, QuicLoadBalancerCodec::CreateEncrypted(
+                         /*config_id=*/0, kServerId, /*nonce_length=*/12,
+                         absl::string_view(kKey, 16)));
+}
+
+TEST(QuicLoadBalancerCodecTest, PlaintextRoundTrip) {
+  auto codec = QuicLoadBalancerCodec::CreatePlaintext(
+      /*config_id=*/2, kServerId, /*nonce_length=*/4);
+  ASSERT_NE(nullptr, codec);
+  EXPECT_EQ(9u, codec->connection_id_length());
+
+  QuicConnectionId connection_id =
+      codec->GenerateConnectionId(QuicRandom::GetInstance());
+  EXPECT_EQ(codec->connection_id_length(), connection_id.length());
+  EXPECT_TRUE(codec->MatchesConfig(connection_id));
+
+  // The config rotator occupies the top three bits of the first octet and
+  // the payload length the low five; the server ID follows in the clear.
+  EXPECT_EQ(0x48, static_cast<uint8_t>(connection_id.data()[0]));
+  EXPECT_EQ(absl::string_view(kServerId, 4),
+            absl::string_view(connection_id.data() + 1, 4));
+
+  std::string server_id;
+  ASSERT_TRUE(codec->DecodeServerId(connection_id, &server_id));
+  EXPECT_EQ(kServerId, server_id);
+}
+
+TEST(QuicLoadBalancerCodecTest, EncryptedRoundTripHidesServerId) {
+  auto codec = QuicLoadBalancerCodec::CreateEncrypted(
+      /*config_id=*/1, kServerId, /*nonce_length=*/12,
+      absl::string_view(kKey, 16));
+  ASSERT_NE(nullptr, codec);
+  EXPECT_EQ(17u, codec->connection_id_length());
+
+  QuicConnectionId connection_id =
+      codec->GenerateConnectionId(QuicRandom::GetInstance());
+  EXPECT_TRUE(codec->MatchesConfig(connection_id));
+  // The server ID must not appear in the clear.
+  EXPECT_NE(absl::string_view(kServerId, 4),
+            absl::string_view(connection_id.data() + 1, 4));
+
+  std::string server_id;
+  ASSERT_TRUE(codec->DecodeServerId(connection_id, &server_id));
+  EXPECT_EQ(kServerId, server_id);
+}
+
+TEST(QuicLoadBalancerCodecTest, SeededGenerationIsDeterministic) {
+  auto codec = QuicLoadBalancerCodec::CreatePlaintext(
+      /*config_id=*/0, kServerId, /*nonce_length=*/8);
+  ASSERT_NE(nullptr, codec);
+  EXPECT_EQ(codec->GenerateConnectionIdFromSeed(TestConnectionId(1)),
+            codec->GenerateConnectionIdFromSeed(TestConnectionId(1)));
+  EXPECT_NE(codec->GenerateConnectionIdFromSeed(TestConnectionId(1)),
+            codec->GenerateConnectionIdFromSeed(TestConnectionId(2)));
+  EXPECT_TRUE(codec->MatchesConfig(
+      codec->GenerateConnectionIdFromSeed(TestConnectionId(1))));
+}
+
+TEST(QuicLoadBalancerCodecTest, MismatchedConnectionIdsAreRejected) {
+  auto codec = QuicLoadBalancerCodec::CreatePlaintext(
+      /*config_id=*/0, kServerId, /*nonce_length=*/4);
+  auto other_config = QuicLoadBalancerCodec::CreatePlaintext(
+      /*config_id=*/1, kServerId, /*nonce_length=*/4);
+  ASSERT_NE(nullptr, codec);
+  ASSERT_NE(nullptr, other_config);
+
+  QuicConnectionId connection_id =
+      codec->GenerateConnectionId(QuicRandom::GetInstance());
+  std::string server_id;
+  // Wrong config rotator.
+  EXPECT_FALSE(other_config->MatchesConfig(connection_id));
+  EXPECT_FALSE(other_config->DecodeServerId(connection_id, &server_id));
+  // Wrong length (a typical client-chosen initial connection ID).
+  EXPECT_FALSE(codec->MatchesConfig(TestConnectionId(1)));
+  EXPECT_FALSE(codec->DecodeServerId(TestConnectionId(1), &server_id));
+}
+
+class StubConnectionIdManagerVisitor
+    : public QuicConnectionIdManagerVisitorInterface {
+ public:
+  void OnPeerIssuedConnectionIdRetired() override {}
+  bool SendNewConnectionId(const QuicNewConnectionIdFrame& /*frame*/) override {
+    return true;
+  }
+  void OnNewConnectionIdIssued(
+      const QuicConnectionId& /*connection_id*/) override {}
+  void OnSelfIssuedConnectionIdRetired(
+      const QuicConnectionId& /*connection_id*/) override {}
+};
+
+TEST(QuicLoadBalancerCodecTest, SelfIssuedIdsStayRoutable) {
+  auto codec = QuicLoadBalancerCodec::CreatePlaintext(
+      /*config_id=*/3, kServerId, /*nonce_length=*/4);
+  ASSERT_NE(nullptr, codec);
+  MockClock clock;
+  MockAlarmFactory alarm_factory;
+  StubConnectionIdManagerVisitor visitor;
+  QuicConnectionId initial_connection_id =
+      codec->GenerateConnectionIdFromSeed(TestConnectionId(1));
+  QuicLoadBalancerSelfIssuedConnectionIdManager manager(
+      codec.get(), /*active_connection_id_limit=*/2, initial_connection_id,
+      &clock, &alarm_factory, &visitor, /*context=*/nullptr);
+
+  QuicConnectionId connection_id = initial_connection_id;
+  for (int i = 0; i < 4; ++i) {
+    connection_id = manager.GenerateNewConnectionId(connection_id);
+    std::string server_id;
+    ASSERT_TRUE(codec->DecodeServerId(connection_id, &server_id));
+    EXPECT_EQ(kServerId, server_id);
+  }
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
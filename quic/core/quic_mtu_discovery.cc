@@ -3,11 +3,92 @@
 // found in the LICENSE file.
 
 #include "quic/core/quic_mtu_discovery.h"
+
+#include <algorithm>
+#include <string>
+
 #include "quic/platform/api/quic_flag_utils.h"
 #include "quic/platform/api/quic_stack_trace.h"
 
 namespace quic {
 
+namespace {
+
+// Number of packed address bytes used as the cache key: a /24 for IPv4 and a
+// /48 for IPv6. Hosts behind the same prefix overwhelmingly share routes and
+// thus path MTU.
+const size_t kIPv4PrefixBytes = 3;
+const size_t kIPv6PrefixBytes = 6;
+
+}  // namespace
+
+// static
+QuicMtuCache* QuicMtuCache::GetInstance() {
+  static QuicMtuCache* cache = new QuicMtuCache();
+  return cache;
+}
+
+// static
+std::string QuicMtuCache::PrefixKey(const QuicSocketAddress& peer_address) {
+  const QuicIpAddress& host = peer_address.host();
+  if (!host.IsInitialized()) {
+    return std::string();
+  }
+  std::string packed = host.ToPackedString();
+  packed.resize(host.IsIPv4() ? kIPv4PrefixBytes : kIPv6PrefixBytes);
+  return packed;
+}
+
+void QuicMtuCache::OnMtuValidated(const QuicSocketAddress& peer_address,
+                                  QuicByteCount mtu) {
+  std::string key = PrefixKey(peer_address);
+  if (key.empty() || mtu == 0) {
+    return;
+  }
+  QuicWriterMutexLock lock(&mutex_);
+  auto it = mtus_.find(key);
+  if (it != mtus_.end()) {
+    it->second = std::max(it->second, mtu);
+    return;
+  }
+  if (mtus_.size() >= kMaxPrefixes) {
+    return;
+  }
+  mtus_[std::move(key)] = mtu;
+}
+
+void QuicMtuCache::OnMtuBlackholeDetected(
+    const QuicSocketAddress& peer_address, QuicByteCount safe_mtu) {
+  std::string key = PrefixKey(peer_address);
+  if (key.empty() || safe_mtu == 0) {
+    return;
+  }
+  QuicWriterMutexLock lock(&mutex_);
+  auto it = mtus_.find(key);
+  if (it == mtus_.end()) {
+    // Nothing cached means nothing seeded probing beyond the safe size;
+    // there is no estimate to lower.
+    return;
+  }
+  it->second = std::min(it->second, safe_mtu);
+}
+
+QuicByteCount QuicMtuCache::GetMtuEstimate(
+    const QuicSocketAddress& peer_address) const {
+  std::string key = PrefixKey(peer_address);
+  if (key.empty()) {
+    return 0;
+  }
+  QuicReaderMutexLock lock(&mutex_);
+  auto it = mtus_.find(key);
+  return it == mtus_.end() ? 0 : it->second;
+}
+
+void QuicMtuCache::ClearForTesting() {
+  QuicWriterMutexLock lock(&mutex_);
+  mtus_.clear();
+}
+
 QuicConnectionMtuDiscoverer::QuicConnectionMtuDiscoverer(
     QuicPacketCount packets_between_probes_base,
     QuicPacketNumber next_probe_at)
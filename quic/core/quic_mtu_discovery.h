@@ -6,9 +6,13 @@
 #define QUICHE_QUIC_CORE_QUIC_MTU_DISCOVERY_H_
 
 #include <iostream>
+#include <string>
 
+#include "absl/container/flat_hash_map.h"
 #include "quic/core/quic_constants.h"
 #include "quic/core/quic_types.h"
+#include "quic/platform/api/quic_mutex.h"
+#include "quic/platform/api/quic_socket_address.h"
 
 namespace quic {
 
@@ -112,6 +116,51 @@ class QUIC_EXPORT_PRIVATE QuicConnectionMtuDiscoverer {
       QuicPacketNumber(kPacketsBetweenMtuProbesBase);
 };
 
+// QuicMtuCache is a process-wide cache of path MTUs discovered by previous
+// connections, keyed by destination address prefix (/24 for IPv4, /48 for
+// IPv6). Connections record the outcome of MTU probing here, and new
+// connections to the same prefix seed their probe target from the cache: a
+// jumbo-capable path is probed straight towards its known MTU, and a path
+// that black-holed large packets is not probed past its known-safe size.
+class QUIC_EXPORT_PRIVATE QuicMtuCache {
+ public:
+  // Maximum number of prefixes retained. Newly seen prefixes are not
+  // recorded once the cache is full.
+  static const size_t kMaxPrefixes = 10000;
+
+  static QuicMtuCache* GetInstance();
+
+  QuicMtuCache(const QuicMtuCache&) = delete;
+  QuicMtuCache& operator=(const QuicMtuCache&) = delete;
+
+  // Records |mtu| as validated by an acknowledged probe on the path to
+  // |peer_address|. Only raises the cached estimate.
+  void OnMtuValidated(const QuicSocketAddress& peer_address, QuicByteCount mtu);
+
+  // Records that packets of the previously validated size were lost on the
+  // path to |peer_address| and that the connection fell back to |safe_mtu|.
+  // Lowers the cached estimate so that later connections do not probe into
+  // the same black hole.
+  void OnMtuBlackholeDetected(const QuicSocketAddress& peer_address,
+                              QuicByteCount safe_mtu);
+
+  // Returns the cached MTU estimate for the path to |peer_address|, or 0 if
+  // nothing has been recorded for its prefix.
+  QuicByteCount GetMtuEstimate(const QuicSocketAddress& peer_address) const;
+
+  void ClearForTesting();
+
+ private:
+  QuicMtuCache() = default;
+
+  // Returns the packed address prefix used as the cache key, or an empty
+  // string if |peer_address| is not initialized.
+  static std::string PrefixKey(const QuicSocketAddress& peer_address);
+
+  mutable QuicMutex mutex_;
+  absl::flat_hash_map<std::string, QuicByteCount> mtus_ QUIC_GUARDED_BY(mutex_);
+};
+
 }  // namespace quic
 
 #endif  // QUICHE_QUIC_CORE_QUIC_MTU_DISCOVERY_H_
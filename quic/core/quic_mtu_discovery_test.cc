@@ -0,0 +1,88 @@
+// Copyright (c) 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/quic_mtu_discovery.h"
+
+#include <string>
+
+#include "quic/platform/api/quic_ip_address.h"
+#include "quic/platform/api/quic_socket_address.h"
+#include "quic/platform/api/quic_test.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+// The discoverer itself is tested in QuicConnectionTest.MtuDiscovery*; this
+// file covers the process-wide MTU cache.
+class QuicMtuCacheTest : public QuicTest {
+ protected:
+  QuicMtuCacheTest() { cache()->ClearForTesting(); }
+  ~QuicMtuCacheTest() override { cache()->ClearForTesting(); }
+
+  QuicMtuCache* cache() { return QuicMtuCache::GetInstance(); }
+
+  QuicSocketAddress Address(const std::string& ip) {
+    QuicIpAddress host;
+    EXPECT_TRUE(host.FromString(ip));
+    return QuicSocketAddress(host, 443);
+  }
+};
+
+TEST_F(QuicMtuCacheTest, ValidatedMtuOnlyRises) {
+  const QuicSocketAddress peer = Address("10.1.2.3");
+  EXPECT_EQ(0u, cache()->GetMtuEstimate(peer));
+
+  cache()->OnMtuValidated(peer, 1400);
+  EXPECT_EQ(1400u, cache()->GetMtuEstimate(peer));
+
+  cache()->OnMtuValidated(peer, 4500);
+  EXPECT_EQ(4500u, cache()->GetMtuEstimate(peer));
+
+  // A smaller validated MTU does not lower the estimate; a larger size has
+  // already been proven to work.
+  cache()->OnMtuValidated(peer, 1400);
+  EXPECT_EQ(4500u, cache()->GetMtuEstimate(peer));
+}
+
+TEST_F(QuicMtuCacheTest, HostsInSameIpv4PrefixShareEstimate) {
+  cache()->OnMtuValidated(Address("10.1.2.3"), 4500);
+
+  // Same /24.
+  EXPECT_EQ(4500u, cache()->GetMtuEstimate(Address("10.1.2.200")));
+  // Different /24.
+  EXPECT_EQ(0u, cache()->GetMtuEstimate(Address("10.1.3.3")));
+}
+
+TEST_F(QuicMtuCacheTest, HostsInSameIpv6PrefixShareEstimate) {
+  cache()->OnMtuValidated(Address("2001:db8:1:2::1"), 4500);
+
+  // Same /48; different subnet.
+  EXPECT_EQ(4500u, cache()->GetMtuEstimate(Address("2001:db8:1:ffff::9")));
+  // Different /48.
+  EXPECT_EQ(0u, cache()->GetMtuEstimate(Address("2001:db8:2:2::1")));
+}
+
+TEST_F(QuicMtuCacheTest, BlackholeLowersEstimate) {
+  const QuicSocketAddress peer = Address("10.1.2.3");
+  cache()->OnMtuValidated(peer, 4500);
+
+  cache()->OnMtuBlackholeDetected(peer, 1350);
+  EXPECT_EQ(1350u, cache()->GetMtuEstimate(peer));
+
+  // A black hole on a prefix with no estimate records nothing; there is no
+  // cached value seeding probes beyond the safe size.
+  cache()->OnMtuBlackholeDetected(Address("10.9.9.9"), 1350);
+  EXPECT_EQ(0u, cache()->GetMtuEstimate(Address("10.9.9.9")));
+}
+
+TEST_F(QuicMtuCacheTest, UninitializedAddressIsIgnored) {
+  const QuicSocketAddress uninitialized;
+  cache()->OnMtuValidated(uninitialized, 4500);
+  EXPECT_EQ(0u, cache()->GetMtuEstimate(uninitialized));
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
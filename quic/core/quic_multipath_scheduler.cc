@@ -0,0 +1,163 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/quic_multipath_scheduler.h"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+#include "quic/core/congestion_control/rtt_stats.h"
+#include "quic/platform/api/quic_logging.h"
+
+namespace quic {
+
+QuicMultipathScheduler::PathContext::PathContext(
+    QuicMultipathPathId path_id,
+    const QuicSocketAddress& self_address,
+    const QuicSocketAddress& peer_address)
+    : path_id(path_id),
+      self_address(self_address),
+      peer_address(peer_address) {}
+
+QuicMultipathScheduler::PathContext::~PathContext() = default;
+
+QuicMultipathScheduler::QuicMultipathScheduler(
+    Perspective perspective,
+    const QuicClock* clock,
+    QuicRandom* random,
+    CongestionControlType congestion_control_type)
+    : perspective_(perspective),
+      clock_(clock),
+      random_(random),
+      congestion_control_type_(congestion_control_type) {}
+
+QuicMultipathScheduler::~QuicMultipathScheduler() = default;
+
+bool QuicMultipathScheduler::AddPath(QuicMultipathPathId path_id,
+                                     const QuicSocketAddress& self_address,
+                                     const QuicSocketAddress& peer_address) {
+  if (FindPath(path_id) != nullptr) {
+    QUIC_BUG(quic_multipath_duplicate_path)
+        << "Path " << path_id << " is already registered.";
+    return false;
+  }
+  auto path =
+      std::make_unique<PathContext>(path_id, self_address, peer_address);
+  path->sent_packet_manager = std::make_unique<QuicSentPacketManager>(
+      perspective_, clock_, random_, &path->stats, congestion_control_type_);
+  paths_.push_back(std::move(path));
+  return true;
+}
+
+bool QuicMultipathScheduler::RemovePath(QuicMultipathPathId path_id) {
+  for (auto it = paths_.begin(); it != paths_.end(); ++it) {
+    if ((*it)->path_id == path_id) {
+      paths_.erase(it);
+      return true;
+    }
+  }
+  return false;
+}
+
+bool QuicMultipathScheduler::HasPath(QuicMultipathPathId path_id) const {
+  return FindPath(path_id) != nullptr;
+}
+
+std::vector<QuicMultipathPathId> QuicMultipathScheduler::SelectPathsForPacket(
+    QuicTime now) const {
+  std::vector<const PathContext*> sendable;
+  for (const auto& path : paths_) {
+    if (IsSendable(*path, now)) {
+      sendable.push_back(path.get());
+    }
+  }
+  std::vector<QuicMultipathPathId> selected;
+  if (sendable.empty()) {
+    return selected;
+  }
+  switch (policy_) {
+    case Policy::kMinLatency:
+    case Policy::kRedundant: {
+      // Order by smoothed RTT; std::stable_sort preserves insertion order
+      // among paths with equal RTT so the primary path wins ties.
+      std::stable_sort(sendable.begin(), sendable.end(),
+                       [](const PathContext* a, const PathContext* b) {
+                         return a->sent_packet_manager->GetRttStats()
+                                    ->SmoothedOrInitialRtt() <
+                                b->sent_packet_manager->GetRttStats()
+                                    ->SmoothedOrInitialRtt();
+                       });
+      const size_t num_selected =
+          policy_ == Policy::kRedundant ? sendable.size() : 1;
+      for (size_t i = 0; i < num_selected; ++i) {
+        selected.push_back(sendable[i]->path_id);
+      }
+      break;
+    }
+    case Policy::kAggregateThroughput: {
+      const PathContext* best = nullptr;
+      QuicByteCount best_headroom = 0;
+      for (const PathContext* path : sendable) {
+        const QuicSentPacketManager& manager = *path->sent_packet_manager;
+        const QuicByteCount in_flight = manager.GetBytesInFlight();
+        const QuicByteCount window = manager.GetCongestionWindowInBytes();
+        const QuicByteCount headroom =
+            window > in_flight ? window - in_flight : 0;
+        if (best == nullptr || headroom > best_headroom) {
+          best = path;
+          best_headroom = headroom;
+        }
+      }
+      selected.push_back(best->path_id);
+      break;
+    }
+  }
+  return selected;
+}
+
+QuicSentPacketManager* QuicMultipathScheduler::GetSentPacketManager(
+    QuicMultipathPathId path_id) {
+  PathContext* path = FindPath(path_id);
+  return path == nullptr ? nullptr : path->sent_packet_manager.get();
+}
+
+const QuicSentPacketManager* QuicMultipathScheduler::GetSentPacketManager(
+    QuicMultipathPathId path_id) const {
+  const PathContext* path = FindPath(path_id);
+  return path == nullptr ? nullptr : path->sent_packet_manager.get();
+}
+
+const QuicConnectionStats* QuicMultipathScheduler::GetPathStats(
+    QuicMultipathPathId path_id) const {
+  const PathContext* path = FindPath(path_id);
+  return path == nullptr ? nullptr : &path->stats;
+}
+
+QuicMultipathScheduler::PathContext* QuicMultipathScheduler::FindPath(
+    QuicMultipathPathId path_id) {
+  for (const auto& path : paths_) {
+    if (path->path_id == path_id) {
+      return path.get();
+    }
+  }
+  return nullptr;
+}
+
+const QuicMultipathScheduler::PathContext* QuicMultipathScheduler::FindPath(
+    QuicMultipathPathId path_id) const {
+  for (const auto& path : paths_) {
+    if (path->path_id == path_id) {
+      return path.get();
+    }
+  }
+  return nullptr;
+}
+
+// static
+bool QuicMultipathScheduler::IsSendable(const PathContext& path, QuicTime now) {
+  return path.sent_packet_manager->TimeUntilSend(now).IsZero();
+}
+
+}  // namespace quic
@@ -0,0 +1,124 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_QUIC_MULTIPATH_SCHEDULER_H_
+#define QUICHE_QUIC_CORE_QUIC_MULTIPATH_SCHEDULER_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "quic/core/quic_connection_stats.h"
+#include "quic/core/quic_sent_packet_manager.h"
+#include "quic/core/quic_time.h"
+#include "quic/core/quic_types.h"
+#include "quic/platform/api/quic_export.h"
+#include "quic/platform/api/quic_socket_address.h"
+
+namespace quic {
+
+// Identifies one network path of a multipath connection. Path IDs are
+// assigned by the caller and have no wire meaning; they typically map to
+// a (self address, peer address) pair or an interface.
+using QuicMultipathPathId = uint32_t;
+
+// Per-path send state for multipath QUIC. Each registered path gets its
+// own QuicSentPacketManager (and thereby its own congestion controller,
+// RttStats and loss detection) plus its own QuicConnectionStats, so that
+// a lossy cellular path cannot poison the congestion state of a clean
+// WiFi path. The scheduler picks which path(s) the next packet should go
+// on according to a policy.
+//
+// This class only tracks per-path state and makes scheduling decisions;
+// the owner remains responsible for routing acks and sent-packet
+// notifications to the manager of the path the packet was sent on.
+class QUIC_EXPORT_PRIVATE QuicMultipathScheduler {
+ public:
+  enum class Policy : uint8_t {
+    // Send on the sendable path with the lowest smoothed RTT.
+    kMinLatency,
+    // Send a copy on every sendable path, lowest RTT first.
+    kRedundant,
+    // Send on the sendable path with the most congestion window headroom,
+    // spreading load across paths to aggregate their throughput.
+    kAggregateThroughput,
+  };
+
+  QuicMultipathScheduler(Perspective perspective,
+                         const QuicClock* clock,
+                         QuicRandom* random,
+                         CongestionControlType congestion_control_type);
+  QuicMultipathScheduler(const QuicMultipathScheduler&) = delete;
+  QuicMultipathScheduler& operator=(const QuicMultipathScheduler&) = delete;
+  ~QuicMultipathScheduler();
+
+  // Registers a path with fresh congestion and RTT state. Returns false if
+  // |path_id| is already registered.
+  bool AddPath(QuicMultipathPathId path_id,
+               const QuicSocketAddress& self_address,
+               const QuicSocketAddress& peer_address);
+
+  // Unregisters a path, discarding its send state. Returns false if
+  // |path_id| is not registered.
+  bool RemovePath(QuicMultipathPathId path_id);
+
+  bool HasPath(QuicMultipathPathId path_id) const;
+
+  size_t num_paths() const { return paths_.size(); }
+
+  // Returns the paths the next packet should be sent on, in send order.
+  // Under kMinLatency and kAggregateThroughput the result has at most one
+  // element; under kRedundant it lists every usable path. A path is usable
+  // when its congestion controller and pacer allow a send at |now|. An
+  // empty result means every path is blocked and the caller should wait
+  // for acks or pacing alarms.
+  std::vector<QuicMultipathPathId> SelectPathsForPacket(QuicTime now) const;
+
+  // Per-path accessors; return nullptr if |path_id| is not registered.
+  QuicSentPacketManager* GetSentPacketManager(QuicMultipathPathId path_id);
+  const QuicSentPacketManager* GetSentPacketManager(
+      QuicMultipathPathId path_id) const;
+  const QuicConnectionStats* GetPathStats(QuicMultipathPathId path_id) const;
+
+  Policy policy() const { return policy_; }
+  void set_policy(Policy policy) { policy_ = policy; }
+
+ private:
+  // Heap-allocated because the sent packet manager keeps a pointer to the
+  // stats struct, so both need stable addresses across paths_ mutations.
+  struct QUIC_EXPORT_PRIVATE PathContext {
+    PathContext(QuicMultipathPathId path_id,
+                const QuicSocketAddress& self_address,
+                const QuicSocketAddress& peer_address);
+    ~PathContext();
+
+    QuicMultipathPathId path_id;
+    QuicSocketAddress self_address;
+    QuicSocketAddress peer_address;
+    QuicConnectionStats stats;
+    std::unique_ptr<QuicSentPacketManager> sent_packet_manager;
+  };
+
+  PathContext* FindPath(QuicMultipathPathId path_id);
+  const PathContext* FindPath(QuicMultipathPathId path_id) const;
+
+  // Whether |path|'s congestion controller and pacer allow a send at |now|.
+  static bool IsSendable(const PathContext& path, QuicTime now);
+
+  const Perspective perspective_;
+  const QuicClock* clock_;  // Not owned.
+  QuicRandom* random_;      // Not owned.
+  const CongestionControlType congestion_control_type_;
+
+  // Registered paths in insertion order, which breaks scheduling ties so
+  // that the first-added (typically primary) path is preferred. Linear
+  // search is fine: realistic deployments have two or three paths.
+  std::vector<std::unique_ptr<PathContext>> paths_;
+
+  Policy policy_ = Policy::kMinLatency;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_QUIC_MULTIPATH_SCHEDULER_H_
@@ -0,0 +1,172 @@
+// Copyright (c) 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/quic_multipath_scheduler.h"
+
+#include "quic/core/congestion_control/rtt_stats.h"
+#include "quic/core/quic_types.h"
+#include "quic/platform/api/quic_expect_bug.h"
+#include "quic/platform/api/quic_test.h"
+#include "quic/test_tools/quic_sent_packet_manager_peer.h"
+#include "quic/test_tools/quic_test_utils.h"
+
+using testing::_;
+using testing::ElementsAre;
+using testing::IsEmpty;
+using testing::NiceMock;
+using testing::Return;
+
+namespace quic {
+namespace test {
+namespace {
+
+const QuicMultipathPathId kWifiPath = 1;
+const QuicMultipathPathId kCellularPath = 2;
+
+class QuicMultipathSchedulerTest : public QuicTest {
+ protected:
+  QuicMultipathSchedulerTest()
+      : scheduler_(Perspective::IS_CLIENT,
+                   &clock_,
+                   QuicRandom::GetInstance(),
+                   kCubicBytes) {
+    clock_.AdvanceTime(QuicTime::Delta::FromSeconds(1));
+  }
+
+  QuicSocketAddress SelfAddress(uint16_t port) {
+    return QuicSocketAddress(QuicIpAddress::Loopback4(), port);
+  }
+
+  QuicSocketAddress PeerAddress() {
+    return QuicSocketAddress(QuicIpAddress::Loopback4(), 443);
+  }
+
+  void AddBothPaths() {
+    EXPECT_TRUE(
+        scheduler_.AddPath(kWifiPath, SelfAddress(1234), PeerAddress()));
+    EXPECT_TRUE(
+        scheduler_.AddPath(kCellularPath, SelfAddress(5678), PeerAddress()));
+  }
+
+  void SetSmoothedRtt(QuicMultipathPathId path_id, QuicTime::Delta rtt) {
+    RttStats* rtt_stats = QuicSentPacketManagerPeer::GetRttStats(
+        scheduler_.GetSentPacketManager(path_id));
+    rtt_stats->UpdateRtt(rtt, QuicTime::Delta::Zero(), clock_.Now());
+  }
+
+  // Replaces |path_id|'s send algorithm with a mock reporting the given
+  // congestion window, and returns the mock for further customization.
+  MockSendAlgorithm* InstallMockSendAlgorithm(QuicMultipathPathId path_id,
+                                              QuicByteCount congestion_window,
+                                              bool can_send) {
+    auto* send_algorithm = new NiceMock<MockSendAlgorithm>();
+    ON_CALL(*send_algorithm, GetCongestionWindow())
+        .WillByDefault(Return(congestion_window));
+    ON_CALL(*send_algorithm, CanSend(_)).WillByDefault(Return(can_send));
+    QuicSentPacketManagerPeer::SetSendAlgorithm(
+        scheduler_.GetSentPacketManager(path_id), send_algorithm);
+    return send_algorithm;
+  }
+
+  MockClock clock_;
+  QuicMultipathScheduler scheduler_;
+};
+
+TEST_F(QuicMultipathSchedulerTest, AddAndRemovePaths) {
+  EXPECT_EQ(0u, scheduler_.num_paths());
+  AddBothPaths();
+  EXPECT_EQ(2u, scheduler_.num_paths());
+  EXPECT_TRUE(scheduler_.HasPath(kWifiPath));
+  EXPECT_TRUE(scheduler_.HasPath(kCellularPath));
+  EXPECT_NE(nullptr, scheduler_.GetSentPacketManager(kWifiPath));
+  EXPECT_NE(nullptr, scheduler_.GetPathStats(kWifiPath));
+
+  EXPECT_TRUE(scheduler_.RemovePath(kWifiPath));
+  EXPECT_FALSE(scheduler_.HasPath(kWifiPath));
+  EXPECT_EQ(nullptr, scheduler_.GetSentPacketManager(kWifiPath));
+  EXPECT_FALSE(scheduler_.RemovePath(kWifiPath));
+  EXPECT_EQ(1u, scheduler_.num_paths());
+}
+
+TEST_F(QuicMultipathSchedulerTest, DuplicatePathIdRejected) {
+  AddBothPaths();
+  EXPECT_QUIC_BUG(EXPECT_FALSE(scheduler_.AddPath(kWifiPath, SelfAddress(99),
+                                                  PeerAddress())),
+                  "already registered");
+  EXPECT_EQ(2u, scheduler_.num_paths());
+}
+
+TEST_F(QuicMultipathSchedulerTest, PathsHaveIndependentRttState) {
+  AddBothPaths();
+  SetSmoothedRtt(kCellularPath, QuicTime::Delta::FromMilliseconds(200));
+  EXPECT_NE(scheduler_.GetSentPacketManager(kWifiPath)
+                ->GetRttStats()
+                ->smoothed_rtt(),
+            scheduler_.GetSentPacketManager(kCellularPath)
+                ->GetRttStats()
+                ->smoothed_rtt());
+}
+
+TEST_F(QuicMultipathSchedulerTest, MinLatencyPrefersLowestRttPath) {
+  AddBothPaths();
+  SetSmoothedRtt(kWifiPath, QuicTime::Delta::FromMilliseconds(50));
+  SetSmoothedRtt(kCellularPath, QuicTime::Delta::FromMilliseconds(20));
+  EXPECT_THAT(scheduler_.SelectPathsForPacket(clock_.Now()),
+              ElementsAre(kCellularPath));
+
+  SetSmoothedRtt(kCellularPath, QuicTime::Delta::FromMilliseconds(500));
+  EXPECT_THAT(scheduler_.SelectPathsForPacket(clock_.Now()),
+              ElementsAre(kWifiPath));
+}
+
+TEST_F(QuicMultipathSchedulerTest, MinLatencyTieBreaksByInsertionOrder) {
+  AddBothPaths();
+  EXPECT_THAT(scheduler_.SelectPathsForPacket(clock_.Now()),
+              ElementsAre(kWifiPath));
+}
+
+TEST_F(QuicMultipathSchedulerTest, RedundantSelectsAllSendablePaths) {
+  AddBothPaths();
+  scheduler_.set_policy(QuicMultipathScheduler::Policy::kRedundant);
+  SetSmoothedRtt(kWifiPath, QuicTime::Delta::FromMilliseconds(50));
+  SetSmoothedRtt(kCellularPath, QuicTime::Delta::FromMilliseconds(20));
+  EXPECT_THAT(scheduler_.SelectPathsForPacket(clock_.Now()),
+              ElementsAre(kCellularPath, kWifiPath));
+}
+
+TEST_F(QuicMultipathSchedulerTest, RedundantSkipsBlockedPath) {
+  AddBothPaths();
+  scheduler_.set_policy(QuicMultipathScheduler::Policy::kRedundant);
+  InstallMockSendAlgorithm(kWifiPath, kDefaultTCPMSS * 10, /*can_send=*/false);
+  EXPECT_THAT(scheduler_.SelectPathsForPacket(clock_.Now()),
+              ElementsAre(kCellularPath));
+}
+
+TEST_F(QuicMultipathSchedulerTest, AggregatePicksPathWithMostHeadroom) {
+  AddBothPaths();
+  scheduler_.set_policy(
+      QuicMultipathScheduler::Policy::kAggregateThroughput);
+  InstallMockSendAlgorithm(kWifiPath, kDefaultTCPMSS * 10, /*can_send=*/true);
+  InstallMockSendAlgorithm(kCellularPath, kDefaultTCPMSS * 40,
+                           /*can_send=*/true);
+  // Nothing is in flight on either path, so headroom is the full window.
+  EXPECT_THAT(scheduler_.SelectPathsForPacket(clock_.Now()),
+              ElementsAre(kCellularPath));
+}
+
+TEST_F(QuicMultipathSchedulerTest, NoPathSendableReturnsEmpty) {
+  AddBothPaths();
+  InstallMockSendAlgorithm(kWifiPath, kDefaultTCPMSS * 10, /*can_send=*/false);
+  InstallMockSendAlgorithm(kCellularPath, kDefaultTCPMSS * 10,
+                           /*can_send=*/false);
+  EXPECT_THAT(scheduler_.SelectPathsForPacket(clock_.Now()), IsEmpty());
+}
+
+TEST_F(QuicMultipathSchedulerTest, NoPathsRegisteredReturnsEmpty) {
+  EXPECT_THAT(scheduler_.SelectPathsForPacket(clock_.Now()), IsEmpty());
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
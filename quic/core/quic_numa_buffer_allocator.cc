@@ -0,0 +1,144 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/quic_numa_buffer_allocator.h"
+
+#include <errno.h>
+#include <linux/mempolicy.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "quic/platform/api/quic_logging.h"
+
+namespace quic {
+namespace {
+
+constexpr size_t kMinSizeClassBytes = 512;
+constexpr size_t kSlabBytes = 2 * 1024 * 1024;
+
+size_t SizeClassBytes(size_t size_class) {
+  return kMinSizeClassBytes << size_class;
+}
+
+// Returns the smallest size class that can hold |size|, or kNumSizeClasses if
+// |size| exceeds the largest class.
+size_t SizeClassFor(size_t size, size_t num_size_classes) {
+  for (size_t size_class = 0; size_class < num_size_classes; ++size_class) {
+    if (size <= SizeClassBytes(size_class)) {
+      return size_class;
+    }
+  }
+  return num_size_classes;
+}
+
+}  // namespace
+
+QuicNumaBufferAllocator::QuicNumaBufferAllocator(int numa_node)
+    : numa_node_(numa_node) {}
+
+QuicNumaBufferAllocator::~QuicNumaBufferAllocator() {
+  QuicWriterMutexLock lock(&mutex_);
+  for (const auto& slab : slabs_) {
+    munmap(reinterpret_cast<void*>(slab.first), kSlabBytes);
+  }
+}
+
+// static
+int QuicNumaBufferAllocator::GetCurrentNumaNode() {
+  unsigned int cpu = 0;
+  unsigned int node = 0;
+  if (syscall(SYS_getcpu, &cpu, &node, nullptr) != 0) {
+    return -1;
+  }
+  return static_cast<int>(node);
+}
+
+char* QuicNumaBufferAllocator::New(size_t size) {
+  const size_t size_class = SizeClassFor(size, kNumSizeClasses);
+  QuicWriterMutexLock lock(&mutex_);
+  if (size_class == kNumSizeClasses ||
+      (free_lists_[size_class] == nullptr && !MapNewSlab(size_class))) {
+    ++stats_.fallback_allocations;
+    return new char[size];
+  }
+  void* chunk = free_lists_[size_class];
+  free_lists_[size_class] = *reinterpret_cast<void**>(chunk);
+  ++stats_.pooled_allocations;
+  return reinterpret_cast<char*>(chunk);
+}
+
+char* QuicNumaBufferAllocator::New(size_t size, bool flag_enable) {
+  if (!flag_enable) {
+    QuicWriterMutexLock lock(&mutex_);
+    ++stats_.fallback_allocations;
+    return new char[size];
+  }
+  return New(size);
+}
+
+void QuicNumaBufferAllocator::Delete(char* buffer) {
+  if (buffer == nullptr) {
+    return;
+  }
+  {
+    QuicWriterMutexLock lock(&mutex_);
+    auto it = slabs_.upper_bound(reinterpret_cast<uintptr_t>(buffer));
+    if (it != slabs_.begin()) {
+      --it;
+      if (reinterpret_cast<uintptr_t>(buffer) < it->second.end) {
+        const size_t size_class = it->second.size_class;
+        *reinterpret_cast<void**>(buffer) = free_lists_[size_class];
+        free_lists_[size_class] = buffer;
+        return;
+      }
+    }
+  }
+  delete[] buffer;
+}
+
+QuicNumaBufferAllocator::Stats QuicNumaBufferAllocator::GetStats() const {
+  QuicReaderMutexLock lock(&mutex_);
+  return stats_;
+}
+
+bool QuicNumaBufferAllocator::MapNewSlab(size_t size_class) {
+  void* slab = mmap(nullptr, kSlabBytes, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (slab == MAP_FAILED) {
+    QUIC_LOG_EVERY_N_SEC(ERROR, 60)
+        << "Failed to map a " << kSlabBytes
+        << " byte slab: " << strerror(errno);
+    return false;
+  }
+  if (numa_node_ >= 0 &&
+      numa_node_ < static_cast<int>(8 * sizeof(unsigned long))) {
+    unsigned long nodemask = 1UL << numa_node_;
+    if (syscall(SYS_mbind, slab, kSlabBytes, MPOL_PREFERRED, &nodemask,
+                8 * sizeof(nodemask), 0) != 0) {
+      // Preferred-node policy is best-effort; keep the slab with default
+      // placement.
+      QUIC_LOG_EVERY_N_SEC(WARNING, 60)
+          << "mbind to node " << numa_node_ << " failed: " << strerror(errno);
+    }
+  }
+
+  const size_t chunk_bytes = SizeClassBytes(size_class);
+  char* base = reinterpret_cast<char*>(slab);
+  for (size_t offset = 0; offset + chunk_bytes <= kSlabBytes;
+       offset += chunk_bytes) {
+    void* chunk = base + offset;
+    *reinterpret_cast<void**>(chunk) = free_lists_[size_class];
+    free_lists_[size_class] = chunk;
+  }
+
+  slabs_[reinterpret_cast<uintptr_t>(slab)] =
+      SlabInfo{reinterpret_cast<uintptr_t>(slab) + kSlabBytes, size_class};
+  ++stats_.slabs_mapped;
+  stats_.bytes_mapped += kSlabBytes;
+  return true;
+}
+
+}  // namespace quic
@@ -0,0 +1,89 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_QUIC_NUMA_BUFFER_ALLOCATOR_H_
+#define QUICHE_QUIC_CORE_QUIC_NUMA_BUFFER_ALLOCATOR_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+
+#include "quic/core/quic_buffer_allocator.h"
+#include "quic/platform/api/quic_export.h"
+#include "quic/platform/api/quic_mutex.h"
+
+namespace quic {
+
+// A NUMA-aware QuicBufferAllocator.  Buffers up to 64kB are carved out of
+// large slabs mmap()ed with a preferred-node memory policy, so that a
+// dispatcher shard pinned to one socket serves its traffic out of local
+// memory instead of paying for cross-node accesses.  One allocator instance
+// should be created per shard, bound to that shard's node; allocations larger
+// than the biggest size class fall back to operator new.
+//
+// Linux-only: node binding uses mbind(2).  Binding is best-effort; if the
+// policy cannot be applied, the allocator still works with the kernel's
+// default (first-touch) placement.
+//
+// All methods are thread-safe.
+class QUIC_EXPORT_PRIVATE QuicNumaBufferAllocator : public QuicBufferAllocator {
+ public:
+  // Per-allocator (and therefore per-node, with one allocator per shard)
+  // allocation counters.
+  struct QUIC_EXPORT_PRIVATE Stats {
+    uint64_t slabs_mapped = 0;
+    uint64_t bytes_mapped = 0;
+    uint64_t pooled_allocations = 0;
+    uint64_t fallback_allocations = 0;
+  };
+
+  // Binds all pooled memory to |numa_node|.  A negative node skips the
+  // binding and keeps the kernel default placement.
+  explicit QuicNumaBufferAllocator(int numa_node);
+  QuicNumaBufferAllocator(const QuicNumaBufferAllocator&) = delete;
+  QuicNumaBufferAllocator& operator=(const QuicNumaBufferAllocator&) = delete;
+  ~QuicNumaBufferAllocator() override;
+
+  // Returns the NUMA node the calling thread is currently running on, as
+  // reported by getcpu(2), or -1 if it cannot be determined.  A dispatcher
+  // shard that is already pinned to its CPUs can declare its affinity with
+  // QuicNumaBufferAllocator(QuicNumaBufferAllocator::GetCurrentNumaNode()).
+  static int GetCurrentNumaNode();
+
+  // QuicBufferAllocator implementation.
+  char* New(size_t size) override;
+  char* New(size_t size, bool flag_enable) override;
+  void Delete(char* buffer) override;
+
+  int numa_node() const { return numa_node_; }
+  Stats GetStats() const;
+
+ private:
+  // Size classes are powers of two from 512 bytes to 64kB.
+  static constexpr size_t kNumSizeClasses = 8;
+
+  struct SlabInfo {
+    uintptr_t end;
+    size_t size_class;
+  };
+
+  // Maps a new slab for |size_class| and pushes its chunks onto the free
+  // list.  Returns false if the mapping failed.
+  bool MapNewSlab(size_t size_class) QUIC_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  const int numa_node_;
+
+  mutable QuicMutex mutex_;
+  // Intrusive LIFO free list per size class; the next pointer is stored in
+  // the first bytes of each free chunk.
+  void* free_lists_[kNumSizeClasses] QUIC_GUARDED_BY(mutex_) = {};
+  // Maps slab start address to its extent, used by Delete() to tell pooled
+  // buffers apart from operator new fallbacks.
+  std::map<uintptr_t, SlabInfo> slabs_ QUIC_GUARDED_BY(mutex_);
+  Stats stats_ QUIC_GUARDED_BY(mutex_);
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_QUIC_NUMA_BUFFER_ALLOCATOR_H_
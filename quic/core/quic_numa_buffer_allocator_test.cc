@@ -0,0 +1,61 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/quic_numa_buffer_allocator.h"
+
+#include "quic/platform/api/quic_test.h"
+
+namespace quic {
+namespace {
+
+class QuicNumaBufferAllocatorTest : public QuicTest {};
+
+TEST_F(QuicNumaBufferAllocatorTest, PooledAllocationRoundTrip) {
+  QuicNumaBufferAllocator alloc(/*numa_node=*/-1);
+  char* buffer = alloc.New(1000);
+  ASSERT_NE(nullptr, buffer);
+  alloc.Delete(buffer);
+
+  // The free list is LIFO, so the chunk is handed out again.
+  char* buffer2 = alloc.New(1000);
+  EXPECT_EQ(buffer, buffer2);
+  alloc.Delete(buffer2);
+
+  QuicNumaBufferAllocator::Stats stats = alloc.GetStats();
+  EXPECT_EQ(1u, stats.slabs_mapped);
+  EXPECT_EQ(2u, stats.pooled_allocations);
+  EXPECT_EQ(0u, stats.fallback_allocations);
+}
+
+TEST_F(QuicNumaBufferAllocatorTest, LargeAllocationsFallBackToNew) {
+  QuicNumaBufferAllocator alloc(/*numa_node=*/-1);
+  char* buffer = alloc.New(1024 * 1024);
+  ASSERT_NE(nullptr, buffer);
+  alloc.Delete(buffer);
+
+  QuicNumaBufferAllocator::Stats stats = alloc.GetStats();
+  EXPECT_EQ(0u, stats.slabs_mapped);
+  EXPECT_EQ(1u, stats.fallback_allocations);
+}
+
+TEST_F(QuicNumaBufferAllocatorTest, DeleteNull) {
+  QuicNumaBufferAllocator alloc(/*numa_node=*/-1);
+  alloc.Delete(nullptr);
+}
+
+TEST_F(QuicNumaBufferAllocatorTest, CopyBuffer) {
+  QuicNumaBufferAllocator alloc(/*numa_node=*/-1);
+  const absl::string_view original = "Test string";
+  QuicBuffer copy = QuicBuffer::Copy(&alloc, original);
+  EXPECT_EQ(copy.AsStringView(), original);
+}
+
+TEST_F(QuicNumaBufferAllocatorTest, GetCurrentNumaNode) {
+  // getcpu() may be unavailable in some environments, in which case -1 is
+  // returned; otherwise the node is non-negative.
+  EXPECT_GE(QuicNumaBufferAllocator::GetCurrentNumaNode(), -1);
+}
+
+}  // namespace
+}  // namespace quic
@@ -0,0 +1,149 @@
+// Copyright (c) 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/quic_pacing_wheel.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "quic/platform/api/quic_logging.h"
+
+namespace quic {
+
+namespace {
+
+// Fires the wheel. The alarm is cancelled before the wheel is destroyed.
+class TickAlarmDelegate : public QuicAlarm::DelegateWithoutContext {
+ public:
+  explicit TickAlarmDelegate(QuicPacingWheel* wheel) : wheel_(wheel) {}
+  TickAlarmDelegate(const TickAlarmDelegate&) = delete;
+  TickAlarmDelegate& operator=(const TickAlarmDelegate&) = delete;
+
+  void OnAlarm() override { wheel_->DrainDueSlots(); }
+
+ private:
+  // Not owned.
+  QuicPacingWheel* wheel_;
+};
+
+}  // namespace
+
+QuicPacingWheel::QuicPacingWheel(QuicAlarmFactory* alarm_factory,
+                                 const QuicClock* clock,
+                                 QuicTime::Delta granularity)
+    : alarm_factory_(alarm_factory),
+      clock_(clock),
+      granularity_(granularity),
+      epoch_(clock->Now()),
+      slots_(kNumSlots),
+      tick_alarm_(alarm_factory_->CreateAlarm(new TickAlarmDelegate(this))) {
+  QUICHE_DCHECK(granularity_ > QuicTime::Delta::Zero());
+}
+
+QuicPacingWheel::~QuicPacingWheel() {
+  tick_alarm_->Cancel();
+}
+
+void QuicPacingWheel::Schedule(Delegate* delegate, QuicTime release_time) {
+  // A release time in a slot that has already been drained gets the next
+  // tick to fire.
+  const int64_t tick = std::max(TickForTime(release_time), current_tick_);
+  if (tick < current_tick_ + static_cast<int64_t>(kNumSlots)) {
+    slots_[tick % kNumSlots].push_back(delegate);
+  } else {
+    overflow_.emplace(tick, delegate);
+  }
+  ++num_scheduled_;
+  RearmAlarm();
+}
+
+void QuicPacingWheel::Cancel(Delegate* delegate) {
+  for (std::vector<Delegate*>& slot : slots_) {
+    auto new_end = std::remove(slot.begin(), slot.end(), delegate);
+    num_scheduled_ -= slot.end() - new_end;
+    slot.erase(new_end, slot.end());
+  }
+  for (auto it = overflow_.begin(); it != overflow_.end();) {
+    if (it->second == delegate) {
+      it = overflow_.erase(it);
+      --num_scheduled_;
+    } else {
+      ++it;
+    }
+  }
+  RearmAlarm();
+}
+
+void QuicPacingWheel::DrainDueSlots() {
+  const QuicTime now = clock_->Now();
+  // A slot is due once |now| has reached its tick boundary, so round down
+  // here; Schedule() rounds up so that nothing is released early.
+  const int64_t now_tick =
+      now <= epoch_ ? 0
+                    : (now - epoch_).ToMicroseconds() /
+                          granularity_.ToMicroseconds();
+  while (current_tick_ <= now_tick && num_scheduled_ > 0) {
+    // Swap the slot out so that delegates re-scheduling themselves from
+    // within the tick land in a future slot rather than the one being
+    // drained.
+    std::vector<Delegate*> due;
+    due.swap(slots_[current_tick_ % kNumSlots]);
+    num_scheduled_ -= due.size();
+    ++current_tick_;
+    PullFromOverflow();
+    for (Delegate* delegate : due) {
+      delegate->OnPacingWheelTick(now);
+    }
+  }
+  if (current_tick_ <= now_tick) {
+    // Skip over empty ticks in one step.
+    current_tick_ = now_tick + 1;
+    PullFromOverflow();
+  }
+  RearmAlarm();
+}
+
+int64_t QuicPacingWheel::TickForTime(QuicTime time) const {
+  if (time <= epoch_) {
+    return 0;
+  }
+  const int64_t elapsed_us = (time - epoch_).ToMicroseconds();
+  const int64_t granularity_us = granularity_.ToMicroseconds();
+  // Round up so that a delegate is never released before its release time.
+  return (elapsed_us + granularity_us - 1) / granularity_us;
+}
+
+void QuicPacingWheel::RearmAlarm() {
+  if (num_scheduled_ == 0) {
+    tick_alarm_->Cancel();
+    return;
+  }
+  int64_t earliest_tick = -1;
+  for (size_t i = 0; i < kNumSlots; ++i) {
+    const int64_t tick = current_tick_ + static_cast<int64_t>(i);
+    if (!slots_[tick % kNumSlots].empty()) {
+      earliest_tick = tick;
+      break;
+    }
+  }
+  if (earliest_tick == -1) {
+    QUICHE_DCHECK(!overflow_.empty());
+    earliest_tick = overflow_.begin()->first;
+  }
+  const QuicTime deadline =
+      epoch_ + QuicTime::Delta::FromMicroseconds(
+                   earliest_tick * granularity_.ToMicroseconds());
+  tick_alarm_->Update(deadline, granularity_);
+}
+
+void QuicPacingWheel::PullFromOverflow() {
+  const int64_t horizon = current_tick_ + static_cast<int64_t>(kNumSlots);
+  while (!overflow_.empty() && overflow_.begin()->first < horizon) {
+    auto it = overflow_.begin();
+    slots_[it->first % kNumSlots].push_back(it->second);
+    overflow_.erase(it);
+  }
+}
+
+}  // namespace quic
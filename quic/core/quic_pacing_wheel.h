@@ -0,0 +1,108 @@
+// Copyright (c) 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_QUIC_PACING_WHEEL_H_
+#define QUICHE_QUIC_CORE_QUIC_PACING_WHEEL_H_
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "quic/core/quic_alarm.h"
+#include "quic/core/quic_alarm_factory.h"
+#include "quic/core/quic_clock.h"
+#include "quic/core/quic_time.h"
+#include "quic/platform/api/quic_export.h"
+
+namespace quic {
+
+namespace test {
+class QuicPacingWheelPeer;
+}  // namespace test
+
+// A shared, time-bucketed pacing scheduler. Instead of every paced sender
+// arming its own alarm, senders enqueue themselves with a release time; the
+// wheel rounds the release time up to a fixed tick granularity, buckets
+// senders that share a tick into one slot, and drains each due slot in a
+// single pass from one underlying alarm. With many concurrently paced
+// senders this replaces a storm of near-simultaneous timer entries with one
+// ticking alarm, and lets the caller amortize writer flushes across all
+// senders released by the same tick.
+//
+// The alarm only fires while work is scheduled; an idle wheel arms nothing.
+class QUIC_EXPORT_PRIVATE QuicPacingWheel {
+ public:
+  // Implemented by paced senders. OnPacingWheelTick is called once per
+  // scheduled entry when its slot is drained.
+  class QUIC_EXPORT_PRIVATE Delegate {
+   public:
+    virtual ~Delegate() {}
+
+    // Called when the delegate's release time has been reached. |now| is the
+    // time the draining tick fired, shared by every delegate in the slot.
+    virtual void OnPacingWheelTick(QuicTime now) = 0;
+  };
+
+  QuicPacingWheel(QuicAlarmFactory* alarm_factory,
+                  const QuicClock* clock,
+                  QuicTime::Delta granularity);
+  QuicPacingWheel(const QuicPacingWheel&) = delete;
+  QuicPacingWheel& operator=(const QuicPacingWheel&) = delete;
+  ~QuicPacingWheel();
+
+  // Enqueues |delegate| to be released at |release_time|, rounded up to the
+  // next tick boundary. A delegate may be scheduled multiple times; it is
+  // called once per entry. |delegate| must outlive the entry, i.e. until it
+  // is ticked or cancelled.
+  void Schedule(Delegate* delegate, QuicTime release_time);
+
+  // Removes all scheduled entries for |delegate|.
+  void Cancel(Delegate* delegate);
+
+  // Drains every slot whose tick has been reached. Called by the wheel's
+  // alarm; exposed for callers that want to drain opportunistically, e.g.
+  // after processing a batch of incoming packets.
+  void DrainDueSlots();
+
+  size_t num_scheduled() const { return num_scheduled_; }
+  QuicTime::Delta granularity() const { return granularity_; }
+
+ private:
+  friend class test::QuicPacingWheelPeer;
+
+  // Number of slots in the ring; release times beyond this horizon live in
+  // the overflow map until they come within the horizon.
+  static const size_t kNumSlots = 1024;
+
+  // Returns the tick number of the slot covering |time|.
+  int64_t TickForTime(QuicTime time) const;
+
+  // Re-arms the alarm for the earliest scheduled tick, or cancels it when
+  // the wheel is empty.
+  void RearmAlarm();
+
+  // Moves overflow entries that now fall within the ring horizon into their
+  // slots.
+  void PullFromOverflow();
+
+  QuicAlarmFactory* alarm_factory_;  // Not owned.
+  const QuicClock* clock_;           // Not owned.
+  const QuicTime::Delta granularity_;
+  const QuicTime epoch_;
+
+  // The next tick that has not been drained yet.
+  int64_t current_tick_ = 0;
+  // Ring of slots indexed by tick number modulo kNumSlots.
+  std::vector<std::vector<Delegate*>> slots_;
+  // Entries more than kNumSlots ticks in the future, keyed by tick.
+  std::multimap<int64_t, Delegate*> overflow_;
+  size_t num_scheduled_ = 0;
+
+  std::unique_ptr<QuicAlarm> tick_alarm_;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_QUIC_PACING_WHEEL_H_
@@ -0,0 +1,167 @@
+// Copyright (c) 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/quic_pacing_wheel.h"
+
+#include <vector>
+
+#include "quic/platform/api/quic_test.h"
+#include "quic/test_tools/quic_pacing_wheel_peer.h"
+#include "quic/test_tools/quic_test_utils.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+const QuicTime::Delta kGranularity = QuicTime::Delta::FromMicroseconds(500);
+
+// Records the times at which it was ticked.
+class RecordingDelegate : public QuicPacingWheel::Delegate {
+ public:
+  void OnPacingWheelTick(QuicTime now) override { ticks_.push_back(now); }
+
+  const std::vector<QuicTime>& ticks() const { return ticks_; }
+
+ private:
+  std::vector<QuicTime> ticks_;
+};
+
+class QuicPacingWheelTest : public QuicTest {
+ protected:
+  QuicPacingWheelTest()
+      : wheel_(&alarm_factory_, &clock_, kGranularity),
+        epoch_(clock_.Now()) {}
+
+  void FireTickAlarm() {
+    alarm_factory_.FireAlarm(QuicPacingWheelPeer::GetTickAlarm(&wheel_));
+  }
+
+  QuicTime AlarmDeadline() {
+    return QuicPacingWheelPeer::GetTickAlarm(&wheel_)->deadline();
+  }
+
+  MockClock clock_;
+  MockAlarmFactory alarm_factory_;
+  QuicPacingWheel wheel_;
+  QuicTime epoch_;
+};
+
+TEST_F(QuicPacingWheelTest, IdleWheelArmsNothing) {
+  EXPECT_FALSE(QuicPacingWheelPeer::GetTickAlarm(&wheel_)->IsSet());
+  EXPECT_EQ(0u, wheel_.num_scheduled());
+}
+
+TEST_F(QuicPacingWheelTest, ReleaseTimeRoundsUpToTickBoundary) {
+  RecordingDelegate delegate;
+  wheel_.Schedule(&delegate,
+                  epoch_ + QuicTime::Delta::FromMicroseconds(100));
+  EXPECT_EQ(epoch_ + kGranularity, AlarmDeadline());
+}
+
+TEST_F(QuicPacingWheelTest, DelegatesSharingATickDrainTogether) {
+  RecordingDelegate delegate1;
+  RecordingDelegate delegate2;
+  RecordingDelegate late_delegate;
+  // Two delegates land in the same slot, the third in a later one.
+  wheel_.Schedule(&delegate1,
+                  epoch_ + QuicTime::Delta::FromMicroseconds(100));
+  wheel_.Schedule(&delegate2,
+                  epoch_ + QuicTime::Delta::FromMicroseconds(400));
+  wheel_.Schedule(&late_delegate,
+                  epoch_ + QuicTime::Delta::FromMicroseconds(1800));
+  EXPECT_EQ(3u, wheel_.num_scheduled());
+
+  clock_.AdvanceTime(kGranularity);
+  FireTickAlarm();
+  EXPECT_EQ(1u, delegate1.ticks().size());
+  EXPECT_EQ(1u, delegate2.ticks().size());
+  EXPECT_TRUE(late_delegate.ticks().empty());
+  // The alarm is re-armed for the remaining delegate's tick.
+  EXPECT_EQ(epoch_ + 4 * kGranularity, AlarmDeadline());
+
+  clock_.AdvanceTime(3 * kGranularity);
+  FireTickAlarm();
+  EXPECT_EQ(1u, late_delegate.ticks().size());
+  EXPECT_EQ(0u, wheel_.num_scheduled());
+  EXPECT_FALSE(QuicPacingWheelPeer::GetTickAlarm(&wheel_)->IsSet());
+}
+
+TEST_F(QuicPacingWheelTest, DelegateNeverReleasedEarly) {
+  RecordingDelegate delegate;
+  const QuicTime release_time =
+      epoch_ + QuicTime::Delta::FromMicroseconds(900);
+  wheel_.Schedule(&delegate, release_time);
+
+  clock_.AdvanceTime(kGranularity);
+  wheel_.DrainDueSlots();
+  EXPECT_TRUE(delegate.ticks().empty());
+
+  clock_.AdvanceTime(kGranularity);
+  wheel_.DrainDueSlots();
+  ASSERT_EQ(1u, delegate.ticks().size());
+  EXPECT_GE(delegate.ticks()[0], release_time);
+}
+
+TEST_F(QuicPacingWheelTest, CancelRemovesAllEntries) {
+  RecordingDelegate delegate;
+  RecordingDelegate other;
+  wheel_.Schedule(&delegate, epoch_ + kGranularity);
+  wheel_.Schedule(&delegate, epoch_ + 2 * kGranularity);
+  wheel_.Schedule(&other, epoch_ + kGranularity);
+  wheel_.Cancel(&delegate);
+  EXPECT_EQ(1u, wheel_.num_scheduled());
+
+  clock_.AdvanceTime(2 * kGranularity);
+  FireTickAlarm();
+  EXPECT_TRUE(delegate.ticks().empty());
+  EXPECT_EQ(1u, other.ticks().size());
+}
+
+TEST_F(QuicPacingWheelTest, EntriesBeyondRingHorizonAreDelivered) {
+  RecordingDelegate delegate;
+  const QuicTime::Delta far = QuicTime::Delta::FromMicroseconds(
+      (QuicPacingWheelPeer::NumSlots() + 5) * kGranularity.ToMicroseconds());
+  wheel_.Schedule(&delegate, epoch_ + far);
+  EXPECT_EQ(1u, wheel_.num_scheduled());
+
+  clock_.AdvanceTime(far);
+  FireTickAlarm();
+  EXPECT_EQ(1u, delegate.ticks().size());
+}
+
+TEST_F(QuicPacingWheelTest, RescheduleFromWithinTick) {
+  // A delegate that re-schedules itself for the next tick when it fires.
+  class ReschedulingDelegate : public QuicPacingWheel::Delegate {
+   public:
+    ReschedulingDelegate(QuicPacingWheel* wheel, QuicTime::Delta interval)
+        : wheel_(wheel), interval_(interval) {}
+
+    void OnPacingWheelTick(QuicTime now) override {
+      ++num_ticks_;
+      if (num_ticks_ < 3) {
+        wheel_->Schedule(this, now + interval_);
+      }
+    }
+
+    int num_ticks() const { return num_ticks_; }
+
+   private:
+    QuicPacingWheel* wheel_;
+    QuicTime::Delta interval_;
+    int num_ticks_ = 0;
+  };
+
+  ReschedulingDelegate delegate(&wheel_, kGranularity);
+  wheel_.Schedule(&delegate, epoch_ + kGranularity);
+  for (int i = 0; i < 3; ++i) {
+    clock_.AdvanceTime(kGranularity);
+    FireTickAlarm();
+  }
+  EXPECT_EQ(3, delegate.num_ticks());
+  EXPECT_EQ(0u, wheel_.num_scheduled());
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
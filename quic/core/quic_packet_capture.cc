@@ -0,0 +1,257 @@
+// Copyright (c) 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/quic_packet_capture.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "quic/platform/api/quic_logging.h"
+
+namespace quic {
+namespace {
+
+// pcapng block and field constants, from draft-tuexen-opsawg-pcapng.
+const uint32_t kSectionHeaderBlock = 0x0A0D0D0A;
+const uint32_t kInterfaceDescriptionBlock = 0x00000001;
+const uint32_t kEnhancedPacketBlock = 0x00000006;
+const uint32_t kDecryptionSecretsBlock = 0x0000000A;
+const uint32_t kByteOrderMagic = 0x1A2B3C4D;
+const uint32_t kSecretsTypeTlsKeyLog = 0x544C534B;  // "TLSK"
+// Raw IP; each packet starts directly with an IPv4 or IPv6 header.
+const uint16_t kLinkTypeRaw = 101;
+
+void AppendUint16(uint16_t value, std::string* out) {
+  out->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void AppendUint32(uint32_t value, std::string* out) {
+  out->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void AppendUint64(uint64_t value, std::string* out) {
+  out->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void AppendPadding(size_t unpadded_length, std::string* out) {
+  out->append((4 - unpadded_length % 4) % 4, '\0');
+}
+
+// Finishes a block started at |block_start| by patching the total length
+// into the reserved slot at offset 4 and appending the trailing copy.
+void FinishBlock(size_t block_start, std::string* out) {
+  const uint32_t total_length =
+      static_cast<uint32_t>(out->size() - block_start + 4);
+  AppendUint32(total_length, out);
+  memcpy(&(*out)[block_start + 4], &total_length, sizeof(total_length));
+}
+
+uint16_t OnesComplementSum(absl::string_view data, uint32_t initial) {
+  uint32_t sum = initial;
+  size_t i = 0;
+  for (; i + 1 < data.size(); i += 2) {
+    sum += static_cast<uint16_t>((static_cast<uint8_t>(data[i]) << 8) |
+                                 static_cast<uint8_t>(data[i + 1]));
+  }
+  if (i < data.size()) {
+    sum += static_cast<uint16_t>(static_cast<uint8_t>(data[i]) << 8);
+  }
+  while (sum >> 16) {
+    sum = (sum & 0xFFFF) + (sum >> 16);
+  }
+  return static_cast<uint16_t>(~sum);
+}
+
+void AppendUint16BigEndian(uint16_t value, std::string* out) {
+  out->push_back(static_cast<char>(value >> 8));
+  out->push_back(static_cast<char>(value & 0xFF));
+}
+
+// Synthesizes an IP+UDP encapsulation of |payload| between |source| and
+// |destination|, so the capture parses in any pcapng reader.
+std::string SynthesizeIpUdpPacket(const QuicSocketAddress& source,
+                                  const QuicSocketAddress& destination,
+                                  absl::string_view payload,
+                                  uint32_t original_payload_length) {
+  std::string packet;
+  const std::string source_ip = source.host().ToPackedString();
+  const std::string destination_ip = destination.host().ToPackedString();
+  const uint16_t kUdpHeaderSize = 8;
+  const uint16_t udp_length =
+      static_cast<uint16_t>(kUdpHeaderSize + original_payload_length);
+  const bool ipv4 = source.host().IsIPv4();
+  if (ipv4) {
+    const uint16_t total_length = static_cast<uint16_t>(20 + udp_length);
+    packet.push_back(0x45);  // Version 4, 20 byte header.
+    packet.push_back(0);     // TOS.
+    AppendUint16BigEndian(total_length, &packet);
+    AppendUint16BigEndian(0, &packet);  // Identification.
+    AppendUint16BigEndian(0, &packet);  // Flags and fragment offset.
+    packet.push_back(64);               // TTL.
+    packet.push_back(17);               // Protocol: UDP.
+    AppendUint16BigEndian(0, &packet);  // Checksum placeholder.
+    packet += source_ip;
+    packet += destination_ip;
+    const uint16_t header_checksum = OnesComplementSum(packet, 0);
+    packet[10] = static_cast<char>(header_checksum >> 8);
+    packet[11] = static_cast<char>(header_checksum & 0xFF);
+  } else {
+    packet.push_back(0x60);  // Version 6.
+    packet.append(3, '\0');  // Traffic class and flow label.
+    AppendUint16BigEndian(udp_length, &packet);
+    packet.push_back(17);  // Next header: UDP.
+    packet.push_back(64);  // Hop limit.
+    packet += source_ip;
+    packet += destination_ip;
+  }
+  AppendUint16BigEndian(source.port(), &packet);
+  AppendUint16BigEndian(destination.port(), &packet);
+  AppendUint16BigEndian(udp_length, &packet);
+  // A zero UDP checksum means "absent" for IPv4. Computing a valid IPv6
+  // checksum requires the full payload, which a truncated capture does not
+  // have, so readers are left to flag it the way they do for checksum
+  // offload captures.
+  AppendUint16BigEndian(0, &packet);
+  packet.append(payload.data(), payload.size());
+  return packet;
+}
+
+}  // namespace
+
+QuicPacketCaptureRing::QuicPacketCaptureRing(size_t capacity, size_t snaplen)
+    : snaplen_(snaplen), slots_(capacity) {
+  for (Slot& slot : slots_) {
+    slot.data.reserve(snaplen_);
+  }
+}
+
+void QuicPacketCaptureRing::CapturePacket(
+    bool sent,
+    int64_t timestamp_micros,
+    const QuicSocketAddress& self_address,
+    const QuicSocketAddress& peer_address,
+    absl::string_view packet) {
+  const uint64_t ticket =
+      next_ticket_.fetch_add(1, std::memory_order_relaxed);
+  Slot& slot = slots_[ticket % slots_.size()];
+  slot.sent = sent;
+  slot.timestamp_micros = timestamp_micros;
+  slot.self_address = self_address;
+  slot.peer_address = peer_address;
+  slot.original_length = static_cast<uint32_t>(packet.size());
+  slot.data.assign(packet.data(), std::min(packet.size(), snaplen_));
+}
+
+void QuicPacketCaptureRing::AddTlsKeyLogLine(absl::string_view line) {
+  tls_key_log_.append(line.data(), line.size());
+  tls_key_log_.push_back('\n');
+}
+
+void QuicPacketCaptureRing::AppendEnhancedPacketBlock(
+    const Slot& slot,
+    std::string* out) const {
+  const QuicSocketAddress& source =
+      slot.sent ? slot.self_address : slot.peer_address;
+  const QuicSocketAddress& destination =
+      slot.sent ? slot.peer_address : slot.self_address;
+  const std::string packet = SynthesizeIpUdpPacket(
+      source, destination, slot.data, slot.original_length);
+  const size_t ip_overhead = packet.size() - slot.data.size();
+
+  const size_t block_start = out->size();
+  AppendUint32(kEnhancedPacketBlock, out);
+  AppendUint32(0, out);  // Total length, patched by FinishBlock().
+  AppendUint32(0, out);  // Interface ID.
+  const uint64_t timestamp = static_cast<uint64_t>(slot.timestamp_micros);
+  AppendUint32(static_cast<uint32_t>(timestamp >> 32), out);
+  AppendUint32(static_cast<uint32_t>(timestamp & 0xFFFFFFFF), out);
+  AppendUint32(static_cast<uint32_t>(packet.size()), out);
+  AppendUint32(static_cast<uint32_t>(ip_overhead + slot.original_length), out);
+  out->append(packet);
+  AppendPadding(packet.size(), out);
+  FinishBlock(block_start, out);
+}
+
+std::string QuicPacketCaptureRing::SerializeToPcapng() const {
+  std::string out;
+
+  // Section Header Block.
+  size_t block_start = out.size();
+  AppendUint32(kSectionHeaderBlock, &out);
+  AppendUint32(0, &out);
+  AppendUint32(kByteOrderMagic, &out);
+  AppendUint16(1, &out);  // Major version.
+  AppendUint16(0, &out);  // Minor version.
+  AppendUint64(0xFFFFFFFFFFFFFFFF, &out);  // Unspecified section length.
+  FinishBlock(block_start, &out);
+
+  // Interface Description Block.
+  block_start = out.size();
+  AppendUint32(kInterfaceDescriptionBlock, &out);
+  AppendUint32(0, &out);
+  AppendUint16(kLinkTypeRaw, &out);
+  AppendUint16(0, &out);  // Reserved.
+  AppendUint32(0, &out);  // No snap length limit; truncation is recorded
+                          // per packet via the captured length.
+  FinishBlock(block_start, &out);
+
+  // Decryption Secrets Block, ahead of the packets that need it.
+  if (!tls_key_log_.empty()) {
+    block_start = out.size();
+    AppendUint32(kDecryptionSecretsBlock, &out);
+    AppendUint32(0, &out);
+    AppendUint32(kSecretsTypeTlsKeyLog, &out);
+    AppendUint32(static_cast<uint32_t>(tls_key_log_.size()), &out);
+    out.append(tls_key_log_);
+    AppendPadding(tls_key_log_.size(), &out);
+    FinishBlock(block_start, &out);
+  }
+
+  const uint64_t end = next_ticket_.load(std::memory_order_relaxed);
+  const uint64_t begin = end > slots_.size() ? end - slots_.size() : 0;
+  for (uint64_t ticket = begin; ticket < end; ++ticket) {
+    AppendEnhancedPacketBlock(slots_[ticket % slots_.size()], &out);
+  }
+  return out;
+}
+
+QuicPacketCaptureVisitor::QuicPacketCaptureVisitor(QuicPacketCaptureRing* ring,
+                                                   const QuicClock* clock)
+    : ring_(ring), clock_(clock) {}
+
+void QuicPacketCaptureVisitor::OnPacketReceived(
+    const QuicSocketAddress& self_address,
+    const QuicSocketAddress& peer_address,
+    const QuicEncryptedPacket& packet) {
+  if (num_seen_++ % sample_every_n_ != 0) {
+    return;
+  }
+  ring_->CapturePacket(/*sent=*/false,
+                       clock_->WallNow().ToUNIXMicroseconds(), self_address,
+                       peer_address,
+                       absl::string_view(packet.data(), packet.length()));
+}
+
+QuicCapturingPacketWriter::QuicCapturingPacketWriter(
+    QuicPacketCaptureRing* ring,
+    const QuicClock* clock)
+    : ring_(ring), clock_(clock) {}
+
+WriteResult QuicCapturingPacketWriter::WritePacket(
+    const char* buffer,
+    size_t buf_len,
+    const QuicIpAddress& self_address,
+    const QuicSocketAddress& peer_address,
+    PerPacketOptions* options) {
+  if (num_seen_++ % sample_every_n_ == 0) {
+    ring_->CapturePacket(/*sent=*/true,
+                         clock_->WallNow().ToUNIXMicroseconds(),
+                         QuicSocketAddress(self_address, /*port=*/0),
+                         peer_address, absl::string_view(buffer, buf_len));
+  }
+  return QuicPacketWriterWrapper::WritePacket(buffer, buf_len, self_address,
+                                              peer_address, options);
+}
+
+}  // namespace quic
@@ -0,0 +1,144 @@
+// Copyright (c) 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_QUIC_PACKET_CAPTURE_H_
+#define QUICHE_QUIC_CORE_QUIC_PACKET_CAPTURE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "quic/core/quic_clock.h"
+#include "quic/core/quic_connection.h"
+#include "quic/core/quic_packet_writer_wrapper.h"
+#include "quic/platform/api/quic_export.h"
+#include "quic/platform/api/quic_socket_address.h"
+
+namespace quic {
+
+// In-process packet capture. Running tcpdump next to a loaded server costs
+// real throughput and the resulting trace still needs the TLS secrets
+// exported separately; capturing inside the stack copies sampled datagrams
+// into a preallocated ring instead and exports them as a self-contained
+// pcapng trace, including a Decryption Secrets Block so readers can decrypt
+// the payloads directly.
+//
+// Appending is wait-free: a producer claims a slot with one atomic
+// fetch_add and copies into preallocated storage, so the capture path never
+// locks or allocates. The ring overwrites its oldest records when full.
+// Exporting while producers are still appending is not supported; detach the
+// capture hooks first.
+class QUIC_EXPORT_PRIVATE QuicPacketCaptureRing {
+ public:
+  // |capacity| is the number of packet records retained; |snaplen| is the
+  // maximum number of payload bytes copied per packet (longer packets are
+  // truncated but their original length is recorded, as with tcpdump -s).
+  QuicPacketCaptureRing(size_t capacity, size_t snaplen);
+  QuicPacketCaptureRing(const QuicPacketCaptureRing&) = delete;
+  QuicPacketCaptureRing& operator=(const QuicPacketCaptureRing&) = delete;
+
+  // Copies up to |snaplen| bytes of |packet| into the ring. |sent| is the
+  // direction; |timestamp_micros| is a UNIX timestamp in microseconds.
+  void CapturePacket(bool sent,
+                     int64_t timestamp_micros,
+                     const QuicSocketAddress& self_address,
+                     const QuicSocketAddress& peer_address,
+                     absl::string_view packet);
+
+  // Records one line in SSLKEYLOGFILE format, e.g.
+  // "CLIENT_TRAFFIC_SECRET_0 <client_random_hex> <secret_hex>". The lines are
+  // exported in a pcapng Decryption Secrets Block ahead of the packets. Not
+  // wait-free; call from the thread that owns the capture.
+  void AddTlsKeyLogLine(absl::string_view line);
+
+  // Serializes the retained records as a pcapng capture. Each record becomes
+  // an Enhanced Packet Block carrying a synthesized IP/UDP header built from
+  // the recorded socket addresses, so standard readers parse the trace
+  // without a dissector hint. Must not race with CapturePacket().
+  std::string SerializeToPcapng() const;
+
+  // Total packets offered to the ring, including overwritten ones.
+  uint64_t num_captured() const {
+    return next_ticket_.load(std::memory_order_relaxed);
+  }
+
+  size_t capacity() const { return slots_.size(); }
+  size_t snaplen() const { return snaplen_; }
+
+ private:
+  struct Slot {
+    bool sent = false;
+    int64_t timestamp_micros = 0;
+    QuicSocketAddress self_address;
+    QuicSocketAddress peer_address;
+    uint32_t original_length = 0;
+    // Preallocated to |snaplen_| capacity in the constructor, so assigning
+    // the captured bytes never allocates.
+    std::string data;
+  };
+
+  // Appends one Enhanced Packet Block for |slot| to |out|.
+  void AppendEnhancedPacketBlock(const Slot& slot, std::string* out) const;
+
+  const size_t snaplen_;
+  std::vector<Slot> slots_;
+  std::atomic<uint64_t> next_ticket_{0};
+  std::string tls_key_log_;
+};
+
+// Connection-side capture surface: a debug visitor that copies every
+// |sample_every_n|-th received datagram into the ring. Attach it to the
+// connections of interest to capture per connection ID; debug visitors see
+// the datagram before it is parsed or decrypted.
+class QUIC_EXPORT_PRIVATE QuicPacketCaptureVisitor
+    : public QuicConnectionDebugVisitor {
+ public:
+  // Does not take ownership of |ring| or |clock|.
+  QuicPacketCaptureVisitor(QuicPacketCaptureRing* ring, const QuicClock* clock);
+
+  // Capture one datagram out of every |n|; 1 captures everything.
+  void set_sample_every_n(uint32_t n) { sample_every_n_ = n; }
+
+  void OnPacketReceived(const QuicSocketAddress& self_address,
+                        const QuicSocketAddress& peer_address,
+                        const QuicEncryptedPacket& packet) override;
+
+ private:
+  QuicPacketCaptureRing* ring_;  // Not owned.
+  const QuicClock* clock_;       // Not owned.
+  uint32_t sample_every_n_ = 1;
+  uint64_t num_seen_ = 0;
+};
+
+// Writer-side capture surface: wraps the outgoing writer at the flush point
+// and copies every |sample_every_n|-th written datagram into the ring before
+// forwarding it. Install per connection, or on the dispatcher's shared
+// writer to capture all egress.
+class QUIC_EXPORT_PRIVATE QuicCapturingPacketWriter
+    : public QuicPacketWriterWrapper {
+ public:
+  // Does not take ownership of |ring| or |clock|.
+  QuicCapturingPacketWriter(QuicPacketCaptureRing* ring,
+                            const QuicClock* clock);
+
+  void set_sample_every_n(uint32_t n) { sample_every_n_ = n; }
+
+  WriteResult WritePacket(const char* buffer,
+                          size_t buf_len,
+                          const QuicIpAddress& self_address,
+                          const QuicSocketAddress& peer_address,
+                          PerPacketOptions* options) override;
+
+ private:
+  QuicPacketCaptureRing* ring_;  // Not owned.
+  const QuicClock* clock_;       // Not owned.
+  uint32_t sample_every_n_ = 1;
+  uint64_t num_seen_ = 0;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_QUIC_PACKET_CAPTURE_H_
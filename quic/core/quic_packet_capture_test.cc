@@ -0,0 +1,166 @@
+// Copyright (c) 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/quic_packet_capture.h"
+
+#include <cstring>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "quic/platform/api/quic_ip_address.h"
+#include "quic/platform/api/quic_test.h"
+#include "quic/test_tools/mock_clock.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+// Reads the little-endian uint32 at |offset|.
+uint32_t Uint32At(absl::string_view data, size_t offset) {
+  uint32_t value;
+  memcpy(&value, data.data() + offset, sizeof(value));
+  return value;
+}
+
+// Walks the pcapng block chain and returns the body offsets of all blocks of
+// |block_type|.
+std::vector<size_t> FindBlocks(absl::string_view pcapng, uint32_t block_type) {
+  std::vector<size_t> offsets;
+  size_t offset = 0;
+  while (offset + 8 <= pcapng.size()) {
+    const uint32_t type = Uint32At(pcapng, offset);
+    const uint32_t total_length = Uint32At(pcapng, offset + 4);
+    EXPECT_GE(total_length, 12u);
+    EXPECT_EQ(0u, total_length % 4);
+    // The trailing length copy must match the leading one.
+    EXPECT_EQ(total_length, Uint32At(pcapng, offset + total_length - 4));
+    if (type == block_type) {
+      offsets.push_back(offset);
+    }
+    offset += total_length;
+  }
+  EXPECT_EQ(pcapng.size(), offset);
+  return offsets;
+}
+
+class QuicPacketCaptureTest : public QuicTest {
+ protected:
+  QuicPacketCaptureTest()
+      : self_address_(QuicIpAddress::Loopback4(), 443),
+        peer_address_(QuicIpAddress::Loopback4(), 12345) {
+    clock_.AdvanceTime(QuicTime::Delta::FromSeconds(10));
+  }
+
+  int64_t Now() { return clock_.WallNow().ToUNIXMicroseconds(); }
+
+  MockClock clock_;
+  QuicSocketAddress self_address_;
+  QuicSocketAddress peer_address_;
+};
+
+TEST_F(QuicPacketCaptureTest, SerializesWellFormedPcapng) {
+  QuicPacketCaptureRing ring(/*capacity=*/4, /*snaplen=*/1500);
+  ring.CapturePacket(/*sent=*/false, Now(), self_address_, peer_address_,
+                     "client initial");
+  ring.CapturePacket(/*sent=*/true, Now(), self_address_, peer_address_,
+                     "server response");
+
+  const std::string pcapng = ring.SerializeToPcapng();
+  // One section header, one interface description, two packets.
+  EXPECT_EQ(1u, FindBlocks(pcapng, 0x0A0D0D0A).size());
+  EXPECT_EQ(1u, FindBlocks(pcapng, 0x00000001).size());
+  const std::vector<size_t> packets = FindBlocks(pcapng, 0x00000006);
+  ASSERT_EQ(2u, packets.size());
+  // Byte-order magic of the section header.
+  EXPECT_EQ(0x1A2B3C4Du, Uint32At(pcapng, 8));
+  // The packet payloads are present, behind the synthesized IP/UDP headers.
+  EXPECT_NE(pcapng.find("client initial"), std::string::npos);
+  EXPECT_NE(pcapng.find("server response"), std::string::npos);
+}
+
+TEST_F(QuicPacketCaptureTest, SynthesizedUdpHeaderUsesDirection) {
+  QuicPacketCaptureRing ring(/*capacity=*/4, /*snaplen=*/1500);
+  ring.CapturePacket(/*sent=*/false, Now(), self_address_, peer_address_,
+                     "payload");
+
+  const std::string pcapng = ring.SerializeToPcapng();
+  const std::vector<size_t> packets = FindBlocks(pcapng, 0x00000006);
+  ASSERT_EQ(1u, packets.size());
+  // Enhanced Packet Block: 28 bytes of fixed fields, then the packet, which
+  // starts with a 20 byte IPv4 header followed by the UDP ports.
+  const size_t ip_offset = packets[0] + 28;
+  EXPECT_EQ(0x45, static_cast<uint8_t>(pcapng[ip_offset]));
+  const size_t ports_offset = ip_offset + 20;
+  const uint16_t source_port =
+      static_cast<uint8_t>(pcapng[ports_offset]) << 8 |
+      static_cast<uint8_t>(pcapng[ports_offset + 1]);
+  const uint16_t destination_port =
+      static_cast<uint8_t>(pcapng[ports_offset + 2]) << 8 |
+      static_cast<uint8_t>(pcapng[ports_offset + 3]);
+  // A received packet flows from the peer to this endpoint.
+  EXPECT_EQ(peer_address_.port(), source_port);
+  EXPECT_EQ(self_address_.port(), destination_port);
+}
+
+TEST_F(QuicPacketCaptureTest, RingOverwritesOldest) {
+  QuicPacketCaptureRing ring(/*capacity=*/2, /*snaplen=*/1500);
+  ring.CapturePacket(false, Now(), self_address_, peer_address_, "first");
+  ring.CapturePacket(false, Now(), self_address_, peer_address_, "second");
+  ring.CapturePacket(false, Now(), self_address_, peer_address_, "third");
+  EXPECT_EQ(3u, ring.num_captured());
+
+  const std::string pcapng = ring.SerializeToPcapng();
+  EXPECT_EQ(2u, FindBlocks(pcapng, 0x00000006).size());
+  EXPECT_EQ(pcapng.find("first"), std::string::npos);
+  EXPECT_NE(pcapng.find("second"), std::string::npos);
+  EXPECT_NE(pcapng.find("third"), std::string::npos);
+}
+
+TEST_F(QuicPacketCaptureTest, TruncatesToSnaplen) {
+  QuicPacketCaptureRing ring(/*capacity=*/2, /*snaplen=*/4);
+  ring.CapturePacket(false, Now(), self_address_, peer_address_,
+                     "truncated payload");
+
+  const std::string pcapng = ring.SerializeToPcapng();
+  const std::vector<size_t> packets = FindBlocks(pcapng, 0x00000006);
+  ASSERT_EQ(1u, packets.size());
+  // Captured length covers 4 payload bytes plus 28 bytes of IPv4+UDP;
+  // original length reflects the full payload.
+  EXPECT_EQ(4u + 28u, Uint32At(pcapng, packets[0] + 20));
+  EXPECT_EQ(strlen("truncated payload") + 28u,
+            Uint32At(pcapng, packets[0] + 24));
+  EXPECT_NE(pcapng.find("trun"), std::string::npos);
+  EXPECT_EQ(pcapng.find("truncated"), std::string::npos);
+}
+
+TEST_F(QuicPacketCaptureTest, ExportsDecryptionSecretsBlock) {
+  QuicPacketCaptureRing ring(/*capacity=*/2, /*snaplen=*/1500);
+  const std::string line = "CLIENT_TRAFFIC_SECRET_0 abcd 1234";
+  ring.AddTlsKeyLogLine(line);
+
+  const std::string pcapng = ring.SerializeToPcapng();
+  const std::vector<size_t> blocks = FindBlocks(pcapng, 0x0000000A);
+  ASSERT_EQ(1u, blocks.size());
+  // Secrets type TLS key log, then the length of the log data.
+  EXPECT_EQ(0x544C534Bu, Uint32At(pcapng, blocks[0] + 8));
+  EXPECT_EQ(line.size() + 1, Uint32At(pcapng, blocks[0] + 12));
+  EXPECT_NE(pcapng.find(line + "\n"), std::string::npos);
+}
+
+TEST_F(QuicPacketCaptureTest, VisitorSamplesReceivedPackets) {
+  QuicPacketCaptureRing ring(/*capacity=*/8, /*snaplen=*/1500);
+  QuicPacketCaptureVisitor visitor(&ring, &clock_);
+  visitor.set_sample_every_n(2);
+  char packet_bytes[] = "datagram";
+  QuicEncryptedPacket packet(packet_bytes, sizeof(packet_bytes) - 1);
+  for (int i = 0; i < 5; ++i) {
+    visitor.OnPacketReceived(self_address_, peer_address_, packet);
+  }
+  // Packets 1, 3 and 5 are sampled.
+  EXPECT_EQ(3u, ring.num_captured());
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
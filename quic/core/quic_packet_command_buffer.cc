@@ -0,0 +1,499 @@
+// Copyright (c) 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/quic_packet_command_buffer.h"
+
+#include <utility>
+
+#include "quic/core/frames/quic_frame.h"
+#include "quic/platform/api/quic_bug_tracker.h"
+
+namespace quic {
+
+QuicPacketCommandBuffer::QuicPacketCommandBuffer() = default;
+
+QuicPacketCommandBuffer::~QuicPacketCommandBuffer() {
+  Clear();
+}
+
+void QuicPacketCommandBuffer::Clear() {
+  for (Command& command : commands_) {
+    if (command.type == CommandType::kFrame) {
+      DeleteFrame(&command.frame);
+    }
+  }
+  commands_.clear();
+  headers_.clear();
+  payloads_.clear();
+}
+
+bool QuicPacketCommandBuffer::ApplyTo(
+    QuicFramerVisitorInterface* visitor) const {
+  for (const Command& command : commands_) {
+    switch (command.type) {
+      case CommandType::kPacket:
+        visitor->OnPacket();
+        break;
+      case CommandType::kUnauthenticatedPublicHeader:
+        if (!visitor->OnUnauthenticatedPublicHeader(
+                headers_[command.header_index])) {
+          return false;
+        }
+        break;
+      case CommandType::kUnauthenticatedHeader:
+        if (!visitor->OnUnauthenticatedHeader(
+                headers_[command.header_index])) {
+          return false;
+        }
+        break;
+      case CommandType::kDecryptedPacket:
+        visitor->OnDecryptedPacket(command.decrypted_length,
+                                   command.decrypted_level);
+        break;
+      case CommandType::kPacketHeader:
+        if (!visitor->OnPacketHeader(headers_[command.header_index])) {
+          return false;
+        }
+        break;
+      case CommandType::kFrame: {
+        const QuicFrame& frame = command.frame;
+        bool processed = false;
+        switch (frame.type) {
+          case STREAM_FRAME:
+            processed = visitor->OnStreamFrame(frame.stream_frame);
+            break;
+          case CRYPTO_FRAME:
+            processed = visitor->OnCryptoFrame(*frame.crypto_frame);
+            break;
+          case PADDING_FRAME:
+            processed = visitor->OnPaddingFrame(frame.padding_frame);
+            break;
+          case PING_FRAME:
+            processed = visitor->OnPingFrame(frame.ping_frame);
+            break;
+          case STOP_WAITING_FRAME:
+            processed = visitor->OnStopWaitingFrame(frame.stop_waiting_frame);
+            break;
+          case RST_STREAM_FRAME:
+            processed = visitor->OnRstStreamFrame(*frame.rst_stream_frame);
+            break;
+          case CONNECTION_CLOSE_FRAME:
+            processed =
+                visitor->OnConnectionCloseFrame(*frame.connection_close_frame);
+            break;
+          case STOP_SENDING_FRAME:
+            processed = visitor->OnStopSendingFrame(*frame.stop_sending_frame);
+            break;
+          case PATH_CHALLENGE_FRAME:
+            processed =
+                visitor->OnPathChallengeFrame(*frame.path_challenge_frame);
+            break;
+          case PATH_RESPONSE_FRAME:
+            processed =
+                visitor->OnPathResponseFrame(*frame.path_response_frame);
+            break;
+          case GOAWAY_FRAME:
+            processed = visitor->OnGoAwayFrame(*frame.goaway_frame);
+            break;
+          case WINDOW_UPDATE_FRAME:
+            processed =
+                visitor->OnWindowUpdateFrame(*frame.window_update_frame);
+            break;
+          case BLOCKED_FRAME:
+            processed = visitor->OnBlockedFrame(*frame.blocked_frame);
+            break;
+          case NEW_CONNECTION_ID_FRAME:
+            processed =
+                visitor->OnNewConnectionIdFrame(*frame.new_connection_id_frame);
+            break;
+          case RETIRE_CONNECTION_ID_FRAME:
+            processed = visitor->OnRetireConnectionIdFrame(
+                *frame.retire_connection_id_frame);
+            break;
+          case NEW_TOKEN_FRAME:
+            processed = visitor->OnNewTokenFrame(*frame.new_token_frame);
+            break;
+          case MESSAGE_FRAME:
+            processed = visitor->OnMessageFrame(*frame.message_frame);
+            break;
+          case HANDSHAKE_DONE_FRAME:
+            processed =
+                visitor->OnHandshakeDoneFrame(frame.handshake_done_frame);
+            break;
+          case ACK_FREQUENCY_FRAME:
+            processed =
+                visitor->OnAckFrequencyFrame(*frame.ack_frequency_frame);
+            break;
+          case MAX_STREAMS_FRAME:
+            processed = visitor->OnMaxStreamsFrame(frame.max_streams_frame);
+            break;
+          case STREAMS_BLOCKED_FRAME:
+            processed =
+                visitor->OnStreamsBlockedFrame(frame.streams_blocked_frame);
+            break;
+          default:
+            QUIC_BUG(quic_packet_command_buffer_bad_frame)
+                << "Unexpected recorded frame type " << frame.type;
+            return false;
+        }
+        if (!processed) {
+          return false;
+        }
+        break;
+      }
+      case CommandType::kAckFrameStart:
+        if (!visitor->OnAckFrameStart(command.packet_number, command.delta)) {
+          return false;
+        }
+        break;
+      case CommandType::kAckRange:
+        if (!visitor->OnAckRange(command.packet_number,
+                                 command.ack_range_end)) {
+          return false;
+        }
+        break;
+      case CommandType::kAckTimestamp:
+        if (!visitor->OnAckTimestamp(command.packet_number, command.time)) {
+          return false;
+        }
+        break;
+      case CommandType::kAckEcnCounts:
+        if (!visitor->OnAckFrameEcnCounts(command.ect_0_count,
+                                          command.ect_1_count,
+                                          command.ecn_ce_count)) {
+          return false;
+        }
+        break;
+      case CommandType::kAckFrameEnd:
+        if (!visitor->OnAckFrameEnd(command.packet_number)) {
+          return false;
+        }
+        break;
+      case CommandType::kPacketComplete:
+        visitor->OnPacketComplete();
+        break;
+    }
+  }
+  return true;
+}
+
+QuicPacketCommandRecorder::QuicPacketCommandRecorder(
+    QuicFramerVisitorInterface* inline_visitor,
+    QuicPacketCommandBuffer* buffer)
+    : inline_visitor_(inline_visitor), buffer_(buffer) {}
+
+QuicPacketCommandBuffer::Command& QuicPacketCommandRecorder::Record(
+    QuicPacketCommandBuffer::CommandType type) {
+  buffer_->commands_.emplace_back(type);
+  return buffer_->commands_.back();
+}
+
+void QuicPacketCommandRecorder::RecordHeader(
+    QuicPacketCommandBuffer::CommandType type,
+    const QuicPacketHeader& header) {
+  buffer_->headers_.push_back(header);
+  Record(type).header_index = buffer_->headers_.size() - 1;
+}
+
+void QuicPacketCommandRecorder::RecordFrame(QuicFrame frame) {
+  Record(QuicPacketCommandBuffer::CommandType::kFrame).frame = frame;
+}
+
+absl::string_view QuicPacketCommandRecorder::CopyPayload(const char* data,
+                                                         size_t length) {
+  buffer_->payloads_.emplace_back(data, length);
+  return buffer_->payloads_.back();
+}
+
+void QuicPacketCommandRecorder::OnError(QuicFramer* framer) {
+  inline_visitor_->OnError(framer);
+  deferrable_ = false;
+}
+
+bool QuicPacketCommandRecorder::OnProtocolVersionMismatch(
+    ParsedQuicVersion received_version) {
+  deferrable_ = false;
+  return inline_visitor_->OnProtocolVersionMismatch(received_version);
+}
+
+void QuicPacketCommandRecorder::OnPacket() {
+  Record(QuicPacketCommandBuffer::CommandType::kPacket);
+}
+
+void QuicPacketCommandRecorder::OnPublicResetPacket(
+    const QuicPublicResetPacket& packet) {
+  deferrable_ = false;
+  inline_visitor_->OnPublicResetPacket(packet);
+}
+
+void QuicPacketCommandRecorder::OnVersionNegotiationPacket(
+    const QuicVersionNegotiationPacket& packet) {
+  deferrable_ = false;
+  inline_visitor_->OnVersionNegotiationPacket(packet);
+}
+
+void QuicPacketCommandRecorder::OnRetryPacket(
+    QuicConnectionId original_connection_id,
+    QuicConnectionId new_connection_id,
+    absl::string_view retry_token,
+    absl::string_view retry_integrity_tag,
+    absl::string_view retry_without_tag) {
+  deferrable_ = false;
+  inline_visitor_->OnRetryPacket(original_connection_id, new_connection_id,
+                                 retry_token, retry_integrity_tag,
+                                 retry_without_tag);
+}
+
+bool QuicPacketCommandRecorder::OnUnauthenticatedPublicHeader(
+    const QuicPacketHeader& header) {
+  RecordHeader(QuicPacketCommandBuffer::CommandType::kUnauthenticatedPublicHeader,
+               header);
+  return true;
+}
+
+bool QuicPacketCommandRecorder::OnUnauthenticatedHeader(
+    const QuicPacketHeader& header) {
+  RecordHeader(QuicPacketCommandBuffer::CommandType::kUnauthenticatedHeader,
+               header);
+  return true;
+}
+
+void QuicPacketCommandRecorder::OnDecryptedPacket(size_t length,
+                                                  EncryptionLevel level) {
+  QuicPacketCommandBuffer::Command& command =
+      Record(QuicPacketCommandBuffer::CommandType::kDecryptedPacket);
+  command.decrypted_length = length;
+  command.decrypted_level = level;
+}
+
+bool QuicPacketCommandRecorder::OnPacketHeader(const QuicPacketHeader& header) {
+  RecordHeader(QuicPacketCommandBuffer::CommandType::kPacketHeader, header);
+  return true;
+}
+
+void QuicPacketCommandRecorder::OnCoalescedPacket(
+    const QuicEncryptedPacket& packet) {
+  // The inline visitor buffers its own copy; coalesced payloads do not make
+  // the leading packet non-deferrable.
+  inline_visitor_->OnCoalescedPacket(packet);
+}
+
+void QuicPacketCommandRecorder::OnUndecryptablePacket(
+    const QuicEncryptedPacket& packet,
+    EncryptionLevel decryption_level,
+    bool has_decryption_key) {
+  inline_visitor_->OnUndecryptablePacket(packet, decryption_level,
+                                         has_decryption_key);
+}
+
+bool QuicPacketCommandRecorder::OnStreamFrame(const QuicStreamFrame& frame) {
+  QuicStreamFrame copy = frame;
+  absl::string_view payload = CopyPayload(frame.data_buffer, frame.data_length);
+  copy.data_buffer = payload.data();
+  RecordFrame(QuicFrame(copy));
+  return true;
+}
+
+bool QuicPacketCommandRecorder::OnCryptoFrame(const QuicCryptoFrame& frame) {
+  auto copy = std::make_unique<QuicCryptoFrame>(frame);
+  absl::string_view payload = CopyPayload(frame.data_buffer, frame.data_length);
+  copy->data_buffer = payload.data();
+  RecordFrame(QuicFrame(copy.release()));
+  return true;
+}
+
+bool QuicPacketCommandRecorder::OnAckFrameStart(QuicPacketNumber largest_acked,
+                                                QuicTime::Delta ack_delay_time) {
+  QuicPacketCommandBuffer::Command& command =
+      Record(QuicPacketCommandBuffer::CommandType::kAckFrameStart);
+  command.packet_number = largest_acked;
+  command.delta = ack_delay_time;
+  return true;
+}
+
+bool QuicPacketCommandRecorder::OnAckRange(QuicPacketNumber start,
+                                           QuicPacketNumber end) {
+  QuicPacketCommandBuffer::Command& command =
+      Record(QuicPacketCommandBuffer::CommandType::kAckRange);
+  command.packet_number = start;
+  command.ack_range_end = end;
+  return true;
+}
+
+bool QuicPacketCommandRecorder::OnAckTimestamp(QuicPacketNumber packet_number,
+                                               QuicTime timestamp) {
+  QuicPacketCommandBuffer::Command& command =
+      Record(QuicPacketCommandBuffer::CommandType::kAckTimestamp);
+  command.packet_number = packet_number;
+  command.time = timestamp;
+  return true;
+}
+
+bool QuicPacketCommandRecorder::OnAckFrameEcnCounts(
+    QuicPacketCount ect_0_count,
+    QuicPacketCount ect_1_count,
+    QuicPacketCount ecn_ce_count) {
+  QuicPacketCommandBuffer::Command& command =
+      Record(QuicPacketCommandBuffer::CommandType::kAckEcnCounts);
+  command.ect_0_count = ect_0_count;
+  command.ect_1_count = ect_1_count;
+  command.ecn_ce_count = ecn_ce_count;
+  return true;
+}
+
+bool QuicPacketCommandRecorder::OnAckFrameEnd(QuicPacketNumber start) {
+  Record(QuicPacketCommandBuffer::CommandType::kAckFrameEnd).packet_number =
+      start;
+  return true;
+}
+
+bool QuicPacketCommandRecorder::OnStopWaitingFrame(
+    const QuicStopWaitingFrame& frame) {
+  RecordFrame(QuicFrame(frame));
+  return true;
+}
+
+bool QuicPacketCommandRecorder::OnPaddingFrame(const QuicPaddingFrame& frame) {
+  RecordFrame(QuicFrame(frame));
+  return true;
+}
+
+bool QuicPacketCommandRecorder::OnPingFrame(const QuicPingFrame& frame) {
+  RecordFrame(QuicFrame(frame));
+  return true;
+}
+
+bool QuicPacketCommandRecorder::OnRstStreamFrame(
+    const QuicRstStreamFrame& frame) {
+  RecordFrame(QuicFrame(new QuicRstStreamFrame(frame)));
+  return true;
+}
+
+bool QuicPacketCommandRecorder::OnConnectionCloseFrame(
+    const QuicConnectionCloseFrame& frame) {
+  RecordFrame(QuicFrame(new QuicConnectionCloseFrame(frame)));
+  return true;
+}
+
+bool QuicPacketCommandRecorder::OnStopSendingFrame(
+    const QuicStopSendingFrame& frame) {
+  RecordFrame(QuicFrame(new QuicStopSendingFrame(frame)));
+  return true;
+}
+
+bool QuicPacketCommandRecorder::OnPathChallengeFrame(
+    const QuicPathChallengeFrame& frame) {
+  RecordFrame(QuicFrame(new QuicPathChallengeFrame(frame)));
+  return true;
+}
+
+bool QuicPacketCommandRecorder::OnPathResponseFrame(
+    const QuicPathResponseFrame& frame) {
+  RecordFrame(QuicFrame(new QuicPathResponseFrame(frame)));
+  return true;
+}
+
+bool QuicPacketCommandRecorder::OnGoAwayFrame(const QuicGoAwayFrame& frame) {
+  RecordFrame(QuicFrame(new QuicGoAwayFrame(frame)));
+  return true;
+}
+
+bool QuicPacketCommandRecorder::OnWindowUpdateFrame(
+    const QuicWindowUpdateFrame& frame) {
+  RecordFrame(QuicFrame(new QuicWindowUpdateFrame(frame)));
+  return true;
+}
+
+bool QuicPacketCommandRecorder::OnBlockedFrame(const QuicBlockedFrame& frame) {
+  RecordFrame(QuicFrame(new QuicBlockedFrame(frame)));
+  return true;
+}
+
+bool QuicPacketCommandRecorder::OnNewConnectionIdFrame(
+    const QuicNewConnectionIdFrame& frame) {
+  RecordFrame(QuicFrame(new QuicNewConnectionIdFrame(frame)));
+  return true;
+}
+
+bool QuicPacketCommandRecorder::OnRetireConnectionIdFrame(
+    const QuicRetireConnectionIdFrame& frame) {
+  RecordFrame(QuicFrame(new QuicRetireConnectionIdFrame(frame)));
+  return true;
+}
+
+bool QuicPacketCommandRecorder::OnNewTokenFrame(
+    const QuicNewTokenFrame& frame) {
+  RecordFrame(QuicFrame(new QuicNewTokenFrame(frame)));
+  return true;
+}
+
+bool QuicPacketCommandRecorder::OnMessageFrame(const QuicMessageFrame& frame) {
+  absl::string_view payload = CopyPayload(frame.data, frame.message_length);
+  RecordFrame(
+      QuicFrame(new QuicMessageFrame(payload.data(), payload.length())));
+  return true;
+}
+
+bool QuicPacketCommandRecorder::OnHandshakeDoneFrame(
+    const QuicHandshakeDoneFrame& frame) {
+  RecordFrame(QuicFrame(frame));
+  return true;
+}
+
+bool QuicPacketCommandRecorder::OnAckFrequencyFrame(
+    const QuicAckFrequencyFrame& frame) {
+  RecordFrame(QuicFrame(new QuicAckFrequencyFrame(frame)));
+  return true;
+}
+
+void QuicPacketCommandRecorder::OnPacketComplete() {
+  Record(QuicPacketCommandBuffer::CommandType::kPacketComplete);
+}
+
+bool QuicPacketCommandRecorder::IsValidStatelessResetToken(
+    const StatelessResetToken& token) const {
+  return inline_visitor_->IsValidStatelessResetToken(token);
+}
+
+void QuicPacketCommandRecorder::OnAuthenticatedIetfStatelessResetPacket(
+    const QuicIetfStatelessResetPacket& packet) {
+  deferrable_ = false;
+  inline_visitor_->OnAuthenticatedIetfStatelessResetPacket(packet);
+}
+
+bool QuicPacketCommandRecorder::OnMaxStreamsFrame(
+    const QuicMaxStreamsFrame& frame) {
+  RecordFrame(QuicFrame(frame));
+  return true;
+}
+
+bool QuicPacketCommandRecorder::OnStreamsBlockedFrame(
+    const QuicStreamsBlockedFrame& frame) {
+  RecordFrame(QuicFrame(frame));
+  return true;
+}
+
+void QuicPacketCommandRecorder::OnKeyUpdate(KeyUpdateReason reason) {
+  // Key schedule changes must be visible to the connection before any later
+  // packet is processed; they cannot ride in the command buffer.
+  deferrable_ = false;
+  inline_visitor_->OnKeyUpdate(reason);
+}
+
+void QuicPacketCommandRecorder::OnDecryptedFirstPacketInKeyPhase() {
+  inline_visitor_->OnDecryptedFirstPacketInKeyPhase();
+}
+
+std::unique_ptr<QuicDecrypter>
+QuicPacketCommandRecorder::AdvanceKeysAndCreateCurrentOneRttDecrypter() {
+  deferrable_ = false;
+  return inline_visitor_->AdvanceKeysAndCreateCurrentOneRttDecrypter();
+}
+
+std::unique_ptr<QuicEncrypter>
+QuicPacketCommandRecorder::CreateCurrentOneRttEncrypter() {
+  return inline_visitor_->CreateCurrentOneRttEncrypter();
+}
+
+}  // namespace quic
@@ -0,0 +1,211 @@
+// Copyright (c) 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_QUIC_PACKET_COMMAND_BUFFER_H_
+#define QUICHE_QUIC_CORE_QUIC_PACKET_COMMAND_BUFFER_H_
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "quic/core/quic_framer.h"
+#include "quic/core/quic_packets.h"
+#include "quic/core/quic_time.h"
+#include "quic/core/quic_types.h"
+#include "quic/platform/api/quic_export.h"
+
+namespace quic {
+
+// A replayable record of the data-plane framer callbacks produced by parsing
+// and decrypting one QUIC packet: headers, decryption level, frames and
+// packet completion, in their original order. Frame payloads are deep copied,
+// so the buffer remains valid after the datagram that produced it is gone.
+//
+// This is the hand-off unit for splitting receive processing into a parse
+// phase and an apply phase. The parse phase (QuicFramer work, AEAD, frame
+// extraction) fills a buffer through QuicPacketCommandRecorder; the apply
+// phase replays the buffer into the connection's framer visitor with
+// ApplyTo(). Because the buffer owns all referenced memory, the two phases
+// need not share a stack, a thread, or the original packet buffer.
+class QUIC_EXPORT_PRIVATE QuicPacketCommandBuffer {
+ public:
+  QuicPacketCommandBuffer();
+  QuicPacketCommandBuffer(const QuicPacketCommandBuffer&) = delete;
+  QuicPacketCommandBuffer& operator=(const QuicPacketCommandBuffer&) = delete;
+  QuicPacketCommandBuffer(QuicPacketCommandBuffer&&) = default;
+  QuicPacketCommandBuffer& operator=(QuicPacketCommandBuffer&&) = default;
+  ~QuicPacketCommandBuffer();
+
+  // Replays the recorded callbacks on |visitor| in their original order.
+  // Replay stops early if a callback returns false, mirroring how the framer
+  // stops processing a packet; returns false in that case. OnPacketComplete
+  // is only delivered if it was recorded and no earlier callback stopped the
+  // replay.
+  bool ApplyTo(QuicFramerVisitorInterface* visitor) const;
+
+  bool empty() const { return commands_.empty(); }
+  size_t num_commands() const { return commands_.size(); }
+
+  // Discards all recorded commands and owned frame memory.
+  void Clear();
+
+ private:
+  friend class QuicPacketCommandRecorder;
+
+  enum class CommandType : uint8_t {
+    kPacket,
+    kUnauthenticatedPublicHeader,
+    kUnauthenticatedHeader,
+    kDecryptedPacket,
+    kPacketHeader,
+    kFrame,
+    kAckFrameStart,
+    kAckRange,
+    kAckTimestamp,
+    kAckEcnCounts,
+    kAckFrameEnd,
+    kPacketComplete,
+  };
+
+  struct QUIC_EXPORT_PRIVATE Command {
+    explicit Command(CommandType type) : type(type) {}
+
+    CommandType type;
+    // Valid for kFrame. Heap-allocated frames are owned by the buffer and
+    // released in Clear().
+    QuicFrame frame;
+    // Valid for header commands; indexes headers_.
+    size_t header_index = 0;
+    // kAckFrameStart: largest acked. kAckRange: range start. kAckTimestamp:
+    // packet number. kAckFrameEnd: start of the last range.
+    QuicPacketNumber packet_number;
+    QuicPacketNumber ack_range_end;               // kAckRange.
+    QuicTime::Delta delta = QuicTime::Delta::Zero();  // kAckFrameStart.
+    QuicTime time = QuicTime::Zero();             // kAckTimestamp.
+    QuicPacketCount ect_0_count = 0;              // kAckEcnCounts.
+    QuicPacketCount ect_1_count = 0;              // kAckEcnCounts.
+    QuicPacketCount ecn_ce_count = 0;             // kAckEcnCounts.
+    size_t decrypted_length = 0;                  // kDecryptedPacket.
+    EncryptionLevel decrypted_level = ENCRYPTION_INITIAL;  // kDecryptedPacket.
+  };
+
+  std::vector<Command> commands_;
+  // Header snapshots referenced by header commands. The framer fills the
+  // header in progressively, so each stage records its own copy.
+  std::vector<QuicPacketHeader> headers_;
+  // Owns deep copies of stream, crypto and message payloads; deque for
+  // pointer stability as commands are appended.
+  std::deque<std::string> payloads_;
+};
+
+// A framer visitor that records one packet's data-plane callbacks into a
+// QuicPacketCommandBuffer for deferred application, e.g. on the connection's
+// owner thread after parse and decrypt ran on a worker.
+//
+// Callbacks that need a synchronous answer from connection state - protocol
+// version mismatch, key phase management, stateless reset validation - and
+// special packets (public reset, version negotiation, retry, authenticated
+// stateless reset) cannot be deferred. They are forwarded to
+// |inline_visitor| immediately, and those that imply connection-level state
+// changes mark the recording as non-deferrable: the caller should then
+// discard the buffer and reprocess the packet inline. Deployments offloading
+// the parse phase must route such packets to the owner thread.
+class QUIC_EXPORT_PRIVATE QuicPacketCommandRecorder
+    : public QuicFramerVisitorInterface {
+ public:
+  // Neither |inline_visitor| nor |buffer| is owned; both must outlive the
+  // recorder.
+  QuicPacketCommandRecorder(QuicFramerVisitorInterface* inline_visitor,
+                            QuicPacketCommandBuffer* buffer);
+
+  // False once a forwarded callback implied a connection-level state change,
+  // in which case the recorded commands must not be replayed.
+  bool deferrable() const { return deferrable_; }
+
+  // QuicFramerVisitorInterface. Data-plane callbacks are recorded; the rest
+  // forward to the inline visitor.
+  void OnError(QuicFramer* framer) override;
+  bool OnProtocolVersionMismatch(ParsedQuicVersion received_version) override;
+  void OnPacket() override;
+  void OnPublicResetPacket(const QuicPublicResetPacket& packet) override;
+  void OnVersionNegotiationPacket(
+      const QuicVersionNegotiationPacket& packet) override;
+  void OnRetryPacket(QuicConnectionId original_connection_id,
+                     QuicConnectionId new_connection_id,
+                     absl::string_view retry_token,
+                     absl::string_view retry_integrity_tag,
+                     absl::string_view retry_without_tag) override;
+  bool OnUnauthenticatedPublicHeader(const QuicPacketHeader& header) override;
+  bool OnUnauthenticatedHeader(const QuicPacketHeader& header) override;
+  void OnDecryptedPacket(size_t length, EncryptionLevel level) override;
+  bool OnPacketHeader(const QuicPacketHeader& header) override;
+  void OnCoalescedPacket(const QuicEncryptedPacket& packet) override;
+  void OnUndecryptablePacket(const QuicEncryptedPacket& packet,
+                             EncryptionLevel decryption_level,
+                             bool has_decryption_key) override;
+  bool OnStreamFrame(const QuicStreamFrame& frame) override;
+  bool OnCryptoFrame(const QuicCryptoFrame& frame) override;
+  bool OnAckFrameStart(QuicPacketNumber largest_acked,
+                       QuicTime::Delta ack_delay_time) override;
+  bool OnAckRange(QuicPacketNumber start, QuicPacketNumber end) override;
+  bool OnAckTimestamp(QuicPacketNumber packet_number,
+                      QuicTime timestamp) override;
+  bool OnAckFrameEcnCounts(QuicPacketCount ect_0_count,
+                           QuicPacketCount ect_1_count,
+                           QuicPacketCount ecn_ce_count) override;
+  bool OnAckFrameEnd(QuicPacketNumber start) override;
+  bool OnStopWaitingFrame(const QuicStopWaitingFrame& frame) override;
+  bool OnPaddingFrame(const QuicPaddingFrame& frame) override;
+  bool OnPingFrame(const QuicPingFrame& frame) override;
+  bool OnRstStreamFrame(const QuicRstStreamFrame& frame) override;
+  bool OnConnectionCloseFrame(const QuicConnectionCloseFrame& frame) override;
+  bool OnStopSendingFrame(const QuicStopSendingFrame& frame) override;
+  bool OnPathChallengeFrame(const QuicPathChallengeFrame& frame) override;
+  bool OnPathResponseFrame(const QuicPathResponseFrame& frame) override;
+  bool OnGoAwayFrame(const QuicGoAwayFrame& frame) override;
+  bool OnWindowUpdateFrame(const QuicWindowUpdateFrame& frame) override;
+  bool OnBlockedFrame(const QuicBlockedFrame& frame) override;
+  bool OnNewConnectionIdFrame(const QuicNewConnectionIdFrame& frame) override;
+  bool OnRetireConnectionIdFrame(
+      const QuicRetireConnectionIdFrame& frame) override;
+  bool OnNewTokenFrame(const QuicNewTokenFrame& frame) override;
+  bool OnMessageFrame(const QuicMessageFrame& frame) override;
+  bool OnHandshakeDoneFrame(const QuicHandshakeDoneFrame& frame) override;
+  bool OnAckFrequencyFrame(const QuicAckFrequencyFrame& frame) override;
+  void OnPacketComplete() override;
+  bool IsValidStatelessResetToken(
+      const StatelessResetToken& token) const override;
+  void OnAuthenticatedIetfStatelessResetPacket(
+      const QuicIetfStatelessResetPacket& packet) override;
+  bool OnMaxStreamsFrame(const QuicMaxStreamsFrame& frame) override;
+  bool OnStreamsBlockedFrame(const QuicStreamsBlockedFrame& frame) override;
+  void OnKeyUpdate(KeyUpdateReason reason) override;
+  void OnDecryptedFirstPacketInKeyPhase() override;
+  std::unique_ptr<QuicDecrypter> AdvanceKeysAndCreateCurrentOneRttDecrypter()
+      override;
+  std::unique_ptr<QuicEncrypter> CreateCurrentOneRttEncrypter() override;
+
+ private:
+  // Appends a command of |type| and returns it for payload population.
+  QuicPacketCommandBuffer::Command& Record(
+      QuicPacketCommandBuffer::CommandType type);
+  // Records a header command of |type|, snapshotting |header|.
+  void RecordHeader(QuicPacketCommandBuffer::CommandType type,
+                    const QuicPacketHeader& header);
+  // Records a kFrame command owning |frame|.
+  void RecordFrame(QuicFrame frame);
+  // Deep copies |data| into the buffer; the returned view stays valid for
+  // the buffer's lifetime.
+  absl::string_view CopyPayload(const char* data, size_t length);
+
+  QuicFramerVisitorInterface* inline_visitor_;  // Not owned.
+  QuicPacketCommandBuffer* buffer_;             // Not owned.
+  bool deferrable_ = true;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_QUIC_PACKET_COMMAND_BUFFER_H_
@@ -0,0 +1,162 @@
+// Copyright (c) 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/quic_packet_command_buffer.h"
+
+#include <cstring>
+#include <string>
+
+#include "quic/core/quic_time.h"
+#include "quic/platform/api/quic_test.h"
+#include "quic/test_tools/quic_test_utils.h"
+
+using testing::_;
+using testing::InSequence;
+using testing::Invoke;
+using testing::Return;
+using testing::StrictMock;
+
+namespace quic {
+namespace test {
+namespace {
+
+class QuicPacketCommandBufferTest : public QuicTest {
+ protected:
+  QuicPacketCommandBufferTest()
+      : recorder_(&inline_visitor_, &buffer_),
+        creation_time_(QuicTime::Zero() + QuicTime::Delta::FromSeconds(1)) {
+    header_.packet_number = QuicPacketNumber(42);
+  }
+
+  // Records the callback sequence the framer produces for a typical
+  // decrypted packet carrying a stream frame. |data| is deliberately
+  // destroyed by callers to prove the buffer owns its copy.
+  void RecordStreamPacket(const char* data, size_t length) {
+    recorder_.OnPacket();
+    EXPECT_TRUE(recorder_.OnUnauthenticatedPublicHeader(header_));
+    EXPECT_TRUE(recorder_.OnUnauthenticatedHeader(header_));
+    recorder_.OnDecryptedPacket(length, ENCRYPTION_FORWARD_SECURE);
+    EXPECT_TRUE(recorder_.OnPacketHeader(header_));
+    EXPECT_TRUE(recorder_.OnStreamFrame(
+        QuicStreamFrame(3, /*fin=*/false, /*offset=*/0,
+                        absl::string_view(data, length))));
+    recorder_.OnPacketComplete();
+  }
+
+  StrictMock<MockFramerVisitor> inline_visitor_;
+  StrictMock<MockFramerVisitor> apply_visitor_;
+  QuicPacketCommandBuffer buffer_;
+  QuicPacketCommandRecorder recorder_;
+  QuicPacketHeader header_;
+  QuicTime creation_time_;
+};
+
+TEST_F(QuicPacketCommandBufferTest, ReplaysCallbacksInOrder) {
+  char data[] = "stream payload";
+  RecordStreamPacket(data, sizeof(data) - 1);
+  // Overwrite the original buffer; the replay must use the deep copy.
+  memset(data, 'x', sizeof(data) - 1);
+
+  InSequence s;
+  EXPECT_CALL(apply_visitor_, OnPacket());
+  EXPECT_CALL(apply_visitor_, OnUnauthenticatedPublicHeader(_))
+      .WillOnce(Return(true));
+  EXPECT_CALL(apply_visitor_, OnUnauthenticatedHeader(_))
+      .WillOnce(Return(true));
+  EXPECT_CALL(apply_visitor_,
+              OnDecryptedPacket(sizeof(data) - 1, ENCRYPTION_FORWARD_SECURE));
+  EXPECT_CALL(apply_visitor_, OnPacketHeader(_))
+      .WillOnce(Invoke([this](const QuicPacketHeader& header) {
+        EXPECT_EQ(header_.packet_number, header.packet_number);
+        return true;
+      }));
+  EXPECT_CALL(apply_visitor_, OnStreamFrame(_))
+      .WillOnce(Invoke([](const QuicStreamFrame& frame) {
+        EXPECT_EQ("stream payload",
+                  absl::string_view(frame.data_buffer, frame.data_length));
+        return true;
+      }));
+  EXPECT_CALL(apply_visitor_, OnPacketComplete());
+
+  EXPECT_TRUE(recorder_.deferrable());
+  EXPECT_TRUE(buffer_.ApplyTo(&apply_visitor_));
+}
+
+TEST_F(QuicPacketCommandBufferTest, ReplaysAckEvents) {
+  EXPECT_TRUE(recorder_.OnPacketHeader(header_));
+  EXPECT_TRUE(recorder_.OnAckFrameStart(QuicPacketNumber(10),
+                                        QuicTime::Delta::FromMilliseconds(3)));
+  EXPECT_TRUE(
+      recorder_.OnAckRange(QuicPacketNumber(5), QuicPacketNumber(11)));
+  EXPECT_TRUE(recorder_.OnAckTimestamp(QuicPacketNumber(10), creation_time_));
+  EXPECT_TRUE(recorder_.OnAckFrameEnd(QuicPacketNumber(5)));
+  recorder_.OnPacketComplete();
+
+  InSequence s;
+  EXPECT_CALL(apply_visitor_, OnPacketHeader(_)).WillOnce(Return(true));
+  EXPECT_CALL(apply_visitor_,
+              OnAckFrameStart(QuicPacketNumber(10),
+                              QuicTime::Delta::FromMilliseconds(3)))
+      .WillOnce(Return(true));
+  EXPECT_CALL(apply_visitor_,
+              OnAckRange(QuicPacketNumber(5), QuicPacketNumber(11)))
+      .WillOnce(Return(true));
+  EXPECT_CALL(apply_visitor_,
+              OnAckTimestamp(QuicPacketNumber(10), creation_time_))
+      .WillOnce(Return(true));
+  EXPECT_CALL(apply_visitor_, OnAckFrameEnd(QuicPacketNumber(5)))
+      .WillOnce(Return(true));
+  EXPECT_CALL(apply_visitor_, OnPacketComplete());
+
+  EXPECT_TRUE(buffer_.ApplyTo(&apply_visitor_));
+}
+
+TEST_F(QuicPacketCommandBufferTest, ReplayStopsWhenVisitorDeclines) {
+  char data[] = "stream payload";
+  RecordStreamPacket(data, sizeof(data) - 1);
+
+  InSequence s;
+  EXPECT_CALL(apply_visitor_, OnPacket());
+  EXPECT_CALL(apply_visitor_, OnUnauthenticatedPublicHeader(_))
+      .WillOnce(Return(true));
+  EXPECT_CALL(apply_visitor_, OnUnauthenticatedHeader(_))
+      .WillOnce(Return(true));
+  EXPECT_CALL(apply_visitor_, OnDecryptedPacket(_, _));
+  EXPECT_CALL(apply_visitor_, OnPacketHeader(_)).WillOnce(Return(true));
+  EXPECT_CALL(apply_visitor_, OnStreamFrame(_)).WillOnce(Return(false));
+  // No OnPacketComplete: replay stopped at the declined frame.
+
+  EXPECT_FALSE(buffer_.ApplyTo(&apply_visitor_));
+}
+
+TEST_F(QuicPacketCommandBufferTest, ControlCallbacksForwardInline) {
+  EXPECT_CALL(inline_visitor_, OnKeyUpdate(KeyUpdateReason::kRemote));
+  recorder_.OnKeyUpdate(KeyUpdateReason::kRemote);
+  EXPECT_FALSE(recorder_.deferrable());
+  // Nothing was recorded for deferred application.
+  EXPECT_TRUE(buffer_.empty());
+}
+
+TEST_F(QuicPacketCommandBufferTest, VersionMismatchForwardsInline) {
+  EXPECT_CALL(inline_visitor_, OnProtocolVersionMismatch(_))
+      .WillOnce(Return(false));
+  EXPECT_FALSE(
+      recorder_.OnProtocolVersionMismatch(UnsupportedQuicVersion()));
+  EXPECT_FALSE(recorder_.deferrable());
+}
+
+TEST_F(QuicPacketCommandBufferTest, ClearDiscardsCommands) {
+  char data[] = "stream payload";
+  RecordStreamPacket(data, sizeof(data) - 1);
+  EXPECT_FALSE(buffer_.empty());
+  buffer_.Clear();
+  EXPECT_TRUE(buffer_.empty());
+  EXPECT_EQ(0u, buffer_.num_commands());
+  // An empty buffer replays nothing.
+  EXPECT_TRUE(buffer_.ApplyTo(&apply_visitor_));
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
@@ -7,9 +7,11 @@
 #include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <limits>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/base/macros.h"
 #include "absl/base/optimization.h"
@@ -25,6 +27,7 @@
 #include "quic/core/quic_constants.h"
 #include "quic/core/quic_data_writer.h"
 #include "quic/core/quic_error_codes.h"
+#include "quic/core/quic_stage_latency_recorder.h"
 #include "quic/core/quic_types.h"
 #include "quic/core/quic_utils.h"
 #include "quic/core/quic_versions.h"
@@ -133,7 +136,8 @@ QuicPacketCreator::QuicPacketCreator(QuicConnectionId server_connection_id,
       max_datagram_frame_size_(0),
       chaos_protection_enabled_(
           GetQuicFlag(FLAGS_quic_enable_chaos_protection) &&
-          framer->perspective() == Perspective::IS_CLIENT) {
+          framer->perspective() == Perspective::IS_CLIENT),
+      max_retransmission_templates_(0) {
   SetMaxPacketLength(kDefaultMaxPacketSize);
   if (!framer_->version().UsesTls()) {
     // QUIC+TLS negotiates the maximum datagram frame size via the
@@ -282,6 +286,17 @@ void QuicPacketCreator::SkipNPacketNumbers(
         << " last frame type:" << queued_frames_.back().type;
     return;
   }
+  if (!packet_.packet_number.IsInitialized()) {
+    if (count == 0) {
+      return;
+    }
+    // No packet has been created yet; skipping starts counting from the
+    // first sending packet number.
+    packet_.packet_number = framer_->first_sending_packet_number() + count - 1;
+    UpdatePacketNumberLength(least_packet_awaited_by_peer,
+                             max_packets_in_flight);
+    return;
+  }
   if (packet_.packet_number > packet_.packet_number + count) {
     // Skipping count packet numbers causes packet number wrapping around,
     // reject it.
@@ -468,6 +483,8 @@ void QuicPacketCreator::FlushCurrentPacket() {
   if (!HasPendingFrames() && pending_padding_bytes_ == 0) {
     return;
   }
+  QuicScopedStageLatencySampler latency_sampler(
+      QuicStageLatencyRecorder::kFlushPacket);
 
   ABSL_CACHELINE_ALIGNED char stack_buffer[kMaxOutgoingPacketSize];
   QuicOwnedPacketBuffer external_buffer(delegate_->GetPacketBuffer());
@@ -478,7 +495,9 @@ void QuicPacketCreator::FlushCurrentPacket() {
   }
 
   QUICHE_DCHECK_EQ(nullptr, packet_.encrypted_buffer) << ENDPOINT;
-  if (!SerializePacket(std::move(external_buffer), kMaxOutgoingPacketSize)) {
+  const bool success =
+      SerializePacket(std::move(external_buffer), kMaxOutgoingPacketSize);
+  if (!success) {
     return;
   }
   OnSerializedPacket();
@@ -873,16 +892,29 @@ bool QuicPacketCreator::SerializePacket(QuicOwnedPacketBuffer encrypted_buffer,
   if (!possibly_truncated_by_length) {
     QUICHE_DCHECK_EQ(packet_size_, length) << ENDPOINT;
   }
+  const size_t associated_data_length =
+      GetStartOfEncryptedData(framer_->transport_version(), header);
+  // Encryption below overwrites the buffer in place, so the plaintext must be
+  // captured first if this packet qualifies as a retransmission template.
+  const bool cache_retransmission_template =
+      !length_with_chaos_protection.has_value() &&
+      ShouldCacheRetransmissionTemplate();
+  std::string template_plaintext;
+  if (cache_retransmission_template) {
+    template_plaintext.assign(encrypted_buffer.buffer, length);
+  }
   const size_t encrypted_length = framer_->EncryptInPlace(
-      packet_.encryption_level, packet_.packet_number,
-      GetStartOfEncryptedData(framer_->transport_version(), header), length,
-      encrypted_buffer_len, encrypted_buffer.buffer);
+      packet_.encryption_level, packet_.packet_number, associated_data_length,
+      length, encrypted_buffer_len, encrypted_buffer.buffer);
   if (encrypted_length == 0) {
-    QUIC_BUG(quic_bug_10752_17)
-        << ENDPOINT << "Failed to encrypt packet number "
-        << packet_.packet_number;
+    QUIC_BUG(quic_bug_10752_17) << ENDPOINT
+                                << "Failed to encrypt packet number "
+                                << packet_.packet_number;
     return false;
   }
+  if (cache_retransmission_template) {
+    CacheRetransmissionTemplate(template_plaintext, associated_data_length);
+  }
 
   packet_size_ = 0;
   packet_.encrypted_buffer = encrypted_buffer.buffer;
@@ -1300,8 +1332,44 @@ QuicConsumedData QuicPacketCreator::ConsumeData(QuicStreamId id,
       << ENDPOINT
       << "Packet flusher is not attached when "
          "generator tries to write stream data.";
-  bool has_handshake = QuicUtils::IsCryptoStreamId(transport_version(), id);
   MaybeBundleAckOpportunistically();
+  return ConsumeDataInternal(id, write_length, offset, state);
+}
+
+std::vector<QuicConsumedData> QuicPacketCreator::ConsumeDataBatch(
+    absl::Span<const StreamDataChunk> chunks) {
+  QUIC_BUG_IF(quic_batch_consume_without_flusher, !flusher_attached_)
+      << ENDPOINT
+      << "Packet flusher is not attached when "
+         "generator tries to batch write stream data.";
+  std::vector<QuicConsumedData> consumed_data;
+  consumed_data.reserve(chunks.size());
+  // Bundle an ACK at most once for the whole batch instead of once per chunk.
+  MaybeBundleAckOpportunistically();
+  for (const StreamDataChunk& chunk : chunks) {
+    QUIC_BUG_IF(quic_batch_consume_crypto_data,
+                QuicUtils::IsCryptoStreamId(transport_version(), chunk.id))
+        << ENDPOINT << "Crypto stream data cannot be batched.";
+    const QuicConsumedData consumed =
+        ConsumeDataInternal(chunk.id, chunk.length, chunk.offset, chunk.state);
+    consumed_data.push_back(consumed);
+    if (consumed.bytes_consumed < chunk.length ||
+        (chunk.state != NO_FIN && !consumed.fin_consumed)) {
+      // The delegate stopped allowing packets (e.g. congestion blocked).
+      break;
+    }
+  }
+  // Mark any remaining chunks as unconsumed.
+  consumed_data.resize(chunks.size(), QuicConsumedData(0, false));
+  return consumed_data;
+}
+
+QuicConsumedData QuicPacketCreator::ConsumeDataInternal(
+    QuicStreamId id,
+    size_t write_length,
+    QuicStreamOffset offset,
+    StreamSendingState state) {
+  bool has_handshake = QuicUtils::IsCryptoStreamId(transport_version(), id);
   bool fin = state != NO_FIN;
   QUIC_BUG_IF(quic_bug_12398_17, has_handshake && fin)
       << ENDPOINT << "Handshake packets should never send a fin";
@@ -1592,6 +1660,146 @@ void QuicPacketCreator::SendRemainingPendingPadding() {
   }
 }
 
+void QuicPacketCreator::EnableRetransmissionTemplates(size_t max_templates) {
+  max_retransmission_templates_ = max_templates;
+  if (max_retransmission_templates_ == 0) {
+    retransmission_templates_.clear();
+    return;
+  }
+  while (retransmission_templates_.size() > max_retransmission_templates_) {
+    retransmission_templates_.erase(retransmission_templates_.begin());
+  }
+}
+
+void QuicPacketCreator::ClearRetransmissionTemplates() {
+  retransmission_templates_.clear();
+}
+
+bool QuicPacketCreator::HasRetransmissionTemplate(
+    QuicPacketNumber original_packet_number) const {
+  return retransmission_templates_.contains(original_packet_number);
+}
+
+bool QuicPacketCreator::ShouldCacheRetransmissionTemplate() const {
+  if (max_retransmission_templates_ == 0) {
+    return false;
+  }
+  if (packet_.encryption_level != ENCRYPTION_FORWARD_SECURE) {
+    return false;
+  }
+  // ACK contents and message payloads go stale; only cache packets whose
+  // payload can be retransmitted verbatim.
+  if (packet_.has_ack || packet_.has_stop_waiting || packet_.has_message ||
+      packet_.has_ack_frequency) {
+    return false;
+  }
+  if (packet_.retransmittable_frames.empty()) {
+    return false;
+  }
+  for (const QuicFrame& frame : queued_frames_) {
+    if (frame.type != STREAM_FRAME && frame.type != PADDING_FRAME) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void QuicPacketCreator::CacheRetransmissionTemplate(
+    absl::string_view plaintext,
+    size_t header_length) {
+  RetransmissionTemplate packet_template;
+  packet_template.plaintext = std::string(plaintext);
+  packet_template.header_length = header_length;
+  packet_template.packet_number_length = GetPacketNumberLength();
+  packet_template.encryption_level = packet_.encryption_level;
+  for (const QuicFrame& frame : packet_.retransmittable_frames) {
+    if (frame.type == STREAM_FRAME) {
+      packet_template.retransmittable_frames.push_back(frame);
+    }
+  }
+  retransmission_templates_.emplace(packet_.packet_number,
+                                    std::move(packet_template));
+  while (retransmission_templates_.size() > max_retransmission_templates_) {
+    retransmission_templates_.erase(retransmission_templates_.begin());
+  }
+}
+
+bool QuicPacketCreator::MaybeSerializeFromRetransmissionTemplate(
+    QuicPacketNumber original_packet_number,
+    TransmissionType type) {
+  auto it = retransmission_templates_.find(original_packet_number);
+  if (it == retransmission_templates_.end()) {
+    return false;
+  }
+  const RetransmissionTemplate& packet_template = it->second;
+  if (HasPendingFrames() || packet_.encrypted_buffer != nullptr) {
+    // Do not clobber a packet under construction.
+    return false;
+  }
+  if (packet_.encryption_level != packet_template.encryption_level ||
+      !framer_->HasEncrypterOfEncryptionLevel(
+          packet_template.encryption_level) ||
+      GetPacketNumberLength() != packet_template.packet_number_length) {
+    // The header would no longer serialize to the same length; fall back to
+    // regular retransmission.
+    return false;
+  }
+
+  ABSL_CACHELINE_ALIGNED char stack_buffer[kMaxOutgoingPacketSize];
+  QuicOwnedPacketBuffer buffer(delegate_->GetPacketBuffer());
+  if (buffer.buffer == nullptr) {
+    buffer.buffer = stack_buffer;
+    buffer.release_buffer = nullptr;
+  }
+  memcpy(buffer.buffer, packet_template.plaintext.data(),
+         packet_template.plaintext.size());
+
+  QuicPacketHeader header;
+  // FillPacketHeader increments packet_number_.
+  FillPacketHeader(&header);
+  // The packet number occupies the last |packet_number_length| bytes of the
+  // header; patch it in place.
+  QuicDataWriter writer(packet_template.packet_number_length,
+                        buffer.buffer + packet_template.header_length -
+                            packet_template.packet_number_length);
+  if (!writer.WriteBytesToUInt64(packet_template.packet_number_length,
+                                 packet_.packet_number.ToUint64())) {
+    QUIC_BUG(quic_bug_template_packet_number_patch)
+        << ENDPOINT << "Failed to patch packet number into template of "
+        << original_packet_number;
+    ClearPacket();
+    return false;
+  }
+  const size_t encrypted_length = framer_->EncryptInPlace(
+      packet_template.encryption_level, packet_.packet_number,
+      packet_template.header_length, packet_template.plaintext.size(),
+      kMaxOutgoingPacketSize, buffer.buffer);
+  if (encrypted_length == 0) {
+    QUIC_BUG(quic_bug_template_encrypt_failure)
+        << ENDPOINT << "Failed to encrypt retransmission of "
+        << original_packet_number << " as " << packet_.packet_number;
+    ClearPacket();
+    return false;
+  }
+
+  QUIC_DVLOG(1) << ENDPOINT << "Retransmitting " << original_packet_number
+                << " as " << packet_.packet_number
+                << " from its serialized template";
+  QUIC_CODE_COUNT(quic_retransmission_from_template);
+  packet_.fate = delegate_->GetSerializedPacketFate(
+      /*is_mtu_discovery=*/false, packet_.encryption_level);
+  packet_.transmission_type = type;
+  for (const QuicFrame& frame : packet_template.retransmittable_frames) {
+    packet_.retransmittable_frames.push_back(frame);
+  }
+  packet_.encrypted_buffer = buffer.buffer;
+  packet_.encrypted_length = encrypted_length;
+  buffer.buffer = nullptr;
+  packet_.release_encrypted_buffer = std::move(buffer).release_buffer;
+  OnSerializedPacket();
+  return true;
+}
+
 void QuicPacketCreator::SetServerConnectionIdLength(uint32_t length) {
   if (length == 0) {
     SetServerConnectionIdIncluded(CONNECTION_ID_ABSENT);
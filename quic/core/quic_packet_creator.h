@@ -17,12 +17,14 @@
 
 #include <cstddef>
 #include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 
 #include "absl/base/attributes.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/optional.h"
+#include "absl/types/span.h"
 #include "quic/core/frames/quic_stream_frame.h"
 #include "quic/core/quic_coalesced_packet.h"
 #include "quic/core/quic_connection_id.h"
@@ -31,6 +33,7 @@
 #include "quic/core/quic_types.h"
 #include "quic/platform/api/quic_export.h"
 #include "common/quiche_circular_deque.h"
+#include "common/quiche_linked_hash_map.h"
 
 namespace quic {
 namespace test {
@@ -370,6 +373,24 @@ class QUIC_EXPORT_PRIVATE QuicPacketCreator {
                                QuicStreamOffset offset,
                                StreamSendingState state);
 
+  // A chunk of stream data to be consumed by ConsumeDataBatch().
+  struct QUIC_EXPORT_PRIVATE StreamDataChunk {
+    QuicStreamId id;
+    QuicStreamOffset offset;
+    size_t length;
+    StreamSendingState state;
+  };
+
+  // Consumes |chunks| in order, packing their stream frames into as few
+  // packets as possible. Equivalent to calling ConsumeData() once per chunk,
+  // except that an ACK is opportunistically bundled at most once for the whole
+  // batch instead of once per chunk. Returns one QuicConsumedData per chunk;
+  // once a chunk is not fully consumed (e.g. the delegate stops allowing
+  // packets), the remaining chunks are left unconsumed. Must not be used for
+  // crypto stream data.
+  std::vector<QuicConsumedData> ConsumeDataBatch(
+      absl::Span<const StreamDataChunk> chunks);
+
   // Sends as many data only packets as allowed by the send algorithm and the
   // available iov.
   // This path does not support padding, or bundling pending frames.
@@ -413,6 +434,37 @@ class QUIC_EXPORT_PRIVATE QuicPacketCreator {
   // Pending paddings should only be sent when there is nothing else to send.
   void SendRemainingPendingPadding();
 
+  // Enables caching of the serialized plaintext of sent 1-RTT packets whose
+  // retransmittable frames are all stream frames, so that such packets can be
+  // retransmitted by patching the packet number and re-running AEAD, without
+  // re-serializing frames. At most |max_templates| most recent packets are
+  // retained; 0 disables caching and clears existing templates.
+  void EnableRetransmissionTemplates(size_t max_templates);
+
+  // Drops all cached templates. Must be called when the 1-RTT encryption
+  // state changes in a way that invalidates serialized headers, e.g. a key
+  // update: the template plaintext embeds the key phase bit, so re-encrypting
+  // it under the new keys would produce a packet the peer cannot decrypt.
+  void ClearRetransmissionTemplates();
+
+  // Returns true if any retransmission template is cached.
+  bool has_retransmission_templates() const {
+    return !retransmission_templates_.empty();
+  }
+
+  // Returns true if a retransmission template for |original_packet_number| is
+  // cached.
+  bool HasRetransmissionTemplate(QuicPacketNumber original_packet_number) const;
+
+  // Serializes a copy of |original_packet_number| with a fresh packet number
+  // from its cached template and hands it to the delegate. Returns false
+  // without side effects if no template is cached, a packet is under
+  // construction, or the encryption state no longer matches the template; the
+  // caller should fall back to regular retransmission.
+  bool MaybeSerializeFromRetransmissionTemplate(
+      QuicPacketNumber original_packet_number,
+      TransmissionType type);
+
   // Set the minimum number of bytes for the server connection id length;
   void SetServerConnectionIdLength(uint32_t length);
 
@@ -507,6 +559,14 @@ class QUIC_EXPORT_PRIVATE QuicPacketCreator {
  private:
   friend class test::QuicPacketCreatorPeer;
 
+  // Body of ConsumeData(), minus the opportunistic ACK bundling. Called once
+  // per chunk by ConsumeDataBatch(), which bundles an ACK for the whole batch
+  // up front.
+  QuicConsumedData ConsumeDataInternal(QuicStreamId id,
+                                       size_t write_length,
+                                       QuicStreamOffset offset,
+                                       StreamSendingState state);
+
   // Used to 1) clear queued_frames_, 2) report unrecoverable error (if
   // serialization fails) upon exiting the scope.
   class QUIC_EXPORT_PRIVATE ScopedSerializationFailureHandler {
@@ -639,6 +699,30 @@ class QUIC_EXPORT_PRIVATE QuicPacketCreator {
   // fail to add.
   bool AddPaddedFrameWithRetry(const QuicFrame& frame);
 
+  // Serialized plaintext of a sent packet, kept to serialize byte-identical
+  // retransmissions without rebuilding frames.
+  struct QUIC_NO_EXPORT RetransmissionTemplate {
+    // Header and frames as serialized before encryption.
+    std::string plaintext;
+    // Length of the packet header, i.e. offset of the first frame byte and
+    // the length of the associated data passed to the AEAD.
+    size_t header_length;
+    QuicPacketNumberLength packet_number_length;
+    EncryptionLevel encryption_level;
+    // Stream frames to attach to the retransmission for ack/loss tracking.
+    QuicFrames retransmittable_frames;
+  };
+
+  // Returns true if the packet being serialized qualifies for template
+  // caching: 1-RTT, no ACK or other non-retransmittable payload beyond
+  // padding, and all retransmittable frames are stream frames.
+  bool ShouldCacheRetransmissionTemplate() const;
+
+  // Stores |plaintext| as the retransmission template of the packet being
+  // serialized, evicting the oldest template if over the limit.
+  void CacheRetransmissionTemplate(absl::string_view plaintext,
+                                   size_t header_length);
+
   // Does not own these delegates or the framer.
   DelegateInterface* delegate_;
   DebugDelegate* debug_delegate_;
@@ -712,6 +796,17 @@ class QUIC_EXPORT_PRIVATE QuicPacketCreator {
 
   // Whether to attempt protecting initial packets with chaos.
   bool chaos_protection_enabled_;
+
+  // Maximum number of retransmission templates to retain. 0 disables
+  // template caching.
+  size_t max_retransmission_templates_;
+
+  // Retransmission templates of recently sent packets, keyed by packet
+  // number in insertion (i.e. packet number) order.
+  quiche::QuicheLinkedHashMap<QuicPacketNumber,
+                              RetransmissionTemplate,
+                              QuicPacketNumberHash>
+      retransmission_templates_;
 };
 
 }  // namespace quic
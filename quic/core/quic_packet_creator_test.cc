@@ -1413,6 +1413,110 @@ TEST_P(QuicPacketCreatorTest, ConsumeDataLargerThanOneStreamFrame) {
   DeleteSerializedPacket();
 }
 
+TEST_P(QuicPacketCreatorTest, RetransmitFromTemplate) {
+  creator_.set_encryption_level(ENCRYPTION_FORWARD_SECURE);
+  creator_.EnableRetransmissionTemplates(16);
+
+  QuicFrame frame;
+  MakeIOVector("template data", &iov_);
+  QuicStreamId stream_id = QuicUtils::GetFirstBidirectionalStreamId(
+      client_framer_.transport_version(), Perspective::IS_CLIENT);
+  ASSERT_TRUE(creator_.ConsumeDataToFillCurrentPacket(
+      stream_id, &iov_, 1u, iov_.iov_len, 0u, 0u, false, false,
+      NOT_RETRANSMISSION, &frame));
+  EXPECT_CALL(delegate_, OnSerializedPacket(_))
+      .WillOnce(Invoke(this, &QuicPacketCreatorTest::SaveSerializedPacket));
+  creator_.FlushCurrentPacket();
+  ASSERT_TRUE(serialized_packet_);
+  const QuicPacketNumber original_packet_number =
+      serialized_packet_->packet_number;
+  EXPECT_TRUE(creator_.HasRetransmissionTemplate(original_packet_number));
+  DeleteSerializedPacket();
+
+  // Reserialize from the template under a fresh packet number and verify the
+  // peer parses the same stream frame.
+  EXPECT_CALL(delegate_, OnSerializedPacket(_))
+      .WillOnce(Invoke(this, &QuicPacketCreatorTest::SaveSerializedPacket));
+  ASSERT_TRUE(creator_.MaybeSerializeFromRetransmissionTemplate(
+      original_packet_number, PTO_RETRANSMISSION));
+  ASSERT_TRUE(serialized_packet_);
+  EXPECT_GT(serialized_packet_->packet_number, original_packet_number);
+  EXPECT_EQ(PTO_RETRANSMISSION, serialized_packet_->transmission_type);
+  ASSERT_EQ(1u, serialized_packet_->retransmittable_frames.size());
+  CheckStreamFrame(serialized_packet_->retransmittable_frames[0], stream_id,
+                   "template data", 0u, false);
+
+  {
+    InSequence s;
+    EXPECT_CALL(framer_visitor_, OnPacket());
+    EXPECT_CALL(framer_visitor_, OnUnauthenticatedPublicHeader(_));
+    EXPECT_CALL(framer_visitor_, OnUnauthenticatedHeader(_));
+    EXPECT_CALL(framer_visitor_, OnDecryptedPacket(_, _));
+    EXPECT_CALL(framer_visitor_, OnPacketHeader(_));
+    EXPECT_CALL(framer_visitor_, OnStreamFrame(_));
+    if (client_framer_.version().HasHeaderProtection()) {
+      EXPECT_CALL(framer_visitor_, OnPaddingFrame(_))
+          .Times(testing::AnyNumber());
+    }
+    EXPECT_CALL(framer_visitor_, OnPacketComplete());
+  }
+  ProcessPacket(*serialized_packet_);
+  DeleteSerializedPacket();
+}
+
+TEST_P(QuicPacketCreatorTest, RetransmissionTemplatesCleared) {
+  creator_.set_encryption_level(ENCRYPTION_FORWARD_SECURE);
+  creator_.EnableRetransmissionTemplates(16);
+
+  QuicFrame frame;
+  MakeIOVector("template data", &iov_);
+  QuicStreamId stream_id = QuicUtils::GetFirstBidirectionalStreamId(
+      client_framer_.transport_version(), Perspective::IS_CLIENT);
+  ASSERT_TRUE(creator_.ConsumeDataToFillCurrentPacket(
+      stream_id, &iov_, 1u, iov_.iov_len, 0u, 0u, false, false,
+      NOT_RETRANSMISSION, &frame));
+  EXPECT_CALL(delegate_, OnSerializedPacket(_))
+      .WillOnce(Invoke(this, &QuicPacketCreatorTest::SaveSerializedPacket));
+  creator_.FlushCurrentPacket();
+  ASSERT_TRUE(serialized_packet_);
+  const QuicPacketNumber original_packet_number =
+      serialized_packet_->packet_number;
+  EXPECT_TRUE(creator_.HasRetransmissionTemplate(original_packet_number));
+  DeleteSerializedPacket();
+
+  // After the cache is cleared (as the connection does on a key update, since
+  // the template plaintext embeds the old key phase bit) the template path
+  // must decline and let regular retransmission run.
+  creator_.ClearRetransmissionTemplates();
+  EXPECT_FALSE(creator_.has_retransmission_templates());
+  EXPECT_FALSE(creator_.HasRetransmissionTemplate(original_packet_number));
+  EXPECT_FALSE(creator_.MaybeSerializeFromRetransmissionTemplate(
+      original_packet_number, PTO_RETRANSMISSION));
+}
+
+TEST_P(QuicPacketCreatorTest, NoRetransmissionTemplateForAckBearingPacket) {
+  creator_.set_encryption_level(ENCRYPTION_FORWARD_SECURE);
+  creator_.EnableRetransmissionTemplates(16);
+
+  // A packet bundling an ACK must not be cached: its ACK contents go stale.
+  QuicAckFrame ack_frame(InitAckFrame(1));
+  EXPECT_TRUE(creator_.AddFrame(QuicFrame(&ack_frame), NOT_RETRANSMISSION));
+  QuicFrame frame;
+  MakeIOVector("test", &iov_);
+  QuicStreamId stream_id = QuicUtils::GetFirstBidirectionalStreamId(
+      client_framer_.transport_version(), Perspective::IS_CLIENT);
+  ASSERT_TRUE(creator_.ConsumeDataToFillCurrentPacket(
+      stream_id, &iov_, 1u, iov_.iov_len, 0u, 0u, false, false,
+      NOT_RETRANSMISSION, &frame));
+  EXPECT_CALL(delegate_, OnSerializedPacket(_))
+      .WillOnce(Invoke(this, &QuicPacketCreatorTest::SaveSerializedPacket));
+  creator_.FlushCurrentPacket();
+  ASSERT_TRUE(serialized_packet_);
+  EXPECT_FALSE(
+      creator_.HasRetransmissionTemplate(serialized_packet_->packet_number));
+  DeleteSerializedPacket();
+}
+
 TEST_P(QuicPacketCreatorTest, AddFrameAndFlush) {
   if (!GetParam().version_serialization) {
     creator_.StopSendingVersion();
@@ -2447,6 +2551,23 @@ class MultiplePacketsTestPacketCreator : public QuicPacketCreator {
     return QuicPacketCreator::ConsumeData(id, total_length, offset, state);
   }
 
+  std::vector<QuicConsumedData> ConsumeDataBatch(
+      absl::Span<const StreamDataChunk> chunks,
+      const struct iovec* iov,
+      int iov_count) {
+    // Save each chunk's data before it is consumed.
+    for (const StreamDataChunk& chunk : chunks) {
+      if (chunk.length > 0) {
+        producer_->SaveStreamData(chunk.id, iov, iov_count, 0, chunk.length);
+      }
+    }
+    if (!has_ack() && delegate_->ShouldGeneratePacket(NO_RETRANSMITTABLE_DATA,
+                                                      NOT_HANDSHAKE)) {
+      EXPECT_CALL(*delegate_, MaybeBundleAckOpportunistically()).Times(1);
+    }
+    return QuicPacketCreator::ConsumeDataBatch(chunks);
+  }
+
   MessageStatus AddMessageFrame(QuicMessageId message_id,
                                 QuicMemSlice message) {
     if (!has_ack() && delegate_->ShouldGeneratePacket(NO_RETRANSMITTABLE_DATA,
@@ -2783,6 +2904,57 @@ TEST_F(QuicPacketCreatorMultiplePacketsTest,
   CheckPacketContains(contents, 0);
 }
 
+TEST_F(QuicPacketCreatorMultiplePacketsTest, ConsumeDataBatch) {
+  delegate_.SetCanWriteAnything();
+
+  EXPECT_CALL(delegate_, OnSerializedPacket(_))
+      .WillRepeatedly(
+          Invoke(this, &QuicPacketCreatorMultiplePacketsTest::SavePacket));
+  const QuicStreamId stream1_id = QuicUtils::GetFirstBidirectionalStreamId(
+      framer_.transport_version(), Perspective::IS_CLIENT);
+  const QuicStreamId stream2_id = stream1_id + 4;
+
+  // Both chunks fit into, and share, a single packet.
+  MakeIOVector("foo", &iov_);
+  const QuicPacketCreator::StreamDataChunk chunks[] = {
+      {stream1_id, /*offset=*/0, /*length=*/3, NO_FIN},
+      {stream2_id, /*offset=*/0, /*length=*/3, FIN},
+  };
+  const std::vector<QuicConsumedData> consumed =
+      creator_.ConsumeDataBatch(chunks, &iov_, 1u);
+  ASSERT_EQ(2u, consumed.size());
+  EXPECT_EQ(3u, consumed[0].bytes_consumed);
+  EXPECT_FALSE(consumed[0].fin_consumed);
+  EXPECT_EQ(3u, consumed[1].bytes_consumed);
+  EXPECT_TRUE(consumed[1].fin_consumed);
+  EXPECT_TRUE(creator_.HasPendingFrames());
+  creator_.Flush();
+
+  PacketContents contents;
+  contents.num_stream_frames = 2;
+  CheckPacketContains(contents, 0);
+}
+
+TEST_F(QuicPacketCreatorMultiplePacketsTest, ConsumeDataBatch_NotWritable) {
+  delegate_.SetCanNotWrite();
+
+  MakeIOVector("foo", &iov_);
+  const QuicStreamId stream_id = QuicUtils::GetFirstBidirectionalStreamId(
+      framer_.transport_version(), Perspective::IS_CLIENT);
+  const QuicPacketCreator::StreamDataChunk chunks[] = {
+      {stream_id, /*offset=*/0, /*length=*/3, NO_FIN},
+      {stream_id + 4, /*offset=*/0, /*length=*/3, FIN},
+  };
+  const std::vector<QuicConsumedData> consumed =
+      creator_.ConsumeDataBatch(chunks, &iov_, 1u);
+  ASSERT_EQ(2u, consumed.size());
+  EXPECT_EQ(0u, consumed[0].bytes_consumed);
+  EXPECT_EQ(0u, consumed[1].bytes_consumed);
+  EXPECT_FALSE(consumed[1].fin_consumed);
+  EXPECT_FALSE(creator_.HasPendingFrames());
+  EXPECT_FALSE(creator_.HasPendingRetransmittableFrames());
+}
+
 // Test the behavior of ConsumeData when the data consumed is for the crypto
 // handshake stream.  Ensure that the packet is always sent and padded even if
 // the creator operates in batch mode.
@@ -4,6 +4,8 @@
 
 #include "quic/core/quic_packet_reader.h"
 
+#include <algorithm>
+
 #include "absl/base/macros.h"
 #include "quic/core/quic_packets.h"
 #include "quic/core/quic_process_packet_interface.h"
@@ -18,8 +20,12 @@
 namespace quic {
 
 QuicPacketReader::QuicPacketReader()
-    : read_buffers_(kNumPacketsPerReadMmsgCall),
-      read_results_(kNumPacketsPerReadMmsgCall) {
+    : QuicPacketReader(kNumPacketsPerReadMmsgCall) {}
+
+QuicPacketReader::QuicPacketReader(size_t num_packets_per_read)
+    : read_buffers_(std::min<size_t>(num_packets_per_read,
+                                     kMaxNumPacketsPerReadMmsgCall)),
+      read_results_(read_buffers_.size()) {
   QUICHE_DCHECK_EQ(read_buffers_.size(), read_results_.size());
   for (size_t i = 0; i < read_results_.size(); ++i) {
     read_results_[i].packet_buffer.buffer = read_buffers_[i].packet_buffer;
@@ -97,8 +103,26 @@ bool QuicPacketReader::ReadAndDispatchPackets(
       QUIC_CODE_COUNT(quic_packet_reader_no_google_packet_header);
     }
 
+    // Prefer the kernel (or NIC) receive timestamp over |now|: it is taken
+    // when the packet arrives at the host rather than when the event loop got
+    // around to reading the socket, so it is not inflated by scheduling
+    // delays. Guard against implausible values, e.g. a raw NIC timestamp from
+    // an unsynchronized NIC clock.
+    QuicTime receipt_time = now;
+    if (result.packet_info.HasValue(QuicUdpPacketInfoBit::RECV_TIMESTAMP)) {
+      QuicTime socket_timestamp = clock.ConvertWallTimeToQuicTime(
+          result.packet_info.receive_timestamp());
+      if (socket_timestamp <= now &&
+          now - socket_timestamp < QuicTime::Delta::FromSeconds(1)) {
+        receipt_time = socket_timestamp;
+      } else {
+        QUIC_CODE_COUNT(quic_packet_reader_implausible_recv_timestamp);
+      }
+    }
+
     QuicReceivedPacket packet(
-        result.packet_buffer.buffer, result.packet_buffer.buffer_len, now,
+        result.packet_buffer.buffer, result.packet_buffer.buffer_len,
+        receipt_time,
         /*owns_buffer=*/false, ttl, has_ttl, headers, headers_length,
         /*owns_header_buffer=*/false);
 
@@ -107,7 +131,7 @@ bool QuicPacketReader::ReadAndDispatchPackets(
   }
 
   // We may not have read all of the packets available on the socket.
-  return packets_read == kNumPacketsPerReadMmsgCall;
+  return packets_read == read_results_.size();
 }
 
 // static
@@ -20,9 +20,19 @@ namespace quic {
 // Read in larger batches to minimize recvmmsg overhead.
 const int kNumPacketsPerReadMmsgCall = 16;
 
+// Deeper batches for servers, where the syscall overhead of draining a
+// saturated socket dominates; bounded to keep the preallocated buffer ring at
+// a reasonable size (64 * ~1.5KB packet buffers plus control buffers).
+const int kMaxNumPacketsPerReadMmsgCall = 64;
+
 class QUIC_EXPORT_PRIVATE QuicPacketReader {
  public:
   QuicPacketReader();
+
+  // Preallocates a ring of |num_packets_per_read| packet buffers, each read
+  // draining up to that many datagrams in a single recvmmsg call.
+  // |num_packets_per_read| is capped at kMaxNumPacketsPerReadMmsgCall.
+  explicit QuicPacketReader(size_t num_packets_per_read);
   QuicPacketReader(const QuicPacketReader&) = delete;
   QuicPacketReader& operator=(const QuicPacketReader&) = delete;
 
@@ -32,6 +32,10 @@ struct QUIC_EXPORT_PRIVATE PerPacketOptions {
   QuicTime::Delta release_time_delay = QuicTime::Delta::Zero();
   // Whether it is allowed to send this packet without |release_time_delay|.
   bool allow_burst = false;
+  // The QoS class of this packet, derived from the streams whose data it
+  // carries. Writers that support per-packet marking translate it into the
+  // corresponding DSCP on the wire; other writers ignore it.
+  QuicQosClass qos_class = QOS_CLASS_DEFAULT;
 };
 
 // An interface between writers and the entity managing the
@@ -195,6 +195,14 @@ QUIC_PROTOCOL_FLAG(
     10,
     "The default initial value of the max ack height filter's window length.")
 
+QUIC_PROTOCOL_FLAG(
+    int32_t,
+    quic_bbr2_state_sampling_interval_ms,
+    0,
+    "If positive, BBRv2 records a fixed-width snapshot of its network model "
+    "at most once per this many milliseconds, retrievable from "
+    "QuicConnectionStats. Zero disables sampling.")
+
 QUIC_PROTOCOL_FLAG(
     double,
     quic_ack_aggregation_bandwidth_threshold,
@@ -287,4 +295,12 @@ QUIC_PROTOCOL_FLAG(
 
 QUIC_PROTOCOL_FLAG(bool, quic_use_lower_server_response_mtu_for_test, false,
                    "If true, cap server response packet size at 1250.")
+
+QUIC_PROTOCOL_FLAG(
+    bool,
+    quic_dispatcher_use_fast_cid_hash,
+    false,
+    "If true, the dispatcher session map hashes connection IDs with a keyed "
+    "hardware CRC32 hash instead of SipHash, and falls back to SipHash when "
+    "collision monitoring detects crafted collisions.")
 #endif
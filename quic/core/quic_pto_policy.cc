@@ -0,0 +1,24 @@
+// Copyright (c) 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/quic_pto_policy.h"
+
+namespace quic {
+
+QuicPtoPolicy QuicPtoPolicy::Datacenter() {
+  QuicPtoPolicy policy;
+  // In-cluster smoothed RTTs are tens of microseconds; a 100us floor keeps
+  // probes an order of magnitude above the RTT without waiting a full
+  // millisecond on the alarm granularity.
+  policy.min_pto = QuicTime::Delta::FromMicroseconds(100);
+  policy.handshake_min_pto = QuicTime::Delta::FromMicroseconds(500);
+  // Keep one millisecond of amplification protection before RTT samples
+  // exist; in-cluster peers are not spoofable but the handshake should not
+  // retransmit faster than the crypto stack can respond.
+  policy.min_pto_without_rtt_samples = QuicTime::Delta::FromMilliseconds(1);
+  policy.multiplier_without_rtt_samples = 2;
+  return policy;
+}
+
+}  // namespace quic
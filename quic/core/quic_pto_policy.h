@@ -0,0 +1,58 @@
+// Copyright (c) 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_QUIC_PTO_POLICY_H_
+#define QUICHE_QUIC_CORE_QUIC_PTO_POLICY_H_
+
+#include <cstddef>
+
+#include "quic/core/quic_constants.h"
+#include "quic/core/quic_time.h"
+#include "quic/platform/api/quic_export.h"
+
+namespace quic {
+
+// Deployment-profile tuning knobs for probe timeout (PTO) computation in
+// QuicSentPacketManager. The default-constructed policy reproduces the
+// internet-path behavior the manager has always had: millisecond-scale
+// floors that protect against spurious probes over jittery WAN paths.
+// Datacenter() lowers those floors to microsecond scale for in-cluster
+// deployments where smoothed RTTs are tens of microseconds and a
+// millisecond floor dominates tail RPC latency.
+struct QUIC_EXPORT_PRIVATE QuicPtoPolicy {
+  // Lower bound on the RTT-variance component of the PTO, and on a PTO
+  // clamped to TLP-like 2*SRTT, for APPLICATION_DATA packets.
+  QuicTime::Delta min_pto = kAlarmGranularity;
+
+  // Same bound, applied to INITIAL and HANDSHAKE packets. Kept separate
+  // because handshake probes retransmit crypto frames and can be tuned more
+  // (or less) aggressively than data probes.
+  QuicTime::Delta handshake_min_pto = kAlarmGranularity;
+
+  // Floor applied while there is no RTT sample yet, i.e. to the very first
+  // handshake probes. This bounds the retransmission rate reachable through
+  // an address-spoofing amplification attack, so it should not be lowered
+  // beyond what the deployment's ingress filtering justifies.
+  QuicTime::Delta min_pto_without_rtt_samples =
+      QuicTime::Delta::FromMilliseconds(10);
+
+  // Multiplier applied to the initial RTT while there is no RTT sample.
+  float multiplier_without_rtt_samples = 3;
+
+  // Multiplier applied to the RTT variance term of the PTO.
+  int rttvar_multiplier = 2;
+
+  // Number of PTOs to fire before exponential backoff starts.
+  size_t exponential_backoff_start_point = 0;
+
+  // The policy QuicSentPacketManager starts with.
+  static QuicPtoPolicy Default() { return QuicPtoPolicy(); }
+
+  // Microsecond-scale floors for intra-datacenter paths.
+  static QuicPtoPolicy Datacenter();
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_QUIC_PTO_POLICY_H_
@@ -0,0 +1,368 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/quic_qlog_emitter.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <limits>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "quic/platform/api/quic_logging.h"
+
+namespace quic {
+
+namespace {
+
+// CBOR major type 0 (unsigned integer) encoding. Returns the number of bytes
+// written, at most 9.
+size_t EncodeCborUint(uint64_t value, char* out) {
+  uint8_t* bytes = reinterpret_cast<uint8_t*>(out);
+  if (value < 24) {
+    bytes[0] = static_cast<uint8_t>(value);
+    return 1;
+  }
+  if (value <= 0xff) {
+    bytes[0] = 0x18;
+    bytes[1] = static_cast<uint8_t>(value);
+    return 2;
+  }
+  if (value <= 0xffff) {
+    bytes[0] = 0x19;
+    bytes[1] = static_cast<uint8_t>(value >> 8);
+    bytes[2] = static_cast<uint8_t>(value);
+    return 3;
+  }
+  if (value <= 0xffffffff) {
+    bytes[0] = 0x1a;
+    for (int i = 0; i < 4; ++i) {
+      bytes[1 + i] = static_cast<uint8_t>(value >> (24 - 8 * i));
+    }
+    return 5;
+  }
+  bytes[0] = 0x1b;
+  for (int i = 0; i < 8; ++i) {
+    bytes[1 + i] = static_cast<uint8_t>(value >> (56 - 8 * i));
+  }
+  return 9;
+}
+
+// Decodes a CBOR unsigned integer at |data| + |*offset|, advancing *offset.
+// Returns false on truncation or a non-integer major type.
+bool DecodeCborUint(absl::string_view data, size_t* offset, uint64_t* value) {
+  if (*offset >= data.size()) {
+    return false;
+  }
+  const uint8_t initial = static_cast<uint8_t>(data[*offset]);
+  ++*offset;
+  if (initial < 24) {
+    *value = initial;
+    return true;
+  }
+  size_t length;
+  switch (initial) {
+    case 0x18:
+      length = 1;
+      break;
+    case 0x19:
+      length = 2;
+      break;
+    case 0x1a:
+      length = 4;
+      break;
+    case 0x1b:
+      length = 8;
+      break;
+    default:
+      return false;
+  }
+  if (*offset + length > data.size()) {
+    return false;
+  }
+  *value = 0;
+  for (size_t i = 0; i < length; ++i) {
+    *value = (*value << 8) | static_cast<uint8_t>(data[*offset + i]);
+  }
+  *offset += length;
+  return true;
+}
+
+// One decoded record.
+struct DecodedRecord {
+  uint64_t connection_id_hash = 0;
+  uint64_t time_us = 0;
+  uint64_t event_type = 0;
+  uint64_t packet_number = 0;
+  uint64_t value = 0;
+};
+
+// Decodes the CBOR map of one record. Returns false if the record is not the
+// shape QuicQlogEmitter produces.
+bool DecodeRecord(absl::string_view payload, DecodedRecord* record) {
+  size_t offset = 0;
+  if (payload.empty() ||
+      static_cast<uint8_t>(payload[0]) != (0xa0 | 5)) {  // map of 5 pairs.
+    return false;
+  }
+  ++offset;
+  for (int i = 0; i < 5; ++i) {
+    uint64_t key;
+    uint64_t value;
+    if (!DecodeCborUint(payload, &offset, &key) ||
+        !DecodeCborUint(payload, &offset, &value)) {
+      return false;
+    }
+    switch (key) {
+      case QuicQlogEmitter::kKeyConnectionId:
+        record->connection_id_hash = value;
+        break;
+      case QuicQlogEmitter::kKeyTimeUs:
+        record->time_us = value;
+        break;
+      case QuicQlogEmitter::kKeyEventType:
+        record->event_type = value;
+        break;
+      case QuicQlogEmitter::kKeyPacketNumber:
+        record->packet_number = value;
+        break;
+      case QuicQlogEmitter::kKeyValue:
+        record->value = value;
+        break;
+      default:
+        return false;
+    }
+  }
+  return offset == payload.size();
+}
+
+// Appends the JSON qlog event for one decoded record.
+void AppendJsonEvent(const DecodedRecord& record,
+                     uint64_t first_time_us,
+                     std::string* json) {
+  const double relative_time_ms = (record.time_us - first_time_us) / 1000.0;
+  absl::StrAppend(json, "{\"time\":", absl::StrFormat("%.3f", relative_time_ms),
+                  ",\"group_id\":\"",
+                  absl::StrFormat("%016x", record.connection_id_hash), "\",");
+  switch (static_cast<QuicQlogEmitter::EventType>(record.event_type)) {
+    case QuicQlogEmitter::EventType::kPacketSent:
+      absl::StrAppend(json,
+                      "\"name\":\"transport:packet_sent\",\"data\":{"
+                      "\"header\":{\"packet_number\":",
+                      record.packet_number, "},\"raw\":{\"length\":",
+                      record.value, "}}");
+      break;
+    case QuicQlogEmitter::EventType::kAckReceived:
+      absl::StrAppend(json,
+                      "\"name\":\"recovery:metrics_updated\",\"data\":{"
+                      "\"smoothed_rtt\":",
+                      absl::StrFormat("%.3f", record.value / 1000.0),
+                      ",\"largest_acked_packet_number\":",
+                      record.packet_number, "}");
+      break;
+    case QuicQlogEmitter::EventType::kPacketLost:
+      absl::StrAppend(json,
+                      "\"name\":\"recovery:packet_lost\",\"data\":{"
+                      "\"header\":{\"packet_number\":",
+                      record.packet_number, "}}");
+      break;
+    case QuicQlogEmitter::EventType::kCongestionWindowChange:
+      absl::StrAppend(json,
+                      "\"name\":\"recovery:metrics_updated\",\"data\":{"
+                      "\"congestion_window\":",
+                      record.value, "}");
+      break;
+    default:
+      absl::StrAppend(json, "\"name\":\"unknown\",\"data\":{\"type\":",
+                      record.event_type, "}");
+      break;
+  }
+  absl::StrAppend(json, "}");
+}
+
+}  // namespace
+
+// static
+std::unique_ptr<QuicQlogFile> QuicQlogFile::Create(
+    const std::string& file_name, size_t capacity) {
+  if (capacity < kLengthPrefixSize) {
+    return nullptr;
+  }
+  int fd = open(file_name.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    QUIC_LOG(WARNING) << "Failed to create qlog file " << file_name << ": "
+                      << strerror(errno);
+    return nullptr;
+  }
+  // Preallocate; ftruncate zero-fills, which both reserves the address range
+  // and gives readers the zero length prefix terminator for free.
+  if (ftruncate(fd, capacity) != 0) {
+    QUIC_LOG(WARNING) << "Failed to size qlog file " << file_name << ": "
+                      << strerror(errno);
+    close(fd);
+    return nullptr;
+  }
+  void* base =
+      mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  // The mapping keeps the file alive; the descriptor is no longer needed.
+  close(fd);
+  if (base == MAP_FAILED) {
+    QUIC_LOG(WARNING) << "Failed to map qlog file " << file_name << ": "
+                      << strerror(errno);
+    return nullptr;
+  }
+  return std::unique_ptr<QuicQlogFile>(
+      new QuicQlogFile(static_cast<char*>(base), capacity));
+}
+
+QuicQlogFile::QuicQlogFile(char* base, size_t capacity)
+    : base_(base), capacity_(capacity), offset_(0), records_dropped_(0) {}
+
+QuicQlogFile::~QuicQlogFile() {
+  munmap(base_, capacity_);
+}
+
+void QuicQlogFile::Append(absl::string_view record) {
+  const size_t total = kLengthPrefixSize + record.size();
+  // Claim space with a single atomic add. On overflow the claimed region is
+  // simply left unused; offset_ keeps growing but never wraps in practice.
+  const size_t start = offset_.fetch_add(total, std::memory_order_relaxed);
+  if (start + total > capacity_) {
+    records_dropped_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  char* out = base_ + start;
+  const uint32_t length = static_cast<uint32_t>(record.size());
+  out[0] = static_cast<char>(length >> 24);
+  out[1] = static_cast<char>(length >> 16);
+  out[2] = static_cast<char>(length >> 8);
+  out[3] = static_cast<char>(length);
+  memcpy(out + kLengthPrefixSize, record.data(), record.size());
+}
+
+QuicQlogEmitter::QuicQlogEmitter(const QuicConnection* connection,
+                                 QuicQlogFile* file)
+    : connection_(connection),
+      file_(file),
+      connection_id_hash_(connection->connection_id().Hash()) {}
+
+void QuicQlogEmitter::OnPacketSent(
+    QuicPacketNumber packet_number,
+    QuicPacketLength packet_length,
+    bool /*has_crypto_handshake*/,
+    TransmissionType /*transmission_type*/,
+    EncryptionLevel /*encryption_level*/,
+    const QuicFrames& /*retransmittable_frames*/,
+    const QuicFrames& /*nonretransmittable_frames*/,
+    QuicTime sent_time) {
+  RecordEvent(EventType::kPacketSent, sent_time, packet_number.ToUint64(),
+              packet_length);
+}
+
+void QuicQlogEmitter::OnIncomingAck(
+    QuicPacketNumber /*ack_packet_number*/,
+    EncryptionLevel /*ack_decrypted_level*/,
+    const QuicAckFrame& /*ack_frame*/,
+    QuicTime ack_receive_time,
+    QuicPacketNumber largest_observed,
+    bool /*rtt_updated*/,
+    QuicPacketNumber /*least_unacked_sent_packet*/) {
+  RecordEvent(EventType::kAckReceived, ack_receive_time,
+              largest_observed.IsInitialized() ? largest_observed.ToUint64()
+                                               : 0,
+              connection_->sent_packet_manager()
+                  .GetRttStats()
+                  ->smoothed_rtt()
+                  .ToMicroseconds());
+  MaybeRecordCongestionWindowChange(ack_receive_time);
+}
+
+void QuicQlogEmitter::OnPacketLoss(QuicPacketNumber lost_packet_number,
+                                   EncryptionLevel /*encryption_level*/,
+                                   TransmissionType /*transmission_type*/,
+                                   QuicTime detection_time) {
+  RecordEvent(EventType::kPacketLost, detection_time,
+              lost_packet_number.ToUint64(), 0);
+  MaybeRecordCongestionWindowChange(detection_time);
+}
+
+void QuicQlogEmitter::RecordEvent(EventType type,
+                                  QuicTime time,
+                                  uint64_t packet_number,
+                                  uint64_t value) {
+  // Map header plus five key/value pairs, each at most 1 + 9 bytes.
+  char buffer[1 + 5 * 10];
+  size_t length = 0;
+  buffer[length++] = static_cast<char>(0xa0 | 5);  // map of 5 pairs.
+  length += EncodeCborUint(kKeyConnectionId, buffer + length);
+  length += EncodeCborUint(connection_id_hash_, buffer + length);
+  length += EncodeCborUint(kKeyTimeUs, buffer + length);
+  length += EncodeCborUint((time - QuicTime::Zero()).ToMicroseconds(),
+                           buffer + length);
+  length += EncodeCborUint(kKeyEventType, buffer + length);
+  length += EncodeCborUint(static_cast<uint64_t>(type), buffer + length);
+  length += EncodeCborUint(kKeyPacketNumber, buffer + length);
+  length += EncodeCborUint(packet_number, buffer + length);
+  length += EncodeCborUint(kKeyValue, buffer + length);
+  length += EncodeCborUint(value, buffer + length);
+  file_->Append(absl::string_view(buffer, length));
+}
+
+void QuicQlogEmitter::MaybeRecordCongestionWindowChange(QuicTime time) {
+  const QuicByteCount cwnd =
+      connection_->sent_packet_manager().GetCongestionWindowInBytes();
+  if (cwnd == last_recorded_cwnd_) {
+    return;
+  }
+  last_recorded_cwnd_ = cwnd;
+  RecordEvent(EventType::kCongestionWindowChange, time, 0, cwnd);
+}
+
+std::string QuicQlogToJson(absl::string_view data) {
+  // First pass finds the earliest timestamp, so event times can be relative.
+  std::vector<DecodedRecord> records;
+  uint64_t first_time_us = std::numeric_limits<uint64_t>::max();
+  size_t offset = 0;
+  while (offset + QuicQlogFile::kLengthPrefixSize <= data.size()) {
+    const uint32_t length = (static_cast<uint8_t>(data[offset]) << 24) |
+                            (static_cast<uint8_t>(data[offset + 1]) << 16) |
+                            (static_cast<uint8_t>(data[offset + 2]) << 8) |
+                            static_cast<uint8_t>(data[offset + 3]);
+    if (length == 0) {
+      // Zero-filled tail: end of the log.
+      break;
+    }
+    offset += QuicQlogFile::kLengthPrefixSize;
+    if (offset + length > data.size()) {
+      break;
+    }
+    DecodedRecord record;
+    if (!DecodeRecord(data.substr(offset, length), &record)) {
+      break;
+    }
+    first_time_us = std::min(first_time_us, record.time_us);
+    records.push_back(record);
+    offset += length;
+  }
+
+  std::string json =
+      "{\"qlog_version\":\"0.3\",\"qlog_format\":\"JSON\","
+      "\"traces\":[{\"events\":[";
+  for (size_t i = 0; i < records.size(); ++i) {
+    if (i > 0) {
+      json.push_back(',');
+    }
+    AppendJsonEvent(records[i], first_time_us, &json);
+  }
+  absl::StrAppend(&json, "]}]}");
+  return json;
+}
+
+}  // namespace quic
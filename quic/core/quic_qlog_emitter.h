@@ -0,0 +1,151 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_QUIC_QLOG_EMITTER_H_
+#define QUICHE_QUIC_CORE_QUIC_QLOG_EMITTER_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "quic/core/quic_connection.h"
+#include "quic/core/quic_time.h"
+#include "quic/core/quic_types.h"
+
+namespace quic {
+
+// A preallocated, memory-mapped, append-only log of length-prefixed binary
+// qlog records, shared by all sampled connections of a server. Appending is
+// wait-free for multiple producers: a writer claims space with one atomic
+// fetch_add and copies its record into the claimed region, so the hot path
+// never locks, allocates or issues a syscall; the kernel writes dirty pages
+// back on its own schedule. When the file fills up, further records are
+// dropped and counted. The file is created zero-filled, so an offline reader
+// can treat a zero length prefix as the end of the log. Reading the file
+// while producers are still appending is not supported.
+class QUIC_EXPORT_PRIVATE QuicQlogFile {
+ public:
+  // Each record is preceded by its payload length as 4 bytes, big endian.
+  static constexpr size_t kLengthPrefixSize = 4;
+
+  // Creates a zero-filled file of |capacity| bytes at |file_name| and maps
+  // it writable. An existing file is truncated. Returns nullptr if the file
+  // cannot be created or mapped.
+  static std::unique_ptr<QuicQlogFile> Create(const std::string& file_name,
+                                              size_t capacity);
+
+  QuicQlogFile(const QuicQlogFile&) = delete;
+  QuicQlogFile& operator=(const QuicQlogFile&) = delete;
+  ~QuicQlogFile();
+
+  // Appends one length-prefixed record. Wait-free and safe to call from
+  // multiple threads; the record is dropped (and counted) if it does not
+  // fit in the remaining capacity.
+  void Append(absl::string_view record);
+
+  // Number of bytes claimed so far, including dropped overshoot.
+  size_t bytes_used() const {
+    return std::min(offset_.load(std::memory_order_relaxed), capacity_);
+  }
+
+  uint64_t records_dropped() const {
+    return records_dropped_.load(std::memory_order_relaxed);
+  }
+
+  // The mapped log contents, for conversion or inspection after all
+  // producers have stopped appending.
+  absl::string_view data() const {
+    return absl::string_view(base_, capacity_);
+  }
+
+ private:
+  QuicQlogFile(char* base, size_t capacity);
+
+  char* const base_;
+  const size_t capacity_;
+  std::atomic<size_t> offset_;
+  std::atomic<uint64_t> records_dropped_;
+};
+
+// Emits compact binary qlog records for one connection into a shared
+// QuicQlogFile. Unlike QuicTraceVisitor, which builds a quic_trace protobuf
+// and is too expensive to enable outside the lab, every event here is a
+// fixed-shape CBOR map of integer keys and values, encoded into a small
+// stack buffer and appended with a single atomic add — cheap enough for
+// sampled production connections. The binary log is converted to a JSON
+// qlog document offline with QuicQlogToJson().
+class QUIC_EXPORT_PRIVATE QuicQlogEmitter : public QuicConnectionDebugVisitor {
+ public:
+  enum class EventType : uint8_t {
+    kPacketSent = 1,
+    kAckReceived = 2,
+    kPacketLost = 3,
+    kCongestionWindowChange = 4,
+  };
+
+  // CBOR map keys used in every record.
+  enum RecordKey : uint8_t {
+    kKeyConnectionId = 0,
+    kKeyTimeUs = 1,
+    kKeyEventType = 2,
+    kKeyPacketNumber = 3,
+    kKeyValue = 4,
+  };
+
+  // |file| must outlive this emitter.
+  QuicQlogEmitter(const QuicConnection* connection, QuicQlogFile* file);
+  QuicQlogEmitter(const QuicQlogEmitter&) = delete;
+  QuicQlogEmitter& operator=(const QuicQlogEmitter&) = delete;
+
+  // QuicConnectionDebugVisitor implementation.
+  void OnPacketSent(QuicPacketNumber packet_number,
+                    QuicPacketLength packet_length,
+                    bool has_crypto_handshake,
+                    TransmissionType transmission_type,
+                    EncryptionLevel encryption_level,
+                    const QuicFrames& retransmittable_frames,
+                    const QuicFrames& nonretransmittable_frames,
+                    QuicTime sent_time) override;
+  void OnIncomingAck(QuicPacketNumber ack_packet_number,
+                     EncryptionLevel ack_decrypted_level,
+                     const QuicAckFrame& ack_frame,
+                     QuicTime ack_receive_time,
+                     QuicPacketNumber largest_observed,
+                     bool rtt_updated,
+                     QuicPacketNumber least_unacked_sent_packet) override;
+  void OnPacketLoss(QuicPacketNumber lost_packet_number,
+                    EncryptionLevel encryption_level,
+                    TransmissionType transmission_type,
+                    QuicTime detection_time) override;
+
+ private:
+  // Encodes one record as a CBOR map on the stack and appends it.
+  void RecordEvent(EventType type,
+                   QuicTime time,
+                   uint64_t packet_number,
+                   uint64_t value);
+  // Records a kCongestionWindowChange event if the congestion window differs
+  // from the last recorded value.
+  void MaybeRecordCongestionWindowChange(QuicTime time);
+
+  const QuicConnection* connection_;
+  QuicQlogFile* file_;
+  // Stable identifier for this connection's records in the shared file.
+  const uint64_t connection_id_hash_;
+  QuicByteCount last_recorded_cwnd_ = 0;
+};
+
+// Converts a binary log produced by QuicQlogEmitter into a JSON qlog
+// document, with event times in milliseconds relative to the earliest
+// record. Intended for offline use; stops at the first zero length prefix
+// or malformed record.
+QUIC_EXPORT_PRIVATE std::string QuicQlogToJson(absl::string_view data);
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_QUIC_QLOG_EMITTER_H_
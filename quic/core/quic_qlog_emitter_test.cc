@@ -0,0 +1,84 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/quic_qlog_emitter.h"
+
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "quic/core/quic_time.h"
+#include "quic/platform/api/quic_test.h"
+#include "quic/test_tools/quic_test_utils.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+class QuicQlogEmitterTest : public QuicTest {
+ protected:
+  QuicQlogEmitterTest()
+      : file_path_(absl::StrCat("/tmp/quic_qlog_emitter_test.", getpid(),
+                                ".qlog")),
+        connection_(&helper_, &alarm_factory_, Perspective::IS_SERVER) {}
+
+  ~QuicQlogEmitterTest() override { unlink(file_path_.c_str()); }
+
+  QuicTime Now() { return helper_.GetClock()->Now(); }
+
+  const std::string file_path_;
+  MockQuicConnectionHelper helper_;
+  MockAlarmFactory alarm_factory_;
+  MockQuicConnection connection_;
+};
+
+TEST_F(QuicQlogEmitterTest, RecordsAndConvertsEvents) {
+  std::unique_ptr<QuicQlogFile> file =
+      QuicQlogFile::Create(file_path_, 64 * 1024);
+  ASSERT_NE(nullptr, file);
+  QuicQlogEmitter emitter(&connection_, file.get());
+
+  emitter.OnPacketSent(QuicPacketNumber(1), 1200,
+                       /*has_crypto_handshake=*/false, NOT_RETRANSMISSION,
+                       ENCRYPTION_FORWARD_SECURE, {}, {}, Now());
+  helper_.AdvanceTime(QuicTime::Delta::FromMilliseconds(30));
+  QuicAckFrame ack_frame;
+  emitter.OnIncomingAck(QuicPacketNumber(2), ENCRYPTION_FORWARD_SECURE,
+                        ack_frame, Now(), QuicPacketNumber(1),
+                        /*rtt_updated=*/true, QuicPacketNumber(1));
+  emitter.OnPacketLoss(QuicPacketNumber(2), ENCRYPTION_FORWARD_SECURE,
+                       LOSS_RETRANSMISSION, Now());
+
+  EXPECT_EQ(0u, file->records_dropped());
+  EXPECT_GT(file->bytes_used(), 0u);
+
+  const std::string json = QuicQlogToJson(file->data());
+  EXPECT_NE(json.find("\"qlog_version\":\"0.3\""), std::string::npos);
+  EXPECT_NE(json.find("transport:packet_sent"), std::string::npos);
+  EXPECT_NE(json.find("\"packet_number\":1"), std::string::npos);
+  EXPECT_NE(json.find("\"length\":1200"), std::string::npos);
+  EXPECT_NE(json.find("recovery:metrics_updated"), std::string::npos);
+  EXPECT_NE(json.find("recovery:packet_lost"), std::string::npos);
+  EXPECT_NE(json.find("\"packet_number\":2"), std::string::npos);
+  // The first event is at relative time zero.
+  EXPECT_NE(json.find("\"time\":0.000"), std::string::npos);
+}
+
+TEST_F(QuicQlogEmitterTest, DropsRecordsWhenFull) {
+  std::unique_ptr<QuicQlogFile> file = QuicQlogFile::Create(file_path_, 16);
+  ASSERT_NE(nullptr, file);
+
+  const std::string record(20, 'x');
+  file->Append(record);
+  EXPECT_EQ(1u, file->records_dropped());
+  // A dropped record leaves the log unchanged; conversion sees no events.
+  const std::string json = QuicQlogToJson(file->data());
+  EXPECT_NE(json.find("\"events\":[]"), std::string::npos);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
@@ -5,6 +5,7 @@
 #include "quic/core/quic_received_packet_manager.h"
 
 #include <algorithm>
+#include <cstring>
 #include <limits>
 #include <utility>
 
@@ -28,8 +29,73 @@ const size_t kMaxPacketsAfterNewMissing = 4;
 
 // One eighth RTT delay when doing ack decimation.
 const float kShortAckDecimationDelay = 0.125;
+
+// Estimated wire cost of one ACK-only packet (short header, ack frame, AEAD
+// tag plus UDP/IP overhead), used by dynamic ack frequency to translate an
+// ACK-bandwidth budget into a packet tolerance.
+const QuicByteCount kEstimatedAckWireSize = 80;
+
+// How long each receive-rate observation window lasts before the dynamic ack
+// frequency is re-derived.
+const QuicTime::Delta kDynamicAckFrequencyWindow =
+    QuicTime::Delta::FromMilliseconds(100);
+
+// Upper bound on the dynamically chosen packet tolerance, so feedback never
+// becomes sparse enough to starve the peer's loss recovery and congestion
+// controller.
+const size_t kMaxDynamicAckPacketTolerance = 100;
 }  // namespace
 
+void QuicReceivedPacketManager::ReceivedPacketBitmap::Add(
+    QuicPacketNumber packet_number) {
+  if (!largest_.IsInitialized()) {
+    largest_ = packet_number;
+    SetBit(packet_number.ToUint64());
+    return;
+  }
+  if (packet_number > largest_) {
+    // Slide the window forward, clearing bits for the numbers it now covers.
+    if (packet_number - largest_ >= kWindowSize) {
+      memset(bits_, 0, sizeof(bits_));
+    } else {
+      for (QuicPacketNumber n = largest_ + 1; n < packet_number; ++n) {
+        ClearBit(n.ToUint64());
+      }
+    }
+    largest_ = packet_number;
+    SetBit(packet_number.ToUint64());
+    return;
+  }
+  if (largest_ - packet_number < kWindowSize) {
+    SetBit(packet_number.ToUint64());
+  }
+}
+
+bool QuicReceivedPacketManager::ReceivedPacketBitmap::InWindow(
+    QuicPacketNumber packet_number) const {
+  return largest_.IsInitialized() && packet_number <= largest_ &&
+         largest_ - packet_number < kWindowSize;
+}
+
+bool QuicReceivedPacketManager::ReceivedPacketBitmap::Contains(
+    QuicPacketNumber packet_number) const {
+  QUICHE_DCHECK(InWindow(packet_number));
+  const uint64_t index = packet_number.ToUint64() % kWindowSize;
+  return (bits_[index / 64] >> (index % 64)) & 1;
+}
+
+void QuicReceivedPacketManager::ReceivedPacketBitmap::SetBit(
+    uint64_t packet_number) {
+  const uint64_t index = packet_number % kWindowSize;
+  bits_[index / 64] |= uint64_t{1} << (index % 64);
+}
+
+void QuicReceivedPacketManager::ReceivedPacketBitmap::ClearBit(
+    uint64_t packet_number) {
+  const uint64_t index = packet_number % kWindowSize;
+  bits_[index / 64] &= ~(uint64_t{1} << (index % 64));
+}
+
 QuicReceivedPacketManager::QuicReceivedPacketManager()
     : QuicReceivedPacketManager(nullptr) {}
 
@@ -51,7 +117,14 @@ QuicReceivedPacketManager::QuicReceivedPacketManager(QuicConnectionStats* stats)
       ack_timeout_(QuicTime::Zero()),
       time_of_previous_received_packet_(QuicTime::Zero()),
       was_last_packet_missing_(false),
-      last_ack_frequency_frame_sequence_number_(-1) {}
+      last_ack_frequency_frame_sequence_number_(-1),
+      dynamic_ack_frequency_enabled_(false),
+      ack_bandwidth_budget_(0),
+      dynamic_ack_window_start_(QuicTime::Zero()),
+      dynamic_ack_window_bytes_received_(0),
+      dynamic_ack_window_packets_received_(0),
+      dynamic_ack_window_packets_reordered_(0),
+      dynamic_max_ack_delay_(QuicTime::Delta::Zero()) {}
 
 QuicReceivedPacketManager::~QuicReceivedPacketManager() {}
 
@@ -98,6 +171,7 @@ void QuicReceivedPacketManager::RecordPacketReceived(
     time_largest_observed_ = receipt_time;
   }
   ack_frame_.packets.Add(packet_number);
+  recent_packets_.Add(packet_number);
 
   if (save_timestamps_) {
     // The timestamp format only handles packets in time order.
@@ -129,6 +203,15 @@ bool QuicReceivedPacketManager::IsMissing(QuicPacketNumber packet_number) {
 
 bool QuicReceivedPacketManager::IsAwaitingPacket(
     QuicPacketNumber packet_number) const {
+  if (peer_least_packet_awaiting_ack_.IsInitialized() &&
+      packet_number < peer_least_packet_awaiting_ack_) {
+    return false;
+  }
+  if (recent_packets_.InWindow(packet_number)) {
+    // O(1) duplicate check for packets near the largest observed, avoiding
+    // the interval set lookup which degrades under reordering.
+    return !recent_packets_.Contains(packet_number);
+  }
   return quic::IsAwaitingPacket(ack_frame_, packet_number,
                                 peer_least_packet_awaiting_ack_);
 }
@@ -201,6 +284,13 @@ QuicTime::Delta QuicReceivedPacketManager::GetMaxAckDelay(
     return local_max_ack_delay_;
   }
 
+  if (dynamic_ack_frequency_enabled_ && !dynamic_max_ack_delay_.IsZero()) {
+    // The delay was derived from the receive rate as the time it takes
+    // ack_frequency_ packets to arrive, and is already capped at
+    // local_max_ack_delay_.
+    return std::max(dynamic_max_ack_delay_, kAlarmGranularity);
+  }
+
   // Wait for the minimum of the ack decimation delay or the delayed ack time
   // before sending an ack.
   QuicTime::Delta ack_delay = std::min(
@@ -208,8 +298,71 @@ QuicTime::Delta QuicReceivedPacketManager::GetMaxAckDelay(
   return std::max(ack_delay, kAlarmGranularity);
 }
 
+void QuicReceivedPacketManager::EnableDynamicAckFrequency(
+    float ack_bandwidth_budget) {
+  QUICHE_DCHECK_GT(ack_bandwidth_budget, 0);
+  QUICHE_DCHECK_LE(ack_bandwidth_budget, 1);
+  if (stats_ == nullptr) {
+    // The receive-rate observation relies on the connection stats counters.
+    return;
+  }
+  dynamic_ack_frequency_enabled_ = true;
+  ack_bandwidth_budget_ = ack_bandwidth_budget;
+}
+
+void QuicReceivedPacketManager::UpdateDynamicAckFrequency(QuicTime now) {
+  if (!dynamic_ack_window_start_.IsInitialized()) {
+    // Start the first observation window.
+    dynamic_ack_window_start_ = now;
+    dynamic_ack_window_bytes_received_ = stats_->bytes_received;
+    dynamic_ack_window_packets_received_ = stats_->packets_received;
+    dynamic_ack_window_packets_reordered_ = stats_->packets_reordered;
+    return;
+  }
+  const QuicTime::Delta elapsed = now - dynamic_ack_window_start_;
+  if (elapsed < kDynamicAckFrequencyWindow) {
+    return;
+  }
+  const QuicByteCount bytes_received =
+      stats_->bytes_received - dynamic_ack_window_bytes_received_;
+  const QuicPacketCount packets_received =
+      stats_->packets_received - dynamic_ack_window_packets_received_;
+  const bool reordered =
+      stats_->packets_reordered != dynamic_ack_window_packets_reordered_;
+  dynamic_ack_window_start_ = now;
+  dynamic_ack_window_bytes_received_ = stats_->bytes_received;
+  dynamic_ack_window_packets_received_ = stats_->packets_received;
+  dynamic_ack_window_packets_reordered_ = stats_->packets_reordered;
+  if (packets_received == 0) {
+    return;
+  }
+
+  // Acking every n-th packet spends kEstimatedAckWireSize bytes per n
+  // received packets. Choose the smallest tolerance that keeps that at or
+  // under the budget for the packet size observed in this window.
+  const QuicByteCount mean_packet_size =
+      std::max<QuicByteCount>(bytes_received / packets_received, 1);
+  size_t tolerance = static_cast<size_t>(
+      kEstimatedAckWireSize / (ack_bandwidth_budget_ * mean_packet_size) + 1);
+  tolerance =
+      std::max<size_t>(tolerance, kDefaultRetransmittablePacketsBeforeAck);
+  // Under reordering, fall back to the static decimation limit so the peer
+  // still gets nacks quickly enough for fast retransmit.
+  tolerance = std::min<size_t>(tolerance,
+                               reordered ? kMaxRetransmittablePacketsBeforeAck
+                                         : kMaxDynamicAckPacketTolerance);
+  ack_frequency_ = tolerance;
+  // Delay at most the time it takes |tolerance| packets to arrive at the
+  // observed rate, so a rate drop does not leave the last packets of a burst
+  // unacked for the full delayed ack time.
+  dynamic_max_ack_delay_ =
+      std::min(local_max_ack_delay_,
+               elapsed * (static_cast<double>(tolerance) / packets_received));
+}
+
 void QuicReceivedPacketManager::MaybeUpdateAckFrequency(
-    QuicPacketNumber last_received_packet_number) {
+    QuicPacketNumber last_received_packet_number,
+    QuicTime now) {
   if (AckFrequencyFrameReceived()) {
     // Skip Ack Decimation below after receiving an AckFrequencyFrame from the
     // other end point.
@@ -219,6 +372,10 @@ void QuicReceivedPacketManager::MaybeUpdateAckFrequency(
       PeerFirstSendingPacketNumber() + min_received_before_ack_decimation_) {
     return;
   }
+  if (dynamic_ack_frequency_enabled_) {
+    UpdateDynamicAckFrequency(now);
+    return;
+  }
   ack_frequency_ = unlimited_ack_decimation_
                        ? std::numeric_limits<size_t>::max()
                        : kMaxRetransmittablePacketsBeforeAck;
@@ -249,7 +406,7 @@ void QuicReceivedPacketManager::MaybeUpdateAckTimeout(
 
   ++num_retransmittable_packets_received_since_last_ack_sent_;
 
-  MaybeUpdateAckFrequency(last_received_packet_number);
+  MaybeUpdateAckFrequency(last_received_packet_number, now);
   if (num_retransmittable_packets_received_since_last_ack_sent_ >=
       ack_frequency_) {
     ack_timeout_ = now;
@@ -6,6 +6,8 @@
 #define QUICHE_QUIC_CORE_QUIC_RECEIVED_PACKET_MANAGER_H_
 
 #include <cstddef>
+#include <cstdint>
+
 #include "quic/core/frames/quic_ack_frequency_frame.h"
 #include "quic/core/quic_config.h"
 #include "quic/core/quic_framer.h"
@@ -119,6 +121,17 @@ class QUIC_EXPORT_PRIVATE QuicReceivedPacketManager {
     ack_frequency_ = new_value;
   }
 
+  // Enables dynamic ack frequency: instead of the fixed ack decimation
+  // heuristics, the packet tolerance and max ack delay are continuously
+  // re-derived from the locally observed receive rate so that the bytes spent
+  // on ACKs stay at roughly |ack_bandwidth_budget| (a fraction in (0, 1]) of
+  // the bytes received. Observed reordering caps the tolerance back at the
+  // static decimation limit so fast retransmit at the peer is not delayed.
+  // Has no effect once an AckFrequencyFrame has been received, which takes
+  // precedence just as it does over static ack decimation. Requires
+  // connection stats (for the receive counters); no-op without them.
+  void EnableDynamicAckFrequency(float ack_bandwidth_budget);
+
   void set_local_max_ack_delay(QuicTime::Delta local_max_ack_delay) {
     local_max_ack_delay_ = local_max_ack_delay;
   }
@@ -132,11 +145,50 @@ class QUIC_EXPORT_PRIVATE QuicReceivedPacketManager {
   friend class test::QuicReceivedPacketManagerPeer;
   friend class test::UberReceivedPacketManagerPeer;
 
+  // Fixed-size bitmap of recently received packet numbers.  Answers duplicate
+  // checks in O(1) for packets at most kWindowSize behind the largest observed
+  // packet; older packets spill to the ack frame's interval set, whose ordered
+  // lookups degrade under heavy reordering.  Bits are indexed by packet number
+  // modulo kWindowSize; bits the window slides past are cleared as the largest
+  // observed packet advances.
+  class QUIC_EXPORT_PRIVATE ReceivedPacketBitmap {
+   public:
+    // Records |packet_number| as received.  No-op if it is more than
+    // kWindowSize behind the largest recorded packet.
+    void Add(QuicPacketNumber packet_number);
+
+    // Returns true if |packet_number| is covered by the window, i.e. the
+    // bitmap can answer Contains() for it.
+    bool InWindow(QuicPacketNumber packet_number) const;
+
+    // Returns true if |packet_number| has been received.  Must only be called
+    // when InWindow() returns true.
+    bool Contains(QuicPacketNumber packet_number) const;
+
+   private:
+    // Window size in packets.  Must be a multiple of 64.
+    static const uint64_t kWindowSize = 4096;
+
+    void SetBit(uint64_t packet_number);
+    void ClearBit(uint64_t packet_number);
+
+    // Largest packet number recorded.  The window covers
+    // (largest_ - kWindowSize, largest_].  Uninitialized until the first Add.
+    QuicPacketNumber largest_;
+    uint64_t bits_[kWindowSize / 64] = {};
+  };
+
   // Sets ack_timeout_ to |time| if ack_timeout_ is not initialized or > time.
   void MaybeUpdateAckTimeoutTo(QuicTime time);
 
   // Maybe update ack_frequency_ when condition meets.
-  void MaybeUpdateAckFrequency(QuicPacketNumber last_received_packet_number);
+  void MaybeUpdateAckFrequency(QuicPacketNumber last_received_packet_number,
+                               QuicTime now);
+
+  // Re-derives ack_frequency_ and dynamic_max_ack_delay_ from the bytes and
+  // packets received since the last update window. Called from
+  // MaybeUpdateAckFrequency when dynamic ack frequency is enabled.
+  void UpdateDynamicAckFrequency(QuicTime now);
 
   QuicTime::Delta GetMaxAckDelay(QuicPacketNumber last_received_packet_number,
                                  const RttStats& rtt_stats) const;
@@ -152,6 +204,10 @@ class QUIC_EXPORT_PRIVATE QuicReceivedPacketManager {
   // Received packet information used to produce acks.
   QuicAckFrame ack_frame_;
 
+  // Recently received packet numbers, consulted by IsAwaitingPacket() before
+  // the interval set in |ack_frame_|.
+  ReceivedPacketBitmap recent_packets_;
+
   // True if |ack_frame_| has been updated since UpdateReceivedPacketInfo was
   // last called.
   bool ack_frame_updated_;
@@ -206,6 +262,22 @@ class QUIC_EXPORT_PRIVATE QuicReceivedPacketManager {
   // The sequence number of the last received AckFrequencyFrame. Negative if
   // none received.
   int64_t last_ack_frequency_frame_sequence_number_;
+
+  // When true, ack_frequency_ and the max ack delay are continuously derived
+  // from the observed receive rate. See EnableDynamicAckFrequency().
+  bool dynamic_ack_frequency_enabled_;
+  // Target fraction of received bytes to spend on ACKs.
+  float ack_bandwidth_budget_;
+  // Start of the current receive-rate observation window, and the stats
+  // counter values at that point. Unset until the first window starts.
+  QuicTime dynamic_ack_window_start_;
+  QuicByteCount dynamic_ack_window_bytes_received_;
+  QuicPacketCount dynamic_ack_window_packets_received_;
+  QuicPacketCount dynamic_ack_window_packets_reordered_;
+  // Max ack delay derived from the receive rate: the time it takes
+  // ack_frequency_ packets to arrive. Zero until the first window completes;
+  // GetMaxAckDelay falls back to the decimation delay while zero.
+  QuicTime::Delta dynamic_max_ack_delay_;
 };
 
 }  // namespace quic
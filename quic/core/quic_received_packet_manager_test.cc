@@ -32,6 +32,10 @@ class QuicReceivedPacketManagerPeer {
                                     float ack_decimation_delay) {
     manager->ack_decimation_delay_ = ack_decimation_delay;
   }
+
+  static size_t GetAckFrequency(QuicReceivedPacketManager* manager) {
+    return manager->ack_frequency_;
+  }
 };
 
 namespace {
@@ -100,6 +104,32 @@ TEST_F(QuicReceivedPacketManagerTest, DontWaitForPacketsBefore) {
   EXPECT_TRUE(received_manager_.IsAwaitingPacket(QuicPacketNumber(6u)));
 }
 
+TEST_F(QuicReceivedPacketManagerTest, DuplicateDetectionAcrossBitmapWindow) {
+  // Receive every other packet so the interval set stays fragmented, across
+  // more than the 4096-packet bitmap window.
+  const uint64_t kLargest = 10000;
+  for (uint64_t i = 2; i <= kLargest; i += 2) {
+    RecordPacketReceipt(i);
+  }
+  // Duplicates and gaps near the largest observed are answered by the bitmap.
+  EXPECT_FALSE(received_manager_.IsAwaitingPacket(QuicPacketNumber(kLargest)));
+  EXPECT_FALSE(
+      received_manager_.IsAwaitingPacket(QuicPacketNumber(kLargest - 2)));
+  EXPECT_TRUE(
+      received_manager_.IsAwaitingPacket(QuicPacketNumber(kLargest - 1)));
+  // Packets older than the window spill to the interval set and still give
+  // the same answers.
+  EXPECT_FALSE(received_manager_.IsAwaitingPacket(QuicPacketNumber(2u)));
+  EXPECT_TRUE(received_manager_.IsAwaitingPacket(QuicPacketNumber(3u)));
+  // A filled gap inside the window is no longer awaited.
+  RecordPacketReceipt(kLargest - 1);
+  EXPECT_FALSE(
+      received_manager_.IsAwaitingPacket(QuicPacketNumber(kLargest - 1)));
+  // Packets beyond the largest observed are always awaited.
+  EXPECT_TRUE(
+      received_manager_.IsAwaitingPacket(QuicPacketNumber(kLargest + 1)));
+}
+
 TEST_F(QuicReceivedPacketManagerTest, GetUpdatedAckFrame) {
   QuicPacketHeader header;
   header.packet_number = QuicPacketNumber(2u);
@@ -622,6 +652,45 @@ TEST_F(QuicReceivedPacketManagerTest,
   }
 }
 
+TEST_F(QuicReceivedPacketManagerTest, DynamicAckFrequencyFromReceiveRate) {
+  const QuicByteCount kPacketSize = 1200;
+  received_manager_.EnableDynamicAckFrequency(0.005f);
+
+  auto receive_packet = [&](uint64_t packet_number) {
+    RecordPacketReceipt(packet_number, clock_.ApproximateNow());
+    stats_.bytes_received += kPacketSize;
+    ++stats_.packets_received;
+    MaybeUpdateAckTimeout(kInstigateAck, packet_number);
+    if (HasPendingAck()) {
+      received_manager_.ResetAckStates();
+    }
+  };
+
+  // Get past the decimation threshold; packet 101 starts the first
+  // receive-rate observation window.
+  for (uint64_t i = 1; i <= 101; ++i) {
+    receive_packet(i);
+  }
+  EXPECT_EQ(kDefaultRetransmittablePacketsBeforeAck,
+            QuicReceivedPacketManagerPeer::GetAckFrequency(&received_manager_));
+
+  // Once the window elapses, the tolerance is re-derived from the observed
+  // packet size and the budget: 80 bytes per ACK at 0.5% of 1200-byte packets
+  // works out to acking every 14th packet.
+  clock_.AdvanceTime(QuicTime::Delta::FromMilliseconds(100));
+  receive_packet(102);
+  EXPECT_EQ(14u, QuicReceivedPacketManagerPeer::GetAckFrequency(
+                     &received_manager_));
+
+  // Reordering observed during a window caps the tolerance back at the
+  // static decimation limit.
+  clock_.AdvanceTime(QuicTime::Delta::FromMilliseconds(100));
+  ++stats_.packets_reordered;
+  receive_packet(103);
+  EXPECT_EQ(kMaxRetransmittablePacketsBeforeAck,
+            QuicReceivedPacketManagerPeer::GetAckFrequency(&received_manager_));
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace quic
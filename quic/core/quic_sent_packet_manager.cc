@@ -343,6 +343,16 @@ void QuicSentPacketManager::SetFromConfig(const QuicConfig& config) {
   if (config.HasClientRequestedIndependentOption(kRUNT, perspective)) {
     uber_loss_algorithm_.DisablePacketThresholdForRuntPackets();
   }
+  // Loss detection profiles bundle the knobs above per network class.
+  if (config.HasClientRequestedIndependentOption(kLDPD, perspective)) {
+    ApplyLossDetectionProfile(LossDetectionProfile::Datacenter());
+  }
+  if (config.HasClientRequestedIndependentOption(kLDPC, perspective)) {
+    ApplyLossDetectionProfile(LossDetectionProfile::Cable());
+  }
+  if (config.HasClientRequestedIndependentOption(kLDPS, perspective)) {
+    ApplyLossDetectionProfile(LossDetectionProfile::Satellite());
+  }
   if (config.HasClientSentConnectionOption(kCONH, perspective)) {
     conservative_handshake_retransmits_ = true;
   }
@@ -416,6 +426,12 @@ void QuicSentPacketManager::SetLossDetectionTuner(
   uber_loss_algorithm_.SetLossDetectionTuner(std::move(tuner));
 }
 
+void QuicSentPacketManager::ApplyLossDetectionProfile(
+    const LossDetectionProfile& profile) {
+  uber_loss_algorithm_.ApplyProfile(profile);
+  stats_->loss_detection_profile_id = profile.id;
+}
+
 void QuicSentPacketManager::OnConfigNegotiated() {
   loss_algorithm_->OnConfigNegotiated();
 }
@@ -836,6 +852,9 @@ bool QuicSentPacketManager::OnPacketSent(
     in_flight = false;
     measure_rtt = false;
   }
+  if (in_flight) {
+    RecordBytesInFlightSample(unacked_packets_.bytes_in_flight());
+  }
   if (using_pacing_) {
     pacing_sender_.OnPacketSent(sent_time, unacked_packets_.bytes_in_flight(),
                                 packet_number, packet.encrypted_length,
@@ -870,6 +889,17 @@ bool QuicSentPacketManager::OnPacketSent(
   return in_flight;
 }
 
+void QuicSentPacketManager::RecordBytesInFlightSample(
+    QuicByteCount bytes_in_flight) {
+  size_t bucket = 0;
+  while (bytes_in_flight > 1 &&
+         bucket < QuicConnectionStats::kNumBytesInFlightBuckets - 1) {
+    bytes_in_flight >>= 1;
+    ++bucket;
+  }
+  ++stats_->bytes_in_flight_histogram[bucket];
+}
+
 QuicSentPacketManager::RetransmissionTimeoutMode
 QuicSentPacketManager::OnRetransmissionTimeout() {
   QUICHE_DCHECK(unacked_packets_.HasInFlightPackets() ||
@@ -1437,23 +1467,25 @@ const QuicTime::Delta QuicSentPacketManager::GetProbeTimeoutDelay(
     PacketNumberSpace space) const {
   QUICHE_DCHECK(pto_enabled_);
   if (rtt_stats_.smoothed_rtt().IsZero()) {
-    // Respect kMinHandshakeTimeoutMs to avoid a potential amplification attack.
+    // Respect the policy's no-RTT-sample floor to avoid a potential
+    // amplification attack.
     QUIC_BUG_IF(quic_bug_12552_6, rtt_stats_.initial_rtt().IsZero());
     return std::max(
                pto_multiplier_without_rtt_samples_ * rtt_stats_.initial_rtt(),
-               QuicTime::Delta::FromMilliseconds(kMinHandshakeTimeoutMs)) *
+               pto_policy_.min_pto_without_rtt_samples) *
            (1 << consecutive_pto_count_);
   }
   if (enable_half_rtt_tail_loss_probe_ && consecutive_pto_count_ == 0 &&
       handshake_finished_) {
     return std::max(min_tlp_timeout_, rtt_stats_.smoothed_rtt() * 0.5);
   }
+  const QuicTime::Delta pto_granularity = GetPtoGranularity(space);
   const QuicTime::Delta rtt_var = use_standard_deviation_for_pto_
                                       ? rtt_stats_.GetStandardOrMeanDeviation()
                                       : rtt_stats_.mean_deviation();
   QuicTime::Delta pto_delay =
       rtt_stats_.smoothed_rtt() +
-      std::max(pto_rttvar_multiplier_ * rtt_var, kAlarmGranularity) +
+      std::max(pto_rttvar_multiplier_ * rtt_var, pto_granularity) +
       (ShouldAddMaxAckDelay(space) ? peer_max_ack_delay_
                                    : QuicTime::Delta::Zero());
   pto_delay =
@@ -1464,7 +1496,7 @@ const QuicTime::Delta QuicSentPacketManager::GetProbeTimeoutDelay(
     // Make first n PTOs similar to TLPs.
     if (pto_delay > 2 * rtt_stats_.smoothed_rtt()) {
       QUIC_CODE_COUNT(quic_delayed_pto);
-      pto_delay = std::max(kAlarmGranularity, 2 * rtt_stats_.smoothed_rtt());
+      pto_delay = std::max(pto_granularity, 2 * rtt_stats_.smoothed_rtt());
     } else {
       QUIC_CODE_COUNT(quic_faster_pto);
     }
@@ -1472,6 +1504,29 @@ const QuicTime::Delta QuicSentPacketManager::GetProbeTimeoutDelay(
   return pto_delay;
 }
 
+QuicTime::Delta QuicSentPacketManager::GetPtoGranularity(
+    PacketNumberSpace space) const {
+  // NUM_PACKET_NUMBER_SPACES is passed when packet number spaces are not in
+  // use and gets the data-packet minimum.
+  if (space == INITIAL_DATA || space == HANDSHAKE_DATA) {
+    return pto_policy_.handshake_min_pto;
+  }
+  return pto_policy_.min_pto;
+}
+
+void QuicSentPacketManager::SetPtoPolicy(const QuicPtoPolicy& pto_policy) {
+  QUICHE_DCHECK(pto_enabled_);
+  pto_policy_ = pto_policy;
+  pto_rttvar_multiplier_ = pto_policy.rttvar_multiplier;
+  pto_multiplier_without_rtt_samples_ =
+      pto_policy.multiplier_without_rtt_samples;
+  pto_exponential_backoff_start_point_ =
+      pto_policy.exponential_backoff_start_point;
+  // The TLP-era minimum feeds the half-RTT first-probe path of
+  // GetProbeTimeoutDelay.
+  min_tlp_timeout_ = pto_policy.min_pto;
+}
+
 QuicTime::Delta QuicSentPacketManager::GetSlowStartDuration() const {
   if (send_algorithm_->GetCongestionControlType() == kBBR ||
       send_algorithm_->GetCongestionControlType() == kBBRv2) {
@@ -1543,7 +1598,7 @@ void QuicSentPacketManager::OnAckFrameStart(QuicPacketNumber largest_acked,
                                             QuicTime ack_receive_time) {
   QUICHE_DCHECK(packets_acked_.empty());
   QUICHE_DCHECK_LE(largest_acked, unacked_packets_.largest_sent_packet());
-  if (GetQuicReloadableFlag(quic_ignore_peer_max_ack_delay_during_handshake) &&
+  if (flag_snapshot_.ignore_peer_max_ack_delay_during_handshake &&
       supports_multiple_packet_number_spaces() && !handshake_finished_) {
     QUIC_RELOADABLE_FLAG_COUNT(quic_ignore_peer_max_ack_delay_during_handshake);
     // Ignore peer_max_ack_delay and use received ack_delay during
@@ -1611,6 +1666,21 @@ void QuicSentPacketManager::OnAckTimestamp(QuicPacketNumber packet_number,
   }
 }
 
+void QuicSentPacketManager::OnAckFrameEcnCounts(QuicPacketCount ect_0_count,
+                                                QuicPacketCount ect_1_count,
+                                                QuicPacketCount ecn_ce_count) {
+  peer_ect_0_count_ = std::max(peer_ect_0_count_, ect_0_count);
+  peer_ect_1_count_ = std::max(peer_ect_1_count_, ect_1_count);
+  if (ecn_ce_count <= peer_ecn_ce_count_) {
+    // A reordered or duplicate report; the marks have already been counted.
+    return;
+  }
+  const QuicPacketCount newly_marked = ecn_ce_count - peer_ecn_ce_count_;
+  peer_ecn_ce_count_ = ecn_ce_count;
+  stats_->ecn_ce_marks_received += newly_marked;
+  send_algorithm_->OnEcnFeedback(newly_marked);
+}
+
 AckResult QuicSentPacketManager::OnAckFrameEnd(
     QuicTime ack_receive_time,
     QuicPacketNumber ack_packet_number,
@@ -1683,13 +1753,54 @@ AckResult QuicSentPacketManager::OnAckFrameEnd(
                       acked_packet.receive_timestamp);
   }
   const bool acked_new_packet = !packets_acked_.empty();
-  PostProcessNewlyAckedPackets(ack_packet_number, ack_decrypted_level,
-                               last_ack_frame_, ack_receive_time, rtt_updated_,
-                               prior_bytes_in_flight);
+  if (ack_batch_mode_) {
+    // Defer loss detection and congestion control to OnAckBatchComplete().
+    if (!ack_batch_pending_) {
+      ack_batch_pending_ = true;
+      ack_batch_prior_bytes_in_flight_ = prior_bytes_in_flight;
+      ack_batch_rtt_updated_ = false;
+    }
+    ack_batch_rtt_updated_ |= rtt_updated_;
+    ack_batch_receive_time_ = ack_receive_time;
+    ack_batch_packet_number_ = ack_packet_number;
+    ack_batch_decrypted_level_ = ack_decrypted_level;
+    for (AckedPacket& acked_packet : packets_acked_) {
+      batched_packets_acked_.push_back(acked_packet);
+    }
+    packets_acked_.clear();
+  } else {
+    PostProcessNewlyAckedPackets(ack_packet_number, ack_decrypted_level,
+                                 last_ack_frame_, ack_receive_time,
+                                 rtt_updated_, prior_bytes_in_flight);
+  }
 
   return acked_new_packet ? PACKETS_NEWLY_ACKED : NO_PACKETS_NEWLY_ACKED;
 }
 
+void QuicSentPacketManager::EnterAckBatchMode() {
+  QUIC_BUG_IF(quic_bug_ack_batch_mode_reentered, ack_batch_mode_)
+      << "EnterAckBatchMode called while already in batch-ACK mode";
+  ack_batch_mode_ = true;
+}
+
+bool QuicSentPacketManager::OnAckBatchComplete() {
+  if (!ack_batch_mode_) {
+    return false;
+  }
+  ack_batch_mode_ = false;
+  if (!ack_batch_pending_) {
+    return false;
+  }
+  ack_batch_pending_ = false;
+  QUICHE_DCHECK(packets_acked_.empty());
+  packets_acked_.swap(batched_packets_acked_);
+  PostProcessNewlyAckedPackets(
+      ack_batch_packet_number_, ack_batch_decrypted_level_, last_ack_frame_,
+      ack_batch_receive_time_, ack_batch_rtt_updated_,
+      ack_batch_prior_bytes_in_flight_);
+  return true;
+}
+
 void QuicSentPacketManager::SetDebugDelegate(DebugDelegate* debug_delegate) {
   debug_delegate_ = debug_delegate;
 }
@@ -19,7 +19,9 @@
 #include "quic/core/congestion_control/send_algorithm_interface.h"
 #include "quic/core/congestion_control/uber_loss_algorithm.h"
 #include "quic/core/proto/cached_network_parameters_proto.h"
+#include "quic/core/quic_flag_snapshot.h"
 #include "quic/core/quic_packets.h"
+#include "quic/core/quic_pto_policy.h"
 #include "quic/core/quic_sustained_bandwidth_recorder.h"
 #include "quic/core/quic_time.h"
 #include "quic/core/quic_transmission_info.h"
@@ -144,6 +146,10 @@ class QUIC_EXPORT_PRIVATE QuicSentPacketManager {
     return pacing_sender_.max_pacing_rate();
   }
 
+  void SetPacingDeadlineHint(QuicTime deadline) {
+    pacing_sender_.set_deadline_hint(deadline);
+  }
+
   // Called to mark the handshake state complete, and all handshake packets are
   // neutered.
   // TODO(fayang): Rename this function to OnHandshakeComplete.
@@ -168,6 +174,12 @@ class QUIC_EXPORT_PRIVATE QuicSentPacketManager {
   void OnConfigNegotiated();
   void OnConnectionClosed();
 
+  // Applies |profile| to the loss algorithm and records its ID in the
+  // connection stats, so spurious retransmit rates can be aggregated per
+  // profile. Called when the client requests a profile by connection option,
+  // or directly by server policy.
+  void ApplyLossDetectionProfile(const LossDetectionProfile& profile);
+
   // Retransmits the oldest pending packet there is still a tail loss probe
   // pending.  Invoked after OnRetransmissionTimeout.
   bool MaybeRetransmitTailLossProbe();
@@ -322,11 +334,29 @@ class QUIC_EXPORT_PRIVATE QuicSentPacketManager {
   // the timestamp field is set.  Otherwise, the timestamp is ignored.
   void OnAckTimestamp(QuicPacketNumber packet_number, QuicTime timestamp);
 
+  // Called when the cumulative ECN counts of an ACK_ECN frame are parsed.
+  // Newly reported CE marks are passed on to the send algorithm.
+  void OnAckFrameEcnCounts(QuicPacketCount ect_0_count,
+                           QuicPacketCount ect_1_count,
+                           QuicPacketCount ecn_ce_count);
+
   // Called when an ack frame is parsed completely.
   AckResult OnAckFrameEnd(QuicTime ack_receive_time,
                           QuicPacketNumber ack_packet_number,
                           EncryptionLevel ack_decrypted_level);
 
+  // Enters batch-ACK mode. While in batch mode, OnAckFrameEnd() accumulates
+  // newly acked packets and defers loss detection and congestion control
+  // updates until OnAckBatchComplete() is called, so that several ACK frames
+  // received within one event-loop iteration (e.g. from coalesced packets)
+  // result in a single loss detection and congestion control pass.
+  void EnterAckBatchMode();
+
+  // Leaves batch-ACK mode and performs the deferred loss detection and
+  // congestion control pass over all packets acked since EnterAckBatchMode().
+  // Returns true if any deferred processing ran. No-op outside batch mode.
+  bool OnAckBatchComplete();
+
   void EnableMultiplePacketNumberSpacesSupport();
 
   void SetDebugDelegate(DebugDelegate* debug_delegate);
@@ -435,6 +465,12 @@ class QUIC_EXPORT_PRIVATE QuicSentPacketManager {
   void StartExponentialBackoffAfterNthPto(
       size_t exponential_backoff_start_point);
 
+  // Replaces the PTO timeout computation knobs with |pto_policy|, e.g. to
+  // lower the millisecond-scale floors on microsecond-RTT datacenter paths.
+  // Must only be called when PTO is enabled, ideally before any packet is
+  // sent.
+  void SetPtoPolicy(const QuicPtoPolicy& pto_policy);
+
   // Called to retransmit in flight packet of |space| if any.
   void RetransmitDataOfSpaceIfAny(PacketNumberSpace space);
 
@@ -502,6 +538,13 @@ class QUIC_EXPORT_PRIVATE QuicSentPacketManager {
   // Returns the probe timeout.
   const QuicTime::Delta GetProbeTimeoutDelay(PacketNumberSpace space) const;
 
+  // Returns the lower bound pto_policy_ imposes on PTOs of |space|.
+  QuicTime::Delta GetPtoGranularity(PacketNumberSpace space) const;
+
+  // Counts |bytes_in_flight| into the power-of-two bytes-in-flight histogram
+  // in |stats_|. Called as each congestion controlled packet is sent.
+  void RecordBytesInFlightSample(QuicByteCount bytes_in_flight);
+
   // Update the RTT if the ack is for the largest acked packet number.
   // Returns true if the rtt was updated.
   bool MaybeUpdateRTT(QuicPacketNumber largest_acked,
@@ -692,6 +735,25 @@ class QUIC_EXPORT_PRIVATE QuicSentPacketManager {
   // OnAckRangeStart, and gradually moves in OnAckRange..
   PacketNumberQueue::const_reverse_iterator acked_packets_iter_;
 
+  // True while batch-ACK mode is active. See EnterAckBatchMode().
+  bool ack_batch_mode_ = false;
+  // True if at least one ACK frame has been processed in the current batch.
+  bool ack_batch_pending_ = false;
+  // Packets acked by frames in the current batch, in ascending order.
+  AckedPacketVector batched_packets_acked_;
+  // State of the batch so far, consumed by OnAckBatchComplete(). The bytes in
+  // flight are captured before the first frame in the batch acked anything;
+  // the other fields reflect the most recently processed frame.
+  QuicByteCount ack_batch_prior_bytes_in_flight_ = 0;
+  bool ack_batch_rtt_updated_ = false;
+  QuicTime ack_batch_receive_time_ = QuicTime::Zero();
+  QuicPacketNumber ack_batch_packet_number_;
+  EncryptionLevel ack_batch_decrypted_level_ = ENCRYPTION_INITIAL;
+
+  // Reloadable flags read on per-ack paths, resolved once at creation. See
+  // QuicFlagSnapshot.
+  const QuicFlagSnapshot flag_snapshot_;
+
   // Indicates whether PTO mode has been enabled. PTO mode unifies TLP and RTO
   // modes.
   bool pto_enabled_;
@@ -731,6 +793,12 @@ class QUIC_EXPORT_PRIVATE QuicSentPacketManager {
   // True if any 1-RTT packet gets acknowledged.
   bool one_rtt_packet_acked_;
 
+  // Largest cumulative ECN counts the peer has reported in ACK_ECN frames.
+  // Used to compute the number of newly marked packets per report.
+  QuicPacketCount peer_ect_0_count_ = 0;
+  QuicPacketCount peer_ect_1_count_ = 0;
+  QuicPacketCount peer_ecn_ce_count_ = 0;
+
   // If > 0, arm the 1st PTO with max of earliest in flight sent time + PTO
   // delay and multiplier * srtt from last in flight packet.
   float first_pto_srtt_multiplier_;
@@ -743,6 +811,11 @@ class QUIC_EXPORT_PRIVATE QuicSentPacketManager {
   // available.
   float pto_multiplier_without_rtt_samples_;
 
+  // Deployment-profile floors applied when calculating PTO timeout. The
+  // multiplier-style knobs of the policy are copied onto the members above
+  // by SetPtoPolicy(); only the per-space minimums are read from here.
+  QuicPtoPolicy pto_policy_;
+
   // The number of PTOs needed for path degrading alarm. If equals to 0, the
   // traditional path degrading mechanism will be used.
   int num_ptos_for_path_degrading_;
@@ -10,6 +10,7 @@
 #include "absl/base/macros.h"
 #include "absl/strings/string_view.h"
 #include "quic/core/frames/quic_ack_frequency_frame.h"
+#include "quic/core/quic_pto_policy.h"
 #include "quic/core/quic_time.h"
 #include "quic/core/quic_types.h"
 #include "quic/platform/api/quic_expect_bug.h"
@@ -352,6 +353,21 @@ class QuicSentPacketManagerTest : public QuicTest {
   StrictMock<MockSessionNotifier> notifier_;
 };
 
+TEST_F(QuicSentPacketManagerTest, BytesInFlightHistogram) {
+  // The first packet is sent with nothing in flight, landing in bucket 0.
+  SendDataPacket(1);
+  // The second packet is sent with 1000 bytes in flight:
+  // 2^9 <= 1000 < 2^10, so it lands in bucket 9.
+  SendDataPacket(2);
+  // The third packet is sent with 2000 bytes in flight, landing in bucket 10.
+  SendDataPacket(3);
+
+  EXPECT_EQ(1u, stats_.bytes_in_flight_histogram[0]);
+  EXPECT_EQ(0u, stats_.bytes_in_flight_histogram[1]);
+  EXPECT_EQ(1u, stats_.bytes_in_flight_histogram[9]);
+  EXPECT_EQ(1u, stats_.bytes_in_flight_histogram[10]);
+}
+
 TEST_F(QuicSentPacketManagerTest, IsUnacked) {
   VerifyUnackedPackets(nullptr, 0);
   SendDataPacket(1);
@@ -418,6 +434,44 @@ TEST_F(QuicSentPacketManagerTest, RetransmitThenAckBeforeSend) {
   EXPECT_EQ(0u, stats_.packets_spuriously_retransmitted);
 }
 
+TEST_F(QuicSentPacketManagerTest, AckBatchModeDefersCongestionEvents) {
+  SendDataPacket(1);
+  SendDataPacket(2);
+  SendDataPacket(3);
+  SendDataPacket(4);
+
+  // In batch mode, each ACK frame is validated and its packets are marked
+  // handled immediately, but loss detection and congestion control are
+  // deferred until the batch completes.
+  manager_.EnterAckBatchMode();
+  manager_.OnAckFrameStart(QuicPacketNumber(2), QuicTime::Delta::Infinite(),
+                           clock_.Now());
+  manager_.OnAckRange(QuicPacketNumber(1), QuicPacketNumber(3));
+  EXPECT_EQ(PACKETS_NEWLY_ACKED,
+            manager_.OnAckFrameEnd(clock_.Now(), QuicPacketNumber(1),
+                                   ENCRYPTION_INITIAL));
+  manager_.OnAckFrameStart(QuicPacketNumber(4), QuicTime::Delta::Infinite(),
+                           clock_.Now());
+  manager_.OnAckRange(QuicPacketNumber(3), QuicPacketNumber(5));
+  EXPECT_EQ(PACKETS_NEWLY_ACKED,
+            manager_.OnAckFrameEnd(clock_.Now(), QuicPacketNumber(2),
+                                   ENCRYPTION_INITIAL));
+
+  // A single congestion event covers the packets acked by both frames.
+  uint64_t acked[] = {1, 2, 3, 4};
+  ExpectAcksAndLosses(true, acked, ABSL_ARRAYSIZE(acked), nullptr, 0);
+  EXPECT_TRUE(manager_.OnAckBatchComplete());
+  EXPECT_FALSE(manager_.HasInFlightPackets());
+}
+
+TEST_F(QuicSentPacketManagerTest, AckBatchModeWithoutAcksIsNoOp) {
+  SendDataPacket(1);
+  manager_.EnterAckBatchMode();
+  EXPECT_FALSE(manager_.OnAckBatchComplete());
+  // Completing again outside batch mode is also a no-op.
+  EXPECT_FALSE(manager_.OnAckBatchComplete());
+}
+
 TEST_F(QuicSentPacketManagerTest, RetransmitThenStopRetransmittingBeforeSend) {
   SendDataPacket(1);
   EXPECT_CALL(notifier_, RetransmitFrames(_, _));
@@ -1867,6 +1921,29 @@ TEST_F(QuicSentPacketManagerTest,
       QuicSentPacketManagerPeer::AdaptiveTimeThresholdEnabled(&manager_));
 }
 
+TEST_F(QuicSentPacketManagerTest, NegotiateLossDetectionProfileFromOptions) {
+  EXPECT_EQ(kDefaultLossDelayShift,
+            QuicSentPacketManagerPeer::GetReorderingShift(&manager_));
+  EXPECT_EQ(0u, stats_.loss_detection_profile_id);
+
+  QuicConfig config;
+  QuicTagVector options;
+  options.push_back(kLDPS);
+  QuicConfigPeer::SetReceivedConnectionOptions(&config, options);
+  EXPECT_CALL(*send_algorithm_, SetFromConfig(_, _));
+  EXPECT_CALL(*network_change_visitor_, OnCongestionChange());
+  manager_.SetFromConfig(config);
+
+  const LossDetectionProfile satellite = LossDetectionProfile::Satellite();
+  EXPECT_EQ(satellite.reordering_shift,
+            QuicSentPacketManagerPeer::GetReorderingShift(&manager_));
+  EXPECT_TRUE(
+      QuicSentPacketManagerPeer::AdaptiveReorderingThresholdEnabled(&manager_));
+  EXPECT_TRUE(
+      QuicSentPacketManagerPeer::AdaptiveTimeThresholdEnabled(&manager_));
+  EXPECT_EQ(kLDPS, stats_.loss_detection_profile_id);
+}
+
 TEST_F(QuicSentPacketManagerTest, NegotiateCongestionControlFromOptions) {
   QuicConfig config;
   QuicTagVector options;
@@ -3780,6 +3857,55 @@ TEST_F(QuicSentPacketManagerTest, ComputingProbeTimeoutUsingStandardDeviation) {
             manager_.GetRetransmissionTime());
 }
 
+TEST_F(QuicSentPacketManagerTest, DatacenterPtoPolicyUsesMicrosecondFloor) {
+  EnablePto(k2PTO);
+  manager_.SetPtoPolicy(QuicPtoPolicy::Datacenter());
+  manager_.set_peer_max_ack_delay(QuicTime::Delta::Zero());
+  EXPECT_CALL(*send_algorithm_, PacingRate(_))
+      .WillRepeatedly(Return(QuicBandwidth::Zero()));
+  EXPECT_CALL(*send_algorithm_, GetCongestionWindow())
+      .WillRepeatedly(Return(10 * kDefaultTCPMSS));
+  RttStats* rtt_stats = const_cast<RttStats*>(manager_.GetRttStats());
+  rtt_stats->UpdateRtt(QuicTime::Delta::FromMicroseconds(50),
+                       QuicTime::Delta::Zero(), QuicTime::Zero());
+  QuicTime::Delta srtt = rtt_stats->smoothed_rtt();
+
+  SendDataPacket(1, ENCRYPTION_FORWARD_SECURE);
+  // The variance term is floored at the policy's 100us minimum instead of
+  // the 1ms alarm granularity, keeping the PTO microsecond scale.
+  QuicTime::Delta expected_pto_delay =
+      srtt + std::max(2 * rtt_stats->mean_deviation(),
+                      QuicTime::Delta::FromMicroseconds(100));
+  EXPECT_LT(expected_pto_delay, QuicTime::Delta::FromMilliseconds(1));
+  EXPECT_EQ(clock_.Now() + expected_pto_delay,
+            manager_.GetRetransmissionTime());
+}
+
+TEST_F(QuicSentPacketManagerTest,
+       DatacenterPtoPolicyUsesHandshakeFloorForInitialData) {
+  manager_.EnableMultiplePacketNumberSpacesSupport();
+  EnablePto(k1PTO);
+  manager_.SetPtoPolicy(QuicPtoPolicy::Datacenter());
+  EXPECT_CALL(*send_algorithm_, PacingRate(_))
+      .WillRepeatedly(Return(QuicBandwidth::Zero()));
+  EXPECT_CALL(*send_algorithm_, GetCongestionWindow())
+      .WillRepeatedly(Return(10 * kDefaultTCPMSS));
+  RttStats* rtt_stats = const_cast<RttStats*>(manager_.GetRttStats());
+  rtt_stats->UpdateRtt(QuicTime::Delta::FromMicroseconds(50),
+                       QuicTime::Delta::Zero(), QuicTime::Zero());
+  QuicTime::Delta srtt = rtt_stats->smoothed_rtt();
+
+  // Send packet 1 in the initial space. Handshake probes use the policy's
+  // separate 500us floor rather than the data-packet 100us one.
+  SendDataPacket(1, ENCRYPTION_INITIAL);
+  const QuicTime packet1_sent_time = clock_.Now();
+  QuicTime::Delta expected_pto_delay =
+      srtt + std::max(2 * rtt_stats->mean_deviation(),
+                      QuicTime::Delta::FromMicroseconds(500));
+  EXPECT_EQ(packet1_sent_time + expected_pto_delay,
+            manager_.GetRetransmissionTime());
+}
+
 TEST_F(QuicSentPacketManagerTest,
        ComputingProbeTimeoutByLeftEdgeMultiplePacketNumberSpaces) {
   manager_.EnableMultiplePacketNumberSpacesSupport();
@@ -4860,6 +4986,26 @@ TEST_F(QuicSentPacketManagerTest, BuildAckFrequencyFrameWithSRTT) {
                      QuicTime::Delta::FromMilliseconds(1u)));
 }
 
+TEST_F(QuicSentPacketManagerTest, EcnCountsReportedAsDeltas) {
+  // The first report's CE count is entirely new marks.
+  EXPECT_CALL(*send_algorithm_, OnEcnFeedback(3));
+  manager_.OnAckFrameEcnCounts(/*ect_0_count=*/10, /*ect_1_count=*/0,
+                               /*ecn_ce_count=*/3);
+  EXPECT_EQ(3u, stats_.ecn_ce_marks_received);
+
+  // A duplicate or reordered report of already-seen cumulative counts is
+  // ignored.
+  manager_.OnAckFrameEcnCounts(/*ect_0_count=*/10, /*ect_1_count=*/0,
+                               /*ecn_ce_count=*/3);
+  EXPECT_EQ(3u, stats_.ecn_ce_marks_received);
+
+  // Only the newly marked packets are passed to the send algorithm.
+  EXPECT_CALL(*send_algorithm_, OnEcnFeedback(2));
+  manager_.OnAckFrameEcnCounts(/*ect_0_count=*/12, /*ect_1_count=*/0,
+                               /*ecn_ce_count=*/5);
+  EXPECT_EQ(5u, stats_.ecn_ce_marks_received);
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace quic
@@ -54,6 +54,31 @@ class ClosedStreamsCleanUpDelegate : public QuicAlarm::Delegate {
   QuicSession* session_;
 };
 
+class WriteAggregationDelegate : public QuicAlarm::Delegate {
+ public:
+  explicit WriteAggregationDelegate(QuicSession* session)
+      : session_(session) {}
+  WriteAggregationDelegate(const WriteAggregationDelegate&) = delete;
+  WriteAggregationDelegate& operator=(const WriteAggregationDelegate&) = delete;
+
+  QuicConnectionContext* GetConnectionContext() override {
+    return (session_->connection() == nullptr)
+               ? nullptr
+               : session_->connection()->context();
+  }
+
+  void OnAlarm() override { session_->OnWriteAggregationAlarm(); }
+
+ private:
+  QuicSession* session_;
+};
+
+// How long acks of application data may be delayed while the server is
+// overloaded. A stretched ack delay slows ack-clocked senders down without
+// looking like loss.
+constexpr QuicTime::Delta kOverloadedLocalMaxAckDelay =
+    QuicTime::Delta::FromMilliseconds(4 * kDefaultDelayedAckTimeMs);
+
 }  // namespace
 
 #define ENDPOINT \
@@ -104,6 +129,8 @@ QuicSession::QuicSession(
       last_message_id_(0),
       datagram_queue_(this, std::move(datagram_observer)),
       closed_streams_clean_up_alarm_(nullptr),
+      write_aggregation_window_(QuicTime::Delta::Zero()),
+      write_aggregation_alarm_(nullptr),
       supported_versions_(supported_versions),
       is_configured_(false),
       was_zero_rtt_rejected_(false),
@@ -163,6 +190,9 @@ QuicSession::~QuicSession() {
   if (closed_streams_clean_up_alarm_ != nullptr) {
     closed_streams_clean_up_alarm_->PermanentCancel();
   }
+  if (write_aggregation_alarm_ != nullptr) {
+    write_aggregation_alarm_->PermanentCancel();
+  }
 }
 
 PendingStream* QuicSession::PendingStreamOnStreamFrame(
@@ -681,7 +711,7 @@ void QuicSession::OnCanWrite() {
     if (!CanWriteStreamData()) {
       return;
     }
-    currently_writing_stream_id_ = write_blocked_streams_.PopFront();
+    currently_writing_stream_id_ = PopNextWriteBlockedStream();
     last_writing_stream_ids.push_back(currently_writing_stream_id_);
     QUIC_DVLOG(1) << ENDPOINT << "Removing stream "
                   << currently_writing_stream_id_ << " from write-blocked list";
@@ -691,12 +721,23 @@ void QuicSession::OnCanWrite() {
       // list.
       uint64_t previous_bytes_written = stream->stream_bytes_written();
       bool previous_fin_sent = stream->fin_sent();
+      const bool had_pending_retransmission =
+          streams_with_pending_retransmission_.contains(
+              currently_writing_stream_id_);
       QUIC_DVLOG(1) << ENDPOINT << "stream " << stream->id()
                     << " bytes_written " << previous_bytes_written << " fin "
                     << previous_fin_sent;
       stream->OnCanWrite();
+      if (had_pending_retransmission && !stream->HasPendingRetransmission()) {
+        streams_with_pending_retransmission_.erase(
+            currently_writing_stream_id_);
+      }
       QUICHE_DCHECK(CheckStreamWriteBlocked(stream));
-      QUICHE_DCHECK(CheckStreamNotBusyLooping(stream, previous_bytes_written,
+      // Retransmitted bytes do not count towards stream_bytes_written(), so
+      // a write slot spent on retransmission is progress the busy loop
+      // detector cannot see.
+      QUICHE_DCHECK(had_pending_retransmission ||
+                    CheckStreamNotBusyLooping(stream, previous_bytes_written,
                                               previous_fin_sent));
     }
     currently_writing_stream_id_ = 0;
@@ -770,6 +811,15 @@ std::string QuicSession::GetStreamsInfoForLogging() const {
   return info;
 }
 
+QuicQosClass QuicSession::GetQosClassForStream(QuicStreamId stream_id) const {
+  const QuicStream* stream = GetStream(stream_id);
+  if (stream == nullptr) {
+    // Closed or unknown stream; retransmissions of its data are best effort.
+    return QOS_CLASS_DEFAULT;
+  }
+  return stream->qos_class();
+}
+
 bool QuicSession::HasPendingHandshake() const {
   if (QuicVersionUsesCryptoFrames(transport_version())) {
     return GetCryptoStream()->HasPendingCryptoRetransmission() ||
@@ -788,6 +838,67 @@ void QuicSession::ProcessUdpPacket(const QuicSocketAddress& self_address,
   connection_->ProcessUdpPacket(self_address, peer_address, packet);
 }
 
+bool QuicSession::ShouldAggregateWrite(QuicStreamId id, size_t write_length,
+                                       StreamSendingState state,
+                                       TransmissionType type) {
+  if (write_aggregation_window_.IsZero() || type != NOT_RETRANSMISSION ||
+      state != NO_FIN || write_length == 0 ||
+      write_length >= connection_->max_packet_length()) {
+    // Only hold new small stream data without a FIN; everything else is
+    // either urgent or already fills packets on its own.
+    return false;
+  }
+  if (currently_writing_stream_id_ != 0) {
+    // Inside the OnCanWrite loop, which is also how held writes get flushed.
+    // Holding here would busy-loop the write blocked list.
+    return false;
+  }
+  if (QuicUtils::IsCryptoStreamId(transport_version(), id)) {
+    return false;
+  }
+  if (stream_delivery_deadlines_.contains(id)) {
+    // Deadline-marked streams are latency sensitive; never delay them.
+    return false;
+  }
+  const QuicStream* stream = GetActiveStream(id);
+  if (stream == nullptr || stream->is_static()) {
+    return false;
+  }
+  if (write_aggregation_alarm_ == nullptr) {
+    QUIC_BUG(quic_write_aggregation_no_alarm)
+        << ENDPOINT << "Write aggregation enabled without an alarm.";
+    return false;
+  }
+  if (!write_aggregation_alarm_->IsSet()) {
+    write_aggregation_alarm_->Set(connection_->clock()->ApproximateNow() +
+                                  write_aggregation_window_);
+  }
+  return true;
+}
+
+void QuicSession::set_write_aggregation_window(QuicTime::Delta window) {
+  write_aggregation_window_ = window;
+  if (!window.IsZero()) {
+    if (write_aggregation_alarm_ == nullptr) {
+      write_aggregation_alarm_ =
+          absl::WrapUnique<QuicAlarm>(connection_->alarm_factory()->CreateAlarm(
+              new WriteAggregationDelegate(this)));
+    }
+    return;
+  }
+  if (write_aggregation_alarm_ != nullptr && write_aggregation_alarm_->IsSet()) {
+    // Flush anything already held instead of waiting for the alarm.
+    write_aggregation_alarm_->Cancel();
+    OnCanWrite();
+  }
+}
+
+void QuicSession::OnWriteAggregationAlarm() {
+  // Everything held during the window is flushed under a single packet
+  // flusher, so frames from different streams share packets.
+  OnCanWrite();
+}
+
 QuicConsumedData QuicSession::WritevData(QuicStreamId id, size_t write_length,
                                          QuicStreamOffset offset,
                                          StreamSendingState state,
@@ -825,6 +936,13 @@ QuicConsumedData QuicSession::WritevData(QuicStreamId id, size_t write_length,
     return QuicConsumedData(0, false);
   }
 
+  if (ShouldAggregateWrite(id, write_length, state, type)) {
+    // Leave the data buffered in the stream; the caller marks itself write
+    // blocked and the aggregation alarm flushes it together with other
+    // closely-spaced writes.
+    return QuicConsumedData(0, false);
+  }
+
   SetTransmissionType(type);
   QuicConnection::ScopedEncryptionLevelContext context(connection(), level);
 
@@ -1009,6 +1127,7 @@ void QuicSession::OnStreamClosed(QuicStreamId stream_id) {
     stream_map_.erase(it);
     // Do not retransmit data of a closed stream.
     streams_with_pending_retransmission_.erase(stream_id);
+    stream_delivery_deadlines_.erase(stream_id);
     if (!closed_streams_clean_up_alarm_->IsSet()) {
       closed_streams_clean_up_alarm_->Set(
           connection_->clock()->ApproximateNow());
@@ -1707,6 +1826,17 @@ bool QuicSession::MaybeSendAddressToken() {
   return true;
 }
 
+void QuicSession::OnIdleMemoryReclaim() {
+  // Streams waiting for data hold on to their sequencer buffer's block map
+  // even when nothing is buffered; release it until new data arrives.
+  for (auto& it : stream_map_) {
+    it.second->ReleaseSequencerBufferIfEmpty();
+  }
+  if (closed_streams_.empty()) {
+    closed_streams_.shrink_to_fit();
+  }
+}
+
 void QuicSession::DiscardOldDecryptionKey(EncryptionLevel level) {
   if (!connection()->version().KnowsWhichDecrypterToUse()) {
     return;
@@ -2140,6 +2270,73 @@ void QuicSession::OnServerConnectionIdRetired(
   }
 }
 
+QuicByteCount QuicSession::GetMemoryFootprint() const {
+  QuicByteCount total =
+      connection_->sent_packet_manager().GetBytesInFlight();
+  for (auto const& kv : stream_map_) {
+    total += kv.second->GetMemoryFootprint();
+  }
+  const QuicCryptoStream* crypto_stream = GetCryptoStream();
+  if (crypto_stream != nullptr) {
+    total += crypto_stream->GetMemoryFootprint();
+  }
+  return total;
+}
+
+void QuicSession::OnMemoryPressure(MemoryPressureLevel level) {
+  if (level == MemoryPressureLevel::kCritical) {
+    connection_->CloseConnection(
+        QUIC_CONNECTION_CANCELLED, "Connection closed due to memory pressure",
+        ConnectionCloseBehavior::SEND_CONNECTION_CLOSE_PACKET);
+    return;
+  }
+  // Advertised flow control windows cannot shrink, but stopping receive
+  // window auto-tuning caps how much more buffering this connection can
+  // commit to.
+  flow_controller_.DisableReceiveWindowAutoTuning();
+  for (auto const& kv : stream_map_) {
+    kv.second->OnMemoryPressure();
+  }
+}
+
+void QuicSession::OnServerOverload(bool overloaded) {
+  QUICHE_DCHECK_EQ(perspective_, Perspective::IS_SERVER);
+  // The connection-level window gates the aggregate inbound rate across all
+  // streams, so stream-level windows are left alone.
+  flow_controller_.SetOverloaded(overloaded);
+  connection_->set_local_max_ack_delay(
+      overloaded ? kOverloadedLocalMaxAckDelay
+                 : QuicTime::Delta::FromMilliseconds(kDefaultDelayedAckTimeMs));
+}
+
+void QuicSession::RaiseAdvertisedLimits(
+    QuicStreamCount max_incoming_bidirectional_streams,
+    QuicStreamCount max_incoming_unidirectional_streams,
+    QuicByteCount session_flow_control_window) {
+  if (!connection_->connected()) {
+    return;
+  }
+  if (VersionHasIetfQuicFrames(transport_version())) {
+    if (max_incoming_bidirectional_streams > 0) {
+      ietf_streamid_manager_.MaybeRaiseMaxOpenIncomingBidirectionalStreams(
+          max_incoming_bidirectional_streams);
+    }
+    if (max_incoming_unidirectional_streams > 0) {
+      ietf_streamid_manager_.MaybeRaiseMaxOpenIncomingUnidirectionalStreams(
+          max_incoming_unidirectional_streams);
+    }
+  } else if (max_incoming_bidirectional_streams >
+             stream_id_manager_.max_open_incoming_streams()) {
+    // Google QUIC enforces the stream limit locally; there is no frame to
+    // advertise it, so raising the limit takes effect immediately.
+    stream_id_manager_.set_max_open_incoming_streams(
+        max_incoming_bidirectional_streams);
+  }
+  if (session_flow_control_window > 0) {
+    flow_controller_.MaybeRaiseReceiveWindowSize(session_flow_control_window);
+  }
+}
+
 bool QuicSession::IsConnectionFlowControlBlocked() const {
   return flow_controller_.IsBlocked();
 }
@@ -2399,6 +2596,41 @@ bool QuicSession::CanWriteStreamData() const {
   return connection_->CanWrite(HAS_RETRANSMITTABLE_DATA);
 }
 
+void QuicSession::OnStreamDeliveryDeadlineSet(QuicStreamId stream_id,
+                                              QuicTime deadline) {
+  if (!deadline.IsInitialized()) {
+    stream_delivery_deadlines_.erase(stream_id);
+    return;
+  }
+  stream_delivery_deadlines_[stream_id] = deadline;
+}
+
+QuicStreamId QuicSession::PopNextWriteBlockedStream() {
+  if (!stream_delivery_deadlines_.empty() &&
+      !write_blocked_streams_.HasWriteBlockedSpecialStream() &&
+      !flow_controller_.IsBlocked()) {
+    // Earliest-deadline-first admission: serve the write-blocked stream with
+    // the nearest delivery deadline ahead of the priority order, and give the
+    // pacer the deadline so it can skip its delay if honoring it would miss
+    // the deadline.
+    QuicStreamId earliest_stream_id = 0;
+    QuicTime earliest_deadline = QuicTime::Infinite();
+    for (const auto& deadline : stream_delivery_deadlines_) {
+      if (deadline.second < earliest_deadline &&
+          write_blocked_streams_.IsStreamBlocked(deadline.first)) {
+        earliest_deadline = deadline.second;
+        earliest_stream_id = deadline.first;
+      }
+    }
+    if (earliest_stream_id != 0 &&
+        write_blocked_streams_.PopStream(earliest_stream_id)) {
+      connection_->SetPacingDeadlineHint(earliest_deadline);
+      return earliest_stream_id;
+    }
+  }
+  return write_blocked_streams_.PopFront();
+}
+
 bool QuicSession::RetransmitLostData() {
   QuicConnection::ScopedPacketFlusher retransmission_flusher(connection_);
   // Retransmit crypto data first.
@@ -2430,34 +2662,45 @@ bool QuicSession::RetransmitLostData() {
       return false;
     }
   }
-  while (!streams_with_pending_retransmission_.empty()) {
-    if (!CanWriteStreamData()) {
-      break;
-    }
-    // Retransmit lost data on headers and data streams.
-    const QuicStreamId id = streams_with_pending_retransmission_.begin()->first;
+  // Lost data on headers and data streams is not drained here. Each stream
+  // is instead re-queued in the write blocked list at its own priority, so
+  // that retransmissions compete with new data: a lost frame on a bulk
+  // stream must not delay fresh data on a more urgent stream. The streams
+  // are serviced by the regular write loop in OnCanWrite().
+  std::vector<QuicStreamId> retransmission_ids;
+  retransmission_ids.reserve(streams_with_pending_retransmission_.size());
+  for (const auto& pair : streams_with_pending_retransmission_) {
+    retransmission_ids.push_back(pair.first);
+  }
+  for (QuicStreamId id : retransmission_ids) {
     QuicStream* stream = GetStream(id);
-    if (stream != nullptr) {
-      stream->OnCanWrite();
-      QUICHE_DCHECK(CheckStreamWriteBlocked(stream));
-      if (stream->HasPendingRetransmission()) {
-        // Connection is write blocked.
-        break;
-      } else if (!streams_with_pending_retransmission_.empty() &&
-                 streams_with_pending_retransmission_.begin()->first == id) {
-        // Retransmit lost data may cause connection close. If this stream
-        // has not yet sent fin, a RST_STREAM will be sent and it will be
-        // removed from streams_with_pending_retransmission_.
-        streams_with_pending_retransmission_.pop_front();
-      }
-    } else {
+    if (stream == nullptr) {
       QUIC_BUG(quic_bug_10866_14)
           << "Try to retransmit data of a closed stream";
-      streams_with_pending_retransmission_.pop_front();
+      streams_with_pending_retransmission_.erase(id);
+      continue;
     }
+    if (!flow_controller_.IsBlocked() && !stream->IsFlowControlBlocked()) {
+      // No-op if the stream is already in the write blocked list.
+      MarkConnectionLevelWriteBlocked(id);
+      continue;
+    }
+    // The write loop does not service flow control blocked streams, but
+    // retransmissions consume no new flow control window. Drain this
+    // stream's lost data directly.
+    if (!CanWriteStreamData()) {
+      break;
+    }
+    stream->OnCanWrite();
+    QUICHE_DCHECK(CheckStreamWriteBlocked(stream));
+    if (stream->HasPendingRetransmission()) {
+      // Connection is write blocked.
+      return false;
+    }
+    streams_with_pending_retransmission_.erase(id);
   }
 
-  return streams_with_pending_retransmission_.empty();
+  return true;
 }
 
 void QuicSession::NeuterUnencryptedData() {
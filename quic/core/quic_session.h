@@ -157,6 +157,7 @@ class QUIC_EXPORT_PRIVATE QuicSession
       const QuicConnectionId& server_connection_id) override;
   bool WillingAndAbleToWrite() const override;
   std::string GetStreamsInfoForLogging() const override;
+  QuicQosClass GetQosClassForStream(QuicStreamId stream_id) const override;
   void OnPathDegrading() override;
   void OnForwardProgressMadeAfterPathDegrading() override;
   bool AllowSelfAddressChange() const override;
@@ -178,6 +179,7 @@ class QUIC_EXPORT_PRIVATE QuicSession
       const QuicSocketAddress& /*address*/) const override {
     return false;
   }
+  void OnIdleMemoryReclaim() override;
 
   // QuicStreamFrameDataProducer
   WriteStreamDataResult WriteStreamData(QuicStreamId id,
@@ -277,6 +279,10 @@ class QUIC_EXPORT_PRIVATE QuicSession
   // Called by stream |stream_id| when it gets closed.
   virtual void OnStreamClosed(QuicStreamId stream_id);
 
+  // Called by stream |stream_id| when its delivery deadline changes.
+  // |deadline| of QuicTime::Zero() clears the stream's deadline.
+  void OnStreamDeliveryDeadlineSet(QuicStreamId stream_id, QuicTime deadline);
+
   // Returns true if outgoing packets will be encrypted, even if the server
   // hasn't confirmed the handshake yet.
   virtual bool IsEncryptionEstablished() const;
@@ -494,6 +500,45 @@ class QUIC_EXPORT_PRIVATE QuicSession
 
   QuicFlowController* flow_controller() { return &flow_controller_; }
 
+  // Severity passed to OnMemoryPressure().
+  enum class MemoryPressureLevel {
+    // Stop growing per-connection buffers, but keep the connection alive.
+    kModerate,
+    // Close the connection to release its memory.
+    kCritical,
+  };
+
+  // Returns an estimate of the heap memory retained by this session: send
+  // buffer data that is buffered or unacked, sequencer blocks holding
+  // out-of-order receive data, and bytes in flight tracked by the sent
+  // packet manager. Lets the session owner find the heaviest connections
+  // when the process is under memory pressure.
+  virtual QuicByteCount GetMemoryFootprint() const;
+
+  // Called by the session owner when the process is under memory pressure.
+  // At kModerate, degrades gracefully: receive windows stop auto-tuning
+  // upwards, so buffering commitments stop growing. At kCritical, closes the
+  // connection.
+  virtual void OnMemoryPressure(MemoryPressureLevel level);
+
+  // Called by the dispatcher when the server's event loop enters or leaves
+  // overload (e.g. kernel socket drops observed). While overloaded, the
+  // connection-level receive window advances as if it were a quarter of its
+  // size and acks of application data are delayed further, throttling the
+  // inbound rate gracefully instead of letting kernel drops trigger
+  // loss-recovery storms.
+  virtual void OnServerOverload(bool overloaded);
+
+  // Raises the session's advertised limits on a live connection: the incoming
+  // stream limits are advertised with MAX_STREAMS frames and the session
+  // flow control window with a WINDOW_UPDATE. A zero argument leaves that
+  // limit unchanged, as do values at or below the current limits — the
+  // protocol only allows limits to rise once advertised. Driven by server
+  // policy changes, see QuicLimitsPolicyBus.
+  void RaiseAdvertisedLimits(QuicStreamCount max_incoming_bidirectional_streams,
+                             QuicStreamCount max_incoming_unidirectional_streams,
+                             QuicByteCount session_flow_control_window);
+
   // Returns true if connection is flow controller blocked.
   bool IsConnectionFlowControlBlocked() const;
 
@@ -522,6 +567,18 @@ class QUIC_EXPORT_PRIVATE QuicSession
   // Clean up closed_streams_.
   void CleanUpClosedStreams();
 
+  // Enables nagle-like aggregation of closely-spaced stream writes. New
+  // stream data smaller than a packet that arrives outside of OnCanWrite is
+  // held back (the stream stays write blocked) for up to |window|, so writes
+  // issued on different streams within the window are flushed together into
+  // full packets instead of each draining into an underfull one. Writes
+  // carrying a FIN and writes on streams with a delivery deadline bypass the
+  // hold. Pass QuicTime::Delta::Zero() to disable.
+  void set_write_aggregation_window(QuicTime::Delta window);
+
+  // Called when the write aggregation alarm fires; flushes held writes.
+  void OnWriteAggregationAlarm();
+
   const ParsedQuicVersionVector& supported_versions() const {
     return supported_versions_;
   }
@@ -814,7 +871,7 @@ class QUIC_EXPORT_PRIVATE QuicSession
   // bandwidth/rtt information. If return absl::nullopt, address token will not
   // contain the CachedNetworkParameters.
   virtual absl::optional<CachedNetworkParameters>
-  GenerateCachedNetworkParameters() const {
+  GenerateCachedNetworkParameters() {
     return absl::nullopt;
   }
 
@@ -854,6 +911,12 @@ class QUIC_EXPORT_PRIVATE QuicSession
   // it has to be in the write blocked list.
   bool CheckStreamWriteBlocked(QuicStream* stream) const;
 
+  // Returns true if this write should be held back and flushed together with
+  // other closely-spaced writes when the write aggregation alarm fires. Also
+  // arms the alarm when returning true. See set_write_aggregation_window().
+  bool ShouldAggregateWrite(QuicStreamId id, size_t write_length,
+                            StreamSendingState state, TransmissionType type);
+
   // Called in OnConfigNegotiated for Finch trials to measure performance of
   // starting with larger flow control receive windows.
   void AdjustInitialFlowControlWindows(size_t stream_window);
@@ -872,6 +935,12 @@ class QUIC_EXPORT_PRIVATE QuicSession
   // Returns true if stream data should be written.
   bool CanWriteStreamData() const;
 
+  // Pops the next stream to write from |write_blocked_streams_|.  If any
+  // write-blocked data stream has a delivery deadline, the one whose deadline
+  // is earliest is served ahead of the regular priority order and the pacer
+  // is given the deadline as a hint.
+  QuicStreamId PopNextWriteBlockedStream();
+
   // Closes the pending stream |stream_id| before it has been created.
   void ClosePendingStream(QuicStreamId stream_id);
 
@@ -982,13 +1051,27 @@ class QUIC_EXPORT_PRIVATE QuicSession
 
   // TODO(fayang): switch to linked_hash_set when chromium supports it. The bool
   // is not used here.
-  // List of streams with pending retransmissions.
+  // List of streams with pending retransmissions. Data streams in this list
+  // are re-queued in |write_blocked_streams_| so that retransmissions are
+  // scheduled at stream priority; only crypto and control data bypass the
+  // write blocked list.
   quiche::QuicheLinkedHashMap<QuicStreamId, bool>
       streams_with_pending_retransmission_;
 
+  // Delivery deadlines of streams that have one set, used for
+  // earliest-deadline-first admission in PopNextWriteBlockedStream().
+  absl::flat_hash_map<QuicStreamId, QuicTime> stream_delivery_deadlines_;
+
   // Clean up closed_streams_ when this alarm fires.
   std::unique_ptr<QuicAlarm> closed_streams_clean_up_alarm_;
 
+  // How long closely-spaced small writes are held back so they can be
+  // flushed together. Zero when write aggregation is disabled.
+  QuicTime::Delta write_aggregation_window_;
+
+  // Flushes held writes when it fires. See set_write_aggregation_window().
+  std::unique_ptr<QuicAlarm> write_aggregation_alarm_;
+
   // Supported version list used by the crypto handshake only. Please note, this
   // list may be a superset of the connection framer's supported versions.
   ParsedQuicVersionVector supported_versions_;
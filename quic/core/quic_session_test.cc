@@ -41,6 +41,7 @@
 #include "quic/test_tools/quic_test_utils.h"
 
 using spdy::kV3HighestPriority;
+using spdy::kV3LowestPriority;
 using spdy::SpdyPriority;
 using ::testing::_;
 using ::testing::AnyNumber;
@@ -703,6 +704,42 @@ TEST_P(QuicSessionTestServer, OneRttKeysAvailable) {
   EXPECT_TRUE(session_.OneRttKeysAvailable());
 }
 
+TEST_P(QuicSessionTestServer, MemoryFootprintAndMemoryPressure) {
+  // Ensure that Writev consumes all the data it is given (simulate no socket
+  // blocking).
+  session_.set_writev_consumes_all_data(true);
+  CompleteHandshake();
+
+  const QuicByteCount initial_footprint = session_.GetMemoryFootprint();
+  TestStream* stream = session_.CreateOutgoingBidirectionalStream();
+  std::string body(1024, '.');
+  stream->WriteOrBufferData(body, false, nullptr);
+  // The written data is unacked and still retained by the send buffer.
+  EXPECT_GE(session_.GetMemoryFootprint(), initial_footprint + body.size());
+
+  // Moderate pressure stops receive window auto-tuning but keeps the
+  // connection alive.
+  EXPECT_CALL(*connection_, CloseConnection(_, _, _)).Times(0);
+  session_.OnMemoryPressure(QuicSession::MemoryPressureLevel::kModerate);
+  EXPECT_FALSE(session_.flow_controller()->auto_tune_receive_window());
+
+  // Critical pressure closes the connection.
+  EXPECT_CALL(*connection_,
+              CloseConnection(QUIC_CONNECTION_CANCELLED, _, _));
+  session_.OnMemoryPressure(QuicSession::MemoryPressureLevel::kCritical);
+}
+
+TEST_P(QuicSessionTestServer, ServerOverloadThrottlesInbound) {
+  CompleteHandshake();
+
+  EXPECT_FALSE(session_.flow_controller()->overloaded());
+  session_.OnServerOverload(true);
+  EXPECT_TRUE(session_.flow_controller()->overloaded());
+
+  session_.OnServerOverload(false);
+  EXPECT_FALSE(session_.flow_controller()->overloaded());
+}
+
 TEST_P(QuicSessionTestServer, IsClosedStreamDefault) {
   // Ensure that no streams are initially closed.
   QuicStreamId first_stream_id = QuicUtils::GetFirstBidirectionalStreamId(
@@ -1026,6 +1063,47 @@ TEST_P(QuicSessionTestServer, OnCanWrite) {
   EXPECT_TRUE(session_.WillingAndAbleToWrite());
 }
 
+TEST_P(QuicSessionTestServer, WriteAggregationHoldsSmallWrites) {
+  CompleteHandshake();
+  session_.set_write_aggregation_window(QuicTime::Delta::FromMicroseconds(50));
+  TestStream* stream2 = session_.CreateOutgoingBidirectionalStream();
+  TestStream* stream4 = session_.CreateOutgoingBidirectionalStream();
+
+  // Small FIN-less writes outside of OnCanWrite are held back; nothing is
+  // consumed and the data stays buffered in the streams.
+  QuicConsumedData consumed =
+      session_.WritevData(stream2->id(), 5, 0, NO_FIN, NOT_RETRANSMISSION,
+                          ENCRYPTION_FORWARD_SECURE);
+  EXPECT_EQ(0u, consumed.bytes_consumed);
+  consumed = session_.WritevData(stream4->id(), 5, 0, NO_FIN,
+                                 NOT_RETRANSMISSION, ENCRYPTION_FORWARD_SECURE);
+  EXPECT_EQ(0u, consumed.bytes_consumed);
+
+  // A write carrying a FIN bypasses the hold and reaches the connection.
+  struct iovec iov;
+  MakeIOVector("12345", &iov);
+  QuicStreamPeer::SendBuffer(stream2).SaveStreamData(&iov, 1, 0, 5);
+  consumed = session_.WritevData(stream2->id(), 5, 0, FIN, NOT_RETRANSMISSION,
+                                 ENCRYPTION_FORWARD_SECURE);
+  EXPECT_EQ(5u, consumed.bytes_consumed);
+
+  // When the aggregation alarm fires, the held streams get to write within a
+  // single OnCanWrite pass.
+  session_.MarkConnectionLevelWriteBlocked(stream2->id());
+  session_.MarkConnectionLevelWriteBlocked(stream4->id());
+  EXPECT_CALL(*stream2, OnCanWrite());
+  EXPECT_CALL(*stream4, OnCanWrite());
+  session_.OnWriteAggregationAlarm();
+
+  // Disabling the window stops further holds.
+  session_.set_write_aggregation_window(QuicTime::Delta::Zero());
+  MakeIOVector("12345", &iov);
+  QuicStreamPeer::SendBuffer(stream4).SaveStreamData(&iov, 1, 0, 5);
+  consumed = session_.WritevData(stream4->id(), 5, 0, NO_FIN,
+                                 NOT_RETRANSMISSION, ENCRYPTION_FORWARD_SECURE);
+  EXPECT_EQ(5u, consumed.bytes_consumed);
+}
+
 TEST_P(QuicSessionTestServer, TestBatchedWrites) {
   session_.set_writev_consumes_all_data(true);
   TestStream* stream2 = session_.CreateOutgoingBidirectionalStream();
@@ -2462,8 +2540,9 @@ TEST_P(QuicSessionTestServer, OnStreamFrameLost) {
   session_.MarkConnectionLevelWriteBlocked(stream2->id());
   session_.MarkConnectionLevelWriteBlocked(stream4->id());
 
-  // Lost data is retransmitted before new data, and retransmissions for crypto
-  // stream go first.
+  // Crypto retransmissions still go first, but lost data on streams 2 and 4
+  // is serviced through the write blocked list in stream order rather than
+  // ahead of new data.
   // Do not check congestion window when crypto stream has lost data.
   EXPECT_CALL(*send_algorithm, CanSend(_)).Times(0);
   if (!QuicVersionUsesCryptoFrames(connection_->transport_version())) {
@@ -2472,9 +2551,10 @@ TEST_P(QuicSessionTestServer, OnStreamFrameLost) {
         .WillOnce(Return(false));
   }
   // Check congestion window for non crypto streams.
+  // Stream 2 gets the first write slot and retransmits its lost data.
   EXPECT_CALL(*send_algorithm, CanSend(_)).WillOnce(Return(true));
-  EXPECT_CALL(*stream4, OnCanWrite());
-  EXPECT_CALL(*stream4, HasPendingRetransmission()).WillOnce(Return(false));
+  EXPECT_CALL(*stream2, OnCanWrite());
+  EXPECT_CALL(*stream2, HasPendingRetransmission()).WillOnce(Return(false));
   // Connection is blocked.
   EXPECT_CALL(*send_algorithm, CanSend(_)).WillRepeatedly(Return(false));
 
@@ -2482,15 +2562,44 @@ TEST_P(QuicSessionTestServer, OnStreamFrameLost) {
   EXPECT_TRUE(session_.WillingAndAbleToWrite());
 
   // Unblock connection.
-  // Stream 2 retransmits lost data.
-  EXPECT_CALL(*send_algorithm, CanSend(_)).WillOnce(Return(true));
-  EXPECT_CALL(*stream2, OnCanWrite());
-  EXPECT_CALL(*stream2, HasPendingRetransmission()).WillOnce(Return(false));
+  // Stream 4 retransmits lost data from its write slot.
   EXPECT_CALL(*send_algorithm, CanSend(_)).WillOnce(Return(true));
-  // Stream 2 sends new data.
-  EXPECT_CALL(*stream2, OnCanWrite());
+  EXPECT_CALL(*stream4, OnCanWrite());
+  EXPECT_CALL(*stream4, HasPendingRetransmission()).WillOnce(Return(false));
+  EXPECT_CALL(*send_algorithm, OnApplicationLimited(_));
+
+  session_.OnCanWrite();
+  EXPECT_FALSE(session_.WillingAndAbleToWrite());
+}
+
+TEST_P(QuicSessionTestServer, LostDataDoesNotPreemptHigherPriorityStream) {
+  CompleteHandshake();
+  InSequence s;
+
+  // Drive congestion control manually.
+  MockSendAlgorithm* send_algorithm = new StrictMock<MockSendAlgorithm>;
+  QuicConnectionPeer::SetSendAlgorithm(session_.connection(), send_algorithm);
+
+  // Stream 2 is a low priority bulk stream with lost data, stream 4 is a
+  // high priority stream with fresh data.
+  TestStream* stream2 = session_.CreateOutgoingBidirectionalStream();
+  TestStream* stream4 = session_.CreateOutgoingBidirectionalStream();
+  stream2->SetPriority(spdy::SpdyStreamPrecedence(kV3LowestPriority));
+  stream4->SetPriority(spdy::SpdyStreamPrecedence(kV3HighestPriority));
+
+  QuicStreamFrame frame(stream2->id(), false, 0, 9);
+  EXPECT_CALL(*stream2, HasPendingRetransmission()).WillOnce(Return(true));
+  session_.OnFrameLost(QuicFrame(frame));
+  session_.MarkConnectionLevelWriteBlocked(stream4->id());
+  EXPECT_TRUE(session_.WillingAndAbleToWrite());
+
+  // Stream 4's new data goes out first; stream 2's retransmission waits its
+  // turn behind the higher priority stream.
   EXPECT_CALL(*send_algorithm, CanSend(_)).WillOnce(Return(true));
   EXPECT_CALL(*stream4, OnCanWrite());
+  EXPECT_CALL(*send_algorithm, CanSend(_)).WillOnce(Return(true));
+  EXPECT_CALL(*stream2, OnCanWrite());
+  EXPECT_CALL(*stream2, HasPendingRetransmission()).WillOnce(Return(false));
   EXPECT_CALL(*send_algorithm, OnApplicationLimited(_));
 
   session_.OnCanWrite();
@@ -2525,15 +2634,15 @@ TEST_P(QuicSessionTestServer, DonotRetransmitDataOfClosedStreams) {
   EXPECT_CALL(*connection_, OnStreamReset(stream4->id(), _));
   stream4->Reset(QUIC_STREAM_CANCELLED);
 
-  // Verify stream 4 is removed from streams with lost data list.
-  EXPECT_CALL(*stream6, OnCanWrite());
-  EXPECT_CALL(*stream6, HasPendingRetransmission()).WillOnce(Return(false));
-  EXPECT_CALL(*stream2, OnCanWrite());
-  EXPECT_CALL(*stream2, HasPendingRetransmission()).WillOnce(Return(false));
+  // Verify stream 4 is removed from streams with lost data list. The control
+  // frames buffered by the reset go out first, then streams 2 and 6
+  // retransmit lost data from their regular write slots.
   EXPECT_CALL(*connection_, SendControlFrame(_))
       .WillRepeatedly(Invoke(&ClearControlFrame));
   EXPECT_CALL(*stream2, OnCanWrite());
+  EXPECT_CALL(*stream2, HasPendingRetransmission()).WillOnce(Return(false));
   EXPECT_CALL(*stream6, OnCanWrite());
+  EXPECT_CALL(*stream6, HasPendingRetransmission()).WillOnce(Return(false));
   session_.OnCanWrite();
 }
 
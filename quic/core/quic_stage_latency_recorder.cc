@@ -0,0 +1,139 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/quic_stage_latency_recorder.h"
+
+#include <cstring>
+
+#include "absl/strings/str_cat.h"
+#include "common/platform/api/quiche_logging.h"
+#include "common/platform/api/quiche_thread_local.h"
+
+namespace quic {
+
+namespace {
+
+DEFINE_QUICHE_THREAD_LOCAL_POINTER(CurrentStageLatencyRecorder,
+                                   QuicStageLatencyRecorder);
+
+// Returns the index of the bucket holding |sample|.
+size_t BucketFor(QuicTime::Delta sample) {
+  int64_t micros = sample.ToMicroseconds();
+  if (micros <= 0) {
+    return 0;
+  }
+  size_t bucket = 1;
+  while (micros > 1 && bucket < QuicLatencyHistogram::kNumBuckets - 1) {
+    micros >>= 1;
+    ++bucket;
+  }
+  return bucket;
+}
+
+// Returns the upper latency bound of the bucket at |index|.
+QuicTime::Delta BucketUpperBound(size_t index) {
+  if (index == 0) {
+    return QuicTime::Delta::FromMicroseconds(1);
+  }
+  return QuicTime::Delta::FromMicroseconds(int64_t{1} << index);
+}
+
+}  // namespace
+
+void QuicLatencyHistogram::Record(QuicTime::Delta sample) {
+  ++buckets_[BucketFor(sample)];
+  ++total_count_;
+}
+
+QuicTime::Delta QuicLatencyHistogram::ApproximatePercentile(
+    double fraction) const {
+  if (total_count_ == 0) {
+    return QuicTime::Delta::Zero();
+  }
+  uint64_t rank = static_cast<uint64_t>(fraction * total_count_);
+  uint64_t cumulative_count = 0;
+  for (size_t i = 0; i < kNumBuckets; ++i) {
+    cumulative_count += buckets_[i];
+    if (cumulative_count > rank) {
+      return BucketUpperBound(i);
+    }
+  }
+  return BucketUpperBound(kNumBuckets - 1);
+}
+
+void QuicLatencyHistogram::MergeFrom(const QuicLatencyHistogram& other) {
+  for (size_t i = 0; i < kNumBuckets; ++i) {
+    buckets_[i] += other.buckets_[i];
+  }
+  total_count_ += other.total_count_;
+}
+
+void QuicLatencyHistogram::Clear() {
+  memset(buckets_, 0, sizeof(buckets_));
+  total_count_ = 0;
+}
+
+std::string QuicLatencyHistogram::ToString() const {
+  return absl::StrCat(
+      "count: ", total_count_,
+      " p50: ", ApproximatePercentile(0.5).ToMicroseconds(),
+      "us p90: ", ApproximatePercentile(0.9).ToMicroseconds(),
+      "us p99: ", ApproximatePercentile(0.99).ToMicroseconds(), "us");
+}
+
+// static
+const char* QuicStageLatencyRecorder::StageToString(Stage stage) {
+  switch (stage) {
+    case kProcessUdpPacket:
+      return "process_udp_packet";
+    case kDecryptPacket:
+      return "decrypt_packet";
+    case kProcessAckFrame:
+      return "process_ack_frame";
+    case kOnCanWrite:
+      return "on_can_write";
+    case kFlushPacket:
+      return "flush_packet";
+    case kNumStages:
+      break;
+  }
+  return "unknown";
+}
+
+QuicStageLatencyRecorder::QuicStageLatencyRecorder(const QuicClock* clock)
+    : clock_(clock) {
+  QUICHE_DCHECK(clock_);
+}
+
+// static
+QuicStageLatencyRecorder* QuicStageLatencyRecorder::Current() {
+  return GET_QUICHE_THREAD_LOCAL_POINTER(CurrentStageLatencyRecorder);
+}
+
+// static
+void QuicStageLatencyRecorder::Install(QuicStageLatencyRecorder* recorder) {
+  SET_QUICHE_THREAD_LOCAL_POINTER(CurrentStageLatencyRecorder, recorder);
+}
+
+void QuicStageLatencyRecorder::Record(Stage stage, QuicTime::Delta latency) {
+  QUICHE_DCHECK(stage < kNumStages);
+  histograms_[stage].Record(latency);
+}
+
+void QuicStageLatencyRecorder::Clear() {
+  for (QuicLatencyHistogram& histogram : histograms_) {
+    histogram.Clear();
+  }
+}
+
+std::string QuicStageLatencyRecorder::ToString() const {
+  std::string output;
+  for (int i = 0; i < kNumStages; ++i) {
+    absl::StrAppend(&output, StageToString(static_cast<Stage>(i)), " ",
+                    histograms_[i].ToString(), "\n");
+  }
+  return output;
+}
+
+}  // namespace quic
@@ -0,0 +1,119 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/quic_stage_latency_recorder.h"
+
+#include "quic/platform/api/quic_test.h"
+#include "quic/test_tools/mock_clock.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+class QuicLatencyHistogramTest : public QuicTest {
+ protected:
+  QuicLatencyHistogram histogram_;
+};
+
+TEST_F(QuicLatencyHistogramTest, Empty) {
+  EXPECT_EQ(0u, histogram_.total_count());
+  EXPECT_EQ(QuicTime::Delta::Zero(), histogram_.ApproximatePercentile(0.5));
+}
+
+TEST_F(QuicLatencyHistogramTest, Percentiles) {
+  // 90 samples in the [2, 4) microsecond bucket, 10 in the [64, 128) bucket.
+  for (int i = 0; i < 90; ++i) {
+    histogram_.Record(QuicTime::Delta::FromMicroseconds(3));
+  }
+  for (int i = 0; i < 10; ++i) {
+    histogram_.Record(QuicTime::Delta::FromMicroseconds(100));
+  }
+  EXPECT_EQ(100u, histogram_.total_count());
+  EXPECT_EQ(QuicTime::Delta::FromMicroseconds(4),
+            histogram_.ApproximatePercentile(0.5));
+  EXPECT_EQ(QuicTime::Delta::FromMicroseconds(128),
+            histogram_.ApproximatePercentile(0.99));
+}
+
+TEST_F(QuicLatencyHistogramTest, SubMicrosecondAndOversizedSamples) {
+  histogram_.Record(QuicTime::Delta::Zero());
+  // Larger than the range covered by the buckets; lands in the last bucket.
+  histogram_.Record(QuicTime::Delta::FromSeconds(10));
+  EXPECT_EQ(2u, histogram_.total_count());
+  EXPECT_EQ(QuicTime::Delta::FromMicroseconds(1),
+            histogram_.ApproximatePercentile(0.0));
+  EXPECT_EQ(QuicTime::Delta::FromMicroseconds(
+                int64_t{1} << (QuicLatencyHistogram::kNumBuckets - 1)),
+            histogram_.ApproximatePercentile(0.99));
+}
+
+TEST_F(QuicLatencyHistogramTest, MergeAndClear) {
+  histogram_.Record(QuicTime::Delta::FromMicroseconds(3));
+
+  QuicLatencyHistogram other;
+  other.Record(QuicTime::Delta::FromMicroseconds(3));
+  other.MergeFrom(histogram_);
+  EXPECT_EQ(2u, other.total_count());
+
+  other.Clear();
+  EXPECT_EQ(0u, other.total_count());
+  EXPECT_EQ(1u, histogram_.total_count());
+}
+
+class QuicStageLatencyRecorderTest : public QuicTest {
+ protected:
+  QuicStageLatencyRecorderTest() : recorder_(&clock_) {}
+
+  ~QuicStageLatencyRecorderTest() override {
+    QuicStageLatencyRecorder::Install(nullptr);
+  }
+
+  MockClock clock_;
+  QuicStageLatencyRecorder recorder_;
+};
+
+TEST_F(QuicStageLatencyRecorderTest, NoRecorderInstalled) {
+  EXPECT_EQ(nullptr, QuicStageLatencyRecorder::Current());
+  {
+    // Must be a no-op.
+    QuicScopedStageLatencySampler sampler(
+        QuicStageLatencyRecorder::kProcessUdpPacket);
+  }
+  EXPECT_EQ(0u, recorder_.histogram(QuicStageLatencyRecorder::kProcessUdpPacket)
+                    .total_count());
+}
+
+TEST_F(QuicStageLatencyRecorderTest, ScopedSampler) {
+  QuicStageLatencyRecorder::Install(&recorder_);
+  EXPECT_EQ(&recorder_, QuicStageLatencyRecorder::Current());
+  {
+    QuicScopedStageLatencySampler sampler(
+        QuicStageLatencyRecorder::kDecryptPacket);
+    clock_.AdvanceTime(QuicTime::Delta::FromMicroseconds(3));
+  }
+  EXPECT_EQ(1u, recorder_.histogram(QuicStageLatencyRecorder::kDecryptPacket)
+                    .total_count());
+  EXPECT_EQ(QuicTime::Delta::FromMicroseconds(4),
+            recorder_.histogram(QuicStageLatencyRecorder::kDecryptPacket)
+                .ApproximatePercentile(0.5));
+  // Other stages are untouched.
+  EXPECT_EQ(0u, recorder_.histogram(QuicStageLatencyRecorder::kProcessUdpPacket)
+                    .total_count());
+}
+
+TEST_F(QuicStageLatencyRecorderTest, ToStringCoversAllStages) {
+  recorder_.Record(QuicStageLatencyRecorder::kOnCanWrite,
+                   QuicTime::Delta::FromMicroseconds(10));
+  std::string output = recorder_.ToString();
+  for (int i = 0; i < QuicStageLatencyRecorder::kNumStages; ++i) {
+    EXPECT_NE(std::string::npos,
+              output.find(QuicStageLatencyRecorder::StageToString(
+                  static_cast<QuicStageLatencyRecorder::Stage>(i))))
+        << i;
+  }
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
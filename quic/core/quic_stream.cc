@@ -365,8 +365,12 @@ QuicStream::QuicStream(QuicStreamId id, QuicSession* session,
       send_buffer_(
           session->connection()->helper()->GetStreamSendBufferAllocator()),
       buffered_data_threshold_(GetQuicFlag(FLAGS_quic_buffered_data_threshold)),
+      send_buffer_low_watermark_(0),
+      send_buffer_high_watermark_(0),
+      send_buffer_above_high_watermark_(false),
       is_static_(is_static),
       deadline_(QuicTime::Zero()),
+      delivery_deadline_(QuicTime::Zero()),
       was_draining_(false),
       type_(VersionHasIetfQuicFrames(session->transport_version()) &&
                     type != CRYPTO
@@ -485,6 +489,49 @@ void QuicStream::OnStreamFrame(const QuicStreamFrame& frame) {
   }
 
   sequencer_.OnStreamFrame(frame);
+
+  if (data_sink_ != nullptr && !read_side_closed_) {
+    // The frame may have filled a hole; feed any newly contiguous buffered
+    // data to the sink.
+    DrainSequencerIntoSink();
+  }
+}
+
+void QuicStream::set_data_sink(QuicStreamDataSink* sink) {
+  data_sink_ = sink;
+  if (data_sink_ != nullptr && !read_side_closed_ &&
+      sequencer_.HasBytesToRead()) {
+    DrainSequencerIntoSink();
+  }
+}
+
+size_t QuicStream::OnInOrderDataAvailable(absl::string_view data) {
+  if (data_sink_ == nullptr || read_side_closed_) {
+    return 0;
+  }
+  return data_sink_->OnStreamData(id_, data);
+}
+
+void QuicStream::DrainSequencerIntoSink() {
+  QUICHE_DCHECK(data_sink_ != nullptr);
+  iovec iov;
+  while (sequencer_.GetReadableRegion(&iov)) {
+    const size_t accepted = data_sink_->OnStreamData(
+        id_, absl::string_view(static_cast<const char*>(iov.iov_base),
+                               iov.iov_len));
+    QUICHE_DCHECK_LE(accepted, iov.iov_len);
+    if (accepted > 0) {
+      sequencer_.MarkConsumed(accepted);
+    }
+    if (accepted < iov.iov_len) {
+      // The sink cannot accept more right now. The rest stays buffered and
+      // is offered again when the next frame arrives.
+      return;
+    }
+  }
+  if (sequencer_.IsClosed()) {
+    OnFinRead();
+  }
 }
 
 bool QuicStream::OnStopSending(QuicResetStreamError error) {
@@ -586,6 +633,9 @@ void QuicStream::OnFinRead() {
   // OnFinRead can be called due to a FIN flag in a headers block, so there may
   // have been no OnStreamFrame call with a FIN in the frame.
   fin_received_ = true;
+  if (data_sink_ != nullptr) {
+    data_sink_->OnFinConsumed(id_);
+  }
   // If fin_sent_ is true, then CloseWriteSide has already been called, and the
   // stream will be destroyed by CloseReadSide, so don't need to call
   // StreamDraining.
@@ -653,6 +703,16 @@ void QuicStream::SetPriority(const spdy::SpdyStreamPrecedence& precedence) {
   stream_delegate_->UpdateStreamPriority(id(), precedence);
 }
 
+void QuicStream::SetQosClass(QuicQosClass qos_class) {
+  qos_class_ = qos_class;
+  if (qos_class == QOS_CLASS_EXPEDITED) {
+    // Expedited packets should also be first in line for internal
+    // scheduling; a wire marking alone would leave them queued behind
+    // best-effort streams in the write blocked list.
+    SetPriority(spdy::SpdyStreamPrecedence(spdy::kV3HighestPriority));
+  }
+}
+
 void QuicStream::WriteOrBufferData(
     absl::string_view data, bool fin,
     QuicReferenceCountedPointer<QuicAckListenerInterface> ack_listener) {
@@ -704,7 +764,11 @@ void QuicStream::WriteOrBufferDataAtLevel(
       return;
     }
     send_buffer_.SaveStreamData(&iov, 1, 0, data.length());
+    latency_tracker_.OnDataBuffered(
+        offset, data.length(), ack_listener,
+        session()->connection()->clock()->ApproximateNow());
     OnDataBuffered(offset, data.length(), ack_listener);
+    MaybeSignalSendBufferWatermark();
   }
   if (!had_buffered_data && (HasBufferedData() || fin_buffered_)) {
     // Write data if there is no buffered data before.
@@ -720,7 +784,12 @@ void QuicStream::OnCanWrite() {
   if (HasPendingRetransmission()) {
     WritePendingRetransmission();
     // Exit early to allow other streams to write pending retransmissions if
-    // any.
+    // any. If the retransmissions drained and new data remains buffered,
+    // re-register for another write slot at this stream's priority.
+    if (!HasPendingRetransmission() && !write_side_closed_ &&
+        (HasBufferedData() || (fin_buffered_ && !fin_sent_))) {
+      session_->MarkConnectionLevelWriteBlocked(id_);
+    }
     return;
   }
 
@@ -808,6 +877,62 @@ QuicConsumedData QuicStream::WriteMemSlices(absl::Span<QuicMemSlice> span,
         return consumed_data;
       }
       OnDataBuffered(offset, consumed_data.bytes_consumed, nullptr);
+      MaybeSignalSendBufferWatermark();
+    }
+  }
+  fin_buffered_ = consumed_data.fin_consumed;
+
+  if (!had_buffered_data && (HasBufferedData() || fin_buffered_)) {
+    // Write data if there is no buffered data before.
+    WriteBufferedData(session()->GetEncryptionLevelToSendApplicationData());
+  }
+
+  return consumed_data;
+}
+
+QuicConsumedData QuicStream::WriteExternalBuffer(
+    QuicReferenceCountedPointer<QuicExternalSendBuffer> buffer, bool fin) {
+  QuicConsumedData consumed_data(0, false);
+  const bool empty = buffer == nullptr || buffer->length() == 0;
+  if (empty && !fin) {
+    QUIC_BUG(quic_bug_write_empty_external_buffer) << "empty buffer && !fin";
+    return consumed_data;
+  }
+
+  if (fin_buffered_) {
+    QUIC_BUG(quic_bug_external_buffer_fin_buffered) << "Fin already buffered";
+    return consumed_data;
+  }
+
+  if (write_side_closed_) {
+    QUIC_DLOG(ERROR) << ENDPOINT << "Stream " << id()
+                     << " attempting to write when the write side is closed";
+    if (type_ == READ_UNIDIRECTIONAL) {
+      OnUnrecoverableError(QUIC_TRY_TO_WRITE_DATA_ON_READ_UNIDIRECTIONAL_STREAM,
+                           "Try to send data on read unidirectional stream");
+    }
+    return consumed_data;
+  }
+
+  bool had_buffered_data = HasBufferedData();
+  if (CanWriteNewData() || empty) {
+    consumed_data.fin_consumed = fin;
+    if (!empty) {
+      const QuicByteCount length = buffer->length();
+      QuicStreamOffset offset = send_buffer_.stream_offset();
+      send_buffer_.SaveExternalBuffer(std::move(buffer));
+      consumed_data.bytes_consumed = length;
+      if (offset > send_buffer_.stream_offset() ||
+          kMaxStreamLength < send_buffer_.stream_offset()) {
+        QUIC_BUG(quic_bug_external_buffer_length_overflow)
+            << "Write too many data via stream " << id_;
+        OnUnrecoverableError(
+            QUIC_STREAM_LENGTH_OVERFLOW,
+            absl::StrCat("Write too many data via stream ", id_));
+        return consumed_data;
+      }
+      OnDataBuffered(offset, consumed_data.bytes_consumed, nullptr);
+      MaybeSignalSendBufferWatermark();
     }
   }
   fin_buffered_ = consumed_data.fin_consumed;
@@ -1019,14 +1144,17 @@ void QuicStream::AddBytesConsumed(QuicByteCount bytes) {
         << "AddBytesConsumed called on non-crypto stream without flow control";
     return;
   }
+  // Adjust the connection level flow controller first: its window gates
+  // every stream, so its WINDOW_UPDATE should precede any stream-level
+  // update generated by the same consumption.
+  if (stream_contributes_to_connection_flow_control_) {
+    connection_flow_controller_->AddBytesConsumed(bytes);
+  }
+
   // Only adjust stream level flow controller if still reading.
   if (!read_side_closed_) {
     flow_controller_->AddBytesConsumed(bytes);
   }
-
-  if (stream_contributes_to_connection_flow_control_) {
-    connection_flow_controller_->AddBytesConsumed(bytes);
-  }
 }
 
 bool QuicStream::MaybeConfigSendWindowOffset(QuicStreamOffset new_offset,
@@ -1096,6 +1224,11 @@ bool QuicStream::OnStreamFrameAcked(QuicStreamOffset offset,
     OnUnrecoverableError(QUIC_INTERNAL_ERROR, "Trying to ack unsent data.");
     return false;
   }
+  if (latency_tracker_.HasStamps()) {
+    latency_tracker_.OnDataAcked(
+        send_buffer_.bytes_acked(),
+        session()->connection()->clock()->ApproximateNow());
+  }
   if (!fin_sent_ && fin_acked) {
     OnUnrecoverableError(QUIC_INTERNAL_ERROR, "Trying to ack unsent fin.");
     return false;
@@ -1316,6 +1449,55 @@ uint64_t QuicStream::BufferedDataBytes() const {
   return send_buffer_.stream_offset() - stream_bytes_written();
 }
 
+void QuicStream::SetSendBufferWatermarks(QuicByteCount low_watermark,
+                                         QuicByteCount high_watermark) {
+  QUICHE_DCHECK_LE(low_watermark, high_watermark);
+  send_buffer_low_watermark_ = low_watermark;
+  send_buffer_high_watermark_ = high_watermark;
+  send_buffer_above_high_watermark_ = false;
+  MaybeSignalSendBufferWatermark();
+}
+
+void QuicStream::MaybeSignalSendBufferWatermark() {
+  if (send_buffer_high_watermark_ == 0) {
+    return;
+  }
+  const QuicByteCount buffered = BufferedDataBytes();
+  if (!send_buffer_above_high_watermark_ &&
+      buffered >= send_buffer_high_watermark_) {
+    send_buffer_above_high_watermark_ = true;
+    OnSendBufferHighWatermark();
+  } else if (send_buffer_above_high_watermark_ &&
+             buffered <= send_buffer_low_watermark_) {
+    send_buffer_above_high_watermark_ = false;
+    OnSendBufferLowWatermark();
+  }
+}
+
+QuicByteCount QuicStream::GetMemoryFootprint() const {
+  return BufferedDataBytes() + send_buffer_.stream_bytes_outstanding() +
+         sequencer_.NumBytesAllocated();
+}
+
+void QuicStream::OnMemoryPressure() {
+  if (flow_controller_.has_value()) {
+    flow_controller_->DisableReceiveWindowAutoTuning();
+  }
+}
+
+void QuicStream::EnableConsumptionRateTuning() {
+  if (flow_controller_.has_value()) {
+    flow_controller_->EnableConsumptionRateTuning();
+  }
+}
+
+QuicBandwidth QuicStream::consumption_rate() const {
+  if (!flow_controller_.has_value()) {
+    return QuicBandwidth::Zero();
+  }
+  return flow_controller_->consumption_rate();
+}
+
 bool QuicStream::CanWriteNewData() const {
   return BufferedDataBytes() < buffered_data_threshold_;
 }
@@ -1334,6 +1516,12 @@ const QuicIntervalSet<QuicStreamOffset>& QuicStream::bytes_acked() const {
 
 void QuicStream::OnStreamDataConsumed(QuicByteCount bytes_consumed) {
   send_buffer_.OnStreamDataConsumed(bytes_consumed);
+  if (latency_tracker_.HasStamps()) {
+    latency_tracker_.OnDataConsumed(
+        send_buffer_.stream_bytes_written(),
+        session()->connection()->clock()->ApproximateNow());
+  }
+  MaybeSignalSendBufferWatermark();
 }
 
 void QuicStream::WritePendingRetransmission() {
@@ -1391,6 +1579,16 @@ bool QuicStream::MaybeSetTtl(QuicTime::Delta ttl) {
   return true;
 }
 
+void QuicStream::SetDeliveryDeadline(QuicTime deadline) {
+  if (is_static_) {
+    QUIC_BUG(quic_set_delivery_deadline_static)
+        << "Cannot set delivery deadline of a static stream.";
+    return;
+  }
+  delivery_deadline_ = deadline;
+  session()->OnStreamDeliveryDeadlineSet(id_, deadline);
+}
+
 bool QuicStream::HasDeadlinePassed() const {
   if (!deadline_.IsInitialized()) {
     // No deadline has been set.
@@ -26,11 +26,14 @@
 #include "absl/types/optional.h"
 #include "absl/types/span.h"
 #include "quic/core/frames/quic_rst_stream_frame.h"
+#include "quic/core/quic_bandwidth.h"
 #include "quic/core/quic_error_codes.h"
 #include "quic/core/quic_flow_controller.h"
 #include "quic/core/quic_packets.h"
+#include "quic/core/quic_stream_latency_tracker.h"
 #include "quic/core/quic_stream_send_buffer.h"
 #include "quic/core/quic_stream_sequencer.h"
+#include "quic/core/quic_stream_slab_allocator.h"
 #include "quic/core/quic_types.h"
 #include "quic/core/session_notifier_interface.h"
 #include "quic/core/stream_delegate_interface.h"
@@ -48,6 +51,28 @@ class QuicStreamPeer;
 class QuicSession;
 class QuicStream;
 
+// Destination for a stream's incoming data, registered via
+// QuicStream::set_data_sink(). While a sink is registered, in-order data is
+// handed to it directly from the decrypted packet, and the sequencer's
+// receive buffer holds only data behind out-of-order holes. This enables
+// splice-like flows, e.g. writing request bodies straight to a file or
+// forwarding them onto another stream, without staging every byte in the
+// receive buffer first.
+class QUIC_EXPORT_PRIVATE QuicStreamDataSink {
+ public:
+  virtual ~QuicStreamDataSink() = default;
+
+  // Called with the next in-order chunk of stream data. Returns the number
+  // of bytes accepted; bytes not accepted stay buffered in the sequencer and
+  // are redelivered when more data arrives. |data| is only valid for the
+  // duration of the call.
+  virtual size_t OnStreamData(QuicStreamId id, absl::string_view data) = 0;
+
+  // Called once all data up to and including the FIN has been delivered to
+  // the sink.
+  virtual void OnFinConsumed(QuicStreamId /*id*/) {}
+};
+
 // Buffers frames for a stream until the first byte of that frame arrives.
 class QUIC_EXPORT_PRIVATE PendingStream
     : public QuicStreamSequencer::StreamInterface {
@@ -161,6 +186,19 @@ class QUIC_EXPORT_PRIVATE QuicStream
 
   virtual ~QuicStream();
 
+  // Stream objects are created and destroyed at request rates, so their
+  // memory is routed through QuicStreamSlabAllocator, which recycles the
+  // blocks of closed streams. Inherited by all stream subclasses; placement
+  // new is unaffected.
+  static void* operator new(size_t size) {
+    return QuicStreamSlabAllocator::Allocate(size);
+  }
+  static void* operator new(size_t /*size*/, void* ptr) { return ptr; }
+  static void operator delete(void* ptr) {
+    QuicStreamSlabAllocator::Release(ptr);
+  }
+  static void operator delete(void* /*ptr*/, void* /*place*/) {}
+
   // Default priority for IETF QUIC, defined by the priority extension at
   // https://httpwg.org/http-extensions/draft-ietf-httpbis-priority.html#urgency.
   static const int kDefaultUrgency = 3;
@@ -222,6 +260,15 @@ class QUIC_EXPORT_PRIVATE QuicStream
   // PRIORITY_UPDATE frame.
   void SetPriority(const spdy::SpdyStreamPrecedence& precedence);
 
+  // The stream's QoS class, used to DSCP-mark packets carrying this stream's
+  // data on DiffServ-managed networks. Defaults to best effort.
+  QuicQosClass qos_class() const { return qos_class_; }
+
+  // Sets the stream's QoS class. Setting QOS_CLASS_EXPEDITED also raises the
+  // stream to the highest internal scheduling priority, so EF-marked packets
+  // are not queued behind best-effort data inside the connection.
+  void SetQosClass(QuicQosClass qos_class);
+
   // Returns true if this stream is still waiting for acks of sent data.
   // This will return false if all data has been acked, or if the stream
   // is no longer interested in data being acked (which happens when
@@ -255,6 +302,25 @@ class QUIC_EXPORT_PRIVATE QuicStream
 
   uint64_t BufferedDataBytes() const;
 
+  // Configures edge-triggered watermarks on the number of bytes buffered in
+  // the send buffer but not yet consumed. OnSendBufferHighWatermark is called
+  // when buffered bytes rise to or above |high_watermark|;
+  // OnSendBufferLowWatermark is called once buffered bytes then drain back to
+  // or below |low_watermark|. Both are invoked inline from the write and
+  // consume paths without allocation. Requires |low_watermark| <=
+  // |high_watermark|; a |high_watermark| of zero disables signaling.
+  void SetSendBufferWatermarks(QuicByteCount low_watermark,
+                               QuicByteCount high_watermark);
+
+  // Returns an estimate of the heap memory retained by this stream: data
+  // buffered in the send buffer but not yet acked, plus blocks allocated by
+  // the sequencer for out-of-order receive data.
+  QuicByteCount GetMemoryFootprint() const;
+
+  // Called by the session when the process is under memory pressure. Stops
+  // the stream's receive window from auto-tuning upwards.
+  void OnMemoryPressure();
+
   uint64_t stream_bytes_read() const { return stream_bytes_read_; }
   uint64_t stream_bytes_written() const;
 
@@ -272,6 +338,15 @@ class QUIC_EXPORT_PRIVATE QuicStream
   QuicStreamOffset highest_received_byte_offset() const;
   void UpdateReceiveWindowSize(QuicStreamOffset size);
 
+  // Switches the stream's receive window from doubling on fast growth to
+  // tracking the application's observed read rate. Useful for proxies, where
+  // a slow upstream should not cause megabytes of data to be buffered.
+  void EnableConsumptionRateTuning();
+
+  // The application's observed read rate on this stream. Zero unless
+  // consumption-rate tuning is enabled and an estimate has formed.
+  QuicBandwidth consumption_rate() const;
+
   // Called when endpoint receives a frame which could increase the highest
   // offset.
   // Returns true if the highest offset did increase.
@@ -361,6 +436,14 @@ class QUIC_EXPORT_PRIVATE QuicStream
   // succeeds.
   bool MaybeSetTtl(QuicTime::Delta ttl);
 
+  // Sets the delivery deadline of this stream.  The session serves streams
+  // whose deadline is nearest ahead of the regular priority order, and lets
+  // the pacer skip its delay when honoring it would miss the deadline.  Pass
+  // QuicTime::Zero() to clear.  Must not be called on a static stream.
+  void SetDeliveryDeadline(QuicTime deadline);
+
+  QuicTime delivery_deadline() const { return delivery_deadline_; }
+
   // Commits data into the stream write buffer, and potentially sends it over
   // the wire.  This method has all-or-nothing semantics: if the write buffer is
   // not full, all of the memslices in |span| are moved into it; otherwise,
@@ -368,6 +451,16 @@ class QUIC_EXPORT_PRIVATE QuicStream
   QuicConsumedData WriteMemSlices(absl::Span<QuicMemSlice> span, bool fin);
   QuicConsumedData WriteMemSlice(QuicMemSlice span, bool fin);
 
+  // Zero-copy variant of WriteMemSlices: pins |buffer| in the stream write
+  // buffer without copying its bytes, and potentially sends it over the
+  // wire. Has the same all-or-nothing semantics: if the write buffer is
+  // full, nothing is consumed and the caller should retry after
+  // OnCanWriteNewData(). The application memory viewed by |buffer| must
+  // remain valid and unchanged until the last reference to |buffer| is
+  // dropped, which happens once all of its bytes are acked.
+  QuicConsumedData WriteExternalBuffer(
+      QuicReferenceCountedPointer<QuicExternalSendBuffer> buffer, bool fin);
+
   // Returns true if any stream data is lost (including fin) and needs to be
   // retransmitted.
   virtual bool HasPendingRetransmission() const;
@@ -403,6 +496,19 @@ class QUIC_EXPORT_PRIVATE QuicStream
   // indicating it can start processing data.
   void OnStreamCreatedFromPendingStream();
 
+  // Releases the sequencer's receive buffer if it holds no data. The buffer
+  // is reallocated when new data arrives. Called by the session when idle
+  // connection memory gets reclaimed.
+  void ReleaseSequencerBufferIfEmpty() { sequencer_.ReleaseBufferIfEmpty(); }
+
+  // Registers |sink| to receive this stream's incoming data in order,
+  // bypassing the sequencer's receive buffer for data that arrives in order.
+  // Data already buffered is drained into the sink immediately. |sink| is
+  // not owned and must outlive the stream; pass nullptr to unregister.
+  // While a sink is registered, readable data is consumed by the sink before
+  // OnDataAvailable-driven reads see it.
+  void set_data_sink(QuicStreamDataSink* sink);
+
  protected:
   // Called when data of [offset, offset + data_length] is buffered in send
   // buffer.
@@ -424,6 +530,13 @@ class QUIC_EXPORT_PRIVATE QuicStream
   // Called when upper layer can write new data.
   virtual void OnCanWriteNewData() {}
 
+  // Edge-triggered notifications for the watermarks configured with
+  // SetSendBufferWatermarks. OnSendBufferHighWatermark is called when
+  // buffered bytes cross above the high watermark; OnSendBufferLowWatermark
+  // when they subsequently drain below the low watermark.
+  virtual void OnSendBufferHighWatermark() {}
+  virtual void OnSendBufferLowWatermark() {}
+
   // Called when |bytes_consumed| bytes has been consumed.
   virtual void OnStreamDataConsumed(QuicByteCount bytes_consumed);
 
@@ -492,6 +605,10 @@ class QUIC_EXPORT_PRIVATE QuicStream
   absl::optional<QuicByteCount> GetSendWindow() const;
   absl::optional<QuicByteCount> GetReceiveWindow() const;
 
+  // QuicStreamSequencer::StreamInterface implementation. Hands data arriving
+  // exactly in order to the registered sink, skipping the receive buffer.
+  size_t OnInOrderDataAvailable(absl::string_view data) override;
+
  private:
   friend class test::QuicStreamPeer;
   friend class QuicStreamUtils;
@@ -520,6 +637,15 @@ class QUIC_EXPORT_PRIVATE QuicStream
   // Returns true if deadline_ has passed.
   bool HasDeadlinePassed() const;
 
+  // Fires OnSendBufferHighWatermark or OnSendBufferLowWatermark if buffered
+  // bytes crossed the corresponding watermark.
+  void MaybeSignalSendBufferWatermark();
+
+  // Feeds readable sequencer data (accumulated behind out-of-order holes) to
+  // |data_sink_| and marks what the sink accepts as consumed. Calls
+  // OnFinRead() once the sink has consumed everything up to the FIN.
+  void DrainSequencerIntoSink();
+
   QuicStreamSequencer sequencer_;
   QuicStreamId id_;
   // Pointer to the owning QuicSession object.
@@ -528,6 +654,9 @@ class QUIC_EXPORT_PRIVATE QuicStream
   StreamDelegateInterface* stream_delegate_;
   // The precedence of the stream, once parsed.
   spdy::SpdyStreamPrecedence precedence_;
+
+  // QoS class used to mark packets carrying this stream's data.
+  QuicQosClass qos_class_ = QOS_CLASS_DEFAULT;
   // Bytes read refers to payload bytes only: they do not include framing,
   // encryption overhead etc.
   uint64_t stream_bytes_read_;
@@ -595,9 +724,21 @@ class QUIC_EXPORT_PRIVATE QuicStream
   // or discarded.
   QuicStreamSendBuffer send_buffer_;
 
+  // Stamps data written with an ack listener attached and reports a latency
+  // breakdown to the listener when the data is acked.
+  QuicStreamLatencyTracker latency_tracker_;
+
   // Latched value of quic_buffered_data_threshold.
   const QuicByteCount buffered_data_threshold_;
 
+  // Edge-triggered send buffer watermarks; see SetSendBufferWatermarks. A
+  // high watermark of zero disables signaling.
+  QuicByteCount send_buffer_low_watermark_;
+  QuicByteCount send_buffer_high_watermark_;
+  // True after OnSendBufferHighWatermark fired, until buffered bytes drain
+  // back below the low watermark.
+  bool send_buffer_above_high_watermark_;
+
   // If true, then this stream has precedence over other streams for write
   // scheduling.
   const bool is_static_;
@@ -605,6 +746,10 @@ class QUIC_EXPORT_PRIVATE QuicStream
   // If initialized, reset this stream at this deadline.
   QuicTime deadline_;
 
+  // If initialized, serve this stream's pending data early enough that it can
+  // be delivered by this deadline.
+  QuicTime delivery_deadline_;
+
   // True if this stream has entered draining state.
   bool was_draining_;
 
@@ -615,6 +760,10 @@ class QUIC_EXPORT_PRIVATE QuicStream
   // Creation time of this stream, as reported by the QuicClock.
   const QuicTime creation_time_;
 
+  // If not null, incoming data is handed to this sink instead of
+  // accumulating in the sequencer. Not owned.
+  QuicStreamDataSink* data_sink_ = nullptr;
+
   Perspective perspective_;
 };
 
@@ -99,6 +99,27 @@ void QuicStreamIdManager::SetMaxOpenIncomingStreams(
   incoming_initial_max_open_streams_ = max_open_streams;
 }
 
+void QuicStreamIdManager::MaybeRaiseMaxOpenIncomingStreams(
+    QuicStreamCount max_open_streams) {
+  if (max_open_streams <= incoming_initial_max_open_streams_) {
+    return;
+  }
+  const QuicStreamCount delta =
+      max_open_streams - incoming_initial_max_open_streams_;
+  incoming_initial_max_open_streams_ = max_open_streams;
+  incoming_actual_max_streams_ = std::min(
+      QuicUtils::GetMaxStreamCount(), incoming_actual_max_streams_ + delta);
+  QUIC_DLOG(INFO) << absl::StrCat(
+      unidirectional_ ? "unidirectional " : "bidirectional: ",
+      "incoming stream limit raised to ", max_open_streams,
+      " on a live connection");
+  if (incoming_advertised_max_streams_ < incoming_actual_max_streams_) {
+    // The actual maximum may not have moved if it was already pegged at the
+    // implementation limit; only advertise when there is news.
+    SendMaxStreamsFrame();
+  }
+}
+
 void QuicStreamIdManager::MaybeSendMaxStreamsFrame() {
   int divisor = GetQuicFlag(FLAGS_quic_max_streams_window_divisor);
 
@@ -80,6 +80,13 @@ class QUIC_EXPORT_PRIVATE QuicStreamIdManager {
 
   void SetMaxOpenIncomingStreams(QuicStreamCount max_open_streams);
 
+  // Raises the incoming stream limit to |max_open_streams| on a live
+  // connection and advertises the new limit with a MAX_STREAMS frame, unlike
+  // SetMaxOpenIncomingStreams which may only run before any stream exists.
+  // Values at or below the current limit are ignored: an advertised limit
+  // cannot be retracted.
+  void MaybeRaiseMaxOpenIncomingStreams(QuicStreamCount max_open_streams);
+
   // Called on |max_open_streams| outgoing streams can be created because of 1)
   // config negotiated or 2) MAX_STREAMS received. Returns true if new
   // streams can be created.
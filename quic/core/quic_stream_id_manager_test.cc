@@ -127,6 +127,35 @@ TEST_P(QuicStreamIdManagerTest, CheckMaxStreamsWindowForSingleStream) {
   EXPECT_EQ(1u, stream_id_manager_.incoming_actual_max_streams());
 }
 
+TEST_P(QuicStreamIdManagerTest, MaybeRaiseMaxOpenIncomingStreams) {
+  const QuicStreamCount initial_limit =
+      stream_id_manager_.incoming_initial_max_open_streams();
+
+  // Open a stream so SetMaxOpenIncomingStreams is no longer usable; the
+  // raise path must work on a live connection.
+  EXPECT_TRUE(stream_id_manager_.MaybeIncreaseLargestPeerStreamId(
+      GetNthIncomingStreamId(0), nullptr));
+
+  // Raising the limit advertises the new actual maximum immediately.
+  EXPECT_CALL(delegate_,
+              SendMaxStreams(initial_limit + 10, IsUnidirectional()));
+  stream_id_manager_.MaybeRaiseMaxOpenIncomingStreams(initial_limit + 10);
+  EXPECT_EQ(initial_limit + 10,
+            stream_id_manager_.incoming_initial_max_open_streams());
+  EXPECT_EQ(initial_limit + 10,
+            stream_id_manager_.incoming_actual_max_streams());
+  EXPECT_EQ(initial_limit + 10,
+            stream_id_manager_.incoming_advertised_max_streams());
+
+  // Values at or below the current limit are ignored; an advertised limit
+  // cannot be retracted.
+  EXPECT_CALL(delegate_, SendMaxStreams(_, _)).Times(0);
+  stream_id_manager_.MaybeRaiseMaxOpenIncomingStreams(initial_limit + 10);
+  stream_id_manager_.MaybeRaiseMaxOpenIncomingStreams(initial_limit);
+  EXPECT_EQ(initial_limit + 10,
+            stream_id_manager_.incoming_initial_max_open_streams());
+}
+
 TEST_P(QuicStreamIdManagerTest, CheckMaxStreamsBadValuesOverMaxFailsOutgoing) {
   QuicStreamCount implementation_max = QuicUtils::GetMaxStreamCount();
   // Ensure that the limit is less than the implementation maximum.
@@ -0,0 +1,64 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/quic_stream_latency_tracker.h"
+
+#include <utility>
+
+#include "quic/platform/api/quic_logging.h"
+
+namespace quic {
+
+void QuicStreamLatencyTracker::OnDataBuffered(
+    QuicStreamOffset offset, QuicByteCount length,
+    QuicReferenceCountedPointer<QuicAckListenerInterface> ack_listener,
+    QuicTime now) {
+  if (ack_listener == nullptr || length == 0) {
+    return;
+  }
+  Stamp stamp;
+  stamp.range = QuicInterval<QuicStreamOffset>(offset, offset + length);
+  stamp.write_time = now;
+  stamp.ack_listener = std::move(ack_listener);
+  stamps_.push_back(std::move(stamp));
+}
+
+void QuicStreamLatencyTracker::OnDataConsumed(QuicStreamOffset bytes_written,
+                                              QuicTime now) {
+  // Stream data is written to the wire in offset order, so only stamps at the
+  // front of the deque can be affected.
+  for (Stamp& stamp : stamps_) {
+    if (stamp.range.min() >= bytes_written) {
+      break;
+    }
+    if (!stamp.head_of_buffer_time.IsInitialized()) {
+      stamp.head_of_buffer_time = now;
+    }
+    if (!stamp.sent_time.IsInitialized() &&
+        stamp.range.max() <= bytes_written) {
+      stamp.sent_time = now;
+    }
+  }
+}
+
+void QuicStreamLatencyTracker::OnDataAcked(
+    const QuicIntervalSet<QuicStreamOffset>& bytes_acked, QuicTime now) {
+  while (!stamps_.empty()) {
+    const Stamp& stamp = stamps_.front();
+    if (!stamp.sent_time.IsInitialized() ||
+        !bytes_acked.Contains(stamp.range.min(), stamp.range.max())) {
+      // Breakdowns are emitted in offset order, so an out-of-order ack of a
+      // later range is reported once earlier ranges complete.
+      return;
+    }
+    stamp.ack_listener->OnDataLatencyBreakdown(
+        stamp.range.Length(),
+        /*queued=*/stamp.head_of_buffer_time - stamp.write_time,
+        /*paced=*/stamp.sent_time - stamp.head_of_buffer_time,
+        /*in_flight=*/now - stamp.sent_time);
+    stamps_.pop_front();
+  }
+}
+
+}  // namespace quic
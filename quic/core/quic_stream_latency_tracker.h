@@ -0,0 +1,72 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_QUIC_STREAM_LATENCY_TRACKER_H_
+#define QUICHE_QUIC_CORE_QUIC_STREAM_LATENCY_TRACKER_H_
+
+#include "quic/core/quic_ack_listener_interface.h"
+#include "quic/core/quic_interval.h"
+#include "quic/core/quic_interval_set.h"
+#include "quic/core/quic_time.h"
+#include "quic/core/quic_types.h"
+#include "quic/platform/api/quic_export.h"
+#include "quic/platform/api/quic_reference_counted.h"
+#include "common/quiche_circular_deque.h"
+
+namespace quic {
+
+// QuicStreamLatencyTracker answers "where did this write's latency go?" for
+// stream data written with an ack listener attached. Each write is stamped as
+// a single range, so the cost is one record per write call rather than per
+// byte. A range passes through three phases, reported to the listener via
+// OnDataLatencyBreakdown once the range is fully acked:
+//  - queued: from the application write until the range reaches the head of
+//    the send buffer.
+//  - paced: from the head of the send buffer until the range is fully
+//    written to the wire.
+//  - in flight: from the last byte being written until the range is fully
+//    acked; retransmissions are not tracked separately, so lost data
+//    reports a longer in-flight phase.
+class QUIC_EXPORT_PRIVATE QuicStreamLatencyTracker {
+ public:
+  // Called when [offset, offset + length) is saved into the send buffer with
+  // |ack_listener| attached.
+  void OnDataBuffered(
+      QuicStreamOffset offset, QuicByteCount length,
+      QuicReferenceCountedPointer<QuicAckListenerInterface> ack_listener,
+      QuicTime now);
+
+  // Called when stream data up to |bytes_written| has been written to the
+  // wire.
+  void OnDataConsumed(QuicStreamOffset bytes_written, QuicTime now);
+
+  // Called when the set of acked stream data changes. Emits breakdowns for
+  // stamped ranges that are now fully acked, in offset order.
+  void OnDataAcked(const QuicIntervalSet<QuicStreamOffset>& bytes_acked,
+                   QuicTime now);
+
+  // Returns true if any stamped range is awaiting its breakdown. Allows
+  // callers to skip clock reads when nothing is tracked.
+  bool HasStamps() const { return !stamps_.empty(); }
+
+ private:
+  struct QUIC_EXPORT_PRIVATE Stamp {
+    QuicInterval<QuicStreamOffset> range;
+    // When the application wrote the data.
+    QuicTime write_time = QuicTime::Zero();
+    // When the first byte of the range was written to the wire, i.e. when
+    // the range reached the head of the send buffer.
+    QuicTime head_of_buffer_time = QuicTime::Zero();
+    // When the last byte of the range was written to the wire.
+    QuicTime sent_time = QuicTime::Zero();
+    QuicReferenceCountedPointer<QuicAckListenerInterface> ack_listener;
+  };
+
+  // Stamps ordered by offset; popped from the front as ranges complete.
+  quiche::QuicheCircularDeque<Stamp> stamps_;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_QUIC_STREAM_LATENCY_TRACKER_H_
@@ -0,0 +1,126 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/quic_stream_latency_tracker.h"
+
+#include <vector>
+
+#include "quic/core/quic_interval_set.h"
+#include "quic/platform/api/quic_test.h"
+#include "quic/test_tools/mock_clock.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+struct LatencyBreakdown {
+  QuicByteCount acked_bytes;
+  QuicTime::Delta queued = QuicTime::Delta::Zero();
+  QuicTime::Delta paced = QuicTime::Delta::Zero();
+  QuicTime::Delta in_flight = QuicTime::Delta::Zero();
+};
+
+class BreakdownRecordingAckListener : public QuicAckListenerInterface {
+ public:
+  void OnPacketAcked(int /*acked_bytes*/,
+                     QuicTime::Delta /*ack_delay_time*/) override {}
+  void OnPacketRetransmitted(int /*retransmitted_bytes*/) override {}
+
+  void OnDataLatencyBreakdown(QuicByteCount acked_bytes,
+                              QuicTime::Delta queued,
+                              QuicTime::Delta paced,
+                              QuicTime::Delta in_flight) override {
+    breakdowns_.push_back({acked_bytes, queued, paced, in_flight});
+  }
+
+  const std::vector<LatencyBreakdown>& breakdowns() const {
+    return breakdowns_;
+  }
+
+ protected:
+  ~BreakdownRecordingAckListener() override = default;
+
+ private:
+  std::vector<LatencyBreakdown> breakdowns_;
+};
+
+class QuicStreamLatencyTrackerTest : public QuicTest {
+ protected:
+  QuicStreamLatencyTrackerTest()
+      : listener_(new BreakdownRecordingAckListener()) {}
+
+  void AckRange(QuicStreamOffset offset, QuicByteCount length) {
+    bytes_acked_.Add(offset, offset + length);
+    tracker_.OnDataAcked(bytes_acked_, clock_.Now());
+  }
+
+  MockClock clock_;
+  QuicStreamLatencyTracker tracker_;
+  QuicIntervalSet<QuicStreamOffset> bytes_acked_;
+  QuicReferenceCountedPointer<BreakdownRecordingAckListener> listener_;
+};
+
+TEST_F(QuicStreamLatencyTrackerTest, SinglePhaseBreakdown) {
+  tracker_.OnDataBuffered(0, 100, listener_, clock_.Now());
+  EXPECT_TRUE(tracker_.HasStamps());
+
+  // The range waits 5ms behind earlier data, then takes 7ms to drain onto
+  // the wire, and is acked 20ms after its last byte was written.
+  clock_.AdvanceTime(QuicTime::Delta::FromMilliseconds(5));
+  tracker_.OnDataConsumed(/*bytes_written=*/50, clock_.Now());
+  clock_.AdvanceTime(QuicTime::Delta::FromMilliseconds(7));
+  tracker_.OnDataConsumed(/*bytes_written=*/100, clock_.Now());
+  clock_.AdvanceTime(QuicTime::Delta::FromMilliseconds(20));
+  AckRange(0, 100);
+
+  ASSERT_EQ(1u, listener_->breakdowns().size());
+  const LatencyBreakdown& breakdown = listener_->breakdowns()[0];
+  EXPECT_EQ(100u, breakdown.acked_bytes);
+  EXPECT_EQ(QuicTime::Delta::FromMilliseconds(5), breakdown.queued);
+  EXPECT_EQ(QuicTime::Delta::FromMilliseconds(7), breakdown.paced);
+  EXPECT_EQ(QuicTime::Delta::FromMilliseconds(20), breakdown.in_flight);
+  EXPECT_FALSE(tracker_.HasStamps());
+}
+
+TEST_F(QuicStreamLatencyTrackerTest, PartialAckDefersBreakdown) {
+  tracker_.OnDataBuffered(0, 100, listener_, clock_.Now());
+  tracker_.OnDataConsumed(/*bytes_written=*/100, clock_.Now());
+
+  clock_.AdvanceTime(QuicTime::Delta::FromMilliseconds(10));
+  AckRange(0, 50);
+  EXPECT_TRUE(listener_->breakdowns().empty());
+
+  clock_.AdvanceTime(QuicTime::Delta::FromMilliseconds(10));
+  AckRange(50, 50);
+  ASSERT_EQ(1u, listener_->breakdowns().size());
+  EXPECT_EQ(QuicTime::Delta::FromMilliseconds(20),
+            listener_->breakdowns()[0].in_flight);
+}
+
+TEST_F(QuicStreamLatencyTrackerTest, RangesReportedInOffsetOrder) {
+  tracker_.OnDataBuffered(0, 100, listener_, clock_.Now());
+  tracker_.OnDataBuffered(100, 100, listener_, clock_.Now());
+  tracker_.OnDataConsumed(/*bytes_written=*/200, clock_.Now());
+
+  // The second range is acked first; its breakdown is held back until the
+  // first range completes.
+  AckRange(100, 100);
+  EXPECT_TRUE(listener_->breakdowns().empty());
+
+  AckRange(0, 100);
+  ASSERT_EQ(2u, listener_->breakdowns().size());
+  EXPECT_EQ(100u, listener_->breakdowns()[0].acked_bytes);
+  EXPECT_EQ(100u, listener_->breakdowns()[1].acked_bytes);
+}
+
+TEST_F(QuicStreamLatencyTrackerTest, IgnoresDataWithoutListener) {
+  tracker_.OnDataBuffered(
+      0, 100, QuicReferenceCountedPointer<QuicAckListenerInterface>(),
+      clock_.Now());
+  EXPECT_FALSE(tracker_.HasStamps());
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
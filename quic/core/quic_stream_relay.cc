@@ -0,0 +1,60 @@
+// Copyright (c) 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/quic_stream_relay.h"
+
+#include "quic/platform/api/quic_logging.h"
+
+namespace quic {
+
+QuicStreamRelay::QuicStreamRelay(QuicStream* ingress, QuicStream* egress)
+    : ingress_(ingress), egress_(egress) {
+  ingress_->set_data_sink(this);
+}
+
+QuicStreamRelay::~QuicStreamRelay() { Detach(); }
+
+size_t QuicStreamRelay::OnStreamData(QuicStreamId /*id*/,
+                                     absl::string_view data) {
+  if (egress_->write_side_closed()) {
+    // The egress stream is gone; swallow the data so the ingress stream does
+    // not wedge. It is up to the caller to reset the ingress stream.
+    return data.size();
+  }
+  if (!egress_->CanWriteNewData()) {
+    // Leave the data in the ingress sequencer. The unconsumed bytes keep the
+    // ingress flow control window from replenishing, which pushes back on
+    // the remote sender until the egress send buffer drains.
+    return 0;
+  }
+  egress_->WriteOrBufferData(data, /*fin=*/false, nullptr);
+  return data.size();
+}
+
+void QuicStreamRelay::OnFinConsumed(QuicStreamId /*id*/) {
+  if (fin_forwarded_ || egress_->write_side_closed()) {
+    return;
+  }
+  egress_->WriteOrBufferData(absl::string_view(), /*fin=*/true, nullptr);
+  fin_forwarded_ = true;
+}
+
+void QuicStreamRelay::OnEgressWritable() {
+  if (detached_ || fin_forwarded_) {
+    return;
+  }
+  // Re-registering the sink drains whatever the sequencer has been holding
+  // back while the egress stream was above its buffered-data threshold.
+  ingress_->set_data_sink(this);
+}
+
+void QuicStreamRelay::Detach() {
+  if (detached_) {
+    return;
+  }
+  detached_ = true;
+  ingress_->set_data_sink(nullptr);
+}
+
+}  // namespace quic
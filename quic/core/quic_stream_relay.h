@@ -0,0 +1,64 @@
+// Copyright (c) 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_QUIC_STREAM_RELAY_H_
+#define QUICHE_QUIC_CORE_QUIC_STREAM_RELAY_H_
+
+#include "absl/strings/string_view.h"
+#include "quic/core/quic_stream.h"
+#include "quic/core/quic_types.h"
+#include "quic/platform/api/quic_export.h"
+
+namespace quic {
+
+// Binds an ingress stream to an egress stream, possibly on a different
+// session, so that in-order stream data is forwarded without being staged in
+// the ingress receive buffer. The relay registers itself as the ingress
+// stream's data sink; decrypted, in-order slices are written straight into
+// the egress send buffer, and a FIN is forwarded once all ingress data has
+// been relayed.
+//
+// Flow control is coupled: while the egress send buffer is above its
+// buffered-data threshold, the relay stops accepting ingress data, which
+// leaves it unconsumed in the ingress sequencer and lets the ingress flow
+// control window fill up, pushing back on the remote sender. The egress
+// stream's owner must call OnEgressWritable() when the egress send buffer
+// drains (e.g. from OnCanWriteNewData) to resume forwarding.
+//
+// The relay does not own either stream and must be destroyed, or Detach()ed,
+// before the ingress stream is.
+class QUIC_EXPORT_PRIVATE QuicStreamRelay : public QuicStreamDataSink {
+ public:
+  // Registers |this| as |ingress|'s data sink; any data already buffered in
+  // the ingress sequencer is forwarded immediately.
+  QuicStreamRelay(QuicStream* ingress, QuicStream* egress);
+  QuicStreamRelay(const QuicStreamRelay&) = delete;
+  QuicStreamRelay& operator=(const QuicStreamRelay&) = delete;
+  ~QuicStreamRelay() override;
+
+  // QuicStreamDataSink implementation.
+  size_t OnStreamData(QuicStreamId id, absl::string_view data) override;
+  void OnFinConsumed(QuicStreamId id) override;
+
+  // Resumes forwarding of ingress data held back by egress backpressure.
+  // Must be called when the egress send buffer drains below its threshold.
+  void OnEgressWritable();
+
+  // Unregisters the relay from the ingress stream. Forwarding stops; data
+  // received afterwards is delivered to the ingress stream normally.
+  void Detach();
+
+  // True once the ingress FIN has been relayed to the egress stream.
+  bool fin_forwarded() const { return fin_forwarded_; }
+
+ private:
+  QuicStream* ingress_;
+  QuicStream* egress_;
+  bool detached_ = false;
+  bool fin_forwarded_ = false;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_QUIC_STREAM_RELAY_H_
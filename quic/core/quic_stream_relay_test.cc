@@ -0,0 +1,163 @@
+// Copyright (c) 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/quic_stream_relay.h"
+
+#include <memory>
+#include <string>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "quic/core/crypto/null_encrypter.h"
+#include "quic/core/quic_stream.h"
+#include "quic/core/quic_versions.h"
+#include "quic/platform/api/quic_flags.h"
+#include "quic/platform/api/quic_test.h"
+#include "quic/test_tools/quic_config_peer.h"
+#include "quic/test_tools/quic_test_utils.h"
+
+using testing::_;
+using testing::AnyNumber;
+using testing::Invoke;
+using testing::InvokeWithoutArgs;
+using testing::Return;
+using testing::StrictMock;
+
+namespace quic {
+namespace test {
+namespace {
+
+const char kData1[] = "FooAndBar";
+const char kData2[] = "EepAndBaz";
+const QuicByteCount kDataLen = 9;
+
+class RelayTestStream : public QuicStream {
+ public:
+  RelayTestStream(QuicStreamId id, QuicSession* session, StreamType type)
+      : QuicStream(id, session, /*is_static=*/false, type) {}
+
+  void OnDataAvailable() override {}
+
+  using QuicStream::sequencer;
+};
+
+class QuicStreamRelayTest : public QuicTestWithParam<ParsedQuicVersion> {
+ public:
+  void Initialize() {
+    ParsedQuicVersionVector version_vector;
+    version_vector.push_back(GetParam());
+    connection_ = new StrictMock<MockQuicConnection>(
+        &helper_, &alarm_factory_, Perspective::IS_SERVER, version_vector);
+    connection_->AdvanceTime(QuicTime::Delta::FromSeconds(1));
+    session_ = std::make_unique<StrictMock<MockQuicSession>>(connection_);
+    session_->Initialize();
+    connection_->SetEncrypter(
+        ENCRYPTION_FORWARD_SECURE,
+        std::make_unique<NullEncrypter>(connection_->perspective()));
+    QuicConfigPeer::SetReceivedInitialSessionFlowControlWindow(
+        session_->config(), kMinimumFlowControlSendWindow);
+    QuicConfigPeer::SetReceivedInitialMaxStreamDataBytesIncomingBidirectional(
+        session_->config(), kMinimumFlowControlSendWindow);
+    QuicConfigPeer::SetReceivedInitialMaxStreamDataBytesOutgoingBidirectional(
+        session_->config(), kMinimumFlowControlSendWindow);
+    session_->OnConfigNegotiated();
+
+    ingress_ = new RelayTestStream(kIngressStreamId, session_.get(),
+                                   BIDIRECTIONAL);
+    egress_ =
+        new RelayTestStream(kEgressStreamId, session_.get(), BIDIRECTIONAL);
+    session_->ActivateStream(absl::WrapUnique(ingress_));
+    session_->ActivateStream(absl::WrapUnique(egress_));
+    EXPECT_CALL(*session_, MaybeSendStopSendingFrame(_, _)).Times(AnyNumber());
+    EXPECT_CALL(*session_, MaybeSendRstStreamFrame(_, _, _))
+        .Times(AnyNumber());
+  }
+
+  MockQuicConnectionHelper helper_;
+  MockAlarmFactory alarm_factory_;
+  StrictMock<MockQuicConnection>* connection_;
+  std::unique_ptr<StrictMock<MockQuicSession>> session_;
+  RelayTestStream* ingress_;
+  RelayTestStream* egress_;
+  const QuicStreamId kIngressStreamId =
+      GetNthClientInitiatedBidirectionalStreamId(GetParam().transport_version,
+                                                 1);
+  const QuicStreamId kEgressStreamId =
+      GetNthClientInitiatedBidirectionalStreamId(GetParam().transport_version,
+                                                 2);
+};
+
+INSTANTIATE_TEST_SUITE_P(QuicStreamRelayTests, QuicStreamRelayTest,
+                         ::testing::ValuesIn(AllSupportedVersions()),
+                         ::testing::PrintToStringParamName());
+
+TEST_P(QuicStreamRelayTest, ForwardsDataAndFin) {
+  Initialize();
+  QuicStreamRelay relay(ingress_, egress_);
+
+  // In-order ingress data is written to the egress stream without being
+  // staged in the ingress receive buffer.
+  EXPECT_CALL(*session_, WritevData(kEgressStreamId, _, _, _, _, _))
+      .WillRepeatedly(Invoke(session_.get(), &MockQuicSession::ConsumeData));
+  ingress_->OnStreamFrame(
+      QuicStreamFrame(kIngressStreamId, false, 0, kData1));
+  EXPECT_EQ(kDataLen, ingress_->stream_bytes_read());
+  EXPECT_EQ(kDataLen, egress_->stream_bytes_written());
+
+  // The ingress FIN is forwarded once all data has been relayed.
+  ingress_->OnStreamFrame(
+      QuicStreamFrame(kIngressStreamId, true, kDataLen, kData2));
+  EXPECT_EQ(2 * kDataLen, egress_->stream_bytes_written());
+  EXPECT_TRUE(relay.fin_forwarded());
+  EXPECT_TRUE(egress_->fin_sent());
+  EXPECT_TRUE(ingress_->read_side_closed());
+}
+
+TEST_P(QuicStreamRelayTest, BackpressurePropagatesToIngress) {
+  SetQuicFlag(FLAGS_quic_buffered_data_threshold, 100);
+  Initialize();
+  QuicStreamRelay relay(ingress_, egress_);
+
+  // The egress stream cannot send; relayed data piles up in its send buffer
+  // until the buffered-data threshold is hit.
+  EXPECT_CALL(*session_, WritevData(kEgressStreamId, _, _, _, _, _))
+      .WillRepeatedly(Return(QuicConsumedData(0, false)));
+  std::string data(200, 'a');
+  ingress_->OnStreamFrame(QuicStreamFrame(kIngressStreamId, false, 0, data));
+  EXPECT_EQ(data.length(), egress_->BufferedDataBytes());
+  EXPECT_FALSE(egress_->CanWriteNewData());
+
+  // Further ingress data is not accepted; it stays in the ingress sequencer,
+  // keeping the ingress flow control window from replenishing.
+  ingress_->OnStreamFrame(
+      QuicStreamFrame(kIngressStreamId, false, data.length(), data));
+  EXPECT_EQ(data.length(), ingress_->stream_bytes_read());
+  EXPECT_TRUE(ingress_->sequencer()->HasBytesToRead());
+
+  // Draining the egress send buffer and signaling the relay resumes
+  // forwarding of the held-back data.
+  EXPECT_CALL(*session_, WritevData(kEgressStreamId, _, _, _, _, _))
+      .WillRepeatedly(Invoke(session_.get(), &MockQuicSession::ConsumeData));
+  egress_->OnCanWrite();
+  relay.OnEgressWritable();
+  EXPECT_EQ(2 * data.length(), ingress_->stream_bytes_read());
+  EXPECT_EQ(2 * data.length(), egress_->stream_bytes_written());
+}
+
+TEST_P(QuicStreamRelayTest, DetachStopsForwarding) {
+  Initialize();
+  QuicStreamRelay relay(ingress_, egress_);
+  relay.Detach();
+
+  // With the relay detached, received data is buffered in the ingress
+  // sequencer as usual and nothing is written to the egress stream.
+  ingress_->OnStreamFrame(
+      QuicStreamFrame(kIngressStreamId, false, 0, kData1));
+  EXPECT_TRUE(ingress_->sequencer()->HasBytesToRead());
+  EXPECT_EQ(0u, egress_->stream_bytes_written());
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
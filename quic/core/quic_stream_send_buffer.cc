@@ -20,7 +20,7 @@ namespace {
 
 struct CompareOffset {
   bool operator()(const BufferedSlice& slice, QuicStreamOffset offset) const {
-    return slice.offset + slice.slice.length() < offset;
+    return slice.offset + slice.length() < offset;
   }
 };
 
@@ -29,6 +29,11 @@ struct CompareOffset {
 BufferedSlice::BufferedSlice(QuicMemSlice mem_slice, QuicStreamOffset offset)
     : slice(std::move(mem_slice)), offset(offset) {}
 
+BufferedSlice::BufferedSlice(
+    QuicReferenceCountedPointer<QuicExternalSendBuffer> external,
+    QuicStreamOffset offset)
+    : external(std::move(external)), offset(offset) {}
+
 BufferedSlice::BufferedSlice(BufferedSlice&& other) = default;
 
 BufferedSlice& BufferedSlice::operator=(BufferedSlice&& other) = default;
@@ -36,8 +41,24 @@ BufferedSlice& BufferedSlice::operator=(BufferedSlice&& other) = default;
 BufferedSlice::~BufferedSlice() {}
 
 QuicInterval<std::size_t> BufferedSlice::interval() const {
-  const std::size_t length = slice.length();
-  return QuicInterval<std::size_t>(offset, offset + length);
+  return QuicInterval<std::size_t>(offset, offset + length());
+}
+
+const char* BufferedSlice::data() const {
+  return external != nullptr ? external->data() : slice.data();
+}
+
+std::size_t BufferedSlice::length() const {
+  return external != nullptr ? external->length() : slice.length();
+}
+
+bool BufferedSlice::empty() const {
+  return external == nullptr && slice.empty();
+}
+
+void BufferedSlice::Reset() {
+  external = nullptr;
+  slice.Reset();
 }
 
 bool StreamPendingRetransmission::operator==(
@@ -92,6 +113,24 @@ void QuicStreamSendBuffer::SaveMemSlice(QuicMemSlice slice) {
   stream_offset_ += length;
 }
 
+void QuicStreamSendBuffer::SaveExternalBuffer(
+    QuicReferenceCountedPointer<QuicExternalSendBuffer> buffer) {
+  if (buffer == nullptr || buffer->length() == 0) {
+    QUIC_BUG(quic_bug_save_empty_external_buffer)
+        << "Try to save empty external buffer to send buffer.";
+    return;
+  }
+  QUIC_DVLOG(2) << "Save external buffer offset " << stream_offset_
+                << " length " << buffer->length();
+  const size_t length = buffer->length();
+  if (interval_deque_.Empty()) {
+    const QuicStreamOffset end = stream_offset_ + length;
+    current_end_offset_ = std::max(current_end_offset_, end);
+  }
+  interval_deque_.PushBack(BufferedSlice(std::move(buffer), stream_offset_));
+  stream_offset_ += length;
+}
+
 QuicByteCount QuicStreamSendBuffer::SaveMemSliceSpan(
     absl::Span<QuicMemSlice> span) {
   QuicByteCount total = 0;
@@ -128,9 +167,9 @@ bool QuicStreamSendBuffer::WriteStreamData(QuicStreamOffset offset,
 
     QuicByteCount slice_offset = offset - slice_it->offset;
     QuicByteCount available_bytes_in_slice =
-        slice_it->slice.length() - slice_offset;
+        slice_it->length() - slice_offset;
     QuicByteCount copy_length = std::min(data_length, available_bytes_in_slice);
-    if (!writer->WriteBytes(slice_it->slice.data() + slice_offset,
+    if (!writer->WriteBytes(slice_it->data() + slice_offset,
                             copy_length)) {
       QUIC_BUG(quic_bug_10853_2) << "Writer fails to write.";
       return false;
@@ -138,7 +177,7 @@ bool QuicStreamSendBuffer::WriteStreamData(QuicStreamOffset offset,
     offset += copy_length;
     data_length -= copy_length;
     const QuicStreamOffset new_end =
-        slice_it->offset + slice_it->slice.length();
+        slice_it->offset + slice_it->length();
     current_end_offset_ = std::max(current_end_offset_, new_end);
   }
   return data_length == 0;
@@ -238,7 +277,7 @@ StreamPendingRetransmission QuicStreamSendBuffer::NextPendingRetransmission()
 bool QuicStreamSendBuffer::FreeMemSlices(QuicStreamOffset start,
                                          QuicStreamOffset end) {
   auto it = interval_deque_.DataBegin();
-  if (it == interval_deque_.DataEnd() || it->slice.empty()) {
+  if (it == interval_deque_.DataEnd() || it->empty()) {
     QUIC_BUG(quic_bug_10853_4)
         << "Trying to ack stream data [" << start << ", " << end << "), "
         << (it == interval_deque_.DataEnd()
@@ -251,7 +290,7 @@ bool QuicStreamSendBuffer::FreeMemSlices(QuicStreamOffset start,
     it = std::lower_bound(interval_deque_.DataBegin(),
                           interval_deque_.DataEnd(), start, CompareOffset());
   }
-  if (it == interval_deque_.DataEnd() || it->slice.empty()) {
+  if (it == interval_deque_.DataEnd() || it->empty()) {
     QUIC_BUG(quic_bug_10853_5)
         << "Offset " << start << " with iterator offset: " << it->offset
         << (it == interval_deque_.DataEnd() ? " does not exist."
@@ -262,9 +301,9 @@ bool QuicStreamSendBuffer::FreeMemSlices(QuicStreamOffset start,
     if (it->offset >= end) {
       break;
     }
-    if (!it->slice.empty() &&
-        bytes_acked_.Contains(it->offset, it->offset + it->slice.length())) {
-      it->slice.Reset();
+    if (!it->empty() &&
+        bytes_acked_.Contains(it->offset, it->offset + it->length())) {
+      it->Reset();
     }
   }
   return true;
@@ -272,13 +311,13 @@ bool QuicStreamSendBuffer::FreeMemSlices(QuicStreamOffset start,
 
 void QuicStreamSendBuffer::CleanUpBufferedSlices() {
   while (!interval_deque_.Empty() &&
-         interval_deque_.DataBegin()->slice.empty()) {
+         interval_deque_.DataBegin()->empty()) {
     QUIC_BUG_IF(quic_bug_12823_2,
                 interval_deque_.DataBegin()->offset > current_end_offset_)
         << "Fail to pop front from interval_deque_. Front element contained "
            "a slice whose data has not all be written. Front offset "
         << interval_deque_.DataBegin()->offset << " length "
-        << interval_deque_.DataBegin()->slice.length();
+        << interval_deque_.DataBegin()->length();
     interval_deque_.PopFront();
   }
 }
@@ -12,6 +12,7 @@
 #include "quic/core/quic_types.h"
 #include "quic/platform/api/quic_iovec.h"
 #include "quic/platform/api/quic_mem_slice.h"
+#include "quic/platform/api/quic_reference_counted.h"
 #include "common/quiche_circular_deque.h"
 
 namespace quic {
@@ -23,12 +24,36 @@ class QuicStreamPeer;
 
 class QuicDataWriter;
 
+// QuicExternalSendBuffer is a reference-counted view of immutable,
+// application-owned memory. Saving one into a QuicStreamSendBuffer pins the
+// underlying memory (via the reference count) until the covered stream data
+// is fully acked, letting QuicPacketCreator serialize stream frames directly
+// from application buffers without an intermediate copy. Subclasses release
+// the underlying memory in their destructor.
+class QUIC_EXPORT_PRIVATE QuicExternalSendBuffer : public QuicReferenceCounted {
+ public:
+  QuicExternalSendBuffer(const char* data, size_t length)
+      : data_(data), length_(length) {}
+
+  const char* data() const { return data_; }
+  size_t length() const { return length_; }
+
+ protected:
+  ~QuicExternalSendBuffer() override = default;
+
+ private:
+  const char* data_;
+  size_t length_;
+};
+
 // BufferedSlice comprises information of a piece of stream data stored in
 // contiguous memory space. Please note, BufferedSlice is constructed when
 // stream data is saved in send buffer and is removed when stream data is fully
 // acked. It is move-only.
 struct QUIC_EXPORT_PRIVATE BufferedSlice {
   BufferedSlice(QuicMemSlice mem_slice, QuicStreamOffset offset);
+  BufferedSlice(QuicReferenceCountedPointer<QuicExternalSendBuffer> external,
+                QuicStreamOffset offset);
   BufferedSlice(BufferedSlice&& other);
   BufferedSlice& operator=(BufferedSlice&& other);
 
@@ -39,8 +64,21 @@ struct QUIC_EXPORT_PRIVATE BufferedSlice {
   // Return an interval representing the offset and length.
   QuicInterval<std::size_t> interval() const;
 
-  // Stream data of this data slice.
+  // Stream data of this slice, regardless of whether it is stored in |slice|
+  // or pinned in an application-owned |external| buffer.
+  const char* data() const;
+  std::size_t length() const;
+  bool empty() const;
+
+  // Releases the underlying memory: resets |slice|, or drops the reference
+  // pinning |external|.
+  void Reset();
+
+  // Stream data of this data slice, if it was copied into the send buffer.
   QuicMemSlice slice;
+  // Application-owned stream data pinned by this slice; null if the data was
+  // copied into |slice| instead.
+  QuicReferenceCountedPointer<QuicExternalSendBuffer> external;
   // Location of this data slice in the stream.
   QuicStreamOffset offset;
 };
@@ -78,6 +116,12 @@ class QUIC_EXPORT_PRIVATE QuicStreamSendBuffer {
   // Save |slice| to send buffer.
   void SaveMemSlice(QuicMemSlice slice);
 
+  // Save a reference to application-owned |buffer| to send buffer without
+  // copying. The buffer is pinned (via its reference count) until all covered
+  // stream data is acked, so the application must not mutate it once saved.
+  void SaveExternalBuffer(
+      QuicReferenceCountedPointer<QuicExternalSendBuffer> buffer);
+
   // Save all slices in |span| to send buffer. Return total bytes saved.
   QuicByteCount SaveMemSliceSpan(absl::Span<QuicMemSlice> span);
 
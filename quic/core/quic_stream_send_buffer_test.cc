@@ -345,6 +345,66 @@ TEST_F(QuicStreamSendBufferTest, SaveEmptyMemSliceSpan) {
   EXPECT_EQ(10u, send_buffer.size());
 }
 
+// An external buffer which records its destruction, standing in for
+// application-owned memory whose lifetime is tied to the reference count.
+class TrackedExternalSendBuffer : public QuicExternalSendBuffer {
+ public:
+  TrackedExternalSendBuffer(const char* data, size_t length, bool* destroyed)
+      : QuicExternalSendBuffer(data, length), destroyed_(destroyed) {}
+
+ protected:
+  ~TrackedExternalSendBuffer() override { *destroyed_ = true; }
+
+ private:
+  bool* destroyed_;
+};
+
+TEST_F(QuicStreamSendBufferTest, SaveExternalBufferWritesWithoutCopy) {
+  SimpleBufferAllocator allocator;
+  QuicStreamSendBuffer send_buffer(&allocator);
+
+  std::string data(2048, 'e');
+  bool destroyed = false;
+  QuicReferenceCountedPointer<QuicExternalSendBuffer> external(
+      new TrackedExternalSendBuffer(data.data(), data.length(), &destroyed));
+  send_buffer.SaveExternalBuffer(std::move(external));
+  EXPECT_EQ(1u, send_buffer.size());
+  send_buffer.OnStreamDataConsumed(2048u);
+
+  char buf[2048];
+  QuicDataWriter writer(sizeof(buf), buf, quiche::HOST_BYTE_ORDER);
+  EXPECT_TRUE(send_buffer.WriteStreamData(0, 2048u, &writer));
+  EXPECT_EQ(data, absl::string_view(buf, sizeof(buf)));
+
+  // The application buffer stays pinned until all covered data is acked.
+  EXPECT_FALSE(destroyed);
+  QuicByteCount newly_acked_length;
+  EXPECT_TRUE(send_buffer.OnStreamDataAcked(0, 2048u, &newly_acked_length));
+  EXPECT_EQ(2048u, newly_acked_length);
+  EXPECT_TRUE(destroyed);
+  EXPECT_EQ(0u, send_buffer.size());
+}
+
+TEST_F(QuicStreamSendBufferTest, SaveExternalBufferInterleavedWithMemSlices) {
+  SimpleBufferAllocator allocator;
+  QuicStreamSendBuffer send_buffer(&allocator);
+
+  std::string slice_data(512, 'f');
+  std::string external_data(512, 'g');
+  bool destroyed = false;
+  send_buffer.SaveMemSlice(MemSliceFromString(slice_data));
+  send_buffer.SaveExternalBuffer(
+      QuicReferenceCountedPointer<QuicExternalSendBuffer>(
+          new TrackedExternalSendBuffer(external_data.data(),
+                                        external_data.length(), &destroyed)));
+  send_buffer.OnStreamDataConsumed(1024u);
+
+  char buf[1024];
+  QuicDataWriter writer(sizeof(buf), buf, quiche::HOST_BYTE_ORDER);
+  EXPECT_TRUE(send_buffer.WriteStreamData(0, 1024u, &writer));
+  EXPECT_EQ(slice_data + external_data, absl::string_view(buf, sizeof(buf)));
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace quic
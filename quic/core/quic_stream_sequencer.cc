@@ -36,7 +36,13 @@ QuicStreamSequencer::QuicStreamSequencer(StreamInterface* quic_stream)
       num_frames_received_(0),
       num_duplicate_frames_received_(0),
       ignore_read_data_(false),
-      level_triggered_(false) {}
+      level_triggered_(false),
+      reset_on_reassembly_limit_(false) {}
+
+void QuicStreamSequencer::EnableReassemblyHardening(size_t max_data_intervals) {
+  buffered_frames_.set_max_data_intervals(max_data_intervals);
+  reset_on_reassembly_limit_ = true;
+}
 
 QuicStreamSequencer::~QuicStreamSequencer() {
   if (stream_ == nullptr) {
@@ -80,6 +86,31 @@ void QuicStreamSequencer::OnFrameData(QuicStreamOffset byte_offset,
                                       size_t data_len,
                                       const char* data_buffer) {
   highest_offset_ = std::max(highest_offset_, byte_offset + data_len);
+  // Fast path: data arriving exactly in order while nothing is buffered can
+  // be handed to the stream without first copying it into
+  // |buffered_frames_|.  Bytes the stream consumes synchronously are touched
+  // once, in the decrypted packet, instead of being written into the buffer
+  // and read back out.
+  if (!blocked_ && !ignore_read_data_ && data_len > 0 &&
+      buffered_frames_.CanDeliverInOrderDataDirectly(byte_offset, data_len)) {
+    const size_t bytes_processed = stream_->OnInOrderDataAvailable(
+        absl::string_view(data_buffer, data_len));
+    if (bytes_processed > 0) {
+      QUICHE_DCHECK_LE(bytes_processed, data_len);
+      buffered_frames_.MarkInOrderDataConsumed(byte_offset, bytes_processed);
+      stream_->AddBytesConsumed(bytes_processed);
+      if (bytes_processed == data_len) {
+        // The whole frame was consumed; a FIN at the end of it can be
+        // delivered now.
+        MaybeCloseStream();
+        return;
+      }
+      // Buffer the unconsumed remainder as if it had arrived on its own.
+      byte_offset += bytes_processed;
+      data_buffer += bytes_processed;
+      data_len -= bytes_processed;
+    }
+  }
   const size_t previous_readable_bytes = buffered_frames_.ReadableBytes();
   size_t bytes_written;
   std::string error_details;
@@ -92,6 +123,17 @@ void QuicStreamSequencer::OnFrameData(QuicStreamOffset byte_offset,
                      QuicErrorCodeToString(result), ": ", error_details);
     QUIC_LOG_FIRST_N(WARNING, 50) << QuicErrorCodeToString(result);
     QUIC_LOG_FIRST_N(WARNING, 50) << details;
+    if (result == QUIC_TOO_MANY_STREAM_DATA_INTERVALS &&
+        reset_on_reassembly_limit_) {
+      // The peer exceeded the hardened reassembly budget on this stream.
+      // Reset the stream to shed the reassembly state instead of making the
+      // reordering fatal to the connection. QUIC_TOO_MANY_STREAM_DATA_INTERVALS
+      // is a connection-level error code; the closest stream-level reset code
+      // is QUIC_STREAM_EXCESSIVE_LOAD.
+      stream_->ResetWithError(
+          QuicResetStreamError::FromInternal(QUIC_STREAM_EXCESSIVE_LOAD));
+      return;
+    }
     stream_->OnUnrecoverableError(result, details);
     return;
   }
@@ -293,6 +335,10 @@ size_t QuicStreamSequencer::NumBytesBuffered() const {
   return buffered_frames_.BytesBuffered();
 }
 
+size_t QuicStreamSequencer::NumBytesAllocated() const {
+  return buffered_frames_.AllocatedBytes();
+}
+
 QuicStreamOffset QuicStreamSequencer::NumBytesConsumed() const {
   return buffered_frames_.BytesConsumed();
 }
@@ -9,6 +9,7 @@
 #include <map>
 #include <string>
 
+#include "absl/strings/string_view.h"
 #include "quic/core/quic_packets.h"
 #include "quic/core/quic_stream_sequencer_buffer.h"
 #include "quic/core/quic_types.h"
@@ -31,6 +32,15 @@ class QUIC_EXPORT_PRIVATE QuicStreamSequencer {
 
     // Called when new data is available to be read from the sequencer.
     virtual void OnDataAvailable() = 0;
+    // Called when |data| arrives exactly at the next offset the stream would
+    // read while nothing is buffered ahead of it.  The stream may process a
+    // prefix of |data| synchronously and return the number of bytes
+    // consumed; the remainder is buffered as usual.  |data| is only valid
+    // for the duration of the call.  The default implementation consumes
+    // nothing, which disables this fast path.
+    virtual size_t OnInOrderDataAvailable(absl::string_view /*data*/) {
+      return 0;
+    }
     // Called when the end of the stream has been read.
     virtual void OnFinRead() = 0;
     // Called when bytes have been consumed from the sequencer.
@@ -136,6 +146,9 @@ class QUIC_EXPORT_PRIVATE QuicStreamSequencer {
   // Number of bytes in the buffer right now.
   size_t NumBytesBuffered() const;
 
+  // Number of bytes of heap memory held by the buffer right now.
+  size_t NumBytesAllocated() const;
+
   // Number of bytes has been consumed.
   QuicStreamOffset NumBytesConsumed() const;
 
@@ -153,6 +166,14 @@ class QUIC_EXPORT_PRIVATE QuicStreamSequencer {
     level_triggered_ = level_triggered;
   }
 
+  // Hardens this stream against pathological reassembly patterns (e.g.
+  // one-byte frames at alternating offsets): lowers the budget of disjoint
+  // received-data intervals to |max_data_intervals|, and when a peer exceeds
+  // it, resets this stream instead of closing the connection.  Bounds the
+  // worst-case per-frame reassembly cost without making a reordering-heavy
+  // stream fatal to the other streams of the connection.
+  void EnableReassemblyHardening(size_t max_data_intervals);
+
   bool level_triggered() const { return level_triggered_; }
 
   void set_stream(StreamInterface* stream) { stream_ = stream; }
@@ -210,6 +231,10 @@ class QUIC_EXPORT_PRIVATE QuicStreamSequencer {
   // If false, only call OnDataAvailable() when it becomes newly unblocked.
   // Otherwise, call OnDataAvailable() when number of readable bytes changes.
   bool level_triggered_;
+
+  // If true, exceeding the reassembly interval budget resets the stream
+  // instead of closing the connection.  See EnableReassemblyHardening().
+  bool reset_on_reassembly_limit_;
 };
 
 }  // namespace quic
@@ -38,6 +38,47 @@ constexpr size_t kInitialBlockCount = 8u;
 // Choose 4 to reduce the amount of reallocation.
 constexpr int kBlocksGrowthFactor = 4;
 
+// A per-thread LIFO free list of BufferBlocks. Short streams churn through
+// blocks constantly; recycling them within a thread moves blocks between
+// streams without hitting the allocator or requiring any synchronization,
+// since all streams of a dispatcher shard live on the same thread. LIFO
+// order hands back the most recently touched (and thus cache-warmest)
+// block first.
+class BufferBlockPool {
+ public:
+  static BufferBlockPool* Get() {
+    static thread_local BufferBlockPool* pool = new BufferBlockPool();
+    return pool;
+  }
+
+  QuicStreamSequencerBuffer::BufferBlock* Allocate() {
+    if (num_free_ == 0) {
+      return new QuicStreamSequencerBuffer::BufferBlock();
+    }
+    return free_blocks_[--num_free_];
+  }
+
+  void Release(QuicStreamSequencerBuffer::BufferBlock* block) {
+    if (num_free_ == QuicStreamSequencerBuffer::kMaxRecycledBlocks) {
+      delete block;
+      return;
+    }
+    free_blocks_[num_free_++] = block;
+    high_water_mark_ = std::max(high_water_mark_, num_free_);
+  }
+
+  size_t num_free() const { return num_free_; }
+  size_t high_water_mark() const { return high_water_mark_; }
+
+ private:
+  BufferBlockPool() = default;
+
+  QuicStreamSequencerBuffer::BufferBlock*
+      free_blocks_[QuicStreamSequencerBuffer::kMaxRecycledBlocks];
+  size_t num_free_ = 0;
+  size_t high_water_mark_ = 0;
+};
+
 }  // namespace
 
 QuicStreamSequencerBuffer::QuicStreamSequencerBuffer(size_t max_capacity_bytes)
@@ -45,7 +86,8 @@ QuicStreamSequencerBuffer::QuicStreamSequencerBuffer(size_t max_capacity_bytes)
       max_blocks_count_(CalculateBlockCount(max_capacity_bytes)),
       current_blocks_count_(0u),
       total_bytes_read_(0),
-      blocks_(nullptr) {
+      blocks_(nullptr),
+      max_data_intervals_(kMaxNumDataIntervalsAllowed) {
   QUICHE_DCHECK_GE(max_blocks_count_, kInitialBlockCount);
   Clear();
 }
@@ -72,12 +114,33 @@ bool QuicStreamSequencerBuffer::RetireBlock(size_t index) {
     QUIC_BUG(quic_bug_10610_1) << "Try to retire block twice";
     return false;
   }
-  delete blocks_[index];
+  ReleaseBlock(blocks_[index]);
   blocks_[index] = nullptr;
   QUIC_DVLOG(1) << "Retired block with index: " << index;
   return true;
 }
 
+// static
+QuicStreamSequencerBuffer::BufferBlock*
+QuicStreamSequencerBuffer::AllocateBlock() {
+  return BufferBlockPool::Get()->Allocate();
+}
+
+// static
+void QuicStreamSequencerBuffer::ReleaseBlock(BufferBlock* block) {
+  BufferBlockPool::Get()->Release(block);
+}
+
+// static
+size_t QuicStreamSequencerBuffer::NumRecycledBlocksForThread() {
+  return BufferBlockPool::Get()->num_free();
+}
+
+// static
+size_t QuicStreamSequencerBuffer::RecycledBlocksHighWaterMarkForThread() {
+  return BufferBlockPool::Get()->high_water_mark();
+}
+
 void QuicStreamSequencerBuffer::MaybeAddMoreBlocks(
     QuicStreamOffset next_expected_byte) {
   if (current_blocks_count_ == max_blocks_count_) {
@@ -136,7 +199,7 @@ QuicErrorCode QuicStreamSequencerBuffer::OnStreamData(
     // Optimization for the typical case, when all data is newly received.
     bytes_received_.AddOptimizedForAppend(starting_offset,
                                           starting_offset + size);
-    if (bytes_received_.Size() >= kMaxNumDataIntervalsAllowed) {
+    if (bytes_received_.Size() >= max_data_intervals_) {
       // This frame is going to create more intervals than allowed. Stop
       // processing.
       *error_details = "Too many data intervals received for this stream.";
@@ -164,7 +227,7 @@ QuicErrorCode QuicStreamSequencerBuffer::OnStreamData(
     return QUIC_NO_ERROR;
   }
   bytes_received_.Add(starting_offset, starting_offset + size);
-  if (bytes_received_.Size() >= kMaxNumDataIntervalsAllowed) {
+  if (bytes_received_.Size() >= max_data_intervals_) {
     // This frame is going to create more intervals than allowed. Stop
     // processing.
     *error_details = "Too many data intervals received for this stream.";
@@ -190,6 +253,22 @@ QuicErrorCode QuicStreamSequencerBuffer::OnStreamData(
   return QUIC_NO_ERROR;
 }
 
+bool QuicStreamSequencerBuffer::CanDeliverInOrderDataDirectly(
+    QuicStreamOffset offset,
+    size_t length) const {
+  return offset == total_bytes_read_ && num_bytes_buffered_ == 0 &&
+         offset + length >= offset &&
+         bytes_received_.IsDisjoint(
+             QuicInterval<QuicStreamOffset>(offset, offset + length));
+}
+
+void QuicStreamSequencerBuffer::MarkInOrderDataConsumed(QuicStreamOffset offset,
+                                                        size_t length) {
+  QUICHE_DCHECK(CanDeliverInOrderDataDirectly(offset, length));
+  bytes_received_.AddOptimizedForAppend(offset, offset + length);
+  total_bytes_read_ += length;
+}
+
 bool QuicStreamSequencerBuffer::CopyStreamData(QuicStreamOffset offset,
                                                absl::string_view data,
                                                size_t* bytes_copy,
@@ -232,9 +311,8 @@ bool QuicStreamSequencerBuffer::CopyStreamData(QuicStreamOffset offset,
       return false;
     }
     if (blocks_[write_block_num] == nullptr) {
-      // TODO(danzh): Investigate if using a freelist would improve performance.
       // Same as RetireBlock().
-      blocks_[write_block_num] = new BufferBlock();
+      blocks_[write_block_num] = AllocateBlock();
     }
 
     const size_t bytes_to_copy =
@@ -455,6 +533,26 @@ size_t QuicStreamSequencerBuffer::ReadableBytes() const {
   return FirstMissingByte() - total_bytes_read_;
 }
 
+void QuicStreamSequencerBuffer::set_max_data_intervals(
+    size_t max_data_intervals) {
+  QUICHE_DCHECK_GT(max_data_intervals, 0u);
+  QUICHE_DCHECK_LE(max_data_intervals, kMaxNumDataIntervalsAllowed);
+  max_data_intervals_ = max_data_intervals;
+}
+
+size_t QuicStreamSequencerBuffer::AllocatedBytes() const {
+  if (blocks_ == nullptr) {
+    return 0;
+  }
+  size_t num_allocated_blocks = 0;
+  for (size_t i = 0; i < current_blocks_count_; ++i) {
+    if (blocks_[i] != nullptr) {
+      ++num_allocated_blocks;
+    }
+  }
+  return num_allocated_blocks * kBlockSizeBytes;
+}
+
 bool QuicStreamSequencerBuffer::HasBytesToRead() const {
   return ReadableBytes() > 0;
 }
@@ -111,6 +111,19 @@ class QUIC_EXPORT_PRIVATE QuicStreamSequencerBuffer {
                              size_t* bytes_buffered,
                              std::string* error_details);
 
+  // Returns true if data arriving at |offset| could be handed to the
+  // application directly instead of being copied into this buffer: |offset|
+  // is the next byte the application would read, no data is buffered, and
+  // none of the |length| bytes has been received before.
+  bool CanDeliverInOrderDataDirectly(QuicStreamOffset offset,
+                                     size_t length) const;
+
+  // Records [|offset|, |offset| + |length|) as received and consumed without
+  // copying it into the buffer.  To be called only when
+  // CanDeliverInOrderDataDirectly() returns true for a range covering these
+  // bytes.
+  void MarkInOrderDataConsumed(QuicStreamOffset offset, size_t length);
+
   // Reads from this buffer into given iovec array, up to number of iov_len
   // iovec objects and returns the number of bytes read.
   QuicErrorCode Readv(const struct iovec* dest_iov,
@@ -162,6 +175,34 @@ class QUIC_EXPORT_PRIVATE QuicStreamSequencerBuffer {
   // Returns number of bytes available to be read out.
   size_t ReadableBytes() const;
 
+  // Returns the number of bytes of heap memory held by allocated blocks.
+  // This can exceed BytesBuffered() because blocks are allocated whole.
+  size_t AllocatedBytes() const;
+
+  // Lowers the limit on the number of disjoint received-byte intervals this
+  // buffer tracks before OnStreamData() fails with
+  // QUIC_TOO_MANY_STREAM_DATA_INTERVALS.  Each disjoint interval costs
+  // bookkeeping on every subsequent out-of-order write, so the limit bounds
+  // the worst-case per-frame reassembly cost under adversarial fragment
+  // patterns (e.g. one-byte frames at alternating offsets).
+  // |max_data_intervals| must not exceed the default limit.
+  void set_max_data_intervals(size_t max_data_intervals);
+
+  // Number of disjoint received-byte intervals currently tracked.
+  size_t num_data_intervals() const { return bytes_received_.Size(); }
+
+  // Occupancy metrics of this thread's block recycler, exposed so the pool
+  // bound can be sized against real workloads. Blocks retired by drained
+  // streams are kept on a per-thread free list (bounded by
+  // kMaxRecycledBlocks) and handed to other streams without going through
+  // the allocator.
+  static size_t NumRecycledBlocksForThread();
+  static size_t RecycledBlocksHighWaterMarkForThread();
+
+  // Upper bound of blocks kept for reuse per thread. At 8 KB a block, this
+  // caps the idle footprint of the recycler at 4 MB per event-loop thread.
+  static const size_t kMaxRecycledBlocks = 512;
+
  private:
   friend class test::QuicStreamSequencerBufferPeer;
 
@@ -172,6 +213,14 @@ class QUIC_EXPORT_PRIVATE QuicStreamSequencerBuffer {
                       size_t* bytes_copy,
                       std::string* error_details);
 
+  // Returns a block from this thread's recycler, or a freshly allocated one
+  // if the recycler is empty.
+  static BufferBlock* AllocateBlock();
+
+  // Returns |block| to this thread's recycler, or frees it if the recycler
+  // is at capacity.
+  static void ReleaseBlock(BufferBlock* block);
+
   // Dispose the given buffer block.
   // After calling this method, blocks_[index] is set to nullptr
   // in order to indicate that no memory set is allocated for that block.
@@ -240,6 +289,9 @@ class QUIC_EXPORT_PRIVATE QuicStreamSequencerBuffer {
   // Currently received data.
   QuicIntervalSet<QuicStreamOffset> bytes_received_;
 
+  // Limit on the size of |bytes_received_|, see set_max_data_intervals().
+  size_t max_data_intervals_;
+
   bool delay_allocation_until_new_data_ = GetQuicReloadableFlag(
       quic_delay_sequencer_buffer_allocation_until_new_data);
 };
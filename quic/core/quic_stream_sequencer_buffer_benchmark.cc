@@ -0,0 +1,148 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <cstdint>
+#include <string>
+
+#include "common/platform/api/quiche_benchmark.h"
+#include "quic/core/quic_stream_sequencer_buffer.h"
+
+namespace quic {
+namespace {
+
+// A full-sized stream frame payload.
+const size_t kChunkSize = 1350;
+
+// Frames drained from the buffer per read.
+const size_t kChunksPerRead = 16;
+
+// In-order writes with periodic reads, the common case on a healthy path.
+void BM_SequencerBufferInOrderWrites(quiche::QuicheBenchmarkState& state) {
+  QuicStreamSequencerBuffer buffer(2 * 1024 * 1024);
+  const std::string chunk(kChunkSize, 'q');
+  char dest[kChunksPerRead * kChunkSize];
+  iovec iov{dest, sizeof(dest)};
+  QuicStreamOffset offset = 0;
+  size_t chunks_pending = 0;
+  std::string error_details;
+  while (state.KeepRunning()) {
+    size_t written;
+    buffer.OnStreamData(offset, chunk, &written, &error_details);
+    offset += kChunkSize;
+    if (++chunks_pending == kChunksPerRead) {
+      size_t read;
+      buffer.Readv(&iov, 1, &read, &error_details);
+      chunks_pending = 0;
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * kChunkSize);
+}
+QUICHE_BENCHMARK(BM_SequencerBufferInOrderWrites);
+
+// Every other frame arrives one chunk early, so half of the writes land
+// past a gap and half of them fill one.
+void BM_SequencerBufferReorderedWrites(quiche::QuicheBenchmarkState& state) {
+  QuicStreamSequencerBuffer buffer(2 * 1024 * 1024);
+  const std::string chunk(kChunkSize, 'q');
+  char dest[2 * kChunkSize];
+  iovec iov{dest, sizeof(dest)};
+  QuicStreamOffset offset = 0;
+  std::string error_details;
+  while (state.KeepRunning()) {
+    size_t written;
+    buffer.OnStreamData(offset + kChunkSize, chunk, &written, &error_details);
+    buffer.OnStreamData(offset, chunk, &written, &error_details);
+    offset += 2 * kChunkSize;
+    size_t read;
+    buffer.Readv(&iov, 1, &read, &error_details);
+  }
+  state.SetBytesProcessed(state.iterations() * 2 * kChunkSize);
+}
+QUICHE_BENCHMARK(BM_SequencerBufferReorderedWrites);
+
+// Adversarial pattern: one-byte frames at alternating offsets, so every
+// write lands disjoint from all received data and the interval set tracks
+// |num_intervals| entries.  Steady state writes one new disjoint byte and
+// fills the oldest gap per iteration, keeping the interval count constant
+// while exercising both the append and the gap-filling path.
+void TinyDisjointFragments(quiche::QuicheBenchmarkState& state,
+                           size_t num_intervals) {
+  QuicStreamSequencerBuffer buffer(2 * 1024 * 1024);
+  std::string error_details;
+  size_t written;
+  // Pre-fragment the buffer: [1,2), [3,4), ...
+  for (QuicStreamOffset offset = 1; offset < 2 * num_intervals; offset += 2) {
+    buffer.OnStreamData(offset, "a", &written, &error_details);
+  }
+  QuicStreamOffset next_disjoint = 2 * num_intervals + 1;
+  QuicStreamOffset next_gap = 0;
+  char dest[4 * 1024];
+  iovec iov{dest, sizeof(dest)};
+  while (state.KeepRunning()) {
+    buffer.OnStreamData(next_disjoint, "a", &written, &error_details);
+    next_disjoint += 2;
+    buffer.OnStreamData(next_gap, "a", &written, &error_details);
+    next_gap += 2;
+    size_t read;
+    buffer.Readv(&iov, 1, &read, &error_details);
+  }
+  state.SetBytesProcessed(state.iterations() * 2);
+}
+
+void BM_SequencerBufferTinyFragments100(quiche::QuicheBenchmarkState& state) {
+  TinyDisjointFragments(state, 100);
+}
+QUICHE_BENCHMARK(BM_SequencerBufferTinyFragments100);
+
+void BM_SequencerBufferTinyFragments1000(quiche::QuicheBenchmarkState& state) {
+  TinyDisjointFragments(state, 1000);
+}
+QUICHE_BENCHMARK(BM_SequencerBufferTinyFragments1000);
+
+void BM_SequencerBufferTinyFragments5000(quiche::QuicheBenchmarkState& state) {
+  TinyDisjointFragments(state, 5000);
+}
+QUICHE_BENCHMARK(BM_SequencerBufferTinyFragments5000);
+
+// Adversarial pattern: every frame overlaps already received data on both
+// sides, forcing the slow path that computes the set difference against the
+// tracked intervals before discovering a single new byte.
+void OverlappingFragments(quiche::QuicheBenchmarkState& state,
+                          size_t num_intervals) {
+  QuicStreamSequencerBuffer buffer(2 * 1024 * 1024);
+  std::string error_details;
+  size_t written;
+  // Two-byte entries at [1,3), [5,7), ... so that a four-byte write over an
+  // entry overlaps it and adds one new byte on each side.
+  for (QuicStreamOffset offset = 1; offset < 4 * num_intervals; offset += 4) {
+    buffer.OnStreamData(offset, "aa", &written, &error_details);
+  }
+  const QuicStreamOffset base = 4 * num_intervals + 1;
+  QuicStreamOffset rewrite = 1;
+  while (state.KeepRunning()) {
+    buffer.OnStreamData(rewrite - 1, "aaaa", &written, &error_details);
+    rewrite += 4;
+    if (rewrite >= base) {
+      rewrite = 1;
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * 4);
+}
+
+void BM_SequencerBufferOverlappingFragments100(
+    quiche::QuicheBenchmarkState& state) {
+  OverlappingFragments(state, 100);
+}
+QUICHE_BENCHMARK(BM_SequencerBufferOverlappingFragments100);
+
+void BM_SequencerBufferOverlappingFragments1000(
+    quiche::QuicheBenchmarkState& state) {
+  OverlappingFragments(state, 1000);
+}
+QUICHE_BENCHMARK(BM_SequencerBufferOverlappingFragments1000);
+
+}  // namespace
+}  // namespace quic
+
+QUICHE_BENCHMARK_MAIN();
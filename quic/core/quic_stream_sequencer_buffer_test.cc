@@ -467,6 +467,20 @@ TEST_F(QuicStreamSequencerBufferTest, ReleaseWholeBuffer) {
   EXPECT_FALSE(helper_->IsBufferAllocated());
 }
 
+TEST_F(QuicStreamSequencerBufferTest, AllocatedBytes) {
+  EXPECT_EQ(0u, buffer_->AllocatedBytes());
+  // Writing 1 byte allocates a whole block.
+  buffer_->OnStreamData(0, "a", &written_, &error_details_);
+  EXPECT_EQ(kBlockSizeBytes, buffer_->AllocatedBytes());
+  // An out-of-order write in a later block allocates another block.
+  std::string source(100, 'b');
+  buffer_->OnStreamData(2 * kBlockSizeBytes, source, &written_, &error_details_);
+  EXPECT_EQ(2 * kBlockSizeBytes, buffer_->AllocatedBytes());
+  EXPECT_GT(buffer_->AllocatedBytes(), buffer_->BytesBuffered());
+  buffer_->ReleaseWholeBuffer();
+  EXPECT_EQ(0u, buffer_->AllocatedBytes());
+}
+
 TEST_F(QuicStreamSequencerBufferTest, GetReadableRegionsBlockedByGap) {
   // Write into [1, 1024).
   std::string source(1023, 'a');
@@ -861,6 +875,26 @@ TEST_F(QuicStreamSequencerBufferTest, TooManyGaps) {
   }
 }
 
+TEST_F(QuicStreamSequencerBufferTest, LoweredMaxDataIntervals) {
+  buffer_->set_max_data_intervals(10);
+
+  // One-byte frames at alternating offsets; the 10th disjoint frame exceeds
+  // the budget.
+  for (QuicStreamOffset begin = 1; begin <= 17; begin += 2) {
+    EXPECT_THAT(buffer_->OnStreamData(begin, "a", &written_, &error_details_),
+                IsQuicNoError());
+  }
+  EXPECT_EQ(9u, buffer_->num_data_intervals());
+  EXPECT_THAT(buffer_->OnStreamData(19, "a", &written_, &error_details_),
+              IsError(QUIC_TOO_MANY_STREAM_DATA_INTERVALS));
+
+  // Contiguous data does not consume the budget: filling a gap coalesces
+  // intervals and frees one slot.
+  EXPECT_THAT(buffer_->OnStreamData(2, "a", &written_, &error_details_),
+              IsQuicNoError());
+  EXPECT_EQ(9u, buffer_->num_data_intervals());
+}
+
 class QuicStreamSequencerBufferRandomIOTest
     : public QuicStreamSequencerBufferTest {
  public:
@@ -1132,6 +1166,33 @@ TEST_F(QuicStreamSequencerBufferTest, GrowBlockSizeOnDemand) {
   ASSERT_EQ(helper_->current_blocks_count(), 1024u);
 }
 
+TEST_F(QuicStreamSequencerBufferTest, RetiredBlocksAreRecycled) {
+  // Fill and drain one full block; retiring it hands the block to the
+  // per-thread recycler rather than the allocator.
+  std::string source(kBlockSizeBytes, 'a');
+  buffer_->OnStreamData(0, source, &written_, &error_details_);
+  const size_t recycled_before =
+      QuicStreamSequencerBuffer::NumRecycledBlocksForThread();
+  char dest[kBlockSizeBytes];
+  iovec iovecs[1]{iovec{dest, kBlockSizeBytes}};
+  size_t read;
+  EXPECT_THAT(buffer_->Readv(iovecs, 1, &read, &error_details_),
+              IsQuicNoError());
+  EXPECT_EQ(kBlockSizeBytes, read);
+  // The pool is far below its bound in tests, so the block must have been
+  // recycled rather than freed.
+  ASSERT_LT(recycled_before, QuicStreamSequencerBuffer::kMaxRecycledBlocks);
+  EXPECT_EQ(recycled_before + 1,
+            QuicStreamSequencerBuffer::NumRecycledBlocksForThread());
+  EXPECT_LE(recycled_before + 1,
+            QuicStreamSequencerBuffer::RecycledBlocksHighWaterMarkForThread());
+
+  // Writing again draws the block back out of the recycler.
+  buffer_->OnStreamData(kBlockSizeBytes, source, &written_, &error_details_);
+  EXPECT_EQ(recycled_before,
+            QuicStreamSequencerBuffer::NumRecycledBlocksForThread());
+}
+
 }  // anonymous namespace
 
 }  // namespace test
@@ -6,6 +6,7 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <limits>
 #include <memory>
 #include <string>
 #include <utility>
@@ -776,6 +777,111 @@ TEST_F(QuicStreamSequencerTest, ReceiveFinLessThanHighestOffset) {
   OnFinFrame(0u, "");
 }
 
+TEST_F(QuicStreamSequencerTest, ReassemblyHardeningResetsStream) {
+  sequencer_->EnableReassemblyHardening(/*max_data_intervals=*/10);
+
+  // The budget exceeding frame resets the stream instead of closing the
+  // connection.
+  EXPECT_CALL(stream_, ResetWithError(QuicResetStreamError::FromInternal(
+                           QUIC_STREAM_EXCESSIVE_LOAD)));
+
+  // One-byte frames at alternating offsets, each creating a new interval.
+  for (QuicStreamOffset offset = 1; offset <= 19; offset += 2) {
+    OnFrame(offset, "a");
+  }
+}
+
+TEST_F(QuicStreamSequencerTest, ReassemblyHardeningAllowsContiguousData) {
+  sequencer_->EnableReassemblyHardening(/*max_data_intervals=*/10);
+
+  // Contiguous data never accumulates intervals, regardless of volume.
+  EXPECT_CALL(stream_, OnDataAvailable()).Times(testing::AnyNumber());
+  std::string data(100, 'a');
+  for (QuicStreamOffset offset = 0; offset < 10000; offset += 100) {
+    OnFrame(offset, data.c_str());
+  }
+}
+
+// A stream that opts into direct delivery of in-order data, consuming up to
+// |max_bytes_per_call_| bytes per frame.
+class InOrderConsumingStream : public MockStream {
+ public:
+  size_t OnInOrderDataAvailable(absl::string_view data) override {
+    const size_t bytes_consumed = std::min(max_bytes_per_call_, data.size());
+    in_order_data_.append(data.data(), bytes_consumed);
+    return bytes_consumed;
+  }
+
+  size_t max_bytes_per_call_ = std::numeric_limits<size_t>::max();
+  std::string in_order_data_;
+};
+
+class QuicStreamSequencerInOrderDeliveryTest : public QuicStreamSequencerTest {
+ protected:
+  QuicStreamSequencerInOrderDeliveryTest() {
+    sequencer_ = std::make_unique<QuicStreamSequencer>(&in_order_stream_);
+  }
+
+  testing::StrictMock<InOrderConsumingStream> in_order_stream_;
+};
+
+TEST_F(QuicStreamSequencerInOrderDeliveryTest, DeliverWithoutBuffering) {
+  EXPECT_CALL(in_order_stream_, AddBytesConsumed(3)).Times(2);
+
+  OnFrame(0, "abc");
+  EXPECT_EQ(0u, NumBufferedBytes());
+  EXPECT_EQ(3u, sequencer_->NumBytesConsumed());
+  EXPECT_EQ("abc", in_order_stream_.in_order_data_);
+
+  // A retransmission of directly delivered data is a duplicate.
+  OnFrame(0, "abc");
+  EXPECT_EQ(1, sequencer_->num_duplicate_frames_received());
+
+  OnFrame(3, "def");
+  EXPECT_EQ(0u, NumBufferedBytes());
+  EXPECT_EQ(6u, sequencer_->NumBytesConsumed());
+  EXPECT_EQ("abcdef", in_order_stream_.in_order_data_);
+}
+
+TEST_F(QuicStreamSequencerInOrderDeliveryTest, FinAfterDirectDelivery) {
+  EXPECT_CALL(in_order_stream_, AddBytesConsumed(3));
+  // The frame is fully consumed in OnInOrderDataAvailable(), so the FIN at
+  // its end is deliverable as soon as the frame has been processed.
+  EXPECT_CALL(in_order_stream_, OnDataAvailable())
+      .WillOnce(testing::Invoke(
+          [this]() { EXPECT_TRUE(sequencer_->IsClosed()); }));
+
+  OnFinFrame(0, "abc");
+  EXPECT_EQ(0u, NumBufferedBytes());
+  EXPECT_EQ("abc", in_order_stream_.in_order_data_);
+}
+
+TEST_F(QuicStreamSequencerInOrderDeliveryTest, PartialConsumeBuffersRemainder) {
+  in_order_stream_.max_bytes_per_call_ = 2;
+  EXPECT_CALL(in_order_stream_, AddBytesConsumed(2));
+  EXPECT_CALL(in_order_stream_, OnDataAvailable());
+
+  OnFrame(0, "abcdef");
+  EXPECT_EQ("ab", in_order_stream_.in_order_data_);
+  EXPECT_EQ(2u, sequencer_->NumBytesConsumed());
+  EXPECT_EQ(4u, NumBufferedBytes());
+  EXPECT_TRUE(VerifyReadableRegion(std::vector<std::string>{"cdef"}));
+}
+
+TEST_F(QuicStreamSequencerInOrderDeliveryTest, BufferedDataDisablesFastPath) {
+  EXPECT_CALL(in_order_stream_, OnDataAvailable());
+
+  OnFrame(3, "def");
+  EXPECT_EQ(3u, NumBufferedBytes());
+
+  // Data filling the gap goes through the buffer; none of it is delivered
+  // directly because bytes are already buffered ahead of it.
+  OnFrame(0, "abc");
+  EXPECT_TRUE(in_order_stream_.in_order_data_.empty());
+  EXPECT_EQ(6u, NumBufferedBytes());
+  EXPECT_TRUE(VerifyReadableRegions(std::vector<std::string>{"abcdef"}));
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace quic
@@ -0,0 +1,121 @@
+// Copyright (c) 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/quic_stream_slab_allocator.h"
+
+#include <cstdint>
+#include <new>
+
+#include "quic/platform/api/quic_logging.h"
+
+namespace quic {
+namespace {
+
+// Block sizes are rounded up to multiples of the granularity; one bucket per
+// size class. Stream objects across the tree are a few hundred bytes to a
+// couple of kilobytes, so anything larger is not worth holding onto.
+constexpr size_t kGranularity = 64;
+constexpr size_t kMaxRecycledSize = 4096;
+constexpr size_t kNumBuckets = kMaxRecycledSize / kGranularity;
+// Caps how many released blocks a bucket retains; beyond this, blocks go
+// back to the global allocator.
+constexpr size_t kMaxBlocksPerBucket = 64;
+
+// Every block carries its total size in a header, so Release() can find the
+// bucket without the caller passing the size. The header is one alignment
+// unit so the payload stays aligned for any object type.
+constexpr size_t kHeaderSize = alignof(max_align_t);
+
+static_assert(kHeaderSize >= sizeof(size_t), "Header must hold the size");
+
+struct FreeBlock {
+  FreeBlock* next;
+};
+
+struct Freelist {
+  FreeBlock* buckets[kNumBuckets] = {};
+  size_t num_blocks[kNumBuckets] = {};
+
+  ~Freelist() { Drain(); }
+
+  void Drain() {
+    for (size_t i = 0; i < kNumBuckets; ++i) {
+      while (buckets[i] != nullptr) {
+        FreeBlock* block = buckets[i];
+        buckets[i] = block->next;
+        ::operator delete(block);
+      }
+      num_blocks[i] = 0;
+    }
+  }
+};
+
+Freelist* GetFreelist() {
+  static thread_local Freelist freelist;
+  return &freelist;
+}
+
+size_t TotalBlockSize(size_t payload_size) {
+  const size_t unrounded = payload_size + kHeaderSize;
+  return (unrounded + kGranularity - 1) / kGranularity * kGranularity;
+}
+
+}  // namespace
+
+// static
+void* QuicStreamSlabAllocator::Allocate(size_t size) {
+  const size_t total_size = TotalBlockSize(size);
+  void* raw = nullptr;
+  if (total_size <= kMaxRecycledSize) {
+    const size_t bucket = total_size / kGranularity - 1;
+    Freelist* freelist = GetFreelist();
+    if (freelist->buckets[bucket] != nullptr) {
+      FreeBlock* block = freelist->buckets[bucket];
+      freelist->buckets[bucket] = block->next;
+      --freelist->num_blocks[bucket];
+      raw = block;
+    }
+  }
+  if (raw == nullptr) {
+    raw = ::operator new(total_size);
+  }
+  *static_cast<size_t*>(raw) = total_size;
+  return static_cast<char*>(raw) + kHeaderSize;
+}
+
+// static
+void QuicStreamSlabAllocator::Release(void* ptr) {
+  if (ptr == nullptr) {
+    return;
+  }
+  void* raw = static_cast<char*>(ptr) - kHeaderSize;
+  const size_t total_size = *static_cast<size_t*>(raw);
+  if (total_size <= kMaxRecycledSize) {
+    const size_t bucket = total_size / kGranularity - 1;
+    Freelist* freelist = GetFreelist();
+    if (freelist->num_blocks[bucket] < kMaxBlocksPerBucket) {
+      FreeBlock* block = static_cast<FreeBlock*>(raw);
+      block->next = freelist->buckets[bucket];
+      freelist->buckets[bucket] = block;
+      ++freelist->num_blocks[bucket];
+      return;
+    }
+  }
+  ::operator delete(raw);
+}
+
+// static
+size_t QuicStreamSlabAllocator::NumFreeBlocksForTesting() {
+  size_t total = 0;
+  Freelist* freelist = GetFreelist();
+  for (size_t i = 0; i < kNumBuckets; ++i) {
+    total += freelist->num_blocks[i];
+  }
+  return total;
+}
+
+// static
+void QuicStreamSlabAllocator::DrainForTesting() { GetFreelist()->Drain(); }
+
+}  // namespace quic
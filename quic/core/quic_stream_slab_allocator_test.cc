@@ -0,0 +1,83 @@
+// Copyright (c) 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/quic_stream_slab_allocator.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "quic/platform/api/quic_test.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+class QuicStreamSlabAllocatorTest : public QuicTest {
+ protected:
+  QuicStreamSlabAllocatorTest() {
+    // Isolate from blocks released by earlier tests on this thread.
+    QuicStreamSlabAllocator::DrainForTesting();
+  }
+
+  ~QuicStreamSlabAllocatorTest() override {
+    QuicStreamSlabAllocator::DrainForTesting();
+  }
+};
+
+TEST_F(QuicStreamSlabAllocatorTest, ReleasedBlockIsReused) {
+  void* first = QuicStreamSlabAllocator::Allocate(300);
+  QuicStreamSlabAllocator::Release(first);
+  EXPECT_EQ(1u, QuicStreamSlabAllocator::NumFreeBlocksForTesting());
+
+  // An allocation of the same size class pops the recycled block.
+  void* second = QuicStreamSlabAllocator::Allocate(300);
+  EXPECT_EQ(first, second);
+  EXPECT_EQ(0u, QuicStreamSlabAllocator::NumFreeBlocksForTesting());
+  QuicStreamSlabAllocator::Release(second);
+}
+
+TEST_F(QuicStreamSlabAllocatorTest, SizeClassesDoNotMix) {
+  void* small = QuicStreamSlabAllocator::Allocate(100);
+  QuicStreamSlabAllocator::Release(small);
+
+  // The 100 byte block stays on its bucket; a much larger request gets a
+  // fresh block.
+  void* large = QuicStreamSlabAllocator::Allocate(2000);
+  EXPECT_NE(small, large);
+  EXPECT_EQ(1u, QuicStreamSlabAllocator::NumFreeBlocksForTesting());
+  QuicStreamSlabAllocator::Release(large);
+}
+
+TEST_F(QuicStreamSlabAllocatorTest, BlocksAreAligned) {
+  for (size_t size : {1, 100, 300, 1000, 4000, 10000}) {
+    void* ptr = QuicStreamSlabAllocator::Allocate(size);
+    EXPECT_EQ(0u,
+              reinterpret_cast<uintptr_t>(ptr) % alignof(max_align_t))
+        << "size: " << size;
+    QuicStreamSlabAllocator::Release(ptr);
+  }
+}
+
+TEST_F(QuicStreamSlabAllocatorTest, OversizedBlocksAreNotRetained) {
+  void* ptr = QuicStreamSlabAllocator::Allocate(64 * 1024);
+  QuicStreamSlabAllocator::Release(ptr);
+  EXPECT_EQ(0u, QuicStreamSlabAllocator::NumFreeBlocksForTesting());
+}
+
+TEST_F(QuicStreamSlabAllocatorTest, FreelistIsBounded) {
+  std::vector<void*> blocks;
+  for (int i = 0; i < 200; ++i) {
+    blocks.push_back(QuicStreamSlabAllocator::Allocate(300));
+  }
+  for (void* block : blocks) {
+    QuicStreamSlabAllocator::Release(block);
+  }
+  // The bucket retains only its cap; the rest went back to the allocator.
+  EXPECT_LT(QuicStreamSlabAllocator::NumFreeBlocksForTesting(), 200u);
+  EXPECT_GT(QuicStreamSlabAllocator::NumFreeBlocksForTesting(), 0u);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
@@ -4,12 +4,15 @@
 
 #include "quic/core/quic_stream.h"
 
+#include <algorithm>
+#include <limits>
 #include <memory>
 #include <string>
 #include <utility>
 
 #include "absl/base/macros.h"
 #include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/optional.h"
 #include "quic/core/crypto/null_encrypter.h"
@@ -67,6 +70,10 @@ class TestStream : public QuicStream {
 
   MOCK_METHOD(void, OnWriteSideInDataRecvdState, (), (override));
 
+  MOCK_METHOD(void, OnSendBufferHighWatermark, (), (override));
+
+  MOCK_METHOD(void, OnSendBufferLowWatermark, (), (override));
+
   using QuicStream::CanWriteNewData;
   using QuicStream::CanWriteNewDataAfterData;
   using QuicStream::CloseWriteSide;
@@ -80,6 +87,29 @@ class TestStream : public QuicStream {
   std::string data_;
 };
 
+// Sink which accumulates delivered data, optionally limiting how many bytes
+// it accepts in total to exercise backpressure.
+class TestDataSink : public QuicStreamDataSink {
+ public:
+  size_t OnStreamData(QuicStreamId /*id*/, absl::string_view data) override {
+    const size_t accepted = std::min(data.size(), accept_limit_ - data_.size());
+    data_.append(data.data(), accepted);
+    return accepted;
+  }
+
+  void OnFinConsumed(QuicStreamId /*id*/) override { fin_consumed_ = true; }
+
+  void set_accept_limit(size_t limit) { accept_limit_ = limit; }
+
+  const std::string& data() const { return data_; }
+  bool fin_consumed() const { return fin_consumed_; }
+
+ private:
+  std::string data_;
+  size_t accept_limit_ = std::numeric_limits<size_t>::max();
+  bool fin_consumed_ = false;
+};
+
 class QuicStreamTest : public QuicTestWithParam<ParsedQuicVersion> {
  public:
   QuicStreamTest()
@@ -357,6 +387,25 @@ TEST_P(QuicStreamTest, WriteAllData) {
   EXPECT_FALSE(HasWriteBlockedStreams());
 }
 
+TEST_P(QuicStreamTest, SetQosClass) {
+  Initialize();
+
+  EXPECT_EQ(QOS_CLASS_DEFAULT, stream_->qos_class());
+
+  // Non-expedited classes do not change the stream's precedence.
+  const spdy::SpdyStreamPrecedence initial_precedence = stream_->precedence();
+  stream_->SetQosClass(QOS_CLASS_INTERACTIVE);
+  EXPECT_EQ(QOS_CLASS_INTERACTIVE, stream_->qos_class());
+  EXPECT_EQ(initial_precedence.spdy3_priority(),
+            stream_->precedence().spdy3_priority());
+
+  // The expedited class also raises the stream to the highest internal
+  // scheduling priority.
+  stream_->SetQosClass(QOS_CLASS_EXPEDITED);
+  EXPECT_EQ(QOS_CLASS_EXPEDITED, stream_->qos_class());
+  EXPECT_EQ(spdy::kV3HighestPriority, stream_->precedence().spdy3_priority());
+}
+
 TEST_P(QuicStreamTest, NoBlockingIfNoDataOrFin) {
   Initialize();
 
@@ -687,6 +736,84 @@ TEST_P(QuicStreamTest, StopReadingSendsFlowControl) {
             QuicStreamPeer::ReceiveWindowOffset(stream_));
 }
 
+TEST_P(QuicStreamTest, DataSinkReceivesInOrderData) {
+  Initialize();
+
+  TestDataSink sink;
+  stream_->set_data_sink(&sink);
+
+  // In-order data goes straight to the sink; the stream is never told to
+  // read and nothing is buffered in the sequencer.
+  EXPECT_CALL(*stream_, OnDataAvailable()).Times(0);
+  stream_->OnStreamFrame(QuicStreamFrame(stream_->id(), false, 0, kData1));
+  EXPECT_EQ(kData1, sink.data());
+  EXPECT_EQ(kDataLen, stream_->stream_bytes_read());
+
+  // A FIN at the end of fully consumed data is surfaced to the sink and
+  // closes the read side.
+  stream_->OnStreamFrame(QuicStreamFrame(stream_->id(), true, kDataLen, kData2));
+  EXPECT_EQ(absl::StrCat(kData1, kData2), sink.data());
+  EXPECT_TRUE(sink.fin_consumed());
+  EXPECT_TRUE(stream_->read_side_closed());
+}
+
+TEST_P(QuicStreamTest, DataSinkDrainsBufferAfterHoleFilled) {
+  Initialize();
+
+  TestDataSink sink;
+  stream_->set_data_sink(&sink);
+
+  // Out-of-order data is buffered; nothing is readable yet.
+  stream_->OnStreamFrame(
+      QuicStreamFrame(stream_->id(), false, kDataLen, kData2));
+  EXPECT_TRUE(sink.data().empty());
+
+  // Filling the hole makes everything contiguous. The hole-filling frame is
+  // buffered (the fast path requires an empty buffer), so the sequencer
+  // notifies the stream once, and the stream drains the buffer into the sink.
+  EXPECT_CALL(*stream_, OnDataAvailable());
+  stream_->OnStreamFrame(QuicStreamFrame(stream_->id(), false, 0, kData1));
+  EXPECT_EQ(absl::StrCat(kData1, kData2), sink.data());
+  EXPECT_EQ(2 * kDataLen, stream_->stream_bytes_read());
+}
+
+TEST_P(QuicStreamTest, DataSinkBackpressure) {
+  Initialize();
+
+  TestDataSink sink;
+  sink.set_accept_limit(3);
+  stream_->set_data_sink(&sink);
+
+  // The sink only accepts 3 bytes; the remainder stays buffered in the
+  // sequencer and the stream is notified of the buffered data.
+  EXPECT_CALL(*stream_, OnDataAvailable());
+  stream_->OnStreamFrame(QuicStreamFrame(stream_->id(), false, 0, kData1));
+  EXPECT_EQ("Foo", sink.data());
+  EXPECT_EQ(3u, stream_->stream_bytes_read());
+
+  // Once the sink has capacity again, the next frame triggers a drain of the
+  // buffered remainder followed by the new data.
+  sink.set_accept_limit(std::numeric_limits<size_t>::max());
+  EXPECT_CALL(*stream_, OnDataAvailable());
+  stream_->OnStreamFrame(QuicStreamFrame(stream_->id(), false, kDataLen, kData2));
+  EXPECT_EQ(absl::StrCat(kData1, kData2), sink.data());
+  EXPECT_EQ(2 * kDataLen, stream_->stream_bytes_read());
+}
+
+TEST_P(QuicStreamTest, DataSinkRegisteredAfterDataBuffered) {
+  Initialize();
+
+  // Without a sink, received data is buffered as usual.
+  EXPECT_CALL(*stream_, OnDataAvailable());
+  stream_->OnStreamFrame(QuicStreamFrame(stream_->id(), false, 0, kData1));
+
+  // Registering a sink immediately drains what is already buffered.
+  TestDataSink sink;
+  stream_->set_data_sink(&sink);
+  EXPECT_EQ(kData1, sink.data());
+  EXPECT_EQ(kDataLen, stream_->stream_bytes_read());
+}
+
 TEST_P(QuicStreamTest, FinalByteOffsetFromFin) {
   Initialize();
 
@@ -1108,6 +1235,42 @@ TEST_P(QuicStreamTest, CanWriteNewDataAfterData) {
   EXPECT_FALSE(stream_->CanWriteNewDataAfterData(100));
 }
 
+TEST_P(QuicStreamTest, SendBufferWatermarkSignals) {
+  Initialize();
+  stream_->SetSendBufferWatermarks(/*low_watermark=*/100,
+                                   /*high_watermark=*/1000);
+  std::string data(600, 'a');
+
+  // The first write is consumed in full, so nothing gets buffered and no
+  // signal fires.
+  EXPECT_CALL(*session_, WritevData(_, _, _, _, _, _))
+      .WillOnce(Invoke(session_.get(), &MockQuicSession::ConsumeData));
+  EXPECT_CALL(*stream_, OnSendBufferHighWatermark()).Times(0);
+  stream_->WriteOrBufferData(data, false, nullptr);
+  EXPECT_EQ(0u, stream_->BufferedDataBytes());
+
+  // Buffer two writes without sending. Only the second one crosses the high
+  // watermark, and the signal is edge-triggered.
+  EXPECT_CALL(*session_, WritevData(_, _, _, _, _, _))
+      .WillOnce(Return(QuicConsumedData(0, false)));
+  stream_->WriteOrBufferData(data, false, nullptr);
+  EXPECT_CALL(*stream_, OnSendBufferHighWatermark()).Times(1);
+  stream_->WriteOrBufferData(data, false, nullptr);
+  EXPECT_EQ(2 * data.length(), stream_->BufferedDataBytes());
+
+  // Draining back to the low watermark fires the low signal exactly once,
+  // from the consume path.
+  EXPECT_CALL(*session_, WritevData(_, _, _, _, _, _))
+      .WillOnce(InvokeWithoutArgs([this]() {
+        return session_->ConsumeData(stream_->id(), 1100u, 600u, NO_FIN,
+                                     NOT_RETRANSMISSION, absl::nullopt);
+      }));
+  EXPECT_CALL(*stream_, OnSendBufferLowWatermark()).Times(1);
+  EXPECT_CALL(*stream_, OnCanWriteNewData()).Times(1);
+  stream_->OnCanWrite();
+  EXPECT_EQ(100u, stream_->BufferedDataBytes());
+}
+
 TEST_P(QuicStreamTest, WriteBufferedData) {
   // Set buffered data low water mark to be 100.
   SetQuicFlag(FLAGS_quic_buffered_data_threshold, 100);
@@ -1310,6 +1473,41 @@ TEST_P(QuicStreamTest, WriteMemSlices) {
   EXPECT_TRUE(stream_->write_side_closed());
 }
 
+TEST_P(QuicStreamTest, WriteExternalBuffer) {
+  // Set buffered data low water mark to be 100.
+  SetQuicFlag(FLAGS_quic_buffered_data_threshold, 100);
+
+  Initialize();
+  constexpr QuicByteCount kDataSize = 1024;
+  const std::string data(kDataSize, 'a');
+
+  QuicReferenceCountedPointer<QuicExternalSendBuffer> buffer(
+      new QuicExternalSendBuffer(data.data(), data.size()));
+  EXPECT_CALL(*session_, WritevData(_, _, _, _, _, _))
+      .WillOnce(InvokeWithoutArgs([this]() {
+        return session_->ConsumeData(stream_->id(), 100u, 0u, NO_FIN,
+                                     NOT_RETRANSMISSION, absl::nullopt);
+      }));
+  // There is no buffered data before; the whole buffer is pinned without a
+  // copy and partially sent.
+  QuicConsumedData consumed =
+      stream_->WriteExternalBuffer(std::move(buffer), false);
+  EXPECT_EQ(kDataSize, consumed.bytes_consumed);
+  EXPECT_FALSE(consumed.fin_consumed);
+  EXPECT_EQ(kDataSize - 100, stream_->BufferedDataBytes());
+
+  // Buffered data is beyond the upper limit: the all-or-nothing write
+  // consumes nothing.
+  QuicReferenceCountedPointer<QuicExternalSendBuffer> buffer2(
+      new QuicExternalSendBuffer(data.data(), data.size()));
+  EXPECT_CALL(*session_, WritevData(_, _, _, _, _, _)).Times(0);
+  consumed = stream_->WriteExternalBuffer(std::move(buffer2), true);
+  EXPECT_EQ(0u, consumed.bytes_consumed);
+  EXPECT_FALSE(consumed.fin_consumed);
+  EXPECT_FALSE(stream_->fin_buffered());
+  EXPECT_EQ(kDataSize - 100, stream_->BufferedDataBytes());
+}
+
 TEST_P(QuicStreamTest, WriteMemSlicesReachStreamLimit) {
   Initialize();
   QuicStreamPeer::SetStreamBytesWritten(kMaxStreamLength - 5u, stream_);
@@ -0,0 +1,199 @@
+// Copyright (c) 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_QUIC_STRIPED_LRU_CACHE_H_
+#define QUICHE_QUIC_CORE_QUIC_STRIPED_LRU_CACHE_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "quic/platform/api/quic_export.h"
+#include "quic/platform/api/quic_logging.h"
+#include "quic/platform/api/quic_mutex.h"
+#include "common/quiche_linked_hash_map.h"
+
+namespace quic {
+
+// A thread-safe LRU cache for state shared across connections or dispatcher
+// shards, such as compressed certificate chains. Unlike QuicLRUCache, which
+// must stay confined to one thread, entries are handed out as
+// std::shared_ptr<const V>: a looked-up value stays valid even if another
+// thread evicts it a moment later, so no reader ever observes reclaimed
+// memory.
+//
+// The key space is partitioned into |num_stripes| independently locked
+// segments, each with its own LRU list, so threads touching different keys
+// rarely contend. Capacity is expressed as a total cost shared evenly across
+// stripes; by default every entry costs one unit (an entry-count bound), and
+// callers can supply a Cost functor measuring bytes to bound memory instead.
+// Hit, miss and eviction counts are tracked and cheap to read.
+// The default cost function: every entry costs one unit, so the cache
+// capacity bounds the number of entries.
+template <class V>
+struct QUIC_NO_EXPORT QuicStripedLRUCacheUnitCost {
+  size_t operator()(const V& /*value*/) const { return 1; }
+};
+
+template <class K, class V, class Hash = std::hash<K>,
+          class Eq = std::equal_to<K>,
+          class Cost = QuicStripedLRUCacheUnitCost<V>>
+class QUIC_NO_EXPORT QuicStripedLRUCache {
+ public:
+  struct QUIC_NO_EXPORT Stats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+  };
+
+  // |capacity| is the total cost budget, divided evenly across |num_stripes|
+  // segments. A single stripe gives the exact global LRU order of
+  // QuicLRUCache behind one lock; more stripes trade exactness of the global
+  // LRU order for less contention.
+  QuicStripedLRUCache(size_t capacity, size_t num_stripes)
+      : QuicStripedLRUCache(capacity, num_stripes, Cost()) {}
+
+  QuicStripedLRUCache(size_t capacity, size_t num_stripes, Cost cost)
+      : cost_(std::move(cost)) {
+    QUICHE_DCHECK_LT(0u, num_stripes);
+    QUICHE_DCHECK_LE(num_stripes, capacity);
+    stripe_capacity_ = std::max<size_t>(capacity / num_stripes, 1);
+    stripes_.reserve(num_stripes);
+    for (size_t i = 0; i < num_stripes; ++i) {
+      stripes_.push_back(std::make_unique<Stripe>());
+    }
+  }
+
+  QuicStripedLRUCache(const QuicStripedLRUCache&) = delete;
+  QuicStripedLRUCache& operator=(const QuicStripedLRUCache&) = delete;
+
+  // Inserts the |key|, |value| pair, replacing any existing entry for |key|
+  // and evicting least-recently-used entries from the key's stripe until it
+  // is within budget. The cache shares ownership of |value|; lookups that
+  // already handed it out keep it alive after eviction.
+  void Insert(const K& key, std::unique_ptr<V> value) {
+    std::shared_ptr<const V> shared_value(std::move(value));
+    const size_t entry_cost = cost_(*shared_value);
+    Stripe& stripe = StripeForKey(key);
+    QuicWriterMutexLock lock(&stripe.mutex);
+    auto it = stripe.map.find(key);
+    if (it != stripe.map.end()) {
+      stripe.used -= it->second.cost;
+      stripe.map.erase(it);
+    }
+    stripe.map.emplace(key, Entry{std::move(shared_value), entry_cost});
+    stripe.used += entry_cost;
+    while (stripe.used > stripe_capacity_ && stripe.map.size() > 1) {
+      stripe.used -= stripe.map.front().second.cost;
+      stripe.map.pop_front();
+      evictions_.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  // Returns the value for |key| and marks it most recently used, or nullptr
+  // on a miss.
+  std::shared_ptr<const V> Lookup(const K& key) {
+    Stripe& stripe = StripeForKey(key);
+    QuicWriterMutexLock lock(&stripe.mutex);
+    auto it = stripe.map.find(key);
+    if (it == stripe.map.end()) {
+      misses_.fetch_add(1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    // Move the entry to the back of its stripe's LRU list.
+    Entry entry = std::move(it->second);
+    std::shared_ptr<const V> result = entry.value;
+    stripe.map.erase(it);
+    stripe.map.emplace(key, std::move(entry));
+    return result;
+  }
+
+  // Removes the entry for |key|, if any.
+  void Erase(const K& key) {
+    Stripe& stripe = StripeForKey(key);
+    QuicWriterMutexLock lock(&stripe.mutex);
+    auto it = stripe.map.find(key);
+    if (it != stripe.map.end()) {
+      stripe.used -= it->second.cost;
+      stripe.map.erase(it);
+    }
+  }
+
+  // Removes all entries from the cache.
+  void Clear() {
+    for (auto& stripe : stripes_) {
+      QuicWriterMutexLock lock(&stripe->mutex);
+      stripe->map.clear();
+      stripe->used = 0;
+    }
+  }
+
+  // Returns the total cost budget of the cache.
+  size_t MaxSize() const { return stripe_capacity_ * stripes_.size(); }
+
+  // Returns the current number of entries across all stripes.
+  size_t Size() const {
+    size_t size = 0;
+    for (const auto& stripe : stripes_) {
+      QuicWriterMutexLock lock(&stripe->mutex);
+      size += stripe->map.size();
+    }
+    return size;
+  }
+
+  // Returns the current total cost across all stripes.
+  size_t TotalCost() const {
+    size_t used = 0;
+    for (const auto& stripe : stripes_) {
+      QuicWriterMutexLock lock(&stripe->mutex);
+      used += stripe->used;
+    }
+    return used;
+  }
+
+  Stats GetStats() const {
+    Stats stats;
+    stats.hits = hits_.load(std::memory_order_relaxed);
+    stats.misses = misses_.load(std::memory_order_relaxed);
+    stats.evictions = evictions_.load(std::memory_order_relaxed);
+    return stats;
+  }
+
+ private:
+  struct QUIC_NO_EXPORT Entry {
+    std::shared_ptr<const V> value;
+    size_t cost;
+  };
+
+  // A Stripe's map doubles as its LRU list: QuicheLinkedHashMap keeps
+  // insertion order intrusively in the map nodes, with the least recently
+  // used entry at the front.
+  struct QUIC_NO_EXPORT Stripe {
+    mutable QuicMutex mutex;
+    quiche::QuicheLinkedHashMap<K, Entry, Hash, Eq> map
+        QUIC_GUARDED_BY(mutex);
+    size_t used QUIC_GUARDED_BY(mutex) = 0;
+  };
+
+  Stripe& StripeForKey(const K& key) {
+    return *stripes_[Hash()(key) % stripes_.size()];
+  }
+
+  const Cost cost_;
+  size_t stripe_capacity_;
+  // unique_ptr because QuicMutex is neither movable nor copyable.
+  std::vector<std::unique_ptr<Stripe>> stripes_;
+
+  std::atomic<uint64_t> hits_{0};
+  std::atomic<uint64_t> misses_{0};
+  std::atomic<uint64_t> evictions_{0};
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_QUIC_STRIPED_LRU_CACHE_H_
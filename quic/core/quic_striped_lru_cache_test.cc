@@ -0,0 +1,139 @@
+// Copyright (c) 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/quic_striped_lru_cache.h"
+
+#include <memory>
+#include <string>
+
+#include "quic/platform/api/quic_test.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+struct CachedItem {
+  explicit CachedItem(uint32_t new_value) : value(new_value) {}
+
+  uint32_t value;
+};
+
+TEST(QuicStripedLRUCacheTest, InsertAndLookup) {
+  QuicStripedLRUCache<int, CachedItem> cache(5, /*num_stripes=*/1);
+  EXPECT_EQ(nullptr, cache.Lookup(1));
+  EXPECT_EQ(0u, cache.Size());
+  EXPECT_EQ(5u, cache.MaxSize());
+
+  // Check that item 1 was properly inserted.
+  cache.Insert(1, std::make_unique<CachedItem>(11));
+  EXPECT_EQ(1u, cache.Size());
+  EXPECT_EQ(11u, cache.Lookup(1)->value);
+
+  // Check that item 2 overrides item 1.
+  cache.Insert(1, std::make_unique<CachedItem>(12));
+  EXPECT_EQ(1u, cache.Size());
+  EXPECT_EQ(12u, cache.Lookup(1)->value);
+
+  cache.Insert(3, std::make_unique<CachedItem>(13));
+  EXPECT_EQ(2u, cache.Size());
+  EXPECT_EQ(13u, cache.Lookup(3)->value);
+  cache.Erase(3);
+  EXPECT_EQ(nullptr, cache.Lookup(3));
+  EXPECT_EQ(1u, cache.Size());
+
+  cache.Clear();
+  EXPECT_EQ(0u, cache.Size());
+}
+
+TEST(QuicStripedLRUCacheTest, Eviction) {
+  QuicStripedLRUCache<int, CachedItem> cache(3, /*num_stripes=*/1);
+
+  for (int i = 1; i <= 4; ++i) {
+    cache.Insert(i, std::make_unique<CachedItem>(10 + i));
+  }
+
+  EXPECT_EQ(3u, cache.Size());
+  EXPECT_EQ(3u, cache.MaxSize());
+
+  // Make sure item 1 is evicted.
+  EXPECT_EQ(nullptr, cache.Lookup(1));
+  EXPECT_EQ(14u, cache.Lookup(4)->value);
+
+  EXPECT_EQ(12u, cache.Lookup(2)->value);
+  cache.Insert(5, std::make_unique<CachedItem>(15));
+  // Make sure item 3 is evicted.
+  EXPECT_EQ(nullptr, cache.Lookup(3));
+  EXPECT_EQ(15u, cache.Lookup(5)->value);
+}
+
+TEST(QuicStripedLRUCacheTest, EvictedValueOutlivesEviction) {
+  QuicStripedLRUCache<int, CachedItem> cache(1, /*num_stripes=*/1);
+  cache.Insert(1, std::make_unique<CachedItem>(11));
+  std::shared_ptr<const CachedItem> item = cache.Lookup(1);
+  ASSERT_NE(nullptr, item);
+
+  // Inserting a second item evicts the first, but the handed-out value
+  // stays valid.
+  cache.Insert(2, std::make_unique<CachedItem>(12));
+  EXPECT_EQ(nullptr, cache.Lookup(1));
+  EXPECT_EQ(11u, item->value);
+}
+
+TEST(QuicStripedLRUCacheTest, ByteCostEviction) {
+  struct StringCost {
+    size_t operator()(const std::string& value) const { return value.size(); }
+  };
+  QuicStripedLRUCache<int, std::string, std::hash<int>, std::equal_to<int>,
+                      StringCost>
+      cache(10, /*num_stripes=*/1);
+
+  cache.Insert(1, std::make_unique<std::string>("four"));
+  cache.Insert(2, std::make_unique<std::string>("five5"));
+  EXPECT_EQ(2u, cache.Size());
+  EXPECT_EQ(9u, cache.TotalCost());
+
+  // A third entry pushes the total cost over 10 bytes and evicts the least
+  // recently used entry.
+  cache.Insert(3, std::make_unique<std::string>("four"));
+  EXPECT_EQ(nullptr, cache.Lookup(1));
+  EXPECT_EQ(2u, cache.Size());
+  EXPECT_EQ(9u, cache.TotalCost());
+}
+
+TEST(QuicStripedLRUCacheTest, StripesEvictIndependently) {
+  // Two stripes of capacity two each.
+  QuicStripedLRUCache<int, CachedItem> cache(4, /*num_stripes=*/2);
+
+  // std::hash<int> is the identity, so even keys and odd keys land in
+  // different stripes.
+  for (int i = 0; i < 3; ++i) {
+    cache.Insert(2 * i, std::make_unique<CachedItem>(100 + i));
+  }
+  // The even stripe is over budget; its oldest entry is evicted.
+  EXPECT_EQ(nullptr, cache.Lookup(0));
+  EXPECT_EQ(102u, cache.Lookup(4)->value);
+
+  // The odd stripe is unaffected.
+  cache.Insert(1, std::make_unique<CachedItem>(201));
+  EXPECT_EQ(201u, cache.Lookup(1)->value);
+  EXPECT_EQ(3u, cache.Size());
+}
+
+TEST(QuicStripedLRUCacheTest, Stats) {
+  QuicStripedLRUCache<int, CachedItem> cache(2, /*num_stripes=*/1);
+  cache.Insert(1, std::make_unique<CachedItem>(11));
+  EXPECT_NE(nullptr, cache.Lookup(1));
+  EXPECT_EQ(nullptr, cache.Lookup(2));
+  cache.Insert(2, std::make_unique<CachedItem>(12));
+  cache.Insert(3, std::make_unique<CachedItem>(13));
+
+  QuicStripedLRUCache<int, CachedItem>::Stats stats = cache.GetStats();
+  EXPECT_EQ(1u, stats.hits);
+  EXPECT_EQ(1u, stats.misses);
+  EXPECT_EQ(1u, stats.evictions);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
@@ -0,0 +1,143 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/quic_tagged_buffer_allocator.h"
+
+#include <cstring>
+
+#include "absl/strings/str_cat.h"
+#include "quic/platform/api/quic_bug_tracker.h"
+#include "quic/platform/api/quic_logging.h"
+
+namespace quic {
+
+namespace {
+
+// Every tagged buffer is prefixed with its allocation size so Delete() can
+// attribute the release. Sized to max_align_t so the caller-visible buffer
+// keeps the alignment the delegate provided.
+const size_t kTaggedBufferHeaderSize = alignof(max_align_t);
+
+static_assert(kTaggedBufferHeaderSize >= sizeof(uint64_t),
+              "header too small to hold the allocation size");
+
+}  // namespace
+
+absl::string_view QuicBufferTagToString(QuicBufferTag tag) {
+  switch (tag) {
+    case QuicBufferTag::kUntagged:
+      return "untagged";
+    case QuicBufferTag::kSequencer:
+      return "sequencer";
+    case QuicBufferTag::kSendBuffer:
+      return "send_buffer";
+    case QuicBufferTag::kQpack:
+      return "qpack";
+    case QuicBufferTag::kFramerScratch:
+      return "framer_scratch";
+    case QuicBufferTag::kCoalescer:
+      return "coalescer";
+    case QuicBufferTag::kNumTags:
+      break;
+  }
+  return "unknown";
+}
+
+// static
+QuicBufferAllocationProfiler* QuicBufferAllocationProfiler::GetDefault() {
+  static QuicBufferAllocationProfiler* profiler =
+      new QuicBufferAllocationProfiler();
+  return profiler;
+}
+
+void QuicBufferAllocationProfiler::RecordNew(QuicBufferTag tag, size_t size) {
+  TagCounters& counters = counters_[static_cast<size_t>(tag)];
+  counters.total_allocations.fetch_add(1, std::memory_order_relaxed);
+  const size_t live =
+      counters.live_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+  // Racy peaks under concurrent growth can miss the true maximum by a few
+  // in-flight allocations; that is fine for regression tracking.
+  size_t peak = counters.peak_bytes.load(std::memory_order_relaxed);
+  while (live > peak && !counters.peak_bytes.compare_exchange_weak(
+                            peak, live, std::memory_order_relaxed)) {
+  }
+}
+
+void QuicBufferAllocationProfiler::RecordDelete(QuicBufferTag tag,
+                                                size_t size) {
+  TagCounters& counters = counters_[static_cast<size_t>(tag)];
+  QUIC_BUG_IF(quic_buffer_profiler_underflow,
+              counters.live_bytes.load(std::memory_order_relaxed) < size)
+      << "Releasing more " << QuicBufferTagToString(tag)
+      << " bytes than are live.";
+  counters.live_bytes.fetch_sub(size, std::memory_order_relaxed);
+}
+
+QuicBufferAllocationProfiler::TagSnapshot
+QuicBufferAllocationProfiler::GetSnapshot(QuicBufferTag tag) const {
+  const TagCounters& counters = counters_[static_cast<size_t>(tag)];
+  TagSnapshot snapshot;
+  snapshot.live_bytes = counters.live_bytes.load(std::memory_order_relaxed);
+  snapshot.peak_bytes = counters.peak_bytes.load(std::memory_order_relaxed);
+  snapshot.total_allocations =
+      counters.total_allocations.load(std::memory_order_relaxed);
+  return snapshot;
+}
+
+std::string QuicBufferAllocationProfiler::ToString() const {
+  std::string result;
+  for (size_t i = 0; i < static_cast<size_t>(QuicBufferTag::kNumTags); ++i) {
+    const QuicBufferTag tag = static_cast<QuicBufferTag>(i);
+    const TagSnapshot snapshot = GetSnapshot(tag);
+    absl::StrAppend(&result, QuicBufferTagToString(tag),
+                    ": live=", snapshot.live_bytes,
+                    " peak=", snapshot.peak_bytes,
+                    " allocations=", snapshot.total_allocations, "\n");
+  }
+  return result;
+}
+
+QuicTaggedBufferAllocator::QuicTaggedBufferAllocator(
+    QuicBufferAllocator* delegate,
+    QuicBufferTag tag)
+    : QuicTaggedBufferAllocator(delegate,
+                                tag,
+                                QuicBufferAllocationProfiler::GetDefault()) {}
+
+QuicTaggedBufferAllocator::QuicTaggedBufferAllocator(
+    QuicBufferAllocator* delegate,
+    QuicBufferTag tag,
+    QuicBufferAllocationProfiler* profiler)
+    : delegate_(delegate), profiler_(profiler), tag_(tag) {}
+
+QuicTaggedBufferAllocator::~QuicTaggedBufferAllocator() = default;
+
+char* QuicTaggedBufferAllocator::New(size_t size) {
+  return New(size, /*flag_enable=*/true);
+}
+
+char* QuicTaggedBufferAllocator::New(size_t size, bool flag_enable) {
+  char* raw = delegate_->New(kTaggedBufferHeaderSize + size, flag_enable);
+  const uint64_t size64 = size;
+  memcpy(raw, &size64, sizeof(size64));
+  profiler_->RecordNew(tag_, size);
+  return raw + kTaggedBufferHeaderSize;
+}
+
+void QuicTaggedBufferAllocator::Delete(char* buffer) {
+  if (buffer == nullptr) {
+    return;
+  }
+  char* raw = buffer - kTaggedBufferHeaderSize;
+  uint64_t size64;
+  memcpy(&size64, raw, sizeof(size64));
+  profiler_->RecordDelete(tag_, size64);
+  delegate_->Delete(raw);
+}
+
+void QuicTaggedBufferAllocator::MarkAllocatorIdle() {
+  delegate_->MarkAllocatorIdle();
+}
+
+}  // namespace quic
@@ -0,0 +1,110 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_QUIC_TAGGED_BUFFER_ALLOCATOR_H_
+#define QUICHE_QUIC_CORE_QUIC_TAGGED_BUFFER_ALLOCATOR_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "quic/core/quic_buffer_allocator.h"
+#include "quic/platform/api/quic_export.h"
+
+namespace quic {
+
+// Identifies the subsystem a buffer was allocated for, so that allocation
+// regressions can be attributed without a heap profiler.
+enum class QuicBufferTag : uint8_t {
+  kUntagged = 0,
+  kSequencer,
+  kSendBuffer,
+  kQpack,
+  kFramerScratch,
+  kCoalescer,
+  kNumTags,
+};
+
+QUIC_EXPORT_PRIVATE absl::string_view QuicBufferTagToString(QuicBufferTag tag);
+
+// Maintains live-bytes, peak-bytes and allocation-count counters per
+// QuicBufferTag. Thread safe; counters are plain atomics so recording an
+// allocation costs a few uncontended RMW operations. Typically shared by
+// every QuicTaggedBufferAllocator in a process via GetDefault().
+class QUIC_EXPORT_PRIVATE QuicBufferAllocationProfiler {
+ public:
+  struct QUIC_EXPORT_PRIVATE TagSnapshot {
+    size_t live_bytes = 0;
+    size_t peak_bytes = 0;
+    size_t total_allocations = 0;
+  };
+
+  static QuicBufferAllocationProfiler* GetDefault();
+
+  QuicBufferAllocationProfiler() = default;
+  QuicBufferAllocationProfiler(const QuicBufferAllocationProfiler&) = delete;
+  QuicBufferAllocationProfiler& operator=(const QuicBufferAllocationProfiler&) =
+      delete;
+
+  void RecordNew(QuicBufferTag tag, size_t size);
+  void RecordDelete(QuicBufferTag tag, size_t size);
+
+  TagSnapshot GetSnapshot(QuicBufferTag tag) const;
+
+  // One "tag: live=... peak=... allocations=..." line per tag, for dumping
+  // onto a stats or debug surface.
+  std::string ToString() const;
+
+ private:
+  struct TagCounters {
+    std::atomic<size_t> live_bytes{0};
+    std::atomic<size_t> peak_bytes{0};
+    std::atomic<size_t> total_allocations{0};
+  };
+
+  TagCounters counters_[static_cast<size_t>(QuicBufferTag::kNumTags)];
+};
+
+// A QuicBufferAllocator view that attributes every allocation made through
+// it to one QuicBufferTag. Wraps any delegate allocator (SimpleBufferAllocator,
+// QuicNumaBufferAllocator, ...) and prefixes each buffer with a small header
+// recording its size, so Delete() can decrement the tag's live-byte count.
+// Buffers obtained from a tagged allocator must be released through the
+// same (or an equally tagged) tagged allocator, not the delegate.
+//
+// A subsystem opts in by constructing its own view of the shared delegate:
+//
+//   QuicTaggedBufferAllocator sequencer_allocator(
+//       allocator, QuicBufferTag::kSequencer);
+class QUIC_EXPORT_PRIVATE QuicTaggedBufferAllocator
+    : public QuicBufferAllocator {
+ public:
+  // Records into QuicBufferAllocationProfiler::GetDefault().
+  QuicTaggedBufferAllocator(QuicBufferAllocator* delegate, QuicBufferTag tag);
+  QuicTaggedBufferAllocator(QuicBufferAllocator* delegate,
+                            QuicBufferTag tag,
+                            QuicBufferAllocationProfiler* profiler);
+  QuicTaggedBufferAllocator(const QuicTaggedBufferAllocator&) = delete;
+  QuicTaggedBufferAllocator& operator=(const QuicTaggedBufferAllocator&) =
+      delete;
+  ~QuicTaggedBufferAllocator() override;
+
+  char* New(size_t size) override;
+  char* New(size_t size, bool flag_enable) override;
+  void Delete(char* buffer) override;
+  void MarkAllocatorIdle() override;
+
+  QuicBufferTag tag() const { return tag_; }
+
+ private:
+  QuicBufferAllocator* delegate_;            // Not owned.
+  QuicBufferAllocationProfiler* profiler_;   // Not owned.
+  const QuicBufferTag tag_;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_QUIC_TAGGED_BUFFER_ALLOCATOR_H_
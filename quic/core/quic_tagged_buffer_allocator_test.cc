@@ -0,0 +1,97 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/quic_tagged_buffer_allocator.h"
+
+#include <cstring>
+
+#include "quic/core/quic_simple_buffer_allocator.h"
+#include "quic/platform/api/quic_test.h"
+
+namespace quic {
+namespace {
+
+class QuicTaggedBufferAllocatorTest : public QuicTest {
+ protected:
+  QuicBufferAllocationProfiler::TagSnapshot Snapshot(QuicBufferTag tag) {
+    return profiler_.GetSnapshot(tag);
+  }
+
+  SimpleBufferAllocator delegate_;
+  QuicBufferAllocationProfiler profiler_;
+};
+
+TEST_F(QuicTaggedBufferAllocatorTest, TracksLiveAndPeakBytes) {
+  QuicTaggedBufferAllocator alloc(&delegate_, QuicBufferTag::kSequencer,
+                                  &profiler_);
+  char* buffer1 = alloc.New(100);
+  char* buffer2 = alloc.New(50);
+  EXPECT_EQ(150u, Snapshot(QuicBufferTag::kSequencer).live_bytes);
+  EXPECT_EQ(150u, Snapshot(QuicBufferTag::kSequencer).peak_bytes);
+  EXPECT_EQ(2u, Snapshot(QuicBufferTag::kSequencer).total_allocations);
+
+  alloc.Delete(buffer1);
+  EXPECT_EQ(50u, Snapshot(QuicBufferTag::kSequencer).live_bytes);
+  EXPECT_EQ(150u, Snapshot(QuicBufferTag::kSequencer).peak_bytes);
+
+  // The peak survives a later, smaller high-water mark.
+  char* buffer3 = alloc.New(20);
+  EXPECT_EQ(70u, Snapshot(QuicBufferTag::kSequencer).live_bytes);
+  EXPECT_EQ(150u, Snapshot(QuicBufferTag::kSequencer).peak_bytes);
+  EXPECT_EQ(3u, Snapshot(QuicBufferTag::kSequencer).total_allocations);
+
+  alloc.Delete(buffer2);
+  alloc.Delete(buffer3);
+  EXPECT_EQ(0u, Snapshot(QuicBufferTag::kSequencer).live_bytes);
+}
+
+TEST_F(QuicTaggedBufferAllocatorTest, TagsAreIndependent) {
+  QuicTaggedBufferAllocator qpack_alloc(&delegate_, QuicBufferTag::kQpack,
+                                        &profiler_);
+  QuicTaggedBufferAllocator coalescer_alloc(
+      &delegate_, QuicBufferTag::kCoalescer, &profiler_);
+  char* qpack_buffer = qpack_alloc.New(10);
+  char* coalescer_buffer = coalescer_alloc.New(30);
+
+  EXPECT_EQ(10u, Snapshot(QuicBufferTag::kQpack).live_bytes);
+  EXPECT_EQ(30u, Snapshot(QuicBufferTag::kCoalescer).live_bytes);
+  EXPECT_EQ(0u, Snapshot(QuicBufferTag::kSendBuffer).live_bytes);
+
+  qpack_alloc.Delete(qpack_buffer);
+  coalescer_alloc.Delete(coalescer_buffer);
+  EXPECT_EQ(0u, Snapshot(QuicBufferTag::kQpack).live_bytes);
+  EXPECT_EQ(0u, Snapshot(QuicBufferTag::kCoalescer).live_bytes);
+}
+
+TEST_F(QuicTaggedBufferAllocatorTest, BuffersAreUsable) {
+  QuicTaggedBufferAllocator alloc(&delegate_, QuicBufferTag::kFramerScratch,
+                                  &profiler_);
+  char* buffer = alloc.New(64);
+  ASSERT_NE(nullptr, buffer);
+  memset(buffer, 0xab, 64);
+  EXPECT_EQ('\xab', buffer[0]);
+  EXPECT_EQ('\xab', buffer[63]);
+  alloc.Delete(buffer);
+}
+
+TEST_F(QuicTaggedBufferAllocatorTest, DeleteNull) {
+  QuicTaggedBufferAllocator alloc(&delegate_, QuicBufferTag::kUntagged,
+                                  &profiler_);
+  alloc.Delete(nullptr);
+  EXPECT_EQ(0u, Snapshot(QuicBufferTag::kUntagged).total_allocations);
+}
+
+TEST_F(QuicTaggedBufferAllocatorTest, ToStringListsEveryTag) {
+  QuicTaggedBufferAllocator alloc(&delegate_, QuicBufferTag::kSendBuffer,
+                                  &profiler_);
+  char* buffer = alloc.New(42);
+  const std::string dump = profiler_.ToString();
+  EXPECT_NE(std::string::npos,
+            dump.find("send_buffer: live=42 peak=42 allocations=1"));
+  EXPECT_NE(std::string::npos, dump.find("sequencer: live=0"));
+  alloc.Delete(buffer);
+}
+
+}  // namespace
+}  // namespace quic
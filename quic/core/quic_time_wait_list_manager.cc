@@ -81,6 +81,9 @@ QuicTimeWaitListManager::QuicTimeWaitListManager(
       clock_(clock),
       writer_(writer),
       visitor_(visitor) {
+  // The time wait period is measured in seconds, so cleanup can run on a
+  // coarse second-aligned timer rather than a precise heap entry.
+  connection_id_clean_up_alarm_->set_precision(QuicAlarm::Precision::kCoarse1s);
   SetConnectionIdCleanUpAlarm();
 }
 
@@ -272,7 +275,7 @@ void QuicTimeWaitListManager::SendVersionNegotiationPacket(
     const QuicSocketAddress& peer_address,
     std::unique_ptr<QuicPerPacketContext> packet_context) {
   std::unique_ptr<QuicEncryptedPacket> version_packet =
-      QuicFramer::BuildVersionNegotiationPacket(
+      version_negotiation_packet_cache_.BuildPacket(
           server_connection_id, client_connection_id, ietf_quic,
           use_length_prefix, supported_versions);
   QUIC_DVLOG(2) << "Dispatcher sending version negotiation packet {"
@@ -462,7 +465,20 @@ void QuicTimeWaitListManager::CleanUpOldConnectionIds() {
   QuicTime now = clock_->ApproximateNow();
   QuicTime expiration = now - time_wait_period_;
 
-  while (MaybeExpireOldestConnection(expiration)) {
+  size_t num_expired = 0;
+  while (num_expired < kMaxConnectionsToExpirePerAlarm &&
+         MaybeExpireOldestConnection(expiration)) {
+    ++num_expired;
+  }
+
+  if (!connection_id_map_.empty() &&
+      connection_id_map_.begin()->second.time_added <= expiration) {
+    // The batch limit was hit with overdue entries remaining. Reschedule the
+    // alarm to fire again right away so expiration cost is amortized across
+    // event loop iterations instead of stalling the dispatcher.
+    QUIC_CODE_COUNT(quic_time_wait_list_expiration_batch_limited);
+    connection_id_clean_up_alarm_->Update(now, QuicTime::Delta::Zero());
+    return;
   }
 
   SetConnectionIdCleanUpAlarm();
@@ -19,6 +19,7 @@
 #include "quic/core/quic_packets.h"
 #include "quic/core/quic_session.h"
 #include "quic/core/quic_types.h"
+#include "quic/core/quic_version_negotiation_packet_cache.h"
 #include "quic/platform/api/quic_flags.h"
 #include "common/quiche_linked_hash_map.h"
 
@@ -137,8 +138,18 @@ class QUIC_NO_EXPORT QuicTimeWaitListManager
     return writer_ != nullptr && writer_->IsWriteBlocked();
   }
 
+  // Upper bound on the number of connection_id entries deleted per cleanup
+  // alarm fire. During connection churn storms hundreds of thousands of
+  // entries can expire at once; expiring them in bounded batches keeps any
+  // single alarm fire from stalling the dispatcher, at the cost of the
+  // remaining overdue entries lingering until the immediately rescheduled
+  // alarm fires again.
+  static const size_t kMaxConnectionsToExpirePerAlarm = 256;
+
   // Used to delete connection_id entries that have outlived their time wait
-  // period.
+  // period. Deletes at most kMaxConnectionsToExpirePerAlarm entries per call;
+  // if overdue entries remain, the cleanup alarm is rescheduled to fire again
+  // immediately.
   void CleanUpOldConnectionIds();
 
   // If necessary, trims the oldest connections from the time-wait list until
@@ -331,6 +342,10 @@ class QUIC_NO_EXPORT QuicTimeWaitListManager
   // Clock to efficiently measure approximate time.
   const QuicClock* clock_;
 
+  // Preserialized version negotiation packet template, so rejecting a
+  // version-scanning flood does not rebuild the version list per datagram.
+  QuicVersionNegotiationPacketCache version_negotiation_packet_cache_;
+
   // Interface that writes given buffer to the socket.
   QuicPacketWriter* writer_;
 
@@ -447,6 +447,31 @@ TEST_F(QuicTimeWaitListManagerTest, CleanUpOldConnectionIds) {
             time_wait_list_manager_.num_connections());
 }
 
+TEST_F(QuicTimeWaitListManagerTest, CleanUpOldConnectionIdsInBatches) {
+  // One more overdue connection than fits in a single cleanup batch.
+  const size_t kConnectionIdCount =
+      QuicTimeWaitListManager::kMaxConnectionsToExpirePerAlarm + 1;
+  for (uint64_t conn_id = 1; conn_id <= kConnectionIdCount; ++conn_id) {
+    QuicConnectionId connection_id = TestConnectionId(conn_id);
+    EXPECT_CALL(visitor_, OnConnectionAddedToTimeWaitList(connection_id));
+    AddConnectionId(connection_id, QuicTimeWaitListManager::DO_NOTHING);
+  }
+  const QuicTime::Delta time_wait_period =
+      QuicTimeWaitListManagerPeer::time_wait_period(&time_wait_list_manager_);
+  clock_.AdvanceTime(time_wait_period);
+
+  // The first alarm fire only expires a full batch and reschedules itself to
+  // fire again immediately, rather than draining the whole list at once.
+  EXPECT_CALL(alarm_factory_, OnAlarmSet(_, clock_.Now()));
+  time_wait_list_manager_.CleanUpOldConnectionIds();
+  EXPECT_EQ(1u, time_wait_list_manager_.num_connections());
+
+  // The second fire expires the remainder and schedules the regular interval.
+  EXPECT_CALL(alarm_factory_, OnAlarmSet(_, clock_.Now() + time_wait_period));
+  time_wait_list_manager_.CleanUpOldConnectionIds();
+  EXPECT_EQ(0u, time_wait_list_manager_.num_connections());
+}
+
 TEST_F(QuicTimeWaitListManagerTest,
        CleanUpOldConnectionIdsForMultipleConnectionIdsPerConnection) {
   connection_id_ = TestConnectionId(7);
@@ -380,6 +380,43 @@ std::ostream& operator<<(std::ostream& os, AddressChangeType type) {
   return os;
 }
 
+std::string QuicQosClassToString(QuicQosClass qos_class) {
+  switch (qos_class) {
+    RETURN_STRING_LITERAL(QOS_CLASS_DEFAULT);
+    RETURN_STRING_LITERAL(QOS_CLASS_BACKGROUND);
+    RETURN_STRING_LITERAL(QOS_CLASS_INTERACTIVE);
+    RETURN_STRING_LITERAL(QOS_CLASS_EXPEDITED);
+    default:
+      return absl::StrCat("Unknown(", static_cast<int>(qos_class), ")");
+  }
+}
+
+std::ostream& operator<<(std::ostream& os, const QuicQosClass& qos_class) {
+  os << QuicQosClassToString(qos_class);
+  return os;
+}
+
+uint8_t QosClassToDscp(QuicQosClass qos_class) {
+  switch (qos_class) {
+    case QOS_CLASS_BACKGROUND:
+      // Lower Effort (LE), RFC 8622.
+      return 0x01;
+    case QOS_CLASS_INTERACTIVE:
+      // Assured Forwarding class 4, low drop precedence (AF41), RFC 2597.
+      return 0x22;
+    case QOS_CLASS_EXPEDITED:
+      // Expedited Forwarding (EF), RFC 3246.
+      return 0x2e;
+    case QOS_CLASS_DEFAULT:
+    default:
+      return 0x00;
+  }
+}
+
+uint8_t QosClassToTos(QuicQosClass qos_class) {
+  return QosClassToDscp(qos_class) << 2;
+}
+
 std::string KeyUpdateReasonString(KeyUpdateReason reason) {
 #define RETURN_REASON_LITERAL(x) \
   case KeyUpdateReason::x:       \
@@ -786,6 +786,35 @@ struct QUIC_NO_EXPORT NextReleaseTimeResult {
   bool allow_burst;
 };
 
+// Traffic classes for DiffServ-managed networks. A stream's class determines
+// the DSCP marking of packets carrying its data, so that the network's
+// priority queues can differentiate QUIC traffic per stream.
+enum QuicQosClass : uint8_t {
+  // Best effort. Packets leave with the default (zero) DSCP.
+  QOS_CLASS_DEFAULT,
+  // Background traffic, marked Lower Effort (LE, RFC 8622).
+  QOS_CLASS_BACKGROUND,
+  // Interactive but loss-tolerant traffic, marked AF41 (RFC 2597).
+  QOS_CLASS_INTERACTIVE,
+  // Latency-critical traffic such as voice, marked Expedited Forwarding (EF,
+  // RFC 3246). Expedited streams are additionally raised to the highest
+  // internal scheduling priority so EF-marked packets are not queued behind
+  // best-effort data inside the connection.
+  QOS_CLASS_EXPEDITED,
+};
+
+QUIC_EXPORT_PRIVATE std::string QuicQosClassToString(QuicQosClass qos_class);
+
+QUIC_EXPORT_PRIVATE std::ostream& operator<<(std::ostream& os,
+                                             const QuicQosClass& qos_class);
+
+// Returns the 6-bit DSCP value for |qos_class|.
+QUIC_EXPORT_PRIVATE uint8_t QosClassToDscp(QuicQosClass qos_class);
+
+// Returns the TOS/traffic class byte for |qos_class|: the DSCP in the upper
+// six bits with the two ECN bits left clear.
+QUIC_EXPORT_PRIVATE uint8_t QosClassToTos(QuicQosClass qos_class);
+
 // QuicPacketBuffer bundles a buffer and a function that releases it. Note
 // it does not assume ownership of buffer, i.e. it doesn't release the buffer on
 // destruction.
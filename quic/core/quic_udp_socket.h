@@ -7,6 +7,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <string>
 
 #include <type_traits>
 
@@ -35,6 +36,7 @@ enum class QuicUdpPacketInfoBit : uint8_t {
   RECV_TIMESTAMP,        // Read
   TTL,                   // Read & Write
   GOOGLE_PACKET_HEADER,  // Read
+  TOS,                   // Write
   NUM_BITS,
 };
 static_assert(static_cast<size_t>(QuicUdpPacketInfoBit::NUM_BITS) <=
@@ -118,8 +120,17 @@ class QUIC_EXPORT_PRIVATE QuicUdpPacketInfo {
     return receive_timestamp_;
   }
 
-  void SetReceiveTimestamp(QuicWallTime receive_timestamp) {
+  // Whether |receive_timestamp| was taken by the NIC hardware, as opposed to
+  // by the kernel when the packet was handed to the networking stack.
+  bool receive_timestamp_is_hardware() const {
+    QUICHE_DCHECK(HasValue(QuicUdpPacketInfoBit::RECV_TIMESTAMP));
+    return receive_timestamp_is_hardware_;
+  }
+
+  void SetReceiveTimestamp(QuicWallTime receive_timestamp,
+                           bool is_hardware = false) {
     receive_timestamp_ = receive_timestamp;
+    receive_timestamp_is_hardware_ = is_hardware;
     bitmask_.Set(QuicUdpPacketInfoBit::RECV_TIMESTAMP);
   }
 
@@ -143,6 +154,18 @@ class QUIC_EXPORT_PRIVATE QuicUdpPacketInfo {
     bitmask_.Set(QuicUdpPacketInfoBit::GOOGLE_PACKET_HEADER);
   }
 
+  uint8_t tos() const {
+    QUICHE_DCHECK(HasValue(QuicUdpPacketInfoBit::TOS));
+    return tos_;
+  }
+
+  // Sets the TOS (IPv4) or traffic class (IPv6) byte of the outgoing packet,
+  // including both the DSCP and ECN bits.
+  void SetTos(uint8_t tos) {
+    tos_ = tos;
+    bitmask_.Set(QuicUdpPacketInfoBit::TOS);
+  }
+
  private:
   BitMask64 bitmask_;
   QuicPacketCount dropped_packets_;
@@ -150,8 +173,10 @@ class QUIC_EXPORT_PRIVATE QuicUdpPacketInfo {
   QuicIpAddress self_v6_ip_;
   QuicSocketAddress peer_address_;
   QuicWallTime receive_timestamp_ = QuicWallTime::Zero();
+  bool receive_timestamp_is_hardware_ = false;
   int ttl_;
   BufferSpan google_packet_headers_;
+  uint8_t tos_ = 0;
 };
 
 // QuicUdpSocketApi provides a minimal set of apis for sending and receiving
@@ -180,6 +205,25 @@ class QUIC_EXPORT_PRIVATE QuicUdpSocketApi {
   // to get the bound random port.
   bool Bind(QuicUdpSocketFd fd, QuicSocketAddress address);
 
+  // Enable SO_REUSEPORT on |fd|, allowing multiple sockets to bind to the
+  // same address. Return true on success. Not supported on all platforms.
+  bool EnableReusePort(QuicUdpSocketFd fd);
+
+  // Attach a classic BPF program to the SO_REUSEPORT group containing |fd|
+  // which routes each packet to the socket whose group index equals the
+  // first byte of the packet's destination connection ID modulo
+  // |num_workers|. Combined with QuicConnectionIdWorkerRouter, which encodes
+  // the worker index into that byte of every server-chosen connection ID,
+  // this keeps packets on the owning process even after a client migrates to
+  // a new path and the kernel 4-tuple hash no longer matches. Packets whose
+  // routing byte is not controlled by a server (the client-chosen connection
+  // IDs in a connection's first flight) are spread uniformly. The sockets
+  // must join the group in worker index order, and the program should be
+  // attached once all of them have joined. Return true on success. Only
+  // supported on Linux.
+  bool EnableConnectionIdReusePortRouting(QuicUdpSocketFd fd,
+                                          uint8_t num_workers);
+
   // Enable receiving of various per-packet information. Return true if the
   // corresponding information can be received on read.
   bool EnableDroppedPacketCount(QuicUdpSocketFd fd);
@@ -187,6 +231,39 @@ class QUIC_EXPORT_PRIVATE QuicUdpSocketApi {
   bool EnableReceiveTtlForV4(QuicUdpSocketFd fd);
   bool EnableReceiveTtlForV6(QuicUdpSocketFd fd);
 
+  // Set the ECN field of outgoing packets to |ecn_codepoint|, which must be
+  // one of the two-bit codepoints from RFC 3168: 0b00 (Not-ECT), 0b01
+  // (ECT(1)), 0b10 (ECT(0)) or 0b11 (CE, not useful for senders). The DSCP
+  // bits of the TOS/traffic class byte are preserved. Return true on success.
+  bool SetEcnCodepointForV4(QuicUdpSocketFd fd, uint8_t ecn_codepoint);
+  bool SetEcnCodepointForV6(QuicUdpSocketFd fd, uint8_t ecn_codepoint);
+
+  // Effective send-offload capabilities of a socket, as reported by
+  // ProbeOffloadStatus().
+  struct QUIC_EXPORT_PRIVATE UdpOffloadStatus {
+    // True if the kernel supports UDP generic segmentation offload
+    // (UDP_SEGMENT) on the socket.
+    bool udp_segmentation = false;
+    // True if the network interface the socket is bound to checksums
+    // outgoing packets in hardware. When false, UDP segmentation still
+    // works, but the kernel silently computes every segment's checksum in
+    // software and most of the offload's CPU savings are lost.
+    bool hardware_tx_checksum = false;
+    // Name of the probed network interface. Empty if the socket is not bound
+    // to a specific address or the interface could not be determined, in
+    // which case |hardware_tx_checksum| is false.
+    std::string interface_name;
+  };
+
+  // Reports the effective segmentation and checksum offload status of |fd|,
+  // which should be bound. Intended to be called once at startup to choose a
+  // batch writer (e.g. QuicGsoBatchWriter if |udp_segmentation| is set,
+  // QuicSendmmsgBatchWriter otherwise) instead of discovering a
+  // misconfigured NIC under load. Logs a warning when segmentation would
+  // fall back to software checksums. Only effective on Linux; on other
+  // platforms all capabilities are reported as unsupported.
+  UdpOffloadStatus ProbeOffloadStatus(QuicUdpSocketFd fd);
+
   // Wait for |fd| to become readable, up to |timeout|.
   // Return true if |fd| is readable upon return.
   bool WaitUntilReadable(QuicUdpSocketFd fd, QuicTime::Delta timeout);
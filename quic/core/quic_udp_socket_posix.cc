@@ -3,6 +3,8 @@
 // found in the LICENSE file.
 
 #include "quic/core/quic_udp_socket.h"
+
+#include "absl/base/macros.h"
 #include "quic/platform/api/quic_bug_tracker.h"
 #include "quic/platform/api/quic_udp_socket_platform_api.h"
 
@@ -19,8 +21,19 @@
 
 #if defined(__linux__)
 #include <alloca.h>
+#include <ifaddrs.h>
+// For ETHTOOL_GTXCSUM.
+#include <linux/ethtool.h>
+// For SO_ATTACH_REUSEPORT_CBPF.
+#include <linux/filter.h>
 // For SO_TIMESTAMPING.
 #include <linux/net_tstamp.h>
+// For SIOCETHTOOL.
+#include <linux/sockios.h>
+#include <net/if.h>
+#include <sys/ioctl.h>
+// For UDP_SEGMENT.
+#include "quic/core/quic_linux_socket_utils.h"
 #endif
 
 #if defined(__linux__) && !defined(__ANDROID__)
@@ -138,11 +151,21 @@ void PopulatePacketInfoFromControlMessage(struct cmsghdr* cmsg,
     if (packet_info_interested.IsSet(QuicUdpPacketInfoBit::RECV_TIMESTAMP)) {
       LinuxSoTimestamping* linux_ts =
           reinterpret_cast<LinuxSoTimestamping*>(CMSG_DATA(cmsg));
-      timespec* ts = &linux_ts->systime;
+      // Prefer the raw NIC timestamp when the driver provided one; it is taken
+      // before the packet traverses the host's networking stack and is thus
+      // immune to scheduling delays. It is only usable as a wall time if the
+      // NIC clock is synchronized to the system clock(e.g. by phc2sys), which
+      // the reader of the timestamp is expected to verify.
+      timespec* ts = &linux_ts->hwtimeraw;
+      bool is_hardware = true;
+      if (ts->tv_sec == 0 && ts->tv_nsec == 0) {
+        ts = &linux_ts->systime;
+        is_hardware = false;
+      }
       int64_t usec = (static_cast<int64_t>(ts->tv_sec) * 1000 * 1000) +
                      (static_cast<int64_t>(ts->tv_nsec) / 1000);
       packet_info->SetReceiveTimestamp(
-          QuicWallTime::FromUNIXMicroseconds(usec));
+          QuicWallTime::FromUNIXMicroseconds(usec), is_hardware);
     }
     return;
   }
@@ -231,6 +254,64 @@ bool NextCmsg(msghdr* hdr,
 
   return true;
 }
+
+#if defined(__linux__)
+// Returns the name of the network interface owning |address|, or an empty
+// string if no interface matches.
+std::string InterfaceNameForAddress(const QuicIpAddress& address) {
+  ifaddrs* interfaces = nullptr;
+  if (getifaddrs(&interfaces) != 0) {
+    QUIC_LOG_FIRST_N(ERROR, 10) << "getifaddrs() failed: " << strerror(errno);
+    return "";
+  }
+  std::string name;
+  for (ifaddrs* ifa = interfaces; ifa != nullptr; ifa = ifa->ifa_next) {
+    if (ifa->ifa_addr == nullptr || ifa->ifa_name == nullptr) {
+      continue;
+    }
+    QuicIpAddress interface_address;
+    if (ifa->ifa_addr->sa_family == AF_INET) {
+      const sockaddr_in* sin =
+          reinterpret_cast<const sockaddr_in*>(ifa->ifa_addr);
+      interface_address.FromPackedString(
+          reinterpret_cast<const char*>(&sin->sin_addr), sizeof(in_addr));
+    } else if (ifa->ifa_addr->sa_family == AF_INET6) {
+      const sockaddr_in6* sin6 =
+          reinterpret_cast<const sockaddr_in6*>(ifa->ifa_addr);
+      interface_address.FromPackedString(
+          reinterpret_cast<const char*>(&sin6->sin6_addr), sizeof(in6_addr));
+    } else {
+      continue;
+    }
+    if (interface_address.Normalized() == address.Normalized()) {
+      name = ifa->ifa_name;
+      break;
+    }
+  }
+  freeifaddrs(interfaces);
+  return name;
+}
+
+// Returns true if |interface_name| checksums outgoing packets in hardware.
+// Virtual interfaces (e.g. loopback) typically do not implement the ethtool
+// query and report false.
+bool InterfaceHasHardwareTxChecksum(QuicUdpSocketFd fd,
+                                    const std::string& interface_name) {
+  ethtool_value value;
+  memset(&value, 0, sizeof(value));
+  value.cmd = ETHTOOL_GTXCSUM;
+  ifreq ifr;
+  memset(&ifr, 0, sizeof(ifr));
+  strncpy(ifr.ifr_name, interface_name.c_str(), IFNAMSIZ - 1);
+  ifr.ifr_data = reinterpret_cast<char*>(&value);
+  if (ioctl(fd, SIOCETHTOOL, &ifr) != 0) {
+    QUIC_LOG_FIRST_N(INFO, 10) << "ioctl(SIOCETHTOOL) failed on "
+                               << interface_name << ": " << strerror(errno);
+    return false;
+  }
+  return value.data != 0;
+}
+#endif  // defined(__linux__)
 }  // namespace
 
 QuicUdpSocketFd QuicUdpSocketApi::Create(int address_family,
@@ -307,6 +388,55 @@ bool QuicUdpSocketApi::Bind(QuicUdpSocketFd fd, QuicSocketAddress address) {
   return 0 == bind(fd, reinterpret_cast<sockaddr*>(&addr), addr_len);
 }
 
+bool QuicUdpSocketApi::EnableReusePort(QuicUdpSocketFd fd) {
+#if defined(SO_REUSEPORT)
+  int reuse_port = 1;
+  return 0 == setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &reuse_port,
+                         sizeof(reuse_port));
+#else
+  (void)fd;
+  return false;
+#endif
+}
+
+bool QuicUdpSocketApi::EnableConnectionIdReusePortRouting(QuicUdpSocketFd fd,
+                                                          uint8_t num_workers) {
+#if defined(__linux__) && defined(SO_ATTACH_REUSEPORT_CBPF)
+  if (num_workers == 0) {
+    QUIC_BUG(quic_bug_reuseport_routing_no_workers)
+        << "num_workers must be positive";
+    return false;
+  }
+  // The program sees the UDP payload, i.e. the QUIC packet. In short header
+  // packets the destination connection ID starts at offset 1 (after the
+  // flags byte); in long header packets it starts at offset 6 (flags byte,
+  // 4 version bytes and the connection ID length byte).
+  struct sock_filter instructions[] = {
+      // A = payload[0]
+      BPF_STMT(BPF_LD | BPF_B | BPF_ABS, 0),
+      // if (A & 0x80) goto long_header
+      BPF_JUMP(BPF_JMP | BPF_JSET | BPF_K, 0x80, 2, 0),
+      // A = payload[1]; goto modulo
+      BPF_STMT(BPF_LD | BPF_B | BPF_ABS, 1),
+      BPF_JUMP(BPF_JMP | BPF_JA, 1, 0, 0),
+      // long_header: A = payload[6]
+      BPF_STMT(BPF_LD | BPF_B | BPF_ABS, 6),
+      // modulo: return A % num_workers
+      BPF_STMT(BPF_ALU | BPF_MOD | BPF_K, num_workers),
+      BPF_STMT(BPF_RET | BPF_A, 0),
+  };
+  struct sock_fprog program;
+  program.len = ABSL_ARRAYSIZE(instructions);
+  program.filter = instructions;
+  return 0 == setsockopt(fd, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &program,
+                         sizeof(program));
+#else
+  (void)fd;
+  (void)num_workers;
+  return false;
+#endif
+}
+
 bool QuicUdpSocketApi::EnableDroppedPacketCount(QuicUdpSocketFd fd) {
 #if defined(__linux__) && defined(SO_RXQ_OVFL)
   int get_overflow = 1;
@@ -332,7 +462,17 @@ bool QuicUdpSocketApi::EnableReceiveSelfIpAddressForV6(QuicUdpSocketFd fd) {
 
 bool QuicUdpSocketApi::EnableReceiveTimestamp(QuicUdpSocketFd fd) {
 #if defined(__linux__) && (!defined(__ANDROID_API__) || __ANDROID_API__ >= 21)
-  int timestamping = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+  // Also ask for raw NIC timestamps. If the NIC or driver does not support
+  // them, the kernel simply reports software timestamps only.
+  int timestamping = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE |
+                     SOF_TIMESTAMPING_RX_HARDWARE |
+                     SOF_TIMESTAMPING_RAW_HARDWARE;
+  if (0 == setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPING, &timestamping,
+                      sizeof(timestamping))) {
+    return true;
+  }
+  // Some older kernels reject the hardware flags outright.
+  timestamping = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
   return 0 == setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPING, &timestamping,
                          sizeof(timestamping));
 #else
@@ -362,6 +502,61 @@ bool QuicUdpSocketApi::EnableReceiveTtlForV6(QuicUdpSocketFd fd) {
 #endif
 }
 
+bool QuicUdpSocketApi::SetEcnCodepointForV4(QuicUdpSocketFd fd,
+                                            uint8_t ecn_codepoint) {
+  int tos = 0;
+  socklen_t tos_len = sizeof(tos);
+  if (0 != getsockopt(fd, IPPROTO_IP, IP_TOS, &tos, &tos_len)) {
+    return false;
+  }
+  tos = (tos & ~0x03) | (ecn_codepoint & 0x03);
+  return 0 == setsockopt(fd, IPPROTO_IP, IP_TOS, &tos, sizeof(tos));
+}
+
+bool QuicUdpSocketApi::SetEcnCodepointForV6(QuicUdpSocketFd fd,
+                                            uint8_t ecn_codepoint) {
+  int tclass = 0;
+  socklen_t tclass_len = sizeof(tclass);
+  if (0 != getsockopt(fd, IPPROTO_IPV6, IPV6_TCLASS, &tclass, &tclass_len)) {
+    return false;
+  }
+  tclass = (tclass & ~0x03) | (ecn_codepoint & 0x03);
+  return 0 == setsockopt(fd, IPPROTO_IPV6, IPV6_TCLASS, &tclass,
+                         sizeof(tclass));
+}
+
+QuicUdpSocketApi::UdpOffloadStatus QuicUdpSocketApi::ProbeOffloadStatus(
+    QuicUdpSocketFd fd) {
+  UdpOffloadStatus status;
+#if defined(__linux__)
+  int segment_size;
+  socklen_t optlen = sizeof(segment_size);
+  status.udp_segmentation =
+      0 == getsockopt(fd, SOL_UDP, UDP_SEGMENT, &segment_size, &optlen);
+
+  QuicSocketAddress bound_address;
+  if (bound_address.FromSocket(fd) != 0 ||
+      !bound_address.host().IsInitialized()) {
+    return status;
+  }
+  status.interface_name = InterfaceNameForAddress(bound_address.host());
+  if (status.interface_name.empty()) {
+    // Bound to the any-address or an address no interface owns; the sending
+    // interface, and thus the checksum behavior, cannot be determined.
+    return status;
+  }
+  status.hardware_tx_checksum =
+      InterfaceHasHardwareTxChecksum(fd, status.interface_name);
+  if (status.udp_segmentation && !status.hardware_tx_checksum) {
+    QUIC_LOG(WARNING) << "UDP segmentation on " << status.interface_name
+                      << " will fall back to software checksums";
+  }
+#else
+  (void)fd;
+#endif
+  return status;
+}
+
 bool QuicUdpSocketApi::WaitUntilReadable(QuicUdpSocketFd fd,
                                          QuicTime::Delta timeout) {
   fd_set read_fds;
@@ -623,6 +818,20 @@ WriteResult QuicUdpSocketApi::WritePacket(
   }
 #endif
 
+  // Set TOS/traffic class.
+  if (packet_info.HasValue(QuicUdpPacketInfoBit::TOS)) {
+    int cmsg_level =
+        packet_info.peer_address().host().IsIPv4() ? IPPROTO_IP : IPPROTO_IPV6;
+    int cmsg_type =
+        packet_info.peer_address().host().IsIPv4() ? IP_TOS : IPV6_TCLASS;
+    if (!NextCmsg(&hdr, control_buffer, sizeof(control_buffer), cmsg_level,
+                  cmsg_type, sizeof(int), &cmsg)) {
+      QUIC_LOG_FIRST_N(ERROR, 100) << "Not enough buffer to set tos.";
+      return WriteResult(WRITE_STATUS_ERROR, EINVAL);
+    }
+    *reinterpret_cast<int*>(CMSG_DATA(cmsg)) = packet_info.tos();
+  }
+
   int rc;
   do {
     rc = sendmsg(fd, &hdr, 0);
@@ -131,6 +131,7 @@ QuicUnackedPacketMap::~QuicUnackedPacketMap() {
   for (QuicTransmissionInfo& transmission_info : unacked_packets_) {
     DeleteFrames(&(transmission_info.retransmittable_frames));
   }
+  DeleteFrames(&obsolete_frames_);
 }
 
 void QuicUnackedPacketMap::AddSentPacket(SerializedPacket* mutable_packet,
@@ -197,10 +198,19 @@ void QuicUnackedPacketMap::RemoveObsoletePackets() {
     if (!IsPacketUseless(least_unacked_, unacked_packets_.front())) {
       break;
     }
-    DeleteFrames(&unacked_packets_.front().retransmittable_frames);
+    // Move the frames into the shared epoch buffer so they can be freed in
+    // one pass below; destroying the now-empty transmission info is cheap.
+    QuicFrames& frames = unacked_packets_.front().retransmittable_frames;
+    obsolete_frames_.insert(obsolete_frames_.end(), frames.begin(),
+                            frames.end());
+    frames.clear();
     unacked_packets_.pop_front();
     ++least_unacked_;
   }
+  if (!obsolete_frames_.empty()) {
+    // DeleteFrames clears the vector but retains its capacity.
+    DeleteFrames(&obsolete_frames_);
+  }
 }
 
 bool QuicUnackedPacketMap::HasRetransmittableFrames(
@@ -227,7 +237,14 @@ bool QuicUnackedPacketMap::HasRetransmittableFrames(
 
 void QuicUnackedPacketMap::RemoveRetransmittability(
     QuicTransmissionInfo* info) {
-  DeleteFrames(&info->retransmittable_frames);
+  // Defer releasing the frames into the shared epoch buffer rather than
+  // running DeleteFrames per packet: when a cumulative ack covers a long
+  // span of packets, all of their frames are then freed in one pass by the
+  // RemoveObsoletePackets call that ends the ack event.
+  obsolete_frames_.insert(obsolete_frames_.end(),
+                          info->retransmittable_frames.begin(),
+                          info->retransmittable_frames.end());
+  info->retransmittable_frames.clear();
   info->first_sent_after_loss.Clear();
 }
 
@@ -161,7 +161,9 @@ class QUIC_EXPORT_PRIVATE QuicUnackedPacketMap {
 
   // Removes any retransmittable frames from this transmission or an associated
   // transmission.  It removes now useless transmissions, and disconnects any
-  // other packets from other transmissions.
+  // other packets from other transmissions. The frames themselves are not
+  // freed here but on the next RemoveObsoletePackets() call, so a cumulative
+  // ack covering many packets releases all of their frames in one pass.
   void RemoveRetransmittability(QuicTransmissionInfo* info);
 
   // Looks up the QuicTransmissionInfo by |packet_number| and calls
@@ -305,6 +307,14 @@ class QUIC_EXPORT_PRIVATE QuicUnackedPacketMap {
   // The packet at the 0th index of unacked_packets_.
   QuicPacketNumber least_unacked_;
 
+  // Frames collected from acked packets (RemoveRetransmittability) and from
+  // obsolete packets while least_unacked_ advances. They are moved here and
+  // then freed in one bulk pass per RemoveObsoletePackets call, instead of
+  // running a destructor chain per packet. The vector's capacity is retained
+  // across calls so the collection step performs no allocations in steady
+  // state.
+  QuicFrames obsolete_frames_;
+
   QuicByteCount bytes_in_flight_;
   // Bytes in flight per packet number space.
   QuicByteCount
@@ -42,8 +42,9 @@ const std::vector<std::string>& QuicVersionManager::GetSupportedAlpns() {
 }
 
 void QuicVersionManager::MaybeRefilterSupportedVersions() {
-  static_assert(SupportedVersions().size() == 5u,
-                "Supported versions out of sync");
+  static_assert(
+      SupportedVersions().size() == (GQuicVersionsCompiledIn() ? 5u : 2u),
+      "Supported versions out of sync");
   if (disable_version_rfcv1_ !=
           GetQuicReloadableFlag(quic_disable_version_rfcv1) ||
       disable_version_draft_29_ !=
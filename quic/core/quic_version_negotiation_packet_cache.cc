@@ -0,0 +1,135 @@
+// Copyright (c) 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/quic_version_negotiation_packet_cache.h"
+
+#include <cstring>
+
+#include "quic/core/quic_constants.h"
+#include "quic/core/quic_framer.h"
+#include "quic/platform/api/quic_bug_tracker.h"
+#include "common/quiche_endian.h"
+
+namespace quic {
+
+std::unique_ptr<QuicEncryptedPacket>
+QuicVersionNegotiationPacketCache::BuildPacket(
+    QuicConnectionId server_connection_id,
+    QuicConnectionId client_connection_id,
+    bool ietf_quic,
+    bool use_length_prefix,
+    const ParsedQuicVersionVector& supported_versions) {
+  if (supported_versions.empty()) {
+    // With no supported versions the packet consists entirely of grease
+    // labels; there is nothing stable to cache.
+    return QuicFramer::BuildVersionNegotiationPacket(
+        server_connection_id, client_connection_id, ietf_quic,
+        use_length_prefix, supported_versions);
+  }
+  if (!TemplateMatches(server_connection_id, client_connection_id, ietf_quic,
+                       use_length_prefix, supported_versions) &&
+      !RebuildTemplate(server_connection_id, client_connection_id, ietf_quic,
+                       use_length_prefix, supported_versions)) {
+    return QuicFramer::BuildVersionNegotiationPacket(
+        server_connection_id, client_connection_id, ietf_quic,
+        use_length_prefix, supported_versions);
+  }
+
+  std::unique_ptr<char[]> buffer(new char[template_.size()]);
+  memcpy(buffer.get(), template_.data(), template_.size());
+  if (ietf_quic) {
+    memcpy(buffer.get() + client_connection_id_offset_,
+           client_connection_id.data(), client_connection_id.length());
+  }
+  memcpy(buffer.get() + server_connection_id_offset_,
+         server_connection_id.data(), server_connection_id.length());
+  // Refresh the grease label so cached packets remain as unpredictable as
+  // framer-built ones.
+  const QuicVersionLabel grease_label = quiche::QuicheEndian::HostToNet32(
+      CreateQuicVersionLabel(QuicVersionReservedForNegotiation()));
+  memcpy(buffer.get() + grease_label_offset_, &grease_label,
+         sizeof(grease_label));
+  return std::make_unique<QuicEncryptedPacket>(
+      buffer.release(), template_.size(), /*owns_buffer=*/true);
+}
+
+bool QuicVersionNegotiationPacketCache::TemplateMatches(
+    const QuicConnectionId& server_connection_id,
+    const QuicConnectionId& client_connection_id,
+    bool ietf_quic,
+    bool use_length_prefix,
+    const ParsedQuicVersionVector& supported_versions) const {
+  return has_template_ && ietf_quic_ == ietf_quic &&
+         use_length_prefix_ == use_length_prefix &&
+         server_connection_id_length_ == server_connection_id.length() &&
+         client_connection_id_length_ == client_connection_id.length() &&
+         supported_versions_ == supported_versions;
+}
+
+bool QuicVersionNegotiationPacketCache::RebuildTemplate(
+    QuicConnectionId server_connection_id,
+    QuicConnectionId client_connection_id,
+    bool ietf_quic,
+    bool use_length_prefix,
+    const ParsedQuicVersionVector& supported_versions) {
+  has_template_ = false;
+  std::unique_ptr<QuicEncryptedPacket> packet =
+      QuicFramer::BuildVersionNegotiationPacket(
+          server_connection_id, client_connection_id, ietf_quic,
+          use_length_prefix, supported_versions);
+  if (packet == nullptr) {
+    return false;
+  }
+
+  // Field offsets follow directly from the wire format built by
+  // QuicFramer::Build(Ietf)VersionNegotiationPacket.
+  size_t client_connection_id_offset = 0;
+  size_t server_connection_id_offset;
+  if (ietf_quic) {
+    client_connection_id_offset =
+        kPacketHeaderTypeSize + kQuicVersionSize + kConnectionIdLengthSize;
+    server_connection_id_offset =
+        client_connection_id_offset + client_connection_id.length() +
+        (use_length_prefix ? kConnectionIdLengthSize : 0);
+  } else {
+    server_connection_id_offset = kPublicFlagsSize;
+  }
+  const size_t labels_offset =
+      server_connection_id_offset + server_connection_id.length();
+  const size_t num_wire_labels = supported_versions.size() + 1;
+  if (labels_offset + num_wire_labels * kQuicVersionSize != packet->length()) {
+    QUIC_BUG(quic_version_negotiation_cache_bad_template)
+        << "Unexpected version negotiation packet length "
+        << packet->length();
+    return false;
+  }
+
+  // Locate the grease label: the wire carries the supported versions in order
+  // with one reserved label inserted at a random index.
+  size_t grease_index = supported_versions.size();
+  for (size_t i = 0; i < supported_versions.size(); ++i) {
+    QuicVersionLabel wire_label;
+    memcpy(&wire_label, packet->data() + labels_offset + i * kQuicVersionSize,
+           sizeof(wire_label));
+    if (quiche::QuicheEndian::NetToHost32(wire_label) !=
+        CreateQuicVersionLabel(supported_versions[i])) {
+      grease_index = i;
+      break;
+    }
+  }
+
+  ietf_quic_ = ietf_quic;
+  use_length_prefix_ = use_length_prefix;
+  server_connection_id_length_ = server_connection_id.length();
+  client_connection_id_length_ = client_connection_id.length();
+  supported_versions_ = supported_versions;
+  template_.assign(packet->data(), packet->length());
+  server_connection_id_offset_ = server_connection_id_offset;
+  client_connection_id_offset_ = client_connection_id_offset;
+  grease_label_offset_ = labels_offset + grease_index * kQuicVersionSize;
+  has_template_ = true;
+  return true;
+}
+
+}  // namespace quic
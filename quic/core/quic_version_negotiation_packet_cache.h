@@ -0,0 +1,78 @@
+// Copyright (c) 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_QUIC_VERSION_NEGOTIATION_PACKET_CACHE_H_
+#define QUICHE_QUIC_CORE_QUIC_VERSION_NEGOTIATION_PACKET_CACHE_H_
+
+#include <memory>
+#include <string>
+
+#include "quic/core/quic_connection_id.h"
+#include "quic/core/quic_packets.h"
+#include "quic/core/quic_versions.h"
+#include "quic/platform/api/quic_export.h"
+
+namespace quic {
+
+// Builds version negotiation packets from a cached serialized template
+// instead of reserializing the version list for every offending datagram.
+// Under a version-scanning flood the dispatcher sends near-identical version
+// negotiation packets millions of times; only the connection IDs and the
+// grease version label differ between them. This cache preserializes the
+// packet once per (format, connection ID lengths, supported versions)
+// combination and serves subsequent packets as a memcpy of the template with
+// the connection IDs and a fresh random grease label patched in.
+//
+// The template is invalidated whenever the key changes, which covers
+// supported-version changes from QuicVersionManager as well as clients using
+// different connection ID lengths.
+class QUIC_EXPORT_PRIVATE QuicVersionNegotiationPacketCache {
+ public:
+  // Returns a packet equivalent to what
+  // QuicFramer::BuildVersionNegotiationPacket() would build for the same
+  // arguments, rebuilding the cached template first if needed.
+  std::unique_ptr<QuicEncryptedPacket> BuildPacket(
+      QuicConnectionId server_connection_id,
+      QuicConnectionId client_connection_id,
+      bool ietf_quic,
+      bool use_length_prefix,
+      const ParsedQuicVersionVector& supported_versions);
+
+ private:
+  // Whether the cached template can serve a packet with these parameters.
+  bool TemplateMatches(const QuicConnectionId& server_connection_id,
+                       const QuicConnectionId& client_connection_id,
+                       bool ietf_quic,
+                       bool use_length_prefix,
+                       const ParsedQuicVersionVector& supported_versions) const;
+
+  // Builds a packet via QuicFramer and records it, together with the offsets
+  // of the fields patched per packet. Returns false if the template could not
+  // be derived; callers then fall back to the framer.
+  bool RebuildTemplate(QuicConnectionId server_connection_id,
+                       QuicConnectionId client_connection_id,
+                       bool ietf_quic,
+                       bool use_length_prefix,
+                       const ParsedQuicVersionVector& supported_versions);
+
+  // Template key.
+  bool has_template_ = false;
+  bool ietf_quic_ = false;
+  bool use_length_prefix_ = false;
+  uint8_t server_connection_id_length_ = 0;
+  uint8_t client_connection_id_length_ = 0;
+  ParsedQuicVersionVector supported_versions_;
+
+  // Serialized packet; the fields below are patched into a copy per packet.
+  std::string template_;
+  size_t server_connection_id_offset_ = 0;
+  // Only meaningful for IETF packets; gQUIC does not encode the client
+  // connection ID.
+  size_t client_connection_id_offset_ = 0;
+  size_t grease_label_offset_ = 0;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_QUIC_VERSION_NEGOTIATION_PACKET_CACHE_H_
@@ -0,0 +1,122 @@
+// Copyright (c) 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/quic_version_negotiation_packet_cache.h"
+
+#include <memory>
+
+#include "quic/core/quic_framer.h"
+#include "quic/core/quic_versions.h"
+#include "quic/platform/api/quic_flags.h"
+#include "quic/platform/api/quic_test.h"
+#include "quic/test_tools/quic_test_utils.h"
+#include "common/test_tools/quiche_test_utils.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+class QuicVersionNegotiationPacketCacheTest : public QuicTest {
+ protected:
+  QuicVersionNegotiationPacketCacheTest() {
+    // Make framer-built packets deterministic so cached packets can be
+    // compared against them byte for byte.
+    SetQuicFlag(FLAGS_quic_disable_version_negotiation_grease_randomness,
+                true);
+  }
+
+  // Expects |packet| to be byte-identical to what the framer builds.
+  void ExpectMatchesFramer(const QuicEncryptedPacket& packet,
+                           QuicConnectionId server_connection_id,
+                           QuicConnectionId client_connection_id,
+                           bool ietf_quic,
+                           bool use_length_prefix,
+                           const ParsedQuicVersionVector& versions) {
+    std::unique_ptr<QuicEncryptedPacket> expected =
+        QuicFramer::BuildVersionNegotiationPacket(
+            server_connection_id, client_connection_id, ietf_quic,
+            use_length_prefix, versions);
+    ASSERT_NE(expected, nullptr);
+    quiche::test::CompareCharArraysWithHexError(
+        "cached packet", packet.data(), packet.length(), expected->data(),
+        expected->length());
+  }
+
+  QuicVersionNegotiationPacketCache cache_;
+};
+
+TEST_F(QuicVersionNegotiationPacketCacheTest, MatchesFramerGoogleQuic) {
+  const ParsedQuicVersionVector versions = AllSupportedVersions();
+  for (int i = 0; i < 2; ++i) {  // Second iteration is served from the cache.
+    std::unique_ptr<QuicEncryptedPacket> packet = cache_.BuildPacket(
+        TestConnectionId(), EmptyQuicConnectionId(), /*ietf_quic=*/false,
+        /*use_length_prefix=*/false, versions);
+    ASSERT_NE(packet, nullptr);
+    ExpectMatchesFramer(*packet, TestConnectionId(), EmptyQuicConnectionId(),
+                        false, false, versions);
+  }
+}
+
+TEST_F(QuicVersionNegotiationPacketCacheTest, MatchesFramerIetf) {
+  const ParsedQuicVersionVector versions = AllSupportedVersions();
+  for (bool use_length_prefix : {false, true}) {
+    for (int i = 0; i < 2; ++i) {
+      std::unique_ptr<QuicEncryptedPacket> packet = cache_.BuildPacket(
+          TestConnectionId(), TestConnectionId(0x33), /*ietf_quic=*/true,
+          use_length_prefix, versions);
+      ASSERT_NE(packet, nullptr);
+      ExpectMatchesFramer(*packet, TestConnectionId(), TestConnectionId(0x33),
+                          true, use_length_prefix, versions);
+    }
+  }
+}
+
+TEST_F(QuicVersionNegotiationPacketCacheTest, PatchesConnectionIds) {
+  const ParsedQuicVersionVector versions = AllSupportedVersions();
+  // Populate the template with one pair of connection IDs, then serve a
+  // packet for a different pair from it.
+  std::unique_ptr<QuicEncryptedPacket> packet =
+      cache_.BuildPacket(TestConnectionId(1), TestConnectionId(2),
+                         /*ietf_quic=*/true, /*use_length_prefix=*/true,
+                         versions);
+  ASSERT_NE(packet, nullptr);
+  packet = cache_.BuildPacket(TestConnectionId(3), TestConnectionId(4),
+                              /*ietf_quic=*/true, /*use_length_prefix=*/true,
+                              versions);
+  ASSERT_NE(packet, nullptr);
+  ExpectMatchesFramer(*packet, TestConnectionId(3), TestConnectionId(4), true,
+                      true, versions);
+}
+
+TEST_F(QuicVersionNegotiationPacketCacheTest, InvalidatedOnVersionChange) {
+  const ParsedQuicVersionVector all_versions = AllSupportedVersions();
+  ASSERT_GT(all_versions.size(), 1u);
+  const ParsedQuicVersionVector one_version = {all_versions.front()};
+
+  std::unique_ptr<QuicEncryptedPacket> packet = cache_.BuildPacket(
+      TestConnectionId(), TestConnectionId(0x33), /*ietf_quic=*/true,
+      /*use_length_prefix=*/true, all_versions);
+  ASSERT_NE(packet, nullptr);
+  packet = cache_.BuildPacket(TestConnectionId(), TestConnectionId(0x33),
+                              /*ietf_quic=*/true, /*use_length_prefix=*/true,
+                              one_version);
+  ASSERT_NE(packet, nullptr);
+  ExpectMatchesFramer(*packet, TestConnectionId(), TestConnectionId(0x33),
+                      true, true, one_version);
+}
+
+TEST_F(QuicVersionNegotiationPacketCacheTest, EmptyVersionsFallsThrough) {
+  // An empty supported-version set produces an all-grease packet straight
+  // from the framer.
+  std::unique_ptr<QuicEncryptedPacket> packet = cache_.BuildPacket(
+      TestConnectionId(), EmptyQuicConnectionId(), /*ietf_quic=*/true,
+      /*use_length_prefix=*/true, ParsedQuicVersionVector());
+  ASSERT_NE(packet, nullptr);
+  // The framer guarantees at least two grease labels, i.e. 14 bytes.
+  EXPECT_GE(packet->length(), 14u);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
@@ -42,8 +42,9 @@ QuicVersionLabel CreateRandomVersionLabelForNegotiation() {
 }
 
 void SetVersionFlag(const ParsedQuicVersion& version, bool should_enable) {
-  static_assert(SupportedVersions().size() == 5u,
-                "Supported versions out of sync");
+  static_assert(
+      SupportedVersions().size() == (GQuicVersionsCompiledIn() ? 5u : 2u),
+      "Supported versions out of sync");
   const bool enable = should_enable;
   const bool disable = !should_enable;
   if (version == ParsedQuicVersion::RFCv1()) {
@@ -213,8 +214,9 @@ std::ostream& operator<<(std::ostream& os,
 }
 
 QuicVersionLabel CreateQuicVersionLabel(ParsedQuicVersion parsed_version) {
-  static_assert(SupportedVersions().size() == 5u,
-                "Supported versions out of sync");
+  static_assert(
+      SupportedVersions().size() == (GQuicVersionsCompiledIn() ? 5u : 2u),
+      "Supported versions out of sync");
   if (parsed_version == ParsedQuicVersion::RFCv1()) {
     return MakeVersionLabel(0x00, 0x00, 0x00, 0x01);
   } else if (parsed_version == ParsedQuicVersion::Draft29()) {
@@ -508,8 +510,9 @@ std::string HandshakeProtocolToString(HandshakeProtocol handshake_protocol) {
 }
 
 std::string ParsedQuicVersionToString(ParsedQuicVersion version) {
-  static_assert(SupportedVersions().size() == 5u,
-                "Supported versions out of sync");
+  static_assert(
+      SupportedVersions().size() == (GQuicVersionsCompiledIn() ? 5u : 2u),
+      "Supported versions out of sync");
   if (version == UnsupportedQuicVersion()) {
     return "0";
   } else if (version == ParsedQuicVersion::RFCv1()) {
@@ -389,7 +389,39 @@ QUIC_EXPORT_PRIVATE std::ostream& operator<<(
     std::ostream& os,
     const QuicVersionLabelVector& version_labels);
 
+// Defining QUIC_DISABLE_GQUIC at build time produces an IETF-only build:
+// the gQUIC versions (Q043, Q046, Q050) and the QUIC crypto handshake are
+// removed from the supported-version lists below at compile time. The gQUIC
+// identifiers themselves stay defined so shared code keeps compiling, but
+// since no supported version is ever constructed from them, link-time
+// optimization can fold the version dispatch sites on the IETF hot path and
+// discard the legacy framing and handshake code entirely. Deprecated APIs
+// that require PROTOCOL_QUIC_CRYPTO versions (e.g.
+// AllSupportedVersionsWithQuicCrypto) hit a QUIC_BUG in such builds.
+
+// Returns true when the gQUIC versions are compiled into the
+// supported-version list, i.e. when QUIC_DISABLE_GQUIC is not defined.
+constexpr bool GQuicVersionsCompiledIn() {
+#if defined(QUIC_DISABLE_GQUIC)
+  return false;
+#else
+  return true;
+#endif
+}
+
 // This vector contains all crypto handshake protocols that are supported.
+#if defined(QUIC_DISABLE_GQUIC)
+constexpr std::array<HandshakeProtocol, 1> SupportedHandshakeProtocols() {
+  return {PROTOCOL_TLS1_3};
+}
+
+constexpr std::array<ParsedQuicVersion, 2> SupportedVersions() {
+  return {
+      ParsedQuicVersion::RFCv1(),
+      ParsedQuicVersion::Draft29(),
+  };
+}
+#else
 constexpr std::array<HandshakeProtocol, 2> SupportedHandshakeProtocols() {
   return {PROTOCOL_TLS1_3, PROTOCOL_QUIC_CRYPTO};
 }
@@ -401,6 +433,7 @@ constexpr std::array<ParsedQuicVersion, 5> SupportedVersions() {
       ParsedQuicVersion::Q043(),
   };
 }
+#endif  // defined(QUIC_DISABLE_GQUIC)
 
 using QuicTransportVersionVector = std::vector<QuicTransportVersion>;
 
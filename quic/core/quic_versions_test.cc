@@ -430,6 +430,16 @@ TEST_F(QuicVersionsTest, SupportedVersionsAllDistinct) {
   }
 }
 
+TEST_F(QuicVersionsTest, GQuicVersionsCompiledInMatchesSupportedList) {
+  bool found_gquic_version = false;
+  for (const ParsedQuicVersion& version : AllSupportedVersions()) {
+    if (!version.UsesHttp3()) {
+      found_gquic_version = true;
+    }
+  }
+  EXPECT_EQ(GQuicVersionsCompiledIn(), found_gquic_version);
+}
+
 TEST_F(QuicVersionsTest, CurrentSupportedHttp3Versions) {
   ParsedQuicVersionVector h3_versions = CurrentSupportedHttp3Versions();
   ParsedQuicVersionVector all_current_supported_versions =
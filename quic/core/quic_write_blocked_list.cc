@@ -6,14 +6,12 @@
 
 #include "quic/platform/api/quic_flag_utils.h"
 #include "quic/platform/api/quic_flags.h"
+#include "quic/platform/api/quic_logging.h"
 
 namespace quic {
 
-QuicWriteBlockedList::QuicWriteBlockedList(QuicTransportVersion version)
-    : priority_write_scheduler_(QuicVersionUsesCryptoFrames(version)
-                                    ? std::numeric_limits<QuicStreamId>::max()
-                                    : 0),
-      last_priority_popped_(0) {
+QuicWriteBlockedList::QuicWriteBlockedList(QuicTransportVersion /*version*/)
+    : last_priority_popped_(0) {
   memset(batch_write_stream_id_, 0, sizeof(batch_write_stream_id_));
   memset(bytes_left_for_batch_write_, 0, sizeof(bytes_left_for_batch_write_));
 }
@@ -32,7 +30,7 @@ bool QuicWriteBlockedList::ShouldYield(QuicStreamId id) const {
     }
   }
 
-  return priority_write_scheduler_.ShouldYield(id);
+  return data_stream_scheduler_.ShouldYield(id);
 }
 
 QuicStreamId QuicWriteBlockedList::PopFront() {
@@ -41,13 +39,10 @@ QuicStreamId QuicWriteBlockedList::PopFront() {
     return static_stream_id;
   }
 
-  const auto id_and_precedence =
-      priority_write_scheduler_.PopNextReadyStreamAndPrecedence();
-  const QuicStreamId id = std::get<0>(id_and_precedence);
-  const spdy::SpdyPriority priority =
-      std::get<1>(id_and_precedence).spdy3_priority();
+  spdy::SpdyPriority priority;
+  const QuicStreamId id = data_stream_scheduler_.Pop(&priority);
 
-  if (!priority_write_scheduler_.HasReadyStreams()) {
+  if (!data_stream_scheduler_.HasReadyStreams()) {
     // If no streams are blocked, don't bother latching.  This stream will be
     // the first popped for its priority anyway.
     batch_write_stream_id_[priority] = 0;
@@ -66,7 +61,7 @@ void QuicWriteBlockedList::RegisterStream(
     QuicStreamId stream_id,
     bool is_static_stream,
     const spdy::SpdyStreamPrecedence& precedence) {
-  QUICHE_DCHECK(!priority_write_scheduler_.StreamRegistered(stream_id))
+  QUICHE_DCHECK(!data_stream_scheduler_.IsRegistered(stream_id))
       << "stream " << stream_id << " already registered";
   QUICHE_DCHECK(precedence.is_spdy3_priority());
   if (is_static_stream) {
@@ -74,7 +69,7 @@ void QuicWriteBlockedList::RegisterStream(
     return;
   }
 
-  priority_write_scheduler_.RegisterStream(stream_id, precedence);
+  data_stream_scheduler_.Register(stream_id, precedence.spdy3_priority());
 }
 
 void QuicWriteBlockedList::UnregisterStream(QuicStreamId stream_id,
@@ -83,7 +78,7 @@ void QuicWriteBlockedList::UnregisterStream(QuicStreamId stream_id,
     static_stream_collection_.Unregister(stream_id);
     return;
   }
-  priority_write_scheduler_.UnregisterStream(stream_id);
+  data_stream_scheduler_.Unregister(stream_id);
 }
 
 void QuicWriteBlockedList::UpdateStreamPriority(
@@ -91,7 +86,8 @@ void QuicWriteBlockedList::UpdateStreamPriority(
     const spdy::SpdyStreamPrecedence& new_precedence) {
   QUICHE_DCHECK(!static_stream_collection_.IsRegistered(stream_id));
   QUICHE_DCHECK(new_precedence.is_spdy3_priority());
-  priority_write_scheduler_.UpdateStreamPrecedence(stream_id, new_precedence);
+  data_stream_scheduler_.UpdatePriority(stream_id,
+                                        new_precedence.spdy3_priority());
 }
 
 void QuicWriteBlockedList::UpdateBytesForStream(QuicStreamId stream_id,
@@ -112,7 +108,15 @@ void QuicWriteBlockedList::AddStream(QuicStreamId stream_id) {
   bool push_front =
       stream_id == batch_write_stream_id_[last_priority_popped_] &&
       bytes_left_for_batch_write_[last_priority_popped_] > 0;
-  priority_write_scheduler_.MarkStreamReady(stream_id, push_front);
+  data_stream_scheduler_.MarkReady(stream_id, push_front);
+}
+
+bool QuicWriteBlockedList::PopStream(QuicStreamId stream_id) {
+  if (static_stream_collection_.IsRegistered(stream_id) ||
+      !data_stream_scheduler_.IsRegistered(stream_id)) {
+    return false;
+  }
+  return data_stream_scheduler_.MarkNotReady(stream_id);
 }
 
 bool QuicWriteBlockedList::IsStreamBlocked(QuicStreamId stream_id) const {
@@ -122,7 +126,210 @@ bool QuicWriteBlockedList::IsStreamBlocked(QuicStreamId stream_id) const {
     }
   }
 
-  return priority_write_scheduler_.IsStreamReady(stream_id);
+  return data_stream_scheduler_.IsReady(stream_id);
+}
+
+void QuicWriteBlockedList::DataStreamScheduler::Register(
+    QuicStreamId stream_id, spdy::SpdyPriority priority) {
+  StreamEntry entry;
+  entry.stream_id = stream_id;
+  entry.priority = priority;
+  bool inserted = entries_.insert(std::make_pair(stream_id, entry)).second;
+  QUIC_BUG_IF(quic_write_blocked_list_register_twice, !inserted)
+      << "Stream " << stream_id << " already registered";
+}
+
+void QuicWriteBlockedList::DataStreamScheduler::Unregister(
+    QuicStreamId stream_id) {
+  auto it = entries_.find(stream_id);
+  if (it == entries_.end()) {
+    QUIC_BUG(quic_write_blocked_list_unregister_unknown)
+        << "Stream " << stream_id << " not registered";
+    return;
+  }
+  if (it->second.ready) {
+    Unlink(&it->second);
+    --num_ready_streams_;
+  }
+  entries_.erase(it);
+}
+
+bool QuicWriteBlockedList::DataStreamScheduler::IsRegistered(
+    QuicStreamId stream_id) const {
+  return entries_.find(stream_id) != entries_.end();
+}
+
+spdy::SpdyPriority QuicWriteBlockedList::DataStreamScheduler::GetPriority(
+    QuicStreamId stream_id) const {
+  auto it = entries_.find(stream_id);
+  if (it == entries_.end()) {
+    QUIC_DVLOG(1) << "Stream " << stream_id << " not registered";
+    return spdy::kV3LowestPriority;
+  }
+  return it->second.priority;
+}
+
+void QuicWriteBlockedList::DataStreamScheduler::UpdatePriority(
+    QuicStreamId stream_id, spdy::SpdyPriority priority) {
+  auto it = entries_.find(stream_id);
+  if (it == entries_.end()) {
+    QUIC_DVLOG(1) << "Stream " << stream_id << " not registered";
+    return;
+  }
+  StreamEntry& entry = it->second;
+  if (entry.priority == priority) {
+    return;
+  }
+  if (entry.ready) {
+    Unlink(&entry);
+    entry.priority = priority;
+    PushBack(&entry);
+  } else {
+    entry.priority = priority;
+  }
+}
+
+void QuicWriteBlockedList::DataStreamScheduler::MarkReady(
+    QuicStreamId stream_id, bool push_front) {
+  auto it = entries_.find(stream_id);
+  if (it == entries_.end()) {
+    QUIC_BUG(quic_write_blocked_list_mark_unknown_ready)
+        << "Stream " << stream_id << " not registered";
+    return;
+  }
+  StreamEntry& entry = it->second;
+  if (entry.ready) {
+    return;
+  }
+  if (push_front) {
+    PushFront(&entry);
+  } else {
+    PushBack(&entry);
+  }
+  entry.ready = true;
+  ++num_ready_streams_;
+}
+
+bool QuicWriteBlockedList::DataStreamScheduler::MarkNotReady(
+    QuicStreamId stream_id) {
+  auto it = entries_.find(stream_id);
+  if (it == entries_.end()) {
+    QUIC_DVLOG(1) << "Stream " << stream_id << " not registered";
+    return false;
+  }
+  StreamEntry& entry = it->second;
+  if (!entry.ready) {
+    return false;
+  }
+  Unlink(&entry);
+  entry.ready = false;
+  --num_ready_streams_;
+  return true;
+}
+
+bool QuicWriteBlockedList::DataStreamScheduler::IsReady(
+    QuicStreamId stream_id) const {
+  auto it = entries_.find(stream_id);
+  if (it == entries_.end()) {
+    QUIC_DVLOG(1) << "Stream " << stream_id << " not registered";
+    return false;
+  }
+  return it->second.ready;
+}
+
+bool QuicWriteBlockedList::DataStreamScheduler::ShouldYield(
+    QuicStreamId stream_id) const {
+  auto it = entries_.find(stream_id);
+  if (it == entries_.end()) {
+    QUIC_BUG(quic_write_blocked_list_yield_unknown)
+        << "Stream " << stream_id << " not registered";
+    return false;
+  }
+  const StreamEntry& entry = it->second;
+
+  // If there is a ready stream in a higher priority bucket, this stream
+  // should yield.  Lower priority values are more urgent, so the occupancy
+  // bits below this stream's are the higher buckets.
+  const uint8_t higher_buckets =
+      bucket_occupancy_ & ((1 << entry.priority) - 1);
+  if (higher_buckets != 0) {
+    return true;
+  }
+
+  // If this priority level is empty, or this stream is the next up, there's
+  // no need to yield.
+  const Bucket& bucket = buckets_[entry.priority];
+  if (bucket.head == nullptr || bucket.head->stream_id == stream_id) {
+    return false;
+  }
+
+  // There are other streams in this priority level which take precedence.
+  // Yield.
+  return true;
+}
+
+QuicStreamId QuicWriteBlockedList::DataStreamScheduler::Pop(
+    spdy::SpdyPriority* priority) {
+  for (spdy::SpdyPriority p = spdy::kV3HighestPriority;
+       p <= spdy::kV3LowestPriority; ++p) {
+    if ((bucket_occupancy_ & (1 << p)) == 0) {
+      continue;
+    }
+    StreamEntry* entry = buckets_[p].head;
+    Unlink(entry);
+    entry->ready = false;
+    --num_ready_streams_;
+    *priority = p;
+    return entry->stream_id;
+  }
+  QUIC_BUG(quic_write_blocked_list_pop_empty) << "No ready streams available";
+  *priority = spdy::kV3LowestPriority;
+  return 0;
+}
+
+void QuicWriteBlockedList::DataStreamScheduler::PushFront(StreamEntry* entry) {
+  Bucket& bucket = buckets_[entry->priority];
+  entry->prev = nullptr;
+  entry->next = bucket.head;
+  if (bucket.head != nullptr) {
+    bucket.head->prev = entry;
+  } else {
+    bucket.tail = entry;
+  }
+  bucket.head = entry;
+  bucket_occupancy_ |= 1 << entry->priority;
+}
+
+void QuicWriteBlockedList::DataStreamScheduler::PushBack(StreamEntry* entry) {
+  Bucket& bucket = buckets_[entry->priority];
+  entry->prev = bucket.tail;
+  entry->next = nullptr;
+  if (bucket.tail != nullptr) {
+    bucket.tail->next = entry;
+  } else {
+    bucket.head = entry;
+  }
+  bucket.tail = entry;
+  bucket_occupancy_ |= 1 << entry->priority;
+}
+
+void QuicWriteBlockedList::DataStreamScheduler::Unlink(StreamEntry* entry) {
+  Bucket& bucket = buckets_[entry->priority];
+  if (entry->prev != nullptr) {
+    entry->prev->next = entry->next;
+  } else {
+    bucket.head = entry->next;
+  }
+  if (entry->next != nullptr) {
+    entry->next->prev = entry->prev;
+  } else {
+    bucket.tail = entry->prev;
+  }
+  entry->prev = nullptr;
+  entry->next = nullptr;
+  if (bucket.head == nullptr) {
+    bucket_occupancy_ &= ~(1 << entry->priority);
+  }
 }
 
 void QuicWriteBlockedList::StaticStreamCollection::Register(QuicStreamId id) {
@@ -7,15 +7,16 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <unordered_map>
 #include <utility>
 
 #include "absl/container/inlined_vector.h"
-#include "http2/core/priority_write_scheduler.h"
 #include "quic/core/quic_packets.h"
 #include "quic/platform/api/quic_bug_tracker.h"
 #include "quic/platform/api/quic_containers.h"
 #include "quic/platform/api/quic_export.h"
 #include "quic/platform/api/quic_flags.h"
+#include "spdy/core/spdy_protocol.h"
 
 namespace quic {
 
@@ -30,7 +31,7 @@ class QUIC_EXPORT_PRIVATE QuicWriteBlockedList {
   ~QuicWriteBlockedList();
 
   bool HasWriteBlockedDataStreams() const {
-    return priority_write_scheduler_.HasReadyStreams();
+    return data_stream_scheduler_.HasReadyStreams();
   }
 
   bool HasWriteBlockedSpecialStream() const {
@@ -43,13 +44,13 @@ class QUIC_EXPORT_PRIVATE QuicWriteBlockedList {
 
   size_t NumBlockedStreams() const {
     return NumBlockedSpecialStreams() +
-           priority_write_scheduler_.NumReadyStreams();
+           data_stream_scheduler_.NumReadyStreams();
   }
 
   bool ShouldYield(QuicStreamId id) const;
 
   spdy::SpdyPriority GetSpdyPriorityofStream(QuicStreamId id) const {
-    return priority_write_scheduler_.GetStreamPrecedence(id).spdy3_priority();
+    return data_stream_scheduler_.GetPriority(id);
   }
 
   // Pops the highest priority stream, special casing crypto and headers
@@ -77,8 +78,102 @@ class QUIC_EXPORT_PRIVATE QuicWriteBlockedList {
   // Returns true if stream with |stream_id| is write blocked.
   bool IsStreamBlocked(QuicStreamId stream_id) const;
 
+  // Pops the given write-blocked data stream out of priority order, e.g. for
+  // earliest-deadline-first admission. Returns false if |stream_id| is not a
+  // write-blocked data stream. Does not latch the stream for batch writing.
+  bool PopStream(QuicStreamId stream_id);
+
  private:
-  http2::PriorityWriteScheduler<QuicStreamId> priority_write_scheduler_;
+  // Schedules data streams by priority bucket.  HTTP/3 extensible priorities
+  // map their urgency (0-7) onto these buckets; streams within a bucket are
+  // served round robin, with the batch-write deficit maintained by the
+  // enclosing class providing each stream a contiguous byte quantum.
+  //
+  // Every operation is O(1): the per-bucket ready lists are doubly linked
+  // through the stream entries themselves, so becoming ready, becoming not
+  // ready, unregistration and priority updates never scan a list, and the
+  // highest non-empty bucket is found through a bitmap of bucket occupancy.
+  // This keeps the scheduler flat even with tens of thousands of concurrent
+  // streams per connection.
+  class QUIC_EXPORT_PRIVATE DataStreamScheduler {
+   public:
+    DataStreamScheduler() = default;
+    DataStreamScheduler(const DataStreamScheduler&) = delete;
+    DataStreamScheduler& operator=(const DataStreamScheduler&) = delete;
+
+    // Registers |stream_id| (initially not ready) at |priority|.
+    void Register(QuicStreamId stream_id, spdy::SpdyPriority priority);
+
+    // Unregisters |stream_id|, dropping it from its ready list if present.
+    void Unregister(QuicStreamId stream_id);
+
+    bool IsRegistered(QuicStreamId stream_id) const;
+
+    // Returns the priority of |stream_id|, or the lowest priority if it is
+    // not registered.
+    spdy::SpdyPriority GetPriority(QuicStreamId stream_id) const;
+
+    // Moves |stream_id| to |priority|.  If the stream is ready, it goes to
+    // the back of the new priority bucket, behind streams already waiting
+    // there.
+    void UpdatePriority(QuicStreamId stream_id, spdy::SpdyPriority priority);
+
+    // Marks |stream_id| ready, adding it to the front or back of its bucket.
+    // No-op if it is already ready.
+    void MarkReady(QuicStreamId stream_id, bool push_front);
+
+    // Marks |stream_id| not ready, removing it from its bucket. Returns true
+    // if the stream was ready.
+    bool MarkNotReady(QuicStreamId stream_id);
+
+    bool IsReady(QuicStreamId stream_id) const;
+
+    // True if a ready stream takes precedence over |stream_id|: any ready
+    // stream in a higher bucket, or another stream ahead of it in its own
+    // bucket.
+    bool ShouldYield(QuicStreamId stream_id) const;
+
+    // Pops the first stream from the highest non-empty bucket and sets
+    // |*priority| to its priority.  There must be a ready stream.
+    QuicStreamId Pop(spdy::SpdyPriority* priority);
+
+    bool HasReadyStreams() const { return bucket_occupancy_ != 0; }
+
+    size_t NumReadyStreams() const { return num_ready_streams_; }
+
+   private:
+    // Links are embedded in the entry so ready lists never allocate and
+    // removal from the middle is O(1).  Entries live in |entries_|;
+    // std::unordered_map guarantees the pointer stability the links rely on.
+    struct QUIC_EXPORT_PRIVATE StreamEntry {
+      QuicStreamId stream_id;
+      spdy::SpdyPriority priority;
+      bool ready = false;
+      StreamEntry* prev = nullptr;
+      StreamEntry* next = nullptr;
+    };
+
+    struct QUIC_EXPORT_PRIVATE Bucket {
+      StreamEntry* head = nullptr;
+      StreamEntry* tail = nullptr;
+    };
+
+    // Links |entry| into its bucket and sets the occupancy bit.
+    void PushFront(StreamEntry* entry);
+    void PushBack(StreamEntry* entry);
+
+    // Unlinks |entry| from its bucket and clears the occupancy bit if the
+    // bucket became empty.
+    void Unlink(StreamEntry* entry);
+
+    Bucket buckets_[spdy::kV3LowestPriority + 1];
+    // Bit |p| is set iff buckets_[p] is non-empty.
+    uint8_t bucket_occupancy_ = 0;
+    size_t num_ready_streams_ = 0;
+    std::unordered_map<QuicStreamId, StreamEntry> entries_;
+  };
+
+  DataStreamScheduler data_stream_scheduler_;
 
   // If performing batch writes, this will be the stream ID of the stream doing
   // batch writes for this priority level.  We will allow this stream to write
@@ -264,6 +264,80 @@ TEST_F(QuicWriteBlockedListTest, Ceding) {
   EXPECT_FALSE(write_blocked_list_.ShouldYield(1));
 }
 
+TEST_F(QuicWriteBlockedListTest, UpdateStreamPriority) {
+  write_blocked_list_.RegisterStream(5, false, spdy::SpdyStreamPrecedence(3));
+  write_blocked_list_.RegisterStream(7, false, spdy::SpdyStreamPrecedence(3));
+  write_blocked_list_.RegisterStream(9, false, spdy::SpdyStreamPrecedence(3));
+  EXPECT_EQ(3, write_blocked_list_.GetSpdyPriorityofStream(7));
+
+  write_blocked_list_.AddStream(5);
+  write_blocked_list_.AddStream(7);
+  write_blocked_list_.AddStream(9);
+
+  // Raising the priority of a blocked stream moves it ahead of streams in
+  // lower priority buckets.
+  write_blocked_list_.UpdateStreamPriority(
+      7, spdy::SpdyStreamPrecedence(kV3HighestPriority));
+  EXPECT_EQ(kV3HighestPriority, write_blocked_list_.GetSpdyPriorityofStream(7));
+  EXPECT_TRUE(write_blocked_list_.ShouldYield(5));
+  EXPECT_FALSE(write_blocked_list_.ShouldYield(7));
+  EXPECT_EQ(7u, write_blocked_list_.PopFront());
+
+  // Lowering the priority of a blocked stream sends it behind streams in
+  // higher priority buckets.
+  write_blocked_list_.UpdateStreamPriority(
+      5, spdy::SpdyStreamPrecedence(kV3LowestPriority));
+  EXPECT_EQ(9u, write_blocked_list_.PopFront());
+  EXPECT_EQ(5u, write_blocked_list_.PopFront());
+  EXPECT_EQ(0u, write_blocked_list_.NumBlockedStreams());
+}
+
+TEST_F(QuicWriteBlockedListTest, UnregisterBlockedStream) {
+  write_blocked_list_.RegisterStream(5, false, spdy::SpdyStreamPrecedence(3));
+  write_blocked_list_.RegisterStream(7, false, spdy::SpdyStreamPrecedence(3));
+  write_blocked_list_.AddStream(5);
+  write_blocked_list_.AddStream(7);
+  EXPECT_EQ(2u, write_blocked_list_.NumBlockedStreams());
+
+  // Unregistering a blocked stream removes it from its ready list.
+  write_blocked_list_.UnregisterStream(5, false);
+  EXPECT_EQ(1u, write_blocked_list_.NumBlockedStreams());
+  EXPECT_EQ(7u, write_blocked_list_.PopFront());
+  EXPECT_EQ(0u, write_blocked_list_.NumBlockedStreams());
+  EXPECT_FALSE(write_blocked_list_.HasWriteBlockedDataStreams());
+}
+
+TEST_F(QuicWriteBlockedListTest, PopStream) {
+  write_blocked_list_.RegisterStream(
+      3, true, spdy::SpdyStreamPrecedence(kV3HighestPriority));
+  write_blocked_list_.RegisterStream(5, false, spdy::SpdyStreamPrecedence(1));
+  write_blocked_list_.RegisterStream(7, false, spdy::SpdyStreamPrecedence(3));
+  write_blocked_list_.RegisterStream(9, false, spdy::SpdyStreamPrecedence(3));
+  write_blocked_list_.AddStream(3);
+  write_blocked_list_.AddStream(5);
+  write_blocked_list_.AddStream(7);
+  write_blocked_list_.AddStream(9);
+  EXPECT_EQ(4u, write_blocked_list_.NumBlockedStreams());
+
+  // A blocked data stream can be popped out of priority order.
+  EXPECT_TRUE(write_blocked_list_.PopStream(9));
+  EXPECT_FALSE(write_blocked_list_.IsStreamBlocked(9));
+  EXPECT_EQ(3u, write_blocked_list_.NumBlockedStreams());
+
+  // Popping again fails: the stream is no longer blocked.
+  EXPECT_FALSE(write_blocked_list_.PopStream(9));
+  // Static and unregistered streams cannot be popped this way.
+  EXPECT_FALSE(write_blocked_list_.PopStream(3));
+  EXPECT_FALSE(write_blocked_list_.PopStream(11));
+  EXPECT_EQ(3u, write_blocked_list_.NumBlockedStreams());
+
+  // The remaining streams still pop in priority order.
+  EXPECT_EQ(3u, write_blocked_list_.PopFront());
+  EXPECT_EQ(5u, write_blocked_list_.PopFront());
+  EXPECT_EQ(7u, write_blocked_list_.PopFront());
+  EXPECT_EQ(0u, write_blocked_list_.NumBlockedStreams());
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace quic
@@ -0,0 +1,132 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/quic_xor_repair_engine.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "quic/core/quic_data_reader.h"
+#include "quic/core/quic_data_writer.h"
+#include "quic/platform/api/quic_logging.h"
+
+namespace quic {
+
+QuicXorRepairEncoder::QuicXorRepairEncoder() {
+  memset(xor_buffer_, 0, sizeof(xor_buffer_));
+}
+
+void QuicXorRepairEncoder::AbsorbSourceData(
+    absl::string_view data, std::vector<std::string>* repair_payloads) {
+  while (!data.empty()) {
+    const size_t chunk = std::min(kSymbolSize - symbol_fill_, data.size());
+    for (size_t i = 0; i < chunk; ++i) {
+      xor_buffer_[symbol_fill_ + i] ^= static_cast<uint8_t>(data[i]);
+    }
+    symbol_fill_ += chunk;
+    block_payload_length_ += chunk;
+    data.remove_prefix(chunk);
+    if (symbol_fill_ == kSymbolSize) {
+      symbol_fill_ = 0;
+      ++symbols_in_block_;
+      if (symbols_in_block_ >= block_size_) {
+        CloseBlock(repair_payloads);
+      }
+    }
+  }
+}
+
+void QuicXorRepairEncoder::Flush(std::vector<std::string>* repair_payloads) {
+  if (block_payload_length_ == 0) {
+    return;
+  }
+  CloseBlock(repair_payloads);
+}
+
+void QuicXorRepairEncoder::OnLossRateUpdated(float loss_rate) {
+  if (loss_rate <= 0) {
+    block_size_ = kMaxBlockSize;
+    return;
+  }
+  // One repair symbol per block of k source symbols adds 1/k overhead; aim
+  // the overhead at twice the observed loss rate so that a typical block
+  // loses at most its one recoverable symbol.
+  const size_t target_block_size =
+      static_cast<size_t>(1.0f / (2.0f * loss_rate));
+  block_size_ = std::min(kMaxBlockSize,
+                         std::max(kMinBlockSize, target_block_size));
+}
+
+void QuicXorRepairEncoder::CloseBlock(
+    std::vector<std::string>* repair_payloads) {
+  const size_t num_source_symbols =
+      symbols_in_block_ + (symbol_fill_ > 0 ? 1 : 0);
+  QUICHE_DCHECK_GT(num_source_symbols, 0u);
+  std::string payload(kRepairSymbolHeaderSize + kSymbolSize, '\0');
+  QuicDataWriter writer(payload.size(), &payload[0]);
+  const bool success =
+      writer.WriteUInt8(kRepairSymbolType) &&
+      writer.WriteUInt64(block_number_) && writer.WriteUInt64(block_offset_) &&
+      writer.WriteUInt8(static_cast<uint8_t>(num_source_symbols)) &&
+      writer.WriteUInt16(static_cast<uint16_t>(kSymbolSize)) &&
+      writer.WriteUInt32(block_payload_length_) &&
+      writer.WriteBytes(xor_buffer_, kSymbolSize);
+  QUICHE_DCHECK(success);
+  repair_payloads->push_back(std::move(payload));
+
+  ++block_number_;
+  block_offset_ += block_payload_length_;
+  block_payload_length_ = 0;
+  symbols_in_block_ = 0;
+  symbol_fill_ = 0;
+  memset(xor_buffer_, 0, sizeof(xor_buffer_));
+}
+
+// static
+bool QuicXorRepairDecoder::ParseRepairSymbol(
+    absl::string_view payload, QuicXorRepairSymbolHeader* header,
+    absl::string_view* xor_bytes) {
+  QuicDataReader reader(payload);
+  uint8_t type;
+  if (!reader.ReadUInt8(&type) ||
+      type != QuicXorRepairEncoder::kRepairSymbolType ||
+      !reader.ReadUInt64(&header->block_number) ||
+      !reader.ReadUInt64(&header->block_offset) ||
+      !reader.ReadUInt8(&header->num_source_symbols) ||
+      !reader.ReadUInt16(&header->symbol_size) ||
+      !reader.ReadUInt32(&header->block_payload_length)) {
+    return false;
+  }
+  if (header->num_source_symbols == 0 || header->symbol_size == 0 ||
+      reader.BytesRemaining() != header->symbol_size) {
+    return false;
+  }
+  *xor_bytes = reader.ReadRemainingPayload();
+  return true;
+}
+
+// static
+std::string QuicXorRepairDecoder::RecoverMissingSymbol(
+    const QuicXorRepairSymbolHeader& header, absl::string_view xor_bytes,
+    const std::vector<absl::string_view>& received_symbols,
+    size_t missing_index) {
+  QUICHE_DCHECK_EQ(received_symbols.size(),
+                   static_cast<size_t>(header.num_source_symbols) - 1);
+  QUICHE_DCHECK_LT(missing_index, header.num_source_symbols);
+  std::string recovered(xor_bytes.data(), xor_bytes.size());
+  for (const absl::string_view symbol : received_symbols) {
+    QUICHE_DCHECK_LE(symbol.size(), recovered.size());
+    for (size_t i = 0; i < symbol.size(); ++i) {
+      recovered[i] ^= symbol[i];
+    }
+  }
+  const size_t missing_symbol_length = std::min<size_t>(
+      header.symbol_size,
+      header.block_payload_length - missing_index * header.symbol_size);
+  recovered.resize(missing_symbol_length);
+  return recovered;
+}
+
+}  // namespace quic
@@ -0,0 +1,120 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_QUIC_XOR_REPAIR_ENGINE_H_
+#define QUICHE_QUIC_CORE_QUIC_XOR_REPAIR_ENGINE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "quic/platform/api/quic_export.h"
+
+namespace quic {
+
+// Application-level forward error correction for loss-sensitive streams.
+// Outgoing payload bytes are grouped into fixed-size source symbols; after
+// every block of source symbols the encoder emits one repair symbol carrying
+// their byte-wise XOR, which lets the receiver reconstruct any single lost
+// symbol of the block without waiting a round trip for a retransmission.
+// The number of source symbols covered by one repair symbol adapts to the
+// loss rate observed by loss detection, keeping the redundancy overhead
+// proportional to the actual loss.
+class QUIC_EXPORT_PRIVATE QuicXorRepairEncoder {
+ public:
+  // Bytes of payload covered by one source symbol.
+  static constexpr size_t kSymbolSize = 1200;
+  // Bounds for the number of source symbols covered by one repair symbol.
+  static constexpr size_t kMinBlockSize = 2;
+  static constexpr size_t kMaxBlockSize = 16;
+  // Leading type byte of every serialized repair symbol, so that receivers
+  // can distinguish repair symbols from other datagrams on the same flow.
+  static constexpr uint8_t kRepairSymbolType = 0x52;
+  // Bytes preceding the XOR payload in a serialized repair symbol, including
+  // the type byte.
+  static constexpr size_t kRepairSymbolHeaderSize = 24;
+
+  QuicXorRepairEncoder();
+  QuicXorRepairEncoder(const QuicXorRepairEncoder&) = delete;
+  QuicXorRepairEncoder& operator=(const QuicXorRepairEncoder&) = delete;
+
+  // Absorbs outgoing payload bytes and appends the serialized payload of
+  // every repair symbol completed by |data| to |repair_payloads|.
+  void AbsorbSourceData(absl::string_view data,
+                        std::vector<std::string>* repair_payloads);
+
+  // Closes the current block even if it is not full, appending its repair
+  // payload to |repair_payloads|. Called at end of stream so trailing bytes
+  // are protected too. No-op if no payload was absorbed since the last
+  // repair symbol.
+  void Flush(std::vector<std::string>* repair_payloads);
+
+  // Adapts the block size so that the redundancy overhead of one repair
+  // symbol per block tracks roughly twice |loss_rate|. Takes effect when the
+  // current block completes.
+  void OnLossRateUpdated(float loss_rate);
+
+  size_t block_size() const { return block_size_; }
+
+ private:
+  // Closes the current block and serializes its repair symbol.
+  void CloseBlock(std::vector<std::string>* repair_payloads);
+
+  // Source symbols covered by the next repair symbol.
+  size_t block_size_ = kMaxBlockSize;
+  // Number of the current block, incremented per repair symbol.
+  uint64_t block_number_ = 0;
+  // Payload offset of the first byte of the current block.
+  uint64_t block_offset_ = 0;
+  // Payload bytes absorbed into the current block so far.
+  uint32_t block_payload_length_ = 0;
+  // Completed source symbols in the current block.
+  size_t symbols_in_block_ = 0;
+  // Bytes absorbed into the current, partially filled source symbol.
+  size_t symbol_fill_ = 0;
+  // Running XOR of the source symbols of the current block. Bytes past the
+  // end of a short final symbol are implicitly zero.
+  uint8_t xor_buffer_[kSymbolSize];
+};
+
+// Parsed header of a serialized repair symbol. The leading type byte is
+// validated and consumed by ParseRepairSymbol and not stored here.
+struct QUIC_EXPORT_PRIVATE QuicXorRepairSymbolHeader {
+  // Number of the protected block.
+  uint64_t block_number;
+  // Payload offset of the first byte of the protected block.
+  uint64_t block_offset;
+  // Source symbols covered, including a possibly short final symbol.
+  uint8_t num_source_symbols;
+  // Bytes per source symbol.
+  uint16_t symbol_size;
+  // Total payload bytes covered by the block.
+  uint32_t block_payload_length;
+};
+
+// Receiver-side helpers for repair symbols, typically fed from an HTTP/3
+// datagram visitor.
+class QUIC_EXPORT_PRIVATE QuicXorRepairDecoder {
+ public:
+  // Splits a serialized repair symbol into its header and XOR payload.
+  // Returns false if |payload| is malformed. |xor_bytes| aliases |payload|.
+  static bool ParseRepairSymbol(absl::string_view payload,
+                                QuicXorRepairSymbolHeader* header,
+                                absl::string_view* xor_bytes);
+
+  // Reconstructs the single missing source symbol at |missing_index| by
+  // XOR-ing |xor_bytes| with the block's |received_symbols| (the other
+  // num_source_symbols - 1 symbols, in any order). The result is truncated
+  // to the missing symbol's original length.
+  static std::string RecoverMissingSymbol(
+      const QuicXorRepairSymbolHeader& header, absl::string_view xor_bytes,
+      const std::vector<absl::string_view>& received_symbols,
+      size_t missing_index);
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_QUIC_XOR_REPAIR_ENGINE_H_
@@ -0,0 +1,149 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/quic_xor_repair_engine.h"
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "quic/platform/api/quic_test.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+constexpr size_t kSymbolSize = QuicXorRepairEncoder::kSymbolSize;
+
+// Deterministic pseudo-random payload.
+std::string MakePayload(size_t length) {
+  std::string payload(length, '\0');
+  uint32_t state = 0x5bd1e995;
+  for (size_t i = 0; i < length; ++i) {
+    state = state * 1664525 + 1013904223;
+    payload[i] = static_cast<char>(state >> 24);
+  }
+  return payload;
+}
+
+// Splits |payload| into the source symbols of a single block.
+std::vector<absl::string_view> SplitIntoSymbols(absl::string_view payload) {
+  std::vector<absl::string_view> symbols;
+  while (!payload.empty()) {
+    symbols.push_back(payload.substr(0, kSymbolSize));
+    payload.remove_prefix(symbols.back().size());
+  }
+  return symbols;
+}
+
+class QuicXorRepairEngineTest : public QuicTest {
+ protected:
+  // Encodes |payload| as one block, then recovers the symbol at
+  // |missing_index| from the other symbols and the repair payload.
+  void EncodeDropAndRecover(absl::string_view payload, size_t missing_index) {
+    QuicXorRepairEncoder encoder;
+    std::vector<std::string> repair_payloads;
+    encoder.AbsorbSourceData(payload, &repair_payloads);
+    encoder.Flush(&repair_payloads);
+    ASSERT_EQ(1u, repair_payloads.size());
+
+    QuicXorRepairSymbolHeader header;
+    absl::string_view xor_bytes;
+    ASSERT_TRUE(QuicXorRepairDecoder::ParseRepairSymbol(repair_payloads[0],
+                                                        &header, &xor_bytes));
+    EXPECT_EQ(0u, header.block_number);
+    EXPECT_EQ(0u, header.block_offset);
+    EXPECT_EQ(kSymbolSize, header.symbol_size);
+    EXPECT_EQ(payload.size(), header.block_payload_length);
+
+    std::vector<absl::string_view> symbols = SplitIntoSymbols(payload);
+    ASSERT_EQ(header.num_source_symbols, symbols.size());
+    std::vector<absl::string_view> received;
+    for (size_t i = 0; i < symbols.size(); ++i) {
+      if (i != missing_index) {
+        received.push_back(symbols[i]);
+      }
+    }
+    const std::string recovered = QuicXorRepairDecoder::RecoverMissingSymbol(
+        header, xor_bytes, received, missing_index);
+    EXPECT_EQ(symbols[missing_index], recovered);
+  }
+};
+
+TEST_F(QuicXorRepairEngineTest, RecoversAnyMissingSymbol) {
+  const std::string payload = MakePayload(4 * kSymbolSize);
+  for (size_t missing_index = 0; missing_index < 4; ++missing_index) {
+    EncodeDropAndRecover(payload, missing_index);
+  }
+}
+
+TEST_F(QuicXorRepairEngineTest, RecoversShortFinalSymbol) {
+  const std::string payload = MakePayload(2 * kSymbolSize + kSymbolSize / 2);
+  EncodeDropAndRecover(payload, /*missing_index=*/2);
+  EncodeDropAndRecover(payload, /*missing_index=*/0);
+}
+
+TEST_F(QuicXorRepairEngineTest, FullBlocksEmitWithoutFlush) {
+  QuicXorRepairEncoder encoder;
+  encoder.OnLossRateUpdated(0.25f);  // Block size 2.
+  ASSERT_EQ(2u, encoder.block_size());
+
+  std::vector<std::string> repair_payloads;
+  encoder.AbsorbSourceData(MakePayload(5 * kSymbolSize), &repair_payloads);
+  EXPECT_EQ(2u, repair_payloads.size());
+  encoder.Flush(&repair_payloads);
+  ASSERT_EQ(3u, repair_payloads.size());
+
+  // Block numbers and offsets advance across repair symbols.
+  QuicXorRepairSymbolHeader header;
+  absl::string_view xor_bytes;
+  ASSERT_TRUE(QuicXorRepairDecoder::ParseRepairSymbol(repair_payloads[2],
+                                                      &header, &xor_bytes));
+  EXPECT_EQ(2u, header.block_number);
+  EXPECT_EQ(4 * kSymbolSize, header.block_offset);
+  EXPECT_EQ(1u, header.num_source_symbols);
+  EXPECT_EQ(kSymbolSize, header.block_payload_length);
+}
+
+TEST_F(QuicXorRepairEngineTest, BlockSizeTracksLossRate) {
+  QuicXorRepairEncoder encoder;
+  EXPECT_EQ(QuicXorRepairEncoder::kMaxBlockSize, encoder.block_size());
+  encoder.OnLossRateUpdated(0.02f);  // 1 / (2 * 0.02) = 25, clamped.
+  EXPECT_EQ(QuicXorRepairEncoder::kMaxBlockSize, encoder.block_size());
+  encoder.OnLossRateUpdated(0.1f);  // 1 / (2 * 0.1) = 5.
+  EXPECT_EQ(5u, encoder.block_size());
+  encoder.OnLossRateUpdated(0.5f);  // Clamped to the minimum.
+  EXPECT_EQ(QuicXorRepairEncoder::kMinBlockSize, encoder.block_size());
+  encoder.OnLossRateUpdated(0.f);
+  EXPECT_EQ(QuicXorRepairEncoder::kMaxBlockSize, encoder.block_size());
+}
+
+TEST_F(QuicXorRepairEngineTest, ParseRejectsMalformedPayloads) {
+  QuicXorRepairSymbolHeader header;
+  absl::string_view xor_bytes;
+  EXPECT_FALSE(
+      QuicXorRepairDecoder::ParseRepairSymbol("short", &header, &xor_bytes));
+
+  QuicXorRepairEncoder encoder;
+  std::vector<std::string> repair_payloads;
+  encoder.AbsorbSourceData(MakePayload(kSymbolSize), &repair_payloads);
+  encoder.Flush(&repair_payloads);
+  ASSERT_EQ(1u, repair_payloads.size());
+  // Truncating the XOR payload invalidates the repair symbol.
+  EXPECT_FALSE(QuicXorRepairDecoder::ParseRepairSymbol(
+      absl::string_view(repair_payloads[0]).substr(
+          0, repair_payloads[0].size() - 1),
+      &header, &xor_bytes));
+
+  // A datagram that does not carry the repair symbol type byte is not a
+  // repair symbol.
+  std::string wrong_type = repair_payloads[0];
+  wrong_type[0] ^= 0xff;
+  EXPECT_FALSE(
+      QuicXorRepairDecoder::ParseRepairSymbol(wrong_type, &header, &xor_bytes));
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
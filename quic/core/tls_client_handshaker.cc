@@ -34,6 +34,7 @@ TlsClientHandshaker::TlsClientHandshaker(
       server_id_(server_id),
       proof_verifier_(crypto_config->proof_verifier()),
       verify_context_(std::move(verify_context)),
+      policy_verifier_(crypto_config->policy_verifier()),
       proof_handler_(proof_handler),
       session_cache_(crypto_config->session_cache()),
       user_agent_id_(crypto_config->user_agent_id()),
@@ -64,7 +65,41 @@ TlsClientHandshaker::TlsClientHandshaker(
   }
 }
 
-TlsClientHandshaker::~TlsClientHandshaker() {}
+TlsClientHandshaker::~TlsClientHandshaker() {
+  if (pending_policy_verify_callback_ != nullptr) {
+    pending_policy_verify_callback_->Cancel();
+    pending_policy_verify_callback_ = nullptr;
+  }
+}
+
+TlsClientHandshaker::PolicyVerifierCallback::PolicyVerifierCallback(
+    TlsClientHandshaker* parent)
+    : parent_(parent) {}
+
+void TlsClientHandshaker::PolicyVerifierCallback::Run(
+    bool ok,
+    const std::string& error_details,
+    std::unique_ptr<ProofVerifyDetails>* details) {
+  if (parent_ == nullptr) {
+    return;
+  }
+  parent_->pending_policy_verify_callback_ = nullptr;
+  if (details != nullptr && *details != nullptr) {
+    parent_->policy_verify_details_ = std::move(*details);
+    parent_->proof_handler_->OnProofVerifyDetailsAvailable(
+        *parent_->policy_verify_details_);
+  }
+  if (!ok && !parent_->is_connection_closed()) {
+    parent_->CloseConnection(
+        QUIC_PROOF_INVALID,
+        absl::StrCat("Deferred certificate policy check failed: ",
+                     error_details));
+  }
+}
+
+void TlsClientHandshaker::PolicyVerifierCallback::Cancel() {
+  parent_ = nullptr;
+}
 
 bool TlsClientHandshaker::CryptoConnect() {
   if (!pre_shared_key_.empty()) {
@@ -494,12 +529,48 @@ QuicAsyncStatus TlsClientHandshaker::VerifyCertChain(
   std::string sct_list(reinterpret_cast<const char*>(sct_list_raw),
                        sct_list_len);
 
+  if (policy_verifier_ != nullptr &&
+      !StartPolicyVerification(certs, ocsp_response, sct_list,
+                               error_details)) {
+    *out_alert = SSL_AD_BAD_CERTIFICATE;
+    return QUIC_FAILURE;
+  }
+
   return proof_verifier_->VerifyCertChain(
       server_id_.host(), server_id_.port(), certs, ocsp_response, sct_list,
       verify_context_.get(), error_details, details, out_alert,
       std::move(callback));
 }
 
+bool TlsClientHandshaker::StartPolicyVerification(
+    const std::vector<std::string>& certs,
+    const std::string& ocsp_response,
+    const std::string& sct_list,
+    std::string* error_details) {
+  QUICHE_DCHECK(pending_policy_verify_callback_ == nullptr);
+  PolicyVerifierCallback* policy_callback = new PolicyVerifierCallback(this);
+  QuicAsyncStatus status = policy_verifier_->VerifyCertChain(
+      server_id_.host(), server_id_.port(), certs, ocsp_response, sct_list,
+      verify_context_.get(), error_details, &policy_verify_details_,
+      &policy_verify_tls_alert_,
+      std::unique_ptr<ProofVerifierCallback>(policy_callback));
+  switch (status) {
+    case QUIC_SUCCESS:
+      if (policy_verify_details_ != nullptr) {
+        proof_handler_->OnProofVerifyDetailsAvailable(*policy_verify_details_);
+      }
+      return true;
+    case QUIC_FAILURE:
+      return false;
+    case QUIC_PENDING:
+      // The handshake proceeds optimistically; |policy_callback| closes the
+      // connection if the checks fail later.
+      pending_policy_verify_callback_ = policy_callback;
+      return true;
+  }
+  return true;
+}
+
 void TlsClientHandshaker::OnProofVerifyDetailsAvailable(
     const ProofVerifyDetails& verify_details) {
   proof_handler_->OnProofVerifyDetailsAvailable(verify_details);
@@ -110,6 +110,32 @@ class QUIC_EXPORT_PRIVATE TlsClientHandshaker
   TlsConnection::Delegate* ConnectionDelegate() override { return this; }
 
  private:
+  // Handles the result of the deferred policy checks when staged certificate
+  // verification is enabled via QuicCryptoClientConfig::set_policy_verifier().
+  // The handshake proceeds optimistically while the checks run; a late
+  // failure closes the connection.
+  class QUIC_EXPORT_PRIVATE PolicyVerifierCallback
+      : public ProofVerifierCallback {
+   public:
+    explicit PolicyVerifierCallback(TlsClientHandshaker* parent);
+
+    // ProofVerifierCallback interface.
+    void Run(bool ok,
+             const std::string& error_details,
+             std::unique_ptr<ProofVerifyDetails>* details) override;
+    void Cancel();
+
+   private:
+    TlsClientHandshaker* parent_;
+  };
+
+  // Starts the deferred policy checks on |certs|. Returns false if they fail
+  // synchronously, in which case |*error_details| is set.
+  bool StartPolicyVerification(const std::vector<std::string>& certs,
+                               const std::string& ocsp_response,
+                               const std::string& sct_list,
+                               std::string* error_details);
+
   bool SetAlpn();
   bool SetTransportParameters();
   bool ProcessTransportParameters(std::string* error_details);
@@ -133,6 +159,15 @@ class QUIC_EXPORT_PRIVATE TlsClientHandshaker
   ProofVerifier* proof_verifier_;
   std::unique_ptr<ProofVerifyContext> verify_context_;
 
+  // Optional verifier for deferred policy checks, owned by the
+  // QuicCryptoClientConfig. Null unless staged verification is enabled.
+  ProofVerifier* policy_verifier_;
+  // Owned by |policy_verifier_| while a policy check is pending; used to
+  // cancel the callback if this handshaker is destroyed first.
+  PolicyVerifierCallback* pending_policy_verify_callback_ = nullptr;
+  std::unique_ptr<ProofVerifyDetails> policy_verify_details_;
+  uint8_t policy_verify_tls_alert_ = 0;
+
   // Unowned pointer to the proof handler which has the
   // OnProofVerifyDetailsAvailable callback to use for notifying the result of
   // certificate verification.
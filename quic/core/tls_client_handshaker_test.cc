@@ -171,6 +171,58 @@ class TestProofVerifier : public ProofVerifier {
   std::vector<std::unique_ptr<VerifyChainPendingOp>> pending_ops_;
 };
 
+// Policy verifier for staged certificate verification tests. Records
+// VerifyCertChain calls, returns QUIC_PENDING, and completes them on demand.
+class PendingPolicyVerifier : public ProofVerifier {
+ public:
+  QuicAsyncStatus VerifyProof(
+      const std::string& /*hostname*/,
+      const uint16_t /*port*/,
+      const std::string& /*server_config*/,
+      QuicTransportVersion /*quic_version*/,
+      absl::string_view /*chlo_hash*/,
+      const std::vector<std::string>& /*certs*/,
+      const std::string& /*cert_sct*/,
+      const std::string& /*signature*/,
+      const ProofVerifyContext* /*context*/,
+      std::string* /*error_details*/,
+      std::unique_ptr<ProofVerifyDetails>* /*details*/,
+      std::unique_ptr<ProofVerifierCallback> /*callback*/) override {
+    return QUIC_FAILURE;
+  }
+
+  QuicAsyncStatus VerifyCertChain(
+      const std::string& /*hostname*/,
+      const uint16_t /*port*/,
+      const std::vector<std::string>& /*certs*/,
+      const std::string& /*ocsp_response*/,
+      const std::string& /*cert_sct*/,
+      const ProofVerifyContext* /*context*/,
+      std::string* /*error_details*/,
+      std::unique_ptr<ProofVerifyDetails>* /*details*/,
+      uint8_t* /*out_alert*/,
+      std::unique_ptr<ProofVerifierCallback> callback) override {
+    callbacks_.push_back(std::move(callback));
+    return QUIC_PENDING;
+  }
+
+  std::unique_ptr<ProofVerifyContext> CreateDefaultContext() override {
+    return nullptr;
+  }
+
+  size_t NumPendingCallbacks() const { return callbacks_.size(); }
+
+  void InvokePendingCallback(size_t n, bool ok) {
+    ASSERT_GT(NumPendingCallbacks(), n);
+    std::unique_ptr<ProofVerifyDetails> details;
+    callbacks_[n]->Run(ok, ok ? "" : "CT policy violation", &details);
+    callbacks_.erase(callbacks_.begin() + n);
+  }
+
+ private:
+  std::vector<std::unique_ptr<ProofVerifierCallback>> callbacks_;
+};
+
 class TlsClientHandshakerTest : public QuicTestWithParam<ParsedQuicVersion> {
  public:
   TlsClientHandshakerTest()
@@ -334,6 +386,36 @@ TEST_P(TlsClientHandshakerTest, HandshakeWithAsyncProofVerifier) {
   EXPECT_TRUE(stream()->one_rtt_keys_available());
 }
 
+TEST_P(TlsClientHandshakerTest, StagedPolicyVerificationSuccess) {
+  auto policy_verifier = std::make_unique<PendingPolicyVerifier>();
+  PendingPolicyVerifier* policy_verifier_ptr = policy_verifier.get();
+  crypto_config_->set_policy_verifier(std::move(policy_verifier));
+  CreateConnection();
+
+  // The handshake completes while the policy checks are still pending.
+  CompleteCryptoHandshake();
+  EXPECT_TRUE(stream()->one_rtt_keys_available());
+  ASSERT_EQ(policy_verifier_ptr->NumPendingCallbacks(), 1u);
+
+  policy_verifier_ptr->InvokePendingCallback(0, /*ok=*/true);
+  EXPECT_TRUE(connection_->connected());
+}
+
+TEST_P(TlsClientHandshakerTest, StagedPolicyVerificationLateFailure) {
+  auto policy_verifier = std::make_unique<PendingPolicyVerifier>();
+  PendingPolicyVerifier* policy_verifier_ptr = policy_verifier.get();
+  crypto_config_->set_policy_verifier(std::move(policy_verifier));
+  CreateConnection();
+
+  CompleteCryptoHandshake();
+  EXPECT_TRUE(stream()->one_rtt_keys_available());
+  ASSERT_EQ(policy_verifier_ptr->NumPendingCallbacks(), 1u);
+
+  // A late policy failure aborts the connection.
+  EXPECT_CALL(*connection_, CloseConnection(QUIC_PROOF_INVALID, _, _, _));
+  policy_verifier_ptr->InvokePendingCallback(0, /*ok=*/false);
+}
+
 TEST_P(TlsClientHandshakerTest, Resumption) {
   // Disable 0-RTT on the server so that we're only testing 1-RTT resumption:
   SSL_CTX_set_early_data_enabled(server_crypto_config_->ssl_ctx(), false);
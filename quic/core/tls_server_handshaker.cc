@@ -447,7 +447,6 @@ void TlsServerHandshaker::AdvanceHandshakeFromCallback() {
 bool TlsServerHandshaker::ProcessTransportParameters(
     const SSL_CLIENT_HELLO* client_hello,
     std::string* error_details) {
-  TransportParameters client_params;
   const uint8_t* client_params_bytes;
   size_t params_bytes_len;
 
@@ -470,10 +469,14 @@ bool TlsServerHandshaker::ProcessTransportParameters(
     return false;
   }
   std::string parse_error_details;
-  if (!ParseTransportParameters(session()->connection()->version(),
-                                Perspective::IS_CLIENT, client_params_bytes,
-                                params_bytes_len, &client_params,
-                                &parse_error_details)) {
+  // Client transport parameter blobs repeat heavily across the client
+  // population, so parse through the memoization cache and share the parsed
+  // object with other connections from the same client implementation.
+  std::shared_ptr<const TransportParameters> client_params_ptr =
+      ParseTransportParametersMemoized(
+          session()->connection()->version(), Perspective::IS_CLIENT,
+          client_params_bytes, params_bytes_len, &parse_error_details);
+  if (client_params_ptr == nullptr) {
     QUICHE_DCHECK(!parse_error_details.empty());
     *error_details =
         "Unable to parse client's transport parameters: " + parse_error_details;
@@ -481,7 +484,7 @@ bool TlsServerHandshaker::ProcessTransportParameters(
   }
 
   // Notify QuicConnectionDebugVisitor.
-  session()->connection()->OnTransportParametersReceived(client_params);
+  session()->connection()->OnTransportParametersReceived(*client_params_ptr);
 
   if (GetQuicReloadableFlag(quic_ignore_key_update_not_yet_supported)) {
     QUIC_RELOADABLE_FLAG_COUNT_N(quic_ignore_key_update_not_yet_supported, 2,
@@ -494,12 +497,19 @@ bool TlsServerHandshaker::ProcessTransportParameters(
     // ensure we do not use key updates with those older clients.
     // TODO(dschinazi) remove this workaround once all of our QUIC+TLS Finch
     // experiments have a min_version greater than 86.0.4233.0.
-    if (client_params.custom_parameters.find(
+    if (!client_params_ptr->key_update_not_yet_supported &&
+        client_params_ptr->custom_parameters.find(
             static_cast<TransportParameters::TransportParameterId>(0x4751)) !=
-        client_params.custom_parameters.end()) {
-      client_params.key_update_not_yet_supported = true;
+            client_params_ptr->custom_parameters.end()) {
+      // The parsed object is shared with other connections, so copy it before
+      // modifying it.
+      auto patched_params =
+          std::make_shared<TransportParameters>(*client_params_ptr);
+      patched_params->key_update_not_yet_supported = true;
+      client_params_ptr = std::move(patched_params);
     }
   }
+  const TransportParameters& client_params = *client_params_ptr;
 
   if (client_params.legacy_version_information.has_value() &&
       CryptoUtils::ValidateClientHelloVersion(
@@ -635,6 +645,9 @@ void TlsServerHandshaker::FinishHandshake() {
                   << CryptoUtils::EarlyDataReasonToString(reason_code) << ")";
   state_ = HANDSHAKE_CONFIRMED;
 
+  connection_stats().tls_server_resumption_attempted = ticket_received_;
+  connection_stats().tls_server_session_resumed = SSL_session_reused(ssl());
+
   handshaker_delegate()->OnTlsHandshakeComplete();
   handshaker_delegate()->DiscardOldEncryptionKey(ENCRYPTION_HANDSHAKE);
   handshaker_delegate()->DiscardOldDecryptionKey(ENCRYPTION_HANDSHAKE);
@@ -46,6 +46,18 @@ void UberQuicStreamIdManager::SetMaxOpenIncomingBidirectionalStreams(
     QuicStreamCount max_open_streams) {
   bidirectional_stream_id_manager_.SetMaxOpenIncomingStreams(max_open_streams);
 }
+void UberQuicStreamIdManager::MaybeRaiseMaxOpenIncomingBidirectionalStreams(
+    QuicStreamCount max_open_streams) {
+  bidirectional_stream_id_manager_.MaybeRaiseMaxOpenIncomingStreams(
+      max_open_streams);
+}
+
+void UberQuicStreamIdManager::MaybeRaiseMaxOpenIncomingUnidirectionalStreams(
+    QuicStreamCount max_open_streams) {
+  unidirectional_stream_id_manager_.MaybeRaiseMaxOpenIncomingStreams(
+      max_open_streams);
+}
+
 void UberQuicStreamIdManager::SetMaxOpenIncomingUnidirectionalStreams(
     QuicStreamCount max_open_streams) {
   unidirectional_stream_id_manager_.SetMaxOpenIncomingStreams(max_open_streams);
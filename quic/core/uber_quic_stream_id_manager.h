@@ -43,6 +43,14 @@ class QUIC_EXPORT_PRIVATE UberQuicStreamIdManager {
   void SetMaxOpenIncomingUnidirectionalStreams(
       QuicStreamCount max_open_streams);
 
+  // Raises the incoming stream limits on a live connection, advertising the
+  // new limits with MAX_STREAMS frames. Values at or below the current
+  // limits are ignored.
+  void MaybeRaiseMaxOpenIncomingBidirectionalStreams(
+      QuicStreamCount max_open_streams);
+  void MaybeRaiseMaxOpenIncomingUnidirectionalStreams(
+      QuicStreamCount max_open_streams);
+
   // Returns true if next outgoing bidirectional stream ID can be allocated.
   bool CanOpenNextOutgoingBidirectionalStream() const;
 
@@ -209,6 +209,23 @@ void UberReceivedPacketManager::set_ack_frequency(size_t new_value) {
   }
 }
 
+void UberReceivedPacketManager::set_local_max_ack_delay(
+    QuicTime::Delta local_max_ack_delay) {
+  if (!supports_multiple_packet_number_spaces_) {
+    received_packet_managers_[0].set_local_max_ack_delay(local_max_ack_delay);
+    return;
+  }
+  received_packet_managers_[APPLICATION_DATA].set_local_max_ack_delay(
+      local_max_ack_delay);
+}
+
+void UberReceivedPacketManager::EnableDynamicAckFrequency(
+    float ack_bandwidth_budget) {
+  for (auto& received_packet_manager : received_packet_managers_) {
+    received_packet_manager.EnableDynamicAckFrequency(ack_bandwidth_budget);
+  }
+}
+
 const QuicAckFrame& UberReceivedPacketManager::ack_frame() const {
   QUICHE_DCHECK(!supports_multiple_packet_number_spaces_);
   return received_packet_managers_[0].ack_frame();
@@ -80,6 +80,14 @@ class QUIC_EXPORT_PRIVATE UberReceivedPacketManager {
 
   void set_ack_frequency(size_t new_value);
 
+  // Sets the maximum delay before an application data ack is sent. Initial
+  // and handshake data keep their near-immediate ack delay.
+  void set_local_max_ack_delay(QuicTime::Delta local_max_ack_delay);
+
+  // Enables receive-rate driven ack frequency on all packet number spaces.
+  // See QuicReceivedPacketManager::EnableDynamicAckFrequency().
+  void EnableDynamicAckFrequency(float ack_bandwidth_budget);
+
   bool supports_multiple_packet_number_spaces() const {
     return supports_multiple_packet_number_spaces_;
   }
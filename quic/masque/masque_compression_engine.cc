@@ -83,48 +83,51 @@ QuicDatagramStreamId MasqueCompressionEngine::FindOrCreateCompressionContext(
   context.client_connection_id = client_connection_id;
   context.server_connection_id = server_connection_id;
   context.server_address = server_address;
+  UpdateHeaderPrefix(flow_id, &context);
   contexts_[flow_id] = context;
 
   return flow_id;
 }
 
-bool MasqueCompressionEngine::WriteCompressedPacketToSlice(
-    QuicConnectionId client_connection_id,
-    QuicConnectionId server_connection_id,
-    const QuicSocketAddress& server_address,
-    QuicConnectionId destination_connection_id,
-    QuicConnectionId source_connection_id, QuicDatagramStreamId flow_id,
-    bool validated, uint8_t first_byte, bool long_header,
-    QuicDataReader* reader, QuicDataWriter* writer) {
-  if (validated) {
-    QUIC_DVLOG(1) << "Compressing using validated flow_id " << flow_id;
-    if (!writer->WriteVarInt62(flow_id)) {
+void MasqueCompressionEngine::UpdateHeaderPrefix(
+    QuicDatagramStreamId flow_id, MasqueCompressionContext* context) {
+  context->header_prefix.clear();
+  // Large enough for the longest possible context registration preamble: two
+  // 8-byte varints, two length-prefixed connection IDs, port, address family
+  // and an IPv6 address.
+  char buffer[2 * sizeof(uint64_t) +
+              2 * kQuicMaxConnectionIdWithLengthPrefixLength + sizeof(uint16_t) +
+              sizeof(uint8_t) + QuicIpAddress::kMaxAddressSize];
+  QuicDataWriter writer(sizeof(buffer), buffer);
+  if (context->validated) {
+    if (!writer.WriteVarInt62(flow_id)) {
       QUIC_BUG(quic_bug_10981_1) << "Failed to write flow_id";
-      return false;
+      return;
     }
   } else {
-    QUIC_DVLOG(1) << "Compressing using unvalidated flow_id " << flow_id;
-    if (!writer->WriteVarInt62(kFlowId0)) {
+    if (!writer.WriteVarInt62(kFlowId0)) {
       QUIC_BUG(quic_bug_10981_2) << "Failed to write kFlowId0";
-      return false;
+      return;
     }
-    if (!writer->WriteVarInt62(flow_id)) {
+    if (!writer.WriteVarInt62(flow_id)) {
       QUIC_BUG(quic_bug_10981_3) << "Failed to write flow_id";
-      return false;
+      return;
     }
-    if (!writer->WriteLengthPrefixedConnectionId(client_connection_id)) {
+    if (!writer.WriteLengthPrefixedConnectionId(
+            context->client_connection_id)) {
       QUIC_BUG(quic_bug_10981_4) << "Failed to write client_connection_id";
-      return false;
+      return;
     }
-    if (!writer->WriteLengthPrefixedConnectionId(server_connection_id)) {
+    if (!writer.WriteLengthPrefixedConnectionId(
+            context->server_connection_id)) {
       QUIC_BUG(quic_bug_10981_5) << "Failed to write server_connection_id";
-      return false;
+      return;
     }
-    if (!writer->WriteUInt16(server_address.port())) {
+    if (!writer.WriteUInt16(context->server_address.port())) {
       QUIC_BUG(quic_bug_10981_6) << "Failed to write port";
-      return false;
+      return;
     }
-    QuicIpAddress peer_ip = server_address.host();
+    QuicIpAddress peer_ip = context->server_address.host();
     QUICHE_DCHECK(peer_ip.IsInitialized());
     std::string peer_ip_bytes = peer_ip.ToPackedString();
     QUICHE_DCHECK(!peer_ip_bytes.empty());
@@ -132,29 +135,47 @@ bool MasqueCompressionEngine::WriteCompressedPacketToSlice(
     if (peer_ip.address_family() == IpAddressFamily::IP_V6) {
       address_id = MasqueAddressFamilyIPv6;
       if (peer_ip_bytes.length() != QuicIpAddress::kIPv6AddressSize) {
-        QUIC_BUG(quic_bug_10981_7) << "Bad IPv6 length " << server_address;
-        return false;
+        QUIC_BUG(quic_bug_10981_7)
+            << "Bad IPv6 length " << context->server_address;
+        return;
       }
     } else if (peer_ip.address_family() == IpAddressFamily::IP_V4) {
       address_id = MasqueAddressFamilyIPv4;
       if (peer_ip_bytes.length() != QuicIpAddress::kIPv4AddressSize) {
-        QUIC_BUG(quic_bug_10981_8) << "Bad IPv4 length " << server_address;
-        return false;
+        QUIC_BUG(quic_bug_10981_8)
+            << "Bad IPv4 length " << context->server_address;
+        return;
       }
     } else {
       QUIC_BUG(quic_bug_10981_9)
-          << "Unexpected server_address " << server_address;
-      return false;
+          << "Unexpected server_address " << context->server_address;
+      return;
     }
-    if (!writer->WriteUInt8(address_id)) {
+    if (!writer.WriteUInt8(address_id)) {
       QUIC_BUG(quic_bug_10981_10) << "Failed to write address_id";
-      return false;
+      return;
     }
-    if (!writer->WriteStringPiece(peer_ip_bytes)) {
+    if (!writer.WriteStringPiece(peer_ip_bytes)) {
       QUIC_BUG(quic_bug_10981_11) << "Failed to write IP address";
-      return false;
+      return;
     }
   }
+  context->header_prefix.assign(buffer, writer.length());
+}
+
+bool MasqueCompressionEngine::WriteCompressedPacketToSlice(
+    const MasqueCompressionContext& context,
+    QuicConnectionId destination_connection_id,
+    QuicConnectionId source_connection_id, uint8_t first_byte,
+    bool long_header, QuicDataReader* reader, QuicDataWriter* writer) {
+  if (context.header_prefix.empty()) {
+    QUIC_BUG(quic_bug_10981_24) << "Missing header prefix";
+    return false;
+  }
+  if (!writer->WriteStringPiece(context.header_prefix)) {
+    QUIC_BUG(quic_bug_10981_1) << "Failed to write header prefix";
+    return false;
+  }
   if (!writer->WriteUInt8(first_byte)) {
     QUIC_BUG(quic_bug_10981_12) << "Failed to write first_byte";
     return false;
@@ -214,10 +235,12 @@ bool MasqueCompressionEngine::WriteCompressedPacketToSlice(
   return true;
 }
 
-void MasqueCompressionEngine::CompressAndSendPacket(
+void MasqueCompressionEngine::CompressAndSendPacketInternal(
     absl::string_view packet, QuicConnectionId client_connection_id,
     QuicConnectionId server_connection_id,
-    const QuicSocketAddress& server_address) {
+    const QuicSocketAddress& server_address,
+    QuicDatagramStreamId* long_header_flow_id,
+    QuicDatagramStreamId* short_header_flow_id) {
   QUIC_DVLOG(2) << "Compressing client " << client_connection_id << " server "
                 << server_connection_id << "\n"
                 << quiche::QuicheTextUtils::HexDump(packet);
@@ -249,34 +272,37 @@ void MasqueCompressionEngine::CompressAndSendPacket(
     }
   }
 
-  bool validated = false;
-  QuicDatagramStreamId flow_id = FindOrCreateCompressionContext(
-      client_connection_id, server_connection_id, server_address,
-      client_connection_id_present, server_connection_id_present, &validated);
+  // Which connection IDs are present (and therefore which context matches)
+  // only depends on whether the packet has a long header, so within a batch
+  // the context is resolved at most once per header form.
+  QuicDatagramStreamId* cached_flow_id =
+      long_header ? long_header_flow_id : short_header_flow_id;
+  if (*cached_flow_id == kFlowId0) {
+    bool validated = false;
+    *cached_flow_id = FindOrCreateCompressionContext(
+        client_connection_id, server_connection_id, server_address,
+        client_connection_id_present, server_connection_id_present, &validated);
+  }
+  const QuicDatagramStreamId flow_id = *cached_flow_id;
+  auto context_pair = contexts_.find(flow_id);
+  QUICHE_DCHECK(context_pair != contexts_.end());
+  const MasqueCompressionContext& context = context_pair->second;
+  QUIC_DVLOG(1) << "Compressing using " << (context.validated ? "" : "un")
+                << "validated flow_id " << flow_id;
 
-  size_t slice_length = packet.length() - destination_connection_id.length();
+  size_t slice_length = packet.length() - destination_connection_id.length() +
+                        context.header_prefix.length();
   if (long_header) {
     slice_length -= sizeof(uint8_t) * 2 + source_connection_id.length();
   }
-  if (validated) {
-    slice_length += QuicDataWriter::GetVarInt62Len(flow_id);
-  } else {
-    slice_length += QuicDataWriter::GetVarInt62Len(kFlowId0) +
-                    QuicDataWriter::GetVarInt62Len(flow_id) + sizeof(uint8_t) +
-                    client_connection_id.length() + sizeof(uint8_t) +
-                    server_connection_id.length() +
-                    sizeof(server_address.port()) + sizeof(uint8_t) +
-                    server_address.host().ToPackedString().length();
-  }
   QuicBuffer buffer(
       masque_session_->connection()->helper()->GetStreamSendBufferAllocator(),
       slice_length);
   QuicDataWriter writer(buffer.size(), buffer.data());
 
-  if (!WriteCompressedPacketToSlice(
-          client_connection_id, server_connection_id, server_address,
-          destination_connection_id, source_connection_id, flow_id, validated,
-          first_byte, long_header, &reader, &writer)) {
+  if (!WriteCompressedPacketToSlice(context, destination_connection_id,
+                                    source_connection_id, first_byte,
+                                    long_header, &reader, &writer)) {
     return;
   }
 
@@ -287,6 +313,31 @@ void MasqueCompressionEngine::CompressAndSendPacket(
                 << " and got message result " << message_result;
 }
 
+void MasqueCompressionEngine::CompressAndSendPacket(
+    absl::string_view packet, QuicConnectionId client_connection_id,
+    QuicConnectionId server_connection_id,
+    const QuicSocketAddress& server_address) {
+  QuicDatagramStreamId long_header_flow_id = kFlowId0;
+  QuicDatagramStreamId short_header_flow_id = kFlowId0;
+  CompressAndSendPacketInternal(packet, client_connection_id,
+                                server_connection_id, server_address,
+                                &long_header_flow_id, &short_header_flow_id);
+}
+
+void MasqueCompressionEngine::CompressAndSendPackets(
+    const std::vector<absl::string_view>& packets,
+    QuicConnectionId client_connection_id,
+    QuicConnectionId server_connection_id,
+    const QuicSocketAddress& server_address) {
+  QuicDatagramStreamId long_header_flow_id = kFlowId0;
+  QuicDatagramStreamId short_header_flow_id = kFlowId0;
+  for (absl::string_view packet : packets) {
+    CompressAndSendPacketInternal(packet, client_connection_id,
+                                  server_connection_id, server_address,
+                                  &long_header_flow_id, &short_header_flow_id);
+  }
+}
+
 bool MasqueCompressionEngine::ParseCompressionContext(
     QuicDataReader* reader, MasqueCompressionContext* context) {
   QuicDatagramStreamId new_flow_id;
@@ -341,6 +392,7 @@ bool MasqueCompressionEngine::ParseCompressionContext(
     context->server_connection_id = new_server_connection_id;
     context->server_address = new_server_address;
     context->validated = true;
+    UpdateHeaderPrefix(new_flow_id, context);
     contexts_[new_flow_id] = *context;
     QUIC_DVLOG(1) << "Registered new flow_id " << new_flow_id << " to "
                   << new_server_address << " client "
@@ -371,6 +423,7 @@ bool MasqueCompressionEngine::ParseCompressionContext(
     }
     if (!context->validated) {
       context->validated = true;
+      UpdateHeaderPrefix(new_flow_id, context);
       contexts_[new_flow_id] = *context;
       QUIC_DLOG(INFO) << "Successfully validated remotely-unvalidated flow_id "
                       << new_flow_id << " to " << new_server_address
@@ -478,6 +531,7 @@ bool MasqueCompressionEngine::DecompressDatagram(
 
     if (!context.validated) {
       context.validated = true;
+      UpdateHeaderPrefix(flow_id, &context);
       contexts_[flow_id] = context;
       QUIC_DLOG(INFO) << "Successfully validated remotely-validated flow_id "
                       << flow_id << " to " << context.server_address
@@ -5,6 +5,9 @@
 #ifndef QUICHE_QUIC_MASQUE_MASQUE_PROTOCOL_H_
 #define QUICHE_QUIC_MASQUE_MASQUE_PROTOCOL_H_
 
+#include <string>
+#include <vector>
+
 #include "absl/container/flat_hash_map.h"
 #include "absl/strings/string_view.h"
 #include "quic/core/http/quic_spdy_session.h"
@@ -53,6 +56,16 @@ class QUIC_NO_EXPORT MasqueCompressionEngine {
                              QuicConnectionId server_connection_id,
                              const QuicSocketAddress& server_address);
 
+  // Compresses and sends every packet in |packets|, equivalent to calling
+  // CompressAndSendPacket on each of them. All packets must belong to the
+  // same encapsulated connection: the compression context is resolved once
+  // per batch and its precomputed header prefix is reused for every
+  // datagram, so each packet is touched exactly once.
+  void CompressAndSendPackets(const std::vector<absl::string_view>& packets,
+                              QuicConnectionId client_connection_id,
+                              QuicConnectionId server_connection_id,
+                              const QuicSocketAddress& server_address);
+
   // Decompresses received DATAGRAM frame contents from |datagram| and places
   // them in |packet|. Reverses the transformation from CompressAndSendPacket.
   // The connection IDs are the one used by the encapsulated |packet|.
@@ -75,6 +88,14 @@ class QUIC_NO_EXPORT MasqueCompressionEngine {
     QuicConnectionId server_connection_id;
     QuicSocketAddress server_address;
     bool validated = false;
+    // Precomputed bytes this context puts in front of every datagram: the
+    // flow ID for validated contexts, or the full context registration
+    // preamble (flow ID 0, flow ID, connection IDs, server address) for
+    // unvalidated ones. Every field in the prefix is a per-context constant,
+    // so compression memcpys the prefix and appends the variable part of the
+    // packet after it. Rebuilt whenever |validated| changes; empty indicates
+    // the prefix could not be built.
+    std::string header_prefix;
   };
 
   // Finds or creates a new compression context to use during compression.
@@ -89,17 +110,31 @@ class QUIC_NO_EXPORT MasqueCompressionEngine {
       bool client_connection_id_present, bool server_connection_id_present,
       bool* validated);
 
-  // Writes compressed packet to |slice| during compression.
-  bool WriteCompressedPacketToSlice(QuicConnectionId client_connection_id,
-                                    QuicConnectionId server_connection_id,
-                                    const QuicSocketAddress& server_address,
+  // (Re)builds |context->header_prefix| for |flow_id|. On failure the prefix
+  // is left empty and compression with this context will fail.
+  void UpdateHeaderPrefix(QuicDatagramStreamId flow_id,
+                          MasqueCompressionContext* context);
+
+  // Writes compressed packet to |slice| during compression, using the
+  // precomputed header prefix of |context|.
+  bool WriteCompressedPacketToSlice(const MasqueCompressionContext& context,
                                     QuicConnectionId destination_connection_id,
                                     QuicConnectionId source_connection_id,
-                                    QuicDatagramStreamId flow_id,
-                                    bool validated, uint8_t first_byte,
-                                    bool long_header, QuicDataReader* reader,
+                                    uint8_t first_byte, bool long_header,
+                                    QuicDataReader* reader,
                                     QuicDataWriter* writer);
 
+  // Compresses and sends a single packet. |long_header_flow_id| and
+  // |short_header_flow_id| cache the flow ID resolved for each header form;
+  // kFlowId0 means not yet resolved. Batched sends pass the same caches for
+  // every packet so the context is looked up at most once per batch.
+  void CompressAndSendPacketInternal(
+      absl::string_view packet, QuicConnectionId client_connection_id,
+      QuicConnectionId server_connection_id,
+      const QuicSocketAddress& server_address,
+      QuicDatagramStreamId* long_header_flow_id,
+      QuicDatagramStreamId* short_header_flow_id);
+
   // Parses compression context from flow ID 0 during decompression.
   bool ParseCompressionContext(QuicDataReader* reader,
                                MasqueCompressionContext* context);
@@ -90,6 +90,7 @@ MasqueServerSession::MasqueServerSession(
       owner_(owner),
       epoll_server_(epoll_server),
       compression_engine_(this),
+      tunnel_scheduler_(this),
       masque_mode_(masque_mode) {
   // Artificially increase the max packet length to 1350 to ensure we can fit
   // QUIC packets inside DATAGRAM frames.
@@ -158,13 +159,47 @@ void MasqueServerSession::OnConnectionClosed(
 
 void MasqueServerSession::OnStreamClosed(QuicStreamId stream_id) {
   connect_udp_server_states_.remove_if(
-      [stream_id](const ConnectUdpServerState& connect_udp) {
-        return connect_udp.stream()->id() == stream_id;
+      [stream_id, this](const ConnectUdpServerState& connect_udp) {
+        if (connect_udp.stream()->id() != stream_id) {
+          return false;
+        }
+        tunnel_scheduler_.UnregisterTunnel(stream_id);
+        return true;
       });
 
   QuicSimpleServerSession::OnStreamClosed(stream_id);
 }
 
+void MasqueServerSession::OnCanWrite() {
+  QuicSimpleServerSession::OnCanWrite();
+  // The connection may have drained its datagram queue; feed it more.
+  tunnel_scheduler_.Drain();
+}
+
+bool MasqueServerSession::SendTunnelDatagram(QuicStreamId stream_id,
+                                             absl::string_view datagram) {
+  if (datagram_queue()->queue_size() > 0) {
+    // The connection is already queueing datagrams; stop feeding it so the
+    // scheduler (rather than the FIFO connection queue) decides which tunnel
+    // sends next once capacity frees up.
+    return false;
+  }
+  auto it = absl::c_find_if(connect_udp_server_states_,
+                            [stream_id](const ConnectUdpServerState& state) {
+                              return state.stream()->id() == stream_id;
+                            });
+  if (it == connect_udp_server_states_.end()) {
+    // The tunnel went away while its datagrams were queued; drop them.
+    return true;
+  }
+  MessageStatus message_status =
+      it->stream()->SendHttp3Datagram(it->context_id(), datagram);
+  QUIC_DVLOG(1) << "Scheduler sent UDP packet of length " << datagram.length()
+                << " with stream ID " << stream_id << " and got message status "
+                << MessageStatusToString(message_status);
+  return true;
+}
+
 std::unique_ptr<QuicBackendResponse> MasqueServerSession::HandleMasqueRequest(
     const std::string& masque_path,
     const spdy::Http2HeaderBlock& request_headers,
@@ -301,6 +336,7 @@ std::unique_ptr<QuicBackendResponse> MasqueServerSession::HandleMasqueRequest(
     connect_udp_server_states_.push_back(
         ConnectUdpServerState(stream, context_id, target_server_address,
                               fd_wrapper.extract_fd(), this));
+    tunnel_scheduler_.RegisterTunnel(stream->id(), /*weight=*/1);
 
     if (http_datagram_support() == HttpDatagramSupport::kDraft00) {
       // TODO(b/181256914) remove this when we drop support for
@@ -435,17 +471,18 @@ void MasqueServerSession::OnEvent(QuicUdpSocketFd fd, QuicEpollEvent* event) {
           << " because MASQUE connection is closed";
       return;
     }
-    // The packet is valid, send it to the client in a DATAGRAM frame.
-    MessageStatus message_status = it->stream()->SendHttp3Datagram(
-        it->context_id(),
+    // The packet is valid; queue it for the tunnel scheduler, which divides
+    // the session's datagram capacity fairly across tunnels instead of
+    // forwarding in arrival order.
+    tunnel_scheduler_.Enqueue(
+        it->stream()->id(),
         absl::string_view(read_result.packet_buffer.buffer,
                           read_result.packet_buffer.buffer_len));
-    QUIC_DVLOG(1) << "Sent UDP packet from " << expected_target_server_address
+    QUIC_DVLOG(1) << "Queued UDP packet from " << expected_target_server_address
                   << " of length " << read_result.packet_buffer.buffer_len
-                  << " with stream ID " << it->stream()->id()
-                  << " and got message status "
-                  << MessageStatusToString(message_status);
+                  << " with stream ID " << it->stream()->id();
   }
+  tunnel_scheduler_.Drain();
 }
 
 void MasqueServerSession::OnUnregistration(QuicUdpSocketFd fd, bool replaced) {
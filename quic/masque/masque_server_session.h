@@ -9,6 +9,7 @@
 #include "quic/core/quic_udp_socket.h"
 #include "quic/masque/masque_compression_engine.h"
 #include "quic/masque/masque_server_backend.h"
+#include "quic/masque/masque_tunnel_scheduler.h"
 #include "quic/masque/masque_utils.h"
 #include "quic/platform/api/quic_epoll.h"
 #include "quic/platform/api/quic_export.h"
@@ -20,7 +21,8 @@ namespace quic {
 class QUIC_NO_EXPORT MasqueServerSession
     : public QuicSimpleServerSession,
       public MasqueServerBackend::BackendClient,
-      public QuicEpollCallbackInterface {
+      public QuicEpollCallbackInterface,
+      public MasqueTunnelScheduler::Visitor {
  public:
   // Interface meant to be implemented by owner of this MasqueServerSession
   // instance.
@@ -58,6 +60,11 @@ class QUIC_NO_EXPORT MasqueServerSession
   void OnConnectionClosed(const QuicConnectionCloseFrame& frame,
                           ConnectionCloseSource source) override;
   void OnStreamClosed(QuicStreamId stream_id) override;
+  void OnCanWrite() override;
+
+  // From MasqueTunnelScheduler::Visitor.
+  bool SendTunnelDatagram(QuicStreamId stream_id,
+                          absl::string_view datagram) override;
 
   // From MasqueServerBackend::BackendClient.
   std::unique_ptr<QuicBackendResponse> HandleMasqueRequest(
@@ -146,6 +153,9 @@ class QUIC_NO_EXPORT MasqueServerSession
   Visitor* owner_;                              // Unowned.
   QuicEpollServer* epoll_server_;               // Unowned.
   MasqueCompressionEngine compression_engine_;
+  // Arbitrates the session's datagram capacity across tunnels so one
+  // saturated tunnel cannot starve the others.
+  MasqueTunnelScheduler tunnel_scheduler_;
   MasqueMode masque_mode_;
   std::list<ConnectUdpServerState> connect_udp_server_states_;
   bool masque_initialized_ = false;
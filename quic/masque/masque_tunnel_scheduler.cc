@@ -0,0 +1,98 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/masque/masque_tunnel_scheduler.h"
+
+#include "quic/platform/api/quic_bug_tracker.h"
+#include "quic/platform/api/quic_logging.h"
+
+namespace quic {
+
+MasqueTunnelScheduler::MasqueTunnelScheduler(Visitor* visitor)
+    : visitor_(visitor) {}
+
+void MasqueTunnelScheduler::RegisterTunnel(QuicStreamId stream_id,
+                                           int weight) {
+  QUICHE_DCHECK_GE(weight, 1);
+  for (const auto& tunnel : tunnels_) {
+    if (tunnel.first == stream_id) {
+      QUIC_BUG(quic_bug_masque_scheduler_1)
+          << "Tunnel for stream " << stream_id << " registered twice";
+      return;
+    }
+  }
+  tunnels_.emplace_back(stream_id, Tunnel());
+  tunnels_.back().second.weight = weight;
+}
+
+void MasqueTunnelScheduler::UnregisterTunnel(QuicStreamId stream_id) {
+  for (auto it = tunnels_.begin(); it != tunnels_.end(); ++it) {
+    if (it->first == stream_id) {
+      queued_datagrams_ -= it->second.queue.size();
+      tunnels_.erase(it);
+      return;
+    }
+  }
+}
+
+void MasqueTunnelScheduler::Enqueue(QuicStreamId stream_id,
+                                    absl::string_view datagram) {
+  for (auto& tunnel : tunnels_) {
+    if (tunnel.first != stream_id) {
+      continue;
+    }
+    if (tunnel.second.queue.size() >= kMaxQueuedDatagramsPerTunnel) {
+      // Drop the oldest datagram: for tunneled traffic a fresh packet is
+      // worth more than a stale one.
+      tunnel.second.queue.pop_front();
+      --queued_datagrams_;
+      ++dropped_datagrams_;
+      QUIC_DVLOG(1) << "Dropped oldest datagram for tunnel on stream "
+                    << stream_id;
+    }
+    tunnel.second.queue.emplace_back(datagram);
+    ++queued_datagrams_;
+    return;
+  }
+  QUIC_BUG(quic_bug_masque_scheduler_2)
+      << "Datagram enqueued for unregistered tunnel on stream " << stream_id;
+}
+
+void MasqueTunnelScheduler::Drain() {
+  if (draining_) {
+    return;
+  }
+  draining_ = true;
+  bool made_progress = true;
+  while (made_progress && queued_datagrams_ > 0) {
+    made_progress = false;
+    for (auto& tunnel_pair : tunnels_) {
+      Tunnel& tunnel = tunnel_pair.second;
+      if (tunnel.queue.empty()) {
+        // An idle tunnel does not bank credit for later.
+        tunnel.deficit = 0;
+        continue;
+      }
+      tunnel.deficit += kDeficitQuantum * tunnel.weight;
+      while (!tunnel.queue.empty() &&
+             tunnel.queue.front().size() <= tunnel.deficit) {
+        if (!visitor_->SendTunnelDatagram(tunnel_pair.first,
+                                          tunnel.queue.front())) {
+          draining_ = false;
+          return;
+        }
+        tunnel.deficit -= tunnel.queue.front().size();
+        tunnel.queue.pop_front();
+        --queued_datagrams_;
+        made_progress = true;
+      }
+      if (tunnel.queue.empty()) {
+        tunnel.deficit = 0;
+      }
+    }
+  }
+  draining_ = false;
+}
+
+}  // namespace quic
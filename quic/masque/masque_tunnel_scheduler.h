@@ -0,0 +1,92 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_MASQUE_MASQUE_TUNNEL_SCHEDULER_H_
+#define QUICHE_QUIC_MASQUE_MASQUE_TUNNEL_SCHEDULER_H_
+
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <string>
+#include <utility>
+
+#include "absl/strings/string_view.h"
+#include "quic/core/quic_types.h"
+#include "quic/platform/api/quic_export.h"
+
+namespace quic {
+
+// Schedules datagrams across the encapsulated tunnels of one MASQUE session
+// using deficit round-robin, so a tunnel whose target floods the relay cannot
+// starve the other tunnels sharing the session's connection. Each tunnel has
+// a bounded queue (the oldest datagram is dropped on overflow, since for
+// tunneled traffic fresher packets are worth more than stale ones) and a
+// weight; each round a tunnel's deficit grows by its weight's worth of bytes
+// and it may send datagrams up to that deficit.
+class QUIC_NO_EXPORT MasqueTunnelScheduler {
+ public:
+  // Implemented by the owning session to deliver scheduled datagrams.
+  class QUIC_NO_EXPORT Visitor {
+   public:
+    virtual ~Visitor() {}
+
+    // Attempts to deliver |datagram| for the tunnel on |stream_id|. Returns
+    // false when no more datagrams can be accepted right now; the scheduler
+    // then stops draining and retains the datagram for a later Drain().
+    virtual bool SendTunnelDatagram(QuicStreamId stream_id,
+                                    absl::string_view datagram) = 0;
+  };
+
+  explicit MasqueTunnelScheduler(Visitor* visitor);
+
+  // Disallow copy and assign.
+  MasqueTunnelScheduler(const MasqueTunnelScheduler&) = delete;
+  MasqueTunnelScheduler& operator=(const MasqueTunnelScheduler&) = delete;
+
+  // Adds a tunnel with the given scheduling weight (relative share of the
+  // session's datagram capacity; must be at least 1).
+  void RegisterTunnel(QuicStreamId stream_id, int weight);
+
+  // Removes a tunnel, discarding anything still queued for it.
+  void UnregisterTunnel(QuicStreamId stream_id);
+
+  // Queues a datagram for a registered tunnel. If the tunnel's queue is
+  // full, the oldest queued datagram is dropped to make room.
+  void Enqueue(QuicStreamId stream_id, absl::string_view datagram);
+
+  // Delivers queued datagrams round-robin via the visitor until all queues
+  // are empty or the visitor declines a datagram.
+  void Drain();
+
+  bool HasQueuedDatagrams() const { return queued_datagrams_ > 0; }
+  size_t queued_datagrams() const { return queued_datagrams_; }
+  uint64_t dropped_datagrams() const { return dropped_datagrams_; }
+
+ private:
+  // Bytes of deficit granted per weight unit per round; slightly above the
+  // largest datagram a tunnel can carry so every round permits progress.
+  static constexpr QuicByteCount kDeficitQuantum = 1500;
+  // Bound on each tunnel's queue. The session only queues while its
+  // connection is blocked, so this only needs to cover a short stall.
+  static constexpr size_t kMaxQueuedDatagramsPerTunnel = 64;
+
+  struct QUIC_NO_EXPORT Tunnel {
+    int weight = 1;
+    QuicByteCount deficit = 0;
+    std::deque<std::string> queue;
+  };
+
+  Visitor* visitor_;  // Unowned.
+  // Tunnels in round-robin order. MASQUE sessions carry few tunnels, so
+  // linear lookup matches how the session itself tracks per-tunnel state.
+  std::list<std::pair<QuicStreamId, Tunnel>> tunnels_;
+  size_t queued_datagrams_ = 0;
+  uint64_t dropped_datagrams_ = 0;
+  // Guards against reentrant Drain() calls from inside the visitor.
+  bool draining_ = false;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_MASQUE_MASQUE_TUNNEL_SCHEDULER_H_
@@ -21,6 +21,12 @@ class MockTunDevice : public TunDeviceInterface {
   MOCK_METHOD(void, CloseDevice, (), (override));
 
   MOCK_METHOD(int, GetFileDescriptor, (), (const, override));
+
+  MOCK_METHOD(size_t, NumQueues, (), (const, override));
+
+  MOCK_METHOD(int, GetQueueFileDescriptor, (size_t), (const, override));
+
+  MOCK_METHOD(bool, OpenQueues, (size_t), (override));
 };
 
 }  // namespace quic
@@ -32,7 +32,6 @@ TunTapDevice::TunTapDevice(const std::string& interface_name, int mtu,
       persist_(persist),
       setup_tun_(setup_tun),
       is_tap_(is_tap),
-      file_descriptor_(kInvalidFd),
       kernel_(*kernel) {}
 
 TunTapDevice::~TunTapDevice() {
@@ -92,13 +91,46 @@ bool TunTapDevice::Down() {
   return NetdeviceIoctl(SIOCSIFFLAGS, reinterpret_cast<void*>(&if_request));
 }
 
-int TunTapDevice::GetFileDescriptor() const { return file_descriptor_; }
+int TunTapDevice::GetFileDescriptor() const {
+  return queue_fds_.empty() ? kInvalidFd : queue_fds_.front();
+}
+
+size_t TunTapDevice::NumQueues() const { return queue_fds_.size(); }
+
+int TunTapDevice::GetQueueFileDescriptor(size_t index) const {
+  return index < queue_fds_.size() ? queue_fds_[index] : kInvalidFd;
+}
+
+bool TunTapDevice::OpenQueues(size_t total_queues) {
+  if (queue_fds_.empty()) {
+    QUIC_BUG(quic_bug_tun_open_queues_before_init)
+        << "OpenQueues called before a successful Init()";
+    return false;
+  }
+  while (queue_fds_.size() < total_queues) {
+    int fd = OpenQueueFd();
+    if (fd == kInvalidFd) {
+      return false;
+    }
+    queue_fds_.push_back(fd);
+  }
+  return true;
+}
 
 bool TunTapDevice::OpenDevice() {
-  if (file_descriptor_ != kInvalidFd) {
+  if (!queue_fds_.empty()) {
     CloseDevice();
   }
 
+  int fd = OpenQueueFd();
+  if (fd == kInvalidFd) {
+    return false;
+  }
+  queue_fds_.push_back(fd);
+  return true;
+}
+
+int TunTapDevice::OpenQueueFd() {
   struct ifreq if_request;
   memset(&if_request, 0, sizeof(if_request));
   // copy does not zero-terminate the result string, but we've memset the entire
@@ -117,41 +149,41 @@ bool TunTapDevice::OpenDevice() {
     if_request.ifr_flags |= IFF_TUN;
   }
 
-  // When the device is running with IFF_MULTI_QUEUE set, each call to open will
-  // create a queue which can be used to read/write packets from/to the device.
+  // When the device is running with IFF_MULTI_QUEUE set, each call to open
+  // will create a queue which can be used to read/write packets from/to the
+  // device.
   bool successfully_opened = false;
-  auto cleanup = absl::MakeCleanup([this, &successfully_opened]() {
-    if (!successfully_opened) {
-      CloseDevice();
-    }
-  });
 
   const std::string tun_device_path =
       absl::GetFlag(FLAGS_qbone_client_tun_device_path);
   int fd = kernel_.open(tun_device_path.c_str(), O_RDWR);
   if (fd < 0) {
     QUIC_PLOG(WARNING) << "Failed to open " << tun_device_path;
-    return successfully_opened;
+    return kInvalidFd;
   }
-  file_descriptor_ = fd;
+  auto cleanup = absl::MakeCleanup([this, fd, &successfully_opened]() {
+    if (!successfully_opened) {
+      kernel_.close(fd);
+    }
+  });
   if (!CheckFeatures(fd)) {
-    return successfully_opened;
+    return kInvalidFd;
   }
 
   if (kernel_.ioctl(fd, TUNSETIFF, reinterpret_cast<void*>(&if_request)) != 0) {
     QUIC_PLOG(WARNING) << "Failed to TUNSETIFF on fd(" << fd << ")";
-    return successfully_opened;
+    return kInvalidFd;
   }
 
   if (kernel_.ioctl(
           fd, TUNSETPERSIST,
           persist_ ? reinterpret_cast<void*>(&if_request) : nullptr) != 0) {
     QUIC_PLOG(WARNING) << "Failed to TUNSETPERSIST on fd(" << fd << ")";
-    return successfully_opened;
+    return kInvalidFd;
   }
 
   successfully_opened = true;
-  return successfully_opened;
+  return fd;
 }
 
 // TODO(pengg): might be better to use netlink socket, once we have a library to
@@ -210,10 +242,10 @@ bool TunTapDevice::NetdeviceIoctl(int request, void* argp) {
 }
 
 void TunTapDevice::CloseDevice() {
-  if (file_descriptor_ != kInvalidFd) {
-    kernel_.close(file_descriptor_);
-    file_descriptor_ = kInvalidFd;
+  for (int fd : queue_fds_) {
+    kernel_.close(fd);
   }
+  queue_fds_.clear();
 }
 
 }  // namespace quic
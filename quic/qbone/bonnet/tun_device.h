@@ -55,10 +55,25 @@ class TunTapDevice : public TunDeviceInterface {
   // This returns -1 when the TUN device is in an invalid state.
   int GetFileDescriptor() const override;
 
+  // The number of queues currently open on the device.
+  size_t NumQueues() const override;
+
+  // Gets the file descriptor of the |index|th queue, or -1 if |index| is out
+  // of range.
+  int GetQueueFileDescriptor(size_t index) const override;
+
+  // Opens additional queues until the device has |total_queues| of them. The
+  // device is always opened with IFF_MULTI_QUEUE, so each open of the tun
+  // path attaches another queue to the same interface.
+  bool OpenQueues(size_t total_queues) override;
+
  private:
   // Creates or reopens the tun device.
   bool OpenDevice();
 
+  // Opens and configures one queue fd on the device. Returns -1 on failure.
+  int OpenQueueFd();
+
   // Configure the interface.
   bool ConfigureInterface();
 
@@ -73,7 +88,9 @@ class TunTapDevice : public TunDeviceInterface {
   const bool persist_;
   const bool setup_tun_;
   const bool is_tap_;
-  int file_descriptor_;
+  // One fd per open queue; the fd at index 0 is the one returned by
+  // GetFileDescriptor().
+  std::vector<int> queue_fds_;
   KernelInterface& kernel_;
 };
 
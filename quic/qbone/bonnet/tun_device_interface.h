@@ -5,6 +5,7 @@
 #ifndef QUICHE_QUIC_QBONE_BONNET_TUN_DEVICE_INTERFACE_H_
 #define QUICHE_QUIC_QBONE_BONNET_TUN_DEVICE_INTERFACE_H_
 
+#include <cstddef>
 #include <vector>
 
 namespace quic {
@@ -31,6 +32,22 @@ class TunDeviceInterface {
   // Gets the file descriptor that can be used to send/receive packets.
   // This returns -1 when the TUN device is in an invalid state.
   virtual int GetFileDescriptor() const = 0;
+
+  // The number of queues currently open on the device. At least 1 after a
+  // successful Init(); more after OpenQueues(). The kernel steers each
+  // tunneled flow to a single queue, so per-queue readers never see packets
+  // of the same flow out of order.
+  virtual size_t NumQueues() const = 0;
+
+  // Gets the file descriptor of the |index|th queue, or -1 if |index| is out
+  // of range.
+  virtual int GetQueueFileDescriptor(size_t index) const = 0;
+
+  // Opens additional queues until the device has |total_queues| of them.
+  // Requires a successful Init() first; a no-op if that many queues are
+  // already open. Returns false if the kernel refuses a queue, in which case
+  // the queues already open remain usable.
+  virtual bool OpenQueues(size_t total_queues) = 0;
 };
 
 }  // namespace quic
@@ -35,17 +35,35 @@ TunDevicePacketExchanger::TunDevicePacketExchanger(
 bool TunDevicePacketExchanger::WritePacket(const char* packet, size_t size,
                                            bool* blocked, std::string* error) {
   *blocked = false;
-  if (fd_ < 0) {
-    *error = absl::StrCat("Invalid file descriptor of the TUN device: ", fd_);
+  const int fd = SelectWriteFd(packet, size);
+  if (fd < 0) {
+    *error = absl::StrCat("Invalid file descriptor of the TUN device: ", fd);
     stats_->OnWriteError(error);
     return false;
   }
 
-  auto buffer = std::make_unique<QuicData>(packet, size);
+  int result;
   if (is_tap_) {
-    buffer = ApplyL2Headers(*buffer);
+    // Prepend the Ethernet header with a vectored write instead of copying the
+    // packet into a freshly allocated L2 buffer.
+    MaybeInitTapMac();
+    ethhdr header;
+    // Set src & dst to my own address
+    memcpy(header.h_dest, tap_mac_, ETH_ALEN);
+    memcpy(header.h_source, tap_mac_, ETH_ALEN);
+    // Assume ipv6 for now
+    // TODO(b/195113643): Support additional protocols.
+    header.h_proto = absl::ghtons(ETH_P_IPV6);
+
+    iovec iov[2];
+    iov[0].iov_base = &header;
+    iov[0].iov_len = ETH_HLEN;
+    iov[1].iov_base = const_cast<char*>(packet);
+    iov[1].iov_len = size;
+    result = kernel_->writev(fd, iov, 2);
+  } else {
+    result = kernel_->write(fd, packet, size);
   }
-  int result = kernel_->write(fd_, buffer->data(), buffer->length());
   if (result == -1) {
     if (errno == EWOULDBLOCK || errno == EAGAIN) {
       // The tunnel is blocked. Note that this does not mean the receive buffer
@@ -97,40 +115,63 @@ std::unique_ptr<QuicData> TunDevicePacketExchanger::ReadPacket(
 
 void TunDevicePacketExchanger::set_file_descriptor(int fd) { fd_ = fd; }
 
-const TunDevicePacketExchanger::StatsInterface*
-TunDevicePacketExchanger::stats_interface() const {
-  return stats_;
+void TunDevicePacketExchanger::set_queue_file_descriptors(
+    const std::vector<int>& fds) {
+  queue_fds_ = fds;
+  if (!fds.empty()) {
+    fd_ = fds.front();
+  }
 }
 
-std::unique_ptr<QuicData> TunDevicePacketExchanger::ApplyL2Headers(
-    const QuicData& l3_packet) {
-  if (is_tap_ && !mac_initialized_) {
-    NetlinkInterface::LinkInfo link_info{};
-    if (netlink_->GetLinkInfo(ifname_, &link_info)) {
-      memcpy(tap_mac_, link_info.hardware_address, ETH_ALEN);
-      mac_initialized_ = true;
-    } else {
-      QUIC_LOG_EVERY_N_SEC(ERROR, 30)
-          << "Unable to get link info for: " << ifname_;
-    }
+// static
+size_t TunDevicePacketExchanger::SelectQueue(const char* packet, size_t size,
+                                             size_t num_queues) {
+  if (num_queues <= 1) {
+    return 0;
   }
+  // Hash the IPv6 source and destination addresses (bytes 8-39 of the
+  // header) with FNV-1a. Ports are not included: the address pair is enough
+  // to keep a tunneled flow on one queue, and it avoids parsing extension
+  // headers to find the transport header.
+  constexpr size_t kAddressOffset = 8;
+  constexpr size_t kAddressBytes = 32;
+  if (size < kAddressOffset + kAddressBytes ||
+      (packet[0] & 0xf0) != 0x60) {  // Not IPv6.
+    return 0;
+  }
+  uint64_t hash = UINT64_C(14695981039346656037);
+  for (size_t i = kAddressOffset; i < kAddressOffset + kAddressBytes; ++i) {
+    hash ^= static_cast<uint8_t>(packet[i]);
+    hash *= UINT64_C(1099511628211);
+  }
+  return hash % num_queues;
+}
 
-  const auto l2_packet_size = l3_packet.length() + ETH_HLEN;
-  auto l2_buffer = std::make_unique<char[]>(l2_packet_size);
-
-  // Populate the Ethernet header
-  auto* hdr = reinterpret_cast<ethhdr*>(l2_buffer.get());
-  // Set src & dst to my own address
-  memcpy(hdr->h_dest, tap_mac_, ETH_ALEN);
-  memcpy(hdr->h_source, tap_mac_, ETH_ALEN);
-  // Assume ipv6 for now
-  // TODO(b/195113643): Support additional protocols.
-  hdr->h_proto = absl::ghtons(ETH_P_IPV6);
+int TunDevicePacketExchanger::SelectWriteFd(const char* packet,
+                                            size_t size) const {
+  if (queue_fds_.size() <= 1) {
+    return fd_;
+  }
+  return queue_fds_[SelectQueue(packet, size, queue_fds_.size())];
+}
 
-  // Copy the l3 packet into buffer, just after the ethernet header.
-  memcpy(l2_buffer.get() + ETH_HLEN, l3_packet.data(), l3_packet.length());
+const TunDevicePacketExchanger::StatsInterface*
+TunDevicePacketExchanger::stats_interface() const {
+  return stats_;
+}
 
-  return std::make_unique<QuicData>(l2_buffer.release(), l2_packet_size, true);
+void TunDevicePacketExchanger::MaybeInitTapMac() {
+  if (!is_tap_ || mac_initialized_) {
+    return;
+  }
+  NetlinkInterface::LinkInfo link_info{};
+  if (netlink_->GetLinkInfo(ifname_, &link_info)) {
+    memcpy(tap_mac_, link_info.hardware_address, ETH_ALEN);
+    mac_initialized_ = true;
+  } else {
+    QUIC_LOG_EVERY_N_SEC(ERROR, 30)
+        << "Unable to get link info for: " << ifname_;
+  }
 }
 
 std::unique_ptr<QuicData> TunDevicePacketExchanger::ConsumeL2Headers(
@@ -53,6 +53,18 @@ class TunDevicePacketExchanger : public QbonePacketExchanger {
 
   void set_file_descriptor(int fd);
 
+  // Supplies the fds of all queues open on a multi-queue TUN device. Writes
+  // are spread across the queues by a hash of the packet's IPv6 flow, so a
+  // tunneled flow always leaves through one queue and stays in order. The
+  // first fd also becomes the default descriptor used for reads.
+  void set_queue_file_descriptors(const std::vector<int>& fds);
+
+  // Returns the index of the queue that packets of |packet|'s flow are
+  // written to, given |num_queues| open queues. Non-IPv6 packets map to
+  // queue 0.
+  static size_t SelectQueue(const char* packet, size_t size,
+                            size_t num_queues);
+
   ABSL_MUST_USE_RESULT const StatsInterface* stats_interface() const;
 
  private:
@@ -66,11 +78,17 @@ class TunDevicePacketExchanger : public QbonePacketExchanger {
                    bool* blocked,
                    std::string* error) override;
 
-  std::unique_ptr<QuicData> ApplyL2Headers(const QuicData& l3_packet);
+  // Lazily resolves the TAP interface's MAC address via netlink.
+  void MaybeInitTapMac();
 
   std::unique_ptr<QuicData> ConsumeL2Headers(const QuicData& l2_packet);
 
+  // Returns the fd to write |packet| to: the flow-selected queue fd when
+  // multiple queues are open, |fd_| otherwise.
+  int SelectWriteFd(const char* packet, size_t size) const;
+
   int fd_ = -1;
+  std::vector<int> queue_fds_;
   size_t mtu_;
   KernelInterface* kernel_;
   NetlinkInterface* netlink_;
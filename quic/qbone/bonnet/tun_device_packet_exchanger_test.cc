@@ -82,6 +82,35 @@ TEST_F(TunDevicePacketExchangerTest, WritePacketReturnsTrueOnSuccessfulWrite) {
   exchanger_.WritePacketToNetwork(packet.data(), packet.size());
 }
 
+TEST_F(TunDevicePacketExchangerTest, WritePacketUsesFlowSelectedQueue) {
+  // A well-formed IPv6 header: version 6, some src/dst addresses.
+  std::string packet(40, '\0');
+  packet[0] = 0x60;
+  for (int i = 8; i < 40; ++i) {
+    packet[i] = i;
+  }
+  const std::vector<int> queue_fds = {15, 16, 17, 18};
+  exchanger_.set_queue_file_descriptors(queue_fds);
+
+  const size_t queue = TunDevicePacketExchanger::SelectQueue(
+      packet.data(), packet.size(), queue_fds.size());
+  // Selection is deterministic: the same flow always maps to the same queue.
+  EXPECT_EQ(queue, TunDevicePacketExchanger::SelectQueue(
+                       packet.data(), packet.size(), queue_fds.size()));
+
+  EXPECT_CALL(mock_kernel_, write(queue_fds[queue], _, packet.size()))
+      .WillOnce(Invoke(
+          [](int fd, const void* buf, size_t count) { return count; }));
+  EXPECT_CALL(mock_stats_, OnPacketWritten(_)).Times(1);
+  exchanger_.WritePacketToNetwork(packet.data(), packet.size());
+}
+
+TEST_F(TunDevicePacketExchangerTest, SelectQueueMapsNonIpv6ToQueueZero) {
+  std::string packet = "fake packet";
+  EXPECT_EQ(0u, TunDevicePacketExchanger::SelectQueue(packet.data(),
+                                                      packet.size(), 4));
+}
+
 TEST_F(TunDevicePacketExchangerTest, ReadPacketReturnsNullOnError) {
   EXPECT_CALL(mock_kernel_, read(kFd, _, kMtu))
       .WillOnce(Invoke([](int fd, void* buf, size_t count) {
@@ -132,6 +132,45 @@ TEST_F(TunDeviceTest, BasicWorkFlow) {
   ExpectDown(/* fail = */ false);
 }
 
+// Each additional queue opens another fd against the same interface.
+TEST_F(TunDeviceTest, MultiQueueWorkFlow) {
+  SetInitExpectations(/* mtu = */ 1500, /* persist = */ false);
+  TunTapDevice tun_device(kDeviceName, 1500, false, true, false, &mock_kernel_);
+  EXPECT_TRUE(tun_device.Init());
+  EXPECT_EQ(1u, tun_device.NumQueues());
+
+  EXPECT_TRUE(tun_device.OpenQueues(4));
+  EXPECT_EQ(4u, tun_device.NumQueues());
+  EXPECT_EQ(tun_device.GetFileDescriptor(),
+            tun_device.GetQueueFileDescriptor(0));
+  // Queue fds are distinct, and out-of-range indices are invalid.
+  EXPECT_NE(tun_device.GetQueueFileDescriptor(0),
+            tun_device.GetQueueFileDescriptor(3));
+  EXPECT_EQ(-1, tun_device.GetQueueFileDescriptor(4));
+
+  // Opening fewer queues than are already open is a no-op.
+  EXPECT_TRUE(tun_device.OpenQueues(2));
+  EXPECT_EQ(4u, tun_device.NumQueues());
+
+  ExpectUp(/* fail = */ false);
+  EXPECT_TRUE(tun_device.Up());
+  ExpectDown(/* fail = */ false);
+}
+
+// A failure to open an additional queue keeps the existing queues usable.
+TEST_F(TunDeviceTest, FailToOpenAdditionalQueue) {
+  SetInitExpectations(/* mtu = */ 1500, /* persist = */ false);
+  TunTapDevice tun_device(kDeviceName, 1500, false, true, false, &mock_kernel_);
+  EXPECT_TRUE(tun_device.Init());
+
+  EXPECT_CALL(mock_kernel_, open(StrEq("/dev/net/tun"), _))
+      .WillOnce(Return(-1));
+  EXPECT_FALSE(tun_device.OpenQueues(2));
+  EXPECT_EQ(1u, tun_device.NumQueues());
+  EXPECT_GT(tun_device.GetFileDescriptor(), -1);
+  ExpectDown(false);
+}
+
 TEST_F(TunDeviceTest, FailToOpenTunDevice) {
   SetInitExpectations(/* mtu = */ 1500, /* persist = */ false);
   EXPECT_CALL(mock_kernel_, open(StrEq("/dev/net/tun"), _))
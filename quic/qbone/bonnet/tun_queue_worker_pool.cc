@@ -0,0 +1,101 @@
+// Copyright (c) 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/qbone/bonnet/tun_queue_worker_pool.h"
+
+#include <poll.h>
+
+#include <utility>
+
+#include "quic/platform/api/quic_logging.h"
+
+namespace quic {
+
+namespace {
+
+// How long a worker blocks in poll() before rechecking whether it should
+// quit. Bounds shutdown latency without waking an idle queue often.
+const int kPollTimeoutMs = 50;
+
+}  // namespace
+
+TunQueueWorker::TunQueueWorker(
+    int queue_fd, size_t mtu, KernelInterface* kernel,
+    std::unique_ptr<PacketHandlerInterface> handler)
+    : QuicThread("TunQueueWorker"),
+      queue_fd_(queue_fd),
+      mtu_(mtu),
+      kernel_(kernel),
+      handler_(std::move(handler)) {}
+
+void TunQueueWorker::Quit() { quitting_.Notify(); }
+
+void TunQueueWorker::Run() {
+  auto read_buffer = std::make_unique<char[]>(mtu_);
+  while (!quitting_.HasBeenNotified()) {
+    pollfd poll_fd = {};
+    poll_fd.fd = queue_fd_;
+    poll_fd.events = POLLIN;
+    const int poll_result = kernel_->poll(&poll_fd, 1, kPollTimeoutMs);
+    if (poll_result < 0 && errno != EINTR) {
+      stats_.read_errors.fetch_add(1, std::memory_order_relaxed);
+      continue;
+    }
+    if (poll_result <= 0) {
+      continue;
+    }
+    // Reading on a TUN queue returns a packet at a time; a packet longer
+    // than the buffer is truncated.
+    const ssize_t result = kernel_->read(queue_fd_, read_buffer.get(), mtu_);
+    if (result <= 0) {
+      if (errno != EAGAIN && errno != EWOULDBLOCK) {
+        stats_.read_errors.fetch_add(1, std::memory_order_relaxed);
+      }
+      continue;
+    }
+    stats_.packets_read.fetch_add(1, std::memory_order_relaxed);
+    stats_.bytes_read.fetch_add(result, std::memory_order_relaxed);
+    handler_->HandlePacketFromDevice(
+        absl::string_view(read_buffer.get(), result));
+  }
+}
+
+TunQueueWorkerPool::TunQueueWorkerPool(const std::vector<int>& queue_fds,
+                                       size_t mtu, KernelInterface* kernel,
+                                       const HandlerFactory& handler_factory) {
+  workers_.reserve(queue_fds.size());
+  for (size_t i = 0; i < queue_fds.size(); ++i) {
+    workers_.push_back(std::make_unique<TunQueueWorker>(
+        queue_fds[i], mtu, kernel, handler_factory(i)));
+  }
+}
+
+void TunQueueWorkerPool::Start() {
+  QUIC_LOG(INFO) << "Starting " << workers_.size() << " TUN queue workers";
+  for (const auto& worker : workers_) {
+    worker->Start();
+  }
+}
+
+void TunQueueWorkerPool::QuitAndJoin() {
+  for (const auto& worker : workers_) {
+    worker->Quit();
+  }
+  for (const auto& worker : workers_) {
+    worker->Join();
+  }
+}
+
+TunQueueWorkerPool::AggregatedStats TunQueueWorkerPool::GetStats() const {
+  AggregatedStats total;
+  for (const auto& worker : workers_) {
+    const TunQueueWorker::QueueStats& stats = worker->stats();
+    total.packets_read += stats.packets_read.load(std::memory_order_relaxed);
+    total.bytes_read += stats.bytes_read.load(std::memory_order_relaxed);
+    total.read_errors += stats.read_errors.load(std::memory_order_relaxed);
+  }
+  return total;
+}
+
+}  // namespace quic
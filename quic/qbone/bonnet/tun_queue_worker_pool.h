@@ -0,0 +1,112 @@
+// Copyright (c) 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_QBONE_BONNET_TUN_QUEUE_WORKER_POOL_H_
+#define QUICHE_QUIC_QBONE_BONNET_TUN_QUEUE_WORKER_POOL_H_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/notification.h"
+#include "quic/platform/api/quic_thread.h"
+#include "quic/qbone/platform/kernel_interface.h"
+
+namespace quic {
+
+// TunQueueWorker reads packets from one queue of a multi-queue TUN device on
+// its own thread and hands each packet to a handler that the worker owns
+// exclusively. Since the kernel steers every tunneled flow to a single
+// queue, a flow's packets are always handled by the same worker in order,
+// and handlers — typically wrapping a dedicated QbonePacketProcessor — need
+// no locking.
+class TunQueueWorker : public QuicThread {
+ public:
+  // Handles packets read from the worker's queue. One instance per worker;
+  // never called concurrently.
+  class PacketHandlerInterface {
+   public:
+    virtual ~PacketHandlerInterface() = default;
+
+    virtual void HandlePacketFromDevice(absl::string_view packet) = 0;
+  };
+
+  // Counters written only by the owning worker and read by stats
+  // aggregation, see TunQueueWorkerPool::GetStats().
+  struct QueueStats {
+    std::atomic<int64_t> packets_read{0};
+    std::atomic<int64_t> bytes_read{0};
+    std::atomic<int64_t> read_errors{0};
+  };
+
+  // Does not take ownership of |kernel|; |queue_fd| stays owned by the TUN
+  // device and must outlive the worker.
+  TunQueueWorker(int queue_fd, size_t mtu, KernelInterface* kernel,
+                 std::unique_ptr<PacketHandlerInterface> handler);
+
+  TunQueueWorker(const TunQueueWorker&) = delete;
+  TunQueueWorker& operator=(const TunQueueWorker&) = delete;
+
+  // Terminates the worker's read loop. The worker must still be joined.
+  void Quit();
+
+  const QueueStats& stats() const { return stats_; }
+
+ protected:
+  void Run() override;
+
+ private:
+  const int queue_fd_;
+  const size_t mtu_;
+  KernelInterface* kernel_;  // Unowned.
+  std::unique_ptr<PacketHandlerInterface> handler_;
+  QueueStats stats_;
+  absl::Notification quitting_;
+};
+
+// Owns one TunQueueWorker per TUN queue fd. Each worker gets its own handler
+// from the factory, so packet processing across queues is shared-nothing;
+// the only cross-thread traffic is the stats aggregation, which sums the
+// per-worker counters on demand.
+class TunQueueWorkerPool {
+ public:
+  using HandlerFactory =
+      std::function<std::unique_ptr<TunQueueWorker::PacketHandlerInterface>(
+          size_t queue_index)>;
+
+  struct AggregatedStats {
+    int64_t packets_read = 0;
+    int64_t bytes_read = 0;
+    int64_t read_errors = 0;
+  };
+
+  // Creates one worker per fd in |queue_fds|. Does not take ownership of
+  // |kernel| or the fds.
+  TunQueueWorkerPool(const std::vector<int>& queue_fds, size_t mtu,
+                     KernelInterface* kernel,
+                     const HandlerFactory& handler_factory);
+
+  TunQueueWorkerPool(const TunQueueWorkerPool&) = delete;
+  TunQueueWorkerPool& operator=(const TunQueueWorkerPool&) = delete;
+
+  // Starts all workers.
+  void Start();
+
+  // Stops all workers and joins their threads.
+  void QuitAndJoin();
+
+  AggregatedStats GetStats() const;
+
+  size_t num_workers() const { return workers_.size(); }
+
+ private:
+  std::vector<std::unique_ptr<TunQueueWorker>> workers_;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_QBONE_BONNET_TUN_QUEUE_WORKER_POOL_H_
@@ -0,0 +1,97 @@
+// Copyright (c) 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/qbone/bonnet/tun_queue_worker_pool.h"
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+#include "absl/synchronization/notification.h"
+#include "quic/platform/api/quic_test.h"
+
+namespace quic {
+namespace {
+
+constexpr size_t kMtu = 1500;
+
+// Counts packets delivered to one worker and notifies once the expected
+// number has arrived. Each worker owns its own instance, so no locking.
+class NotifyingHandler : public TunQueueWorker::PacketHandlerInterface {
+ public:
+  NotifyingHandler(int expected_packets, absl::Notification* done)
+      : expected_packets_(expected_packets), done_(done) {}
+
+  void HandlePacketFromDevice(absl::string_view packet) override {
+    packets_.push_back(std::string(packet));
+    if (static_cast<int>(packets_.size()) == expected_packets_) {
+      done_->Notify();
+    }
+  }
+
+  const std::vector<std::string>& packets() const { return packets_; }
+
+ private:
+  const int expected_packets_;
+  absl::Notification* done_;
+  std::vector<std::string> packets_;
+};
+
+TEST(TunQueueWorkerPoolTest, WorkersReadTheirOwnQueues) {
+  // Stand in for two TUN queues with datagram socket pairs, which preserve
+  // packet boundaries like a TUN fd does; the kernel-side flow steering is
+  // irrelevant to the pool itself.
+  int queue0[2];
+  int queue1[2];
+  ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_DGRAM, 0, queue0));
+  ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_DGRAM, 0, queue1));
+
+  Kernel kernel;
+  absl::Notification queue0_done;
+  absl::Notification queue1_done;
+  std::vector<NotifyingHandler*> handlers;
+  TunQueueWorkerPool pool(
+      {queue0[0], queue1[0]}, kMtu, &kernel,
+      [&](size_t queue_index) {
+        auto handler = std::make_unique<NotifyingHandler>(
+            queue_index == 0 ? 2 : 1,
+            queue_index == 0 ? &queue0_done : &queue1_done);
+        handlers.push_back(handler.get());
+        return handler;
+      });
+  ASSERT_EQ(2u, pool.num_workers());
+  pool.Start();
+
+  const std::string packet_a = "packet a";
+  const std::string packet_b = "packet b";
+  const std::string packet_c = "packet c";
+  ASSERT_GT(write(queue0[1], packet_a.data(), packet_a.size()), 0);
+  ASSERT_GT(write(queue0[1], packet_b.data(), packet_b.size()), 0);
+  ASSERT_GT(write(queue1[1], packet_c.data(), packet_c.size()), 0);
+
+  queue0_done.WaitForNotification();
+  queue1_done.WaitForNotification();
+  pool.QuitAndJoin();
+
+  // Each worker saw only its own queue's packets, in order.
+  EXPECT_EQ(std::vector<std::string>({packet_a, packet_b}),
+            handlers[0]->packets());
+  EXPECT_EQ(std::vector<std::string>({packet_c}), handlers[1]->packets());
+
+  const TunQueueWorkerPool::AggregatedStats stats = pool.GetStats();
+  EXPECT_EQ(3, stats.packets_read);
+  EXPECT_EQ(static_cast<int64_t>(packet_a.size() + packet_b.size() +
+                                 packet_c.size()),
+            stats.bytes_read);
+  EXPECT_EQ(0, stats.read_errors);
+
+  for (int fd : {queue0[0], queue0[1], queue1[0], queue1[1]}) {
+    close(fd);
+  }
+}
+
+}  // namespace
+}  // namespace quic
@@ -7,9 +7,11 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <poll.h>
 #include <sys/ioctl.h>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <unistd.h>
 #include <type_traits>
 #include <utility>
@@ -25,6 +27,7 @@ class KernelInterface {
   virtual int close(int fd) = 0;
   virtual int ioctl(int fd, int request, void* argp) = 0;
   virtual int open(const char* pathname, int flags) = 0;
+  virtual int poll(struct pollfd* fds, nfds_t nfds, int timeout) = 0;
   virtual ssize_t read(int fd, void* buf, size_t count) = 0;
   virtual ssize_t recvfrom(int sockfd,
                            void* buf,
@@ -46,6 +49,7 @@ class KernelInterface {
                          const void* optval,
                          socklen_t optlen) = 0;
   virtual ssize_t write(int fd, const void* buf, size_t count) = 0;
+  virtual ssize_t writev(int fd, const struct iovec* iov, int iovcnt) = 0;
 };
 
 // It is unfortunate to have R here, but std::result_of cannot be used.
@@ -92,6 +96,10 @@ class ParametrizedKernel final : public KernelInterface {
     static Runner syscall("open");
     return syscall.Retry(&::open, pathname, flags);
   }
+  int poll(struct pollfd* fds, nfds_t nfds, int timeout) override {
+    static Runner syscall("poll");
+    return syscall.Run(&::poll, fds, nfds, timeout);
+  }
   ssize_t read(int fd, void* buf, size_t count) override {
     static Runner syscall("read");
     return syscall.Run(&::read, fd, buf, count);
@@ -137,6 +145,10 @@ class ParametrizedKernel final : public KernelInterface {
     static Runner syscall("write");
     return syscall.Run(&::write, fd, buf, count);
   }
+  ssize_t writev(int fd, const struct iovec* iov, int iovcnt) override {
+    static Runner syscall("writev");
+    return syscall.Run(&::writev, fd, iov, iovcnt);
+  }
 };
 
 class DefaultKernelRunner {
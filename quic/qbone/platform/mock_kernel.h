@@ -21,6 +21,10 @@ class MockKernel : public KernelInterface {
   MOCK_METHOD(int, close, (int fd), (override));
   MOCK_METHOD(int, ioctl, (int fd, int request, void*), (override));
   MOCK_METHOD(int, open, (const char*, int flags), (override));
+  MOCK_METHOD(int,
+              poll,
+              (struct pollfd * fds, nfds_t nfds, int timeout),
+              (override));
   MOCK_METHOD(ssize_t, read, (int fd, void*, size_t count), (override));
   MOCK_METHOD(
       ssize_t,
@@ -46,6 +50,10 @@ class MockKernel : public KernelInterface {
               (int, int, int, const void*, socklen_t),
               (override));
   MOCK_METHOD(ssize_t, write, (int fd, const void*, size_t count), (override));
+  MOCK_METHOD(ssize_t,
+              writev,
+              (int fd, const struct iovec*, int iovcnt),
+              (override));
 };
 
 }  // namespace quic
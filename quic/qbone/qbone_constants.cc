@@ -10,6 +10,7 @@ namespace quic {
 
 constexpr char QboneConstants::kQboneAlpn[];
 const QuicByteCount QboneConstants::kMaxQbonePacketBytes;
+const uint8_t QboneConstants::kAggregatedPacketMarker;
 const uint32_t QboneConstants::kQboneRouteTableId;
 
 QuicStreamId QboneConstants::GetControlStreamId(QuicTransportVersion version) {
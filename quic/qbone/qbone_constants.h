@@ -17,6 +17,10 @@ struct QboneConstants {
   static constexpr char kQboneAlpn[] = "qbone";
   // The maximum number of bytes allowed in a QBONE packet.
   static const QuicByteCount kMaxQbonePacketBytes = 2000;
+  // The first byte of a MESSAGE payload that carries multiple aggregated
+  // tunneled packets, each prefixed by a varint62 length. A raw IP packet can
+  // never start with this byte since its version nibble is neither 4 nor 6.
+  static const uint8_t kAggregatedPacketMarker = 0x00;
   // The table id for QBONE's routing table. 'bone' in ascii.
   static const uint32_t kQboneRouteTableId = 0x626F6E65;
   // The stream ID of the control channel.
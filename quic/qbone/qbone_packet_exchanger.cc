@@ -23,6 +23,16 @@ bool QbonePacketExchanger::ReadAndDeliverPacket(
   return true;
 }
 
+size_t QbonePacketExchanger::ReadAndDeliverBatch(
+    QboneClientInterface* qbone_client, size_t max_packets) {
+  size_t packets_delivered = 0;
+  while (packets_delivered < max_packets &&
+         ReadAndDeliverPacket(qbone_client)) {
+    ++packets_delivered;
+  }
+  return packets_delivered;
+}
+
 void QbonePacketExchanger::WritePacketToNetwork(const char* packet,
                                                 size_t size) {
   bool blocked = false;
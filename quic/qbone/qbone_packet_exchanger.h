@@ -39,6 +39,13 @@ class QbonePacketExchanger : public QbonePacketWriter {
   // qbone_client.
   bool ReadAndDeliverPacket(QboneClientInterface* qbone_client);
 
+  // Reads and delivers packets until the local network has no more to offer
+  // or |max_packets| have been delivered, whichever comes first.  Draining the
+  // device in one go amortizes the event-loop dispatch over a burst of
+  // packets.  Returns the number of packets delivered.
+  size_t ReadAndDeliverBatch(QboneClientInterface* qbone_client,
+                             size_t max_packets);
+
   // From QbonePacketWriter.
   // Writes a packet to the local network. If the write would be blocked, the
   // packet will be queued if the queue is smaller than max_pending_packets_.
@@ -131,6 +131,39 @@ TEST(QbonePacketExchangerTest,
   EXPECT_FALSE(exchanger.ReadAndDeliverPacket(&client));
 }
 
+TEST(QbonePacketExchangerTest, ReadAndDeliverBatchDrainsAvailablePackets) {
+  StrictMock<MockVisitor> visitor;
+  FakeQbonePacketExchanger exchanger(&visitor, kMaxPendingPackets);
+  StrictMock<MockQboneClient> client;
+
+  std::string first = "first";
+  std::string second = "second";
+  exchanger.AddPacketToBeRead(
+      std::make_unique<QuicData>(first.data(), first.length()));
+  exchanger.AddPacketToBeRead(
+      std::make_unique<QuicData>(second.data(), second.length()));
+  EXPECT_CALL(client, ProcessPacketFromNetwork(StrEq("first")));
+  EXPECT_CALL(client, ProcessPacketFromNetwork(StrEq("second")));
+
+  // The batch stops once the exchanger reports blocked I/O.
+  EXPECT_EQ(2u, exchanger.ReadAndDeliverBatch(&client, 100));
+}
+
+TEST(QbonePacketExchangerTest, ReadAndDeliverBatchRespectsPacketLimit) {
+  StrictMock<MockVisitor> visitor;
+  FakeQbonePacketExchanger exchanger(&visitor, kMaxPendingPackets);
+  StrictMock<MockQboneClient> client;
+
+  std::string packet = "data";
+  for (int i = 0; i < 3; ++i) {
+    exchanger.AddPacketToBeRead(
+        std::make_unique<QuicData>(packet.data(), packet.length()));
+  }
+  EXPECT_CALL(client, ProcessPacketFromNetwork(StrEq("data"))).Times(2);
+
+  EXPECT_EQ(2u, exchanger.ReadAndDeliverBatch(&client, 2));
+}
+
 TEST(QbonePacketExchangerTest,
      WritePacketToNetworkWritesDirectlyToNetworkWhenNotBlocked) {
   MockVisitor visitor;
@@ -110,6 +110,13 @@ void QbonePacketProcessor::ProcessPacket(std::string* packet,
   }
 }
 
+void QbonePacketProcessor::ProcessPacketBatch(std::vector<std::string>* packets,
+                                              Direction direction) {
+  for (std::string& packet : *packets) {
+    ProcessPacket(&packet, direction);
+  }
+}
+
 QbonePacketProcessor::ProcessingResult
 QbonePacketProcessor::ProcessIPv6HeaderAndFilter(std::string* packet,
                                                  Direction direction,
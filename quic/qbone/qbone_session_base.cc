@@ -9,9 +9,11 @@
 
 #include <utility>
 
+#include "absl/memory/memory.h"
 #include "absl/strings/string_view.h"
 #include "quic/core/quic_buffer_allocator.h"
 #include "quic/core/quic_data_reader.h"
+#include "quic/core/quic_data_writer.h"
 #include "quic/core/quic_types.h"
 #include "quic/platform/api/quic_exported_stats.h"
 #include "quic/platform/api/quic_logging.h"
@@ -30,6 +32,37 @@ namespace quic {
 #define ENDPOINT \
   (perspective() == Perspective::IS_SERVER ? "Server: " : "Client: ")
 
+namespace {
+
+// Tunneled packets larger than this are sent standalone: the relative framing
+// savings are small and they would displace several smaller packets.
+constexpr QuicByteCount kMaxAggregatedPacketSize = 512;
+
+// How long a buffered packet may wait for companions before it is flushed.
+constexpr QuicTime::Delta kAggregationFlushTimeout =
+    QuicTime::Delta::FromMicroseconds(50);
+
+class AggregationFlushDelegate : public QuicAlarm::Delegate {
+ public:
+  explicit AggregationFlushDelegate(QboneSessionBase* session)
+      : session_(session) {}
+  AggregationFlushDelegate(const AggregationFlushDelegate&) = delete;
+  AggregationFlushDelegate& operator=(const AggregationFlushDelegate&) = delete;
+
+  QuicConnectionContext* GetConnectionContext() override {
+    return (session_->connection() == nullptr)
+               ? nullptr
+               : session_->connection()->context();
+  }
+
+  void OnAlarm() override { session_->FlushAggregatedPackets(); }
+
+ private:
+  QboneSessionBase* session_;
+};
+
+}  // namespace
+
 QboneSessionBase::QboneSessionBase(
     QuicConnection* connection,
     Visitor* owner,
@@ -88,6 +121,22 @@ void QboneSessionBase::OnStreamFrame(const QuicStreamFrame& frame) {
 }
 
 void QboneSessionBase::OnMessageReceived(absl::string_view message) {
+  if (!message.empty() &&
+      static_cast<uint8_t>(message[0]) ==
+          QboneConstants::kAggregatedPacketMarker) {
+    QuicDataReader reader(message.data() + 1, message.size() - 1);
+    while (!reader.IsDoneReading()) {
+      absl::string_view packet;
+      if (!reader.ReadStringPieceVarInt62(&packet)) {
+        QUIC_DLOG(ERROR) << ENDPOINT
+                         << "Dropping tail of malformed aggregated message";
+        return;
+      }
+      ++num_message_packets_;
+      ProcessPacketFromPeer(packet);
+    }
+    return;
+  }
   ++num_message_packets_;
   ProcessPacketFromPeer(message);
 }
@@ -140,6 +189,9 @@ void QboneSessionBase::SendPacketToPeer(absl::string_view packet) {
   }
 
   if (send_packets_as_messages_) {
+    if (packet_aggregation_enabled_ && MaybeAggregatePacket(packet)) {
+      return;
+    }
     QuicMemSlice slice(QuicBuffer::Copy(
         connection()->helper()->GetStreamSendBufferAllocator(), packet));
     switch (SendMessage(absl::MakeSpan(&slice, 1), /*flush=*/true).status) {
@@ -209,6 +261,85 @@ uint64_t QboneSessionBase::GetNumFallbackToStream() const {
   return num_fallback_to_stream_;
 }
 
+uint64_t QboneSessionBase::GetNumAggregatedMessagesSent() const {
+  return num_aggregated_messages_sent_;
+}
+
+bool QboneSessionBase::MaybeAggregatePacket(absl::string_view packet) {
+  if (packet.size() > kMaxAggregatedPacketSize) {
+    return false;
+  }
+  const QuicByteCount max_payload =
+      connection()->GetGuaranteedLargestMessagePayload();
+  char length_prefix[sizeof(uint64_t)];
+  QuicDataWriter length_writer(sizeof(length_prefix), length_prefix);
+  if (!length_writer.WriteVarInt62(packet.size())) {
+    QUIC_BUG(qbone_aggregation_length_prefix)
+        << "Failed to encode length prefix for a " << packet.size()
+        << " byte packet";
+    return false;
+  }
+  const size_t encoded_size = length_writer.length() + packet.size();
+  // If even an empty aggregated message cannot hold the packet, send it
+  // standalone so that the regular ICMP Packet Too Big handling applies.
+  if (1 + encoded_size > max_payload) {
+    return false;
+  }
+  if (!aggregation_buffer_.empty() &&
+      aggregation_buffer_.size() + encoded_size > max_payload) {
+    FlushAggregatedPackets();
+  }
+  if (aggregation_buffer_.empty()) {
+    aggregation_buffer_.push_back(
+        static_cast<char>(QboneConstants::kAggregatedPacketMarker));
+  }
+  aggregation_buffer_.append(length_writer.data(), length_writer.length());
+  aggregation_buffer_.append(packet.data(), packet.size());
+  if (!aggregation_alarm_->IsSet()) {
+    aggregation_alarm_->Set(connection()->clock()->ApproximateNow() +
+                            kAggregationFlushTimeout);
+  }
+  return true;
+}
+
+void QboneSessionBase::FlushAggregatedPackets() {
+  if (aggregation_alarm_ != nullptr) {
+    aggregation_alarm_->Cancel();
+  }
+  if (aggregation_buffer_.empty()) {
+    return;
+  }
+  QuicMemSlice slice(
+      QuicBuffer::Copy(connection()->helper()->GetStreamSendBufferAllocator(),
+                       aggregation_buffer_));
+  aggregation_buffer_.clear();
+  MessageStatus status = SendMessage(absl::MakeSpan(&slice, 1),
+                                     /*flush=*/true)
+                             .status;
+  if (status == MESSAGE_STATUS_SUCCESS) {
+    ++num_aggregated_messages_sent_;
+    return;
+  }
+  // The payload is capped at GetGuaranteedLargestMessagePayload() and is only
+  // assembled after encryption is established, so no failure is expected.
+  QUIC_BUG(qbone_aggregated_message_failed)
+      << "Failed to send aggregated QBONE message: "
+      << MessageStatusToString(status);
+}
+
+void QboneSessionBase::set_packet_aggregation_enabled(
+    bool packet_aggregation_enabled) {
+  packet_aggregation_enabled_ = packet_aggregation_enabled;
+  if (packet_aggregation_enabled && aggregation_alarm_ == nullptr) {
+    aggregation_alarm_ =
+        absl::WrapUnique<QuicAlarm>(connection()->alarm_factory()->CreateAlarm(
+            new AggregationFlushDelegate(this)));
+  }
+  if (!packet_aggregation_enabled) {
+    FlushAggregatedPackets();
+  }
+}
+
 void QboneSessionBase::set_writer(QbonePacketWriter* writer) {
   writer_ = writer;
   quic::AdjustTestValue("quic_QbonePacketWriter", &writer_);
@@ -6,6 +6,7 @@
 #define QUICHE_QUIC_QBONE_QBONE_SESSION_BASE_H_
 
 #include "absl/strings/string_view.h"
+#include "quic/core/quic_alarm.h"
 #include "quic/core/quic_crypto_server_stream_base.h"
 #include "quic/core/quic_crypto_stream.h"
 #include "quic/core/quic_error_codes.h"
@@ -56,11 +57,27 @@ class QUIC_EXPORT_PRIVATE QboneSessionBase : public QuicSession {
   // used an ephemeral stream instead.
   uint64_t GetNumFallbackToStream() const;
 
+  // Returns the number of MESSAGE frames sent that carried multiple
+  // aggregated tunneled packets.
+  uint64_t GetNumAggregatedMessagesSent() const;
+
+  // Sends out any tunneled packets currently buffered for aggregation.
+  // Public so that the flush alarm can invoke it; also safe to call at any
+  // time, e.g. right before the fate of the connection is decided.
+  void FlushAggregatedPackets();
+
   void set_writer(QbonePacketWriter* writer);
   void set_send_packets_as_messages(bool send_packets_as_messages) {
     send_packets_as_messages_ = send_packets_as_messages;
   }
 
+  // If enabled, small tunneled packets are coalesced into a single MESSAGE
+  // frame payload, flushed by size or by a short timer. Receiving aggregated
+  // payloads is always supported, but the feature should only be turned on
+  // once the peer is known to understand the aggregated framing. Only
+  // effective when packets are sent as messages.
+  void set_packet_aggregation_enabled(bool packet_aggregation_enabled);
+
  protected:
   virtual std::unique_ptr<QuicCryptoStream> CreateCryptoStream() = 0;
 
@@ -96,9 +113,26 @@ class QUIC_EXPORT_PRIVATE QboneSessionBase : public QuicSession {
   bool send_packets_as_messages_ = false;
 
  private:
+  // Appends |packet| to the aggregation buffer, flushing first if it would
+  // not fit, and arms the flush alarm. Returns false if the packet is too
+  // large to be aggregated and should be sent standalone.
+  bool MaybeAggregatePacket(absl::string_view packet);
+
   // Used for the crypto handshake.
   std::unique_ptr<QuicCryptoStream> crypto_stream_;
 
+  // If true, small tunneled packets are coalesced into aggregated MESSAGE
+  // payloads instead of being sent individually.
+  bool packet_aggregation_enabled_ = false;
+
+  // Aggregated framing for the next MESSAGE frame, starting with
+  // QboneConstants::kAggregatedPacketMarker. Empty when nothing is buffered.
+  std::string aggregation_buffer_;
+
+  // Fires to flush |aggregation_buffer_| when no size-triggered flush
+  // happened within the aggregation window.
+  std::unique_ptr<QuicAlarm> aggregation_alarm_;
+
   // Statistics for the packets received by the session.
   uint64_t num_ephemeral_packets_ = 0;
   uint64_t num_message_packets_ = 0;
@@ -107,6 +141,9 @@ class QUIC_EXPORT_PRIVATE QboneSessionBase : public QuicSession {
   // Number of times the connection has failed to send packets as MESSAGE frame
   // and used streams as a fallback.
   uint64_t num_fallback_to_stream_ = 0;
+
+  // Number of MESSAGE frames sent that carried multiple aggregated packets.
+  uint64_t num_aggregated_messages_sent_ = 0;
 };
 
 }  // namespace quic
@@ -576,6 +576,31 @@ TEST_P(QboneSessionTest, Messages) {
   TestStreamConnection(true);
 }
 
+TEST_P(QboneSessionTest, AggregatedMessages) {
+  CreateClientAndServerSessions();
+  client_peer_->set_send_packets_as_messages(true);
+  server_peer_->set_send_packets_as_messages(true);
+  StartHandshake();
+  client_peer_->set_packet_aggregation_enabled(true);
+
+  // Both small packets are buffered and leave in a single MESSAGE frame.
+  client_peer_->ProcessPacketFromNetwork(TestPacketIn("hello"));
+  client_peer_->ProcessPacketFromNetwork(TestPacketIn("world"));
+  client_peer_->FlushAggregatedPackets();
+  runner_.Run();
+
+  EXPECT_THAT(server_writer_->data(),
+              ElementsAre(TestPacketOut("hello"), TestPacketOut("world")));
+  EXPECT_THAT(client_peer_->GetNumAggregatedMessagesSent(), Eq(1));
+  EXPECT_THAT(server_peer_->GetNumMessagePackets(), Eq(2));
+  EXPECT_EQ(0u, server_peer_->GetNumActiveStreams());
+
+  // A flush with nothing buffered is a no-op.
+  client_peer_->FlushAggregatedPackets();
+  runner_.Run();
+  EXPECT_THAT(client_peer_->GetNumAggregatedMessagesSent(), Eq(1));
+}
+
 TEST_P(QboneSessionTest, ClientRejection) {
   CreateClientAndServerSessions(false /*client_handshake_success*/,
                                 true /*server_handshake_success*/,
@@ -0,0 +1,84 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <cstring>
+#include <vector>
+
+#include "quic/core/quic_data_reader.h"
+#include "quic/core/quic_data_writer.h"
+
+namespace {
+
+// Bound the work per input; the batch kernels have no per-call state, so
+// long inputs add no coverage beyond this.
+const size_t kMaxVarInts = 256;
+
+}  // namespace
+
+// Checks that the batched varint kernels agree with the one-at-a-time
+// methods on arbitrary input.  The batch methods take a branchless wide
+// load/store fast path away from the buffer's end and a bounds-checked
+// fallback near it, and both paths must decode (and re-encode) exactly
+// what ReadVarInt62 and WriteVarInt62 do, including where they stop.
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+  const char* const input = reinterpret_cast<const char*>(data);
+
+  // Differential decode: batch vs. sequential over the same bytes.
+  uint64_t batch_results[kMaxVarInts];
+  quic::QuicDataReader batch_reader(input, size,
+                                    quiche::Endianness::NETWORK_BYTE_ORDER);
+  const size_t batch_count =
+      batch_reader.ReadVarInt62Batch(batch_results, kMaxVarInts);
+
+  quic::QuicDataReader single_reader(input, size,
+                                     quiche::Endianness::NETWORK_BYTE_ORDER);
+  for (size_t i = 0; i < batch_count; ++i) {
+    uint64_t value;
+    if (!single_reader.ReadVarInt62(&value) || value != batch_results[i]) {
+      __builtin_trap();
+    }
+  }
+  if (batch_count < kMaxVarInts) {
+    uint64_t value;
+    if (single_reader.ReadVarInt62(&value)) {
+      __builtin_trap();
+    }
+  }
+  if (batch_reader.BytesRemaining() != single_reader.BytesRemaining()) {
+    __builtin_trap();
+  }
+
+  // Differential encode: re-encoding the decoded values must reproduce
+  // the same bytes through both write paths.  Undersize the batch buffer
+  // by the fuzzer's first byte to also exercise the fallback tail.
+  if (batch_count == 0) {
+    return 0;
+  }
+  const size_t single_length = size - single_reader.BytesRemaining();
+  std::vector<char> single_buffer(single_length);
+  quic::QuicDataWriter single_writer(single_buffer.size(),
+                                     single_buffer.data(),
+                                     quiche::Endianness::NETWORK_BYTE_ORDER);
+  for (size_t i = 0; i < batch_count; ++i) {
+    if (!single_writer.WriteVarInt62(batch_results[i])) {
+      __builtin_trap();
+    }
+  }
+
+  const size_t shrink = data[0] % (single_length + 1);
+  std::vector<char> batch_buffer(single_length - shrink);
+  quic::QuicDataWriter batch_writer(batch_buffer.size(), batch_buffer.data(),
+                                    quiche::Endianness::NETWORK_BYTE_ORDER);
+  const size_t written =
+      batch_writer.WriteVarInt62Batch(batch_results, batch_count);
+  if (written < batch_count && shrink == 0) {
+    __builtin_trap();
+  }
+  if (memcmp(batch_buffer.data(), single_buffer.data(),
+             batch_writer.length()) != 0) {
+    __builtin_trap();
+  }
+
+  return 0;
+}
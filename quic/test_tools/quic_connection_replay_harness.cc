@@ -0,0 +1,269 @@
+// Copyright (c) 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/test_tools/quic_connection_replay_harness.h"
+
+#include <algorithm>
+#include <memory>
+
+#include "quic/core/quic_data_reader.h"
+#include "quic/core/quic_data_writer.h"
+#include "quic/core/quic_packets.h"
+#include "quic/platform/api/quic_bug_tracker.h"
+
+namespace quic {
+namespace test {
+
+namespace {
+
+// Serialized trace format version, bumped on incompatible changes.
+const uint8_t kTraceFormatVersion = 1;
+
+// Writes |address| as an 8-bit length-prefixed packed IP followed by the
+// port. An uninitialized address is written with a zero-length IP.
+bool WriteAddress(const QuicSocketAddress& address, QuicDataWriter* writer) {
+  std::string packed_ip;
+  if (address.IsInitialized()) {
+    packed_ip = address.host().ToPackedString();
+  }
+  return writer->WriteUInt8(packed_ip.size()) &&
+         writer->WriteStringPiece(packed_ip) &&
+         writer->WriteUInt16(address.port());
+}
+
+bool ReadAddress(QuicDataReader* reader, QuicSocketAddress* address) {
+  uint8_t ip_length;
+  absl::string_view packed_ip;
+  uint16_t port;
+  if (!reader->ReadUInt8(&ip_length) ||
+      !reader->ReadStringPiece(&packed_ip, ip_length) ||
+      !reader->ReadUInt16(&port)) {
+    return false;
+  }
+  if (ip_length == 0) {
+    *address = QuicSocketAddress();
+    return true;
+  }
+  QuicIpAddress ip;
+  if (!ip.FromPackedString(packed_ip.data(), packed_ip.size())) {
+    return false;
+  }
+  *address = QuicSocketAddress(ip, port);
+  return true;
+}
+
+}  // namespace
+
+void QuicConnectionReplayTrace::RecordPacket(QuicTime::Delta offset,
+                                             absl::string_view packet) {
+  Event event;
+  event.type = EventType::kPacket;
+  event.offset = offset;
+  event.packet = std::string(packet);
+  events_.push_back(std::move(event));
+}
+
+void QuicConnectionReplayTrace::RecordAlarmFire(QuicTime::Delta offset) {
+  Event event;
+  event.type = EventType::kAlarmFire;
+  event.offset = offset;
+  events_.push_back(std::move(event));
+}
+
+std::string QuicConnectionReplayTrace::Serialize() const {
+  size_t length = 1 + 2 * (1 + QuicIpAddress::kIPv6AddressSize + 2);
+  for (const Event& event : events_) {
+    length += 1 + 8 + 4 + event.packet.size();
+  }
+  std::string buffer(length, '\0');
+  QuicDataWriter writer(buffer.size(), &buffer[0]);
+  if (!writer.WriteUInt8(kTraceFormatVersion) ||
+      !WriteAddress(self_address_, &writer) ||
+      !WriteAddress(peer_address_, &writer)) {
+    QUIC_BUG(quic_bug_replay_trace_1) << "Failed to serialize trace header.";
+    return std::string();
+  }
+  for (const Event& event : events_) {
+    if (!writer.WriteUInt8(static_cast<uint8_t>(event.type)) ||
+        !writer.WriteUInt64(event.offset.ToMicroseconds()) ||
+        !writer.WriteUInt32(event.packet.size()) ||
+        !writer.WriteStringPiece(event.packet)) {
+      QUIC_BUG(quic_bug_replay_trace_2) << "Failed to serialize trace event.";
+      return std::string();
+    }
+  }
+  buffer.resize(writer.length());
+  return buffer;
+}
+
+bool QuicConnectionReplayTrace::Parse(absl::string_view data) {
+  events_.clear();
+  QuicDataReader reader(data.data(), data.size());
+  uint8_t version;
+  if (!reader.ReadUInt8(&version) || version != kTraceFormatVersion ||
+      !ReadAddress(&reader, &self_address_) ||
+      !ReadAddress(&reader, &peer_address_)) {
+    return false;
+  }
+  while (!reader.IsDoneReading()) {
+    uint8_t type;
+    uint64_t offset_us;
+    uint32_t packet_length;
+    absl::string_view packet;
+    if (!reader.ReadUInt8(&type) || !reader.ReadUInt64(&offset_us) ||
+        !reader.ReadUInt32(&packet_length) ||
+        !reader.ReadStringPiece(&packet, packet_length)) {
+      return false;
+    }
+    if (type != static_cast<uint8_t>(EventType::kPacket) &&
+        type != static_cast<uint8_t>(EventType::kAlarmFire)) {
+      return false;
+    }
+    Event event;
+    event.type = static_cast<EventType>(type);
+    event.offset = QuicTime::Delta::FromMicroseconds(offset_us);
+    event.packet = std::string(packet);
+    events_.push_back(std::move(event));
+  }
+  return true;
+}
+
+QuicConnectionReplayRecorder::QuicConnectionReplayRecorder(
+    const QuicClock* clock)
+    : clock_(clock) {}
+
+QuicTime::Delta QuicConnectionReplayRecorder::OffsetNow() {
+  if (start_time_ == QuicTime::Zero()) {
+    start_time_ = clock_->Now();
+  }
+  return clock_->Now() - start_time_;
+}
+
+void QuicConnectionReplayRecorder::OnPacketDispatched(
+    const QuicSocketAddress& self_address,
+    const QuicSocketAddress& peer_address, absl::string_view packet) {
+  if (trace_.events().empty()) {
+    trace_.set_self_address(self_address);
+    trace_.set_peer_address(peer_address);
+  }
+  trace_.RecordPacket(OffsetNow(), packet);
+}
+
+void QuicConnectionReplayRecorder::OnAlarmFired() {
+  trace_.RecordAlarmFire(OffsetNow());
+}
+
+// An alarm whose scheduling lives entirely in the harness's deadline map,
+// so the harness controls exactly when and in what order alarms fire.
+class QuicConnectionReplayHarness::ReplayAlarm : public QuicAlarm {
+ public:
+  ReplayAlarm(QuicConnectionReplayHarness* harness,
+              QuicArenaScopedPtr<QuicAlarm::Delegate> delegate)
+      : QuicAlarm(std::move(delegate)), harness_(harness) {}
+
+  ~ReplayAlarm() override { CancelImpl(); }
+
+  void SetImpl() override {
+    CancelImpl();
+    key_ = AlarmKey(deadline(), harness_->next_alarm_token_++);
+    harness_->scheduled_alarms_[key_] = this;
+    scheduled_ = true;
+  }
+
+  void CancelImpl() override {
+    if (scheduled_) {
+      harness_->scheduled_alarms_.erase(key_);
+      scheduled_ = false;
+    }
+  }
+
+  void DoFire() {
+    scheduled_ = false;
+    Fire();
+  }
+
+ private:
+  QuicConnectionReplayHarness* harness_;  // Not owned.
+  AlarmKey key_ = AlarmKey(QuicTime::Zero(), 0);
+  bool scheduled_ = false;
+};
+
+class QuicConnectionReplayHarness::ReplayAlarmFactory
+    : public QuicAlarmFactory {
+ public:
+  explicit ReplayAlarmFactory(QuicConnectionReplayHarness* harness)
+      : harness_(harness) {}
+
+  QuicAlarm* CreateAlarm(QuicAlarm::Delegate* delegate) override {
+    return new ReplayAlarm(
+        harness_, QuicArenaScopedPtr<QuicAlarm::Delegate>(delegate));
+  }
+
+  QuicArenaScopedPtr<QuicAlarm> CreateAlarm(
+      QuicArenaScopedPtr<QuicAlarm::Delegate> delegate,
+      QuicConnectionArena* arena) override {
+    if (arena != nullptr) {
+      return arena->New<ReplayAlarm>(harness_, std::move(delegate));
+    }
+    return QuicArenaScopedPtr<QuicAlarm>(
+        new ReplayAlarm(harness_, std::move(delegate)));
+  }
+
+ private:
+  QuicConnectionReplayHarness* harness_;  // Not owned.
+};
+
+QuicConnectionReplayHarness::QuicConnectionReplayHarness()
+    : alarm_factory_(std::make_unique<ReplayAlarmFactory>(this)) {}
+
+QuicConnectionReplayHarness::~QuicConnectionReplayHarness() {}
+
+QuicAlarmFactory* QuicConnectionReplayHarness::alarm_factory() {
+  return alarm_factory_.get();
+}
+
+void QuicConnectionReplayHarness::AdvanceTo(QuicTime time) {
+  if (time > clock_.Now()) {
+    clock_.AdvanceTime(time - clock_.Now());
+  }
+}
+
+bool QuicConnectionReplayHarness::FireNextDueAlarm() {
+  auto it = scheduled_alarms_.begin();
+  if (it == scheduled_alarms_.end() || it->first.first > clock_.Now()) {
+    return false;
+  }
+  ReplayAlarm* alarm = it->second;
+  scheduled_alarms_.erase(it);
+  alarm->DoFire();
+  return true;
+}
+
+void QuicConnectionReplayHarness::Replay(
+    const QuicConnectionReplayTrace& trace, QuicConnection* connection) {
+  const QuicTime start_time = clock_.Now();
+  for (const QuicConnectionReplayTrace::Event& event : trace.events()) {
+    AdvanceTo(start_time + event.offset);
+    switch (event.type) {
+      case QuicConnectionReplayTrace::EventType::kPacket: {
+        QuicReceivedPacket packet(event.packet.data(), event.packet.size(),
+                                  clock_.Now());
+        connection->ProcessUdpPacket(trace.self_address(),
+                                     trace.peer_address(), packet);
+        break;
+      }
+      case QuicConnectionReplayTrace::EventType::kAlarmFire:
+        // The recorded event loop may have fired an alarm that this code
+        // version never armed; skipping keeps the rest of the trace usable.
+        FireNextDueAlarm();
+        break;
+    }
+    if (!connection->connected()) {
+      return;
+    }
+  }
+}
+
+}  // namespace test
+}  // namespace quic
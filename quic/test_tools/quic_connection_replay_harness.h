@@ -0,0 +1,158 @@
+// Copyright (c) 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_TEST_TOOLS_QUIC_CONNECTION_REPLAY_HARNESS_H_
+#define QUICHE_QUIC_TEST_TOOLS_QUIC_CONNECTION_REPLAY_HARNESS_H_
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "quic/core/quic_alarm.h"
+#include "quic/core/quic_alarm_factory.h"
+#include "quic/core/quic_connection.h"
+#include "quic/core/quic_time.h"
+#include "quic/platform/api/quic_export.h"
+#include "quic/platform/api/quic_socket_address.h"
+#include "quic/test_tools/mock_clock.h"
+
+namespace quic {
+namespace test {
+
+// A recorded sequence of the externally observable inputs to one
+// QuicConnection: inbound packet bytes and the order in which alarms fired,
+// each stamped with an offset from the start of the trace. Together with a
+// virtual clock these inputs determine the connection's state evolution, so
+// a trace captured from a misbehaving production connection can be replayed
+// deterministically against any code version and bisected.
+//
+// The serialized format is a compact binary log suitable for cheap always-on
+// recording.
+class QuicConnectionReplayTrace {
+ public:
+  enum class EventType : uint8_t {
+    kPacket = 1,
+    kAlarmFire = 2,
+  };
+
+  struct Event {
+    EventType type;
+    // Time since the start of the trace.
+    QuicTime::Delta offset = QuicTime::Delta::Zero();
+    // Packet bytes; empty for kAlarmFire events.
+    std::string packet;
+  };
+
+  // Appends an inbound packet event.
+  void RecordPacket(QuicTime::Delta offset, absl::string_view packet);
+
+  // Appends an alarm fire event. Alarm identity is not recorded: replay
+  // fires the earliest-deadline alarm due at |offset|, which is the alarm
+  // a deadline-ordered event loop would have fired.
+  void RecordAlarmFire(QuicTime::Delta offset);
+
+  // Serializes the trace to the compact binary format.
+  std::string Serialize() const;
+
+  // Parses a serialized trace. Returns false on malformed input, in which
+  // case |this| is left in an unspecified state.
+  bool Parse(absl::string_view data);
+
+  const std::vector<Event>& events() const { return events_; }
+
+  // Addresses the replayed packets are delivered with.
+  const QuicSocketAddress& self_address() const { return self_address_; }
+  const QuicSocketAddress& peer_address() const { return peer_address_; }
+  void set_self_address(const QuicSocketAddress& address) {
+    self_address_ = address;
+  }
+  void set_peer_address(const QuicSocketAddress& address) {
+    peer_address_ = address;
+  }
+
+ private:
+  QuicSocketAddress self_address_;
+  QuicSocketAddress peer_address_;
+  std::vector<Event> events_;
+};
+
+// Records the inputs of a live connection into a QuicConnectionReplayTrace.
+// The owner calls OnPacketDispatched() immediately before handing each
+// inbound packet to QuicConnection::ProcessUdpPacket(), and OnAlarmFired()
+// from the event loop each time one of the connection's alarms fires.
+class QuicConnectionReplayRecorder {
+ public:
+  explicit QuicConnectionReplayRecorder(const QuicClock* clock);
+
+  void OnPacketDispatched(const QuicSocketAddress& self_address,
+                          const QuicSocketAddress& peer_address,
+                          absl::string_view packet);
+  void OnAlarmFired();
+
+  const QuicConnectionReplayTrace& trace() const { return trace_; }
+
+ private:
+  // Offset of |clock_->Now()| from the start of the trace, anchoring the
+  // start at the first recorded event.
+  QuicTime::Delta OffsetNow();
+
+  const QuicClock* clock_;  // Not owned.
+  QuicTime start_time_ = QuicTime::Zero();
+  QuicConnectionReplayTrace trace_;
+};
+
+// Drives a real QuicConnection from a recorded trace under a virtual clock.
+// The connection under test must be constructed with this harness's clock()
+// and alarm_factory() so that all timing it observes is virtual. Replay
+// advances the clock to each event's offset; packets are processed through
+// ProcessUdpPacket() and alarm events fire the earliest due alarm, so the
+// recorded interleaving of packets and timers is reproduced exactly.
+class QuicConnectionReplayHarness {
+ public:
+  QuicConnectionReplayHarness();
+  QuicConnectionReplayHarness(const QuicConnectionReplayHarness&) = delete;
+  QuicConnectionReplayHarness& operator=(const QuicConnectionReplayHarness&) =
+      delete;
+  ~QuicConnectionReplayHarness();
+
+  MockClock* clock() { return &clock_; }
+  QuicAlarmFactory* alarm_factory();
+
+  // Replays |trace| into |connection|, which must outlive the call. Events
+  // are applied in order at their recorded offsets from the clock's current
+  // time. An alarm event with no due alarm is skipped; this tolerates code
+  // versions that arm fewer alarms than the recorded one, which is exactly
+  // the situation a bisect explores.
+  void Replay(const QuicConnectionReplayTrace& trace,
+              QuicConnection* connection);
+
+  // Advances the virtual clock without firing alarms. Exposed so tests can
+  // interleave replayed traces with manual clock manipulation.
+  void AdvanceTo(QuicTime time);
+
+  // Fires the scheduled alarm with the earliest deadline not after the
+  // current virtual time, if any. Ties are broken by arming order. Returns
+  // whether an alarm fired.
+  bool FireNextDueAlarm();
+
+ private:
+  class ReplayAlarm;
+  class ReplayAlarmFactory;
+
+  // Key orders alarms by (deadline, arming sequence number).
+  using AlarmKey = std::pair<QuicTime, uint64_t>;
+
+  MockClock clock_;
+  std::map<AlarmKey, ReplayAlarm*> scheduled_alarms_;
+  uint64_t next_alarm_token_ = 0;
+  std::unique_ptr<ReplayAlarmFactory> alarm_factory_;
+};
+
+}  // namespace test
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_TEST_TOOLS_QUIC_CONNECTION_REPLAY_HARNESS_H_
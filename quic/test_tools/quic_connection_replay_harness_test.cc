@@ -0,0 +1,129 @@
+// Copyright (c) 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/test_tools/quic_connection_replay_harness.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "quic/platform/api/quic_test.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+class RecordingAlarmDelegate : public QuicAlarm::DelegateWithoutContext {
+ public:
+  RecordingAlarmDelegate(std::vector<int>* fired_ids, int id)
+      : fired_ids_(fired_ids), id_(id) {}
+
+  void OnAlarm() override { fired_ids_->push_back(id_); }
+
+ private:
+  std::vector<int>* fired_ids_;  // Not owned.
+  int id_;
+};
+
+class QuicConnectionReplayHarnessTest : public QuicTest {
+ protected:
+  QuicConnectionReplayHarness harness_;
+};
+
+TEST_F(QuicConnectionReplayHarnessTest, TraceSerializeParseRoundTrip) {
+  QuicConnectionReplayTrace trace;
+  QuicIpAddress ip;
+  ASSERT_TRUE(ip.FromString("127.0.0.1"));
+  trace.set_self_address(QuicSocketAddress(ip, 443));
+  trace.set_peer_address(QuicSocketAddress(ip, 12345));
+  trace.RecordPacket(QuicTime::Delta::FromMicroseconds(10), "first packet");
+  trace.RecordAlarmFire(QuicTime::Delta::FromMicroseconds(25));
+  trace.RecordPacket(QuicTime::Delta::FromMicroseconds(40), "second packet");
+
+  std::string serialized = trace.Serialize();
+  ASSERT_FALSE(serialized.empty());
+
+  QuicConnectionReplayTrace parsed;
+  ASSERT_TRUE(parsed.Parse(serialized));
+  EXPECT_EQ(trace.self_address(), parsed.self_address());
+  EXPECT_EQ(trace.peer_address(), parsed.peer_address());
+  ASSERT_EQ(3u, parsed.events().size());
+  EXPECT_EQ(QuicConnectionReplayTrace::EventType::kPacket,
+            parsed.events()[0].type);
+  EXPECT_EQ("first packet", parsed.events()[0].packet);
+  EXPECT_EQ(QuicTime::Delta::FromMicroseconds(10), parsed.events()[0].offset);
+  EXPECT_EQ(QuicConnectionReplayTrace::EventType::kAlarmFire,
+            parsed.events()[1].type);
+  EXPECT_EQ(QuicTime::Delta::FromMicroseconds(25), parsed.events()[1].offset);
+  EXPECT_EQ("second packet", parsed.events()[2].packet);
+}
+
+TEST_F(QuicConnectionReplayHarnessTest, TraceParseRejectsMalformedInput) {
+  QuicConnectionReplayTrace trace;
+  EXPECT_FALSE(trace.Parse("garbage"));
+
+  QuicConnectionReplayTrace valid;
+  valid.RecordPacket(QuicTime::Delta::FromMicroseconds(10), "packet");
+  std::string serialized = valid.Serialize();
+  // Truncating the packet payload must be detected.
+  EXPECT_FALSE(trace.Parse(
+      absl::string_view(serialized.data(), serialized.size() - 1)));
+}
+
+TEST_F(QuicConnectionReplayHarnessTest, RecorderAnchorsOffsetsAtFirstEvent) {
+  MockClock clock;
+  clock.AdvanceTime(QuicTime::Delta::FromSeconds(100));
+  QuicConnectionReplayRecorder recorder(&clock);
+
+  recorder.OnPacketDispatched(QuicSocketAddress(), QuicSocketAddress(),
+                              "packet");
+  clock.AdvanceTime(QuicTime::Delta::FromMicroseconds(30));
+  recorder.OnAlarmFired();
+
+  ASSERT_EQ(2u, recorder.trace().events().size());
+  EXPECT_EQ(QuicTime::Delta::Zero(), recorder.trace().events()[0].offset);
+  EXPECT_EQ(QuicTime::Delta::FromMicroseconds(30),
+            recorder.trace().events()[1].offset);
+}
+
+TEST_F(QuicConnectionReplayHarnessTest, AlarmsFireInDeadlineOrder) {
+  std::vector<int> fired_ids;
+  std::unique_ptr<QuicAlarm> alarm1(harness_.alarm_factory()->CreateAlarm(
+      new RecordingAlarmDelegate(&fired_ids, 1)));
+  std::unique_ptr<QuicAlarm> alarm2(harness_.alarm_factory()->CreateAlarm(
+      new RecordingAlarmDelegate(&fired_ids, 2)));
+
+  // Arm out of deadline order.
+  alarm2->Set(harness_.clock()->Now() +
+              QuicTime::Delta::FromMicroseconds(10));
+  alarm1->Set(harness_.clock()->Now() + QuicTime::Delta::FromMicroseconds(20));
+
+  // Nothing is due yet.
+  EXPECT_FALSE(harness_.FireNextDueAlarm());
+
+  harness_.AdvanceTo(harness_.clock()->Now() +
+                     QuicTime::Delta::FromMicroseconds(20));
+  EXPECT_TRUE(harness_.FireNextDueAlarm());
+  EXPECT_TRUE(harness_.FireNextDueAlarm());
+  EXPECT_FALSE(harness_.FireNextDueAlarm());
+
+  EXPECT_EQ(std::vector<int>({2, 1}), fired_ids);
+}
+
+TEST_F(QuicConnectionReplayHarnessTest, CancelledAlarmDoesNotFire) {
+  std::vector<int> fired_ids;
+  std::unique_ptr<QuicAlarm> alarm(harness_.alarm_factory()->CreateAlarm(
+      new RecordingAlarmDelegate(&fired_ids, 1)));
+  alarm->Set(harness_.clock()->Now() + QuicTime::Delta::FromMicroseconds(10));
+  alarm->Cancel();
+
+  harness_.AdvanceTo(harness_.clock()->Now() +
+                     QuicTime::Delta::FromMicroseconds(20));
+  EXPECT_FALSE(harness_.FireNextDueAlarm());
+  EXPECT_TRUE(fired_ids.empty());
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
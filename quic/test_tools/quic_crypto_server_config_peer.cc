@@ -110,6 +110,13 @@ void QuicCryptoServerConfigPeer::CheckConfigs(
   }
 }
 
+bool QuicCryptoServerConfigPeer::GetCurrentConfigs(QuicWallTime now) {
+  QuicCryptoServerConfig::Configs configs;
+  return server_config_->GetCurrentConfigs(now, /*requested_scid=*/"",
+                                           /*old_primary_config=*/nullptr,
+                                           &configs);
+}
+
 // ConfigsDebug returns a std::string that contains debugging information about
 // the set of Configs loaded in |server_config_| and their status.
 std::string QuicCryptoServerConfigPeer::ConfigsDebug() {
@@ -67,6 +67,10 @@ class QuicCryptoServerConfigPeer {
   void CheckConfigs(
       std::vector<std::pair<ServerConfigID, bool>> expected_ids_and_status);
 
+  // Calls GetCurrentConfigs, which generates any deferred default config.
+  // Returns whether a primary config was available.
+  bool GetCurrentConfigs(QuicWallTime now);
+
   // ConfigsDebug returns a std::string that contains debugging information
   // about the set of Configs loaded in |server_config_| and their status.
   std::string ConfigsDebug()
@@ -58,6 +58,12 @@ QuicByteCount QuicFlowControllerPeer::ReceiveWindowSize(
          flow_controller->highest_received_byte_offset_;
 }
 
+// static
+QuicByteCount QuicFlowControllerPeer::ReceiveWindowSizeLimit(
+    QuicFlowController* flow_controller) {
+  return flow_controller->receive_window_size_limit_;
+}
+
 // static
 QuicByteCount QuicFlowControllerPeer::WindowUpdateThreshold(
     QuicFlowController* flow_controller) {
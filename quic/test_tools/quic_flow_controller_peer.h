@@ -35,6 +35,9 @@ class QuicFlowControllerPeer {
 
   static QuicByteCount ReceiveWindowSize(QuicFlowController* flow_controller);
 
+  static QuicByteCount ReceiveWindowSizeLimit(
+      QuicFlowController* flow_controller);
+
   static QuicByteCount WindowUpdateThreshold(
       QuicFlowController* flow_controller);
 };
@@ -0,0 +1,28 @@
+// Copyright (c) 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_TEST_TOOLS_QUIC_PACING_WHEEL_PEER_H_
+#define QUICHE_QUIC_TEST_TOOLS_QUIC_PACING_WHEEL_PEER_H_
+
+#include "quic/core/quic_alarm.h"
+#include "quic/core/quic_pacing_wheel.h"
+
+namespace quic {
+namespace test {
+
+class QuicPacingWheelPeer {
+ public:
+  QuicPacingWheelPeer() = delete;
+
+  static QuicAlarm* GetTickAlarm(QuicPacingWheel* wheel) {
+    return wheel->tick_alarm_.get();
+  }
+
+  static size_t NumSlots() { return QuicPacingWheel::kNumSlots; }
+};
+
+}  // namespace test
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_TEST_TOOLS_QUIC_PACING_WHEEL_PEER_H_
@@ -507,6 +507,8 @@ class MockQuicConnectionVisitor : public QuicConnectionVisitorInterface {
       const QuicSocketAddress& /*address*/) const override {
     return false;
   }
+
+  MOCK_METHOD(void, OnIdleMemoryReclaim, (), (override));
 };
 
 class MockQuicConnectionHelper : public QuicConnectionHelperInterface {
@@ -1182,6 +1184,8 @@ class MockSendAlgorithm : public SendAlgorithmInterface {
                QuicTime event_time, const AckedPacketVector& acked_packets,
                const LostPacketVector& lost_packets),
               (override));
+  MOCK_METHOD(void, OnEcnFeedback, (QuicPacketCount newly_ce_marked_packets),
+              (override));
   MOCK_METHOD(void, OnPacketSent,
               (QuicTime, QuicByteCount, QuicPacketNumber, QuicByteCount,
                HasRetransmittableData),
@@ -1643,6 +1647,8 @@ class TaggingEncrypter : public QuicEncrypter {
     return absl::string_view();
   }
 
+  absl::string_view GetIV() const override { return absl::string_view(); }
+
  private:
   enum {
     kTagSize = 12,
@@ -1695,6 +1701,7 @@ class TaggingDecrypter : public QuicDecrypter {
   absl::string_view GetNoncePrefix() const override {
     return absl::string_view();
   }
+  absl::string_view GetIV() const override { return absl::string_view(); }
   // Use a distinct value starting with 0xFFFFFF, which is never used by TLS.
   uint32_t cipher_id() const override { return 0xFFFFFFF0; }
   QuicPacketCount GetIntegrityLimit() const override {
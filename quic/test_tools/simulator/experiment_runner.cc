@@ -0,0 +1,108 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/test_tools/simulator/experiment_runner.h"
+
+#include <utility>
+
+#include "quic/platform/api/quic_bug_tracker.h"
+#include "quic/platform/api/quic_logging.h"
+#include "quic/test_tools/quic_test_utils.h"
+
+namespace quic {
+namespace simulator {
+
+class ExperimentRunner::Worker : public QuicThread {
+ public:
+  Worker(ExperimentRunner* runner, size_t worker_index)
+      : QuicThread("experiment_worker"),
+        runner_(runner),
+        worker_index_(worker_index) {}
+
+ protected:
+  void Run() override { runner_->WorkerLoop(worker_index_); }
+
+ private:
+  ExperimentRunner* runner_;
+  const size_t worker_index_;
+};
+
+ExperimentRunner::ExperimentRunner(size_t num_threads)
+    : num_threads_(num_threads) {
+  QUIC_BUG_IF(quic_bug_experiment_runner_no_threads, num_threads == 0)
+      << "ExperimentRunner requires at least one worker thread.";
+  for (size_t i = 0; i < num_threads_; ++i) {
+    queue_mutexes_.push_back(std::make_unique<QuicMutex>());
+    queues_.emplace_back();
+  }
+}
+
+ExperimentRunner::~ExperimentRunner() = default;
+
+void ExperimentRunner::AddExperiment(std::string name, Experiment experiment) {
+  experiments_.push_back(
+      PendingExperiment{std::move(name), std::move(experiment)});
+}
+
+std::vector<ExperimentRunner::Result> ExperimentRunner::RunAll(
+    uint64_t base_seed) {
+  base_seed_ = base_seed;
+  results_.clear();
+  results_.resize(experiments_.size());
+
+  // Distribute tasks round-robin; stealing rebalances skewed durations.
+  for (size_t i = 0; i < experiments_.size(); ++i) {
+    queues_[i % num_threads_].push_back(i);
+  }
+
+  std::vector<std::unique_ptr<Worker>> workers;
+  for (size_t i = 0; i < num_threads_; ++i) {
+    workers.push_back(std::make_unique<Worker>(this, i));
+    workers.back()->Start();
+  }
+  for (std::unique_ptr<Worker>& worker : workers) {
+    worker->Join();
+  }
+
+  experiments_.clear();
+  return std::move(results_);
+}
+
+void ExperimentRunner::WorkerLoop(size_t worker_index) {
+  size_t task_index;
+  while (NextTask(worker_index, &task_index)) {
+    // Derive the experiment's seed from its position, not the executing
+    // worker, so results do not depend on scheduling.
+    test::SimpleRandom random;
+    random.set_seed(base_seed_ + task_index);
+    results_[task_index].name = experiments_[task_index].name;
+    results_[task_index].value = experiments_[task_index].experiment(&random);
+  }
+}
+
+bool ExperimentRunner::NextTask(size_t worker_index, size_t* task_index) {
+  {
+    QuicWriterMutexLock lock(queue_mutexes_[worker_index].get());
+    if (!queues_[worker_index].empty()) {
+      *task_index = queues_[worker_index].front();
+      queues_[worker_index].pop_front();
+      return true;
+    }
+  }
+
+  // Own queue is empty; steal from the back of the next non-empty queue.
+  for (size_t offset = 1; offset < num_threads_; ++offset) {
+    const size_t victim = (worker_index + offset) % num_threads_;
+    QuicWriterMutexLock lock(queue_mutexes_[victim].get());
+    if (!queues_[victim].empty()) {
+      *task_index = queues_[victim].back();
+      queues_[victim].pop_back();
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace simulator
+}  // namespace quic
@@ -0,0 +1,91 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_TEST_TOOLS_SIMULATOR_EXPERIMENT_RUNNER_H_
+#define QUICHE_QUIC_TEST_TOOLS_SIMULATOR_EXPERIMENT_RUNNER_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "quic/core/crypto/quic_random.h"
+#include "quic/platform/api/quic_mutex.h"
+#include "quic/platform/api/quic_thread.h"
+#include "common/quiche_circular_deque.h"
+
+namespace quic {
+namespace simulator {
+
+// Runs a batch of independent simulation experiments (e.g. a congestion
+// control parameter sweep) across a pool of worker threads.  Each experiment
+// constructs its own Simulator, so no simulation state is shared between
+// workers; any topology description captured by the experiment callbacks must
+// be read-only.  Every experiment receives a deterministically seeded random
+// generator derived from the batch seed and the experiment's position, so a
+// sweep produces identical results regardless of thread count or scheduling.
+//
+// Workers drain their own queue first and steal from other workers when it
+// runs dry, which keeps all cores busy even when experiment durations are
+// highly skewed.
+class ExperimentRunner {
+ public:
+  // An experiment body.  |random| is owned by the runner and is valid only
+  // for the duration of the call.  The returned string is the experiment's
+  // result, collected verbatim.
+  using Experiment = std::function<std::string(QuicRandom* random)>;
+
+  struct Result {
+    std::string name;
+    std::string value;
+  };
+
+  // Creates a runner with |num_threads| workers; |num_threads| must be at
+  // least one.
+  explicit ExperimentRunner(size_t num_threads);
+  ExperimentRunner(const ExperimentRunner&) = delete;
+  ExperimentRunner& operator=(const ExperimentRunner&) = delete;
+  ~ExperimentRunner();
+
+  // Registers an experiment.  All experiments must be added before RunAll().
+  void AddExperiment(std::string name, Experiment experiment);
+
+  // Runs all registered experiments and blocks until they complete.  Returns
+  // results in registration order.  The runner can be reused for further
+  // batches after this returns.
+  std::vector<Result> RunAll(uint64_t base_seed);
+
+ private:
+  class Worker;
+
+  struct PendingExperiment {
+    std::string name;
+    Experiment experiment;
+  };
+
+  // Executed on each worker thread: drains the worker's queue, then steals.
+  void WorkerLoop(size_t worker_index);
+
+  // Pops the next experiment index from |worker_index|'s own queue, or steals
+  // one from another worker's queue.  Returns false when no work is left
+  // anywhere.
+  bool NextTask(size_t worker_index, size_t* task_index);
+
+  const size_t num_threads_;
+  std::vector<PendingExperiment> experiments_;
+
+  // Per-worker task queues; queues_[i] is guarded by queue_mutexes_[i].
+  std::vector<std::unique_ptr<QuicMutex>> queue_mutexes_;
+  std::vector<quiche::QuicheCircularDeque<size_t>> queues_;
+
+  // Written by workers, one slot per experiment; slots are disjoint so no
+  // locking is required.
+  std::vector<Result> results_;
+  uint64_t base_seed_ = 0;
+};
+
+}  // namespace simulator
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_TEST_TOOLS_SIMULATOR_EXPERIMENT_RUNNER_H_
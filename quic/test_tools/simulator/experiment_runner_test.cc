@@ -0,0 +1,91 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/test_tools/simulator/experiment_runner.h"
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "quic/platform/api/quic_test.h"
+#include "quic/test_tools/simulator/simulator.h"
+
+namespace quic {
+namespace simulator {
+
+class ExperimentRunnerTest : public QuicTest {};
+
+// The same batch must produce identical results regardless of how many
+// workers execute it.
+TEST_F(ExperimentRunnerTest, DeterministicAcrossThreadCounts) {
+  constexpr size_t kNumExperiments = 12;
+  constexpr uint64_t kBaseSeed = 42;
+
+  auto run_with_threads = [](size_t num_threads) {
+    ExperimentRunner runner(num_threads);
+    for (size_t i = 0; i < kNumExperiments; ++i) {
+      runner.AddExperiment(absl::StrCat("experiment-", i),
+                           [](QuicRandom* random) {
+                             return absl::StrCat(random->RandUint64());
+                           });
+    }
+    return runner.RunAll(kBaseSeed);
+  };
+
+  std::vector<ExperimentRunner::Result> serial = run_with_threads(1);
+  std::vector<ExperimentRunner::Result> parallel = run_with_threads(4);
+
+  ASSERT_EQ(kNumExperiments, serial.size());
+  ASSERT_EQ(kNumExperiments, parallel.size());
+  for (size_t i = 0; i < kNumExperiments; ++i) {
+    EXPECT_EQ(serial[i].name, absl::StrCat("experiment-", i));
+    EXPECT_EQ(serial[i].name, parallel[i].name);
+    EXPECT_EQ(serial[i].value, parallel[i].value);
+  }
+}
+
+// Each experiment owns an independent Simulator instance.
+TEST_F(ExperimentRunnerTest, RunsIndependentSimulators) {
+  constexpr size_t kNumExperiments = 8;
+
+  ExperimentRunner runner(3);
+  for (size_t i = 0; i < kNumExperiments; ++i) {
+    const QuicTime::Delta duration = QuicTime::Delta::FromMilliseconds(i + 1);
+    runner.AddExperiment(absl::StrCat("sim-", i),
+                         [duration](QuicRandom* random) {
+                           Simulator simulator(random);
+                           simulator.RunFor(duration);
+                           return absl::StrCat(
+                               (simulator.GetClock()->Now() - QuicTime::Zero())
+                                   .ToMilliseconds());
+                         });
+  }
+
+  std::vector<ExperimentRunner::Result> results = runner.RunAll(1);
+  ASSERT_EQ(kNumExperiments, results.size());
+  for (size_t i = 0; i < kNumExperiments; ++i) {
+    EXPECT_EQ(absl::StrCat(i + 1), results[i].value);
+  }
+}
+
+// More experiments than workers: stealing must drain every queue.
+TEST_F(ExperimentRunnerTest, AllTasksCompleteWithFewerThreadsThanTasks) {
+  constexpr size_t kNumExperiments = 17;
+
+  ExperimentRunner runner(2);
+  for (size_t i = 0; i < kNumExperiments; ++i) {
+    runner.AddExperiment(absl::StrCat("task-", i), [](QuicRandom* /*random*/) {
+      return std::string("done");
+    });
+  }
+
+  std::vector<ExperimentRunner::Result> results = runner.RunAll(7);
+  ASSERT_EQ(kNumExperiments, results.size());
+  for (const ExperimentRunner::Result& result : results) {
+    EXPECT_EQ("done", result.value);
+  }
+}
+
+}  // namespace simulator
+}  // namespace quic
@@ -116,6 +116,7 @@ class QuicEndpoint : public QuicEndpointBase,
       const QuicSocketAddress& /*address*/) const override {
     return false;
   }
+  void OnIdleMemoryReclaim() override {}
 
   // End QuicConnectionVisitorInterface implementation.
 
@@ -0,0 +1,287 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/test_tools/simulator/trace_replay.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "quic/core/quic_connection.h"
+#include "quic/platform/api/quic_logging.h"
+#include "quic/test_tools/quic_connection_peer.h"
+#include "quic/test_tools/quic_test_utils.h"
+#include "quic/test_tools/simulator/packet_filter.h"
+#include "quic/test_tools/simulator/quic_endpoint.h"
+#include "quic/test_tools/simulator/simulator.h"
+#include "quic/test_tools/simulator/switch.h"
+
+namespace quic {
+namespace simulator {
+
+namespace {
+
+// Mirrors the local (non-bottleneck) link parameters used by the
+// congestion control simulation tests.
+const QuicBandwidth kLocalLinkBandwidth =
+    QuicBandwidth::FromKBitsPerSecond(10000000);
+const QuicTime::Delta kLocalPropagationDelay =
+    QuicTime::Delta::FromMilliseconds(1);
+
+std::string CongestionControlName(CongestionControlType type) {
+  switch (type) {
+    case kCubicBytes:
+      return "cubic-bytes";
+    case kRenoBytes:
+      return "reno-bytes";
+    case kBBR:
+      return "bbr";
+    case kPCC:
+      return "pcc";
+    case kGoogCC:
+      return "googcc";
+    case kBBRv2:
+      return "bbr2";
+  }
+  return "unknown";
+}
+
+// Drops packets entering the bottleneck according to the loss rate of the
+// trace segment currently in effect.
+class TraceLossFilter : public PacketFilter {
+ public:
+  TraceLossFilter(Simulator* simulator, std::string name, Endpoint* input)
+      : PacketFilter(simulator, std::move(name), input) {}
+
+  void set_loss_rate(double loss_rate) { loss_rate_ = loss_rate; }
+
+ protected:
+  bool FilterPacket(const Packet& /*packet*/) override {
+    if (loss_rate_ <= 0) {
+      return true;
+    }
+    return simulator_->GetRandomGenerator()->RandUint64() % 1000000 >=
+           static_cast<uint64_t>(loss_rate_ * 1000000);
+  }
+
+ private:
+  double loss_rate_ = 0.0;
+};
+
+// Walks the trace, applying each segment's bandwidth, delay and loss rate
+// to the bottleneck at the segment's start time.
+class TraceScheduler : public Actor {
+ public:
+  TraceScheduler(Simulator* simulator,
+                 const NetworkTrace* trace,
+                 TraceDrivenLink* forward_link,
+                 TraceDrivenLink* reverse_link,
+                 TraceLossFilter* loss_filter)
+      : Actor(simulator, "Trace scheduler"),
+        trace_(trace),
+        forward_link_(forward_link),
+        reverse_link_(reverse_link),
+        loss_filter_(loss_filter),
+        min_rtt_(trace->MinRtt()) {
+    Schedule(clock_->Now());
+  }
+
+  void Act() override {
+    if (next_segment_ >= trace_->segments.size()) {
+      return;
+    }
+    const NetworkTraceSegment& segment = trace_->segments[next_segment_];
+    ++next_segment_;
+    // The base propagation delay realizes the trace's minimum RTT; the
+    // excess of the current segment is split across the two directions.
+    const QuicTime::Delta extra_delay = (segment.rtt - min_rtt_) * 0.5;
+    forward_link_->set_bandwidth(segment.bandwidth);
+    reverse_link_->set_bandwidth(segment.bandwidth);
+    forward_link_->set_extra_delay(extra_delay);
+    reverse_link_->set_extra_delay(extra_delay);
+    loss_filter_->set_loss_rate(segment.loss_rate);
+    if (next_segment_ < trace_->segments.size()) {
+      Schedule(clock_->Now() + segment.duration);
+    }
+  }
+
+ private:
+  const NetworkTrace* trace_;
+  TraceDrivenLink* forward_link_;
+  TraceDrivenLink* reverse_link_;
+  TraceLossFilter* loss_filter_;
+  const QuicTime::Delta min_rtt_;
+  size_t next_segment_ = 0;
+};
+
+}  // namespace
+
+// static
+bool NetworkTrace::ParseFromString(absl::string_view text,
+                                   NetworkTrace* trace) {
+  trace->segments.clear();
+  for (absl::string_view line : absl::StrSplit(text, '\n')) {
+    const size_t comment = line.find('#');
+    if (comment != absl::string_view::npos) {
+      line = line.substr(0, comment);
+    }
+    std::vector<absl::string_view> fields =
+        absl::StrSplit(line, ' ', absl::SkipEmpty());
+    if (fields.empty()) {
+      continue;
+    }
+    int64_t duration_ms;
+    int64_t bandwidth_kbps;
+    int64_t rtt_ms;
+    double loss_rate;
+    if (fields.size() != 4 || !absl::SimpleAtoi(fields[0], &duration_ms) ||
+        !absl::SimpleAtoi(fields[1], &bandwidth_kbps) ||
+        !absl::SimpleAtoi(fields[2], &rtt_ms) ||
+        !absl::SimpleAtod(fields[3], &loss_rate) || duration_ms <= 0 ||
+        bandwidth_kbps <= 0 || rtt_ms <= 0 || loss_rate < 0 ||
+        loss_rate >= 1) {
+      QUIC_LOG(ERROR) << "Malformed trace line: \"" << line << "\"";
+      return false;
+    }
+    NetworkTraceSegment segment;
+    segment.duration = QuicTime::Delta::FromMilliseconds(duration_ms);
+    segment.bandwidth = QuicBandwidth::FromKBitsPerSecond(bandwidth_kbps);
+    segment.rtt = QuicTime::Delta::FromMilliseconds(rtt_ms);
+    segment.loss_rate = loss_rate;
+    trace->segments.push_back(segment);
+  }
+  return !trace->segments.empty();
+}
+
+QuicTime::Delta NetworkTrace::TotalDuration() const {
+  QuicTime::Delta total = QuicTime::Delta::Zero();
+  for (const NetworkTraceSegment& segment : segments) {
+    total = total + segment.duration;
+  }
+  return total;
+}
+
+QuicTime::Delta NetworkTrace::MinRtt() const {
+  QuicTime::Delta min_rtt = QuicTime::Delta::Infinite();
+  for (const NetworkTraceSegment& segment : segments) {
+    min_rtt = std::min(min_rtt, segment.rtt);
+  }
+  return min_rtt;
+}
+
+QuicBandwidth NetworkTrace::MaxBandwidth() const {
+  QuicBandwidth max_bandwidth = QuicBandwidth::Zero();
+  for (const NetworkTraceSegment& segment : segments) {
+    max_bandwidth = std::max(max_bandwidth, segment.bandwidth);
+  }
+  return max_bandwidth;
+}
+
+TraceDrivenLink::TraceDrivenLink(Simulator* simulator,
+                                 std::string name,
+                                 UnconstrainedPortInterface* sink,
+                                 QuicBandwidth bandwidth,
+                                 QuicTime::Delta propagation_delay)
+    : OneWayLink(simulator,
+                 std::move(name),
+                 sink,
+                 bandwidth,
+                 propagation_delay) {}
+
+QuicTime::Delta TraceDrivenLink::GetRandomDelay(
+    QuicTime::Delta transfer_time) {
+  return OneWayLink::GetRandomDelay(transfer_time) + extra_delay_;
+}
+
+std::string TraceReplayScorecard::ToString() const {
+  return absl::StrCat(algorithm, ": goodput=", average_goodput.ToDebugValue(),
+                      " srtt=", smoothed_rtt.ToDebugValue(),
+                      " min_rtt=", min_rtt.ToDebugValue(),
+                      " bytes=", bytes_delivered, " lost=", packets_lost);
+}
+
+TraceReplayScorecard ReplayTrace(
+    const NetworkTrace& trace,
+    CongestionControlType congestion_control_type,
+    uint64_t seed) {
+  QUICHE_DCHECK(!trace.segments.empty());
+  test::SimpleRandom random;
+  random.set_seed(seed);
+  Simulator simulator(&random);
+
+  QuicEndpoint sender(&simulator, "Sender", "Receiver", Perspective::IS_CLIENT,
+                      test::TestConnectionId(42));
+  QuicEndpoint receiver(&simulator, "Receiver", "Sender",
+                        Perspective::IS_SERVER, test::TestConnectionId(42));
+  test::QuicConnectionPeer::GetSentPacketManager(sender.connection())
+      ->SetSendAlgorithm(congestion_control_type);
+
+  // Size the switch queue off the largest bandwidth-delay product the trace
+  // reaches, as the congestion control simulation tests do.
+  QuicTime::Delta max_rtt = QuicTime::Delta::Zero();
+  for (const NetworkTraceSegment& segment : trace.segments) {
+    max_rtt = std::max(max_rtt, segment.rtt);
+  }
+  const QuicByteCount max_bdp = max_rtt * trace.MaxBandwidth();
+  Switch network_switch(&simulator, "Switch", /*port_count=*/8,
+                        /*queue_capacity=*/2 * max_bdp);
+
+  TraceLossFilter loss_filter(&simulator, "Loss filter", &sender);
+  SymmetricLink local_link(&loss_filter, network_switch.port(1),
+                           kLocalLinkBandwidth, kLocalPropagationDelay);
+
+  // The bottleneck pair realizes the trace's minimum RTT through its base
+  // propagation delay; TraceScheduler layers per-segment excess on top.
+  const QuicTime::Delta bottleneck_delay =
+      std::max(trace.MinRtt() * 0.5 - kLocalPropagationDelay,
+               QuicTime::Delta::FromMicroseconds(1));
+  TraceDrivenLink forward_link(&simulator, "Bottleneck (to receiver)",
+                               receiver.GetRxPort(),
+                               trace.segments[0].bandwidth, bottleneck_delay);
+  TraceDrivenLink reverse_link(
+      &simulator, "Bottleneck (to switch)",
+      network_switch.port(2)->GetRxPort(), trace.segments[0].bandwidth,
+      bottleneck_delay);
+  network_switch.port(2)->SetTxPort(&forward_link);
+  receiver.SetTxPort(&reverse_link);
+
+  TraceScheduler scheduler(&simulator, &trace, &forward_link, &reverse_link,
+                           &loss_filter);
+
+  // Saturate the path for the whole trace.
+  sender.AddBytesToTransfer(2 *
+                            (trace.TotalDuration() * trace.MaxBandwidth()));
+  simulator.RunFor(trace.TotalDuration());
+
+  TraceReplayScorecard scorecard;
+  scorecard.algorithm = CongestionControlName(congestion_control_type);
+  scorecard.bytes_delivered = receiver.bytes_received();
+  scorecard.average_goodput = QuicBandwidth::FromBytesAndTimeDelta(
+      scorecard.bytes_delivered, trace.TotalDuration());
+  const RttStats* rtt_stats =
+      sender.connection()->sent_packet_manager().GetRttStats();
+  scorecard.smoothed_rtt = rtt_stats->smoothed_rtt();
+  scorecard.min_rtt = rtt_stats->min_rtt();
+  scorecard.packets_lost = sender.connection()->GetStats().packets_lost;
+  return scorecard;
+}
+
+std::string CompareCongestionControllers(
+    const NetworkTrace& trace,
+    const std::vector<CongestionControlType>& algorithms,
+    uint64_t seed) {
+  std::string result;
+  for (CongestionControlType algorithm : algorithms) {
+    absl::StrAppend(&result, ReplayTrace(trace, algorithm, seed).ToString(),
+                    "\n");
+  }
+  return result;
+}
+
+}  // namespace simulator
+}  // namespace quic
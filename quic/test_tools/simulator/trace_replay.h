@@ -0,0 +1,102 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_TEST_TOOLS_SIMULATOR_TRACE_REPLAY_H_
+#define QUICHE_QUIC_TEST_TOOLS_SIMULATOR_TRACE_REPLAY_H_
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "quic/core/quic_bandwidth.h"
+#include "quic/core/quic_time.h"
+#include "quic/core/quic_types.h"
+#include "quic/test_tools/simulator/link.h"
+
+namespace quic {
+namespace simulator {
+
+// One segment of captured path conditions: for |duration|, the path
+// offered |bandwidth|, a round-trip propagation delay of |rtt| and a
+// random loss rate of |loss_rate|.
+struct NetworkTraceSegment {
+  QuicTime::Delta duration = QuicTime::Delta::Zero();
+  QuicBandwidth bandwidth = QuicBandwidth::Zero();
+  QuicTime::Delta rtt = QuicTime::Delta::Zero();
+  // Fraction of packets dropped, in [0, 1).
+  double loss_rate = 0.0;
+};
+
+// A captured network trace as a sequence of path-condition segments.
+struct NetworkTrace {
+  std::vector<NetworkTraceSegment> segments;
+
+  // Parses a trace in the captured text format: one segment per line,
+  //   <duration_ms> <bandwidth_kbps> <rtt_ms> <loss_rate>
+  // with '#' starting a comment and blank lines ignored. Returns false if
+  // any line is malformed or the trace ends up empty.
+  static bool ParseFromString(absl::string_view text, NetworkTrace* trace);
+
+  QuicTime::Delta TotalDuration() const;
+  QuicTime::Delta MinRtt() const;
+  QuicBandwidth MaxBandwidth() const;
+};
+
+// A OneWayLink whose delay can be raised above its base propagation delay,
+// so a replayed trace can vary the path RTT mid-run (the link bandwidth is
+// already mutable via set_bandwidth()).
+class TraceDrivenLink : public OneWayLink {
+ public:
+  TraceDrivenLink(Simulator* simulator,
+                  std::string name,
+                  UnconstrainedPortInterface* sink,
+                  QuicBandwidth bandwidth,
+                  QuicTime::Delta propagation_delay);
+
+  // Sets the delay added on top of the base propagation delay.
+  void set_extra_delay(QuicTime::Delta extra_delay) {
+    extra_delay_ = extra_delay;
+  }
+
+ protected:
+  QuicTime::Delta GetRandomDelay(QuicTime::Delta transfer_time) override;
+
+ private:
+  QuicTime::Delta extra_delay_ = QuicTime::Delta::Zero();
+};
+
+// Summary of one replay, comparable across congestion control variants.
+struct TraceReplayScorecard {
+  std::string algorithm;
+  QuicBandwidth average_goodput = QuicBandwidth::Zero();
+  QuicTime::Delta smoothed_rtt = QuicTime::Delta::Zero();
+  QuicTime::Delta min_rtt = QuicTime::Delta::Zero();
+  QuicByteCount bytes_delivered = 0;
+  QuicPacketCount packets_lost = 0;
+
+  std::string ToString() const;
+};
+
+// Replays a captured trace against a congestion control algorithm: builds a
+// sender -> switch -> receiver topology whose bottleneck link follows the
+// trace's bandwidth, RTT and loss schedule, runs a saturating transfer for
+// the trace's duration, and reports a scorecard. Each call builds a fresh
+// Simulator seeded with |seed|, so replays are deterministic and
+// independent.
+TraceReplayScorecard ReplayTrace(const NetworkTrace& trace,
+                                 CongestionControlType congestion_control_type,
+                                 uint64_t seed);
+
+// Replays |trace| once per algorithm with the same seed and returns the
+// scorecards, one ToString() line per algorithm, for side-by-side
+// comparison.
+std::string CompareCongestionControllers(
+    const NetworkTrace& trace,
+    const std::vector<CongestionControlType>& algorithms,
+    uint64_t seed);
+
+}  // namespace simulator
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_TEST_TOOLS_SIMULATOR_TRACE_REPLAY_H_
@@ -0,0 +1,96 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/test_tools/simulator/trace_replay.h"
+
+#include <string>
+#include <vector>
+
+#include "quic/platform/api/quic_test.h"
+
+namespace quic {
+namespace simulator {
+namespace {
+
+class TraceReplayTest : public QuicTest {};
+
+TEST_F(TraceReplayTest, ParseTrace) {
+  NetworkTrace trace;
+  ASSERT_TRUE(NetworkTrace::ParseFromString(
+      "# A wireless path with a mid-transfer dip.\n"
+      "2000 10000 40 0\n"
+      "1000 2000 80 0.02  # the dip\n"
+      "\n"
+      "2000 10000 40 0\n",
+      &trace));
+  ASSERT_EQ(3u, trace.segments.size());
+  EXPECT_EQ(QuicTime::Delta::FromSeconds(2), trace.segments[0].duration);
+  EXPECT_EQ(QuicBandwidth::FromKBitsPerSecond(2000),
+            trace.segments[1].bandwidth);
+  EXPECT_EQ(QuicTime::Delta::FromMilliseconds(80), trace.segments[1].rtt);
+  EXPECT_EQ(0.02, trace.segments[1].loss_rate);
+  EXPECT_EQ(QuicTime::Delta::FromSeconds(5), trace.TotalDuration());
+  EXPECT_EQ(QuicTime::Delta::FromMilliseconds(40), trace.MinRtt());
+  EXPECT_EQ(QuicBandwidth::FromKBitsPerSecond(10000), trace.MaxBandwidth());
+}
+
+TEST_F(TraceReplayTest, ParseRejectsMalformedTraces) {
+  NetworkTrace trace;
+  EXPECT_FALSE(NetworkTrace::ParseFromString("", &trace));
+  EXPECT_FALSE(NetworkTrace::ParseFromString("# only comments\n", &trace));
+  EXPECT_FALSE(NetworkTrace::ParseFromString("1000 10000 40\n", &trace));
+  EXPECT_FALSE(NetworkTrace::ParseFromString("1000 10000 40 junk\n", &trace));
+  EXPECT_FALSE(NetworkTrace::ParseFromString("1000 10000 40 1.5\n", &trace));
+  EXPECT_FALSE(NetworkTrace::ParseFromString("-5 10000 40 0\n", &trace));
+}
+
+TEST_F(TraceReplayTest, ReplayReachesTraceBandwidth) {
+  NetworkTrace trace;
+  ASSERT_TRUE(NetworkTrace::ParseFromString("4000 10000 40 0\n", &trace));
+  TraceReplayScorecard scorecard = ReplayTrace(trace, kBBR, /*seed=*/1);
+
+  // The transfer should fill a clean 10 Mbps path to within startup and
+  // framing overheads.
+  EXPECT_GE(scorecard.average_goodput,
+            trace.segments[0].bandwidth * 0.5);
+  EXPECT_LE(scorecard.average_goodput,
+            trace.segments[0].bandwidth * 1.05);
+  EXPECT_GE(scorecard.min_rtt, QuicTime::Delta::FromMilliseconds(40));
+  EXPECT_LE(scorecard.min_rtt, QuicTime::Delta::FromMilliseconds(60));
+  EXPECT_EQ("bbr", scorecard.algorithm);
+}
+
+TEST_F(TraceReplayTest, ReplayAppliesTraceLoss) {
+  NetworkTrace trace;
+  ASSERT_TRUE(NetworkTrace::ParseFromString("3000 10000 40 0.05\n", &trace));
+  TraceReplayScorecard scorecard = ReplayTrace(trace, kCubicBytes,
+                                               /*seed=*/1);
+  EXPECT_GT(scorecard.packets_lost, 0u);
+  EXPECT_GT(scorecard.bytes_delivered, 0u);
+}
+
+TEST_F(TraceReplayTest, ReplayIsDeterministic) {
+  NetworkTrace trace;
+  ASSERT_TRUE(NetworkTrace::ParseFromString(
+      "1000 10000 40 0\n"
+      "1000 2000 80 0.01\n",
+      &trace));
+  TraceReplayScorecard first = ReplayTrace(trace, kBBRv2, /*seed=*/7);
+  TraceReplayScorecard second = ReplayTrace(trace, kBBRv2, /*seed=*/7);
+  EXPECT_EQ(first.ToString(), second.ToString());
+}
+
+TEST_F(TraceReplayTest, CompareEmitsOneScorecardPerAlgorithm) {
+  NetworkTrace trace;
+  ASSERT_TRUE(NetworkTrace::ParseFromString("2000 5000 50 0\n", &trace));
+  const std::string comparison = CompareCongestionControllers(
+      trace, {kCubicBytes, kBBR, kBBRv2}, /*seed=*/3);
+  EXPECT_NE(std::string::npos, comparison.find("cubic-bytes: "));
+  EXPECT_NE(std::string::npos, comparison.find("bbr: "));
+  EXPECT_NE(std::string::npos, comparison.find("bbr2: "));
+}
+
+}  // namespace
+}  // namespace simulator
+}  // namespace quic
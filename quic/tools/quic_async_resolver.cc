@@ -0,0 +1,138 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/tools/quic_async_resolver.h"
+
+#include <sys/socket.h>
+
+#include <utility>
+
+#include "quic/platform/api/quic_logging.h"
+#include "quic/tools/quic_client.h"
+
+namespace quic {
+
+QuicAsyncResolver::QuicAsyncResolver(size_t num_workers)
+    : QuicAsyncResolver(
+          num_workers,
+          [](int address_family, std::string host, std::string port) {
+            return tools::LookupAddress(address_family, std::move(host),
+                                        std::move(port));
+          }) {}
+
+QuicAsyncResolver::QuicAsyncResolver(size_t num_workers, LookupFunction lookup)
+    : lookup_(std::move(lookup)) {
+  QUICHE_DCHECK_LT(0u, num_workers);
+  for (size_t i = 0; i < num_workers; ++i) {
+    workers_.push_back(std::make_unique<Worker>(this));
+    workers_.back()->Start();
+  }
+}
+
+QuicAsyncResolver::~QuicAsyncResolver() {
+  quiche::QuicheCircularDeque<LookupTask> unstarted_tasks;
+  {
+    std::lock_guard<std::mutex> lock(task_mutex_);
+    stopping_ = true;
+    unstarted_tasks.swap(tasks_);
+  }
+  task_available_.notify_all();
+  for (auto& worker : workers_) {
+    worker->Join();
+  }
+  // Fail lookups that never reached a worker, and deliver everything the
+  // workers finished. Both run on this (the event-loop) thread, matching
+  // what callers expect.
+  while (!unstarted_tasks.empty()) {
+    OnLookupComplete(std::move(unstarted_tasks.front().request),
+                     QuicSocketAddress());
+    unstarted_tasks.pop_front();
+  }
+  ProcessCompletions();
+}
+
+void QuicAsyncResolver::AttachEpollServer(QuicEpollServer* epoll_server) {
+  epoll_server_ = epoll_server;
+}
+
+void QuicAsyncResolver::Resolve(std::string host,
+                                std::string port,
+                                std::unique_ptr<Callback> callback) {
+  auto request = std::make_shared<Request>();
+  request->callback = std::move(callback);
+  request->lookups_remaining = 2;
+  {
+    std::lock_guard<std::mutex> lock(task_mutex_);
+    if (stopping_) {
+      // Shutting down; fail synchronously.
+      request->callback->OnResolutionComplete({});
+      return;
+    }
+    // AAAA first so that on an idle pool IPv6 gets the head start, as
+    // happy-eyeballs prefers.
+    tasks_.push_back(LookupTask{AF_INET6, host, port, request});
+    tasks_.push_back(LookupTask{AF_INET, std::move(host), std::move(port),
+                                std::move(request)});
+  }
+  task_available_.notify_all();
+}
+
+size_t QuicAsyncResolver::ProcessCompletions() {
+  std::vector<Completion> completions;
+  {
+    std::lock_guard<std::mutex> lock(completion_mutex_);
+    completions.swap(completions_);
+  }
+  size_t delivered = 0;
+  for (Completion& completion : completions) {
+    Request& request = *completion.request;
+    QUICHE_DCHECK_LT(0u, request.lookups_remaining);
+    --request.lookups_remaining;
+    if (completion.address.IsInitialized()) {
+      request.addresses.push_back(completion.address);
+      if (!request.first_delivered) {
+        request.first_delivered = true;
+        request.callback->OnFirstAddress(completion.address);
+      }
+    }
+    if (request.lookups_remaining == 0) {
+      request.callback->OnResolutionComplete(std::move(request.addresses));
+      ++delivered;
+    }
+  }
+  return delivered;
+}
+
+void QuicAsyncResolver::WorkerLoop() {
+  while (true) {
+    LookupTask task;
+    {
+      std::unique_lock<std::mutex> lock(task_mutex_);
+      task_available_.wait(lock,
+                           [this]() { return stopping_ || !tasks_.empty(); });
+      if (stopping_) {
+        return;
+      }
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+    OnLookupComplete(
+        std::move(task.request),
+        lookup_(task.address_family, std::move(task.host),
+                std::move(task.port)));
+  }
+}
+
+void QuicAsyncResolver::OnLookupComplete(std::shared_ptr<Request> request,
+                                         QuicSocketAddress address) {
+  {
+    std::lock_guard<std::mutex> lock(completion_mutex_);
+    completions_.push_back(Completion{std::move(request), address});
+  }
+  if (epoll_server_ != nullptr) {
+    epoll_server_->Wake();
+  }
+}
+
+}  // namespace quic
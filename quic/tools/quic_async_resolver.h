@@ -0,0 +1,140 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_TOOLS_QUIC_ASYNC_RESOLVER_H_
+#define QUICHE_QUIC_TOOLS_QUIC_ASYNC_RESOLVER_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "quic/platform/api/quic_epoll.h"
+#include "quic/platform/api/quic_export.h"
+#include "quic/platform/api/quic_socket_address.h"
+#include "quic/platform/api/quic_thread.h"
+#include "common/quiche_circular_deque.h"
+
+namespace quic {
+
+// Resolves host names off the event-loop thread on a pool of workers, so a
+// client launching many connections is never serialized behind a slow
+// resolver. Each Resolve() dispatches the IPv6 and IPv4 lookups to separate
+// workers in parallel, happy-eyeballs style: the callback learns the first
+// address the moment either family resolves (so the caller can send its
+// Initial packet immediately) and receives the full address list once the
+// slower family finishes, for fallback.
+//
+// Results are posted to a completion queue, waking the attached epoll server.
+// The event-loop thread must drain the queue by calling ProcessCompletions(),
+// which runs the callbacks there.
+class QuicAsyncResolver {
+ public:
+  class Callback {
+   public:
+    virtual ~Callback() = default;
+
+    // Called as soon as the first address family resolves; the other family
+    // may still be in flight. Not called if no lookup succeeds.
+    virtual void OnFirstAddress(const QuicSocketAddress& address) = 0;
+
+    // Called once both lookups have finished. |addresses| lists every
+    // resolved address in arrival order, so addresses.front() is the address
+    // previously passed to OnFirstAddress. Empty if resolution failed.
+    virtual void OnResolutionComplete(
+        std::vector<QuicSocketAddress> addresses) = 0;
+  };
+
+  // Performs one blocking lookup, tools::LookupAddress-style: returns an
+  // uninitialized address on failure.
+  using LookupFunction = std::function<QuicSocketAddress(
+      int address_family, std::string host, std::string port)>;
+
+  // Starts |num_workers| worker threads resolving via tools::LookupAddress.
+  explicit QuicAsyncResolver(size_t num_workers);
+  // As above with an injectable lookup, for tests.
+  QuicAsyncResolver(size_t num_workers, LookupFunction lookup);
+  QuicAsyncResolver(const QuicAsyncResolver&) = delete;
+  QuicAsyncResolver& operator=(const QuicAsyncResolver&) = delete;
+
+  // Joins the workers. Must run on the event-loop thread: lookups that never
+  // reached a worker are failed and already-resolved completions are
+  // delivered before returning.
+  ~QuicAsyncResolver();
+
+  // Attaches the event loop to wake when a lookup completes. May be nullptr,
+  // in which case the owner is responsible for polling ProcessCompletions().
+  void AttachEpollServer(QuicEpollServer* epoll_server);
+
+  // Starts resolving |host|:|port|, racing the AAAA and A lookups.
+  void Resolve(std::string host,
+               std::string port,
+               std::unique_ptr<Callback> callback);
+
+  // Runs the callbacks of all completed lookups. Must be called on the
+  // event-loop thread. Returns the number of lookups delivered.
+  size_t ProcessCompletions();
+
+ private:
+  // Shared state of one Resolve() call; both per-family lookups point at it.
+  struct QUIC_NO_EXPORT Request {
+    std::unique_ptr<Callback> callback;
+    std::vector<QuicSocketAddress> addresses;
+    size_t lookups_remaining;
+    bool first_delivered = false;
+  };
+
+  // One per-family lookup handed to a worker.
+  struct QUIC_NO_EXPORT LookupTask {
+    int address_family;
+    std::string host;
+    std::string port;
+    std::shared_ptr<Request> request;
+  };
+
+  // A finished lookup, ready to be delivered on the event-loop thread.
+  struct QUIC_NO_EXPORT Completion {
+    std::shared_ptr<Request> request;
+    QuicSocketAddress address;
+  };
+
+  class QUIC_NO_EXPORT Worker : public QuicThread {
+   public:
+    explicit Worker(QuicAsyncResolver* owner)
+        : QuicThread("quic_dns_worker"), owner_(owner) {}
+
+   protected:
+    void Run() override { owner_->WorkerLoop(); }
+
+   private:
+    QuicAsyncResolver* owner_;
+  };
+
+  // Blocks on the task queue and runs lookups until shutdown.
+  void WorkerLoop();
+
+  // Called (on a worker thread) to post one finished lookup.
+  void OnLookupComplete(std::shared_ptr<Request> request,
+                        QuicSocketAddress address);
+
+  LookupFunction lookup_;
+  QuicEpollServer* epoll_server_ = nullptr;  // Not owned.
+
+  std::mutex task_mutex_;
+  std::condition_variable task_available_;
+  quiche::QuicheCircularDeque<LookupTask> tasks_;  // Guarded by task_mutex_.
+  bool stopping_ = false;                          // Guarded by task_mutex_.
+
+  std::mutex completion_mutex_;
+  std::vector<Completion> completions_;  // Guarded by completion_mutex_.
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_TOOLS_QUIC_ASYNC_RESOLVER_H_
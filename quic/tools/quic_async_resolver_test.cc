@@ -0,0 +1,135 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/tools/quic_async_resolver.h"
+
+#include <sys/socket.h>
+
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "quic/platform/api/quic_ip_address.h"
+#include "quic/platform/api/quic_sleep.h"
+#include "quic/platform/api/quic_test.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+struct ResolutionResult {
+  bool first_received = false;
+  QuicSocketAddress first_address;
+  bool complete = false;
+  std::vector<QuicSocketAddress> addresses;
+  std::thread::id thread_id;
+};
+
+class RecordingCallback : public QuicAsyncResolver::Callback {
+ public:
+  explicit RecordingCallback(ResolutionResult* result) : result_(result) {}
+
+  void OnFirstAddress(const QuicSocketAddress& address) override {
+    result_->first_received = true;
+    result_->first_address = address;
+  }
+
+  void OnResolutionComplete(std::vector<QuicSocketAddress> addresses) override {
+    result_->complete = true;
+    result_->addresses = std::move(addresses);
+    result_->thread_id = std::this_thread::get_id();
+  }
+
+ private:
+  ResolutionResult* result_;
+};
+
+class QuicAsyncResolverTest : public QuicTest {
+ protected:
+  // Polls until at least one resolution has been delivered.
+  void WaitForResolutions(QuicAsyncResolver* resolver) {
+    while (resolver->ProcessCompletions() == 0) {
+      QuicSleep(QuicTime::Delta::FromMilliseconds(1));
+    }
+  }
+
+  const QuicSocketAddress v6_address_{QuicIpAddress::Loopback6(), 443};
+  const QuicSocketAddress v4_address_{QuicIpAddress::Loopback4(), 443};
+};
+
+TEST_F(QuicAsyncResolverTest, FirstAddressArrivesBeforeSlowFamily) {
+  // The v4 lookup stalls until the test releases it, so the v6 address must
+  // be surfaced on its own first.
+  std::promise<void> release_v4;
+  std::shared_future<void> v4_unblocked(release_v4.get_future());
+  QuicAsyncResolver resolver(
+      /*num_workers=*/2,
+      [this, v4_unblocked](int address_family, std::string /*host*/,
+                           std::string /*port*/) {
+        if (address_family == AF_INET) {
+          v4_unblocked.wait();
+          return v4_address_;
+        }
+        return v6_address_;
+      });
+
+  ResolutionResult result;
+  resolver.Resolve("example.com", "443",
+                   std::make_unique<RecordingCallback>(&result));
+  while (!result.first_received) {
+    resolver.ProcessCompletions();
+    QuicSleep(QuicTime::Delta::FromMilliseconds(1));
+  }
+  EXPECT_EQ(v6_address_, result.first_address);
+  EXPECT_FALSE(result.complete);
+
+  release_v4.set_value();
+  WaitForResolutions(&resolver);
+  EXPECT_TRUE(result.complete);
+  ASSERT_EQ(2u, result.addresses.size());
+  // Arrival order: the raced winner stays in front.
+  EXPECT_EQ(v6_address_, result.addresses[0]);
+  EXPECT_EQ(v4_address_, result.addresses[1]);
+  // The callback ran on the thread draining the completion queue, not on a
+  // worker.
+  EXPECT_EQ(std::this_thread::get_id(), result.thread_id);
+}
+
+TEST_F(QuicAsyncResolverTest, FailedResolutionDeliversEmptyList) {
+  QuicAsyncResolver resolver(
+      /*num_workers=*/2,
+      [](int /*address_family*/, std::string /*host*/, std::string /*port*/) {
+        return QuicSocketAddress();
+      });
+
+  ResolutionResult result;
+  resolver.Resolve("nonexistent.invalid", "443",
+                   std::make_unique<RecordingCallback>(&result));
+  WaitForResolutions(&resolver);
+  EXPECT_FALSE(result.first_received);
+  EXPECT_TRUE(result.complete);
+  EXPECT_TRUE(result.addresses.empty());
+}
+
+TEST_F(QuicAsyncResolverTest, DestructorDeliversPendingResolutions) {
+  ResolutionResult result;
+  {
+    QuicAsyncResolver resolver(
+        /*num_workers=*/1,
+        [this](int /*address_family*/, std::string /*host*/,
+               std::string /*port*/) { return v4_address_; });
+    resolver.Resolve("example.com", "443",
+                     std::make_unique<RecordingCallback>(&result));
+    // Destruction joins the worker and delivers whatever it finished; any
+    // lookup still queued is failed.
+  }
+  EXPECT_TRUE(result.complete);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
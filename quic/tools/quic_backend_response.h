@@ -5,7 +5,10 @@
 #ifndef QUICHE_QUIC_TOOLS_QUIC_BACKEND_RESPONSE_H_
 #define QUICHE_QUIC_TOOLS_QUIC_BACKEND_RESPONSE_H_
 
+#include <memory>
+
 #include "absl/strings/string_view.h"
+#include "quic/tools/quic_mapped_file.h"
 #include "quic/tools/quic_url.h"
 #include "spdy/core/spdy_protocol.h"
 
@@ -57,7 +60,15 @@ class QuicBackendResponse {
   SpecialResponseType response_type() const { return response_type_; }
   const spdy::Http2HeaderBlock& headers() const { return headers_; }
   const spdy::Http2HeaderBlock& trailers() const { return trailers_; }
-  const absl::string_view body() const { return absl::string_view(body_); }
+  const absl::string_view body() const {
+    return (mapped_file_ != nullptr || has_body_view_)
+               ? mapped_body_
+               : absl::string_view(body_);
+  }
+
+  // The file mapping backing body(), or nullptr if the body is held in
+  // memory.
+  QuicMappedFile* mapped_file() const { return mapped_file_.get(); }
 
   void AddEarlyHints(const spdy::Http2HeaderBlock& headers) {
     spdy::Http2HeaderBlock hints = headers.Clone();
@@ -79,12 +90,37 @@ class QuicBackendResponse {
     body_.assign(body.data(), body.size());
   }
 
+  // Serves body() as a zero-copy view into |mapped_file|. |body| must point
+  // into the mapping and remains valid as long as this response owns it.
+  void set_mapped_body(std::unique_ptr<QuicMappedFile> mapped_file,
+                       absl::string_view body) {
+    mapped_file_ = std::move(mapped_file);
+    mapped_body_ = body;
+    body_.clear();
+  }
+
+  // Serves body() as a zero-copy view into memory owned elsewhere, e.g. a
+  // corpus archive mapping shared by many responses and owned by the
+  // backend. The caller must keep the backing memory alive for the lifetime
+  // of this response.
+  void set_body_view(absl::string_view body) {
+    mapped_body_ = body;
+    has_body_view_ = true;
+    body_.clear();
+  }
+
  private:
   std::vector<spdy::Http2HeaderBlock> early_hints_;
   SpecialResponseType response_type_;
   spdy::Http2HeaderBlock headers_;
   spdy::Http2HeaderBlock trailers_;
   std::string body_;
+  std::unique_ptr<QuicMappedFile> mapped_file_;
+  absl::string_view mapped_body_;
+
+  // True if mapped_body_ points into memory the backend owns (set via
+  // set_body_view) rather than a mapping owned by this response.
+  bool has_body_view_ = false;
 };
 
 }  // namespace quic
@@ -164,9 +164,11 @@ void QuicClientBase::StartConnect() {
   const bool can_reconnect_with_different_version =
       CanReconnectWithDifferentVersion(&mutual_version);
   if (connected_or_attempting_connect()) {
-    // Clear queued up data if client can not try to connect with a different
-    // version.
-    if (!can_reconnect_with_different_version) {
+    // Clear queued up data unless the reconnect is one on which it is safe to
+    // replay it: a version renegotiation or a 0-RTT rejection, neither of
+    // which leaves data processed by the server behind.
+    if (!can_reconnect_with_different_version &&
+        !CanReconnectAfterZeroRttRejection()) {
       ClearDataToResend();
     }
     // Before we destroy the last session and create a new one, gather its stats
@@ -250,6 +252,17 @@ bool QuicClientBase::WaitForEvents() {
                     << ", attempting to reconnect.";
 
     Connect();
+    if (connected()) {
+      ResendSavedData();
+    }
+  } else if (!connected() && CanReconnectAfterZeroRttRejection()) {
+    QUIC_DLOG(INFO) << "Connection closed due to 0-RTT rejection, attempting "
+                       "to reconnect and replay early data.";
+
+    Connect();
+    if (connected()) {
+      ResendSavedData();
+    }
   }
 
   return HasActiveRequests();
@@ -468,6 +481,17 @@ bool QuicClientBase::CanReconnectWithDifferentVersion(
   return false;
 }
 
+bool QuicClientBase::CanReconnectAfterZeroRttRejection() const {
+  if (session_ == nullptr) {
+    return false;
+  }
+  // Both errors are raised before the handshake is confirmed, when rejected
+  // 0-RTT data cannot be retransmitted within the same connection. The server
+  // discarded the early data when it rejected it.
+  return session_->error() == QUIC_ZERO_RTT_UNRETRANSMITTABLE ||
+         session_->error() == QUIC_ZERO_RTT_REJECTION_LIMIT_REDUCED;
+}
+
 bool QuicClientBase::HasPendingPathValidation() {
   return session()->HasPendingPathValidation();
 }
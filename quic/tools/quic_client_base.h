@@ -323,6 +323,12 @@ class QuicClientBase {
   // version.
   bool CanReconnectWithDifferentVersion(ParsedQuicVersion* version) const;
 
+  // Returns true if the last connection was closed because rejected 0-RTT
+  // data could not be retransmitted within the connection. The server
+  // discarded the early data on rejection, so a new connection may safely
+  // replay it.
+  bool CanReconnectAfterZeroRttRejection() const;
+
   std::unique_ptr<QuicPacketWriter> CreateWriterForNewNetwork(
       const QuicIpAddress& new_host,
       int port);
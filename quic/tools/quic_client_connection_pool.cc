@@ -0,0 +1,130 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/tools/quic_client_connection_pool.h"
+
+#include <utility>
+
+#include "quic/platform/api/quic_logging.h"
+
+namespace quic {
+
+QuicClientConnectionPool::QuicClientConnectionPool(size_t pool_size,
+                                                   ClientFactory* factory)
+    : next_index_(0) {
+  QUICHE_DCHECK_GT(pool_size, 0u);
+  for (size_t i = 0; i < pool_size; ++i) {
+    clients_.push_back(factory->CreateClient());
+  }
+}
+
+QuicClientConnectionPool::~QuicClientConnectionPool() = default;
+
+bool QuicClientConnectionPool::Connect() {
+  QuicClientBase* lead = nullptr;
+  for (auto& client : clients_) {
+    if (lead != nullptr) {
+      SeedCryptoConfig(lead, client.get());
+    }
+    if (!client->Initialize() || !client->Connect()) {
+      QUIC_LOG(WARNING) << "Pool member failed to connect to "
+                        << client->server_address();
+      continue;
+    }
+    if (lead == nullptr) {
+      // The first completed handshake populates this member's crypto config
+      // with the server config and source-address token that the remaining
+      // members need to attempt 0-RTT.
+      lead = client.get();
+    }
+  }
+  return lead != nullptr;
+}
+
+QuicClientBase* QuicClientConnectionPool::GetClientForNewStream() {
+  std::vector<size_t> loads(clients_.size(), 0);
+  std::vector<bool> connected(clients_.size(), false);
+  for (size_t i = 0; i < clients_.size(); ++i) {
+    connected[i] = clients_[i]->connected();
+    if (connected[i]) {
+      loads[i] = clients_[i]->session()->GetNumActiveStreams();
+    }
+  }
+  const size_t picked = SelectStripedLeastLoaded(loads, connected, next_index_);
+  if (picked == clients_.size()) {
+    return nullptr;
+  }
+  next_index_ = (picked + 1) % clients_.size();
+  return clients_[picked].get();
+}
+
+size_t QuicClientConnectionPool::ReconnectDeadClients() {
+  QuicClientBase* healthy = AnyConnectedClient();
+  size_t reconnected = 0;
+  for (auto& client : clients_) {
+    if (client->connected()) {
+      continue;
+    }
+    if (healthy != nullptr) {
+      SeedCryptoConfig(healthy, client.get());
+    }
+    if (!client->Connect()) {
+      QUIC_LOG(WARNING) << "Pool member failed to reconnect to "
+                        << client->server_address();
+      continue;
+    }
+    ++reconnected;
+    if (healthy == nullptr) {
+      healthy = client.get();
+    }
+  }
+  return reconnected;
+}
+
+size_t QuicClientConnectionPool::NumConnectedClients() const {
+  size_t num_connected = 0;
+  for (const auto& client : clients_) {
+    if (client->connected()) {
+      ++num_connected;
+    }
+  }
+  return num_connected;
+}
+
+// static
+size_t QuicClientConnectionPool::SelectStripedLeastLoaded(
+    const std::vector<size_t>& loads,
+    const std::vector<bool>& connected,
+    size_t start_index) {
+  QUICHE_DCHECK_EQ(loads.size(), connected.size());
+  size_t best = loads.size();
+  for (size_t i = 0; i < loads.size(); ++i) {
+    const size_t index = (start_index + i) % loads.size();
+    if (!connected[index]) {
+      continue;
+    }
+    if (best == loads.size() || loads[index] < loads[best]) {
+      best = index;
+    }
+  }
+  return best;
+}
+
+void QuicClientConnectionPool::SeedCryptoConfig(QuicClientBase* source,
+                                                QuicClientBase* target) {
+  target->crypto_config()->InitializeFrom(target->server_id(),
+                                          source->server_id(),
+                                          source->crypto_config());
+}
+
+QuicClientBase* QuicClientConnectionPool::AnyConnectedClient() {
+  for (auto& client : clients_) {
+    if (client->connected()) {
+      return client.get();
+    }
+  }
+  return nullptr;
+}
+
+}  // namespace quic
@@ -0,0 +1,86 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_TOOLS_QUIC_CLIENT_CONNECTION_POOL_H_
+#define QUICHE_QUIC_TOOLS_QUIC_CLIENT_CONNECTION_POOL_H_
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "quic/tools/quic_client_base.h"
+
+namespace quic {
+
+// Maintains several QUIC connections to the same backend and spreads new
+// streams across them. The first member to complete its handshake seeds the
+// crypto configs of the remaining members with its cached server config and
+// source-address token, so their handshakes can attempt 0-RTT instead of each
+// paying a full round trip. Stream data is not migrated between members; on
+// failover the caller re-issues its request on the client returned by
+// GetClientForNewStream().
+class QuicClientConnectionPool {
+ public:
+  // Creates the clients to be pooled. Each call must return a new client
+  // configured for the same server.
+  class ClientFactory {
+   public:
+    virtual ~ClientFactory() = default;
+
+    virtual std::unique_ptr<QuicClientBase> CreateClient() = 0;
+  };
+
+  QuicClientConnectionPool(size_t pool_size, ClientFactory* factory);
+  QuicClientConnectionPool(const QuicClientConnectionPool&) = delete;
+  QuicClientConnectionPool& operator=(const QuicClientConnectionPool&) =
+      delete;
+  ~QuicClientConnectionPool();
+
+  // Connects all pool members. The first member to connect performs a full
+  // handshake; every later member is seeded from it before connecting.
+  // Returns true if at least one member connected.
+  bool Connect();
+
+  // Returns the connected member that should carry the next stream: scanning
+  // round-robin from the previous pick, the member with the fewest active
+  // streams wins, so equally loaded members are striped. Returns nullptr if
+  // no member is connected.
+  QuicClientBase* GetClientForNewStream();
+
+  // Reconnects members that have become disconnected, re-seeding each from a
+  // connected member first where possible. Returns the number of members
+  // that were reconnected.
+  size_t ReconnectDeadClients();
+
+  size_t NumConnectedClients() const;
+
+  size_t pool_size() const { return clients_.size(); }
+
+  QuicClientBase* client(size_t i) { return clients_[i].get(); }
+
+  // Returns the index of the least-loaded connected entry, scanning
+  // round-robin from |start_index| and preferring the earliest scanned entry
+  // on ties. Returns |loads.size()| if no entry is connected. Exposed for
+  // testing.
+  static size_t SelectStripedLeastLoaded(const std::vector<size_t>& loads,
+                                         const std::vector<bool>& connected,
+                                         size_t start_index);
+
+ private:
+  // Copies the handshake artifacts cached by |source| into |target| so that
+  // |target|'s next handshake can attempt 0-RTT.
+  void SeedCryptoConfig(QuicClientBase* source, QuicClientBase* target);
+
+  // Returns any connected member, or nullptr if there is none.
+  QuicClientBase* AnyConnectedClient();
+
+  std::vector<std::unique_ptr<QuicClientBase>> clients_;
+
+  // Where the next selection scan starts; one past the previous pick.
+  size_t next_index_;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_TOOLS_QUIC_CLIENT_CONNECTION_POOL_H_
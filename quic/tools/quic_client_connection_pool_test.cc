@@ -0,0 +1,50 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/tools/quic_client_connection_pool.h"
+
+#include <vector>
+
+#include "quic/platform/api/quic_test.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+TEST(QuicClientConnectionPoolTest, SelectsLeastLoaded) {
+  const std::vector<size_t> loads = {3, 1, 2};
+  const std::vector<bool> connected = {true, true, true};
+  EXPECT_EQ(1u, QuicClientConnectionPool::SelectStripedLeastLoaded(
+                    loads, connected, /*start_index=*/0));
+}
+
+TEST(QuicClientConnectionPoolTest, StripesOnTies) {
+  const std::vector<size_t> loads = {2, 2, 2};
+  const std::vector<bool> connected = {true, true, true};
+  // With equal loads, the earliest entry from the scan start wins, so
+  // successive picks rotate through the pool.
+  for (size_t start = 0; start < loads.size(); ++start) {
+    EXPECT_EQ(start, QuicClientConnectionPool::SelectStripedLeastLoaded(
+                         loads, connected, start));
+  }
+}
+
+TEST(QuicClientConnectionPoolTest, SkipsDisconnected) {
+  const std::vector<size_t> loads = {0, 5, 7};
+  const std::vector<bool> connected = {false, true, true};
+  // The idle entry is disconnected, so the least-loaded connected one wins.
+  EXPECT_EQ(1u, QuicClientConnectionPool::SelectStripedLeastLoaded(
+                    loads, connected, /*start_index=*/0));
+}
+
+TEST(QuicClientConnectionPoolTest, NoConnectedMembers) {
+  const std::vector<size_t> loads = {0, 0};
+  const std::vector<bool> connected = {false, false};
+  EXPECT_EQ(loads.size(), QuicClientConnectionPool::SelectStripedLeastLoaded(
+                              loads, connected, /*start_index=*/1));
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
@@ -60,6 +60,24 @@ bool QuicClientEpollNetworkHelper::CreateUDPSocketAndBind(
     int bind_to_port) {
   epoll_server_->set_timeout_in_us(50 * 1000);
 
+  if (socket_pool_ != nullptr && !bind_to_address.IsInitialized() &&
+      bind_to_port == 0) {
+    // A pooled socket already has its options applied and is bound to the
+    // wildcard address on an ephemeral port, making connection start
+    // syscall-free unless the pool is empty.
+    QuicClientSocketPool::PooledSocket socket;
+    if (!socket_pool_->AcquireSocket(server_address.host().address_family(),
+                                     &socket)) {
+      return false;
+    }
+    overflow_supported_ = socket.overflow_supported;
+    fd_address_map_[socket.fd] = socket.bound_address;
+    pooled_fds_.insert(socket.fd);
+    epoll_server_->RegisterFD(socket.fd, this, kEpollFlags);
+    socket_pool_->ScheduleReplenish(epoll_server_);
+    return true;
+  }
+
   int fd = CreateUDPSocket(server_address, &overflow_supported_);
   if (fd < 0) {
     return false;
@@ -126,6 +144,18 @@ void QuicClientEpollNetworkHelper::CleanUpAllUDPSockets() {
 void QuicClientEpollNetworkHelper::CleanUpUDPSocketImpl(int fd) {
   if (fd > -1) {
     epoll_server_->UnregisterFD(fd);
+    if (socket_pool_ != nullptr && pooled_fds_.erase(fd) > 0) {
+      // Recycle the socket instead of closing it.
+      QuicClientSocketPool::PooledSocket socket;
+      socket.fd = fd;
+      socket.overflow_supported = overflow_supported_;
+      auto it = fd_address_map_.find(fd);
+      if (it != fd_address_map_.end()) {
+        socket.bound_address = it->second;
+      }
+      socket_pool_->ReleaseSocket(socket);
+      return;
+    }
     int rc = close(fd);
     QUICHE_DCHECK_EQ(0, rc);
   }
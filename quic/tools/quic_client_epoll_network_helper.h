@@ -12,11 +12,13 @@
 #include <memory>
 #include <string>
 
+#include "absl/container/flat_hash_set.h"
 #include "quic/core/http/quic_client_push_promise_index.h"
 #include "quic/core/quic_config.h"
 #include "quic/core/quic_packet_reader.h"
 #include "quic/platform/api/quic_epoll.h"
 #include "quic/tools/quic_client_base.h"
+#include "quic/tools/quic_client_socket_pool.h"
 #include "common/quiche_linked_hash_map.h"
 
 namespace quic {
@@ -93,6 +95,15 @@ class QuicClientEpollNetworkHelper : public QuicClientBase::NetworkHelper,
   void set_max_reads_per_epoll_loop(int num_reads) {
     max_reads_per_epoll_loop_ = num_reads;
   }
+
+  // Sets the pool pre-configured sockets are checked out of when connecting
+  // without an explicit bind address or port, making connection start
+  // syscall-free. |socket_pool| is typically shared by all clients on the
+  // event loop thread; it is not owned and must outlive this helper. Sockets
+  // checked out of the pool are returned to it on cleanup.
+  void set_socket_pool(QuicClientSocketPool* socket_pool) {
+    socket_pool_ = socket_pool;
+  }
   // If |fd| is an open UDP socket, unregister and close it. Otherwise, do
   // nothing.
   void CleanUpUDPSocket(int fd);
@@ -128,6 +139,13 @@ class QuicClientEpollNetworkHelper : public QuicClientBase::NetworkHelper,
   QuicClientBase* client_;
 
   int max_reads_per_epoll_loop_;
+
+  // If not null, sockets are checked out of this pool when possible instead
+  // of being created per connection. Not owned.
+  QuicClientSocketPool* socket_pool_ = nullptr;
+
+  // Sockets checked out of |socket_pool_|, returned to it on cleanup.
+  absl::flat_hash_set<int> pooled_fds_;
 };
 
 }  // namespace quic
@@ -0,0 +1,136 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/tools/quic_client_race_manager.h"
+
+#include <utility>
+
+#include "quic/platform/api/quic_logging.h"
+
+namespace quic {
+
+QuicClientRaceManager::QuicClientRaceManager() = default;
+
+QuicClientRaceManager::~QuicClientRaceManager() = default;
+
+void QuicClientRaceManager::AddCandidate(
+    std::string label,
+    std::unique_ptr<QuicClientBase> client) {
+  QUICHE_DCHECK(outcomes_.size() == candidates_.size());
+  CandidateOutcome outcome;
+  outcome.label = std::move(label);
+  outcomes_.push_back(std::move(outcome));
+  candidates_.push_back(std::move(client));
+}
+
+bool QuicClientRaceManager::Race() {
+  QUICHE_DCHECK(winner_ == nullptr);
+  std::vector<bool> racing(candidates_.size(), false);
+  std::vector<QuicTime> start_times(candidates_.size(), QuicTime::Zero());
+  for (size_t i = 0; i < candidates_.size(); ++i) {
+    QuicClientBase* candidate = candidates_[i].get();
+    if (!candidate->Initialize()) {
+      QUIC_LOG(WARNING) << "Race candidate " << outcomes_[i].label
+                        << " failed to initialize";
+      outcomes_[i].error = QUIC_CONNECTION_CANCELLED;
+      continue;
+    }
+    start_times[i] = candidate->helper()->GetClock()->ApproximateNow();
+    candidate->StartConnect();
+    racing[i] = true;
+  }
+
+  while (winner_ == nullptr) {
+    bool still_racing = false;
+    for (size_t i = 0; i < candidates_.size(); ++i) {
+      if (!racing[i]) {
+        continue;
+      }
+      QuicClientBase* candidate = candidates_[i].get();
+      if (candidate->EncryptionBeingEstablished()) {
+        // Poll this candidate's event loop once (a bounded wait) and move on,
+        // so every candidate keeps making handshake progress.
+        candidate->network_helper()->RunEventLoop();
+      }
+      if (candidate->EncryptionBeingEstablished()) {
+        still_racing = true;
+        continue;
+      }
+      racing[i] = false;
+      if (candidate->connected()) {
+        winner_ = candidate;
+        RecordOutcome(i, /*won=*/true, start_times[i]);
+        break;
+      }
+      RecordOutcome(i, /*won=*/false, start_times[i]);
+    }
+    if (winner_ != nullptr || !still_racing) {
+      break;
+    }
+  }
+
+  // Cancel candidates that were still racing when the winner finished. Their
+  // outcomes keep the default zero duration to mark them as cancelled rather
+  // than failed.
+  for (size_t i = 0; i < candidates_.size(); ++i) {
+    if (racing[i]) {
+      candidates_[i]->Disconnect();
+    }
+  }
+
+  if (winner_ == nullptr) {
+    // Every candidate failed. If one of them was rejected only for its
+    // version, retry it serially the way a plain Connect() would; the
+    // reconnect uses the mutual version the server advertised.
+    for (size_t i = 0; i < candidates_.size(); ++i) {
+      QuicClientBase* candidate = candidates_[i].get();
+      if (!candidate->initialized() ||
+          candidate->connection_error() != QUIC_INVALID_VERSION) {
+        continue;
+      }
+      const QuicTime start =
+          candidate->helper()->GetClock()->ApproximateNow();
+      if (candidate->Connect()) {
+        winner_ = candidate;
+        outcomes_[i].won = true;
+        outcomes_[i].error = QUIC_NO_ERROR;
+        outcomes_[i].handshake_duration =
+            candidate->helper()->GetClock()->ApproximateNow() - start;
+      }
+      break;
+    }
+  }
+
+  return winner_ != nullptr;
+}
+
+std::unique_ptr<QuicClientBase> QuicClientRaceManager::ReleaseWinner() {
+  if (winner_ == nullptr) {
+    return nullptr;
+  }
+  for (auto& candidate : candidates_) {
+    if (candidate.get() == winner_) {
+      winner_ = nullptr;
+      return std::move(candidate);
+    }
+  }
+  return nullptr;
+}
+
+void QuicClientRaceManager::RecordOutcome(size_t index,
+                                          bool won,
+                                          QuicTime start_time) {
+  QuicClientBase* candidate = candidates_[index].get();
+  CandidateOutcome& outcome = outcomes_[index];
+  outcome.won = won;
+  outcome.error = won ? QUIC_NO_ERROR : candidate->connection_error();
+  outcome.handshake_duration =
+      candidate->helper()->GetClock()->ApproximateNow() - start_time;
+  if (!won) {
+    QUIC_DLOG(INFO) << "Race candidate " << outcome.label << " lost: "
+                    << QuicErrorCodeToString(outcome.error);
+  }
+}
+
+}  // namespace quic
@@ -0,0 +1,85 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_TOOLS_QUIC_CLIENT_RACE_MANAGER_H_
+#define QUICHE_QUIC_TOOLS_QUIC_CLIENT_RACE_MANAGER_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "quic/tools/quic_client_base.h"
+
+namespace quic {
+
+// Races several connection attempts to the same server and promotes the first
+// one to complete its handshake. Each candidate is a fully configured client
+// (for example one speaking IETF QUIC v1 and one speaking a fallback version
+// or ALPN) pointed at the same resolved server address, so DNS is paid once by
+// the caller and shared across candidates. Candidates connect concurrently:
+// the race interleaves their event loops instead of waiting for one attempt
+// to fail before starting the next, so a network that mangles one version
+// costs nothing beyond the losing socket. Losing candidates are disconnected
+// as soon as a winner is known.
+class QuicClientRaceManager {
+ public:
+  // The result of one candidate's leg of the race, for logging and metrics.
+  struct CandidateOutcome {
+    // The label the candidate was added with, e.g. "h3-v1" or "h3-fallback".
+    std::string label;
+    bool won = false;
+    // QUIC_NO_ERROR unless the candidate's connection failed.
+    QuicErrorCode error = QUIC_NO_ERROR;
+    // Time from StartConnect() until the candidate won or failed. Zero for
+    // candidates cancelled because another candidate won first.
+    QuicTime::Delta handshake_duration = QuicTime::Delta::Zero();
+  };
+
+  QuicClientRaceManager();
+  QuicClientRaceManager(const QuicClientRaceManager&) = delete;
+  QuicClientRaceManager& operator=(const QuicClientRaceManager&) = delete;
+  ~QuicClientRaceManager();
+
+  // Adds a candidate to race. The caller is responsible for configuring the
+  // client's versions and for setting the server address on every candidate
+  // from the same DNS result. Must not be called after Race().
+  void AddCandidate(std::string label, std::unique_ptr<QuicClientBase> client);
+
+  // Runs the race to completion. Returns true if some candidate completed its
+  // handshake; that candidate is then available from winner(). Candidates
+  // that lose are disconnected. If every candidate fails but one of them was
+  // rejected only for its version, falls back to one serial reconnect, which
+  // matches the behavior of a plain QuicClientBase::Connect().
+  bool Race();
+
+  // The client that won the race, or nullptr if the race has not been run or
+  // no candidate connected. The manager retains ownership.
+  QuicClientBase* winner() { return winner_; }
+
+  // Hands the winning session's client to the application. After this call
+  // the manager no longer owns the winner and winner() returns nullptr.
+  std::unique_ptr<QuicClientBase> ReleaseWinner();
+
+  // Per-candidate race outcomes, in the order candidates were added. Only
+  // populated once Race() has run.
+  const std::vector<CandidateOutcome>& outcomes() const { return outcomes_; }
+
+  size_t num_candidates() const { return candidates_.size(); }
+
+  // Returns the i-th candidate as added. Null for a winner that has been
+  // released to the application.
+  QuicClientBase* candidate(size_t i) { return candidates_[i].get(); }
+
+ private:
+  // Records |candidate|'s terminal state in outcomes_[index].
+  void RecordOutcome(size_t index, bool won, QuicTime start_time);
+
+  std::vector<std::unique_ptr<QuicClientBase>> candidates_;
+  std::vector<CandidateOutcome> outcomes_;
+  QuicClientBase* winner_ = nullptr;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_TOOLS_QUIC_CLIENT_RACE_MANAGER_H_
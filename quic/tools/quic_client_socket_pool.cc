@@ -0,0 +1,161 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/tools/quic_client_socket_pool.h"
+
+#include <errno.h>
+#include <netinet/in.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "quic/core/quic_constants.h"
+#include "quic/core/quic_udp_socket.h"
+#include "quic/platform/api/quic_logging.h"
+
+namespace quic {
+
+QuicClientSocketPool::QuicClientSocketPool(size_t target_size_per_family)
+    : target_size_per_family_(target_size_per_family),
+      replenish_alarm_(this) {}
+
+QuicClientSocketPool::~QuicClientSocketPool() {
+  replenish_alarm_.UnregisterIfRegistered();
+  for (const std::vector<PooledSocket>* pool : {&v4_sockets_, &v6_sockets_}) {
+    for (const PooledSocket& socket : *pool) {
+      close(socket.fd);
+    }
+  }
+}
+
+bool QuicClientSocketPool::AcquireSocket(IpAddressFamily address_family,
+                                         PooledSocket* socket) {
+  std::vector<PooledSocket>* pool = PoolForFamily(address_family);
+  if (pool == nullptr) {
+    return false;
+  }
+  if (!pool->empty()) {
+    *socket = pool->back();
+    pool->pop_back();
+    return true;
+  }
+  // Pool miss: pay for the syscalls on the connect path, as without a pool.
+  return CreateSocket(address_family, socket);
+}
+
+void QuicClientSocketPool::ReleaseSocket(const PooledSocket& socket) {
+  std::vector<PooledSocket>* pool =
+      PoolForFamily(socket.bound_address.host().address_family());
+  if (pool == nullptr || pool->size() >= target_size_per_family_) {
+    close(socket.fd);
+    return;
+  }
+  // Drain packets still queued from the previous connection so that the next
+  // user does not read them.
+  char drain_buffer[kMaxIncomingPacketSize];
+  while (recv(socket.fd, drain_buffer, sizeof(drain_buffer), MSG_DONTWAIT) >
+         0) {
+  }
+  pool->push_back(socket);
+}
+
+void QuicClientSocketPool::Replenish() {
+  for (IpAddressFamily address_family :
+       {IpAddressFamily::IP_V4, IpAddressFamily::IP_V6}) {
+    std::vector<PooledSocket>* pool = PoolForFamily(address_family);
+    while (pool->size() < target_size_per_family_) {
+      PooledSocket socket;
+      if (!CreateSocket(address_family, &socket)) {
+        break;
+      }
+      pool->push_back(socket);
+    }
+  }
+}
+
+void QuicClientSocketPool::ScheduleReplenish(QuicEpollServer* epoll_server) {
+  if (replenish_alarm_.registered()) {
+    return;
+  }
+  epoll_server->RegisterAlarmApproximateDelta(/*delta_in_us=*/0,
+                                              &replenish_alarm_);
+}
+
+size_t QuicClientSocketPool::NumAvailableSockets(
+    IpAddressFamily address_family) const {
+  switch (address_family) {
+    case IpAddressFamily::IP_V4:
+      return v4_sockets_.size();
+    case IpAddressFamily::IP_V6:
+      return v6_sockets_.size();
+    case IpAddressFamily::IP_UNSPEC:
+      break;
+  }
+  return 0;
+}
+
+int64_t QuicClientSocketPool::ReplenishAlarm::OnAlarm() {
+  QuicEpollAlarmBase::OnAlarm();
+  pool_->Replenish();
+  return 0;
+}
+
+bool QuicClientSocketPool::CreateSocket(IpAddressFamily address_family,
+                                        PooledSocket* socket) {
+  QuicIpAddress bind_address;
+  switch (address_family) {
+    case IpAddressFamily::IP_V4:
+      bind_address = QuicIpAddress::Any4();
+      break;
+    case IpAddressFamily::IP_V6:
+      bind_address = QuicIpAddress::Any6();
+      break;
+    case IpAddressFamily::IP_UNSPEC:
+      return false;
+  }
+
+  QuicUdpSocketApi api;
+  int fd = api.Create(bind_address.AddressFamilyToInt(),
+                      /*receive_buffer_size =*/kDefaultSocketReceiveBuffer,
+                      /*send_buffer_size =*/kDefaultSocketReceiveBuffer);
+  if (fd < 0) {
+    return false;
+  }
+  socket->overflow_supported = api.EnableDroppedPacketCount(fd);
+  api.EnableReceiveTimestamp(fd);
+
+  QuicSocketAddress client_address(bind_address, /*port=*/0);
+  sockaddr_storage addr = client_address.generic_address();
+  const socklen_t addrlen = address_family == IpAddressFamily::IP_V4
+                                ? sizeof(sockaddr_in)
+                                : sizeof(sockaddr_in6);
+  if (bind(fd, reinterpret_cast<sockaddr*>(&addr), addrlen) < 0) {
+    QUIC_LOG(ERROR) << "Bind failed: " << strerror(errno);
+    close(fd);
+    return false;
+  }
+  if (client_address.FromSocket(fd) != 0) {
+    QUIC_LOG(ERROR) << "Unable to get self address.  Error: "
+                    << strerror(errno);
+  }
+
+  socket->fd = fd;
+  socket->bound_address = client_address;
+  return true;
+}
+
+std::vector<QuicClientSocketPool::PooledSocket>*
+QuicClientSocketPool::PoolForFamily(IpAddressFamily address_family) {
+  switch (address_family) {
+    case IpAddressFamily::IP_V4:
+      return &v4_sockets_;
+    case IpAddressFamily::IP_V6:
+      return &v6_sockets_;
+    case IpAddressFamily::IP_UNSPEC:
+      break;
+  }
+  return nullptr;
+}
+
+}  // namespace quic
@@ -0,0 +1,92 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_TOOLS_QUIC_CLIENT_SOCKET_POOL_H_
+#define QUICHE_QUIC_TOOLS_QUIC_CLIENT_SOCKET_POOL_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "quic/platform/api/quic_epoll.h"
+#include "quic/platform/api/quic_ip_address_family.h"
+#include "quic/platform/api/quic_socket_address.h"
+
+namespace quic {
+
+// Pool of pre-created UDP client sockets with all socket options applied
+// (buffer sizes, receive timestamps, dropped packet counts) and already bound
+// to the wildcard address on an ephemeral port. Checking a socket out at
+// connect time replaces the socket()/setsockopt()/bind() syscall sequence on
+// the connection setup critical path, which matters for workloads opening a
+// connection per request, e.g. MASQUE per-origin tunnels. Sockets are kept in
+// separate per-address-family pools and are returned for reuse when their
+// connection closes. Not thread-safe; intended to be owned by the event loop
+// thread that owns the clients.
+class QuicClientSocketPool {
+ public:
+  // A ready-to-use socket checked out of the pool.
+  struct PooledSocket {
+    int fd = -1;
+    // True if the kernel reports dropped packet counts for |fd|.
+    bool overflow_supported = false;
+    // The wildcard address and ephemeral port |fd| is bound to.
+    QuicSocketAddress bound_address;
+  };
+
+  // |target_size_per_family| is the number of ready sockets kept per address
+  // family. The pool starts empty; call Replenish() to prefill it.
+  explicit QuicClientSocketPool(size_t target_size_per_family);
+  QuicClientSocketPool(const QuicClientSocketPool&) = delete;
+  QuicClientSocketPool& operator=(const QuicClientSocketPool&) = delete;
+
+  // Closes all pooled sockets.
+  ~QuicClientSocketPool();
+
+  // Checks a socket for |address_family| out of the pool into |*socket|.
+  // Falls back to creating and configuring one synchronously if the pool is
+  // empty. Returns false if no socket could be provided.
+  bool AcquireSocket(IpAddressFamily address_family, PooledSocket* socket);
+
+  // Returns |socket| to the pool for reuse, first draining any packets still
+  // queued on it from the previous connection. Closes the socket instead if
+  // the pool for its family is already at target size.
+  void ReleaseSocket(const PooledSocket& socket);
+
+  // Fills both per-family pools up to the target size. Runs the socket
+  // creation syscalls, so call it off the connect path.
+  void Replenish();
+
+  // Schedules Replenish() to run from |epoll_server|'s alarm queue once
+  // control has returned to the event loop, keeping socket creation off the
+  // connect path. No-op if a replenish is already pending.
+  void ScheduleReplenish(QuicEpollServer* epoll_server);
+
+  size_t NumAvailableSockets(IpAddressFamily address_family) const;
+
+ private:
+  class ReplenishAlarm : public QuicEpollAlarmBase {
+   public:
+    explicit ReplenishAlarm(QuicClientSocketPool* pool) : pool_(pool) {}
+
+    int64_t OnAlarm() override;
+
+   private:
+    QuicClientSocketPool* pool_;  // Unowned.
+  };
+
+  // Creates, configures and binds a socket for |address_family|. Returns
+  // false on failure.
+  bool CreateSocket(IpAddressFamily address_family, PooledSocket* socket);
+
+  std::vector<PooledSocket>* PoolForFamily(IpAddressFamily address_family);
+
+  const size_t target_size_per_family_;
+  std::vector<PooledSocket> v4_sockets_;
+  std::vector<PooledSocket> v6_sockets_;
+  ReplenishAlarm replenish_alarm_;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_TOOLS_QUIC_CLIENT_SOCKET_POOL_H_
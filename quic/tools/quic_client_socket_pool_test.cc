@@ -0,0 +1,102 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/tools/quic_client_socket_pool.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "quic/platform/api/quic_test.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+bool IsOpenFd(int fd) { return fcntl(fd, F_GETFD) != -1; }
+
+class QuicClientSocketPoolTest : public QuicTest {};
+
+TEST_F(QuicClientSocketPoolTest, ReplenishFillsPools) {
+  QuicClientSocketPool pool(/*target_size_per_family=*/2);
+  EXPECT_EQ(0u, pool.NumAvailableSockets(IpAddressFamily::IP_V4));
+  EXPECT_EQ(0u, pool.NumAvailableSockets(IpAddressFamily::IP_V6));
+
+  pool.Replenish();
+  EXPECT_EQ(2u, pool.NumAvailableSockets(IpAddressFamily::IP_V4));
+  EXPECT_EQ(2u, pool.NumAvailableSockets(IpAddressFamily::IP_V6));
+}
+
+TEST_F(QuicClientSocketPoolTest, AcquireReturnsBoundSocket) {
+  QuicClientSocketPool pool(/*target_size_per_family=*/1);
+  pool.Replenish();
+
+  QuicClientSocketPool::PooledSocket socket;
+  ASSERT_TRUE(pool.AcquireSocket(IpAddressFamily::IP_V4, &socket));
+  EXPECT_EQ(0u, pool.NumAvailableSockets(IpAddressFamily::IP_V4));
+  EXPECT_GE(socket.fd, 0);
+  EXPECT_EQ(IpAddressFamily::IP_V4,
+            socket.bound_address.host().address_family());
+  EXPECT_NE(0u, socket.bound_address.port());
+  close(socket.fd);
+}
+
+TEST_F(QuicClientSocketPoolTest, AcquireFromEmptyPoolCreatesSocket) {
+  QuicClientSocketPool pool(/*target_size_per_family=*/1);
+
+  // The pool was never replenished, so the socket is created synchronously.
+  QuicClientSocketPool::PooledSocket socket;
+  ASSERT_TRUE(pool.AcquireSocket(IpAddressFamily::IP_V6, &socket));
+  EXPECT_GE(socket.fd, 0);
+  EXPECT_NE(0u, socket.bound_address.port());
+  close(socket.fd);
+}
+
+TEST_F(QuicClientSocketPoolTest, ReleasedSocketIsReused) {
+  QuicClientSocketPool pool(/*target_size_per_family=*/1);
+  pool.Replenish();
+
+  QuicClientSocketPool::PooledSocket socket;
+  ASSERT_TRUE(pool.AcquireSocket(IpAddressFamily::IP_V4, &socket));
+  pool.ReleaseSocket(socket);
+  EXPECT_EQ(1u, pool.NumAvailableSockets(IpAddressFamily::IP_V4));
+
+  QuicClientSocketPool::PooledSocket reused;
+  ASSERT_TRUE(pool.AcquireSocket(IpAddressFamily::IP_V4, &reused));
+  EXPECT_EQ(socket.fd, reused.fd);
+  EXPECT_EQ(socket.bound_address, reused.bound_address);
+  close(reused.fd);
+}
+
+TEST_F(QuicClientSocketPoolTest, ReleaseBeyondTargetSizeClosesSocket) {
+  QuicClientSocketPool pool(/*target_size_per_family=*/1);
+  pool.Replenish();
+
+  // Create an extra socket while the pool is already full.
+  QuicClientSocketPool::PooledSocket extra;
+  {
+    QuicClientSocketPool empty_pool(/*target_size_per_family=*/0);
+    ASSERT_TRUE(empty_pool.AcquireSocket(IpAddressFamily::IP_V4, &extra));
+  }
+
+  ASSERT_TRUE(IsOpenFd(extra.fd));
+  pool.ReleaseSocket(extra);
+  EXPECT_FALSE(IsOpenFd(extra.fd));
+  EXPECT_EQ(1u, pool.NumAvailableSockets(IpAddressFamily::IP_V4));
+}
+
+TEST_F(QuicClientSocketPoolTest, DestructorClosesPooledSockets) {
+  QuicClientSocketPool::PooledSocket socket;
+  {
+    QuicClientSocketPool pool(/*target_size_per_family=*/1);
+    pool.Replenish();
+    ASSERT_TRUE(pool.AcquireSocket(IpAddressFamily::IP_V4, &socket));
+    pool.ReleaseSocket(socket);
+    ASSERT_TRUE(IsOpenFd(socket.fd));
+  }
+  EXPECT_FALSE(IsOpenFd(socket.fd));
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
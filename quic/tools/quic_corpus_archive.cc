@@ -0,0 +1,197 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/tools/quic_corpus_archive.h"
+
+#include <fstream>
+
+#include "quic/core/quic_data_reader.h"
+#include "quic/core/quic_data_writer.h"
+#include "quic/platform/api/quic_logging.h"
+
+namespace quic {
+
+namespace {
+
+// 'QCA1' - QUIC corpus archive, version 1.
+const uint32_t kCorpusArchiveMagic = 0x51434131;
+
+}  // namespace
+
+QuicCorpusArchiveWriter::QuicCorpusArchiveWriter() = default;
+
+QuicCorpusArchiveWriter::~QuicCorpusArchiveWriter() = default;
+
+void QuicCorpusArchiveWriter::AddEntry(absl::string_view host,
+                                       absl::string_view path,
+                                       const spdy::Http2HeaderBlock& headers,
+                                       absl::string_view body) {
+  Entry entry;
+  entry.host = std::string(host);
+  entry.path = std::string(path);
+  for (const auto& header : headers) {
+    // Values of multi-valued headers arrive already joined with '\0', which
+    // round-trips through the archive unchanged.
+    entry.headers.emplace_back(std::string(header.first),
+                               std::string(header.second));
+  }
+  entry.body = std::string(body);
+  entries_.push_back(std::move(entry));
+}
+
+std::string QuicCorpusArchiveWriter::Serialize() const {
+  // Size the buffer exactly: the preamble, each index record, then the
+  // concatenated bodies.
+  size_t total_size = sizeof(uint32_t) + sizeof(uint64_t);
+  for (const Entry& entry : entries_) {
+    total_size += sizeof(uint16_t) + entry.host.size();
+    total_size += sizeof(uint16_t) + entry.path.size();
+    total_size += sizeof(uint8_t);   // Compression tag.
+    total_size += sizeof(uint16_t);  // Number of headers.
+    for (const auto& header : entry.headers) {
+      total_size += sizeof(uint16_t) + header.first.size();
+      total_size += sizeof(uint32_t) + header.second.size();
+    }
+    total_size += 2 * sizeof(uint64_t);  // Body offset and length.
+  }
+  size_t body_region_size = 0;
+  for (const Entry& entry : entries_) {
+    body_region_size += entry.body.size();
+  }
+  total_size += body_region_size;
+
+  std::string archive(total_size, '\0');
+  QuicDataWriter writer(archive.size(), &archive[0]);
+  bool success = writer.WriteUInt32(kCorpusArchiveMagic) &&
+                 writer.WriteUInt64(entries_.size());
+
+  // Body offsets are relative to the start of the body region, which begins
+  // immediately after the index; this lets the archive be written in one
+  // pass without knowing the index size up front.
+  uint64_t body_offset = 0;
+  for (const Entry& entry : entries_) {
+    success = success && writer.WriteStringPiece16(entry.host) &&
+              writer.WriteStringPiece16(entry.path) &&
+              writer.WriteUInt8(kCorpusEntryUncompressed) &&
+              writer.WriteUInt16(entry.headers.size());
+    for (const auto& header : entry.headers) {
+      success = success && writer.WriteStringPiece16(header.first) &&
+                writer.WriteUInt32(header.second.size()) &&
+                writer.WriteStringPiece(header.second);
+    }
+    success = success && writer.WriteUInt64(body_offset) &&
+              writer.WriteUInt64(entry.body.size());
+    body_offset += entry.body.size();
+  }
+  for (const Entry& entry : entries_) {
+    success = success && writer.WriteStringPiece(entry.body);
+  }
+  if (!success || writer.remaining() != 0) {
+    QUIC_BUG(quic_corpus_archive_serialize_failed)
+        << "Corpus archive serialization failed; sized " << total_size
+        << " bytes, " << writer.remaining() << " left unwritten.";
+    return std::string();
+  }
+  return archive;
+}
+
+bool QuicCorpusArchiveWriter::WriteToFile(const std::string& file_name) const {
+  std::string archive = Serialize();
+  if (archive.empty() && !entries_.empty()) {
+    return false;
+  }
+  std::ofstream file(file_name, std::ofstream::binary | std::ofstream::trunc);
+  if (!file) {
+    QUIC_LOG(ERROR) << "Failed to open corpus archive for writing: "
+                    << file_name;
+    return false;
+  }
+  file.write(archive.data(), archive.size());
+  file.close();
+  return file.good();
+}
+
+QuicCorpusArchiveEntry::QuicCorpusArchiveEntry() = default;
+QuicCorpusArchiveEntry::QuicCorpusArchiveEntry(QuicCorpusArchiveEntry&&) =
+    default;
+QuicCorpusArchiveEntry& QuicCorpusArchiveEntry::operator=(
+    QuicCorpusArchiveEntry&&) = default;
+QuicCorpusArchiveEntry::~QuicCorpusArchiveEntry() = default;
+
+bool ReadCorpusArchive(absl::string_view archive,
+                       std::vector<QuicCorpusArchiveEntry>* entries) {
+  QuicDataReader reader(archive.data(), archive.size());
+  uint32_t magic;
+  uint64_t num_entries;
+  if (!reader.ReadUInt32(&magic) || magic != kCorpusArchiveMagic ||
+      !reader.ReadUInt64(&num_entries)) {
+    QUIC_LOG(ERROR) << "Corpus archive has a bad preamble.";
+    return false;
+  }
+
+  // First pass over the index collects every record; the body region starts
+  // wherever the index ends, so body views can only be resolved afterwards.
+  struct BodyLocation {
+    uint64_t offset;
+    uint64_t length;
+  };
+  std::vector<BodyLocation> body_locations;
+  entries->clear();
+  entries->reserve(num_entries);
+  body_locations.reserve(num_entries);
+  for (uint64_t i = 0; i < num_entries; ++i) {
+    QuicCorpusArchiveEntry entry;
+    uint8_t compression;
+    uint16_t num_headers;
+    if (!reader.ReadStringPiece16(&entry.host) ||
+        !reader.ReadStringPiece16(&entry.path) ||
+        !reader.ReadUInt8(&compression) || !reader.ReadUInt16(&num_headers)) {
+      QUIC_LOG(ERROR) << "Corpus archive index truncated at entry " << i;
+      return false;
+    }
+    if (compression != kCorpusEntryUncompressed) {
+      QUIC_LOG(ERROR) << "Corpus archive entry " << i
+                      << " uses unsupported compression tag "
+                      << static_cast<int>(compression);
+      return false;
+    }
+    for (uint16_t j = 0; j < num_headers; ++j) {
+      absl::string_view name;
+      uint32_t value_length;
+      absl::string_view value;
+      if (!reader.ReadStringPiece16(&name) ||
+          !reader.ReadUInt32(&value_length) ||
+          !reader.ReadStringPiece(&value, value_length)) {
+        QUIC_LOG(ERROR) << "Corpus archive index truncated at entry " << i;
+        return false;
+      }
+      entry.headers[name] = value;
+    }
+    BodyLocation location;
+    if (!reader.ReadUInt64(&location.offset) ||
+        !reader.ReadUInt64(&location.length)) {
+      QUIC_LOG(ERROR) << "Corpus archive index truncated at entry " << i;
+      return false;
+    }
+    body_locations.push_back(location);
+    entries->push_back(std::move(entry));
+  }
+
+  // Everything after the index is the body region. Resolving views does not
+  // dereference them, so no body page is faulted in here.
+  absl::string_view body_region = reader.ReadRemainingPayload();
+  for (uint64_t i = 0; i < num_entries; ++i) {
+    const BodyLocation& location = body_locations[i];
+    if (location.offset > body_region.size() ||
+        location.length > body_region.size() - location.offset) {
+      QUIC_LOG(ERROR) << "Corpus archive entry " << i
+                      << " has an out-of-bounds body.";
+      return false;
+    }
+    (*entries)[i].body = body_region.substr(location.offset, location.length);
+  }
+  return true;
+}
+
+}  // namespace quic
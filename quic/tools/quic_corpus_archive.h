@@ -0,0 +1,99 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_TOOLS_QUIC_CORPUS_ARCHIVE_H_
+#define QUICHE_QUIC_TOOLS_QUIC_CORPUS_ARCHIVE_H_
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "spdy/core/spdy_header_block.h"
+
+namespace quic {
+
+// A packed, indexed corpus archive for QuicMemoryCacheBackend.
+//
+// Loading a large corpus (millions of small responses) from a directory tree
+// is dominated by directory traversal and per-file open/read. The archive
+// packs the whole corpus into one file which the backend maps once:
+//
+//   u32 magic
+//   u64 number of entries
+//   index: one variable-length record per entry, holding host, path,
+//          headers, a compression tag, and the offset/length of the body
+//          relative to the start of the body region
+//   body region: all bodies concatenated
+//
+// All integers are in network byte order. Body offsets are relative so the
+// archive can be written in a single pass. The index stores everything
+// needed to build the response map, so loading touches only index pages;
+// body pages fault in when a response is first served.
+//
+// Per-entry compression is reserved via the compression tag; only
+// kCorpusEntryUncompressed is currently defined.
+
+// Compression tags. Values other than kCorpusEntryUncompressed are rejected
+// by the loader until a decompressor is wired in.
+const uint8_t kCorpusEntryUncompressed = 0;
+
+// Accumulates responses and serializes them into the archive format above.
+// This is an offline/tooling class: it holds copies of every entry in
+// memory until the archive is written.
+class QuicCorpusArchiveWriter {
+ public:
+  QuicCorpusArchiveWriter();
+  QuicCorpusArchiveWriter(const QuicCorpusArchiveWriter&) = delete;
+  QuicCorpusArchiveWriter& operator=(const QuicCorpusArchiveWriter&) = delete;
+  ~QuicCorpusArchiveWriter();
+
+  // Adds one response to the archive. |headers| is copied; multi-valued
+  // headers survive the round trip.
+  void AddEntry(absl::string_view host, absl::string_view path,
+                const spdy::Http2HeaderBlock& headers, absl::string_view body);
+
+  // Serializes all added entries into the archive format.
+  std::string Serialize() const;
+
+  // Writes Serialize() to |file_name|. Returns false on I/O failure.
+  bool WriteToFile(const std::string& file_name) const;
+
+ private:
+  struct Entry {
+    std::string host;
+    std::string path;
+    std::vector<std::pair<std::string, std::string>> headers;
+    std::string body;
+  };
+
+  std::vector<Entry> entries_;
+};
+
+// One parsed archive entry. |host|, |path| and |body| are zero-copy views
+// into the archive bytes and are only valid while those bytes stay alive
+// (for a mapped archive, while the mapping is held).
+struct QuicCorpusArchiveEntry {
+  QuicCorpusArchiveEntry();
+  QuicCorpusArchiveEntry(QuicCorpusArchiveEntry&& other);
+  QuicCorpusArchiveEntry& operator=(QuicCorpusArchiveEntry&& other);
+  ~QuicCorpusArchiveEntry();
+
+  absl::string_view host;
+  absl::string_view path;
+  spdy::Http2HeaderBlock headers;
+  absl::string_view body;
+};
+
+// Parses |archive| into |entries|. Reads only the preamble and index bytes;
+// entry bodies are returned as views into |archive| without being touched,
+// so body pages of a mapped archive stay cold. Returns false if the archive
+// is malformed, truncated, or uses an unsupported compression tag.
+bool ReadCorpusArchive(absl::string_view archive,
+                       std::vector<QuicCorpusArchiveEntry>* entries);
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_TOOLS_QUIC_CORPUS_ARCHIVE_H_
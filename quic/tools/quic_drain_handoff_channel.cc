@@ -0,0 +1,120 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/tools/quic_drain_handoff_channel.h"
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+#include "quic/core/quic_data_reader.h"
+#include "quic/core/quic_data_writer.h"
+#include "quic/platform/api/quic_logging.h"
+
+namespace quic {
+
+namespace {
+
+// Upper bound on a serialized QuicConnectionHandoffState: the fixed fields
+// plus length-prefixed connection IDs, addresses and key material are well
+// under this.
+const size_t kMaxSerializedHandoffSize = 1024;
+
+}  // namespace
+
+bool SendConnectionHandoff(int channel_fd,
+                           const QuicConnectionHandoffState& state,
+                           int udp_fd) {
+  char buffer[kMaxSerializedHandoffSize];
+  QuicDataWriter writer(sizeof(buffer), buffer);
+  if (!state.Serialize(&writer)) {
+    QUIC_LOG(ERROR) << "Failed to serialize connection handoff state";
+    return false;
+  }
+
+  iovec iov;
+  iov.iov_base = buffer;
+  iov.iov_len = writer.length();
+
+  msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+
+  char control[CMSG_SPACE(sizeof(int))];
+  if (udp_fd >= 0) {
+    memset(control, 0, sizeof(control));
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(cmsg), &udp_fd, sizeof(int));
+  }
+
+  ssize_t rc;
+  do {
+    rc = sendmsg(channel_fd, &msg, 0);
+  } while (rc < 0 && errno == EINTR);
+  if (rc < 0) {
+    QUIC_LOG(ERROR) << "sendmsg() on handoff channel failed: "
+                    << strerror(errno);
+    return false;
+  }
+  return true;
+}
+
+bool ReceiveConnectionHandoff(int channel_fd,
+                              QuicConnectionHandoffState* state,
+                              int* udp_fd) {
+  *udp_fd = -1;
+
+  char buffer[kMaxSerializedHandoffSize];
+  iovec iov;
+  iov.iov_base = buffer;
+  iov.iov_len = sizeof(buffer);
+
+  msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+
+  char control[CMSG_SPACE(sizeof(int))];
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+
+  ssize_t rc;
+  do {
+    rc = recvmsg(channel_fd, &msg, 0);
+  } while (rc < 0 && errno == EINTR);
+  if (rc <= 0) {
+    QUIC_LOG(ERROR) << "recvmsg() on handoff channel failed: "
+                    << (rc == 0 ? "peer closed" : strerror(errno));
+    return false;
+  }
+
+  for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr;
+       cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+    if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS &&
+        cmsg->cmsg_len == CMSG_LEN(sizeof(int))) {
+      memcpy(udp_fd, CMSG_DATA(cmsg), sizeof(int));
+    }
+  }
+
+  QuicDataReader reader(buffer, rc);
+  if (!state->Deserialize(&reader)) {
+    QUIC_LOG(ERROR) << "Malformed connection handoff message";
+    if (*udp_fd >= 0) {
+      close(*udp_fd);
+      *udp_fd = -1;
+    }
+    return false;
+  }
+  return true;
+}
+
+}  // namespace quic
@@ -0,0 +1,37 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_TOOLS_QUIC_DRAIN_HANDOFF_CHANNEL_H_
+#define QUICHE_QUIC_TOOLS_QUIC_DRAIN_HANDOFF_CHANNEL_H_
+
+#include "quic/core/quic_connection_handoff_state.h"
+
+namespace quic {
+
+// Transfers connection handoff snapshots between processes over a connected
+// unix-domain datagram or seqpacket socket, one snapshot per message. Used
+// during graceful restarts: the draining process exports its still-active
+// connections to its replacement so they continue without a new handshake,
+// see QuicServerDrainManager. Alongside the first snapshot the sender passes
+// its listening UDP socket via SCM_RIGHTS, so the replacement can read the
+// exported connections' packets even before its own socket exists.
+
+// Sends |state| over |channel_fd|. If |udp_fd| is non-negative it is attached
+// to the message as a passed file descriptor. Returns false if serialization
+// or the send fails.
+bool SendConnectionHandoff(int channel_fd,
+                           const QuicConnectionHandoffState& state,
+                           int udp_fd);
+
+// Receives one snapshot from |channel_fd| into |*state|. |*udp_fd| is set to
+// the passed file descriptor, or to -1 if the message carried none; the
+// caller owns the received descriptor. Returns false if the read fails or the
+// message is malformed.
+bool ReceiveConnectionHandoff(int channel_fd,
+                              QuicConnectionHandoffState* state,
+                              int* udp_fd);
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_TOOLS_QUIC_DRAIN_HANDOFF_CHANNEL_H_
@@ -0,0 +1,114 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/tools/quic_drain_handoff_channel.h"
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <string>
+
+#include "quic/core/quic_connection_id.h"
+#include "quic/platform/api/quic_ip_address.h"
+#include "quic/platform/api/quic_socket_address.h"
+#include "quic/platform/api/quic_test.h"
+#include "quic/test_tools/quic_test_utils.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+class QuicDrainHandoffChannelTest : public QuicTest {
+ protected:
+  QuicDrainHandoffChannelTest() {
+    EXPECT_EQ(0, socketpair(AF_UNIX, SOCK_SEQPACKET, 0, channel_fds_));
+  }
+
+  ~QuicDrainHandoffChannelTest() override {
+    for (int fd : channel_fds_) {
+      if (fd >= 0) {
+        close(fd);
+      }
+    }
+  }
+
+  QuicConnectionHandoffState MakeState() {
+    QuicConnectionHandoffState state;
+    state.version_label = 0x00000001;
+    state.cipher_suite = 0x1301;
+    state.server_connection_id = TestConnectionId(42);
+    state.client_connection_id = TestConnectionId(24);
+    state.self_address = QuicSocketAddress(QuicIpAddress::Loopback4(), 443);
+    state.peer_address = QuicSocketAddress(QuicIpAddress::Loopback6(), 4433);
+    state.encryption_key = std::string(16, 'e');
+    state.encryption_iv = std::string(12, 'E');
+    state.decryption_key = std::string(16, 'd');
+    state.decryption_iv = std::string(12, 'D');
+    state.next_packet_number = 1234;
+    state.smoothed_rtt_us = 30000;
+    state.min_rtt_us = 25000;
+    return state;
+  }
+
+  bool IsOpenFd(int fd) { return fcntl(fd, F_GETFD) != -1; }
+
+  int channel_fds_[2] = {-1, -1};
+};
+
+TEST_F(QuicDrainHandoffChannelTest, RoundTripWithoutFd) {
+  QuicConnectionHandoffState sent = MakeState();
+  ASSERT_TRUE(SendConnectionHandoff(channel_fds_[0], sent, /*udp_fd=*/-1));
+
+  QuicConnectionHandoffState received;
+  int udp_fd = 12345;
+  ASSERT_TRUE(ReceiveConnectionHandoff(channel_fds_[1], &received, &udp_fd));
+
+  EXPECT_EQ(-1, udp_fd);
+  EXPECT_EQ(sent.version_label, received.version_label);
+  EXPECT_EQ(sent.cipher_suite, received.cipher_suite);
+  EXPECT_EQ(sent.server_connection_id, received.server_connection_id);
+  EXPECT_EQ(sent.client_connection_id, received.client_connection_id);
+  EXPECT_EQ(sent.self_address, received.self_address);
+  EXPECT_EQ(sent.peer_address, received.peer_address);
+  EXPECT_EQ(sent.encryption_key, received.encryption_key);
+  EXPECT_EQ(sent.decryption_iv, received.decryption_iv);
+  EXPECT_EQ(sent.next_packet_number, received.next_packet_number);
+  EXPECT_EQ(sent.smoothed_rtt_us, received.smoothed_rtt_us);
+  EXPECT_EQ(sent.min_rtt_us, received.min_rtt_us);
+}
+
+TEST_F(QuicDrainHandoffChannelTest, RoundTripPassesUdpSocket) {
+  int udp_socket = socket(AF_INET, SOCK_DGRAM, 0);
+  ASSERT_GE(udp_socket, 0);
+
+  ASSERT_TRUE(SendConnectionHandoff(channel_fds_[0], MakeState(), udp_socket));
+
+  QuicConnectionHandoffState received;
+  int passed_fd = -1;
+  ASSERT_TRUE(
+      ReceiveConnectionHandoff(channel_fds_[1], &received, &passed_fd));
+
+  // The passed descriptor is a new, open descriptor for the same socket.
+  EXPECT_GE(passed_fd, 0);
+  EXPECT_NE(udp_socket, passed_fd);
+  EXPECT_TRUE(IsOpenFd(passed_fd));
+
+  close(passed_fd);
+  close(udp_socket);
+}
+
+TEST_F(QuicDrainHandoffChannelTest, ReceiveFailsWhenSenderCloses) {
+  close(channel_fds_[0]);
+  channel_fds_[0] = -1;
+
+  QuicConnectionHandoffState received;
+  int passed_fd = -1;
+  EXPECT_FALSE(
+      ReceiveConnectionHandoff(channel_fds_[1], &received, &passed_fd));
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
@@ -0,0 +1,53 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/tools/quic_limits_policy_bus.h"
+
+#include "quic/core/quic_session.h"
+#include "quic/platform/api/quic_logging.h"
+
+namespace quic {
+
+QuicLimitsPolicyBus::QuicLimitsPolicyBus(QuicDispatcher* dispatcher,
+                                         QuicEpollServer* epoll_server)
+    : dispatcher_(dispatcher),
+      epoll_server_(epoll_server),
+      apply_alarm_(this) {}
+
+QuicLimitsPolicyBus::~QuicLimitsPolicyBus() {
+  apply_alarm_.UnregisterIfRegistered();
+}
+
+void QuicLimitsPolicyBus::Publish(const TransportLimits& limits) {
+  limits_ = limits;
+  const bool apply_was_in_progress = apply_in_progress();
+  pending_sessions_ = dispatcher_->GetSessionsSnapshot();
+  QUIC_DLOG(INFO) << "Publishing transport limits to "
+                  << pending_sessions_.size() << " sessions";
+  if (!apply_was_in_progress && !pending_sessions_.empty()) {
+    epoll_server_->RegisterAlarmApproximateDelta(0, &apply_alarm_);
+  }
+}
+
+int64_t QuicLimitsPolicyBus::ApplyAlarm::OnAlarm() {
+  QuicEpollAlarmBase::OnAlarm();
+  bus_->ApplyNextBatch();
+  return 0;
+}
+
+void QuicLimitsPolicyBus::ApplyNextBatch() {
+  for (size_t i = 0; i < kSessionsPerBatch && !pending_sessions_.empty(); ++i) {
+    std::shared_ptr<QuicSession> session = std::move(pending_sessions_.back());
+    pending_sessions_.pop_back();
+    session->RaiseAdvertisedLimits(limits_.max_incoming_bidirectional_streams,
+                                   limits_.max_incoming_unidirectional_streams,
+                                   limits_.session_flow_control_window);
+    ++sessions_updated_;
+  }
+  if (!pending_sessions_.empty()) {
+    epoll_server_->RegisterAlarmApproximateDelta(0, &apply_alarm_);
+  }
+}
+
+}  // namespace quic
@@ -0,0 +1,90 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_TOOLS_QUIC_LIMITS_POLICY_BUS_H_
+#define QUICHE_QUIC_TOOLS_QUIC_LIMITS_POLICY_BUS_H_
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "quic/core/quic_dispatcher.h"
+#include "quic/core/quic_types.h"
+#include "quic/platform/api/quic_epoll.h"
+
+namespace quic {
+
+// Applies server-wide transport limit changes to connections that are
+// already established, without restarting them. The QUIC protocol only
+// allows advertised limits to rise: raised stream limits go out as
+// MAX_STREAMS frames and a raised session flow control window as a
+// WINDOW_UPDATE (see QuicSession::RaiseAdvertisedLimits). Lowered values
+// cannot be applied to live connections and only take effect for new ones
+// through QuicConfig; the idle timeout is negotiated at the handshake and
+// cannot change at all.
+//
+// A published limit set is applied to a snapshot of the connection table in
+// fixed-size batches, one batch per event loop iteration, so a large table
+// does not stall packet processing while every session writes its control
+// frames.
+//
+// Not thread-safe; runs on the event loop thread that owns the dispatcher.
+class QuicLimitsPolicyBus {
+ public:
+  struct TransportLimits {
+    // Zero leaves the corresponding limit unchanged.
+    QuicStreamCount max_incoming_bidirectional_streams = 0;
+    QuicStreamCount max_incoming_unidirectional_streams = 0;
+    QuicByteCount session_flow_control_window = 0;
+  };
+
+  QuicLimitsPolicyBus(QuicDispatcher* dispatcher,
+                      QuicEpollServer* epoll_server);
+  QuicLimitsPolicyBus(const QuicLimitsPolicyBus&) = delete;
+  QuicLimitsPolicyBus& operator=(const QuicLimitsPolicyBus&) = delete;
+
+  ~QuicLimitsPolicyBus();
+
+  // Publishes |limits| to every currently active session. If an earlier
+  // publish is still being applied, the remaining sessions get the new
+  // limits instead; since limits only ratchet upwards, applying the latest
+  // values is always correct.
+  void Publish(const TransportLimits& limits);
+
+  bool apply_in_progress() const { return !pending_sessions_.empty(); }
+
+  // Sessions updated across all publishes so far.
+  size_t sessions_updated() const { return sessions_updated_; }
+
+ private:
+  class ApplyAlarm : public QuicEpollAlarmBase {
+   public:
+    explicit ApplyAlarm(QuicLimitsPolicyBus* bus) : bus_(bus) {}
+
+    int64_t OnAlarm() override;
+
+   private:
+    QuicLimitsPolicyBus* bus_;  // Unowned.
+  };
+
+  // Applies |limits_| to the next batch of pending sessions, re-arming the
+  // alarm if sessions remain.
+  void ApplyNextBatch();
+
+  // Sessions applied per event loop iteration.
+  static const size_t kSessionsPerBatch = 64;
+
+  QuicDispatcher* dispatcher_;     // Unowned.
+  QuicEpollServer* epoll_server_;  // Unowned.
+  ApplyAlarm apply_alarm_;
+  // The most recently published limits, applied to |pending_sessions_|.
+  TransportLimits limits_;
+  // Sessions still awaiting the published limits, consumed from the back.
+  std::vector<std::shared_ptr<QuicSession>> pending_sessions_;
+  size_t sessions_updated_ = 0;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_TOOLS_QUIC_LIMITS_POLICY_BUS_H_
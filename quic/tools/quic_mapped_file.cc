@@ -0,0 +1,66 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/tools/quic_mapped_file.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+
+#include "quic/platform/api/quic_logging.h"
+
+namespace quic {
+
+// static
+std::unique_ptr<QuicMappedFile> QuicMappedFile::Create(
+    const std::string& file_name) {
+  int fd = open(file_name.c_str(), O_RDONLY);
+  if (fd < 0) {
+    QUIC_LOG(WARNING) << "Failed to open " << file_name << " for mapping: "
+                      << strerror(errno);
+    return nullptr;
+  }
+  struct stat file_info;
+  if (fstat(fd, &file_info) != 0) {
+    QUIC_LOG(WARNING) << "Failed to stat " << file_name << ": "
+                      << strerror(errno);
+    close(fd);
+    return nullptr;
+  }
+  const size_t size = file_info.st_size;
+  if (size == 0) {
+    // mmap() rejects zero-length mappings; represent an empty file directly.
+    close(fd);
+    return std::unique_ptr<QuicMappedFile>(new QuicMappedFile(nullptr, 0));
+  }
+  void* base = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // The mapping keeps the file alive; the descriptor is no longer needed.
+  close(fd);
+  if (base == MAP_FAILED) {
+    QUIC_LOG(WARNING) << "Failed to map " << file_name << ": "
+                      << strerror(errno);
+    return nullptr;
+  }
+  // Bodies are streamed front to back; ask for aggressive readahead.
+  madvise(base, size, MADV_SEQUENTIAL);
+  return std::unique_ptr<QuicMappedFile>(new QuicMappedFile(base, size));
+}
+
+QuicMappedFile::~QuicMappedFile() {
+  if (base_ != nullptr) {
+    munmap(base_, size_);
+  }
+}
+
+void QuicMappedFile::EvictPages() {
+  if (base_ != nullptr) {
+    madvise(base_, size_, MADV_DONTNEED);
+  }
+}
+
+}  // namespace quic
@@ -0,0 +1,58 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_TOOLS_QUIC_MAPPED_FILE_H_
+#define QUICHE_QUIC_TOOLS_QUIC_MAPPED_FILE_H_
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "absl/strings/string_view.h"
+
+namespace quic {
+
+// A read-only memory mapping of a file. Pages are faulted in lazily by the
+// kernel, so mapping a file is a metadata-only operation and bodies served
+// from a mapping never occupy anonymous memory. The mapping is advised for
+// sequential access, matching how response bodies are streamed.
+class QuicMappedFile {
+ public:
+  // Maps |file_name| read-only. Returns nullptr if the file cannot be opened
+  // or mapped.
+  static std::unique_ptr<QuicMappedFile> Create(const std::string& file_name);
+
+  QuicMappedFile(const QuicMappedFile&) = delete;
+  QuicMappedFile& operator=(const QuicMappedFile&) = delete;
+  ~QuicMappedFile();
+
+  // The complete file contents. Valid for the lifetime of this object.
+  absl::string_view data() const {
+    return absl::string_view(static_cast<const char*>(base_), size_);
+  }
+
+  // Tells the kernel the resident pages of this mapping are not needed.
+  // The data remains valid; subsequent accesses fault the pages back in.
+  void EvictPages();
+
+  // Second-chance bookkeeping used to find cold mappings: readers mark a
+  // mapping on use, and an eviction pass clears the mark.
+  void MarkRecentlyUsed() { recently_used_ = true; }
+  bool TestAndClearRecentlyUsed() {
+    const bool used = recently_used_;
+    recently_used_ = false;
+    return used;
+  }
+
+ private:
+  QuicMappedFile(void* base, size_t size) : base_(base), size_(size) {}
+
+  void* base_;
+  size_t size_;
+  bool recently_used_ = true;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_TOOLS_QUIC_MAPPED_FILE_H_
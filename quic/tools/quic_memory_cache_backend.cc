@@ -13,6 +13,7 @@
 #include "quic/core/http/spdy_utils.h"
 #include "quic/platform/api/quic_bug_tracker.h"
 #include "quic/platform/api/quic_logging.h"
+#include "quic/tools/quic_corpus_archive.h"
 #include "quic/tools/web_transport_test_visitors.h"
 #include "common/platform/api/quiche_file_utils.h"
 #include "common/quiche_text_utils.h"
@@ -36,21 +37,38 @@ void QuicMemoryCacheBackend::ResourceFile::Read() {
     return;
   }
   file_contents_ = *maybe_file_contents;
+  ParseContents(file_contents_);
+}
+
+void QuicMemoryCacheBackend::ResourceFile::ReadMapped() {
+  mapped_file_ = QuicMappedFile::Create(file_name_);
+  if (mapped_file_ == nullptr) {
+    QUIC_LOG(WARNING) << "Failed to map file for the memory cache backend, "
+                      << "reading it instead: " << file_name_;
+    Read();
+    return;
+  }
+  // Parsing only touches the header bytes at the front of the mapping; the
+  // body pages stay untouched until the response is served.
+  ParseContents(mapped_file_->data());
+}
 
+void QuicMemoryCacheBackend::ResourceFile::ParseContents(
+    absl::string_view contents) {
   // First read the headers.
   size_t start = 0;
-  while (start < file_contents_.length()) {
-    size_t pos = file_contents_.find('\n', start);
-    if (pos == std::string::npos) {
+  while (start < contents.length()) {
+    size_t pos = contents.find('\n', start);
+    if (pos == absl::string_view::npos) {
       QUIC_LOG(DFATAL) << "Headers invalid or empty, ignoring: " << file_name_;
       return;
     }
     size_t len = pos - start;
     // Support both dos and unix line endings for convenience.
-    if (file_contents_[pos - 1] == '\r') {
+    if (contents[pos - 1] == '\r') {
       len -= 1;
     }
-    absl::string_view line(file_contents_.data() + start, len);
+    absl::string_view line(contents.data() + start, len);
     start = pos + 1;
     // Headers end with an empty line.
     if (line.empty()) {
@@ -107,8 +125,7 @@ void QuicMemoryCacheBackend::ResourceFile::Read() {
     }
   }
 
-  body_ = absl::string_view(file_contents_.data() + start,
-                            file_contents_.size() - start);
+  body_ = absl::string_view(contents.data() + start, contents.size() - start);
 }
 
 void QuicMemoryCacheBackend::ResourceFile::SetHostPathFromBase(
@@ -167,6 +184,10 @@ const QuicBackendResponse* QuicMemoryCacheBackend::GetResponse(
     }
     return nullptr;
   }
+  if (it->second->mapped_file() != nullptr) {
+    // Keep the mapping's pages resident across the next eviction pass.
+    it->second->mapped_file()->MarkRecentlyUsed();
+  }
   return it->second.get();
 }
 
@@ -275,10 +296,23 @@ bool QuicMemoryCacheBackend::InitializeBackend(
     }
 
     resource_file->SetHostPathFromBase(base);
-    resource_file->Read();
+    if (use_mapped_files_) {
+      resource_file->ReadMapped();
+    } else {
+      resource_file->Read();
+    }
 
-    AddResponse(resource_file->host(), resource_file->path(),
-                resource_file->spdy_headers().Clone(), resource_file->body());
+    std::unique_ptr<QuicMappedFile> mapped_file =
+        resource_file->ReleaseMappedFile();
+    if (mapped_file != nullptr) {
+      AddMappedResponse(resource_file->host(), resource_file->path(),
+                        resource_file->spdy_headers().Clone(),
+                        std::move(mapped_file), resource_file->body());
+    } else {
+      AddResponse(resource_file->host(), resource_file->path(),
+                  resource_file->spdy_headers().Clone(),
+                  resource_file->body());
+    }
 
     resource_files.push_back(std::move(resource_file));
   }
@@ -305,6 +339,49 @@ bool QuicMemoryCacheBackend::InitializeBackend(
   return true;
 }
 
+bool QuicMemoryCacheBackend::InitializeBackendFromArchive(
+    const std::string& archive_file) {
+  QUIC_LOG(INFO)
+      << "Attempting to initialize QuicMemoryCacheBackend from archive: "
+      << archive_file;
+  std::unique_ptr<QuicMappedFile> archive =
+      QuicMappedFile::Create(archive_file);
+  if (archive == nullptr) {
+    QUIC_LOG(ERROR) << "Can't map corpus archive: " << archive_file;
+    return false;
+  }
+  std::vector<QuicCorpusArchiveEntry> entries;
+  if (!ReadCorpusArchive(archive->data(), &entries)) {
+    QUIC_LOG(ERROR) << "Can't parse corpus archive: " << archive_file;
+    return false;
+  }
+
+  {
+    QuicWriterMutexLock lock(&response_mutex_);
+    for (QuicCorpusArchiveEntry& entry : entries) {
+      std::string key = GetKey(entry.host, entry.path);
+      if (responses_.contains(key)) {
+        QUIC_BUG(quic_bug_archive_response_exists)
+            << "Response for '" << key << "' already exists!";
+        return false;
+      }
+      auto new_response = std::make_unique<QuicBackendResponse>();
+      new_response->set_response_type(QuicBackendResponse::REGULAR_RESPONSE);
+      new_response->set_headers(std::move(entry.headers));
+      // The body stays a view into the archive mapping; the page holding it
+      // is only faulted in when the response is first served.
+      new_response->set_body_view(entry.body);
+      responses_[key] = std::move(new_response);
+    }
+    corpus_archives_.push_back(std::move(archive));
+  }
+
+  QUIC_LOG(INFO) << "Loaded " << entries.size()
+                 << " responses from corpus archive.";
+  cache_initialized_ = true;
+  return true;
+}
+
 void QuicMemoryCacheBackend::GenerateDynamicResponses() {
   QuicWriterMutexLock lock(&response_mutex_);
   // Add a generate bytes response.
@@ -320,6 +397,29 @@ void QuicMemoryCacheBackend::EnableWebTransport() {
   enable_webtransport_ = true;
 }
 
+void QuicMemoryCacheBackend::EnableMappedFiles() {
+  QUIC_BUG_IF(quic_bug_mapped_files_after_init, cache_initialized_)
+      << "EnableMappedFiles() must be called before InitializeBackend().";
+  use_mapped_files_ = true;
+}
+
+size_t QuicMemoryCacheBackend::EvictColdMappedBodies() {
+  QuicWriterMutexLock lock(&response_mutex_);
+  size_t num_evicted = 0;
+  for (auto& response : responses_) {
+    QuicMappedFile* mapped_file = response.second->mapped_file();
+    if (mapped_file == nullptr) {
+      continue;
+    }
+    if (!mapped_file->TestAndClearRecentlyUsed()) {
+      mapped_file->EvictPages();
+      ++num_evicted;
+    }
+  }
+  QUIC_DVLOG(1) << "Evicted pages of " << num_evicted << " cold mappings";
+  return num_evicted;
+}
+
 bool QuicMemoryCacheBackend::IsBackendInitialized() const {
   return cache_initialized_;
 }
@@ -349,6 +449,27 @@ void QuicMemoryCacheBackend::FetchResponseFromBackend(
   quic_stream->OnResponseBackendComplete(quic_response);
 }
 
+std::vector<Http2HeaderBlock> QuicMemoryCacheBackend::GetEarlyHints(
+    const Http2HeaderBlock& request_headers) {
+  std::vector<Http2HeaderBlock> early_hints;
+  auto authority = request_headers.find(":authority");
+  auto path = request_headers.find(":path");
+  if (authority == request_headers.end() || path == request_headers.end()) {
+    return early_hints;
+  }
+  // The cache knows the response up front, so its hints are available as soon
+  // as the request headers arrive.
+  const QuicBackendResponse* response =
+      GetResponse(authority->second, path->second);
+  if (response == nullptr) {
+    return early_hints;
+  }
+  for (const Http2HeaderBlock& hints : response->early_hints()) {
+    early_hints.push_back(hints.Clone());
+  }
+  return early_hints;
+}
+
 // The memory cache does not have a per-stream handler
 void QuicMemoryCacheBackend::CloseBackendResponseStream(
     QuicSimpleServerBackend::RequestHandler* /*quic_stream*/) {}
@@ -430,6 +551,29 @@ void QuicMemoryCacheBackend::AddResponseImpl(
   responses_[key] = std::move(new_response);
 }
 
+void QuicMemoryCacheBackend::AddMappedResponse(
+    absl::string_view host, absl::string_view path,
+    Http2HeaderBlock response_headers,
+    std::unique_ptr<QuicMappedFile> mapped_file,
+    absl::string_view response_body) {
+  QuicWriterMutexLock lock(&response_mutex_);
+
+  QUICHE_DCHECK(!host.empty())
+      << "Host must be populated, e.g. \"www.google.com\"";
+  std::string key = GetKey(host, path);
+  if (responses_.contains(key)) {
+    QUIC_BUG(quic_bug_mapped_response_exists)
+        << "Response for '" << key << "' already exists!";
+    return;
+  }
+  auto new_response = std::make_unique<QuicBackendResponse>();
+  new_response->set_response_type(QuicBackendResponse::REGULAR_RESPONSE);
+  new_response->set_headers(std::move(response_headers));
+  new_response->set_mapped_body(std::move(mapped_file), response_body);
+  QUIC_DVLOG(1) << "Add mapped response with key " << key;
+  responses_[key] = std::move(new_response);
+}
+
 std::string QuicMemoryCacheBackend::GetKey(absl::string_view host,
                                            absl::string_view path) const {
   std::string host_string = std::string(host);
@@ -16,6 +16,7 @@
 #include "quic/platform/api/quic_containers.h"
 #include "quic/platform/api/quic_mutex.h"
 #include "quic/tools/quic_backend_response.h"
+#include "quic/tools/quic_mapped_file.h"
 #include "quic/tools/quic_simple_server_backend.h"
 #include "quic/tools/quic_url.h"
 #include "spdy/core/spdy_framer.h"
@@ -40,6 +41,11 @@ class QuicMemoryCacheBackend : public QuicSimpleServerBackend {
 
     void Read();
 
+    // Like Read(), but backs the contents with a lazily paged-in file
+    // mapping instead of an in-memory copy. Falls back to Read() if the
+    // file cannot be mapped.
+    void ReadMapped();
+
     // |base| is |file_name_| with |cache_directory| prefix stripped.
     void SetHostPathFromBase(absl::string_view base);
 
@@ -55,12 +61,21 @@ class QuicMemoryCacheBackend : public QuicSimpleServerBackend {
 
     const std::vector<absl::string_view>& push_urls() { return push_urls_; }
 
+    // Transfers ownership of the file mapping created by ReadMapped(), or
+    // nullptr if the contents were read into memory. body() and the parsed
+    // headers point into the mapping, so the caller must keep it alive.
+    std::unique_ptr<QuicMappedFile> ReleaseMappedFile() {
+      return std::move(mapped_file_);
+    }
+
    private:
+    void ParseContents(absl::string_view contents);
     void HandleXOriginalUrl();
     absl::string_view RemoveScheme(absl::string_view url);
 
     std::string file_name_;
     std::string file_contents_;
+    std::unique_ptr<QuicMappedFile> mapped_file_;
     absl::string_view body_;
     spdy::Http2HeaderBlock spdy_headers_;
     absl::string_view x_original_url_;
@@ -142,11 +157,32 @@ class QuicMemoryCacheBackend : public QuicSimpleServerBackend {
 
   void EnableWebTransport();
 
+  // Once called, InitializeBackend() serves response bodies as zero-copy
+  // views over file mappings instead of loading them into memory. Startup
+  // then touches only the header bytes of each file, and large bodies are
+  // paged in on demand. Must be called before InitializeBackend().
+  void EnableMappedFiles();
+
+  // Drops the resident pages of every mapped response body that has not
+  // been served since the previous call, returning the number of mappings
+  // evicted. Bodies remain valid; cold pages are simply given back to the
+  // kernel. Intended to be called periodically when serving a corpus much
+  // larger than memory.
+  size_t EvictColdMappedBodies();
+
   // Find all the server push resources associated with |request_url|.
   // TODO(b/171463363): Remove.
   std::list<QuicBackendResponse::ServerPushInfo> GetServerPushResources(
       std::string request_url);
 
+  // Initializes the backend from a packed corpus archive produced by
+  // QuicCorpusArchiveWriter instead of a directory tree. The archive is
+  // mapped once and the response map is built from its index alone, so
+  // startup cost is bounded by the index size; body pages fault in the
+  // first time a response is served. Bodies remain views into the archive
+  // mapping, which stays alive for the lifetime of the backend.
+  bool InitializeBackendFromArchive(const std::string& archive_file);
+
   // Implements the functions for interface QuicSimpleServerBackend
   // |cache_cirectory| can be generated using `wget -p --save-headers <url>`.
   bool InitializeBackend(const std::string& cache_directory) override;
@@ -155,6 +191,10 @@ class QuicMemoryCacheBackend : public QuicSimpleServerBackend {
       const spdy::Http2HeaderBlock& request_headers,
       const std::string& request_body,
       QuicSimpleServerBackend::RequestHandler* quic_server_stream) override;
+  // Cache lookups complete within FetchResponseFromBackend().
+  bool CanFetchSynchronously() const override { return true; }
+  std::vector<spdy::Http2HeaderBlock> GetEarlyHints(
+      const spdy::Http2HeaderBlock& request_headers) override;
   void CloseBackendResponseStream(
       QuicSimpleServerBackend::RequestHandler* quic_server_stream) override;
   WebTransportResponse ProcessWebTransportRequest(
@@ -171,6 +211,13 @@ class QuicMemoryCacheBackend : public QuicSimpleServerBackend {
                        spdy::Http2HeaderBlock response_trailers,
                        const std::vector<spdy::Http2HeaderBlock>& early_hints);
 
+  // Adds a response whose body is a zero-copy view into |mapped_file|.
+  void AddMappedResponse(absl::string_view host,
+                         absl::string_view path,
+                         spdy::Http2HeaderBlock response_headers,
+                         std::unique_ptr<QuicMappedFile> mapped_file,
+                         absl::string_view response_body);
+
   std::string GetKey(absl::string_view host, absl::string_view path) const;
 
   // Add some server push urls with given responses for specified
@@ -191,6 +238,11 @@ class QuicMemoryCacheBackend : public QuicSimpleServerBackend {
   absl::flat_hash_map<std::string, std::unique_ptr<QuicBackendResponse>>
       responses_ QUIC_GUARDED_BY(response_mutex_);
 
+  // Mappings of loaded corpus archives. Responses loaded from an archive
+  // hold body views into these, so the mappings live as long as the backend.
+  std::vector<std::unique_ptr<QuicMappedFile>> corpus_archives_
+      QUIC_GUARDED_BY(response_mutex_);
+
   // The default response for cache misses, if set.
   std::unique_ptr<QuicBackendResponse> default_response_
       QUIC_GUARDED_BY(response_mutex_);
@@ -210,6 +262,9 @@ class QuicMemoryCacheBackend : public QuicSimpleServerBackend {
   bool cache_initialized_;
 
   bool enable_webtransport_ = false;
+
+  // If true, InitializeBackend() maps resource files instead of reading them.
+  bool use_mapped_files_ = false;
 };
 
 }  // namespace quic
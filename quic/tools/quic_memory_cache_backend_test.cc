@@ -10,6 +10,7 @@
 #include "absl/strings/str_cat.h"
 #include "quic/platform/api/quic_test.h"
 #include "quic/tools/quic_backend_response.h"
+#include "quic/tools/quic_corpus_archive.h"
 #include "common/platform/api/quiche_file_utils.h"
 
 namespace quic {
@@ -95,6 +96,112 @@ TEST_F(QuicMemoryCacheBackendTest, MAYBE_ReadsCacheDir) {
   EXPECT_LT(0U, response->body().length());
 }
 
+// TODO(crbug.com/1249712) This test is failing on iOS.
+#if defined(OS_IOS)
+#define MAYBE_ReadsCacheDirMapped DISABLED_ReadsCacheDirMapped
+#else
+#define MAYBE_ReadsCacheDirMapped ReadsCacheDirMapped
+#endif
+TEST_F(QuicMemoryCacheBackendTest, MAYBE_ReadsCacheDirMapped) {
+  cache_.EnableMappedFiles();
+  cache_.InitializeBackend(CacheDirectory());
+  const Response* response =
+      cache_.GetResponse("test.example.com", "/index.html");
+  ASSERT_TRUE(response);
+  ASSERT_TRUE(response->headers().contains(":status"));
+  EXPECT_EQ("200", response->headers().find(":status")->second);
+  // The body is served directly from the file mapping.
+  ASSERT_TRUE(response->mapped_file() != nullptr);
+  EXPECT_LT(0U, response->body().length());
+
+  // The mapped body matches what the in-memory mode serves.
+  QuicMemoryCacheBackend unmapped_cache;
+  unmapped_cache.InitializeBackend(CacheDirectory());
+  const Response* unmapped_response =
+      unmapped_cache.GetResponse("test.example.com", "/index.html");
+  ASSERT_TRUE(unmapped_response);
+  EXPECT_EQ(unmapped_response->body(), response->body());
+}
+
+// TODO(crbug.com/1249712) This test is failing on iOS.
+#if defined(OS_IOS)
+#define MAYBE_EvictColdMappedBodies DISABLED_EvictColdMappedBodies
+#else
+#define MAYBE_EvictColdMappedBodies EvictColdMappedBodies
+#endif
+TEST_F(QuicMemoryCacheBackendTest, MAYBE_EvictColdMappedBodies) {
+  cache_.EnableMappedFiles();
+  cache_.InitializeBackend(CacheDirectory());
+
+  // Freshly initialized mappings count as recently used; the first pass only
+  // clears the marks.
+  EXPECT_EQ(0u, cache_.EvictColdMappedBodies());
+  // Nothing was served since, so every mapping is now cold.
+  size_t num_mapped = cache_.EvictColdMappedBodies();
+  EXPECT_LT(0u, num_mapped);
+
+  // Serving a response keeps its mapping warm, and the evicted bodies are
+  // still readable afterwards.
+  const Response* response =
+      cache_.GetResponse("test.example.com", "/index.html");
+  ASSERT_TRUE(response);
+  EXPECT_EQ(num_mapped - 1, cache_.EvictColdMappedBodies());
+  EXPECT_LT(0U, response->body().length());
+}
+
+TEST_F(QuicMemoryCacheBackendTest, LoadsCorpusArchive) {
+  const std::string kBody1 = "archived body one";
+  const std::string kBody2 = "archived body two";
+
+  QuicCorpusArchiveWriter writer;
+  spdy::Http2HeaderBlock headers1;
+  headers1[":status"] = "200";
+  headers1["content-length"] = absl::StrCat(kBody1.size());
+  writer.AddEntry("www.example.com", "/one", headers1, kBody1);
+  spdy::Http2HeaderBlock headers2;
+  headers2[":status"] = "404";
+  headers2["content-length"] = absl::StrCat(kBody2.size());
+  writer.AddEntry("www.example.com", "/two", headers2, kBody2);
+
+  std::string archive_file =
+      absl::StrCat(::testing::TempDir(), "/quic_corpus_archive_test.qca");
+  ASSERT_TRUE(writer.WriteToFile(archive_file));
+  ASSERT_TRUE(cache_.InitializeBackendFromArchive(archive_file));
+  EXPECT_TRUE(cache_.IsBackendInitialized());
+
+  const Response* response = cache_.GetResponse("www.example.com", "/one");
+  ASSERT_TRUE(response);
+  ASSERT_TRUE(response->headers().contains(":status"));
+  EXPECT_EQ("200", response->headers().find(":status")->second);
+  EXPECT_EQ(kBody1, response->body());
+
+  response = cache_.GetResponse("www.example.com", "/two");
+  ASSERT_TRUE(response);
+  EXPECT_EQ("404", response->headers().find(":status")->second);
+  EXPECT_EQ(kBody2, response->body());
+}
+
+TEST_F(QuicMemoryCacheBackendTest, RejectsTruncatedCorpusArchive) {
+  QuicCorpusArchiveWriter writer;
+  spdy::Http2HeaderBlock headers;
+  headers[":status"] = "200";
+  writer.AddEntry("www.example.com", "/", headers, "body");
+
+  // Cut the archive off in the middle of the index.
+  std::string archive = writer.Serialize();
+  std::vector<QuicCorpusArchiveEntry> entries;
+  EXPECT_FALSE(
+      ReadCorpusArchive(absl::string_view(archive).substr(0, 16), &entries));
+  // The intact archive parses, and the body is a view into the archive
+  // bytes rather than a copy.
+  ASSERT_TRUE(ReadCorpusArchive(archive, &entries));
+  ASSERT_EQ(1u, entries.size());
+  EXPECT_EQ("body", entries[0].body);
+  EXPECT_GE(entries[0].body.data(), archive.data());
+  EXPECT_LE(entries[0].body.data() + entries[0].body.size(),
+            archive.data() + archive.size());
+}
+
 // TODO(crbug.com/1249712) This test is failing on iOS.
 #if defined(OS_IOS)
 #define MAYBE_ReadsCacheDirWithServerPushResource \
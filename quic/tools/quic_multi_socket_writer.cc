@@ -0,0 +1,115 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/tools/quic_multi_socket_writer.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+#include "quic/platform/api/quic_bug_tracker.h"
+
+namespace quic {
+
+QuicMultiSocketWriter::QuicMultiSocketWriter() = default;
+
+QuicMultiSocketWriter::~QuicMultiSocketWriter() = default;
+
+void QuicMultiSocketWriter::AddWriter(const QuicIpAddress& self_ip,
+                                      std::unique_ptr<QuicPacketWriter> writer) {
+  QUIC_BUG_IF(quic_multi_socket_writer_mixed_batch_mode,
+              !writers_.empty() && writer->IsBatchMode() != IsBatchMode())
+      << "All writers of a QuicMultiSocketWriter must agree on batch mode";
+  writers_.push_back(Entry{self_ip, std::move(writer)});
+}
+
+QuicPacketWriter* QuicMultiSocketWriter::SelectWriter(
+    const QuicIpAddress& self_address) const {
+  for (const Entry& entry : writers_) {
+    if (entry.self_ip == self_address) {
+      return entry.writer.get();
+    }
+  }
+  return writers_.front().writer.get();
+}
+
+WriteResult QuicMultiSocketWriter::WritePacket(
+    const char* buffer,
+    size_t buf_len,
+    const QuicIpAddress& self_address,
+    const QuicSocketAddress& peer_address,
+    PerPacketOptions* options) {
+  return SelectWriter(self_address)
+      ->WritePacket(buffer, buf_len, self_address, peer_address, options);
+}
+
+bool QuicMultiSocketWriter::IsWriteBlocked() const {
+  // The dispatcher treats the writer as one entity; report blocked if any
+  // socket is, and rely on SetWritable() to clear them all once the event
+  // loop reports writability.
+  for (const Entry& entry : writers_) {
+    if (entry.writer->IsWriteBlocked()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void QuicMultiSocketWriter::SetWritable() {
+  for (Entry& entry : writers_) {
+    entry.writer->SetWritable();
+  }
+}
+
+QuicByteCount QuicMultiSocketWriter::GetMaxPacketSize(
+    const QuicSocketAddress& peer_address) const {
+  QuicByteCount max_packet_size = std::numeric_limits<QuicByteCount>::max();
+  for (const Entry& entry : writers_) {
+    max_packet_size =
+        std::min(max_packet_size, entry.writer->GetMaxPacketSize(peer_address));
+  }
+  return max_packet_size;
+}
+
+bool QuicMultiSocketWriter::SupportsReleaseTime() const {
+  // Release time is only usable if every socket the packet might leave
+  // through supports it.
+  for (const Entry& entry : writers_) {
+    if (!entry.writer->SupportsReleaseTime()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool QuicMultiSocketWriter::IsBatchMode() const {
+  return writers_.front().writer->IsBatchMode();
+}
+
+QuicPacketBuffer QuicMultiSocketWriter::GetNextWriteLocation(
+    const QuicIpAddress& self_address,
+    const QuicSocketAddress& peer_address) {
+  return SelectWriter(self_address)
+      ->GetNextWriteLocation(self_address, peer_address);
+}
+
+WriteResult QuicMultiSocketWriter::Flush() {
+  WriteResult result(WRITE_STATUS_OK, 0);
+  for (Entry& entry : writers_) {
+    const WriteResult entry_result = entry.writer->Flush();
+    if (IsWriteError(entry_result.status)) {
+      return entry_result;
+    }
+    if (IsWriteBlockedStatus(entry_result.status)) {
+      result = entry_result;
+      continue;
+    }
+    if (result.status == WRITE_STATUS_OK) {
+      result.bytes_written += entry_result.bytes_written;
+    }
+  }
+  return result;
+}
+
+}  // namespace quic
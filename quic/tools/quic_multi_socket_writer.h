@@ -0,0 +1,75 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_TOOLS_QUIC_MULTI_SOCKET_WRITER_H_
+#define QUICHE_QUIC_TOOLS_QUIC_MULTI_SOCKET_WRITER_H_
+
+#include <memory>
+#include <vector>
+
+#include "quic/core/quic_packet_writer.h"
+#include "quic/platform/api/quic_ip_address.h"
+#include "quic/platform/api/quic_socket_address.h"
+
+namespace quic {
+
+// A packet writer that routes each outgoing packet to one of several
+// per-socket writers, keyed by the packet's self address. A server listening
+// on multiple addresses (dual-stack, multi-homed) reads from several sockets
+// into one dispatcher; responses must leave through the socket the request
+// arrived on, or the kernel would rewrite the source address and the client
+// would drop the reply. Each underlying writer keeps its own socket state,
+// so batching and release-time pacing remain per socket.
+//
+// Packets whose self address does not match any registered writer (for
+// example when the matching socket is bound to a wildcard address) fall back
+// to the first writer added.
+class QuicMultiSocketWriter : public QuicPacketWriter {
+ public:
+  QuicMultiSocketWriter();
+  QuicMultiSocketWriter(const QuicMultiSocketWriter&) = delete;
+  QuicMultiSocketWriter& operator=(const QuicMultiSocketWriter&) = delete;
+  ~QuicMultiSocketWriter() override;
+
+  // Registers |writer| as the egress for packets whose self address is
+  // |self_ip|. The first writer added is also the fallback for unmatched
+  // self addresses. All writers must agree on batch mode.
+  void AddWriter(const QuicIpAddress& self_ip,
+                 std::unique_ptr<QuicPacketWriter> writer);
+
+  size_t num_writers() const { return writers_.size(); }
+
+  // QuicPacketWriter implementation. Per-packet calls are routed by self
+  // address; aggregate queries combine conservatively across all writers.
+  WriteResult WritePacket(const char* buffer,
+                          size_t buf_len,
+                          const QuicIpAddress& self_address,
+                          const QuicSocketAddress& peer_address,
+                          PerPacketOptions* options) override;
+  bool IsWriteBlocked() const override;
+  void SetWritable() override;
+  QuicByteCount GetMaxPacketSize(
+      const QuicSocketAddress& peer_address) const override;
+  bool SupportsReleaseTime() const override;
+  bool IsBatchMode() const override;
+  QuicPacketBuffer GetNextWriteLocation(
+      const QuicIpAddress& self_address,
+      const QuicSocketAddress& peer_address) override;
+  WriteResult Flush() override;
+
+ private:
+  struct Entry {
+    QuicIpAddress self_ip;
+    std::unique_ptr<QuicPacketWriter> writer;
+  };
+
+  // Returns the writer registered for |self_address|, or the fallback.
+  QuicPacketWriter* SelectWriter(const QuicIpAddress& self_address) const;
+
+  std::vector<Entry> writers_;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_TOOLS_QUIC_MULTI_SOCKET_WRITER_H_
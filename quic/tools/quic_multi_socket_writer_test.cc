@@ -0,0 +1,133 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/tools/quic_multi_socket_writer.h"
+
+#include <cerrno>
+#include <memory>
+#include <utility>
+
+#include "quic/platform/api/quic_test.h"
+#include "quic/test_tools/quic_test_utils.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+using testing::Return;
+using testing::StrictMock;
+
+class QuicMultiSocketWriterTest : public QuicTest {
+ protected:
+  QuicMultiSocketWriterTest()
+      : v4_ip_(QuicIpAddress::Loopback4()),
+        v6_ip_(QuicIpAddress::Loopback6()),
+        peer_address_(QuicIpAddress::Loopback4(), 12345) {
+    auto v4_writer = std::make_unique<StrictMock<MockPacketWriter>>();
+    auto v6_writer = std::make_unique<StrictMock<MockPacketWriter>>();
+    v4_writer_ = v4_writer.get();
+    v6_writer_ = v6_writer.get();
+    // AddWriter checks that all writers agree on batch mode.
+    EXPECT_CALL(*v4_writer_, IsBatchMode()).WillRepeatedly(Return(false));
+    EXPECT_CALL(*v6_writer_, IsBatchMode()).WillRepeatedly(Return(false));
+    writer_.AddWriter(v4_ip_, std::move(v4_writer));
+    writer_.AddWriter(v6_ip_, std::move(v6_writer));
+  }
+
+  QuicIpAddress v4_ip_;
+  QuicIpAddress v6_ip_;
+  QuicSocketAddress peer_address_;
+  QuicMultiSocketWriter writer_;
+  StrictMock<MockPacketWriter>* v4_writer_;  // Owned by writer_.
+  StrictMock<MockPacketWriter>* v6_writer_;  // Owned by writer_.
+};
+
+TEST_F(QuicMultiSocketWriterTest, RoutesBySelfAddress) {
+  char packet[] = "packet";
+  EXPECT_CALL(*v6_writer_,
+              WritePacket(packet, sizeof(packet), v6_ip_, peer_address_,
+                          nullptr))
+      .WillOnce(Return(WriteResult(WRITE_STATUS_OK, sizeof(packet))));
+  EXPECT_EQ(WriteResult(WRITE_STATUS_OK, sizeof(packet)),
+            writer_.WritePacket(packet, sizeof(packet), v6_ip_, peer_address_,
+                                nullptr));
+
+  EXPECT_CALL(*v4_writer_,
+              WritePacket(packet, sizeof(packet), v4_ip_, peer_address_,
+                          nullptr))
+      .WillOnce(Return(WriteResult(WRITE_STATUS_OK, sizeof(packet))));
+  EXPECT_EQ(WriteResult(WRITE_STATUS_OK, sizeof(packet)),
+            writer_.WritePacket(packet, sizeof(packet), v4_ip_, peer_address_,
+                                nullptr));
+}
+
+TEST_F(QuicMultiSocketWriterTest, UnmatchedSelfAddressUsesFirstWriter) {
+  char packet[] = "packet";
+  QuicIpAddress other_ip;
+  other_ip.FromString("192.0.2.1");
+  EXPECT_CALL(*v4_writer_,
+              WritePacket(packet, sizeof(packet), other_ip, peer_address_,
+                          nullptr))
+      .WillOnce(Return(WriteResult(WRITE_STATUS_OK, sizeof(packet))));
+  EXPECT_EQ(WriteResult(WRITE_STATUS_OK, sizeof(packet)),
+            writer_.WritePacket(packet, sizeof(packet), other_ip,
+                                peer_address_, nullptr));
+}
+
+TEST_F(QuicMultiSocketWriterTest, BlockedIfAnySocketIsBlocked) {
+  EXPECT_CALL(*v4_writer_, IsWriteBlocked()).WillRepeatedly(Return(false));
+  EXPECT_CALL(*v6_writer_, IsWriteBlocked()).WillRepeatedly(Return(false));
+  EXPECT_FALSE(writer_.IsWriteBlocked());
+
+  EXPECT_CALL(*v6_writer_, IsWriteBlocked()).WillRepeatedly(Return(true));
+  EXPECT_TRUE(writer_.IsWriteBlocked());
+
+  // SetWritable clears every socket.
+  EXPECT_CALL(*v4_writer_, SetWritable());
+  EXPECT_CALL(*v6_writer_, SetWritable());
+  writer_.SetWritable();
+}
+
+TEST_F(QuicMultiSocketWriterTest, MaxPacketSizeIsSmallestAcrossSockets) {
+  EXPECT_CALL(*v4_writer_, GetMaxPacketSize(peer_address_))
+      .WillOnce(Return(1500));
+  EXPECT_CALL(*v6_writer_, GetMaxPacketSize(peer_address_))
+      .WillOnce(Return(1350));
+  EXPECT_EQ(1350u, writer_.GetMaxPacketSize(peer_address_));
+}
+
+TEST_F(QuicMultiSocketWriterTest, ReleaseTimeRequiresAllSockets) {
+  EXPECT_CALL(*v4_writer_, SupportsReleaseTime()).WillRepeatedly(Return(true));
+  EXPECT_CALL(*v6_writer_, SupportsReleaseTime()).WillRepeatedly(Return(false));
+  EXPECT_FALSE(writer_.SupportsReleaseTime());
+
+  EXPECT_CALL(*v6_writer_, SupportsReleaseTime()).WillRepeatedly(Return(true));
+  EXPECT_TRUE(writer_.SupportsReleaseTime());
+}
+
+TEST_F(QuicMultiSocketWriterTest, FlushCombinesResults) {
+  EXPECT_CALL(*v4_writer_, Flush())
+      .WillOnce(Return(WriteResult(WRITE_STATUS_OK, 100)));
+  EXPECT_CALL(*v6_writer_, Flush())
+      .WillOnce(Return(WriteResult(WRITE_STATUS_OK, 50)));
+  WriteResult result = writer_.Flush();
+  EXPECT_EQ(WRITE_STATUS_OK, result.status);
+  EXPECT_EQ(150, result.bytes_written);
+
+  // A blocked socket makes the flush blocked, but the others still drain.
+  EXPECT_CALL(*v4_writer_, Flush())
+      .WillOnce(Return(WriteResult(WRITE_STATUS_BLOCKED, 0)));
+  EXPECT_CALL(*v6_writer_, Flush())
+      .WillOnce(Return(WriteResult(WRITE_STATUS_OK, 50)));
+  EXPECT_EQ(WRITE_STATUS_BLOCKED, writer_.Flush().status);
+
+  // An error aborts the flush.
+  EXPECT_CALL(*v4_writer_, Flush())
+      .WillOnce(Return(WriteResult(WRITE_STATUS_ERROR, EIO)));
+  EXPECT_EQ(WRITE_STATUS_ERROR, writer_.Flush().status);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
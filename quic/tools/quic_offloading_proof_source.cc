@@ -0,0 +1,286 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/tools/quic_offloading_proof_source.h"
+
+#include <utility>
+
+#include "quic/platform/api/quic_logging.h"
+
+namespace quic {
+
+class QuicOffloadingProofSource::ForwardingCallback
+    : public ProofSource::SignatureCallback {
+ public:
+  ForwardingCallback(QuicOffloadingProofSource* owner,
+                     std::unique_ptr<SignatureCallback> wrapped)
+      : owner_(owner), wrapped_(std::move(wrapped)) {}
+
+  void Run(bool ok,
+           std::string signature,
+           std::unique_ptr<Details> details) override {
+    owner_->OnSignatureComputed(std::move(wrapped_), ok, std::move(signature),
+                                std::move(details));
+  }
+
+ private:
+  QuicOffloadingProofSource* owner_;
+  std::unique_ptr<SignatureCallback> wrapped_;
+};
+
+class QuicOffloadingProofSource::ForwardingDecryptCallback
+    : public ProofSource::DecryptCallback {
+ public:
+  ForwardingDecryptCallback(QuicOffloadingProofSource* owner,
+                            std::unique_ptr<DecryptCallback> wrapped)
+      : owner_(owner), wrapped_(std::move(wrapped)) {}
+
+  void Run(std::vector<uint8_t> plaintext) override {
+    owner_->OnTicketDecrypted(std::move(wrapped_), std::move(plaintext));
+  }
+
+ private:
+  QuicOffloadingProofSource* owner_;
+  std::unique_ptr<DecryptCallback> wrapped_;
+};
+
+// Seals synchronously against the wrapped crypter (BoringSSL's seal hook
+// cannot be deferred) and queues opens to the worker pool.
+class QuicOffloadingProofSource::OffloadingTicketCrypter
+    : public ProofSource::TicketCrypter {
+ public:
+  OffloadingTicketCrypter(QuicOffloadingProofSource* owner,
+                          TicketCrypter* wrapped)
+      : owner_(owner), wrapped_(wrapped) {}
+
+  size_t MaxOverhead() override { return wrapped_->MaxOverhead(); }
+
+  std::vector<uint8_t> Encrypt(absl::string_view in,
+                               absl::string_view encryption_key) override {
+    return wrapped_->Encrypt(in, encryption_key);
+  }
+
+  void Decrypt(absl::string_view in,
+               std::unique_ptr<ProofSource::DecryptCallback> callback)
+      override {
+    owner_->EnqueueTicketDecrypt(in, std::move(callback));
+  }
+
+ private:
+  QuicOffloadingProofSource* owner_;  // Not owned.
+  TicketCrypter* wrapped_;            // Not owned.
+};
+
+QuicOffloadingProofSource::QuicOffloadingProofSource(
+    std::unique_ptr<ProofSource> delegate,
+    size_t num_workers)
+    : delegate_(std::move(delegate)) {
+  QUICHE_DCHECK_LT(0u, num_workers);
+  if (delegate_->GetTicketCrypter() != nullptr) {
+    ticket_crypter_ = std::make_unique<OffloadingTicketCrypter>(
+        this, delegate_->GetTicketCrypter());
+  }
+  for (size_t i = 0; i < num_workers; ++i) {
+    workers_.push_back(std::make_unique<Worker>(this));
+    workers_.back()->Start();
+  }
+}
+
+QuicOffloadingProofSource::~QuicOffloadingProofSource() {
+  quiche::QuicheCircularDeque<SignatureTask> unstarted_tasks;
+  quiche::QuicheCircularDeque<TicketTask> unstarted_ticket_tasks;
+  {
+    std::lock_guard<std::mutex> lock(task_mutex_);
+    stopping_ = true;
+    unstarted_tasks.swap(tasks_);
+    unstarted_ticket_tasks.swap(ticket_tasks_);
+  }
+  task_available_.notify_all();
+  for (auto& worker : workers_) {
+    worker->Join();
+  }
+  // Fail requests that never reached a worker, and deliver everything the
+  // workers finished. Both sets of callbacks run on this (the event-loop)
+  // thread, matching what the handshakers expect.
+  while (!unstarted_tasks.empty()) {
+    unstarted_tasks.front().callback->Run(/*ok=*/false, "", nullptr);
+    unstarted_tasks.pop_front();
+  }
+  while (!unstarted_ticket_tasks.empty()) {
+    unstarted_ticket_tasks.front().callback->Run(std::vector<uint8_t>());
+    unstarted_ticket_tasks.pop_front();
+  }
+  ProcessCompletions();
+}
+
+void QuicOffloadingProofSource::AttachEpollServer(
+    QuicEpollServer* epoll_server) {
+  epoll_server_ = epoll_server;
+}
+
+size_t QuicOffloadingProofSource::ProcessCompletions() {
+  std::vector<Completion> completions;
+  std::vector<TicketCompletion> ticket_completions;
+  {
+    std::lock_guard<std::mutex> lock(completion_mutex_);
+    completions.swap(completions_);
+    ticket_completions.swap(ticket_completions_);
+  }
+  for (Completion& completion : completions) {
+    completion.callback->Run(completion.ok, std::move(completion.signature),
+                             std::move(completion.details));
+  }
+  for (TicketCompletion& completion : ticket_completions) {
+    completion.callback->Run(std::move(completion.plaintext));
+  }
+  return completions.size() + ticket_completions.size();
+}
+
+void QuicOffloadingProofSource::GetProof(
+    const QuicSocketAddress& server_address,
+    const QuicSocketAddress& client_address,
+    const std::string& hostname,
+    const std::string& server_config,
+    QuicTransportVersion transport_version,
+    absl::string_view chlo_hash,
+    std::unique_ptr<Callback> callback) {
+  delegate_->GetProof(server_address, client_address, hostname, server_config,
+                      transport_version, chlo_hash, std::move(callback));
+}
+
+QuicReferenceCountedPointer<ProofSource::Chain>
+QuicOffloadingProofSource::GetCertChain(const QuicSocketAddress& server_address,
+                                        const QuicSocketAddress& client_address,
+                                        const std::string& hostname,
+                                        bool* cert_matched_sni) {
+  return delegate_->GetCertChain(server_address, client_address, hostname,
+                                 cert_matched_sni);
+}
+
+void QuicOffloadingProofSource::ComputeTlsSignature(
+    const QuicSocketAddress& server_address,
+    const QuicSocketAddress& client_address,
+    const std::string& hostname,
+    uint16_t signature_algorithm,
+    absl::string_view in,
+    std::unique_ptr<SignatureCallback> callback) {
+  SignatureTask task;
+  task.server_address = server_address;
+  task.client_address = client_address;
+  task.hostname = hostname;
+  task.signature_algorithm = signature_algorithm;
+  task.input = std::string(in);
+  task.callback = std::move(callback);
+  {
+    std::lock_guard<std::mutex> lock(task_mutex_);
+    if (stopping_) {
+      // Shutting down; fail synchronously.
+      task.callback->Run(/*ok=*/false, "", nullptr);
+      return;
+    }
+    tasks_.push_back(std::move(task));
+  }
+  task_available_.notify_one();
+}
+
+absl::InlinedVector<uint16_t, 8>
+QuicOffloadingProofSource::SupportedTlsSignatureAlgorithms() const {
+  return delegate_->SupportedTlsSignatureAlgorithms();
+}
+
+ProofSource::TicketCrypter* QuicOffloadingProofSource::GetTicketCrypter() {
+  return ticket_crypter_.get();
+}
+
+void QuicOffloadingProofSource::EnqueueTicketDecrypt(
+    absl::string_view in,
+    std::unique_ptr<DecryptCallback> callback) {
+  TicketTask task;
+  task.ticket = std::string(in);
+  task.callback = std::move(callback);
+  {
+    std::lock_guard<std::mutex> lock(task_mutex_);
+    if (stopping_) {
+      // Shutting down; fail synchronously.
+      task.callback->Run(std::vector<uint8_t>());
+      return;
+    }
+    ticket_tasks_.push_back(std::move(task));
+  }
+  task_available_.notify_one();
+}
+
+void QuicOffloadingProofSource::WorkerLoop() {
+  TicketCrypter* crypter = delegate_->GetTicketCrypter();
+  while (true) {
+    SignatureTask task;
+    bool have_signature_task = false;
+    std::vector<TicketTask> ticket_batch;
+    {
+      std::unique_lock<std::mutex> lock(task_mutex_);
+      task_available_.wait(lock, [this]() {
+        return stopping_ || !tasks_.empty() || !ticket_tasks_.empty();
+      });
+      if (stopping_) {
+        return;
+      }
+      if (!tasks_.empty()) {
+        task = std::move(tasks_.front());
+        tasks_.pop_front();
+        have_signature_task = true;
+      }
+      // Pull a batch of queued tickets so a resumption burst is opened
+      // back-to-back without bouncing on the task lock.
+      while (!ticket_tasks_.empty() &&
+             ticket_batch.size() < kTicketBatchSize) {
+        ticket_batch.push_back(std::move(ticket_tasks_.front()));
+        ticket_tasks_.pop_front();
+      }
+    }
+    if (have_signature_task) {
+      // The delegate may itself complete asynchronously; ForwardingCallback
+      // posts the result whenever it runs.
+      delegate_->ComputeTlsSignature(
+          task.server_address, task.client_address, task.hostname,
+          task.signature_algorithm, task.input,
+          std::make_unique<ForwardingCallback>(this, std::move(task.callback)));
+    }
+    for (TicketTask& ticket_task : ticket_batch) {
+      crypter->Decrypt(ticket_task.ticket,
+                       std::make_unique<ForwardingDecryptCallback>(
+                           this, std::move(ticket_task.callback)));
+    }
+  }
+}
+
+void QuicOffloadingProofSource::OnTicketDecrypted(
+    std::unique_ptr<DecryptCallback> callback,
+    std::vector<uint8_t> plaintext) {
+  {
+    std::lock_guard<std::mutex> lock(completion_mutex_);
+    ticket_completions_.push_back(
+        TicketCompletion{std::move(callback), std::move(plaintext)});
+  }
+  if (epoll_server_ != nullptr) {
+    epoll_server_->Wake();
+  }
+}
+
+void QuicOffloadingProofSource::OnSignatureComputed(
+    std::unique_ptr<SignatureCallback> callback,
+    bool ok,
+    std::string signature,
+    std::unique_ptr<Details> details) {
+  {
+    std::lock_guard<std::mutex> lock(completion_mutex_);
+    completions_.push_back(
+        Completion{std::move(callback), ok, std::move(signature),
+                   std::move(details)});
+  }
+  if (epoll_server_ != nullptr) {
+    epoll_server_->Wake();
+  }
+}
+
+}  // namespace quic
@@ -0,0 +1,189 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_TOOLS_QUIC_OFFLOADING_PROOF_SOURCE_H_
+#define QUICHE_QUIC_TOOLS_QUIC_OFFLOADING_PROOF_SOURCE_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "quic/core/crypto/proof_source.h"
+#include "quic/platform/api/quic_epoll.h"
+#include "quic/platform/api/quic_socket_address.h"
+#include "quic/platform/api/quic_thread.h"
+#include "common/quiche_circular_deque.h"
+
+namespace quic {
+
+// A ProofSource decorator that moves TLS signature computation off the
+// event-loop thread onto a pool of worker threads, so handshake crypto
+// scales across cores while the dispatcher thread stays responsive.
+//
+// ComputeTlsSignature() queues the request and returns immediately; a worker
+// runs the wrapped ProofSource's signature computation and posts the result
+// to a completion queue, waking the attached epoll server. The event-loop
+// thread must drain the queue by calling ProcessCompletions(), which runs the
+// original SignatureCallbacks there.
+//
+// Session ticket decryption is offloaded the same way: GetTicketCrypter()
+// returns a wrapper whose Decrypt() queues the ticket to the worker pool,
+// where tickets are opened in batches against the wrapped crypter. The
+// handshaker already supports asynchronous ticket opens (BoringSSL's
+// ssl_ticket_aead_retry), so every resumed handshake's AEAD open moves off
+// the event-loop thread. Ticket sealing stays synchronous because BoringSSL's
+// seal hook is; Encrypt() forwards directly to the wrapped crypter. All other
+// ProofSource operations are forwarded synchronously.
+class QuicOffloadingProofSource : public ProofSource {
+ public:
+  // |delegate| performs the actual crypto; |num_workers| worker threads are
+  // started immediately.
+  QuicOffloadingProofSource(std::unique_ptr<ProofSource> delegate,
+                            size_t num_workers);
+  QuicOffloadingProofSource(const QuicOffloadingProofSource&) = delete;
+  QuicOffloadingProofSource& operator=(const QuicOffloadingProofSource&) =
+      delete;
+
+  // Joins the workers. Must run on the event-loop thread: queued requests are
+  // failed and already-computed completions are delivered before returning.
+  ~QuicOffloadingProofSource() override;
+
+  // Attaches the event loop to wake when a signature completes. May be
+  // nullptr, in which case the owner is responsible for polling
+  // ProcessCompletions().
+  void AttachEpollServer(QuicEpollServer* epoll_server);
+
+  // Runs the callbacks of all completed signature computations and ticket
+  // decryptions. Must be called on the event-loop thread. Returns the number
+  // of callbacks run.
+  size_t ProcessCompletions();
+
+  // ProofSource implementation.
+  void GetProof(const QuicSocketAddress& server_address,
+                const QuicSocketAddress& client_address,
+                const std::string& hostname,
+                const std::string& server_config,
+                QuicTransportVersion transport_version,
+                absl::string_view chlo_hash,
+                std::unique_ptr<Callback> callback) override;
+  QuicReferenceCountedPointer<Chain> GetCertChain(
+      const QuicSocketAddress& server_address,
+      const QuicSocketAddress& client_address,
+      const std::string& hostname,
+      bool* cert_matched_sni) override;
+  void ComputeTlsSignature(
+      const QuicSocketAddress& server_address,
+      const QuicSocketAddress& client_address,
+      const std::string& hostname,
+      uint16_t signature_algorithm,
+      absl::string_view in,
+      std::unique_ptr<SignatureCallback> callback) override;
+  absl::InlinedVector<uint16_t, 8> SupportedTlsSignatureAlgorithms()
+      const override;
+  TicketCrypter* GetTicketCrypter() override;
+
+ private:
+  // A queued signature request. |input| owns a copy of the signed bytes since
+  // the caller's view is only valid during ComputeTlsSignature().
+  struct QUIC_NO_EXPORT SignatureTask {
+    QuicSocketAddress server_address;
+    QuicSocketAddress client_address;
+    std::string hostname;
+    uint16_t signature_algorithm;
+    std::string input;
+    std::unique_ptr<SignatureCallback> callback;
+  };
+
+  // A queued ticket decryption. |ticket| owns a copy of the encrypted ticket
+  // since the caller's view is only valid during Decrypt().
+  struct QUIC_NO_EXPORT TicketTask {
+    std::string ticket;
+    std::unique_ptr<DecryptCallback> callback;
+  };
+
+  // A finished computation, ready to be delivered on the event-loop thread.
+  struct QUIC_NO_EXPORT Completion {
+    std::unique_ptr<SignatureCallback> callback;
+    bool ok;
+    std::string signature;
+    std::unique_ptr<Details> details;
+  };
+
+  // A finished ticket decryption.
+  struct QUIC_NO_EXPORT TicketCompletion {
+    std::unique_ptr<DecryptCallback> callback;
+    std::vector<uint8_t> plaintext;
+  };
+
+  class QUIC_NO_EXPORT Worker : public QuicThread {
+   public:
+    explicit Worker(QuicOffloadingProofSource* owner)
+        : QuicThread("quic_sig_worker"), owner_(owner) {}
+
+   protected:
+    void Run() override { owner_->WorkerLoop(); }
+
+   private:
+    QuicOffloadingProofSource* owner_;
+  };
+
+  // Adapts the delegate's SignatureCallback to post into the completion
+  // queue instead of running the original callback on the worker thread.
+  class QUIC_NO_EXPORT ForwardingCallback;
+
+  // Likewise for the delegate crypter's DecryptCallback.
+  class QUIC_NO_EXPORT ForwardingDecryptCallback;
+
+  // The TicketCrypter wrapper returned by GetTicketCrypter().
+  class QUIC_NO_EXPORT OffloadingTicketCrypter;
+
+  // Maximum number of queued tickets a worker pulls per wakeup, so that a
+  // resumption burst is opened back-to-back under one lock acquisition.
+  static constexpr size_t kTicketBatchSize = 16;
+
+  // Blocks on the task queues and runs crypto until shutdown.
+  void WorkerLoop();
+
+  // Queues a ticket decryption from OffloadingTicketCrypter::Decrypt().
+  void EnqueueTicketDecrypt(absl::string_view in,
+                            std::unique_ptr<DecryptCallback> callback);
+
+  // Called (on a worker thread) when the delegate finishes a computation.
+  void OnSignatureComputed(std::unique_ptr<SignatureCallback> callback,
+                           bool ok,
+                           std::string signature,
+                           std::unique_ptr<Details> details);
+
+  // Called (on a worker thread) when the delegate crypter opens a ticket.
+  void OnTicketDecrypted(std::unique_ptr<DecryptCallback> callback,
+                         std::vector<uint8_t> plaintext);
+
+  std::unique_ptr<ProofSource> delegate_;
+  QuicEpollServer* epoll_server_ = nullptr;  // Not owned.
+
+  // Null when the delegate does not support session tickets.
+  std::unique_ptr<OffloadingTicketCrypter> ticket_crypter_;
+
+  std::mutex task_mutex_;
+  std::condition_variable task_available_;
+  quiche::QuicheCircularDeque<SignatureTask> tasks_;  // Guarded by task_mutex_.
+  // Guarded by task_mutex_.
+  quiche::QuicheCircularDeque<TicketTask> ticket_tasks_;
+  bool stopping_ = false;  // Guarded by task_mutex_.
+
+  std::mutex completion_mutex_;
+  std::vector<Completion> completions_;  // Guarded by completion_mutex_.
+  // Guarded by completion_mutex_.
+  std::vector<TicketCompletion> ticket_completions_;
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_TOOLS_QUIC_OFFLOADING_PROOF_SOURCE_H_
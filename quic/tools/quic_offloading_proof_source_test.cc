@@ -0,0 +1,271 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/tools/quic_offloading_proof_source.h"
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "quic/platform/api/quic_sleep.h"
+#include "quic/platform/api/quic_test.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+// A synchronous ProofSource that "signs" by decorating the input, so tests
+// can verify the input survived the thread handoff.
+class EchoingProofSource : public ProofSource {
+ public:
+  void GetProof(const QuicSocketAddress& /*server_address*/,
+                const QuicSocketAddress& /*client_address*/,
+                const std::string& /*hostname*/,
+                const std::string& /*server_config*/,
+                QuicTransportVersion /*transport_version*/,
+                absl::string_view /*chlo_hash*/,
+                std::unique_ptr<Callback> callback) override {
+    callback->Run(/*ok=*/false, nullptr, QuicCryptoProof(), nullptr);
+  }
+
+  QuicReferenceCountedPointer<Chain> GetCertChain(
+      const QuicSocketAddress& /*server_address*/,
+      const QuicSocketAddress& /*client_address*/,
+      const std::string& /*hostname*/,
+      bool* cert_matched_sni) override {
+    *cert_matched_sni = false;
+    return QuicReferenceCountedPointer<Chain>();
+  }
+
+  void ComputeTlsSignature(
+      const QuicSocketAddress& /*server_address*/,
+      const QuicSocketAddress& /*client_address*/,
+      const std::string& /*hostname*/,
+      uint16_t /*signature_algorithm*/,
+      absl::string_view in,
+      std::unique_ptr<SignatureCallback> callback) override {
+    callback->Run(/*ok=*/true, absl::StrCat("signed:", in), nullptr);
+  }
+
+  absl::InlinedVector<uint16_t, 8> SupportedTlsSignatureAlgorithms()
+      const override {
+    return {0x0403};
+  }
+
+  TicketCrypter* GetTicketCrypter() override { return nullptr; }
+};
+
+// A synchronous TicketCrypter that "decrypts" by stripping a prefix, so tests
+// can tell the wrapped crypter ran.
+class EchoingTicketCrypter : public ProofSource::TicketCrypter {
+ public:
+  size_t MaxOverhead() override { return 4; }
+
+  std::vector<uint8_t> Encrypt(absl::string_view in,
+                               absl::string_view /*encryption_key*/) override {
+    std::string out = absl::StrCat("enc:", in);
+    return std::vector<uint8_t>(out.begin(), out.end());
+  }
+
+  void Decrypt(
+      absl::string_view in,
+      std::unique_ptr<ProofSource::DecryptCallback> callback) override {
+    std::string out(in);
+    if (out.rfind("enc:", 0) == 0) {
+      out = out.substr(4);
+    } else {
+      out.clear();
+    }
+    callback->Run(std::vector<uint8_t>(out.begin(), out.end()));
+  }
+};
+
+// An EchoingProofSource that also supports session tickets.
+class TicketingProofSource : public EchoingProofSource {
+ public:
+  TicketCrypter* GetTicketCrypter() override { return &ticket_crypter_; }
+
+ private:
+  EchoingTicketCrypter ticket_crypter_;
+};
+
+struct DecryptResult {
+  bool run = false;
+  std::string plaintext;
+  std::thread::id thread_id;
+};
+
+class RecordingDecryptCallback : public ProofSource::DecryptCallback {
+ public:
+  explicit RecordingDecryptCallback(DecryptResult* result) : result_(result) {}
+
+  void Run(std::vector<uint8_t> plaintext) override {
+    result_->run = true;
+    result_->plaintext = std::string(plaintext.begin(), plaintext.end());
+    result_->thread_id = std::this_thread::get_id();
+  }
+
+ private:
+  DecryptResult* result_;
+};
+
+struct SignatureResult {
+  bool run = false;
+  bool ok = false;
+  std::string signature;
+  std::thread::id thread_id;
+};
+
+class RecordingSignatureCallback : public ProofSource::SignatureCallback {
+ public:
+  explicit RecordingSignatureCallback(SignatureResult* result)
+      : result_(result) {}
+
+  void Run(bool ok,
+           std::string signature,
+           std::unique_ptr<ProofSource::Details> /*details*/) override {
+    result_->run = true;
+    result_->ok = ok;
+    result_->signature = std::move(signature);
+    result_->thread_id = std::this_thread::get_id();
+  }
+
+ private:
+  SignatureResult* result_;
+};
+
+class QuicOffloadingProofSourceTest : public QuicTest {
+ protected:
+  // Polls until at least one completion has been delivered.
+  size_t WaitForCompletions(QuicOffloadingProofSource* proof_source) {
+    size_t processed = 0;
+    while ((processed = proof_source->ProcessCompletions()) == 0) {
+      QuicSleep(QuicTime::Delta::FromMilliseconds(1));
+    }
+    return processed;
+  }
+};
+
+TEST_F(QuicOffloadingProofSourceTest, SignatureComputedOffThread) {
+  QuicOffloadingProofSource proof_source(
+      std::make_unique<EchoingProofSource>(), /*num_workers=*/2);
+
+  SignatureResult result;
+  proof_source.ComputeTlsSignature(
+      QuicSocketAddress(), QuicSocketAddress(), "example.com", 0x0403,
+      "payload", std::make_unique<RecordingSignatureCallback>(&result));
+  // The request is queued; the callback must not run synchronously.
+  EXPECT_FALSE(result.run);
+
+  EXPECT_EQ(1u, WaitForCompletions(&proof_source));
+  EXPECT_TRUE(result.run);
+  EXPECT_TRUE(result.ok);
+  EXPECT_EQ("signed:payload", result.signature);
+  // The callback ran on the thread draining the completion queue, not on a
+  // worker.
+  EXPECT_EQ(std::this_thread::get_id(), result.thread_id);
+}
+
+TEST_F(QuicOffloadingProofSourceTest, MultipleSignaturesAllComplete) {
+  QuicOffloadingProofSource proof_source(
+      std::make_unique<EchoingProofSource>(), /*num_workers=*/4);
+
+  const size_t kNumRequests = 32;
+  std::vector<SignatureResult> results(kNumRequests);
+  for (size_t i = 0; i < kNumRequests; ++i) {
+    proof_source.ComputeTlsSignature(
+        QuicSocketAddress(), QuicSocketAddress(), "example.com", 0x0403,
+        absl::StrCat("payload-", i),
+        std::make_unique<RecordingSignatureCallback>(&results[i]));
+  }
+  size_t processed = 0;
+  while (processed < kNumRequests) {
+    processed += proof_source.ProcessCompletions();
+    QuicSleep(QuicTime::Delta::FromMilliseconds(1));
+  }
+  for (size_t i = 0; i < kNumRequests; ++i) {
+    EXPECT_TRUE(results[i].run);
+    EXPECT_TRUE(results[i].ok);
+    EXPECT_EQ(absl::StrCat("signed:payload-", i), results[i].signature);
+  }
+}
+
+TEST_F(QuicOffloadingProofSourceTest, DestructorDeliversPendingCompletions) {
+  SignatureResult result;
+  {
+    QuicOffloadingProofSource proof_source(
+        std::make_unique<EchoingProofSource>(), /*num_workers=*/1);
+    proof_source.ComputeTlsSignature(
+        QuicSocketAddress(), QuicSocketAddress(), "example.com", 0x0403,
+        "payload", std::make_unique<RecordingSignatureCallback>(&result));
+    // Destruction joins the worker and delivers whatever it finished.
+  }
+  EXPECT_TRUE(result.run);
+}
+
+TEST_F(QuicOffloadingProofSourceTest, ForwardsNonSignatureOperations) {
+  QuicOffloadingProofSource proof_source(
+      std::make_unique<EchoingProofSource>(), /*num_workers=*/1);
+  EXPECT_EQ(nullptr, proof_source.GetTicketCrypter());
+  auto algorithms = proof_source.SupportedTlsSignatureAlgorithms();
+  ASSERT_EQ(1u, algorithms.size());
+  EXPECT_EQ(0x0403, algorithms[0]);
+}
+
+TEST_F(QuicOffloadingProofSourceTest, TicketDecryptionOffloaded) {
+  QuicOffloadingProofSource proof_source(
+      std::make_unique<TicketingProofSource>(), /*num_workers=*/2);
+  ProofSource::TicketCrypter* crypter = proof_source.GetTicketCrypter();
+  ASSERT_NE(nullptr, crypter);
+
+  DecryptResult result;
+  crypter->Decrypt("enc:ticket-state",
+                   std::make_unique<RecordingDecryptCallback>(&result));
+  // The decryption is queued; the callback must not run synchronously.
+  EXPECT_FALSE(result.run);
+
+  EXPECT_EQ(1u, WaitForCompletions(&proof_source));
+  EXPECT_TRUE(result.run);
+  EXPECT_EQ("ticket-state", result.plaintext);
+  // Like signatures, the callback is delivered on the draining thread.
+  EXPECT_EQ(std::this_thread::get_id(), result.thread_id);
+}
+
+TEST_F(QuicOffloadingProofSourceTest, TicketDecryptionBurstAllComplete) {
+  QuicOffloadingProofSource proof_source(
+      std::make_unique<TicketingProofSource>(), /*num_workers=*/2);
+  ProofSource::TicketCrypter* crypter = proof_source.GetTicketCrypter();
+
+  const size_t kNumTickets = 64;
+  std::vector<DecryptResult> results(kNumTickets);
+  for (size_t i = 0; i < kNumTickets; ++i) {
+    crypter->Decrypt(absl::StrCat("enc:ticket-", i),
+                     std::make_unique<RecordingDecryptCallback>(&results[i]));
+  }
+  size_t processed = 0;
+  while (processed < kNumTickets) {
+    processed += proof_source.ProcessCompletions();
+    QuicSleep(QuicTime::Delta::FromMilliseconds(1));
+  }
+  for (size_t i = 0; i < kNumTickets; ++i) {
+    EXPECT_TRUE(results[i].run);
+    EXPECT_EQ(absl::StrCat("ticket-", i), results[i].plaintext);
+  }
+}
+
+TEST_F(QuicOffloadingProofSourceTest, TicketEncryptionStaysSynchronous) {
+  QuicOffloadingProofSource proof_source(
+      std::make_unique<TicketingProofSource>(), /*num_workers=*/1);
+  ProofSource::TicketCrypter* crypter = proof_source.GetTicketCrypter();
+  EXPECT_EQ(4u, crypter->MaxOverhead());
+  std::vector<uint8_t> sealed = crypter->Encrypt("ticket-state", "");
+  EXPECT_EQ("enc:ticket-state", std::string(sealed.begin(), sealed.end()));
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
@@ -0,0 +1,36 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Converts a binary qlog file written by QuicQlogEmitter into a JSON qlog
+// document on stdout.
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "quic/core/quic_qlog_emitter.h"
+#include "quic/platform/api/quic_flags.h"
+
+int main(int argc, char* argv[]) {
+  const char* usage = "Usage: quic_qlog_to_json <binary_qlog_file>";
+  std::vector<std::string> args =
+      quic::QuicParseCommandLineFlags(usage, argc, argv);
+
+  if (args.size() != 1) {
+    std::cerr << usage << std::endl;
+    return 1;
+  }
+
+  std::ifstream input(args[0], std::ios::binary);
+  if (!input) {
+    std::cerr << "Unable to open: " << args[0] << "\n";
+    return 2;
+  }
+  std::stringstream contents;
+  contents << input.rdbuf();
+
+  std::cout << quic::QuicQlogToJson(contents.str()) << "\n";
+  return 0;
+}
@@ -11,8 +11,10 @@
 #include <sys/epoll.h>
 #include <sys/socket.h>
 
+#include <algorithm>
 #include <cstdint>
 #include <memory>
+#include <utility>
 
 #include "quic/core/crypto/crypto_handshake.h"
 #include "quic/core/crypto/quic_random.h"
@@ -25,9 +27,13 @@
 #include "quic/core/quic_epoll_connection_helper.h"
 #include "quic/core/quic_packet_reader.h"
 #include "quic/core/quic_packets.h"
+#include "quic/platform/api/quic_bug_tracker.h"
 #include "quic/platform/api/quic_flags.h"
 #include "quic/platform/api/quic_logging.h"
 #include "net/quic/platform/impl/quic_epoll_clock.h"
+#include "quic/tools/quic_multi_socket_writer.h"
+#include "quic/tools/quic_offloading_proof_source.h"
+#include "quic/tools/quic_server_drain_manager.h"
 #include "quic/tools/quic_simple_crypto_server_stream_helper.h"
 #include "quic/tools/quic_simple_dispatcher.h"
 #include "quic/tools/quic_simple_server_backend.h"
@@ -39,6 +45,10 @@ namespace {
 const int kEpollFlags = EPOLLIN | EPOLLOUT | EPOLLET;
 const char kSourceAddressTokenSecret[] = "secret";
 
+// Number of consecutive socket read batches without new kernel drops before
+// the overload signal is cleared.
+const int kCleanReadsBeforeOverloadRecovery = 10;
+
 }  // namespace
 
 const size_t kNumSessionsToCreatePerSocketEvent = 16;
@@ -78,7 +88,7 @@ QuicServer::QuicServer(
                      KeyExchangeSource::Default()),
       crypto_config_options_(crypto_config_options),
       version_manager_(supported_versions),
-      packet_reader_(new QuicPacketReader()),
+      packet_reader_(new QuicPacketReader(kMaxNumPacketsPerReadMmsgCall)),
       quic_simple_server_backend_(quic_simple_server_backend),
       expected_server_connection_id_length_(
           expected_server_connection_id_length) {
@@ -112,39 +122,88 @@ void QuicServer::Initialize() {
 
 QuicServer::~QuicServer() = default;
 
-bool QuicServer::CreateUDPSocketAndListen(const QuicSocketAddress& address) {
+QuicUdpSocketFd QuicServer::CreateBoundSocket(const QuicSocketAddress& address,
+                                              int* out_port,
+                                              bool* out_overflow_supported) {
   QuicUdpSocketApi socket_api;
-  fd_ = socket_api.Create(address.host().AddressFamilyToInt(),
-                          /*receive_buffer_size =*/kDefaultSocketReceiveBuffer,
-                          /*send_buffer_size =*/kDefaultSocketReceiveBuffer);
-  if (fd_ == kQuicInvalidSocketFd) {
+  QuicUdpSocketFd fd =
+      socket_api.Create(address.host().AddressFamilyToInt(),
+                        /*receive_buffer_size =*/kDefaultSocketReceiveBuffer,
+                        /*send_buffer_size =*/kDefaultSocketReceiveBuffer);
+  if (fd == kQuicInvalidSocketFd) {
     QUIC_LOG(ERROR) << "CreateSocket() failed: " << strerror(errno);
-    return false;
+    return kQuicInvalidSocketFd;
   }
 
-  overflow_supported_ = socket_api.EnableDroppedPacketCount(fd_);
-  socket_api.EnableReceiveTimestamp(fd_);
+  *out_overflow_supported = socket_api.EnableDroppedPacketCount(fd);
+  socket_api.EnableReceiveTimestamp(fd);
+
+  if (!ConfigureSocket(fd)) {
+    QUIC_LOG(ERROR) << "ConfigureSocket() failed";
+    socket_api.Destroy(fd);
+    return kQuicInvalidSocketFd;
+  }
 
   sockaddr_storage addr = address.generic_address();
-  int rc = bind(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+  int rc = bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
   if (rc < 0) {
     QUIC_LOG(ERROR) << "Bind failed: " << strerror(errno);
-    return false;
+    socket_api.Destroy(fd);
+    return kQuicInvalidSocketFd;
   }
   QUIC_LOG(INFO) << "Listening on " << address.ToString();
-  port_ = address.port();
-  if (port_ == 0) {
-    QuicSocketAddress address;
-    if (address.FromSocket(fd_) != 0) {
+  *out_port = address.port();
+  if (*out_port == 0) {
+    QuicSocketAddress bound_address;
+    if (bound_address.FromSocket(fd) != 0) {
       QUIC_LOG(ERROR) << "Unable to get self address.  Error: "
                       << strerror(errno);
     }
-    port_ = address.port();
+    *out_port = bound_address.port();
+  }
+  return fd;
+}
+
+bool QuicServer::CreateUDPSocketAndListen(const QuicSocketAddress& address) {
+  fd_ = CreateBoundSocket(address, &port_, &overflow_supported_);
+  if (fd_ == kQuicInvalidSocketFd) {
+    return false;
   }
 
   epoll_server_.RegisterFD(fd_, this, kEpollFlags);
   dispatcher_.reset(CreateQuicDispatcher());
-  dispatcher_->InitializeWithWriter(CreateWriter(fd_));
+  auto writer = std::make_unique<QuicMultiSocketWriter>();
+  multi_socket_writer_ = writer.get();
+  writer->AddWriter(address.host(),
+                    std::unique_ptr<QuicPacketWriter>(CreateWriter(fd_)));
+  dispatcher_->InitializeWithWriter(writer.release());
+
+  return true;
+}
+
+bool QuicServer::CreateAdditionalUDPSocketAndListen(
+    const QuicSocketAddress& address) {
+  if (dispatcher_ == nullptr) {
+    QUIC_BUG(quic_server_additional_listen_before_primary)
+        << "CreateAdditionalUDPSocketAndListen called before "
+           "CreateUDPSocketAndListen";
+    return false;
+  }
+
+  int port = 0;
+  bool overflow_supported = false;
+  QuicUdpSocketFd fd = CreateBoundSocket(address, &port, &overflow_supported);
+  if (fd == kQuicInvalidSocketFd) {
+    return false;
+  }
+  // packets_dropped_ aggregates across sockets, so it is only meaningful if
+  // every socket reports its drops.
+  overflow_supported_ = overflow_supported_ && overflow_supported;
+
+  epoll_server_.RegisterFD(fd, this, kEpollFlags);
+  additional_sockets_.push_back(ListeningSocket{fd, port});
+  multi_socket_writer_->AddWriter(
+      address.host(), std::unique_ptr<QuicPacketWriter>(CreateWriter(fd)));
 
   return true;
 }
@@ -153,6 +212,10 @@ QuicPacketWriter* QuicServer::CreateWriter(int fd) {
   return new QuicDefaultPacketWriter(fd);
 }
 
+bool QuicServer::ConfigureSocket(QuicUdpSocketFd /*fd*/) {
+  return true;
+}
+
 QuicDispatcher* QuicServer::CreateQuicDispatcher() {
   QuicEpollAlarmFactory alarm_factory(&epoll_server_);
   return new QuicSimpleDispatcher(
@@ -174,6 +237,27 @@ void QuicServer::HandleEventsForever() {
 
 void QuicServer::WaitForEvents() {
   epoll_server_.WaitForEventsAndExecuteCallbacks();
+  if (offloading_proof_source_ != nullptr) {
+    offloading_proof_source_->ProcessCompletions();
+  }
+}
+
+void QuicServer::RegisterHandshakeOffload(
+    QuicOffloadingProofSource* proof_source) {
+  offloading_proof_source_ = proof_source;
+  if (proof_source != nullptr) {
+    proof_source->AttachEpollServer(&epoll_server_);
+  }
+}
+
+bool QuicServer::StartGracefulDrain(QuicTime::Delta deadline, int handoff_fd) {
+  if (dispatcher_ == nullptr || drain_manager_ != nullptr) {
+    return false;
+  }
+  drain_manager_ = std::make_unique<QuicServerDrainManager>(dispatcher_.get(),
+                                                            &epoll_server_);
+  drain_manager_->StartDrain(deadline, handoff_fd, fd_);
+  return true;
 }
 
 void QuicServer::Shutdown() {
@@ -187,10 +271,26 @@ void QuicServer::Shutdown() {
 
   close(fd_);
   fd_ = -1;
+  for (const ListeningSocket& socket : additional_sockets_) {
+    close(socket.fd);
+  }
+  additional_sockets_.clear();
 }
 
 void QuicServer::OnEvent(int fd, QuicEpollEvent* event) {
-  QUICHE_DCHECK_EQ(fd, fd_);
+  int port = port_;
+  if (fd != fd_) {
+    auto it = std::find_if(additional_sockets_.begin(),
+                           additional_sockets_.end(),
+                           [fd](const ListeningSocket& socket) {
+                             return socket.fd == fd;
+                           });
+    QUICHE_DCHECK(it != additional_sockets_.end());
+    if (it == additional_sockets_.end()) {
+      return;
+    }
+    port = it->port;
+  }
   event->out_ready_mask = 0;
 
   if (event->in_events & EPOLLIN) {
@@ -201,10 +301,14 @@ void QuicServer::OnEvent(int fd, QuicEpollEvent* event) {
     bool more_to_read = true;
     while (more_to_read) {
       more_to_read = packet_reader_->ReadAndDispatchPackets(
-          fd_, port_, QuicEpollClock(&epoll_server_), dispatcher_.get(),
+          fd, port, QuicEpollClock(&epoll_server_), dispatcher_.get(),
           overflow_supported_ ? &packets_dropped_ : nullptr);
     }
 
+    if (overflow_supported_) {
+      MaybeUpdateOverloadState();
+    }
+
     if (dispatcher_->HasChlosBuffered()) {
       // Register EPOLLIN event to consume buffered CHLO(s).
       event->out_ready_mask |= EPOLLIN;
@@ -218,4 +322,19 @@ void QuicServer::OnEvent(int fd, QuicEpollEvent* event) {
   }
 }
 
+void QuicServer::MaybeUpdateOverloadState() {
+  if (packets_dropped_ > packets_dropped_at_last_overload_check_) {
+    // The kernel dropped packets since the last read batch: the event loop is
+    // not keeping up with the inbound rate.
+    packets_dropped_at_last_overload_check_ = packets_dropped_;
+    clean_reads_since_socket_drops_ = 0;
+    dispatcher_->OnServerOverloadSignal(true);
+    return;
+  }
+  if (dispatcher_->server_overloaded() &&
+      ++clean_reads_since_socket_drops_ >= kCleanReadsBeforeOverloadRecovery) {
+    dispatcher_->OnServerOverloadSignal(false);
+  }
+}
+
 }  // namespace quic
@@ -12,6 +12,7 @@
 #define QUICHE_QUIC_TOOLS_QUIC_SERVER_H_
 
 #include <memory>
+#include <vector>
 
 #include "absl/strings/string_view.h"
 #include "quic/core/crypto/quic_crypto_server_config.h"
@@ -33,7 +34,10 @@ class QuicServerPeer;
 }  // namespace test
 
 class QuicDispatcher;
+class QuicMultiSocketWriter;
+class QuicOffloadingProofSource;
 class QuicPacketReader;
+class QuicServerDrainManager;
 
 class QuicServer : public QuicSpdyServerBase,
                    public QuicEpollCallbackInterface {
@@ -58,6 +62,14 @@ class QuicServer : public QuicSpdyServerBase,
 
   // Start listening on the specified address.
   bool CreateUDPSocketAndListen(const QuicSocketAddress& address) override;
+  // Starts listening on an additional address, feeding the same dispatcher.
+  // Must be called after CreateUDPSocketAndListen(). Responses are routed
+  // back through the socket their request arrived on, so a dual-stack or
+  // multi-homed server can serve every local address from one process and
+  // share its dispatcher state (connection table, compressed certs, session
+  // tickets) across them. Addresses should be distinct and specific; traffic
+  // that matches no listening address is answered through the first socket.
+  bool CreateAdditionalUDPSocketAndListen(const QuicSocketAddress& address);
   // Handles all events. Does not return.
   void HandleEventsForever() override;
 
@@ -93,11 +105,39 @@ class QuicServer : public QuicSpdyServerBase,
 
   QuicEpollServer* epoll_server() { return &epoll_server_; }
 
+  // Registers |proof_source| (not owned; typically the proof source handed to
+  // the constructor) so its completed handshake signature computations are
+  // delivered on this thread after every event-loop iteration. Worker threads
+  // wake the epoll server when a signature finishes.
+  void RegisterHandshakeOffload(QuicOffloadingProofSource* proof_source);
+
+  // Starts a bounded graceful drain for a zero-downtime restart: GOAWAYs
+  // every session, progressively clamps stragglers, and at |deadline|
+  // exports survivors (with the listening socket) to the replacement
+  // process over |handoff_fd|, a connected unix-domain socket, or closes
+  // them if |handoff_fd| is -1. See QuicServerDrainManager. Returns false
+  // if the server is not listening or a drain is already running. The
+  // caller keeps running the event loop and exits once drain_manager()
+  // reports the drain complete.
+  bool StartGracefulDrain(QuicTime::Delta deadline, int handoff_fd);
+
+  // The running drain, or nullptr before StartGracefulDrain() is called.
+  QuicServerDrainManager* drain_manager() { return drain_manager_.get(); }
+
  protected:
   virtual QuicPacketWriter* CreateWriter(int fd);
 
+  // Configures the socket created by CreateUDPSocketAndListen before it is
+  // bound. Returns false to abort the listen. The default implementation
+  // does nothing.
+  virtual bool ConfigureSocket(QuicUdpSocketFd fd);
+
   virtual QuicDispatcher* CreateQuicDispatcher();
 
+  // Evaluates kernel socket drop counters after a read batch and raises or
+  // clears the dispatcher's overload signal accordingly.
+  void MaybeUpdateOverloadState();
+
   const QuicConfig& config() const { return config_; }
   const QuicCryptoServerConfig& crypto_config() const { return crypto_config_; }
 
@@ -121,6 +161,14 @@ class QuicServer : public QuicSpdyServerBase,
   // Initialize the internal state of the server.
   void Initialize();
 
+  // Creates a configured socket bound to |address|. Returns
+  // kQuicInvalidSocketFd on failure. On success, |*out_port| is the bound
+  // port and |*out_overflow_supported| reports whether the kernel counts
+  // dropped packets for the socket.
+  QuicUdpSocketFd CreateBoundSocket(const QuicSocketAddress& address,
+                                    int* out_port,
+                                    bool* out_overflow_supported);
+
   // Accepts data from the framer and demuxes clients to sessions.
   std::unique_ptr<QuicDispatcher> dispatcher_;
   // Frames incoming packets and hands them to the dispatcher.
@@ -132,6 +180,18 @@ class QuicServer : public QuicSpdyServerBase,
   // Listening connection.  Also used for outbound client communication.
   QuicUdpSocketFd fd_;
 
+  // Sockets created by CreateAdditionalUDPSocketAndListen, feeding the same
+  // dispatcher as fd_.
+  struct ListeningSocket {
+    QuicUdpSocketFd fd;
+    int port;
+  };
+  std::vector<ListeningSocket> additional_sockets_;
+
+  // Routes outgoing packets to the per-socket writer matching their self
+  // address. Owned by the dispatcher.
+  QuicMultiSocketWriter* multi_socket_writer_ = nullptr;
+
   // If overflow_supported_ is true this will be the number of packets dropped
   // during the lifetime of the server.  This may overflow if enough packets
   // are dropped.
@@ -141,6 +201,13 @@ class QuicServer : public QuicSpdyServerBase,
   // because the socket would otherwise overflow.
   bool overflow_supported_;
 
+  // Value of |packets_dropped_| when the overload state was last evaluated.
+  QuicPacketCount packets_dropped_at_last_overload_check_ = 0;
+
+  // Socket read batches since the last one that observed new kernel drops.
+  // Used as hysteresis before reporting the overload as over.
+  int clean_reads_since_socket_drops_ = 0;
+
   // If true, do not call Shutdown on the dispatcher.  Connections will close
   // without sending a final connection close.
   bool silent_close_;
@@ -162,6 +229,13 @@ class QuicServer : public QuicSpdyServerBase,
 
   QuicSimpleServerBackend* quic_simple_server_backend_;  // unowned.
 
+  // If not null, drained after each event-loop iteration to deliver
+  // handshake signatures computed on worker threads. Unowned.
+  QuicOffloadingProofSource* offloading_proof_source_ = nullptr;
+
+  // Non-null while a graceful drain started by StartGracefulDrain() runs.
+  std::unique_ptr<QuicServerDrainManager> drain_manager_;
+
   // Connection ID length expected to be read on incoming IETF short headers.
   uint8_t expected_server_connection_id_length_;
 };
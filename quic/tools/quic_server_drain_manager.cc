@@ -0,0 +1,133 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/tools/quic_server_drain_manager.h"
+
+#include <string>
+
+#include "quic/core/http/quic_spdy_session.h"
+#include "quic/core/quic_connection_handoff_state.h"
+#include "quic/core/quic_error_codes.h"
+#include "quic/core/quic_session.h"
+#include "quic/core/quic_versions.h"
+#include "quic/platform/api/quic_logging.h"
+#include "quic/tools/quic_drain_handoff_channel.h"
+
+namespace quic {
+
+namespace {
+
+const char kDrainReason[] = "server draining";
+
+}  // namespace
+
+QuicServerDrainManager::QuicServerDrainManager(QuicDispatcher* dispatcher,
+                                               QuicEpollServer* epoll_server)
+    : dispatcher_(dispatcher),
+      epoll_server_(epoll_server),
+      stage_alarm_(this) {}
+
+QuicServerDrainManager::~QuicServerDrainManager() {
+  stage_alarm_.UnregisterIfRegistered();
+}
+
+void QuicServerDrainManager::StartDrain(QuicTime::Delta deadline,
+                                        int handoff_fd,
+                                        int udp_fd) {
+  if (stage_ != DrainStage::kIdle) {
+    return;
+  }
+  handoff_fd_ = handoff_fd;
+  udp_fd_to_pass_ = udp_fd;
+  stage_delay_ =
+      QuicTime::Delta::FromMicroseconds(deadline.ToMicroseconds() / 2);
+
+  dispatcher_->StopAcceptingNewConnections();
+  dispatcher_->PerformActionOnActiveSessions([this](QuicSession* session) {
+    ++stats_.sessions_at_drain_start;
+    if (VersionUsesHttp3(session->transport_version())) {
+      static_cast<QuicSpdySession*>(session)->SendHttp3GoAway(
+          QUIC_PEER_GOING_AWAY, kDrainReason);
+    } else {
+      session->SendGoAway(QUIC_PEER_GOING_AWAY, kDrainReason);
+    }
+    ++stats_.goaways_sent;
+  });
+  QUIC_DLOG(INFO) << "Drain started with " << stats_.sessions_at_drain_start
+                  << " active sessions, deadline " << deadline;
+
+  stage_ = DrainStage::kGoAwaySent;
+  epoll_server_->RegisterAlarmApproximateDelta(stage_delay_.ToMicroseconds(),
+                                               &stage_alarm_);
+}
+
+int64_t QuicServerDrainManager::DrainStageAlarm::OnAlarm() {
+  QuicEpollAlarmBase::OnAlarm();
+  manager_->OnStageAlarm();
+  return 0;
+}
+
+void QuicServerDrainManager::OnStageAlarm() {
+  switch (stage_) {
+    case DrainStage::kGoAwaySent:
+      ClampRemainingSessions();
+      stage_ = DrainStage::kClamped;
+      epoll_server_->RegisterAlarmApproximateDelta(
+          stage_delay_.ToMicroseconds(), &stage_alarm_);
+      break;
+    case DrainStage::kClamped:
+      ExportRemainingSessions();
+      stage_ = DrainStage::kComplete;
+      break;
+    default:
+      QUIC_BUG(quic_bug_drain_alarm_bad_stage)
+          << "Drain stage alarm fired in stage " << static_cast<int>(stage_);
+      break;
+  }
+}
+
+void QuicServerDrainManager::ClampRemainingSessions() {
+  dispatcher_->PerformActionOnActiveSessions(
+      [](QuicSession* session) { session->OnServerOverload(true); });
+}
+
+void QuicServerDrainManager::ExportRemainingSessions() {
+  size_t remaining = 0;
+  for (const auto& session : dispatcher_->GetSessionsSnapshot()) {
+    QuicConnection* connection = session->connection();
+    if (!connection->connected()) {
+      continue;
+    }
+    ++remaining;
+    bool exported = false;
+    if (handoff_fd_ >= 0) {
+      QuicConnectionHandoffState state;
+      if (CaptureConnectionHandoffState(*connection, &state) &&
+          SendConnectionHandoff(handoff_fd_, state, udp_fd_to_pass_)) {
+        udp_fd_to_pass_ = -1;
+        exported = true;
+        ++stats_.sessions_exported;
+        // The peer must not learn the connection is closing here; the
+        // replacement process picks it up from the snapshot.
+        connection->CloseConnection(QUIC_NO_ERROR,
+                                    "connection exported during drain",
+                                    ConnectionCloseBehavior::SILENT_CLOSE);
+      } else {
+        ++stats_.export_failures;
+      }
+    }
+    if (!exported) {
+      connection->CloseConnection(
+          QUIC_PEER_GOING_AWAY, kDrainReason,
+          ConnectionCloseBehavior::SEND_CONNECTION_CLOSE_PACKET);
+    }
+  }
+  stats_.sessions_drained = stats_.sessions_at_drain_start - remaining;
+  QUIC_DLOG(INFO) << "Drain complete: " << stats_.sessions_drained
+                  << " sessions drained, " << stats_.sessions_exported
+                  << " exported, " << stats_.export_failures
+                  << " export failures";
+}
+
+}  // namespace quic
@@ -0,0 +1,111 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_TOOLS_QUIC_SERVER_DRAIN_MANAGER_H_
+#define QUICHE_QUIC_TOOLS_QUIC_SERVER_DRAIN_MANAGER_H_
+
+#include <cstddef>
+
+#include "quic/core/quic_dispatcher.h"
+#include "quic/core/quic_time.h"
+#include "quic/platform/api/quic_epoll.h"
+
+namespace quic {
+
+// Drives an accelerated graceful drain of a server's dispatcher so the
+// process can exit within a bounded deadline instead of waiting out its
+// longest-lived stream. The drain runs in stages:
+//
+//  1. Immediately: stop accepting new connections and send GOAWAY on every
+//     active session, so clients finish in-flight requests and move new
+//     ones elsewhere.
+//  2. Halfway to the deadline: clamp the inbound rate of sessions still
+//     open (QuicSession::OnServerOverload), discouraging clients from
+//     starting large transfers on a connection about to go away.
+//  3. At the deadline: export each surviving connection's handoff snapshot
+//     to the replacement process over the handoff channel (see
+//     quic_drain_handoff_channel.h) and close it locally without telling
+//     the peer, so the replacement resumes it without resetting a stream.
+//     Without a handoff channel, survivors are closed with
+//     QUIC_PEER_GOING_AWAY instead.
+//
+// Not thread-safe; runs on the event loop thread that owns the dispatcher.
+class QuicServerDrainManager {
+ public:
+  struct DrainStats {
+    // Sessions active when the drain started.
+    size_t sessions_at_drain_start = 0;
+    // GOAWAYs sent in stage 1.
+    size_t goaways_sent = 0;
+    // Sessions that closed on their own before the deadline.
+    size_t sessions_drained = 0;
+    // Sessions exported to the replacement process at the deadline.
+    size_t sessions_exported = 0;
+    // Sessions that could not be exported (no established 1-RTT keys, or
+    // the channel write failed) and were closed with GOING_AWAY instead.
+    size_t export_failures = 0;
+  };
+
+  QuicServerDrainManager(QuicDispatcher* dispatcher,
+                         QuicEpollServer* epoll_server);
+  QuicServerDrainManager(const QuicServerDrainManager&) = delete;
+  QuicServerDrainManager& operator=(const QuicServerDrainManager&) = delete;
+
+  ~QuicServerDrainManager();
+
+  // Starts the drain. |deadline| bounds how long connections may linger
+  // before being exported. |handoff_fd| is a connected unix-domain socket
+  // to the replacement process, or -1 if there is none; |udp_fd| is the
+  // listening socket passed to the replacement with the first export, or
+  // -1. No-op if a drain is already running.
+  void StartDrain(QuicTime::Delta deadline, int handoff_fd, int udp_fd);
+
+  // True once the final stage has run and no sessions remain active.
+  bool drain_complete() const { return stage_ == DrainStage::kComplete; }
+
+  const DrainStats& drain_stats() const { return stats_; }
+
+ private:
+  enum class DrainStage {
+    kIdle,
+    kGoAwaySent,
+    kClamped,
+    kComplete,
+  };
+
+  class DrainStageAlarm : public QuicEpollAlarmBase {
+   public:
+    explicit DrainStageAlarm(QuicServerDrainManager* manager)
+        : manager_(manager) {}
+
+    int64_t OnAlarm() override;
+
+   private:
+    QuicServerDrainManager* manager_;  // Unowned.
+  };
+
+  // Advances to the next stage when the stage alarm fires.
+  void OnStageAlarm();
+
+  // Stage 2: clamp the inbound rate of sessions still open.
+  void ClampRemainingSessions();
+
+  // Stage 3: export survivors through the handoff channel and close them.
+  void ExportRemainingSessions();
+
+  QuicDispatcher* dispatcher_;      // Unowned.
+  QuicEpollServer* epoll_server_;   // Unowned.
+  DrainStage stage_ = DrainStage::kIdle;
+  DrainStageAlarm stage_alarm_;
+  // Half the drain deadline: the delay before each of stages 2 and 3.
+  QuicTime::Delta stage_delay_ = QuicTime::Delta::Zero();
+  int handoff_fd_ = -1;
+  // Listening socket to pass with the first export, -1 once passed.
+  int udp_fd_to_pass_ = -1;
+  DrainStats stats_;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_TOOLS_QUIC_SERVER_DRAIN_MANAGER_H_
@@ -9,6 +9,7 @@
 #include "quic/core/quic_epoll_alarm_factory.h"
 #include "quic/core/quic_epoll_connection_helper.h"
 #include "quic/core/quic_utils.h"
+#include "quic/platform/api/quic_expect_bug.h"
 #include "quic/platform/api/quic_flags.h"
 #include "quic/platform/api/quic_logging.h"
 #include "quic/platform/api/quic_port_utils.h"
@@ -149,6 +150,50 @@ TEST_F(QuicServerEpollInTest, ProcessBufferedCHLOsOnEpollin) {
   }
 }
 
+// Tests that a socket added with CreateAdditionalUDPSocketAndListen feeds the
+// same dispatcher as the primary socket.
+TEST_F(QuicServerEpollInTest, AdditionalListenSocketFeedsSameDispatcher) {
+  // Additional sockets require the dispatcher, which the primary socket
+  // creates.
+  EXPECT_QUIC_BUG(server_.CreateAdditionalUDPSocketAndListen(server_address_),
+                  "CreateAdditionalUDPSocketAndListen called before");
+
+  StartListening();
+  const QuicSocketAddress additional_address(
+      TestLoopback(), QuicPickServerPortForTestsOrDie());
+  ASSERT_TRUE(server_.CreateAdditionalUDPSocketAndListen(additional_address));
+
+  MockQuicSimpleDispatcher* dispatcher = server_.mock_dispatcher();
+  QUICHE_DCHECK(dispatcher != nullptr);
+  bool packet_handled = false;
+  EXPECT_CALL(*dispatcher, OnCanWrite()).Times(testing::AnyNumber());
+  EXPECT_CALL(*dispatcher, HasPendingWrites()).Times(testing::AnyNumber());
+  EXPECT_CALL(*dispatcher, ProcessBufferedChlos(_)).Times(testing::AnyNumber());
+  EXPECT_CALL(*dispatcher, HasChlosBuffered())
+      .WillOnce(
+          DoAll(testing::Assign(&packet_handled, true), testing::Return(false)))
+      .WillRepeatedly(testing::Return(false));
+
+  // Send a packet to the additional socket to trigger an epoll event there.
+  int fd = socket(
+      AddressFamilyUnderTest() == IpAddressFamily::IP_V4 ? AF_INET : AF_INET6,
+      SOCK_DGRAM | SOCK_NONBLOCK, IPPROTO_UDP);
+  ASSERT_LT(0, fd);
+
+  char buf[1024];
+  memset(buf, 0, ABSL_ARRAYSIZE(buf));
+  sockaddr_storage storage = additional_address.generic_address();
+  int rc = sendto(fd, buf, ABSL_ARRAYSIZE(buf), 0,
+                  reinterpret_cast<sockaddr*>(&storage), sizeof(storage));
+  if (rc < 0) {
+    QUIC_DLOG(INFO) << errno << " " << strerror(errno);
+  }
+
+  while (!packet_handled) {
+    server_.WaitForEvents();
+  }
+}
+
 class QuicServerDispatchPacketTest : public QuicTest {
  public:
   QuicServerDispatchPacketTest()
@@ -0,0 +1,288 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/tools/quic_sharded_server.h"
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <utility>
+
+#include "quic/core/quic_epoll_alarm_factory.h"
+#include "quic/core/quic_epoll_connection_helper.h"
+#include "quic/core/quic_framer.h"
+#include "quic/core/quic_udp_socket.h"
+#include "quic/platform/api/quic_logging.h"
+#include "quic/tools/quic_simple_crypto_server_stream_helper.h"
+
+namespace quic {
+
+namespace {
+
+// Capacity of each shard's handoff queue.  Must be a power of two.
+const size_t kHandoffQueueCapacity = 1024;
+
+// Pins the calling thread to |cpu| so that connections owned by a shard stay
+// on one core.  Best effort: a no-op on platforms without sched_setaffinity.
+void PinCurrentThreadToCpu(size_t cpu) {
+#if defined(__linux__)
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  CPU_SET(cpu % CPU_SETSIZE, &cpuset);
+  if (pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset) != 0) {
+    QUIC_LOG(WARNING) << "Failed to pin shard thread to cpu " << cpu;
+  }
+#else
+  (void)cpu;
+#endif
+}
+
+}  // namespace
+
+QuicPacketShardHandoffQueue::QuicPacketShardHandoffQueue(size_t capacity)
+    : buffer_(capacity), mask_(capacity - 1), enqueue_pos_(0), dequeue_pos_(0) {
+  QUICHE_DCHECK_EQ(capacity & (capacity - 1), 0u)
+      << "capacity must be a power of two";
+  for (size_t i = 0; i < capacity; ++i) {
+    buffer_[i].sequence.store(i, std::memory_order_relaxed);
+    buffer_[i].packet = nullptr;
+  }
+}
+
+QuicPacketShardHandoffQueue::~QuicPacketShardHandoffQueue() {
+  while (std::unique_ptr<HandoffPacket> packet = Dequeue()) {
+  }
+}
+
+bool QuicPacketShardHandoffQueue::Enqueue(
+    std::unique_ptr<HandoffPacket> packet) {
+  size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+  for (;;) {
+    Slot& slot = buffer_[pos & mask_];
+    size_t sequence = slot.sequence.load(std::memory_order_acquire);
+    intptr_t diff =
+        static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+    if (diff == 0) {
+      // The slot is free; try to claim it.
+      if (enqueue_pos_.compare_exchange_weak(pos, pos + 1,
+                                             std::memory_order_relaxed)) {
+        slot.packet = packet.release();
+        slot.sequence.store(pos + 1, std::memory_order_release);
+        return true;
+      }
+    } else if (diff < 0) {
+      // The consumer has not freed this slot yet: the queue is full.
+      return false;
+    } else {
+      // Another producer claimed |pos|; reload and retry.
+      pos = enqueue_pos_.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+std::unique_ptr<QuicPacketShardHandoffQueue::HandoffPacket>
+QuicPacketShardHandoffQueue::Dequeue() {
+  size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+  Slot& slot = buffer_[pos & mask_];
+  size_t sequence = slot.sequence.load(std::memory_order_acquire);
+  intptr_t diff =
+      static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+  if (diff < 0) {
+    return nullptr;
+  }
+  // Single consumer: no CAS needed on the dequeue cursor.
+  dequeue_pos_.store(pos + 1, std::memory_order_relaxed);
+  std::unique_ptr<HandoffPacket> packet(slot.packet);
+  slot.packet = nullptr;
+  slot.sequence.store(pos + buffer_.size(), std::memory_order_release);
+  return packet;
+}
+
+QuicShardedServer::ShardedQuicServer::ShardedQuicServer(
+    std::unique_ptr<ProofSource> proof_source,
+    QuicSimpleServerBackend* backend,
+    const ParsedQuicVersionVector& supported_versions,
+    QuicShardedServer* owner,
+    size_t shard_id)
+    : QuicServer(std::move(proof_source), backend, supported_versions),
+      owner_(owner),
+      shard_id_(shard_id) {}
+
+bool QuicShardedServer::ShardedQuicServer::ConfigureSocket(QuicUdpSocketFd fd) {
+  QuicUdpSocketApi socket_api;
+  if (!socket_api.EnableReusePort(fd)) {
+    QUIC_LOG(ERROR) << "Failed to enable SO_REUSEPORT on shard " << shard_id_;
+    return false;
+  }
+  return true;
+}
+
+QuicDispatcher* QuicShardedServer::ShardedQuicServer::CreateQuicDispatcher() {
+  return new ShardRoutingDispatcher(
+      &config(), &crypto_config(), version_manager(),
+      std::unique_ptr<QuicEpollConnectionHelper>(new QuicEpollConnectionHelper(
+          epoll_server(), QuicAllocator::BUFFER_POOL)),
+      std::unique_ptr<QuicCryptoServerStreamBase::Helper>(
+          new QuicSimpleCryptoServerStreamHelper()),
+      std::unique_ptr<QuicEpollAlarmFactory>(
+          new QuicEpollAlarmFactory(epoll_server())),
+      server_backend(), expected_server_connection_id_length(), owner_,
+      shard_id_);
+}
+
+QuicShardedServer::ShardRoutingDispatcher::ShardRoutingDispatcher(
+    const QuicConfig* config,
+    const QuicCryptoServerConfig* crypto_config,
+    QuicVersionManager* version_manager,
+    std::unique_ptr<QuicConnectionHelperInterface> helper,
+    std::unique_ptr<QuicCryptoServerStreamBase::Helper> session_helper,
+    std::unique_ptr<QuicAlarmFactory> alarm_factory,
+    QuicSimpleServerBackend* backend,
+    uint8_t expected_server_connection_id_length,
+    QuicShardedServer* owner,
+    size_t shard_id)
+    : QuicSimpleDispatcher(config,
+                           crypto_config,
+                           version_manager,
+                           std::move(helper),
+                           std::move(session_helper),
+                           std::move(alarm_factory),
+                           backend,
+                           expected_server_connection_id_length),
+      owner_(owner),
+      shard_id_(shard_id) {}
+
+void QuicShardedServer::ShardRoutingDispatcher::ProcessPacket(
+    const QuicSocketAddress& self_address,
+    const QuicSocketAddress& peer_address,
+    const QuicReceivedPacket& packet) {
+  PacketHeaderFormat format;
+  QuicLongHeaderType long_packet_type;
+  bool version_present;
+  bool has_length_prefix;
+  QuicVersionLabel version_label;
+  ParsedQuicVersion parsed_version = ParsedQuicVersion::Unsupported();
+  QuicConnectionId destination_connection_id;
+  QuicConnectionId source_connection_id;
+  absl::optional<absl::string_view> retry_token;
+  std::string detailed_error;
+  QuicErrorCode error = QuicFramer::ParsePublicHeaderDispatcher(
+      packet, expected_server_connection_id_length(), &format,
+      &long_packet_type, &version_present, &has_length_prefix, &version_label,
+      &parsed_version, &destination_connection_id, &source_connection_id,
+      &retry_token, &detailed_error);
+  if (error == QUIC_NO_ERROR) {
+    const size_t target_shard = owner_->ShardIdFor(destination_connection_id);
+    if (target_shard != shard_id_) {
+      owner_->HandOffPacket(target_shard, self_address, peer_address, packet);
+      return;
+    }
+  }
+  // Unparseable packets are handled (and rejected) locally.
+  QuicSimpleDispatcher::ProcessPacket(self_address, peer_address, packet);
+}
+
+QuicShardedServer::Shard::Shard(QuicShardedServer* owner, size_t shard_id)
+    : QuicThread("quic_shard_" + std::to_string(shard_id)),
+      owner_(owner),
+      shard_id_(shard_id),
+      handoff_queue_(kHandoffQueueCapacity),
+      quitting_(false) {}
+
+QuicShardedServer::Shard::~Shard() = default;
+
+bool QuicShardedServer::Shard::Initialize(const QuicSocketAddress& address) {
+  server_ = std::make_unique<ShardedQuicServer>(
+      owner_->proof_source_factory_(), owner_->backend_,
+      owner_->supported_versions_, owner_, shard_id_);
+  return server_->CreateUDPSocketAndListen(address);
+}
+
+void QuicShardedServer::Shard::Quit() {
+  quitting_.store(true, std::memory_order_release);
+  server_->epoll_server()->Wake();
+}
+
+void QuicShardedServer::Shard::Run() {
+  PinCurrentThreadToCpu(shard_id_);
+  while (!quitting_.load(std::memory_order_acquire)) {
+    server_->WaitForEvents();
+    DrainHandoffQueue();
+  }
+  server_->Shutdown();
+}
+
+void QuicShardedServer::Shard::DrainHandoffQueue() {
+  while (std::unique_ptr<QuicPacketShardHandoffQueue::HandoffPacket> handoff =
+             handoff_queue_.Dequeue()) {
+    server_->dispatcher()->ProcessPacket(
+        handoff->self_address, handoff->peer_address, *handoff->packet);
+  }
+}
+
+QuicShardedServer::QuicShardedServer(
+    size_t num_shards,
+    ProofSourceFactory proof_source_factory,
+    QuicSimpleServerBackend* backend,
+    const ParsedQuicVersionVector& supported_versions)
+    : num_shards_(num_shards),
+      proof_source_factory_(proof_source_factory),
+      backend_(backend),
+      supported_versions_(supported_versions) {
+  QUICHE_DCHECK_GT(num_shards, 0u);
+}
+
+QuicShardedServer::~QuicShardedServer() {
+  Shutdown();
+}
+
+bool QuicShardedServer::Listen(const QuicSocketAddress& address) {
+  QUICHE_DCHECK(shards_.empty()) << "Listen() called twice";
+  for (size_t i = 0; i < num_shards_; ++i) {
+    auto shard = std::make_unique<Shard>(this, i);
+    if (!shard->Initialize(address)) {
+      QUIC_LOG(ERROR) << "Failed to initialize shard " << i;
+      shards_.clear();
+      return false;
+    }
+    port_ = shard->server()->port();
+    shards_.push_back(std::move(shard));
+  }
+  for (auto& shard : shards_) {
+    shard->Start();
+  }
+  return true;
+}
+
+void QuicShardedServer::Shutdown() {
+  for (auto& shard : shards_) {
+    shard->Quit();
+  }
+  for (auto& shard : shards_) {
+    shard->Join();
+  }
+  shards_.clear();
+}
+
+void QuicShardedServer::HandOffPacket(size_t target_shard,
+                                      const QuicSocketAddress& self_address,
+                                      const QuicSocketAddress& peer_address,
+                                      const QuicReceivedPacket& packet) {
+  QUICHE_DCHECK_LT(target_shard, shards_.size());
+  auto handoff = std::make_unique<QuicPacketShardHandoffQueue::HandoffPacket>();
+  handoff->self_address = self_address;
+  handoff->peer_address = peer_address;
+  handoff->packet = packet.Clone();
+  Shard* shard = shards_[target_shard].get();
+  if (!shard->handoff_queue()->Enqueue(std::move(handoff))) {
+    QUIC_DLOG(WARNING) << "Handoff queue for shard " << target_shard
+                       << " is full; dropping packet";
+    return;
+  }
+  shard->server()->epoll_server()->Wake();
+}
+
+}  // namespace quic
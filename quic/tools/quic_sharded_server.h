@@ -0,0 +1,211 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// A sharded wrapper around QuicServer which runs one dispatcher per shard,
+// each on its own thread with its own epoll loop.  Incoming connections are
+// assigned to shards by hashing their destination connection ID, and packets
+// which the kernel delivers to the wrong shard (e.g. because SO_REUSEPORT
+// hashes on the 4-tuple rather than the connection ID) are handed off to the
+// owning shard through a lock-free queue, so each QuicConnection only ever
+// runs on one thread.
+
+#ifndef QUICHE_QUIC_TOOLS_QUIC_SHARDED_SERVER_H_
+#define QUICHE_QUIC_TOOLS_QUIC_SHARDED_SERVER_H_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "quic/core/crypto/proof_source.h"
+#include "quic/core/quic_connection_id.h"
+#include "quic/core/quic_packets.h"
+#include "quic/core/quic_version_manager.h"
+#include "quic/platform/api/quic_socket_address.h"
+#include "quic/platform/api/quic_thread.h"
+#include "quic/tools/quic_server.h"
+#include "quic/tools/quic_simple_dispatcher.h"
+#include "quic/tools/quic_simple_server_backend.h"
+
+namespace quic {
+
+namespace test {
+class QuicShardedServerPeer;
+}  // namespace test
+
+// A bounded, lock-free multi-producer single-consumer queue used to hand
+// packets received on the wrong shard over to the shard which owns the
+// connection.  Producers are the other shard threads; the consumer is the
+// owning shard's event loop.
+class QUIC_NO_EXPORT QuicPacketShardHandoffQueue {
+ public:
+  struct QUIC_NO_EXPORT HandoffPacket {
+    QuicSocketAddress self_address;
+    QuicSocketAddress peer_address;
+    std::unique_ptr<QuicReceivedPacket> packet;
+  };
+
+  // |capacity| must be a power of two.
+  explicit QuicPacketShardHandoffQueue(size_t capacity);
+  QuicPacketShardHandoffQueue(const QuicPacketShardHandoffQueue&) = delete;
+  QuicPacketShardHandoffQueue& operator=(const QuicPacketShardHandoffQueue&) =
+      delete;
+  ~QuicPacketShardHandoffQueue();
+
+  // Attempts to enqueue |packet|.  Returns false if the queue is full, in
+  // which case the packet is dropped by the caller.  Safe to call from any
+  // thread.
+  bool Enqueue(std::unique_ptr<HandoffPacket> packet);
+
+  // Dequeues the oldest packet, or returns nullptr if the queue is empty.
+  // Must only be called from the consuming shard's thread.
+  std::unique_ptr<HandoffPacket> Dequeue();
+
+  size_t capacity() const { return buffer_.size(); }
+
+ private:
+  // Each slot carries a sequence number used to detect whether it is ready
+  // for the producer (sequence == slot index + generation * capacity) or the
+  // consumer (sequence == slot index + generation * capacity + 1).
+  struct QUIC_NO_EXPORT Slot {
+    std::atomic<size_t> sequence;
+    HandoffPacket* packet;
+  };
+
+  std::vector<Slot> buffer_;
+  const size_t mask_;
+  // Producer and consumer cursors live on separate cache lines to avoid
+  // false sharing between shard threads.
+  alignas(64) std::atomic<size_t> enqueue_pos_;
+  alignas(64) std::atomic<size_t> dequeue_pos_;
+};
+
+// QuicShardedServer runs |num_shards| QuicServer instances, each with its own
+// SimpleEpollServer loop, dispatcher and SO_REUSEPORT socket bound to the
+// same listening address.  Shard ownership of a connection is determined by
+// QuicConnectionId::Hash() modulo the shard count.
+class QUIC_NO_EXPORT QuicShardedServer {
+ public:
+  // Factory for per-shard proof sources; called once per shard.
+  using ProofSourceFactory = std::unique_ptr<ProofSource> (*)();
+
+  QuicShardedServer(size_t num_shards,
+                    ProofSourceFactory proof_source_factory,
+                    QuicSimpleServerBackend* backend,
+                    const ParsedQuicVersionVector& supported_versions);
+  QuicShardedServer(const QuicShardedServer&) = delete;
+  QuicShardedServer& operator=(const QuicShardedServer&) = delete;
+  ~QuicShardedServer();
+
+  // Binds one SO_REUSEPORT socket per shard and starts the shard threads.
+  // Returns false if any shard fails to bind.
+  bool Listen(const QuicSocketAddress& address);
+
+  // Stops all shard loops and joins the threads.
+  void Shutdown();
+
+  // Returns the shard which owns |connection_id|.
+  size_t ShardIdFor(QuicConnectionId connection_id) const {
+    return connection_id.Hash() % num_shards_;
+  }
+
+  size_t num_shards() const { return num_shards_; }
+
+  int port() const { return port_; }
+
+ private:
+  friend class test::QuicShardedServerPeer;
+
+  class Shard;
+
+  // A QuicServer whose dispatcher re-routes packets belonging to another
+  // shard instead of processing them locally.
+  class QUIC_NO_EXPORT ShardedQuicServer : public QuicServer {
+   public:
+    ShardedQuicServer(std::unique_ptr<ProofSource> proof_source,
+                      QuicSimpleServerBackend* backend,
+                      const ParsedQuicVersionVector& supported_versions,
+                      QuicShardedServer* owner,
+                      size_t shard_id);
+
+   protected:
+    // Enables SO_REUSEPORT so every shard can bind to the listen address.
+    bool ConfigureSocket(QuicUdpSocketFd fd) override;
+
+    QuicDispatcher* CreateQuicDispatcher() override;
+
+   private:
+    QuicShardedServer* owner_;  // Unowned.
+    size_t shard_id_;
+  };
+
+  // A dispatcher which parses the destination connection ID of every packet
+  // and hands packets owned by other shards to their handoff queues.
+  class QUIC_NO_EXPORT ShardRoutingDispatcher : public QuicSimpleDispatcher {
+   public:
+    ShardRoutingDispatcher(
+        const QuicConfig* config,
+        const QuicCryptoServerConfig* crypto_config,
+        QuicVersionManager* version_manager,
+        std::unique_ptr<QuicConnectionHelperInterface> helper,
+        std::unique_ptr<QuicCryptoServerStreamBase::Helper> session_helper,
+        std::unique_ptr<QuicAlarmFactory> alarm_factory,
+        QuicSimpleServerBackend* backend,
+        uint8_t expected_server_connection_id_length,
+        QuicShardedServer* owner,
+        size_t shard_id);
+
+    void ProcessPacket(const QuicSocketAddress& self_address,
+                       const QuicSocketAddress& peer_address,
+                       const QuicReceivedPacket& packet) override;
+
+   private:
+    QuicShardedServer* owner_;  // Unowned.
+    size_t shard_id_;
+  };
+
+  // One shard: a thread running its own QuicServer event loop and draining
+  // its handoff queue after every wait.
+  class QUIC_NO_EXPORT Shard : public QuicThread {
+   public:
+    Shard(QuicShardedServer* owner, size_t shard_id);
+    ~Shard() override;
+
+    bool Initialize(const QuicSocketAddress& address);
+    void Quit();
+
+    QuicPacketShardHandoffQueue* handoff_queue() { return &handoff_queue_; }
+    ShardedQuicServer* server() { return server_.get(); }
+
+   protected:
+    void Run() override;
+
+   private:
+    void DrainHandoffQueue();
+
+    QuicShardedServer* owner_;  // Unowned.
+    const size_t shard_id_;
+    QuicPacketShardHandoffQueue handoff_queue_;
+    std::unique_ptr<ShardedQuicServer> server_;
+    std::atomic<bool> quitting_;
+  };
+
+  // Hands |packet| to the shard owning |destination_connection_id| and wakes
+  // its event loop.  Called from the receiving (wrong) shard's thread.
+  void HandOffPacket(size_t target_shard,
+                     const QuicSocketAddress& self_address,
+                     const QuicSocketAddress& peer_address,
+                     const QuicReceivedPacket& packet);
+
+  const size_t num_shards_;
+  ProofSourceFactory proof_source_factory_;
+  QuicSimpleServerBackend* backend_;  // Unowned.
+  ParsedQuicVersionVector supported_versions_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+  int port_ = 0;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_TOOLS_QUIC_SHARDED_SERVER_H_
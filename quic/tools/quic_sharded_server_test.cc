@@ -0,0 +1,68 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/tools/quic_sharded_server.h"
+
+#include <memory>
+#include <utility>
+
+#include "quic/platform/api/quic_test.h"
+#include "quic/test_tools/quic_test_utils.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+std::unique_ptr<QuicPacketShardHandoffQueue::HandoffPacket> MakeHandoffPacket(
+    char payload) {
+  auto handoff = std::make_unique<QuicPacketShardHandoffQueue::HandoffPacket>();
+  char buffer[1] = {payload};
+  QuicReceivedPacket packet(buffer, sizeof(buffer), QuicTime::Zero());
+  handoff->packet = packet.Clone();
+  return handoff;
+}
+
+TEST(QuicPacketShardHandoffQueueTest, DequeueEmptyReturnsNull) {
+  QuicPacketShardHandoffQueue queue(/*capacity=*/4);
+  EXPECT_EQ(nullptr, queue.Dequeue());
+}
+
+TEST(QuicPacketShardHandoffQueueTest, FifoOrder) {
+  QuicPacketShardHandoffQueue queue(/*capacity=*/4);
+  ASSERT_TRUE(queue.Enqueue(MakeHandoffPacket('a')));
+  ASSERT_TRUE(queue.Enqueue(MakeHandoffPacket('b')));
+  ASSERT_TRUE(queue.Enqueue(MakeHandoffPacket('c')));
+
+  for (char expected : {'a', 'b', 'c'}) {
+    auto handoff = queue.Dequeue();
+    ASSERT_NE(nullptr, handoff);
+    EXPECT_EQ(expected, handoff->packet->data()[0]);
+  }
+  EXPECT_EQ(nullptr, queue.Dequeue());
+}
+
+TEST(QuicPacketShardHandoffQueueTest, EnqueueFailsWhenFull) {
+  QuicPacketShardHandoffQueue queue(/*capacity=*/2);
+  EXPECT_TRUE(queue.Enqueue(MakeHandoffPacket('a')));
+  EXPECT_TRUE(queue.Enqueue(MakeHandoffPacket('b')));
+  EXPECT_FALSE(queue.Enqueue(MakeHandoffPacket('c')));
+
+  // Draining one slot makes room again.
+  EXPECT_NE(nullptr, queue.Dequeue());
+  EXPECT_TRUE(queue.Enqueue(MakeHandoffPacket('d')));
+}
+
+TEST(QuicPacketShardHandoffQueueTest, WrapsAroundCapacity) {
+  QuicPacketShardHandoffQueue queue(/*capacity=*/2);
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_TRUE(queue.Enqueue(MakeHandoffPacket('a' + (i % 26))));
+    auto handoff = queue.Dequeue();
+    ASSERT_NE(nullptr, handoff);
+    EXPECT_EQ('a' + (i % 26), handoff->packet->data()[0]);
+  }
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
@@ -5,6 +5,7 @@
 #include "quic/tools/quic_simple_dispatcher.h"
 
 #include "absl/strings/string_view.h"
+#include "quic/platform/api/quic_logging.h"
 #include "quic/tools/quic_simple_server_session.h"
 
 namespace quic {
@@ -25,7 +26,8 @@ QuicSimpleDispatcher::QuicSimpleDispatcher(
                      std::move(session_helper),
                      std::move(alarm_factory),
                      expected_server_connection_id_length),
-      quic_simple_server_backend_(quic_simple_server_backend) {}
+      quic_simple_server_backend_(quic_simple_server_backend),
+      source_rate_limiter_(QuicDispatcher::helper()->GetClock()) {}
 
 QuicSimpleDispatcher::~QuicSimpleDispatcher() = default;
 
@@ -48,6 +50,27 @@ void QuicSimpleDispatcher::OnRstStreamReceived(
   }
 }
 
+void QuicSimpleDispatcher::ProcessPacket(const QuicSocketAddress& self_address,
+                                         const QuicSocketAddress& peer_address,
+                                         const QuicReceivedPacket& packet) {
+  const QuicTime start = helper()->GetClock()->Now();
+  QuicDispatcher::ProcessPacket(self_address, peer_address, packet);
+  source_rate_limiter_.OnPacketProcessed(peer_address,
+                                         helper()->GetClock()->Now() - start);
+}
+
+bool QuicSimpleDispatcher::ShouldCreateOrBufferPacketForConnection(
+    const ReceivedPacketInfo& packet_info) {
+  if (!source_rate_limiter_.OnNewConnectionAttempt(packet_info.peer_address)) {
+    QUIC_DLOG(INFO) << "Rejecting new connection "
+                    << packet_info.destination_connection_id << " from "
+                    << packet_info.peer_address
+                    << ": source is out of budget.";
+    return false;
+  }
+  return QuicDispatcher::ShouldCreateOrBufferPacketForConnection(packet_info);
+}
+
 std::unique_ptr<QuicSession> QuicSimpleDispatcher::CreateQuicSession(
     QuicConnectionId connection_id, const QuicSocketAddress& self_address,
     const QuicSocketAddress& peer_address, absl::string_view /*alpn*/,
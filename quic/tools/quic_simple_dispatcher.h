@@ -9,6 +9,7 @@
 #include "quic/core/http/quic_server_session_base.h"
 #include "quic/core/quic_dispatcher.h"
 #include "quic/tools/quic_simple_server_backend.h"
+#include "quic/tools/quic_source_rate_limiter.h"
 
 namespace quic {
 
@@ -30,6 +31,15 @@ class QuicSimpleDispatcher : public QuicDispatcher {
 
   void OnRstStreamReceived(const QuicRstStreamFrame& frame) override;
 
+  // Charges the processing time of each packet to its source address.
+  void ProcessPacket(const QuicSocketAddress& self_address,
+                     const QuicSocketAddress& peer_address,
+                     const QuicReceivedPacket& packet) override;
+
+  const QuicSourceRateLimiter& source_rate_limiter() const {
+    return source_rate_limiter_;
+  }
+
  protected:
   std::unique_ptr<QuicSession> CreateQuicSession(
       QuicConnectionId connection_id, const QuicSocketAddress& self_address,
@@ -37,6 +47,10 @@ class QuicSimpleDispatcher : public QuicDispatcher {
       const ParsedQuicVersion& version,
       const ParsedClientHello& parsed_chlo) override;
 
+  // Rejects packets from new connections whose source is out of budget.
+  bool ShouldCreateOrBufferPacketForConnection(
+      const ReceivedPacketInfo& packet_info) override;
+
   QuicSimpleServerBackend* server_backend() {
     return quic_simple_server_backend_;
   }
@@ -46,6 +60,9 @@ class QuicSimpleDispatcher : public QuicDispatcher {
 
   // The map of the reset error code with its counter.
   std::map<QuicRstStreamErrorCode, int> rst_error_map_;
+
+  // Per-source admission control and cost accounting.
+  QuicSourceRateLimiter source_rate_limiter_;
 };
 
 }  // namespace quic
@@ -6,7 +6,10 @@
 #define QUICHE_QUIC_TOOLS_QUIC_SIMPLE_SERVER_BACKEND_H_
 
 #include <memory>
+#include <string>
+#include <vector>
 
+#include "absl/strings/string_view.h"
 #include "quic/core/quic_types.h"
 #include "quic/core/web_transport_interface.h"
 #include "quic/tools/quic_backend_response.h"
@@ -19,6 +22,45 @@ namespace quic {
 // requests received by a Quic Server
 class QuicSimpleServerBackend {
  public:
+  // Pull-based source of response body bytes for streamed responses. The
+  // stream owns the source and asks for the next chunk only when its send
+  // buffer has drained below the low watermark (set by the
+  // --quic_buffered_data_threshold flag), so per-stream buffering is bounded
+  // by roughly the bandwidth-delay product instead of the response size.
+  class ResponseBodySource {
+   public:
+    virtual ~ResponseBodySource() {}
+
+    // Returns the next chunk of up to |max_length| body bytes and sets |*fin|
+    // to true if the body ends with this chunk. Returning an empty chunk
+    // without setting |*fin| resets the stream, as the source has no way to
+    // resume the response later.
+    virtual std::string GetNextBodyChunk(size_t max_length, bool* fin) = 0;
+  };
+
+  // Push-based sink for streamed ingestion of a request body. The stream
+  // hands body bytes to the sink as they are consumed from its receive
+  // buffer; bytes the sink does not accept stay buffered there and keep
+  // holding the stream's flow control window, so memory for
+  // buffered-but-unprocessed upload bytes is capped at roughly that window
+  // instead of the upload size.
+  class RequestBodySink {
+   public:
+    virtual ~RequestBodySink() {}
+
+    // Consumes up to |data.size()| request body bytes and returns the
+    // number accepted. Returning fewer pauses delivery; once the sink has
+    // room again it calls RequestHandler::OnRequestBodySinkResumed() to
+    // receive the remainder.
+    virtual size_t OnBodyData(absl::string_view data) = 0;
+
+    // Called once after the last body byte has been accepted; |trailers|
+    // is empty when the request carried none. The backend then responds
+    // through the RequestHandler, as FetchResponseFromBackend is not
+    // called for requests ingested through a sink.
+    virtual void OnBodyComplete(spdy::Http2HeaderBlock trailers) = 0;
+  };
+
   // This interface implements the methods
   // called by the QuicSimpleServerBackend implementation
   // to process the request in the backend
@@ -33,6 +75,17 @@ class QuicSimpleServerBackend {
     // the QUIC client.
     virtual void OnResponseBackendComplete(
         const QuicBackendResponse* response) = 0;
+    // Called when the backend streams the response body instead of delivering
+    // it whole: |response_headers| are sent right away and body chunks are
+    // pulled from |body_source| as transport buffers drain. A null
+    // |body_source| sends |response_headers| with a FIN.
+    virtual void OnStreamingResponseBackendComplete(
+        spdy::Http2HeaderBlock response_headers,
+        std::unique_ptr<ResponseBodySource> body_source) = 0;
+    // Called by a RequestBodySink that previously accepted only part of a
+    // body chunk, once it can take more bytes. The stream resumes handing
+    // buffered body bytes to the sink.
+    virtual void OnRequestBodySinkResumed() = 0;
   };
 
   struct WebTransportResponse {
@@ -56,6 +109,30 @@ class QuicSimpleServerBackend {
       const spdy::Http2HeaderBlock& request_headers,
       const std::string& request_body,
       RequestHandler* request_handler) = 0;
+  // Returns true if FetchResponseFromBackend() always completes the
+  // |request_handler| before returning, e.g. for an in-memory cache.
+  // Servers may then run a request to completion -- fetch, response encode
+  // and packet write -- within the packet-processing call stack instead of
+  // waiting for a deferred completion.
+  virtual bool CanFetchSynchronously() const { return false; }
+  // Returns a sink for streamed ingestion of the request body, or nullptr
+  // (the default) to have the stream accumulate the whole body and deliver
+  // it through FetchResponseFromBackend. Called once the request headers
+  // are complete on a request that still has body data outstanding, so
+  // backends can start processing an upload before its last byte arrives.
+  virtual std::unique_ptr<RequestBodySink> MaybeCreateRequestBodySink(
+      const spdy::Http2HeaderBlock& /*request_headers*/,
+      RequestHandler* /*request_handler*/) {
+    return nullptr;
+  }
+  // Returns informational 103 header blocks to be sent as soon as the request
+  // headers are received, before the response fetch completes. Backends that
+  // can resolve resource hints synchronously should override this; the
+  // default sends no Early Hints.
+  virtual std::vector<spdy::Http2HeaderBlock> GetEarlyHints(
+      const spdy::Http2HeaderBlock& /*request_headers*/) {
+    return {};
+  }
   // Clears the state of the backend  instance
   virtual void CloseBackendResponseStream(RequestHandler* request_handler) = 0;
 
@@ -25,6 +25,13 @@ using spdy::Http2HeaderBlock;
 
 namespace quic {
 
+namespace {
+
+// Upper bound on the body bytes requested from a ResponseBodySource at once.
+const size_t kStreamedResponseChunkSize = 64 * 1024;
+
+}  // namespace
+
 QuicSimpleServerStream::QuicSimpleServerStream(
     QuicStreamId id,
     QuicSpdySession* session,
@@ -65,6 +72,12 @@ void QuicSimpleServerStream::OnInitialHeadersComplete(
       SendErrorResponse();
   }
   ConsumeHeaderList();
+  if (!response_sent_) {
+    // Send Early Hints right away, before the backend fetch. Encoding the
+    // hints first also seeds the QPACK dynamic table with entries the final
+    // response headers can refer back to.
+    MaybeSendEarlyHints();
+  }
   if (!fin && !response_sent_) {
     // CONNECT and other CONNECT-like methods (such as CONNECT-UDP) require
     // sending the response right after parsing the headers even though the FIN
@@ -73,19 +86,51 @@ void QuicSimpleServerStream::OnInitialHeadersComplete(
     if (it != request_headers_.end() &&
         absl::StartsWith(it->second, "CONNECT")) {
       SendResponse();
+    } else if (web_transport() == nullptr &&
+               quic_simple_server_backend_ != nullptr) {
+      // Body data is still outstanding; backends that can ingest the upload
+      // incrementally return a sink here, so processing starts before the
+      // last byte arrives and the body is never accumulated whole.
+      body_sink_ = quic_simple_server_backend_->MaybeCreateRequestBodySink(
+          request_headers_, this);
     }
   }
+  if (fin && !response_sent_ && web_transport() == nullptr &&
+      quic_simple_server_backend_ != nullptr &&
+      quic_simple_server_backend_->CanFetchSynchronously()) {
+    // Run-to-completion fast path: the request ended at its headers and the
+    // backend answers inline, so respond directly from the header-complete
+    // callback instead of waiting for the sequencer to re-deliver the fin
+    // through OnBodyAvailable. Lookup, QPACK encode and stream write all
+    // happen within the current packet-processing call. Reading is stopped
+    // first so the fin is consumed silently, as error responses already do.
+    QUIC_DVLOG(1) << "Stream " << id()
+                  << " responding synchronously at header completion.";
+    StopReading();
+    SendResponse();
+  }
 }
 
 void QuicSimpleServerStream::OnTrailingHeadersComplete(
-    bool /*fin*/,
-    size_t /*frame_len*/,
-    const QuicHeaderList& /*header_list*/) {
+    bool fin,
+    size_t frame_len,
+    const QuicHeaderList& header_list) {
+  if (body_sink_ != nullptr) {
+    // Streamed uploads accept trailers; they are delivered to the sink with
+    // OnBodyComplete() once the whole body has been accepted.
+    QuicSpdyStream::OnTrailingHeadersComplete(fin, frame_len, header_list);
+    MarkTrailersConsumed();
+    return;
+  }
   QUIC_BUG(quic_bug_10962_1) << "Server does not support receiving Trailers.";
   SendErrorResponse();
 }
 
 void QuicSimpleServerStream::OnBodyAvailable() {
+  if (body_sink_ != nullptr) {
+    DeliverBodyToSink();
+    return;
+  }
   while (HasBytesToRead()) {
     struct iovec iov;
     if (GetReadableRegions(&iov, 1) == 0) {
@@ -121,6 +166,70 @@ void QuicSimpleServerStream::OnBodyAvailable() {
   SendResponse();
 }
 
+void QuicSimpleServerStream::DeliverBodyToSink() {
+  while (HasBytesToRead()) {
+    struct iovec iov;
+    if (GetReadableRegions(&iov, 1) == 0) {
+      // No more data to read.
+      break;
+    }
+    const size_t accepted = body_sink_->OnBodyData(
+        absl::string_view(static_cast<char*>(iov.iov_base), iov.iov_len));
+    if (accepted > 0) {
+      body_bytes_delivered_ += accepted;
+      if (content_length_ >= 0 &&
+          body_bytes_delivered_ > static_cast<uint64_t>(content_length_)) {
+        QUIC_DVLOG(1) << "Body size (" << body_bytes_delivered_
+                      << ") > content length (" << content_length_ << ").";
+        body_sink_ = nullptr;
+        SendErrorResponse();
+        return;
+      }
+      MarkConsumed(accepted);
+    }
+    if (accepted < iov.iov_len) {
+      // The sink is full. Unaccepted bytes stay in the receive buffer and
+      // keep holding the stream's flow control window, so the client cannot
+      // get more than a window ahead of the sink. Delivery resumes when the
+      // sink calls OnRequestBodySinkResumed().
+      QUIC_DVLOG(1) << "Stream " << id() << " pausing body delivery after "
+                    << body_bytes_delivered_ << " bytes; sink is full.";
+      return;
+    }
+  }
+  if (!sequencer()->IsClosed()) {
+    sequencer()->SetUnblocked();
+    return;
+  }
+
+  // If the sequencer is closed, then all the body, any trailers and the fin
+  // have been consumed.
+  OnFinRead();
+
+  if (content_length_ > 0 &&
+      body_bytes_delivered_ != static_cast<uint64_t>(content_length_)) {
+    QUIC_DVLOG(1) << "Content length (" << content_length_ << ") != body size ("
+                  << body_bytes_delivered_ << ").";
+    body_sink_ = nullptr;
+    SendErrorResponse();
+    return;
+  }
+
+  // The backend responds through the RequestHandler callbacks from within
+  // OnBodyComplete() or later; SendResponse() is not involved.
+  std::unique_ptr<QuicSimpleServerBackend::RequestBodySink> sink =
+      std::move(body_sink_);
+  sink->OnBodyComplete(received_trailers().Clone());
+}
+
+void QuicSimpleServerStream::OnRequestBodySinkResumed() {
+  if (body_sink_ == nullptr || !HasBytesToRead()) {
+    return;
+  }
+  QUIC_DVLOG(1) << "Stream " << id() << " resuming body delivery.";
+  DeliverBodyToSink();
+}
+
 void QuicSimpleServerStream::PushResponse(
     Http2HeaderBlock push_request_headers) {
   if (QuicUtils::IsClientInitiatedStreamId(session()->transport_version(),
@@ -197,8 +306,30 @@ void QuicSimpleServerStream::SendResponse() {
 
   // Fetch the response from the backend interface and wait for callback once
   // response is ready
+  const bool synchronous_fetch =
+      quic_simple_server_backend_->CanFetchSynchronously();
+  backend_response_delivered_ = false;
   quic_simple_server_backend_->FetchResponseFromBackend(request_headers_, body_,
                                                         this);
+  // A backend advertising synchronous fetches must have completed within the
+  // call above; deferring would silently re-introduce an extra wakeup per
+  // request.
+  QUIC_BUG_IF(quic_simple_server_stream_deferred_sync_fetch,
+              synchronous_fetch && !backend_response_delivered_)
+      << "Backend advertising CanFetchSynchronously deferred its response.";
+}
+
+void QuicSimpleServerStream::MaybeSendEarlyHints() {
+  if (quic_simple_server_backend_ == nullptr || web_transport() != nullptr) {
+    return;
+  }
+  for (Http2HeaderBlock& hints :
+       quic_simple_server_backend_->GetEarlyHints(request_headers_)) {
+    QUIC_DVLOG(1) << "Stream " << id() << " sending an Early Hints response: "
+                  << hints.DebugString();
+    WriteHeaders(std::move(hints), false, nullptr);
+    early_hints_sent_ = true;
+  }
 }
 
 QuicConnectionId QuicSimpleServerStream::connection_id() const {
@@ -215,17 +346,21 @@ std::string QuicSimpleServerStream::peer_host() const {
 
 void QuicSimpleServerStream::OnResponseBackendComplete(
     const QuicBackendResponse* response) {
+  backend_response_delivered_ = true;
   if (response == nullptr) {
     QUIC_DVLOG(1) << "Response not found in cache.";
     SendNotFoundResponse();
     return;
   }
 
-  // Send Early Hints first.
-  for (const auto& headers : response->early_hints()) {
-    QUIC_DVLOG(1) << "Stream " << id() << " sending an Early Hints response: "
-                  << headers.DebugString();
-    WriteHeaders(headers.Clone(), false, nullptr);
+  // Send Early Hints first, unless they already went out when the request
+  // headers were received.
+  if (!early_hints_sent_) {
+    for (const auto& headers : response->early_hints()) {
+      QUIC_DVLOG(1) << "Stream " << id() << " sending an Early Hints response: "
+                    << headers.DebugString();
+      WriteHeaders(headers.Clone(), false, nullptr);
+    }
   }
 
   if (response->response_type() == QuicBackendResponse::CLOSE_CONNECTION) {
@@ -317,6 +452,47 @@ void QuicSimpleServerStream::OnResponseBackendComplete(
                                 response->trailers().Clone());
 }
 
+void QuicSimpleServerStream::OnStreamingResponseBackendComplete(
+    Http2HeaderBlock response_headers,
+    std::unique_ptr<QuicSimpleServerBackend::ResponseBodySource> body_source) {
+  backend_response_delivered_ = true;
+  QUIC_DVLOG(1) << "Stream " << id() << " sending a streamed response.";
+  WriteHeaders(std::move(response_headers), /*fin=*/body_source == nullptr,
+               nullptr);
+  QUICHE_DCHECK(!response_sent_);
+  response_sent_ = true;
+
+  body_source_ = std::move(body_source);
+  WriteStreamedBody();
+}
+
+void QuicSimpleServerStream::WriteStreamedBody() {
+  // Pull the next chunk only while the send buffer is below its low
+  // watermark, so per-stream buffering stays bounded by the transport's
+  // appetite rather than the response size.
+  while (body_source_ != nullptr && CanWriteNewData()) {
+    bool fin = false;
+    std::string chunk =
+        body_source_->GetNextBodyChunk(kStreamedResponseChunkSize, &fin);
+    if (chunk.empty() && !fin) {
+      QUIC_DVLOG(1) << "Stream " << id()
+                    << " body source ran dry before the fin; resetting.";
+      body_source_ = nullptr;
+      Reset(QUIC_STREAM_CANCELLED);
+      return;
+    }
+    if (fin) {
+      body_source_ = nullptr;
+    }
+    WriteOrBufferBody(chunk, fin);
+  }
+}
+
+void QuicSimpleServerStream::OnCanWriteNewData() {
+  QuicSpdyStream::OnCanWriteNewData();
+  WriteStreamedBody();
+}
+
 void QuicSimpleServerStream::OnCanWrite() {
   QuicSpdyStream::OnCanWrite();
   WriteGeneratedBytes();
@@ -5,6 +5,8 @@
 #ifndef QUICHE_QUIC_TOOLS_QUIC_SIMPLE_SERVER_STREAM_H_
 #define QUICHE_QUIC_TOOLS_QUIC_SIMPLE_SERVER_STREAM_H_
 
+#include <memory>
+
 #include "absl/strings/string_view.h"
 #include "quic/core/http/quic_spdy_server_stream_base.h"
 #include "quic/core/quic_packets.h"
@@ -59,6 +61,11 @@ class QuicSimpleServerStream : public QuicSpdyServerStreamBase,
   QuicStreamId stream_id() const override;
   std::string peer_host() const override;
   void OnResponseBackendComplete(const QuicBackendResponse* response) override;
+  void OnStreamingResponseBackendComplete(
+      spdy::Http2HeaderBlock response_headers,
+      std::unique_ptr<QuicSimpleServerBackend::ResponseBodySource> body_source)
+      override;
+  void OnRequestBodySinkResumed() override;
 
  protected:
   // Sends a basic 200 response using SendHeaders for the headers and WriteData
@@ -91,15 +98,48 @@ class QuicSimpleServerStream : public QuicSpdyServerStreamBase,
   // Writes the body bytes for the GENERATE_BYTES response type.
   void WriteGeneratedBytes();
 
+  // Called when the send buffer drains below its low watermark; pulls the
+  // next chunks from |body_source_| for streamed responses.
+  void OnCanWriteNewData() override;
+
   // The parsed headers received from the client.
   spdy::Http2HeaderBlock request_headers_;
   int64_t content_length_;
   std::string body_;
 
  private:
+  // Asks the backend for Early Hints for the parsed request headers and sends
+  // any returned 103 header blocks ahead of the backend fetch.
+  void MaybeSendEarlyHints();
+
+  // Pulls chunks from |body_source_| and writes them to the stream while the
+  // send buffer is below its low watermark.
+  void WriteStreamedBody();
+
+  // Hands readable body bytes to |body_sink_|, consuming only what the sink
+  // accepts; unaccepted bytes stay in the receive buffer and hold flow
+  // control. Completes the sink once the fin (and any trailers) are read.
+  void DeliverBodyToSink();
+
   uint64_t generate_bytes_length_;
   // Whether response headers have already been sent.
   bool response_sent_ = false;
+  // Whether the backend has delivered its completion for the current fetch.
+  // Used to verify that backends advertising CanFetchSynchronously complete
+  // within FetchResponseFromBackend.
+  bool backend_response_delivered_ = false;
+  // Whether Early Hints were already sent on request-header receipt.
+  bool early_hints_sent_ = false;
+
+  // Body source of a streamed response; nullptr once the final chunk has
+  // been written or when the response is not streamed.
+  std::unique_ptr<QuicSimpleServerBackend::ResponseBodySource> body_source_;
+
+  // Sink of a streamed request body; nullptr when the backend wants the
+  // body accumulated into |body_| or once the sink has been completed.
+  std::unique_ptr<QuicSimpleServerBackend::RequestBodySink> body_sink_;
+  // Body bytes handed to |body_sink_| so far, for content-length checks.
+  uint64_t body_bytes_delivered_ = 0;
 
   QuicSimpleServerBackend* quic_simple_server_backend_;  // Not owned.
 };
@@ -4,7 +4,9 @@
 
 #include "quic/tools/quic_simple_server_stream.h"
 
+#include <algorithm>
 #include <list>
+#include <limits>
 #include <memory>
 #include <utility>
 
@@ -544,6 +546,74 @@ TEST_P(QuicSimpleServerStreamTest, SendResponseWithEarlyHints) {
   EXPECT_TRUE(stream_->write_side_closed());
 }
 
+TEST_P(QuicSimpleServerStreamTest, EarlyHintsSentOnRequestHeaderReceipt) {
+  std::string body = "Yummm";
+
+  // Cache a response with Early Hints for the fixture's default request.
+  std::vector<spdy::Http2HeaderBlock> early_hints;
+  spdy::Http2HeaderBlock hints;
+  hints["link"] = "</style.css>; rel=preload; as=style";
+  early_hints.push_back(std::move(hints));
+  response_headers_[":status"] = "200";
+  response_headers_["content-length"] = "5";
+  memory_cache_backend_.AddResponseWithEarlyHints(
+      "www.google.com", "/", std::move(response_headers_), body, early_hints);
+
+  QuicBuffer header = HttpEncoder::SerializeDataFrameHeader(
+      body.length(), SimpleBufferAllocator::Get());
+
+  InSequence s;
+  // The hints go out as soon as the request headers are processed, before the
+  // request body arrives or the backend fetch completes.
+  EXPECT_CALL(*stream_, WriteEarlyHintsHeadersMock(false));
+  stream_->OnStreamHeaderList(false, kFakeFrameLen, header_list_);
+
+  // The final response does not resend the hints.
+  stream_->set_body("12345678901");
+  QuicStreamPeer::SetFinReceived(stream_);
+  EXPECT_CALL(*stream_, WriteHeadersMock(false));
+  if (UsesHttp3()) {
+    EXPECT_CALL(session_, WritevData(_, header.size(), _, NO_FIN, _, _));
+  }
+  EXPECT_CALL(session_, WritevData(_, body.length(), _, FIN, _, _));
+  stream_->DoSendResponse();
+}
+
+TEST_P(QuicSimpleServerStreamTest, SynchronousResponseAtHeaderCompletion) {
+  // Cache a response for a GET request that ends at its headers.
+  std::string body = "Yummm";
+  response_headers_[":status"] = "200";
+  response_headers_["content-length"] = "5";
+  memory_cache_backend_.AddResponse("www.google.com", "/",
+                                    std::move(response_headers_), body);
+
+  QuicHeaderList header_list;
+  header_list.OnHeaderBlockStart();
+  header_list.OnHeader(":authority", "www.google.com");
+  header_list.OnHeader(":path", "/");
+  header_list.OnHeader(":method", "GET");
+  header_list.OnHeader(":scheme", "https");
+  header_list.OnHeaderBlockEnd(128, 128);
+
+  QuicBuffer header = HttpEncoder::SerializeDataFrameHeader(
+      body.length(), SimpleBufferAllocator::Get());
+
+  InSequence s;
+  EXPECT_CALL(*stream_, WriteHeadersMock(false));
+  if (UsesHttp3()) {
+    EXPECT_CALL(session_, WritevData(_, header.size(), _, NO_FIN, _, _));
+  }
+  EXPECT_CALL(session_, WritevData(_, body.length(), _, FIN, _, _));
+
+  // The memory cache advertises CanFetchSynchronously, so the whole response
+  // is produced within the header-complete callback without waiting for
+  // OnBodyAvailable to re-deliver the fin.
+  QuicStreamPeer::SetFinReceived(stream_);
+  stream_->OnStreamHeaderList(/*fin=*/true, kFakeFrameLen, header_list);
+  EXPECT_TRUE(stream_->send_response_was_called());
+  EXPECT_TRUE(stream_->write_side_closed());
+}
+
 TEST_P(QuicSimpleServerStreamTest, PushResponseOnClientInitiatedStream) {
   // EXPECT_QUIC_BUG tests are expensive so only run one instance of them.
   if (GetParam() != AllSupportedVersions()[0]) {
@@ -784,6 +854,239 @@ TEST_P(QuicSimpleServerStreamTest, ConnectWithInvalidHeader) {
   EXPECT_TRUE(stream_->send_error_response_was_called());
 }
 
+// Serves a fixed body in chunks of at most |chunk_size| bytes, counting how
+// many chunks the stream pulls.
+class TestBodySource : public QuicSimpleServerBackend::ResponseBodySource {
+ public:
+  TestBodySource(std::string body, size_t chunk_size)
+      : body_(std::move(body)), chunk_size_(chunk_size) {}
+
+  std::string GetNextBodyChunk(size_t max_length, bool* fin) override {
+    ++num_chunks_pulled_;
+    const size_t length =
+        std::min({max_length, chunk_size_, body_.size() - offset_});
+    std::string chunk = body_.substr(offset_, length);
+    offset_ += length;
+    *fin = offset_ == body_.size();
+    return chunk;
+  }
+
+  size_t num_chunks_pulled() const { return num_chunks_pulled_; }
+
+ private:
+  const std::string body_;
+  const size_t chunk_size_;
+  size_t offset_ = 0;
+  size_t num_chunks_pulled_ = 0;
+};
+
+TEST_P(QuicSimpleServerStreamTest, StreamedResponse) {
+  EXPECT_CALL(session_, WritevData(_, _, _, _, _, _))
+      .WillRepeatedly(
+          Invoke(&session_, &MockQuicSimpleServerSession::ConsumeData));
+
+  spdy::Http2HeaderBlock response_headers;
+  response_headers[":status"] = "200";
+  auto body_source = std::make_unique<TestBodySource>(body_, body_.size());
+  TestBodySource* body_source_ptr = body_source.get();
+
+  EXPECT_CALL(*stream_, WriteHeadersMock(/*fin=*/false));
+  stream_->OnStreamingResponseBackendComplete(std::move(response_headers),
+                                              std::move(body_source));
+  // The whole body fits in one chunk and the fin goes out with it.
+  EXPECT_EQ(1u, body_source_ptr->num_chunks_pulled());
+  EXPECT_TRUE(stream_->fin_sent());
+}
+
+TEST_P(QuicSimpleServerStreamTest, StreamedResponseWithoutBody) {
+  spdy::Http2HeaderBlock response_headers;
+  response_headers[":status"] = "204";
+
+  // A null body source sends the headers with a fin and nothing else.
+  EXPECT_CALL(*stream_, WriteHeadersMock(/*fin=*/true));
+  stream_->OnStreamingResponseBackendComplete(std::move(response_headers),
+                                              nullptr);
+}
+
+TEST_P(QuicSimpleServerStreamTest, StreamedResponseBackpressure) {
+  // 20 KB body served in 5 KB chunks against the default 8 KB low watermark.
+  const size_t kChunkSize = 5 * 1024;
+  std::string body(4 * kChunkSize, 'a');
+  auto body_source = std::make_unique<TestBodySource>(body, kChunkSize);
+  TestBodySource* body_source_ptr = body_source.get();
+
+  // Block all writes so pulled chunks pile up in the send buffer.
+  EXPECT_CALL(session_, WritevData(_, _, _, _, _, _))
+      .WillRepeatedly(testing::Return(QuicConsumedData(0, false)));
+
+  spdy::Http2HeaderBlock response_headers;
+  response_headers[":status"] = "200";
+  EXPECT_CALL(*stream_, WriteHeadersMock(/*fin=*/false));
+  stream_->OnStreamingResponseBackendComplete(std::move(response_headers),
+                                              std::move(body_source));
+  // The second chunk pushes buffered data past the watermark, so the stream
+  // stops pulling instead of buffering the remaining body.
+  EXPECT_EQ(2u, body_source_ptr->num_chunks_pulled());
+  EXPECT_FALSE(stream_->fin_sent());
+
+  // Once the transport drains the send buffer, the stream pulls the rest of
+  // the body and sends the fin.
+  EXPECT_CALL(session_, WritevData(_, _, _, _, _, _))
+      .WillRepeatedly(
+          Invoke(&session_, &MockQuicSimpleServerSession::ConsumeData));
+  stream_->OnCanWrite();
+  EXPECT_EQ(4u, body_source_ptr->num_chunks_pulled());
+  EXPECT_TRUE(stream_->fin_sent());
+}
+
+// Accepts at most |*max_bytes_per_call| bytes per OnBodyData() call and
+// records what it received into test-owned storage, as the sink itself is
+// destroyed once the stream completes it.
+class TestBodySink : public QuicSimpleServerBackend::RequestBodySink {
+ public:
+  TestBodySink(const size_t* max_bytes_per_call, std::string* body,
+               bool* body_complete, spdy::Http2HeaderBlock* trailers)
+      : max_bytes_per_call_(max_bytes_per_call),
+        body_(body),
+        body_complete_(body_complete),
+        trailers_(trailers) {}
+
+  size_t OnBodyData(absl::string_view data) override {
+    const size_t accepted = std::min(*max_bytes_per_call_, data.size());
+    body_->append(data.data(), accepted);
+    return accepted;
+  }
+
+  void OnBodyComplete(spdy::Http2HeaderBlock trailers) override {
+    *body_complete_ = true;
+    *trailers_ = std::move(trailers);
+  }
+
+ private:
+  const size_t* max_bytes_per_call_;
+  std::string* body_;
+  bool* body_complete_;
+  spdy::Http2HeaderBlock* trailers_;
+};
+
+// Hands out a TestBodySink for every request with an outstanding body.
+class StreamingUploadBackend : public QuicMemoryCacheBackend {
+ public:
+  std::unique_ptr<QuicSimpleServerBackend::RequestBodySink>
+  MaybeCreateRequestBodySink(const spdy::Http2HeaderBlock& /*request_headers*/,
+                             RequestHandler* request_handler) override {
+    request_handler_ = request_handler;
+    return std::make_unique<TestBodySink>(&max_bytes_per_call_, &body_,
+                                          &body_complete_, &trailers_);
+  }
+
+  size_t max_bytes_per_call_ = std::numeric_limits<size_t>::max();
+  RequestHandler* request_handler_ = nullptr;
+  std::string body_;
+  bool body_complete_ = false;
+  spdy::Http2HeaderBlock trailers_;
+};
+
+class QuicSimpleServerStreamSinkTest : public QuicSimpleServerStreamTest {
+ public:
+  QuicSimpleServerStreamSinkTest() {
+    upload_stream_ = new StrictMock<TestStream>(
+        GetNthClientInitiatedBidirectionalStreamId(
+            connection_->transport_version(), 1),
+        &session_, BIDIRECTIONAL, &upload_backend_);
+    session_.ActivateStream(absl::WrapUnique(upload_stream_));
+  }
+
+  // Returns |payload| framed the way it would arrive on the request stream.
+  std::string BuildDataFrame(absl::string_view payload) {
+    if (!UsesHttp3()) {
+      return std::string(payload);
+    }
+    QuicBuffer header = HttpEncoder::SerializeDataFrameHeader(
+        payload.length(), SimpleBufferAllocator::Get());
+    return absl::StrCat(header.AsStringView(), payload);
+  }
+
+  StreamingUploadBackend upload_backend_;
+  StrictMock<TestStream>* upload_stream_;  // Owned by session_.
+};
+
+INSTANTIATE_TEST_SUITE_P(Tests, QuicSimpleServerStreamSinkTest,
+                         ::testing::ValuesIn(AllSupportedVersions()),
+                         ::testing::PrintToStringParamName());
+
+TEST_P(QuicSimpleServerStreamSinkTest, BodyDeliveredIncrementally) {
+  upload_stream_->OnStreamHeaderList(/*fin=*/false, kFakeFrameLen,
+                                     header_list_);
+
+  // The first chunk reaches the sink as soon as it is consumed, before the
+  // request has ended.
+  std::string first = BuildDataFrame("hello ");
+  upload_stream_->OnStreamFrame(QuicStreamFrame(upload_stream_->id(),
+                                                /*fin=*/false, /*offset=*/0,
+                                                first));
+  EXPECT_EQ("hello ", upload_backend_.body_);
+  EXPECT_FALSE(upload_backend_.body_complete_);
+  EXPECT_TRUE(upload_stream_->body().empty());
+
+  upload_stream_->OnStreamFrame(QuicStreamFrame(upload_stream_->id(),
+                                                /*fin=*/true, first.size(),
+                                                BuildDataFrame("world")));
+  EXPECT_EQ("hello world", upload_backend_.body_);
+  EXPECT_TRUE(upload_backend_.body_complete_);
+  EXPECT_TRUE(upload_backend_.trailers_.empty());
+  // The sink produces the response; SendResponse() is not involved.
+  EXPECT_FALSE(upload_stream_->send_response_was_called());
+}
+
+TEST_P(QuicSimpleServerStreamSinkTest, BackpressuresWhenSinkIsFull) {
+  upload_backend_.max_bytes_per_call_ = 5;
+  upload_stream_->OnStreamHeaderList(/*fin=*/false, kFakeFrameLen,
+                                     header_list_);
+
+  // The sink only takes 5 of the 11 bytes; the rest stays in the receive
+  // buffer and the fin is not processed.
+  upload_stream_->OnStreamFrame(QuicStreamFrame(upload_stream_->id(),
+                                                /*fin=*/true, /*offset=*/0,
+                                                BuildDataFrame("hello world")));
+  EXPECT_EQ("hello", upload_backend_.body_);
+  EXPECT_FALSE(upload_backend_.body_complete_);
+
+  // Once the sink frees up, delivery resumes and runs to completion.
+  upload_backend_.max_bytes_per_call_ = std::numeric_limits<size_t>::max();
+  upload_backend_.request_handler_->OnRequestBodySinkResumed();
+  EXPECT_EQ("hello world", upload_backend_.body_);
+  EXPECT_TRUE(upload_backend_.body_complete_);
+}
+
+TEST_P(QuicSimpleServerStreamSinkTest, TrailersDeliveredToSink) {
+  if (!UsesHttp3()) {
+    // Trailers arrive interleaved on the headers stream in gQUIC; this test
+    // drives them through the request stream.
+    return;
+  }
+  upload_stream_->OnStreamHeaderList(/*fin=*/false, kFakeFrameLen,
+                                     header_list_);
+  std::string data = BuildDataFrame("hello world");
+  upload_stream_->OnStreamFrame(QuicStreamFrame(upload_stream_->id(),
+                                                /*fin=*/false, /*offset=*/0,
+                                                data));
+  EXPECT_EQ("hello world", upload_backend_.body_);
+  EXPECT_FALSE(upload_backend_.body_complete_);
+
+  QuicHeaderList trailers;
+  trailers.OnHeaderBlockStart();
+  trailers.OnHeader("custom-trailer", "value");
+  trailers.OnHeaderBlockEnd(128, 128);
+  upload_stream_->OnStreamHeaderList(/*fin=*/true, kFakeFrameLen, trailers);
+
+  upload_stream_->OnStreamFrame(QuicStreamFrame(upload_stream_->id(),
+                                                /*fin=*/true, data.size(),
+                                                absl::string_view()));
+  EXPECT_TRUE(upload_backend_.body_complete_);
+  EXPECT_EQ("value", upload_backend_.trailers_["custom-trailer"].as_string());
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace quic
@@ -0,0 +1,114 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/tools/quic_source_rate_limiter.h"
+
+#include <algorithm>
+#include <string>
+
+#include "absl/hash/hash.h"
+#include "quic/platform/api/quic_logging.h"
+
+namespace quic {
+
+namespace {
+
+// Length of one overload accounting epoch.
+const QuicTime::Delta kOverloadEpoch = QuicTime::Delta::FromSeconds(1);
+
+// Weight of the most recent epoch in the busy fraction estimate.
+const double kBusyFractionGain = 0.5;
+
+}  // namespace
+
+QuicSourceRateLimiter::QuicSourceRateLimiter(const QuicClock* clock)
+    : QuicSourceRateLimiter(clock, Config()) {}
+
+QuicSourceRateLimiter::QuicSourceRateLimiter(const QuicClock* clock,
+                                             const Config& config)
+    : clock_(clock), config_(config), buckets_(kNumBuckets) {}
+
+bool QuicSourceRateLimiter::OnNewConnectionAttempt(
+    const QuicSocketAddress& source) {
+  Bucket& bucket = BucketForSource(source);
+  Refill(&bucket, clock_->ApproximateNow());
+
+  const double cost =
+      overloaded_ ? config_.overload_admission_cost : 1.0;
+  if (bucket.connection_tokens < cost || bucket.processing_time_debt_us > 0) {
+    ++num_rejected_connections_;
+    return false;
+  }
+  bucket.connection_tokens -= cost;
+  return true;
+}
+
+void QuicSourceRateLimiter::OnPacketProcessed(const QuicSocketAddress& source,
+                                              QuicTime::Delta elapsed) {
+  const QuicTime now = clock_->ApproximateNow();
+  Bucket& bucket = BucketForSource(source);
+  Refill(&bucket, now);
+  bucket.processing_time_debt_us += elapsed.ToMicroseconds();
+  UpdateOverload(now, elapsed);
+}
+
+QuicSourceRateLimiter::Bucket& QuicSourceRateLimiter::BucketForSource(
+    const QuicSocketAddress& source) {
+  // Key on the IP alone: an abusive client can vary its source port freely.
+  const size_t hash =
+      absl::Hash<std::string>()(source.host().ToPackedString());
+  return buckets_[hash & (kNumBuckets - 1)];
+}
+
+void QuicSourceRateLimiter::Refill(Bucket* bucket, QuicTime now) {
+  if (bucket->last_refill == QuicTime::Zero()) {
+    // First contact with this bucket: grant the full budget.
+    bucket->connection_tokens = config_.max_connection_burst;
+    bucket->processing_time_debt_us = 0.0;
+    bucket->last_refill = now;
+    return;
+  }
+  const double elapsed_seconds =
+      (now - bucket->last_refill).ToMicroseconds() * 1e-6;
+  if (elapsed_seconds <= 0) {
+    return;
+  }
+  bucket->connection_tokens =
+      std::min(config_.max_connection_burst,
+               bucket->connection_tokens +
+                   elapsed_seconds * config_.connections_per_second);
+  bucket->processing_time_debt_us = std::max(
+      0.0, bucket->processing_time_debt_us -
+               elapsed_seconds *
+                   config_.processing_time_per_second.ToMicroseconds());
+  bucket->last_refill = now;
+}
+
+void QuicSourceRateLimiter::UpdateOverload(QuicTime now,
+                                           QuicTime::Delta elapsed) {
+  if (epoch_start_ == QuicTime::Zero()) {
+    epoch_start_ = now;
+  }
+  busy_time_this_epoch_ = busy_time_this_epoch_ + elapsed;
+  const QuicTime::Delta epoch_length = now - epoch_start_;
+  if (epoch_length < kOverloadEpoch) {
+    return;
+  }
+  const double busy_fraction =
+      std::min(1.0, static_cast<double>(busy_time_this_epoch_.ToMicroseconds()) /
+                        epoch_length.ToMicroseconds());
+  busy_fraction_ewma_ = (1 - kBusyFractionGain) * busy_fraction_ewma_ +
+                        kBusyFractionGain * busy_fraction;
+  const bool was_overloaded = overloaded_;
+  overloaded_ = busy_fraction_ewma_ > config_.overload_threshold;
+  if (overloaded_ != was_overloaded) {
+    QUIC_DLOG(INFO) << (overloaded_ ? "Entering" : "Leaving")
+                    << " overload: busy fraction "
+                    << busy_fraction_ewma_;
+  }
+  epoch_start_ = now;
+  busy_time_this_epoch_ = QuicTime::Delta::Zero();
+}
+
+}  // namespace quic
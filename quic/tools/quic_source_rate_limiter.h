@@ -0,0 +1,113 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_TOOLS_QUIC_SOURCE_RATE_LIMITER_H_
+#define QUICHE_QUIC_TOOLS_QUIC_SOURCE_RATE_LIMITER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "quic/core/quic_clock.h"
+#include "quic/core/quic_time.h"
+#include "quic/platform/api/quic_socket_address.h"
+
+namespace quic {
+
+// Cost accounting for packet sources hitting a server dispatcher.  Each
+// source address maps, by hash of its IP, to a token bucket that is charged
+// for new connection attempts and for the packet-processing time the source
+// consumes.  The bucket table has a fixed size, so memory use and lookup
+// cost stay constant no matter how many distinct sources probe the server;
+// unrelated sources that collide share a bucket, which only makes admission
+// more conservative.  An overload signal derived from the fraction of wall
+// time spent processing packets raises the cost of admission before the
+// event loop saturates, shedding new connections while established,
+// well-behaved ones keep their budget.
+class QuicSourceRateLimiter {
+ public:
+  struct Config {
+    // Sustained rate of new connection (and handshake) attempts admitted
+    // from one source, and the burst allowed on top of it.
+    double connections_per_second = 50.0;
+    double max_connection_burst = 100.0;
+
+    // Packet-processing time one source may consume per second of wall
+    // time.  A source that exceeds its budget has new connection attempts
+    // rejected until the budget refills; its established connections are
+    // left alone.
+    QuicTime::Delta processing_time_per_second =
+        QuicTime::Delta::FromMilliseconds(50);
+
+    // Fraction of wall time spent processing packets above which the
+    // dispatcher is considered overloaded.
+    double overload_threshold = 0.75;
+
+    // Multiplier applied to the token cost of admitting a new connection
+    // while overloaded.
+    double overload_admission_cost = 4.0;
+  };
+
+  explicit QuicSourceRateLimiter(const QuicClock* clock);
+  QuicSourceRateLimiter(const QuicClock* clock, const Config& config);
+  QuicSourceRateLimiter(const QuicSourceRateLimiter&) = delete;
+  QuicSourceRateLimiter& operator=(const QuicSourceRateLimiter&) = delete;
+
+  // Returns true if a new connection attempt from |source| should be
+  // admitted, charging its bucket.  Returns false, at O(1) cost, if the
+  // source is out of connection tokens or has outstanding processing-time
+  // debt.
+  bool OnNewConnectionAttempt(const QuicSocketAddress& source);
+
+  // Charges |elapsed| of packet-processing time to |source| and to the
+  // overload accounting.
+  void OnPacketProcessed(const QuicSocketAddress& source,
+                         QuicTime::Delta elapsed);
+
+  // Whether the recent busy fraction exceeds the overload threshold.
+  bool overloaded() const { return overloaded_; }
+
+  // Number of connection attempts rejected so far.
+  uint64_t num_rejected_connections() const {
+    return num_rejected_connections_;
+  }
+
+ private:
+  // Per-source accounting.  |last_refill| of QuicTime::Zero() marks a
+  // bucket that has never been touched and therefore holds a full budget.
+  struct Bucket {
+    double connection_tokens = 0.0;
+    double processing_time_debt_us = 0.0;
+    QuicTime last_refill = QuicTime::Zero();
+  };
+
+  // Power of two, so the bucket index is a mask of the address hash.
+  static const size_t kNumBuckets = 1024;
+
+  Bucket& BucketForSource(const QuicSocketAddress& source);
+
+  // Grants |bucket| the tokens accrued since its last refill.
+  void Refill(Bucket* bucket, QuicTime now);
+
+  // Folds |elapsed| busy time into the epoch-based overload estimate.
+  void UpdateOverload(QuicTime now, QuicTime::Delta elapsed);
+
+  const QuicClock* clock_;  // Unowned.
+  const Config config_;
+
+  std::vector<Bucket> buckets_;
+
+  // Overload accounting: busy time is accumulated per epoch and folded
+  // into an exponentially weighted busy fraction when the epoch ends.
+  QuicTime epoch_start_ = QuicTime::Zero();
+  QuicTime::Delta busy_time_this_epoch_ = QuicTime::Delta::Zero();
+  double busy_fraction_ewma_ = 0.0;
+  bool overloaded_ = false;
+
+  uint64_t num_rejected_connections_ = 0;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_TOOLS_QUIC_SOURCE_RATE_LIMITER_H_
@@ -0,0 +1,95 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/tools/quic_source_rate_limiter.h"
+
+#include "quic/platform/api/quic_test.h"
+#include "quic/test_tools/mock_clock.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+class QuicSourceRateLimiterTest : public QuicTest {
+ protected:
+  QuicSourceRateLimiterTest()
+      : source_(QuicIpAddress::Loopback4(), 443) {
+    // Move off QuicTime::Zero(), which marks untouched buckets.
+    clock_.AdvanceTime(QuicTime::Delta::FromSeconds(1));
+  }
+
+  MockClock clock_;
+  QuicSocketAddress source_;
+};
+
+TEST_F(QuicSourceRateLimiterTest, AdmitsBurstThenRefills) {
+  QuicSourceRateLimiter::Config config;
+  config.connections_per_second = 50.0;
+  config.max_connection_burst = 100.0;
+  QuicSourceRateLimiter limiter(&clock_, config);
+
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_TRUE(limiter.OnNewConnectionAttempt(source_)) << i;
+  }
+  EXPECT_FALSE(limiter.OnNewConnectionAttempt(source_));
+  EXPECT_EQ(1u, limiter.num_rejected_connections());
+
+  // One second of refill grants another |connections_per_second| tokens.
+  clock_.AdvanceTime(QuicTime::Delta::FromSeconds(1));
+  for (int i = 0; i < 50; ++i) {
+    EXPECT_TRUE(limiter.OnNewConnectionAttempt(source_)) << i;
+  }
+  EXPECT_FALSE(limiter.OnNewConnectionAttempt(source_));
+  EXPECT_EQ(2u, limiter.num_rejected_connections());
+}
+
+TEST_F(QuicSourceRateLimiterTest, ProcessingTimeDebtBlocksAdmission) {
+  QuicSourceRateLimiter::Config config;
+  config.processing_time_per_second = QuicTime::Delta::FromMilliseconds(50);
+  QuicSourceRateLimiter limiter(&clock_, config);
+
+  // The source burns far more processing time than its budget allows.
+  limiter.OnPacketProcessed(source_, QuicTime::Delta::FromMilliseconds(200));
+  EXPECT_FALSE(limiter.OnNewConnectionAttempt(source_));
+
+  // After the debt has drained at 50ms per second, admission resumes.
+  clock_.AdvanceTime(QuicTime::Delta::FromSeconds(5));
+  EXPECT_TRUE(limiter.OnNewConnectionAttempt(source_));
+}
+
+TEST_F(QuicSourceRateLimiterTest, OverloadRaisesAdmissionCost) {
+  QuicSourceRateLimiter::Config config;
+  config.max_connection_burst = 2.0;
+  config.overload_admission_cost = 4.0;
+  config.overload_threshold = 0.5;
+  // Make per-source processing budget a non-issue for this test.
+  config.processing_time_per_second = QuicTime::Delta::FromSeconds(1);
+  QuicSourceRateLimiter limiter(&clock_, config);
+
+  EXPECT_FALSE(limiter.overloaded());
+  EXPECT_TRUE(limiter.OnNewConnectionAttempt(source_));
+
+  // Keep the event loop busy for most of several one-second epochs.
+  for (int i = 0; i < 4; ++i) {
+    limiter.OnPacketProcessed(source_,
+                              QuicTime::Delta::FromMilliseconds(900));
+    clock_.AdvanceTime(QuicTime::Delta::FromMilliseconds(1100));
+    limiter.OnPacketProcessed(source_,
+                              QuicTime::Delta::FromMilliseconds(900));
+  }
+  EXPECT_TRUE(limiter.overloaded());
+
+  // Let the source's processing debt drain so that only the raised
+  // admission cost is in play.
+  clock_.AdvanceTime(QuicTime::Delta::FromSeconds(1));
+
+  // With admission four times as expensive, the bucket's two tokens are no
+  // longer enough.
+  EXPECT_FALSE(limiter.OnNewConnectionAttempt(source_));
+  EXPECT_EQ(1u, limiter.num_rejected_connections());
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
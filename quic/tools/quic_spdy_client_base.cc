@@ -77,6 +77,7 @@ void QuicSpdyClientBase::InitializeSession() {
 
 void QuicSpdyClientBase::OnClose(QuicSpdyStream* stream) {
   QUICHE_DCHECK(stream != nullptr);
+  MaybeRetireEarlyRequests();
   QuicSpdyClientStream* client_stream =
       static_cast<QuicSpdyClientStream*>(stream);
 
@@ -151,6 +152,62 @@ void QuicSpdyClientBase::SendRequestInternal(Http2HeaderBlock sanitized_headers,
   stream->SendRequest(std::move(sanitized_headers), body, fin);
 }
 
+void QuicSpdyClientBase::SendEarlyRequest(const Http2HeaderBlock& headers,
+                                          absl::string_view body,
+                                          bool fin,
+                                          bool idempotent) {
+  MaybeRetireEarlyRequests();
+  if (connected() && client_session()->OneRttKeysAvailable()) {
+    // The handshake has already been confirmed; there is no 0-RTT rejection
+    // left to protect against.
+    SendRequest(headers, body, fin);
+    return;
+  }
+  EarlyRequest request;
+  request.headers = headers.Clone();
+  request.body = std::string(body);
+  request.fin = fin;
+  request.idempotent = idempotent;
+  early_requests_.push_back(std::move(request));
+  ++early_request_stats_.num_early_requests_sent;
+  SendRequest(headers, body, fin);
+}
+
+void QuicSpdyClientBase::ReplayEarlyRequests() {
+  if (early_requests_.empty()) {
+    return;
+  }
+  // Requests stay buffered while they are replayed, since the new
+  // connection's 0-RTT data may be rejected as well.
+  std::vector<EarlyRequest> requests;
+  requests.swap(early_requests_);
+  for (EarlyRequest& request : requests) {
+    if (!request.idempotent && request.num_replays > 0) {
+      // By the second failure, copies of this request have been sent on
+      // several connections, and whether the server processed one of them
+      // can no longer be reasoned about. Only idempotent requests keep being
+      // replayed.
+      ++early_request_stats_.num_early_requests_dropped;
+      continue;
+    }
+    ++request.num_replays;
+    ++early_request_stats_.num_early_requests_replayed;
+    SendRequest(request.headers, request.body, request.fin);
+    early_requests_.push_back(std::move(request));
+  }
+}
+
+void QuicSpdyClientBase::MaybeRetireEarlyRequests() {
+  if (early_requests_.empty() || !connected() ||
+      !client_session()->OneRttKeysAvailable()) {
+    return;
+  }
+  // Once the handshake is confirmed, the buffered requests were either
+  // accepted as 0-RTT data or retransmitted by the session itself, so they no
+  // longer need replay protection.
+  early_requests_.clear();
+}
+
 void QuicSpdyClientBase::SendRequestAndWaitForResponse(
     const Http2HeaderBlock& headers,
     absl::string_view body,
@@ -219,6 +276,9 @@ void QuicSpdyClientBase::MaybeAddQuicDataToResend(
 
 void QuicSpdyClientBase::ClearDataToResend() {
   data_to_resend_on_connect_.clear();
+  MaybeRetireEarlyRequests();
+  early_request_stats_.num_early_requests_dropped += early_requests_.size();
+  early_requests_.clear();
 }
 
 void QuicSpdyClientBase::ResendSavedData() {
@@ -229,6 +289,7 @@ void QuicSpdyClientBase::ResendSavedData() {
   for (const auto& data : old_data) {
     data->Resend();
   }
+  ReplayEarlyRequests();
 }
 
 void QuicSpdyClientBase::AddPromiseDataToResend(const Http2HeaderBlock& headers,
@@ -84,11 +84,40 @@ class QuicSpdyClientBase : public QuicClientBase,
   // initialization.
   void InitializeSession() override;
 
+  // Statistics about requests sent through SendEarlyRequest().
+  struct EarlyRequestStats {
+    // Number of requests handed to SendEarlyRequest() before the handshake
+    // was confirmed.
+    size_t num_early_requests_sent = 0;
+    // Number of buffered requests replayed on a new connection after a 0-RTT
+    // rejection or a version renegotiation.
+    size_t num_early_requests_replayed = 0;
+    // Number of buffered requests dropped instead of replayed.
+    size_t num_early_requests_dropped = 0;
+  };
+
   // Sends an HTTP request and does not wait for response before returning.
   void SendRequest(const spdy::Http2HeaderBlock& headers,
                    absl::string_view body,
                    bool fin);
 
+  // Sends an HTTP request like SendRequest(), but also buffers a copy of the
+  // request until the handshake is confirmed so that it can be replayed on a
+  // new connection if the server rejects the 0-RTT data or forces a version
+  // renegotiation. In both cases the original request is known to have been
+  // discarded unprocessed, so the replay cannot duplicate work on the server.
+  // |idempotent| requests are replayed every time the connection is restarted;
+  // non-idempotent requests are replayed at most once, after which another
+  // failure drops them rather than risk duplicated side effects.
+  void SendEarlyRequest(const spdy::Http2HeaderBlock& headers,
+                        absl::string_view body,
+                        bool fin,
+                        bool idempotent);
+
+  const EarlyRequestStats& early_request_stats() const {
+    return early_request_stats_;
+  }
+
   // Sends an HTTP request and waits for response before returning.
   void SendRequestAndWaitForResponse(const spdy::Http2HeaderBlock& headers,
                                      absl::string_view body,
@@ -199,10 +228,31 @@ class QuicSpdyClientBase : public QuicClientBase,
     QuicSpdyClientBase* client_;
   };
 
+  // A request buffered by SendEarlyRequest() until the handshake is
+  // confirmed. Owns copies of the headers and body so that it outlives the
+  // connection the request was originally sent on.
+  struct EarlyRequest {
+    spdy::Http2HeaderBlock headers;
+    std::string body;
+    bool fin;
+    bool idempotent;
+    // Number of times this request has been replayed on a new connection.
+    int num_replays = 0;
+  };
+
   void SendRequestInternal(spdy::Http2HeaderBlock sanitized_headers,
                            absl::string_view body,
                            bool fin);
 
+  // Replays buffered early requests on the connection created after a 0-RTT
+  // rejection or a version renegotiation. Called from ResendSavedData().
+  void ReplayEarlyRequests();
+
+  // Drops the buffered copies once the handshake is confirmed: from that
+  // point on any buffered request was either accepted as 0-RTT data or
+  // retransmitted by the session itself.
+  void MaybeRetireEarlyRequests();
+
   // Index of pending promised streams. Must outlive |session_|.
   QuicClientPushPromiseIndex push_promise_index_;
 
@@ -230,6 +280,12 @@ class QuicSpdyClientBase : public QuicClientBase,
 
   std::unique_ptr<ClientQuicDataToResend> push_promise_data_to_resend_;
 
+  // Requests sent before the handshake was confirmed, kept until the
+  // handshake confirms in case the 0-RTT data carrying them is rejected.
+  std::vector<EarlyRequest> early_requests_;
+
+  EarlyRequestStats early_request_stats_;
+
   bool drop_response_body_ = false;
   bool enable_web_transport_ = false;
   bool use_datagram_contexts_ = false;
@@ -0,0 +1,156 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/tools/shared_ticket_crypter.h"
+
+#include <atomic>
+#include <memory>
+#include <utility>
+
+#include "third_party/boringssl/src/include/openssl/aead.h"
+#include "third_party/boringssl/src/include/openssl/rand.h"
+
+namespace quic {
+
+namespace {
+
+constexpr QuicTime::Delta kTicketKeyLifetime =
+    QuicTime::Delta::FromSeconds(60 * 60 * 24 * 7);
+
+// The format of an encrypted ticket is 1 byte for the key epoch, followed by
+// 16 bytes of IV, followed by the output from the AES-GCM Seal operation. The
+// seal operation has an overhead of 16 bytes for its auth tag.
+constexpr size_t kEpochSize = 1;
+constexpr size_t kIVSize = 16;
+constexpr size_t kAuthTagSize = 16;
+
+// Offsets into the ciphertext to make message parsing easier.
+constexpr size_t kIVOffset = kEpochSize;
+constexpr size_t kMessageOffset = kIVOffset + kIVSize;
+
+}  // namespace
+
+SharedTicketKeyManager::SharedTicketKeyManager(QuicClock* clock)
+    : clock_(clock) {
+  uint8_t epoch;
+  RAND_bytes(&epoch, 1);
+  std::atomic_store(&key_set_, NewKeySet(epoch, nullptr));
+}
+
+SharedTicketKeyManager::~SharedTicketKeyManager() = default;
+
+size_t SharedTicketKeyManager::MaxOverhead() const {
+  return kEpochSize + kIVSize + kAuthTagSize;
+}
+
+std::vector<uint8_t> SharedTicketKeyManager::Encrypt(absl::string_view in) {
+  std::shared_ptr<const KeySet> keys = GetKeys();
+  std::vector<uint8_t> out(in.size() + MaxOverhead());
+  out[0] = keys->epoch;
+  RAND_bytes(out.data() + kIVOffset, kIVSize);
+  size_t out_len;
+  if (!EVP_AEAD_CTX_seal(keys->current->aead_ctx.get(),
+                         out.data() + kMessageOffset, &out_len,
+                         out.size() - kMessageOffset, out.data() + kIVOffset,
+                         kIVSize, reinterpret_cast<const uint8_t*>(in.data()),
+                         in.size(), nullptr, 0)) {
+    return std::vector<uint8_t>();
+  }
+  out.resize(out_len + kMessageOffset);
+  return out;
+}
+
+std::vector<uint8_t> SharedTicketKeyManager::Decrypt(absl::string_view in) {
+  std::shared_ptr<const KeySet> keys = GetKeys();
+  if (in.size() < kMessageOffset) {
+    return std::vector<uint8_t>();
+  }
+  const uint8_t* input = reinterpret_cast<const uint8_t*>(in.data());
+  std::vector<uint8_t> out(in.size() - kMessageOffset);
+  size_t out_len;
+  const EVP_AEAD_CTX* ctx = keys->current->aead_ctx.get();
+  if (input[0] != keys->epoch) {
+    if (input[0] == static_cast<uint8_t>(keys->epoch - 1) && keys->previous) {
+      ctx = keys->previous->aead_ctx.get();
+    } else {
+      return std::vector<uint8_t>();
+    }
+  }
+  if (!EVP_AEAD_CTX_open(ctx, out.data(), &out_len, out.size(),
+                         input + kIVOffset, kIVSize, input + kMessageOffset,
+                         in.size() - kMessageOffset, nullptr, 0)) {
+    return std::vector<uint8_t>();
+  }
+  out.resize(out_len);
+  return out;
+}
+
+std::shared_ptr<const SharedTicketKeyManager::Key>
+SharedTicketKeyManager::NewKey() {
+  auto key = std::make_shared<Key>();
+  RAND_bytes(key->key, kKeySize);
+  EVP_AEAD_CTX_init(key->aead_ctx.get(), EVP_aead_aes_128_gcm(), key->key,
+                    kKeySize, EVP_AEAD_DEFAULT_TAG_LENGTH, nullptr);
+  return key;
+}
+
+std::shared_ptr<const SharedTicketKeyManager::KeySet>
+SharedTicketKeyManager::NewKeySet(uint8_t epoch,
+                                  std::shared_ptr<const Key> previous) {
+  auto key_set = std::make_shared<KeySet>();
+  key_set->epoch = epoch;
+  key_set->current = NewKey();
+  key_set->previous = std::move(previous);
+  key_set->expiration = clock_->ApproximateNow() + kTicketKeyLifetime;
+  return key_set;
+}
+
+std::shared_ptr<const SharedTicketKeyManager::KeySet>
+SharedTicketKeyManager::GetKeys() {
+  std::shared_ptr<const KeySet> keys = std::atomic_load(&key_set_);
+  if (keys->expiration < clock_->ApproximateNow()) {
+    return RotateKeys(std::move(keys));
+  }
+  return keys;
+}
+
+std::shared_ptr<const SharedTicketKeyManager::KeySet>
+SharedTicketKeyManager::RotateKeys(std::shared_ptr<const KeySet> expired) {
+  QuicWriterMutexLock lock(&rotation_mutex_);
+  std::shared_ptr<const KeySet> keys = std::atomic_load(&key_set_);
+  if (keys != expired) {
+    // Another thread rotated while we waited for the lock.
+    return keys;
+  }
+  std::shared_ptr<const KeySet> next =
+      NewKeySet(expired->epoch + 1, expired->current);
+  std::atomic_store(&key_set_, next);
+  return next;
+}
+
+SharedTicketCrypter::SharedTicketCrypter(
+    std::shared_ptr<SharedTicketKeyManager> key_manager)
+    : key_manager_(std::move(key_manager)) {}
+
+SharedTicketCrypter::~SharedTicketCrypter() = default;
+
+size_t SharedTicketCrypter::MaxOverhead() {
+  return key_manager_->MaxOverhead();
+}
+
+std::vector<uint8_t> SharedTicketCrypter::Encrypt(
+    absl::string_view in, absl::string_view encryption_key) {
+  // Like SimpleTicketCrypter, this implementation only uses the
+  // internally-cached keys, never a caller-provided |encryption_key|.
+  QUICHE_DCHECK(encryption_key.empty());
+  return key_manager_->Encrypt(in);
+}
+
+void SharedTicketCrypter::Decrypt(
+    absl::string_view in,
+    std::unique_ptr<quic::ProofSource::DecryptCallback> callback) {
+  callback->Run(key_manager_->Decrypt(in));
+}
+
+}  // namespace quic
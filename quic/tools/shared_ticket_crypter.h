@@ -0,0 +1,99 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_TOOLS_SHARED_TICKET_CRYPTER_H_
+#define QUICHE_QUIC_TOOLS_SHARED_TICKET_CRYPTER_H_
+
+#include <memory>
+
+#include "third_party/boringssl/src/include/openssl/aead.h"
+#include "quic/core/crypto/proof_source.h"
+#include "quic/core/quic_clock.h"
+#include "quic/core/quic_time.h"
+#include "quic/platform/api/quic_mutex.h"
+
+namespace quic {
+
+// SharedTicketKeyManager holds the session ticket keys for an entire server
+// process. Each key is stored with its AEAD context already initialized, so
+// the AES key schedule is computed once per rotation instead of once per
+// resumption. Keys are published as an immutable snapshot behind an
+// atomically-swapped shared_ptr: the seal/open hot path only performs an
+// atomic load, and the rotation lock is taken at most once per key lifetime.
+//
+// The ticket format matches SimpleTicketCrypter: 1 byte of key epoch, 16
+// bytes of IV, then the AES-128-GCM seal output. Like SimpleTicketCrypter,
+// keys are generated randomly at startup and rotated every 7 days, with the
+// previous key retained to decrypt older tickets, so this is not suitable for
+// deployments where multiple server processes need to share keys.
+class QUIC_NO_EXPORT SharedTicketKeyManager {
+ public:
+  explicit SharedTicketKeyManager(QuicClock* clock);
+  ~SharedTicketKeyManager();
+
+  size_t MaxOverhead() const;
+  std::vector<uint8_t> Encrypt(absl::string_view in);
+  std::vector<uint8_t> Decrypt(absl::string_view in);
+
+ private:
+  static constexpr size_t kKeySize = 16;
+
+  struct Key {
+    uint8_t key[kKeySize];
+    // The precomputed key schedule for |key|.
+    bssl::ScopedEVP_AEAD_CTX aead_ctx;
+  };
+
+  // An immutable snapshot of the key material. Once published via
+  // std::atomic_store, a KeySet is never modified; rotation builds a new
+  // KeySet which shares the outgoing current key as |previous|.
+  struct KeySet {
+    uint8_t epoch = 0;
+    std::shared_ptr<const Key> current;
+    // Null for the first epoch.
+    std::shared_ptr<const Key> previous;
+    QuicTime expiration = QuicTime::Zero();
+  };
+
+  std::shared_ptr<const Key> NewKey();
+  std::shared_ptr<const KeySet> NewKeySet(uint8_t epoch,
+                                          std::shared_ptr<const Key> previous);
+
+  // Returns the current key set, rotating first if it has expired.
+  std::shared_ptr<const KeySet> GetKeys();
+  std::shared_ptr<const KeySet> RotateKeys(
+      std::shared_ptr<const KeySet> expired);
+
+  // Accessed with std::atomic_load/std::atomic_store only.
+  std::shared_ptr<const KeySet> key_set_;
+  // Serializes rotation; never held on the seal/open path.
+  QuicMutex rotation_mutex_;
+  QuicClock* clock_;
+};
+
+// SharedTicketCrypter adapts a SharedTicketKeyManager to the
+// ProofSource::TicketCrypter interface. Every handshaker thread can own its
+// own SharedTicketCrypter while all of them seal and open tickets with the
+// same process-wide keys.
+class QUIC_NO_EXPORT SharedTicketCrypter
+    : public quic::ProofSource::TicketCrypter {
+ public:
+  explicit SharedTicketCrypter(
+      std::shared_ptr<SharedTicketKeyManager> key_manager);
+  ~SharedTicketCrypter() override;
+
+  size_t MaxOverhead() override;
+  std::vector<uint8_t> Encrypt(absl::string_view in,
+                               absl::string_view encryption_key) override;
+  void Decrypt(
+      absl::string_view in,
+      std::unique_ptr<quic::ProofSource::DecryptCallback> callback) override;
+
+ private:
+  std::shared_ptr<SharedTicketKeyManager> key_manager_;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_TOOLS_SHARED_TICKET_CRYPTER_H_
@@ -4,6 +4,7 @@
 
 #include "spdy/core/hpack/hpack_decoder_adapter.h"
 
+#include "absl/strings/string_view.h"
 #include "http2/decoder/decode_buffer.h"
 #include "http2/decoder/decode_status.h"
 #include "common/platform/api/quiche_logging.h"
@@ -135,8 +136,8 @@ void HpackDecoderAdapter::ListenerAdapter::OnHeaderListStart() {
   }
 }
 
-void HpackDecoderAdapter::ListenerAdapter::OnHeader(const std::string& name,
-                                                    const std::string& value) {
+void HpackDecoderAdapter::ListenerAdapter::OnHeader(absl::string_view name,
+                                                    absl::string_view value) {
   QUICHE_DVLOG(2) << "HpackDecoderAdapter::ListenerAdapter::OnHeader:\n name: "
                   << name << "\n value: " << value;
   total_uncompressed_bytes_ += name.size() + value.size();
@@ -6,6 +6,7 @@
 
 #include <algorithm>
 
+#include "absl/types/optional.h"
 #include "common/platform/api/quiche_logging.h"
 #include "spdy/core/hpack/hpack_constants.h"
 #include "spdy/core/hpack/hpack_static_table.h"
@@ -14,8 +15,7 @@ namespace spdy {
 
 HpackHeaderTable::HpackHeaderTable()
     : static_entries_(ObtainHpackStaticTable().GetStaticEntries()),
-      static_index_(ObtainHpackStaticTable().GetStaticIndex()),
-      static_name_index_(ObtainHpackStaticTable().GetStaticNameIndex()),
+      static_table_(ObtainHpackStaticTable()),
       settings_size_bound_(kDefaultHeaderTableSizeSetting),
       size_(0),
       max_size_(kDefaultHeaderTableSizeSetting),
@@ -25,9 +25,9 @@ HpackHeaderTable::~HpackHeaderTable() = default;
 
 size_t HpackHeaderTable::GetByName(absl::string_view name) {
   {
-    auto it = static_name_index_.find(name);
-    if (it != static_name_index_.end()) {
-      return 1 + it->second;
+    absl::optional<size_t> index = static_table_.FindByName(name);
+    if (index.has_value()) {
+      return 1 + *index;
     }
   }
   {
@@ -41,14 +41,14 @@ size_t HpackHeaderTable::GetByName(absl::string_view name) {
 
 size_t HpackHeaderTable::GetByNameAndValue(absl::string_view name,
                                            absl::string_view value) {
-  HpackLookupEntry query{name, value};
   {
-    auto it = static_index_.find(query);
-    if (it != static_index_.end()) {
-      return 1 + it->second;
+    absl::optional<size_t> index = static_table_.FindByNameAndValue(name, value);
+    if (index.has_value()) {
+      return 1 + *index;
     }
   }
   {
+    HpackLookupEntry query{name, value};
     auto it = dynamic_index_.find(query);
     if (it != dynamic_index_.end()) {
       return dynamic_table_insertions_ - it->second + kStaticTableSize;
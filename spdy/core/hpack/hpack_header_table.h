@@ -22,6 +22,8 @@
 
 namespace spdy {
 
+class HpackStaticTable;
+
 namespace test {
 class HpackHeaderTablePeer;
 }  // namespace test
@@ -109,22 +111,16 @@ class QUICHE_EXPORT_PRIVATE HpackHeaderTable {
   // Evicts |count| oldest entries from the table.
   void Evict(size_t count);
 
-  // |static_entries_|, |static_index_|, and |static_name_index_| are owned by
-  // HpackStaticTable singleton.
+  // |static_entries_| and |static_table_| are owned by the HpackStaticTable
+  // singleton.
 
   // Stores HpackEntries.
   const StaticEntryTable& static_entries_;
   DynamicEntryTable dynamic_entries_;
 
-  // Tracks the index of the unique HpackEntry for a given header name and
-  // value.  Keys consist of string_views that point to strings stored in
-  // |static_entries_|.
-  const NameValueToEntryMap& static_index_;
-
-  // Tracks the index of the first static entry for each name in the static
-  // table.  Each key is a string_view that points to a name string stored in
-  // |static_entries_|.
-  const NameToEntryMap& static_name_index_;
+  // Answers static table lookups by name and by name and value through its
+  // flat indices.
+  const HpackStaticTable& static_table_;
 
   // Tracks the index of the most recently inserted HpackEntry for a given
   // header name and value.  Keys consist of string_views that point to strings
@@ -4,6 +4,7 @@
 
 #include "spdy/core/hpack/hpack_static_table.h"
 
+#include "absl/hash/hash.h"
 #include "absl/strings/string_view.h"
 #include "common/platform/api/quiche_logging.h"
 #include "spdy/core/hpack/hpack_constants.h"
@@ -11,6 +12,18 @@
 
 namespace spdy {
 
+namespace {
+
+size_t FlatIndexCapacity(size_t entry_count) {
+  size_t capacity = 1;
+  while (capacity < 2 * entry_count) {
+    capacity <<= 1;
+  }
+  return capacity;
+}
+
+}  // namespace
+
 HpackStaticTable::HpackStaticTable() = default;
 
 HpackStaticTable::~HpackStaticTable() = default;
@@ -41,6 +54,80 @@ void HpackStaticTable::Initialize(const HpackStaticEntry* static_entry_table,
 
     ++insertion_count;
   }
+
+  // Build the flat lookup indices used by FindByNameAndValue() and
+  // FindByName().
+  flat_index_.resize(FlatIndexCapacity(static_entry_count));
+  flat_name_index_.resize(FlatIndexCapacity(static_entry_count));
+  int32_t index = 0;
+  for (const auto& entry : static_entries_) {
+    InsertToFlatIndex(
+        &flat_index_,
+        absl::Hash<HpackLookupEntry>()({entry.name(), entry.value()}), index,
+        [](const FlatIndexSlot& /*slot*/) { return false; });
+    InsertToFlatIndex(&flat_name_index_,
+                      absl::Hash<absl::string_view>()(entry.name()), index,
+                      [this, &entry](const FlatIndexSlot& slot) {
+                        return static_entries_[slot.index].name() ==
+                               entry.name();
+                      });
+    ++index;
+  }
+}
+
+absl::optional<size_t> HpackStaticTable::FindByNameAndValue(
+    absl::string_view name,
+    absl::string_view value) const {
+  const size_t hash = absl::Hash<HpackLookupEntry>()({name, value});
+  const size_t mask = flat_index_.size() - 1;
+  for (size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+    const FlatIndexSlot& candidate = flat_index_[slot];
+    if (candidate.index < 0) {
+      return absl::nullopt;
+    }
+    if (candidate.hash == hash) {
+      const HpackEntry& entry = static_entries_[candidate.index];
+      if (entry.name() == name && entry.value() == value) {
+        return candidate.index;
+      }
+    }
+  }
+}
+
+absl::optional<size_t> HpackStaticTable::FindByName(
+    absl::string_view name) const {
+  const size_t hash = absl::Hash<absl::string_view>()(name);
+  const size_t mask = flat_name_index_.size() - 1;
+  for (size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+    const FlatIndexSlot& candidate = flat_name_index_[slot];
+    if (candidate.index < 0) {
+      return absl::nullopt;
+    }
+    if (candidate.hash == hash &&
+        static_entries_[candidate.index].name() == name) {
+      return candidate.index;
+    }
+  }
+}
+
+template <typename CollidesFn>
+void HpackStaticTable::InsertToFlatIndex(FlatIndex* flat_index,
+                                         size_t hash,
+                                         int32_t index,
+                                         const CollidesFn& collides) {
+  const size_t mask = flat_index->size() - 1;
+  for (size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+    FlatIndexSlot& candidate = (*flat_index)[slot];
+    if (candidate.index < 0) {
+      candidate.hash = hash;
+      candidate.index = index;
+      return;
+    }
+    if (candidate.hash == hash && collides(candidate)) {
+      // An earlier entry with an equal key keeps its slot.
+      return;
+    }
+  }
 }
 
 bool HpackStaticTable::IsInitialized() const {
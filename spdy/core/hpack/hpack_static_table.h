@@ -5,6 +5,11 @@
 #ifndef QUICHE_SPDY_CORE_HPACK_HPACK_STATIC_TABLE_H_
 #define QUICHE_SPDY_CORE_HPACK_HPACK_STATIC_TABLE_H_
 
+#include <cstdint>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
 #include "common/platform/api/quiche_export.h"
 #include "spdy/core/hpack/hpack_header_table.h"
 
@@ -43,12 +48,47 @@ class QUICHE_EXPORT_PRIVATE HpackStaticTable {
     return static_name_index_;
   }
 
+  // Returns the index of the entry with the given name and value, or nullopt
+  // if there is no such entry.  Probes the flat index below, which keeps the
+  // whole search within a handful of contiguous slots.
+  absl::optional<size_t> FindByNameAndValue(absl::string_view name,
+                                            absl::string_view value) const;
+
+  // Returns the index of the first entry with the given name, or nullopt if
+  // there is no such entry.
+  absl::optional<size_t> FindByName(absl::string_view name) const;
+
  private:
+  // A slot of the flat lookup index: the hash of the key and the index of the
+  // entry in |static_entries_|, or -1 for an empty slot.
+  struct QUICHE_EXPORT_PRIVATE FlatIndexSlot {
+    size_t hash = 0;
+    int32_t index = -1;
+  };
+
+  // Open-addressing hash tables with linear probing, sized to a power of two
+  // at least twice the entry count so that probe sequences stay short.  The
+  // entries are known at compile time, so once Initialize() fills these in,
+  // lookups are read-only, allocation-free and touch adjacent slots only.
+  using FlatIndex = std::vector<FlatIndexSlot>;
+
+  // Inserts |index| under |hash| unless |collides| reports that a slot probed
+  // on the way already holds an equal key, which keeps the first entry for
+  // duplicate names in place.
+  template <typename CollidesFn>
+  static void InsertToFlatIndex(FlatIndex* flat_index,
+                                size_t hash,
+                                int32_t index,
+                                const CollidesFn& collides);
+
   HpackHeaderTable::StaticEntryTable static_entries_;
   // The following two members have string_views that point to strings stored in
   // |static_entries_|.
   HpackHeaderTable::NameValueToEntryMap static_index_;
   HpackHeaderTable::NameToEntryMap static_name_index_;
+
+  FlatIndex flat_index_;       // Keyed by (name, value).
+  FlatIndex flat_name_index_;  // Keyed by name; first entry wins.
 };
 
 }  // namespace spdy
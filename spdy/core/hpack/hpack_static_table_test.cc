@@ -8,6 +8,7 @@
 #include <vector>
 
 #include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
 #include "common/platform/api/quiche_test.h"
 #include "spdy/core/hpack/hpack_constants.h"
 
@@ -49,6 +50,33 @@ TEST_F(HpackStaticTableTest, Initialize) {
   EXPECT_EQ(names.size(), static_name_index.size());
 }
 
+// Check that the flat index gives the same answers as the maps, including
+// for entries with duplicate names and for misses.
+TEST_F(HpackStaticTableTest, FlatIndexLookup) {
+  table_.Initialize(HpackStaticTableVector().data(),
+                    HpackStaticTableVector().size());
+
+  const HpackHeaderTable::StaticEntryTable& static_entries =
+      table_.GetStaticEntries();
+  const HpackHeaderTable::NameToEntryMap& static_name_index =
+      table_.GetStaticNameIndex();
+  for (size_t i = 0; i < static_entries.size(); ++i) {
+    const HpackEntry& entry = static_entries[i];
+    absl::optional<size_t> index =
+        table_.FindByNameAndValue(entry.name(), entry.value());
+    ASSERT_TRUE(index.has_value());
+    EXPECT_EQ(i, *index);
+
+    absl::optional<size_t> name_index = table_.FindByName(entry.name());
+    ASSERT_TRUE(name_index.has_value());
+    // The first entry for a name wins, as in the map.
+    EXPECT_EQ(static_name_index.find(entry.name())->second, *name_index);
+  }
+
+  EXPECT_FALSE(table_.FindByName("no-such-name").has_value());
+  EXPECT_FALSE(table_.FindByNameAndValue(":method", "BREW").has_value());
+}
+
 // Test that ObtainHpackStaticTable returns the same instance every time.
 TEST_F(HpackStaticTableTest, IsSingleton) {
   const HpackStaticTable* static_table_one = &ObtainHpackStaticTable();
@@ -19,7 +19,7 @@ class Http2HeaderBlockHpackListener : public http2::HpackDecoderListener {
     hpack_error_ = false;
   }
 
-  void OnHeader(const std::string& name, const std::string& value) override {
+  void OnHeader(absl::string_view name, absl::string_view value) override {
     header_block_.AppendValueOrAddHeader(name, value);
   }
 
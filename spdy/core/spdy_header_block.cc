@@ -298,6 +298,25 @@ void Http2HeaderBlock::AppendValueOrAddHeader(const absl::string_view key,
   iter->second.Append(storage_.Write(value));
 }
 
+void Http2HeaderBlock::AppendValueOrAddHeaderWithoutCopying(
+    const absl::string_view key,
+    const absl::string_view value) {
+  value_size_ += value.size();
+
+  auto iter = map_.find(key);
+  if (iter == map_.end()) {
+    QUICHE_DVLOG(1) << "Inserting without copying: (" << key << ", " << value
+                    << ")";
+    key_size_ += key.size();
+    map_.emplace(std::make_pair(key, HeaderValue(&storage_, key, value)));
+    return;
+  }
+  QUICHE_DVLOG(1) << "Updating key: " << iter->first
+                  << "; appending value without copying: " << value;
+  value_size_ += SeparatorForKey(key).size();
+  iter->second.Append(value);
+}
+
 void Http2HeaderBlock::AppendHeader(const absl::string_view key,
                                     const absl::string_view value) {
   auto backed_key = WriteKey(key);
@@ -202,6 +202,17 @@ class QUICHE_EXPORT_PRIVATE Http2HeaderBlock {
   void AppendValueOrAddHeader(const absl::string_view key,
                               const absl::string_view value);
 
+  // Equivalent to AppendValueOrAddHeader(), except that |key| and |value| are
+  // not copied into backing storage: the caller must guarantee that both
+  // outlive this Http2HeaderBlock (for example, pinned decoder output
+  // buffers).  This makes building a block for pass-through proxying
+  // copy-free for headers that are never modified.  Mutating a header
+  // afterwards -- via insert(), operator[], or consolidation of a multi-value
+  // header -- materializes data into backing storage as usual, and Clone()
+  // always produces a deep copy.
+  void AppendValueOrAddHeaderWithoutCopying(const absl::string_view key,
+                                            const absl::string_view value);
+
   // This object provides automatic conversions that allow Http2HeaderBlock to
   // be nearly a drop-in replacement for
   // SpdyLinkedHashMap<std::string, std::string>.
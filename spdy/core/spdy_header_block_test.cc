@@ -194,6 +194,32 @@ TEST(Http2HeaderBlockTest, AppendHeaders) {
   EXPECT_EQ("singleton", block["h4"]);
 }
 
+// This test verifies that headers added without copying refer to the caller's
+// buffers until they are mutated.
+TEST(Http2HeaderBlockTest, AppendHeadersWithoutCopying) {
+  std::string key = "foo";
+  std::string value = "bar";
+  Http2HeaderBlock block;
+  block.AppendValueOrAddHeaderWithoutCopying(key, value);
+  EXPECT_EQ(Pair("foo", "bar"), *block.find("foo"));
+
+  // The block refers to the caller's buffers rather than private copies.
+  EXPECT_EQ(key.data(), block.find("foo")->first.data());
+  EXPECT_EQ(value.data(), block.find("foo")->second.data());
+
+  // Mutation materializes the header into backing storage.
+  block["foo"] = "baz";
+  EXPECT_EQ("baz", block["foo"]);
+  EXPECT_NE(value.data(), block.find("foo")->second.data());
+
+  // Appended fragments are consolidated into backing storage on first read.
+  std::string cookie_value1 = "key1=value1";
+  std::string cookie_value2 = "key2=value2";
+  block.AppendValueOrAddHeaderWithoutCopying("cookie", cookie_value1);
+  block.AppendValueOrAddHeaderWithoutCopying("cookie", cookie_value2);
+  EXPECT_EQ("key1=value1; key2=value2", block["cookie"]);
+}
+
 TEST(Http2HeaderBlockTest, CompareValueToStringPiece) {
   Http2HeaderBlock block;
   block["foo"] = "foo";